@@ -1,4 +1,55 @@
 set(PART_CUDA_KERNEL_FILES)
+
+# With OPS_LIST_FILE, which lists the op types used by the inference models
+# one per line, see tools/get_model_ops.py, only the op libraries registering
+# any of them are built, to make the inference library smaller and faster to
+# load.
+if (OPS_LIST_FILE)
+    file(STRINGS ${OPS_LIST_FILE} SELECTED_OPS)
+endif()
+
+# The op libraries built regardless of OPS_LIST_FILE, which load the models
+# or run the subgraphs of the inference passes. The ops of controlflow, e.g.,
+# feed and fetch, are built too.
+set(ALWAYS_BUILT_OP_LIBS load_op load_combine_op save_op save_combine_op
+    tensorrt_engine_op lite_engine_op)
+
+# Sets OUTPUT to whether the op library is built with OPS_LIST_FILE. The
+# libraries whose op types can not be found in the sources, e.g., the ones
+# registered by macros, are always built.
+function(op_library_selected TARGET OUTPUT)
+    set(${OUTPUT} TRUE PARENT_SCOPE)
+    list(FIND ALWAYS_BUILT_OP_LIBS ${TARGET} always_built)
+    if (NOT OPS_LIST_FILE OR NOT ${always_built} EQUAL -1 OR
+        ${CMAKE_CURRENT_SOURCE_DIR} MATCHES "controlflow$")
+        return()
+    endif()
+    set(registered_ops)
+    foreach(src ${ARGN})
+        get_filename_component(src_path ${src} ABSOLUTE)
+        file(READ ${src_path} src_content)
+        if (src_content MATCHES "#define")
+            return()
+        endif()
+        string(REGEX MATCHALL "REGISTER_OP(ERATOR|_WITHOUT_GRADIENT)\\([ \t\r\n]*[a-z0-9_]+"
+            registers "${src_content}")
+        foreach(register ${registers})
+            string(REGEX REPLACE "^.*\\([ \t\r\n]*" "" op_type "${register}")
+            list(APPEND registered_ops ${op_type})
+        endforeach()
+    endforeach()
+    if (NOT registered_ops)
+        return()
+    endif()
+    foreach(op_type ${registered_ops})
+        list(FIND SELECTED_OPS ${op_type} selected)
+        if (NOT ${selected} EQUAL -1)
+            return()
+        endif()
+    endforeach()
+    set(${OUTPUT} FALSE PARENT_SCOPE)
+endfunction()
+
 function(op_library TARGET)
     # op_library is a function to create op library. The interface is same as
     # cc_library. But it handle split GPU/CPU code and link some common library
@@ -88,6 +139,11 @@ function(op_library TARGET)
     if (${cc_srcs_len} EQUAL 0)
         message(FATAL_ERROR "The op library ${TARGET} should contains at least one .cc file")
     endif()
+    op_library_selected(${TARGET} selected ${cc_srcs})
+    if (NOT selected)
+        message(STATUS "Skip the op library ${TARGET}, which is not used by ${OPS_LIST_FILE}")
+        return()
+    endif()
     if (WIN32)
     # remove windows unsupported op, because windows has no nccl, no warpctc such ops.
     foreach(windows_unsupport_op "nccl_op" "gen_nccl_id_op")
@@ -0,0 +1,161 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package paddle
+
+// #cgo CFLAGS: -Ipaddle_c/paddle/include
+// #cgo LDFLAGS: -Lpaddle_c/paddle/lib -lpaddle_fluid_c
+// #include <stdbool.h>
+// #include <stdlib.h>
+// #include <paddle_c_api.h>
+import "C"
+
+import "reflect"
+import "runtime"
+import "unsafe"
+
+// Buffer is the memory allocated in C, which can be bound to the inputs and
+// outputs of a predictor, since the Go memory can not be kept by C after a
+// call. The data is read and written in place through the slices returned by
+// Float32s, Int32s, Int64s and Uint8s, without copy.
+type Buffer struct {
+	data     unsafe.Pointer
+	capacity C.size_t
+	dtype    PaddleDType
+}
+
+// NewBuffer allocates the memory of num elements of the dtype.
+func NewBuffer(dtype PaddleDType, num int) *Buffer {
+	size := SizeofDataType(dtype)
+	if size < 0 {
+		panic(bug("Data %v type is not support", dtype))
+	}
+	capacity := C.size_t(int(size) * num)
+	buf := &Buffer{data: C.malloc(capacity), capacity: capacity, dtype: dtype}
+	runtime.SetFinalizer(buf, (*Buffer).finalize)
+	return buf
+}
+
+func (buf *Buffer) finalize() {
+	C.free(buf.data)
+}
+
+func (buf *Buffer) DataType() PaddleDType {
+	return buf.dtype
+}
+
+// Len returns the number of the elements in the buffer.
+func (buf *Buffer) Len() int {
+	return int(buf.capacity) / int(SizeofDataType(buf.dtype))
+}
+
+func (buf *Buffer) slice(elem reflect.Type, dtype PaddleDType) interface{} {
+	if buf.dtype != dtype {
+		panic(bug("Buffer of %v type is read as %v", buf.dtype, dtype))
+	}
+	value := reflect.New(reflect.SliceOf(elem))
+	hdr := (*reflect.SliceHeader)(unsafe.Pointer(value.Pointer()))
+	hdr.Data = uintptr(buf.data)
+	hdr.Len = buf.Len()
+	hdr.Cap = buf.Len()
+	return reflect.Indirect(value).Interface()
+}
+
+func (buf *Buffer) Float32s() []float32 {
+	return buf.slice(reflect.TypeOf(float32(0)), FLOAT32).([]float32)
+}
+
+func (buf *Buffer) Int32s() []int32 {
+	return buf.slice(reflect.TypeOf(int32(0)), INT32).([]int32)
+}
+
+func (buf *Buffer) Int64s() []int64 {
+	return buf.slice(reflect.TypeOf(int64(0)), INT64).([]int64)
+}
+
+func (buf *Buffer) Uint8s() []uint8 {
+	return buf.slice(reflect.TypeOf(uint8(0)), UINT8).([]uint8)
+}
+
+// ZeroCopyBinding binds the buffers to the inputs and outputs of a predictor
+// with SwitchUseFeedFetchOps off. After binding once, each Run reads the
+// inputs from and writes the outputs into the buffers, without copy or
+// allocation on either side.
+type ZeroCopyBinding struct {
+	c         *C.PD_ZeroCopyBinding
+	predictor *Predictor
+	// the buffers are kept alive as long as they are bound
+	inputs  map[string]*Buffer
+	outputs []*Buffer
+}
+
+func (predictor *Predictor) NewZeroCopyBinding() *ZeroCopyBinding {
+	binding := &ZeroCopyBinding{
+		c:         C.PD_NewZeroCopyBinding(predictor.c),
+		predictor: predictor,
+		inputs:    make(map[string]*Buffer),
+	}
+	runtime.SetFinalizer(binding, (*ZeroCopyBinding).finalize)
+	return binding
+}
+
+func (binding *ZeroCopyBinding) finalize() {
+	C.PD_DeleteZeroCopyBinding(binding.c)
+}
+
+// BindInput binds the buffer of the shape to the input, which should be
+// bound again when the shape changes.
+func (binding *ZeroCopyBinding) BindInput(name string, buf *Buffer, shape []int32) {
+	if int(numel(shape)) > buf.Len() {
+		panic(bug("Buffer of %d elements is bound to input %s of shape %v",
+			buf.Len(), name, shape))
+	}
+	c_name := C.CString(name)
+	defer C.free(unsafe.Pointer(c_name))
+	var c_shape *C.int
+	if len(shape) > 0 {
+		c_shape = (*C.int)(unsafe.Pointer(&shape[0]))
+	}
+	C.PD_ZeroCopyBindInput(binding.c, c_name, buf.data,
+		C.PD_DataType(buf.dtype), c_shape, C.int(len(shape)))
+	binding.inputs[name] = buf
+}
+
+// BindOutput binds the buffer to the output, and returns its index for
+// OutputShape. An output larger than the buffer fails the run.
+func (binding *ZeroCopyBinding) BindOutput(name string, buf *Buffer) int {
+	c_name := C.CString(name)
+	defer C.free(unsafe.Pointer(c_name))
+	index := int(C.PD_ZeroCopyBindOutput(binding.c, c_name, buf.data,
+		buf.capacity, C.PD_DataType(buf.dtype)))
+	binding.outputs = append(binding.outputs, buf)
+	return index
+}
+
+func (binding *ZeroCopyBinding) Run() bool {
+	return ConvertCBooleanToGo(C.PD_ZeroCopyRunBound(binding.c))
+}
+
+// OutputShape returns the shape of the output of the index after a run.
+func (binding *ZeroCopyBinding) OutputShape(index int) []int32 {
+	shape := make([]int32, 8)
+	for {
+		rank := int(C.PD_ZeroCopyBoundOutputShape(binding.c, C.int(index),
+			(*C.int)(unsafe.Pointer(&shape[0])), C.int(len(shape))))
+		if rank <= len(shape) {
+			return shape[:rank]
+		}
+		shape = make([]int32, rank)
+	}
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package paddle
+
+// PredictorPool holds the clones of a predictor for the goroutines serving
+// at the same time, which share the parameters. A predictor is taken by Get
+// for a run, and returned by Put, so that it is never run concurrently.
+type PredictorPool struct {
+	predictors chan *Predictor
+}
+
+func NewPredictorPool(config *AnalysisConfig, size int) *PredictorPool {
+	if size < 1 {
+		panic(bug("The size of PredictorPool should be positive, but got %d",
+			size))
+	}
+	pool := &PredictorPool{predictors: make(chan *Predictor, size)}
+	main := NewPredictor(config)
+	pool.predictors <- main
+	for i := 1; i < size; i++ {
+		pool.predictors <- main.Clone()
+	}
+	return pool
+}
+
+// Get waits for a free predictor.
+func (pool *PredictorPool) Get() *Predictor {
+	return <-pool.predictors
+}
+
+func (pool *PredictorPool) Put(predictor *Predictor) {
+	pool.predictors <- predictor
+}
@@ -43,6 +43,15 @@ func DeletePredictor(predictor *Predictor) {
 	C.PD_DeletePredictor(predictor.c)
 }
 
+// Clone returns a predictor sharing the parameters of the predictor, which
+// can run in another goroutine at the same time.
+func (predictor *Predictor) Clone() *Predictor {
+	c_predictor := C.PD_ClonePredictor(predictor.c)
+	cloned := &Predictor{c: c_predictor}
+	runtime.SetFinalizer(cloned, (*Predictor).finalize)
+	return cloned
+}
+
 func (predictor *Predictor) GetInputNum() int {
 	return int(C.PD_GetInputNum(predictor.c))
 }
@@ -183,10 +183,13 @@ void BlockDesc::Flush() {
   }
 
   if (need_update_) {
-    this->desc_->mutable_ops()->Clear();
+    // The ops not materialized yet are views of desc_->ops(), which are
+    // materialized by Proto() before desc_->ops() is replaced.
+    google::protobuf::RepeatedPtrField<proto::OpDesc> ops;
     for (auto &op_desc : ops_) {
-      this->desc_->mutable_ops()->Add()->CopyFrom(*op_desc->Proto());
+      ops.Add()->CopyFrom(*op_desc->Proto());
     }
+    this->desc_->mutable_ops()->Swap(&ops);
     this->desc_->mutable_vars()->Clear();
     for (auto &var_desc : vars_) {
       this->desc_->mutable_vars()->Add()->CopyFrom(*var_desc.second->Proto());
@@ -210,7 +213,7 @@ BlockDesc::BlockDesc(ProgramDesc *prog, proto::BlockDesc *desc)
     vars_[var_desc.name()].reset(new VarDesc(var_desc));
   }
   for (const proto::OpDesc &op_desc : desc_->ops()) {
-    ops_.emplace_back(new OpDesc(op_desc, this));
+    ops_.emplace_back(OpDesc::CreateView(&op_desc, this));
   }
 }
 
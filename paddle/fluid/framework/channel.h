@@ -21,6 +21,7 @@
 
 #include <glog/logging.h>
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <deque>
 #include <limits>
@@ -29,10 +30,29 @@
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/expect.h"
+#include "paddle/fluid/platform/metrics.h"
 
 namespace paddle {
 namespace framework {
 
+// The items read from and written into all the channels, shared by the
+// ChannelObject of all the types.
+struct ChannelMetrics {
+  platform::MetricCounter* reads;
+  platform::MetricCounter* writes;
+
+  static ChannelMetrics& Instance() {
+    static ChannelMetrics metrics{
+        platform::MetricsRegistry::Instance().Counter(
+            "paddle_channel_reads_total",
+            "The items read from the channels of the data feeds."),
+        platform::MetricsRegistry::Instance().Counter(
+            "paddle_channel_writes_total",
+            "The items written into the channels of the data feeds.")};
+    return metrics;
+  }
+};
+
 template <class T>
 class ChannelObject {
  public:
@@ -43,13 +63,46 @@ class ChannelObject {
     capacity_ = (std::min)(MaxCapacity(), capacity);
   }
 
-  const std::deque<T>& GetData() const { return data_; }
+  const std::deque<T>& GetData() const {
+    CHECK(shards_.empty()) << "GetData is not supported by sharded channel";
+    return data_;
+  }
   void Clear() {
+    if (!shards_.empty()) {
+      for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->data.clear();
+        shard->data.shrink_to_fit();
+      }
+      sharded_size_ = 0;
+      return;
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     data_.clear();
     data_.shrink_to_fit();
   }
 
+  // Split the channel into shard_num lock-striped queues to reduce lock
+  // contention with many reader and writer threads. Each thread writes to
+  // its own shard, and reads from its own shard first, then from the
+  // others. The blocking, block size, capacity and close semantics are
+  // kept, but the order of data is only kept within a shard, and capacity
+  // becomes a soft limit. shard_num <= 1 turns sharding off.
+  // It can only be called when the channel is empty.
+  void SetShardNum(size_t shard_num) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(EmptyUnlocked() && sharded_size_ == 0)
+        << "can not change shard num of a non-empty channel";
+    shards_.clear();
+    if (shard_num > 1) {
+      for (size_t i = 0; i < shard_num; ++i) {
+        shards_.emplace_back(new Shard);
+      }
+    }
+  }
+
+  size_t ShardNum() { return shards_.empty() ? 1 : shards_.size(); }
+
   size_t Capacity() {
     return capacity_;  // atomic
   }
@@ -75,6 +128,12 @@ class ChannelObject {
     std::lock_guard<std::mutex> lock(mutex_);
     capacity_ = other->Capacity();
     block_size_ = other->BlockSize();
+    if (other->ShardNum() > 1 && EmptyUnlocked() && sharded_size_ == 0) {
+      shards_.clear();
+      for (size_t i = 0; i < other->ShardNum(); ++i) {
+        shards_.emplace_back(new Shard);
+      }
+    }
   }
 
   bool Closed() {
@@ -96,11 +155,17 @@ class ChannelObject {
   }
 
   size_t Size() {
+    if (!shards_.empty()) {
+      return sharded_size_;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     return data_.size();
   }
 
   bool Empty() {
+    if (!shards_.empty()) {
+      return sharded_size_ == 0;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     return EmptyUnlocked();
   }
@@ -114,10 +179,15 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
-
-    std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = Read(n, p, lock);
-    Notify();
+    size_t finished = 0;
+    if (!shards_.empty()) {
+      finished = ShardedRead(n, p);
+    } else {
+      std::unique_lock<std::mutex> lock(mutex_);
+      finished = Read(n, p, lock);
+      Notify();
+    }
+    ChannelMetrics::Instance().reads->Add(finished);
     return finished;
   }
 
@@ -133,9 +203,15 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
-    std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = Write(n, p, lock);
-    Notify();
+    size_t finished = 0;
+    if (!shards_.empty()) {
+      finished = ShardedWrite(n, const_cast<T*>(p), false);
+    } else {
+      std::unique_lock<std::mutex> lock(mutex_);
+      finished = Write(n, p, lock);
+      Notify();
+    }
+    ChannelMetrics::Instance().writes->Add(finished);
     return finished;
   }
 
@@ -144,9 +220,15 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
-    std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = WriteMove(n, p, lock);
-    Notify();
+    size_t finished = 0;
+    if (!shards_.empty()) {
+      finished = ShardedWrite(n, p, true);
+    } else {
+      std::unique_lock<std::mutex> lock(mutex_);
+      finished = WriteMove(n, p, lock);
+      Notify();
+    }
+    ChannelMetrics::Instance().writes->Add(finished);
     return finished;
   }
 
@@ -180,9 +262,16 @@ class ChannelObject {
   size_t Write(std::vector<T>&& p) { return WriteMove(p.size(), &p[0]); }
 
  private:
+  struct Shard {
+    std::mutex mutex;
+    std::deque<T> data;
+    // keep shards on different cache lines
+    char padding[64];
+  };
+
   size_t capacity_ = MaxCapacity();
   size_t block_size_ = 1024;
-  bool closed_ = false;
+  std::atomic<bool> closed_{false};
   std::mutex mutex_;
   // use deque to store data
   std::deque<T> data_;
@@ -191,12 +280,23 @@ class ChannelObject {
   int full_waiters_ = 0;
   std::condition_variable empty_cond_;
   std::condition_variable full_cond_;
+  // only used in sharded mode, mutex_ and the conditions above are only
+  // taken when a thread has to wait
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> sharded_size_{0};
+  std::atomic<size_t> sharded_reading_count_{0};
+  std::atomic<int> sharded_waiters_{0};
 
   static constexpr size_t MaxCapacity() {
     return (std::numeric_limits<size_t>::max)() / 2;
   }
 
   void Notify() {
+    if (!shards_.empty()) {
+      empty_cond_.notify_all();
+      full_cond_.notify_all();
+      return;
+    }
     if (empty_waiters_ != 0 && (!EmptyUnlocked() || closed_)) {
       empty_cond_.notify_one();
     }
@@ -284,6 +384,100 @@ class ChannelObject {
     }
     return finished;
   }
+
+  size_t ThreadShard() {
+    static std::atomic<size_t> thread_count{0};
+    static thread_local size_t thread_id = thread_count++;
+    return thread_id % shards_.size();
+  }
+
+  bool ShardedFull() {
+    return sharded_size_ >= capacity_ + sharded_reading_count_;
+  }
+
+  void ShardedNotify() {
+    if (sharded_waiters_ != 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      empty_cond_.notify_all();
+      full_cond_.notify_all();
+    }
+  }
+
+  // returns false if the channel is closed and empty
+  bool ShardedWaitForRead() {
+    if (sharded_size_ != 0) {
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    sharded_waiters_++;
+    while (sharded_size_ == 0 && !closed_) {
+      full_cond_.notify_all();
+      empty_cond_.wait(lock);
+    }
+    sharded_waiters_--;
+    return sharded_size_ != 0;
+  }
+
+  // returns false if the channel is closed
+  bool ShardedWaitForWrite() {
+    if (!ShardedFull() || closed_) {
+      return !closed_;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    sharded_waiters_++;
+    while (ShardedFull() && !closed_) {
+      empty_cond_.notify_all();
+      full_cond_.wait(lock);
+    }
+    sharded_waiters_--;
+    return !closed_;
+  }
+
+  size_t ShardedRead(size_t n, T* p) {
+    size_t finished = 0;
+    size_t start = ThreadShard();
+    sharded_reading_count_ += n;
+    while (finished < n && ShardedWaitForRead()) {
+      for (size_t i = 0; i < shards_.size() && finished < n; ++i) {
+        Shard& shard = *shards_[(start + i) % shards_.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t m = std::min(n - finished, shard.data.size());
+        for (size_t j = 0; j < m; ++j) {
+          p[finished++] = std::move(shard.data.front());
+          shard.data.pop_front();
+        }
+        sharded_size_ -= m;
+        sharded_reading_count_ -= m;
+      }
+      ShardedNotify();
+    }
+    sharded_reading_count_ -= n - finished;
+    return finished;
+  }
+
+  size_t ShardedWrite(size_t n, T* p, bool move) {
+    size_t finished = 0;
+    Shard& shard = *shards_[ThreadShard()];
+    while (finished < n && ShardedWaitForWrite()) {
+      // capacity is a soft limit, concurrent writers may exceed it a little
+      size_t limit = capacity_ + sharded_reading_count_;
+      size_t size = sharded_size_;
+      size_t m = std::min(n - finished, size < limit ? limit - size : 1);
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = 0; i < m; i++) {
+          if (move) {
+            shard.data.push_back(std::move(p[finished++]));
+          } else {
+            shard.data.push_back(p[finished++]);
+          }
+        }
+      }
+      sharded_size_ += m;
+      ShardedNotify();
+    }
+    return finished;
+  }
 };  // NOLINT
 
 template <class T>
@@ -0,0 +1,108 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/channel.h"
+#include <gtest/gtest.h>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+static void TestMultiThreadReadWrite(size_t shard_num, size_t capacity) {
+  const int kWriterNum = 8;
+  const int kReaderNum = 8;
+  const int kNumPerWriter = 10000;
+  auto chan = MakeChannel<int>(capacity);
+  chan->SetShardNum(shard_num);
+  chan->SetBlockSize(64);
+
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kWriterNum; ++i) {
+    writers.emplace_back([&chan, i] {
+      ChannelWriter<int> writer(chan.get());
+      for (int j = 0; j < kNumPerWriter; ++j) {
+        writer << (i * kNumPerWriter + j);
+      }
+      writer.Flush();
+    });
+  }
+
+  std::vector<std::vector<int>> results(kReaderNum);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kReaderNum; ++i) {
+    readers.emplace_back([&chan, &results, i] {
+      std::vector<int> data;
+      while (chan->Read(data) != 0) {
+        results[i].insert(results[i].end(), data.begin(), data.end());
+      }
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  chan->Close();
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  std::vector<bool> seen(kWriterNum * kNumPerWriter, false);
+  size_t total = 0;
+  for (auto& result : results) {
+    for (int x : result) {
+      EXPECT_FALSE(seen[x]);
+      seen[x] = true;
+    }
+    total += result.size();
+  }
+  EXPECT_EQ(total, seen.size());
+  EXPECT_EQ(chan->Size(), 0UL);
+}
+
+TEST(Channel, MultiThreadReadWrite) { TestMultiThreadReadWrite(1, 1024); }
+
+TEST(Channel, ShardedMultiThreadReadWrite) {
+  TestMultiThreadReadWrite(4, (std::numeric_limits<size_t>::max)());
+  TestMultiThreadReadWrite(4, 1024);
+  TestMultiThreadReadWrite(4, 0);
+}
+
+TEST(Channel, ShardedCloseAndInherit) {
+  auto chan = MakeChannel<int>();
+  chan->SetShardNum(3);
+  std::vector<int> data = {1, 2, 3, 4, 5};
+  chan->Write(std::move(data));
+  EXPECT_EQ(chan->Size(), 5UL);
+  chan->Close();
+  EXPECT_EQ(chan->Write(std::vector<int>{6}), 0UL);
+
+  std::vector<int> all;
+  chan->ReadAll(all);
+  EXPECT_EQ(all.size(), 5UL);
+  EXPECT_TRUE(chan->Empty());
+
+  chan->Open();
+  chan->Put(7);
+  int x = 0;
+  EXPECT_TRUE(chan->Get(x));
+  EXPECT_EQ(x, 7);
+
+  auto other = MakeChannel<int>(chan);
+  EXPECT_EQ(other->ShardNum(), 3UL);
+  chan->SetShardNum(1);
+  EXPECT_EQ(chan->ShardNum(), 1UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
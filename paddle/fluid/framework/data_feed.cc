@@ -24,6 +24,8 @@ limitations under the License. */
 #include <sys/stat.h>
 #include <sys/types.h>
 #endif
+#include <algorithm>
+#include <random>
 #include <utility>
 #include "gflags/gflags.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
@@ -34,7 +36,12 @@ limitations under the License. */
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/timer.h"
+#include "paddle/fluid/string/slot_tokenizer.h"
 
 namespace paddle {
 namespace framework {
@@ -155,13 +162,46 @@ void DataFeed::CopyToFeedTensor(void* dst, const void* src, size_t size) {
     memcpy(dst, src, size);
   } else {
 #ifdef PADDLE_WITH_CUDA
-    cudaMemcpy(dst, src, size, cudaMemcpyHostToDevice);
+    // NOTE: cudaMemcpy from pageable memory blocks until the copy is done,
+    // so src is staged in a pinned buffer, which is released after the async
+    // copy finishes. The ops using dst run in the same stream after the copy.
+    ReleaseStagingBuffers(false);
+    auto& place = boost::get<platform::CUDAPlace>(this->place_);
+    auto stream = static_cast<platform::CUDADeviceContext*>(
+                      platform::DeviceContextPool::Instance().Get(place))
+                      ->stream();
+    platform::CUDAPinnedPlace cuda_pinned_place;
+    auto buffer = memory::Alloc(cuda_pinned_place, size);
+    memcpy(buffer->ptr(), src, size);
+    memory::Copy(place, dst, cuda_pinned_place, buffer->ptr(), size, stream);
+    auto event = platform::CudaEventResourcePool::Instance().New(place.device);
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaEventRecord(event.get(), stream),
+        platform::errors::Fatal("cudaEventRecord raises unexpected exception"));
+    staging_buffers_.emplace_back(std::move(event), std::move(buffer));
 #else
     PADDLE_THROW("Not supported GPU, Please compile WITH_GPU option");
 #endif
   }
 }
 
+#ifdef PADDLE_WITH_CUDA
+void DataFeed::ReleaseStagingBuffers(bool wait) {
+  while (!staging_buffers_.empty()) {
+    auto* event = staging_buffers_.front().first.get();
+    if (wait) {
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaEventSynchronize(event),
+          platform::errors::Fatal(
+              "cudaEventSynchronize raises unexpected exception"));
+    } else if (cudaEventQuery(event) != cudaSuccess) {
+      break;
+    }
+    staging_buffers_.pop_front();
+  }
+}
+#endif
+
 template <typename T>
 void PrivateQueueDataFeed<T>::SetQueueSize(int queue_size) {
   PADDLE_ENFORCE(queue_size > 0, "Illegal queue size: %d.", queue_size);
@@ -182,6 +222,7 @@ bool PrivateQueueDataFeed<T>::Start() {
 
 template <typename T>
 void PrivateQueueDataFeed<T>::ReadThread() {
+  platform::BindThreadToCpuPool(platform::CpuPool::kIO);
 #ifdef _LINUX
   std::string filename;
   while (PickOneFile(&filename)) {
@@ -232,6 +273,9 @@ InMemoryDataFeed<T>::InMemoryDataFeed() {
   this->thread_num_ = 1;
   this->parse_ins_id_ = false;
   this->parse_content_ = false;
+  this->compact_record_ = false;
+  this->prefetch_batch_ = false;
+  this->load_memory_budget_ = nullptr;
   this->input_channel_ = nullptr;
   this->output_channel_ = nullptr;
   this->consume_channel_ = nullptr;
@@ -260,20 +304,11 @@ int InMemoryDataFeed<T>::Next() {
   VLOG(3) << "output_channel_ size=" << output_channel_->Size()
           << ", consume_channel_ size=" << consume_channel_->Size()
           << ", thread_id=" << thread_id_;
-  int index = 0;
-  T instance;
-  std::vector<T> ins_vec;
-  ins_vec.reserve(this->default_batch_size_);
-  while (index < this->default_batch_size_) {
-    if (output_channel_->Size() == 0) {
-      break;
-    }
-    output_channel_->Get(instance);
-    ins_vec.push_back(instance);
-    ++index;
-    consume_channel_->Put(std::move(instance));
+  if (prefetch_batch_) {
+    return PrefetchNext();
   }
-  this->batch_size_ = index;
+  std::vector<T> ins_vec;
+  this->batch_size_ = ReadBatch(&ins_vec);
   VLOG(3) << "batch_size_=" << this->batch_size_
           << ", thread_id=" << thread_id_;
   if (this->batch_size_ != 0) {
@@ -290,6 +325,125 @@ int InMemoryDataFeed<T>::Next() {
 #endif
 }
 
+template <typename T>
+int InMemoryDataFeed<T>::ReadBatch(std::vector<T>* ins_vec) {
+  int index = 0;
+  T instance;
+  ins_vec->reserve(this->default_batch_size_);
+  while (index < this->default_batch_size_) {
+    if (output_channel_->Size() == 0) {
+      break;
+    }
+    output_channel_->Get(instance);
+    ins_vec->push_back(instance);
+    ++index;
+    consume_channel_->Put(std::move(instance));
+  }
+  return index;
+}
+
+template <typename T>
+int InMemoryDataFeed<T>::PrefetchNext() {
+  if (!prefetch_thread_.joinable()) {
+    // feed variables may be rebound between epochs, so buffers are set up
+    // when each epoch begins
+    scope_feed_vec_ = this->feed_vec_;
+    for (auto& tensors : prefetch_tensors_) {
+      tensors.clear();
+      tensors.resize(scope_feed_vec_.size());
+    }
+    prefetch_free_ = paddle::framework::MakeChannel<int>();
+    prefetch_ready_ = paddle::framework::MakeChannel<std::pair<int, int>>();
+    prefetch_free_->Put(0);
+    prefetch_thread_ = std::thread(&InMemoryDataFeed<T>::PrefetchThread, this);
+  }
+  std::pair<int, int> ready;
+  CHECK(prefetch_ready_->Get(ready));
+  this->batch_size_ = ready.second;
+  VLOG(3) << "prefetched batch_size_=" << this->batch_size_
+          << ", thread_id=" << thread_id_;
+  if (this->batch_size_ == 0) {
+    StopPrefetch();
+    return 0;
+  }
+  // prefetch_thread_ waits for a free buffer now, so it is safe to publish
+  // the filled one and give back the one used by the last batch
+  auto& tensors = prefetch_tensors_[ready.first];
+  for (size_t i = 0; i < scope_feed_vec_.size(); ++i) {
+    if (scope_feed_vec_[i] == nullptr) {
+      continue;
+    }
+    scope_feed_vec_[i]->ShareDataWith(tensors[i]);
+    scope_feed_vec_[i]->set_lod(tensors[i].lod());
+  }
+  front_ins_id_vec_.swap(this->ins_id_vec_);
+  front_ins_content_vec_.swap(this->ins_content_vec_);
+  prefetch_free_->Put(1 - ready.first);
+  return this->batch_size_;
+}
+
+template <typename T>
+void InMemoryDataFeed<T>::PrefetchThread() {
+  platform::BindThreadToCpuPool(platform::CpuPool::kIO);
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(this->place_)) {
+    platform::SetDeviceId(
+        boost::get<platform::CUDAPlace>(this->place_).GetDeviceId());
+  }
+#endif
+  int index = 0;
+  while (prefetch_free_->Get(index)) {
+    std::vector<T> ins_vec;
+    int batch_size = ReadBatch(&ins_vec);
+    if (batch_size != 0) {
+      for (size_t i = 0; i < scope_feed_vec_.size(); ++i) {
+        this->feed_vec_[i] = scope_feed_vec_[i] == nullptr
+                                 ? nullptr
+                                 : &prefetch_tensors_[index][i];
+      }
+      PutToFeedVec(ins_vec);
+    }
+    prefetch_ready_->Put(std::make_pair(index, batch_size));
+    if (batch_size == 0) {
+      break;
+    }
+  }
+}
+
+template <typename T>
+void InMemoryDataFeed<T>::StopPrefetch() {
+  if (!prefetch_thread_.joinable()) {
+    return;
+  }
+  prefetch_free_->Close();
+  prefetch_ready_->Close();
+  prefetch_thread_.join();
+  this->feed_vec_ = scope_feed_vec_;
+  prefetch_free_ = nullptr;
+  prefetch_ready_ = nullptr;
+}
+
+template <typename T>
+void InMemoryDataFeed<T>::SetPrefetchBatch(bool prefetch_batch) {
+  prefetch_batch_ = prefetch_batch;
+}
+
+template <typename T>
+void InMemoryDataFeed<T>::SetLoadMemoryBudget(LoadMemoryBudget* budget) {
+  load_memory_budget_ = budget;
+}
+
+template <typename T>
+const std::vector<std::string>& InMemoryDataFeed<T>::GetInsIdVec() const {
+  return prefetch_batch_ ? front_ins_id_vec_ : this->ins_id_vec_;
+}
+
+template <typename T>
+const std::vector<std::string>& InMemoryDataFeed<T>::GetInsContentVec()
+    const {
+  return prefetch_batch_ ? front_ins_content_vec_ : this->ins_content_vec_;
+}
+
 template <typename T>
 void InMemoryDataFeed<T>::SetInputChannel(void* channel) {
   input_channel_ = static_cast<paddle::framework::ChannelObject<T>*>(channel);
@@ -325,8 +479,14 @@ void InMemoryDataFeed<T>::SetParseInsId(bool parse_ins_id) {
   parse_ins_id_ = parse_ins_id;
 }
 
+template <typename T>
+void InMemoryDataFeed<T>::SetCompactRecord(bool compact_record) {
+  compact_record_ = compact_record;
+}
+
 template <typename T>
 void InMemoryDataFeed<T>::LoadIntoMemory() {
+  platform::BindThreadToCpuPool(platform::CpuPool::kIO);
 #ifdef _LINUX
   VLOG(3) << "LoadIntoMemory() begin, thread_id=" << thread_id_;
   std::string filename;
@@ -342,6 +502,12 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
     platform::Timer timeline;
     timeline.Start();
     while (ParseOneInstanceFromPipe(&instance)) {
+      if (compact_record_) {
+        CompactInstance(&instance);
+      }
+      if (load_memory_budget_ != nullptr) {
+        load_memory_budget_->Consume(RecordMemorySize(instance));
+      }
       writer << std::move(instance);
       instance = T();
     }
@@ -412,6 +578,7 @@ void MultiSlotDataFeed::Init(
 }
 
 void MultiSlotDataFeed::ReadThread() {
+  platform::BindThreadToCpuPool(platform::CpuPool::kIO);
 #ifdef _LINUX
   std::string filename;
   while (PickOneFile(&filename)) {
@@ -556,8 +723,7 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
     instance->resize(use_slots_num);
 
     const char* str = reader.get();
-    std::string line = std::string(str);
-    // VLOG(3) << line;
+    const char* line_end = str + reader.length();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
@@ -579,19 +745,18 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
+          thread_local std::vector<uint64_t> feasigns;
+          feasigns.resize(num);
+          endptr = const_cast<char*>(
+              string::ParseUint64s(endptr, line_end, num, feasigns.data()));
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
-            (*instance)[idx].AddValue(feasign);
+            (*instance)[idx].AddValue(feasigns[j]);
           }
         }
         pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        // skip the num token and the num values of the unused slot
+        pos = string::SkipTokens(&str[pos], line_end, num + 1) - str;
       }
     }
     return true;
@@ -609,6 +774,7 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
     instance->resize(use_slots_num);
     // parse line
     const char* str = line.c_str();
+    const char* line_end = str + line.length();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
@@ -630,16 +796,18 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
+          thread_local std::vector<uint64_t> feasigns;
+          feasigns.resize(num);
+          endptr = const_cast<char*>(
+              string::ParseUint64s(endptr, line_end, num, feasigns.data()));
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
-            (*instance)[idx].AddValue(feasign);
+            (*instance)[idx].AddValue(feasigns[j]);
           }
         }
         pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        // skip the num token and the num values of the unused slot
+        pos = string::SkipTokens(&str[pos], line_end, num + 1) - str;
       }
     }
   } else {
@@ -753,19 +921,27 @@ void MultiSlotInMemoryDataFeed::Init(
   }
   feed_vec_.resize(use_slots_.size());
   pipe_command_ = data_feed_desc.pipe_command();
+  instance_filter_.Init(data_feed_desc, all_slots_, all_slots_type_);
   finish_init_ = true;
 }
 
+void MultiSlotInMemoryDataFeed::ClearInstance(Record* instance) {
+  instance->uint64_feasigns_.clear();
+  instance->float_feasigns_.clear();
+  instance->ins_id_.clear();
+  instance->content_.clear();
+}
+
 bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
 #ifdef _LINUX
   thread_local string::LineFileReader reader;
+  if (compact_record_) {
+    compact_encoder_.Recycle(instance);
+  }
 
-  if (!reader.getline(&*(fp_.get()))) {
-    return false;
-  } else {
+  while (reader.getline(&*(fp_.get()))) {
     const char* str = reader.get();
-    std::string line = std::string(str);
-    // VLOG(3) << line;
+    const char* line_end = str + reader.length();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     if (parse_ins_id_) {
@@ -792,7 +968,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       pos += len + 1;
       VLOG(3) << "content " << instance->content_;
     }
-    for (size_t i = 0; i < use_slots_index_.size(); ++i) {
+    bool keep = true;
+    for (size_t i = 0; i < use_slots_index_.size() && keep; ++i) {
       int idx = use_slots_index_[i];
       int num = strtol(&str[pos], &endptr, 10);
       PADDLE_ENFORCE(
@@ -816,8 +993,16 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
             instance->float_feasigns_.push_back(FeatureItem(f, idx));
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
-          for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+          thread_local std::vector<uint64_t> feasigns;
+          feasigns.resize(num);
+          endptr = const_cast<char*>(
+              string::ParseUint64s(endptr, line_end, num, feasigns.data()));
+          if (instance_filter_.HasFilter(i) &&
+              !instance_filter_.Keep(i, feasigns.data(), num)) {
+            keep = false;
+          }
+          for (int j = 0; j < num && keep; ++j) {
+            uint64_t feasign = feasigns[j];
             // if uint64 feasign is equal to zero, ignore it
             // except when slot is dense
             if (feasign == 0 && !use_slots_is_dense_[i]) {
@@ -829,19 +1014,29 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         }
         pos = endptr - str;
+      } else if (instance_filter_.HasFilter(i)) {
+        // the unused slot is only parsed for the instance filters
+        thread_local std::vector<uint64_t> feasigns;
+        feasigns.resize(num);
+        endptr = const_cast<char*>(
+            string::ParseUint64s(endptr, line_end, num, feasigns.data()));
+        keep = instance_filter_.Keep(i, feasigns.data(), num);
+        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        // skip the num token and the num values of the unused slot
+        pos = string::SkipTokens(&str[pos], line_end, num + 1) - str;
       }
     }
+    if (!keep) {
+      // dropped by the instance filters, parse the next line into it
+      ClearInstance(instance);
+      continue;
+    }
     instance->float_feasigns_.shrink_to_fit();
     instance->uint64_feasigns_.shrink_to_fit();
     return true;
   }
+  return false;
 #else
   return false;
 #endif
@@ -850,13 +1045,15 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
 bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
 #ifdef _LINUX
   std::string line;
-  if (getline(file_, line)) {
+  while (getline(file_, line)) {
     VLOG(3) << line;
     // parse line
     const char* str = line.c_str();
+    const char* line_end = str + line.length();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
-    for (size_t i = 0; i < use_slots_index_.size(); ++i) {
+    bool keep = true;
+    for (size_t i = 0; i < use_slots_index_.size() && keep; ++i) {
       int idx = use_slots_index_[i];
       int num = strtol(&str[pos], &endptr, 10);
       PADDLE_ENFORCE(
@@ -879,8 +1076,16 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
             instance->float_feasigns_.push_back(FeatureItem(f, idx));
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
-          for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+          thread_local std::vector<uint64_t> feasigns;
+          feasigns.resize(num);
+          endptr = const_cast<char*>(
+              string::ParseUint64s(endptr, line_end, num, feasigns.data()));
+          if (instance_filter_.HasFilter(i) &&
+              !instance_filter_.Keep(i, feasigns.data(), num)) {
+            keep = false;
+          }
+          for (int j = 0; j < num && keep; ++j) {
+            uint64_t feasign = feasigns[j];
             if (feasign == 0) {
               continue;
             }
@@ -890,22 +1095,251 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
           }
         }
         pos = endptr - str;
+      } else if (instance_filter_.HasFilter(i)) {
+        // the unused slot is only parsed for the instance filters
+        thread_local std::vector<uint64_t> feasigns;
+        feasigns.resize(num);
+        endptr = const_cast<char*>(
+            string::ParseUint64s(endptr, line_end, num, feasigns.data()));
+        keep = instance_filter_.Keep(i, feasigns.data(), num);
+        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        // skip the num token and the num values of the unused slot
+        pos = string::SkipTokens(&str[pos], line_end, num + 1) - str;
       }
     }
+    if (!keep) {
+      // dropped by the instance filters, parse the next line into it
+      ClearInstance(instance);
+      continue;
+    }
     instance->float_feasigns_.shrink_to_fit();
     instance->uint64_feasigns_.shrink_to_fit();
     return true;
-  } else {
-    return false;
   }
 #endif
   return false;
 }
 
+namespace {
+
+void AppendVarint(uint64_t value, std::string* buffer) {
+  while (value >= 0x80) {
+    buffer->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer->push_back(static_cast<char>(value));
+}
+
+// append [group_num [slot num value * num]*], a group is a run of
+// consecutive feasigns of the same slot
+void AppendFeasignGroups(const std::vector<FeatureItem>& feas, bool is_uint64,
+                         std::string* buffer) {
+  size_t group_num = 0;
+  for (size_t i = 0; i < feas.size(); ++i) {
+    if (i == 0 || feas[i].slot() != feas[i - 1].slot()) {
+      ++group_num;
+    }
+  }
+  AppendVarint(group_num, buffer);
+  size_t begin = 0;
+  while (begin < feas.size()) {
+    size_t end = begin + 1;
+    while (end < feas.size() && feas[end].slot() == feas[begin].slot()) {
+      ++end;
+    }
+    AppendVarint(feas[begin].slot(), buffer);
+    AppendVarint(end - begin, buffer);
+    uint64_t prev = 0;
+    for (size_t i = begin; i < end; ++i) {
+      if (is_uint64) {
+        uint64_t cur = feas[i].sign().uint64_feasign_;
+        int64_t delta = static_cast<int64_t>(cur - prev);
+        AppendVarint((static_cast<uint64_t>(delta) << 1) ^
+                         static_cast<uint64_t>(delta >> 63),
+                     buffer);
+        prev = cur;
+      } else {
+        buffer->append(
+            reinterpret_cast<const char*>(&feas[i].sign().float_feasign_),
+            sizeof(float));
+      }
+    }
+    begin = end;
+  }
+}
+
+}  // namespace
+
+char* RecordArena::Allocate(size_t size) {
+  if (size > block_size_ / 4) {
+    // large records get their own block, so blocks are not wasted
+    blocks_.emplace_back(new char[size]);
+    memory_size_ += size;
+    return blocks_.back().get();
+  }
+  if (block_ == nullptr || block_used_ + size > block_size_) {
+    blocks_.emplace_back(new char[block_size_]);
+    memory_size_ += block_size_;
+    block_ = blocks_.back().get();
+    block_used_ = 0;
+  }
+  char* ret = block_ + block_used_;
+  block_used_ += size;
+  return ret;
+}
+
+void RecordArena::Reset() {
+  std::vector<std::unique_ptr<char[]>>().swap(blocks_);
+  block_ = nullptr;
+  block_used_ = 0;
+  memory_size_ = 0;
+}
+
+void InstanceFilter::Init(const DataFeedDesc& data_feed_desc,
+                          const std::vector<std::string>& slot_names,
+                          const std::vector<std::string>& slot_types) {
+  filters_.clear();
+  slot_filters_.clear();
+  if (data_feed_desc.instance_filters_size() == 0) {
+    return;
+  }
+  slot_filters_.resize(slot_names.size());
+  for (int i = 0; i < data_feed_desc.instance_filters_size(); ++i) {
+    const auto& desc = data_feed_desc.instance_filters(i);
+    auto iter = std::find(slot_names.begin(), slot_names.end(), desc.slot());
+    PADDLE_ENFORCE_NE(iter, slot_names.end(),
+                      platform::errors::InvalidArgument(
+                          "The slot %s of the instance filter is not found.",
+                          desc.slot()));
+    int slot_index = iter - slot_names.begin();
+    PADDLE_ENFORCE_EQ(slot_types[slot_index], "uint64",
+                      platform::errors::InvalidArgument(
+                          "The slot %s of the instance filter should be a "
+                          "uint64 slot, but it is %s.",
+                          desc.slot(), slot_types[slot_index]));
+    Filter filter;
+    filter.values.insert(desc.values().begin(), desc.values().end());
+    filter.keep_rate = desc.keep_rate();
+    filter.others_keep_rate = desc.others_keep_rate();
+    slot_filters_[slot_index].push_back(filters_.size());
+    filters_.push_back(std::move(filter));
+  }
+}
+
+bool InstanceFilter::Keep(int slot_index, const uint64_t* values,
+                          int num) const {
+  for (int filter_index : slot_filters_[slot_index]) {
+    const Filter& filter = filters_[filter_index];
+    bool match = filter.values.empty();
+    for (int i = 0; i < num && !match; ++i) {
+      match = filter.values.count(values[i]) > 0;
+    }
+    float keep_rate = match ? filter.keep_rate : filter.others_keep_rate;
+    if (keep_rate >= 1.0) {
+      continue;
+    }
+    if (keep_rate <= 0.0) {
+      return false;
+    }
+    std::uniform_real_distribution<float> distribution(0.0, 1.0);
+    if (distribution(FleetWrapper::GetInstance()->LocalRandomEngine()) >=
+        keep_rate) {
+      return false;
+    }
+  }
+  return true;
+}
+
+char* CompactRecordEncoder::Allocate(size_t size,
+                                     std::shared_ptr<char>* block) {
+  if (arena_ != nullptr) {
+    block->reset();
+    return arena_->Allocate(size);
+  }
+  if (size > block_size_ / 4) {
+    // large records get their own block, so blocks are not wasted
+    block->reset(new char[size], std::default_delete<char[]>());
+    return block->get();
+  }
+  if (block_ == nullptr || block_used_ + size > block_capacity_) {
+    block_.reset(new char[block_size_], std::default_delete<char[]>());
+    block_used_ = 0;
+    block_capacity_ = block_size_;
+  }
+  char* ret = block_.get() + block_used_;
+  block_used_ += size;
+  *block = block_;
+  return ret;
+}
+
+void CompactRecordEncoder::Encode(Record* rec) {
+  if (rec->IsCompact()) {
+    return;
+  }
+  buffer_.clear();
+  AppendFeasignGroups(rec->uint64_feasigns_, true, &buffer_);
+  AppendFeasignGroups(rec->float_feasigns_, false, &buffer_);
+  char* data = Allocate(buffer_.size(), &rec->compact_block_);
+  memcpy(data, buffer_.data(), buffer_.size());
+  rec->compact_data_ = data;
+  rec->compact_size_ = static_cast<uint32_t>(buffer_.size());
+  // rec must not hold any capacity, keep the largest vectors for Recycle()
+  auto release = [](std::vector<FeatureItem>* feas,
+                    std::vector<FeatureItem>* recycled) {
+    std::vector<FeatureItem> tmp;
+    tmp.swap(*feas);
+    tmp.clear();
+    if (tmp.capacity() > recycled->capacity()) {
+      recycled->swap(tmp);
+    }
+  };
+  release(&rec->uint64_feasigns_, &recycled_uint64_feasigns_);
+  release(&rec->float_feasigns_, &recycled_float_feasigns_);
+}
+
+void CompactRecordEncoder::Recycle(Record* rec) {
+  if (rec->uint64_feasigns_.capacity() == 0) {
+    rec->uint64_feasigns_.swap(recycled_uint64_feasigns_);
+  }
+  if (rec->float_feasigns_.capacity() == 0) {
+    rec->float_feasigns_.swap(recycled_float_feasigns_);
+  }
+}
+
+void CompactRecordEncoder::Decode(Record* rec) {
+  if (!rec->IsCompact()) {
+    return;
+  }
+  std::vector<FeatureItem> uint64_feasigns;
+  std::vector<FeatureItem> float_feasigns;
+  ForEach(*rec,
+          [&uint64_feasigns](uint16_t slot, uint64_t feasign) {
+            FeatureKey key;
+            key.uint64_feasign_ = feasign;
+            uint64_feasigns.emplace_back(key, slot);
+          },
+          [&float_feasigns](uint16_t slot, float feasign) {
+            FeatureKey key;
+            key.float_feasign_ = feasign;
+            float_feasigns.emplace_back(key, slot);
+          });
+  // feasigns left in the vectors are kept after the decoded ones
+  uint64_feasigns.insert(uint64_feasigns.end(), rec->uint64_feasigns_.begin(),
+                         rec->uint64_feasigns_.end());
+  float_feasigns.insert(float_feasigns.end(), rec->float_feasigns_.begin(),
+                        rec->float_feasigns_.end());
+  rec->uint64_feasigns_.swap(uint64_feasigns);
+  rec->float_feasigns_.swap(float_feasigns);
+  rec->compact_block_ = nullptr;
+  rec->compact_data_ = nullptr;
+  rec->compact_size_ = 0;
+}
+
+void MultiSlotInMemoryDataFeed::CompactInstance(Record* instance) {
+  compact_encoder_.Encode(instance);
+}
+
 void MultiSlotInMemoryDataFeed::PutToFeedVec(
     const std::vector<Record>& ins_vec) {
 #ifdef _LINUX
@@ -924,6 +1358,18 @@ void MultiSlotInMemoryDataFeed::PutToFeedVec(
     auto& r = ins_vec[i];
     ins_id_vec_.push_back(r.ins_id_);
     ins_content_vec_.push_back(r.content_);
+    if (r.IsCompact()) {
+      CompactRecordEncoder::ForEach(
+          r,
+          [&](uint16_t slot, uint64_t feasign) {
+            batch_uint64_feasigns[slot].push_back(feasign);
+            visit[slot] = true;
+          },
+          [&](uint16_t slot, float feasign) {
+            batch_float_feasigns[slot].push_back(feasign);
+            visit[slot] = true;
+          });
+    }
     for (auto& item : r.float_feasigns_) {
       batch_float_feasigns[item.slot()].push_back(item.sign().float_feasign_);
       visit[item.slot()] = true;
@@ -985,6 +1431,388 @@ void MultiSlotInMemoryDataFeed::PutToFeedVec(
 #endif
 }
 
+namespace {
+// "PDBF" in little endian
+constexpr uint32_t kBinaryDataFeedMagic = 0x46424450;
+constexpr uint32_t kBinaryDataFeedVersion = 1;
+constexpr uint32_t kBinaryFlagInsId = 1;
+constexpr uint32_t kBinaryFlagContent = 2;
+
+template <typename T>
+void AppendPod(std::vector<char>* buffer, const T& value) {
+  const char* p = reinterpret_cast<const char*>(&value);
+  buffer->insert(buffer->end(), p, p + sizeof(T));
+}
+
+template <typename T>
+bool FreadPod(FILE* fp, T* value) {
+  return fread(value, sizeof(T), 1, fp) == 1;
+}
+
+void FwriteOrDie(const void* data, size_t size, FILE* fp) {
+  PADDLE_ENFORCE_EQ(fwrite(data, 1, size, fp), size,
+                    platform::errors::Unavailable(
+                        "Failed to write binary data feed file."));
+}
+
+// Cursor over a block payload, the payload is not necessarily aligned.
+class BinaryBlockCursor {
+ public:
+  BinaryBlockCursor(const char* data, size_t size)
+      : cur_(data), end_(data + size) {}
+
+  const char* Take(size_t bytes) {
+    PADDLE_ENFORCE_LE(bytes, static_cast<size_t>(end_ - cur_),
+                      platform::errors::InvalidArgument(
+                          "Binary data feed block is truncated."));
+    const char* ret = cur_;
+    cur_ += bytes;
+    return ret;
+  }
+
+  uint32_t LenAt(const char* lens, size_t i) const {
+    uint32_t len;
+    memcpy(&len, lens + i * sizeof(uint32_t), sizeof(uint32_t));
+    return len;
+  }
+
+ private:
+  const char* cur_;
+  const char* end_;
+};
+}  // namespace
+
+bool MultiSlotBinaryInMemoryDataFeed::ReadBinaryHeader(
+    FILE* fp, std::vector<BinarySlotInfo>* slots, uint32_t* flags) {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t slot_num = 0;
+  if (!FreadPod(fp, &magic)) {
+    // empty file
+    return false;
+  }
+  PADDLE_ENFORCE_EQ(magic, kBinaryDataFeedMagic,
+                    platform::errors::InvalidArgument(
+                        "The file is not in binary data feed format, please "
+                        "convert it with ConvertTextFile first."));
+  PADDLE_ENFORCE_EQ(FreadPod(fp, &version) && FreadPod(fp, flags) &&
+                        FreadPod(fp, &slot_num),
+                    true, platform::errors::InvalidArgument(
+                              "Binary data feed header is truncated."));
+  PADDLE_ENFORCE_EQ(version, kBinaryDataFeedVersion,
+                    platform::errors::Unimplemented(
+                        "Binary data feed version %d is not supported.",
+                        version));
+  std::unordered_map<std::string, int> use_index;
+  for (size_t i = 0; i < use_slots_.size(); ++i) {
+    use_index[use_slots_[i]] = i;
+  }
+  std::vector<bool> found(use_slots_.size(), false);
+  slots->resize(slot_num);
+  for (uint32_t i = 0; i < slot_num; ++i) {
+    uint8_t type = 0;
+    uint32_t name_len = 0;
+    PADDLE_ENFORCE_EQ(FreadPod(fp, &type) && FreadPod(fp, &name_len), true,
+                      platform::errors::InvalidArgument(
+                          "Binary data feed header is truncated."));
+    std::string name(name_len, '\0');
+    PADDLE_ENFORCE_EQ(fread(&name[0], 1, name_len, fp), name_len,
+                      platform::errors::InvalidArgument(
+                          "Binary data feed header is truncated."));
+    (*slots)[i].type = static_cast<char>(type);
+    auto iter = use_index.find(name);
+    if (iter == use_index.end()) {
+      (*slots)[i].use_index = -1;
+      continue;
+    }
+    (*slots)[i].use_index = iter->second;
+    found[iter->second] = true;
+  }
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    int idx = use_slots_index_[i];
+    if (idx == -1) {
+      continue;
+    }
+    PADDLE_ENFORCE_EQ(found[idx], true,
+                      platform::errors::NotFound(
+                          "Used slot %s is not in the binary data feed file.",
+                          all_slots_[i]));
+  }
+  for (auto& slot : *slots) {
+    if (slot.use_index == -1) {
+      continue;
+    }
+    for (size_t i = 0; i < all_slots_.size(); ++i) {
+      if (use_slots_index_[i] == slot.use_index) {
+        PADDLE_ENFORCE_EQ(slot.type, all_slots_type_[i][0],
+                          platform::errors::InvalidArgument(
+                              "The type of slot %s in binary data feed file "
+                              "does not match the DataFeedDesc.",
+                              all_slots_[i]));
+      }
+    }
+  }
+  PADDLE_ENFORCE_EQ(!parse_ins_id_ || (*flags & kBinaryFlagInsId), true,
+                    platform::errors::InvalidArgument(
+                        "The binary data feed file has no ins_id."));
+  PADDLE_ENFORCE_EQ(!parse_content_ || (*flags & kBinaryFlagContent), true,
+                    platform::errors::InvalidArgument(
+                        "The binary data feed file has no content."));
+  return true;
+}
+
+bool MultiSlotBinaryInMemoryDataFeed::ReadBinaryBlock(
+    FILE* fp, const std::vector<BinarySlotInfo>& slots, uint32_t flags,
+    std::vector<char>* buffer, std::vector<Record>* records) {
+  uint32_t ins_num = 0;
+  uint64_t payload_bytes = 0;
+  if (!FreadPod(fp, &ins_num)) {
+    return false;
+  }
+  PADDLE_ENFORCE_EQ(FreadPod(fp, &payload_bytes), true,
+                    platform::errors::InvalidArgument(
+                        "Binary data feed block header is truncated."));
+  buffer->resize(payload_bytes);
+  PADDLE_ENFORCE_EQ(fread(buffer->data(), 1, payload_bytes, fp), payload_bytes,
+                    platform::errors::InvalidArgument(
+                        "Binary data feed block is truncated."));
+  records->clear();
+  records->resize(ins_num);
+
+  // first pass: locate every column, so that each Record is reserved once
+  BinaryBlockCursor cursor(buffer->data(), buffer->size());
+  std::vector<const char*> lens(slots.size());
+  std::vector<const char*> values(slots.size());
+  std::vector<size_t> uint64_num(ins_num, 0);
+  std::vector<size_t> float_num(ins_num, 0);
+  for (size_t s = 0; s < slots.size(); ++s) {
+    lens[s] = cursor.Take(ins_num * sizeof(uint32_t));
+    size_t total = 0;
+    for (uint32_t r = 0; r < ins_num; ++r) {
+      uint32_t len = cursor.LenAt(lens[s], r);
+      total += len;
+      if (slots[s].use_index == -1) {
+        continue;
+      }
+      if (slots[s].type == 'u') {
+        uint64_num[r] += len;
+      } else {
+        float_num[r] += len;
+      }
+    }
+    values[s] = cursor.Take(
+        total * (slots[s].type == 'u' ? sizeof(uint64_t) : sizeof(float)));
+  }
+  for (uint32_t r = 0; r < ins_num; ++r) {
+    (*records)[r].uint64_feasigns_.reserve(uint64_num[r]);
+    (*records)[r].float_feasigns_.reserve(float_num[r]);
+  }
+
+  // second pass: fill FeatureItems slot by slot
+  for (size_t s = 0; s < slots.size(); ++s) {
+    int idx = slots[s].use_index;
+    if (idx == -1) {
+      continue;
+    }
+    const char* value = values[s];
+    for (uint32_t r = 0; r < ins_num; ++r) {
+      uint32_t len = cursor.LenAt(lens[s], r);
+      Record& rec = (*records)[r];
+      for (uint32_t j = 0; j < len; ++j) {
+        FeatureKey f;
+        if (slots[s].type == 'u') {
+          memcpy(&f.uint64_feasign_, value, sizeof(uint64_t));
+          value += sizeof(uint64_t);
+          rec.uint64_feasigns_.push_back(FeatureItem(f, idx));
+        } else {
+          memcpy(&f.float_feasign_, value, sizeof(float));
+          value += sizeof(float);
+          rec.float_feasigns_.push_back(FeatureItem(f, idx));
+        }
+      }
+    }
+  }
+
+  auto read_strings = [&](bool keep, std::string Record::*field) {
+    const char* str_lens = cursor.Take(ins_num * sizeof(uint32_t));
+    for (uint32_t r = 0; r < ins_num; ++r) {
+      uint32_t len = cursor.LenAt(str_lens, r);
+      const char* str = cursor.Take(len);
+      if (keep) {
+        ((*records)[r].*field).assign(str, len);
+      }
+    }
+  };
+  if (flags & kBinaryFlagInsId) {
+    read_strings(parse_ins_id_, &Record::ins_id_);
+  }
+  if (flags & kBinaryFlagContent) {
+    read_strings(parse_content_, &Record::content_);
+  }
+  return true;
+}
+
+void MultiSlotBinaryInMemoryDataFeed::LoadIntoMemory() {
+  platform::BindThreadToCpuPool(platform::CpuPool::kIO);
+#ifdef _LINUX
+  VLOG(3) << "LoadIntoMemory() begin, thread_id=" << thread_id_;
+  std::string filename;
+  std::vector<char> buffer;
+  std::vector<Record> records;
+  while (this->PickOneFile(&filename)) {
+    VLOG(3) << "PickOneFile, filename=" << filename
+            << ", thread_id=" << thread_id_;
+    int err_no = 0;
+    this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_);
+    CHECK(this->fp_ != nullptr);
+    __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
+    platform::Timer timeline;
+    timeline.Start();
+    std::vector<BinarySlotInfo> slots;
+    uint32_t flags = 0;
+    size_t ins_num = 0;
+    if (ReadBinaryHeader(this->fp_.get(), &slots, &flags)) {
+      while (ReadBinaryBlock(this->fp_.get(), slots, flags, &buffer,
+                             &records)) {
+        if (records.empty()) {
+          continue;
+        }
+        ins_num += records.size();
+        if (compact_record_) {
+          for (auto& rec : records) {
+            CompactInstance(&rec);
+          }
+        }
+        if (load_memory_budget_ != nullptr) {
+          size_t bytes = 0;
+          for (auto& rec : records) {
+            bytes += RecordMemorySize(rec);
+          }
+          load_memory_budget_->Consume(bytes);
+        }
+        input_channel_->Write(std::move(records));
+      }
+    }
+    timeline.Pause();
+    VLOG(3) << "LoadIntoMemory() read all blocks, file=" << filename
+            << ", instances=" << ins_num
+            << ", cost time=" << timeline.ElapsedSec()
+            << " seconds, thread_id=" << thread_id_;
+  }
+  VLOG(3) << "LoadIntoMemory() end, thread_id=" << thread_id_;
+#endif
+}
+
+void MultiSlotBinaryInMemoryDataFeed::WriteBinaryBlock(
+    FILE* fp, const std::vector<Record>& records, uint32_t flags,
+    std::vector<char>* buffer) {
+  buffer->clear();
+  std::vector<uint32_t> lens(records.size());
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    int idx = use_slots_index_[i];
+    if (idx == -1) {
+      continue;
+    }
+    bool is_uint64 = all_slots_type_[i][0] == 'u';
+    for (size_t r = 0; r < records.size(); ++r) {
+      const auto& feas = is_uint64 ? records[r].uint64_feasigns_
+                                   : records[r].float_feasigns_;
+      lens[r] = 0;
+      for (auto& item : feas) {
+        lens[r] += item.slot() == idx;
+      }
+      AppendPod(buffer, lens[r]);
+    }
+    for (size_t r = 0; r < records.size(); ++r) {
+      const auto& feas = is_uint64 ? records[r].uint64_feasigns_
+                                   : records[r].float_feasigns_;
+      for (auto& item : feas) {
+        if (item.slot() != idx) {
+          continue;
+        }
+        if (is_uint64) {
+          AppendPod(buffer, item.sign().uint64_feasign_);
+        } else {
+          AppendPod(buffer, item.sign().float_feasign_);
+        }
+      }
+    }
+  }
+  auto write_strings = [&](std::string Record::*field) {
+    for (auto& rec : records) {
+      AppendPod(buffer, static_cast<uint32_t>((rec.*field).size()));
+    }
+    for (auto& rec : records) {
+      buffer->insert(buffer->end(), (rec.*field).begin(), (rec.*field).end());
+    }
+  };
+  if (flags & kBinaryFlagInsId) {
+    write_strings(&Record::ins_id_);
+  }
+  if (flags & kBinaryFlagContent) {
+    write_strings(&Record::content_);
+  }
+  uint32_t ins_num = records.size();
+  uint64_t payload_bytes = buffer->size();
+  FwriteOrDie(&ins_num, sizeof(ins_num), fp);
+  FwriteOrDie(&payload_bytes, sizeof(payload_bytes), fp);
+  FwriteOrDie(buffer->data(), buffer->size(), fp);
+}
+
+void MultiSlotBinaryInMemoryDataFeed::ConvertTextFile(const std::string& src,
+                                                      const std::string& dst,
+                                                      size_t block_size) {
+#ifdef _LINUX
+  CheckInit();
+  PADDLE_ENFORCE_GT(block_size, 0,
+                    platform::errors::InvalidArgument(
+                        "Block size of binary data feed must be positive."));
+  int err_no = 0;
+  this->fp_ = fs_open_read(src, &err_no, this->pipe_command_);
+  CHECK(this->fp_ != nullptr);
+  std::shared_ptr<FILE> out = fs_open_write(dst, &err_no, "");
+  CHECK(out != nullptr);
+
+  uint32_t flags = (parse_ins_id_ ? kBinaryFlagInsId : 0) |
+                   (parse_content_ ? kBinaryFlagContent : 0);
+  std::vector<char> buffer;
+  AppendPod(&buffer, kBinaryDataFeedMagic);
+  AppendPod(&buffer, kBinaryDataFeedVersion);
+  AppendPod(&buffer, flags);
+  AppendPod(&buffer, static_cast<uint32_t>(use_slots_.size()));
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    if (use_slots_index_[i] == -1) {
+      continue;
+    }
+    AppendPod(&buffer, static_cast<uint8_t>(all_slots_type_[i][0]));
+    AppendPod(&buffer, static_cast<uint32_t>(all_slots_[i].size()));
+    buffer.insert(buffer.end(), all_slots_[i].begin(), all_slots_[i].end());
+  }
+  FwriteOrDie(buffer.data(), buffer.size(), out.get());
+
+  std::vector<Record> records;
+  records.reserve(block_size);
+  Record instance;
+  size_t ins_num = 0;
+  while (ParseOneInstanceFromPipe(&instance)) {
+    records.push_back(std::move(instance));
+    instance = Record();
+    if (records.size() == block_size) {
+      WriteBinaryBlock(out.get(), records, flags, &buffer);
+      ins_num += records.size();
+      records.clear();
+    }
+  }
+  if (!records.empty()) {
+    WriteBinaryBlock(out.get(), records, flags, &buffer);
+    ins_num += records.size();
+  }
+  this->fp_ = nullptr;
+  VLOG(3) << "ConvertTextFile() " << src << " -> " << dst
+          << ", instances=" << ins_num;
+#endif
+}
+
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
 template <typename T>
 void PrivateInstantDataFeed<T>::PutToFeedVec() {
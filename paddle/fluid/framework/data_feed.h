@@ -19,6 +19,8 @@ limitations under the License. */
 #define _LINUX
 #endif
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <fstream>
 #include <future>  // NOLINT
 #include <memory>
@@ -27,6 +29,7 @@ limitations under the License. */
 #include <string>
 #include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -38,10 +41,17 @@ limitations under the License. */
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable.h"
 #include "paddle/fluid/string/string_helper.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/cuda_resource_pool.h"
+#endif
 
 namespace paddle {
 namespace framework {
 
+class LoadMemoryBudget;
+class RecordArena;
+
 // DataFeed is the base virtual class for all ohther DataFeeds.
 // It is used to read files and parse the data for subsequent trainer.
 // Example:
@@ -64,7 +74,11 @@ class DataFeed {
     mutex_for_pick_file_ = nullptr;
     file_idx_ = nullptr;
   }
-  virtual ~DataFeed() {}
+  virtual ~DataFeed() {
+#ifdef PADDLE_WITH_CUDA
+    ReleaseStagingBuffers(true);
+#endif
+  }
   virtual void Init(const DataFeedDesc& data_feed_desc) = 0;
   virtual bool CheckFile(const char* filename) {
     PADDLE_THROW("This function(CheckFile) is not implemented.");
@@ -106,6 +120,14 @@ class DataFeed {
   // This function will do nothing at default
   virtual void SetParseInsId(bool parse_ins_id) {}
   virtual void SetParseContent(bool parse_content) {}
+  // This function will do nothing at default
+  virtual void SetCompactRecord(bool compact_record) {}
+  // This function will do nothing at default
+  virtual void SetRecordArena(RecordArena* arena) {}
+  // This function will do nothing at default
+  virtual void SetPrefetchBatch(bool prefetch_batch) {}
+  // This function will do nothing at default
+  virtual void SetLoadMemoryBudget(LoadMemoryBudget* budget) {}
   virtual void SetFileListMutex(std::mutex* mutex) {
     mutex_for_pick_file_ = mutex;
   }
@@ -137,7 +159,14 @@ class DataFeed {
   // This function is used to pick one file from the global filelist(thread
   // safe).
   virtual bool PickOneFile(std::string* filename);
+  // Copy to the feed tensors in place_. The copies to GPU are staged in
+  // pinned memory and are async in the stream of place_.
   virtual void CopyToFeedTensor(void* dst, const void* src, size_t size);
+#ifdef PADDLE_WITH_CUDA
+  // Release the staging buffers whose copies are finished, or all of them
+  // after their copies finish if wait is true.
+  void ReleaseStagingBuffers(bool wait);
+#endif
 
   std::vector<std::string> filelist_;
   size_t* file_idx_;
@@ -175,6 +204,13 @@ class DataFeed {
   std::vector<std::string> ins_id_vec_;
   std::vector<std::string> ins_content_vec_;
   platform::Place place_;
+#ifdef PADDLE_WITH_CUDA
+  // the pinned buffers staging the copies to GPU, with the events recorded
+  // after the copies, in the order of the copies
+  std::deque<std::pair<std::shared_ptr<platform::CudaEventObject>,
+                       memory::AllocationPtr>>
+      staging_buffers_;
+#endif
 };
 
 // PrivateQueueDataFeed is the base virtual class for ohther DataFeeds.
@@ -222,7 +258,7 @@ template <typename T>
 class InMemoryDataFeed : public DataFeed {
  public:
   InMemoryDataFeed();
-  virtual ~InMemoryDataFeed() {}
+  virtual ~InMemoryDataFeed() { StopPrefetch(); }
   virtual void Init(const DataFeedDesc& data_feed_desc) = 0;
   virtual bool Start();
   virtual int Next();
@@ -233,17 +269,51 @@ class InMemoryDataFeed : public DataFeed {
   virtual void SetThreadNum(int thread_num);
   virtual void SetParseInsId(bool parse_ins_id);
   virtual void SetParseContent(bool parse_content);
+  virtual void SetCompactRecord(bool compact_record);
+  // If prefetch_batch is true, the feed tensors of the next batch are built
+  // by a helper thread while the current batch is trained. Next() then only
+  // shares the prebuilt tensors with the feed variables.
+  virtual void SetPrefetchBatch(bool prefetch_batch);
+  virtual void SetLoadMemoryBudget(LoadMemoryBudget* budget);
+  virtual const std::vector<std::string>& GetInsIdVec() const;
+  virtual const std::vector<std::string>& GetInsContentVec() const;
   virtual void LoadIntoMemory();
 
  protected:
   virtual bool ParseOneInstance(T* instance) = 0;
   virtual bool ParseOneInstanceFromPipe(T* instance) = 0;
   virtual void PutToFeedVec(const std::vector<T>& ins_vec) = 0;
+  // convert a parsed instance to its compact form before it is put into
+  // input_channel_, called only if compact_record_ is true
+  virtual void CompactInstance(T* instance) {}
+  // move the next batch from output_channel_ to ins_vec, and keep a copy of
+  // it in consume_channel_, returns the batch size
+  int ReadBatch(std::vector<T>* ins_vec);
+  int PrefetchNext();
+  void PrefetchThread();
+  // stop and join the prefetch thread. a derived class must call it in its
+  // destructor, since the thread calls PutToFeedVec()
+  void StopPrefetch();
 
   int thread_id_;
   int thread_num_;
   bool parse_ins_id_;
   bool parse_content_;
+  bool compact_record_;
+  bool prefetch_batch_;
+  // LoadIntoMemory() blocks while the loaded records exceed the budget
+  LoadMemoryBudget* load_memory_budget_;
+  // two sets of feed tensors, one is shared with scope_feed_vec_ and the
+  // other is being filled by prefetch_thread_ through feed_vec_
+  std::vector<LoDTensor> prefetch_tensors_[2];
+  std::vector<LoDTensor*> scope_feed_vec_;
+  std::vector<std::string> front_ins_id_vec_;
+  std::vector<std::string> front_ins_content_vec_;
+  std::thread prefetch_thread_;
+  // index of the buffer that prefetch_thread_ can fill
+  paddle::framework::Channel<int> prefetch_free_;
+  // index and batch size of a filled buffer
+  paddle::framework::Channel<std::pair<int, int>> prefetch_ready_;
   std::ifstream file_;
   std::shared_ptr<FILE> fp_;
   paddle::framework::ChannelObject<T>* input_channel_;
@@ -439,8 +509,205 @@ struct Record {
   std::vector<FeatureItem> float_feasigns_;
   std::string ins_id_;
   std::string content_;
+  // In compact record mode the feasigns are moved out of the two vectors
+  // above into compact_size_ bytes at compact_data_, see CompactRecordEncoder.
+  // compact_block_ keeps the block holding them alive, it is null if they
+  // are owned by a RecordArena of the dataset.
+  std::shared_ptr<char> compact_block_;
+  const char* compact_data_ = nullptr;
+  uint32_t compact_size_ = 0;
+
+  bool IsCompact() const { return compact_data_ != nullptr; }
+};
+
+// estimated bytes of memory held by a Record
+inline size_t RecordMemorySize(const Record& r) {
+  return sizeof(Record) +
+         (r.uint64_feasigns_.capacity() + r.float_feasigns_.capacity()) *
+             sizeof(FeatureItem) +
+         r.ins_id_.capacity() + r.content_.capacity() + r.compact_size_;
+}
+
+// LoadMemoryBudget bounds the memory of the records loaded in background.
+// Readers call Consume() for every record they load, which blocks while the
+// consumed bytes exceed the limit, until Lift() is called. It is shared by
+// all readers of a dataset and is thread safe.
+class LoadMemoryBudget {
+ public:
+  LoadMemoryBudget() {}
+  // limit <= 0 means no limit
+  void Reset(int64_t limit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    limit_ = limit;
+    used_ = 0;
+    lifted_ = limit <= 0;
+    cond_.notify_all();
+  }
+  void Consume(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    used_ += bytes;
+    cond_.wait(lock, [this] { return lifted_ || used_ <= limit_; });
+  }
+  // stop blocking readers, they load the rest at full speed
+  void Lift() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lifted_ = true;
+    cond_.notify_all();
+  }
+  int64_t Used() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  int64_t limit_ = 0;
+  int64_t used_ = 0;
+  bool lifted_ = true;
+};
+
+// RecordArena hands out the memory for the compact feasigns of the Records
+// loaded by one reader thread. The memory is given back all at once by
+// Reset(), when the dataset releases the pass, instead of one Record at a
+// time. It is not thread safe.
+class RecordArena {
+ public:
+  explicit RecordArena(size_t block_size = 1 << 20)
+      : block_size_(block_size) {}
+  char* Allocate(size_t size);
+  // free all memory, Records allocated from this arena must not be used
+  // any more
+  void Reset();
+  size_t MemorySize() const { return memory_size_; }
+
+ private:
+  size_t block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* block_ = nullptr;
+  size_t block_used_ = 0;
+  size_t memory_size_ = 0;
+};
+
+// InstanceFilter evaluates the instance_filters of DataFeedDesc while a text
+// line is parsed, so that the dropped instances never reach the channel, the
+// shuffle or the executor. An instance matches a filter if its slot has one
+// of the values of the filter (always if no values are given), then it is
+// kept with the probability keep_rate if it matches and others_keep_rate if
+// not. An instance is kept only if all filters keep it.
+class InstanceFilter {
+ public:
+  // slot_names and slot_types are all slots of the data feed, in the order
+  // of the text format
+  void Init(const DataFeedDesc& data_feed_desc,
+            const std::vector<std::string>& slot_names,
+            const std::vector<std::string>& slot_types);
+  bool Empty() const { return filters_.empty(); }
+  // if there are filters on the slot at slot_index of all slots
+  bool HasFilter(int slot_index) const {
+    return !filters_.empty() && slot_filters_[slot_index].size() > 0;
+  }
+  // returns false if the instance is dropped by the filters on the slot at
+  // slot_index of all slots, values are all values of the slot in the line
+  bool Keep(int slot_index, const uint64_t* values, int num) const;
+
+ private:
+  struct Filter {
+    std::unordered_set<uint64_t> values;
+    float keep_rate;
+    float others_keep_rate;
+  };
+  std::vector<Filter> filters_;
+  // the filters on each slot
+  std::vector<std::vector<int>> slot_filters_;
+};
+
+// CompactRecordEncoder encodes the feasigns of Records into a compact format
+// and stores them in blocks shared by many Records:
+//   [group_num(varint) [slot(varint) num(varint) value * num]*] * 2
+// The first groups hold uint64 feasigns as zigzag varints of the delta to
+// the previous feasign of the same slot, the second ones hold float feasigns
+// as raw 4 bytes. The order of feasigns is kept. An encoder is not thread
+// safe, each reader thread owns one.
+class CompactRecordEncoder {
+ public:
+  explicit CompactRecordEncoder(size_t block_size = 1 << 20)
+      : block_size_(block_size) {}
+  // allocate from arena instead of reference counted blocks, arena must
+  // outlive the encoded Records
+  void SetArena(RecordArena* arena) { arena_ = arena; }
+  // move the feasigns of rec into the arena, rec->uint64_feasigns_ and
+  // rec->float_feasigns_ are released. their memory is kept by the encoder
+  // and handed to the next Record by Recycle()
+  void Encode(Record* rec);
+  // give the feasign vectors kept by the last Encode() to an empty rec, so
+  // parsing it does not allocate again
+  void Recycle(Record* rec);
+  // restore rec->uint64_feasigns_ and rec->float_feasigns_ of a compact rec
+  static void Decode(Record* rec);
+  // call uint64_func(slot, feasign) and float_func(slot, feasign) for each
+  // feasign of a compact rec, without materializing FeatureItems
+  template <typename Uint64Func, typename FloatFunc>
+  static void ForEach(const Record& rec, Uint64Func uint64_func,
+                      FloatFunc float_func);
+
+ private:
+  static uint64_t ReadVarint(const char** cursor);
+  char* Allocate(size_t size, std::shared_ptr<char>* block);
+
+  size_t block_size_;
+  RecordArena* arena_ = nullptr;
+  std::shared_ptr<char> block_;
+  size_t block_used_ = 0;
+  size_t block_capacity_ = 0;
+  std::string buffer_;
+  std::vector<FeatureItem> recycled_uint64_feasigns_;
+  std::vector<FeatureItem> recycled_float_feasigns_;
 };
 
+inline uint64_t CompactRecordEncoder::ReadVarint(const char** cursor) {
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(*cursor);
+  uint64_t value = 0;
+  int shift = 0;
+  while (*p & 0x80) {
+    value |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+    shift += 7;
+  }
+  value |= static_cast<uint64_t>(*p++) << shift;
+  *cursor = reinterpret_cast<const char*>(p);
+  return value;
+}
+
+template <typename Uint64Func, typename FloatFunc>
+void CompactRecordEncoder::ForEach(const Record& rec, Uint64Func uint64_func,
+                                   FloatFunc float_func) {
+  const char* cursor = rec.compact_data_;
+  const char* end = rec.compact_data_ + rec.compact_size_;
+  uint64_t group_num = ReadVarint(&cursor);
+  for (uint64_t i = 0; i < group_num; ++i) {
+    uint16_t slot = static_cast<uint16_t>(ReadVarint(&cursor));
+    uint64_t num = ReadVarint(&cursor);
+    uint64_t prev = 0;
+    for (uint64_t j = 0; j < num; ++j) {
+      uint64_t zigzag = ReadVarint(&cursor);
+      prev += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+      uint64_func(slot, prev);
+    }
+  }
+  group_num = ReadVarint(&cursor);
+  for (uint64_t i = 0; i < group_num; ++i) {
+    uint16_t slot = static_cast<uint16_t>(ReadVarint(&cursor));
+    uint64_t num = ReadVarint(&cursor);
+    for (uint64_t j = 0; j < num; ++j) {
+      float value;
+      memcpy(&value, cursor, sizeof(float));
+      cursor += sizeof(float);
+      float_func(slot, value);
+    }
+  }
+  CHECK(cursor == end) << "broken compact record";
+}
+
 struct RecordCandidate {
   std::string ins_id_;
   std::unordered_multimap<uint16_t, FeatureKey> feas;
@@ -514,6 +781,10 @@ paddle::framework::Archive<AR>& operator<<(paddle::framework::Archive<AR>& ar,
   ar << r.uint64_feasigns_;
   ar << r.float_feasigns_;
   ar << r.ins_id_;
+  ar << r.compact_size_;
+  if (r.compact_size_ != 0) {
+    ar.Write(r.compact_data_, r.compact_size_);
+  }
   return ar;
 }
 
@@ -523,6 +794,16 @@ paddle::framework::Archive<AR>& operator>>(paddle::framework::Archive<AR>& ar,
   ar >> r.uint64_feasigns_;
   ar >> r.float_feasigns_;
   ar >> r.ins_id_;
+  ar >> r.compact_size_;
+  if (r.compact_size_ != 0) {
+    r.compact_block_.reset(new char[r.compact_size_],
+                           std::default_delete<char[]>());
+    ar.Read(r.compact_block_.get(), r.compact_size_);
+    r.compact_data_ = r.compact_block_.get();
+  } else {
+    r.compact_block_ = nullptr;
+    r.compact_data_ = nullptr;
+  }
   return ar;
 }
 
@@ -550,13 +831,57 @@ class MultiSlotDataFeed
 class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
  public:
   MultiSlotInMemoryDataFeed() {}
-  virtual ~MultiSlotInMemoryDataFeed() {}
+  virtual ~MultiSlotInMemoryDataFeed() { StopPrefetch(); }
   virtual void Init(const DataFeedDesc& data_feed_desc);
+  virtual void SetRecordArena(RecordArena* arena) {
+    compact_encoder_.SetArena(arena);
+  }
 
  protected:
   virtual bool ParseOneInstance(Record* instance);
   virtual bool ParseOneInstanceFromPipe(Record* instance);
   virtual void PutToFeedVec(const std::vector<Record>& ins_vec);
+  virtual void CompactInstance(Record* instance);
+  void ClearInstance(Record* instance);
+
+  CompactRecordEncoder compact_encoder_;
+  InstanceFilter instance_filter_;
+};
+
+// This DataFeed loads the binary slot-columnar format written by
+// ConvertTextFile() instead of tokenizing text lines. A file consists of a
+// header and a sequence of blocks:
+//   header: magic(4) version(u32) flags(u32) slot_num(u32)
+//           [type(u8) name_len(u32) name]*
+//   block:  ins_num(u32) payload_bytes(u64) payload
+//   payload: for each slot: len(u32) * ins_num, then all values of the slot
+//            (uint64 or float), followed by the ins_id/content strings if
+//            they are flagged in the header.
+// Each block is bulk read and decoded directly into Records, so no text
+// parsing is done while loading a pass.
+class MultiSlotBinaryInMemoryDataFeed : public MultiSlotInMemoryDataFeed {
+ public:
+  MultiSlotBinaryInMemoryDataFeed() {}
+  virtual ~MultiSlotBinaryInMemoryDataFeed() {}
+  virtual void LoadIntoMemory();
+  // Parse a text file with the slot layout of this DataFeed and write it to
+  // dst in binary format, block_size instances per block.
+  void ConvertTextFile(const std::string& src, const std::string& dst,
+                       size_t block_size = 1024);
+
+ protected:
+  struct BinarySlotInfo {
+    char type;
+    // -1: the slot is not used by this DataFeed
+    int use_index;
+  };
+  bool ReadBinaryHeader(FILE* fp, std::vector<BinarySlotInfo>* slots,
+                        uint32_t* flags);
+  bool ReadBinaryBlock(FILE* fp, const std::vector<BinarySlotInfo>& slots,
+                       uint32_t flags, std::vector<char>* buffer,
+                       std::vector<Record>* records);
+  void WriteBinaryBlock(FILE* fp, const std::vector<Record>& records,
+                        uint32_t flags, std::vector<char>* buffer);
 };
 
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
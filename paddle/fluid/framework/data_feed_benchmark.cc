@@ -0,0 +1,222 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Measures the input pipeline of the MultiSlotDataset without the model:
+//
+//   data_feed_benchmark --data_feed_desc=desc.prototxt --filelist=files.txt \
+//       --thread_num=8 --channel_num=8 --in_memory --shuffle
+//
+// The in-memory pipeline is timed by the stages of parsing the files into
+// memory, shuffling and assembling the batches. The streaming one parses and
+// assembles at the same time, whose time of Next() includes waiting for the
+// parser thread, and its difference from the in-memory one is the wait.
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <fstream>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "google/protobuf/text_format.h"
+#include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/data_set.h"
+#include "paddle/fluid/framework/dataset_factory.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/timer.h"
+#include "paddle/fluid/string/printf.h"
+
+DEFINE_string(data_feed_desc, "",
+              "The DataFeedDesc in the protobuf text format.");
+DEFINE_string(filelist, "", "The file listing the data files line by line.");
+DEFINE_int32(thread_num, 1, "The number of the readers.");
+DEFINE_int32(channel_num, 1,
+             "The number of the channels of the in-memory dataset, no more "
+             "than thread_num.");
+DEFINE_bool(in_memory, false,
+            "Load the files into memory by MultiSlotInMemoryDataFeed before "
+            "reading the batches, or stream them by MultiSlotDataFeed.");
+DEFINE_bool(shuffle, false, "Shuffle the in-memory dataset locally.");
+DEFINE_int32(repeat, 1, "The number of the epochs to read.");
+
+namespace paddle {
+namespace framework {
+
+static std::string ReadFile(const std::string& filename) {
+  std::ifstream fin(filename);
+  PADDLE_ENFORCE_EQ(
+      fin.good(), true,
+      platform::errors::NotFound("Cannot open the file %s.", filename));
+  return std::string((std::istreambuf_iterator<char>(fin)),
+                     std::istreambuf_iterator<char>());
+}
+
+static std::vector<std::string> ReadFileList(const std::string& filename) {
+  std::ifstream fin(filename);
+  PADDLE_ENFORCE_EQ(
+      fin.good(), true,
+      platform::errors::NotFound("Cannot open the file %s.", filename));
+  std::vector<std::string> filelist;
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (!line.empty()) filelist.push_back(line);
+  }
+  return filelist;
+}
+
+static int64_t FileBytes(const std::vector<std::string>& filelist) {
+  int64_t bytes = 0;
+  for (auto& filename : filelist) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) == 0) bytes += st.st_size;
+  }
+  return bytes;
+}
+
+static std::string Rate(double num, double sec, const char* unit) {
+  return sec > 0 ? string::Sprintf("%.1f %s/s", num / sec, unit) : "-";
+}
+
+struct ReaderStats {
+  int64_t batches{0};
+  int64_t instances{0};
+  // the time in Next(), which assembles the batches into the feed variables
+  double next_sec{0};
+};
+
+// Reads the batches of all the readers, each by its own thread as the
+// trainers do, and sums their stats.
+static ReaderStats ReadBatches(Dataset* dataset) {
+  auto readers = dataset->GetReaders();
+  std::vector<std::future<ReaderStats>> results;
+  for (auto* reader : readers) {
+    results.emplace_back(std::async(std::launch::async, [reader] {
+      Scope scope;
+      for (auto& name : reader->GetUseSlotAlias()) {
+        reader->AddFeedVar(scope.Var(name), name);
+      }
+      ReaderStats stats;
+      platform::Timer timer;
+      reader->Start();
+      timer.Start();
+      for (int size = reader->Next(); size > 0; size = reader->Next()) {
+        timer.Pause();
+        ++stats.batches;
+        stats.instances += size;
+        timer.Resume();
+      }
+      timer.Pause();
+      stats.next_sec = timer.ElapsedSec();
+      return stats;
+    }));
+  }
+  ReaderStats total;
+  for (auto& result : results) {
+    auto stats = result.get();
+    total.batches += stats.batches;
+    total.instances += stats.instances;
+    total.next_sec += stats.next_sec;
+  }
+  return total;
+}
+
+static void RunBenchmark() {
+  auto desc_str = ReadFile(FLAGS_data_feed_desc);
+  DataFeedDesc desc;
+  PADDLE_ENFORCE_EQ(
+      google::protobuf::TextFormat::ParseFromString(desc_str, &desc), true,
+      platform::errors::InvalidArgument("Cannot parse the DataFeedDesc %s.",
+                                        FLAGS_data_feed_desc));
+  desc.set_name(FLAGS_in_memory ? "MultiSlotInMemoryDataFeed"
+                                : "MultiSlotDataFeed");
+  google::protobuf::TextFormat::PrintToString(desc, &desc_str);
+
+  auto filelist = ReadFileList(FLAGS_filelist);
+  int64_t file_bytes = FileBytes(filelist);
+  LOG(INFO) << "Read " << filelist.size() << " files of " << file_bytes
+            << " bytes by " << FLAGS_thread_num << " threads with "
+            << desc.name() << ", batch size " << desc.batch_size();
+
+  auto dataset = DatasetFactory::CreateDataset("MultiSlotDataset");
+  dataset->SetFileList(filelist);
+  dataset->SetThreadNum(FLAGS_thread_num);
+  dataset->SetDataFeedDesc(desc_str);
+  dataset->SetChannelNum(FLAGS_channel_num);
+
+  for (int epoch = 0; epoch < FLAGS_repeat; ++epoch) {
+    platform::Timer timer;
+    if (FLAGS_in_memory) {
+      // the in-memory readers load the files before reading the batches
+      dataset->CreateChannel();
+      dataset->CreateReaders();
+      timer.Start();
+      dataset->LoadIntoMemory();
+      timer.Pause();
+      double load_sec = timer.ElapsedSec();
+      int64_t records = dataset->GetMemoryDataSize();
+      std::cout << "epoch " << epoch << " parse: " << records
+                << " instances in " << load_sec << " s, "
+                << Rate(records, load_sec, "instances") << ", "
+                << Rate(file_bytes, load_sec, "bytes") << std::endl;
+      if (FLAGS_shuffle) {
+        timer.Start();
+        dataset->LocalShuffle();
+        timer.Pause();
+        std::cout << "epoch " << epoch << " shuffle: " << timer.ElapsedSec()
+                  << " s, " << Rate(records, timer.ElapsedSec(), "instances")
+                  << std::endl;
+      }
+    }
+
+    timer.Start();
+    dataset->CreateReaders();  // created already if in memory
+    auto stats = ReadBatches(dataset.get());
+    dataset->DestroyReaders();
+    timer.Pause();
+    double read_sec = timer.ElapsedSec();
+    double next_sec_per_thread = stats.next_sec / FLAGS_thread_num;
+    std::cout << "epoch " << epoch << " batch: " << stats.batches
+              << " batches of " << stats.instances << " instances in "
+              << read_sec << " s, " << Rate(stats.batches, read_sec, "batches")
+              << ", " << Rate(stats.instances, read_sec, "instances");
+    if (!FLAGS_in_memory) {
+      std::cout << ", " << Rate(file_bytes, read_sec, "bytes");
+    }
+    std::cout << ", Next() " << next_sec_per_thread << " s per thread, "
+              << (stats.batches > 0 ? stats.next_sec * 1e6 / stats.batches : 0)
+              << " us per batch" << std::endl;
+
+    if (FLAGS_in_memory) {
+      dataset->ReleaseMemory();
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  PADDLE_ENFORCE_EQ(
+      FLAGS_data_feed_desc.empty() || FLAGS_filelist.empty(), false,
+      paddle::platform::errors::InvalidArgument(
+          "Both --data_feed_desc and --filelist should be given."));
+  paddle::framework::RunBenchmark();
+  return 0;
+}
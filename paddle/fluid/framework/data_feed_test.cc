@@ -330,3 +330,127 @@ TEST(DataFeed, MultiSlotUnitTest) {
   // GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
   // CheckIsUnorderedSame(reader_elem_set, file_elem_set);
 }
+
+TEST(DataFeed, CompactRecordEncoder) {
+  using paddle::framework::CompactRecordEncoder;
+  using paddle::framework::FeatureKey;
+  using paddle::framework::Record;
+  std::vector<Record> recs(100);
+  for (size_t i = 0; i < recs.size(); ++i) {
+    for (uint16_t slot = 0; slot < 4; ++slot) {
+      for (size_t j = 0; j < i % 5; ++j) {
+        FeatureKey key;
+        key.uint64_feasign_ = (i * 7919 + j * 104729) << (slot * 13);
+        recs[i].uint64_feasigns_.emplace_back(key, slot);
+      }
+    }
+    FeatureKey key;
+    key.float_feasign_ = i * 0.5f;
+    recs[i].float_feasigns_.emplace_back(key, 4);
+  }
+  std::vector<Record> origin = recs;
+  // a small block size makes records span several blocks
+  CompactRecordEncoder encoder(64);
+  for (auto& rec : recs) {
+    encoder.Encode(&rec);
+    EXPECT_TRUE(rec.IsCompact());
+    EXPECT_TRUE(rec.uint64_feasigns_.empty());
+  }
+  for (size_t i = 0; i < recs.size(); ++i) {
+    CompactRecordEncoder::Decode(&recs[i]);
+    EXPECT_FALSE(recs[i].IsCompact());
+    ASSERT_EQ(recs[i].uint64_feasigns_.size(),
+              origin[i].uint64_feasigns_.size());
+    for (size_t j = 0; j < origin[i].uint64_feasigns_.size(); ++j) {
+      EXPECT_EQ(recs[i].uint64_feasigns_[j].slot(),
+                origin[i].uint64_feasigns_[j].slot());
+      EXPECT_EQ(recs[i].uint64_feasigns_[j].sign().uint64_feasign_,
+                origin[i].uint64_feasigns_[j].sign().uint64_feasign_);
+    }
+    ASSERT_EQ(recs[i].float_feasigns_.size(), 1UL);
+    EXPECT_EQ(recs[i].float_feasigns_[0].slot(), 4);
+    EXPECT_EQ(recs[i].float_feasigns_[0].sign().float_feasign_, i * 0.5f);
+  }
+}
+
+TEST(DataFeed, RecordArena) {
+  using paddle::framework::CompactRecordEncoder;
+  using paddle::framework::FeatureKey;
+  using paddle::framework::Record;
+  using paddle::framework::RecordArena;
+  RecordArena arena(256);
+  CompactRecordEncoder encoder;
+  encoder.SetArena(&arena);
+  std::vector<Record> recs(50);
+  for (size_t i = 0; i < recs.size(); ++i) {
+    Record rec;
+    encoder.Recycle(&rec);
+    for (size_t j = 0; j < i; ++j) {
+      FeatureKey key;
+      key.uint64_feasign_ = i * 1000 + j;
+      rec.uint64_feasigns_.emplace_back(key, j % 3);
+    }
+    encoder.Encode(&rec);
+    EXPECT_TRUE(rec.IsCompact());
+    EXPECT_EQ(rec.compact_block_, nullptr);
+    EXPECT_EQ(rec.uint64_feasigns_.capacity(), 0UL);
+    recs[i] = std::move(rec);
+  }
+  EXPECT_GT(arena.MemorySize(), 0UL);
+  for (size_t i = 0; i < recs.size(); ++i) {
+    size_t num = 0;
+    CompactRecordEncoder::ForEach(
+        recs[i],
+        [&](uint16_t slot, uint64_t feasign) {
+          EXPECT_EQ(feasign, i * 1000 + num);
+          EXPECT_EQ(slot, num % 3);
+          ++num;
+        },
+        [](uint16_t slot, float feasign) {});
+    EXPECT_EQ(num, i);
+  }
+  recs.clear();
+  arena.Reset();
+  EXPECT_EQ(arena.MemorySize(), 0UL);
+}
+
+TEST(DataFeed, InstanceFilter) {
+  using paddle::framework::InstanceFilter;
+  paddle::framework::DataFeedDesc desc;
+  auto* tag_filter = desc.add_instance_filters();
+  tag_filter->set_slot("tag");
+  tag_filter->add_values(3);
+  tag_filter->add_values(5);
+  tag_filter->set_others_keep_rate(0.0);
+  auto* label_filter = desc.add_instance_filters();
+  label_filter->set_slot("label");
+  label_filter->add_values(0);
+  label_filter->set_keep_rate(0.5);
+  std::vector<std::string> names{"tag", "label", "feasign"};
+  std::vector<std::string> types{"uint64", "uint64", "uint64"};
+
+  InstanceFilter filter;
+  filter.Init(desc, names, types);
+  EXPECT_FALSE(filter.Empty());
+  EXPECT_TRUE(filter.HasFilter(0));
+  EXPECT_TRUE(filter.HasFilter(1));
+  EXPECT_FALSE(filter.HasFilter(2));
+
+  std::vector<uint64_t> tags{1, 5};
+  EXPECT_TRUE(filter.Keep(0, tags.data(), tags.size()));
+  tags = {1, 4};
+  EXPECT_FALSE(filter.Keep(0, tags.data(), tags.size()));
+  uint64_t label = 1;
+  EXPECT_TRUE(filter.Keep(1, &label, 1));
+  label = 0;
+  int kept = 0;
+  for (int i = 0; i < 10000; ++i) {
+    kept += filter.Keep(1, &label, 1);
+  }
+  EXPECT_GT(kept, 4000);
+  EXPECT_LT(kept, 6000);
+
+  types[0] = "float";
+  EXPECT_THROW(filter.Init(desc, names, types),
+               paddle::platform::EnforceNotMet);
+}
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/data_layout_transform.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -36,6 +37,39 @@ std::vector<int> GetAxis(const DataLayout& from, const DataLayout& to) {
   }
 }
 
+// The tile of the transpose, whose rows and columns fit in L1 cache.
+constexpr int64_t kTransposeTile = 32;
+// The number of the elements transposed by a thread.
+constexpr int64_t kTransposeNumelPerThread = 1 << 16;
+
+// Transpose the batch of rows x cols matrices tile by tile, that is
+// NCHW -> NHWC as [N, C, HW] -> [N, HW, C], and NHWC -> NCHW as
+// [N, HW, C] -> [N, C, HW].
+template <typename T>
+void BatchTranspose(const T* in, int64_t batch, int64_t rows, int64_t cols,
+                    T* out) {
+  int64_t row_tiles = (rows + kTransposeTile - 1) / kTransposeTile;
+  int64_t col_tiles = (cols + kTransposeTile - 1) / kTransposeTile;
+  int64_t num_tiles = batch * row_tiles * col_tiles;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (batch * rows * cols > kTransposeNumelPerThread)
+#endif
+  for (int64_t tile = 0; tile < num_tiles; ++tile) {
+    int64_t b = tile / (row_tiles * col_tiles);
+    int64_t row_begin = tile / col_tiles % row_tiles * kTransposeTile;
+    int64_t col_begin = tile % col_tiles * kTransposeTile;
+    int64_t row_end = std::min(row_begin + kTransposeTile, rows);
+    int64_t col_end = std::min(col_begin + kTransposeTile, cols);
+    const T* src = in + b * rows * cols;
+    T* dst = out + b * rows * cols;
+    for (int64_t r = row_begin; r < row_end; ++r) {
+      for (int64_t c = col_begin; c < col_end; ++c) {
+        dst[c * rows + r] = src[r * cols + c];
+      }
+    }
+  }
+}
+
 struct CastDataLayout {
   CastDataLayout(const platform::DeviceContext* ctx,
                  const std::vector<int>& axis, const framework::Tensor& in,
@@ -51,9 +85,18 @@ struct CastDataLayout {
     auto place = ctx_->GetPlace();
 
     if (platform::is_cpu_place(place)) {
-      operators::math::Transpose<platform::CPUDeviceContext, T, 4> trans4;
-      auto* context = static_cast<const platform::CPUDeviceContext*>(ctx_);
-      trans4(*context, in_, out_, axis_);
+      auto dims = in_.dims();
+      if (axis_ == std::vector<int>({0, 2, 3, 1})) {
+        BatchTranspose(in_.data<T>(), dims[0], dims[1], dims[2] * dims[3],
+                       out_->data<T>());
+      } else if (axis_ == std::vector<int>({0, 3, 1, 2})) {
+        BatchTranspose(in_.data<T>(), dims[0], dims[1] * dims[2], dims[3],
+                       out_->data<T>());
+      } else {
+        operators::math::Transpose<platform::CPUDeviceContext, T, 4> trans4;
+        auto* context = static_cast<const platform::CPUDeviceContext*>(ctx_);
+        trans4(*context, in_, out_, axis_);
+      }
     } else {
       PADDLE_THROW("Unsupport CPU <-> GPU!");
     }
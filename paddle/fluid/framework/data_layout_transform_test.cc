@@ -43,3 +43,45 @@ TEST(DataTransform, DataLayoutFunction) {
   EXPECT_TRUE(in.layout() == paddle::framework::DataLayout::kNHWC);
   EXPECT_TRUE(in.dims() == paddle::framework::make_ddim({2, 3, 1, 2}));
 }
+
+TEST(DataTransform, DataLayoutValues) {
+  auto place = paddle::platform::CPUPlace();
+  auto kernel_nhwc = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::FP32, place,
+      paddle::framework::DataLayout::kNHWC,
+      paddle::framework::LibraryType::kPlain);
+  auto kernel_nchw = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::FP32, place,
+      paddle::framework::DataLayout::kNCHW,
+      paddle::framework::LibraryType::kPlain);
+
+  // the sizes are not multiples of the tile
+  const int n = 2, c = 35, h = 7, w = 9;
+  paddle::framework::Tensor in;
+  float* in_data =
+      in.mutable_data<float>(paddle::framework::make_ddim({n, c, h, w}), place);
+  for (int i = 0; i < n * c * h * w; ++i) {
+    in_data[i] = static_cast<float>(i);
+  }
+
+  paddle::framework::Tensor nhwc;
+  paddle::framework::TransDataLayout(kernel_nchw, kernel_nhwc, in, &nhwc);
+  EXPECT_TRUE(nhwc.dims() == paddle::framework::make_ddim({n, h, w, c}));
+  const float* nhwc_data = nhwc.data<float>();
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < c; ++j) {
+      for (int k = 0; k < h * w; ++k) {
+        EXPECT_EQ(nhwc_data[(i * h * w + k) * c + j],
+                  in_data[(i * c + j) * h * w + k]);
+      }
+    }
+  }
+
+  paddle::framework::Tensor nchw;
+  paddle::framework::TransDataLayout(kernel_nhwc, kernel_nchw, nhwc, &nchw);
+  EXPECT_TRUE(nchw.dims() == in.dims());
+  const float* nchw_data = nchw.data<float>();
+  for (int i = 0; i < n * c * h * w; ++i) {
+    EXPECT_EQ(nchw_data[i], in_data[i]);
+  }
+}
@@ -41,6 +41,10 @@ DatasetImpl<T>::DatasetImpl() {
   thread_num_ = 1;
   trainer_num_ = 1;
   channel_num_ = 1;
+  channel_shard_num_ = 1;
+  compact_record_ = false;
+  prefetch_batch_ = false;
+  preload_memory_limit_ = 0;
   file_idx_ = 0;
   cur_channel_ = 0;
   fleet_send_batch_size_ = 1024;
@@ -93,6 +97,14 @@ void DatasetImpl<T>::SetHdfsConfig(const std::string& fs_name,
   cmd += " -D fs.default.name=" + fs_name;
   cmd += " -D hadoop.job.ugi=" + fs_ugi;
   paddle::framework::hdfs_set_command(cmd);
+  paddle::framework::hdfs_set_native_config(fs_name, fs_ugi);
+}
+
+template <typename T>
+void DatasetImpl<T>::SetHdfsNativeRead(bool native_read, size_t chunk_size,
+                                       int parallelism) {
+  paddle::framework::hdfs_set_native_read(native_read, chunk_size,
+                                          parallelism);
 }
 
 template <typename T>
@@ -116,6 +128,11 @@ void DatasetImpl<T>::SetChannelNum(int channel_num) {
   channel_num_ = channel_num;
 }
 
+template <typename T>
+void DatasetImpl<T>::SetChannelShardNum(int shard_num) {
+  channel_shard_num_ = shard_num;
+}
+
 template <typename T>
 void DatasetImpl<T>::SetParseInsId(bool parse_ins_id) {
   parse_ins_id_ = parse_ins_id;
@@ -126,6 +143,16 @@ void DatasetImpl<T>::SetParseContent(bool parse_content) {
   parse_content_ = parse_content;
 }
 
+template <typename T>
+void DatasetImpl<T>::SetCompactRecord(bool compact_record) {
+  compact_record_ = compact_record;
+}
+
+template <typename T>
+void DatasetImpl<T>::SetPrefetchBatch(bool prefetch_batch) {
+  prefetch_batch_ = prefetch_batch;
+}
+
 template <typename T>
 void DatasetImpl<T>::SetMergeByInsId(int merge_size) {
   merge_by_insid_ = true;
@@ -162,6 +189,11 @@ void DatasetImpl<T>::CreateChannel() {
   if (input_channel_ == nullptr) {
     input_channel_ = paddle::framework::MakeChannel<T>();
   }
+  // all reader threads write to the input channel in LoadIntoMemory
+  size_t shard_num = channel_shard_num_ > 1 ? channel_shard_num_ : 1;
+  if (input_channel_->ShardNum() != shard_num && input_channel_->Size() == 0) {
+    input_channel_->SetShardNum(shard_num);
+  }
   if (multi_output_channel_.size() == 0) {
     multi_output_channel_.reserve(channel_num_);
     for (int i = 0; i < channel_num_; ++i) {
@@ -215,6 +247,7 @@ void DatasetImpl<T>::LoadIntoMemory() {
 template <typename T>
 void DatasetImpl<T>::PreLoadIntoMemory() {
   VLOG(3) << "DatasetImpl<T>::PreLoadIntoMemory() begin";
+  preload_memory_budget_.Reset(preload_memory_limit_);
   if (preload_thread_num_ != 0) {
     CHECK(static_cast<size_t>(preload_thread_num_) == preload_readers_.size());
     preload_threads_.clear();
@@ -227,6 +260,7 @@ void DatasetImpl<T>::PreLoadIntoMemory() {
     CHECK(static_cast<size_t>(thread_num_) == readers_.size());
     preload_threads_.clear();
     for (int64_t i = 0; i < thread_num_; ++i) {
+      readers_[i]->SetLoadMemoryBudget(&preload_memory_budget_);
       preload_threads_.push_back(std::thread(
           &paddle::framework::DataFeed::LoadIntoMemory, readers_[i].get()));
     }
@@ -237,6 +271,8 @@ void DatasetImpl<T>::PreLoadIntoMemory() {
 template <typename T>
 void DatasetImpl<T>::WaitPreLoadDone() {
   VLOG(3) << "DatasetImpl<T>::WaitPreLoadDone() begin";
+  // the pass is needed now, load the rest without the memory limit
+  preload_memory_budget_.Lift();
   for (std::thread& t : preload_threads_) {
     t.join();
   }
@@ -271,6 +307,8 @@ void DatasetImpl<T>::ReleaseMemory() {
   }
   std::vector<paddle::framework::Channel<T>>().swap(multi_consume_channel_);
   std::vector<std::shared_ptr<paddle::framework::DataFeed>>().swap(readers_);
+  // all Records are gone, so their compact feasigns are freed in bulk
+  ResetRecordArenas();
   VLOG(3) << "DatasetImpl<T>::ReleaseMemory() end";
 }
 
@@ -329,63 +367,14 @@ void DatasetImpl<T>::GlobalShuffle(int thread_num) {
   VLOG(3) << "DatasetImpl<T>::GlobalShuffle() input_channel_ size "
           << input_channel_->Size();
 
-  auto get_client_id = [this, fleet_ptr](const T& data) -> size_t {
-    if (!this->merge_by_insid_) {
-      return fleet_ptr->LocalRandomEngine()() % this->trainer_num_;
-    } else {
-      return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) %
-             this->trainer_num_;
-    }
-  };
-
-  auto global_shuffle_func = [this, get_client_id]() {
-    auto fleet_ptr = FleetWrapper::GetInstance();
-    std::vector<T> data;
-    while (this->input_channel_->Read(data)) {
-      std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
-      for (auto& t : data) {
-        auto client_id = get_client_id(t);
-        ars[client_id] << t;
-      }
-      std::vector<std::future<int32_t>> total_status;
-      std::vector<int> send_index(this->trainer_num_);
-      for (int i = 0; i < this->trainer_num_; ++i) {
-        send_index[i] = i;
-      }
-      std::shuffle(send_index.begin(), send_index.end(),
-                   fleet_ptr->LocalRandomEngine());
-      for (int index = 0; index < this->trainer_num_; ++index) {
-        int i = send_index[index];
-        if (ars[i].Length() == 0) {
-          continue;
-        }
-        std::string msg(ars[i].Buffer(), ars[i].Length());
-        auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
-        total_status.push_back(std::move(ret));
-      }
-      for (auto& t : total_status) {
-        t.wait();
-      }
-      ars.clear();
-      ars.shrink_to_fit();
-      data.clear();
-      data.shrink_to_fit();
-      // currently we find bottleneck is server not able to handle large data
-      // in time, so we can remove this sleep and set fleet_send_batch_size to
-      // 1024, and set server thread to 24.
-      if (fleet_send_sleep_seconds_ != 0) {
-        sleep(this->fleet_send_sleep_seconds_);
-      }
-    }
-  };
-
   std::vector<std::thread> global_shuffle_threads;
   if (thread_num == -1) {
     thread_num = thread_num_;
   }
   VLOG(3) << "start global shuffle threads, num = " << thread_num;
   for (int i = 0; i < thread_num; ++i) {
-    global_shuffle_threads.push_back(std::thread(global_shuffle_func));
+    global_shuffle_threads.push_back(
+        std::thread(&DatasetImpl<T>::GlobalShuffleSend, this, false));
   }
   for (std::thread& t : global_shuffle_threads) {
     t.join();
@@ -393,12 +382,118 @@ void DatasetImpl<T>::GlobalShuffle(int thread_num) {
   global_shuffle_threads.clear();
   global_shuffle_threads.shrink_to_fit();
   input_channel_->Clear();
+  // every local Record was sent as a copy, even those to this trainer
+  ResetRecordArenas();
   timeline.Pause();
   VLOG(3) << "DatasetImpl<T>::GlobalShuffle() end, cost time="
           << timeline.ElapsedSec() << " seconds";
 #endif
 }
 
+// load data into memory and global shuffle it in one pipelined pass:
+// reader threads parse files into input_channel_ while shuffle threads
+// drain it in fleet_send_batch_size_ blocks and send them to other trainers,
+// so the whole pass is never held twice in memory.
+template <typename T>
+void DatasetImpl<T>::LoadIntoMemoryAndGlobalShuffle(int thread_num) {
+#ifdef PADDLE_WITH_PSLIB
+  VLOG(3) << "DatasetImpl<T>::LoadIntoMemoryAndGlobalShuffle() begin";
+  platform::Timer timeline;
+  timeline.Start();
+  if (thread_num == -1) {
+    thread_num = thread_num_;
+  }
+  input_channel_->Open();
+  input_channel_->SetBlockSize(fleet_send_batch_size_);
+  // bound the records waiting to be sent, readers block when it is full
+  size_t origin_capacity = input_channel_->Capacity();
+  input_channel_->SetCapacity(2 * fleet_send_batch_size_ * thread_num);
+
+  VLOG(3) << "start global shuffle threads, num = " << thread_num;
+  std::vector<std::thread> global_shuffle_threads;
+  for (int i = 0; i < thread_num; ++i) {
+    global_shuffle_threads.push_back(
+        std::thread(&DatasetImpl<T>::GlobalShuffleSend, this, true));
+  }
+  std::vector<std::thread> load_threads;
+  for (int64_t i = 0; i < thread_num_; ++i) {
+    load_threads.push_back(std::thread(
+        &paddle::framework::DataFeed::LoadIntoMemory, readers_[i].get()));
+  }
+  for (std::thread& t : load_threads) {
+    t.join();
+  }
+  input_channel_->Close();
+  for (std::thread& t : global_shuffle_threads) {
+    t.join();
+  }
+  input_channel_->SetCapacity(origin_capacity);
+  input_channel_->Clear();
+  ResetRecordArenas();
+  timeline.Pause();
+  VLOG(3) << "DatasetImpl<T>::LoadIntoMemoryAndGlobalShuffle() end"
+          << ", cost time=" << timeline.ElapsedSec() << " seconds";
+#else
+  LoadIntoMemory();
+#endif
+}
+
+template <typename T>
+void DatasetImpl<T>::GlobalShuffleSend(bool shuffle_block) {
+#ifdef PADDLE_WITH_PSLIB
+  auto fleet_ptr = FleetWrapper::GetInstance();
+  auto get_client_id = [this, fleet_ptr](const T& data) -> size_t {
+    if (!this->merge_by_insid_) {
+      return fleet_ptr->LocalRandomEngine()() % trainer_num_;
+    } else {
+      return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) %
+             trainer_num_;
+    }
+  };
+
+  std::vector<T> data;
+  while (input_channel_->Read(data)) {
+    if (shuffle_block) {
+      std::shuffle(data.begin(), data.end(), fleet_ptr->LocalRandomEngine());
+    }
+    std::vector<paddle::framework::BinaryArchive> ars(trainer_num_);
+    for (auto& t : data) {
+      auto client_id = get_client_id(t);
+      ars[client_id] << t;
+    }
+    std::vector<std::future<int32_t>> total_status;
+    std::vector<int> send_index(trainer_num_);
+    for (int i = 0; i < trainer_num_; ++i) {
+      send_index[i] = i;
+    }
+    std::shuffle(send_index.begin(), send_index.end(),
+                 fleet_ptr->LocalRandomEngine());
+    for (int index = 0; index < trainer_num_; ++index) {
+      int i = send_index[index];
+      if (ars[i].Length() == 0) {
+        continue;
+      }
+      std::string msg(ars[i].Buffer(), ars[i].Length());
+      auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
+      total_status.push_back(std::move(ret));
+    }
+    for (auto& t : total_status) {
+      t.wait();
+    }
+    ars.clear();
+    ars.shrink_to_fit();
+    data.clear();
+    data.shrink_to_fit();
+    // currently we find bottleneck is server not able to handle large data
+    // in time, so we can remove this sleep and set fleet_send_batch_size to
+    // 1024, and set server thread to 24.
+    if (fleet_send_sleep_seconds_ != 0) {
+      sleep(fleet_send_sleep_seconds_);
+    }
+  }
+#endif
+}
+
 template <typename T>
 void DatasetImpl<T>::DynamicAdjustChannelNum(int channel_num,
                                              bool discard_remaining_ins) {
@@ -528,6 +623,8 @@ void DatasetImpl<T>::CreateReaders() {
     readers_[i]->SetFileList(filelist_);
     readers_[i]->SetParseInsId(parse_ins_id_);
     readers_[i]->SetParseContent(parse_content_);
+    readers_[i]->SetCompactRecord(compact_record_);
+    readers_[i]->SetPrefetchBatch(prefetch_batch_);
     if (input_channel_ != nullptr) {
       readers_[i]->SetInputChannel(input_channel_.get());
     }
@@ -545,9 +642,39 @@ void DatasetImpl<T>::CreateReaders() {
       channel_idx = 0;
     }
   }
+  SetReadersRecordArena(readers_, &record_arenas_);
   VLOG(3) << "readers size: " << readers_.size();
 }
 
+template <typename T>
+void DatasetImpl<T>::SetReadersRecordArena(
+    const std::vector<std::shared_ptr<paddle::framework::DataFeed>>& readers,
+    std::vector<std::unique_ptr<RecordArena>>* arenas) {
+  if (!compact_record_) {
+    return;
+  }
+  while (arenas->size() < readers.size()) {
+    arenas->emplace_back(new RecordArena());
+  }
+  for (size_t i = 0; i < readers.size(); ++i) {
+    readers[i]->SetRecordArena((*arenas)[i].get());
+  }
+}
+
+template <typename T>
+void DatasetImpl<T>::ResetRecordArenas() {
+  size_t memory_size = 0;
+  for (auto& arena : record_arenas_) {
+    memory_size += arena->MemorySize();
+    arena->Reset();
+  }
+  for (auto& arena : preload_record_arenas_) {
+    memory_size += arena->MemorySize();
+    arena->Reset();
+  }
+  VLOG(3) << "ResetRecordArenas, release memory size=" << memory_size;
+}
+
 template <typename T>
 void DatasetImpl<T>::DestroyReaders() {
   VLOG(3) << "Calling DestroyReaders()";
@@ -563,6 +690,16 @@ void DatasetImpl<T>::SetPreLoadThreadNum(int thread_num) {
   preload_thread_num_ = thread_num;
 }
 
+template <typename T>
+void DatasetImpl<T>::SetPreLoadMemoryLimit(int64_t limit) {
+  preload_memory_limit_ = limit;
+}
+
+template <typename T>
+int64_t DatasetImpl<T>::GetPreLoadMemorySize() {
+  return preload_memory_budget_.Used();
+}
+
 template <typename T>
 void DatasetImpl<T>::CreatePreLoadReaders() {
   VLOG(3) << "Begin CreatePreLoadReaders";
@@ -583,10 +720,13 @@ void DatasetImpl<T>::CreatePreLoadReaders() {
     preload_readers_[i]->SetFileList(filelist_);
     preload_readers_[i]->SetParseInsId(parse_ins_id_);
     preload_readers_[i]->SetParseContent(parse_content_);
+    preload_readers_[i]->SetCompactRecord(compact_record_);
     preload_readers_[i]->SetInputChannel(input_channel_.get());
     preload_readers_[i]->SetOutputChannel(nullptr);
     preload_readers_[i]->SetConsumeChannel(nullptr);
+    preload_readers_[i]->SetLoadMemoryBudget(&preload_memory_budget_);
   }
+  SetReadersRecordArena(preload_readers_, &preload_record_arenas_);
   VLOG(3) << "End CreatePreLoadReaders";
 }
 
@@ -699,6 +839,14 @@ void MultiSlotDataset::GenerateLocalTablesUnlock(int table_id, int feadim,
     this->multi_output_channel_[i]->Close();
     this->multi_output_channel_[i]->ReadAll(vec_data);
     for (size_t j = 0; j < vec_data.size(); j++) {
+      if (vec_data[j].IsCompact()) {
+        CompactRecordEncoder::ForEach(
+            vec_data[j],
+            [&task_keys, shard_num](uint16_t slot, uint64_t feasign) {
+              task_keys[feasign % shard_num].push_back(feasign);
+            },
+            [](uint16_t slot, float feasign) {});
+      }
       for (auto& feature : vec_data[j].uint64_feasigns_) {
         int shard = feature.sign().uint64_feasign_ % shard_num;
         task_keys[shard].push_back(feature.sign().uint64_feasign_);
@@ -769,6 +917,11 @@ void MultiSlotDataset::MergeByInsId() {
   recs.reserve(channel_data->Size());
   channel_data->ReadAll(recs);
   channel_data->Clear();
+  // merging works on FeatureItems, compact records are decoded here and
+  // encoded again after they are merged
+  for (auto& r : recs) {
+    CompactRecordEncoder::Decode(&r);
+  }
   std::sort(recs.begin(), recs.end(), [](const Record& a, const Record& b) {
     return a.ins_id_ < b.ins_id_;
   });
@@ -908,6 +1061,12 @@ void MultiSlotDataset::MergeByInsId() {
   VLOG(3) << "results size " << results.size();
   LOG(WARNING) << "total drop ins num: " << drop_ins_num;
   results.shrink_to_fit();
+  if (compact_record_) {
+    CompactRecordEncoder encoder;
+    for (auto& r : results) {
+      encoder.Encode(&r);
+    }
+  }
 
   auto fleet_ptr = FleetWrapper::GetInstance();
   std::shuffle(results.begin(), results.end(), fleet_ptr->LocalRandomEngine());
@@ -1041,6 +1200,10 @@ void MultiSlotDataset::SlotsShuffle(
         }
       }
     }
+    // slots shuffle works on FeatureItems, so original data is kept decoded
+    for (auto& rec : slots_shuffle_original_data_) {
+      CompactRecordEncoder::Decode(&rec);
+    }
   } else {
     // if already have original data for slots shuffle, clear channel
     input_channel_->Clear();
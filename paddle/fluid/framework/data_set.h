@@ -55,6 +55,10 @@ class Dataset {
   // set fs name and ugi
   virtual void SetHdfsConfig(const std::string& fs_name,
                              const std::string& fs_ugi) = 0;
+  // read hdfs files through libhdfs with parallel range reads instead of
+  // the hdfs command
+  virtual void SetHdfsNativeRead(bool native_read, size_t chunk_size,
+                                 int parallelism) = 0;
   // set customized download command, such as using afs api
   virtual void SetDownloadCmd(const std::string& download_cmd) = 0;
   // set data fedd desc, which contains:
@@ -62,6 +66,12 @@ class Dataset {
   virtual void SetDataFeedDesc(const std::string& data_feed_desc_str) = 0;
   // set channel num
   virtual void SetChannelNum(int channel_num) = 0;
+  // set shard num of the input channel, see ChannelObject::SetShardNum
+  virtual void SetChannelShardNum(int shard_num) = 0;
+  // set if records are held in compact format, see CompactRecordEncoder
+  virtual void SetCompactRecord(bool compact_record) = 0;
+  // set if readers build the feed tensors of the next batch in advance
+  virtual void SetPrefetchBatch(bool prefetch_batch) = 0;
   // set parse ins id
   virtual void SetParseInsId(bool parse_ins_id) = 0;
   virtual void SetParseContent(bool parse_content) = 0;
@@ -105,6 +115,9 @@ class Dataset {
   virtual void LocalShuffle() = 0;
   // global shuffle data
   virtual void GlobalShuffle(int thread_num = -1) = 0;
+  // load all data into memory and global shuffle it at the same time,
+  // records are sent to their destination trainer while files are parsed
+  virtual void LoadIntoMemoryAndGlobalShuffle(int thread_num = -1) = 0;
   // for slots shuffle
   virtual void SlotsShuffle(const std::set<std::string>& slots_to_replace) = 0;
   virtual void GetRandomData(const std::set<uint16_t>& slots_to_replace,
@@ -128,6 +141,11 @@ class Dataset {
   virtual void CreatePreLoadReaders() = 0;
   // destroy preload readers after prelaod done
   virtual void DestroyPreLoadReaders() = 0;
+  // set the memory limit in bytes of the records preloaded in background,
+  // preload readers block when it is reached until WaitPreLoadDone()
+  virtual void SetPreLoadMemoryLimit(int64_t limit) = 0;
+  // get the memory in bytes of the records preloaded so far
+  virtual int64_t GetPreLoadMemorySize() = 0;
   // set preload thread num
   virtual void SetPreLoadThreadNum(int thread_num) = 0;
   // seperate train thread and dataset thread
@@ -156,9 +174,14 @@ class DatasetImpl : public Dataset {
   virtual void SetFleetSendBatchSize(int64_t size);
   virtual void SetHdfsConfig(const std::string& fs_name,
                              const std::string& fs_ugi);
+  virtual void SetHdfsNativeRead(bool native_read, size_t chunk_size,
+                                 int parallelism);
   virtual void SetDownloadCmd(const std::string& download_cmd);
   virtual void SetDataFeedDesc(const std::string& data_feed_desc_str);
   virtual void SetChannelNum(int channel_num);
+  virtual void SetChannelShardNum(int shard_num);
+  virtual void SetCompactRecord(bool compact_record);
+  virtual void SetPrefetchBatch(bool prefetch_batch);
   virtual void SetParseInsId(bool parse_ins_id);
   virtual void SetParseContent(bool parse_content);
   virtual void SetMergeByInsId(int merge_size);
@@ -186,6 +209,7 @@ class DatasetImpl : public Dataset {
   virtual void ReleaseMemory();
   virtual void LocalShuffle();
   virtual void GlobalShuffle(int thread_num = -1);
+  virtual void LoadIntoMemoryAndGlobalShuffle(int thread_num = -1);
   virtual void SlotsShuffle(const std::set<std::string>& slots_to_replace) {}
   virtual void GetRandomData(const std::set<uint16_t>& slots_to_replace,
                              std::vector<Record>* result) {}
@@ -202,6 +226,8 @@ class DatasetImpl : public Dataset {
   virtual void CreatePreLoadReaders();
   virtual void DestroyPreLoadReaders();
   virtual void SetPreLoadThreadNum(int thread_num);
+  virtual void SetPreLoadMemoryLimit(int64_t limit);
+  virtual int64_t GetPreLoadMemorySize();
   virtual void DynamicAdjustChannelNum(int channel_num,
                                        bool discard_remaining_ins = false);
   virtual void DynamicAdjustReadersNum(int thread_num);
@@ -210,10 +236,27 @@ class DatasetImpl : public Dataset {
  protected:
   virtual int ReceiveFromClient(int msg_type, int client_id,
                                 const std::string& msg);
+  // read blocks from input_channel_ until it is closed and empty, and send
+  // each record to its destination trainer. if shuffle_block is true, every
+  // block is shuffled locally before sending.
+  void GlobalShuffleSend(bool shuffle_block);
+  // give each reader its own arena in compact record mode
+  void SetReadersRecordArena(
+      const std::vector<std::shared_ptr<paddle::framework::DataFeed>>& readers,
+      std::vector<std::unique_ptr<RecordArena>>* arenas);
+  // free the memory of all Records parsed by readers at once
+  void ResetRecordArenas();
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers_;
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> preload_readers_;
   paddle::framework::Channel<T> input_channel_;
   int channel_num_;
+  int channel_shard_num_;
+  bool compact_record_;
+  bool prefetch_batch_;
+  // arenas for the compact Records loaded by readers_ and preload_readers_,
+  // they are reset when the pass is released
+  std::vector<std::unique_ptr<RecordArena>> record_arenas_;
+  std::vector<std::unique_ptr<RecordArena>> preload_record_arenas_;
   std::vector<paddle::framework::Channel<T>> multi_output_channel_;
   std::vector<paddle::framework::Channel<T>> multi_consume_channel_;
   std::vector<std::unordered_set<uint64_t>> local_tables_;
@@ -242,6 +285,8 @@ class DatasetImpl : public Dataset {
   bool slots_shuffle_fea_eval_ = false;
   bool gen_uni_feasigns_ = false;
   int preload_thread_num_;
+  int64_t preload_memory_limit_;
+  LoadMemoryBudget preload_memory_budget_;
   std::mutex global_index_mutex_;
   int64_t global_index_ = 0;
   std::vector<std::shared_ptr<ThreadPool>> consume_task_pool_;
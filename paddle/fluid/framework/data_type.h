@@ -16,6 +16,7 @@ limitations under the License. */
 #include <string>
 #include <typeindex>
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/float16.h"
 
@@ -45,7 +46,8 @@ struct DataTypeTrait<void> {
   _ForEachDataTypeHelper_(callback, bool, BOOL);                        \
   _ForEachDataTypeHelper_(callback, uint8_t, UINT8);                    \
   _ForEachDataTypeHelper_(callback, int16_t, INT16);                    \
-  _ForEachDataTypeHelper_(callback, int8_t, INT8)
+  _ForEachDataTypeHelper_(callback, int8_t, INT8);                      \
+  _ForEachDataTypeHelper_(callback, ::paddle::platform::bfloat16, BF16)
 
 #define DefineDataTypeTrait(cpp_type, proto_type)                           \
   template <>                                                               \
@@ -14,6 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/data_type_transform.h"
 
+#if defined(__F16C__) && !defined(__NVCC__)
+#include <immintrin.h>
+#endif
+#include <algorithm>
+
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/platform/transform.h"
 
@@ -27,6 +32,61 @@ struct CastDataTypeFunctor {
   }
 };
 
+// The number of the elements cast by a thread on CPU.
+constexpr int64_t kCastBlockSize = 1 << 16;
+
+template <typename InType, typename OutType>
+inline void CastBlock(const InType* in, int64_t numel, OutType* out) {
+  CastDataTypeFunctor<InType, OutType> cast;
+  for (int64_t i = 0; i < numel; ++i) {
+    out[i] = cast(in[i]);
+  }
+}
+
+#if defined(__F16C__) && !defined(__NVCC__)
+// Convert 8 elements per instruction, with the same rounding as float16.
+template <>
+inline void CastBlock<float, platform::float16>(const float* in,
+                                                int64_t numel,
+                                                platform::float16* out) {
+  int64_t i = 0;
+  for (; i + 8 <= numel; i += 8) {
+    __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), 0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), half);
+  }
+  for (; i < numel; ++i) {
+    out[i] = static_cast<platform::float16>(in[i]);
+  }
+}
+
+template <>
+inline void CastBlock<platform::float16, float>(const platform::float16* in,
+                                                int64_t numel, float* out) {
+  int64_t i = 0;
+  for (; i + 8 <= numel; i += 8) {
+    __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm256_storeu_ps(out + i, _mm256_cvtph_ps(half));
+  }
+  for (; i < numel; ++i) {
+    out[i] = static_cast<float>(in[i]);
+  }
+}
+#endif
+
+// Cast the blocks of the large tensors in parallel.
+template <typename InType, typename OutType>
+void CPUCastDataType(const InType* in, int64_t numel, OutType* out) {
+  int64_t num_blocks = (numel + kCastBlockSize - 1) / kCastBlockSize;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_blocks > 1)
+#endif
+  for (int64_t i = 0; i < num_blocks; ++i) {
+    int64_t begin = i * kCastBlockSize;
+    CastBlock(in + begin, std::min(kCastBlockSize, numel - begin),
+              out + begin);
+  }
+}
+
 template <typename InType>
 struct CastDataType {
   CastDataType(const framework::Tensor& in, framework::Tensor* out,
@@ -39,19 +99,15 @@ struct CastDataType {
   template <typename OutType>
   void apply() {
     auto* in_begin = in_.data<InType>();
-    auto* in_end = in_begin + in_.numel();
     auto* out_begin = out_->mutable_data<OutType>(in_.place());
 
     if (platform::is_cpu_place(in_.place())) {
-      platform::Transform<platform::CPUDeviceContext> trans;
-      auto* context = static_cast<const platform::CPUDeviceContext*>(ctx_);
-      trans(*context, in_begin, in_end, out_begin,
-            CastDataTypeFunctor<InType, OutType>());
+      CPUCastDataType(in_begin, in_.numel(), out_begin);
 #ifdef __NVCC__
     } else if (platform::is_gpu_place(in_.place())) {
       platform::Transform<platform::CUDADeviceContext> trans;
       auto* context = static_cast<const platform::CUDADeviceContext*>(ctx_);
-      trans(*context, in_begin, in_end, out_begin,
+      trans(*context, in_begin, in_begin + in_.numel(), out_begin,
             CastDataTypeFunctor<InType, OutType>());
       context->Wait();
 #endif
@@ -76,6 +132,10 @@ void TransDataType(const OpKernelType& kernel_type_for_var,
       framework::VisitDataType(dst_type,
                                CastDataType<platform::float16>(in, out, ctx));
       break;
+    case proto::VarType::BF16:
+      framework::VisitDataType(dst_type,
+                               CastDataType<platform::bfloat16>(in, out, ctx));
+      break;
     case proto::VarType::FP32:
       framework::VisitDataType(dst_type, CastDataType<float>(in, out, ctx));
       break;
@@ -92,10 +152,13 @@ void TransDataType(const OpKernelType& kernel_type_for_var,
       framework::VisitDataType(dst_type, CastDataType<bool>(in, out, ctx));
       break;
     case proto::VarType::INT16:
-      framework::VisitDataType(dst_type, CastDataType<bool>(in, out, ctx));
+      framework::VisitDataType(dst_type, CastDataType<int16_t>(in, out, ctx));
       break;
     case proto::VarType::UINT8:
-      framework::VisitDataType(dst_type, CastDataType<bool>(in, out, ctx));
+      framework::VisitDataType(dst_type, CastDataType<uint8_t>(in, out, ctx));
+      break;
+    case proto::VarType::INT8:
+      framework::VisitDataType(dst_type, CastDataType<int8_t>(in, out, ctx));
       break;
     default:
       PADDLE_THROW("Not support type %d", src_type);
@@ -190,3 +190,54 @@ TEST(DataTypeTransform, CPUTransform) {
     }
   }
 }
+
+TEST(DataTypeTransform, CPUTransformLarge) {
+  auto place = paddle::platform::CPUPlace();
+  auto kernel_fp16 = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::FP16, place,
+      paddle::framework::DataLayout::kAnyLayout,
+      paddle::framework::LibraryType::kPlain);
+  auto kernel_fp32 = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::FP32, place,
+      paddle::framework::DataLayout::kAnyLayout,
+      paddle::framework::LibraryType::kPlain);
+  auto kernel_int16 = paddle::framework::OpKernelType(
+      paddle::framework::proto::VarType::INT16, place,
+      paddle::framework::DataLayout::kAnyLayout,
+      paddle::framework::LibraryType::kPlain);
+
+  // more than a block cast by a thread, and not a multiple of the vector
+  int data_number = (1 << 17) + 3;
+  paddle::framework::Tensor in;
+  paddle::framework::Tensor out;
+  float* in_data = in.mutable_data<float>(
+      paddle::framework::make_ddim({data_number}), place);
+  for (int i = 0; i < data_number; ++i) {
+    in_data[i] = (i % 4096 - 2048) * 0.37f;
+  }
+
+  paddle::framework::TransDataType(kernel_fp32, kernel_fp16, in, &out);
+  auto* out_data = out.data<paddle::platform::float16>();
+  for (int i = 0; i < data_number; ++i) {
+    ASSERT_EQ(out_data[i].x,
+              static_cast<paddle::platform::float16>(in_data[i]).x);
+  }
+
+  paddle::framework::Tensor back;
+  paddle::framework::TransDataType(kernel_fp16, kernel_fp32, out, &back);
+  auto* back_data = back.data<float>();
+  for (int i = 0; i < data_number; ++i) {
+    ASSERT_EQ(back_data[i], static_cast<float>(out_data[i]));
+  }
+
+  paddle::framework::TransDataType(kernel_fp32, kernel_int16, in, &out);
+  auto* int16_data = out.data<int16_t>();
+  for (int i = 0; i < data_number; ++i) {
+    ASSERT_EQ(int16_data[i], static_cast<int16_t>(in_data[i]));
+  }
+  paddle::framework::TransDataType(kernel_int16, kernel_fp32, out, &back);
+  back_data = back.data<float>();
+  for (int i = 0; i < data_number; ++i) {
+    ASSERT_EQ(back_data[i], static_cast<float>(int16_data[i]));
+  }
+}
@@ -16,6 +16,7 @@
 #include "paddle/fluid/framework/details/container_cast.h"
 #include "paddle/fluid/framework/details/reduce_and_gather.h"
 #include "paddle/fluid/framework/details/variable_visitor.h"
+#include "paddle/fluid/framework/fleet/gloo_wrapper.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/profiler.h"
@@ -28,6 +29,22 @@ namespace paddle {
 namespace framework {
 namespace details {
 
+// Sum the reduced buffer of the places of all the trainers on CPU.
+struct GlooAllReduceFunctor {
+  GlooAllReduceFunctor(GlooWrapper *gloo, void *data, int64_t numel)
+      : gloo_(gloo), data_(data), numel_(numel) {}
+
+  template <typename T>
+  void apply() const {
+    gloo_->AllReduceDense(static_cast<T *>(data_),
+                          static_cast<size_t>(numel_));
+  }
+
+  GlooWrapper *gloo_;
+  void *data_;
+  int64_t numel_;
+};
+
 #if defined(PADDLE_WITH_NCCL)
 AllReduceOpHandle::AllReduceOpHandle(ir::Node *node,
                                      const std::vector<Scope *> &local_scopes,
@@ -132,6 +149,24 @@ void AllReduceOpHandle::AllReduceFunc(
         NCCLAllReduce(p, buffer, buffer, numel, nccl_dtype, ncclSum);
       });
     }
+    std::unique_ptr<platform::RecordCommEvent> comm_event;
+    if (platform::IsProfileEnabled()) {
+      auto *run_ctxs =
+          nccl_ctxs_->GetRunEnvNCCLCtx(run_order_, use_hierarchical_allreduce_);
+      std::vector<cudaStream_t> streams;
+      for (auto &p : places) {
+        int dev_id = boost::get<platform::CUDAPlace>(p).device;
+        streams.emplace_back(run_ctxs->at(dev_id).stream());
+      }
+      // the ranks of all the trainers, which are in the flat communicator
+      int nranks = 0;
+      auto *flat_ctxs = nccl_ctxs_->GetFlatCtx(run_order_);
+      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclCommCount(
+          flat_ctxs->contexts_.begin()->second.comm(), &nranks));
+      comm_event.reset(new platform::RecordCommEvent(
+          Name(), use_hierarchical_allreduce_ ? "hierarchical" : "ring",
+          numel * SizeOfType(dtype), nranks, places, streams));
+    }
     NCCLAllReduceFunc(all_reduce_calls);
 #else
     PADDLE_THROW("Not compiled with CUDA.");
@@ -145,6 +180,13 @@ void AllReduceOpHandle::AllReduceFunc(
     ReduceBufferData func(lod_tensor_data, trg.data<void>(), numel);
     VisitDataType(trg.type(), func);
 
+    // Then reduce trg of all the trainers when the gloo rings are created
+    auto gloo = GlooWrapper::GetInstance();
+    if (gloo->DenseRingNum() > 0) {
+      GlooAllReduceFunctor gloo_func(gloo.get(), trg.data<void>(), numel);
+      VisitDataType(trg.type(), gloo_func);
+    }
+
     for (size_t i = 1; i < local_exec_scopes_.size(); ++i) {
       auto &scope = local_exec_scopes_[i];
       auto &p = places[i];
@@ -19,12 +19,14 @@ limitations under the License. */
 #include <unordered_set>
 #include <utility>
 #include "paddle/fluid/framework/details/reduce_op_handle.h"
+#include "paddle/fluid/framework/ir/gradient_accumulate_pass.h"
 #include "paddle/fluid/framework/ir/graph.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/graph_printer.h"
 #include "paddle/fluid/framework/ir/graph_to_program_pass.h"
 #include "paddle/fluid/framework/ir/graph_viz_pass.h"
 #include "paddle/fluid/framework/ir/multi_devices_graph_pass/multi_devices_graph_pass.h"
+#include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(use_mkldnn);
 DECLARE_bool(use_ngraph);
@@ -65,6 +67,9 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     AppendOpFusePasses();
     AppendPrintGraphPass("graph_viz_pass", "_fused_graph");
 
+    AppendPassWithCheck(strategy_.gradient_accumulate_steps_ > 1,
+                        "gradient_accumulate_pass");
+
     AppendMultiDevPass();
     AppendSetReaderDeviceIndexPass();
     AppendMultiGraphOptPasses();
@@ -115,6 +120,31 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
              "mode.";
       strategy_.fuse_all_reduce_ops_ = false;
     }
+    if (strategy_.sparsify_grad_) {
+#if !defined(PADDLE_WITH_DGC)
+      LOG(WARNING) << "sparsify_grad only works when Paddle is compiled "
+                      "with DGC.";
+      strategy_.sparsify_grad_ = false;
+#endif
+      LOG_IF(WARNING, strategy_.fuse_all_reduce_ops_ == true)
+          << "fuse_all_reduce_ops doesn't work with sparsify_grad.";
+      strategy_.fuse_all_reduce_ops_ = false;
+    }
+    if (strategy_.gradient_accumulate_steps_ > 1) {
+      if (strategy_.async_mode_ || strategy_.is_distribution_) {
+        LOG(WARNING) << "gradient_accumulate_steps doesn't work under the "
+                        "async mode or the distributed mode.";
+        strategy_.gradient_accumulate_steps_ = 1;
+      }
+      LOG_IF(WARNING, strategy_.fuse_all_optimizer_ops_ == true)
+          << "fuse_all_optimizer_ops doesn't work with "
+             "gradient_accumulate_steps.";
+      strategy_.fuse_all_optimizer_ops_ = false;
+      LOG_IF(WARNING, strategy_.fuse_all_reduce_ops_ == true)
+          << "fuse_all_reduce_ops doesn't work with "
+             "gradient_accumulate_steps.";
+      strategy_.fuse_all_reduce_ops_ = false;
+    }
     if (strategy_.reduce_ == BuildStrategy::ReduceStrategy::kAllReduce) {
       LOG_IF(WARNING, strategy_.fuse_broadcast_ops_ == true)
           << "Currently, fuse_broadcast_ops only works under Reduce "
@@ -161,18 +191,39 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
         strategy_.enable_backward_optimizer_op_deps_;
     AppendPassWithCheck(append_backward_optimizer_op_deps_pass,
                         "backward_optimizer_op_deps_pass");
+
+    // the ops are reordered after the other dependencies are added, and
+    // before the memory reuse passes applied by the executor
+    AppendPassWithCheck(strategy_.enable_memory_aware_reorder_,
+                        "memory_aware_reorder_pass");
+
+    // the critical paths are computed after all the dependencies are added
+    AppendPassWithCheck(strategy_.enable_critical_path_priority_,
+                        "critical_path_priority_pass");
   }
 
   void AppendOpFusePasses() {
+    // the layout is propagated before the fusions, e.g. fuse_bn_act_pass,
+    // so that the fused ops keep the layout of the ops
+    AppendPassWithCheck(strategy_.enable_nhwc_layout_,
+                        "layout_propagation_pass");
     AppendPassWithCheck(strategy_.fuse_relu_depthwise_conv_,
                         "fuse_relu_depthwise_conv_pass");
     AppendPassWithCheck(strategy_.fuse_bn_act_ops_, "fuse_bn_act_pass");
-#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__)
+#if !defined(_WIN32) && !defined(__APPLE__)
     AppendPassWithCheck(strategy_.enable_auto_fusion_, "fusion_group_pass");
 #else
-    LOG(WARNING) << "fusion_group is not enabled for Windows/MacOS now, and "
-                    "only effective when running with CUDA GPU.";
+    LOG(WARNING) << "fusion_group is not enabled for Windows/MacOS now.";
 #endif
+    // fuse_attention_pass runs before fuse_elewise_add_act_pass, which may
+    // take the elementwise_add of the attention bias otherwise
+    AppendPassWithCheck(strategy_.fuse_attention_ops_, "fuse_attention_pass");
+    // and so does fuse_dropout_residual_layer_norm_pass for the elementwise_add
+    // of the residual
+    AppendPassWithCheck(strategy_.fuse_dropout_residual_layer_norm_ops_,
+                        "fuse_dropout_residual_layer_norm_pass");
+    AppendPassWithCheck(strategy_.fuse_fake_quant_dequant_ops_,
+                        "fuse_fake_quant_dequant_pass");
     AppendPassWithCheck(strategy_.fuse_elewise_add_act_ops_,
                         "fuse_elewise_add_act_pass");
     // for single card training, fuse_all_reduce_ops is unnecessary.
@@ -361,6 +412,9 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
     } else if (pass->Type() == "coalesce_grad_tensor_pass") {
       pass->Erase(kNRanks);
       pass->Set<size_t>(kNRanks, new size_t(nranks));
+      pass->Erase(kFuseGradBucketSizeMB);
+      pass->Set<double>(kFuseGradBucketSizeMB,
+                        new double(fuse_grad_bucket_size_mb_));
     } else if (pass->Type() == "sequential_execution_pass") {
       LOG(INFO) << "set enable_sequential_execution:"
                 << enable_sequential_execution_;
@@ -383,8 +437,10 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
       }
     } else if (pass->Type() == "fusion_group_pass") {
       pass->Set<bool>("use_gpu", new bool(use_cuda));
+    } else if (pass->Type() == "layout_propagation_pass") {
       if (!use_cuda) {
-        LOG(WARNING) << "fusion_group_pass is only supported on GPU, skipped.";
+        LOG(WARNING) << "layout_propagation_pass is only supported on "
+                        "GPU, skipped.";
         continue;
       }
     } else if (pass->Type() == "fuse_bn_act_pass") {
@@ -402,11 +458,19 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
                    "GPU, skipped.";
         continue;
       }
+    } else if (pass->Type() == "critical_path_priority_pass") {
+      pass->Erase(kOpCosts);
+      pass->Set<OpCosts>(kOpCosts, new OpCosts(op_costs_));
+    } else if (pass->Type() == "gradient_accumulate_pass") {
+      pass->Erase(ir::kGradientAccumulateSteps);
+      pass->Set<int>(ir::kGradientAccumulateSteps,
+                     new int(gradient_accumulate_steps_));
     } else if (pass->Type() == "set_reader_device_index_pass") {
       pass->Erase(kPlaces);
       pass->SetNotOwned<const std::vector<platform::Place>>(kPlaces, &places);
     }
     VLOG(1) << "Start Apply Pass " << pass->Type();
+    platform::NvtxRange nvtx_range(pass->Type());
     graph = pass->Apply(graph);
     VLOG(1) << "Finish Apply Pass " << pass->Type();
   }
@@ -422,8 +486,13 @@ USE_PASS(sync_batch_norm_pass);
 USE_PASS(fuse_relu_depthwise_conv_pass);
 USE_PASS(fuse_elewise_add_act_pass);
 USE_PASS(fuse_bn_act_pass);
+USE_PASS(fuse_attention_pass);
+USE_PASS(fuse_dropout_residual_layer_norm_pass);
+USE_PASS(fuse_fake_quant_dequant_pass);
+USE_PASS(layout_propagation_pass);
 USE_PASS(graph_viz_pass);
 USE_PASS(multi_batch_merge_pass);
+USE_PASS(gradient_accumulate_pass);
 USE_PASS(reduce_mode_multi_devices_pass);
 USE_PASS(all_reduce_mode_multi_devices_pass);
 USE_PASS(dist_multi_devices_pass);
@@ -432,6 +501,8 @@ USE_PASS(multi_devices_print_pass);
 USE_PASS(sequential_execution_pass);
 USE_PASS(all_reduce_deps_pass);
 USE_PASS(backward_optimizer_op_deps_pass);
+USE_PASS(critical_path_priority_pass);
+USE_PASS(memory_aware_reorder_pass);
 USE_PASS(modify_op_lock_and_record_event_pass);
 USE_PASS(lock_free_optimize_pass);
 USE_PASS(coalesce_grad_tensor_pass);
@@ -448,6 +519,6 @@ USE_PASS(mkldnn_placement_pass);
 #ifdef PADDLE_WITH_NGRAPH
 USE_PASS(ngraph_subgraph_pass);
 #endif
-#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__)
+#if !defined(_WIN32) && !defined(__APPLE__)
 USE_PASS(fusion_group_pass);
 #endif
@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -74,6 +75,16 @@ struct BuildStrategy {
   // all the backward ops are finished before running the optimization ops.
   // It might make the training speed of data parallelism faster.
   bool enable_backward_optimizer_op_deps_{true};
+  // Run the ready ops with the longest path to the end of the graph first,
+  // e.g. start all_reduce early, rather than in the order they get ready.
+  // The costs of the ops on the paths are taken from op_costs_ by the op
+  // types, e.g. measured by the profiler, or estimated if missing.
+  bool enable_critical_path_priority_{false};
+  std::unordered_map<std::string, double> op_costs_;
+  // Reorder the computation ops of each device to reduce the peak memory of
+  // the temporary vars, e.g. run the consumers of a large var right after
+  // its producer. The ops of a device then run one by one.
+  bool enable_memory_aware_reorder_{false};
   // TODO(dev-paddle): enable_sequential_execution depends on
   // kStaleProgramOpDescs, it is not appropriate, because kStaleProgramOpDescs
   // will be removed in the near future.
@@ -87,12 +98,28 @@ struct BuildStrategy {
   // TODO(dev-paddle): fuse_elewise_add_act_ops may cause some models have
   // cycle.
   bool fuse_bn_act_ops_{false};
+  // run the conv regions of the forward ops in NHWC, which pays off on the
+  // GPUs with the tensor cores
+  bool enable_nhwc_layout_{false};
   bool fuse_elewise_add_act_ops_{false};
+  // fuse the attention of the training graphs into fused_attention, which
+  // does not store the attention scores
+  bool fuse_attention_ops_{false};
+  // fuse dropout, elementwise_add and layer_norm of the residual blocks into
+  // fused_dropout_residual_layer_norm, which keeps the dropout mask by bits
+  bool fuse_dropout_residual_layer_norm_ops_{false};
+  // fuse the fake quantization and dequantization ops of the quantization
+  // aware training into the fake quantize-dequantize ops
+  bool fuse_fake_quant_dequant_ops_{false};
   bool enable_auto_fusion_{false};
   // Fuse_all_optimizer_ops and fuse_all_reduce_ops require that gradients
   // should not be sparse types
   boost::optional<bool> fuse_all_optimizer_ops_{false};
   boost::optional<bool> fuse_all_reduce_ops_{boost::none};
+  // If positive, fuse_all_reduce_ops groups the gradients into the buckets
+  // of at most so many MB in their producing order, rather than by layers,
+  // so the all_reduce of a bucket starts once its gradients are produced.
+  double fuse_grad_bucket_size_mb_{-1.0};
   // fuse_relu_depthwise_conv can fuse the `relu ->
   // depthwise_conv`
   bool fuse_relu_depthwise_conv_{false};
@@ -128,6 +155,25 @@ struct BuildStrategy {
   int trainer_id_{0};
   std::vector<std::string> trainers_endpoints_;
 
+  // Sparsify the dense FP32 gradients of at least grad_sparsify_min_numel_
+  // elements in the all reduce mode: each rank sends only the top-k values
+  // of its gradient plus the values unsent before. The sparsity ramps up by
+  // grad_sparsity_ from grad_sparsify_rampup_begin_step_ during
+  // grad_sparsify_rampup_step_ steps, like DGC, but without the DGC ops, so
+  // it works with any optimizer. It requires Paddle compiled with DGC.
+  bool sparsify_grad_{false};
+  std::vector<float> grad_sparsity_{0.999};
+  int64_t grad_sparsify_rampup_begin_step_{0};
+  int64_t grad_sparsify_rampup_step_{1};
+  int64_t grad_sparsify_min_numel_{16384};
+
+  // If greater than 1, the gradients of so many steps are accumulated and
+  // averaged before the parameters are updated, so that it trains as if the
+  // batch is so many times larger. The graph is not copied like
+  // multi_batch_merge_pass, and the optimize and the collective ops are only
+  // run on the last step of each accumulation.
+  int gradient_accumulate_steps_{1};
+
   // NCCL config
   size_t nccl_comm_num_{1};
   // The picture is here:
@@ -37,6 +37,10 @@ struct ExecutionStrategy {
   // This debug option.
   bool dry_run_{false};
   bool thread_barrier_{false};
+  // Only used by the kExperimental executor. Each thread runs the ready ops
+  // from its own queue and steals the ops of the other threads when idle,
+  // instead of all the threads sharing one queue.
+  bool use_work_stealing_{false};
 
   // only use with async_ssa_graph_executor
   // and pyreader with data queue
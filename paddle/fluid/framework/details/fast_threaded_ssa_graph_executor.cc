@@ -12,15 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
+#include <algorithm>
 #include <deque>
+#include <functional>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/details/fetch_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
@@ -37,9 +42,13 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
       places_(places),
       graph_(graph),
       fetch_ctxs_(places),
-      pool_(strategy.num_threads_),
+      pool_(strategy.use_work_stealing_ ? 0 : strategy.num_threads_),
       // add one more thread for generate op_deps
       prepare_pool_(1) {
+  if (strategy.use_work_stealing_) {
+    work_stealing_pool_.reset(
+        new WorkStealingThreadPool(strategy.num_threads_));
+  }
   for (auto &op : ir::FilterByNodeWrapper<OpHandleBase>(*graph_)) {
     int dep = static_cast<int>(op->NotReadyInputSize());
     op_deps_.emplace(op, dep);
@@ -48,14 +57,49 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
     }
   }
   PADDLE_ENFORCE_GT(op_deps_.size(), 0, "The graph doesn't have operators.");
+  if (strategy_.num_iteration_per_run_ > 1) {
+    bool has_read_op = false;
+    for (auto *node : graph_->Nodes()) {
+      if (node->IsOp() && node->Name() == "read") {
+        has_read_op = true;
+        break;
+      }
+    }
+    if (!has_read_op) {
+      LOG(WARNING) << "when num_iteration_per_run_ is larger then 1, the model "
+                      "should use pyreader to feed data!";
+    }
+  }
+  if (OpTimeline::IsEnabled()) {
+    timeline_.reset(new OpTimeline("FastThreadedSSAGraphExecutor"));
+  }
+  if (graph_->Has(kCriticalPathPriority)) {
+    std::stable_sort(bootstrap_ops_.begin(), bootstrap_ops_.end(),
+                     [](OpHandleBase *a, OpHandleBase *b) {
+                       return a->CriticalPathLength() > b->CriticalPathLength();
+                     });
+  }
   PrepareAtomicOpDeps();
 }
 
 FetchResultType FastThreadedSSAGraphExecutor::Run(
     const std::vector<std::string> &fetch_tensors, bool return_merged) {
+  // the op dependencies of the next iteration are prepared while running
+  // the current one, and the fetch ops are only inserted in the last one
+  for (size_t j = 1; j < strategy_.num_iteration_per_run_; ++j) {
+    RunImpl({}, return_merged);
+  }
+  return RunImpl(fetch_tensors, return_merged);
+}
+
+FetchResultType FastThreadedSSAGraphExecutor::RunImpl(
+    const std::vector<std::string> &fetch_tensors, bool return_merged) {
   VLOG(3) << "enter FastThreadedSSAGraphExecutor Run";
   std::unique_ptr<platform::RecordEvent> event(
       new platform::RecordEvent("FastThreadedSSAGraphExecutorPrepare"));
+  if (timeline_) {
+    timeline_->BeginStep();
+  }
   std::unique_ptr<std::unordered_map<OpHandleBase *, std::atomic<int>>>
       op_deps = atomic_op_deps_.get();
   PrepareAtomicOpDeps();
@@ -89,6 +133,9 @@ FetchResultType FastThreadedSSAGraphExecutor::Run(
   } else {
     traced_ops_.clear();
     remaining_ = 0;
+    if (work_stealing_pool_) {
+      work_stealing_pool_->ResetUtilization();
+    }
     auto complete_q = std::make_shared<BlockingQueue<size_t>>();
     for (auto op : bootstrap_ops_) {
       RunOpAsync(op_deps.get(), op, complete_q);
@@ -118,8 +165,19 @@ FetchResultType FastThreadedSSAGraphExecutor::Run(
       num_complete += num_comp;
     }
   }
+  if (work_stealing_pool_ && VLOG_IS_ON(3)) {
+    std::stringstream ss;
+    for (auto utilization : ThreadUtilization()) {
+      ss << " " << utilization;
+    }
+    VLOG(3) << "Thread utilization of the work-stealing scheduler:"
+            << ss.str();
+  }
   // Wait FetchOps.
   ClearFetchOp(graph_, &fetch_ops);
+  if (timeline_) {
+    timeline_->EndStep();
+  }
   return fetches;
 }
 
@@ -199,7 +257,7 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     OpHandleBase *op,
     const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
   ++remaining_;
-  this->pool_.enqueue([=] {
+  Schedule([=] {
     std::deque<OpHandleBase *> op_queue;
     op_queue.push_front(op);
 
@@ -218,14 +276,23 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
         for (auto &pending_op : output->PendingOps()) {
           std::atomic<int> &deps = op_deps->at(pending_op);
           if (deps.fetch_sub(1) != 1) continue;
+          if (timeline_) {
+            timeline_->SetReady(pending_op);
+          }
 
           // NOTE(zjl): op with highest priority should run
           // first without switching to another thread.
           if (pending_op->GetPriority() == OpHandleBase::Priority::kHighest) {
             op_queue.push_back(pending_op);
           } else {
+            // keep the op with the longest critical path on this thread,
+            // the lengths are all 0 without critical_path_priority_pass
             if (op_to_run == nullptr) {
               op_to_run = pending_op;
+            } else if (pending_op->CriticalPathLength() >
+                       op_to_run->CriticalPathLength()) {
+              RunOpAsync(op_deps, op_to_run, complete_q);
+              op_to_run = pending_op;
             } else {
               RunOpAsync(op_deps, pending_op, complete_q);
             }
@@ -242,6 +309,15 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
   });
 }
 
+void FastThreadedSSAGraphExecutor::Schedule(std::function<void()> task) {
+  // the ops pushed by a worker run on the same thread unless stolen
+  if (work_stealing_pool_) {
+    work_stealing_pool_->Push(std::move(task));
+  } else {
+    pool_.enqueue(std::move(task));
+  }
+}
+
 void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
   atomic_op_deps_ = prepare_pool_.enqueue([&] {
     auto *op_deps = new std::unordered_map<OpHandleBase *, std::atomic<int>>;
@@ -255,6 +331,13 @@ void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
 
 const ir::Graph &FastThreadedSSAGraphExecutor::Graph() const { return *graph_; }
 
+std::vector<double> FastThreadedSSAGraphExecutor::ThreadUtilization() const {
+  if (work_stealing_pool_) {
+    return work_stealing_pool_->Utilization();
+  }
+  return {};
+}
+
 void FastThreadedSSAGraphExecutor::RecordOps(OpHandleBase *op) {
   if (strategy_.num_threads_ == 1 && !dynamic_cast<FetchOpHandle *>(op)) {
     traced_ops_.emplace_back(op);
@@ -279,9 +362,13 @@ bool FastThreadedSSAGraphExecutor::RunTracedOps(
 bool FastThreadedSSAGraphExecutor::RunOpSync(OpHandleBase *op) {
   try {
     VLOG(10) << op << " " << op->Name() << " : " << op->DebugString();
+    uint64_t start_ns = timeline_ ? platform::PosixInNsec() : 0;
     if (LIKELY(!strategy_.dry_run_)) {
       op->Run(strategy_.use_cuda_);
     }
+    if (timeline_) {
+      timeline_->AddOp(op, start_ns, platform::PosixInNsec());
+    }
     VLOG(10) << op << " " << op->Name() << " Done ";
     return true;
   } catch (...) {
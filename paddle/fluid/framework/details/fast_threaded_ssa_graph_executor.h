@@ -21,7 +21,9 @@
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/details/execution_strategy.h"
+#include "paddle/fluid/framework/details/op_timeline.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
 
 namespace paddle {
 namespace framework {
@@ -40,6 +42,10 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
                       bool return_merged) override;
   const ir::Graph &Graph() const override;
 
+  // The part of the time each thread spends running ops in the last run,
+  // only reported with the work-stealing scheduler.
+  std::vector<double> ThreadUtilization() const;
+
  private:
   // Note(zcd): the ThreadPool should be placed last so that ThreadPool should
   // be destroyed first.
@@ -62,8 +68,15 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
   ::ThreadPool pool_;
   ::ThreadPool prepare_pool_;
+  std::unique_ptr<WorkStealingThreadPool> work_stealing_pool_;
 
   std::vector<OpHandleBase *> traced_ops_;
+  std::unique_ptr<OpTimeline> timeline_;
+
+  // Run one iteration. The intermediate iterations of a run with
+  // num_iteration_per_run_ > 1 fetch nothing.
+  FetchResultType RunImpl(const std::vector<std::string> &fetch_tensors,
+                          bool return_merged);
 
   bool RunOp(OpHandleBase *op,
              const std::shared_ptr<BlockingQueue<size_t>> &complete_q,
@@ -73,6 +86,8 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
                   OpHandleBase *op,
                   const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
 
+  void Schedule(std::function<void()> task);
+
   void PrepareAtomicOpDeps();
 
   inline void RecordOps(OpHandleBase *op);
@@ -16,6 +16,7 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
@@ -80,11 +81,15 @@ void FetchOpHandle::WaitAndMergeCPUTensors() const {
 
 void FetchOpHandle::RunImpl() {
   platform::RecordEvent record_event(Name());
-  WaitInputVarGenerated(platform::CPUPlace());
 
   tensors_.resize(inputs_.size());
   platform::CPUPlace cpu;
   auto &scopes = *local_exec_scopes_;
+  auto &pool = platform::DeviceContextPool::Instance();
+  // The copies from the devices are launched without blocking, so that they
+  // overlap with each other and with the work of the other devices.
+  std::vector<TensorCopyEvent> copy_events;
+  copy_events.reserve(inputs_.size());
 
   for (size_t i = 0; i < inputs_.size(); ++i) {
     auto *var_handle = static_cast<VarHandle *>(inputs_[i]);
@@ -94,11 +99,17 @@ void FetchOpHandle::RunImpl() {
                             var_handle->name());
 
     auto &t = var->Get<framework::LoDTensor>();
+    bool on_gpu = t.IsInitialized() && platform::is_gpu_place(t.place());
+    // the tensor on GPU is waited for on the stream copying it
+    auto *waited_ctx = pool.Get(on_gpu ? t.place() : cpu);
+    if (var_handle->GeneratedOp()) {
+      var_handle->GeneratedOp()->RecordWaitEventOnCtx(waited_ctx);
+    }
+
     if (t.IsInitialized() && t.numel() > 0) {
-      if (platform::is_gpu_place(t.place())) {
-#ifdef PADDLE_WITH_CUDA
-        TensorCopy(t, cpu, &tensors_[i]);
-#endif
+      if (on_gpu) {
+        copy_events.emplace_back(
+            TensorCopyAsync(t, cpu, *waited_ctx, &tensors_[i]));
       } else {
         tensors_[i].ShareDataWith(t);
       }
@@ -109,6 +120,9 @@ void FetchOpHandle::RunImpl() {
     tensors_[i].set_lod(t.lod());
   }
 
+  for (auto &event : copy_events) {
+    event.Wait();
+  }
   this->WaitAndMergeCPUTensors();
 }
 
@@ -51,6 +51,8 @@ constexpr char kGlobalScope[] = "global_scope";
 constexpr char kLocalScopes[] = "local_scopes";
 constexpr char kNCCLCtxs[] = "nccl_ctxs";
 constexpr char kUseHierarchicalAllReduce[] = "use_hierarchical_allreduce";
+// the max memory size(MB) of the buckets of the fused gradients
+constexpr char kFuseGradBucketSizeMB[] = "fuse_grad_bucket_size_mb";
 
 // aux variables to represent dependency. Useful to resolve data hazard.
 typedef std::unordered_set<VarHandleBase *> GraphDepVars;
@@ -80,6 +82,13 @@ typedef std::vector<std::vector<std::pair<std::string, std::string>>>
     GroupParamsAndGrads;
 constexpr char kGroupParamsAndDenseGrads[] = "group_params_dense_grads";
 
+// the measured costs of the op handles by their Name(), which are used by
+// critical_path_priority_pass
+typedef std::unordered_map<std::string, double> OpCosts;
+constexpr char kOpCosts[] = "op_costs";
+// set if the critical path lengths of the op handles are computed
+constexpr char kCriticalPathPriority[] = "critical_path_priority";
+
 inline bool IsOpRole(const OpDesc &op, OpRole role) {
   const auto &attrs = op.GetAttrMap();
   auto iter = attrs.find(OpProtoAndCheckerMaker::OpRoleAttrName());
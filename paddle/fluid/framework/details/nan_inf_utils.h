@@ -33,6 +33,11 @@ void CheckVarHasNanOrInf(const std::string& op_type,
 void CheckOpHasNanOrInf(const framework::OperatorBase& op,
                         const framework::Scope& scope,
                         const platform::Place& place);
+
+// Throw if NAN or INF is found by the checks of FLAGS_check_nan_inf_async on
+// the place since the last call. It is called by the executors once per step,
+// and does nothing for the places other than GPU, whose checks are synchronous.
+void CheckNanInfAsyncResults(const platform::Place& place);
 }  // namespace details
 }  // namespace framework
 }  // namespace paddle
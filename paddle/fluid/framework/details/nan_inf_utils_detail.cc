@@ -269,6 +269,13 @@ void CheckVarHasNanOrInf(const std::string& op_type,
   tensor_check<platform::CPUDeviceContext>(op_type, var_name, *tensor, place);
 }
 
+void CheckNanInfAsyncResults(const platform::Place& place) {
+  if (!platform::is_gpu_place(place)) return;
+#ifdef PADDLE_WITH_CUDA
+  CheckNanInfAsyncResultsGPU(boost::get<platform::CUDAPlace>(place));
+#endif
+}
+
 bool IsSkipOp(const framework::OperatorBase& op) {
   if (op_type_nan_inf_white_list().count(op.Type()) != 0) return true;
 
@@ -16,16 +16,39 @@
 #include "paddle/fluid/framework/details/nan_inf_utils_detail.h"
 
 #include <algorithm>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "gflags/gflags.h"
+
+DECLARE_bool(check_nan_inf_async);
+
 namespace paddle {
 namespace framework {
 namespace details {
 
 static std::once_flag init_multi_gpu_op_var_map_flag;
 
+// The state of the asynchronous checks of a device. Slot i of flags is set
+// by the kernel checking names[i] if it finds NAN or INF, and the flags are
+// read and cleared once per step by CheckNanInfAsyncResults.
+struct AsyncCheckState {
+  std::mutex mutex;
+  memory::AllocationPtr flags;
+  size_t capacity{0};
+  std::unordered_map<std::string, size_t> slots;
+  std::vector<std::string> names;
+  // whether any tensor is checked since the flags are read
+  bool dirty{false};
+};
+
+static std::vector<std::unique_ptr<AsyncCheckState>>& async_check_states() {
+  static std::vector<std::unique_ptr<AsyncCheckState>> _async_check_states;
+  return _async_check_states;
+}
+
 // lazy init
 static std::vector<std::unordered_map<std::string, memory::AllocationPtr>>&
 multi_op_var2gpu_str() {
@@ -52,6 +75,11 @@ static void InitMultiGPUOpVarMap() {
 
   multi_op_var2gpu_str().swap(tmp_multi);
   multi_op_var2gpu_str_mutex().swap(tmp_multi_mutex);
+
+  async_check_states().resize(dev_count);
+  for (auto& state : async_check_states()) {
+    state.reset(new AsyncCheckState());
+  }
 }
 
 template <typename T>
@@ -114,6 +142,59 @@ __global__ void CheckNanInfKernel(const T* value, const size_t numel,
   PrintNanInfKernel(value, numel, print_num, debug_info);
 }
 
+// Only sets the flag, without printing or trapping, so that the following
+// kernels are not affected and the flags are read once per step.
+template <typename T>
+__global__ void CheckNanInfAsyncKernel(const T* value, const size_t numel,
+                                       int* flag) {
+  const size_t tid = threadIdx.x + blockIdx.x * blockDim.x;
+  T sum = static_cast<T>(0.0);
+  for (size_t i = tid; i < numel; i += blockDim.x * gridDim.x) {
+    sum += (value[i] - value[i]);
+  }
+  if (isnan(sum) || isinf(sum)) *flag = 1;
+}
+
+template <typename T>
+static void CheckNanInfAsync(const platform::CUDADeviceContext& dev_ctx,
+                             int dev_id, const std::string& op_var,
+                             const framework::Tensor& tensor, size_t blocks,
+                             size_t threads) {
+  auto& state = *async_check_states().at(dev_id);
+  std::lock_guard<std::mutex> guard(state.mutex);
+  auto iter = state.slots.find(op_var);
+  if (iter == state.slots.end()) {
+    size_t slot = state.names.size();
+    if (slot >= state.capacity) {
+      // Only grows in the first steps of a program, so that it waits for
+      // the checks using the old flags before they are freed.
+      size_t capacity = std::max<size_t>(1024, state.capacity * 2);
+      auto flags = memory::Alloc(dev_ctx, capacity * sizeof(int));
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaMemsetAsync(flags->ptr(), 0, capacity * sizeof(int),
+                          dev_ctx.stream()),
+          platform::errors::External("Failed to clear the NAN/INF flags."));
+      if (state.flags != nullptr) {
+        PADDLE_ENFORCE_CUDA_SUCCESS(
+            cudaMemcpyAsync(flags->ptr(), state.flags->ptr(),
+                            state.capacity * sizeof(int),
+                            cudaMemcpyDeviceToDevice, dev_ctx.stream()),
+            platform::errors::External("Failed to copy the NAN/INF flags."));
+      }
+      dev_ctx.Wait();
+      state.flags = std::move(flags);
+      state.capacity = capacity;
+    }
+    iter = state.slots.emplace(op_var, slot).first;
+    state.names.push_back(op_var);
+  }
+  int* flag = reinterpret_cast<int*>(state.flags->ptr()) + iter->second;
+  // launched in the lock, since the flags may be reallocated by the others
+  CheckNanInfAsyncKernel<<<blocks, threads, 0, dev_ctx.stream()>>>(
+      tensor.data<T>(), tensor.numel(), flag);
+  state.dirty = true;
+}
+
 template <>
 template <typename T>
 void TensorCheckerVisitor<platform::CUDADeviceContext>::apply(
@@ -129,6 +210,14 @@ void TensorCheckerVisitor<platform::CUDADeviceContext>::apply(
                                    multi_op_var2gpu_str_mutex().size()));
 
   std::string op_var = "[op=" + op_type_ + "] [tensor=" + var_name_ + "]";
+  const size_t threads = 1024;
+  size_t blocks =
+      std::min(static_cast<size_t>(128),
+               static_cast<size_t>((tensor_.numel() + threads - 1) / threads));
+  if (FLAGS_check_nan_inf_async) {
+    CheckNanInfAsync<T>(*dev_ctx, dev_id, op_var, tensor_, blocks, threads);
+    return;
+  }
   char* gpu_str_ptr = NULL;
 
   {
@@ -166,10 +255,6 @@ void TensorCheckerVisitor<platform::CUDADeviceContext>::apply(
     }
   }
 
-  const size_t threads = 1024;
-  size_t blocks =
-      std::min(static_cast<size_t>(128),
-               static_cast<size_t>((tensor_.numel() + threads - 1) / threads));
   CheckNanInfKernel<<<blocks, threads, 0, dev_ctx->stream()>>>(
       tensor_.data<T>(), tensor_.numel(), print_num, gpu_str_ptr);
 }
@@ -186,6 +271,50 @@ void tensor_check<platform::CUDADeviceContext>(const std::string& op_type,
   VisitDataType(tensor.type(), vistor);
 }
 
+void CheckNanInfAsyncResultsGPU(const platform::CUDAPlace& place) {
+  std::call_once(init_multi_gpu_op_var_map_flag, InitMultiGPUOpVarMap);
+
+  PADDLE_ENFORCE_EQ(
+      place.device >= 0 && place.device < async_check_states().size(), true,
+      platform::errors::OutOfRange("GPU dev_id must >=0 and < dev_count=%d",
+                                   async_check_states().size()));
+  auto& state = *async_check_states().at(place.device);
+  std::vector<std::string> found;
+  {
+    std::lock_guard<std::mutex> guard(state.mutex);
+    if (!state.dirty) return;
+    state.dirty = false;
+
+    auto* dev_ctx = reinterpret_cast<platform::CUDADeviceContext*>(
+        platform::DeviceContextPool::Instance().Get(place));
+    std::vector<int> flags(state.names.size());
+    size_t size = flags.size() * sizeof(int);
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaMemcpyAsync(flags.data(), state.flags->ptr(), size,
+                        cudaMemcpyDeviceToHost, dev_ctx->stream()),
+        platform::errors::External("Failed to copy the NAN/INF flags."));
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaMemsetAsync(state.flags->ptr(), 0, size, dev_ctx->stream()),
+        platform::errors::External("Failed to clear the NAN/INF flags."));
+    dev_ctx->Wait();
+
+    // the slots are in the order the tensors are checked first
+    for (size_t i = 0; i < flags.size(); ++i) {
+      if (flags[i] != 0) found.push_back(state.names[i]);
+    }
+  }
+  if (found.empty()) return;
+  std::string message = found[0];
+  for (size_t i = 1; i < found.size() && i < 10; ++i) {
+    message += ", " + found[i];
+  }
+  if (found.size() > 10) message += ", ...";
+  PADDLE_THROW(platform::errors::PreconditionNotMet(
+      "===ERROR: in %s find nan or inf===, found in %d tensors on %s in the "
+      "step: %s",
+      found[0], found.size(), platform::Place(place), message));
+}
+
 }  // namespace details
 }  // namespace framework
 }  // namespace paddle
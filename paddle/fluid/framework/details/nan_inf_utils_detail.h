@@ -54,6 +54,10 @@ void tensor_check(const std::string& op_type, const std::string& var_name,
                   const framework::Tensor& tensor,
                   const platform::Place& place);
 
+#ifdef PADDLE_WITH_CUDA
+void CheckNanInfAsyncResultsGPU(const platform::CUDAPlace& place);
+#endif
+
 }  // namespace details
 }  // namespace framework
 }  // namespace paddle
@@ -79,6 +79,10 @@ void OpHandleBase::InitCUDA() {
 }
 
 void OpHandleBase::Run(bool use_cuda) {
+  if (skip_running_ != nullptr && *skip_running_) {
+    VLOG(10) << "skip running " << Name();
+    return;
+  }
 #ifdef PADDLE_WITH_CUDA
   if (events_.empty() && use_cuda && dev_ctxes_.size() > 0) {
     InitCUDA();
@@ -52,6 +52,19 @@ class OpHandleBase {
 
   virtual Priority GetPriority() const { return kNormal; }
 
+  // The cost of the longest path from the op to the end of the graph, set
+  // by critical_path_priority_pass. Among the ready ops of the same
+  // priority, the ops with longer critical paths run first.
+  double CriticalPathLength() const { return critical_path_length_; }
+
+  void SetCriticalPathLength(double length) { critical_path_length_ = length; }
+
+  // If *skip_running is true, Run returns without running the op, e.g., the
+  // optimize and collective ops between the steps of gradient accumulation.
+  void SetSkipRunning(const bool *skip_running) {
+    skip_running_ = skip_running;
+  }
+
   virtual std::string Name() const = 0;
 
   void Run(bool use_cuda);
@@ -132,6 +145,10 @@ class OpHandleBase {
 
   std::vector<Scope *> local_exec_scopes_;
 
+  double critical_path_length_{0};
+
+  const bool *skip_running_{nullptr};
+
 #ifdef PADDLE_WITH_CUDA
   std::unordered_map<int, cudaEvent_t> events_;
 #endif
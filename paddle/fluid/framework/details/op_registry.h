@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/grad_op_desc_maker.h"
 #include "paddle/fluid/framework/inplace_op_inference.h"
 #include "paddle/fluid/framework/no_need_buffer_vars_inference.h"
+#include "paddle/fluid/framework/op_cost_estimator.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/framework/operator.h"
@@ -44,6 +45,7 @@ enum OpInfoFillType {
   kInplaceOpInference = 5,
   kNoNeedBufferVarsInference = 6,
   kGradOpBaseMaker = 7,
+  kOpCostEstimator = 8,
   kUnknown = -1
 };
 
@@ -54,15 +56,16 @@ struct TypePair {
   static constexpr OpInfoFillType kFillType = kType;
 };
 
-using OpRegistryClasses = std::tuple<                                // NOLINT
-    TypePair<OperatorBase, kOperator>,                               // NOLINT
-    TypePair<OpProtoAndCheckerMaker, kOpProtoAndCheckerMaker>,       // NOLINT
-    TypePair<GradOpDescMakerBase, kGradOpDescMaker>,                 // NOLINT
-    TypePair<imperative::GradOpBaseMakerBase, kGradOpBaseMaker>,     // NOLINT
-    TypePair<VarTypeInference, kVarTypeInference>,                   // NOLINT
-    TypePair<InferShapeBase, kShapeInference>,                       // NOLINT
-    TypePair<InplaceOpInference, kInplaceOpInference>,               // NOLINT
-    TypePair<NoNeedBufferVarsInference, kNoNeedBufferVarsInference>  // NOLINT
+using OpRegistryClasses = std::tuple<                                 // NOLINT
+    TypePair<OperatorBase, kOperator>,                                // NOLINT
+    TypePair<OpProtoAndCheckerMaker, kOpProtoAndCheckerMaker>,        // NOLINT
+    TypePair<GradOpDescMakerBase, kGradOpDescMaker>,                  // NOLINT
+    TypePair<imperative::GradOpBaseMakerBase, kGradOpBaseMaker>,      // NOLINT
+    TypePair<VarTypeInference, kVarTypeInference>,                    // NOLINT
+    TypePair<InferShapeBase, kShapeInference>,                        // NOLINT
+    TypePair<InplaceOpInference, kInplaceOpInference>,                // NOLINT
+    TypePair<NoNeedBufferVarsInference, kNoNeedBufferVarsInference>,  // NOLINT
+    TypePair<OpCostEstimator, kOpCostEstimator>                       // NOLINT
     >;
 
 static constexpr int kOpRegistryClassNumber =
@@ -305,6 +308,20 @@ struct OpInfoFiller<T, kNoNeedBufferVarsInference> {
   }
 };
 
+template <typename T>
+struct OpInfoFiller<T, kOpCostEstimator> {
+  void operator()(const char* op_type, OpInfo* info) const {
+    PADDLE_ENFORCE_EQ(
+        info->estimate_cost_, nullptr,
+        platform::errors::AlreadyExists(
+            "OpCostEstimator of %s has been registered", op_type));
+    info->estimate_cost_ = [](const ExecutionContext& ctx) {
+      T estimator;
+      return estimator(ctx);
+    };
+  }
+};
+
 // A fake OpInfoFiller of void
 template <>
 struct OpInfoFiller<void, kUnknown> {
@@ -0,0 +1,190 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/op_timeline.h"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/platform/device_tracer.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_string(ssa_graph_executor_timeline_path, "",
+              "The file to append the timeline of the op handles run by "
+              "ThreadedSSAGraphExecutor and FastThreadedSSAGraphExecutor in "
+              "the chrome trace format, empty for not recording it");
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+namespace {
+
+std::string EscapeJson(const std::string &str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (auto c : str) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+    }
+    escaped.push_back(c);
+  }
+  return escaped;
+}
+
+// The file shared by all the executors, written in the JSON array format of
+// chrome trace, which allows the array not to be closed, so that the events
+// are appended step by step.
+class TimelineWriter {
+ public:
+  static TimelineWriter &Instance() {
+    static TimelineWriter writer;
+    return writer;
+  }
+
+  // The pid of the process named name in the trace.
+  int64_t Pid(const std::string &name) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = pids_.find(name);
+    if (it != pids_.end()) {
+      return it->second;
+    }
+    int64_t pid = static_cast<int64_t>(pids_.size());
+    pids_.emplace(name, pid);
+    std::stringstream ss;
+    ss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+       << ",\"tid\":0,\"args\":{\"name\":\"" << EscapeJson(name) << "\"}},\n";
+    WriteLocked(ss.str());
+    return pid;
+  }
+
+  void Write(const std::string &events) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    WriteLocked(events);
+  }
+
+ private:
+  void WriteLocked(const std::string &events) {
+    if (!out_.is_open()) {
+      out_.open(FLAGS_ssa_graph_executor_timeline_path, std::ios::out);
+      PADDLE_ENFORCE_EQ(out_.is_open(), true,
+                        platform::errors::Unavailable(
+                            "Cannot open %s to write the timeline of the SSA "
+                            "graph executors.",
+                            FLAGS_ssa_graph_executor_timeline_path));
+      out_ << "[\n";
+    }
+    out_ << events;
+    out_.flush();
+  }
+
+  std::mutex mutex_;
+  std::ofstream out_;
+  std::unordered_map<std::string, int64_t> pids_;
+};
+
+}  // namespace
+
+bool OpTimeline::IsEnabled() {
+  return !FLAGS_ssa_graph_executor_timeline_path.empty();
+}
+
+OpTimeline::OpTimeline(const std::string &executor_name) {
+  // distinguish the executors of the same type, e.g. the ones of
+  // ParallelSSAGraphExecutor
+  static std::atomic<int> timeline_num(0);
+  executor_name_ = executor_name + "#" + std::to_string(timeline_num++);
+}
+
+void OpTimeline::BeginStep() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++step_;
+  step_start_ns_ = platform::PosixInNsec();
+  ready_ns_.clear();
+  records_.clear();
+}
+
+void OpTimeline::SetReady(OpHandleBase *op) {
+  uint64_t now = platform::PosixInNsec();
+  std::lock_guard<std::mutex> guard(mutex_);
+  ready_ns_[op] = now;
+}
+
+void OpTimeline::AddOp(OpHandleBase *op, uint64_t start_ns, uint64_t end_ns) {
+  OpRecord record;
+  record.name = op->Name();
+  std::stringstream device;
+  for (auto &pair : op->DeviceContext()) {
+    if (device.tellp() > 0) {
+      device << ",";
+    }
+    device << pair.first;
+  }
+  record.device = device.str();
+  record.start_ns = start_ns;
+  record.end_ns = end_ns;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = ready_ns_.find(op);
+  record.ready_ns = it != ready_ns_.end() ? it->second : step_start_ns_;
+  record.thread_id = ThreadId();
+  records_.emplace_back(std::move(record));
+}
+
+void OpTimeline::EndStep() {
+  uint64_t step_end_ns = platform::PosixInNsec();
+  std::vector<OpRecord> records;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    records.swap(records_);
+  }
+
+  auto &writer = TimelineWriter::Instance();
+  std::stringstream ss;
+  ss << "{\"name\":\"step " << step_ << "\",\"cat\":\"Step\",\"ph\":\"X\","
+     << "\"pid\":" << writer.Pid(executor_name_ + ":steps")
+     << ",\"tid\":0,\"ts\":" << step_start_ns_
+     << ",\"dur\":" << step_end_ns - step_start_ns_ << "},\n";
+  for (auto &record : records) {
+    ss << "{\"name\":\"" << EscapeJson(record.name)
+       << "\",\"cat\":\"OpHandle\",\"ph\":\"X\",\"pid\":"
+       << writer.Pid(executor_name_ + ":" + record.device)
+       << ",\"tid\":" << record.thread_id << ",\"ts\":" << record.start_ns
+       << ",\"dur\":" << record.end_ns - record.start_ns
+       << ",\"args\":{\"step\":" << step_
+       << ",\"ready_ns\":" << record.ready_ns
+       << ",\"wait_ns\":"
+       << (record.start_ns > record.ready_ns ? record.start_ns - record.ready_ns
+                                             : 0)
+       << ",\"device\":\"" << EscapeJson(record.device) << "\"}},\n";
+  }
+  writer.Write(ss.str());
+}
+
+int64_t OpTimeline::ThreadId() {
+  auto id = std::this_thread::get_id();
+  auto it = thread_ids_.find(id);
+  if (it != thread_ids_.end()) {
+    return it->second;
+  }
+  int64_t thread_id = static_cast<int64_t>(thread_ids_.size());
+  thread_ids_.emplace(id, thread_id);
+  return thread_id;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+class OpHandleBase;
+
+/**
+ * OpTimeline records when each op handle of a step of an SSA graph executor
+ * gets ready, i.e. all its inputs are generated, when it starts and ends,
+ * and the thread and the device it runs on. The records of each step are
+ * appended to FLAGS_ssa_graph_executor_timeline_path in the chrome trace
+ * format when the step ends.
+ *
+ * The timestamps are in nanoseconds of platform::PosixInNsec, the same as
+ * the profile of DeviceTracer, so that tools/timeline.py merges the two by
+ * --executor_timeline_path.
+ */
+class OpTimeline {
+ public:
+  // Whether FLAGS_ssa_graph_executor_timeline_path is set.
+  static bool IsEnabled();
+
+  explicit OpTimeline(const std::string &executor_name);
+
+  void BeginStep();
+
+  // Called when all the inputs of op are ready. The ops not set ready in a
+  // step are regarded as ready when the step begins.
+  void SetReady(OpHandleBase *op);
+
+  // Called by the thread running op after op finishes.
+  void AddOp(OpHandleBase *op, uint64_t start_ns, uint64_t end_ns);
+
+  void EndStep();
+
+ private:
+  struct OpRecord {
+    std::string name;
+    std::string device;
+    uint64_t ready_ns;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int64_t thread_id;
+  };
+
+  int64_t ThreadId();
+
+  std::string executor_name_;
+  std::mutex mutex_;
+  int64_t step_{-1};
+  uint64_t step_start_ns_{0};
+  std::unordered_map<OpHandleBase *, uint64_t> ready_ns_;
+  std::vector<OpRecord> records_;
+  std::unordered_map<std::thread::id, int64_t> thread_ids_;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/details/scope_buffered_ssa_graph_executor.h"
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -20,7 +21,12 @@
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/platform/profiler.h"
+
+DECLARE_double(local_exe_scope_drop_memory_mb);
+DECLARE_double(local_exe_scope_drop_fragmentation);
+
 namespace paddle {
 namespace framework {
 namespace details {
@@ -38,6 +44,8 @@ ScopeBufferedSSAGraphExecutor::ScopeBufferedSSAGraphExecutor(
       places_(std::move(places)),
       scope_monitor_(places_, local_exec_scopes_) {
   PADDLE_ENFORCE_EQ(local_scopes_.size(), local_exec_scopes_.size());
+  dropped_allocated_bytes_.resize(places_.size(), 0);
+  dropped_fragmentation_.resize(places_.size(), 0);
   PrepareLocalExeScopes();
 }
 
@@ -59,7 +67,7 @@ FetchResultType ScopeBufferedSSAGraphExecutor::Run(
     }
   };
 
-  if (strategy_.num_iteration_per_drop_scope_ == 1) {
+  if (strategy_.num_iteration_per_drop_scope_ == 1 && !DropByMemory()) {
     exe_run_func();
   } else {
     scope_monitor_.Apply(exe_run_func, fetch_tensors.size() > 0);
@@ -73,10 +81,12 @@ FetchResultType ScopeBufferedSSAGraphExecutor::Run(
     }
   }
 
-  ++drop_scope_counter_;
-  if (drop_scope_counter_ == strategy_.num_iteration_per_drop_scope_ ||
-      DropScopeOrNot()) {
-    DropLocalExeScopes();
+  // the iterations of one run share the local execution scopes, and the
+  // scopes are dropped by the number of the iterations instead of the runs
+  drop_scope_counter_ += std::max<size_t>(strategy_.num_iteration_per_run_, 1);
+  auto reason = DropScopeReason();
+  if (!reason.empty()) {
+    DropLocalExeScopes(reason);
   }
 
   if (VLOG_IS_ON(5)) {
@@ -107,6 +117,52 @@ bool ScopeBufferedSSAGraphExecutor::DropScopeOrNot() const {
   return false;
 }
 
+bool ScopeBufferedSSAGraphExecutor::DropByMemory() const {
+  return FLAGS_local_exe_scope_drop_memory_mb > 0 ||
+         FLAGS_local_exe_scope_drop_fragmentation > 0;
+}
+
+std::string ScopeBufferedSSAGraphExecutor::DropScopeReason() {
+  if (!DropByMemory()) {
+    if (drop_scope_counter_ >= strategy_.num_iteration_per_drop_scope_) {
+      return "iteration";
+    }
+    return DropScopeOrNot() ? "tensor_array" : "";
+  }
+  if (DropScopeOrNot()) {
+    return "tensor_array";
+  }
+  // The memory left by the last drop is held by the variables out of the
+  // local execution scopes, which is not released by dropping them again.
+  auto limit = static_cast<size_t>(FLAGS_local_exe_scope_drop_memory_mb *
+                                   1024 * 1024);
+  for (size_t i = 0; i < places_.size(); ++i) {
+    auto stats = memory::allocation::AllocatorFacade::Instance().GetStats(
+        places_[i]);
+    if (FLAGS_local_exe_scope_drop_memory_mb > 0 &&
+        stats.allocated_bytes > limit &&
+        stats.allocated_bytes > dropped_allocated_bytes_[i]) {
+      VLOG(2) << string::HumanReadableSize(stats.allocated_bytes)
+              << " is in use on " << places_[i] << ", exceeding "
+              << "FLAGS_local_exe_scope_drop_memory_mb "
+              << FLAGS_local_exe_scope_drop_memory_mb;
+      return "memory";
+    }
+    auto fragmentation = stats.Fragmentation();
+    if (FLAGS_local_exe_scope_drop_fragmentation > 0 &&
+        fragmentation > FLAGS_local_exe_scope_drop_fragmentation &&
+        fragmentation > dropped_fragmentation_[i]) {
+      VLOG(2) << "The fragmentation of " << places_[i] << " is "
+              << fragmentation << " with "
+              << string::HumanReadableSize(stats.chunk_stats.free_bytes)
+              << " free, exceeding FLAGS_local_exe_scope_drop_fragmentation "
+              << FLAGS_local_exe_scope_drop_fragmentation;
+      return "fragmentation";
+    }
+  }
+  return "";
+}
+
 void ScopeBufferedSSAGraphExecutor::InitVariables() {
   for (auto &info : tmp_var_infos_) {
     for (auto &pair : info) {
@@ -138,8 +194,11 @@ void ScopeBufferedSSAGraphExecutor::InitVariables() {
   }
 }
 
-void ScopeBufferedSSAGraphExecutor::DropLocalExeScopes() {
-  platform::RecordEvent drop_scope_event("DropLocalExeScopes");
+void ScopeBufferedSSAGraphExecutor::DropLocalExeScopes(
+    const std::string &reason) {
+  platform::RecordEvent drop_scope_event("DropLocalExeScopes/" + reason);
+  VLOG(3) << "Drop local execution scopes by " << reason << " after "
+          << drop_scope_counter_ << " iterations";
   drop_scope_counter_ = 0;
   for (auto &p : places_) {
     platform::DeviceContextPool::Instance().Get(p)->Wait();
@@ -153,6 +212,14 @@ void ScopeBufferedSSAGraphExecutor::DropLocalExeScopes() {
     }
     VLOG(3) << "Drop local execution scope: " << local_scopes_[i];
   }
+  if (DropByMemory()) {
+    for (size_t i = 0; i < places_.size(); ++i) {
+      auto stats = memory::allocation::AllocatorFacade::Instance().GetStats(
+          places_[i]);
+      dropped_allocated_bytes_[i] = stats.allocated_bytes;
+      dropped_fragmentation_[i] = stats.Fragmentation();
+    }
+  }
 }
 
 void ScopeBufferedSSAGraphExecutor::PrepareLocalExeScopes() {
@@ -53,7 +53,8 @@ class ScopeBufferedSSAGraphExecutor : public SSAGraphExecutor {
   FetchResultType Run(const std::vector<std::string>& fetch_tensors,
                       bool return_merged) override;
 
-  void DropLocalExeScopes();
+  // The reason is recorded by the profiler and the log.
+  void DropLocalExeScopes(const std::string& reason = "requested");
 
   bool NeedCreateLocalExeScope();
 
@@ -64,6 +65,16 @@ class ScopeBufferedSSAGraphExecutor : public SSAGraphExecutor {
 
   bool DropScopeOrNot() const;
 
+  bool DropByMemory() const;
+
+  // Returns why the scopes should be dropped after a run, or empty to keep.
+  std::string DropScopeReason();
+
+  // the memory in use and the fragmentation of each place after the last
+  // drop by the memory
+  std::vector<size_t> dropped_allocated_bytes_;
+  std::vector<double> dropped_fragmentation_;
+
   size_t drop_scope_counter_{0};
   ExecutionStrategy strategy_;
   std::unique_ptr<SSAGraphExecutor> underlying_executor_;
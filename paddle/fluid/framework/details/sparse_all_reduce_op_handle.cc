@@ -57,6 +57,39 @@ SparseAllReduceOpHandle::SparseAllReduceOpHandle(
   }
 }
 
+SparseAllReduceOpHandle::SparseAllReduceOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const platform::NCCLCommunicator *ctxs,
+    const GradSparsifyConfig &sparsify_config, int nranks)
+    : AllReduceOpHandle(node, local_scopes, places, ctxs),
+      nranks_(nranks),
+      is_sparsified_(true),
+      sparsify_config_(sparsify_config) {
+  PADDLE_ENFORCE_GT(nranks_, 1,
+                    platform::errors::InvalidArgument(
+                        "The gradients are sparsified only when nranks > 1, "
+                        "but got nranks %d.",
+                        nranks_));
+  PADDLE_ENFORCE_EQ(sparsify_config_.sparsity.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "The sparsity of the gradients should not be empty."));
+  for (auto sparsity : sparsify_config_.sparsity) {
+    PADDLE_ENFORCE_EQ(sparsity > 0 && sparsity < 1, true,
+                      platform::errors::InvalidArgument(
+                          "The sparsity of the gradients should be in (0, 1), "
+                          "but got %f.",
+                          sparsity));
+  }
+  PADDLE_ENFORCE_GT(sparsify_config_.rampup_step, 0,
+                    platform::errors::InvalidArgument(
+                        "The rampup_step of the sparsity should be positive, "
+                        "but got %d.",
+                        sparsify_config_.rampup_step));
+  VLOG(1) << "Use sparsified allreduce mode"
+          << ", nranks:" << nranks_;
+}
+
 void SparseAllReduceOpHandle::RunImplEncoded() {
   platform::RecordEvent record_event(Name());
 
@@ -224,7 +257,148 @@ bool SparseAllReduceOpHandle::IsEncoded() {
   return true;
 }
 
+float SparseAllReduceOpHandle::GetSparsity(int64_t step) const {
+  auto &sparsity = sparsify_config_.sparsity;
+  step -= sparsify_config_.rampup_begin_step;
+  if (step < 0) {
+    return 0;
+  }
+  size_t idx = step * sparsity.size() / sparsify_config_.rampup_step;
+  return sparsity[std::min(idx, sparsity.size() - 1)];
+}
+
+void SparseAllReduceOpHandle::RunImplSparsified(float sparsity) {
+  platform::RecordEvent record_event(Name());
+
+  auto in_var_handles = DynamicCast<VarHandle>(this->Inputs());
+  auto out_var_handles = DynamicCast<VarHandle>(this->Outputs());
+  PADDLE_ENFORCE_EQ(
+      in_var_handles.size(), places_.size(),
+      platform::errors::InvalidArgument(
+          "The NoDummyInputSize should be equal to the number of places."));
+  PADDLE_ENFORCE_EQ(
+      in_var_handles.size(), out_var_handles.size(),
+      platform::errors::InvalidArgument(
+          "The NoDummyInputSize and NoDummyOutputSize should be equal."));
+  PADDLE_ENFORCE_NOT_NULL(nccl_ctxs_, platform::errors::InvalidArgument(
+                                          "nccl_ctxs should not be nullptr."));
+
+  std::vector<LoDTensor *> grads;
+  for (size_t i = 0; i < local_scopes_.size(); ++i) {
+    auto *grad = local_exec_scopes_[i]
+                     ->FindVar(out_var_handles[i]->name())
+                     ->GetMutable<LoDTensor>();
+    PADDLE_ENFORCE_EQ(grad->type(), proto::VarType::FP32,
+                      platform::errors::InvalidArgument(
+                          "Only the FP32 gradients can be sparsified, but %s "
+                          "is %s.",
+                          out_var_handles[i]->name(),
+                          DataTypeToString(grad->type())));
+    grads.emplace_back(grad);
+  }
+  int64_t numel = grads[0]->numel();
+  int k = std::max(static_cast<int>(numel * (1 - sparsity)), 1);
+
+  bool init_residual = residuals_.empty();
+  if (init_residual) {
+    float min_sparsity = *std::min_element(sparsify_config_.sparsity.begin(),
+                                           sparsify_config_.sparsity.end());
+    max_k_ = std::max(static_cast<int>(numel * (1 - min_sparsity)), 1);
+    for (auto &place : places_) {
+      residuals_.emplace_back(memory::Alloc(place, numel * sizeof(float)));
+      encode_buffers_.emplace_back(
+          memory::Alloc(place, 2 * max_k_ * sizeof(float)));
+      gather_buffers_.emplace_back(
+          memory::Alloc(place, 2 * max_k_ * nranks_ * sizeof(float)));
+      select_buffers_.emplace_back(memory::Alloc(
+          place, paddle::communication::dgc::get_buffer_size(max_k_)));
+    }
+  }
+  PADDLE_ENFORCE_LE(k, max_k_,
+                    platform::errors::InvalidArgument(
+                        "The k %d of the step %d is larger than the max k %d.",
+                        k, step_, max_k_));
+
+  std::vector<std::function<void()>> select_calls;
+  std::vector<std::function<void()>> all_gather_calls;
+  std::vector<std::function<void()>> sparse_reduce_calls;
+  for (size_t i = 0; i < local_scopes_.size(); ++i) {
+    auto &place = places_[i];
+    PADDLE_ENFORCE_EQ(grads[i]->numel(), numel,
+                      platform::errors::InvalidArgument(
+                          "The gradients of the places should have the same "
+                          "numel %d, but got %d.",
+                          numel, grads[i]->numel()));
+    float *grad = grads[i]->data<float>();
+    float *residual = reinterpret_cast<float *>(residuals_[i]->ptr());
+    void *encode = encode_buffers_[i]->ptr();
+    void *gather = gather_buffers_[i]->ptr();
+    void *select_buf = select_buffers_[i]->ptr();
+
+    int dev_id = boost::get<platform::CUDAPlace>(place).device;
+    auto *nccl_ctxs = nccl_ctxs_->GetRunEnvNCCLCtx(run_order_, false);
+    auto &nccl_ctx = nccl_ctxs->at(dev_id);
+    auto stream = nccl_ctx.stream();
+    auto comm = nccl_ctx.comm_;
+    int nranks = nranks_;
+
+    VLOG(10) << "numel:" << numel << ", nranks:" << nranks_
+             << ", sparsity:" << sparsity << ", k:" << k
+             << ", place:" << place;
+
+    select_calls.emplace_back([=] {
+      platform::CUDADeviceGuard guard(dev_id);
+      if (init_residual) {
+        PADDLE_ENFORCE_CUDA_SUCCESS(
+            cudaMemsetAsync(residual, 0, numel * sizeof(float), stream));
+      }
+      AccumulateGradToResidual(grad, residual, numel, stream);
+      // the selected values of the residual are set to zero
+      PADDLE_ENFORCE_EQ(paddle::communication::dgc::k_select(
+                            encode, k, residual, static_cast<int>(numel),
+                            select_buf, stream, residual),
+                        true, platform::errors::External(
+                                  "Failed to select the top %d values of "
+                                  "the %d values.",
+                                  k, numel));
+    });
+
+    all_gather_calls.emplace_back([=] {
+      PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllGather(
+          encode, gather, 2 * k, ncclFloat, comm, stream));
+    });
+
+    sparse_reduce_calls.emplace_back([=] {
+      platform::CUDADeviceGuard guard(dev_id);
+      PADDLE_ENFORCE_EQ(
+          paddle::communication::dgc::sparseReduce(
+              gather, k, grad, static_cast<int>(numel), nranks, stream),
+          true, platform::errors::External(
+                    "Failed to reduce the gathered top %d values.", k));
+    });
+  }
+
+  WaitInputVarGenerated();
+  this->RunAndRecordEvent([&] {
+    for (auto &call : select_calls) {
+      call();
+    }
+  });
+  SparseAllReduceFunc(all_gather_calls, sparse_reduce_calls);
+}
+
 void SparseAllReduceOpHandle::RunImpl() {
+  if (is_sparsified_) {
+    float sparsity = GetSparsity(step_);
+    if (sparsity > 0) {
+      RunImplSparsified(sparsity);
+    } else {
+      AllReduceOpHandle::RunImpl();
+    }
+    ++step_;
+    return;
+  }
+
   if (!IsEncoded()) {
     AllReduceOpHandle::RunImpl();
     return;
@@ -234,6 +408,7 @@ void SparseAllReduceOpHandle::RunImpl() {
 }
 
 std::string SparseAllReduceOpHandle::Name() const {
+
   return "sparse_all_reduce";
 }
 }  // namespace details
@@ -0,0 +1,41 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <algorithm>
+#include "paddle/fluid/framework/details/sparse_all_reduce_op_handle.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+__global__ void AccumulateGradToResidualKernel(float *grad, float *residual,
+                                               int64_t numel) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    residual[i] += grad[i];
+    grad[i] = 0;
+  }
+}
+
+void AccumulateGradToResidual(float *grad, float *residual, int64_t numel,
+                              cudaStream_t stream) {
+  const int threads = 512;
+  int blocks = static_cast<int>(
+      std::min<int64_t>((numel + threads - 1) / threads, 4096));
+  AccumulateGradToResidualKernel<<<blocks, threads, 0, stream>>>(
+      grad, residual, numel);
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -21,12 +21,22 @@
 #include "paddle/fluid/framework/details/dgc_const_values.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/nccl_helper.h"
 
 namespace paddle {
 namespace framework {
 namespace details {
 
+// The gradient sparsification without the DGC ops: the sparsity of the
+// gradients ramps up by the sparsity list from rampup_begin_step during
+// rampup_step steps, like DGC, and the dense all reduce is used before.
+struct GradSparsifyConfig {
+  std::vector<float> sparsity;
+  int64_t rampup_begin_step{0};
+  int64_t rampup_step{1};
+};
+
 class SparseAllReduceOpHandle : public AllReduceOpHandle {
  public:
   SparseAllReduceOpHandle(ir::Node *node,
@@ -34,6 +44,15 @@ class SparseAllReduceOpHandle : public AllReduceOpHandle {
                           const std::vector<platform::Place> &places,
                           const platform::NCCLCommunicator *ctxs,
                           bool is_encoded = false, int nranks = -1);
+  // Each rank selects the top-k values of its gradient plus the residual,
+  // i.e. the values unsent before, and the selected values of all the ranks
+  // are all gathered and summed up into the gradient.
+  SparseAllReduceOpHandle(ir::Node *node,
+                          const std::vector<Scope *> &local_scopes,
+                          const std::vector<platform::Place> &places,
+                          const platform::NCCLCommunicator *ctxs,
+                          const GradSparsifyConfig &sparsify_config,
+                          int nranks);
   std::string Name() const override;
 
  protected:
@@ -41,6 +60,8 @@ class SparseAllReduceOpHandle : public AllReduceOpHandle {
   int GetKValue(const std::string &grad_name);
   bool IsEncoded();
   void RunImplEncoded();
+  float GetSparsity(int64_t step) const;
+  void RunImplSparsified(float sparsity);
   void SparseAllReduceFunc(
       const std::vector<std::function<void()>> &all_gather_calls,
       const std::vector<std::function<void()>> &sparse_reduce_calls);
@@ -48,8 +69,23 @@ class SparseAllReduceOpHandle : public AllReduceOpHandle {
  private:
   bool is_encoded_{false};
   int nranks_{-1};
+
+  bool is_sparsified_{false};
+  GradSparsifyConfig sparsify_config_;
+  int64_t step_{0};
+  // the buffers of each place, allocated once for the max k, since they are
+  // used by the nccl streams asynchronously
+  int max_k_{0};
+  std::vector<memory::AllocationPtr> residuals_;
+  std::vector<memory::AllocationPtr> encode_buffers_;
+  std::vector<memory::AllocationPtr> gather_buffers_;
+  std::vector<memory::AllocationPtr> select_buffers_;
 };
 
+// residual += grad, and grad = 0
+void AccumulateGradToResidual(float *grad, float *residual, int64_t numel,
+                              cudaStream_t stream);
+
 }  // namespace details
 }  // namespace framework
 }  // namespace paddle
@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
+#include <algorithm>
 #include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/platform/profiler.h"
 
 #ifdef PADDLE_WITH_DISTRIBUTE
@@ -48,6 +50,9 @@ ThreadedSSAGraphExecutor::ThreadedSSAGraphExecutor(
                       "should use pyreader to feed data!";
     }
   }
+  if (OpTimeline::IsEnabled()) {
+    timeline_.reset(new OpTimeline("ThreadedSSAGraphExecutor"));
+  }
   PrepareOpDeps();
   CopyOpDeps();
 }
@@ -56,6 +61,9 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
     const std::vector<std::string> &fetch_tensors, bool return_merged) {
   std::unique_ptr<platform::RecordEvent> event(
       new platform::RecordEvent("ThreadedSSAGraphExecutorPrepare"));
+  if (timeline_) {
+    timeline_->BeginStep();
+  }
   std::unique_ptr<OpDependentData> op_deps = op_deps_futures_.get();
   CopyOpDeps();
 
@@ -97,9 +105,23 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
     }
   } else {
     traced_ops_.clear();
+    bool by_critical_path = graph_->Has(kCriticalPathPriority);
+    std::vector<OpHandleBase *> sorted_ops;
     auto run_all_ops = [&](std::unordered_set<OpHandleBase *> &set) {
-      for (auto *op : set) {
-        RunOp(ready_vars, op);
+      if (by_critical_path && set.size() > 1) {
+        // the ops are enqueued to the thread pool in the order to start
+        sorted_ops.assign(set.begin(), set.end());
+        std::sort(sorted_ops.begin(), sorted_ops.end(),
+                  [](OpHandleBase *a, OpHandleBase *b) {
+                    return a->CriticalPathLength() > b->CriticalPathLength();
+                  });
+        for (auto *op : sorted_ops) {
+          RunOp(ready_vars, op);
+        }
+      } else {
+        for (auto *op : set) {
+          RunOp(ready_vars, op);
+        }
       }
       set.clear();
     };
@@ -133,6 +155,9 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
           auto &deps = pending_ops[op];
           --deps;
           if (deps == 0) {
+            if (timeline_) {
+              timeline_->SetReady(op);
+            }
             ready_ops.insert(op);
           }
         }
@@ -143,6 +168,9 @@ inline FetchResultType ThreadedSSAGraphExecutor::RunImpl(
 
   // Wait FetchOps.
   ClearFetchOp(graph_, &fetch_ops);
+  if (timeline_) {
+    timeline_->EndStep();
+  }
 
   return fetch_data;
 }
@@ -333,9 +361,13 @@ bool ThreadedSSAGraphExecutor::RunTracedOps(
 bool ThreadedSSAGraphExecutor::RunOpSync(OpHandleBase *op) {
   try {
     VLOG(10) << op << " " << op->Name() << " : " << op->DebugString();
+    uint64_t start_ns = timeline_ ? platform::PosixInNsec() : 0;
     if (LIKELY(!strategy_.dry_run_)) {
       op->Run(strategy_.use_cuda_);
     }
+    if (timeline_) {
+      timeline_->AddOp(op, start_ns, platform::PosixInNsec());
+    }
     VLOG(10) << op << " " << op->Name() << " Done ";
     return true;
   } catch (...) {
@@ -15,6 +15,8 @@ limitations under the License. */
 #pragma once
 
 #include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <fstream>
 #include <map>
 #include <memory>
@@ -77,6 +79,9 @@ class PullDenseWorker {
   PullDenseWorker() : root_scope_(NULL) {}
   void Run();
   bool CheckUpdateParam(uint64_t table_id);
+  // whether the slowest thread has updated the table by threshold_ versions
+  // since the last pull, which requires mutex_for_version_ held
+  bool NeedUpdateUnlocked(uint64_t table_id) const;
 
  private:
   static std::shared_ptr<PullDenseWorker> s_instance_;
@@ -89,6 +94,8 @@ class PullDenseWorker {
   static std::map<uint64_t, uint64_t> last_versions_;
   static std::map<uint64_t, uint64_t> current_version_;
   static std::mutex mutex_for_version_;
+  // notified when a table needs to be pulled, or the worker stops
+  static std::condition_variable version_cond_;
   static std::map<uint64_t, std::vector<uint64_t>> training_versions_;
   static std::map<uint64_t, std::vector<std::string>> dense_value_names_;
 
@@ -134,6 +141,9 @@ class DeviceWorker {
     device_reader_->SetPlace(place);
   }
   virtual Scope* GetThreadScope() { return thread_scope_; }
+  // the NUMA node the worker places its thread scope and runs on, -1 if
+  // there is none
+  virtual void SetNumaNode(int numa_node) { numa_node_ = numa_node; }
 
  protected:
   Scope* root_scope_ = nullptr;
@@ -144,6 +154,7 @@ class DeviceWorker {
   FetchConfig fetch_config_;
   bool use_cvm_;
   bool no_cvm_;
+  int numa_node_ = -1;
 };
 
 class CPUWorkerBase : public DeviceWorker {
@@ -184,6 +195,24 @@ class HogwildWorker : public CPUWorkerBase {
   void CreateThreadOperators(const ProgramDesc& program);
   void CreateThreadScope(const ProgramDesc& program);
   virtual void DumpParam(const int batch_id);
+  // Create the thread local copies of the small params, see
+  // HogwildWorkerParameter.local_param_max_numel.
+  void CreateLocalParams(const ProgramDesc& program);
+  // Add the updates of the local params since the last merge to the root
+  // params, and reload the local params from the root params.
+  void MergeLocalParams();
+  // Called after each batch, which merges the local params periodically.
+  void MaybeMergeLocalParams();
+
+  struct LocalParam {
+    std::string name;
+    LoDTensor* root;
+    LoDTensor* local;
+    // the value of the local param at the last merge
+    LoDTensor base;
+  };
+  std::vector<LocalParam> local_params_;
+  int batches_since_merge_{0};
 
   std::vector<std::string> op_names_;
   std::vector<OperatorBase*> ops_;
@@ -205,6 +234,7 @@ class DownpourWorker : public HogwildWorker {
   DownpourWorker() {}
   virtual ~DownpourWorker() {}
   virtual void Initialize(const TrainerDesc& desc);
+  virtual void BindingDataFeedMemory();
   virtual void TrainFiles();
   virtual void TrainFilesWithProfiler();
   virtual void SetNeedDump(bool need_dump_field);
@@ -258,6 +288,21 @@ class DownpourWorker : public HogwildWorker {
   std::map<uint64_t, std::vector<std::string>> dense_value_names_;
   std::map<uint64_t, uint64_t> table_dependency_;
   std::vector<std::pair<uint64_t, uint64_t>> copy_dense_tables_;
+  // pipeline pull: the next batch is read into next_scope_, and its sparse
+  // values are pulled while the current batch is computed
+  int NextBatch();
+  void PullNextSparseAsync();
+  void SwapNextBatch();
+  bool pipeline_pull_ = false;
+  int max_push_staleness_ = -1;
+  Scope* next_scope_ = nullptr;
+  int next_batch_size_ = -1;
+  std::map<uint64_t, std::vector<std::string>> pipeline_key_names_;
+  std::map<uint64_t, std::vector<uint64_t>> next_features_;
+  std::map<uint64_t, std::vector<std::vector<float>>> next_feature_values_;
+  std::vector<::std::future<int32_t>> pull_sparse_status_;
+  // the push status of the batches in flight
+  std::deque<std::vector<::std::future<int32_t>>> pending_push_status_;
 
  private:
   // std::vector<std::string> dump_param_;
@@ -365,6 +410,9 @@ class SectionWorker : public DeviceWorker {
 
  protected:
   void AutoSetCPUAffinity(bool reuse);
+  // Copy the inputs of the section in scope to its kid on the GPU by ctx,
+  // and return the kid.
+  Scope* CopyInputsToDevice(Scope* scope, const platform::DeviceContext& ctx);
   int section_id_;
   int pipeline_id_;
   int section_num_;
@@ -383,6 +431,10 @@ class SectionWorker : public DeviceWorker {
   std::vector<std::unique_ptr<OperatorBase>> ops_;
 
   platform::DeviceContext* dev_ctx_ = nullptr;
+  // The inputs of the next scope are copied on its own stream while the ops
+  // of the current scope run, so that the copies between the sections are
+  // hidden by the compute on the GPU.
+  std::unique_ptr<platform::CUDADeviceContext> copy_ctx_;
 };
 #endif
 }  // namespace framework
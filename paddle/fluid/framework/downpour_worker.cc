@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/string/string_helper.h"
 
@@ -72,6 +73,8 @@ void DownpourWorker::Initialize(const TrainerDesc& desc) {
 
   need_to_push_sparse_ = param_.push_sparse();
   need_to_push_dense_ = param_.push_dense();
+  pipeline_pull_ = param_.pipeline_pull();
+  max_push_staleness_ = param_.max_push_staleness();
 
   fleet_ptr_ = FleetWrapper::GetInstance();
   fetch_config_ = desc.fetch_config();
@@ -121,6 +124,110 @@ void DownpourWorker::Initialize(const TrainerDesc& desc) {
   }
 }
 
+void DownpourWorker::BindingDataFeedMemory() {
+  const std::vector<std::string>& input_feed =
+      device_reader_->GetUseSlotAlias();
+  if (pipeline_pull_ && need_dump_field_) {
+    // the instances dumped are got from the reader, which is a batch ahead
+    LOG(WARNING) << "pipeline_pull is disabled when dumping fields";
+    pipeline_pull_ = false;
+  }
+  // the keys of the next batch are got from the feed vars of next_scope_,
+  // so only the fed slots with embeddings are pulled
+  for (int i = 0;
+       pipeline_pull_ &&
+       i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    auto& key_names = pipeline_key_names_[tid];
+    key_names.clear();
+    for (size_t j = 0; j < sparse_key_names_[tid].size(); ++j) {
+      const std::string& name = sparse_key_names_[tid][j];
+      if (thread_scope_->FindVar(name) == nullptr ||
+          thread_scope_->FindVar(sparse_value_names_[tid][j]) == nullptr) {
+        continue;
+      }
+      if (std::find(input_feed.begin(), input_feed.end(), name) ==
+          input_feed.end()) {
+        LOG(WARNING) << "pipeline_pull is disabled since the sparse key "
+                     << name << " is not fed";
+        pipeline_pull_ = false;
+        break;
+      }
+      key_names.push_back(name);
+    }
+  }
+  if (!pipeline_pull_) {
+    HogwildWorker::BindingDataFeedMemory();
+    return;
+  }
+  next_scope_ = &root_scope_->NewScope();
+  for (auto name : input_feed) {
+    device_reader_->AddFeedVar(next_scope_->Var(name), name);
+  }
+}
+
+int DownpourWorker::NextBatch() {
+  if (!pipeline_pull_) {
+    return device_reader_->Next();
+  }
+  if (next_batch_size_ < 0) {
+    next_batch_size_ = device_reader_->Next();
+    if (next_batch_size_ > 0) {
+      PullNextSparseAsync();
+    }
+  }
+  int cur_batch = next_batch_size_;
+  if (cur_batch <= 0) {
+    return cur_batch;
+  }
+  for (auto& t : pull_sparse_status_) {
+    if (t.valid()) {
+      t.wait();
+    }
+  }
+  pull_sparse_status_.clear();
+  SwapNextBatch();
+  next_batch_size_ = device_reader_->Next();
+  if (next_batch_size_ > 0) {
+    PullNextSparseAsync();
+  }
+  return cur_batch;
+}
+
+void DownpourWorker::PullNextSparseAsync() {
+  for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    TableParameter table;
+    for (auto j : param_.sparse_table()) {
+      if (j.table_id() == tid) {
+        table = j;
+        break;
+      }
+    }
+    pull_sparse_status_.push_back(fleet_ptr_->PullSparseVarsAsync(
+        *next_scope_, tid, pipeline_key_names_[tid], &next_features_[tid],
+        &next_feature_values_[tid], table.fea_dim()));
+  }
+}
+
+void DownpourWorker::SwapNextBatch() {
+  // the tensors are swapped, so that the reader keeps feeding next_scope_
+  for (auto& name : device_reader_->GetUseSlotAlias()) {
+    Variable* var = thread_scope_->FindVar(name);
+    if (var == nullptr) {
+      continue;
+    }
+    std::swap(*var->GetMutable<LoDTensor>(),
+              *next_scope_->FindVar(name)->GetMutable<LoDTensor>());
+  }
+  std::swap(features_, next_features_);
+  std::swap(feature_values_, next_feature_values_);
+}
+
 void DownpourWorker::SetChannelWriter(ChannelObject<std::string>* queue) {
   writer_.Reset(queue);
 }
@@ -466,6 +573,7 @@ void DownpourWorker::CopyDenseVars() {
 void DownpourWorker::TrainFilesWithProfiler() {
   VLOG(3) << "Begin to train files with profiler";
   platform::SetNumThreads(1);
+  platform::BindThreadToCpuPool(platform::CpuPool::kCompute);
   device_reader_->Start();
   std::vector<double> op_total_time;
   std::vector<std::string> op_name;
@@ -760,10 +868,12 @@ void DownpourWorker::TrainFilesWithProfiler() {
 void DownpourWorker::TrainFiles() {
   VLOG(3) << "Begin to train files";
   platform::SetNumThreads(1);
+  platform::BindThreadToCpuPool(platform::CpuPool::kCompute);
   device_reader_->Start();
   int batch_cnt = 0;
   int cur_batch;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  next_batch_size_ = -1;
+  while ((cur_batch = NextBatch()) > 0) {
     if (copy_table_config_.need_copy()) {
       if (batch_cnt % copy_table_config_.batch_num() == 0) {
         CopySparseTable();
@@ -783,9 +893,12 @@ void DownpourWorker::TrainFiles() {
           break;
         }
       }
-      fleet_ptr_->PullSparseVarsSync(
-          *thread_scope_, tid, sparse_key_names_[tid], &features_[tid],
-          &feature_values_[tid], table.fea_dim(), sparse_value_names_[tid]);
+      // the pipelined values are pulled in NextBatch
+      if (!pipeline_pull_) {
+        fleet_ptr_->PullSparseVarsSync(
+            *thread_scope_, tid, sparse_key_names_[tid], &features_[tid],
+            &feature_values_[tid], table.fea_dim(), sparse_value_names_[tid]);
+      }
       CollectLabelInfo(i);
       FillSparseValue(i);
       auto nid_iter = std::find(sparse_value_names_[tid].begin(),
@@ -889,6 +1002,19 @@ void DownpourWorker::TrainFiles() {
       }
     }
 
+    if (max_push_staleness_ >= 0) {
+      // wait for the pushes of the batches older than the staleness
+      pending_push_status_.push_back(std::move(push_sparse_status_));
+      push_sparse_status_.clear();
+      while (pending_push_status_.size() >
+             static_cast<size_t>(max_push_staleness_)) {
+        for (auto& t : pending_push_status_.front()) {
+          t.wait();
+        }
+        pending_push_status_.pop_front();
+      }
+    }
+
     if (need_to_push_sparse_) {
       VLOG(3) << "push sparse gradient done.";
       int32_t tmp_push_sparse_wait_times = -1;
@@ -960,6 +1086,12 @@ void DownpourWorker::TrainFiles() {
     thread_scope_->DropKids();
     ++batch_cnt;
   }
+  for (auto& status : pending_push_status_) {
+    for (auto& t : status) {
+      t.wait();
+    }
+  }
+  pending_push_status_.clear();
   if (need_dump_field_) {
     writer_.Flush();
   }
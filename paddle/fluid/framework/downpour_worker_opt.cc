@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/lodtensor_printer.h"
 
@@ -321,6 +322,7 @@ void DownpourWorkerOpt::CreateThreadOperatorsWithRerank(
 void DownpourWorkerOpt::TrainFiles() {
   VLOG(3) << "Begin to train files";
   platform::SetNumThreads(1);
+  platform::BindThreadToCpuPool(platform::CpuPool::kCompute);
   device_reader_->Start();
   int batch_cnt = 0;
   int cur_batch;
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/executor.h"
+#include <algorithm>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -21,6 +23,7 @@ limitations under the License. */
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
+#include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
@@ -42,8 +45,16 @@ limitations under the License. */
 #endif
 
 DECLARE_bool(benchmark);
+DECLARE_bool(check_nan_inf);
+DECLARE_bool(check_nan_inf_async);
 DEFINE_bool(use_mkldnn, false, "Use MKLDNN to run");
 DEFINE_bool(use_ngraph, false, "Use NGRAPH to run");
+DECLARE_int32(inter_op_parallelism);
+DECLARE_bool(use_var_slots);
+DEFINE_bool(executor_compiled_mode, false,
+            "Run the prepared contexts of Executor in the compiled mode, "
+            "which binds the ops to the variables of the scope once and "
+            "reuses them in the later runs in the same scope");
 
 namespace paddle {
 namespace framework {
@@ -55,7 +66,10 @@ int kProgramId = -1;
 
 ExecutorPrepareContext::ExecutorPrepareContext(
     const framework::ProgramDesc& prog, size_t block_id)
-    : prog_(prog), block_id_(block_id) {}
+    : prog_(prog),
+      block_id_(block_id),
+      compiled_mode_(FLAGS_executor_compiled_mode),
+      inter_op_parallelism_(std::max(FLAGS_inter_op_parallelism, 0)) {}
 
 void ExecutorPrepareContext::PrepareUnusedVars(
     const std::vector<std::string>& keep_vars, bool force_disable_gc) {
@@ -91,6 +105,184 @@ ExecutorPrepareContext::~ExecutorPrepareContext() {
   VLOG(5) << "destroy ExecutorPrepareContext";
 }
 
+void ExecutorPrepareContext::EnableCompiledMode(bool enable) {
+  compiled_mode_ = enable;
+  if (!enable) {
+    instructions_.clear();
+    bound_scope_ = nullptr;
+  }
+}
+
+void ExecutorPrepareContext::BindInstructions(const Scope& scope) {
+  if (bound_scope_ == &scope && instructions_.size() == ops_.size()) {
+    return;
+  }
+  VLOG(3) << "Bind " << ops_.size() << " instructions to scope " << &scope;
+  instructions_.clear();
+  instructions_.reserve(ops_.size());
+  for (auto& op : ops_) {
+    instructions_.emplace_back(op.get());
+    instructions_.back().Bind(scope);
+  }
+  bound_scope_ = &scope;
+}
+
+void ExecutorPrepareContext::SetInterOpParallelism(size_t num_threads) {
+  inter_op_parallelism_ = num_threads;
+  parallel_runner_.reset();
+}
+
+ParallelOpRunner* ExecutorPrepareContext::PrepareParallelRunner(
+    const platform::Place& place) {
+  if (inter_op_parallelism_ == 0 || run_num_++ == 0) {
+    return nullptr;
+  }
+  if (!parallel_runner_) {
+    if (!ParallelOpRunner::CanRunInParallel(ops_, place)) {
+      VLOG(3) << "The ops on " << place << " can not run in parallel";
+      inter_op_parallelism_ = 0;
+      return nullptr;
+    }
+    parallel_runner_.reset(new ParallelOpRunner(ops_, inter_op_parallelism_));
+  }
+  return parallel_runner_.get();
+}
+
+#ifdef PADDLE_WITH_CUDA
+OpStreamScheduler* ExecutorPrepareContext::PrepareStreamScheduler(
+    const platform::Place& place) {
+  if (!stream_scheduler_prepared_) {
+    stream_scheduler_ = OpStreamScheduler::Create(ops_, place);
+    stream_scheduler_prepared_ = true;
+  }
+  if (stream_scheduler_) {
+    stream_scheduler_->Reset();
+  }
+  return stream_scheduler_.get();
+}
+#endif
+
+void ExecutorPrepareContext::PrepareVarSlots() {
+  if (!FLAGS_use_var_slots) {
+    return;
+  }
+  for (auto& op : ops_) {
+    op->BindVarSlots();
+  }
+  var_slot_num_ = Scope::VarSlotNum();
+}
+
+void ExecutorPrepareContext::ReserveVarSlots(const Scope& scope) const {
+  if (var_slot_num_ > 0) {
+    scope.ReserveVarSlots(var_slot_num_);
+  }
+}
+
+static void GetInputMetas(
+    const std::vector<Variable*>& vars,
+    std::vector<ExecutorPrepareContext::Instruction::InputMeta>* metas) {
+  metas->resize(vars.size());
+  for (size_t i = 0; i < vars.size(); ++i) {
+    auto& meta = (*metas)[i];
+    meta.initialized = false;
+    auto* var = vars[i];
+    if (var == nullptr ||
+        !(var->IsType<LoDTensor>() || var->IsType<SelectedRows>())) {
+      continue;
+    }
+    auto* tensor = GetLoDTensorOrSelectedRowsValueFromVar(*var);
+    meta.dims = tensor->dims();
+    if (tensor->IsInitialized()) {
+      meta.initialized = true;
+      meta.place = tensor->place();
+      meta.type = tensor->type();
+      meta.layout = tensor->layout();
+    }
+  }
+}
+
+bool ExecutorPrepareContext::Instruction::InputMeta::operator==(
+    const InputMeta& other) const {
+  if (initialized != other.initialized || dims != other.dims) {
+    return false;
+  }
+  return !initialized || (place == other.place && type == other.type &&
+                          layout == other.layout);
+}
+
+ExecutorPrepareContext::Instruction::Instruction(OperatorBase* op)
+    : op(op), kernel_op(dynamic_cast<const OperatorWithKernel*>(op)) {}
+
+void ExecutorPrepareContext::Instruction::Bind(const Scope& scope) {
+  bound_inputs.clear();
+  input_metas.clear();
+  if (kernel_op == nullptr) {
+    return;
+  }
+  if (op->HasVarSlots()) {
+    runtime_ctx.reset(new RuntimeContext(op->Inputs(), op->Outputs(),
+                                         op->InputSlots(), op->OutputSlots(),
+                                         scope));
+  } else {
+    runtime_ctx.reset(new RuntimeContext(op->Inputs(), op->Outputs(), scope));
+  }
+  // the variables created after binding are not found in runtime_ctx, the op
+  // looks up its variables in each run then
+  auto all_found = [](const VariableNameMap& names, VariableValueMap* vars) {
+    for (auto& pair : names) {
+      auto& bound_vars = (*vars)[pair.first];
+      for (size_t i = 0; i < pair.second.size(); ++i) {
+        if (bound_vars[i] == nullptr && pair.second[i] != kEmptyVarName) {
+          VLOG(4) << "Variable " << pair.second[i] << " is not found";
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+  if (!all_found(op->Inputs(), &runtime_ctx->inputs) ||
+      !all_found(op->Outputs(), &runtime_ctx->outputs)) {
+    runtime_ctx.reset();
+    return;
+  }
+  for (auto& pair : runtime_ctx->inputs) {
+    bound_inputs.insert(bound_inputs.end(), pair.second.begin(),
+                        pair.second.end());
+  }
+  // check the data transforms in the first run
+  kernel_op->ResetDataTransformCache();
+}
+
+void ExecutorPrepareContext::Instruction::Run(const Scope& scope,
+                                              const platform::Place& place) {
+  if (runtime_ctx == nullptr) {
+    op->Run(scope, place);
+    return;
+  }
+  std::vector<InputMeta> metas;
+  GetInputMetas(bound_inputs, &metas);
+  if (metas != input_metas) {
+    kernel_op->ResetDataTransformCache();
+    input_metas.swap(metas);
+  }
+
+  op->Run(scope, place, runtime_ctx.get());
+
+  // the data transform points the inputs to the transferred variables in a
+  // child scope, which may be dropped after the run
+  size_t i = 0;
+  bool transferred = false;
+  for (auto& pair : runtime_ctx->inputs) {
+    for (auto* var : pair.second) {
+      transferred = transferred || var != bound_inputs[i];
+      ++i;
+    }
+  }
+  if (transferred) {
+    Bind(scope);
+  }
+}
+
 Executor::Executor(const platform::Place& place) : place_(place) {}
 
 Executor::~Executor() {
@@ -380,10 +572,34 @@ std::unique_ptr<ExecutorPrepareContext> Executor::Prepare(
         ctx->prog_.Block(ctx->block_id_), &ctx->ops_);
   }
 #endif
+  ctx->PrepareVarSlots();
   ctx->PrepareUnusedVars(skip_ref_cnt_vars, force_disable_gc);
   return ctx;
 }
 
+std::shared_ptr<ExecutorPrepareContext> ExecutorPrepareContextPool::Acquire(
+    const ProgramDesc& program, int block_id,
+    const std::vector<std::string>& skip_ref_cnt_vars, bool force_disable_gc) {
+  std::unique_ptr<ExecutorPrepareContext> ctx;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ctxs_.empty()) {
+      ctx = std::move(ctxs_.back());
+      ctxs_.pop_back();
+    }
+  }
+  if (ctx == nullptr) {
+    ctx = Executor::Prepare(program, block_id, skip_ref_cnt_vars,
+                            force_disable_gc);
+  }
+  // The pool is owned by the op, which outlives the runs using the context.
+  return std::shared_ptr<ExecutorPrepareContext>(
+      ctx.release(), [this](ExecutorPrepareContext* released) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ctxs_.emplace_back(released);
+      });
+}
+
 std::vector<std::shared_ptr<ExecutorPrepareContext>> Executor::Prepare(
     const ProgramDesc& program, const std::vector<int>& block_ids,
     const std::vector<std::vector<std::string>>& skip_ref_cnt_vars,
@@ -401,6 +617,7 @@ std::vector<std::shared_ptr<ExecutorPrepareContext>> Executor::Prepare(
     for (auto& op_desc : block.AllOps()) {
       ctx->ops_.push_back(OpRegistry::CreateOp(*op_desc));
     }
+    ctx->PrepareVarSlots();
     if (skip_ref_cnt_vars.empty()) {
       ctx->PrepareUnusedVars(std::vector<std::string>(), force_disable_gc);
     } else {
@@ -416,6 +633,7 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
                                   bool create_local_scope, bool create_vars,
                                   bool keep_kids) {
   platform::RecordBlock b(kProgramId);
+  platform::NvtxRange nvtx_range("Executor::RunPreparedContext");
   PADDLE_ENFORCE_NOT_NULL(scope);
   Scope* local_scope = scope;
   if (create_vars) {
@@ -424,6 +642,10 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
     }
     CreateVariables(ctx->prog_, local_scope, ctx->block_id_);
   }
+  ctx->ReserveVarSlots(*local_scope);
+  if (local_scope != scope) {
+    ctx->ReserveVarSlots(*scope);
+  }
 
   int64_t max_memory_size = GetEagerDeletionThreshold();
   std::unique_ptr<GarbageCollector> gc;
@@ -446,11 +668,41 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
 #endif
   }
 
-  for (auto& op : ctx->ops_) {
-    op->Run(*local_scope, place_);
-    if (gc) {
-      DeleteUnusedTensors(*local_scope, op.get(), ctx->unused_vars_, gc.get());
+  std::function<void(size_t)> run_op;
+  // a local scope may be created at the address of a deleted one, whose
+  // variables can not be told apart from the bound ones
+  if (ctx->IsCompiledMode() && local_scope == scope) {
+    ctx->BindInstructions(*local_scope);
+    run_op = [&](size_t i) { ctx->instructions_[i].Run(*local_scope, place_); };
+  } else {
+    run_op = [&](size_t i) { ctx->ops_[i]->Run(*local_scope, place_); };
+  }
+
+  auto* parallel_runner = ctx->PrepareParallelRunner(place_);
+  if (parallel_runner != nullptr) {
+    parallel_runner->Run(run_op, *local_scope, &ctx->unused_vars_, gc.get());
+  } else {
+#ifdef PADDLE_WITH_CUDA
+    auto* stream_scheduler = ctx->PrepareStreamScheduler(place_);
+    if (stream_scheduler != nullptr) {
+      auto run_on_stream = run_op;
+      run_op = [&](size_t i) {
+        auto* op = ctx->ops_[i].get();
+        stream_scheduler->RunOp(i, run_on_stream,
+                                gc && ctx->unused_vars_.count(op) > 0);
+      };
     }
+#endif
+    for (size_t i = 0; i < ctx->ops_.size(); ++i) {
+      run_op(i);
+      if (gc) {
+        DeleteUnusedTensors(*local_scope, ctx->ops_[i].get(),
+                            ctx->unused_vars_, gc.get());
+      }
+    }
+  }
+  if (gc) {
+    gc->Flush();
   }
 
   platform::DeviceContextPool::Instance().Get(place_)->Wait();
@@ -469,6 +721,11 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
       scope->DropKids();
     }
   }
+
+  // the device is waited above, so that the flags are read without waiting
+  if (FLAGS_check_nan_inf && FLAGS_check_nan_inf_async) {
+    details::CheckNanInfAsyncResults(place_);
+  }
 }
 
 void Executor::RunPreparedContext(
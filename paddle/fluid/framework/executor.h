@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -23,6 +24,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/executor_gc_helper.h"
 #include "paddle/fluid/framework/garbage_collector.h"
 #include "paddle/fluid/framework/op_info.h"
+#include "paddle/fluid/framework/op_stream_scheduler.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/parallel_op_runner.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -40,6 +44,47 @@ struct ExecutorPrepareContext {
   void PrepareUnusedVars(const std::vector<std::string>& keep_vars,
                          bool force_disable_gc = false);
 
+  // In the compiled mode, the ops are bound to the variables of the scope
+  // they run in as a flat array of instructions, which the later runs in
+  // the same scope reuse instead of looking up the variables, choosing the
+  // kernels and checking the data transforms in each op. The instructions
+  // are bound again when the scope changes, and the data transforms of an
+  // op are checked again when the meta of its inputs, e.g. the shapes or
+  // the places, change. It is set by FLAGS_executor_compiled_mode by
+  // default. The context must not be run by several threads at the same
+  // time in the compiled mode.
+  void EnableCompiledMode(bool enable = true);
+
+  bool IsCompiledMode() const { return compiled_mode_; }
+
+  // Bind the instructions to scope if they are not bound to it.
+  void BindInstructions(const Scope& scope);
+
+  // Run the independent ops in parallel by num_threads threads from the
+  // second run, 0 for running the ops one by one. Only for CPUPlace. It is
+  // set by FLAGS_inter_op_parallelism by default.
+  void SetInterOpParallelism(size_t num_threads);
+
+  // Return the runner of the ops if they run in parallel in this run, or
+  // nullptr. The first run creates the variables and chooses the kernels
+  // one by one.
+  ParallelOpRunner* PrepareParallelRunner(const platform::Place& place);
+
+#ifdef PADDLE_WITH_CUDA
+  // Return the scheduler of the ops on the CUDA streams if some ops have
+  // the op_stream attribute on a CUDAPlace, or nullptr. The ops run on
+  // their streams only if they run one by one.
+  OpStreamScheduler* PrepareStreamScheduler(const platform::Place& place);
+#endif
+
+  // Assign the slots of the variables of the ops if FLAGS_use_var_slots is
+  // set, so that the ops find their variables in the scopes by the slots
+  // instead of hashing the names, see Scope::VarSlot.
+  void PrepareVarSlots();
+
+  // Reserve the slots of the variables of the ops in scope.
+  void ReserveVarSlots(const Scope& scope) const;
+
   const framework::ProgramDesc& prog_;
   const size_t block_id_;
 
@@ -48,6 +93,50 @@ struct ExecutorPrepareContext {
   std::unordered_map<const OperatorBase*, std::vector<std::string>>
       unused_vars_;
   bool force_disable_gc_{false};
+
+  struct Instruction {
+    struct InputMeta {
+      DDim dims;
+      bool initialized;
+      platform::Place place;
+      proto::VarType::Type type;
+      DataLayout layout;
+
+      bool operator==(const InputMeta& other) const;
+    };
+
+    explicit Instruction(OperatorBase* op);
+
+    void Bind(const Scope& scope);
+
+    void Run(const Scope& scope, const platform::Place& place);
+
+    OperatorBase* op;
+    // nullptr for the ops without kernels
+    const OperatorWithKernel* kernel_op;
+    // nullptr if the op looks up its variables by itself, e.g. without
+    // kernels or some variables are not created when bound
+    std::unique_ptr<RuntimeContext> runtime_ctx;
+    // the input variables when bound, which are replaced by the transferred
+    // ones in runtime_ctx if the data transform happens
+    std::vector<Variable*> bound_inputs;
+    std::vector<InputMeta> input_metas;
+  };
+
+  bool compiled_mode_;
+  const Scope* bound_scope_{nullptr};
+  std::vector<Instruction> instructions_;
+
+  size_t inter_op_parallelism_;
+  size_t run_num_{0};
+  std::unique_ptr<ParallelOpRunner> parallel_runner_;
+#ifdef PADDLE_WITH_CUDA
+  bool stream_scheduler_prepared_{false};
+  std::unique_ptr<OpStreamScheduler> stream_scheduler_;
+#endif
+
+  // 0 if the ops find their variables by the names
+  size_t var_slot_num_{0};
 };
 
 class Executor {
@@ -134,5 +223,27 @@ class Executor {
   const platform::Place place_;
 };
 
+/*
+ * The prepared contexts of a sub-block, which a control flow op running the
+ * block in every run, e.g. conditional_block and while, reuses across the
+ * runs instead of creating the ops of the block every time. Acquire returns
+ * a context not used by others, which is given back to the pool when the
+ * returned pointer is released, so that the op may run in several threads
+ * at the same time. The ops of the block are not created again if the block
+ * changes after the first run.
+ */
+class ExecutorPrepareContextPool {
+ public:
+  std::shared_ptr<ExecutorPrepareContext> Acquire(
+      const ProgramDesc& program, int block_id,
+      const std::vector<std::string>& skip_ref_cnt_vars =
+          std::vector<std::string>(),
+      bool force_disable_gc = false);
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ExecutorPrepareContext>> ctxs_;
+};
+
 }  // namespace framework
 }  // namespace paddle
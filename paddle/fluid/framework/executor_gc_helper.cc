@@ -152,9 +152,12 @@ void DeleteUnusedTensors(
   if (iter == delete_vars_map.end()) {
     return;
   }
+  DeleteUnusedTensors(scope, iter->second, gc);
+}
 
-  auto &delete_vars = iter->second;
-
+void DeleteUnusedTensors(const Scope &scope,
+                         const std::vector<std::string> &delete_vars,
+                         GarbageCollector *gc) {
   std::deque<std::shared_ptr<memory::Allocation>> garbages;
 
   for (auto &var_name : delete_vars) {
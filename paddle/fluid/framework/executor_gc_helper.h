@@ -38,5 +38,10 @@ void DeleteUnusedTensors(
         &delete_vars_map,
     GarbageCollector *gc);
 
+// Collect the tensors of delete_vars
+void DeleteUnusedTensors(const Scope &scope,
+                         const std::vector<std::string> &delete_vars,
+                         GarbageCollector *gc);
+
 }  // namespace framework
 }  // namespace paddle
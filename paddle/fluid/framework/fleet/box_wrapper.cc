@@ -135,10 +135,6 @@ void BoxWrapper::PullSparse(const paddle::platform::Place& place,
 
   int64_t total_length =
       std::accumulate(slot_lengths.begin(), slot_lengths.end(), 0UL);
-  auto buf =
-      memory::AllocShared(place, total_length * sizeof(boxps::FeatureValueGpu));
-  boxps::FeatureValueGpu* total_values_gpu =
-      reinterpret_cast<boxps::FeatureValueGpu*>(buf->ptr());
 
   if (platform::is_cpu_place(place)) {
     PADDLE_THROW(platform::errors::Unimplemented(
@@ -169,11 +165,21 @@ void BoxWrapper::PullSparse(const paddle::platform::Place& place,
     this->CopyKeys(place, gpu_keys, total_keys, gpu_len,
                    static_cast<int>(slot_lengths.size()),
                    static_cast<int>(total_length));
+    int uniq_length =
+        this->DedupKeys(place, total_keys, static_cast<int>(total_length));
+    VLOG(3) << "Dedup keys, key_num[" << total_length << "], uniq_key_num["
+            << uniq_length << "]";
+    auto& dedup = dedup_keys_[device_id];
+    auto buf = memory::AllocShared(
+        place, uniq_length * sizeof(boxps::FeatureValueGpu));
+    boxps::FeatureValueGpu* total_values_gpu =
+        reinterpret_cast<boxps::FeatureValueGpu*>(buf->ptr());
+
     VLOG(3) << "Begin call PullSparseGPU in BoxPS";
     pull_boxps_timer.Start();
-    int ret =
-        boxps_ptr_->PullSparseGPU(total_keys, total_values_gpu,
-                                  static_cast<int>(total_length), device_id);
+    int ret = boxps_ptr_->PullSparseGPU(
+        reinterpret_cast<uint64_t*>(dedup.uniq_keys.data<int64_t>()),
+        total_values_gpu, uniq_length, device_id);
     PADDLE_ENFORCE_EQ(ret, 0, platform::errors::PreconditionNotMet(
                                   "PullSparseGPU failed in BoxPS."));
     pull_boxps_timer.Pause();
@@ -182,7 +188,7 @@ void BoxWrapper::PullSparse(const paddle::platform::Place& place,
             << "]";
     this->CopyForPull(place, gpu_keys, values, total_values_gpu, gpu_len,
                       static_cast<int>(slot_lengths.size()), hidden_size,
-                      total_length);
+                      total_length, dedup.restore_idx.data<int>());
 #else
     PADDLE_THROW(platform::errors::PreconditionNotMet(
         "Please compile WITH_GPU option, because NCCL doesn't support "
@@ -220,18 +226,25 @@ void BoxWrapper::PushSparseGrad(const paddle::platform::Place& place,
   } else if (platform::is_gpu_place(place)) {
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
     int device_id = boost::get<platform::CUDAPlace>(place).GetDeviceId();
-    LoDTensor& cached_total_keys_tensor = keys_tensor[device_id];
-    uint64_t* total_keys =
-        reinterpret_cast<uint64_t*>(cached_total_keys_tensor.data<int64_t>());
+    auto& dedup = dedup_keys_[device_id];
+    uint64_t* uniq_keys =
+        reinterpret_cast<uint64_t*>(dedup.uniq_keys.data<int64_t>());
     VLOG(3) << "Begin copy grad tensor to boxps struct";
     this->CopyForPush(place, grad_values, total_grad_values_gpu, slot_lengths,
                       hidden_size, total_length, batch_size);
 
+    VLOG(3) << "Begin merge the grads of " << dedup.uniq_num << " unique keys";
+    auto buf_uniq = memory::AllocShared(
+        place, dedup.uniq_num * sizeof(boxps::FeaturePushValueGpu));
+    boxps::FeaturePushValueGpu* uniq_grad_values_gpu =
+        reinterpret_cast<boxps::FeaturePushValueGpu*>(buf_uniq->ptr());
+    this->MergePushValues(place, total_grad_values_gpu, uniq_grad_values_gpu,
+                          static_cast<int>(total_length));
+
     VLOG(3) << "Begin call PushSparseGPU in BoxPS";
     push_boxps_timer.Start();
-    int ret = boxps_ptr_->PushSparseGPU(
-        total_keys, total_grad_values_gpu, static_cast<int>(total_length),
-        boost::get<platform::CUDAPlace>(place).GetDeviceId());
+    int ret = boxps_ptr_->PushSparseGPU(uniq_keys, uniq_grad_values_gpu,
+                                        dedup.uniq_num, device_id);
     PADDLE_ENFORCE_EQ(ret, 0, platform::errors::PreconditionNotMet(
                                   "PushSparseGPU failed in BoxPS."));
     push_boxps_timer.Pause();
@@ -17,6 +17,7 @@
 #include <ctime>
 #include <memory>
 #include <numeric>
+#include "cub/cub.cuh"
 #include "paddle/fluid/framework/fleet/box_wrapper.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/platform/gpu_info.h"
@@ -29,7 +30,8 @@ namespace framework {
 
 __global__ void PullCopy(float** dest, const boxps::FeatureValueGpu* src,
                          const int64_t* len, int hidden, int slot_num,
-                         int total_len, uint64_t** keys) {
+                         int total_len, uint64_t** keys,
+                         const int* restore_idx) {
   CUDA_KERNEL_LOOP(i, total_len) {
     int low = 0;
     int high = slot_num - 1;
@@ -42,22 +44,23 @@ __global__ void PullCopy(float** dest, const boxps::FeatureValueGpu* src,
     }
     int x = low;
     int y = i - (x ? len[x - 1] : 0);
+    const boxps::FeatureValueGpu* value = src + restore_idx[i];
     if (*(keys[x] + y) == 0) {
       *(dest[x] + y * hidden) = 0;
       *(dest[x] + y * hidden + 1) = 0;
       *(dest[x] + y * hidden + 2) = 0;
     } else {
-      *(dest[x] + y * hidden) = (src + i)->show;
-      *(dest[x] + y * hidden + 1) = (src + i)->clk;
-      *(dest[x] + y * hidden + 2) = (src + i)->embed_w;
+      *(dest[x] + y * hidden) = value->show;
+      *(dest[x] + y * hidden + 1) = value->clk;
+      *(dest[x] + y * hidden + 2) = value->embed_w;
     }
-    if ((src + i)->embedding_size == 0 || *(keys[x] + y) == 0) {
+    if (value->embedding_size == 0 || *(keys[x] + y) == 0) {
       for (int j = 0; j < 8; j++) {
         *(dest[x] + y * hidden + 3 + j) = 0;
       }
     } else {
       for (int j = 0; j < 8; j++) {
-        *(dest[x] + y * hidden + 3 + j) = (src + i)->embedx[1 + j];
+        *(dest[x] + y * hidden + 3 + j) = value->embedx[1 + j];
       }
     }
   }
@@ -82,6 +85,57 @@ __global__ void CopyKeysKernel(uint64_t** src_keys, uint64_t* dest_total_keys,
   }
 }
 
+__global__ void FillIndexKernel(int* idx, int len) {
+  CUDA_KERNEL_LOOP(i, len) { idx[i] = i; }
+}
+
+__global__ void MarkUniqueKernel(const uint64_t* sorted_keys, int* flags,
+                                 int len) {
+  CUDA_KERNEL_LOOP(i, len) {
+    flags[i] = (i == 0 || sorted_keys[i] != sorted_keys[i - 1]) ? 1 : 0;
+  }
+}
+
+// uniq_pos is the inclusive sum of the flags, so the sorted key i is the
+// unique key uniq_pos[i] - 1
+__global__ void ScatterUniqueKernel(const uint64_t* sorted_keys,
+                                    const int* sorted_idx, const int* flags,
+                                    const int* uniq_pos, uint64_t* uniq_keys,
+                                    int* uniq_offset, int* restore_idx,
+                                    int len) {
+  CUDA_KERNEL_LOOP(i, len) {
+    int u = uniq_pos[i] - 1;
+    restore_idx[sorted_idx[i]] = u;
+    if (flags[i]) {
+      uniq_keys[u] = sorted_keys[i];
+      uniq_offset[u] = i;
+    }
+  }
+}
+
+// Sum the gradients of a unique key in the order of the sorted keys, so the
+// result does not depend on the scheduling of the threads.
+__global__ void MergePushKernel(const boxps::FeaturePushValueGpu* src,
+                                boxps::FeaturePushValueGpu* dest,
+                                const int* sorted_idx, const int* uniq_offset,
+                                int uniq_num, int total_len) {
+  CUDA_KERNEL_LOOP(i, uniq_num) {
+    int begin = uniq_offset[i];
+    int end = i + 1 < uniq_num ? uniq_offset[i + 1] : total_len;
+    boxps::FeaturePushValueGpu merged = src[sorted_idx[begin]];
+    for (int k = begin + 1; k < end; ++k) {
+      const boxps::FeaturePushValueGpu& value = src[sorted_idx[k]];
+      merged.show += value.show;
+      merged.clk += value.clk;
+      merged.embed_g += value.embed_g;
+      for (int j = 0; j < 8; j++) {
+        merged.embedx_g[j] += value.embedx_g[j];
+      }
+    }
+    dest[i] = merged;
+  }
+}
+
 __global__ void PushCopy(boxps::FeaturePushValueGpu* dest, float** src,
                          int64_t* len, int hidden, int slot_num, int total_len,
                          int bs, int* slot_vector) {
@@ -112,8 +166,8 @@ void BoxWrapper::CopyForPull(const paddle::platform::Place& place,
                              const std::vector<float*>& values,
                              const boxps::FeatureValueGpu* total_values_gpu,
                              const int64_t* gpu_len, const int slot_num,
-                             const int hidden_size,
-                             const int64_t total_length) {
+                             const int hidden_size, const int64_t total_length,
+                             const int* restore_idx) {
   auto stream = dynamic_cast<platform::CUDADeviceContext*>(
                     platform::DeviceContextPool::Instance().Get(
                         boost::get<platform::CUDAPlace>(place)))
@@ -125,7 +179,7 @@ void BoxWrapper::CopyForPull(const paddle::platform::Place& place,
 
   PullCopy<<<(total_length + 512 - 1) / 512, 512, 0, stream>>>(
       gpu_values, total_values_gpu, gpu_len, hidden_size, slot_num,
-      total_length, gpu_keys);
+      total_length, gpu_keys, restore_idx);
   cudaStreamSynchronize(stream);
 }
 
@@ -141,6 +195,79 @@ void BoxWrapper::CopyKeys(const paddle::platform::Place& place,
   cudaStreamSynchronize(stream);
 }
 
+int BoxWrapper::DedupKeys(const paddle::platform::Place& place,
+                          const uint64_t* total_keys, int total_len) {
+  int device_id = boost::get<platform::CUDAPlace>(place).GetDeviceId();
+  auto& dedup = dedup_keys_[device_id];
+  dedup.uniq_num = 0;
+  if (total_len == 0) {
+    return 0;
+  }
+  auto stream = dynamic_cast<platform::CUDADeviceContext*>(
+                    platform::DeviceContextPool::Instance().Get(
+                        boost::get<platform::CUDAPlace>(place)))
+                    ->stream();
+  uint64_t* uniq_keys = reinterpret_cast<uint64_t*>(
+      dedup.uniq_keys.mutable_data<int64_t>({total_len, 1}, place));
+  int* restore_idx = dedup.restore_idx.mutable_data<int>({total_len}, place);
+  int* sorted_idx = dedup.sorted_idx.mutable_data<int>({total_len}, place);
+  int* uniq_offset = dedup.uniq_offset.mutable_data<int>({total_len}, place);
+
+  auto buf_sorted_keys =
+      memory::AllocShared(place, total_len * sizeof(uint64_t));
+  auto buf_idx = memory::AllocShared(place, total_len * sizeof(int));
+  auto buf_flags = memory::AllocShared(place, total_len * sizeof(int));
+  auto buf_uniq_pos = memory::AllocShared(place, total_len * sizeof(int));
+  uint64_t* sorted_keys = reinterpret_cast<uint64_t*>(buf_sorted_keys->ptr());
+  int* idx = reinterpret_cast<int*>(buf_idx->ptr());
+  int* flags = reinterpret_cast<int*>(buf_flags->ptr());
+  int* uniq_pos = reinterpret_cast<int*>(buf_uniq_pos->ptr());
+
+  int grid = (total_len + 512 - 1) / 512;
+  FillIndexKernel<<<grid, 512, 0, stream>>>(idx, total_len);
+  size_t sort_bytes = 0;
+  cub::DeviceRadixSort::SortPairs(nullptr, sort_bytes, total_keys,
+                                  sorted_keys, idx, sorted_idx, total_len, 0,
+                                  sizeof(uint64_t) * 8, stream);
+  size_t scan_bytes = 0;
+  cub::DeviceScan::InclusiveSum(nullptr, scan_bytes, flags, uniq_pos,
+                                total_len, stream);
+  auto buf_temp = memory::AllocShared(place, std::max(sort_bytes, scan_bytes));
+  cub::DeviceRadixSort::SortPairs(buf_temp->ptr(), sort_bytes, total_keys,
+                                  sorted_keys, idx, sorted_idx, total_len, 0,
+                                  sizeof(uint64_t) * 8, stream);
+  MarkUniqueKernel<<<grid, 512, 0, stream>>>(sorted_keys, flags, total_len);
+  cub::DeviceScan::InclusiveSum(buf_temp->ptr(), scan_bytes, flags, uniq_pos,
+                                total_len, stream);
+  ScatterUniqueKernel<<<grid, 512, 0, stream>>>(
+      sorted_keys, sorted_idx, flags, uniq_pos, uniq_keys, uniq_offset,
+      restore_idx, total_len);
+  cudaMemcpyAsync(&dedup.uniq_num, uniq_pos + total_len - 1, sizeof(int),
+                  cudaMemcpyDeviceToHost, stream);
+  cudaStreamSynchronize(stream);
+  return dedup.uniq_num;
+}
+
+void BoxWrapper::MergePushValues(
+    const paddle::platform::Place& place,
+    const boxps::FeaturePushValueGpu* total_grad_values_gpu,
+    boxps::FeaturePushValueGpu* uniq_grad_values_gpu, int total_len) {
+  int device_id = boost::get<platform::CUDAPlace>(place).GetDeviceId();
+  auto& dedup = dedup_keys_[device_id];
+  if (dedup.uniq_num == 0) {
+    return;
+  }
+  auto stream = dynamic_cast<platform::CUDADeviceContext*>(
+                    platform::DeviceContextPool::Instance().Get(
+                        boost::get<platform::CUDAPlace>(place)))
+                    ->stream();
+  MergePushKernel<<<(dedup.uniq_num + 512 - 1) / 512, 512, 0, stream>>>(
+      total_grad_values_gpu, uniq_grad_values_gpu,
+      dedup.sorted_idx.data<int>(), dedup.uniq_offset.data<int>(),
+      dedup.uniq_num, total_len);
+  cudaStreamSynchronize(stream);
+}
+
 void BoxWrapper::CopyForPush(const paddle::platform::Place& place,
                              const std::vector<const float*>& grad_values,
                              boxps::FeaturePushValueGpu* total_grad_values_gpu,
@@ -144,7 +144,8 @@ class BoxWrapper {
                    const std::vector<float*>& values,
                    const boxps::FeatureValueGpu* total_values_gpu,
                    const int64_t* gpu_len, const int slot_num,
-                   const int hidden_size, const int64_t total_length);
+                   const int hidden_size, const int64_t total_length,
+                   const int* restore_idx);
   void CopyForPush(const paddle::platform::Place& place,
                    const std::vector<const float*>& grad_values,
                    boxps::FeaturePushValueGpu* total_grad_values_gpu,
@@ -154,6 +155,15 @@ class BoxWrapper {
   void CopyKeys(const paddle::platform::Place& place, uint64_t** origin_keys,
                 uint64_t* total_keys, const int64_t* gpu_len, int slot_num,
                 int total_len);
+  // sort and unique the keys of a batch on the device, return the number of
+  // the unique keys, which are pulled and pushed only once
+  int DedupKeys(const paddle::platform::Place& place,
+                const uint64_t* total_keys, int total_len);
+  // sum the gradients of the same key by the dedup of the last pull
+  void MergePushValues(const paddle::platform::Place& place,
+                       const boxps::FeaturePushValueGpu* total_grad_values_gpu,
+                       boxps::FeaturePushValueGpu* uniq_grad_values_gpu,
+                       int total_len);
   boxps::PSAgentBase* GetAgent() { return p_agent_; }
   void InitializeGPU(const char* conf_file, const std::vector<int>& slot_vector,
                      const std::vector<std::string>& slot_omit_in_feedpass) {
@@ -179,6 +189,7 @@ class BoxWrapper {
       }
       slot_vector_ = slot_vector;
       keys_tensor.resize(platform::GetCUDADeviceCount());
+      dedup_keys_.resize(platform::GetCUDADeviceCount());
     }
   }
 
@@ -521,6 +532,20 @@ class BoxWrapper {
   std::vector<std::string> metric_name_list_;
   std::vector<int> slot_vector_;
   std::vector<LoDTensor> keys_tensor;  // Cache for pull_sparse
+
+  // The unique keys of the last pull on a device, kept for the push of the
+  // same batch to merge the gradients of the same key.
+  struct DedupKeyCache {
+    LoDTensor uniq_keys;
+    // the unique key of each total key
+    LoDTensor restore_idx;
+    // the positions of the total keys in the order of the keys
+    LoDTensor sorted_idx;
+    // the first sorted position of each unique key
+    LoDTensor uniq_offset;
+    int uniq_num = 0;
+  };
+  std::vector<DedupKeyCache> dedup_keys_;
 };
 #endif
 
@@ -580,6 +605,16 @@ class BoxHelper {
     for (auto iter = t.begin() + begin_index; iter != t.begin() + end_index;
          iter++) {
       const auto& ins = *iter;
+      if (ins.IsCompact()) {
+        CompactRecordEncoder::ForEach(
+            ins,
+            [&](uint16_t slot, uint64_t feasign) {
+              if (index_map.find(slot) == index_map.end()) {
+                p_agent->AddKey(feasign, thread_id);
+              }
+            },
+            [](uint16_t slot, float feasign) {});
+      }
       const auto& feasign_v = ins.uint64_feasigns_;
       for (const auto feasign : feasign_v) {
         if (index_map.find(feasign.slot()) != index_map.end()) {
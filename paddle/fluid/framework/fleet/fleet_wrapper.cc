@@ -703,6 +703,27 @@ void FleetWrapper::LoadModelOneTable(const uint64_t table_id,
 #endif
 }
 
+void FleetWrapper::LoadModelTables(const std::vector<uint64_t>& table_ids,
+                                   const std::string& path, const int mode) {
+#ifdef PADDLE_WITH_PSLIB
+  std::vector<std::future<int32_t>> rets;
+  rets.reserve(table_ids.size());
+  for (auto table_id : table_ids) {
+    rets.push_back(
+        pslib_ptr_->_worker_ptr->load(table_id, path, std::to_string(mode)));
+  }
+  for (size_t i = 0; i < rets.size(); ++i) {
+    rets[i].wait();
+    if (rets[i].get() != 0) {
+      LOG(ERROR) << "load model of table id: " << table_ids[i]
+                 << ", from path: " << path << " failed";
+    }
+  }
+#else
+  VLOG(0) << "FleetWrapper::LoadModelTables does nothing when no pslib";
+#endif
+}
+
 void FleetWrapper::SaveModel(const std::string& path, const int mode) {
 #ifdef PADDLE_WITH_PSLIB
   auto ret = pslib_ptr_->_worker_ptr->save(path, std::to_string(mode));
@@ -718,6 +739,73 @@ void FleetWrapper::SaveModel(const std::string& path, const int mode) {
 #endif
 }
 
+void FleetWrapper::SaveModelAsync(const std::string& path, const int mode,
+                                  const std::vector<uint64_t>& table_ids,
+                                  int parallelism) {
+#ifdef PADDLE_WITH_PSLIB
+  PADDLE_ENFORCE_EQ(
+      save_model_future_.valid(), false,
+      platform::errors::PreconditionNotMet(
+          "The model saved by the last SaveModelAsync is not waited, call "
+          "WaitSaveModel before saving the model again."));
+  if (save_model_pool_ == nullptr) {
+    save_model_pool_.reset(new ::ThreadPool(1));
+  }
+  size_t step = static_cast<size_t>(std::max(parallelism, 1));
+  save_model_future_ = save_model_pool_->enqueue(
+      [this, path, mode, table_ids, step]() -> int32_t {
+        if (table_ids.empty()) {
+          auto ret = pslib_ptr_->_worker_ptr->save(path, std::to_string(mode));
+          ret.wait();
+          return ret.get();
+        }
+        int32_t feasign_cnt = 0;
+        bool failed = false;
+        for (size_t begin = 0; begin < table_ids.size(); begin += step) {
+          size_t end = std::min(begin + step, table_ids.size());
+          std::vector<std::future<int32_t>> rets;
+          for (size_t i = begin; i < end; ++i) {
+            rets.push_back(pslib_ptr_->_worker_ptr->save(
+                table_ids[i], path, std::to_string(mode)));
+          }
+          for (size_t i = begin; i < end; ++i) {
+            rets[i - begin].wait();
+            int32_t cnt = rets[i - begin].get();
+            if (cnt == -1) {
+              LOG(ERROR) << "save model of table id: " << table_ids[i]
+                         << ", to path: " << path << " failed";
+              failed = true;
+            } else {
+              feasign_cnt += cnt;
+            }
+          }
+        }
+        return failed ? -1 : feasign_cnt;
+      });
+#else
+  VLOG(0) << "FleetWrapper::SaveModelAsync does nothing when no pslib";
+#endif
+}
+
+int32_t FleetWrapper::WaitSaveModel() {
+#ifdef PADDLE_WITH_PSLIB
+  if (!save_model_future_.valid()) {
+    VLOG(0) << "FleetWrapper::WaitSaveModel no model is being saved";
+    return 0;
+  }
+  int32_t feasign_cnt = save_model_future_.get();
+  if (feasign_cnt == -1) {
+    LOG(ERROR) << "save model failed";
+    sleep(sleep_seconds_before_fail_exit_);
+    exit(-1);
+  }
+  return feasign_cnt;
+#else
+  VLOG(0) << "FleetWrapper::WaitSaveModel does nothing when no pslib";
+  return 0;
+#endif
+}
+
 void FleetWrapper::PrintTableStat(const uint64_t table_id) {
 #ifdef PADDLE_WITH_PSLIB
   auto ret = pslib_ptr_->_worker_ptr->print_table_stat(table_id);
@@ -22,6 +22,7 @@ limitations under the License. */
 #include <ThreadPool.h>
 #include <atomic>
 #include <ctime>
+#include <future>  // NOLINT
 #include <map>
 #include <random>
 #include <string>
@@ -201,9 +202,24 @@ class FleetWrapper {
   // mode = 1, laod delta feature, which means load diff
   void LoadModelOneTable(const uint64_t table_id, const std::string& path,
                          const int mode);
+  // load the tables in parallel, the requests of all the tables are sent
+  // before waiting for any of them
+  void LoadModelTables(const std::vector<uint64_t>& table_ids,
+                       const std::string& path, const int mode);
   // mode = 0, save all feature
   // mode = 1, save delta feature, which means save diff
   void SaveModel(const std::string& path, const int mode);
+  // save the tables in the background and return at once, so that the
+  // training goes on while the servers dump the tables. At most parallelism
+  // tables are saved at the same time to bound the io of the servers, and
+  // all the tables are saved by one request if table_ids is empty.
+  // The tables are saved as the servers see them, which are still updated
+  // by the training, call ClientFlush before for a consistent checkpoint.
+  void SaveModelAsync(const std::string& path, const int mode,
+                      const std::vector<uint64_t>& table_ids,
+                      int parallelism);
+  // wait for the model saved by SaveModelAsync, return the feasign num
+  int32_t WaitSaveModel();
   // get save cache threshold
   double GetCacheThreshold(int table_id);
   // shuffle cache model between servers
@@ -266,6 +282,8 @@ class FleetWrapper {
   int pull_local_thread_num_;
   std::unique_ptr<::ThreadPool> pull_to_local_pool_{nullptr};
   int local_table_shard_num_;
+  std::unique_ptr<::ThreadPool> save_model_pool_{nullptr};
+  std::future<int32_t> save_model_future_;
   DISABLE_COPY_AND_ASSIGN(FleetWrapper);
 };
 
@@ -141,6 +141,8 @@ bool HdfsStore::Check(const std::vector<std::string>& keys) {
 namespace paddle {
 namespace framework {
 
+std::shared_ptr<GlooWrapper> GlooWrapper::s_instance_ = nullptr;
+
 void GlooWrapper::Init(int rank, int size, const std::string& path,
                        const std::string& fs_name, const std::string& fs_ugi,
                        const std::string& iface, const std::string& prefix) {
@@ -149,22 +151,69 @@ void GlooWrapper::Init(int rank, int size, const std::string& path,
   }
   rank_ = rank;
   size_ = size;
+  path_ = path;
+  iface_ = iface;
+  prefix_ = prefix;
   std::string cmd = std::string("${HADOOP_HOME}/bin/hadoop fs");
   cmd += " -D fs.default.name=" + fs_name;
   cmd += " -D hadoop.job.ugi=" + fs_ugi;
   paddle::framework::hdfs_set_command(cmd);
 #ifdef PADDLE_WITH_GLOO
+  context_ = CreateContext(prefix);
+#endif
+  is_initialized_ = true;
+}
+
+#ifdef PADDLE_WITH_GLOO
+std::shared_ptr<gloo::Context> GlooWrapper::CreateContext(
+    const std::string& prefix) {
   gloo::transport::tcp::attr attr;
-  attr.iface = iface;
-  auto file_store = gloo::rendezvous::HdfsStore(path);
+  attr.iface = iface_;
+  auto file_store = gloo::rendezvous::HdfsStore(path_);
   auto prefix_store = gloo::rendezvous::PrefixStore(prefix, file_store);
   auto dev = gloo::transport::tcp::CreateDevice(attr);
-  auto context = std::make_shared<gloo::rendezvous::Context>(rank, size);
+  auto context = std::make_shared<gloo::rendezvous::Context>(rank_, size_);
   context->setTimeout(file_store.wait_timeout_);
   context->connectFullMesh(prefix_store, dev);
-  context_ = std::move(context);
+  return context;
+}
+#endif
+
+void GlooWrapper::InitDenseRings(int ring_num) {
+  CHECK_EQ(is_initialized_, true);
+  if (dense_ring_num_ > 0) {
+    return;
+  }
+  PADDLE_ENFORCE_GT(ring_num, 0,
+                    paddle::platform::errors::InvalidArgument(
+                        "The number of the dense rings should be positive, "
+                        "but got %d.",
+                        ring_num));
+#ifdef PADDLE_WITH_GLOO
+  for (int i = 0; i < ring_num; ++i) {
+    dense_rings_.push_back(
+        CreateContext(prefix_ + "_dense_ring_" + std::to_string(i)));
+    dense_ring_mutexes_.emplace_back(new std::mutex());
+  }
+  dense_ring_pool_.reset(new ::ThreadPool(ring_num));
+  dense_ring_num_ = ring_num;
+#endif
+  VLOG(3) << "gloo rank " << rank_ << " creates " << dense_ring_num_
+          << " dense rings";
+}
+
+void GlooWrapper::BroadcastDense(void* data, size_t bytes, int root) {
+  CHECK_EQ(is_initialized_, true);
+  if (dense_ring_num_ == 0 || size_ <= 1 || bytes == 0) {
+    return;
+  }
+#ifdef PADDLE_WITH_GLOO
+  std::lock_guard<std::mutex> guard(*dense_ring_mutexes_[0]);
+  gloo::BroadcastOptions opts(dense_rings_[0]);
+  opts.setOutput(static_cast<char*>(data), bytes);
+  opts.setRoot(root);
+  gloo::broadcast(opts);
 #endif
-  is_initialized_ = true;
 }
 
 template std::vector<int64_t> GlooWrapper::AllReduce<int64_t>(
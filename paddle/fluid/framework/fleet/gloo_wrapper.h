@@ -20,8 +20,12 @@ limitations under the License. */
 #include <sys/types.h>
 #include <unistd.h>
 #endif
+#include <ThreadPool.h>
+#include <algorithm>
+#include <future>  // NOLINT
 #include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,6 +33,7 @@ limitations under the License. */
 #include <gloo/allgather.h>
 #include <gloo/allreduce.h>
 #include <gloo/barrier.h>
+#include <gloo/broadcast.h>
 #include <gloo/rendezvous/context.h>
 #include <gloo/rendezvous/file_store.h>
 #include <gloo/rendezvous/prefix_store.h>
@@ -89,6 +94,22 @@ class GlooWrapper {
             const std::string& fs_name, const std::string& fs_ugi,
             const std::string& iface, const std::string& prefix);
 
+  // Create ring_num rings besides the context of Barrier/AllReduce/AllGather
+  // to reduce the dense gradients in the collective training on CPU.
+  // A buffer is cut into chunks reduced on the rings at the same time, so
+  // that more tcp connections are used for the big fused gradients.
+  void InitDenseRings(int ring_num);
+
+  int DenseRingNum() const { return dense_ring_num_; }
+
+  // GlooWrapper singleton used by the all reduce op handles
+  static std::shared_ptr<GlooWrapper> GetInstance() {
+    if (NULL == s_instance_) {
+      s_instance_.reset(new paddle::framework::GlooWrapper());
+    }
+    return s_instance_;
+  }
+
   int Rank() {
     CHECK_EQ(is_initialized_, true);
     return rank_;
@@ -151,13 +172,69 @@ class GlooWrapper {
     return std::move(ret);
   }
 
+  // Sum the buffers of all the ranks in place on the dense rings.
+  template <typename T>
+  void AllReduceDense(T* data, size_t count) {
+    CHECK_EQ(is_initialized_, true);
+    if (dense_ring_num_ == 0 || size_ <= 1 || count == 0) {
+      return;
+    }
+#ifdef PADDLE_WITH_GLOO
+    size_t chunk_num = std::max<size_t>(
+        std::min<size_t>(dense_ring_num_, count * sizeof(T) / kMinChunkBytes),
+        1);
+    std::vector<std::future<void>> fs;
+    for (size_t i = 0; i < chunk_num; ++i) {
+      size_t begin = count * i / chunk_num;
+      size_t end = count * (i + 1) / chunk_num;
+      auto all_reduce = [this, data, begin, end, i] {
+        std::lock_guard<std::mutex> guard(*dense_ring_mutexes_[i]);
+        gloo::AllreduceOptions opts(dense_rings_[i]);
+        opts.setOutput(data + begin, end - begin);
+        opts.setReduceFunction(
+            static_cast<void (*)(void*, const void*, const void*, size_t)>(
+                &gloo::sum<T>));
+        gloo::allreduce(opts);
+      };
+      if (i + 1 == chunk_num) {
+        all_reduce();
+      } else {
+        fs.push_back(dense_ring_pool_->enqueue(all_reduce));
+      }
+    }
+    for (auto& f : fs) {
+      f.get();
+    }
+#endif
+  }
+
+  // Broadcast the bytes of the root rank on the first dense ring.
+  void BroadcastDense(void* data, size_t bytes, int root);
+
  protected:
+  // the chunks smaller than this are not reduced on their own ring
+  static constexpr size_t kMinChunkBytes = 256 * 1024;
+
+#ifdef PADDLE_WITH_GLOO
+  std::shared_ptr<gloo::Context> CreateContext(const std::string& prefix);
+#endif
+
   bool is_initialized_ = false;
 #ifdef PADDLE_WITH_GLOO
   std::shared_ptr<gloo::Context> context_ = nullptr;
+  std::vector<std::shared_ptr<gloo::Context>> dense_rings_;
+  std::vector<std::unique_ptr<std::mutex>> dense_ring_mutexes_;
+  std::unique_ptr<::ThreadPool> dense_ring_pool_{nullptr};
 #endif
   int rank_ = 0;
   int size_ = 0;
+  int dense_ring_num_ = 0;
+  std::string path_;
+  std::string iface_;
+  std::string prefix_;
+
+ private:
+  static std::shared_ptr<GlooWrapper> s_instance_;
 };
 
 }  // namespace framework
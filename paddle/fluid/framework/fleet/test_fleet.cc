@@ -52,6 +52,10 @@ TEST(TEST_GLOO, store_1) {
   gw.AllReduce(input);
   int64_t t;
   gw.AllGather(t);
+  gw.InitDenseRings(2);
+  std::vector<float> grad(8, 1.f);
+  gw.AllReduceDense(grad.data(), grad.size());
+  gw.BroadcastDense(grad.data(), grad.size() * sizeof(float), 0);
 #endif
 #endif
 }
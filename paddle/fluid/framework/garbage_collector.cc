@@ -28,26 +28,69 @@
 DECLARE_double(eager_delete_tensor_gb);
 DECLARE_double(memory_fraction_of_eager_deletion);
 DECLARE_bool(fast_eager_deletion_mode);
+DECLARE_int32(eager_delete_batch_size);
 
 namespace paddle {
 namespace framework {
 
 GarbageCollector::GarbageCollector(const platform::Place &place,
                                    size_t max_memory_size)
-    : max_memory_size_((std::max)(max_memory_size, static_cast<size_t>(1))) {
+    : max_memory_size_((std::max)(max_memory_size, static_cast<size_t>(1))),
+      batch_size_(static_cast<size_t>(
+          (std::max)(FLAGS_eager_delete_batch_size, 0))) {
   garbages_.reset(new GarbageQueue());
   dev_ctx_ = platform::DeviceContextPool::Instance().Get(place);
-  if (max_memory_size_ > 1) {
+  if (max_memory_size_ > 1 || batch_size_ > 1) {
     mutex_.reset(new std::mutex());
   }
 }
 
+void GarbageCollector::Wait() const {
+  if (release_thread_) {
+    // the release thread runs the tasks in order
+    release_thread_->Run([] {}).wait();
+  }
+}
+
+void GarbageCollector::Flush() {
+  if (max_memory_size_ > 1 || batch_size_ <= 1) {
+    return;
+  }
+  GarbageQueue *batch = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(*mutex_);
+    batch_add_num_ = 0;
+    if (garbages_->empty()) {
+      return;
+    }
+    batch = garbages_.release();
+    garbages_.reset(new GarbageQueue());
+  }
+  WaitComputeBeforeClear();
+  ClearCallback([batch] { delete batch; });
+}
+
+void GarbageCollector::RunOnReleaseThread(
+    const std::function<void()> &callback) {
+  if (batch_size_ <= 1 || max_memory_size_ > 1) {
+    callback();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(*mutex_);
+    if (!release_thread_) {
+      release_thread_.reset(new ThreadPool(1));
+    }
+  }
+  release_thread_->Run(callback);
+}
+
 CPUGarbageCollector::CPUGarbageCollector(const platform::CPUPlace &place,
                                          size_t max_memory_size)
     : GarbageCollector(place, max_memory_size) {}
 
 void CPUGarbageCollector::ClearCallback(const std::function<void()> &callback) {
-  callback();
+  RunOnReleaseThread(callback);
 }
 
 #ifdef PADDLE_WITH_CUDA
@@ -57,7 +100,7 @@ UnsafeFastGPUGarbageCollector::UnsafeFastGPUGarbageCollector(
 
 void UnsafeFastGPUGarbageCollector::ClearCallback(
     const std::function<void()> &callback) {
-  callback();
+  RunOnReleaseThread(callback);
 }
 
 DefaultStreamGarbageCollector::DefaultStreamGarbageCollector(
@@ -88,6 +131,22 @@ StreamGarbageCollector::~StreamGarbageCollector() {
   platform::CUDADeviceGuard guard(place.device);
   PADDLE_ENFORCE(cudaStreamSynchronize(stream_));
   PADDLE_ENFORCE(cudaStreamDestroy(stream_));
+  if (flush_event_) {
+    PADDLE_ENFORCE(cudaEventDestroy(flush_event_));
+  }
+}
+
+void StreamGarbageCollector::WaitComputeBeforeClear() {
+  auto place = boost::get<platform::CUDAPlace>(this->dev_ctx_->GetPlace());
+  platform::CUDADeviceGuard guard(place.device);
+  if (flush_event_ == nullptr) {
+    PADDLE_ENFORCE(
+        cudaEventCreateWithFlags(&flush_event_, cudaEventDisableTiming));
+  }
+  auto compute_stream =
+      static_cast<platform::CUDADeviceContext *>(this->dev_ctx_)->stream();
+  PADDLE_ENFORCE(cudaEventRecord(flush_event_, compute_stream));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(stream_, flush_event_, 0));
 }
 
 cudaStream_t StreamGarbageCollector::stream() const { return stream_; }
@@ -20,6 +20,7 @@
 #include <mutex>  // NOLINT
 #include <utility>
 #include "gflags/gflags.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
@@ -33,7 +34,8 @@ class GarbageCollector {
 
   virtual ~GarbageCollector() PADDLE_MAY_THROW {}
 
-  virtual void Wait() const {}
+  // Wait for the garbages released on the release thread.
+  virtual void Wait() const;
 
   template <typename Container>
   void Add(Container &&objs);
@@ -41,14 +43,30 @@ class GarbageCollector {
   template <typename Container, typename Callback>
   void Add(Container &&objs, Callback &&callback);
 
+  // Release the garbages of the unfinished batch, e.g. at the end of a step.
+  void Flush();
+
  protected:
   virtual void ClearCallback(const std::function<void()> &callback) = 0;
 
+  // Make the clear callbacks wait for the kernels launched before, called
+  // before flushing the batch without the callback of Add.
+  virtual void WaitComputeBeforeClear() {}
+
+  // Run callback on the release thread in the batched mode, otherwise run
+  // it at once.
+  void RunOnReleaseThread(const std::function<void()> &callback);
+
   platform::DeviceContext *dev_ctx_;
   std::unique_ptr<GarbageQueue> garbages_;
   mutable std::unique_ptr<std::mutex> mutex_;
   const size_t max_memory_size_;
   size_t cur_memory_size_{0};
+
+  // the number of Add calls of the garbages released in one batch
+  const size_t batch_size_;
+  size_t batch_add_num_{0};
+  std::unique_ptr<ThreadPool> release_thread_;
 };
 
 class CPUGarbageCollector : public GarbageCollector {
@@ -94,8 +112,11 @@ class StreamGarbageCollector : public GarbageCollector {
  protected:
   void ClearCallback(const std::function<void()> &callback) override;
 
+  void WaitComputeBeforeClear() override;
+
  private:
   cudaStream_t stream_;
+  cudaEvent_t flush_event_{nullptr};
   std::unique_ptr<platform::StreamCallbackManager> callback_manager_;
 };
 #endif
@@ -107,6 +128,30 @@ void GarbageCollector::Add(Container &&objs) {
 
 template <typename Container, typename Callback>
 void GarbageCollector::Add(Container &&objs, Callback &&callback) {
+  // Release the garbages of batch_size_ ops by one clear callback, with the
+  // callback of the last one, which makes the callback wait for the kernels
+  // of all the ops launched before on the same stream.
+  if (max_memory_size_ <= 1 && batch_size_ > 1) {
+    GarbageQueue *batch = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(*mutex_);
+      for (auto &obj : objs) {
+        if (!obj) continue;
+        garbages_->push_back(std::move(obj));
+      }
+      if (++batch_add_num_ >= batch_size_) {
+        batch_add_num_ = 0;
+        batch = garbages_.release();
+        garbages_.reset(new GarbageQueue());
+      }
+    }
+    if (batch) {
+      callback();
+      ClearCallback([batch] { delete batch; });
+    }
+    return;
+  }
+
   // Special case when FLAGS_eager_delete_tensor_gb=0.0
   // It speeds up GC about 2~3%.
   if (max_memory_size_ <= 1) {
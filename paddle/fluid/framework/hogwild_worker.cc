@@ -12,12 +12,17 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <functional>
+#include <mutex>  // NOLINT
+#include <unordered_set>
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/lodtensor_printer.h"
+#include "paddle/fluid/platform/numa.h"
 
 namespace paddle {
 namespace framework {
@@ -66,6 +71,9 @@ void HogwildWorker::CreateThreadScope(const ProgramDesc &program) {
       root_scope_, "root_scope should be set before creating thread scope");
 
   thread_scope_ = &root_scope_->NewScope();
+  // place the thread scope on the node of the worker thread, since it is
+  // created by the main thread
+  platform::NumaNodeGuard numa_guard(numa_node_);
 
   for (auto &var : block.AllVars()) {
     if (var->Persistable()) {
@@ -112,11 +120,119 @@ void HogwildWorker::BindingDataFeedMemory() {
 
 void HogwildWorker::CreateDeviceResource(const ProgramDesc &main_prog) {
   CreateThreadScope(main_prog);
+  CreateLocalParams(main_prog);
   CreateThreadOperators(main_prog);
 }
 
+// The padded size of the local params, so that the local params of the
+// threads never share a cache line, as the allocations are aligned.
+static constexpr size_t kLocalParamAlignment = 64;
+
+// The merges of a param by the threads are serialized by one of the mutexes.
+static std::mutex &LocalParamMutex(const std::string &name) {
+  static std::mutex mutexes[64];
+  return mutexes[std::hash<std::string>()(name) % 64];
+}
+
+void HogwildWorker::CreateLocalParams(const ProgramDesc &program) {
+  local_params_.clear();
+  int64_t max_numel = param_.local_param_max_numel();
+  if (max_numel <= 0) {
+    return;
+  }
+  // the params updated in place by the optimizers
+  std::unordered_set<std::string> params;
+  for (auto *op_desc : program.Block(0).AllOps()) {
+    if (!op_desc->Input("Param").empty() &&
+        !op_desc->Output("ParamOut").empty()) {
+      params.insert(op_desc->Input("Param")[0]);
+    }
+  }
+
+  platform::NumaNodeGuard numa_guard(numa_node_);
+  for (auto &name : params) {
+    if (stat_var_name_map_.count(name) > 0) {
+      continue;
+    }
+    auto *root_var = root_scope_->FindVar(name);
+    if (root_var == nullptr || !root_var->IsType<LoDTensor>()) {
+      continue;
+    }
+    auto *root = root_var->GetMutable<LoDTensor>();
+    if (!root->IsInitialized() || !platform::is_cpu_place(root->place()) ||
+        root->numel() > max_numel ||
+        (root->type() != proto::VarType::FP32 &&
+         root->type() != proto::VarType::FP64)) {
+      continue;
+    }
+    auto *local = thread_scope_->Var(name)->GetMutable<LoDTensor>();
+    size_t bytes = root->numel() * SizeOfType(root->type());
+    size_t padded = (bytes + kLocalParamAlignment - 1) /
+                    kLocalParamAlignment * kLocalParamAlignment;
+    local->Resize(root->dims());
+    local->mutable_data(platform::CPUPlace(), root->type(), padded);
+    local_params_.emplace_back();
+    auto &local_param = local_params_.back();
+    local_param.name = name;
+    local_param.root = root;
+    local_param.local = local;
+    local_param.base.Resize(root->dims());
+    local_param.base.mutable_data(platform::CPUPlace(), root->type(), padded);
+    {
+      std::lock_guard<std::mutex> lock(LocalParamMutex(name));
+      memcpy(local->data<void>(), root->data<void>(), bytes);
+    }
+    memcpy(local_param.base.data<void>(), local->data<void>(), bytes);
+  }
+  VLOG(3) << "Thread " << thread_id_ << " updates " << local_params_.size()
+          << " params locally";
+}
+
+template <typename T>
+static void MergeLocalParam(const T *base, T *local, T *root, int64_t numel) {
+  for (int64_t i = 0; i < numel; ++i) {
+    root[i] += local[i] - base[i];
+    local[i] = root[i];
+  }
+}
+
+void HogwildWorker::MergeLocalParams() {
+  for (auto &param : local_params_) {
+    int64_t numel = param.root->numel();
+    {
+      std::lock_guard<std::mutex> lock(LocalParamMutex(param.name));
+      if (param.root->type() == proto::VarType::FP32) {
+        MergeLocalParam<float>(param.base.data<float>(),
+                               param.local->data<float>(),
+                               param.root->data<float>(), numel);
+      } else {
+        MergeLocalParam<double>(param.base.data<double>(),
+                                param.local->data<double>(),
+                                param.root->data<double>(), numel);
+      }
+    }
+    memcpy(param.base.data<void>(), param.local->data<void>(),
+           numel * SizeOfType(param.root->type()));
+  }
+  batches_since_merge_ = 0;
+}
+
+void HogwildWorker::MaybeMergeLocalParams() {
+  if (local_params_.empty()) {
+    return;
+  }
+  if (++batches_since_merge_ >= param_.local_param_merge_period()) {
+    MergeLocalParams();
+  }
+}
+
 void HogwildWorker::TrainFilesWithProfiler() {
   platform::SetNumThreads(1);
+  if (numa_node_ >= 0) {
+    platform::BindThreadToNumaNode(numa_node_);
+  }
+  // the compute pool overrides the CPUs of the NUMA node if it is set
+  platform::BindThreadToCpuPool(platform::CpuPool::kCompute);
   device_reader_->Start();
   std::vector<double> op_total_time;
   std::vector<std::string> op_name;
@@ -202,6 +318,7 @@ void HogwildWorker::TrainFilesWithProfiler() {
 
     total_inst += cur_batch;
     ++batch_cnt;
+    MaybeMergeLocalParams();
     PrintFetchVars();
     if (thread_id_ == 0) {
       if (batch_cnt > 0 && batch_cnt % 100 == 0) {
@@ -221,6 +338,9 @@ void HogwildWorker::TrainFilesWithProfiler() {
   if (need_dump_field_) {
     writer_.Flush();
   }
+  if (!local_params_.empty()) {
+    MergeLocalParams();
+  }
 
 #ifdef PADDLE_WITH_DISTRIBUTE
   if (thread_barrier_) {
@@ -236,6 +356,11 @@ void HogwildWorker::SetChannelWriter(ChannelObject<std::string> *queue) {
 
 void HogwildWorker::TrainFiles() {
   platform::SetNumThreads(1);
+  if (numa_node_ >= 0) {
+    platform::BindThreadToNumaNode(numa_node_);
+  }
+  // the compute pool overrides the CPUs of the NUMA node if it is set
+  platform::BindThreadToCpuPool(platform::CpuPool::kCompute);
 
   // how to accumulate fetched values here
   device_reader_->Start();
@@ -254,9 +379,13 @@ void HogwildWorker::TrainFiles() {
       }
     }
 
+    MaybeMergeLocalParams();
     PrintFetchVars();
     thread_scope_->DropKids();
   }
+  if (!local_params_.empty()) {
+    MergeLocalParams();
+  }
 #ifdef PADDLE_WITH_DISTRIBUTE
   if (thread_barrier_) {
     operators::distributed::Communicator::GetInstance()
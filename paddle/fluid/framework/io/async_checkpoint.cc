@@ -0,0 +1,256 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/async_checkpoint.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+DECLARE_uint64(async_checkpoint_max_pending_mb);
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+// Write the std::ostream of SerializeToStream to the FILE of fs_open_write.
+class FileStreamBuf : public std::streambuf {
+ public:
+  explicit FileStreamBuf(FILE* fp) : fp_(fp) {}
+
+ protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    return static_cast<std::streamsize>(
+        fwrite(s, 1, static_cast<size_t>(n), fp_));
+  }
+
+  int_type overflow(int_type ch) override {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+      return traits_type::not_eof(ch);
+    }
+    char c = traits_type::to_char_type(ch);
+    return fwrite(&c, 1, 1, fp_) == 1 ? ch : traits_type::eof();
+  }
+
+ private:
+  FILE* fp_;
+};
+
+// Copy the tensor to the host memory, which is pinned if the tensor is on
+// GPU, the copy from GPU is done after dev_ctx.Wait().
+LoDTensor Snapshot(const LoDTensor& tensor,
+                   const platform::DeviceContext& dev_ctx) {
+  size_t bytes = tensor.numel() * SizeOfType(tensor.type());
+  auto& place = tensor.place();
+  std::shared_ptr<memory::Allocation> buffer;
+  if (platform::is_gpu_place(place)) {
+#ifdef PADDLE_WITH_CUDA
+    buffer = memory::AllocShared(platform::CUDAPinnedPlace(), bytes);
+    memory::Copy(platform::CUDAPinnedPlace(), buffer->ptr(),
+                 boost::get<platform::CUDAPlace>(place), tensor.data<void>(),
+                 bytes,
+                 static_cast<const platform::CUDADeviceContext&>(dev_ctx)
+                     .stream());
+#else
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "CUDAPlace is not supported when not compiled with CUDA"));
+#endif
+  } else {
+    buffer = memory::AllocShared(platform::CPUPlace(), bytes);
+    if (bytes > 0) {
+      std::memcpy(buffer->ptr(), tensor.data<void>(), bytes);
+    }
+  }
+  LoDTensor snapshot;
+  snapshot.Resize(tensor.dims());
+  snapshot.set_lod(tensor.lod());
+  snapshot.ResetHolderWithType(buffer, tensor.type());
+  return snapshot;
+}
+
+}  // namespace
+
+AsyncCheckpointWriter& AsyncCheckpointWriter::Instance() {
+  // never destroyed, the checkpoints pending at exit should be waited for
+  // explicitly, e.g. by the atexit of fluid.io
+  static auto* writer = new AsyncCheckpointWriter();
+  return *writer;
+}
+
+void AsyncCheckpointWriter::Save(const std::string& path,
+                                 const std::vector<const LoDTensor*>& tensors,
+                                 const platform::DeviceContext& dev_ctx,
+                                 bool indexed) {
+  size_t bytes = 0;
+  for (auto* tensor : tensors) {
+    bytes += tensor->numel() * SizeOfType(tensor->type());
+  }
+  size_t max_pending_bytes = FLAGS_async_checkpoint_max_pending_mb << 20;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    // a checkpoint larger than the bound is saved once nothing is pending
+    cv_.wait(lock, [&] {
+      return error_ != nullptr || pending_bytes_ == 0 ||
+             pending_bytes_ + bytes <= max_pending_bytes;
+    });
+    ThrowErrorIfAny();
+    pending_bytes_ += bytes;
+    ++num_pending_;
+  }
+
+  Checkpoint checkpoint;
+  checkpoint.path = path;
+  checkpoint.bytes = bytes;
+  checkpoint.indexed = indexed;
+  try {
+    for (auto* tensor : tensors) {
+      checkpoint.snapshots.emplace_back(Snapshot(*tensor, dev_ctx));
+    }
+    dev_ctx.Wait();
+  } catch (...) {
+    std::lock_guard<std::mutex> guard(mu_);
+    pending_bytes_ -= bytes;
+    --num_pending_;
+    cv_.notify_all();
+    throw;
+  }
+
+  std::lock_guard<std::mutex> guard(mu_);
+  checkpoints_.emplace_back(std::move(checkpoint));
+  if (thread_ == nullptr) {
+    thread_.reset(new std::thread(&AsyncCheckpointWriter::WriteLoop, this));
+  }
+  cv_.notify_all();
+}
+
+void AsyncCheckpointWriter::Wait() {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this] { return num_pending_ == 0; });
+  ThrowErrorIfAny();
+}
+
+size_t AsyncCheckpointWriter::NumPending() const {
+  std::lock_guard<std::mutex> guard(mu_);
+  return num_pending_;
+}
+
+void AsyncCheckpointWriter::ThrowErrorIfAny() {
+  if (error_ != nullptr) {
+    auto error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void AsyncCheckpointWriter::WriteLoop() {
+  while (true) {
+    Checkpoint checkpoint;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this] { return !checkpoints_.empty(); });
+      checkpoint = std::move(checkpoints_.front());
+      checkpoints_.pop_front();
+    }
+    std::exception_ptr error;
+    try {
+      Write(checkpoint);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // free the snapshots before the bytes are released
+    size_t bytes = checkpoint.bytes;
+    checkpoint.snapshots.clear();
+    std::lock_guard<std::mutex> guard(mu_);
+    if (error != nullptr && error_ == nullptr) {
+      error_ = error;
+    }
+    pending_bytes_ -= bytes;
+    --num_pending_;
+    cv_.notify_all();
+  }
+}
+
+void AsyncCheckpointWriter::Write(const Checkpoint& checkpoint) {
+  VLOG(3) << "write the checkpoint of " << checkpoint.snapshots.size()
+          << " tensors to " << checkpoint.path;
+  std::string tmp_path = checkpoint.path + ".tmp";
+  auto serialize = [&checkpoint](std::ostream& os) {
+    // the snapshots are in the host memory
+    platform::CPUDeviceContext dev_ctx;
+    if (checkpoint.indexed) {
+      std::vector<const LoDTensor*> tensors;
+      for (auto& snapshot : checkpoint.snapshots) {
+        tensors.push_back(&snapshot);
+      }
+      SerializeIndexedToStream(os, tensors, dev_ctx);
+    } else {
+      for (auto& snapshot : checkpoint.snapshots) {
+        SerializeToStream(os, snapshot, dev_ctx);
+      }
+    }
+  };
+
+  // the local files are written and renamed without forking the shell
+  if (fs_select_internal(checkpoint.path) == 0) {
+    {
+      std::ofstream fout(tmp_path, std::ios::binary);
+      PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                        platform::errors::Unavailable(
+                            "Cannot open %s to write the checkpoint.",
+                            tmp_path));
+      serialize(fout);
+      fout.close();
+      PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                        platform::errors::Unavailable(
+                            "Failed to write the checkpoint to %s.",
+                            tmp_path));
+    }
+#ifdef _WIN32
+    // rename does not replace the existing file on windows
+    std::remove(checkpoint.path.c_str());
+#endif
+    PADDLE_ENFORCE_EQ(
+        std::rename(tmp_path.c_str(), checkpoint.path.c_str()), 0,
+        platform::errors::Unavailable("Failed to rename %s to %s.", tmp_path,
+                                      checkpoint.path));
+    return;
+  }
+
+  {
+    int err_no = 0;
+    std::shared_ptr<FILE> fp = fs_open_write(tmp_path, &err_no, "");
+    PADDLE_ENFORCE_EQ(fp != nullptr && err_no == 0, true,
+                      platform::errors::Unavailable(
+                          "Cannot open %s to write the checkpoint.", tmp_path));
+    FileStreamBuf buf(fp.get());
+    std::ostream os(&buf);
+    serialize(os);
+    PADDLE_ENFORCE_EQ(
+        static_cast<bool>(os) && fflush(fp.get()) == 0 && !ferror(fp.get()),
+        true, platform::errors::Unavailable(
+                  "Failed to write the checkpoint to %s.", tmp_path));
+  }
+  fs_mv(tmp_path, checkpoint.path);
+}
+
+}  // namespace framework
+}  // namespace paddle
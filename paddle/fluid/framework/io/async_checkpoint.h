@@ -0,0 +1,92 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * AsyncCheckpointWriter saves the LoDTensors without stalling the training,
+ * for the async mode of save_op and save_combine_op. Save copies the tensors
+ * into the host memory, which is pinned for the GPU tensors, and returns once
+ * the copies are done, then a background thread writes the copies, through
+ * fs_open_write if the path is not local, e.g. on HDFS.
+ *
+ * The copies pending are bounded by FLAGS_async_checkpoint_max_pending_mb,
+ * Save blocks until the earlier checkpoints are written if the bound is
+ * exceeded. A checkpoint is written to a temporary file which is renamed to
+ * the path at last, so the path holds either the old or the new checkpoint
+ * completely. The checkpoints are written in the order of Save.
+ *
+ * The errors of writing are thrown by the next Save or Wait.
+ */
+class AsyncCheckpointWriter {
+ public:
+  static AsyncCheckpointWriter& Instance();
+
+  // The tensors are written in the format of SerializeToStream one by one,
+  // or in the indexed format if indexed is true.
+  void Save(const std::string& path,
+            const std::vector<const LoDTensor*>& tensors,
+            const platform::DeviceContext& dev_ctx, bool indexed = false);
+
+  // Wait for the checkpoints saved to be written.
+  void Wait();
+
+  // The number of the checkpoints saved but not written yet.
+  size_t NumPending() const;
+
+ private:
+  struct Checkpoint {
+    std::string path;
+    std::vector<LoDTensor> snapshots;
+    size_t bytes;
+    bool indexed;
+  };
+
+  AsyncCheckpointWriter() = default;
+
+  void ThrowErrorIfAny();
+
+  void WriteLoop();
+
+  void Write(const Checkpoint& checkpoint);
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Checkpoint> checkpoints_;
+  // the bytes of the checkpoints pending, including the one being written
+  size_t pending_bytes_{0};
+  size_t num_pending_{0};
+  std::exception_ptr error_;
+  std::unique_ptr<std::thread> thread_;
+
+  DISABLE_COPY_AND_ASSIGN(AsyncCheckpointWriter);
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,67 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/async_checkpoint.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+TEST(AsyncCheckpointWriter, save) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext dev_ctx(place);
+  LoDTensor a, b;
+  a.Resize({2, 3});
+  a.set_lod({{0, 1, 2}});
+  float* a_data = a.mutable_data<float>(place);
+  for (int i = 0; i < 6; ++i) {
+    a_data[i] = static_cast<float>(i);
+  }
+  b.Resize({4});
+  int* b_data = b.mutable_data<int>(place);
+  for (int i = 0; i < 4; ++i) {
+    b_data[i] = -i;
+  }
+
+  auto& writer = AsyncCheckpointWriter::Instance();
+  std::string path = "async_checkpoint_test.bin";
+  writer.Save(path, {&a, &b}, dev_ctx);
+  // the tensors are copied when saved
+  a_data[0] = 100;
+  writer.Wait();
+  EXPECT_EQ(writer.NumPending(), 0UL);
+
+  std::ifstream fin(path, std::ios::binary);
+  ASSERT_TRUE(static_cast<bool>(fin));
+  LoDTensor a_loaded, b_loaded;
+  DeserializeFromStream(fin, &a_loaded, dev_ctx);
+  DeserializeFromStream(fin, &b_loaded, dev_ctx);
+  EXPECT_EQ(a_loaded.lod(), a.lod());
+  EXPECT_EQ(a_loaded.data<float>()[0], 0);
+  EXPECT_EQ(a_loaded.data<float>()[5], 5);
+  EXPECT_EQ(b_loaded.data<int>()[3], -3);
+  fin.close();
+  std::remove(path.c_str());
+
+  // the error of writing is thrown by Wait, once
+  writer.Save("async_checkpoint_test_none/dir/test.bin", {&a}, dev_ctx);
+  EXPECT_THROW(writer.Wait(), platform::EnforceNotMet);
+  writer.Wait();
+}
+
+}  // namespace framework
+}  // namespace paddle
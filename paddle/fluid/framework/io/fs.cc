@@ -13,7 +13,18 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/io/fs.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <limits>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#if defined(__linux__)
+#include "paddle/fluid/platform/dynload/hdfs.h"
+#endif
 
 namespace paddle {
 namespace framework {
@@ -232,8 +243,254 @@ void set_download_command(const std::string& x) {
   customized_download_cmd_internal() = x;
 }
 
+static bool& hdfs_native_read_internal() {
+  static bool x = false;
+  return x;
+}
+
+static size_t& hdfs_native_chunk_size_internal() {
+  static size_t x = 8 << 20;
+  return x;
+}
+
+static int& hdfs_native_parallelism_internal() {
+  static int x = 4;
+  return x;
+}
+
+static std::pair<std::string, std::string>& hdfs_native_config_internal() {
+  static std::pair<std::string, std::string> x = {"default", ""};
+  return x;
+}
+
+bool hdfs_native_read() { return hdfs_native_read_internal(); }
+
+void hdfs_set_native_read(bool x, size_t chunk_size, int parallelism) {
+  CHECK_GT(chunk_size, 0);
+  CHECK_GT(parallelism, 0);
+  hdfs_native_read_internal() = x;
+  hdfs_native_chunk_size_internal() = chunk_size;
+  hdfs_native_parallelism_internal() = parallelism;
+}
+
+void hdfs_set_native_config(const std::string& fs_name,
+                            const std::string& fs_ugi) {
+  // hadoop.job.ugi is "user,passwd", libhdfs only takes the user
+  hdfs_native_config_internal() = {fs_name == "" ? "default" : fs_name,
+                                   fs_ugi.substr(0, fs_ugi.find(','))};
+}
+
+#if defined(__linux__)
+namespace {
+
+// Reads a file by `parallelism` positional reads of `chunk_size` bytes in
+// flight, e.g. through libhdfs, so the data never goes through a pipe and
+// a single file can use more than one datanode connection. The first failed
+// read fails the stream: the chunks after it are dropped, and the current
+// and all the later reads return -1, so the caller never sees a hole.
+class RangeReader {
+ public:
+  RangeReader(int64_t file_size, size_t chunk_size, int parallelism,
+              std::function<int64_t(int64_t, char*, size_t)> read_range,
+              std::function<void()> close)
+      : file_size_(file_size),
+        chunk_size_(chunk_size),
+        parallelism_(parallelism),
+        read_range_(std::move(read_range)),
+        close_(std::move(close)) {
+    Prefetch();
+  }
+
+  ~RangeReader() {
+    Drain();
+    if (close_) {
+      close_();
+    }
+  }
+
+  ssize_t Read(char* buf, size_t size) {
+    if (failed_) {
+      return -1;
+    }
+    size_t finished = 0;
+    while (finished < size) {
+      if (pos_ == chunk_.size()) {
+        if (inflight_.empty()) {
+          break;
+        }
+        chunk_ = inflight_.front().get();
+        inflight_.pop_front();
+        pos_ = 0;
+        if (chunk_.empty()) {
+          LOG(ERROR) << "The range read failed, stop reading";
+          failed_ = true;
+          fetch_offset_ = file_size_;
+          Drain();
+          return -1;
+        }
+        Prefetch();
+      }
+      size_t n = std::min(size - finished, chunk_.size() - pos_);
+      memcpy(buf + finished, chunk_.data() + pos_, n);
+      pos_ += n;
+      finished += n;
+    }
+    return finished;
+  }
+
+ private:
+  void Prefetch() {
+    while (inflight_.size() < static_cast<size_t>(parallelism_) &&
+           fetch_offset_ < file_size_) {
+      int64_t offset = fetch_offset_;
+      size_t len = std::min<int64_t>(chunk_size_, file_size_ - offset);
+      fetch_offset_ += len;
+      inflight_.push_back(std::async(std::launch::async, [this, offset, len] {
+        return ReadRange(offset, len);
+      }));
+    }
+  }
+
+  // waits for the reads in flight, which can not be cancelled
+  void Drain() {
+    for (auto& chunk : inflight_) {
+      chunk.wait();
+    }
+    inflight_.clear();
+    chunk_.clear();
+    pos_ = 0;
+  }
+
+  // returns an empty buffer on failure
+  std::vector<char> ReadRange(int64_t offset, size_t len) {
+    std::vector<char> buf(len);
+    size_t done = 0;
+    while (done < len) {
+      int64_t n = read_range_(offset + done, buf.data() + done, len - done);
+      if (n <= 0) {
+        return {};
+      }
+      done += n;
+    }
+    return buf;
+  }
+
+  int64_t file_size_;
+  size_t chunk_size_;
+  int parallelism_;
+  std::function<int64_t(int64_t, char*, size_t)> read_range_;
+  std::function<void()> close_;
+  int64_t fetch_offset_ = 0;
+  std::deque<std::future<std::vector<char>>> inflight_;
+  std::vector<char> chunk_;
+  size_t pos_ = 0;
+  bool failed_ = false;
+};
+
+hdfsFS hdfs_native_connect() {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, hdfsFS> connections;
+  auto config = hdfs_native_config_internal();
+  std::string key = config.first + "#" + config.second;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iter = connections.find(key);
+  if (iter != connections.end()) {
+    return iter->second;
+  }
+  hdfsFS fs = config.second == ""
+                  ? platform::dynload::hdfsConnect(config.first.c_str(), 0)
+                  : platform::dynload::hdfsConnectAsUser(
+                        config.first.c_str(), 0, config.second.c_str());
+  if (fs != nullptr) {
+    connections[key] = fs;
+  }
+  return fs;
+}
+
+// returns nullptr if libhdfs is not available or the file can not be opened,
+// so that the caller can fall back to the hdfs command
+std::shared_ptr<FILE> hdfs_native_open_read(const std::string& path) {
+  if (!platform::dynload::HasHDFS()) {
+    LOG_FIRST_N(WARNING, 1) << "libhdfs.so is not found, add its directory "
+                               "to LD_LIBRARY_PATH to use the native hdfs "
+                               "reader";
+    return nullptr;
+  }
+  hdfsFS fs = hdfs_native_connect();
+  if (fs == nullptr) {
+    LOG(WARNING) << "hdfsConnect failed, fall back to the hdfs command";
+    return nullptr;
+  }
+  hdfsFileInfo* info = platform::dynload::hdfsGetPathInfo(fs, path.c_str());
+  if (info == nullptr) {
+    LOG(WARNING) << "hdfsGetPathInfo(" << path << ") failed";
+    return nullptr;
+  }
+  int64_t file_size = info->mSize;
+  platform::dynload::hdfsFreeFileInfo(info, 1);
+  hdfsFile file =
+      platform::dynload::hdfsOpenFile(fs, path.c_str(), O_RDONLY, 0, 0, 0);
+  if (file == nullptr) {
+    LOG(WARNING) << "hdfsOpenFile(" << path << ") failed";
+    return nullptr;
+  }
+
+  auto fp = fs_open_range_read(
+      file_size, hdfs_native_chunk_size_internal(),
+      hdfs_native_parallelism_internal(),
+      [fs, file](int64_t offset, char* buf, size_t len) -> int64_t {
+        return platform::dynload::hdfsPread(
+            fs, file, offset, buf,
+            std::min<size_t>(len, std::numeric_limits<tSize>::max()));
+      },
+      [fs, file] { platform::dynload::hdfsCloseFile(fs, file); });
+  if (fp != nullptr) {
+    VLOG(3) << "hdfs native reader opened " << path << ", size=" << file_size;
+  }
+  return fp;
+}
+
+}  // namespace
+
+std::shared_ptr<FILE> fs_open_range_read(
+    int64_t file_size, size_t chunk_size, int parallelism,
+    std::function<int64_t(int64_t, char*, size_t)> read_range,
+    std::function<void()> close) {
+  auto* reader = new RangeReader(file_size, chunk_size, parallelism,
+                                 std::move(read_range), std::move(close));
+  cookie_io_functions_t funcs;
+  funcs.read = [](void* cookie, char* buf, size_t size) -> ssize_t {
+    return static_cast<RangeReader*>(cookie)->Read(buf, size);
+  };
+  funcs.write = nullptr;
+  funcs.seek = nullptr;
+  funcs.close = [](void* cookie) -> int {
+    delete static_cast<RangeReader*>(cookie);
+    return 0;
+  };
+  FILE* fp = fopencookie(reader, "r", funcs);
+  if (fp == nullptr) {
+    delete reader;
+    return nullptr;
+  }
+  return {fp, [](FILE* fp) { fclose(fp); }};
+}
+#endif
+
 std::shared_ptr<FILE> hdfs_open_read(std::string path, int* err_no,
                                      const std::string& converter) {
+#if defined(__linux__)
+  // the native reader can not run a converter, "cat" is the identity
+  // converter set by InMemoryDataset by default
+  if (hdfs_native_read() && !fs_end_with_internal(path, ".gz") &&
+      download_cmd() == "" && (converter == "" || converter == "cat")) {
+    auto fp = hdfs_native_open_read(path);
+    if (fp != nullptr) {
+      return fp;
+    }
+  }
+#endif
+
   if (fs_end_with_internal(path, ".gz")) {
     path = string::format_string("%s -text \"%s\"", hdfs_command().c_str(),
                                  path.c_str());
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -65,6 +66,30 @@ extern const std::string& download_cmd();
 
 extern void set_download_command(const std::string& x);
 
+// Read hdfs files through libhdfs.so instead of forking the hdfs command,
+// with `parallelism` range reads of `chunk_size` bytes in flight per file.
+// It falls back to the hdfs command if libhdfs.so can not be loaded.
+extern bool hdfs_native_read();
+
+extern void hdfs_set_native_read(bool x, size_t chunk_size = 8 << 20,
+                                 int parallelism = 4);
+
+extern void hdfs_set_native_config(const std::string& fs_name,
+                                   const std::string& fs_ugi);
+
+#if defined(__linux__)
+// Open a stream of file_size bytes read by read_range(offset, buf, len),
+// which returns the bytes read or <= 0 on failure, with `parallelism` reads
+// of `chunk_size` bytes in flight. Once a read fails, the reads of the
+// stream fail with ferror set, and no data after the failed range is
+// returned. close is called when the stream is closed. It is how the native
+// hdfs reader reads the files.
+extern std::shared_ptr<FILE> fs_open_range_read(
+    int64_t file_size, size_t chunk_size, int parallelism,
+    std::function<int64_t(int64_t, char*, size_t)> read_range,
+    std::function<void()> close = nullptr);
+#endif
+
 extern std::shared_ptr<FILE> hdfs_open_read(std::string path, int* err_no,
                                             const std::string& converter);
 
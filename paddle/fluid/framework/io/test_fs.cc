@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <fstream>
+#include <vector>
 #include "paddle/fluid/framework/io/fs.h"
 
 #if defined _WIN32 || defined __APPLE__
@@ -45,3 +47,70 @@ TEST(FS, mv) {
   }
 #endif
 }
+
+TEST(FS, hdfs_native_read) {
+#ifdef _LINUX
+  paddle::framework::hdfs_set_native_config("", "user,passwd");
+  paddle::framework::hdfs_set_native_read(true, 1 << 20, 2);
+  EXPECT_TRUE(paddle::framework::hdfs_native_read());
+  paddle::framework::hdfs_set_native_read(false);
+  EXPECT_FALSE(paddle::framework::hdfs_native_read());
+#endif
+}
+
+#if defined(__linux__)
+TEST(FS, range_read) {
+  const int64_t file_size = 10000;
+  auto byte_at = [](int64_t offset) { return static_cast<char>(offset % 251); };
+  auto read_range = [&](int64_t offset, char* buf, size_t len) -> int64_t {
+    // short reads are continued
+    len = std::min<size_t>(len, 700);
+    for (size_t i = 0; i < len; ++i) {
+      buf[i] = byte_at(offset + i);
+    }
+    return len;
+  };
+  bool closed = false;
+  {
+    auto fp = paddle::framework::fs_open_range_read(
+        file_size, 1000, 3, read_range, [&closed] { closed = true; });
+    ASSERT_NE(fp, nullptr);
+    std::vector<char> data(file_size + 1);
+    ASSERT_EQ(fread(data.data(), 1, data.size(), fp.get()), file_size);
+    for (int64_t i = 0; i < file_size; ++i) {
+      ASSERT_EQ(data[i], byte_at(i));
+    }
+    ASSERT_FALSE(ferror(fp.get()));
+  }
+  ASSERT_TRUE(closed);
+}
+
+TEST(FS, range_read_failure) {
+  const int64_t file_size = 10000;
+  const int64_t failed_offset = 3000;
+  auto byte_at = [](int64_t offset) { return static_cast<char>(offset % 251); };
+  auto fp = paddle::framework::fs_open_range_read(
+      file_size, 1000, 4, [&](int64_t offset, char* buf, size_t len) {
+        int64_t end = offset + static_cast<int64_t>(len);
+        if (offset <= failed_offset && failed_offset < end) {
+          return static_cast<int64_t>(-1);
+        }
+        for (size_t i = 0; i < len; ++i) {
+          buf[i] = byte_at(offset + i);
+        }
+        return static_cast<int64_t>(len);
+      });
+  ASSERT_NE(fp, nullptr);
+  // the chunks after the failed one are never returned
+  std::vector<char> data(file_size);
+  size_t read_num = fread(data.data(), 1, data.size(), fp.get());
+  ASSERT_LE(read_num, static_cast<size_t>(failed_offset));
+  for (size_t i = 0; i < read_num; ++i) {
+    ASSERT_EQ(data[i], byte_at(i));
+  }
+  ASSERT_TRUE(ferror(fp.get()));
+  clearerr(fp.get());
+  ASSERT_EQ(fread(data.data(), 1, data.size(), fp.get()), 0UL);
+  ASSERT_TRUE(ferror(fp.get()));
+}
+#endif
@@ -0,0 +1,364 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/block_sparse_weight_pass.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+constexpr float kDefaultBlockSparsity = 0.8f;
+
+// The block shapes tried, from the largest one.
+const std::vector<std::pair<int, int>>& CandidateBlockShapes() {
+  static const std::vector<std::pair<int, int>> shapes = {
+      {16, 16}, {8, 8}, {4, 4}, {1, 16}, {1, 8}, {1, 4}};
+  return shapes;
+}
+
+struct BlockSparseWeight {
+  int block_height{0};
+  int block_width{0};
+  std::vector<float> values;
+  std::vector<int> offsets;
+  std::vector<int> columns;
+};
+
+// Converts the matrix S of [rows, cols] into the BSR format, where S is the
+// dense weight w, or its transpose of [cols, rows]. Returns false if S is not
+// sparse enough with any block shape.
+bool ToBlockSparse(const float* w, int rows, int cols, bool transpose,
+                   float threshold, BlockSparseWeight* weight) {
+  auto at = [&](int r, int c) {
+    return transpose ? w[c * rows + r] : w[r * cols + c];
+  };
+  for (auto& shape : CandidateBlockShapes()) {
+    const int bh = shape.first;
+    const int bw = shape.second;
+    if (rows % bh != 0 || cols % bw != 0) continue;
+    auto is_zero_block = [&](int r, int c) {
+      for (int i = 0; i < bh; ++i) {
+        for (int j = 0; j < bw; ++j) {
+          if (at(r * bh + i, c * bw + j) != 0.0f) return false;
+        }
+      }
+      return true;
+    };
+
+    const int block_rows = rows / bh;
+    const int block_cols = cols / bw;
+    std::vector<int> columns;
+    std::vector<int> offsets(1, 0);
+    for (int r = 0; r < block_rows; ++r) {
+      for (int c = 0; c < block_cols; ++c) {
+        if (!is_zero_block(r, c)) columns.push_back(c);
+      }
+      offsets.push_back(static_cast<int>(columns.size()));
+    }
+    float sparsity = 1.0f - static_cast<float>(columns.size()) /
+                                (static_cast<float>(block_rows) * block_cols);
+    if (sparsity < threshold) continue;
+
+    weight->block_height = bh;
+    weight->block_width = bw;
+    weight->values.clear();
+    weight->values.reserve(columns.size() * bh * bw);
+    for (int r = 0; r < block_rows; ++r) {
+      for (int k = offsets[r]; k < offsets[r + 1]; ++k) {
+        for (int i = 0; i < bh; ++i) {
+          for (int j = 0; j < bw; ++j) {
+            weight->values.push_back(at(r * bh + i, columns[k] * bw + j));
+          }
+        }
+      }
+    }
+    weight->offsets = std::move(offsets);
+    weight->columns = std::move(columns);
+    VLOG(4) << "convert the weight of [" << rows << ", " << cols
+            << "] with the blocks of [" << bh << ", " << bw
+            << "], sparsity " << sparsity;
+    return true;
+  }
+  return false;
+}
+
+// The attribute of the op, or the default value of the op maker if it is not
+// set.
+template <typename T>
+T GetAttrOr(Node* op, const std::string& name, T default_value) {
+  return op->Op()->HasAttr(name) ? op->Op()->GetAttrIfExists<T>(name)
+                                 : default_value;
+}
+
+bool HasArgument(Node* op, const std::string& argument) {
+  auto& inputs = op->Op()->Inputs();
+  auto it = inputs.find(argument);
+  return it != inputs.end() && !it->second.empty();
+}
+
+Node* GetInput(Node* op, const std::string& argument) {
+  auto& inputs = op->Op()->Inputs();
+  auto it = inputs.find(argument);
+  if (it == inputs.end() || it->second.size() != 1) return nullptr;
+  for (auto* in : op->inputs) {
+    if (in->IsVar() && in->Name() == it->second[0]) return in;
+  }
+  return nullptr;
+}
+
+Node* GetOutput(Node* op, const std::string& argument) {
+  auto& outputs = op->Op()->Outputs();
+  auto it = outputs.find(argument);
+  if (it == outputs.end() || it->second.size() != 1) return nullptr;
+  for (auto* out : op->outputs) {
+    if (out->IsVar() && out->Name() == it->second[0]) return out;
+  }
+  return nullptr;
+}
+
+bool IsAllOf(const std::vector<int>& values, int value) {
+  return std::all_of(values.begin(), values.end(),
+                     [value](int v) { return v == value; });
+}
+
+// The op replaced by block_sparse_fc or block_sparse_conv2d.
+struct SparseCandidate {
+  Node* op{nullptr};
+  Node* input{nullptr};
+  Node* weight{nullptr};
+  Node* bias{nullptr};
+  Node* output{nullptr};
+  // The sparse matrix of [rows, cols] is the transpose of the weight.
+  bool transpose{false};
+  int rows{0};
+  int cols{0};
+};
+
+bool MatchFC(Node* op, SparseCandidate* candidate) {
+  auto* desc = op->Op();
+  if (desc->GetAttrIfExists<bool>("padding_weights") ||
+      desc->GetAttrIfExists<bool>("use_mkldnn") ||
+      desc->GetAttrIfExists<bool>("use_quantizer") ||
+      desc->HasAttr("enable_int8")) {
+    return false;
+  }
+  candidate->input = GetInput(op, "Input");
+  candidate->weight = GetInput(op, "W");
+  candidate->output = GetOutput(op, "Out");
+  if (HasArgument(op, "Bias")) {
+    candidate->bias = GetInput(op, "Bias");
+    if (!candidate->bias) return false;
+  }
+  candidate->transpose = true;
+  return true;
+}
+
+bool MatchMul(Node* op, SparseCandidate* candidate) {
+  auto* desc = op->Op();
+  if (GetAttrOr<int>(op, "y_num_col_dims", 1) != 1 ||
+      desc->GetAttrIfExists<bool>("use_mkldnn") ||
+      desc->HasAttr("enable_int8")) {
+    return false;
+  }
+  candidate->input = GetInput(op, "X");
+  candidate->weight = GetInput(op, "Y");
+  candidate->output = GetOutput(op, "Out");
+  candidate->transpose = true;
+  return true;
+}
+
+bool MatchConv2D(Node* op, SparseCandidate* candidate) {
+  auto* desc = op->Op();
+  auto data_format = desc->GetAttrIfExists<std::string>("data_format");
+  if (desc->GetAttrIfExists<int>("groups") > 1 ||
+      !IsAllOf(GetAttrOr<std::vector<int>>(op, "strides", {1, 1}), 1) ||
+      !IsAllOf(GetAttrOr<std::vector<int>>(op, "paddings", {0, 0}), 0) ||
+      !IsAllOf(GetAttrOr<std::vector<int>>(op, "dilations", {1, 1}), 1) ||
+      data_format == "NHWC" || desc->GetAttrIfExists<bool>("use_mkldnn") ||
+      desc->GetAttrIfExists<bool>("fuse_relu") ||
+      HasArgument(op, "Bias") || HasArgument(op, "ResidualData")) {
+    return false;
+  }
+  candidate->input = GetInput(op, "Input");
+  candidate->weight = GetInput(op, "Filter");
+  candidate->output = GetOutput(op, "Output");
+  candidate->transpose = false;
+  return true;
+}
+
+Node* CreateParameter(Graph* graph, Scope* scope, const std::string& name,
+                      const std::vector<int64_t>& shape,
+                      proto::VarType::Type dtype, const void* data) {
+  VarDesc desc(name);
+  desc.SetShape(shape);
+  desc.SetDataType(dtype);
+  desc.SetPersistable(true);
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(make_ddim(shape));
+  auto* dst = tensor->mutable_data(platform::CPUPlace(), dtype);
+  size_t size =
+      static_cast<size_t>(product(tensor->dims())) * SizeOfType(dtype);
+  // All the blocks may be zero.
+  if (size > 0) {
+    std::memcpy(dst, data, size);
+  }
+  return graph->CreateVarNode(&desc);
+}
+
+}  // namespace
+
+void BlockSparseWeightPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+  if (!graph->Has(kParamScopeAttr)) {
+    VLOG(3) << "Skip block_sparse_weight_pass without the param scope";
+    return;
+  }
+  auto* scope = param_scope();
+  float threshold = Has("block_sparsity_threshold")
+                        ? Get<float>("block_sparsity_threshold")
+                        : kDefaultBlockSparsity;
+
+  // The weights shared by the other ops, or used by name in the sub-blocks,
+  // are kept dense.
+  bool has_sub_blocks = graph->OriginProgram().Size() > 1;
+  std::unordered_map<std::string, int> var_node_num;
+  for (auto* n : graph->Nodes()) {
+    if (n->IsVar()) {
+      ++var_node_num[n->Name()];
+    }
+  }
+  auto is_dense_weight = [&](Node* w, size_t rank) {
+    if (!w || !w->Var() || !w->Var()->Persistable() ||
+        w->outputs.size() != 1 || var_node_num[w->Name()] != 1) {
+      return false;
+    }
+    auto* var = scope->FindVar(w->Name());
+    if (!var || !var->IsType<LoDTensor>()) return false;
+    auto& tensor = var->Get<LoDTensor>();
+    return tensor.IsInitialized() &&
+           tensor.type() == proto::VarType::FP32 &&
+           platform::is_cpu_place(tensor.place()) &&
+           static_cast<size_t>(tensor.dims().size()) == rank;
+  };
+
+  int found_count = 0;
+  for (std::string type : {"fc", "mul", "conv2d"}) {
+    auto& nodes = graph->OpNodesOfType(type);
+    std::vector<Node*> ops(nodes.begin(), nodes.end());
+    for (auto* op : ops) {
+      SparseCandidate candidate;
+      candidate.op = op;
+      bool matched = type == "fc"
+                         ? MatchFC(op, &candidate)
+                         : type == "mul" ? MatchMul(op, &candidate)
+                                         : MatchConv2D(op, &candidate);
+      bool is_conv = type == "conv2d";
+      if (!matched || !candidate.input || !candidate.output ||
+          !is_dense_weight(candidate.weight, is_conv ? 4 : 2)) {
+        continue;
+      }
+      auto& tensor = scope->FindVar(candidate.weight->Name())->Get<LoDTensor>();
+      auto dims = tensor.dims();
+      if (is_conv) {
+        if (dims[2] != 1 || dims[3] != 1) continue;
+        candidate.rows = static_cast<int>(dims[0]);
+        candidate.cols = static_cast<int>(dims[1]);
+      } else {
+        candidate.rows = static_cast<int>(dims[1]);
+        candidate.cols = static_cast<int>(dims[0]);
+      }
+
+      BlockSparseWeight weight;
+      if (!ToBlockSparse(tensor.data<float>(), candidate.rows, candidate.cols,
+                         candidate.transpose, threshold, &weight)) {
+        continue;
+      }
+
+      const std::string& w_name = candidate.weight->Name();
+      auto* values = CreateParameter(
+          graph, scope, w_name + "@bsr_values",
+          {static_cast<int64_t>(weight.columns.size()), weight.block_height,
+           weight.block_width},
+          proto::VarType::FP32, weight.values.data());
+      auto* offsets = CreateParameter(
+          graph, scope, w_name + "@bsr_offsets",
+          {static_cast<int64_t>(weight.offsets.size())},
+          proto::VarType::INT32, weight.offsets.data());
+      auto* columns = CreateParameter(
+          graph, scope, w_name + "@bsr_columns",
+          {static_cast<int64_t>(weight.columns.size())},
+          proto::VarType::INT32, weight.columns.data());
+
+      OpDesc desc;
+      desc.SetType(is_conv ? "block_sparse_conv2d" : "block_sparse_fc");
+      desc.SetInput("Input", {candidate.input->Name()});
+      desc.SetInput("Values", {values->Name()});
+      desc.SetInput("Offsets", {offsets->Name()});
+      desc.SetInput("Columns", {columns->Name()});
+      if (candidate.bias) {
+        desc.SetInput("Bias", {candidate.bias->Name()});
+      }
+      desc.SetOutput(is_conv ? "Output" : "Out", {candidate.output->Name()});
+      if (is_conv) {
+        desc.SetAttr("weight_shape",
+                     std::vector<int>({candidate.rows, candidate.cols}));
+      } else {
+        desc.SetAttr("weight_shape",
+                     std::vector<int>({candidate.cols, candidate.rows}));
+        desc.SetAttr("in_num_col_dims",
+                     GetAttrOr<int>(op, type == "fc" ? "in_num_col_dims"
+                                                     : "x_num_col_dims",
+                                    1));
+        desc.SetAttr("activation_type",
+                     op->Op()->GetAttrIfExists<std::string>("activation_type"));
+      }
+      desc.SetAttr("block_shape", std::vector<int>({weight.block_height,
+                                                    weight.block_width}));
+      auto* sparse_op = graph->CreateOpNode(&desc);
+
+      IR_NODE_LINK_TO(candidate.input, sparse_op);
+      for (auto* in : {values, offsets, columns, candidate.bias}) {
+        if (in) IR_NODE_LINK_TO(in, sparse_op);
+      }
+      IR_NODE_LINK_TO(sparse_op, candidate.output);
+      GraphSafeRemoveNodes(graph, {op, candidate.weight});
+      if (!has_sub_blocks) {
+        scope->EraseVars({w_name});
+      }
+      ++found_count;
+    }
+  }
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(block_sparse_weight_pass,
+              paddle::framework::ir::BlockSparseWeightPass);
@@ -0,0 +1,45 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Convert the weights of fc, mul and 1x1 conv2d, most of whose blocks are
+ * zero after the structured pruning, into the block compressed sparse row
+ * (BSR) format, and replace the ops with block_sparse_fc and
+ * block_sparse_conv2d, which skip the zero blocks.
+ *
+ * The largest block shape is chosen, with which the ratio of the zero blocks
+ * is at least block_sparsity_threshold (0.8 by default), below which the
+ * dense GEMM is faster.
+ */
+class BlockSparseWeightPass : public FusePassBase {
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  const std::string name_scope_{"block_sparse_weight"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
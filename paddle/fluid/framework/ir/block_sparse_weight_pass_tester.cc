@@ -0,0 +1,171 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/block_sparse_weight_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+float* CreateWeight(Scope* scope, const std::string& name,
+                    const std::vector<int64_t>& shape) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(make_ddim(shape));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  std::fill(data, data + tensor->numel(), 0.0f);
+  return data;
+}
+
+std::unique_ptr<Graph> ApplyPass(const ProgramDesc& program, Scope* scope) {
+  std::unique_ptr<Graph> graph(new Graph(program));
+  graph->SetNotOwned(kParamScopeAttr, scope);
+  auto pass = PassRegistry::Instance().Get("block_sparse_weight_pass");
+  VLOG(3) << DebugString(graph);
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+  return graph;
+}
+
+OpDesc* GetOp(const std::unique_ptr<Graph>& graph,
+              const std::string& op_type) {
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op()->Type() == op_type) {
+      return node->Op();
+    }
+  }
+  return nullptr;
+}
+
+template <typename T>
+std::vector<T> GetData(const Scope& scope, const std::string& name) {
+  auto& tensor = scope.FindVar(name)->Get<LoDTensor>();
+  return std::vector<T>(tensor.data<T>(), tensor.data<T>() + tensor.numel());
+}
+
+TEST(BlockSparseWeightPass, fc) {
+  Layers layers;
+  auto* x = layers.data("x", {4, 32});
+  auto* w = layers.data("w", {32, 16}, true);
+  auto* bias = layers.data("bias", {16}, true);
+  auto* out = layers.fc(x, w, bias, 1, "relu");
+
+  // Only the block (1, 2) of W^T [16, 32] is nonzero with the blocks of
+  // [8, 8].
+  Scope scope;
+  float* w_data = CreateWeight(&scope, "w", {32, 16});
+  for (int n = 8; n < 16; ++n) {
+    for (int k = 16; k < 24; ++k) {
+      w_data[k * 16 + n] = static_cast<float>(n * 32 + k);
+    }
+  }
+  CreateWeight(&scope, "bias", {16});
+
+  auto graph = ApplyPass(layers.main_program(), &scope);
+  EXPECT_EQ(GetNumOpNodes(graph, "fc"), 0);
+  auto* op = GetOp(graph, "block_sparse_fc");
+  ASSERT_NE(op, nullptr);
+  EXPECT_EQ(op->Input("Input"), std::vector<std::string>({x->Name()}));
+  EXPECT_EQ(op->Input("Bias"), std::vector<std::string>({bias->Name()}));
+  EXPECT_EQ(op->Output("Out"), std::vector<std::string>({out->Name()}));
+  EXPECT_EQ(boost::get<std::vector<int>>(op->GetAttr("weight_shape")),
+            std::vector<int>({32, 16}));
+  EXPECT_EQ(boost::get<std::vector<int>>(op->GetAttr("block_shape")),
+            std::vector<int>({8, 8}));
+  EXPECT_EQ(boost::get<std::string>(op->GetAttr("activation_type")), "relu");
+
+  EXPECT_EQ(GetData<int>(scope, op->Input("Offsets")[0]),
+            std::vector<int>({0, 0, 1}));
+  EXPECT_EQ(GetData<int>(scope, op->Input("Columns")[0]),
+            std::vector<int>({2}));
+  auto values = GetData<float>(scope, op->Input("Values")[0]);
+  ASSERT_EQ(values.size(), 64UL);
+  for (int i = 0; i < 8; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      EXPECT_EQ(values[i * 8 + j], static_cast<float>((8 + i) * 32 + 16 + j));
+    }
+  }
+  // The dense weight is removed.
+  EXPECT_EQ(scope.FindVar("w"), nullptr);
+}
+
+TEST(BlockSparseWeightPass, conv2d) {
+  Layers layers;
+  auto* x = layers.data("x", {1, 16, 4, 4});
+  layers.data("filter", {8, 16, 1, 1}, true);
+  auto* out = layers.data("out", {1, 8, 4, 4});
+  ProgramDesc program(layers.main_program());
+  auto* conv = program.MutableBlock(0)->AppendOp();
+  conv->SetType("conv2d");
+  conv->SetInput("Input", {x->Name()});
+  conv->SetInput("Filter", {"filter"});
+  conv->SetOutput("Output", {out->Name()});
+  conv->SetAttr("strides", std::vector<int>({1, 1}));
+  conv->SetAttr("paddings", std::vector<int>({0, 0}));
+  conv->SetAttr("dilations", std::vector<int>({1, 1}));
+  conv->SetAttr("groups", 1);
+
+  // Only the block (1, 2) is nonzero with the blocks of [4, 4].
+  Scope scope;
+  float* filter_data = CreateWeight(&scope, "filter", {8, 16, 1, 1});
+  filter_data[5 * 16 + 9] = 1.0f;
+
+  auto graph = ApplyPass(program, &scope);
+  EXPECT_EQ(GetNumOpNodes(graph, "conv2d"), 0);
+  auto* op = GetOp(graph, "block_sparse_conv2d");
+  ASSERT_NE(op, nullptr);
+  EXPECT_EQ(op->Output("Output"), std::vector<std::string>({out->Name()}));
+  EXPECT_EQ(boost::get<std::vector<int>>(op->GetAttr("weight_shape")),
+            std::vector<int>({8, 16}));
+  EXPECT_EQ(boost::get<std::vector<int>>(op->GetAttr("block_shape")),
+            std::vector<int>({4, 4}));
+  EXPECT_EQ(GetData<int>(scope, op->Input("Offsets")[0]),
+            std::vector<int>({0, 0, 1}));
+  EXPECT_EQ(GetData<int>(scope, op->Input("Columns")[0]),
+            std::vector<int>({2}));
+  auto values = GetData<float>(scope, op->Input("Values")[0]);
+  ASSERT_EQ(values.size(), 16UL);
+  EXPECT_EQ(values[1 * 4 + 1], 1.0f);
+}
+
+TEST(BlockSparseWeightPass, keep_dense) {
+  // The dense weight, and the weight shared by two ops, are kept.
+  Layers layers;
+  auto* x = layers.data("x", {4, 16});
+  auto* dense = layers.data("dense", {16, 16}, true);
+  auto* shared = layers.data("shared", {16, 16}, true);
+  layers.mul(x, dense);
+  layers.mul(x, shared);
+  layers.mul(x, shared);
+
+  Scope scope;
+  float* dense_data = CreateWeight(&scope, "dense", {16, 16});
+  std::fill(dense_data, dense_data + 256, 1.0f);
+  CreateWeight(&scope, "shared", {16, 16})[0] = 1.0f;
+
+  auto graph = ApplyPass(layers.main_program(), &scope);
+  EXPECT_EQ(GetNumOpNodes(graph, "mul"), 3);
+  EXPECT_EQ(GetNumOpNodes(graph, "block_sparse_fc"), 0);
+  EXPECT_NE(scope.FindVar("dense"), nullptr);
+  EXPECT_NE(scope.FindVar("shared"), nullptr);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(block_sparse_weight_pass);
@@ -215,13 +215,54 @@ class CoalesceGradTensorPass : public ir::Pass {
       const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
       const details::ParamsAndGrads &params_grads,
       details::GroupParamsAndGrads *group_params_grads) const {
-    SetGroupAccordingToLayers(vars_info, params_grads, group_params_grads);
-    SetGroupAccordingToMemorySize(vars_info, group_params_grads);
+    double bucket_size_mb = Has(details::kFuseGradBucketSizeMB)
+                                ? Get<double>(details::kFuseGradBucketSizeMB)
+                                : -1.0;
+    if (bucket_size_mb > 0) {
+      SetGroupAccordingToBuckets(vars_info, params_grads, bucket_size_mb,
+                                 group_params_grads);
+    } else {
+      SetGroupAccordingToLayers(vars_info, params_grads, group_params_grads);
+      SetGroupAccordingToMemorySize(vars_info, group_params_grads);
+    }
     if (!IsUnifiedDtype(params_grads, vars_info)) {
       ReGroupByDtype(vars_info, group_params_grads);
     }
   }
 
+  // Group the gradients into the buckets of at most bucket_size_mb in their
+  // producing order, i.e. the topological order of the backward ops, so
+  // that the all_reduce of a bucket only waits for the gradients produced
+  // before. A gradient larger than bucket_size_mb takes a bucket alone.
+  void SetGroupAccordingToBuckets(
+      const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
+      const details::ParamsAndGrads &params_grads, double bucket_size_mb,
+      details::GroupParamsAndGrads *group_params_grads) const {
+    size_t bucket_memory_size = 0;
+    for (auto &p_g : params_grads) {
+      auto var_desc = GetVarDescFromVarsInfo(vars_info, p_g.second);
+      size_t size = framework::SizeOfType(var_desc->GetDataType());
+      auto shape = var_desc->GetShape();
+      std::for_each(shape.begin(), shape.end(),
+                    [&size](const int64_t &n) { size *= n; });
+      if (group_params_grads->empty() ||
+          (bucket_memory_size > 0 &&
+           static_cast<double>(bucket_memory_size + size) / kMB >
+               bucket_size_mb)) {
+        group_params_grads->emplace_back();
+        bucket_memory_size = 0;
+      }
+      group_params_grads->back().emplace_back(p_g);
+      bucket_memory_size += size;
+    }
+
+    if (VLOG_IS_ON(10)) {
+      VLOG(10) << string::Sprintf(
+          "SetGroupAccordingToBuckets(bucket_size: %f MB):", bucket_size_mb);
+      PrintGroupInfo(vars_info, group_params_grads);
+    }
+  }
+
   void SetGroupAccordingToLayers(
       const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
       const details::ParamsAndGrads &params_grads,
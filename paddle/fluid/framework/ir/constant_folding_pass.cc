@@ -0,0 +1,244 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/framework/op_info.h"
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The ops with side effects, or the random ones, which are not folded even
+// if all their inputs are parameters.
+const std::unordered_set<std::string>& UnfoldableOps() {
+  static const std::unordered_set<std::string> ops = {
+      "feed",
+      "fetch",
+      "save",
+      "save_combine",
+      "load",
+      "load_combine",
+      "print",
+      "py_func",
+      "read",
+      "create_py_reader",
+      "uniform_random",
+      "gaussian_random",
+      "truncated_gaussian_random",
+      "randint",
+      "randperm",
+      "random_crop",
+      "sampling_id",
+      "dropout",
+  };
+  return ops;
+}
+
+bool HasSubBlock(const OpDesc& op) {
+  for (auto& pair : op.GetAttrMap()) {
+    if (pair.second.type() == typeid(BlockDesc*) ||
+        pair.second.type() == typeid(std::vector<BlockDesc*>)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the op runs on CPU, since the parameters are still on CPU when
+// the IR passes of the inference are applied.
+bool RunsOnCPU(const std::string& type) {
+  if (!OpInfoMap::Instance().Has(type)) {
+    return false;
+  }
+  auto& all_kernels = OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(type);
+  if (it == all_kernels.end()) {
+    // the ops without kernels
+    return true;
+  }
+  for (auto& pair : it->second) {
+    if (platform::is_cpu_place(pair.first.place_)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ConstantFoldingPass::IsFoldable(
+    Node* op, const std::unordered_set<Node*>& constant_vars,
+    const std::unordered_map<std::string, int>& var_node_num,
+    Scope* scope) const {
+  if (!op->IsOp() || !op->Op() || op->outputs.empty()) {
+    return false;
+  }
+  auto* op_desc = op->Op();
+  if (UnfoldableOps().count(op_desc->Type()) || HasSubBlock(*op_desc) ||
+      !RunsOnCPU(op_desc->Type())) {
+    return false;
+  }
+
+  std::unordered_set<std::string> input_names;
+  for (auto* in : op->inputs) {
+    if (!in->IsVar() || !in->Var()) {
+      return false;
+    }
+    input_names.insert(in->Name());
+    if (constant_vars.count(in)) {
+      continue;
+    }
+    if (!in->Var()->Persistable() ||
+        in->Var()->GetType() != proto::VarType::LOD_TENSOR) {
+      return false;
+    }
+    auto* var = scope->FindVar(in->Name());
+    if (!var || !var->IsType<LoDTensor>() ||
+        !var->Get<LoDTensor>().IsInitialized()) {
+      return false;
+    }
+  }
+  for (auto* out : op->outputs) {
+    // the outputs written more than once, e.g. by the inplace ops, are not
+    // folded
+    if (!out->IsVar() || !out->Var() ||
+        out->Var()->GetType() != proto::VarType::LOD_TENSOR ||
+        var_node_num.at(out->Name()) != 1 || input_names.count(out->Name())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ConstantFoldingPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+  if (!graph->Has(kParamScopeAttr)) {
+    VLOG(3) << "Skip constant_folding_pass without the param scope";
+    return;
+  }
+  auto* scope = param_scope();
+
+  std::unordered_map<std::string, int> var_node_num;
+  for (auto* n : graph->Nodes()) {
+    if (n->IsVar()) {
+      ++var_node_num[n->Name()];
+    }
+  }
+
+  std::vector<Node*> folded_ops;
+  std::unordered_set<Node*> folded_op_set;
+  std::unordered_set<Node*> constant_vars;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (IsFoldable(op, constant_vars, var_node_num, scope)) {
+      folded_ops.push_back(op);
+      folded_op_set.insert(op);
+      constant_vars.insert(op->outputs.begin(), op->outputs.end());
+    }
+  }
+  if (folded_ops.empty()) {
+    AddStatis(0);
+    return;
+  }
+
+  // The ops are run in the order of the graph, and all the variables
+  // created are parameters, so that they are created in the param scope.
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  std::unordered_set<std::string> output_names;
+  auto add_var = [&](Node* var) {
+    if (!block->HasVar(var->Name())) {
+      auto* var_desc = block->Var(var->Name());
+      *var_desc->Proto() = *var->Var()->Proto();
+      var_desc->SetPersistable(true);
+    }
+  };
+  for (auto* op : folded_ops) {
+    for (auto* in : op->inputs) {
+      add_var(in);
+    }
+    for (auto* out : op->outputs) {
+      add_var(out);
+      output_names.insert(out->Name());
+    }
+    block->AppendOp()->CopyFrom(*op->Op());
+  }
+
+  try {
+    platform::CPUPlace place;
+    NaiveExecutor executor(place);
+    executor.CreateVariables(program, 0, true, scope);
+    executor.Prepare(scope, program, 0, false);
+    executor.Run();
+  } catch (platform::EnforceNotMet& e) {
+    LOG(WARNING) << "Skip constant_folding_pass since the ops fail to run: "
+                 << e.what();
+    scope->EraseVars(std::vector<std::string>(output_names.begin(),
+                                              output_names.end()));
+    AddStatis(0);
+    return;
+  }
+
+  // The variables in the sub-blocks are used by name, and never erased.
+  bool has_sub_blocks = graph->OriginProgram().Size() > 1;
+  auto used_by_others = [&](Node* var) {
+    for (auto* out : var->outputs) {
+      if (folded_op_set.count(out) == 0) {
+        return true;
+      }
+    }
+    return var->outputs.empty() && has_sub_blocks;
+  };
+
+  std::unordered_set<const Node*> removed_nodes(folded_ops.begin(),
+                                                folded_ops.end());
+  std::vector<std::string> erased_vars;
+  for (auto* op : folded_ops) {
+    for (auto* out : op->outputs) {
+      if (used_by_others(out)) {
+        out->Var()->SetPersistable(true);
+      } else if (removed_nodes.insert(out).second) {
+        erased_vars.push_back(out->Name());
+      }
+    }
+    for (auto* in : op->inputs) {
+      if (constant_vars.count(in) == 0 && !used_by_others(in) &&
+          removed_nodes.insert(in).second && !has_sub_blocks) {
+        erased_vars.push_back(in->Name());
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph, removed_nodes);
+  scope->EraseVars(erased_vars);
+
+  VLOG(3) << "Fold " << folded_ops.size() << " ops and erase "
+          << erased_vars.size() << " variables";
+  AddStatis(folded_ops.size());
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
@@ -0,0 +1,48 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Evaluate the ops whose inputs are all parameters, e.g. fill_constant, or
+ * scale, reshape2, transpose2 and cast of the weights, and the ops only
+ * depending on them, once on CPU by NaiveExecutor in the param scope, and
+ * replace their outputs used by the other ops with the new parameters. The
+ * folded ops, and the parameters not used any more, are removed.
+ */
+class ConstantFoldingPass : public FusePassBase {
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  bool IsFoldable(Node* op, const std::unordered_set<Node*>& constant_vars,
+                  const std::unordered_map<std::string, int>& var_node_num,
+                  Scope* scope) const;
+
+  const std::string name_scope_{"constant_folding"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
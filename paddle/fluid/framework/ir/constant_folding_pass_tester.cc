@@ -0,0 +1,117 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(ConstantFoldingPass, fold) {
+  // inputs                 operator            output
+  // ---------------------------------------------------
+  // w                      scale           ->  w_scaled
+  // (w_scaled, c)          elementwise_add ->  w_add
+  // (x, w_add)             mul             ->  out
+  // and fill_constant -> c before them
+  Layers layers;
+  auto* x = layers.data("x", {1, 3});
+  auto* w = layers.data("w", {3}, true);
+  auto* c = layers.data("c", {3});
+  auto* w_scaled = layers.scale(w, 2.0f, 1.0f, true);
+  auto* w_add = layers.elementwise_add(w_scaled, c);
+  auto* out = layers.mul(x, w_add);
+
+  ProgramDesc program(layers.main_program());
+  auto* fill_constant = program.MutableBlock(0)->PrependOp();
+  fill_constant->SetType("fill_constant");
+  fill_constant->SetOutput("Out", {c->Name()});
+  fill_constant->SetAttr("shape", std::vector<int64_t>({3}));
+  fill_constant->SetAttr("value", 0.5f);
+  fill_constant->SetAttr("dtype", static_cast<int>(proto::VarType::FP32));
+
+  Scope scope;
+  auto* w_tensor = scope.Var("w")->GetMutable<LoDTensor>();
+  w_tensor->Resize({3});
+  auto* w_data = w_tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 3; ++i) {
+    w_data[i] = static_cast<float>(i);
+  }
+
+  std::unique_ptr<Graph> graph(new Graph(program));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  VLOG(3) << DebugString(graph);
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "fill_constant"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "mul"), 1);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == w_add->Name()) {
+      EXPECT_TRUE(node->Var()->Persistable());
+    }
+    // the parameters and the intermediate variables only used by the
+    // folded ops are removed
+    EXPECT_NE(node->Name(), "w");
+    EXPECT_NE(node->Name(), w_scaled->Name());
+    EXPECT_NE(node->Name(), c->Name());
+    if (node->IsVar() && node->Name() == out->Name()) {
+      EXPECT_FALSE(node->Var()->Persistable());
+    }
+  }
+
+  EXPECT_EQ(scope.FindVar("w"), nullptr);
+  EXPECT_EQ(scope.FindVar(w_scaled->Name()), nullptr);
+  auto* w_add_var = scope.FindVar(w_add->Name());
+  ASSERT_NE(w_add_var, nullptr);
+  auto& w_add_tensor = w_add_var->Get<LoDTensor>();
+  ASSERT_EQ(w_add_tensor.numel(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FLOAT_EQ(w_add_tensor.data<float>()[i], i * 2.0f + 1.0f + 0.5f);
+  }
+}
+
+TEST(ConstantFoldingPass, not_fold) {
+  // The ops depending on the variables not in the param scope are not
+  // folded.
+  Layers layers;
+  auto* x = layers.data("x", {3});
+  auto* w = layers.data("w", {3}, true);
+  layers.elementwise_add(layers.scale(x, 2.0f, 1.0f, true), w);
+
+  Scope scope;
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "scale"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
+USE_OP(scale);
+USE_OP(elementwise_add);
+USE_OP(fill_constant);
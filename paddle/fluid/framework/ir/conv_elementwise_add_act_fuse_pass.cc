@@ -64,6 +64,11 @@ void ConvElementwiseAddActFusePass::ApplyImpl(ir::Graph* graph) const {
   auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
                      Graph* g) {
     GET_NODES;
+    // conv2d_fusion only supports NCHW
+    if (conv_op->Op()->GetAttrIfExists<std::string>("data_format") ==
+        "NHWC") {
+      return;
+    }
 
     auto base_op_desc = *conv_op->Op()->Proto();
     std::string bias_name = elementwise_add_in_y->Name();
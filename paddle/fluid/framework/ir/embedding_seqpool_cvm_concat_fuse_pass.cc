@@ -0,0 +1,149 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_cvm_concat_fuse_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+static Node* FindInputVar(Node* op, const std::string& name) {
+  for (auto* in : op->inputs) {
+    if (in->IsVar() && in->Name() == name) return in;
+  }
+  return nullptr;
+}
+
+static Node* FindInput(Node* op, const std::string& param) {
+  auto names = op->Op()->Input(param);
+  return names.size() == 1UL ? FindInputVar(op, names[0]) : nullptr;
+}
+
+// Return the lookup_table producing x, if x is used by the fused op only.
+static Node* GetLookupTable(Node* x) {
+  if (x == nullptr || x->inputs.size() != 1UL || x->outputs.size() != 1UL) {
+    return nullptr;
+  }
+  auto* op = x->inputs[0];
+  if (!op->IsOp() || op->Op()->Type() != "lookup_table") return nullptr;
+  if (op->Op()->HasAttr("remote_prefetch") &&
+      boost::get<bool>(op->Op()->GetAttr("remote_prefetch"))) {
+    return nullptr;
+  }
+  if (FindInput(op, "Ids") == nullptr || FindInput(op, "W") == nullptr) {
+    return nullptr;
+  }
+  return op;
+}
+
+static int64_t PaddingIdx(Node* lookup) {
+  return lookup->Op()->HasAttr("padding_idx")
+             ? boost::get<int64_t>(lookup->Op()->GetAttr("padding_idx"))
+             : -1;
+}
+}  // anonymous namespace
+
+void EmbeddingSeqPoolCVMConcatFusePass::ApplyImpl(ir::Graph* graph) const {
+  FusePassBase::Init(name_scope_, graph);
+  std::vector<Node*> fused_nodes;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fusion_seqpool_cvm_concat") {
+      fused_nodes.push_back(node);
+    }
+  }
+
+  int count = 0;
+  for (auto* fused_node : fused_nodes) {
+    auto* op = fused_node->Op();
+    auto xs = op->Input("X");
+    auto* cvm_var = FindInput(fused_node, "CVM");
+    if (op->Output("Out").size() != 1UL || cvm_var == nullptr ||
+        fused_node->outputs.size() != 1UL) {
+      continue;
+    }
+
+    std::vector<Node*> lookups;
+    for (auto& x : xs) {
+      auto* lookup = GetLookupTable(FindInputVar(fused_node, x));
+      if (lookup == nullptr ||
+          (!lookups.empty() && PaddingIdx(lookup) != PaddingIdx(lookups[0]))) {
+        break;
+      }
+      lookups.push_back(lookup);
+    }
+    if (lookups.empty() || lookups.size() != xs.size()) {
+      VLOG(3) << "not all the inputs of fusion_seqpool_cvm_concat are the "
+                 "lookup tables to fuse";
+      continue;
+    }
+
+    std::vector<Node*> ids_vars, w_vars;
+    std::vector<std::string> ids_names, w_names;
+    bool shared_table = true;
+    for (auto* lookup : lookups) {
+      ids_vars.push_back(FindInput(lookup, "Ids"));
+      ids_names.push_back(ids_vars.back()->Name());
+      w_vars.push_back(FindInput(lookup, "W"));
+      w_names.push_back(w_vars.back()->Name());
+      shared_table = shared_table && w_names.back() == w_names[0];
+    }
+    if (shared_table) {
+      w_vars.resize(1);
+      w_names.resize(1);
+    }
+
+    OpDesc op_desc;
+    op_desc.SetType("fused_embedding_seqpool_cvm_concat");
+    op_desc.SetInput("Ids", ids_names);
+    op_desc.SetInput("W", w_names);
+    op_desc.SetInput("CVM", {cvm_var->Name()});
+    op_desc.SetOutput("Out", op->Output("Out"));
+    op_desc.SetAttr("pooltype", op->GetAttr("pooltype"));
+    op_desc.SetAttr("use_cvm", op->GetAttr("use_cvm"));
+    op_desc.SetAttr("padding_idx", PaddingIdx(lookups[0]));
+    auto* new_op = graph->CreateOpNode(&op_desc);
+
+    std::vector<Node*> ins(ids_vars);
+    ins.insert(ins.end(), w_vars.begin(), w_vars.end());
+    ins.push_back(cvm_var);
+    std::unordered_set<Node*> linked;
+    for (auto* in : ins) {
+      if (linked.insert(in).second) {
+        IR_NODE_LINK_TO(in, new_op);
+      }
+    }
+    IR_NODE_LINK_TO(new_op, fused_node->outputs[0]);
+
+    std::unordered_set<const Node*> marked_nodes({fused_node});
+    for (auto* lookup : lookups) {
+      marked_nodes.insert(lookup);
+      marked_nodes.insert(lookup->outputs.begin(), lookup->outputs.end());
+    }
+    GraphSafeRemoveNodes(graph, marked_nodes);
+    ++count;
+  }
+  AddStatis(count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(embedding_seqpool_cvm_concat_fuse_pass,
+              paddle::framework::ir::EmbeddingSeqPoolCVMConcatFusePass);
@@ -0,0 +1,155 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_cvm_concat_fuse_pass.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "lookup_table") {
+    op->SetInput("Ids", {inputs[0]});
+    op->SetInput("W", {inputs[1]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("padding_idx", static_cast<int64_t>(-1));
+    op->SetAttr("remote_prefetch", false);
+  } else if (type == "sequence_pool") {
+    op->SetInput("X", {inputs[0]});
+    std::string pooltype = "SUM";
+    op->SetAttr("pooltype", pooltype);
+    op->SetOutput("MaxIndex", {outputs[0]});
+    op->SetOutput("Out", {outputs[1]});
+  } else if (type == "concat") {
+    op->SetInput("X", inputs);
+    op->SetAttr("axis", 1);
+    op->SetOutput("Out", {outputs[0]});
+  } else if (type == "cvm") {
+    op->SetInput("X", {inputs[0]});
+    op->SetInput("CVM", {inputs[1]});
+    op->SetOutput("Y", {outputs[0]});
+    op->SetAttr("use_cvm", true);
+  } else {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+int CountOpType(const ir::Graph* graph, const std::string& op_type) {
+  int count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == op_type) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// Build ids_i -> lookup_table -> sequence_pool -> cvm -> concat for each
+// slot, and apply seqpool_cvm_concat_fuse_pass and the tested pass.
+std::unique_ptr<ir::Graph> BuildAndFuse(const std::vector<std::string>& ws,
+                                        bool reuse_embedding, int* before,
+                                        int* after) {
+  ProgramDesc prog;
+  std::vector<std::string> cvm_outs;
+  prog.MutableBlock(0)->Var("cvm")->SetType(proto::VarType::LOD_TENSOR);
+  for (size_t i = 0; i < ws.size(); ++i) {
+    auto s = std::to_string(i);
+    for (auto& v : {"ids" + s, "emb" + s, "idx" + s, "pool" + s, "y" + s}) {
+      prog.MutableBlock(0)->Var(v)->SetType(proto::VarType::LOD_TENSOR);
+    }
+    prog.MutableBlock(0)->Var(ws[i])->SetPersistable(true);
+    SetOp(&prog, "lookup_table", {"ids" + s, ws[i]}, {"emb" + s});
+    SetOp(&prog, "sequence_pool", {"emb" + s}, {"idx" + s, "pool" + s});
+    SetOp(&prog, "cvm", {"pool" + s, "cvm"}, {"y" + s});
+    cvm_outs.push_back("y" + s);
+  }
+  prog.MutableBlock(0)->Var("out")->SetType(proto::VarType::LOD_TENSOR);
+  SetOp(&prog, "concat", cvm_outs, {"out"});
+  if (reuse_embedding) {
+    prog.MutableBlock(0)->Var("other")->SetType(proto::VarType::LOD_TENSOR);
+    SetOp(&prog, "relu", {"emb0"}, {"other"});
+  }
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto seqpool_pass =
+      PassRegistry::Instance().Get("seqpool_cvm_concat_fuse_pass");
+  graph.reset(seqpool_pass->Apply(graph.release()));
+  auto pass =
+      PassRegistry::Instance().Get("embedding_seqpool_cvm_concat_fuse_pass");
+  *before = graph->Nodes().size();
+  graph.reset(pass->Apply(graph.release()));
+  *after = graph->Nodes().size();
+  return graph;
+}
+
+TEST(EmbeddingSeqPoolCVMConcatFusePass, shared_table) {
+  int before, after;
+  auto graph = BuildAndFuse({"w", "w", "w"}, false, &before, &after);
+  // Remove 3 lookup_tables and their 3 outputs, and
+  // fusion_seqpool_cvm_concat
+  // Add 1 Node: fused_embedding_seqpool_cvm_concat
+  EXPECT_EQ(after, before - 6);
+  EXPECT_EQ(CountOpType(graph.get(), "lookup_table"), 0);
+  EXPECT_EQ(CountOpType(graph.get(), "fusion_seqpool_cvm_concat"), 0);
+  ASSERT_EQ(CountOpType(graph.get(), "fused_embedding_seqpool_cvm_concat"),
+            1);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() &&
+        node->Op()->Type() == "fused_embedding_seqpool_cvm_concat") {
+      EXPECT_EQ(node->Op()->Input("Ids"),
+                std::vector<std::string>({"ids0", "ids1", "ids2"}));
+      EXPECT_EQ(node->Op()->Input("W"), std::vector<std::string>({"w"}));
+      // ids0, ids1, ids2, w and cvm
+      EXPECT_EQ(node->inputs.size(), 5UL);
+    }
+  }
+}
+
+TEST(EmbeddingSeqPoolCVMConcatFusePass, table_per_slot) {
+  int before, after;
+  auto graph = BuildAndFuse({"w0", "w1"}, false, &before, &after);
+  EXPECT_EQ(after, before - 4);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() &&
+        node->Op()->Type() == "fused_embedding_seqpool_cvm_concat") {
+      EXPECT_EQ(node->Op()->Input("W"),
+                std::vector<std::string>({"w0", "w1"}));
+    }
+  }
+}
+
+TEST(EmbeddingSeqPoolCVMConcatFusePass, embedding_used_by_others) {
+  int before, after;
+  auto graph = BuildAndFuse({"w", "w"}, true, &before, &after);
+  EXPECT_EQ(after, before);
+  EXPECT_EQ(CountOpType(graph.get(), "lookup_table"), 2);
+  EXPECT_EQ(CountOpType(graph.get(), "fused_embedding_seqpool_cvm_concat"),
+            0);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(seqpool_cvm_concat_fuse_pass);
+USE_PASS(embedding_seqpool_cvm_concat_fuse_pass);
@@ -0,0 +1,577 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_attention_pass.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The head dims supported by the CUDA kernel of fused_attention.
+constexpr int64_t kMaxHeadDim = 128;
+
+struct AttentionNodes {
+  Node *qk_matmul{nullptr};
+  Node *scale{nullptr};
+  Node *bias_add{nullptr};
+  Node *softmax{nullptr};
+  Node *dropout{nullptr};
+  Node *pv_matmul{nullptr};
+
+  Node *q{nullptr};
+  Node *k{nullptr};
+  Node *v{nullptr};
+  Node *bias{nullptr};
+  Node *softmax_out{nullptr};
+  Node *mask{nullptr};
+  Node *out{nullptr};
+  float alpha{1.0f};
+
+  Node *d_out{nullptr};
+  Node *d_q{nullptr};
+  Node *d_k{nullptr};
+  Node *d_v{nullptr};
+
+  // The ops and the variables replaced by the fused ops.
+  std::vector<Node *> forward_ops;
+  std::vector<Node *> forward_vars;
+  std::vector<Node *> backward_ops;
+  std::vector<Node *> backward_vars;
+};
+
+// The attribute of the op, or the default value of the op maker if it is not
+// set, e.g. by the graphs built in the tests.
+template <typename T>
+T GetAttrOr(Node *op, const std::string &name, T default_value) {
+  return op->Op()->HasAttr(name) ? op->Op()->GetAttrIfExists<T>(name)
+                                 : default_value;
+}
+
+bool IsBackward(Node *op) {
+  int role = GetAttrOr<int>(op, OpProtoAndCheckerMaker::OpRoleAttrName(),
+                            static_cast<int>(OpRole::kForward));
+  return role & static_cast<int>(OpRole::kBackward);
+}
+
+bool IsOpOf(Node *node, const std::string &type) {
+  return node && node->IsOp() && node->Op() && node->Op()->Type() == type;
+}
+
+// The variable node of the only argument, or nullptr.
+Node *GetVar(Node *op, const std::string &argument, bool is_input) {
+  auto &arguments = is_input ? op->Op()->Inputs() : op->Op()->Outputs();
+  auto it = arguments.find(argument);
+  if (it == arguments.end() || it->second.size() != 1) {
+    return nullptr;
+  }
+  for (auto *var : is_input ? op->inputs : op->outputs) {
+    if (var->IsVar() && var->Name() == it->second[0]) {
+      return var;
+    }
+  }
+  return nullptr;
+}
+
+bool HasArgument(Node *op, const std::string &argument, bool is_input) {
+  auto &arguments = is_input ? op->Op()->Inputs() : op->Op()->Outputs();
+  auto it = arguments.find(argument);
+  return it != arguments.end() && !it->second.empty();
+}
+
+// Whether var is an intermediate variable between the ops, which may also
+// be read by the backward ops.
+bool IsIntermediate(Node *var, Node *producer, Node *forward_consumer) {
+  if (!var || !var->Var() || var->Var()->Persistable() ||
+      var->inputs.size() != 1 || var->inputs[0] != producer) {
+    return false;
+  }
+  for (auto *op : var->outputs) {
+    if (!op->IsOp() || !op->Op()) return false;
+    if (!IsBackward(op) && op != forward_consumer) return false;
+  }
+  return forward_consumer == nullptr ||
+         std::find(var->outputs.begin(), var->outputs.end(),
+                   forward_consumer) != var->outputs.end();
+}
+
+// The only forward op reading var.
+Node *GetForwardConsumer(Node *var) {
+  Node *consumer = nullptr;
+  for (auto *op : var->outputs) {
+    if (!op->IsOp() || !op->Op()) return nullptr;
+    if (IsBackward(op)) continue;
+    if (consumer) return nullptr;
+    consumer = op;
+  }
+  return consumer;
+}
+
+bool IsSupportedDataType(Node *var) {
+  auto dtype = var->Var()->GetDataType();
+  return dtype == proto::VarType::FP32 || dtype == proto::VarType::FP64 ||
+         dtype == proto::VarType::FP16;
+}
+
+// matmul(X, Y) of the batches of matrices, without the broadcast.
+bool IsBatchMatmul(Node *matmul, bool transpose_y) {
+  auto *x = GetVar(matmul, "X", true);
+  auto *y = GetVar(matmul, "Y", true);
+  if (!x || !y || !x->Var() || !y->Var() ||
+      GetAttrOr<bool>(matmul, "transpose_X", false) ||
+      GetAttrOr<bool>(matmul, "transpose_Y", false) != transpose_y ||
+      GetAttrOr<int>(matmul, "head_number", 1) > 1) {
+    return false;
+  }
+  auto x_shape = x->Var()->GetShape();
+  auto y_shape = y->Var()->GetShape();
+  if (x_shape.size() < 3 || x_shape.size() != y_shape.size() ||
+      !IsSupportedDataType(x)) {
+    return false;
+  }
+  int64_t head_dim = x_shape.back();
+  int64_t value_dim = transpose_y ? head_dim : y_shape.back();
+  return head_dim > 0 && head_dim <= kMaxHeadDim && value_dim > 0 &&
+         value_dim <= kMaxHeadDim;
+}
+
+bool MatchForward(Node *softmax, AttentionNodes *nodes) {
+  nodes->softmax = softmax;
+  auto *x = GetVar(softmax, "X", true);
+  auto *softmax_out = GetVar(softmax, "Out", false);
+  if (!x || !x->Var() || !softmax_out) return false;
+  int rank = static_cast<int>(x->Var()->GetShape().size());
+  int axis = GetAttrOr<int>(softmax, "axis", -1);
+  if (axis != -1 && axis != rank - 1) return false;
+  nodes->softmax_out = softmax_out;
+
+  // Match the ops before softmax backward.
+  Node *cur = x;
+  Node *consumer = softmax;
+  Node *producer = cur->inputs.size() == 1 ? cur->inputs[0] : nullptr;
+  auto step = [&](Node *op, const std::string &input) {
+    if (!IsIntermediate(cur, op, consumer)) return false;
+    nodes->forward_vars.push_back(cur);
+    consumer = op;
+    cur = GetVar(op, input, true);
+    producer = cur && cur->inputs.size() == 1 ? cur->inputs[0] : nullptr;
+    return cur != nullptr;
+  };
+  if (IsOpOf(producer, "elementwise_add")) {
+    auto *add = producer;
+    auto *add_x = GetVar(add, "X", true);
+    auto *add_y = GetVar(add, "Y", true);
+    if (!add_x || !add_y || !add_x->Var() || !add_y->Var() ||
+        add_x->Var()->GetShape() != add_y->Var()->GetShape()) {
+      return false;
+    }
+    nodes->bias_add = add;
+    nodes->bias = add_y;
+    if (!step(add, "X")) return false;
+  }
+  if (IsOpOf(producer, "scale")) {
+    auto *scale = producer;
+    if (HasArgument(scale, "ScaleTensor", true) ||
+        GetAttrOr<float>(scale, "bias", 0.0f) != 0.0f) {
+      return false;
+    }
+    nodes->scale = scale;
+    nodes->alpha *= GetAttrOr<float>(scale, "scale", 1.0f);
+    if (!step(scale, "X")) return false;
+  }
+  if (!IsOpOf(producer, "matmul") || !IsBatchMatmul(producer, true)) {
+    return false;
+  }
+  nodes->qk_matmul = producer;
+  nodes->alpha *= GetAttrOr<float>(producer, "alpha", 1.0f);
+  if (!IsIntermediate(cur, producer, consumer)) return false;
+  nodes->forward_vars.push_back(cur);
+  nodes->q = GetVar(producer, "X", true);
+  nodes->k = GetVar(producer, "Y", true);
+
+  // Match the ops after softmax forward.
+  cur = softmax_out;
+  consumer = GetForwardConsumer(cur);
+  if (IsOpOf(consumer, "dropout")) {
+    auto *dropout = consumer;
+    auto *dropout_out = GetVar(dropout, "Out", false);
+    if (HasArgument(dropout, "Seed", true) || !dropout_out ||
+        !IsIntermediate(cur, softmax, dropout)) {
+      return false;
+    }
+    nodes->dropout = dropout;
+    nodes->forward_vars.push_back(cur);
+    nodes->mask = GetVar(dropout, "Mask", false);
+    if (nodes->mask) {
+      if (!IsIntermediate(nodes->mask, dropout, nullptr)) return false;
+      nodes->forward_vars.push_back(nodes->mask);
+    }
+    producer = dropout;
+    cur = dropout_out;
+    consumer = GetForwardConsumer(cur);
+  } else {
+    producer = softmax;
+  }
+  if (!IsOpOf(consumer, "matmul") || !IsBatchMatmul(consumer, false) ||
+      GetAttrOr<float>(consumer, "alpha", 1.0f) != 1.0f ||
+      GetVar(consumer, "X", true) != cur ||
+      !IsIntermediate(cur, producer, consumer)) {
+    return false;
+  }
+  nodes->forward_vars.push_back(cur);
+  nodes->pv_matmul = consumer;
+  nodes->v = GetVar(consumer, "Y", true);
+  nodes->out = GetVar(consumer, "Out", false);
+  if (!nodes->out || nodes->v == cur ||
+      nodes->v->Var()->GetShape().size() !=
+          nodes->q->Var()->GetShape().size()) {
+    return false;
+  }
+
+  for (auto *op : {nodes->qk_matmul, nodes->scale, nodes->bias_add,
+                   nodes->softmax, nodes->dropout, nodes->pv_matmul}) {
+    if (op) nodes->forward_ops.push_back(op);
+  }
+  return true;
+}
+
+// The only backward op reading the gradient var, which is of type and reads
+// var as the input argument.
+Node *GetGradConsumer(Node *var, const std::string &type,
+                      const std::string &argument) {
+  if (!var || !var->Var() || var->Var()->Persistable() ||
+      var->inputs.size() != 1 || var->outputs.size() != 1) {
+    return nullptr;
+  }
+  auto *op = var->outputs[0];
+  if (!IsOpOf(op, type) || !IsBackward(op) ||
+      GetVar(op, argument, true) != var) {
+    return nullptr;
+  }
+  return op;
+}
+
+// Returns false if the backward exists but is not matched.
+bool MatchBackward(AttentionNodes *nodes, bool *has_backward) {
+  std::unordered_set<Node *> grad_ops;
+  for (auto *var : nodes->forward_vars) {
+    for (auto *op : var->outputs) {
+      if (IsBackward(op)) grad_ops.insert(op);
+    }
+  }
+  *has_backward = !grad_ops.empty();
+  if (!*has_backward) return true;
+
+  // The gradient of the matmul of V.
+  auto *pv_in = GetVar(nodes->pv_matmul, "X", true);
+  Node *pv_grad = nullptr;
+  for (auto *op : grad_ops) {
+    if (IsOpOf(op, "matmul_grad") && GetVar(op, "X", true) == pv_in &&
+        GetVar(op, "Y", true) == nodes->v) {
+      pv_grad = op;
+    }
+  }
+  if (!pv_grad) return false;
+  nodes->backward_ops.push_back(pv_grad);
+  nodes->d_out = GetVar(pv_grad, GradVarName("Out"), true);
+  nodes->d_v = GetVar(pv_grad, GradVarName("Y"), false);
+  auto *cur = GetVar(pv_grad, GradVarName("X"), false);
+  if (!nodes->d_out || !cur ||
+      (!nodes->d_v && HasArgument(pv_grad, GradVarName("Y"), false))) {
+    return false;
+  }
+
+  auto step = [&](Node *op, const std::string &output) {
+    if (!op) return false;
+    nodes->backward_ops.push_back(op);
+    nodes->backward_vars.push_back(cur);
+    cur = GetVar(op, output, false);
+    return cur != nullptr;
+  };
+  if (nodes->dropout) {
+    auto *dropout_grad =
+        GetGradConsumer(cur, "dropout_grad", GradVarName("Out"));
+    if (!dropout_grad || !nodes->mask ||
+        GetVar(dropout_grad, "Mask", true) != nodes->mask ||
+        !step(dropout_grad, GradVarName("X"))) {
+      return false;
+    }
+  }
+  auto *softmax_grad = GetGradConsumer(cur, "softmax_grad", GradVarName("Out"));
+  if (!softmax_grad ||
+      GetVar(softmax_grad, "Out", true) != nodes->softmax_out ||
+      !step(softmax_grad, GradVarName("X"))) {
+    return false;
+  }
+  if (nodes->bias_add) {
+    auto *add_grad =
+        GetGradConsumer(cur, "elementwise_add_grad", GradVarName("Out"));
+    // The gradient of the bias is not computed by fused_attention_grad.
+    if (!add_grad || HasArgument(add_grad, GradVarName("Y"), false) ||
+        !step(add_grad, GradVarName("X"))) {
+      return false;
+    }
+  }
+  if (nodes->scale) {
+    // The gradient op of scale is scale.
+    auto *scale_grad = GetGradConsumer(cur, "scale", "X");
+    if (!scale_grad ||
+        GetAttrOr<float>(scale_grad, "scale", 1.0f) !=
+            GetAttrOr<float>(nodes->scale, "scale", 1.0f) ||
+        !step(scale_grad, "Out")) {
+      return false;
+    }
+  }
+  auto *qk_grad = GetGradConsumer(cur, "matmul_grad", GradVarName("Out"));
+  if (!qk_grad || GetVar(qk_grad, "X", true) != nodes->q ||
+      GetVar(qk_grad, "Y", true) != nodes->k) {
+    return false;
+  }
+  nodes->backward_ops.push_back(qk_grad);
+  nodes->backward_vars.push_back(cur);
+  nodes->d_q = GetVar(qk_grad, GradVarName("X"), false);
+  nodes->d_k = GetVar(qk_grad, GradVarName("Y"), false);
+  if ((!nodes->d_q && HasArgument(qk_grad, GradVarName("X"), false)) ||
+      (!nodes->d_k && HasArgument(qk_grad, GradVarName("Y"), false))) {
+    return false;
+  }
+
+  // All the backward ops reading the forward variables are replaced.
+  for (auto *op : grad_ops) {
+    if (std::find(nodes->backward_ops.begin(), nodes->backward_ops.end(),
+                  op) == nodes->backward_ops.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SetAttentionAttrs(const AttentionNodes &nodes, OpDesc *desc) {
+  desc->SetAttr("alpha", nodes.alpha);
+  if (nodes.dropout) {
+    auto *dropout = nodes.dropout->Op();
+    desc->SetAttr("dropout_prob",
+                  dropout->GetAttrIfExists<float>("dropout_prob"));
+    desc->SetAttr("is_test", dropout->GetAttrIfExists<bool>("is_test"));
+    desc->SetAttr("fix_seed", dropout->GetAttrIfExists<bool>("fix_seed"));
+    desc->SetAttr("seed", dropout->GetAttrIfExists<int>("seed"));
+    std::string implementation =
+        dropout->GetAttrIfExists<std::string>("dropout_implementation");
+    desc->SetAttr("dropout_implementation", implementation.empty()
+                                                ? "downgrade_in_infer"
+                                                : implementation);
+  } else {
+    desc->SetAttr("dropout_prob", 0.0f);
+    desc->SetAttr("is_test", false);
+    desc->SetAttr("fix_seed", false);
+    desc->SetAttr("seed", 0);
+    desc->SetAttr("dropout_implementation",
+                  std::string("downgrade_in_infer"));
+  }
+}
+
+// Move the control dependencies of the replaced ops to the fused ops, and
+// remove the ones between the replaced ops of the same fused op.
+void RelinkCtrlVars(const std::unordered_map<Node *, Node *> &fused_ops,
+                    std::unordered_set<const Node *> *removed_nodes) {
+  std::unordered_set<Node *> ctrl_vars;
+  std::unordered_set<Node *> new_ops;
+  for (auto &pair : fused_ops) {
+    new_ops.insert(pair.second);
+    for (auto *var : pair.first->inputs) {
+      if (var->IsCtrlVar()) ctrl_vars.insert(var);
+    }
+    for (auto *var : pair.first->outputs) {
+      if (var->IsCtrlVar()) ctrl_vars.insert(var);
+    }
+  }
+  auto map_ops = [&](const std::vector<Node *> &ops) {
+    std::vector<Node *> ret;
+    for (auto *op : ops) {
+      auto it = fused_ops.find(op);
+      auto *new_op = it == fused_ops.end() ? op : it->second;
+      if (std::find(ret.begin(), ret.end(), new_op) == ret.end()) {
+        ret.push_back(new_op);
+      }
+    }
+    return ret;
+  };
+  for (auto *var : ctrl_vars) {
+    auto inputs = map_ops(var->inputs);
+    auto outputs = map_ops(var->outputs);
+    bool self_loop = false;
+    for (auto *op : inputs) {
+      if (std::find(outputs.begin(), outputs.end(), op) != outputs.end()) {
+        self_loop = true;
+      }
+    }
+    if (self_loop) {
+      removed_nodes->insert(var);
+      continue;
+    }
+    var->inputs = inputs;
+    var->outputs = outputs;
+    for (auto *op : inputs) {
+      if (new_ops.count(op)) op->outputs.push_back(var);
+    }
+    for (auto *op : outputs) {
+      if (new_ops.count(op)) op->inputs.push_back(var);
+    }
+  }
+}
+
+void FuseAttention(Graph *graph, const AttentionNodes &nodes,
+                   bool has_backward) {
+  auto q_shape = nodes.q->Var()->GetShape();
+  auto q_dtype = nodes.q->Var()->GetDataType();
+  VarDesc lse_desc(nodes.out->Name() + "@SoftmaxLse");
+  lse_desc.SetShape(std::vector<int64_t>(q_shape.begin(), q_shape.end() - 1));
+  lse_desc.SetDataType(q_dtype == proto::VarType::FP16 ? proto::VarType::FP32
+                                                       : q_dtype);
+  VarDesc seed_desc(nodes.out->Name() + "@SeedOut");
+  seed_desc.SetShape({1});
+  seed_desc.SetDataType(proto::VarType::INT32);
+  auto *lse = graph->CreateVarNode(&lse_desc);
+  auto *seed = graph->CreateVarNode(&seed_desc);
+
+  OpDesc desc;
+  desc.SetType("fused_attention");
+  desc.SetInput("Q", {nodes.q->Name()});
+  desc.SetInput("K", {nodes.k->Name()});
+  desc.SetInput("V", {nodes.v->Name()});
+  if (nodes.bias) {
+    desc.SetInput("BiasQK", {nodes.bias->Name()});
+  }
+  desc.SetOutput("Out", {nodes.out->Name()});
+  desc.SetOutput("SoftmaxLse", {lse->Name()});
+  desc.SetOutput("SeedOut", {seed->Name()});
+  SetAttentionAttrs(nodes, &desc);
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               GetAttrOr<int>(nodes.softmax,
+                              OpProtoAndCheckerMaker::OpRoleAttrName(),
+                              static_cast<int>(OpRole::kForward)));
+  auto *fused = graph->CreateOpNode(&desc);
+  for (auto *in : {nodes.q, nodes.k, nodes.v, nodes.bias}) {
+    if (in) IR_NODE_LINK_TO(in, fused);
+  }
+  for (auto *out : {nodes.out, lse, seed}) {
+    IR_NODE_LINK_TO(fused, out);
+  }
+
+  std::unordered_map<Node *, Node *> fused_ops;
+  for (auto *op : nodes.forward_ops) {
+    fused_ops[op] = fused;
+  }
+  if (has_backward) {
+    OpDesc grad_desc;
+    grad_desc.SetType("fused_attention_grad");
+    grad_desc.SetInput("Q", {nodes.q->Name()});
+    grad_desc.SetInput("K", {nodes.k->Name()});
+    grad_desc.SetInput("V", {nodes.v->Name()});
+    if (nodes.bias) {
+      grad_desc.SetInput("BiasQK", {nodes.bias->Name()});
+    }
+    grad_desc.SetInput("Out", {nodes.out->Name()});
+    grad_desc.SetInput("SoftmaxLse", {lse->Name()});
+    grad_desc.SetInput("SeedOut", {seed->Name()});
+    grad_desc.SetInput(GradVarName("Out"), {nodes.d_out->Name()});
+    if (nodes.d_q) {
+      grad_desc.SetOutput(GradVarName("Q"), {nodes.d_q->Name()});
+    }
+    if (nodes.d_k) {
+      grad_desc.SetOutput(GradVarName("K"), {nodes.d_k->Name()});
+    }
+    if (nodes.d_v) {
+      grad_desc.SetOutput(GradVarName("V"), {nodes.d_v->Name()});
+    }
+    SetAttentionAttrs(nodes, &grad_desc);
+    grad_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                      static_cast<int>(OpRole::kBackward));
+    // Keep the parameters and the gradients of the replaced ops, which are
+    // used by the optimization and the distributed training.
+    std::vector<std::string> op_role_var;
+    for (auto *op : nodes.backward_ops) {
+      auto role_var = op->Op()->GetAttrIfExists<std::vector<std::string>>(
+          OpProtoAndCheckerMaker::OpRoleVarAttrName());
+      op_role_var.insert(op_role_var.end(), role_var.begin(), role_var.end());
+    }
+    if (!op_role_var.empty()) {
+      grad_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+                        op_role_var);
+    }
+    auto *fused_grad = graph->CreateOpNode(&grad_desc);
+    for (auto *in : {nodes.q, nodes.k, nodes.v, nodes.bias, nodes.out, lse,
+                     seed, nodes.d_out}) {
+      if (in) IR_NODE_LINK_TO(in, fused_grad);
+    }
+    for (auto *out : {nodes.d_q, nodes.d_k, nodes.d_v}) {
+      if (out) IR_NODE_LINK_TO(fused_grad, out);
+    }
+    for (auto *op : nodes.backward_ops) {
+      fused_ops[op] = fused_grad;
+    }
+  }
+
+  std::unordered_set<const Node *> removed_nodes;
+  for (auto &pair : fused_ops) {
+    removed_nodes.insert(pair.first);
+  }
+  removed_nodes.insert(nodes.forward_vars.begin(), nodes.forward_vars.end());
+  removed_nodes.insert(nodes.backward_vars.begin(), nodes.backward_vars.end());
+  RelinkCtrlVars(fused_ops, &removed_nodes);
+  GraphSafeRemoveNodes(graph, removed_nodes);
+}
+
+}  // namespace
+
+void FuseAttentionPass::ApplyImpl(ir::Graph *graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+
+  // Each attention has one softmax, which is not removed by the fusion of
+  // the others.
+  auto &softmax_nodes = graph->OpNodesOfType("softmax");
+  std::vector<Node *> softmax_ops(softmax_nodes.begin(), softmax_nodes.end());
+  int found_count = 0;
+  for (auto *softmax : softmax_ops) {
+    if (!IsOpOf(softmax, "softmax") || IsBackward(softmax)) continue;
+    AttentionNodes nodes;
+    bool has_backward = false;
+    if (!MatchForward(softmax, &nodes) ||
+        !MatchBackward(&nodes, &has_backward)) {
+      continue;
+    }
+    VLOG(4) << "fuse the attention of " << nodes.q->Name() << ", "
+            << nodes.k->Name() << " and " << nodes.v->Name() << " -> "
+            << nodes.out->Name() << (has_backward ? " with backward" : "");
+    FuseAttention(graph, nodes, has_backward);
+    ++found_count;
+  }
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_attention_pass, paddle::framework::ir::FuseAttentionPass);
@@ -0,0 +1,52 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the attention of the transformer models
+ *
+ *   matmul(Q, K^T) -> [scale] -> [elementwise_add(BiasQK)] -> softmax
+ *   -> [dropout] -> matmul(V)
+ *
+ * into fused_attention, and its backward,
+ *
+ *   matmul_grad -> [dropout_grad] -> softmax_grad
+ *   -> [elementwise_add_grad] -> [scale] -> matmul_grad
+ *
+ * into fused_attention_grad, so that the attention scores are neither
+ * stored nor read by the training. The forward alone is fused if the graph
+ * has no backward of the attention.
+ */
+class FuseAttentionPass : public FusePassBase {
+ public:
+  virtual ~FuseAttentionPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph *graph) const override;
+
+  const std::string name_scope_{"fuse_attention"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
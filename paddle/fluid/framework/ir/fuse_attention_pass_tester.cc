@@ -0,0 +1,238 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/fuse_attention_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+using VarNames = std::map<std::string, std::vector<std::string>>;
+
+// Builds the attention of the transformer, and the gradient ops generated by
+// the backward of the program optionally.
+class AttentionProgram {
+ public:
+  AttentionProgram(int64_t head_dim, bool with_dropout)
+      : with_dropout_(with_dropout) {
+    Var("q", {2, 4, 16, head_dim});
+    Var("k", {2, 4, 16, head_dim});
+    Var("v", {2, 4, 16, head_dim});
+    Var("bias", {2, 4, 16, 16});
+    for (auto name : {"qk", "scaled", "biased", "p", "dropped"}) {
+      Var(name, {2, 4, 16, 16});
+    }
+    Var("mask", {2, 4, 16, 16}, proto::VarType::UINT8);
+    Var("out", {2, 4, 16, head_dim});
+
+    auto role = static_cast<int>(OpRole::kForward);
+    Op("matmul", {{"X", {"q"}}, {"Y", {"k"}}}, {{"Out", {"qk"}}},
+       {{"transpose_X", false}, {"transpose_Y", true}, {"alpha", 1.0f}},
+       role);
+    Op("scale", {{"X", {"qk"}}}, {{"Out", {"scaled"}}},
+       {{"scale", 0.125f}, {"bias", 0.0f}}, role);
+    Op("elementwise_add", {{"X", {"scaled"}}, {"Y", {"bias"}}},
+       {{"Out", {"biased"}}}, {{"axis", -1}}, role);
+    Op("softmax", {{"X", {"biased"}}}, {{"Out", {"p"}}}, {{"axis", -1}},
+       role);
+    std::string p = "p";
+    if (with_dropout) {
+      Op("dropout", {{"X", {"p"}}}, {{"Out", {"dropped"}}, {"Mask", {"mask"}}},
+         {{"dropout_prob", 0.1f},
+          {"is_test", false},
+          {"fix_seed", true},
+          {"seed", 1},
+          {"dropout_implementation", std::string("upscale_in_train")}},
+         role);
+      p = "dropped";
+    }
+    Op("matmul", {{"X", {p}}, {"Y", {"v"}}}, {{"Out", {"out"}}},
+       {{"transpose_X", false}, {"transpose_Y", false}, {"alpha", 1.0f}},
+       role);
+  }
+
+  void Backward() {
+    for (auto name :
+         {"q", "k", "v", "qk", "scaled", "biased", "p", "dropped", "out"}) {
+      auto* var = program_.MutableBlock(0)->FindVar(name);
+      Var(GradVarName(name), var->GetShape());
+    }
+    auto role = static_cast<int>(OpRole::kBackward);
+    std::string p = with_dropout_ ? "dropped" : "p";
+    Op("matmul_grad",
+       {{"X", {p}}, {"Y", {"v"}}, {GradVarName("Out"), {GradVarName("out")}}},
+       {{GradVarName("X"), {GradVarName(p)}},
+        {GradVarName("Y"), {GradVarName("v")}}},
+       {{"transpose_X", false}, {"transpose_Y", false}, {"alpha", 1.0f}},
+       role);
+    if (with_dropout_) {
+      Op("dropout_grad",
+         {{"Mask", {"mask"}}, {GradVarName("Out"), {GradVarName("dropped")}}},
+         {{GradVarName("X"), {GradVarName("p")}}},
+         {{"dropout_prob", 0.1f},
+          {"is_test", false},
+          {"dropout_implementation", std::string("upscale_in_train")}},
+         role);
+    }
+    Op("softmax_grad",
+       {{"Out", {"p"}}, {GradVarName("Out"), {GradVarName("p")}}},
+       {{GradVarName("X"), {GradVarName("biased")}}}, {{"axis", -1}}, role);
+    Op("elementwise_add_grad",
+       {{"X", {"scaled"}},
+        {"Y", {"bias"}},
+        {GradVarName("Out"), {GradVarName("biased")}}},
+       {{GradVarName("X"), {GradVarName("scaled")}}}, {{"axis", -1}}, role);
+    Op("scale", {{"X", {GradVarName("scaled")}}},
+       {{"Out", {GradVarName("qk")}}}, {{"scale", 0.125f}, {"bias", 0.0f}},
+       role);
+    Op("matmul_grad",
+       {{"X", {"q"}}, {"Y", {"k"}}, {GradVarName("Out"), {GradVarName("qk")}}},
+       {{GradVarName("X"), {GradVarName("q")}},
+        {GradVarName("Y"), {GradVarName("k")}}},
+       {{"transpose_X", false}, {"transpose_Y", true}, {"alpha", 1.0f}},
+       role);
+  }
+
+  // Another forward op reading the variable of the attention.
+  void Read(const std::string& name) {
+    Var(name + "_copy", program_.MutableBlock(0)->FindVar(name)->GetShape());
+    Op("relu", {{"X", {name}}}, {{"Out", {name + "_copy"}}}, {},
+       static_cast<int>(OpRole::kForward));
+  }
+
+  const ProgramDesc& program() const { return program_; }
+
+ private:
+  void Var(const std::string& name, const std::vector<int64_t>& shape,
+           proto::VarType::Type dtype = proto::VarType::FP32) {
+    auto* var = program_.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(dtype);
+    var->SetShape(shape);
+  }
+
+  void Op(const std::string& type, const VarNames& inputs,
+          const VarNames& outputs, const AttributeMap& attrs, int role) {
+    auto* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType(type);
+    for (auto& input : inputs) {
+      op->SetInput(input.first, input.second);
+    }
+    for (auto& output : outputs) {
+      op->SetOutput(output.first, output.second);
+    }
+    for (auto& attr : attrs) {
+      op->SetAttr(attr.first, attr.second);
+    }
+    op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(), role);
+  }
+
+  bool with_dropout_;
+  ProgramDesc program_;
+};
+
+std::unique_ptr<Graph> ApplyPass(const ProgramDesc& program) {
+  std::unique_ptr<Graph> graph(new Graph(program));
+  auto pass = PassRegistry::Instance().Get("fuse_attention_pass");
+  VLOG(3) << DebugString(graph);
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+  return graph;
+}
+
+std::vector<OpDesc*> GetOps(const std::unique_ptr<Graph>& graph,
+                            const std::string& op_type) {
+  std::vector<OpDesc*> ops;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op()->Type() == op_type) {
+      ops.push_back(node->Op());
+    }
+  }
+  return ops;
+}
+
+TEST(FuseAttentionPass, forward_and_backward) {
+  AttentionProgram attention(64, true);
+  attention.Backward();
+  auto graph = ApplyPass(attention.program());
+
+  // Only the fused ops are left.
+  ASSERT_EQ(TopologySortOperations(*graph).size(), 2UL);
+  auto fused = GetOps(graph, "fused_attention");
+  auto fused_grad = GetOps(graph, "fused_attention_grad");
+  ASSERT_EQ(fused.size(), 1UL);
+  ASSERT_EQ(fused_grad.size(), 1UL);
+
+  EXPECT_EQ(fused[0]->Input("BiasQK"), std::vector<std::string>({"bias"}));
+  EXPECT_EQ(fused[0]->Output("Out"), std::vector<std::string>({"out"}));
+  EXPECT_FLOAT_EQ(boost::get<float>(fused[0]->GetAttr("alpha")), 0.125f);
+  EXPECT_FLOAT_EQ(boost::get<float>(fused[0]->GetAttr("dropout_prob")),
+                  0.1f);
+  EXPECT_EQ(
+      boost::get<std::string>(fused[0]->GetAttr("dropout_implementation")),
+      "upscale_in_train");
+
+  // The gradient reads the saved statistics of the forward.
+  EXPECT_EQ(fused_grad[0]->Input("SoftmaxLse"),
+            fused[0]->Output("SoftmaxLse"));
+  EXPECT_EQ(fused_grad[0]->Input("SeedOut"), fused[0]->Output("SeedOut"));
+  EXPECT_EQ(fused_grad[0]->Output(GradVarName("Q")),
+            std::vector<std::string>({GradVarName("q")}));
+  EXPECT_EQ(fused_grad[0]->Output(GradVarName("K")),
+            std::vector<std::string>({GradVarName("k")}));
+  EXPECT_EQ(fused_grad[0]->Output(GradVarName("V")),
+            std::vector<std::string>({GradVarName("v")}));
+  EXPECT_EQ(boost::get<int>(fused_grad[0]->GetAttr(
+                OpProtoAndCheckerMaker::OpRoleAttrName())),
+            static_cast<int>(OpRole::kBackward));
+}
+
+TEST(FuseAttentionPass, forward_only) {
+  AttentionProgram attention(64, false);
+  auto graph = ApplyPass(attention.program());
+
+  ASSERT_EQ(TopologySortOperations(*graph).size(), 1UL);
+  auto fused = GetOps(graph, "fused_attention");
+  ASSERT_EQ(fused.size(), 1UL);
+  EXPECT_FLOAT_EQ(boost::get<float>(fused[0]->GetAttr("dropout_prob")),
+                  0.0f);
+}
+
+TEST(FuseAttentionPass, scores_used_by_others) {
+  // The attention probabilities are read by another op.
+  AttentionProgram attention(64, false);
+  attention.Read("p");
+  attention.Backward();
+  auto graph = ApplyPass(attention.program());
+  EXPECT_EQ(GetOps(graph, "fused_attention").size(), 0UL);
+  EXPECT_EQ(GetOps(graph, "softmax").size(), 1UL);
+}
+
+TEST(FuseAttentionPass, unsupported_head_dim) {
+  AttentionProgram attention(256, false);
+  attention.Backward();
+  auto graph = ApplyPass(attention.program());
+  EXPECT_EQ(GetOps(graph, "fused_attention").size(), 0UL);
+  EXPECT_EQ(GetOps(graph, "fused_attention_grad").size(), 0UL);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_attention_pass);
@@ -0,0 +1,443 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_dropout_residual_layer_norm_pass.h"
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The bits of the dropout mask in a byte.
+constexpr int64_t kDropoutMaskBits = 8;
+
+struct ResidualNodes {
+  Node *dropout{nullptr};
+  Node *add{nullptr};
+  Node *layer_norm{nullptr};
+
+  Node *x{nullptr};
+  Node *residual{nullptr};
+  Node *scale{nullptr};
+  Node *bias{nullptr};
+  Node *dropout_out{nullptr};
+  Node *mask{nullptr};
+  Node *z{nullptr};
+  Node *y{nullptr};
+  Node *mean{nullptr};
+  Node *variance{nullptr};
+
+  Node *d_y{nullptr};
+  Node *d_x{nullptr};
+  Node *d_residual{nullptr};
+  Node *d_scale{nullptr};
+  Node *d_bias{nullptr};
+
+  // The ops and the variables replaced by the fused ops.
+  std::vector<Node *> forward_ops;
+  std::vector<Node *> forward_vars;
+  std::vector<Node *> backward_ops;
+  std::vector<Node *> backward_vars;
+};
+
+// The attribute of the op, or the default value of the op maker if it is not
+// set, e.g. by the graphs built in the tests.
+template <typename T>
+T GetAttrOr(Node *op, const std::string &name, T default_value) {
+  return op->Op()->HasAttr(name) ? op->Op()->GetAttrIfExists<T>(name)
+                                 : default_value;
+}
+
+bool IsBackward(Node *op) {
+  int role = GetAttrOr<int>(op, OpProtoAndCheckerMaker::OpRoleAttrName(),
+                            static_cast<int>(OpRole::kForward));
+  return role & static_cast<int>(OpRole::kBackward);
+}
+
+bool IsOpOf(Node *node, const std::string &type) {
+  return node && node->IsOp() && node->Op() && node->Op()->Type() == type;
+}
+
+// The variable node of the only argument, or nullptr.
+Node *GetVar(Node *op, const std::string &argument, bool is_input) {
+  auto &arguments = is_input ? op->Op()->Inputs() : op->Op()->Outputs();
+  auto it = arguments.find(argument);
+  if (it == arguments.end() || it->second.size() != 1) {
+    return nullptr;
+  }
+  for (auto *var : is_input ? op->inputs : op->outputs) {
+    if (var->IsVar() && var->Name() == it->second[0]) {
+      return var;
+    }
+  }
+  return nullptr;
+}
+
+bool HasArgument(Node *op, const std::string &argument, bool is_input) {
+  auto &arguments = is_input ? op->Op()->Inputs() : op->Op()->Outputs();
+  auto it = arguments.find(argument);
+  return it != arguments.end() && !it->second.empty();
+}
+
+// Whether var is an intermediate variable written by producer, and read by
+// forward_consumer alone of the forward ops.
+bool IsIntermediate(Node *var, Node *producer, Node *forward_consumer) {
+  if (!var || !var->Var() || var->Var()->Persistable() ||
+      var->inputs.size() != 1 || var->inputs[0] != producer) {
+    return false;
+  }
+  for (auto *op : var->outputs) {
+    if (!op->IsOp() || !op->Op()) return false;
+    if (!IsBackward(op) && op != forward_consumer) return false;
+  }
+  return forward_consumer == nullptr ||
+         std::find(var->outputs.begin(), var->outputs.end(),
+                   forward_consumer) != var->outputs.end();
+}
+
+// The control dependencies are not moved to the fused ops.
+bool HasCtrlVar(Node *op) {
+  for (auto *var : op->inputs) {
+    if (var->IsCtrlVar()) return true;
+  }
+  for (auto *var : op->outputs) {
+    if (var->IsCtrlVar()) return true;
+  }
+  return false;
+}
+
+bool MatchForward(Node *layer_norm, ResidualNodes *nodes) {
+  nodes->layer_norm = layer_norm;
+  nodes->z = GetVar(layer_norm, "X", true);
+  nodes->y = GetVar(layer_norm, "Y", false);
+  nodes->mean = GetVar(layer_norm, "Mean", false);
+  nodes->variance = GetVar(layer_norm, "Variance", false);
+  nodes->scale = GetVar(layer_norm, "Scale", true);
+  nodes->bias = GetVar(layer_norm, "Bias", true);
+  if (!nodes->z || !nodes->y || !nodes->mean || !nodes->variance ||
+      nodes->z->inputs.size() != 1 ||
+      !IsIntermediate(nodes->mean, layer_norm, nullptr) ||
+      !IsIntermediate(nodes->variance, layer_norm, nullptr)) {
+    return false;
+  }
+
+  auto *add = nodes->z->inputs[0];
+  if (!IsOpOf(add, "elementwise_add") || IsBackward(add) ||
+      !IsIntermediate(nodes->z, add, layer_norm)) {
+    return false;
+  }
+  nodes->add = add;
+  auto *add_x = GetVar(add, "X", true);
+  auto *add_y = GetVar(add, "Y", true);
+  if (!add_x || !add_y || add_x == add_y || !add_x->Var() || !add_y->Var() ||
+      add_x->Var()->GetShape() != add_y->Var()->GetShape()) {
+    return false;
+  }
+  // Either input of elementwise_add may be the dropout.
+  for (auto *in : {add_x, add_y}) {
+    auto *producer = in->inputs.size() == 1 ? in->inputs[0] : nullptr;
+    if (IsOpOf(producer, "dropout") && !IsBackward(producer) &&
+        !HasArgument(producer, "Seed", true) &&
+        IsIntermediate(in, producer, add)) {
+      nodes->dropout = producer;
+      nodes->dropout_out = in;
+      nodes->residual = in == add_x ? add_y : add_x;
+      break;
+    }
+  }
+  if (!nodes->dropout) return false;
+  nodes->x = GetVar(nodes->dropout, "X", true);
+  nodes->mask = GetVar(nodes->dropout, "Mask", false);
+  if (!nodes->x || !nodes->x->Var() || nodes->x == nodes->residual ||
+      (nodes->mask && !IsIntermediate(nodes->mask, nodes->dropout, nullptr))) {
+    return false;
+  }
+  auto dtype = nodes->x->Var()->GetDataType();
+  if (dtype != proto::VarType::FP32 && dtype != proto::VarType::FP64) {
+    return false;
+  }
+  int rank = static_cast<int>(nodes->z->Var()->GetShape().size());
+  int begin_norm_axis = GetAttrOr<int>(layer_norm, "begin_norm_axis", 1);
+  if (begin_norm_axis <= 0 || begin_norm_axis >= rank) return false;
+
+  nodes->forward_ops = {nodes->dropout, add, layer_norm};
+  nodes->forward_vars.push_back(nodes->dropout_out);
+  if (nodes->mask) {
+    nodes->forward_vars.push_back(nodes->mask);
+  }
+  for (auto *op : nodes->forward_ops) {
+    if (HasCtrlVar(op)) return false;
+  }
+  return true;
+}
+
+// The only backward op reading the gradient var, which is of type and reads
+// var as the input argument.
+Node *GetGradConsumer(Node *var, const std::string &type,
+                      const std::string &argument) {
+  if (!var || !var->Var() || var->Var()->Persistable() ||
+      var->inputs.size() != 1 || var->outputs.size() != 1) {
+    return nullptr;
+  }
+  auto *op = var->outputs[0];
+  if (!IsOpOf(op, type) || !IsBackward(op) ||
+      GetVar(op, argument, true) != var) {
+    return nullptr;
+  }
+  return op;
+}
+
+// Returns false if the backward exists but is not matched.
+bool MatchBackward(ResidualNodes *nodes, bool *has_backward) {
+  std::unordered_set<Node *> grad_ops;
+  for (auto *var : {nodes->dropout_out, nodes->mask, nodes->z, nodes->mean,
+                    nodes->variance}) {
+    if (!var) continue;
+    for (auto *op : var->outputs) {
+      if (IsBackward(op)) grad_ops.insert(op);
+    }
+  }
+  *has_backward = !grad_ops.empty();
+  if (!*has_backward) return true;
+
+  Node *ln_grad = nullptr;
+  for (auto *op : grad_ops) {
+    if (IsOpOf(op, "layer_norm_grad") &&
+        GetVar(op, "X", true) == nodes->z &&
+        GetVar(op, "Mean", true) == nodes->mean &&
+        GetVar(op, "Variance", true) == nodes->variance) {
+      ln_grad = op;
+    }
+  }
+  if (!ln_grad) return false;
+  nodes->backward_ops.push_back(ln_grad);
+  nodes->d_y = GetVar(ln_grad, GradVarName("Y"), true);
+  nodes->d_scale = GetVar(ln_grad, GradVarName("Scale"), false);
+  nodes->d_bias = GetVar(ln_grad, GradVarName("Bias"), false);
+  auto *d_z = GetVar(ln_grad, GradVarName("X"), false);
+  if (!nodes->d_y || !d_z ||
+      (!nodes->d_scale && HasArgument(ln_grad, GradVarName("Scale"), false)) ||
+      (!nodes->d_bias && HasArgument(ln_grad, GradVarName("Bias"), false))) {
+    return false;
+  }
+
+  auto *add_grad =
+      GetGradConsumer(d_z, "elementwise_add_grad", GradVarName("Out"));
+  if (!add_grad) return false;
+  nodes->backward_ops.push_back(add_grad);
+  nodes->backward_vars.push_back(d_z);
+  bool dropout_is_x = GetVar(nodes->add, "X", true) == nodes->dropout_out;
+  auto dropout_grad_name = GradVarName(dropout_is_x ? "X" : "Y");
+  auto residual_grad_name = GradVarName(dropout_is_x ? "Y" : "X");
+  auto *d_dropout_out = GetVar(add_grad, dropout_grad_name, false);
+  nodes->d_residual = GetVar(add_grad, residual_grad_name, false);
+  if ((!d_dropout_out && HasArgument(add_grad, dropout_grad_name, false)) ||
+      (!nodes->d_residual &&
+       HasArgument(add_grad, residual_grad_name, false))) {
+    return false;
+  }
+
+  if (d_dropout_out) {
+    auto *dropout_grad =
+        GetGradConsumer(d_dropout_out, "dropout_grad", GradVarName("Out"));
+    if (!dropout_grad || !nodes->mask ||
+        GetVar(dropout_grad, "Mask", true) != nodes->mask) {
+      return false;
+    }
+    nodes->backward_ops.push_back(dropout_grad);
+    nodes->backward_vars.push_back(d_dropout_out);
+    nodes->d_x = GetVar(dropout_grad, GradVarName("X"), false);
+    if (!nodes->d_x) return false;
+  }
+
+  // All the backward ops reading the forward variables are replaced.
+  for (auto *op : grad_ops) {
+    if (std::find(nodes->backward_ops.begin(), nodes->backward_ops.end(),
+                  op) == nodes->backward_ops.end()) {
+      return false;
+    }
+  }
+  for (auto *op : nodes->backward_ops) {
+    if (HasCtrlVar(op)) return false;
+  }
+  return true;
+}
+
+void SetResidualAttrs(const ResidualNodes &nodes, OpDesc *desc) {
+  auto *dropout = nodes.dropout->Op();
+  desc->SetAttr("dropout_prob",
+                GetAttrOr<float>(nodes.dropout, "dropout_prob", 0.5f));
+  desc->SetAttr("is_test", GetAttrOr<bool>(nodes.dropout, "is_test", false));
+  desc->SetAttr("fix_seed", GetAttrOr<bool>(nodes.dropout, "fix_seed", false));
+  desc->SetAttr("seed", GetAttrOr<int>(nodes.dropout, "seed", 0));
+  std::string implementation =
+      dropout->GetAttrIfExists<std::string>("dropout_implementation");
+  desc->SetAttr("dropout_implementation", implementation.empty()
+                                              ? "downgrade_in_infer"
+                                              : implementation);
+  desc->SetAttr("epsilon",
+                GetAttrOr<float>(nodes.layer_norm, "epsilon", 1e-5f));
+  desc->SetAttr("begin_norm_axis",
+                GetAttrOr<int>(nodes.layer_norm, "begin_norm_axis", 1));
+}
+
+// The shape of the mask by bits, [left, ceil(right / 8)].
+std::vector<int64_t> GetMaskShape(const ResidualNodes &nodes) {
+  auto shape = nodes.z->Var()->GetShape();
+  int begin_norm_axis = GetAttrOr<int>(nodes.layer_norm, "begin_norm_axis", 1);
+  int64_t left = 1;
+  int64_t right = 1;
+  for (int i = 0; i < static_cast<int>(shape.size()); ++i) {
+    int64_t &size = i < begin_norm_axis ? left : right;
+    size = shape[i] < 0 || size < 0 ? -1 : size * shape[i];
+  }
+  return {left, right < 0 ? -1 : (right + kDropoutMaskBits - 1) /
+                                     kDropoutMaskBits};
+}
+
+void FuseResidual(Graph *graph, const ResidualNodes &nodes,
+                  bool has_backward) {
+  VarDesc mask_desc(nodes.z->Name() + "@DropoutMask");
+  mask_desc.SetShape(GetMaskShape(nodes));
+  mask_desc.SetDataType(proto::VarType::UINT8);
+  auto *mask = graph->CreateVarNode(&mask_desc);
+
+  OpDesc desc;
+  desc.SetType("fused_dropout_residual_layer_norm");
+  desc.SetInput("X", {nodes.x->Name()});
+  desc.SetInput("Residual", {nodes.residual->Name()});
+  if (nodes.scale) {
+    desc.SetInput("Scale", {nodes.scale->Name()});
+  }
+  if (nodes.bias) {
+    desc.SetInput("Bias", {nodes.bias->Name()});
+  }
+  desc.SetOutput("Y", {nodes.y->Name()});
+  desc.SetOutput("DropoutMask", {mask->Name()});
+  desc.SetOutput("DropoutResidualOut", {nodes.z->Name()});
+  desc.SetOutput("Mean", {nodes.mean->Name()});
+  desc.SetOutput("Variance", {nodes.variance->Name()});
+  SetResidualAttrs(nodes, &desc);
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               GetAttrOr<int>(nodes.layer_norm,
+                              OpProtoAndCheckerMaker::OpRoleAttrName(),
+                              static_cast<int>(OpRole::kForward)));
+  auto *fused = graph->CreateOpNode(&desc);
+  for (auto *in : {nodes.x, nodes.residual, nodes.scale, nodes.bias}) {
+    if (in) IR_NODE_LINK_TO(in, fused);
+  }
+  for (auto *out : {nodes.y, mask, nodes.z, nodes.mean, nodes.variance}) {
+    IR_NODE_LINK_TO(fused, out);
+  }
+
+  if (has_backward) {
+    OpDesc grad_desc;
+    grad_desc.SetType("fused_dropout_residual_layer_norm_grad");
+    grad_desc.SetInput("DropoutResidualOut", {nodes.z->Name()});
+    grad_desc.SetInput("DropoutMask", {mask->Name()});
+    grad_desc.SetInput("Mean", {nodes.mean->Name()});
+    grad_desc.SetInput("Variance", {nodes.variance->Name()});
+    if (nodes.scale) {
+      grad_desc.SetInput("Scale", {nodes.scale->Name()});
+    }
+    grad_desc.SetInput(GradVarName("Y"), {nodes.d_y->Name()});
+    if (nodes.d_x) {
+      grad_desc.SetOutput(GradVarName("X"), {nodes.d_x->Name()});
+    }
+    if (nodes.d_residual) {
+      grad_desc.SetOutput(GradVarName("Residual"), {nodes.d_residual->Name()});
+    }
+    if (nodes.d_scale) {
+      grad_desc.SetOutput(GradVarName("Scale"), {nodes.d_scale->Name()});
+    }
+    if (nodes.d_bias) {
+      grad_desc.SetOutput(GradVarName("Bias"), {nodes.d_bias->Name()});
+    }
+    SetResidualAttrs(nodes, &grad_desc);
+    grad_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                      static_cast<int>(OpRole::kBackward));
+    // Keep the parameters and the gradients of the replaced ops, which are
+    // used by the optimization and the distributed training.
+    std::vector<std::string> op_role_var;
+    for (auto *op : nodes.backward_ops) {
+      auto role_var = op->Op()->GetAttrIfExists<std::vector<std::string>>(
+          OpProtoAndCheckerMaker::OpRoleVarAttrName());
+      op_role_var.insert(op_role_var.end(), role_var.begin(), role_var.end());
+    }
+    if (!op_role_var.empty()) {
+      grad_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+                        op_role_var);
+    }
+    auto *fused_grad = graph->CreateOpNode(&grad_desc);
+    for (auto *in : {nodes.z, mask, nodes.mean, nodes.variance, nodes.scale,
+                     nodes.d_y}) {
+      if (in) IR_NODE_LINK_TO(in, fused_grad);
+    }
+    for (auto *out :
+         {nodes.d_x, nodes.d_residual, nodes.d_scale, nodes.d_bias}) {
+      if (out) IR_NODE_LINK_TO(fused_grad, out);
+    }
+  }
+
+  std::unordered_set<const Node *> removed_nodes;
+  removed_nodes.insert(nodes.forward_ops.begin(), nodes.forward_ops.end());
+  removed_nodes.insert(nodes.forward_vars.begin(), nodes.forward_vars.end());
+  removed_nodes.insert(nodes.backward_ops.begin(), nodes.backward_ops.end());
+  removed_nodes.insert(nodes.backward_vars.begin(), nodes.backward_vars.end());
+  GraphSafeRemoveNodes(graph, removed_nodes);
+}
+
+}  // namespace
+
+void FuseDropoutResidualLayerNormPass::ApplyImpl(ir::Graph *graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+
+  // Each residual block has one layer_norm, which is not removed by the
+  // fusion of the others.
+  auto &layer_norm_nodes = graph->OpNodesOfType("layer_norm");
+  std::vector<Node *> layer_norm_ops(layer_norm_nodes.begin(),
+                                     layer_norm_nodes.end());
+  int found_count = 0;
+  for (auto *layer_norm : layer_norm_ops) {
+    if (!IsOpOf(layer_norm, "layer_norm") || IsBackward(layer_norm)) continue;
+    ResidualNodes nodes;
+    bool has_backward = false;
+    if (!MatchForward(layer_norm, &nodes) ||
+        !MatchBackward(&nodes, &has_backward)) {
+      continue;
+    }
+    VLOG(4) << "fuse the residual of " << nodes.x->Name() << " and "
+            << nodes.residual->Name() << " -> " << nodes.y->Name()
+            << (has_backward ? " with backward" : "");
+    FuseResidual(graph, nodes, has_backward);
+    ++found_count;
+  }
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_dropout_residual_layer_norm_pass,
+              paddle::framework::ir::FuseDropoutResidualLayerNormPass);
@@ -0,0 +1,50 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the residual blocks of the transformer models
+ *
+ *   dropout(X) -> elementwise_add(Residual) -> layer_norm
+ *
+ * into fused_dropout_residual_layer_norm, and its backward,
+ *
+ *   layer_norm_grad -> elementwise_add_grad -> [dropout_grad]
+ *
+ * into fused_dropout_residual_layer_norm_grad, so that the output of the
+ * dropout is neither stored nor read by the training, and the mask is kept
+ * by bits. The forward alone is fused if the graph has no backward of it.
+ */
+class FuseDropoutResidualLayerNormPass : public FusePassBase {
+ public:
+  virtual ~FuseDropoutResidualLayerNormPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph *graph) const override;
+
+  const std::string name_scope_{"fuse_dropout_residual_layer_norm"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
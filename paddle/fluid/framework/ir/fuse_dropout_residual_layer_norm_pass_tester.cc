@@ -0,0 +1,230 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/fuse_dropout_residual_layer_norm_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+using VarNames = std::map<std::string, std::vector<std::string>>;
+
+// Builds the residual block of the transformer, and the gradient ops
+// generated by the backward of the program optionally.
+class ResidualProgram {
+ public:
+  explicit ResidualProgram(bool residual_first)
+      : residual_first_(residual_first) {
+    for (auto name : {"x", "residual", "dropped", "z", "y"}) {
+      Var(name, {4, 16, 60});
+    }
+    Var("mask", {4, 16, 60}, proto::VarType::UINT8);
+    Var("scale", {60});
+    Var("bias", {60});
+    Var("mean", {64});
+    Var("variance", {64});
+
+    auto role = static_cast<int>(OpRole::kForward);
+    Op("dropout", {{"X", {"x"}}}, {{"Out", {"dropped"}}, {"Mask", {"mask"}}},
+       {{"dropout_prob", 0.1f},
+        {"is_test", false},
+        {"fix_seed", true},
+        {"seed", 1},
+        {"dropout_implementation", std::string("upscale_in_train")}},
+       role);
+    Op("elementwise_add", {{"X", {AddX()}}, {"Y", {AddY()}}},
+       {{"Out", {"z"}}}, {{"axis", -1}}, role);
+    Op("layer_norm",
+       {{"X", {"z"}}, {"Scale", {"scale"}}, {"Bias", {"bias"}}},
+       {{"Y", {"y"}}, {"Mean", {"mean"}}, {"Variance", {"variance"}}},
+       {{"epsilon", 1e-5f}, {"begin_norm_axis", 2}}, role);
+  }
+
+  void Backward() {
+    for (auto name : {"x", "residual", "dropped", "z", "y", "scale", "bias"}) {
+      auto* var = program_.MutableBlock(0)->FindVar(name);
+      Var(GradVarName(name), var->GetShape());
+    }
+    auto role = static_cast<int>(OpRole::kBackward);
+    Op("layer_norm_grad",
+       {{"X", {"z"}},
+        {"Mean", {"mean"}},
+        {"Variance", {"variance"}},
+        {"Scale", {"scale"}},
+        {GradVarName("Y"), {GradVarName("y")}}},
+       {{GradVarName("X"), {GradVarName("z")}},
+        {GradVarName("Scale"), {GradVarName("scale")}},
+        {GradVarName("Bias"), {GradVarName("bias")}}},
+       {{"epsilon", 1e-5f}, {"begin_norm_axis", 2}}, role);
+    Op("elementwise_add_grad",
+       {{"X", {AddX()}},
+        {"Y", {AddY()}},
+        {GradVarName("Out"), {GradVarName("z")}}},
+       {{GradVarName("X"), {GradVarName(AddX())}},
+        {GradVarName("Y"), {GradVarName(AddY())}}},
+       {{"axis", -1}}, role);
+    Op("dropout_grad",
+       {{"Mask", {"mask"}}, {GradVarName("Out"), {GradVarName("dropped")}}},
+       {{GradVarName("X"), {GradVarName("x")}}},
+       {{"dropout_prob", 0.1f},
+        {"is_test", false},
+        {"dropout_implementation", std::string("upscale_in_train")}},
+       role);
+  }
+
+  // Another forward op reading the variable of the residual block.
+  void Read(const std::string& name) {
+    Var(name + "_copy", program_.MutableBlock(0)->FindVar(name)->GetShape());
+    Op("relu", {{"X", {name}}}, {{"Out", {name + "_copy"}}}, {},
+       static_cast<int>(OpRole::kForward));
+  }
+
+  const ProgramDesc& program() const { return program_; }
+
+ private:
+  std::string AddX() const { return residual_first_ ? "residual" : "dropped"; }
+  std::string AddY() const { return residual_first_ ? "dropped" : "residual"; }
+
+  void Var(const std::string& name, const std::vector<int64_t>& shape,
+           proto::VarType::Type dtype = proto::VarType::FP32) {
+    auto* var = program_.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(dtype);
+    var->SetShape(shape);
+  }
+
+  void Op(const std::string& type, const VarNames& inputs,
+          const VarNames& outputs, const AttributeMap& attrs, int role) {
+    auto* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType(type);
+    for (auto& input : inputs) {
+      op->SetInput(input.first, input.second);
+    }
+    for (auto& output : outputs) {
+      op->SetOutput(output.first, output.second);
+    }
+    for (auto& attr : attrs) {
+      op->SetAttr(attr.first, attr.second);
+    }
+    op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(), role);
+  }
+
+  bool residual_first_;
+  ProgramDesc program_;
+};
+
+std::unique_ptr<Graph> ApplyPass(const ProgramDesc& program) {
+  std::unique_ptr<Graph> graph(new Graph(program));
+  auto pass =
+      PassRegistry::Instance().Get("fuse_dropout_residual_layer_norm_pass");
+  VLOG(3) << DebugString(graph);
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+  return graph;
+}
+
+std::vector<OpDesc*> GetOps(const std::unique_ptr<Graph>& graph,
+                            const std::string& op_type) {
+  std::vector<OpDesc*> ops;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op()->Type() == op_type) {
+      ops.push_back(node->Op());
+    }
+  }
+  return ops;
+}
+
+Node* FindVarNode(const std::unique_ptr<Graph>& graph,
+                  const std::string& name) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+TEST(FuseDropoutResidualLayerNormPass, forward_and_backward) {
+  for (bool residual_first : {false, true}) {
+    ResidualProgram residual(residual_first);
+    residual.Backward();
+    auto graph = ApplyPass(residual.program());
+
+    // Only the fused ops are left.
+    ASSERT_EQ(TopologySortOperations(*graph).size(), 2UL);
+    auto fused = GetOps(graph, "fused_dropout_residual_layer_norm");
+    auto fused_grad = GetOps(graph, "fused_dropout_residual_layer_norm_grad");
+    ASSERT_EQ(fused.size(), 1UL);
+    ASSERT_EQ(fused_grad.size(), 1UL);
+
+    EXPECT_EQ(fused[0]->Input("X"), std::vector<std::string>({"x"}));
+    EXPECT_EQ(fused[0]->Input("Residual"),
+              std::vector<std::string>({"residual"}));
+    EXPECT_EQ(fused[0]->Output("Y"), std::vector<std::string>({"y"}));
+    EXPECT_EQ(fused[0]->Output("DropoutResidualOut"),
+              std::vector<std::string>({"z"}));
+    EXPECT_FLOAT_EQ(boost::get<float>(fused[0]->GetAttr("dropout_prob")),
+                    0.1f);
+    EXPECT_EQ(boost::get<int>(fused[0]->GetAttr("begin_norm_axis")), 2);
+
+    // The mask keeps a bit for each element.
+    auto* mask = FindVarNode(graph, fused[0]->Output("DropoutMask")[0]);
+    ASSERT_NE(mask, nullptr);
+    EXPECT_EQ(mask->Var()->GetDataType(), proto::VarType::UINT8);
+    EXPECT_EQ(mask->Var()->GetShape(), std::vector<int64_t>({64, 8}));
+    EXPECT_EQ(FindVarNode(graph, "dropped"), nullptr);
+
+    EXPECT_EQ(fused_grad[0]->Input("DropoutMask"),
+              fused[0]->Output("DropoutMask"));
+    EXPECT_EQ(fused_grad[0]->Input("DropoutResidualOut"),
+              std::vector<std::string>({"z"}));
+    EXPECT_EQ(fused_grad[0]->Output(GradVarName("X")),
+              std::vector<std::string>({GradVarName("x")}));
+    EXPECT_EQ(fused_grad[0]->Output(GradVarName("Residual")),
+              std::vector<std::string>({GradVarName("residual")}));
+    EXPECT_EQ(fused_grad[0]->Output(GradVarName("Scale")),
+              std::vector<std::string>({GradVarName("scale")}));
+    EXPECT_EQ(fused_grad[0]->Output(GradVarName("Bias")),
+              std::vector<std::string>({GradVarName("bias")}));
+    EXPECT_EQ(boost::get<int>(fused_grad[0]->GetAttr(
+                  OpProtoAndCheckerMaker::OpRoleAttrName())),
+              static_cast<int>(OpRole::kBackward));
+  }
+}
+
+TEST(FuseDropoutResidualLayerNormPass, forward_only) {
+  ResidualProgram residual(false);
+  auto graph = ApplyPass(residual.program());
+
+  ASSERT_EQ(TopologySortOperations(*graph).size(), 1UL);
+  EXPECT_EQ(GetOps(graph, "fused_dropout_residual_layer_norm").size(), 1UL);
+}
+
+TEST(FuseDropoutResidualLayerNormPass, dropout_used_by_others) {
+  // The output of the dropout is read by another op.
+  ResidualProgram residual(false);
+  residual.Read("dropped");
+  residual.Backward();
+  auto graph = ApplyPass(residual.program());
+  EXPECT_EQ(GetOps(graph, "fused_dropout_residual_layer_norm").size(), 0UL);
+  EXPECT_EQ(GetOps(graph, "layer_norm_grad").size(), 1UL);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_dropout_residual_layer_norm_pass);
@@ -0,0 +1,163 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_fake_quant_dequant_pass.h"
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+struct QuantDequantType {
+  const char *quant;
+  const char *dequant;
+  const char *fused;
+};
+
+constexpr QuantDequantType kQuantDequantTypes[] = {
+    {"fake_quantize_abs_max", "fake_dequantize_max_abs",
+     "fake_quantize_dequantize_abs_max"},
+    {"fake_quantize_moving_average_abs_max", "fake_dequantize_max_abs",
+     "fake_quantize_dequantize_moving_average_abs_max"},
+    {"fake_channel_wise_quantize_abs_max",
+     "fake_channel_wise_dequantize_max_abs",
+     "fake_channel_wise_quantize_dequantize_abs_max"},
+};
+
+bool IsOpOf(Node *node, const std::string &type) {
+  return node && node->IsOp() && node->Op() && node->Op()->Type() == type;
+}
+
+// The variable node of the only argument, or nullptr.
+Node *GetVar(Node *op, const std::string &argument, bool is_input) {
+  auto &arguments = is_input ? op->Op()->Inputs() : op->Op()->Outputs();
+  auto it = arguments.find(argument);
+  if (it == arguments.end() || it->second.size() != 1) {
+    return nullptr;
+  }
+  for (auto *var : is_input ? op->inputs : op->outputs) {
+    if (var->IsVar() && var->Name() == it->second[0]) {
+      return var;
+    }
+  }
+  return nullptr;
+}
+
+// The control dependencies are not moved to the fused op.
+bool HasCtrlVar(Node *op) {
+  for (auto *var : op->inputs) {
+    if (var->IsCtrlVar()) return true;
+  }
+  for (auto *var : op->outputs) {
+    if (var->IsCtrlVar()) return true;
+  }
+  return false;
+}
+
+// Whether dequant undoes the quantization of quant with the same scale and
+// the same bits.
+bool IsDequantOf(Node *dequant, Node *quant, const QuantDequantType &type) {
+  auto *quant_op = quant->Op();
+  auto *dequant_op = dequant->Op();
+  int bit_length = quant_op->HasAttr("bit_length")
+                       ? quant_op->GetAttrIfExists<int>("bit_length")
+                       : 8;
+  if (bit_length < 2 || bit_length > 16) return false;
+  auto *scale = GetVar(quant, "OutScale", false);
+  if (!scale) return false;
+
+  if (std::string(type.dequant) == "fake_dequantize_max_abs") {
+    float max_range = dequant_op->GetAttrIfExists<float>("max_range");
+    return GetVar(dequant, "Scale", true) == scale &&
+           max_range == static_cast<float>((1 << (bit_length - 1)) - 1);
+  }
+  // The channel wise dequantization of the activations of the quantized
+  // convolutions reads a second scale, which is not fused.
+  auto quant_bits =
+      dequant_op->GetAttrIfExists<std::vector<int>>("quant_bits");
+  return GetVar(dequant, "Scales", true) == scale &&
+         (quant_bits.empty() || quant_bits[0] == bit_length);
+}
+
+// Returns the dequant op matched with quant, and its quantized input.
+Node *MatchDequant(Node *quant, const QuantDequantType &type, Node **out) {
+  *out = GetVar(quant, "Out", false);
+  auto *x = GetVar(quant, "X", true);
+  if (!x || !*out || !(*out)->Var() || (*out)->Var()->Persistable() ||
+      (*out)->inputs.size() != 1 || (*out)->outputs.size() != 1) {
+    return nullptr;
+  }
+  auto *dequant = (*out)->outputs[0];
+  if (!IsOpOf(dequant, type.dequant) || GetVar(dequant, "X", true) != *out ||
+      !GetVar(dequant, "Out", false) || HasCtrlVar(quant) ||
+      HasCtrlVar(dequant) || !IsDequantOf(dequant, quant, type)) {
+    return nullptr;
+  }
+  return dequant;
+}
+
+void FuseQuantDequant(Graph *graph, const QuantDequantType &type, Node *quant,
+                      Node *quant_out, Node *dequant) {
+  auto *dequant_out = GetVar(dequant, "Out", false);
+  // The fused op keeps the inputs, the scales and the states of quant.
+  OpDesc desc(*quant->Op(), nullptr);
+  desc.SetType(type.fused);
+  desc.SetOutput("Out", {dequant_out->Name()});
+  desc.Flush();
+  auto *fused = graph->CreateOpNode(&desc);
+  for (auto *in : quant->inputs) {
+    IR_NODE_LINK_TO(in, fused);
+  }
+  for (auto *out : quant->outputs) {
+    if (out != quant_out) IR_NODE_LINK_TO(fused, out);
+  }
+  IR_NODE_LINK_TO(fused, dequant_out);
+  GraphSafeRemoveNodes(graph, {quant, quant_out, dequant});
+}
+
+}  // namespace
+
+void FuseFakeQuantDequantPass::ApplyImpl(ir::Graph *graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+
+  int found_count = 0;
+  for (auto &type : kQuantDequantTypes) {
+    auto &quant_nodes = graph->OpNodesOfType(type.quant);
+    std::vector<Node *> quant_ops(quant_nodes.begin(), quant_nodes.end());
+    for (auto *quant : quant_ops) {
+      Node *quant_out = nullptr;
+      auto *dequant = MatchDequant(quant, type, &quant_out);
+      if (!dequant) continue;
+      VLOG(4) << "fuse " << type.quant << " and " << type.dequant << " of "
+              << quant_out->Name();
+      FuseQuantDequant(graph, type, quant, quant_out, dequant);
+      ++found_count;
+    }
+  }
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_fake_quant_dequant_pass,
+              paddle::framework::ir::FuseFakeQuantDequantPass);
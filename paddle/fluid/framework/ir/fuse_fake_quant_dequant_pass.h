@@ -0,0 +1,50 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the fake quantization ops of the quantization aware training and the
+ * fake dequantization ops reading their outputs,
+ *
+ *   fake_quantize_abs_max -> fake_dequantize_max_abs
+ *   fake_quantize_moving_average_abs_max -> fake_dequantize_max_abs
+ *   fake_channel_wise_quantize_abs_max -> fake_channel_wise_dequantize_max_abs
+ *
+ * into fake_quantize_dequantize_abs_max,
+ * fake_quantize_dequantize_moving_average_abs_max and
+ * fake_channel_wise_quantize_dequantize_abs_max respectively, so that the
+ * quantized tensor is neither stored nor read again.
+ */
+class FuseFakeQuantDequantPass : public FusePassBase {
+ public:
+  virtual ~FuseFakeQuantDequantPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph *graph) const override;
+
+  const std::string name_scope_{"fuse_fake_quant_dequant"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
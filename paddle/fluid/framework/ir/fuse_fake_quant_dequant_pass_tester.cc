@@ -0,0 +1,204 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/fuse_fake_quant_dequant_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+using VarNames = std::map<std::string, std::vector<std::string>>;
+
+class QuantProgram {
+ public:
+  QuantProgram() {
+    for (auto name : {"x", "quantized", "dequantized", "y", "w"}) {
+      Var(name, {8, 16});
+    }
+    for (auto name : {"scale", "in_scale", "accum", "state"}) {
+      Var(name, {1});
+    }
+  }
+
+  void AbsMax(int bit_length, float max_range) {
+    Op("fake_quantize_abs_max", {{"X", {"x"}}},
+       {{"Out", {"quantized"}}, {"OutScale", {"scale"}}},
+       {{"bit_length", bit_length}});
+    Dequant(max_range);
+  }
+
+  void MovingAverageAbsMax() {
+    Op("fake_quantize_moving_average_abs_max",
+       {{"X", {"x"}},
+        {"InScale", {"in_scale"}},
+        {"InAccum", {"accum"}},
+        {"InState", {"state"}}},
+       {{"Out", {"quantized"}},
+        {"OutScale", {"scale"}},
+        {"OutAccum", {"accum"}},
+        {"OutState", {"state"}}},
+       {{"bit_length", 8}, {"moving_rate", 0.9f}, {"is_test", false}});
+    Dequant(127.f);
+  }
+
+  void ChannelWiseAbsMax() {
+    Var("channel_scale", {8});
+    Op("fake_channel_wise_quantize_abs_max", {{"X", {"x"}}},
+       {{"Out", {"quantized"}}, {"OutScale", {"channel_scale"}}},
+       {{"bit_length", 8}});
+    Op("fake_channel_wise_dequantize_max_abs",
+       {{"X", {"quantized"}}, {"Scales", {"channel_scale"}}},
+       {{"Out", {"dequantized"}}}, {{"quant_bits", std::vector<int>({8})}});
+  }
+
+  // The consumer of the dequantized tensor.
+  void Mul() {
+    Op("mul", {{"X", {"dequantized"}}, {"Y", {"w"}}}, {{"Out", {"y"}}}, {});
+  }
+
+  void Read(const std::string& name) {
+    Var(name + "_copy", {8, 16});
+    Op("relu", {{"X", {name}}}, {{"Out", {name + "_copy"}}}, {});
+  }
+
+  const ProgramDesc& program() const { return program_; }
+
+ private:
+  void Dequant(float max_range) {
+    Op("fake_dequantize_max_abs", {{"X", {"quantized"}}, {"Scale", {"scale"}}},
+       {{"Out", {"dequantized"}}}, {{"max_range", max_range}});
+  }
+
+  void Var(const std::string& name, const std::vector<int64_t>& shape) {
+    auto* var = program_.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape(shape);
+  }
+
+  void Op(const std::string& type, const VarNames& inputs,
+          const VarNames& outputs, const AttributeMap& attrs) {
+    auto* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType(type);
+    for (auto& input : inputs) {
+      op->SetInput(input.first, input.second);
+    }
+    for (auto& output : outputs) {
+      op->SetOutput(output.first, output.second);
+    }
+    for (auto& attr : attrs) {
+      op->SetAttr(attr.first, attr.second);
+    }
+  }
+
+  ProgramDesc program_;
+};
+
+std::unique_ptr<Graph> ApplyPass(const ProgramDesc& program) {
+  std::unique_ptr<Graph> graph(new Graph(program));
+  auto pass = PassRegistry::Instance().Get("fuse_fake_quant_dequant_pass");
+  VLOG(3) << DebugString(graph);
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+  return graph;
+}
+
+std::vector<OpDesc*> GetOps(const std::unique_ptr<Graph>& graph,
+                            const std::string& op_type) {
+  std::vector<OpDesc*> ops;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op()->Type() == op_type) {
+      ops.push_back(node->Op());
+    }
+  }
+  return ops;
+}
+
+TEST(FuseFakeQuantDequantPass, abs_max) {
+  QuantProgram program;
+  program.AbsMax(8, 127.f);
+  program.Mul();
+  auto graph = ApplyPass(program.program());
+
+  ASSERT_EQ(TopologySortOperations(*graph).size(), 2UL);
+  auto fused = GetOps(graph, "fake_quantize_dequantize_abs_max");
+  ASSERT_EQ(fused.size(), 1UL);
+  EXPECT_EQ(fused[0]->Input("X"), std::vector<std::string>({"x"}));
+  EXPECT_EQ(fused[0]->Output("Out"), std::vector<std::string>({"dequantized"}));
+  EXPECT_EQ(fused[0]->Output("OutScale"), std::vector<std::string>({"scale"}));
+  EXPECT_EQ(boost::get<int>(fused[0]->GetAttr("bit_length")), 8);
+  EXPECT_EQ(GetOps(graph, "mul")[0]->Input("X"),
+            std::vector<std::string>({"dequantized"}));
+}
+
+TEST(FuseFakeQuantDequantPass, moving_average_abs_max) {
+  QuantProgram program;
+  program.MovingAverageAbsMax();
+  program.Mul();
+  auto graph = ApplyPass(program.program());
+
+  ASSERT_EQ(TopologySortOperations(*graph).size(), 2UL);
+  auto fused = GetOps(graph, "fake_quantize_dequantize_moving_average_abs_max");
+  ASSERT_EQ(fused.size(), 1UL);
+  EXPECT_EQ(fused[0]->Input("InScale"),
+            std::vector<std::string>({"in_scale"}));
+  EXPECT_EQ(fused[0]->Output("Out"), std::vector<std::string>({"dequantized"}));
+  EXPECT_EQ(fused[0]->Output("OutAccum"), std::vector<std::string>({"accum"}));
+  EXPECT_EQ(fused[0]->Output("OutState"), std::vector<std::string>({"state"}));
+  EXPECT_FLOAT_EQ(boost::get<float>(fused[0]->GetAttr("moving_rate")), 0.9f);
+}
+
+TEST(FuseFakeQuantDequantPass, channel_wise_abs_max) {
+  QuantProgram program;
+  program.ChannelWiseAbsMax();
+  program.Mul();
+  auto graph = ApplyPass(program.program());
+
+  ASSERT_EQ(TopologySortOperations(*graph).size(), 2UL);
+  auto fused = GetOps(graph, "fake_channel_wise_quantize_dequantize_abs_max");
+  ASSERT_EQ(fused.size(), 1UL);
+  EXPECT_EQ(fused[0]->Output("Out"), std::vector<std::string>({"dequantized"}));
+  EXPECT_EQ(fused[0]->Output("OutScale"),
+            std::vector<std::string>({"channel_scale"}));
+}
+
+TEST(FuseFakeQuantDequantPass, mismatched_range) {
+  // The dequantization of 8 bits does not undo the quantization of 4 bits.
+  QuantProgram program;
+  program.AbsMax(4, 127.f);
+  program.Mul();
+  auto graph = ApplyPass(program.program());
+  EXPECT_EQ(GetOps(graph, "fake_quantize_dequantize_abs_max").size(), 0UL);
+  EXPECT_EQ(GetOps(graph, "fake_dequantize_max_abs").size(), 1UL);
+}
+
+TEST(FuseFakeQuantDequantPass, quantized_used_by_others) {
+  QuantProgram program;
+  program.AbsMax(8, 127.f);
+  program.Read("quantized");
+  program.Mul();
+  auto graph = ApplyPass(program.program());
+  EXPECT_EQ(GetOps(graph, "fake_quantize_dequantize_abs_max").size(), 0UL);
+  EXPECT_EQ(GetOps(graph, "fake_quantize_abs_max").size(), 1UL);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_fake_quant_dequant_pass);
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <sstream>
 #include <unordered_set>
 #include "paddle/fluid/framework/ir/fusion_group/code_generator_helper.h"
+#include "paddle/fluid/framework/ir/fusion_group/cpu_resources.h"
 #include "paddle/fluid/framework/ir/fusion_group/cuda_resources.h"
 #include "paddle/fluid/framework/ir/fusion_group/operation.h"
 
@@ -45,17 +46,31 @@ std::string ExtractDataType(const std::vector<Node*>& nodes) {
   return dtype_str;
 }
 
-CodeGenerator::CodeGenerator() {
-  // Only support elementwise operations now.
-  code_templates_.resize(1);
+CodeGenerator::CodeGenerator(bool use_gpu) : use_gpu_(use_gpu) {
+  // Support elementwise operations, and the ones followed by a reduction.
+  code_templates_.resize(2);
 
-  CodeTemplate elementwise_t(cuda_kernel_template_1d);
-  code_templates_[0] = elementwise_t;
+  if (use_gpu_) {
+    CodeTemplate elementwise_t(cuda_kernel_template_1d);
+    code_templates_[0] = elementwise_t;
+
+    CodeTemplate reduction_t(cuda_kernel_template_reduction);
+    code_templates_[1] = reduction_t;
+  } else {
+    CodeTemplate elementwise_t(cpu_kernel_template_1d);
+    code_templates_[0] = elementwise_t;
+  }
 }
 
 std::string CodeGenerator::Generate(SubGraph* subgraph) {
   std::vector<OperationExpression> expressions = ConvertToExpressions(subgraph);
-  return Generate(subgraph->GetFuncName(), expressions);
+  std::unordered_map<int, int64_t> broadcast_sizes =
+      DistilBroadcastSizes(subgraph);
+  if (subgraph->GetType() == 1) {
+    return GenerateReduction(subgraph->GetFuncName(), expressions,
+                             DistilReduceSize(subgraph), broadcast_sizes);
+  }
+  return Generate(subgraph->GetFuncName(), expressions, broadcast_sizes);
 }
 
 static bool HasInput(Node* n, std::string name) {
@@ -128,19 +143,113 @@ std::vector<OperationExpression> CodeGenerator::ConvertToExpressions(
 // In order to get the right result of expression, we need to calculate and
 // store the expression as suffix Expressions using vector.
 std::string CodeGenerator::Generate(
-    std::string func_name,
-    const std::vector<OperationExpression>& expressions) {
+    std::string func_name, const std::vector<OperationExpression>& expressions,
+    const std::unordered_map<int, int64_t>& broadcast_sizes,
+    const std::unordered_set<int>& intermediate_ids) {
   // TODO(liuyiqun): Check whether all expressions are elementwise operations.
   std::set<int> input_ids = std::move(DistilInputIds(expressions));
   std::set<int> output_ids = std::move(DistilOutputIds(expressions));
+  for (auto id : intermediate_ids) {
+    input_ids.erase(id);
+    output_ids.erase(id);
+  }
   std::unordered_map<int, std::string> dtypes =
       std::move(DistilDtypes(expressions));
   TemplateVariable template_var;
   template_var.Add("func_name", func_name);
   template_var.Add("parameters", EmitParameters(input_ids, output_ids, dtypes));
   template_var.Add("compute_body",
-                   EmitComputeBody(expressions, input_ids, output_ids, dtypes));
+                   EmitComputeBody(expressions, input_ids, output_ids, dtypes,
+                                   broadcast_sizes));
+  return EmitPredefinedFunctions(dtypes) +
+         code_templates_[0].Format(template_var);
+}
+
+static void ReplaceAll(std::string* str, const std::string& from,
+                       const std::string& to) {
+  for (size_t pos = str->find(from); pos != std::string::npos;
+       pos = str->find(from, pos + to.size())) {
+    str->replace(pos, from.size(), to);
+  }
+}
+
+// Each block reduces a row of reduce_size elements at a time. The threads of
+// the block compute the elementwise operations for the elements of the row,
+// accumulate them, and then sum up the partial sums in the shared memory.
+std::string CodeGenerator::GenerateReduction(
+    std::string func_name, const std::vector<OperationExpression>& expressions,
+    int64_t reduce_size,
+    const std::unordered_map<int, int64_t>& broadcast_sizes) {
+  PADDLE_ENFORCE_EQ(use_gpu_, true,
+                    platform::errors::Unimplemented(
+                        "The reduction is only supported on GPU."));
+  PADDLE_ENFORCE_GT(
+      expressions.size(), 1U,
+      platform::errors::InvalidArgument(
+          "Expected a reduction following some elementwise operations."));
+  const OperationExpression& reduction = expressions.back();
+  const Operation& operation =
+      OperationMap::Instance().Get(reduction.GetOpType());
+  PADDLE_ENFORCE_EQ(operation.type, 1,
+                    platform::errors::InvalidArgument(
+                        "Expected the last operation to be a reduction, but "
+                        "received %s.",
+                        reduction.GetOpType()));
+  std::vector<OperationExpression> elementwise_expressions(
+      expressions.begin(), expressions.end() - 1);
+
+  std::set<int> input_ids = std::move(DistilInputIds(expressions));
+  std::set<int> output_ids = std::move(DistilOutputIds(expressions));
+  std::unordered_map<int, std::string> dtypes =
+      std::move(DistilDtypes(expressions));
+
+  int operand_id = reduction.GetInputIds()[0];
+  int out_id = reduction.GetOutputIds()[0];
+  std::set<int> elementwise_output_ids = output_ids;
+  elementwise_output_ids.erase(out_id);
+  PADDLE_ENFORCE_NE(
+      elementwise_output_ids.find(operand_id), elementwise_output_ids.end(),
+      platform::errors::InvalidArgument(
+          "The input of %s should be computed by the elementwise operations.",
+          reduction.GetOpType()));
+
+  // Sum up float16 in float.
+  std::string acc_type = dtypes.at(operand_id) == "double" ? "double" : "float";
+  std::string operand = TmpName(operand_id);
+  if (dtypes.at(operand_id) == "float16") {
+    operand = "__half2float(" + operand + ")";
+  }
+
+  std::string result = operation.exprs[0];
+  ReplaceAll(&result, "${0}", "shm[0]");
+  ReplaceAll(&result, "${1}", std::to_string(reduce_size));
+  std::string cast_str = dtypes.at(out_id) == "float16"
+                             ? "__float2half"
+                             : "static_cast<" + dtypes.at(out_id) + ">";
+  std::string store =
+      ArgName(out_id) + "[row] = " + cast_str + "(" + result + ");";
+
+  TemplateVariable template_var;
+  template_var.Add("func_name", func_name);
+  template_var.Add("parameters", EmitParameters(input_ids, output_ids, dtypes));
+  template_var.Add("acc_type", acc_type);
+  template_var.Add("reduce_size", std::to_string(reduce_size));
+  template_var.Add(
+      "compute_body",
+      EmitComputeBody(elementwise_expressions, input_ids,
+                      elementwise_output_ids, dtypes, broadcast_sizes));
+  template_var.Add("reduce_operand", operand);
+  template_var.Add("reduce_store", store);
+  return EmitPredefinedFunctions(dtypes) +
+         code_templates_[1].Format(template_var);
+}
 
+std::string CodeGenerator::EmitPredefinedFunctions(
+    const std::unordered_map<int, std::string>& dtypes) const {
+  // Exp, Log, Sqrt and Max are parsed by platform::CPUDeviceCode directly.
+  if (!use_gpu_) {
+    return "";
+  }
   std::set<std::string> all_dtype;
   for (const auto& type : dtypes) {
     all_dtype.insert(type.second);
@@ -156,7 +265,7 @@ std::string CodeGenerator::Generate(
   if (all_dtype.find("float16") != all_dtype.end()) {
     predefined_cuda_functions += predefined_cuda_functions_fp16;
   }
-  return predefined_cuda_functions + code_templates_[0].Format(template_var);
+  return predefined_cuda_functions;
 }
 
 std::set<int> CodeGenerator::DistilInputIds(
@@ -215,6 +324,66 @@ std::unordered_map<int, std::string> CodeGenerator::DistilDtypes(
   return dtypes;
 }
 
+static int64_t GetNumel(const std::vector<int64_t>& shape) {
+  int64_t numel = 1;
+  for (auto dim : shape) {
+    numel *= dim;
+  }
+  return numel;
+}
+
+std::unordered_map<int, int64_t> CodeGenerator::DistilBroadcastSizes(
+    SubGraph* subgraph) {
+  std::unordered_map<std::string, int> var_ids = EncodeVarNodes(subgraph);
+  std::unordered_map<int, int64_t> broadcast_sizes;
+  for (auto* node : subgraph->SortedNodes()) {
+    if (!(node && node->IsOp() && node->Op())) {
+      continue;
+    }
+    auto* op = node->Op();
+    const auto& operation = OperationMap::Instance().Get(op->Type());
+    if (operation.type != 0 || operation.num_operands != 2 ||
+        op->Input("X").size() != 1U || op->Input("Y").size() != 1U) {
+      continue;
+    }
+    // The second input of a binary operation with a different shape is
+    // broadcast to the first one, which is checked when detecting the
+    // subgraph.
+    std::vector<int64_t> x_shape, y_shape;
+    for (auto* in : node->inputs) {
+      if (in && in->IsVar() && in->Var()) {
+        if (in->Name() == op->Input("X")[0]) {
+          x_shape = in->Var()->GetShape();
+        } else if (in->Name() == op->Input("Y")[0]) {
+          y_shape = in->Var()->GetShape();
+        }
+      }
+    }
+    if (x_shape != y_shape) {
+      broadcast_sizes[var_ids[op->Input("Y")[0]]] = GetNumel(y_shape);
+    }
+  }
+  return broadcast_sizes;
+}
+
+int64_t CodeGenerator::DistilReduceSize(SubGraph* subgraph) {
+  for (auto* node : subgraph->SortedNodes()) {
+    if (node && node->IsOp() && node->Op() &&
+        OperationMap::Instance().Get(node->Op()->Type()).type == 1) {
+      // The reduction is along the trailing dims, which is checked when
+      // detecting the subgraph.
+      auto* in = node->inputs[0];
+      std::vector<int64_t> shape = in->Var()->GetShape();
+      size_t num_dims =
+          boost::get<std::vector<int>>(node->Op()->GetAttr("dim")).size();
+      return GetNumel(std::vector<int64_t>(shape.end() - num_dims,
+                                           shape.end()));
+    }
+  }
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "There is no reduction in the subgraph %s.", subgraph->GetFuncName()));
+}
+
 // we get the parameter list code for the expression information
 std::string CodeGenerator::EmitParameters(
     const std::set<int>& input_ids, const std::set<int>& output_ids,
@@ -245,7 +414,8 @@ std::string CodeGenerator::EmitParameters(
 std::string CodeGenerator::EmitComputeBody(
     const std::vector<OperationExpression>& expressions,
     const std::set<int>& input_ids, const std::set<int>& output_ids,
-    const std::unordered_map<int, std::string>& dtypes) const {
+    const std::unordered_map<int, std::string>& dtypes,
+    const std::unordered_map<int, int64_t>& broadcast_sizes) const {
   std::ostringstream compute;
   std::unordered_set<int> used;
   for (size_t i = 0; i < expressions.size(); i++) {
@@ -258,8 +428,12 @@ std::string CodeGenerator::EmitComputeBody(
   for (auto id : input_ids) {
     if (output_ids.find(id) == output_ids.end() &&
         used.find(id) != used.end()) {
-      load << dtypes.at(id) << " " << TmpName(id) << " = " << VarName(id)
-           << ";";
+      auto iter = broadcast_sizes.find(id);
+      std::string var_name =
+          iter == broadcast_sizes.end()
+              ? VarName(id)
+              : ArgName(id) + "[idx % " + std::to_string(iter->second) + "]";
+      load << dtypes.at(id) << " " << TmpName(id) << " = " << var_name << ";";
     }
   }
   // Store temporal variables to memory.
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/ir/fusion_group/code_generator_helper.h"
@@ -29,10 +30,26 @@ namespace fusion_group {
 
 class CodeGenerator {
  public:
-  CodeGenerator();
+  // Generate the CUDA kernels if use_gpu, or the ones run by
+  // platform::CPUDeviceCode, which only support the elementwise operations.
+  explicit CodeGenerator(bool use_gpu = true);
+
+  // broadcast_sizes holds the number of elements of the inputs broadcast
+  // along the trailing dims, which are indexed by the remainder. The outputs
+  // in intermediate_ids are only kept in the temporary variables, and are
+  // not the parameters of the kernel.
+  std::string Generate(
+      std::string func_name,
+      const std::vector<OperationExpression>& expressions,
+      const std::unordered_map<int, int64_t>& broadcast_sizes = {},
+      const std::unordered_set<int>& intermediate_ids = {});
 
-  std::string Generate(std::string func_name,
-                       const std::vector<OperationExpression>& expressions);
+  // The last expression is the reduction of the output of the others along
+  // the trailing dims with reduce_size elements.
+  std::string GenerateReduction(
+      std::string func_name,
+      const std::vector<OperationExpression>& expressions, int64_t reduce_size,
+      const std::unordered_map<int, int64_t>& broadcast_sizes = {});
 
   std::string Generate(SubGraph* subgraph);
 
@@ -45,6 +62,8 @@ class CodeGenerator {
       const std::vector<OperationExpression>& expressions);
   std::unordered_map<int, std::string> DistilDtypes(
       const std::vector<OperationExpression>& expressions);
+  std::unordered_map<int, int64_t> DistilBroadcastSizes(SubGraph* subgraph);
+  int64_t DistilReduceSize(SubGraph* subgraph);
 
   // we get the parameter list code for the expression information
   std::string EmitParameters(
@@ -54,12 +73,17 @@ class CodeGenerator {
   std::string EmitComputeBody(
       const std::vector<OperationExpression>& expressions,
       const std::set<int>& input_ids, const std::set<int>& output_ids,
+      const std::unordered_map<int, std::string>& dtypes,
+      const std::unordered_map<int, int64_t>& broadcast_sizes) const;
+
+  std::string EmitPredefinedFunctions(
       const std::unordered_map<int, std::string>& dtypes) const;
 
   // Encode all var nodes in the subgraph with an unique number.
   std::unordered_map<std::string, int> EncodeVarNodes(SubGraph* subgraph);
 
  private:
+  bool use_gpu_;
   std::vector<CodeTemplate> code_templates_;
 };
 
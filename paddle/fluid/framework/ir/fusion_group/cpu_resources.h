@@ -0,0 +1,37 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+namespace paddle {
+namespace framework {
+namespace ir {
+namespace fusion_group {
+
+// The kernel run by platform::CPUDeviceCode, which supports the statements
+// emitted for the elementwise operations in the loop body.
+static constexpr char cpu_kernel_template_1d[] = R"(
+extern "C" void $func_name($parameters) {
+  for(int idx = 0;
+      idx < N;
+      idx++) {
+    $compute_body
+  }
+}
+)";
+
+}  // namespace fusion_group
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -82,6 +82,39 @@ extern "C" __global__ void $func_name($parameters) {
 }
 )";
 
+static constexpr char cuda_kernel_template_reduction[] = R"(
+extern "C" __global__ void $func_name($parameters) {
+  __shared__ $acc_type shm[1024];
+  for(int row = blockIdx.x;
+      row < N / $reduce_size;
+      row += gridDim.x) {
+    $acc_type sum = 0;
+    for(int col = threadIdx.x;
+        col < $reduce_size;
+        col += blockDim.x) {
+      int idx = row * $reduce_size + col;
+      $compute_body
+      sum += $reduce_operand;
+    }
+    shm[threadIdx.x] = sum;
+    __syncthreads();
+    for(int stride = 1;
+        stride < blockDim.x;
+        stride *= 2) {
+      if (threadIdx.x % (2 * stride) == 0 &&
+          threadIdx.x + stride < blockDim.x) {
+        shm[threadIdx.x] += shm[threadIdx.x + stride];
+      }
+      __syncthreads();
+    }
+    if (threadIdx.x == 0) {
+      $reduce_store
+    }
+    __syncthreads();
+  }
+}
+)";
+
 }  // namespace fusion_group
 }  // namespace ir
 }  // namespace framework
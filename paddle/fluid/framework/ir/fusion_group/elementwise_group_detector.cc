@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/ir/fusion_group/elementwise_group_detector.h"
+#include <algorithm>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -33,6 +34,15 @@ static std::unordered_set<std::string>& GetElementwiseOpTypes() {
   return elementwise_op_types;
 }
 
+static std::unordered_set<std::string> reduction_op_types;
+
+static std::unordered_set<std::string>& GetReductionOpTypes() {
+  if (reduction_op_types.empty()) {
+    reduction_op_types = OperationMap::Instance().Find(/* type= */ 1);
+  }
+  return reduction_op_types;
+}
+
 static bool IsSpecifiedOp(const std::unordered_set<std::string>& op_types,
                           const Node* n) {
   if (n && n->IsOp() && n->Op() && n->outputs.size() > 0U) {
@@ -60,6 +70,54 @@ static bool IsEqualAndNotEmpty(const std::vector<int64_t>& l,
   return l.size() != 0U && r.size() != 0U && l == r;
 }
 
+static Node* GetInputVar(const Node* n, const std::string& name) {
+  if (n->Op()->Input(name).size() != 1U) {
+    return nullptr;
+  }
+  for (auto* in : n->inputs) {
+    if (in && in->IsVar() && in->Var() &&
+        in->Name() == n->Op()->Input(name)[0]) {
+      return in;
+    }
+  }
+  return nullptr;
+}
+
+// Whether Y of the binary operation n is broadcast to X along the trailing
+// dims. Y should have a known shape and not be computed by any operation,
+// such as a parameter, so that it is always an input of the subgraph and
+// indexed by the remainder in the generated code.
+static bool IsBroadcastBinaryOp(const Node* n) {
+  if (IsGradOp(n) ||
+      OperationMap::Instance().Get(n->Op()->Type()).num_operands != 2) {
+    return false;
+  }
+  Node* x = GetInputVar(n, "X");
+  Node* y = GetInputVar(n, "Y");
+  if (x == nullptr || y == nullptr || y->inputs.size() != 0U) {
+    return false;
+  }
+
+  std::vector<int64_t> x_shape = x->Var()->GetShape();
+  std::vector<int64_t> y_shape = y->Var()->GetShape();
+  if (y_shape.size() == 0U || y_shape.size() >= x_shape.size()) {
+    return false;
+  }
+  size_t offset = x_shape.size() - y_shape.size();
+  int axis = n->Op()->HasAttr("axis")
+                 ? boost::get<int>(n->Op()->GetAttr("axis"))
+                 : -1;
+  if (axis != -1 && axis != static_cast<int>(offset)) {
+    return false;
+  }
+  for (size_t i = 0; i < y_shape.size(); ++i) {
+    if (y_shape[i] <= 0 || y_shape[i] != x_shape[offset + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool GroupDetector::CheckPrecondition(const Node* n) {
   auto check_data_type = [&](const std::vector<Node*>& nodes) -> bool {
     bool is_first = true;
@@ -92,7 +150,7 @@ bool GroupDetector::CheckPrecondition(const Node* n) {
          check_data_type(n->outputs);
 }
 
-bool ElementwiseGroupDetector::IsElementwiseOp(const Node* n) {
+bool GroupDetector::IsElementwiseOp(const Node* n) {
   if (IsSpecifiedOp(GetElementwiseOpTypes(), n)) {
     // Check whether all inputs have the same shape.
     std::vector<int64_t> shape_0;
@@ -107,7 +165,7 @@ bool ElementwiseGroupDetector::IsElementwiseOp(const Node* n) {
         shape_0 = shape_i;
       } else {
         if (!IsEqualAndNotEmpty(shape_0, shape_i)) {
-          return false;
+          return IsBroadcastBinaryOp(n);
         }
       }
     }
@@ -125,6 +183,99 @@ std::vector<std::vector<Node*>> ElementwiseGroupDetector::operator()(
   return SubgraphDetector(graph, teller)();
 }
 
+bool ReductionGroupDetector::IsReductionOp(const Node* n) {
+  if (!IsSpecifiedOp(GetReductionOpTypes(), n) || n->inputs.size() != 1U) {
+    return false;
+  }
+  auto* in = n->inputs[0];
+  if (!(in && in->IsVar() && in->Var())) {
+    return false;
+  }
+  auto* op = n->Op();
+  if (op->HasAttr("reduce_all") &&
+      boost::get<bool>(op->GetAttr("reduce_all"))) {
+    return false;
+  }
+
+  // Only the reductions along the trailing dims with known sizes are
+  // supported, where the elements reduced are contiguous.
+  std::vector<int64_t> shape = in->Var()->GetShape();
+  int rank = static_cast<int>(shape.size());
+  std::vector<int> dims = boost::get<std::vector<int>>(op->GetAttr("dim"));
+  if (dims.size() == 0U || static_cast<int>(dims.size()) >= rank) {
+    return false;
+  }
+  for (auto& dim : dims) {
+    dim = dim < 0 ? dim + rank : dim;
+  }
+  std::sort(dims.begin(), dims.end());
+  int first_dim = rank - static_cast<int>(dims.size());
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (dims[i] != first_dim + static_cast<int>(i) || shape[dims[i]] <= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::vector<Node*>> ReductionGroupDetector::operator()(
+    Graph* graph) {
+  auto teller = [&](const Node* n) -> bool {
+    return CheckPrecondition(n) && (IsElementwiseOp(n) || IsReductionOp(n));
+  };
+
+  std::vector<std::vector<Node*>> groups;
+  std::unordered_set<Node*> grouped_nodes;
+  for (auto& subgraph : SubgraphDetector(graph, teller)()) {
+    std::unordered_set<Node*> subgraph_nodes(subgraph.begin(), subgraph.end());
+    for (auto* n : subgraph) {
+      if (!IsReductionOp(n)) {
+        continue;
+      }
+
+      // Collect the operations in the subgraph computing the input of the
+      // reduction. Since the subgraph has no cycle through the nodes outside
+      // it, neither does the group.
+      std::vector<int64_t> shape = n->inputs[0]->Var()->GetShape();
+      std::vector<Node*> group = {n};
+      std::unordered_set<Node*> visited = {n};
+      bool is_valid = true;
+      for (size_t i = 0; i < group.size() && is_valid; ++i) {
+        for (auto* in : group[i]->inputs) {
+          for (auto* pre : in->inputs) {
+            if (subgraph_nodes.count(pre) == 0U || visited.count(pre) != 0U) {
+              continue;
+            }
+            visited.insert(pre);
+            bool is_same_shape = true;
+            for (auto* out : pre->outputs) {
+              if (out && out->IsVar() && out->Var() &&
+                  out->Var()->GetShape() != shape) {
+                is_same_shape = false;
+              }
+            }
+            if (IsReductionOp(pre) || grouped_nodes.count(pre) != 0U ||
+                !is_same_shape) {
+              is_valid = false;
+              break;
+            }
+            group.push_back(pre);
+          }
+          if (!is_valid) {
+            break;
+          }
+        }
+      }
+
+      if (is_valid && group.size() > 1U) {
+        grouped_nodes.insert(group.begin(), group.end());
+        groups.push_back(group);
+      }
+    }
+  }
+  return groups;
+}
+
 }  // namespace fusion_group
 }  // namespace ir
 }  // namespace framework
@@ -26,14 +26,28 @@ namespace fusion_group {
 class GroupDetector {
  protected:
   bool CheckPrecondition(const Node* n);
+
+  // Whether all the inputs of n have the same shape, or the second input of
+  // a binary operation is broadcast to the first one along the trailing
+  // dims, e.g. a bias.
+  bool IsElementwiseOp(const Node* n);
 };
 
 class ElementwiseGroupDetector : GroupDetector {
  public:
   std::vector<std::vector<Node*>> operator()(Graph* graph);
+};
+
+// Detect the groups of elementwise operations followed by a reduction along
+// the trailing dims, e.g. reduce_mean(relu(x + bias), dim=-1). A group holds
+// the reduction and the elementwise operations computing its input, which
+// all have the same shape as the input.
+class ReductionGroupDetector : GroupDetector {
+ public:
+  std::vector<std::vector<Node*>> operator()(Graph* graph);
 
  private:
-  bool IsElementwiseOp(const Node* n);
+  bool IsReductionOp(const Node* n);
 };
 
 }  // namespace fusion_group
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/ir/fusion_group/fusion_group_pass.h"
+#include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
@@ -29,22 +31,35 @@ namespace ir {
 
 void FusionGroupPass::ApplyImpl(ir::Graph* graph) const {
   FusePassBase::Init("fusion_group_pass", graph);
+  fusion_group::OperationMap::Init();
+  // Detect the reductions at first, so that the elementwise operations
+  // computing their inputs are fused with them. The reductions are only
+  // fused on GPU.
+  int num_reduction_groups =
+      Get<bool>("use_gpu") ? DetectFusionGroup(graph, 1) : 0;
+  int num_elementwise_groups = DetectFusionGroup(graph, 0);
+  AddStatis(num_reduction_groups + num_elementwise_groups);
+  LOG(INFO) << "Detect " << num_elementwise_groups
+            << " elementwise fusion groups and " << num_reduction_groups
+            << " reduction fusion groups.";
+}
+
+platform::Place FusionGroupPass::GetPlace() const {
+  // TODO(liuyiqun): supported different places
   if (Get<bool>("use_gpu")) {
-    fusion_group::OperationMap::Init();
-    int num_elementwise_groups = DetectFusionGroup(graph, 0);
-    AddStatis(num_elementwise_groups);
-    LOG(INFO) << "Detect " << num_elementwise_groups
-              << " elementwise fusion groups.";
+    return platform::CUDAPlace(0);
   }
+  return platform::CPUPlace();
 }
 
 int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
+  platform::Place place = GetPlace();
   int index = platform::DeviceCodePool::Init({place}).size(place);
 
   std::vector<std::vector<Node*>> subgraphs =
-      fusion_group::ElementwiseGroupDetector()(graph);
+      type == 0 ? fusion_group::ElementwiseGroupDetector()(graph)
+                : fusion_group::ReductionGroupDetector()(graph);
+  std::string func_prefix = type == 0 ? "FusedElementwise" : "FusedReduction";
 
   int num_subgraphs = 0;
   size_t min_subgraph_size = 2;
@@ -56,7 +71,7 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
     VLOG(3) << "subgraph: {\n" << DebugString(subgraph.SortedNodes()) << "}\n";
 
     if (subgraph.IsValid(min_subgraph_size)) {
-      subgraph.SetFuncName("FusedElementwise" + std::to_string(index++));
+      subgraph.SetFuncName(func_prefix + std::to_string(index++));
       if (GenerateCode(&subgraph)) {
         InsertFusionGroupOp(graph, &subgraph);
         num_subgraphs++;
@@ -67,14 +82,26 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
 }
 
 bool FusionGroupPass::GenerateCode(fusion_group::SubGraph* subgraph) const {
-  fusion_group::CodeGenerator code_generator;
+  bool use_gpu = Get<bool>("use_gpu");
+  fusion_group::CodeGenerator code_generator(use_gpu);
   std::string code_str = code_generator.Generate(subgraph);
   VLOG(3) << code_str;
 
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
-  std::unique_ptr<platform::CUDADeviceCode> device_code(
-      new platform::CUDADeviceCode(place, subgraph->GetFuncName(), code_str));
+  platform::Place place = GetPlace();
+  std::unique_ptr<platform::DeviceCode> device_code;
+  if (use_gpu) {
+#ifdef PADDLE_WITH_CUDA
+    device_code.reset(new platform::CUDADeviceCode(
+        place, subgraph->GetFuncName(), code_str));
+#else
+    PADDLE_THROW(platform::errors::PreconditionNotMet(
+        "fusion_group on GPU is not supported, please re-compile with "
+        "WITH_GPU=ON."));
+#endif
+  } else {
+    device_code.reset(new platform::CPUDeviceCode(
+        place, subgraph->GetFuncName(), code_str));
+  }
   bool is_compiled = device_code->Compile();
   if (is_compiled) {
     platform::DeviceCodePool& pool = platform::DeviceCodePool::Init({place});
@@ -100,6 +127,39 @@ static int ExtractOpRole(fusion_group::SubGraph* subgraph) {
   }
 }
 
+// Set the attributes for fusion_group to infer the shape of the output of
+// the reduction.
+static void SetReductionAttrs(fusion_group::SubGraph* subgraph,
+                              const std::vector<std::string>& output_names,
+                              OpDesc* op_desc) {
+  for (auto* n : subgraph->Nodes()) {
+    if (!(n && n->IsOp() && n->Op()) ||
+        fusion_group::OperationMap::Instance().Get(n->Op()->Type()).type !=
+            1) {
+      continue;
+    }
+    auto* op = n->Op();
+    auto iter = std::find(output_names.begin(), output_names.end(),
+                          op->Output("Out")[0]);
+    PADDLE_ENFORCE_NE(iter, output_names.end(),
+                      platform::errors::NotFound(
+                          "The output of %s is not an output of the subgraph.",
+                          op->Type()));
+    op_desc->SetAttr("reduce_out_index",
+                     static_cast<int>(iter - output_names.begin()));
+    op_desc->SetAttr(
+        "reduce_num_dims",
+        static_cast<int>(
+            boost::get<std::vector<int>>(op->GetAttr("dim")).size()));
+    op_desc->SetAttr("keep_dim", op->HasAttr("keep_dim")
+                                     ? boost::get<bool>(op->GetAttr("keep_dim"))
+                                     : false);
+    return;
+  }
+  PADDLE_THROW(platform::errors::NotFound(
+      "There is no reduction in the subgraph %s.", subgraph->GetFuncName()));
+}
+
 void FusionGroupPass::InsertFusionGroupOp(
     Graph* graph, fusion_group::SubGraph* subgraph) const {
   const std::vector<Node*>& input_vars_of_subgraph =
@@ -135,6 +195,9 @@ void FusionGroupPass::InsertFusionGroupOp(
   op_desc.SetAttr("func_name", subgraph->GetFuncName());
   op_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
                   ExtractOpRole(subgraph));
+  if (subgraph->GetType() == 1) {
+    SetReductionAttrs(subgraph, output_names, &op_desc);
+  }
 
   Node* fusion_group_node = graph->CreateOpNode(&op_desc);
   for (auto* in : input_vars_of_subgraph) {
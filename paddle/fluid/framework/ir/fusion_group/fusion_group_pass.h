@@ -18,6 +18,7 @@ limitations under the License. */
 #include <unordered_set>
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/fusion_group/subgraph.h"
+#include "paddle/fluid/platform/place.h"
 
 namespace paddle {
 namespace framework {
@@ -28,6 +29,7 @@ class FusionGroupPass : public FusePassBase {
   void ApplyImpl(Graph* graph) const override;
 
  private:
+  platform::Place GetPlace() const;
   int DetectFusionGroup(Graph* graph, int type = 0) const;
   bool GenerateCode(fusion_group::SubGraph* subgraph) const;
   void InsertFusionGroupOp(Graph* graph,
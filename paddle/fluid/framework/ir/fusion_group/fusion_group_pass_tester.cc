@@ -133,10 +133,48 @@ std::unique_ptr<Graph> BuildElementwiseTreeGraph(bool backward = false) {
 #endif
 }
 
-int TestMain(std::unique_ptr<Graph> graph, std::string prefix) {
+std::unique_ptr<Graph> BuildReductionGraph() {
+  // inputs                     operator            output
+  // --------------------------------------------------------
+  // (x, bias)                  elementwise_add  -> tmp_0
+  // tmp_0                      relu             -> tmp_1
+  // tmp_1                      reduce_mean      -> tmp_2
+  // (tmp_2, y)                 mul              -> tmp_3
+  //
+  // Expression: tmp_2 = reduce_mean(relu(x + bias), dim=-1)
+  //             tmp_3 = mul(tmp_2, y)
+  Layers layers;
+  std::vector<int64_t> shape = {16, 32};
+  auto* x = layers.data("x", shape);
+  auto* bias = layers.data("bias", {32}, true);
+  auto* tmp_0 = layers.elementwise_add(x, bias);
+  auto* tmp_1 = layers.relu(tmp_0);
+  auto* tmp_2 = layers.reduce_mean(tmp_1, {-1}, true);
+  auto* y = layers.data("y", {1, 16});
+  layers.mul(tmp_2, y);
+  for (auto* var : {tmp_0, tmp_1}) {
+    var->SetShape(shape);
+  }
+  tmp_2->SetShape({16, 1});
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  for (auto* n : graph->Nodes()) {
+    if (n && n->IsVar() && n->Var()) {
+      n->Var()->SetDataType(proto::VarType::FP32);
+    }
+  }
+#ifdef __clang__
+  return graph;
+#else
+  return std::move(graph);
+#endif
+}
+
+int TestMain(std::unique_ptr<Graph> graph, std::string prefix,
+             bool use_gpu = true) {
   // VisualizeGraph(&graph, prefix + ".dot");
   auto pass = PassRegistry::Instance().Get("fusion_group_pass");
-  pass->Set("use_gpu", new bool(true));
+  pass->Set("use_gpu", new bool(use_gpu));
   VLOG(3) << DebugString(graph);
 
   graph.reset(pass->Apply(graph.release()));
@@ -147,6 +185,7 @@ int TestMain(std::unique_ptr<Graph> graph, std::string prefix) {
   return num_fusion_group_ops;
 }
 
+#ifdef PADDLE_WITH_CUDA
 TEST(FusionGroupPass, elementwise_list) {
   std::unique_ptr<Graph> graph = BuildElementwiseListGraph(true);
   int num_fusion_group_ops = TestMain(std::move(graph), "elementwise_list");
@@ -159,6 +198,36 @@ TEST(FusionGroupPass, elementwise_tree) {
   EXPECT_EQ(num_fusion_group_ops, 4);
 }
 
+TEST(FusionGroupPass, reduction) {
+  std::unique_ptr<Graph> graph = BuildReductionGraph();
+  int num_fusion_group_ops = TestMain(std::move(graph), "reduction");
+  EXPECT_EQ(num_fusion_group_ops, 1);
+}
+#endif
+
+TEST(FusionGroupPass, elementwise_list_cpu) {
+  std::unique_ptr<Graph> graph = BuildElementwiseListGraph(true);
+  int num_fusion_group_ops =
+      TestMain(std::move(graph), "elementwise_list_cpu", false);
+  EXPECT_EQ(num_fusion_group_ops, 2);
+}
+
+TEST(FusionGroupPass, elementwise_tree_cpu) {
+  std::unique_ptr<Graph> graph = BuildElementwiseTreeGraph(true);
+  int num_fusion_group_ops =
+      TestMain(std::move(graph), "elementwise_tree_cpu", false);
+  EXPECT_EQ(num_fusion_group_ops, 4);
+}
+
+TEST(FusionGroupPass, reduction_cpu) {
+  // The reductions are not fused on CPU, while the elementwise operations
+  // computing their inputs are.
+  std::unique_ptr<Graph> graph = BuildReductionGraph();
+  int num_fusion_group_ops =
+      TestMain(std::move(graph), "reduction_cpu", false);
+  EXPECT_EQ(num_fusion_group_ops, 1);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
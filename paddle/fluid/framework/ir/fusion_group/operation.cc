@@ -26,6 +26,7 @@ OperationMap::OperationMap() {
   InsertUnaryElementwiseOperations();
   InsertBinaryElementwiseOperations();
   InsertMultivariateElementwiseOperations();
+  InsertReductionOperations();
 }
 
 std::unordered_set<std::string> OperationMap::Find(int type) {
@@ -187,6 +188,25 @@ void OperationMap::InsertMultivariateElementwiseOperations() {
   insert_handler("sum", "${0}[ + ${?}]", {});
 }
 
+void OperationMap::InsertReductionOperations() {
+  // For reduction operations, the elements are summed up at first, and the
+  // expression computes the result from the sum:
+  //  ${0} - the sum of the elements
+  //  ${1} - the number of the elements
+  auto insert_handler = [&](std::string op_type, std::string expr) {
+    int type = 1;
+    int num_oprands = 1;
+    Insert(type, num_oprands, op_type, expr, {}, {"X"}, {"Out"});
+  };
+
+  // reduce_sum:
+  //  out = x_0 + x_1 + ... + x_N-1
+  insert_handler("reduce_sum", "${0}");
+  // reduce_mean:
+  //  out = (x_0 + x_1 + ... + x_N-1) / N
+  insert_handler("reduce_mean", "${0} / ${1}");
+}
+
 }  // namespace fusion_group
 }  // namespace ir
 }  // namespace framework
@@ -0,0 +1,208 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/gradient_accumulate_pass.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static const char kAccumulateSuffix[] = "@ACCUMULATE";
+
+static int GetOpRole(const ir::Node* node) {
+  return boost::get<int>(
+      node->Op()->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+}
+
+// The ops which update the parameters by the gradients, and are only run
+// on the last step of each accumulation.
+static bool IsOptimizeOp(const ir::Node* node) {
+  return GetOpRole(node) & (static_cast<int>(OpRole::kOptimize) |
+                            static_cast<int>(OpRole::kLRSched));
+}
+
+static void LinkNodes(ir::Node* from, ir::Node* to) {
+  from->outputs.push_back(to);
+  to->inputs.push_back(from);
+}
+
+static ir::Node* CreateOpNode(ir::Graph* graph, const std::string& type,
+                              const std::vector<std::string>& inputs,
+                              const std::string& output, OpRole role,
+                              const std::string& param_name) {
+  OpDesc desc;
+  desc.SetType(type);
+  desc.SetInput("X", inputs);
+  desc.SetOutput("Out", {output});
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               static_cast<int>(role));
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+               std::vector<std::string>({param_name, output}));
+  return graph->CreateOpNode(&desc);
+}
+
+void GradientAccumulatePass::ApplyImpl(ir::Graph* graph) const {
+  int steps = Get<int>(kGradientAccumulateSteps);
+  PADDLE_ENFORCE_GT(steps, 1,
+                    platform::errors::InvalidArgument(
+                        "The gradient_accumulate_steps should be greater "
+                        "than 1, but received %d.",
+                        steps));
+  std::unordered_map<std::string, VarDesc*> var_descs;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Var()) {
+      var_descs.emplace(node->Name(), node->Var());
+    }
+  }
+
+  auto sorted_ops = TopologySortOperations(*graph);
+  auto* acc_names = new GradientAccumulateVars;
+  graph->Set(kGradientAccumulateVars, acc_names);
+  for (auto* node : sorted_ops) {
+    if (!node->Op() ||
+        !(GetOpRole(node) & static_cast<int>(OpRole::kBackward)) ||
+        !node->Op()->HasAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName())) {
+      continue;
+    }
+    auto param_grads = boost::get<std::vector<std::string>>(
+        node->Op()->GetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName()));
+    if (param_grads.empty()) continue;
+    // the collective ops are inserted for the accumulated gradients, instead
+    // of the gradients of each step
+    node->Op()->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+                        std::vector<std::string>());
+
+    for (size_t i = 0; i < param_grads.size(); i += 2) {
+      const auto& param_name = param_grads[i];
+      const auto& grad_name = param_grads[i + 1];
+      auto it = std::find_if(
+          node->outputs.begin(), node->outputs.end(),
+          [&](ir::Node* out) { return out->Name() == grad_name; });
+      PADDLE_ENFORCE_NE(it, node->outputs.end(),
+                        platform::errors::NotFound(
+                            "The gradient %s is not an output of the op %s.",
+                            grad_name, node->Op()->Type()));
+      ir::Node* grad = *it;
+      PADDLE_ENFORCE_NE(var_descs.count(param_name), 0,
+                        platform::errors::NotFound(
+                            "The parameter %s is not found.", param_name));
+      auto* param_desc = var_descs.at(param_name);
+
+      // acc = sum(acc, grad), which is dense even if grad is SelectedRows
+      std::string acc_name = grad_name + kAccumulateSuffix;
+      VarDesc acc_desc(acc_name);
+      acc_desc.SetType(proto::VarType::LOD_TENSOR);
+      acc_desc.SetDataType(param_desc->GetDataType());
+      acc_desc.SetShape(param_desc->GetShape());
+      acc_desc.SetPersistable(true);
+      acc_names->push_back(acc_name);
+      auto* acc_in = graph->CreateVarNode(&acc_desc);
+      auto* sum = CreateOpNode(graph, "sum", {acc_name, grad_name}, acc_name,
+                               OpRole::kBackward, param_name);
+      LinkNodes(acc_in, sum);
+      LinkNodes(grad, sum);
+      auto* acc_sum = graph->CreateVarNode(&acc_desc);
+      LinkNodes(sum, acc_sum);
+
+      // acc = acc / steps, after acc is all reduced
+      auto* scale = CreateOpNode(graph, "scale", {acc_name}, acc_name,
+                                 OpRole::kOptimize, param_name);
+      scale->Op()->SetAttr("scale", 1.0f / steps);
+      LinkNodes(acc_sum, scale);
+      auto* acc_latest = graph->CreateVarNode(&acc_desc);
+      LinkNodes(scale, acc_latest);
+
+      // The optimize ops read acc instead of grad, and so do the ops that
+      // update grad in place, e.g., the weight decay.
+      std::vector<ir::Node*> acc_ops;
+      for (auto* op : sorted_ops) {
+        if (op == node || !op->Op() || !IsOptimizeOp(op)) continue;
+        bool touched = false;
+        for (auto*& in : op->inputs) {
+          if (in->Name() != grad_name) continue;
+          PADDLE_ENFORCE_EQ(in, grad,
+                            platform::errors::Unimplemented(
+                                "The gradient %s is written by a non-optimize "
+                                "op after it is accumulated.",
+                                grad_name));
+          grad->outputs.erase(
+              std::remove(grad->outputs.begin(), grad->outputs.end(), op),
+              grad->outputs.end());
+          in = acc_latest;
+          acc_latest->outputs.push_back(op);
+          touched = true;
+        }
+        for (auto* out : op->outputs) {
+          if (out->Name() == grad_name) {
+            out->RenameVar(acc_name);
+            out->Var()->SetPersistable(true);
+            acc_latest = out;
+            touched = true;
+          }
+        }
+        for (auto* in : op->inputs) {
+          touched = touched || in->Name() == acc_name;
+        }
+        if (touched) {
+          op->Op()->RenameInput(grad_name, acc_name);
+          op->Op()->RenameOutput(grad_name, acc_name);
+          // so that the reduce strategy places the op with acc
+          auto* op_desc = op->Op();
+          if (op_desc->HasAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName())) {
+            auto role_vars = boost::get<std::vector<std::string>>(
+                op_desc->GetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName()));
+            std::replace(role_vars.begin(), role_vars.end(), grad_name,
+                         acc_name);
+            op_desc->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+                             role_vars);
+          }
+          acc_ops.push_back(op);
+        }
+      }
+
+      // acc is zeroed after it is used by all the optimize ops
+      auto* reset = CreateOpNode(graph, "fill_zeros_like", {acc_name},
+                                 acc_name, OpRole::kOptimize, param_name);
+      LinkNodes(acc_latest, reset);
+      for (auto* op : acc_ops) {
+        if (std::find(acc_latest->inputs.begin(), acc_latest->inputs.end(),
+                      op) != acc_latest->inputs.end()) {
+          continue;
+        }
+        auto* dep = graph->CreateControlDepVar();
+        LinkNodes(op, dep);
+        LinkNodes(dep, reset);
+      }
+      LinkNodes(reset, graph->CreateVarNode(&acc_desc));
+      VLOG(3) << "accumulate " << grad_name << " to " << acc_name << " for "
+              << steps << " steps";
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(gradient_accumulate_pass,
+              paddle::framework::ir::GradientAccumulatePass)
+    .RequirePassAttr(paddle::framework::ir::kGradientAccumulateSteps);
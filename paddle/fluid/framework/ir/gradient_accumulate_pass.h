@@ -0,0 +1,47 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// the number of the steps whose gradients are accumulated
+constexpr char kGradientAccumulateSteps[] = "gradient_accumulate_steps";
+// the names of the persistable accumulated gradients, which are created by
+// the pass and should be zeroed before the first step
+constexpr char kGradientAccumulateVars[] = "gradient_accumulate_vars";
+typedef std::vector<std::string> GradientAccumulateVars;
+
+// GradientAccumulatePass trains with a large batch like BatchMergePass, but
+// without copying the forward and backward ops. In every step, each gradient
+// of the parameters is added to a persistable accumulated gradient, which is
+// all reduced, averaged, used by the optimize ops and zeroed then. The
+// optimize, the LR scheduling and the collective ops should only be run on
+// every kGradientAccumulateSteps-th step, which is done by ParallelExecutor.
+class GradientAccumulatePass : public Pass {
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
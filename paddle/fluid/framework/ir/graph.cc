@@ -139,6 +139,11 @@ void Graph::ResolveHazard(
         dep_var->inputs.push_back(upstream_op);
       }
 
+      // The inputs of write_op grow with the dep vars added below, which
+      // are looked up in a set rather than scanned for each read_op, since a
+      // var can be read by thousands of ops in the large graphs.
+      std::unordered_set<ir::Node *> write_op_inputs(write_op->inputs.begin(),
+                                                     write_op->inputs.end());
       for (auto *read_op : read_ops) {
         // Manually add a dependency var from read_op to write_op;
         if (read_op == write_op) {
@@ -146,15 +151,9 @@ void Graph::ResolveHazard(
           continue;
         }
         // 2 ops might have been connected via other vars.
-        bool has_dep = false;
-        for (ir::Node *r_out : read_op->outputs) {
-          for (ir::Node *w_in : write_op->inputs) {
-            if (r_out == w_in) {
-              has_dep = true;
-              break;
-            }
-          }
-        }
+        bool has_dep = std::any_of(
+            read_op->outputs.begin(), read_op->outputs.end(),
+            [&](ir::Node *r_out) { return write_op_inputs.count(r_out); });
         if (has_dep) continue;
 
         ir::Node *dep_var = CreateControlDepVar();
@@ -163,11 +162,41 @@ void Graph::ResolveHazard(
         dep_var->inputs.push_back(read_op);
         write_op->inputs.push_back(dep_var);
         dep_var->outputs.push_back(write_op);
+        write_op_inputs.insert(dep_var);
       }
     }
   }
 }
 
+const std::unordered_set<ir::Node *> &Graph::OpNodesOfType(
+    const std::string &op_type) const {
+  if (!op_type_index_built_) {
+    for (auto *n : node_set_) {
+      IndexOpNode(n);
+    }
+    op_type_index_built_ = true;
+  }
+  static const std::unordered_set<ir::Node *> kEmptyNodes;
+  auto it = op_type_index_.find(op_type);
+  return it == op_type_index_.end() ? kEmptyNodes : it->second;
+}
+
+void Graph::IndexOpNode(ir::Node *node) const {
+  if (node->IsOp() && node->Op()) {
+    const std::string &op_type = node->Op()->Type();
+    op_type_index_[op_type].insert(node);
+    op_node_types_[node] = op_type;
+  }
+}
+
+void Graph::UnindexOpNode(ir::Node *node) const {
+  auto it = op_node_types_.find(node);
+  if (it != op_node_types_.end()) {
+    op_type_index_[it->second].erase(node);
+    op_node_types_.erase(it);
+  }
+}
+
 std::shared_ptr<Graph> Graph::Clone() {
   auto cloned_graph = std::make_shared<Graph>(this->program_);
   cloned_graph->ReleaseNodes();
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -142,6 +143,21 @@ class Graph {
 
   const std::unordered_set<ir::Node *> &Nodes() const { return node_set_; }
 
+  // Return the op nodes of op_type. The index is built at the first call,
+  // and kept up to date when the nodes are added or removed, so that the
+  // pattern detection need not scan all the nodes of a large graph. The
+  // type of an op changed in place by OpDesc::SetType is not seen until
+  // InvalidateOpTypeIndex() is called, which Pass::Apply does after each
+  // pass, so the callers should still check the type of the nodes.
+  const std::unordered_set<ir::Node *> &OpNodesOfType(
+      const std::string &op_type) const;
+
+  void InvalidateOpTypeIndex() const {
+    op_type_index_built_ = false;
+    op_type_index_.clear();
+    op_node_types_.clear();
+  }
+
   // Create a normal variable with non-null VarDesc.
   ir::Node *CreateVarNode(VarDesc *var_desc) {
     PADDLE_ENFORCE_NOT_NULL(var_desc);
@@ -188,6 +204,7 @@ class Graph {
     }
     nodes_.clear();
     node_set_.clear();
+    InvalidateOpTypeIndex();
     return ret;
   }
 
@@ -197,6 +214,7 @@ class Graph {
     ret.reset(nodes_.at(node).release());
     nodes_.erase(node);
     node_set_.erase(node);
+    UnindexOpNode(node);
     return ret;
   }
 
@@ -221,6 +239,9 @@ class Graph {
     PADDLE_ENFORCE_EQ(node_set_.find(node) == node_set_.end(), true);
     nodes_[node].reset(node);
     node_set_.insert(node);
+    if (op_type_index_built_) {
+      IndexOpNode(node);
+    }
     return node;
   }
 
@@ -235,6 +256,9 @@ class Graph {
   std::map<std::string, std::vector<ir::Node *>> InitFromProgram(
       const ProgramDesc &program);
 
+  void IndexOpNode(ir::Node *node) const;
+  void UnindexOpNode(ir::Node *node) const;
+
   // NOTE: program_ shouldn't be exposed to user.
   const ProgramDesc program_;
   std::map<std::string, boost::any> attrs_;
@@ -242,6 +266,14 @@ class Graph {
   std::map<ir::Node *, std::unique_ptr<ir::Node>> nodes_;
   std::unordered_set<ir::Node *> node_set_;
   size_t num_node_created_{0};  // help to generate a unique node id.
+
+  // The index of OpNodesOfType, built lazily. The type an op node is
+  // indexed with is recorded, so that it can be removed from the index
+  // even if its type is changed in place.
+  mutable bool op_type_index_built_{false};
+  mutable std::unordered_map<std::string, std::unordered_set<ir::Node *>>
+      op_type_index_;
+  mutable std::unordered_map<ir::Node *, std::string> op_node_types_;
 };
 
 bool IsControlDepVar(const ir::Node &var);
@@ -31,23 +31,6 @@ namespace paddle {
 namespace framework {
 namespace ir {
 namespace {
-void SortHelper(const std::map<ir::Node *, std::set<ir::Node *, ir::NodeComp>,
-                               ir::NodeComp> &adj_list,
-                ir::Node *node, std::unordered_set<ir::Node *> *visited,
-                std::vector<ir::Node *> *ret) {
-  visited->insert(node);
-
-  for (auto adj : adj_list.at(node)) {
-    if (visited->find(adj) == visited->end()) {
-      SortHelper(adj_list, adj, visited, ret);
-    }
-  }
-
-  VLOG(5) << "topology sort insert: " << node->Name() << " "
-          << reinterpret_cast<void *>(node) << " input " << node->inputs.size();
-  ret->push_back(node);
-}
-
 bool HasCircleHelper(
     ir::Node *node,
     const std::map<ir::Node *, std::set<ir::Node *, ir::NodeComp>, ir::NodeComp>
@@ -97,10 +80,77 @@ bool HasCircleInternal(
   }
   return false;
 }
+
+// The post order of the DFS over BuildOperationAdjList, from the ops in the
+// order of ids, which visits the preceding ops in the order of ids too. The
+// ops are indexed densely and the DFS runs on a stack, so that it is linear
+// in the size of the graph and does not overflow for the large graphs.
+// Returns false if there is a circle.
+bool SortOperations(const Graph &graph, std::vector<ir::Node *> *ret) {
+  std::vector<ir::Node *> ops;
+  for (auto *n : graph.Nodes()) {
+    if (n->IsOp()) ops.push_back(n);
+  }
+  std::sort(ops.begin(), ops.end(), ir::NodeComp());
+  int max_id = ops.empty() ? -1 : ops.back()->id();
+  std::vector<int> index(max_id + 1, -1);
+  for (size_t i = 0; i < ops.size(); ++i) {
+    index[ops[i]->id()] = static_cast<int>(i);
+  }
+
+  std::vector<std::vector<int>> adj_list(ops.size());
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto &adj = adj_list[i];
+    for (auto *var : ops[i]->inputs) {
+      for (auto *adj_n : var->inputs) {
+        PADDLE_ENFORCE(adj_n->NodeType() == ir::Node::Type::kOperation);
+        int id = adj_n->id();
+        bool found = id >= 0 && id <= max_id && index[id] >= 0 &&
+                     ops[index[id]] == adj_n;
+        PADDLE_ENFORCE_EQ(found, true,
+                          platform::errors::NotFound(
+                              "The op %s is not in the graph.", adj_n->Name()));
+        adj.push_back(index[id]);
+      }
+    }
+    std::sort(adj.begin(), adj.end());
+    adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+  }
+
+  enum { kUnvisited = 0, kInTrace, kVisited };
+  std::vector<char> states(ops.size(), kUnvisited);
+  // the op, and the next one of its preceding ops to visit
+  std::vector<std::pair<int, size_t>> stack;
+  ret->clear();
+  ret->reserve(ops.size());
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (states[i] != kUnvisited) continue;
+    states[i] = kInTrace;
+    stack.emplace_back(static_cast<int>(i), 0);
+    while (!stack.empty()) {
+      auto &top = stack.back();
+      auto &adj = adj_list[top.first];
+      if (top.second < adj.size()) {
+        int next = adj[top.second++];
+        if (states[next] == kInTrace) return false;
+        if (states[next] == kUnvisited) {
+          states[next] = kInTrace;
+          stack.emplace_back(next, 0);
+        }
+      } else {
+        states[top.first] = kVisited;
+        ret->push_back(ops[top.first]);
+        stack.pop_back();
+      }
+    }
+  }
+  return true;
+}
 }  // namespace
 
 bool HasCircle(const Graph &graph) {
-  return HasCircleInternal(BuildOperationAdjList(graph), nullptr);
+  std::vector<ir::Node *> ops;
+  return !SortOperations(graph, &ops);
 }
 
 bool VarDescIsConsistency(const Graph &graph) {
@@ -134,17 +184,11 @@ bool FindCircleSubGraph(const Graph &graph,
 }
 
 std::vector<ir::Node *> TopologySortOperations(const Graph &graph) {
-  std::map<ir::Node *, std::set<ir::Node *, ir::NodeComp>, ir::NodeComp>
-      adj_list = BuildOperationAdjList(graph);
-  PADDLE_ENFORCE(!HasCircleInternal(adj_list, nullptr));
-  std::unordered_set<ir::Node *> visited;
   std::vector<ir::Node *> ret;
-  for (auto adj : adj_list) {
-    if (visited.find(adj.first) == visited.end()) {
-      SortHelper(adj_list, adj.first, &visited, &ret);
-    }
-  }
-
+  PADDLE_ENFORCE_EQ(SortOperations(graph, &ret), true,
+                    platform::errors::InvalidArgument(
+                        "There is a circle in the graph, which can not be "
+                        "sorted topologically."));
   return ret;
 }
 
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/ir/graph.h"
 #include <string>
+#include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/program_desc.h"
@@ -121,6 +122,29 @@ TEST(GraphHelperTest, Basic) {
   ASSERT_TRUE(node_map.at("op3") < node_map.at("op5"));
 }
 
+TEST(GraphHelperTest, LongChain) {
+  ProgramDesc prog;
+  Graph g(prog);
+  // ops are created in the reversed order of the chain, which is deep
+  // enough to overflow a recursive sort
+  const int num_ops = 100000;
+  std::vector<ir::Node*> ops(num_ops);
+  for (int i = num_ops - 1; i >= 0; --i) {
+    ops[i] = g.CreateEmptyNode("op" + std::to_string(i),
+                               Node::Type::kOperation);
+  }
+  for (int i = 0; i + 1 < num_ops; ++i) {
+    ir::Node* v = g.CreateEmptyNode("var", Node::Type::kVariable);
+    ops[i]->outputs.push_back(v);
+    v->inputs.push_back(ops[i]);
+    v->outputs.push_back(ops[i + 1]);
+    ops[i + 1]->inputs.push_back(v);
+  }
+  ASSERT_FALSE(HasCircle(g));
+  auto sorted = TopologySortOperations(g);
+  ASSERT_EQ(sorted, ops);
+}
+
 void BuildZeroGraph(Graph* g) {}
 
 void BuildOneGraph(Graph* g) {
@@ -110,11 +110,33 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+  for (const auto &pdnode : pattern_.nodes()) {
+    auto mark = [&](Node *node) {
+      if (pdnode->Tell(node)) {
+        VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+        pdnodes2nodes_[pdnode.get()].insert(node);
+      }
+    };
+    // Only the candidates found by the op type index of the graph are told,
+    // instead of all the nodes.
+    auto hint = pdnode->candidate_hint();
+    if (hint == PDNode::CandidateHint::kAll) {
+      for (auto *node : graph.Nodes()) {
+        mark(node);
+      }
+      continue;
+    }
+    for (auto &op_type : pdnode->hint_op_types()) {
+      for (auto *op : graph.OpNodesOfType(op_type)) {
+        if (hint == PDNode::CandidateHint::kOp) {
+          mark(op);
+        } else {
+          auto &vars = hint == PDNode::CandidateHint::kOpInput ? op->inputs
+                                                               : op->outputs;
+          for (auto *var : vars) {
+            mark(var);
+          }
+        }
       }
     }
   }
@@ -188,16 +210,6 @@ struct HitGroup {
   std::unordered_set<Node *> nodes_;
 };
 
-// Tell whether Node a links to b.
-bool IsNodesLink(Node *a, Node *b) {
-  for (auto *node : a->outputs) {
-    if (b == node) {
-      return true;
-    }
-  }
-  return false;
-}
-
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
@@ -228,23 +240,53 @@ GraphPatternDetector::DetectPatterns() {
     cur_groups.clear();
     if (pre_groups.empty()) break;
     // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
-        VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
-            }
+    // The groups are extended along the links of the nodes already matched,
+    // instead of checking all the pairs of the candidates, which is
+    // quadratic to the size of the graph.
+    auto &sources = pdnodes2nodes_[edge.first];
+    auto &targets = pdnodes2nodes_[edge.second];
+    auto extend = [&](const HitGroup &group, Node *source, Node *target) {
+      VLOG(8) << "check " << source->id() << " -- " << target->id();
+      HitGroup new_group = group;
+      bool flag = new_group.Match(source, edge.first) &&
+                  new_group.Match(target, edge.second);
+      if (flag) {
+        new_group.Register(source, edge.first);
+        new_group.Register(target, edge.second);
+        cur_groups.push_back(new_group);
+        // TODO(Superjomn) need to unique
+      }
+    };
+    // The nodes may be linked more than once, e.g. an op with the same
+    // variable as two inputs.
+    auto extend_outputs = [&](const HitGroup &group, Node *source) {
+      std::unordered_set<Node *> visited;
+      for (auto *target : source->outputs) {
+        if (targets.count(target) && visited.insert(target).second) {
+          extend(group, source, target);
+        }
+      }
+    };
+    for (const auto &group : pre_groups) {
+      auto source_it = group.roles.find(edge.first);
+      auto target_it = group.roles.find(edge.second);
+      if (source_it != group.roles.end()) {
+        if (sources.count(source_it->second)) {
+          extend_outputs(group, source_it->second);
+        }
+      } else if (target_it != group.roles.end()) {
+        Node *target = target_it->second;
+        if (!targets.count(target)) continue;
+        std::unordered_set<Node *> visited;
+        for (auto *source : target->inputs) {
+          if (sources.count(source) && visited.insert(source).second) {
+            extend(group, source, target);
           }
         }
+      } else {
+        for (auto *source : sources) {
+          extend_outputs(group, source);
+        }
       }
     }
     VLOG(3) << "step " << step << " get records: " << cur_groups.size();
@@ -372,6 +414,7 @@ PDNode *PDNode::assert_is_op() {
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  SetCandidateHint(CandidateHint::kOp, {op_type});
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -425,6 +468,7 @@ PDNode *PDNode::assert_is_op_nth_input(const std::string &op_type,
 PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument, int nth) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpOutput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op->IsOp() && op->Op()->Type() == op_type &&
@@ -438,6 +482,7 @@ PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
 
 PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpInput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type &&
@@ -452,6 +497,7 @@ PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
 
 PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpOutput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type &&
@@ -466,6 +512,7 @@ PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
 
 PDNode *PDNode::assert_is_op_output(const std::string &op_type) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpOutput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type) {
@@ -486,6 +533,7 @@ PDNode *PDNode::assert_is_op_output(const std::string &op_type,
 
 PDNode *PDNode::assert_is_op_input(const std::string &op_type) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpInput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type) {
@@ -542,6 +590,7 @@ PDNode *PDNode::assert_more(PDNode::teller_t &&teller) {
 }
 
 PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
+  SetCandidateHint(CandidateHint::kOp, op_types);
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
@@ -568,6 +617,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
     const std::unordered_set<std::string> &op_types,
     const std::string &argument, int nth) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpOutput, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op->IsOp() && op_types.count(op->Op()->Type()) &&
@@ -581,6 +631,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
 PDNode *PDNode::assert_is_ops_output(
     const std::unordered_set<std::string> &op_types) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpOutput, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op_types.count(op->Op()->Type())) {
@@ -603,6 +654,7 @@ PDNode *PDNode::assert_is_ops_output(
 PDNode *PDNode::assert_is_ops_input(
     const std::unordered_set<std::string> &op_types) {
   assert_is_var();
+  SetCandidateHint(CandidateHint::kOpInput, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op_types.count(op->Op()->Type())) {
@@ -54,6 +54,15 @@ struct PDNode {
     kOutput,       // an output and will be retained,
     kIntermediate  // will be removed after handler.
   };
+  // Where to find the candidates of this node, which is deduced from the
+  // first assertion on the op types, so that the detector need not tell
+  // all the nodes of the graph.
+  enum class CandidateHint {
+    kAll,       // all the nodes,
+    kOp,        // the ops of hint_op_types(),
+    kOpInput,   // the inputs of the ops of hint_op_types(),
+    kOpOutput,  // the outputs of the ops of hint_op_types().
+  };
 
   // this link to others
   PDNode& LinksTo(const std::vector<PDNode*>& others);
@@ -71,6 +80,14 @@ struct PDNode {
   bool IsOp() const { return type_ == Type::kOp; }
   bool IsVar() const { return type_ == Type::kVar; }
 
+  // The teller defined by the user ignores the assertions and their hints.
+  CandidateHint candidate_hint() const {
+    return teller_ ? CandidateHint::kAll : candidate_hint_;
+  }
+  const std::unordered_set<std::string>& hint_op_types() const {
+    return hint_op_types_;
+  }
+
   const std::string& name() const { return name_; }
 
   PDNode& operator=(const PDNode&) = delete;
@@ -165,6 +182,14 @@ struct PDNode {
 
   PDNode(PDNode&& other) = default;
 
+  void SetCandidateHint(CandidateHint hint,
+                        const std::unordered_set<std::string>& op_types) {
+    if (candidate_hint_ == CandidateHint::kAll) {
+      candidate_hint_ = hint;
+      hint_op_types_ = op_types;
+    }
+  }
+
   friend class PDPattern;
 
   // Will removed latter.
@@ -174,6 +199,8 @@ struct PDNode {
   std::string name_;
   Type type_;
   Role role_{Role::kUnknown};
+  CandidateHint candidate_hint_{CandidateHint::kAll};
+  std::unordered_set<std::string> hint_op_types_;
 };
 
 /*
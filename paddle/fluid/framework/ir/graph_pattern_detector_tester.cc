@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 
 #include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
 
 namespace paddle {
 namespace framework {
@@ -201,6 +202,45 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(GraphPatternDetector, OpTypeCandidates) {
+  // x -> relu -> scale -> relu -> scale
+  //        |                       ^
+  //        +-----------------------+ (elementwise_add)
+  Layers layers;
+  auto* x = layers.data("x");
+  auto* relu_out_0 = layers.relu(x);
+  auto* scale_out_0 = layers.scale(relu_out_0, 1.0f, 0.0f, true);
+  auto* relu_out_1 = layers.relu(scale_out_0);
+  layers.scale(relu_out_1, 1.0f, 0.0f, true);
+  layers.elementwise_add(relu_out_0, relu_out_1);
+  Graph graph(layers.main_program());
+
+  GraphPatternDetector detector;
+  auto* relu = detector.mutable_pattern()->NewNode("relu")->assert_is_op(
+      "relu");
+  auto* relu_out = detector.mutable_pattern()
+                       ->NewNode("relu_out")
+                       ->assert_is_op_output("relu")
+                       ->assert_is_op_input("scale", "X");
+  auto* scale = detector.mutable_pattern()->NewNode("scale")->assert_is_ops(
+      {"scale"});
+  relu->LinksTo({relu_out});
+  scale->LinksFrom({relu_out});
+  ASSERT_EQ(relu->candidate_hint(), PDNode::CandidateHint::kOp);
+  ASSERT_EQ(relu_out->candidate_hint(), PDNode::CandidateHint::kOpOutput);
+  ASSERT_EQ(scale->candidate_hint(), PDNode::CandidateHint::kOp);
+
+  int count = 0;
+  detector(&graph, [&](const GraphPatternDetector::subgraph_t& subgraph,
+                       Graph* g) {
+    EXPECT_EQ(subgraph.at(relu)->Op()->Type(), "relu");
+    EXPECT_EQ(subgraph.at(scale)->Op()->Type(), "scale");
+    EXPECT_EQ(subgraph.at(relu)->outputs[0], subgraph.at(relu_out));
+    ++count;
+  });
+  ASSERT_EQ(count, 2);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -128,6 +128,39 @@ TEST(GraphTest, Basic) {
   ASSERT_EQ(nodes.size(), 5UL);
 }
 
+TEST(GraphTest, OpNodesOfType) {
+  ProgramDesc prog;
+  for (auto &type : {"sum", "dummy", "sum"}) {
+    auto *op = prog.MutableBlock(0)->AppendOp();
+    op->SetType(type);
+  }
+
+  std::unique_ptr<ir::Graph> g(new ir::Graph(prog));
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 2UL);
+  ASSERT_EQ(g->OpNodesOfType("dummy").size(), 1UL);
+  ASSERT_EQ(g->OpNodesOfType("not_exist").size(), 0UL);
+
+  // The index is kept up to date when the nodes are added or removed.
+  OpDesc desc;
+  desc.SetType("dummy");
+  auto *new_op = g->CreateOpNode(&desc);
+  ASSERT_EQ(g->OpNodesOfType("dummy").count(new_op), 1UL);
+  ir::Node *sum_op = *g->OpNodesOfType("sum").begin();
+  g->RemoveNode(sum_op);
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 1UL);
+
+  // The op retyped in place is re-indexed after the index is invalidated.
+  new_op->Op()->SetType("sum");
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 1UL);
+  g->RemoveNode(new_op);
+  ASSERT_EQ(g->OpNodesOfType("dummy").size(), 1UL);
+  ir::Node *dummy_op = *g->OpNodesOfType("dummy").begin();
+  dummy_op->Op()->SetType("sum");
+  g->InvalidateOpTypeIndex();
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 2UL);
+  ASSERT_EQ(g->OpNodesOfType("dummy").size(), 0UL);
+}
+
 TEST(GraphTest, WriteAfterRead) {
   // void Test() {
   ProgramDesc prog;
@@ -0,0 +1,413 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/layout_propagation_pass.h"
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+struct LayoutOpInfo {
+  std::string input;
+  std::string output;
+  std::string layout_attr;  // empty for the layout agnostic ops
+};
+
+const std::unordered_map<std::string, LayoutOpInfo>& LayoutOpInfos() {
+  static const std::unordered_map<std::string, LayoutOpInfo> infos = {
+      {"conv2d", {"Input", "Output", "data_format"}},
+      {"depthwise_conv2d", {"Input", "Output", "data_format"}},
+      {"pool2d", {"X", "Out", "data_format"}},
+      {"batch_norm", {"X", "Y", "data_layout"}},
+      {"relu", {"X", "Out", ""}},
+      {"relu6", {"X", "Out", ""}},
+      {"leaky_relu", {"X", "Out", ""}},
+      {"sigmoid", {"X", "Out", ""}},
+      {"tanh", {"X", "Out", ""}},
+      {"swish", {"X", "Out", ""}},
+      {"hard_swish", {"X", "Out", ""}},
+      {"hard_sigmoid", {"X", "Out", ""}},
+      {"scale", {"X", "Out", ""}},
+      {"elementwise_add", {"X", "Out", ""}},
+      {"elementwise_sub", {"X", "Out", ""}},
+      {"elementwise_mul", {"X", "Out", ""}},
+      {"concat", {"X", "Out", ""}},
+  };
+  return infos;
+}
+
+bool IsElementwiseOp(const std::string& type) {
+  return type == "elementwise_add" || type == "elementwise_sub" ||
+         type == "elementwise_mul";
+}
+
+// The nodes of the variables in the slot of an op, nullptr for the ones not
+// found in nodes.
+std::vector<Node*> SlotVars(const std::vector<Node*>& nodes,
+                            const VariableNameMap& slots,
+                            const std::string& slot) {
+  std::vector<Node*> vars;
+  auto it = slots.find(slot);
+  if (it == slots.end()) {
+    return vars;
+  }
+  for (auto& name : it->second) {
+    Node* var = nullptr;
+    for (auto* node : nodes) {
+      if (node->Name() == name) {
+        var = node;
+        break;
+      }
+    }
+    vars.push_back(var);
+  }
+  return vars;
+}
+
+std::string UniqueName(const std::string& prefix,
+                       std::unordered_set<std::string>* names) {
+  std::string name = prefix;
+  for (int i = 0; names->count(name); ++i) {
+    name = prefix + "_" + std::to_string(i);
+  }
+  names->insert(name);
+  return name;
+}
+
+}  // namespace
+
+void LayoutPropagationPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+
+  // Only the variables with a single node are converted, since the others
+  // are written more than once, e.g. by the inplace ops.
+  std::unordered_map<std::string, int> var_node_num;
+  std::unordered_set<std::string> var_names;
+  for (auto* n : graph->Nodes()) {
+    if (n->IsVar()) {
+      ++var_node_num[n->Name()];
+      var_names.insert(n->Name());
+    }
+  }
+  std::unordered_set<std::string> single_vars;
+  for (auto& pair : var_node_num) {
+    if (pair.second == 1) {
+      single_vars.insert(pair.first);
+    }
+  }
+
+  std::vector<LayoutOp> layout_ops;
+  for (auto* n : TopologySortOperations(*graph)) {
+    LayoutOp layout_op;
+    if (GetLayoutOp(n, single_vars, &layout_op)) {
+      layout_ops.push_back(layout_op);
+    }
+  }
+
+  // The ops sharing a variable in the data layout are in the same region.
+  std::vector<size_t> parents(layout_ops.size());
+  for (size_t i = 0; i < parents.size(); ++i) {
+    parents[i] = i;
+  }
+  std::function<size_t(size_t)> find_root = [&](size_t i) {
+    if (parents[i] != i) {
+      parents[i] = find_root(parents[i]);
+    }
+    return parents[i];
+  };
+  std::unordered_map<Node*, size_t> var_to_op;
+  auto link = [&](Node* var, size_t i) {
+    auto it = var_to_op.find(var);
+    if (it == var_to_op.end()) {
+      var_to_op.emplace(var, i);
+    } else {
+      parents[find_root(i)] = find_root(it->second);
+    }
+  };
+  for (size_t i = 0; i < layout_ops.size(); ++i) {
+    for (auto* in : layout_ops[i].inputs) {
+      link(in, i);
+    }
+    link(layout_ops[i].output, i);
+  }
+
+  std::vector<size_t> roots;
+  std::unordered_map<size_t, std::vector<LayoutOp>> regions;
+  for (size_t i = 0; i < layout_ops.size(); ++i) {
+    size_t root = find_root(i);
+    if (regions.count(root) == 0) {
+      roots.push_back(root);
+    }
+    regions[root].push_back(layout_ops[i]);
+  }
+  for (auto root : roots) {
+    ConvertRegion(graph, regions[root], &var_names);
+  }
+}
+
+bool LayoutPropagationPass::GetLayoutOp(
+    Node* n, const std::unordered_set<std::string>& vars,
+    LayoutOp* layout_op) const {
+  if (!n->IsOp() || !n->Op()) {
+    return false;
+  }
+  auto* op = n->Op();
+  auto it = LayoutOpInfos().find(op->Type());
+  if (it == LayoutOpInfos().end()) {
+    return false;
+  }
+  auto& info = it->second;
+  if (op->GetAttrIfExists<int>(OpProtoAndCheckerMaker::OpRoleAttrName()) !=
+          static_cast<int>(OpRole::kForward) ||
+      op->GetAttrIfExists<bool>("use_mkldnn")) {
+    return false;
+  }
+  if (!info.layout_attr.empty()) {
+    auto layout = op->GetAttrIfExists<std::string>(info.layout_attr);
+    if (!layout.empty() && layout != "NCHW" && layout != "AnyLayout") {
+      return false;
+    }
+  }
+
+  auto is_data_var = [&](Node* var) {
+    return var && var->IsVar() && var->Var() &&
+           var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+           !var->Var()->Persistable() && var->Var()->GetShape().size() == 4 &&
+           vars.count(var->Name());
+  };
+
+  auto outputs = SlotVars(n->outputs, op->Outputs(), info.output);
+  if (outputs.size() != 1 || !is_data_var(outputs[0])) {
+    return false;
+  }
+  auto inputs = SlotVars(n->inputs, op->Inputs(), info.input);
+  if (inputs.empty()) {
+    return false;
+  }
+  for (auto* in : inputs) {
+    if (!is_data_var(in)) {
+      return false;
+    }
+  }
+
+  layout_op->op = n;
+  layout_op->output = outputs[0];
+  layout_op->layout_attr = info.layout_attr;
+  layout_op->has_channel_axis = false;
+  layout_op->is_conv =
+      op->Type() == "conv2d" || op->Type() == "depthwise_conv2d";
+
+  if (op->Type() == "concat") {
+    if (!SlotVars(n->inputs, op->Inputs(), "AxisTensor").empty() ||
+        op->GetAttrIfExists<int>("axis") != 1) {
+      return false;
+    }
+    layout_op->has_channel_axis = true;
+  } else if (IsElementwiseOp(op->Type())) {
+    auto ys = SlotVars(n->inputs, op->Inputs(), "Y");
+    if (inputs.size() != 1 || ys.size() != 1 || !ys[0] || !ys[0]->Var()) {
+      return false;
+    }
+    int axis = op->HasAttr("axis") ? op->GetAttrIfExists<int>("axis") : -1;
+    auto x_shape = inputs[0]->Var()->GetShape();
+    auto y_shape = ys[0]->Var()->GetShape();
+    if (is_data_var(ys[0]) && x_shape == y_shape && (axis == -1 || axis == 0)) {
+      inputs.push_back(ys[0]);
+    } else if (y_shape.size() == 1 && axis == 1) {
+      // the per-channel bias, e.g. the one of conv2d
+      layout_op->has_channel_axis = true;
+    } else {
+      return false;
+    }
+  } else {
+    if (inputs.size() != 1) {
+      return false;
+    }
+    if (layout_op->is_conv &&
+        !SlotVars(n->inputs, op->Inputs(), "ResidualData").empty()) {
+      return false;
+    }
+  }
+  layout_op->inputs = inputs;
+  return true;
+}
+
+void LayoutPropagationPass::ConvertRegion(
+    Graph* graph, const std::vector<LayoutOp>& region,
+    std::unordered_set<std::string>* var_names) const {
+  bool has_conv = false;
+  int num_layout_sensitive_ops = 0;
+  // the variables in the data layout, in the order of the ops
+  std::vector<Node*> vars;
+  std::unordered_map<Node*, std::unordered_set<Node*>> layout_users;
+  std::unordered_set<Node*> produced_vars;
+  auto add_var = [&](Node* var) {
+    if (std::find(vars.begin(), vars.end(), var) == vars.end()) {
+      vars.push_back(var);
+    }
+  };
+  for (auto& layout_op : region) {
+    has_conv = has_conv || layout_op.is_conv;
+    if (!layout_op.layout_attr.empty()) {
+      ++num_layout_sensitive_ops;
+    }
+    for (auto* in : layout_op.inputs) {
+      add_var(in);
+      layout_users[in].insert(layout_op.op);
+    }
+    add_var(layout_op.output);
+    produced_vars.insert(layout_op.output);
+  }
+
+  // The variables produced in the region are transposed back if they are
+  // used out of the region or fetched, and the other ones are transposed to
+  // NHWC.
+  std::unordered_set<Node*> transposed_back_vars;
+  for (auto* var : vars) {
+    if (produced_vars.count(var) == 0) {
+      continue;
+    }
+    auto& users = layout_users[var];
+    bool used_out_of_region = var->outputs.empty();
+    for (auto* out : var->outputs) {
+      used_out_of_region = used_out_of_region || users.count(out) == 0;
+    }
+    if (used_out_of_region) {
+      transposed_back_vars.insert(var);
+    }
+  }
+  int num_transposes = static_cast<int>(vars.size() - produced_vars.size() +
+                                        transposed_back_vars.size());
+  if (!has_conv || num_transposes > num_layout_sensitive_ops) {
+    VLOG(3) << "Skip the region of " << region.size() << " ops with "
+            << num_layout_sensitive_ops << " layout sensitive ops, which needs "
+            << num_transposes << " transposes";
+    return;
+  }
+  VLOG(3) << "Convert the region of " << region.size()
+          << " ops to NHWC with " << num_transposes << " transposes";
+
+  for (auto& layout_op : region) {
+    auto* op = layout_op.op->Op();
+    if (!layout_op.layout_attr.empty()) {
+      op->SetAttr(layout_op.layout_attr, std::string("NHWC"));
+    }
+    if (layout_op.has_channel_axis) {
+      op->SetAttr("axis", 3);
+    }
+  }
+
+  for (auto* var : vars) {
+    VarDesc desc(*var->Var()->Proto());
+    desc.SetName(UniqueName(var->Name() + "_nhwc", var_names));
+    auto shape = var->Var()->GetShape();
+    desc.SetShape({shape[0], shape[2], shape[3], shape[1]});
+    auto* nhwc_var = graph->CreateVarNode(&desc);
+
+    auto& users = layout_users[var];
+    auto consumers = var->outputs;
+    if (produced_vars.count(var)) {
+      ReplaceOutputVar(var->inputs[0], var, nhwc_var);
+      for (auto* op : consumers) {
+        if (users.count(op)) {
+          ReplaceInputVar(op, var, nhwc_var);
+        }
+      }
+      if (transposed_back_vars.count(var)) {
+        CreateTranspose(graph, nhwc_var, var, {0, 3, 1, 2}, var_names);
+      } else {
+        graph->RemoveNode(var);
+      }
+    } else {
+      CreateTranspose(graph, var, nhwc_var, {0, 2, 3, 1}, var_names);
+      for (auto* op : consumers) {
+        if (users.count(op)) {
+          ReplaceInputVar(op, var, nhwc_var);
+        }
+      }
+    }
+  }
+}
+
+Node* LayoutPropagationPass::CreateTranspose(
+    Graph* graph, Node* x, Node* out, const std::vector<int>& axis,
+    std::unordered_set<std::string>* var_names) const {
+  auto x_shape = x->Var()->GetShape();
+  std::vector<int64_t> xshape_dims = {0};
+  xshape_dims.insert(xshape_dims.end(), x_shape.begin(), x_shape.end());
+  VarDesc xshape_desc(UniqueName(out->Name() + "_xshape", var_names));
+  xshape_desc.SetType(proto::VarType::LOD_TENSOR);
+  xshape_desc.SetDataType(x->Var()->GetDataType());
+  xshape_desc.SetShape(xshape_dims);
+  auto* xshape = graph->CreateVarNode(&xshape_desc);
+
+  OpDesc desc;
+  desc.SetType("transpose2");
+  desc.SetInput("X", {x->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetOutput("XShape", {xshape->Name()});
+  desc.SetAttr("axis", axis);
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               static_cast<int>(OpRole::kForward));
+  auto* transpose = graph->CreateOpNode(&desc);
+
+  IR_NODE_LINK_TO(x, transpose);
+  IR_NODE_LINK_TO(transpose, out);
+  IR_NODE_LINK_TO(transpose, xshape);
+  return transpose;
+}
+
+void LayoutPropagationPass::ReplaceInputVar(Node* op, Node* old_var,
+                                            Node* new_var) const {
+  op->Op()->RenameInput(old_var->Name(), new_var->Name());
+  for (size_t i = 0; i < op->inputs.size(); ++i) {
+    if (op->inputs[i] == old_var) {
+      op->inputs[i] = new_var;
+      new_var->outputs.push_back(op);
+    }
+  }
+  old_var->outputs.erase(
+      std::remove(old_var->outputs.begin(), old_var->outputs.end(), op),
+      old_var->outputs.end());
+}
+
+void LayoutPropagationPass::ReplaceOutputVar(Node* op, Node* old_var,
+                                             Node* new_var) const {
+  op->Op()->RenameOutput(old_var->Name(), new_var->Name());
+  for (size_t i = 0; i < op->outputs.size(); ++i) {
+    if (op->outputs[i] == old_var) {
+      op->outputs[i] = new_var;
+      new_var->inputs.push_back(op);
+    }
+  }
+  old_var->inputs.erase(
+      std::remove(old_var->inputs.begin(), old_var->inputs.end(), op),
+      old_var->inputs.end());
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(layout_propagation_pass,
+              paddle::framework::ir::LayoutPropagationPass);
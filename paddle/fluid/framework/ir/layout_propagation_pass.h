@@ -0,0 +1,74 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Run the connected regions of conv2d, pool2d, batch_norm and the layout
+ * agnostic ops between them, e.g. the activations, elementwise ops with a
+ * per-channel bias and concat along the channels, in NHWC instead of NCHW,
+ * which lets cuDNN use the tensor cores without transposing the data in
+ * each kernel.
+ *
+ * The data_format attributes of the ops in a region are set to NHWC, the
+ * variables produced in the region are replaced by the NHWC ones, and
+ * transpose2 ops are only inserted at the boundaries of the region, i.e.
+ * for the NCHW inputs of the region and the variables used out of it. A
+ * region is only converted if it has a conv and the transposes inserted
+ * are no more than the layout sensitive ops in it.
+ *
+ * Only the forward ops are converted, so in a training graph the backward
+ * ops read the NCHW variables transposed back at the boundaries, which
+ * usually makes the regions not worth converting.
+ */
+class LayoutPropagationPass : public Pass {
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  struct LayoutOp {
+    Node* op;
+    std::vector<Node*> inputs;  // the 4-D inputs in the data layout
+    Node* output;
+    std::string layout_attr;  // empty for the layout agnostic ops
+    bool has_channel_axis;    // the axis attribute is the channel one
+    bool is_conv;
+  };
+
+  bool GetLayoutOp(Node* n, const std::unordered_set<std::string>& vars,
+                   LayoutOp* layout_op) const;
+
+  void ConvertRegion(Graph* graph, const std::vector<LayoutOp>& region,
+                     std::unordered_set<std::string>* var_names) const;
+
+  Node* CreateTranspose(Graph* graph, Node* x, Node* out,
+                        const std::vector<int>& axis,
+                        std::unordered_set<std::string>* var_names) const;
+
+  void ReplaceInputVar(Node* op, Node* old_var, Node* new_var) const;
+  void ReplaceOutputVar(Node* op, Node* old_var, Node* new_var) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,174 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/layout_propagation_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+std::unique_ptr<Graph> ApplyPass(const ProgramDesc& program) {
+  std::unique_ptr<Graph> graph(new Graph(program));
+  auto pass = PassRegistry::Instance().Get("layout_propagation_pass");
+  VLOG(3) << DebugString(graph);
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+  return graph;
+}
+
+std::vector<OpDesc*> GetOps(const std::unique_ptr<Graph>& graph,
+                            const std::string& op_type) {
+  std::vector<OpDesc*> ops;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op()->Type() == op_type) {
+      ops.push_back(node->Op());
+    }
+  }
+  return ops;
+}
+
+VarDesc* Conv2d(Layers* layers, VarDesc* x, const std::string& filter_name,
+                const std::vector<int64_t>& out_shape) {
+  auto* filter = layers->data(filter_name, {out_shape[1], 3, 3, 3}, true);
+  auto* bias = layers->data(filter_name + "_bias", {out_shape[1]}, true);
+  auto* out = layers->conv2d(x, filter, bias);
+  out->SetShape(out_shape);
+  return out;
+}
+
+TEST(LayoutPropagationPass, convert_region) {
+  // x -> conv2d -> batch_norm -> relu -> conv2d -> elementwise_add -> pool2d
+  //                               |                     ^
+  //                               +---------------------+
+  // pool2d -> softmax
+  Layers layers;
+  auto* x = layers.data("x", {1, 3, 8, 8});
+  auto* conv_out_0 = Conv2d(&layers, x, "filter_0", {1, 3, 8, 8});
+  auto* bn_out = layers
+                     .batch_norm(conv_out_0, layers.data("scale", {3}, true),
+                                 layers.data("bias", {3}, true),
+                                 layers.data("mean", {3}, true),
+                                 layers.data("variance", {3}, true))
+                     .front();
+  bn_out->SetShape({1, 3, 8, 8});
+  auto* relu_out = layers.relu(bn_out);
+  relu_out->SetShape({1, 3, 8, 8});
+  auto* conv_out_1 = Conv2d(&layers, relu_out, "filter_1", {1, 3, 8, 8});
+  auto* add_out = layers.elementwise_add(conv_out_1, relu_out);
+  add_out->SetShape({1, 3, 8, 8});
+  auto* pool_out = layers.pool2d(add_out, true);
+  pool_out->SetShape({1, 3, 4, 4});
+  layers.softmax(pool_out, -1);
+
+  auto graph = ApplyPass(layers.main_program());
+  auto transposes = GetOps(graph, "transpose2");
+  ASSERT_EQ(transposes.size(), 2UL);
+  EXPECT_EQ(transposes[0]->Input("X")[0], "x");
+  EXPECT_EQ(transposes[0]->Output("Out")[0], "x_nhwc");
+  EXPECT_EQ(transposes[0]->GetAttrIfExists<std::vector<int>>("axis"),
+            std::vector<int>({0, 2, 3, 1}));
+  EXPECT_EQ(transposes[1]->Output("Out")[0], pool_out->Name());
+  EXPECT_EQ(transposes[1]->GetAttrIfExists<std::vector<int>>("axis"),
+            std::vector<int>({0, 3, 1, 2}));
+
+  for (auto* conv : GetOps(graph, "conv2d")) {
+    EXPECT_EQ(conv->GetAttrIfExists<std::string>("data_format"), "NHWC");
+  }
+  EXPECT_EQ(GetOps(graph, "conv2d")[0]->Input("Input")[0], "x_nhwc");
+  auto* bn = GetOps(graph, "batch_norm")[0];
+  EXPECT_EQ(bn->GetAttrIfExists<std::string>("data_layout"), "NHWC");
+  auto* pool = GetOps(graph, "pool2d")[0];
+  EXPECT_EQ(pool->GetAttrIfExists<std::string>("data_format"), "NHWC");
+  EXPECT_EQ(pool->Output("Out")[0], transposes[1]->Input("X")[0]);
+  EXPECT_EQ(GetOps(graph, "softmax")[0]->Input("X")[0], pool_out->Name());
+
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == bn_out->Name() + "_nhwc") {
+      EXPECT_EQ(node->Var()->GetShape(), std::vector<int64_t>({1, 8, 8, 3}));
+    }
+    // the variables only used in the region are removed
+    EXPECT_NE(node->Name(), relu_out->Name());
+  }
+}
+
+TEST(LayoutPropagationPass, channel_axis) {
+  // x -> conv2d -> elementwise_add(axis=1) -> relu -> pool2d -> softmax
+  Layers layers;
+  auto* x = layers.data("x", {1, 3, 8, 8});
+  auto* conv_out = Conv2d(&layers, x, "filter", {1, 4, 8, 8});
+  auto* add_out =
+      layers.elementwise_add(conv_out, layers.data("bias", {4}, true));
+  add_out->SetShape({1, 4, 8, 8});
+  auto* relu_out = layers.relu(add_out);
+  relu_out->SetShape({1, 4, 8, 8});
+  auto* pool_out = layers.pool2d(relu_out, true);
+  pool_out->SetShape({1, 4, 4, 4});
+  layers.softmax(pool_out, -1);
+
+  ProgramDesc program(layers.main_program());
+  for (auto* op : program.MutableBlock(0)->AllOps()) {
+    if (op->Type() == "elementwise_add") {
+      op->SetAttr("axis", 1);
+    }
+  }
+
+  auto graph = ApplyPass(program);
+  EXPECT_EQ(GetNumOpNodes(graph, "transpose2"), 2);
+  auto* add = GetOps(graph, "elementwise_add")[0];
+  EXPECT_EQ(add->GetAttrIfExists<int>("axis"), 3);
+  EXPECT_EQ(add->Input("Y")[0], "bias");
+}
+
+TEST(LayoutPropagationPass, skip_region) {
+  // A region without conv, or the one needing more transposes than the
+  // layout sensitive ops, is not converted.
+  //
+  // x -> relu -> pool2d -> softmax
+  // y -> conv2d -> relu -> softmax
+  //         |
+  //         +----> softmax
+  Layers layers;
+  auto* x = layers.data("x", {1, 3, 8, 8});
+  auto* relu_out_0 = layers.relu(x);
+  relu_out_0->SetShape({1, 3, 8, 8});
+  auto* pool_out = layers.pool2d(relu_out_0, true);
+  pool_out->SetShape({1, 3, 4, 4});
+  layers.softmax(pool_out, -1);
+
+  auto* y = layers.data("y", {1, 3, 8, 8});
+  auto* conv_out = Conv2d(&layers, y, "filter", {1, 3, 8, 8});
+  auto* relu_out_1 = layers.relu(conv_out);
+  relu_out_1->SetShape({1, 3, 8, 8});
+  layers.softmax(relu_out_1, -1);
+  layers.softmax(conv_out, -1);
+
+  auto graph = ApplyPass(layers.main_program());
+  EXPECT_EQ(GetNumOpNodes(graph, "transpose2"), 0);
+  for (auto* op : GetOps(graph, "pool2d")) {
+    EXPECT_FALSE(op->HasAttr("data_format"));
+  }
+  for (auto* op : GetOps(graph, "conv2d")) {
+    EXPECT_FALSE(op->HasAttr("data_format"));
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(layout_propagation_pass);
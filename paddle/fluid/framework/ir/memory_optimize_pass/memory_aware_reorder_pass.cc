@@ -0,0 +1,203 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/details/computation_op_handle.h"
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/details/var_handle.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Reorder the computation op handles of each device to reduce the peak
+ * memory of the temporary vars, before the memory reuse passes, which
+ * reuse the buffers in the given op order.
+ *
+ * The ops are list scheduled: among the ready ops, the one increasing the
+ * live bytes least is run first, i.e. the one freeing the most inputs and
+ * allocating the least outputs, so that the consumers of a large var run
+ * right after its producer. The ties are broken by the original order.
+ * The order is fixed by the dependency vars between the successive
+ * computation ops of each device, so the computation ops of a device do
+ * not run in parallel any more, like with sequential_execution_pass.
+ *
+ * The bytes of a var are estimated by its shape in the VarDesc, in which
+ * the unknown dimensions, e.g. the batch size, are taken as 1.
+ */
+class MemoryAwareReorderPass : public ir::Pass {
+ protected:
+  void ApplyImpl(ir::Graph *graph) const override {
+    auto all_ops = ir::FilterByNodeWrapper<details::OpHandleBase>(*graph);
+
+    std::unordered_map<details::OpHandleBase *, size_t> pending_deps;
+    std::unordered_map<details::VarHandleBase *, size_t> pending_uses;
+    std::vector<details::OpHandleBase *> ready_ops;
+    // the vars without generated ops, e.g. the feed vars, are live from
+    // the beginning
+    int64_t live_bytes = 0;
+    for (auto *op : all_ops) {
+      size_t deps = op->NotReadyInputSize();
+      pending_deps[op] = deps;
+      if (deps == 0) {
+        ready_ops.push_back(op);
+      }
+      for (auto *in : op->Inputs()) {
+        if (pending_uses.count(in)) continue;
+        pending_uses[in] = in->PendingOps().size();
+        if (in->GeneratedOp() == nullptr) {
+          live_bytes += VarBytes(in);
+        }
+      }
+    }
+
+    std::vector<details::OpHandleBase *> sorted_ops;
+    sorted_ops.reserve(all_ops.size());
+    int64_t peak_bytes = live_bytes;
+    while (!ready_ops.empty()) {
+      size_t best = 0;
+      int64_t best_delta = std::numeric_limits<int64_t>::max();
+      for (size_t i = 0; i < ready_ops.size(); ++i) {
+        int64_t delta = LiveBytesDelta(ready_ops[i], pending_uses);
+        if (delta < best_delta ||
+            (delta == best_delta &&
+             ready_ops[i]->Node()->id() < ready_ops[best]->Node()->id())) {
+          best = i;
+          best_delta = delta;
+        }
+      }
+      auto *op = ready_ops[best];
+      ready_ops.erase(ready_ops.begin() + best);
+      sorted_ops.push_back(op);
+      live_bytes += best_delta;
+      peak_bytes = std::max(peak_bytes, live_bytes);
+
+      // an op may take a var as several inputs
+      std::unordered_set<details::VarHandleBase *> inputs(
+          op->Inputs().begin(), op->Inputs().end());
+      for (auto *in : inputs) {
+        --pending_uses[in];
+      }
+      for (auto *out : op->Outputs()) {
+        for (auto *pending_op : out->PendingOps()) {
+          auto it = pending_deps.find(pending_op);
+          if (it != pending_deps.end() && --it->second == 0) {
+            ready_ops.push_back(pending_op);
+          }
+        }
+      }
+    }
+    PADDLE_ENFORCE_EQ(
+        sorted_ops.size(), all_ops.size(),
+        platform::errors::InvalidArgument(
+            "The graph of memory_aware_reorder_pass has cycles, only %d "
+            "of %d ops are sorted.",
+            sorted_ops.size(), all_ops.size()));
+
+    // Fix the order by the dependency vars. The sorted order is a topology
+    // order, so the new dependencies never make cycles.
+    std::unordered_map<size_t, details::OpHandleBase *> last_ops;
+    size_t dep_num = 0;
+    for (auto *op : sorted_ops) {
+      auto *compute_op = dynamic_cast<details::ComputationOpHandle *>(op);
+      if (compute_op == nullptr) continue;
+      auto &last_op = last_ops[compute_op->GetScopeIdx()];
+      if (last_op != nullptr && !DependsOn(op, last_op)) {
+        auto *dep_var =
+            new details::DummyVarHandle(graph->CreateControlDepVar());
+        graph->Get<details::GraphDepVars>(details::kGraphDepVars)
+            .emplace(dep_var);
+        last_op->AddOutput(dep_var);
+        op->AddInput(dep_var);
+        ++dep_num;
+      }
+      last_op = op;
+    }
+    VLOG(10) << "estimated peak memory of the temporary vars: " << peak_bytes
+             << " bytes, " << dep_num << " dependencies are added";
+  }
+
+ private:
+  static bool DependsOn(details::OpHandleBase *op,
+                        details::OpHandleBase *prev_op) {
+    for (auto *in : op->Inputs()) {
+      if (in->GeneratedOp() == prev_op) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static int64_t VarBytes(const details::VarHandleBase *var) {
+    if (dynamic_cast<const details::VarHandle *>(var) == nullptr) return 0;
+    auto *desc = var->Node()->Var();
+    if (desc == nullptr || desc->Persistable() ||
+        desc->GetType() != proto::VarType::LOD_TENSOR) {
+      return 0;
+    }
+    int64_t numel = 1;
+    for (auto dim : desc->GetShape()) {
+      numel *= std::max<int64_t>(dim, 1);
+    }
+    return numel * static_cast<int64_t>(SizeOfType(desc->GetDataType()));
+  }
+
+  // The change of the live bytes after running op: the outputs used by the
+  // other ops are allocated, and the inputs last used by op are freed. The
+  // new version of an input var reuses its buffer.
+  static int64_t LiveBytesDelta(
+      details::OpHandleBase *op,
+      const std::unordered_map<details::VarHandleBase *, size_t>
+          &pending_uses) {
+    std::unordered_set<std::string> in_names;
+    for (auto *in : op->Inputs()) {
+      in_names.insert(in->Name());
+    }
+    std::unordered_set<std::string> out_names;
+    std::unordered_set<details::VarHandleBase *> freed_vars;
+    int64_t delta = 0;
+    for (auto *out : op->Outputs()) {
+      out_names.insert(out->Name());
+      if (!out->PendingOps().empty() && in_names.count(out->Name()) == 0) {
+        delta += VarBytes(out);
+      }
+    }
+    for (auto *in : op->Inputs()) {
+      if (pending_uses.at(in) == 1 && out_names.count(in->Name()) == 0 &&
+          freed_vars.insert(in).second) {
+        delta -= VarBytes(in);
+      }
+    }
+    return delta;
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(memory_aware_reorder_pass,
+              paddle::framework::ir::MemoryAwareReorderPass);
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/ir/mkldnn/cpu_quantize_pass.h"
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <string>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
@@ -530,6 +533,76 @@ void CPUQuantizePass::QuantizeReshape(Graph* graph) const {
   PrettyLogDetail("---    quantized %d reshape ops", quantize_reshape_count);
 }
 
+void CPUQuantizePass::QuantizeFusionRNN(Graph* graph,
+                                        const std::string& op_type) const {
+  int quantize_count = 0;
+  for (auto* op : graph->Nodes()) {
+    if (!op->IsOp() || op->Op()->Type() != op_type) continue;
+    auto* op_desc = op->Op();
+    // skip if should not be quantized
+    if (!op_desc->GetAttrIfExists<bool>("use_quantizer")) continue;
+
+    Node* input = nullptr;
+    Node* weights = nullptr;
+    for (auto* in : op->inputs) {
+      if (in->Name() == op_desc->Input("X")[0]) input = in;
+      if (in->Name() == op_desc->Input("WeightX")[0]) weights = in;
+    }
+    PADDLE_ENFORCE_NOT_NULL(
+        input, platform::errors::NotFound("The X of %s is not found.",
+                                          op_type));
+    PADDLE_ENFORCE_NOT_NULL(
+        weights, platform::errors::NotFound("The WeightX of %s is not found.",
+                                            op_type));
+    // the weights shared with the other ops can not be quantized in place
+    if (weights->outputs.size() != 1) continue;
+    auto* weights_var = param_scope()->FindVar(weights->Name());
+    PADDLE_ENFORCE_NOT_NULL(
+        weights_var, platform::errors::NotFound(
+                         "The WeightX %s is not in the scope.",
+                         weights->Name()));
+    auto* weights_tensor = weights_var->GetMutable<LoDTensor>();
+    if (weights_tensor->type() != proto::VarType::FP32) continue;
+
+    // X is quantized to int8 by its scale in the kernel
+    auto input_scale = GetScaleValueForNode(input) * S8_MAX;
+    op_desc->SetAttr("Scale_data", static_cast<float>(input_scale));
+
+    auto weights_scale_tensor = GetScaleTensorForNode(weights);
+    std::vector<float> weights_scale(weights_scale_tensor.numel());
+    for (size_t i = 0; i < weights_scale.size(); ++i) {
+      weights_scale[i] =
+          weights_scale_tensor.data<double>()[i] * static_cast<double>(S8_MAX);
+    }
+    const int rows = weights_tensor->dims()[0];
+    const int cols = weights_tensor->numel() / rows;
+    PADDLE_ENFORCE_EQ(weights_scale.size(), static_cast<size_t>(cols),
+                      platform::errors::InvalidArgument(
+                          "The WeightX %s should have %d scales, but got %d.",
+                          weights->Name(), cols, weights_scale.size()));
+    LoDTensor int8_weights;
+    int8_weights.Resize(weights_tensor->dims());
+    auto* int8_data = int8_weights.mutable_data<int8_t>(platform::CPUPlace());
+    const float* data = weights_tensor->data<float>();
+    for (int i = 0; i < rows; ++i) {
+      for (int j = 0; j < cols; ++j) {
+        float value = std::round(data[i * cols + j] * weights_scale[j]);
+        int8_data[i * cols + j] = static_cast<int8_t>(std::min(
+            std::max(value, -static_cast<float>(S8_MAX)),
+            static_cast<float>(S8_MAX)));
+      }
+    }
+    weights_tensor->ShareDataWith(int8_weights);
+    weights->Var()->SetDataType(proto::VarType::INT8);
+    op_desc->SetAttr("Scale_weights", weights_scale);
+
+    ++quantize_count;
+  }
+  AddStatis(quantize_count);
+
+  PrettyLogDetail("---    quantized %d %s ops", quantize_count, op_type);
+}
+
 void CPUQuantizePass::ApplyImpl(ir::Graph* graph) const {
   VLOG(3) << "Quantizing the graph.";
   PADDLE_ENFORCE(graph);
@@ -545,6 +618,8 @@ void CPUQuantizePass::ApplyImpl(ir::Graph* graph) const {
   QuantizeTranspose(graph);
   QuantizeFc(graph);
   QuantizeReshape(graph);
+  QuantizeFusionRNN(graph, "fusion_gru");
+  QuantizeFusionRNN(graph, "fusion_lstm");
 }
 
 }  // namespace ir
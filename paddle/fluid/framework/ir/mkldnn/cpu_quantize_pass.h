@@ -58,6 +58,9 @@ class CPUQuantizePass : public FusePassBase {
 
   void QuantizeReshape(Graph* graph) const;
 
+  // Quantize the WeightX of fusion_gru or fusion_lstm to int8 in place.
+  void QuantizeFusionRNN(Graph* graph, const std::string& op_type) const;
+
   void QuantizeInput(Graph* g, Node* op, Node* input, std::string input_name,
                      double scale_to_one, bool is_unsigned,
                      std::string scale_attr_name = "") const;
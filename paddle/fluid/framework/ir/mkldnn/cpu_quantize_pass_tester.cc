@@ -70,6 +70,14 @@ void SetOp(ProgramDesc* prog, const std::string& type, const std::string& name,
     op->SetInput("X", inputs);
     op->SetOutput("Out", outputs);
     op->SetAttr("use_quantizer", use_quantizer);
+  } else if (type == "fusion_gru") {
+    op->SetInput("X", {inputs[0]});
+    op->SetInput("WeightX", {inputs[1]});
+    op->SetInput("WeightH", {inputs[2]});
+    op->SetOutput("Hidden", {outputs[0]});
+    op->SetAttr("use_quantizer", use_quantizer);
+    op->SetAttr("Scale_data", 1.0f);
+    op->SetAttr("Scale_weights", std::vector<float>{1.0f});
   } else if (type == "dequantize") {
     op->SetInput("Input", {inputs[0]});
     op->SetOutput("Output", {outputs[0]});
@@ -513,6 +521,63 @@ TEST(CPUQuantizePass, check_scales) {
   MainTestCheckScales(BuildProgramDescCheckScalesConv(), var_names, "a");
 }
 
+// (a, wx, wh)->FusionGru->h
+TEST(CpuQuantizePass, fusion_gru) {
+  ProgramDesc prog;
+  for (auto& v : {"a", "wx", "wh", "h"}) {
+    prog.MutableBlock(0)->Var(v)->SetPersistable(v[0] == 'w');
+  }
+  SetOp(&prog, "fusion_gru", "FusionGru", {"a", "wx", "wh"}, {"h"}, false,
+        true);
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto place = paddle::platform::CPUPlace();
+  Scope scope;
+  auto* wx = scope.Var("wx")->GetMutable<LoDTensor>();
+  wx->Resize({2, 3});
+  float* wx_data = wx->mutable_data<float>(place);
+  const std::vector<float> wx_values{0.5f, -1.f, 0.25f, -0.5f, 2.f, 1.f};
+  std::copy(wx_values.begin(), wx_values.end(), wx_data);
+
+  auto* scales = new VarQuantScale();
+  LoDTensor a_scale;
+  a_scale.Resize({1});
+  a_scale.mutable_data<double>(place)[0] = 0.5;
+  (*scales)["a"] = std::make_pair(false, std::move(a_scale));
+  // the scales of the columns are 1 / max(abs(column))
+  LoDTensor wx_scale;
+  wx_scale.Resize({3});
+  auto* wx_scale_data = wx_scale.mutable_data<double>(place);
+  wx_scale_data[0] = 2.0;
+  wx_scale_data[1] = 0.5;
+  wx_scale_data[2] = 1.0;
+  (*scales)["wx"] = std::make_pair(false, std::move(wx_scale));
+
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("cpu_quantize_pass");
+  pass->Set("quant_var_scales", scales);
+  graph.reset(pass->Apply(graph.release()));
+
+  ASSERT_EQ(wx->type(), proto::VarType::INT8);
+  const std::vector<int8_t> expected{127, -64, 32, -127, 127, 127};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(wx->data<int8_t>()[i], expected[i]);
+  }
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fusion_gru") {
+      auto* op = node->Op();
+      EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("Scale_data")), 63.5f);
+      auto w_scales =
+          boost::get<std::vector<float>>(op->GetAttr("Scale_weights"));
+      ASSERT_EQ(w_scales.size(), 3UL);
+      EXPECT_FLOAT_EQ(w_scales[1], 63.5f);
+    }
+    if (node->IsVar() && node->Name() == "wx") {
+      EXPECT_EQ(node->Var()->GetDataType(), proto::VarType::INT8);
+    }
+  }
+}
+
 }  // namespace
 
 }  // namespace ir
@@ -0,0 +1,117 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Set the critical path length of each op handle, which is the largest
+ * total cost of the ops on a path from the op to the end of the graph, so
+ * that the executors start the ops delaying the end of the step most first.
+ *
+ * The costs are taken from the kOpCosts attribute by the names of the op
+ * handles if it is set, e.g. measured by the profiler. Otherwise a
+ * computation op costs 1, and an op transferring data among devices, e.g.
+ * all_reduce, costs kDefaultTransferCost for its long latency.
+ */
+class CriticalPathPriorityPass : public ir::Pass {
+ protected:
+  static constexpr double kDefaultTransferCost = 10;
+
+  void ApplyImpl(ir::Graph *graph) const override {
+    const details::OpCosts *op_costs =
+        Has(details::kOpCosts) ? &Get<details::OpCosts>(details::kOpCosts)
+                               : nullptr;
+
+    auto all_ops = ir::FilterByNodeWrapper<details::OpHandleBase>(*graph);
+    // topology sort the op handles by the vars they generate
+    std::unordered_map<details::OpHandleBase *, size_t> pending_deps;
+    std::vector<details::OpHandleBase *> sorted_ops;
+    sorted_ops.reserve(all_ops.size());
+    for (auto *op : all_ops) {
+      size_t deps = op->NotReadyInputSize();
+      pending_deps[op] = deps;
+      if (deps == 0) {
+        sorted_ops.push_back(op);
+      }
+    }
+    for (size_t i = 0; i < sorted_ops.size(); ++i) {
+      for (auto *out : sorted_ops[i]->Outputs()) {
+        for (auto *pending_op : out->PendingOps()) {
+          auto it = pending_deps.find(pending_op);
+          if (it != pending_deps.end() && --it->second == 0) {
+            sorted_ops.push_back(pending_op);
+          }
+        }
+      }
+    }
+    PADDLE_ENFORCE_EQ(
+        sorted_ops.size(), all_ops.size(),
+        platform::errors::InvalidArgument(
+            "The graph of critical_path_priority_pass has cycles, only %d "
+            "of %d ops are sorted.",
+            sorted_ops.size(), all_ops.size()));
+
+    size_t measured_num = 0;
+    double max_length = 0;
+    for (auto it = sorted_ops.rbegin(); it != sorted_ops.rend(); ++it) {
+      auto *op = *it;
+      double cost = op->IsMultiDeviceTransfer() ? kDefaultTransferCost : 1;
+      if (op_costs != nullptr) {
+        auto cost_it = op_costs->find(op->Name());
+        if (cost_it != op_costs->end()) {
+          cost = cost_it->second;
+          ++measured_num;
+        }
+      }
+      double successor_length = 0;
+      for (auto *out : op->Outputs()) {
+        for (auto *pending_op : out->PendingOps()) {
+          successor_length =
+              std::max(successor_length, pending_op->CriticalPathLength());
+        }
+      }
+      op->SetCriticalPathLength(cost + successor_length);
+      max_length = std::max(max_length, op->CriticalPathLength());
+    }
+
+    VLOG(10) << "critical path length: " << max_length << ", "
+             << measured_num << " of " << sorted_ops.size()
+             << " ops use the measured costs";
+    if (!graph->Has(details::kCriticalPathPriority)) {
+      graph->Set(details::kCriticalPathPriority, new bool(true));
+    }
+  }
+};
+
+constexpr double CriticalPathPriorityPass::kDefaultTransferCost;
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(critical_path_priority_pass,
+              paddle::framework::ir::CriticalPathPriorityPass);
@@ -458,6 +458,16 @@ void MultiDevSSAGraphBuilderBase::CreateAllReduceOp(ir::Graph *result,
               result->CreateEmptyNode("allreduce", ir::Node::Type::kOperation),
               scopes, places, multi_nccl_ctxs_, is_encoded,
               strategy_.num_trainers_ * places_.size()));
+    } else if (IsSparsified(og)) {
+      details::GradSparsifyConfig config;
+      config.sparsity = strategy_.grad_sparsity_;
+      config.rampup_begin_step = strategy_.grad_sparsify_rampup_begin_step_;
+      config.rampup_step = strategy_.grad_sparsify_rampup_step_;
+      result->Get<GraphOps>(kGraphOps).emplace_back(
+          new details::SparseAllReduceOpHandle(
+              result->CreateEmptyNode("allreduce", ir::Node::Type::kOperation),
+              scopes, places, multi_nccl_ctxs_, config,
+              strategy_.num_trainers_ * places_.size()));
     } else {
       result->Get<GraphOps>(kGraphOps).emplace_back(
           new details::AllReduceOpHandle(
@@ -582,6 +592,31 @@ bool MultiDevSSAGraphBuilderBase::IsSparseGradient(
   return all_vars_.at(og)->GetType() == proto::VarType::SELECTED_ROWS;
 }
 
+bool MultiDevSSAGraphBuilderBase::IsSparsified(const std::string &og) const {
+#if defined(PADDLE_WITH_DGC) && defined(PADDLE_WITH_NCCL)
+  if (!strategy_.sparsify_grad_ ||
+      strategy_.num_trainers_ * places_.size() <= 1) {
+    return false;
+  }
+  auto it = all_vars_.find(og);
+  if (it == all_vars_.end() ||
+      it->second->GetType() != proto::VarType::LOD_TENSOR ||
+      it->second->GetDataType() != proto::VarType::FP32) {
+    return false;
+  }
+  int64_t numel = 1;
+  for (auto dim : it->second->GetShape()) {
+    if (dim < 0) {
+      return false;
+    }
+    numel *= dim;
+  }
+  return numel >= strategy_.grad_sparsify_min_numel_;
+#else
+  return false;
+#endif
+}
+
 void AllReduceSSAGraphBuilder::InsertCollectiveOp(
     ir::Graph *result, const std::string &p_name,
     const std::string &g_name) const {
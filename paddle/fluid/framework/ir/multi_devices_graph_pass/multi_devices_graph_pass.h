@@ -76,6 +76,9 @@ class MultiDevSSAGraphBuilderBase : public ir::Pass {
 
   bool IsSparseGradient(const std::string &og) const;
 
+  // whether og is sparsified in all reduce, see BuildStrategy::sparsify_grad_
+  bool IsSparsified(const std::string &og) const;
+
   void CreateAllReduceOp(ir::Graph *result, const std::string &og,
                          bool is_encoded = false) const;
 
@@ -38,6 +38,8 @@ Graph* Pass::Apply(Graph* graph) const {
                           "Required atrribute %s for graph is not set.", attr));
   }
   ApplyImpl(graph);
+  // The ops may be retyped in place by the pass.
+  graph->InvalidateOpTypeIndex();
   // TODO(panyx0718): Add more verifications.
   PADDLE_ENFORCE(!HasCircle(*graph),
                  "Illegal Pass %s. Generated graph shouldn't have cycle.",
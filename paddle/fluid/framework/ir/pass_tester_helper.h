@@ -46,7 +46,7 @@ struct Layers {
     op->SetInput("Input", {input->Name()});
     op->SetInput("Filter", {filter->Name()});
     op->SetInput("Bias", {bias->Name()});
-    op->SetOutput("Out", {out->Name()});
+    op->SetOutput("Output", {out->Name()});
     op->SetAttr("use_cudnn", use_cudnn);
     op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
                 static_cast<int>(OpRole::kForward));
@@ -60,7 +60,7 @@ struct Layers {
     op->SetInput("Input", {input->Name()});
     op->SetInput("Filter", {filter->Name()});
     op->SetInput("Bias", {bias->Name()});
-    op->SetOutput("Out", {out->Name()});
+    op->SetOutput("Output", {out->Name()});
     op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
                 static_cast<int>(OpRole::kForward));
     return out;
@@ -74,7 +74,7 @@ struct Layers {
     op->SetInput("Input", {input->Name()});
     op->SetInput("Filter", {filter->Name()});
     op->SetInput("Bias", {bias->Name()});
-    op->SetOutput("Out", {out->Name()});
+    op->SetOutput("Output", {out->Name()});
     op->SetAttr("use_cudnn", use_cudnn);
     op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
                 static_cast<int>(OpRole::kForward));
@@ -288,6 +288,19 @@ struct Layers {
     return out;
   }
 
+  VarDesc* reduce_mean(VarDesc* x, std::vector<int> dim,
+                       bool keep_dim = false) {
+    VarDesc* out = lod_tensor(unique_name());
+    OpDesc* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType("reduce_mean");
+    op->SetInput("X", {x->Name()});
+    op->SetAttr("dim", dim);
+    op->SetAttr("keep_dim", keep_dim);
+    op->SetAttr("reduce_all", false);
+    op->SetOutput("Out", {out->Name()});
+    return out;
+  }
+
   VarDesc* scale(VarDesc* x, float scale, float bias, bool bias_after) {
     VarDesc* out = lod_tensor(unique_name());
     OpDesc* op = program_.MutableBlock(0)->AppendOp();
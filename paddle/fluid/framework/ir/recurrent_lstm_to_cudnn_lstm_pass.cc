@@ -0,0 +1,380 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/recurrent_lstm_to_cudnn_lstm_pass.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+struct LSTMCell {
+  std::string x;
+  std::string h_pre;
+  std::string c_pre;
+  std::string w;
+  std::string b;
+  std::string h;
+  std::string c;
+  float forget_bias{0};
+  // the rnn_memory_helper ops copying the variables to the states and the
+  // step outputs, by their inputs
+  std::unordered_map<std::string, std::vector<std::string>> copies;
+};
+
+const OpDesc* FindOnly(const std::vector<OpDesc*>& ops,
+                       const std::string& type) {
+  const OpDesc* found = nullptr;
+  for (auto* op : ops) {
+    if (op->Type() == type) {
+      if (found) return nullptr;
+      found = op;
+    }
+  }
+  return found;
+}
+
+bool OneName(const std::vector<std::string>& names, std::string* name) {
+  if (names.size() != 1) return false;
+  *name = names[0];
+  return true;
+}
+
+// Matches the step block built by fluid.layers.lstm_unit in a StaticRNN.
+bool MatchLSTMCell(const BlockDesc& block, LSTMCell* cell) {
+  auto ops = block.AllOps();
+  for (auto* op : ops) {
+    auto type = op->Type();
+    if (type != "concat" && type != "mul" && type != "elementwise_add" &&
+        type != "lstm_unit" && type != "rnn_memory_helper") {
+      return false;
+    }
+  }
+  auto* concat = FindOnly(ops, "concat");
+  auto* mul = FindOnly(ops, "mul");
+  auto* add = FindOnly(ops, "elementwise_add");
+  auto* lstm_unit = FindOnly(ops, "lstm_unit");
+  if (!concat || !mul || !add || !lstm_unit) return false;
+
+  auto concat_inputs = concat->Input("X");
+  if (concat_inputs.size() != 2 || concat->Input("AxisTensor").size() > 0 ||
+      boost::get<int>(concat->GetAttr("axis")) != 1) {
+    return false;
+  }
+  cell->x = concat_inputs[0];
+  cell->h_pre = concat_inputs[1];
+
+  std::string concat_out, mul_x, mul_out, add_x, gates, lstm_x;
+  if (!OneName(concat->Output("Out"), &concat_out) ||
+      !OneName(mul->Input("X"), &mul_x) || mul_x != concat_out ||
+      !OneName(mul->Input("Y"), &cell->w) ||
+      !OneName(mul->Output("Out"), &mul_out) ||
+      boost::get<int>(mul->GetAttr("x_num_col_dims")) != 1 ||
+      boost::get<int>(mul->GetAttr("y_num_col_dims")) != 1) {
+    return false;
+  }
+  int axis = boost::get<int>(add->GetAttr("axis"));
+  if (!OneName(add->Input("X"), &add_x) || add_x != mul_out ||
+      !OneName(add->Input("Y"), &cell->b) ||
+      !OneName(add->Output("Out"), &gates) || (axis != -1 && axis != 1)) {
+    return false;
+  }
+  if (!OneName(lstm_unit->Input("X"), &lstm_x) || lstm_x != gates ||
+      !OneName(lstm_unit->Input("C_prev"), &cell->c_pre) ||
+      !OneName(lstm_unit->Output("H"), &cell->h) ||
+      !OneName(lstm_unit->Output("C"), &cell->c)) {
+    return false;
+  }
+  cell->forget_bias = boost::get<float>(lstm_unit->GetAttr("forget_bias"));
+
+  // The intermediate variables should not be read by the other ops.
+  for (auto* op : ops) {
+    if (op->Type() != "rnn_memory_helper") continue;
+    std::string in, out;
+    if (!OneName(op->Input("X"), &in) || !OneName(op->Output("Out"), &out) ||
+        (in != cell->h && in != cell->c)) {
+      return false;
+    }
+    cell->copies[in].push_back(out);
+  }
+  return true;
+}
+
+bool IsCopyOf(const LSTMCell& cell, const std::string& var,
+              const std::string& name) {
+  auto it = cell.copies.find(var);
+  return it != cell.copies.end() &&
+         std::count(it->second.begin(), it->second.end(), name) == 1;
+}
+
+Node* FindInput(Node* op, const std::string& name) {
+  for (auto* in : op->inputs) {
+    if (in->IsVar() && in->Name() == name) return in;
+  }
+  return nullptr;
+}
+
+Node* CreateVar(Graph* graph, const std::string& name,
+                const std::vector<int64_t>& shape, bool persistable,
+                proto::VarType::Type type = proto::VarType::LOD_TENSOR) {
+  VarDesc desc(name);
+  desc.SetType(type);
+  if (type == proto::VarType::LOD_TENSOR) {
+    desc.SetDataType(proto::VarType::FP32);
+    desc.SetShape(shape);
+  }
+  desc.SetPersistable(persistable);
+  return graph->CreateVarNode(&desc);
+}
+
+// Unsqueezes the state of [batch, hidden] to [1, batch, hidden].
+Node* Unsqueeze(Graph* graph, Node* state) {
+  auto shape = state->Var()->GetShape();
+  std::vector<int64_t> out_shape{1};
+  out_shape.insert(out_shape.end(), shape.begin(), shape.end());
+  std::vector<int64_t> xshape{0};
+  xshape.insert(xshape.end(), shape.begin(), shape.end());
+  auto* out = CreateVar(graph, state->Name() + ".unsqueezed", out_shape, false);
+  auto* xshape_var =
+      CreateVar(graph, state->Name() + ".unsqueezed_xshape", xshape, false);
+
+  OpDesc desc;
+  desc.SetType("unsqueeze2");
+  desc.SetInput("X", {state->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetOutput("XShape", {xshape_var->Name()});
+  desc.SetAttr("axes", std::vector<int>({0}));
+  auto* op = graph->CreateOpNode(&desc);
+  IR_NODE_LINK_TO(state, op);
+  IR_NODE_LINK_TO(op, out);
+  IR_NODE_LINK_TO(op, xshape_var);
+  return out;
+}
+
+// Packs the weight [input + hidden, 4 * hidden] and the bias [4 * hidden]
+// of the gates i, f, o, g of lstm_unit into the weight of cudnn, which
+// holds the input weights and the hidden weights of the gates i, f, g, o,
+// each of [hidden, input] or [hidden, hidden], and then the input biases
+// and the hidden biases of them. The forget bias is added to the input
+// bias of f.
+void PackCudnnLSTMWeight(const LoDTensor& w, const LoDTensor& b,
+                         float forget_bias, int input_size, int hidden_size,
+                         LoDTensor* packed) {
+  const int gate_of_cudnn[4] = {0, 1, 3, 2};
+  const int64_t H = hidden_size, I = input_size;
+  packed->Resize({4 * H * I + 4 * H * H + 8 * H});
+  auto* out = packed->mutable_data<float>(platform::CPUPlace());
+  const float* w_data = w.data<float>();
+  const float* b_data = b.data<float>();
+  for (int k = 0; k < 4; ++k) {
+    int64_t col = gate_of_cudnn[k] * H;
+    for (int64_t j = 0; j < H; ++j) {
+      for (int64_t i = 0; i < I; ++i) {
+        out[(k * H + j) * I + i] = w_data[i * 4 * H + col + j];
+      }
+    }
+  }
+  out += 4 * H * I;
+  for (int k = 0; k < 4; ++k) {
+    int64_t col = gate_of_cudnn[k] * H;
+    for (int64_t j = 0; j < H; ++j) {
+      for (int64_t i = 0; i < H; ++i) {
+        out[(k * H + j) * H + i] = w_data[(I + i) * 4 * H + col + j];
+      }
+    }
+  }
+  out += 4 * H * H;
+  for (int k = 0; k < 4; ++k) {
+    int64_t col = gate_of_cudnn[k] * H;
+    for (int64_t j = 0; j < H; ++j) {
+      out[k * H + j] = b_data[col + j] + (k == 1 ? forget_bias : 0.f);
+    }
+  }
+  std::fill(out + 4 * H, out + 8 * H, 0.f);
+}
+
+}  // namespace
+
+void RecurrentLSTMToCudnnLSTMPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+  if (!graph->Has(kParamScopeAttr)) {
+    VLOG(3) << "Skip recurrent_lstm_to_cudnn_lstm_pass without the param scope";
+    return;
+  }
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op() && node->Op()->Type() == "recurrent_grad") {
+      VLOG(3) << "Skip recurrent_lstm_to_cudnn_lstm_pass for training";
+      return;
+    }
+  }
+  auto* scope = param_scope();
+
+  std::vector<Node*> recurrent_ops;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op() && node->Op()->Type() == "recurrent") {
+      recurrent_ops.push_back(node);
+    }
+  }
+
+  int found_count = 0;
+  for (auto* node : recurrent_ops) {
+    auto* op = node->Op();
+    auto* block = boost::get<BlockDesc*>(op->GetAttr("sub_block"));
+    LSTMCell cell;
+    if (!block || boost::get<bool>(op->GetAttr("reverse")) ||
+        !MatchLSTMCell(*block, &cell)) {
+      continue;
+    }
+
+    // the memories are h and c, and the step output is h
+    auto ex_states = boost::get<std::vector<std::string>>(
+        op->GetAttr("ex_states"));
+    auto states = boost::get<std::vector<std::string>>(op->GetAttr("states"));
+    auto initial_states = op->Input("initial_states");
+    auto outputs = op->Output("outputs");
+    auto inputs = op->Input("inputs");
+    if (ex_states.size() != 2 || states.size() != 2 ||
+        initial_states.size() != 2 || outputs.size() != 1 ||
+        inputs.size() != 1 || inputs[0] != cell.x) {
+      continue;
+    }
+    int h_index = ex_states[0] == cell.h_pre ? 0 : 1;
+    int c_index = 1 - h_index;
+    if (ex_states[h_index] != cell.h_pre || ex_states[c_index] != cell.c_pre ||
+        !IsCopyOf(cell, cell.h, states[h_index]) ||
+        !IsCopyOf(cell, cell.c, states[c_index]) ||
+        !IsCopyOf(cell, cell.h, outputs[0])) {
+      continue;
+    }
+
+    auto* x = FindInput(node, cell.x);
+    auto* h0 = FindInput(node, initial_states[h_index]);
+    auto* c0 = FindInput(node, initial_states[c_index]);
+    auto* w = FindInput(node, cell.w);
+    auto* b = FindInput(node, cell.b);
+    Node* out = nullptr;
+    Node* step_scopes = nullptr;
+    for (auto* var : node->outputs) {
+      if (var->Name() == outputs[0]) out = var;
+      if (var->Var() &&
+          var->Var()->GetType() == proto::VarType::STEP_SCOPES) {
+        step_scopes = var;
+      }
+    }
+    if (!x || !h0 || !c0 || !w || !b || !out || !x->Var() || !h0->Var() ||
+        !c0->Var()) {
+      continue;
+    }
+    auto* w_var = scope->FindVar(cell.w);
+    auto* b_var = scope->FindVar(cell.b);
+    if (!w_var || !b_var || !w_var->IsType<LoDTensor>() ||
+        !b_var->IsType<LoDTensor>()) {
+      continue;
+    }
+    auto& w_tensor = w_var->Get<LoDTensor>();
+    auto& b_tensor = b_var->Get<LoDTensor>();
+    auto x_shape = x->Var()->GetShape();
+    if (!w_tensor.IsInitialized() || !b_tensor.IsInitialized() ||
+        w_tensor.type() != proto::VarType::FP32 ||
+        b_tensor.type() != proto::VarType::FP32 ||
+        w_tensor.dims().size() != 2 || w_tensor.dims()[1] % 4 != 0 ||
+        x_shape.size() != 3 || x_shape[0] <= 0) {
+      continue;
+    }
+    int hidden_size = w_tensor.dims()[1] / 4;
+    int input_size = w_tensor.dims()[0] - hidden_size;
+    if (input_size <= 0 || b_tensor.numel() != 4 * hidden_size ||
+        (x_shape[2] > 0 && x_shape[2] != input_size)) {
+      continue;
+    }
+    VLOG(3) << "Replace the recurrent op of the LSTM cell of input size "
+            << input_size << " and hidden size " << hidden_size
+            << " by cudnn_lstm";
+
+    auto packed_name = cell.w + ".cudnn_lstm";
+    if (!scope->FindVar(packed_name)) {
+      PackCudnnLSTMWeight(w_tensor, b_tensor, cell.forget_bias, input_size,
+                          hidden_size,
+                          scope->Var(packed_name)->GetMutable<LoDTensor>());
+    }
+    auto* packed = CreateVar(
+        graph, packed_name,
+        {scope->FindVar(packed_name)->Get<LoDTensor>().numel()}, true);
+    // the RAW cache of the cudnn descriptors is created by cudnn_lstm
+    auto* cache = CreateVar(graph, out->Name() + ".cudnn_lstm_cache", {}, true,
+                            proto::VarType::RAW);
+    auto* init_h = Unsqueeze(graph, h0);
+    auto* init_c = Unsqueeze(graph, c0);
+    auto state_shape = init_h->Var()->GetShape();
+    auto* last_h =
+        CreateVar(graph, out->Name() + ".last_h", state_shape, false);
+    auto* last_c =
+        CreateVar(graph, out->Name() + ".last_c", state_shape, false);
+
+    OpDesc desc;
+    desc.SetType("cudnn_lstm");
+    desc.SetInput("Input", {x->Name()});
+    desc.SetInput("InitH", {init_h->Name()});
+    desc.SetInput("InitC", {init_c->Name()});
+    desc.SetInput("W", {packed->Name()});
+    desc.SetInput("Cache", {cache->Name()});
+    desc.SetOutput("Out", {out->Name()});
+    desc.SetOutput("last_h", {last_h->Name()});
+    desc.SetOutput("last_c", {last_c->Name()});
+    desc.SetAttr("max_len", static_cast<int>(x_shape[0]));
+    desc.SetAttr("dropout_prob", 0.0f);
+    desc.SetAttr("is_bidirec", false);
+    desc.SetAttr("input_size", input_size);
+    desc.SetAttr("hidden_size", hidden_size);
+    desc.SetAttr("num_layers", 1);
+    desc.SetAttr("is_test", true);
+    desc.SetAttr("seed", -1);
+    auto* lstm = graph->CreateOpNode(&desc);
+    IR_NODE_LINK_TO(x, lstm);
+    IR_NODE_LINK_TO(init_h, lstm);
+    IR_NODE_LINK_TO(init_c, lstm);
+    IR_NODE_LINK_TO(packed, lstm);
+    IR_NODE_LINK_TO(cache, lstm);
+    IR_NODE_LINK_TO(lstm, out);
+    IR_NODE_LINK_TO(lstm, last_h);
+    IR_NODE_LINK_TO(lstm, last_c);
+
+    // the parameters of the cell are left in the scope, which may be used
+    // by the other sub-blocks
+    std::unordered_set<const Node*> removed_nodes{node};
+    if (step_scopes) removed_nodes.insert(step_scopes);
+    for (auto* param : {w, b}) {
+      if (param->outputs.size() == 1) removed_nodes.insert(param);
+    }
+    GraphSafeRemoveNodes(graph, removed_nodes);
+    ++found_count;
+  }
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(recurrent_lstm_to_cudnn_lstm_pass,
+              paddle::framework::ir::RecurrentLSTMToCudnnLSTMPass);
@@ -0,0 +1,51 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Replace the recurrent op of a StaticRNN whose step block is the LSTM cell
+ * of fluid.layers.lstm_unit,
+ *
+ *   concat([x_t, h_pre], axis=1) -> mul(W) -> elementwise_add(b)
+ *       -> lstm_unit(c_pre) -> (h, c)
+ *
+ * with h and c as the memories and h as the only step output, by one
+ * cudnn_lstm op running all the steps. W and b are packed into the weight
+ * of cudnn_lstm in the param scope, and the initial states are unsqueezed
+ * to [1, batch, hidden]. Only the inference programs are rewritten, since
+ * the recurrent_grad ops are run by the step scopes of the recurrent op.
+ * The sequence length of the input should be known, which is the max_len
+ * of cudnn_lstm, and its batch size should not change between the runs,
+ * since cudnn_lstm caches the descriptors of the first run.
+ */
+class RecurrentLSTMToCudnnLSTMPass : public FusePassBase {
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  const std::string name_scope_{"recurrent_lstm_to_cudnn_lstm"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,201 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/recurrent_lstm_to_cudnn_lstm_pass.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void AddVar(BlockDesc* block, const std::string& name,
+                   const std::vector<int64_t>& shape, bool persistable = false,
+                   proto::VarType::Type type = proto::VarType::LOD_TENSOR) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  if (type == proto::VarType::LOD_TENSOR) {
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape(shape);
+  }
+  var->SetPersistable(persistable);
+}
+
+static OpDesc* AddOp(
+    BlockDesc* block, const std::string& type,
+    const std::map<std::string, std::vector<std::string>>& inputs,
+    const std::map<std::string, std::vector<std::string>>& outputs) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) op->SetInput(input.first, input.second);
+  for (auto& output : outputs) op->SetOutput(output.first, output.second);
+  return op;
+}
+
+// Builds the program of a StaticRNN of the LSTM cell of lstm_unit:
+//
+//   rnn = fluid.layers.StaticRNN()
+//   with rnn.step():
+//     x_t = rnn.step_input(x)
+//     h_pre = rnn.memory(init=h0)
+//     c_pre = rnn.memory(init=c0)
+//     gates = fc(concat([x_t, h_pre], axis=1), 4 * H)
+//     h, c = lstm_unit(gates, c_pre)
+//     rnn.update_memory(h_pre, h)
+//     rnn.update_memory(c_pre, c)
+//     rnn.step_output(h)
+static ProgramDesc BuildProgram(int seq_len, int batch, int input_size,
+                                int hidden_size, bool reverse) {
+  ProgramDesc program;
+  auto* main = program.MutableBlock(0);
+  auto* step = program.AppendBlock(*main);
+  int64_t I = input_size, H = hidden_size;
+  AddVar(main, "x", {seq_len, batch, I});
+  AddVar(main, "h0", {batch, H});
+  AddVar(main, "c0", {batch, H});
+  AddVar(main, "w", {I + H, 4 * H}, true);
+  AddVar(main, "b", {4 * H}, true);
+  AddVar(main, "out", {seq_len, batch, H});
+  AddVar(main, "step_scopes", {}, false, proto::VarType::STEP_SCOPES);
+
+  AddVar(step, "x_t", {batch, I});
+  AddVar(step, "h_pre", {batch, H});
+  AddVar(step, "c_pre", {batch, H});
+  AddVar(step, "cat", {batch, I + H});
+  AddVar(step, "mul_out", {batch, 4 * H});
+  AddVar(step, "gates", {batch, 4 * H});
+  AddVar(step, "h", {batch, H});
+  AddVar(step, "c", {batch, H});
+  AddVar(step, "h_state", {batch, H});
+  AddVar(step, "c_state", {batch, H});
+  AddVar(step, "h_out", {batch, H});
+  AddOp(step, "concat", {{"X", {"x_t", "h_pre"}}}, {{"Out", {"cat"}}})
+      ->SetAttr("axis", 1);
+  auto* mul = AddOp(step, "mul", {{"X", {"cat"}}, {"Y", {"w"}}},
+                    {{"Out", {"mul_out"}}});
+  mul->SetAttr("x_num_col_dims", 1);
+  mul->SetAttr("y_num_col_dims", 1);
+  AddOp(step, "elementwise_add", {{"X", {"mul_out"}}, {"Y", {"b"}}},
+        {{"Out", {"gates"}}})
+      ->SetAttr("axis", 1);
+  AddOp(step, "lstm_unit", {{"X", {"gates"}}, {"C_prev", {"c_pre"}}},
+        {{"H", {"h"}}, {"C", {"c"}}})
+      ->SetAttr("forget_bias", 1.0f);
+  AddOp(step, "rnn_memory_helper", {{"X", {"h"}}}, {{"Out", {"h_state"}}});
+  AddOp(step, "rnn_memory_helper", {{"X", {"c"}}}, {{"Out", {"c_state"}}});
+  AddOp(step, "rnn_memory_helper", {{"X", {"h"}}}, {{"Out", {"h_out"}}});
+
+  auto* recurrent =
+      AddOp(main, "recurrent",
+            {{"inputs", {"x"}},
+             {"initial_states", {"h0", "c0"}},
+             {"parameters", {"w", "b"}}},
+            {{"outputs", {"out"}}, {"step_scopes", {"step_scopes"}}});
+  recurrent->SetAttr("ex_states",
+                     std::vector<std::string>({"h_pre", "c_pre"}));
+  recurrent->SetAttr("states",
+                     std::vector<std::string>({"h_state", "c_state"}));
+  recurrent->SetAttr("reverse", reverse);
+  recurrent->SetAttr("is_train", false);
+  recurrent->SetAttr("has_states", true);
+  recurrent->SetBlockAttr("sub_block", step);
+  return program;
+}
+
+static void InitParams(Scope* scope, int input_size, int hidden_size) {
+  auto* w = scope->Var("w")->GetMutable<LoDTensor>();
+  w->Resize({input_size + hidden_size, 4 * hidden_size});
+  auto* w_data = w->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < w->numel(); ++i) {
+    w_data[i] = static_cast<float>(i);
+  }
+  auto* b = scope->Var("b")->GetMutable<LoDTensor>();
+  b->Resize({4 * hidden_size});
+  auto* b_data = b->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < b->numel(); ++i) {
+    b_data[i] = static_cast<float>(i);
+  }
+}
+
+TEST(RecurrentLSTMToCudnnLSTMPass, replace) {
+  const int I = 3, H = 2;
+  Scope scope;
+  InitParams(&scope, I, H);
+  std::unique_ptr<Graph> graph(new Graph(BuildProgram(5, 4, I, H, false)));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass =
+      PassRegistry::Instance().Get("recurrent_lstm_to_cudnn_lstm_pass");
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+
+  EXPECT_EQ(GetNumOpNodes(graph, "recurrent"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "cudnn_lstm"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "unsqueeze2"), 2);
+  for (auto* node : graph->Nodes()) {
+    EXPECT_NE(node->Name(), "step_scopes");
+    if (node->IsOp() && node->Op()->Type() == "cudnn_lstm") {
+      auto* op = node->Op();
+      EXPECT_EQ(op->Input("Input"), std::vector<std::string>({"x"}));
+      EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"out"}));
+      EXPECT_EQ(boost::get<int>(op->GetAttr("max_len")), 5);
+      EXPECT_EQ(boost::get<int>(op->GetAttr("input_size")), I);
+      EXPECT_EQ(boost::get<int>(op->GetAttr("hidden_size")), H);
+      EXPECT_TRUE(boost::get<bool>(op->GetAttr("is_test")));
+    }
+  }
+
+  // the gates i, f, o, g of lstm_unit are packed as i, f, g, o
+  auto* packed_var = scope.FindVar("w.cudnn_lstm");
+  ASSERT_NE(packed_var, nullptr);
+  auto& packed = packed_var->Get<LoDTensor>();
+  ASSERT_EQ(packed.numel(), 4 * H * I + 4 * H * H + 8 * H);
+  const float* data = packed.data<float>();
+  const int gate_of_cudnn[4] = {0, 1, 3, 2};
+  for (int k = 0; k < 4; ++k) {
+    for (int j = 0; j < H; ++j) {
+      int col = gate_of_cudnn[k] * H + j;
+      for (int i = 0; i < I; ++i) {
+        EXPECT_EQ(data[(k * H + j) * I + i], i * 4 * H + col);
+      }
+      for (int i = 0; i < H; ++i) {
+        EXPECT_EQ(data[4 * H * I + (k * H + j) * H + i],
+                  (I + i) * 4 * H + col);
+      }
+      float forget_bias = k == 1 ? 1.0f : 0.0f;
+      EXPECT_EQ(data[4 * H * I + 4 * H * H + k * H + j], col + forget_bias);
+      EXPECT_EQ(data[4 * H * I + 4 * H * H + 4 * H + k * H + j], 0.0f);
+    }
+  }
+}
+
+TEST(RecurrentLSTMToCudnnLSTMPass, not_replace_reverse) {
+  Scope scope;
+  InitParams(&scope, 3, 2);
+  std::unique_ptr<Graph> graph(new Graph(BuildProgram(5, 4, 3, 2, true)));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass =
+      PassRegistry::Instance().Get("recurrent_lstm_to_cudnn_lstm_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "recurrent"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "cudnn_lstm"), 0);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(recurrent_lstm_to_cudnn_lstm_pass);
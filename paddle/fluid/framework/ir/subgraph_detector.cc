@@ -102,6 +102,11 @@ inline void MarkOutLinksInSubGraph(const Node *func) {
 }
 
 void SubgraphDetector::MarkNodesInsideSubGraph() {
+  // Clear the marks left by a previous detection on the same graph, e.g. the
+  // one of a different type of fusion groups.
+  for (auto *node : graph_->Nodes()) {
+    Agent(node).set_marked(false);
+  }
   for (auto &node : framework::ir::GraphTraits::DFS(*graph_)) {
     if (node_inside_subgraph_teller_(&node)) {
       Agent(&node).set_marked(true);
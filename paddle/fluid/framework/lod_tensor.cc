@@ -15,7 +15,13 @@ limitations under the License. */
 #include <stdint.h>
 #include <string.h>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <iterator>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/framework.pb.h"
@@ -271,6 +277,49 @@ void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
   TensorFromStream(is, static_cast<Tensor *>(tensor), dev_ctx, seek, shape);
 }
 
+void DeserializeFromMemory(const std::shared_ptr<memory::Allocation> &buffer,
+                           size_t *offset, LoDTensor *tensor) {
+  auto read = [&](void *dst, size_t size) {
+    PADDLE_ENFORCE_LE(*offset + size, buffer->size(),
+                      platform::errors::OutOfRange(
+                          "Reading %d bytes at offset %d exceeds the buffer "
+                          "of %d bytes, the serialized LoDTensor may be "
+                          "damaged.",
+                          size, *offset, buffer->size()));
+    if (size > 0) {
+      std::memcpy(dst, static_cast<const char *>(buffer->ptr()) + *offset,
+                  size);
+    }
+    *offset += size;
+  };
+  {
+    // the 1st field, unit32_t version for LoDTensor
+    uint32_t version;
+    read(&version, sizeof(version));
+    PADDLE_ENFORCE_EQ(
+        version, 0U,
+        platform::errors::InvalidArgument(
+            "tensor version %u is not supported, Only version 0 is supported",
+            version));
+  }
+  {
+    // the 2st field, LoD information
+    uint64_t lod_level;
+    read(&lod_level, sizeof(lod_level));
+    auto &lod = *tensor->mutable_lod();
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size;
+      read(&size, sizeof(size));
+      std::vector<size_t> tmp(size / sizeof(size_t));
+      read(tmp.data(), size);
+      lod[i] = tmp;
+    }
+  }
+  // the 3st filed, Tensor
+  TensorFromMemory(buffer, offset, static_cast<Tensor *>(tensor));
+}
+
 void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
                            const platform::DeviceContext &dev_ctx) {
   {
@@ -305,6 +354,315 @@ void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
   TensorFromStream(is, static_cast<Tensor *>(tensor), dev_ctx);
 }
 
+namespace {
+
+constexpr char kIndexedMagic[8] = {'P', 'D', 'T', 'E', 'N', 'S', 'O', 'R'};
+constexpr uint32_t kIndexedVersion = 1;
+// the payloads are aligned for the vectorized loads on the mapped memory
+constexpr uint64_t kIndexedAlignment = 64;
+// the magic, uint32_t version, uint32_t alignment, uint64_t number of the
+// tensors and uint64_t size of the index
+constexpr size_t kIndexedHeaderSize = 32;
+// the size of the pinned buffer staging the payloads copied to GPU
+constexpr size_t kIndexedStagingSize = 16 << 20;
+
+struct IndexedEntry {
+  uint64_t offset;
+  LoD lod;
+  DDim dims;
+  proto::VarType::Type type;
+  size_t bytes;
+};
+
+uint64_t AlignUp(uint64_t value) {
+  return (value + kIndexedAlignment - 1) / kIndexedAlignment *
+         kIndexedAlignment;
+}
+
+template <typename T>
+void AppendPod(std::string *out, const T &value) {
+  out->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// read(offset, size, dst) reads the bytes of the file of file_size bytes.
+std::vector<IndexedEntry> ReadIndex(
+    const std::function<void(uint64_t, size_t, void *)> &read,
+    uint64_t file_size) {
+  char header[kIndexedHeaderSize];
+  PADDLE_ENFORCE_GE(file_size, kIndexedHeaderSize,
+                    platform::errors::InvalidArgument(
+                        "The indexed tensors file of %d bytes is too short.",
+                        file_size));
+  read(0, kIndexedHeaderSize, header);
+  PADDLE_ENFORCE_EQ(
+      std::memcmp(header, kIndexedMagic, sizeof(kIndexedMagic)), 0,
+      platform::errors::InvalidArgument("It is not an indexed tensors file."));
+  uint32_t version, alignment;
+  uint64_t num_tensors, index_size;
+  std::memcpy(&version, header + 8, sizeof(version));
+  std::memcpy(&alignment, header + 12, sizeof(alignment));
+  std::memcpy(&num_tensors, header + 16, sizeof(num_tensors));
+  std::memcpy(&index_size, header + 24, sizeof(index_size));
+  PADDLE_ENFORCE_EQ(version, kIndexedVersion,
+                    platform::errors::InvalidArgument(
+                        "The version %u of the indexed tensors file is not "
+                        "supported, only version %u is supported.",
+                        version, kIndexedVersion));
+  PADDLE_ENFORCE_LE(kIndexedHeaderSize + index_size, file_size,
+                    platform::errors::InvalidArgument(
+                        "The index of %d bytes exceeds the file of %d bytes, "
+                        "the file may be damaged.",
+                        index_size, file_size));
+  std::string index(index_size, '\0');
+  read(kIndexedHeaderSize, index_size, &index[0]);
+
+  size_t pos = 0;
+  auto parse = [&](void *dst, size_t size) {
+    PADDLE_ENFORCE_LE(pos + size, index.size(),
+                      platform::errors::InvalidArgument(
+                          "The index of the indexed tensors file is damaged."));
+    std::memcpy(dst, index.data() + pos, size);
+    pos += size;
+  };
+  std::vector<IndexedEntry> entries(num_tensors);
+  for (auto &entry : entries) {
+    parse(&entry.offset, sizeof(entry.offset));
+    uint64_t lod_level;
+    parse(&lod_level, sizeof(lod_level));
+    entry.lod.resize(lod_level);
+    for (auto &level : entry.lod) {
+      uint64_t size;
+      parse(&size, sizeof(size));
+      std::vector<size_t> tmp(size / sizeof(size_t));
+      parse(tmp.data(), size);
+      level = tmp;
+    }
+    int32_t desc_size;
+    parse(&desc_size, sizeof(desc_size));
+    PADDLE_ENFORCE_LE(pos + desc_size, index.size(),
+                      platform::errors::InvalidArgument(
+                          "The index of the indexed tensors file is damaged."));
+    proto::VarType::TensorDesc desc;
+    PADDLE_ENFORCE_EQ(desc.ParseFromArray(index.data() + pos, desc_size), true,
+                      platform::errors::InvalidArgument(
+                          "Cannot parse tensor desc"));
+    pos += desc_size;
+    std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+    entry.dims = make_ddim(dims);
+    entry.type = desc.data_type();
+    entry.bytes = product(entry.dims) * SizeOfType(entry.type);
+    PADDLE_ENFORCE_EQ(entry.offset % alignment == 0 &&
+                          entry.offset + entry.bytes <= file_size,
+                      true, platform::errors::InvalidArgument(
+                                "The tensor of %d bytes at offset %d is out "
+                                "of the file of %d bytes or unaligned, the "
+                                "file may be damaged.",
+                                entry.bytes, entry.offset, file_size));
+  }
+  return entries;
+}
+
+void CheckNumTensors(size_t num_entries, size_t num_tensors) {
+  PADDLE_ENFORCE_EQ(num_entries, num_tensors,
+                    platform::errors::InvalidArgument(
+                        "The indexed tensors file holds %d tensors, but %d "
+                        "tensors are loaded. You are not allowed to load "
+                        "partial data via load_combine_op, use load_op "
+                        "instead.",
+                        num_entries, num_tensors));
+}
+
+}  // namespace
+
+bool IsIndexedTensorsBuffer(const char *data, size_t size) {
+  return size >= sizeof(kIndexedMagic) &&
+         std::memcmp(data, kIndexedMagic, sizeof(kIndexedMagic)) == 0;
+}
+
+bool IsIndexedTensorsFile(const std::string &path) {
+  std::ifstream fin(path, std::ios::binary);
+  char magic[sizeof(kIndexedMagic)];
+  fin.read(magic, sizeof(magic));
+  return static_cast<bool>(fin) && IsIndexedTensorsBuffer(magic, sizeof(magic));
+}
+
+void SerializeIndexedToStream(std::ostream &os,
+                              const std::vector<const LoDTensor *> &tensors,
+                              const platform::DeviceContext &dev_ctx) {
+  std::vector<LoDTensor> cpu_tensors(tensors.size());
+  std::vector<std::string> entries(tensors.size());
+  uint64_t header_size = kIndexedHeaderSize;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto &tensor = *tensors[i];
+    if (!platform::is_gpu_place(tensor.place())) {
+      cpu_tensors[i].ShareDataWith(tensor);
+    } else {
+      TensorCopy(tensor, platform::CPUPlace(), dev_ctx, &cpu_tensors[i]);
+    }
+    auto &entry = entries[i];
+    AppendPod(&entry, static_cast<uint64_t>(tensor.lod().size()));
+    for (auto &level : tensor.lod()) {
+      AppendPod(&entry, static_cast<uint64_t>(level.size() * sizeof(size_t)));
+      entry.append(reinterpret_cast<const char *>(level.data()),
+                   level.size() * sizeof(size_t));
+    }
+    proto::VarType::TensorDesc desc;
+    desc.set_data_type(tensor.type());
+    auto dims = framework::vectorize(tensor.dims());
+    auto *pb_dims = desc.mutable_dims();
+    pb_dims->Resize(static_cast<int>(dims.size()), 0);
+    std::copy(dims.begin(), dims.end(), pb_dims->begin());
+    auto desc_str = desc.SerializeAsString();
+    AppendPod(&entry, static_cast<int32_t>(desc_str.size()));
+    entry.append(desc_str);
+    header_size += sizeof(uint64_t) + entry.size();
+  }
+  dev_ctx.Wait();
+
+  std::vector<uint64_t> offsets(tensors.size());
+  uint64_t end = header_size;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    offsets[i] = AlignUp(end);
+    end = offsets[i] + cpu_tensors[i].numel() * SizeOfType(tensors[i]->type());
+  }
+
+  std::string header(kIndexedMagic, sizeof(kIndexedMagic));
+  AppendPod(&header, kIndexedVersion);
+  AppendPod(&header, static_cast<uint32_t>(kIndexedAlignment));
+  AppendPod(&header, static_cast<uint64_t>(tensors.size()));
+  AppendPod(&header, header_size - kIndexedHeaderSize);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    AppendPod(&header, offsets[i]);
+    header.append(entries[i]);
+  }
+  os.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+  uint64_t pos = header.size();
+  const std::string padding(kIndexedAlignment, '\0');
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    os.write(padding.data(), static_cast<std::streamsize>(offsets[i] - pos));
+    size_t bytes = cpu_tensors[i].numel() * SizeOfType(tensors[i]->type());
+    if (bytes > 0) {
+      os.write(static_cast<const char *>(cpu_tensors[i].data<void>()),
+               static_cast<std::streamsize>(bytes));
+    }
+    pos = offsets[i] + bytes;
+  }
+}
+
+void DeserializeIndexedFromMemory(
+    const std::shared_ptr<memory::Allocation> &buffer,
+    const std::vector<LoDTensor *> &tensors) {
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(buffer->place()), true,
+                    platform::errors::InvalidArgument(
+                        "The tensors can only be deserialized from the CPU "
+                        "memory."));
+  auto entries = ReadIndex(
+      [&buffer](uint64_t offset, size_t size, void *dst) {
+        std::memcpy(dst, static_cast<const char *>(buffer->ptr()) + offset,
+                    size);
+      },
+      buffer->size());
+  CheckNumTensors(entries.size(), tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto &entry = entries[i];
+    TensorShareBufferSlice(buffer, entry.offset, entry.dims, entry.type,
+                           tensors[i]);
+    tensors[i]->set_lod(entry.lod);
+  }
+}
+
+void DeserializeIndexedFromFile(const std::string &path,
+                                const std::vector<LoDTensor *> &tensors,
+                                const platform::Place &place,
+                                int num_threads) {
+  std::ifstream fin(path, std::ios::binary | std::ios::ate);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                    platform::errors::Unavailable(
+                        "Cannot open the file %s, please check whether the "
+                        "model file is complete or damaged.",
+                        path));
+  uint64_t file_size = static_cast<uint64_t>(fin.tellg());
+  auto read = [&path](std::ifstream *is, uint64_t offset, size_t size,
+                      void *dst) {
+    is->seekg(static_cast<std::streamoff>(offset));
+    is->read(static_cast<char *>(dst), static_cast<std::streamsize>(size));
+    PADDLE_ENFORCE_EQ(static_cast<bool>(*is), true,
+                      platform::errors::Unavailable(
+                          "Failed to read %d bytes at offset %d of %s.", size,
+                          offset, path));
+  };
+  auto entries = ReadIndex(
+      [&](uint64_t offset, size_t size, void *dst) {
+        read(&fin, offset, size, dst);
+      },
+      file_size);
+  CheckNumTensors(entries.size(), tensors.size());
+
+  // the memory is allocated before reading, and the tensors are read in the
+  // order of the file by the threads
+  std::vector<char *> data(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    tensors[i]->Resize(entries[i].dims);
+    tensors[i]->set_lod(entries[i].lod);
+    data[i] =
+        static_cast<char *>(tensors[i]->mutable_data(place, entries[i].type));
+  }
+
+  std::atomic<size_t> next{0};
+  std::mutex mu;
+  std::exception_ptr exception;
+  auto worker = [&] {
+    try {
+      std::ifstream is(path, std::ios::binary);
+      std::shared_ptr<memory::Allocation> staging;
+      for (size_t i = next.fetch_add(1); i < tensors.size();
+           i = next.fetch_add(1)) {
+        auto &entry = entries[i];
+        if (platform::is_cpu_place(place)) {
+          read(&is, entry.offset, entry.bytes, data[i]);
+          continue;
+        }
+#ifdef PADDLE_WITH_CUDA
+        // the payloads are copied to GPU from the pinned memory directly
+        if (staging == nullptr) {
+          staging = memory::AllocShared(platform::CUDAPinnedPlace(),
+                                        kIndexedStagingSize);
+        }
+        for (size_t pos = 0; pos < entry.bytes; pos += kIndexedStagingSize) {
+          size_t size = std::min(kIndexedStagingSize, entry.bytes - pos);
+          read(&is, entry.offset + pos, size, staging->ptr());
+          memory::Copy(boost::get<platform::CUDAPlace>(place), data[i] + pos,
+                       platform::CUDAPinnedPlace(), staging->ptr(), size,
+                       nullptr);
+        }
+#else
+        PADDLE_THROW(platform::errors::Unimplemented(
+            "Loading the indexed tensors file on %s is not supported.",
+            place));
+#endif
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mu);
+      if (!exception) exception = std::current_exception();
+      next.store(tensors.size());
+    }
+  };
+  num_threads = std::max(
+      1, std::min(num_threads, static_cast<int>(tensors.size())));
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
 std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
     const std::vector<platform::Place> places) const {
   PADDLE_ENFORCE_GT(places.size(), 0,
@@ -335,6 +693,9 @@ std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
   auto result_size = (batch_size + step_width - 1) / step_width;
   std::vector<LoDTensor> results;
   results.reserve(result_size);
+  // the copies to the places overlap with each other
+  std::vector<TensorCopyEvent> copy_events;
+  copy_events.reserve(result_size);
 
   for (size_t i = 0; i < result_size; ++i) {
     auto begin = i * step_width;
@@ -347,14 +708,16 @@ std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
     if (lod().empty()) {
       auto src = Slice(begin, end);
       auto &dst_place = places[i];
-      framework::TensorCopy(src, dst_place, &dst);
+      copy_events.emplace_back(
+          framework::TensorCopyAsync(src, dst_place, &dst));
     } else {
       auto lod_and_offset = GetSubLoDAndAbsoluteOffset(lod(), begin, end, 0);
 
       auto &offset = lod_and_offset.second;
       auto src = Slice(offset.first, offset.second);
       auto &dst_place = places[i];
-      framework::TensorCopy(src, dst_place, &dst);
+      copy_events.emplace_back(
+          framework::TensorCopyAsync(src, dst_place, &dst));
 
       LoD my_lod;
       for (auto &l : lod_and_offset.first) {
@@ -369,6 +732,9 @@ std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
     results.emplace_back(std::move(dst));
   }
 
+  for (auto &event : copy_events) {
+    event.Wait();
+  }
   return results;
 }
 
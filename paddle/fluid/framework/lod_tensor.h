@@ -213,6 +213,41 @@ void DeserializeFromStream(std::istream& is, LoDTensor* tensor,
                            const platform::DeviceContext& dev_ctx,
                            const size_t& seek,
                            const std::vector<int64_t>& shape);
+/*
+ * Desiralize the LoDTensor at *offset of a CPU buffer, e.g. a memory mapped
+ * file written by SerializeToStream, without copying the data, which stays
+ * in the buffer. *offset is moved to the end of the LoDTensor.
+ */
+void DeserializeFromMemory(const std::shared_ptr<memory::Allocation>& buffer,
+                           size_t* offset, LoDTensor* tensor);
+
+/*
+ * The indexed tensors file holds a list of LoDTensors like the stream of
+ * SerializeToStream, but the LoDs and the TensorDescs of all the tensors are
+ * in an index at the beginning of the file, followed by the data of the
+ * tensors aligned to 64 bytes. So that the file can be memory mapped and the
+ * tensors share the mapped data, or the tensors can be read in parallel.
+ *
+ * The header of the file is the magic "PDTENSOR", uint32_t version,
+ * uint32_t alignment, uint64_t number of the tensors and uint64_t size of the
+ * index. Each tensor in the index is uint64_t offset of the data in the file,
+ * the LoD in the format of SerializeToStream, int32_t size of the TensorDesc
+ * and the serialized TensorDesc.
+ */
+bool IsIndexedTensorsFile(const std::string& path);
+bool IsIndexedTensorsBuffer(const char* data, size_t size);
+void SerializeIndexedToStream(std::ostream& os,
+                              const std::vector<const LoDTensor*>& tensors,
+                              const platform::DeviceContext& dev_ctx);
+// The tensors share the data in the CPU buffer, e.g. the mapped file.
+void DeserializeIndexedFromMemory(
+    const std::shared_ptr<memory::Allocation>& buffer,
+    const std::vector<LoDTensor*>& tensors);
+// The tensors are allocated on the place and read by num_threads threads,
+// which copy the data to GPU from a pinned buffer.
+void DeserializeIndexedFromFile(const std::string& path,
+                                const std::vector<LoDTensor*>& tensors,
+                                const platform::Place& place, int num_threads);
 
 /*
  * Convert between length-based LoD and offset-based LoD.
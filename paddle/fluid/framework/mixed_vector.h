@@ -43,27 +43,33 @@ class Vector {
 
  private:
   // The actual class to implement vector logic
+  //
+  // The data is mirrored on each CUDA device it is accessed on, and the
+  // mirrors are kept until the data is modified. So the data shared by the
+  // Vectors, e.g. a LoD shared by the tensors on several devices, is copied
+  // to each device once, rather than every time it is accessed.
   class VectorData {
    public:
-    VectorData() : flag_(kDataInCPU) {}
+    VectorData() : cpu_valid_(true) {}
     VectorData(size_t count, const T &value)
-        : cpu_(count, value), flag_(kDataInCPU) {}
-    VectorData(std::initializer_list<T> init) : cpu_(init), flag_(kDataInCPU) {}
+        : cpu_(count, value), cpu_valid_(true) {}
+    VectorData(std::initializer_list<T> init) : cpu_(init), cpu_valid_(true) {}
     template <typename U>
     explicit VectorData(const std::vector<U> &dat)
-        : cpu_(dat), flag_(kDataInCPU) {}
+        : cpu_(dat), cpu_valid_(true) {}
     ~VectorData() {}
 
     VectorData(const VectorData &o) {
       o.ImmutableCPU();
       cpu_ = o.cpu_;
-      flag_ = kDataInCPU;
+      cpu_valid_ = true;
     }
 
     VectorData &operator=(const VectorData &o) {
       o.ImmutableCPU();
       cpu_ = o.cpu_;
-      flag_ = kDataInCPU;
+      cpu_valid_ = true;
+      InvalidateCUDA();
       return *this;
     }
 
@@ -157,21 +163,23 @@ class Vector {
     const T *CUDAData(platform::Place place) const {
       PADDLE_ENFORCE(platform::is_gpu_place(place),
                      "CUDA Data must on CUDA place");
-      ImmutableCUDA(place);
-      return reinterpret_cast<T *>(gpu_->ptr());
+      return reinterpret_cast<T *>(ImmutableCUDA(place)->ptr());
     }
 
     // get cuda ptr. mutable
     T *CUDAMutableData(platform::Place place) {
       const T *ptr = CUDAData(place);
-      flag_ = kDirty | kDataInCUDA;
+      // the data on CPU and the other devices is out of date
+      cpu_valid_ = false;
+      InvalidateCUDA(boost::get<platform::CUDAPlace>(place).device);
       return const_cast<T *>(ptr);
     }
 
     // clear
     void clear() {
       cpu_.clear();
-      flag_ = kDirty | kDataInCPU;
+      cpu_valid_ = true;
+      InvalidateCUDA();
     }
 
     size_t capacity() const { return cpu_.capacity(); }
@@ -193,101 +201,83 @@ class Vector {
 
     std::mutex &Mutex() const { return mtx_; }
 
-    boost::optional<platform::CUDAPlace> CUDAPlace() const {
-      return gpu_ == nullptr
-                 ? boost::none
-                 : boost::optional<platform::CUDAPlace>(
-                       boost::get<platform::CUDAPlace>(gpu_->place()));
-    }
-
    private:
-    enum DataFlag {
-      kDataInCPU = 0x01,
-      kDataInCUDA = 0x02,
-      // kDirty means the data has been changed in one device.
-      kDirty = 0x10
+    struct CUDAMirror {
+      paddle::memory::AllocationPtr gpu;
+      // the mirror is kept for reuse when it is out of date
+      bool valid{false};
     };
 
     void CopyToCPU() const {
-      // COPY GPU Data To CPU
-      auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
-          platform::DeviceContextPool::Instance().Get(gpu_->place()));
-      auto stream = dev_ctx->stream();
-      void *src = gpu_->ptr();
-      void *dst = cpu_.data();
-      paddle::memory::Copy(platform::CPUPlace(), dst, CUDAPlace().get(), src,
-                           gpu_memory_size_, stream);
-      dev_ctx->Wait();
+      // COPY GPU Data To CPU from any device holding the latest data
+      for (size_t i = 0; i < gpu_.size(); ++i) {
+        if (!gpu_[i].valid) continue;
+        platform::CUDAPlace place(static_cast<int>(i));
+        auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+            platform::DeviceContextPool::Instance().Get(place));
+        paddle::memory::Copy(platform::CPUPlace(), cpu_.data(), place,
+                             gpu_[i].gpu->ptr(), cpu_.size() * sizeof(T),
+                             dev_ctx->stream());
+        dev_ctx->Wait();
+        return;
+      }
+      PADDLE_THROW("The data of Vector is neither on CPU nor on CUDA.");
     }
 
     void MutableCPU() {
-      if (IsInCUDA() && IsDirty()) {
-        CopyToCPU();
+      ImmutableCPU();
+      InvalidateCUDA();
+    }
+
+    const paddle::memory::Allocation *ImmutableCUDA(
+        platform::Place place) const {
+      size_t device = boost::get<platform::CUDAPlace>(place).device;
+      if (gpu_.size() <= device) {
+        gpu_.resize(device + 1);
       }
-      flag_ = kDirty | kDataInCPU;
-    }
-
-    void ImmutableCUDA(platform::Place place) const {
-      if (IsDirty()) {
-        if (IsInCPU()) {
-          CopyCPUDataToCUDA(place);
-          UnsetFlag(kDirty);
-          SetFlag(kDataInCUDA);
-        } else if (IsInCUDA() && !(place == gpu_->place())) {
-          PADDLE_THROW("This situation should not happen");
-          // Still dirty
-        } else {
-          // Dirty && DataInCUDA && Device is same
-          // Do nothing
-        }
-      } else {
-        if (!IsInCUDA()) {
-          // Even data is not dirty. However, data is not in CUDA. Copy data.
-          CopyCPUDataToCUDA(place);
-          SetFlag(kDataInCUDA);
-        } else if (!(place == gpu_->place())) {
-          PADDLE_THROW("This situation should not happen.");
-        } else {
-          // Not Dirty && DataInCUDA && Device is same
-          // Do nothing.
-        }
+      auto &mirror = gpu_[device];
+      if (!mirror.valid) {
+        // the latest data may be on another device
+        ImmutableCPU();
+        CopyCPUDataToCUDA(place, &mirror);
       }
+      return mirror.gpu.get();
     }
 
-    void CopyCPUDataToCUDA(const platform::Place &place) const {
-      void *src = cpu_.data();
-      gpu_memory_size_ = cpu_.size() * sizeof(T);
-      gpu_ = memory::Alloc(place, gpu_memory_size_);
-      void *dst = gpu_->ptr();
+    void CopyCPUDataToCUDA(const platform::Place &place,
+                           CUDAMirror *mirror) const {
+      size_t size = cpu_.size() * sizeof(T);
+      if (mirror->gpu == nullptr || mirror->gpu->size() < size) {
+        mirror->gpu = memory::Alloc(place, size);
+      }
       auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
           platform::DeviceContextPool::Instance().Get(place));
-      auto stream = dev_ctx->stream();
-      paddle::memory::Copy(CUDAPlace().get(), dst, platform::CPUPlace(), src,
-                           gpu_memory_size_, stream);
+      paddle::memory::Copy(boost::get<platform::CUDAPlace>(place),
+                           mirror->gpu->ptr(), platform::CPUPlace(),
+                           cpu_.data(), size, dev_ctx->stream());
+      mirror->valid = true;
     }
 
     void ImmutableCPU() const {
-      if (IsDirty() && !IsInCPU()) {  // If data has been changed in CUDA, or
-                                      // CPU has no data.
+      if (!cpu_valid_) {  // If data has been changed in CUDA
         CopyToCPU();
-        UnsetFlag(kDirty);
+        cpu_valid_ = true;
       }
-      SetFlag(kDataInCPU);
     }
 
-    void UnsetFlag(int flag) const { flag_ &= ~flag; }
-    void SetFlag(int flag) const { flag_ |= flag; }
-
-    bool IsDirty() const { return flag_ & kDirty; }
-
-    bool IsInCUDA() const { return flag_ & kDataInCUDA; }
-
-    bool IsInCPU() const { return flag_ & kDataInCPU; }
+    // Invalidate the mirrors except the one on the device except.
+    void InvalidateCUDA(size_t except = static_cast<size_t>(-1)) const {
+      for (size_t i = 0; i < gpu_.size(); ++i) {
+        if (i != except) {
+          gpu_[i].valid = false;
+        }
+      }
+    }
 
     mutable std::vector<T> cpu_;
-    mutable paddle::memory::AllocationPtr gpu_;
-    mutable size_t gpu_memory_size_{0};
-    mutable int flag_;
+    mutable bool cpu_valid_;
+    // indexed by the device id
+    mutable std::vector<CUDAMirror> gpu_;
 
     mutable std::mutex mtx_;
   };
@@ -381,34 +371,16 @@ class Vector {
 
   // get cuda ptr. immutable
   const T *CUDAData(platform::Place place) const {
-    {
-      auto &mtx = m_.Data().Mutex();
-      std::lock_guard<std::mutex> guard(mtx);
-      auto cuda_place = m_.Data().CUDAPlace();
-      if (cuda_place == boost::none ||
-          cuda_place == boost::get<platform::CUDAPlace>(place)) {
-        return m_.Data().CUDAData(place);
-      }
-    }
-    // If m_ contains CUDAData in a different place. Detach manually.
-    m_.Detach();
-    return CUDAData(place);
+    auto &mtx = m_.Data().Mutex();
+    std::lock_guard<std::mutex> guard(mtx);
+    return m_.Data().CUDAData(place);
   }
 
   // get cuda ptr. mutable
   T *CUDAMutableData(platform::Place place) {
-    {
-      auto &mtx = m_.Data().Mutex();
-      std::lock_guard<std::mutex> guard(mtx);
-      auto cuda_place = m_.Data().CUDAPlace();
-      if (cuda_place == boost::none ||
-          cuda_place == boost::get<platform::CUDAPlace>(place)) {
-        return m_.MutableData()->CUDAMutableData(place);
-      }
-    }
-    // If m_ contains CUDAData in a different place. Detach manually.
-    m_.Detach();
-    return CUDAMutableData(place);
+    auto *data = m_.MutableData();
+    std::lock_guard<std::mutex> guard(data->Mutex());
+    return data->CUDAMutableData(place);
   }
 
   // clear
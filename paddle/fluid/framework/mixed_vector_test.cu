@@ -73,3 +73,72 @@ TEST(mixed_vector, MultiGPU) {
     ASSERT_EQ(tmp[i], i * 100);
   }
 }
+
+TEST(mixed_vector, ReuseCUDAData) {
+  vec<int> tmp;
+  for (int i = 0; i < 10; ++i) {
+    tmp.push_back(i);
+  }
+  paddle::platform::CUDAPlace gpu(0);
+  const vec<int>& const_tmp = tmp;
+  const int* ptr = const_tmp.Data(gpu);
+  // the data is not copied to CUDA again if it is not modified
+  EXPECT_EQ(const_tmp.Data(gpu), ptr);
+
+  // the copies share the data and the mirror on CUDA
+  vec<int> copy = tmp;
+  const vec<int>& const_copy = copy;
+  EXPECT_EQ(const_copy.Data(gpu), ptr);
+
+  // modifying the shared data detaches it, the mirror is kept by the copy
+  tmp[0] = 100;
+  EXPECT_EQ(const_copy[0], 0);
+  EXPECT_EQ(const_copy.Data(gpu), ptr);
+  ptr = const_tmp.Data(gpu);
+  EXPECT_NE(ptr, const_copy.Data(gpu));
+
+  // the allocation of the out of date mirror is reused
+  tmp[0] = 1;
+  EXPECT_EQ(const_tmp.Data(gpu), ptr);
+  tmp[0] = 100;
+
+  multiply_10<<<1, 1, 0, GetCUDAStream(gpu)>>>(tmp.MutableData(gpu));
+  EXPECT_EQ(const_tmp[0], 1000);
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_EQ(const_tmp[i], i * 10);
+    EXPECT_EQ(const_copy[i], i);
+  }
+}
+
+TEST(mixed_vector, MultiGPUSharedData) {
+  if (paddle::platform::GetCUDADeviceCount() < 2) {
+    LOG(WARNING) << "Skip mixed_vector.MultiGPUSharedData since there are not "
+                    "multiple GPUs in your machine.";
+    return;
+  }
+
+  vec<int> tmp;
+  for (int i = 0; i < 10; ++i) {
+    tmp.push_back(i);
+  }
+  const vec<int>& const_tmp = tmp;
+  paddle::platform::CUDAPlace gpu0(0);
+  paddle::platform::CUDAPlace gpu1(1);
+  const int* gpu0_ptr = const_tmp.Data(gpu0);
+  const int* gpu1_ptr = const_tmp.Data(gpu1);
+  EXPECT_NE(gpu0_ptr, gpu1_ptr);
+  // reading the data on both devices keeps the mirrors on both devices
+  EXPECT_EQ(const_tmp.Data(gpu0), gpu0_ptr);
+  EXPECT_EQ(const_tmp.Data(gpu1), gpu1_ptr);
+
+  paddle::platform::SetDeviceId(1);
+  multiply_10<<<1, 1, 0, GetCUDAStream(gpu1)>>>(tmp.MutableData(gpu1));
+  // the mirror on gpu0 is out of date, and updated from gpu1
+  std::vector<int> result(10);
+  paddle::platform::SetDeviceId(0);
+  cudaMemcpy(result.data(), const_tmp.Data(gpu0), 10 * sizeof(int),
+             cudaMemcpyDeviceToHost);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(result[i], i * 10);
+  }
+}
@@ -19,6 +19,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/framework/trainer.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/platform/numa.h"
+
+DECLARE_bool(numa_aware);
 
 namespace paddle {
 namespace framework {
@@ -65,6 +68,7 @@ void MultiTrainer::Initialize(const TrainerDesc& trainer_desc,
   }
 #endif
 
+  int numa_node_count = FLAGS_numa_aware ? platform::GetNumaNodeCount() : 1;
   for (int i = 0; i < thread_num_; ++i) {
     workers_[i] = DeviceWorkerFactory::CreateDeviceWorker(
         trainer_desc.device_worker_name());
@@ -72,6 +76,11 @@ void MultiTrainer::Initialize(const TrainerDesc& trainer_desc,
     workers_[i]->SetDeviceIndex(i);
     workers_[i]->SetDataFeed(readers[i]);
     workers_[i]->SetNeedDump(need_dump_field_);
+    if (numa_node_count > 1) {
+      // the adjacent workers on different nodes, to use all the nodes if
+      // there are fewer workers than the CPUs
+      workers_[i]->SetNumaNode(i % numa_node_count);
+    }
   }
 
   // set debug here
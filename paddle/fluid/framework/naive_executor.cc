@@ -12,8 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -25,9 +28,20 @@
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/fluid/string/pretty_log.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/allocation/retained_allocator.h"
+#endif
+
+DECLARE_int32(inter_op_parallelism);
+DECLARE_bool(use_var_slots);
 
 namespace paddle {
 namespace framework {
+NaiveExecutor::NaiveExecutor(const platform::Place &place)
+    : place_(place),
+      inter_op_parallelism_(std::max(FLAGS_inter_op_parallelism, 0)) {}
+
 void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
                             int block_id, bool with_feed_fetch_ops) {
   if (!scope) {
@@ -38,14 +52,127 @@ void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
 
   VLOG(3) << "NaiveExecutor init with scope " << scope;
   CreateOps(program_desc, block_id, with_feed_fetch_ops);
+  if (FLAGS_use_var_slots) {
+    // only the scope of this executor, since the parent scope may be shared
+    // with the executors running in other threads, e.g. the cloned
+    // predictors
+    scope_->ReserveVarSlots(Scope::VarSlotNum());
+  }
 }
 
 void NaiveExecutor::Run() {
-  for (auto &op : ops_) {
+#ifdef PADDLE_WITH_CUDA
+  if (cuda_graph_ && cuda_graph_->IsCaptured()) {
+    if (CUDAGraphInputsMatch()) {
+      cuda_graph_->Replay();
+      return;
+    }
+    VLOG(3) << "Input tensors changed, capture the CUDA graph again";
+    ResetCUDAGraph();
+  }
+#endif
+
+  if (memory_plan_) {
+    if (memory_plan_->Matches()) {
+      memory_plan_->Bind();
+    } else {
+      VLOG(3) << "Input shapes changed, rebuild the static memory plan";
+      memory_plan_->Unbind();
+      memory_plan_.reset();
+    }
+  }
+
+#ifdef PADDLE_WITH_CUDA
+  if (use_cuda_graph_ && ++cuda_graph_run_num_ > kCUDAGraphWarmupRuns) {
+    CaptureCUDAGraph();
+    // the planned tensors are not moved while the graph is replayed
+    if (cuda_graph_->IsCaptured()) {
+      return;
+    }
+  } else {
+    RunOps();
+  }
+#else
+  RunOps();
+#endif
+
+  if (use_static_memory_plan_ && !memory_plan_) {
+    memory_plan_ =
+        StaticMemoryPlan::Build(ops_, *scope_, place_, memory_plan_outputs_);
+    if (!memory_plan_) {
+      use_static_memory_plan_ = false;
+    }
+  }
+}
+
+void NaiveExecutor::RunOps() {
+  if (use_op_latency_stats_ && op_histograms_.size() != ops_.size()) {
+    op_histograms_.clear();
+    for (auto &op : ops_) {
+      std::string key = op->Type();
+      if (op->HasAttr("engine_key")) {
+        key += ":" + op->Attr<std::string>("engine_key");
+      }
+      auto &histogram = op_latency_histograms_[key];
+      if (!histogram) {
+        histogram.reset(new platform::LatencyHistogram);
+      }
+      op_histograms_.push_back(histogram.get());
+    }
+  }
+
+  auto run_op = [this](size_t i) {
+    auto &op = ops_[i];
     VLOG(4) << std::this_thread::get_id() << " run "
             << op->DebugStringEx(scope_) << " on scope " << scope_;
     op->SetIsCalledByExecutor(false);
+    if (!use_op_latency_stats_) {
+      op->Run(*scope_, place_);
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
     op->Run(*scope_, place_);
+    auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    op_histograms_[i]->Record(latency.count());
+  };
+
+  // the first run creates the variables and chooses the kernels one by one
+  if (inter_op_parallelism_ > 0 && run_num_++ > 0 &&
+      !use_static_memory_plan_) {
+    if (!parallel_runner_ &&
+        ParallelOpRunner::CanRunInParallel(ops_, place_)) {
+      parallel_runner_.reset(new ParallelOpRunner(ops_, inter_op_parallelism_));
+    }
+    if (parallel_runner_) {
+      parallel_runner_->Run(run_op, *scope_);
+      return;
+    }
+    VLOG(3) << "The ops on " << place_ << " can not run in parallel";
+    inter_op_parallelism_ = 0;
+  }
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    run_op(i);
+  }
+}
+
+void NaiveExecutor::SetInterOpParallelism(size_t num_threads) {
+  inter_op_parallelism_ = num_threads;
+  parallel_runner_.reset();
+}
+
+void NaiveExecutor::EnableOpLatencyStats(bool enable) {
+  use_op_latency_stats_ = enable;
+}
+
+void NaiveExecutor::EnableStaticMemoryPlan(
+    bool enable, const std::vector<std::string> &output_names) {
+  use_static_memory_plan_ = enable;
+  memory_plan_outputs_.clear();
+  memory_plan_outputs_.insert(output_names.begin(), output_names.end());
+  if (!enable && memory_plan_) {
+    memory_plan_->Unbind();
+    memory_plan_.reset();
   }
 }
 
@@ -89,6 +216,8 @@ void NaiveExecutor::CreateVariables(const ProgramDesc &desc, int block_id,
 
 void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id,
                               bool with_feed_fetch_ops) {
+  parallel_runner_.reset();
+  op_histograms_.clear();
   for (const auto &op_desc : desc.Block(block_id).AllOps()) {
     if (!with_feed_fetch_ops &&
         (op_desc->Type() == "feed" || op_desc->Type() == "fetch")) {
@@ -97,6 +226,9 @@ void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id,
       continue;
     }
     ops_.emplace_back(OpRegistry::CreateOp(*op_desc));
+    if (FLAGS_use_var_slots) {
+      ops_.back()->BindVarSlots();
+    }
   }
 }
 
@@ -116,7 +248,163 @@ void NaiveExecutor::CleanFeedFetchOps() {
     }
   }
   ops_.swap(ops);
+  parallel_runner_.reset();
+  op_histograms_.clear();
+  // the plan is built on the indices of the ops
+  if (memory_plan_) {
+    memory_plan_->Unbind();
+    memory_plan_.reset();
+  }
+#ifdef PADDLE_WITH_CUDA
+  ResetCUDAGraph();
+#endif
+}
+
+void NaiveExecutor::EnableCUDAGraph(bool enable) {
+#ifdef PADDLE_WITH_CUDA
+  if (enable && (!platform::is_gpu_place(place_) ||
+                 !platform::CUDAGraph::IsSupported())) {
+    LOG(WARNING) << "CUDA graph is only supported on CUDAPlace with CUDA "
+                    "10.1 or later, it is disabled";
+    enable = false;
+  }
+  use_cuda_graph_ = enable;
+  ResetCUDAGraph();
+#else
+  if (enable) {
+    LOG(WARNING) << "CUDA graph is disabled without CUDA";
+  }
+#endif
+}
+
+bool NaiveExecutor::IsCUDAGraphCaptured() const {
+#ifdef PADDLE_WITH_CUDA
+  return cuda_graph_ && cuda_graph_->IsCaptured();
+#else
+  return false;
+#endif
+}
+
+#ifdef PADDLE_WITH_CUDA
+constexpr size_t NaiveExecutor::kCUDAGraphWarmupRuns;
+
+void NaiveExecutor::CaptureCUDAGraph() {
+  if (!cuda_graph_) {
+    cuda_graph_.reset(new platform::CUDAGraph);
+  }
+  auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  // the memory allocated while capturing is used by every replay
+  cuda_graph_context_ = memory::allocation::AllocatorFacade::Instance()
+                            .CreateRetainedAllocationContext(place_);
+  dev_ctx->Wait();
+
+  bool captured = false;
+  std::string error;
+  {
+    memory::allocation::AllocationContextGuard guard(
+        cuda_graph_context_.get());
+    try {
+      cuda_graph_->BeginCapture(dev_ctx->stream());
+      try {
+        RunOps();
+      } catch (...) {
+        cuda_graph_->EndCapture();
+        throw;
+      }
+      captured = cuda_graph_->EndCapture();
+    } catch (std::exception &ex) {
+      error = ex.what();
+    }
+  }
+
+  // the ops running on CPU are not recorded in the graph
+  std::unordered_set<std::string> output_names;
+  for (auto &op : ops_) {
+    for (auto &name : op->OutputVars(true)) {
+      output_names.insert(name);
+    }
+  }
+  for (auto &name : output_names) {
+    auto *var = scope_->FindVar(name);
+    if (captured && var != nullptr && var->IsType<LoDTensor>()) {
+      auto &tensor = var->Get<LoDTensor>();
+      if (tensor.IsInitialized() && !platform::is_gpu_place(tensor.place())) {
+        error = "the output " + name + " is not on CUDAPlace";
+        captured = false;
+      }
+    }
+  }
+
+  if (!captured) {
+    LOG(WARNING) << "Fail to capture the CUDA graph, it is disabled. "
+                 << error;
+    use_cuda_graph_ = false;
+    ResetCUDAGraph();
+    // the kernels captured are not launched
+    RunOps();
+    return;
+  }
+  // the inputs are the tensors read before written by the ops, including the
+  // parameters, whose addresses are recorded in the graph
+  cuda_graph_inputs_.clear();
+  std::unordered_set<std::string> visited;
+  for (auto &op : ops_) {
+    for (auto &name : op->InputVars()) {
+      if (visited.count(name) > 0) {
+        continue;
+      }
+      visited.insert(name);
+      auto *var = scope_->FindVar(name);
+      if (var == nullptr || !var->IsType<LoDTensor>()) {
+        continue;
+      }
+      auto &tensor = var->Get<LoDTensor>();
+      cuda_graph_inputs_.push_back(
+          {&tensor, tensor.dims(), tensor.lod(),
+           tensor.IsInitialized() ? tensor.data<void>() : nullptr});
+    }
+    for (auto &name : op->OutputVars(true)) {
+      visited.insert(name);
+    }
+  }
+  VLOG(3) << "Capture the CUDA graph of " << ops_.size() << " ops, with "
+          << cuda_graph_inputs_.size() << " inputs";
+
+  // the run computes the results by the graph
+  cuda_graph_->Replay();
+}
+
+bool NaiveExecutor::CUDAGraphInputsMatch() const {
+  for (auto &input : cuda_graph_inputs_) {
+    auto &tensor = *input.tensor;
+    const void *data = tensor.IsInitialized() ? tensor.data<void>() : nullptr;
+    if (data != input.data || tensor.dims() != input.dims ||
+        tensor.lod() != input.lod) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void NaiveExecutor::ResetCUDAGraph() {
+  if (cuda_graph_) {
+    cuda_graph_->Reset();
+  }
+  if (cuda_graph_context_) {
+    // the memory still held by the tensors is freed when they are released
+    auto retained_allocator =
+        std::dynamic_pointer_cast<memory::allocation::RetainedAllocator>(
+            cuda_graph_context_->allocator());
+    if (retained_allocator) {
+      retained_allocator->Release();
+    }
+    cuda_graph_context_.reset();
+  }
+  cuda_graph_inputs_.clear();
+  cuda_graph_run_num_ = 0;
 }
+#endif
 
 }  // namespace framework
 }  // namespace paddle
@@ -14,12 +14,22 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/parallel_op_runner.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/static_memory_plan.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/latency_histogram.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/budget_allocator.h"
+#include "paddle/fluid/platform/cuda_graph.h"
+#endif
 
 namespace paddle {
 namespace framework {
@@ -30,7 +40,7 @@ namespace framework {
  */
 class NaiveExecutor {
  public:
-  explicit NaiveExecutor(const platform::Place& place) : place_(place) {}
+  explicit NaiveExecutor(const platform::Place& place);
 
   // Create child scope.
   // Create variables.
@@ -54,15 +64,97 @@ class NaiveExecutor {
 
   void CleanFeedFetchOps();
 
+  // Build a static memory plan in the next run, and place the intermediate
+  // tensors by it in the later runs until the input shapes change, when
+  // the plan is built again. The tensors of output_names, e.g. the fetch
+  // targets read after the run, are not reused by the later ops.
+  void EnableStaticMemoryPlan(
+      bool enable = true, const std::vector<std::string>& output_names = {});
+
+  const StaticMemoryPlan* static_memory_plan() const {
+    return memory_plan_.get();
+  }
+
+  // Capture the kernels of the ops into a CUDA graph after the warm-up runs,
+  // and replay the graph in the later runs while the shapes and the
+  // addresses of the input tensors stay the same, which saves the launch
+  // overhead of the kernels. The inputs have to be updated in place, e.g.
+  // by the zero copy tensors. It is disabled if the ops can not be
+  // captured, e.g. some of them run on CPU. Only for CUDAPlace.
+  void EnableCUDAGraph(bool enable = true);
+
+  bool IsCUDAGraphCaptured() const;
+
+  // Run the independent ops in parallel by num_threads threads from the
+  // second run, 0 for running the ops one by one. Only for CPUPlace, and
+  // not with the static memory plan, which places the tensors by the order
+  // of the ops. It is set by FLAGS_inter_op_parallelism by default.
+  void SetInterOpParallelism(size_t num_threads);
+
+  // Record the latency of every op run into the histograms of its op type,
+  // or of "type:engine_key" for the subgraph engine ops, e.g.
+  // tensorrt_engine. It is the host time of Run, which does not include the
+  // asynchronous kernels on GPU, and the replays of the CUDA graph are not
+  // recorded.
+  void EnableOpLatencyStats(bool enable = true);
+
+  using OpLatencyHistograms =
+      std::map<std::string, std::unique_ptr<platform::LatencyHistogram>>;
+
+  const OpLatencyHistograms& op_latency_histograms() const {
+    return op_latency_histograms_;
+  }
+
  protected:
   void CreateOps(const ProgramDesc& desc, int block_id,
                  bool with_feed_fetch_ops);
 
+  void RunOps();
+
  private:
   const platform::Place place_;
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_;
+
+  bool use_static_memory_plan_{false};
+  std::unordered_set<std::string> memory_plan_outputs_;
+  std::unique_ptr<StaticMemoryPlan> memory_plan_;
+
+  size_t inter_op_parallelism_;
+  size_t run_num_{0};
+  std::unique_ptr<ParallelOpRunner> parallel_runner_;
+
+  bool use_op_latency_stats_{false};
+  OpLatencyHistograms op_latency_histograms_;
+  // the histogram of each op in ops_
+  std::vector<platform::LatencyHistogram*> op_histograms_;
+
+#ifdef PADDLE_WITH_CUDA
+  // The runs before capturing, which initialize the lazily created
+  // resources, e.g. the workspaces and the cuDNN algorithms, out of capture.
+  static constexpr size_t kCUDAGraphWarmupRuns = 1;
+
+  struct GraphInput {
+    const LoDTensor* tensor;
+    DDim dims;
+    LoD lod;
+    const void* data;
+  };
+
+  void CaptureCUDAGraph();
+
+  bool CUDAGraphInputsMatch() const;
+
+  void ResetCUDAGraph();
+
+  bool use_cuda_graph_{false};
+  size_t cuda_graph_run_num_{0};
+  std::unique_ptr<platform::CUDAGraph> cuda_graph_;
+  // keeps the memory used by the kernels of the graph
+  std::shared_ptr<memory::allocation::AllocationContext> cuda_graph_context_;
+  std::vector<GraphInput> cuda_graph_inputs_;
+#endif
 };
 
 }  // namespace framework
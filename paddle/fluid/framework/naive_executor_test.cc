@@ -15,8 +15,11 @@
 #include "paddle/fluid/framework/naive_executor.h"
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <string>
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/tensor_util.h"
 
 namespace paddle {
 namespace framework {
@@ -64,6 +67,184 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+TEST(NaiveExecutor, StaticMemoryPlan) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  // c = a + b, d = c + b, e = d + b
+  std::vector<std::string> names = {"a", "b", "c", "d", "e"};
+  for (auto& name : names) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  for (int i = 0; i < 3; ++i) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {names[i == 0 ? 0 : i + 1]});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {names[i + 2]});
+  }
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.EnableStaticMemoryPlan();
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  auto* e_tensor = exe.FindTensor("e");
+
+  auto run = [&](int64_t n) {
+    a_tensor->Resize({1, n});
+    b_tensor->Resize({1, n});
+    auto* a_data = a_tensor->mutable_data<float>(place);
+    auto* b_data = b_tensor->mutable_data<float>(place);
+    for (int64_t i = 0; i < n; i++) {
+      a_data[i] = i;
+      b_data[i] = 1;
+    }
+    exe.Run();
+    ASSERT_EQ(e_tensor->numel(), n);
+    auto* e_data = e_tensor->data<float>();
+    for (int64_t i = 0; i < n; i++) {
+      EXPECT_NEAR(e_data[i], i + 3, 1e-3);
+    }
+  };
+
+  run(4);
+  auto* plan = exe.static_memory_plan();
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(plan->PlannedTensorNum(), 3UL);
+  // c and d are not used at the same time with e
+  ASSERT_LT(plan->ArenaSize(), 3 * StaticMemoryPlan::kAlignment);
+
+  run(4);
+  ASSERT_EQ(exe.static_memory_plan(), plan);
+  // the plan is rebuilt after the input shapes change
+  run(16);
+  ASSERT_NE(exe.static_memory_plan(), nullptr);
+  run(16);
+}
+
+TEST(NaiveExecutor, StaticMemoryPlanKeepsOutputs) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  // c = a + b, d = c + b, e = d + b, and both c and e are the outputs
+  std::vector<std::string> names = {"a", "b", "c", "d", "e"};
+  for (auto& name : names) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  for (int i = 0; i < 3; ++i) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {names[i == 0 ? 0 : i + 1]});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {names[i + 2]});
+  }
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.EnableStaticMemoryPlan(true, {"c", "e"});
+  const int64_t n = 64;
+  TensorFromVector(std::vector<float>(n, 1), exe.FindTensor("a"));
+  TensorFromVector(std::vector<float>(n, 1), exe.FindTensor("b"));
+  exe.FindTensor("a")->Resize({1, n});
+  exe.FindTensor("b")->Resize({1, n});
+  for (int i = 0; i < 3; ++i) {
+    exe.Run();
+    // c, read by the later op, is not overwritten by e
+    std::vector<float> c, e;
+    TensorToVector(*exe.FindTensor("c"), &c);
+    TensorToVector(*exe.FindTensor("e"), &e);
+    ASSERT_EQ(c, std::vector<float>(n, 2));
+    ASSERT_EQ(e, std::vector<float>(n, 4));
+  }
+  auto* plan = exe.static_memory_plan();
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(plan->PlannedTensorNum(), 3UL);
+  // c is live with both d and e
+  ASSERT_GE(plan->ArenaSize(), 3 * n * sizeof(float));
+}
+
+TEST(NaiveExecutor, CUDAGraphOnCPU) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  // disabled on CPU, the ops run as normal
+  exe.EnableCUDAGraph();
+  TensorFromVector(std::vector<float>({1, 2}), exe.FindTensor("a"));
+  TensorFromVector(std::vector<float>({3, 4}), exe.FindTensor("b"));
+  for (int i = 0; i < 3; ++i) {
+    exe.Run();
+    ASSERT_FALSE(exe.IsCUDAGraphCaptured());
+  }
+  std::vector<float> c;
+  TensorToVector(*exe.FindTensor("c"), &c);
+  ASSERT_EQ(c, std::vector<float>({4, 6}));
+}
+
+#ifdef PADDLE_WITH_CUDA
+TEST(NaiveExecutor, CUDAGraph) {
+  if (!platform::CUDAGraph::IsSupported()) {
+    return;
+  }
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  // c = a + b, d = c + b
+  for (auto& name : {"a", "b", "c", "d"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  for (int i = 0; i < 2; ++i) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {i == 0 ? "a" : "c"});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {i == 0 ? "c" : "d"});
+  }
+
+  auto place = platform::CUDAPlace(0);
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.EnableCUDAGraph();
+
+  auto run = [&](const std::vector<float>& a, const std::vector<float>& b) {
+    // copied into the same memory
+    TensorFromVector(a, ctx, exe.FindTensor("a"));
+    TensorFromVector(b, ctx, exe.FindTensor("b"));
+    exe.FindTensor("a")->Resize({static_cast<int64_t>(a.size())});
+    exe.FindTensor("b")->Resize({static_cast<int64_t>(b.size())});
+    exe.Run();
+    std::vector<float> d;
+    TensorToVector(*exe.FindTensor("d"), ctx, &d);
+    ctx.Wait();
+    return d;
+  };
+
+  ASSERT_EQ(run({1, 2}, {1, 1}), std::vector<float>({3, 4}));
+  ASSERT_FALSE(exe.IsCUDAGraphCaptured());
+  ASSERT_EQ(run({1, 2}, {2, 2}), std::vector<float>({5, 6}));
+  ASSERT_TRUE(exe.IsCUDAGraphCaptured());
+  // replayed with the new values of the inputs
+  ASSERT_EQ(run({3, 4}, {1, 1}), std::vector<float>({5, 6}));
+  ASSERT_TRUE(exe.IsCUDAGraphCaptured());
+  // captured again after warming up with the new shapes
+  ASSERT_EQ(run({1, 2, 3}, {1, 1, 1}), std::vector<float>({3, 4, 5}));
+  ASSERT_FALSE(exe.IsCUDAGraphCaptured());
+  ASSERT_EQ(run({1, 2, 3}, {1, 1, 1}), std::vector<float>({3, 4, 5}));
+  ASSERT_TRUE(exe.IsCUDAGraphCaptured());
+}
+#endif
+
 }  // namespace framework
 }  // namespace paddle
 
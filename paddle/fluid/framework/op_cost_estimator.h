@@ -0,0 +1,45 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+
+namespace paddle {
+namespace framework {
+
+class ExecutionContext;
+
+// The floating point operations and the memory traffic of a run of an op,
+// which tell the profiler whether the op is compute bound or memory bound.
+struct OpCost {
+  double flops{0.0};
+  // Negative means the bytes of all the input and output tensors, which is
+  // the memory traffic of most of the ops.
+  double bytes{-1.0};
+};
+
+// Estimates the cost of an op, registered by REGISTER_OPERATOR with the
+// other classes of the op. It is called after the kernel runs, so that the
+// dims of the outputs are known.
+class OpCostEstimator {
+ public:
+  virtual ~OpCostEstimator() = default;
+  virtual OpCost operator()(const ExecutionContext& ctx) const = 0;
+};
+
+using OpCostFN = std::function<OpCost(const ExecutionContext&)>;
+
+}  // namespace framework
+}  // namespace paddle
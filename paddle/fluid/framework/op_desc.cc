@@ -287,7 +287,32 @@ OpDesc::OpDesc(const OpDesc &other, BlockDesc *block) {
   need_update_ = true;
 }
 
+OpDesc::OpDesc(const OpDesc &other) { *this = other; }
+
+OpDesc &OpDesc::operator=(const OpDesc &other) {
+  if (this != &other) {
+    other.Materialize();
+    view_.store(nullptr, std::memory_order_release);
+    desc_ = other.desc_;
+    block_ = other.block_;
+    inputs_ = other.inputs_;
+    outputs_ = other.outputs_;
+    attrs_ = other.attrs_;
+    need_update_ = other.need_update_;
+  }
+  return *this;
+}
+
+std::unique_ptr<OpDesc> OpDesc::CreateView(const proto::OpDesc *desc,
+                                           BlockDesc *block) {
+  std::unique_ptr<OpDesc> op(new OpDesc(block));
+  op->view_.store(desc, std::memory_order_release);
+  return op;
+}
+
 void OpDesc::CopyFrom(const OpDesc &op_desc) {
+  Materialize();
+  op_desc.Materialize();
   desc_.set_type(op_desc.Type());
   inputs_ = op_desc.inputs_;
   outputs_ = op_desc.outputs_;
@@ -296,7 +321,27 @@ void OpDesc::CopyFrom(const OpDesc &op_desc) {
 }
 
 OpDesc::OpDesc(const proto::OpDesc &desc, BlockDesc *block)
-    : desc_(desc), need_update_(false) {
+    : block_(block), need_update_(false) {
+  // The sub_block referred to by the BLOCK attr hasn't been added
+  // to ProgramDesc class yet, we skip setting BLOCK/BLOCKS attr here.
+  InitFromProto(desc, nullptr);
+}
+
+void OpDesc::MaterializeView() const {
+  // The ops are materialized rarely, so that they share a mutex.
+  static std::mutex mu;
+  std::lock_guard<std::mutex> guard(mu);
+  auto *view = view_.load(std::memory_order_relaxed);
+  if (view == nullptr) {
+    return;
+  }
+  InitFromProto(*view, block_ ? block_->Program() : nullptr);
+  view_.store(nullptr, std::memory_order_release);
+}
+
+void OpDesc::InitFromProto(const proto::OpDesc &desc,
+                           ProgramDesc *program) const {
+  desc_ = desc;
   // restore inputs_
   int input_size = desc_.inputs_size();
   for (int i = 0; i < input_size; ++i) {
@@ -322,22 +367,32 @@ OpDesc::OpDesc(const proto::OpDesc &desc, BlockDesc *block)
   // restore attrs_
   for (const proto::OpDesc::Attr &attr : desc_.attrs()) {
     std::string attr_name = attr.name();
-    // The sub_block referred to by the BLOCK attr hasn't been added
-    // to ProgramDesc class yet, we skip setting BLOCK/BLOCKS attr here.
-    if (attr.type() != proto::AttrType::BLOCK &&
-        attr.type() != proto::AttrType::BLOCKS) {
+    if (attr.type() == proto::AttrType::BLOCK) {
+      if (program != nullptr) {
+        attrs_[attr_name] = program->MutableBlock(attr.block_idx());
+      }
+    } else if (attr.type() == proto::AttrType::BLOCKS) {
+      if (program != nullptr) {
+        std::vector<BlockDesc *> blocks;
+        for (int blk_idx : attr.blocks_idx()) {
+          blocks.push_back(program->MutableBlock(blk_idx));
+        }
+        attrs_[attr_name] = blocks;
+      }
+    } else {
       attrs_[attr_name] = GetAttrValue(attr);
     }
   }
-  this->block_ = block;
 }
 
 proto::OpDesc *OpDesc::Proto() {
+  Materialize();
   Flush();
   return &desc_;
 }
 
 const std::vector<std::string> &OpDesc::Input(const std::string &name) const {
+  Materialize();
   auto it = inputs_.find(name);
   PADDLE_ENFORCE(it != inputs_.end(), "Input %s cannot be found in Op %s", name,
                  Type());
@@ -345,6 +400,7 @@ const std::vector<std::string> &OpDesc::Input(const std::string &name) const {
 }
 
 std::vector<std::string> OpDesc::InputArgumentNames() const {
+  Materialize();
   std::vector<std::string> retv;
   for (auto &ipt : this->inputs_) {
     retv.insert(retv.end(), ipt.second.begin(), ipt.second.end());
@@ -354,11 +410,13 @@ std::vector<std::string> OpDesc::InputArgumentNames() const {
 
 void OpDesc::SetInput(const std::string &param_name,
                       const std::vector<std::string> &args) {
+  Materialize();
   need_update_ = true;
   inputs_[param_name] = args;
 }
 
 const std::vector<std::string> &OpDesc::Output(const std::string &name) const {
+  Materialize();
   auto it = outputs_.find(name);
   PADDLE_ENFORCE(it != outputs_.end(), "Output %s cannot be found in Op %s",
                  name, Type());
@@ -366,6 +424,7 @@ const std::vector<std::string> &OpDesc::Output(const std::string &name) const {
 }
 
 std::vector<std::string> OpDesc::OutputArgumentNames() const {
+  Materialize();
   std::vector<std::string> retv;
   for (auto &ipt : this->outputs_) {
     retv.insert(retv.end(), ipt.second.begin(), ipt.second.end());
@@ -375,14 +434,15 @@ std::vector<std::string> OpDesc::OutputArgumentNames() const {
 
 void OpDesc::SetOutput(const std::string &param_name,
                        const std::vector<std::string> &args) {
+  Materialize();
   need_update_ = true;
   this->outputs_[param_name] = args;
 }
 
 bool OpDesc::HasProtoAttr(const std::string &name) const {
   auto &op_info = OpInfoMap::Instance();
-  if (op_info.Has(desc_.type())) {
-    auto op_info_ptr = op_info.Get(desc_.type());
+  if (op_info.Has(Type())) {
+    auto op_info_ptr = op_info.Get(Type());
     if (op_info_ptr.HasOpProtoAndChecker()) {
       const proto::OpProto &proto = op_info_ptr.Proto();
       for (int i = 0; i != proto.attrs_size(); ++i) {
@@ -397,12 +457,14 @@ bool OpDesc::HasProtoAttr(const std::string &name) const {
 }
 
 proto::AttrType OpDesc::GetAttrType(const std::string &name) const {
+  Materialize();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   return static_cast<proto::AttrType>(it->second.which() - 1);
 }
 
 std::vector<std::string> OpDesc::AttrNames() const {
+  Materialize();
   std::vector<std::string> retv;
   retv.reserve(attrs_.size());
   for (auto &attr : attrs_) {
@@ -412,11 +474,13 @@ std::vector<std::string> OpDesc::AttrNames() const {
 }
 
 void OpDesc::RemoveAttr(const std::string &name) {
+  Materialize();
   attrs_.erase(name);
   need_update_ = true;
 }
 
 void OpDesc::SetAttr(const std::string &name, const Attribute &v) {
+  Materialize();
   // NOTICE(minqiyang): pybind11 will take the empty list in python as
   // the std::vector<int> type in C++; so we have to change the attr's type
   // here if we meet this issue
@@ -482,23 +546,27 @@ void OpDesc::SetAttr(const std::string &name, const Attribute &v) {
 }
 
 void OpDesc::SetBlockAttr(const std::string &name, BlockDesc *block) {
+  Materialize();
   this->attrs_[name] = block;
   need_update_ = true;
 }
 
 void OpDesc::SetBlocksAttr(const std::string &name,
                            std::vector<BlockDesc *> blocks) {
+  Materialize();
   this->attrs_[name] = blocks;
   need_update_ = true;
 }
 
 void OpDesc::SetAttrMap(
     const std::unordered_map<std::string, Attribute> &attr_map) {
+  Materialize();
   attrs_ = attr_map;
   need_update_ = true;
 }
 
 Attribute OpDesc::GetAttr(const std::string &name) const {
+  Materialize();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   return it->second;
@@ -518,6 +586,7 @@ const proto::OpProto::Attr &OpDesc::GetProtoAttr(
 }
 
 Attribute OpDesc::GetNullableAttr(const std::string &name) const {
+  Materialize();
   auto it = attrs_.find(name);
   if (it != attrs_.end()) {
     return it->second;
@@ -527,6 +596,7 @@ Attribute OpDesc::GetNullableAttr(const std::string &name) const {
 }
 
 std::vector<int> OpDesc::GetBlocksAttrIds(const std::string &name) const {
+  Materialize();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   auto blocks = boost::get<std::vector<BlockDesc *>>(it->second);
@@ -540,12 +610,14 @@ std::vector<int> OpDesc::GetBlocksAttrIds(const std::string &name) const {
 }
 
 int OpDesc::GetBlockAttrId(const std::string &name) const {
+  Materialize();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   return boost::get<BlockDesc *>(it->second)->ID();
 }
 
 const std::unordered_map<std::string, Attribute> &OpDesc::GetAttrMap() const {
+  Materialize();
   return attrs_;
 }
 
@@ -557,6 +629,7 @@ void OpDesc::Rename(const std::string &old_name, const std::string &new_name) {
 
 void OpDesc::RenameOutput(const std::string &old_name,
                           const std::string &new_name) {
+  Materialize();
   for (auto &output : outputs_) {
     std::replace(output.second.begin(), output.second.end(), old_name,
                  new_name);
@@ -573,6 +646,7 @@ void OpDesc::RenameOutput(const std::string &old_name,
 
 void OpDesc::RenameInput(const std::string &old_name,
                          const std::string &new_name) {
+  Materialize();
   for (auto &input : inputs_) {
     std::replace(input.second.begin(), input.second.end(), old_name, new_name);
   }
@@ -662,6 +736,7 @@ void OpDesc::Flush() {
 }
 
 void OpDesc::CheckAttrs() {
+  Materialize();
   PADDLE_ENFORCE(!Type().empty(),
                  "CheckAttr() can not be called before type is set.");
   auto *checker = OpInfoMap::Instance().Get(Type()).Checker();
@@ -675,6 +750,7 @@ void OpDesc::CheckAttrs() {
 }
 
 void OpDesc::InferShape(const BlockDesc &block) const {
+  Materialize();
   try {
     VLOG(3) << "CompileTime infer shape on " << Type();
     auto &infer_shape = OpInfoMap::Instance().Get(this->Type()).infer_shape_;
@@ -14,6 +14,8 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -40,13 +42,30 @@ class OpDesc {
 
   OpDesc(const OpDesc &other, BlockDesc *block);
 
+  OpDesc(const OpDesc &other);
+
+  OpDesc &operator=(const OpDesc &other);
+
+  // Create the op as a view of desc, which should outlive the op, and build
+  // the inputs, outputs and attributes from desc at the first access, so that
+  // loading a large program does not build them for all the ops at once. The
+  // BLOCK and BLOCKS attributes are resolved in the program of block.
+  static std::unique_ptr<OpDesc> CreateView(const proto::OpDesc *desc,
+                                            BlockDesc *block);
+
   void CopyFrom(const OpDesc &op_desc);
 
   proto::OpDesc *Proto();
 
-  std::string Type() const { return desc_.type(); }
+  std::string Type() const {
+    auto *view = view_.load(std::memory_order_acquire);
+    return view ? view->type() : desc_.type();
+  }
 
-  void SetType(const std::string &type) { desc_.set_type(type); }
+  void SetType(const std::string &type) {
+    Materialize();
+    desc_.set_type(type);
+  }
 
   const std::vector<std::string> &Input(const std::string &name) const;
 
@@ -63,6 +82,7 @@ class OpDesc {
                  const std::vector<std::string> &args);
 
   bool HasAttr(const std::string &name) const {
+    Materialize();
     return attrs_.find(name) != attrs_.end();
   }
 
@@ -110,14 +130,27 @@ class OpDesc {
   // Only be used in C++
   void SetAttrMap(const AttributeMap &attr_map);
 
-  std::vector<std::string> InputNames() const { return MapKeys(inputs_); }
-  std::vector<std::string> OutputNames() const { return MapKeys(outputs_); }
+  std::vector<std::string> InputNames() const {
+    Materialize();
+    return MapKeys(inputs_);
+  }
+  std::vector<std::string> OutputNames() const {
+    Materialize();
+    return MapKeys(outputs_);
+  }
 
-  const VariableNameMap &Inputs() const { return inputs_; }
+  const VariableNameMap &Inputs() const {
+    Materialize();
+    return inputs_;
+  }
 
-  const VariableNameMap &Outputs() const { return outputs_; }
+  const VariableNameMap &Outputs() const {
+    Materialize();
+    return outputs_;
+  }
 
   AttributeMap *MutableAttrMap() {
+    Materialize();
     this->need_update_ = true;
     return &this->attrs_;
   }
@@ -128,7 +161,10 @@ class OpDesc {
 
   void InferVarType(BlockDesc *block) const;
 
-  void SetIsTarget(bool is_target) { desc_.set_is_target(is_target); }
+  void SetIsTarget(bool is_target) {
+    Materialize();
+    desc_.set_is_target(is_target);
+  }
 
   void Flush();
 
@@ -147,13 +183,28 @@ class OpDesc {
     return ret_val;
   }
 
-  proto::OpDesc desc_;
+  void Materialize() const {
+    if (view_.load(std::memory_order_acquire) != nullptr) {
+      MaterializeView();
+    }
+  }
+
+  void MaterializeView() const;
+
+  // Build desc_, inputs_, outputs_ and attrs_ from desc. The BLOCK and BLOCKS
+  // attributes are skipped if the program of block_ is not given.
+  void InitFromProto(const proto::OpDesc &desc, ProgramDesc *program) const;
+
+  // The members below are built from view_ in the const methods.
+  mutable proto::OpDesc desc_;
   BlockDesc *block_;  // not_own
   // input arg name => input variable names
-  VariableNameMap inputs_;
+  mutable VariableNameMap inputs_;
   // output arg name => output variable names
-  VariableNameMap outputs_;
-  AttributeMap attrs_;
+  mutable VariableNameMap outputs_;
+  mutable AttributeMap attrs_;
+  // the proto viewed until the op is materialized, see CreateView
+  mutable std::atomic<const proto::OpDesc *> view_{nullptr};
 
   // need_update_ indicate there some local changes not be synchronized. If
   // local changes should be synchronized, need_update_ should be set to true.
@@ -21,6 +21,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/attribute.h"
 #include "paddle/fluid/framework/no_need_buffer_vars_inference.h"
+#include "paddle/fluid/framework/op_cost_estimator.h"
 #include "paddle/fluid/framework/type_defs.h"
 #include "paddle/fluid/platform/macros.h"
 
@@ -44,6 +45,7 @@ class OpInfo {
   InferInplaceOpFN infer_inplace_;
   InferNoNeedBufferVarsFN infer_no_need_buffer_vars_;
   DygraphGradOpMakerFN dygraph_grad_op_maker_;
+  OpCostFN estimate_cost_;
 
   // NOTE(zjl): this flag is added to check whether
   // the grad maker is the default one.
@@ -114,6 +116,8 @@ class OpInfo {
 
   bool HasInferInplace() const { return infer_inplace_ != nullptr; }
 
+  bool HasCostEstimator() const { return estimate_cost_ != nullptr; }
+
   const OpAttrChecker* Checker() const { return checker_; }
 
   const InferNoNeedBufferVarsFN& NoNeedBufferVarsInferer() const {
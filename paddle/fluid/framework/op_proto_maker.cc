@@ -89,6 +89,10 @@ void OpProtoAndCheckerMaker::operator()(proto::OpProto* proto,
       .SetDefault({});
   AddAttr<std::string>(OpDeviceAttrName(), "Device type of this operator.")
       .SetDefault("");
+  AddAttr<std::string>(OpStreamAttrName(),
+                       "The CUDA stream this operator runs on, i.e. compute, "
+                       "h2d, d2h or comm, empty for compute.")
+      .SetDefault("");
   Validate();
 }
 
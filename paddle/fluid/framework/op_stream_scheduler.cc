@@ -0,0 +1,131 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/framework/op_stream_scheduler.h"
+#include <utility>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+uint32_t StreamBit(platform::CUDAStreamType type) {
+  return 1u << static_cast<int>(type);
+}
+
+std::vector<std::string> FlattenVarNames(const VariableNameMap& var_map) {
+  std::vector<std::string> names;
+  for (auto& pair : var_map) {
+    for (auto& name : pair.second) {
+      if (name != kEmptyVarName) {
+        names.emplace_back(name);
+      }
+    }
+  }
+  return names;
+}
+
+}  // namespace
+
+std::unique_ptr<OpStreamScheduler> OpStreamScheduler::Create(
+    const std::vector<std::unique_ptr<OperatorBase>>& ops,
+    const platform::Place& place) {
+  if (!platform::is_gpu_place(place)) {
+    return nullptr;
+  }
+  const std::string attr_name = OpProtoAndCheckerMaker::OpStreamAttrName();
+  std::vector<platform::CUDAStreamType> op_streams;
+  op_streams.reserve(ops.size());
+  bool has_side_stream = false;
+  for (auto& op : ops) {
+    auto type = op->HasAttr(attr_name)
+                    ? platform::StringToCUDAStreamType(
+                          op->Attr<std::string>(attr_name))
+                    : platform::CUDAStreamType::kCompute;
+    has_side_stream |= type != platform::CUDAStreamType::kCompute;
+    op_streams.emplace_back(type);
+  }
+  if (!has_side_stream) {
+    return nullptr;
+  }
+  auto* dev_ctx = static_cast<const platform::CUDADeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(place));
+  return std::unique_ptr<OpStreamScheduler>(
+      new OpStreamScheduler(ops, std::move(op_streams), dev_ctx));
+}
+
+OpStreamScheduler::OpStreamScheduler(
+    const std::vector<std::unique_ptr<OperatorBase>>& ops,
+    std::vector<platform::CUDAStreamType> op_streams,
+    const platform::CUDADeviceContext* dev_ctx)
+    : dev_ctx_(dev_ctx), op_streams_(std::move(op_streams)) {
+  inputs_.reserve(ops.size());
+  outputs_.reserve(ops.size());
+  for (auto& op : ops) {
+    inputs_.emplace_back(FlattenVarNames(op->Inputs()));
+    outputs_.emplace_back(FlattenVarNames(op->Outputs()));
+  }
+}
+
+void OpStreamScheduler::RunOp(size_t i,
+                              const std::function<void(size_t)>& run_op,
+                              bool deletes_vars) {
+  auto stream = op_streams_[i];
+  uint32_t self = StreamBit(stream);
+  uint32_t waits = 0;
+  for (auto& name : inputs_[i]) {
+    auto iter = var_states_.find(name);
+    if (iter != var_states_.end()) {
+      waits |= iter->second.writer;
+    }
+  }
+  for (auto& name : outputs_[i]) {
+    auto iter = var_states_.find(name);
+    if (iter != var_states_.end()) {
+      waits |= iter->second.writer | iter->second.readers;
+    }
+  }
+  waits &= ~self;
+  for (int type = 0; waits != 0; ++type, waits >>= 1) {
+    if (waits & 1u) {
+      dev_ctx_->StreamWaitStream(stream,
+                                 static_cast<platform::CUDAStreamType>(type));
+    }
+  }
+
+  if (stream == platform::CUDAStreamType::kCompute) {
+    run_op(i);
+  } else {
+    platform::CUDAThreadContextGuard guard(&dev_ctx_->context(stream));
+    run_op(i);
+  }
+
+  for (auto& name : inputs_[i]) {
+    var_states_[name].readers |= self;
+  }
+  for (auto& name : outputs_[i]) {
+    auto& state = var_states_[name];
+    state.writer = self;
+    state.readers = 0;
+  }
+  if (deletes_vars && stream != platform::CUDAStreamType::kCompute) {
+    dev_ctx_->StreamWaitStream(platform::CUDAStreamType::kCompute, stream);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
+#endif
@@ -0,0 +1,79 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#ifdef PADDLE_WITH_CUDA
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+
+/**
+ * OpStreamScheduler runs the ops of a block with the op_stream attribute on
+ * the streams of the CUDA device context, e.g. the copies of the next inputs
+ * on the h2d stream, so that they overlap the kernels on the compute stream.
+ * An op waits, by the events recorded on the other streams, for the ops
+ * writing its inputs, and for the ops reading or writing its outputs. The
+ * compute stream waits for an op on another stream before the unused
+ * variables of the op are deleted, since their memory may be reused by the
+ * kernels on the compute stream right away.
+ */
+class OpStreamScheduler {
+ public:
+  // Return nullptr if place is not a CUDAPlace, or all the ops run on the
+  // compute stream.
+  static std::unique_ptr<OpStreamScheduler> Create(
+      const std::vector<std::unique_ptr<OperatorBase>>& ops,
+      const platform::Place& place);
+
+  // Forget the ops of the last run, whose streams are all waited at its end.
+  void Reset() { var_states_.clear(); }
+
+  // Run the i-th op by run_op(i) on its stream. deletes_vars tells whether
+  // the unused variables of the op are deleted after it.
+  void RunOp(size_t i, const std::function<void(size_t)>& run_op,
+             bool deletes_vars);
+
+  platform::CUDAStreamType OpStream(size_t i) const { return op_streams_[i]; }
+
+ private:
+  // The streams which wrote a variable last, and read it after, as bit
+  // masks of the stream types.
+  struct VarState {
+    uint32_t writer{0};
+    uint32_t readers{0};
+  };
+
+  OpStreamScheduler(const std::vector<std::unique_ptr<OperatorBase>>& ops,
+                    std::vector<platform::CUDAStreamType> op_streams,
+                    const platform::CUDADeviceContext* dev_ctx);
+
+  const platform::CUDADeviceContext* dev_ctx_;
+  std::vector<platform::CUDAStreamType> op_streams_;
+  std::vector<std::vector<std::string>> inputs_;
+  std::vector<std::vector<std::string>> outputs_;
+  std::unordered_map<std::string, VarState> var_states_;
+};
+
+}  // namespace framework
+}  // namespace paddle
+#endif
@@ -21,6 +21,7 @@ limitations under the License. */
 #include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/data_transform.h"
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -31,6 +32,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/unused_var_check.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/platform/memory_profiler.h"
 #include "paddle/fluid/platform/profiler.h"
 
 #ifdef PADDLE_WITH_MKLDNN
@@ -44,6 +46,10 @@ DEFINE_int32(inner_op_parallelism, 0, "number of threads for inner op");
 DEFINE_bool(fast_check_nan_inf, false,
             "Fast checking NAN/INF after each operation. It will be a little"
             "bit slow, much faster than check_nan_inf");
+DEFINE_bool(enable_infer_shape_cache, false,
+            "Skip the InferShape of an op if the shapes of its inputs are the "
+            "same as the last run, and reuse the output shapes inferred then. "
+            "It is for the models with static shapes.");
 
 namespace paddle {
 namespace framework {
@@ -154,7 +160,106 @@ RuntimeContext::RuntimeContext(const VariableNameMap& innames,
   }
 }
 
+static void FindVarsBySlots(const VariableNameMap& names,
+                            const VariableSlotMap& slots, const Scope& scope,
+                            VariableValueMap* vars) {
+  auto slot_it = slots.begin();
+  for (auto& var_name_item : names) {
+    std::vector<Variable*>& var_list = (*vars)[var_name_item.first];
+    var_list.reserve(var_name_item.second.size());
+    auto& slot_list = (slot_it++)->second;
+    for (size_t i = 0; i < var_name_item.second.size(); ++i) {
+      var_list.push_back(scope.FindVar(slot_list[i], var_name_item.second[i]));
+    }
+  }
+}
+
+RuntimeContext::RuntimeContext(const VariableNameMap& innames,
+                               const VariableNameMap& outnames,
+                               const VariableSlotMap& inslots,
+                               const VariableSlotMap& outslots,
+                               const Scope& scope) {
+  FindVarsBySlots(innames, inslots, scope, &inputs);
+  FindVarsBySlots(outnames, outslots, scope, &outputs);
+}
+
+static VariableSlotMap VarSlots(const VariableNameMap& names) {
+  VariableSlotMap slots;
+  for (auto& var_name_item : names) {
+    auto& slot_list = slots[var_name_item.first];
+    slot_list.reserve(var_name_item.second.size());
+    for (auto& var_name : var_name_item.second) {
+      slot_list.push_back(Scope::VarSlot(var_name));
+    }
+  }
+  return slots;
+}
+
+static platform::MemoryCategory OutputMemoryCategory(
+    const std::string& slot, const std::string& var_name, int op_role,
+    bool persistable) {
+  if (var_name.find(kGradVarSuffix) != std::string::npos) {
+    return platform::MemoryCategory::kGradient;
+  }
+  if (op_role & (static_cast<int>(OpRole::kOptimize) |
+                 static_cast<int>(OpRole::kLRSched))) {
+    return slot == "ParamOut" ? platform::MemoryCategory::kParameter
+                              : platform::MemoryCategory::kOptimizerState;
+  }
+  // The persistable variables are in the root scope, and the accumulators of
+  // the optimizers are told apart once they are written by the optimizers.
+  return persistable ? platform::MemoryCategory::kParameter
+                     : platform::MemoryCategory::kActivation;
+}
+
+// Attribute the allocations holding the outputs to the output variables, see
+// platform::MemoryProfiler.
+static void AnnotateOutputMemory(const OperatorBase& op, const Scope& scope) {
+  int op_role = op.HasAttr(OpProtoAndCheckerMaker::OpRoleAttrName())
+                    ? op.Attr<int>(OpProtoAndCheckerMaker::OpRoleAttrName())
+                    : 0;
+  auto& profiler = platform::MemoryProfiler::Instance();
+  auto annotate = [&](const Tensor& tensor, const std::string& slot,
+                      const std::string& var_name, bool persistable) {
+    if (!tensor.IsInitialized()) return;
+    auto& holder = tensor.Holder();
+    profiler.Annotate(
+        holder->ptr(), holder->place(), var_name,
+        OutputMemoryCategory(slot, var_name, op_role, persistable));
+  };
+  for (auto& pair : op.Outputs()) {
+    for (auto& var_name : pair.second) {
+      if (var_name == kEmptyVarName) continue;
+      auto* var = scope.FindVar(var_name);
+      if (var == nullptr) continue;
+      auto* var_scope = scope.FindScope(var);
+      bool persistable = var_scope != nullptr && var_scope->parent() == nullptr;
+      if (var->IsType<LoDTensor>()) {
+        annotate(var->Get<LoDTensor>(), pair.first, var_name, persistable);
+      } else if (var->IsType<SelectedRows>()) {
+        annotate(var->Get<SelectedRows>().value(), pair.first, var_name,
+                 persistable);
+      } else if (var->IsType<LoDTensorArray>()) {
+        for (auto& tensor : var->Get<LoDTensorArray>()) {
+          annotate(tensor, pair.first, var_name, persistable);
+        }
+      }
+    }
+  }
+}
+
+void OperatorBase::BindVarSlots() {
+  input_slots_ = VarSlots(inputs_);
+  output_slots_ = VarSlots(outputs_);
+  has_var_slots_ = true;
+}
+
 void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
+  Run(scope, place, nullptr);
+}
+
+void OperatorBase::Run(const Scope& scope, const platform::Place& place,
+                       RuntimeContext* runtime_ctx) {
   try {
     VLOG(4) << place << " " << DebugStringEx(&scope);
     if (platform::is_gpu_place(place)) {
@@ -174,7 +279,15 @@ void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
       auto op_name = platform::OpName(outputs_, Type());
       platform::RecordEvent op_name_record_event(
           op_name, platform::EventRole::kUniqueOp);
-      RunImpl(scope, place);
+      platform::MemoryProfiler::OpScope memory_op_scope(&Type());
+      if (runtime_ctx == nullptr) {
+        RunImpl(scope, place);
+      } else {
+        RunBoundImpl(scope, place, runtime_ctx);
+      }
+      if (UNLIKELY(platform::MemoryProfiler::IsEnabled())) {
+        AnnotateOutputMemory(*this, scope);
+      }
     }
 
     VLOG(3) << place << " " << DebugStringEx(&scope);
@@ -905,6 +1018,104 @@ void OperatorWithKernel::RuntimeInferShape(const Scope& scope,
   this->InferShape(&infer_shape_ctx);
 }
 
+// Records the shapes of vars into shapes, or returns false if any of them is
+// not a LoDTensor.
+template <typename Shape>
+static bool RecordShapes(const VariableValueMap& vars,
+                         std::vector<Shape>* shapes) {
+  shapes->clear();
+  for (auto& pair : vars) {
+    for (auto* var : pair.second) {
+      Shape shape;
+      if (var != nullptr) {
+        if (!var->IsType<LoDTensor>()) return false;
+        auto& tensor = var->Get<LoDTensor>();
+        shape.null = false;
+        shape.dims = tensor.dims();
+        shape.lod = tensor.lod();
+        shape.layout = tensor.layout();
+      }
+      shapes->emplace_back(std::move(shape));
+    }
+  }
+  return true;
+}
+
+// Whether vars are the LoDTensors of the same shapes, or the same null ones.
+template <typename Shape>
+static bool MatchShapes(const VariableValueMap& vars,
+                        const std::vector<Shape>& shapes, bool check_dims) {
+  size_t i = 0;
+  for (auto& pair : vars) {
+    for (auto* var : pair.second) {
+      if (i >= shapes.size()) return false;
+      auto& shape = shapes[i++];
+      if (var == nullptr || shape.null) {
+        if (var != nullptr || !shape.null) return false;
+        continue;
+      }
+      if (!var->IsType<LoDTensor>()) return false;
+      if (!check_dims) continue;
+      auto& tensor = var->Get<LoDTensor>();
+      if (tensor.dims() != shape.dims || !(tensor.lod() == shape.lod)) {
+        return false;
+      }
+    }
+  }
+  return i == shapes.size();
+}
+
+bool OperatorWithKernel::InferShapeCache::Record(const RuntimeContext& ctx) {
+  valid = RecordShapes(ctx.inputs, &inputs) &&
+          RecordShapes(ctx.outputs, &outputs);
+  return valid;
+}
+
+bool OperatorWithKernel::InferShapeCache::Match(
+    const RuntimeContext& ctx) const {
+  return valid && MatchShapes(ctx.inputs, inputs, true) &&
+         MatchShapes(ctx.outputs, outputs, false);
+}
+
+void OperatorWithKernel::InferShapeCache::Restore(
+    const RuntimeContext& ctx) const {
+  size_t i = 0;
+  for (auto& pair : ctx.outputs) {
+    for (auto* var : pair.second) {
+      auto& shape = outputs[i++];
+      if (var == nullptr) continue;
+      // the same as SetOutputDim and ShareLoD, but skips the unchanged ones
+      auto* tensor = var->GetMutable<LoDTensor>();
+      if (tensor->dims() != shape.dims) tensor->Resize(shape.dims);
+      if (!(tensor->lod() == shape.lod)) tensor->set_lod(shape.lod);
+      if (tensor->layout() != shape.layout) tensor->set_layout(shape.layout);
+    }
+  }
+}
+
+void OperatorWithKernel::InferShapeWithCache(
+    const RuntimeContext& runtime_ctx) const {
+  // The MKLDNN kernels set the layouts of the outputs by themselves, which
+  // can not be restored as InferShape leaves them.
+  bool use_cache = FLAGS_enable_infer_shape_cache && !IsMKLDNNType();
+  auto& cache = infer_shape_cache_;
+  if (use_cache && cache && cache->Match(runtime_ctx)) {
+    cache->Restore(runtime_ctx);
+    return;
+  }
+
+  RuntimeInferShapeContext infer_shape_ctx(*this, runtime_ctx);
+  this->InferShape(&infer_shape_ctx);
+
+  if (use_cache) {
+    if (!cache) cache.reset(new InferShapeCache);
+    // the ops with other types of variables always run InferShape
+    if (!cache->Record(runtime_ctx)) {
+      VLOG(4) << "the shapes of " << Type() << " are not cached";
+    }
+  }
+}
+
 std::vector<KernelConfig>* OperatorWithKernel::GetKernelConfig(
     const OpKernelType& key) const {
   auto config_iter = kernel_configs_map_.find(key);
@@ -921,13 +1132,16 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   // result of HasAttr.
   if (!enable_cache_runtime_context_ && HasAttr(kEnableCacheRuntimeContext))
     enable_cache_runtime_context_ = true;
-  if (!all_kernels_must_compute_runtime_shape_ &&
-      HasAttr(kAllKernelsMustComputeRuntimeShape))
-    all_kernels_must_compute_runtime_shape_ = true;
   const Scope* cur_scope = &scope;
   if (!enable_cache_runtime_context_) {
-    RuntimeContext ctx(Inputs(), Outputs(), scope);
-    RunImpl(scope, place, &ctx);
+    if (HasVarSlots()) {
+      RuntimeContext ctx(Inputs(), Outputs(), InputSlots(), OutputSlots(),
+                         scope);
+      RunImpl(scope, place, &ctx);
+    } else {
+      RuntimeContext ctx(Inputs(), Outputs(), scope);
+      RunImpl(scope, place, &ctx);
+    }
     pre_scope_ = cur_scope;
   } else {
     if (runtime_ctx_.get() == nullptr || pre_scope_ != cur_scope) {
@@ -941,9 +1155,21 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 }
 
+void OperatorWithKernel::RunBoundImpl(const Scope& scope,
+                                      const platform::Place& place,
+                                      RuntimeContext* runtime_ctx) const {
+  // the runtime context is kept for scope by the caller, the same as the
+  // cached one, so that the data transform can be skipped
+  pre_scope_ = &scope;
+  RunImpl(scope, place, runtime_ctx);
+}
+
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const platform::Place& place,
                                  RuntimeContext* runtime_ctx) const {
+  if (!all_kernels_must_compute_runtime_shape_ &&
+      HasAttr(kAllKernelsMustComputeRuntimeShape))
+    all_kernels_must_compute_runtime_shape_ = true;
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto* dev_ctx = pool.Get(place);
 
@@ -975,8 +1201,7 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   if (!all_kernels_must_compute_runtime_shape_) {
     platform::RecordEvent record_event("infer_shape",
                                        platform::EventRole::kInnerOp);
-    RuntimeInferShapeContext infer_shape_ctx(*this, *runtime_ctx);
-    this->InferShape(&infer_shape_ctx);
+    InferShapeWithCache(*runtime_ctx);
   }
 
   if (FLAGS_enable_unused_var_check) {
@@ -988,8 +1213,13 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   {
     platform::RecordEvent record_event("compute",
                                        platform::EventRole::kInnerOp);
-    (*kernel_func_)(ExecutionContext(*this, exec_scope, *dev_ctx, *runtime_ctx,
-                                     kernel_configs));
+    ExecutionContext exe_ctx(*this, exec_scope, *dev_ctx, *runtime_ctx,
+                             kernel_configs);
+    if (UNLIKELY(platform::IsProfileEnabled())) {
+      RunKernelAndRecordCost(exe_ctx, *runtime_ctx);
+    } else {
+      (*kernel_func_)(exe_ctx);
+    }
   }
 
   if (!transfered_inplace_vars.empty()) {
@@ -1041,6 +1271,54 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 }
 
+// The bytes of the tensors in var_map, whose sum over the inputs and the
+// outputs is the default memory traffic of an op.
+static double TensorBytes(const VariableValueMap& var_map) {
+  double bytes = 0;
+  for (auto& pair : var_map) {
+    for (auto* var : pair.second) {
+      const Tensor* tensor = nullptr;
+      if (var == nullptr) {
+        continue;
+      } else if (var->IsType<LoDTensor>()) {
+        tensor = &var->Get<LoDTensor>();
+      } else if (var->IsType<SelectedRows>()) {
+        tensor = &var->Get<SelectedRows>().value();
+      }
+      if (tensor && tensor->IsInitialized()) {
+        bytes += tensor->numel() * SizeOfType(tensor->type());
+      }
+    }
+  }
+  return bytes;
+}
+
+void OperatorWithKernel::RunKernelAndRecordCost(
+    const ExecutionContext& ctx, const RuntimeContext& runtime_ctx) const {
+  std::unique_ptr<platform::RecordOpCost> record_cost;
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(ctx.GetPlace())) {
+    record_cost.reset(new platform::RecordOpCost(
+        Type(), ctx.GetPlace(), ctx.cuda_device_context().stream()));
+  }
+#endif
+  if (!record_cost) {
+    record_cost.reset(new platform::RecordOpCost(Type()));
+  }
+  (*kernel_func_)(ctx);
+  record_cost->Stop();
+
+  OpCost cost;
+  if (info_ && info_->HasCostEstimator()) {
+    cost = info_->estimate_cost_(ctx);
+  }
+  if (cost.bytes < 0) {
+    cost.bytes =
+        TensorBytes(runtime_ctx.inputs) + TensorBytes(runtime_ctx.outputs);
+  }
+  record_cost->SetCost(cost.flops, cost.bytes);
+}
+
 void OperatorWithKernel::ChooseKernel(const RuntimeContext& ctx,
                                       const Scope& scope,
                                       const platform::Place& place) const {
@@ -1250,6 +1528,32 @@ Scope* OperatorWithKernel::PrepareData(
       }
       auto* trans_var = new_scope->Var(var_name);
       input_vars[i] = trans_var;
+
+      // In the inference, the persistable inputs, which are created in the
+      // ancestors of the scope, are usually the parameters never changed, so
+      // their transformed data, e.g. the weights transformed to the layout of
+      // MKL-DNN, is cached and reused until they are changed.
+      bool is_inplace = !transfered_inplace_vars->empty() &&
+                        transfered_inplace_vars->back() == var_name;
+      if (!run_by_executor_ && !is_inplace &&
+          scope.FindLocalVar(var_name) == nullptr) {
+        auto& cached = transformed_data_cache_[var_name];
+        if (cached && cached->IsValidFor(*tensor_in, kernel_type_for_var,
+                                         expected_kernel_key)) {
+          VLOG(3) << "Reuse the transformed data of " << var_name;
+        } else {
+          cached.reset(
+              new TransformedData(kernel_type_for_var, expected_kernel_key));
+          TransformData(expected_kernel_key, kernel_type_for_var, *tensor_in,
+                        &cached->out);
+          cached->holder = tensor_in->Holder();
+          cached->offset = tensor_in->offset();
+          cached->version = tensor_in->version();
+        }
+        SetTensorToVariable(*var, cached->out, trans_var);
+        continue;
+      }
+
       Tensor out;
       TransformData(expected_kernel_key, kernel_type_for_var, *tensor_in, &out);
       SetTensorToVariable(*var, out, trans_var);
@@ -114,6 +114,12 @@ class RuntimeContext {
   RuntimeContext(const VariableNameMap& innames,
                  const VariableNameMap& outnames, const Scope& scope);
 
+  // Find the variables by their slots, see Scope::VarSlot.
+  RuntimeContext(const VariableNameMap& innames,
+                 const VariableNameMap& outnames,
+                 const VariableSlotMap& inslots,
+                 const VariableSlotMap& outslots, const Scope& scope);
+
   RuntimeContext(const VariableValueMap& invars,
                  const VariableValueMap& outvars)
       : inputs(invars), outputs(outvars) {}
@@ -139,6 +145,11 @@ class OperatorBase {
   //  The implementation should be written at RunImpl
   void Run(const Scope& scope, const platform::Place& place);
 
+  /// Run with the variables of the op bound to scope by the caller, e.g. the
+  /// compiled ExecutorPrepareContext, instead of looking them up in scope.
+  void Run(const Scope& scope, const platform::Place& place,
+           RuntimeContext* runtime_ctx);
+
   // FIXME(typhoonzero): this is only used for recv_op to stop event_loop.
   virtual void Stop() {}
 
@@ -186,6 +197,13 @@ class OperatorBase {
 
   void SetIsCalledByExecutor(bool x) { run_by_executor_ = x; }
 
+  /// Assign the slots of the inputs and outputs, so that they are found by
+  /// the slots in the scopes reserving the slots, e.g. by the executors.
+  void BindVarSlots();
+  bool HasVarSlots() const { return has_var_slots_; }
+  const VariableSlotMap& InputSlots() const { return input_slots_; }
+  const VariableSlotMap& OutputSlots() const { return output_slots_; }
+
   virtual void RuntimeInferShape(const Scope& scope,
                                  const platform::Place& place,
                                  const RuntimeContext& ctx) const {}
@@ -209,11 +227,20 @@ class OperatorBase {
   // Whether this operator executes in an Executor.
   bool run_by_executor_{true};
 
+  bool has_var_slots_{false};
+  VariableSlotMap input_slots_;
+  VariableSlotMap output_slots_;
+
  private:
   void GenerateTemporaryNames();
   void CheckAllInputOutputSet() const;
   virtual void RunImpl(const Scope& scope,
                        const platform::Place& place) const = 0;
+  // The ops without kernels look up their variables by themselves.
+  virtual void RunBoundImpl(const Scope& scope, const platform::Place& place,
+                            RuntimeContext* runtime_ctx) const {
+    RunImpl(scope, place);
+  }
 };
 
 #ifdef PADDLE_WITH_CUDA
@@ -507,6 +534,10 @@ class OperatorWithKernel : public OperatorBase {
       const std::string& var_name, const Tensor& tensor,
       const OpKernelType& expected_kernel_type) const;
 
+  // Check whether the inputs need the data transform again in the next run,
+  // e.g. after their places or layouts change.
+  void ResetDataTransformCache() const { need_prepare_data_ = true; }
+
  private:
   void ParseInputDataType(const ExecutionContext& ctx, const std::string& name,
                           proto::VarType::Type* type) const;
@@ -516,6 +547,8 @@ class OperatorWithKernel : public OperatorBase {
   void RunImpl(const Scope& scope, const platform::Place& place) const final;
   void RunImpl(const Scope& scope, const platform::Place& place,
                RuntimeContext* runtime_ctx) const;
+  void RunBoundImpl(const Scope& scope, const platform::Place& place,
+                    RuntimeContext* runtime_ctx) const final;
 
   /**
    * Transfer data from scope to a transferred scope. If there is no data need
@@ -536,6 +569,61 @@ class OperatorWithKernel : public OperatorBase {
   void ChooseKernel(const RuntimeContext& ctx, const Scope& scope,
                     const platform::Place& place) const;
 
+  // Runs InferShape, or with FLAGS_enable_infer_shape_cache, restores the
+  // output shapes inferred by the last run if the inputs have the same
+  // shapes.
+  void InferShapeWithCache(const RuntimeContext& runtime_ctx) const;
+
+  // Runs the kernel, and records its duration with the FLOPs and the bytes
+  // estimated for it into the profiler.
+  void RunKernelAndRecordCost(const ExecutionContext& ctx,
+                              const RuntimeContext& runtime_ctx) const;
+
+  // The transformed data of a persistable input, which is reused as long as
+  // the input is unchanged, i.e. has the same memory block and version.
+  struct TransformedData {
+    TransformedData(const OpKernelType& from, const OpKernelType& to)
+        : kernel_type_for_var(from), expected_kernel_key(to) {}
+
+    bool IsValidFor(const Tensor& tensor_in, const OpKernelType& from,
+                    const OpKernelType& to) const {
+      return !holder.expired() && holder.lock() == tensor_in.Holder() &&
+             offset == tensor_in.offset() &&
+             version == tensor_in.version() && kernel_type_for_var == from &&
+             expected_kernel_key == to;
+    }
+
+    std::weak_ptr<memory::Allocation> holder;
+    size_t offset{0};
+    uint64_t version{0};
+    OpKernelType kernel_type_for_var;
+    OpKernelType expected_kernel_key;
+    Tensor out;
+  };
+
+  // The shapes of the inputs and the outputs after InferShape, keyed by the
+  // order of the variables in RuntimeContext. Only the ops whose variables
+  // are all LoDTensors are cached.
+  struct InferShapeCache {
+    // Returns false if any of the variables is not a LoDTensor.
+    bool Record(const RuntimeContext& ctx);
+    // Whether the inputs have the cached shapes, and the outputs are still
+    // LoDTensors.
+    bool Match(const RuntimeContext& ctx) const;
+    void Restore(const RuntimeContext& ctx) const;
+
+    struct Shape {
+      bool null{true};
+      DDim dims;
+      LoD lod;
+      DataLayout layout{DataLayout::kAnyLayout};
+    };
+
+    bool valid{false};
+    std::vector<Shape> inputs;
+    std::vector<Shape> outputs;
+  };
+
  protected:
   mutable OpKernelConfigsMap kernel_configs_map_;
   mutable std::unique_ptr<OpKernelType> kernel_type_;
@@ -547,6 +635,10 @@ class OperatorWithKernel : public OperatorBase {
   mutable bool all_kernels_must_compute_runtime_shape_ = false;
   mutable std::mutex cache_update_mutex_;
   mutable bool enable_cache_transfer_scope_ = false;
+  // keyed by the names of the inputs
+  mutable std::unordered_map<std::string, std::unique_ptr<TransformedData>>
+      transformed_data_cache_;
+  mutable std::unique_ptr<InferShapeCache> infer_shape_cache_;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
@@ -17,8 +17,10 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(enable_unused_var_check);
+DECLARE_bool(enable_infer_shape_cache);
 
 namespace paddle {
 namespace framework {
@@ -678,6 +680,15 @@ class OpWithoutUnusedVarKernelTest : public OpKernel<T> {
   }
 };
 
+class OpCostEstimatorTest : public OpCostEstimator {
+ public:
+  OpCost operator()(const ExecutionContext& ctx) const override {
+    OpCost cost;
+    cost.flops = 2.0 * ctx.Output<Tensor>("Y")->numel();
+    return cost;
+  }
+};
+
 }  // namespace framework
 }  // namespace paddle
 
@@ -744,3 +755,136 @@ TEST(OpWithoutUnusedVar, all) {
   ASSERT_NO_THROW(op->Run(scope, cpu_place));
   FLAGS_enable_unused_var_check = false;
 }
+
+REGISTER_OPERATOR(op_with_cost_estimator, paddle::framework::OpUnusedVarTest,
+                  paddle::framework::OpUnusedVarTestProtoAndCheckerMaker,
+                  paddle::framework::OpCostEstimatorTest);
+
+REGISTER_OP_CPU_KERNEL(op_with_cost_estimator,
+                       paddle::framework::OpWithoutUnusedVarKernelTest<float>);
+
+TEST(OpCostEstimator, profiler) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_with_cost_estimator");
+  BuildVar("X", {"X"}, op_desc.add_inputs());
+  BuildVar("Y", {"Y"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("X")->GetMutable<paddle::framework::LoDTensor>();
+  auto* y = scope.Var("Y")->GetMutable<paddle::framework::LoDTensor>();
+  x->Resize({32, 64});
+  y->Resize({32, 64});
+  x->mutable_data<float>(cpu_place);
+  y->mutable_data<float>(cpu_place);
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  ASSERT_TRUE(op->Info().HasCostEstimator());
+  paddle::platform::EnableProfiler(paddle::platform::ProfilerState::kCPU);
+  op->Run(scope, cpu_place);
+  op->Run(scope, cpu_place);
+
+  bool found = false;
+  for (auto& item : paddle::platform::GetOpCostEventItems()) {
+    if (item.name != "op_with_cost_estimator") continue;
+    found = true;
+    EXPECT_EQ(item.device, -1);
+    EXPECT_EQ(item.calls, 2UL);
+    EXPECT_DOUBLE_EQ(item.total_flops, 2 * 2.0 * 32 * 64);
+    // The bytes of X and Y by default.
+    EXPECT_DOUBLE_EQ(item.total_bytes, 2 * 2.0 * 32 * 64 * sizeof(float));
+    EXPECT_DOUBLE_EQ(item.intensity, 0.25);
+  }
+  EXPECT_TRUE(found);
+  paddle::platform::DisableProfiler(paddle::platform::EventSortingKey::kTotal,
+                                    "/tmp/op_cost_profiler");
+  EXPECT_TRUE(paddle::platform::GetOpCostEventItems().empty());
+}
+
+namespace paddle {
+namespace framework {
+
+static int infer_shape_num = 0;
+
+class OpInferShapeCacheTest : public OperatorWithKernel {
+ public:
+  using OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    ++infer_shape_num;
+    auto dims = ctx->GetInputDim("X");
+    dims[0] *= 2;
+    ctx->SetOutputDim("Y", dims);
+    ctx->ShareLoD("X", "Y");
+  }
+  OpKernelType GetExpectedKernelType(
+      const ExecutionContext& ctx) const override {
+    return OpKernelType(proto::VarType::FP32, ctx.GetPlace());
+  }
+};
+
+template <typename T>
+class OpInferShapeCacheKernelTest : public OpKernel<T> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    auto* y = ctx.Output<LoDTensor>("Y");
+    y->mutable_data<T>(ctx.GetPlace());
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    op_infer_shape_cache, paddle::framework::OpInferShapeCacheTest,
+    paddle::framework::OpUnusedVarTestProtoAndCheckerMaker);
+
+REGISTER_OP_CPU_KERNEL(op_infer_shape_cache,
+                       paddle::framework::OpInferShapeCacheKernelTest<float>);
+
+TEST(InferShapeCache, all) {
+  FLAGS_enable_infer_shape_cache = true;
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_infer_shape_cache");
+  BuildVar("X", {"X"}, op_desc.add_inputs());
+  BuildVar("Y", {"Y"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("X")->GetMutable<paddle::framework::LoDTensor>();
+  auto* y = scope.Var("Y")->GetMutable<paddle::framework::LoDTensor>();
+  x->Resize({4, 8});
+  x->set_lod({{0, 1, 4}});
+  x->mutable_data<float>(cpu_place);
+
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  paddle::framework::infer_shape_num = 0;
+  op->Run(scope, cpu_place);
+  EXPECT_EQ(paddle::framework::infer_shape_num, 1);
+  EXPECT_EQ(y->dims(), paddle::framework::make_ddim({8, 8}));
+
+  // the output shapes are restored even if they are changed by others
+  y->Resize({3, 3});
+  y->set_lod({});
+  op->Run(scope, cpu_place);
+  EXPECT_EQ(paddle::framework::infer_shape_num, 1);
+  EXPECT_EQ(y->dims(), paddle::framework::make_ddim({8, 8}));
+  EXPECT_EQ(y->lod(), x->lod());
+
+  // InferShape runs again for the new shapes of the inputs
+  x->Resize({2, 8});
+  op->Run(scope, cpu_place);
+  EXPECT_EQ(paddle::framework::infer_shape_num, 2);
+  EXPECT_EQ(y->dims(), paddle::framework::make_ddim({4, 8}));
+  x->set_lod({{0, 2}});
+  op->Run(scope, cpu_place);
+  EXPECT_EQ(paddle::framework::infer_shape_num, 3);
+  EXPECT_EQ(y->lod(), x->lod());
+
+  FLAGS_enable_infer_shape_cache = false;
+  op->Run(scope, cpu_place);
+  EXPECT_EQ(paddle::framework::infer_shape_num, 4);
+}
@@ -19,13 +19,20 @@ limitations under the License. */
 #include <tuple>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/details/all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/async_ssa_graph_executor.h"
+#include "paddle/fluid/framework/details/broadcast_op_handle.h"
+#include "paddle/fluid/framework/details/computation_op_handle.h"
 #include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/details/op_handle_base.h"
 #include "paddle/fluid/framework/details/parallel_ssa_graph_executor.h"
+#include "paddle/fluid/framework/details/reduce_op_handle.h"
 #include "paddle/fluid/framework/details/scope_buffered_ssa_graph_executor.h"
 #include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
+#include "paddle/fluid/framework/fleet/gloo_wrapper.h"
+#include "paddle/fluid/framework/ir/gradient_accumulate_pass.h"
 #include "paddle/fluid/framework/ir/graph.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/memory_optimize_pass/memory_optimization_var_info.h"
@@ -33,6 +40,8 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(use_ngraph);
+DECLARE_bool(check_nan_inf);
+DECLARE_bool(check_nan_inf_async);
 
 DECLARE_double(eager_delete_tensor_gb);
 
@@ -252,6 +261,57 @@ class ParallelExecutorPrivate {
     return iter != is_persistable_.end() && iter->second;
   }
 
+  // Zero the accumulated gradients of gradient_accumulate_pass in the local
+  // scopes, which are not created by the startup program.
+  void InitGradientAccumulateVars(const ir::Graph &graph) {
+    const auto &acc_names =
+        graph.Get<ir::GradientAccumulateVars>(ir::kGradientAccumulateVars);
+    std::unordered_map<std::string, VarDesc *> var_descs;
+    for (auto *node : graph.Nodes()) {
+      if (node->IsVar() && node->Var()) {
+        var_descs.emplace(node->Name(), node->Var());
+      }
+    }
+    for (auto &name : acc_names) {
+      auto iter = var_descs.find(name);
+      PADDLE_ENFORCE_NE(iter, var_descs.end(),
+                        platform::errors::NotFound(
+                            "The accumulated gradient %s is not found.", name));
+      LoDTensor zeros;
+      zeros.Resize(make_ddim(iter->second->GetShape()));
+      auto *data =
+          zeros.mutable_data(platform::CPUPlace(), iter->second->GetDataType());
+      memset(data, 0, zeros.memory_size());
+      for (size_t i = 0; i < local_scopes_.size(); ++i) {
+        auto *tensor = local_scopes_[i]->Var(name)->GetMutable<LoDTensor>();
+        TensorCopySync(zeros, places_[i], tensor);
+      }
+    }
+  }
+
+  // The optimize, the LR scheduling and the collective ops are skipped
+  // except on the last step of each gradient accumulation.
+  void SkipRunningBetweenAccumulateSteps(const ir::Graph &graph) {
+    auto ops = ir::FilterByNodeWrapper<details::OpHandleBase>(graph);
+    for (auto *op : ops) {
+      bool skip = false;
+      if (auto *compute_op = dynamic_cast<details::ComputationOpHandle *>(op)) {
+        auto *op_base = compute_op->GetOp();
+        skip = op_base->HasAttr(OpProtoAndCheckerMaker::OpRoleAttrName()) &&
+               (op_base->Attr<int>(OpProtoAndCheckerMaker::OpRoleAttrName()) &
+                (static_cast<int>(OpRole::kOptimize) |
+                 static_cast<int>(OpRole::kLRSched)));
+      } else {
+        skip = dynamic_cast<details::AllReduceOpHandle *>(op) ||
+               dynamic_cast<details::ReduceOpHandle *>(op) ||
+               dynamic_cast<details::BroadcastOpHandle *>(op);
+      }
+      if (skip) {
+        op->SetSkipRunning(&skip_optimize_);
+      }
+    }
+  }
+
   BuildStrategy build_strategy_;
   std::vector<platform::Place> places_;
   std::vector<Scope *> local_scopes_;
@@ -273,6 +333,11 @@ class ParallelExecutorPrivate {
   ir::GarbageCollectorMap gcs_;
 
   details::ParallelSSAGraphExecutor *inference_executor_{nullptr};
+
+  // the gradient accumulation of BuildStrategy::gradient_accumulate_steps_
+  int gradient_accumulate_steps_{1};
+  int64_t run_steps_{0};
+  bool skip_optimize_{false};
 };
 
 void ParallelExecutorPrivate::SetHasFeed(size_t dev_idx, bool has_feed) {
@@ -704,6 +769,15 @@ ParallelExecutor::ParallelExecutor(const std::vector<platform::Place> &places,
       op->SetLocalExecScopes(scope_map);
     }
   }
+
+  if (graph->Has(ir::kGradientAccumulateVars)) {
+    member_->gradient_accumulate_steps_ =
+        member_->build_strategy_.gradient_accumulate_steps_;
+    member_->InitGradientAccumulateVars(*graph);
+    for (auto *g : final_graphs) {
+      member_->SkipRunningBetweenAccumulateSteps(*g);
+    }
+  }
 }
 
 void ParallelExecutor::BCastParamsToDevices(
@@ -758,6 +832,14 @@ void ParallelExecutor::BCastParamsToDevices(
 #endif
     } else {
       platform::CPUPlace cpu;
+      // the trainers on CPU start from the params of trainer 0
+      auto gloo = GlooWrapper::GetInstance();
+      if (member_->build_strategy_.num_trainers_ > 1 &&
+          gloo->DenseRingNum() > 0) {
+        size_t size = main_tensor.numel() * SizeOfType(main_tensor.type());
+        gloo->BroadcastDense(const_cast<void *>(main_tensor.data<void>()),
+                             size, 0);
+      }
       for (size_t i = 1; i < member_->places_.size(); ++i) {
         auto local_scope = member_->local_scopes_[i];
         auto *t = local_scope->Var(var)->GetMutable<LoDTensor>();
@@ -801,8 +883,22 @@ FetchResultType ParallelExecutor::Run(
   ir::SkipMemOptVarsGuard guard(&(member_->mem_opt_var_infos_), fetch_tensors,
                                 member_->HasGarbageCollectors());
 
+  if (member_->gradient_accumulate_steps_ > 1) {
+    member_->skip_optimize_ =
+        ++member_->run_steps_ % member_->gradient_accumulate_steps_ != 0;
+  }
+
   VLOG(3) << "ParallelExecutor begin to run member_->executor_->Run";
   auto fetch_data = member_->executor_->Run(fetch_tensors, return_merged);
+  // release the garbages of the unfinished batches of eager deletion
+  for (auto &pair : member_->gcs_) {
+    pair.second->Flush();
+  }
+  if (FLAGS_check_nan_inf && FLAGS_check_nan_inf_async) {
+    for (auto &place : member_->places_) {
+      details::CheckNanInfAsyncResults(place);
+    }
+  }
   return fetch_data;
 }
 
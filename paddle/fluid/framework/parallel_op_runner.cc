@@ -0,0 +1,261 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/parallel_op_runner.h"
+#include <algorithm>
+#include <exception>
+#include <mutex>  // NOLINT
+#include <unordered_set>
+#include <utility>
+#include "paddle/fluid/framework/blocking_queue.h"
+#include "paddle/fluid/framework/executor_gc_helper.h"
+
+DEFINE_int32(inter_op_parallelism, 0,
+             "The number of threads running the independent ops of a block "
+             "in parallel in Executor and NaiveExecutor on CPUPlace, 0 for "
+             "running the ops one by one");
+
+namespace paddle {
+namespace framework {
+
+static bool HasSubBlock(const OperatorBase& op) {
+  for (auto& pair : op.Attrs()) {
+    if (pair.second.type() == typeid(BlockDesc*) ||
+        pair.second.type() == typeid(std::vector<BlockDesc*>)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static std::unordered_set<std::string> VarNames(const VariableNameMap& vars) {
+  std::unordered_set<std::string> names;
+  for (auto& pair : vars) {
+    for (auto& name : pair.second) {
+      if (name != kEmptyVarName) {
+        names.insert(name);
+      }
+    }
+  }
+  return names;
+}
+
+ParallelOpRunner::ParallelOpRunner(
+    const std::vector<std::unique_ptr<OperatorBase>>& ops, size_t num_threads)
+    : num_threads_(num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0,
+                    platform::errors::InvalidArgument(
+                        "The thread number of ParallelOpRunner must be "
+                        "greater than 0, but received %d",
+                        num_threads));
+  ops_.reserve(ops.size());
+  for (auto& op : ops) {
+    ops_.push_back(op.get());
+  }
+  BuildDependencies(ops);
+  pool_.reset(new ThreadPool(static_cast<int>(num_threads)));
+}
+
+bool ParallelOpRunner::CanRunInParallel(
+    const std::vector<std::unique_ptr<OperatorBase>>& ops,
+    const platform::Place& place) {
+  if (!platform::is_cpu_place(place)) {
+    return false;
+  }
+  for (auto& op : ops) {
+    if (op->HasAttr("use_mkldnn") && op->Attr<bool>("use_mkldnn")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ParallelOpRunner::BuildDependencies(
+    const std::vector<std::unique_ptr<OperatorBase>>& ops) {
+  preceding_ops_.assign(ops.size(), {});
+  pending_ops_.assign(ops.size(), {});
+
+  std::unordered_map<std::string, size_t> last_writers;
+  std::unordered_map<std::string, std::vector<size_t>> readers;
+  // the ops since the last op with a sub-block
+  std::vector<size_t> ops_since_barrier;
+  bool has_barrier = false;
+  size_t barrier = 0;
+
+  for (size_t i = 0; i < ops.size(); ++i) {
+    std::unordered_set<size_t> deps;
+    if (HasSubBlock(*ops[i])) {
+      deps.insert(ops_since_barrier.begin(), ops_since_barrier.end());
+      if (has_barrier) {
+        deps.insert(barrier);
+      }
+      has_barrier = true;
+      barrier = i;
+      ops_since_barrier.clear();
+    } else {
+      auto inputs = VarNames(ops[i]->Inputs());
+      auto outputs = VarNames(ops[i]->Outputs());
+      // read after write
+      for (auto& name : inputs) {
+        auto it = last_writers.find(name);
+        if (it != last_writers.end()) {
+          deps.insert(it->second);
+        }
+      }
+      for (auto& name : outputs) {
+        // write after write
+        auto it = last_writers.find(name);
+        if (it != last_writers.end()) {
+          deps.insert(it->second);
+        }
+        // write after read
+        auto readers_it = readers.find(name);
+        if (readers_it != readers.end()) {
+          deps.insert(readers_it->second.begin(), readers_it->second.end());
+        }
+      }
+      if (has_barrier) {
+        deps.insert(barrier);
+      }
+      for (auto& name : inputs) {
+        readers[name].push_back(i);
+      }
+      for (auto& name : outputs) {
+        last_writers[name] = i;
+        readers[name].clear();
+      }
+      ops_since_barrier.push_back(i);
+    }
+
+    deps.erase(i);
+    preceding_ops_[i].assign(deps.begin(), deps.end());
+    std::sort(preceding_ops_[i].begin(), preceding_ops_[i].end());
+    for (auto dep : preceding_ops_[i]) {
+      pending_ops_[dep].push_back(i);
+    }
+  }
+}
+
+void ParallelOpRunner::BuildVarRefs(const DeleteVarsMap& delete_vars) {
+  delete_var_names_.clear();
+  delete_var_ref_num_.clear();
+  op_delete_vars_.assign(ops_.size(), {});
+
+  std::unordered_map<std::string, size_t> name_to_index;
+  for (auto* op : ops_) {
+    auto it = delete_vars.find(op);
+    if (it == delete_vars.end()) {
+      continue;
+    }
+    for (auto& name : it->second) {
+      if (name_to_index.count(name) == 0) {
+        name_to_index[name] = delete_var_names_.size();
+        delete_var_names_.push_back(name);
+      }
+    }
+  }
+  delete_var_ref_num_.assign(delete_var_names_.size(), 0);
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto names = VarNames(ops_[i]->Inputs());
+    auto outputs = VarNames(ops_[i]->Outputs());
+    names.insert(outputs.begin(), outputs.end());
+    for (auto& name : names) {
+      auto it = name_to_index.find(name);
+      if (it != name_to_index.end()) {
+        op_delete_vars_[i].push_back(it->second);
+        ++delete_var_ref_num_[it->second];
+      }
+    }
+  }
+  var_refs_built_for_ = &delete_vars;
+}
+
+void ParallelOpRunner::Run(const std::function<void(size_t)>& run_op,
+                           const Scope& scope, const DeleteVarsMap* delete_vars,
+                           GarbageCollector* gc) {
+  bool use_gc = gc != nullptr && delete_vars != nullptr;
+  if (use_gc && var_refs_built_for_ != delete_vars) {
+    BuildVarRefs(*delete_vars);
+  }
+  std::vector<size_t> var_ref_num;
+  if (use_gc) {
+    var_ref_num = delete_var_ref_num_;
+  }
+
+  std::vector<size_t> pending_deps(ops_.size());
+  BlockingQueue<size_t> finished_ops;
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+
+  size_t running_num = 0;
+  auto schedule = [&](size_t i) {
+    ++running_num;
+    pool_->Run([&, i] {
+      try {
+        run_op(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(exception_mutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+      }
+      finished_ops.Push(i);
+    });
+  };
+
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    pending_deps[i] = preceding_ops_[i].size();
+    if (pending_deps[i] == 0) {
+      schedule(i);
+    }
+  }
+
+  // only this thread updates the dependencies and deletes the variables
+  bool failed = false;
+  while (running_num > 0) {
+    size_t op_idx = finished_ops.Pop();
+    --running_num;
+    if (!failed) {
+      std::lock_guard<std::mutex> guard(exception_mutex);
+      failed = static_cast<bool>(exception);
+    }
+    if (failed) {
+      continue;
+    }
+
+    if (use_gc) {
+      std::vector<std::string> unused_vars;
+      for (auto var_idx : op_delete_vars_[op_idx]) {
+        if (--var_ref_num[var_idx] == 0) {
+          unused_vars.push_back(delete_var_names_[var_idx]);
+        }
+      }
+      if (!unused_vars.empty()) {
+        DeleteUnusedTensors(scope, unused_vars, gc);
+      }
+    }
+    for (auto pending_op : pending_ops_[op_idx]) {
+      if (--pending_deps[pending_op] == 0) {
+        schedule(pending_op);
+      }
+    }
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
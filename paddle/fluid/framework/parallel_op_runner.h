@@ -0,0 +1,94 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/garbage_collector.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/threadpool.h"
+
+namespace paddle {
+namespace framework {
+
+/**
+ * ParallelOpRunner runs the ops of a block on a small thread pool by their
+ * dependencies, so that the independent branches, e.g. the towers of a CTR
+ * model or an Inception block, run at the same time. An op depends on the
+ * previous ops writing its inputs, and the previous ops reading or writing
+ * its outputs. An op with a sub-block, e.g. while, waits for all the
+ * previous ops and blocks all the later ones, since the sub-block may use
+ * the variables not in its inputs or outputs.
+ *
+ * The unused variables of the ops, deleted after the last op using them in
+ * the sequential order, are deleted after all the ops using them finish.
+ */
+class ParallelOpRunner {
+ public:
+  using DeleteVarsMap =
+      std::unordered_map<const OperatorBase*, std::vector<std::string>>;
+
+  ParallelOpRunner(const std::vector<std::unique_ptr<OperatorBase>>& ops,
+                   size_t num_threads);
+
+  // Whether the ops of a block on place can run in parallel. The ops only
+  // run in parallel on CPUPlace, since all the kernels on one GPU are
+  // launched on the same stream, and the MKL-DNN ops keep their caches
+  // per thread.
+  static bool CanRunInParallel(
+      const std::vector<std::unique_ptr<OperatorBase>>& ops,
+      const platform::Place& place);
+
+  // Run the ops by run_op(i), which runs the i-th op, on the thread pool,
+  // and delete the unused variables of delete_vars in scope by gc if gc is
+  // not nullptr. The first exception thrown by the ops is rethrown after
+  // the running ops finish, and the ops not started are skipped.
+  void Run(const std::function<void(size_t)>& run_op, const Scope& scope,
+           const DeleteVarsMap* delete_vars = nullptr,
+           GarbageCollector* gc = nullptr);
+
+  // The indices of the ops which the i-th op waits for.
+  const std::vector<size_t>& PrecedingOps(size_t i) const {
+    return preceding_ops_[i];
+  }
+
+  size_t NumThreads() const { return num_threads_; }
+
+ private:
+  void BuildDependencies(const std::vector<std::unique_ptr<OperatorBase>>& ops);
+
+  void BuildVarRefs(const DeleteVarsMap& delete_vars);
+
+  std::vector<const OperatorBase*> ops_;
+  std::vector<std::vector<size_t>> preceding_ops_;
+  std::vector<std::vector<size_t>> pending_ops_;
+
+  // the variables deleted by the ops and the number of the ops using them
+  const DeleteVarsMap* var_refs_built_for_{nullptr};
+  std::vector<std::string> delete_var_names_;
+  std::vector<size_t> delete_var_ref_num_;
+  // the indices in delete_var_names_ of the variables each op uses
+  std::vector<std::vector<size_t>> op_delete_vars_;
+
+  size_t num_threads_;
+  std::unique_ptr<ThreadPool> pool_;
+};
+
+}  // namespace framework
+}  // namespace paddle
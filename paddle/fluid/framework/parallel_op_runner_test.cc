@@ -0,0 +1,120 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/parallel_op_runner.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+
+// out = x + y for each tuple of {x, y, out}
+static std::vector<std::unique_ptr<OperatorBase>> CreateAddOps(
+    const std::vector<std::vector<std::string>>& adds) {
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  std::vector<std::unique_ptr<OperatorBase>> ops;
+  for (auto& add : adds) {
+    for (auto& name : add) {
+      block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+    }
+    auto* op = block->AppendOp();
+    op->SetType("elementwise_add");
+    op->SetInput("X", {add[0]});
+    op->SetInput("Y", {add[1]});
+    op->SetOutput("Out", {add[2]});
+    ops.emplace_back(OpRegistry::CreateOp(*op));
+  }
+  return ops;
+}
+
+static void SetTensor(Scope* scope, const std::string& name, float value) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize({4});
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 4; ++i) {
+    data[i] = value;
+  }
+}
+
+TEST(ParallelOpRunner, Dependencies) {
+  auto ops = CreateAddOps({{"a", "b", "c"},
+                           {"a", "b", "d"},
+                           {"c", "d", "e"},
+                           // writes a after read by the first two ops
+                           {"e", "b", "a"},
+                           {"b", "b", "f"}});
+  ParallelOpRunner runner(ops, 2);
+  ASSERT_EQ(runner.PrecedingOps(0), std::vector<size_t>());
+  ASSERT_EQ(runner.PrecedingOps(1), std::vector<size_t>());
+  ASSERT_EQ(runner.PrecedingOps(2), std::vector<size_t>({0, 1}));
+  ASSERT_EQ(runner.PrecedingOps(3), std::vector<size_t>({0, 1, 2}));
+  ASSERT_EQ(runner.PrecedingOps(4), std::vector<size_t>());
+}
+
+TEST(ParallelOpRunner, RunTowers) {
+  // two towers from a, joined by out
+  auto ops = CreateAddOps({{"a", "a", "b1"},
+                           {"a", "a", "b2"},
+                           {"b1", "a", "c1"},
+                           {"b2", "b2", "c2"},
+                           {"c1", "c2", "out"}});
+  ASSERT_TRUE(ParallelOpRunner::CanRunInParallel(ops, platform::CPUPlace()));
+  ParallelOpRunner runner(ops, 4);
+
+  Scope scope;
+  for (auto& name : {"b1", "b2", "c1", "c2", "out"}) {
+    scope.Var(name)->GetMutable<LoDTensor>();
+  }
+  // the intermediate tensors are deleted after all the ops using them
+  ParallelOpRunner::DeleteVarsMap delete_vars;
+  delete_vars[ops[2].get()] = {"b1"};
+  delete_vars[ops[3].get()] = {"b2"};
+  delete_vars[ops[4].get()] = {"c1", "c2"};
+  CPUGarbageCollector gc(platform::CPUPlace(), 0);
+
+  auto run_op = [&](size_t i) { ops[i]->Run(scope, platform::CPUPlace()); };
+  for (int iter = 0; iter < 10; ++iter) {
+    SetTensor(&scope, "a", iter);
+    runner.Run(run_op, scope, &delete_vars, &gc);
+    auto& out = scope.FindVar("out")->Get<LoDTensor>();
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_FLOAT_EQ(out.data<float>()[i], 3 * iter + 4 * iter);
+    }
+    for (auto& name : {"b1", "b2", "c1", "c2"}) {
+      ASSERT_FALSE(scope.FindVar(name)->Get<LoDTensor>().IsInitialized());
+    }
+  }
+}
+
+TEST(ParallelOpRunner, Exception) {
+  auto ops = CreateAddOps({{"a", "a", "b"}, {"a", "missing", "c"}});
+  ParallelOpRunner runner(ops, 2);
+  Scope scope;
+  SetTensor(&scope, "a", 1);
+  scope.Var("b")->GetMutable<LoDTensor>();
+  scope.Var("c")->GetMutable<LoDTensor>();
+  auto run_op = [&](size_t i) { ops[i]->Run(scope, platform::CPUPlace()); };
+  ASSERT_THROW(runner.Run(run_op, scope), platform::EnforceNotMet);
+}
+
+}  // namespace framework
+}  // namespace paddle
+
+USE_OP(elementwise_add);
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/program_desc.h"
+#include <climits>
+#include "google/protobuf/io/coded_stream.h"
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/version.h"
@@ -21,9 +23,9 @@ namespace paddle {
 namespace framework {
 
 BlockDesc *ProgramDesc::AppendBlock(const BlockDesc &parent) {
-  auto *b = desc_.add_blocks();
+  auto *b = desc_->add_blocks();
   b->set_parent_idx(parent.ID());
-  b->set_idx(desc_.blocks_size() - 1);
+  b->set_idx(desc_->blocks_size() - 1);
   blocks_.emplace_back(new BlockDesc(this, b));
   return blocks_.back().get();
 }
@@ -36,31 +38,31 @@ void ProgramDesc::Flush() {
 
 proto::ProgramDesc *ProgramDesc::Proto() {
   Flush();
-  return &desc_;
+  return desc_;
 }
 
 proto::OpCompatibleMap *ProgramDesc::OpCompatibleMap() {
-  return desc_.mutable_op_compatible_map();
+  return desc_->mutable_op_compatible_map();
 }
 
-int64_t ProgramDesc::Version() const { return desc_.version().version(); }
+int64_t ProgramDesc::Version() const { return desc_->version().version(); }
 
 void ProgramDesc::SetVersion(const int64_t version) {
-  desc_.mutable_version()->set_version(version);
+  desc_->mutable_version()->set_version(version);
 }
 
-ProgramDesc::ProgramDesc() {
+ProgramDesc::ProgramDesc() : desc_(new proto::ProgramDesc) {
   SetVersion(kCurProgramVersion);
-  auto *block = desc_.mutable_blocks()->Add();
+  auto *block = desc_->mutable_blocks()->Add();
   block->set_idx(kRootBlockIndex);
   block->set_parent_idx(kNoneBlockIndex);
   blocks_.emplace_back(new BlockDesc(this, block));
 }
 
-ProgramDesc::ProgramDesc(const ProgramDesc &o) {
-  desc_ = o.desc_;
-  for (int i = 0; i < desc_.blocks_size(); ++i) {
-    auto *block = desc_.mutable_blocks(i);
+ProgramDesc::ProgramDesc(const ProgramDesc &o)
+    : desc_(new proto::ProgramDesc(*o.desc_)) {
+  for (int i = 0; i < desc_->blocks_size(); ++i) {
+    auto *block = desc_->mutable_blocks(i);
     blocks_.emplace_back(new BlockDesc(*o.blocks_[i], block, this));
   }
   for (size_t block_id = 0; block_id < blocks_.size(); ++block_id) {
@@ -87,44 +89,50 @@ ProgramDesc::ProgramDesc(const ProgramDesc &o) {
   }
 }
 
-ProgramDesc::ProgramDesc(const proto::ProgramDesc &desc) {
-  desc_ = desc;
+ProgramDesc::ProgramDesc(const proto::ProgramDesc &desc)
+    : arena_(new google::protobuf::Arena),
+      desc_(google::protobuf::Arena::CreateMessage<proto::ProgramDesc>(
+          arena_.get())) {
+  desc_->CopyFrom(desc);
   InitFromProto();
 }
 
 void ProgramDesc::CopyFrom(const proto::ProgramDesc &desc) {
   blocks_.clear();
-  desc_ = desc;
+  desc_->CopyFrom(desc);
   InitFromProto();
 }
 
-ProgramDesc::ProgramDesc(const std::string &binary_str) {
-  PADDLE_ENFORCE(desc_.ParseFromString(binary_str),
-                 "Fail to parse program_desc from binary string.");
+ProgramDesc::ProgramDesc(const std::string &binary_str)
+    : arena_(new google::protobuf::Arena),
+      desc_(google::protobuf::Arena::CreateMessage<proto::ProgramDesc>(
+          arena_.get())) {
+  // The default limit of the bytes parsed is 64MB, which is exceeded by the
+  // programs of many ops.
+  google::protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8_t *>(binary_str.data()),
+      static_cast<int>(binary_str.size()));
+  input.SetTotalBytesLimit(INT_MAX, INT_MAX);
+  PADDLE_ENFORCE(
+      desc_->ParseFromCodedStream(&input) && input.ConsumedEntireMessage(),
+      "Fail to parse program_desc from binary string.");
   InitFromProto();
 }
 
+ProgramDesc::~ProgramDesc() {
+  // The blocks and the ops view desc_.
+  blocks_.clear();
+  if (arena_ == nullptr) {
+    delete desc_;
+  }
+}
+
 void ProgramDesc::InitFromProto() {
-  for (auto &block_desc : *desc_.mutable_blocks()) {
+  // The BLOCK and BLOCKS attributes of the ops are resolved when the ops are
+  // materialized, after all the blocks are created.
+  for (auto &block_desc : *desc_->mutable_blocks()) {
     blocks_.emplace_back(new BlockDesc(this, &block_desc));
   }
-  for (auto &block : blocks_) {
-    for (auto *op : block->AllOps()) {
-      for (const auto &attr : op->Proto()->attrs()) {
-        if (attr.type() == proto::AttrType::BLOCK) {
-          size_t blk_idx = attr.block_idx();
-          op->SetBlockAttr(attr.name(), this->MutableBlock(blk_idx));
-        } else if (attr.type() == proto::AttrType::BLOCKS) {
-          auto blks_idx = attr.blocks_idx();
-          std::vector<BlockDesc *> block_descs;
-          for (int blk_idx : blks_idx) {
-            block_descs.push_back(this->MutableBlock(blk_idx));
-          }
-          op->SetBlocksAttr(attr.name(), block_descs);
-        }
-      }
-    }
-  }
 }
 
 const std::vector<std::string> ProgramDesc::GetFeedTargetNames() {
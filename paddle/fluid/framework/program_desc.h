@@ -17,6 +17,7 @@ limitations under the License. */
 #include <memory>
 #include <string>
 #include <vector>
+#include "google/protobuf/arena.h"
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/proto_desc.h"
@@ -37,6 +38,8 @@ class ProgramDesc {
 
   explicit ProgramDesc(const std::string &binary_str);
 
+  ~ProgramDesc();
+
   BlockDesc *AppendBlock(const BlockDesc &parent);
 
   BlockDesc *MutableBlock(size_t idx) {
@@ -86,7 +89,12 @@ class ProgramDesc {
  private:
   void InitFromProto();
 
-  proto::ProgramDesc desc_;
+  // The protos of the programs loaded are allocated on the arena, which is
+  // much faster to parse and to free for the programs of many ops. The ops
+  // are views of the protos until they are accessed, see OpDesc::CreateView.
+  std::unique_ptr<google::protobuf::Arena> arena_;
+
+  proto::ProgramDesc *desc_;
 
   std::vector<std::unique_ptr<BlockDesc>> blocks_;
 };
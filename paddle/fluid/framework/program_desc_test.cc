@@ -174,5 +174,53 @@ TEST(ProgramDescBind, serialize_and_deserialize) {
               op_origin->Proto()->SerializeAsString());
   }
 }
+
+TEST(ProgramDesc, load_op_views) {
+  ProgramDesc program_origin;
+  auto* global_block = program_origin.MutableBlock(0);
+  for (int i = 0; i < 3; ++i) {
+    auto* op = global_block->AppendOp();
+    op->SetType("scale");
+    op->SetInput("X", {"x" + std::to_string(i)});
+    op->SetOutput("Out", {"x" + std::to_string(i + 1)});
+    op->SetAttr("scale", 2.0f);
+  }
+  BlockDesc* sub_block = program_origin.AppendBlock(*global_block);
+  auto* op = global_block->AppendOp();
+  op->SetType("op_with_subblock");
+  op->SetAttr("sub_block", sub_block);
+  op->SetAttr("sub_blocks", std::vector<BlockDesc*>{sub_block});
+
+  std::string binary_str;
+  program_origin.Proto()->SerializeToString(&binary_str);
+
+  ProgramDesc program(binary_str);
+  auto* block = program.MutableBlock(0);
+  ASSERT_EQ(block->OpSize(), 4UL);
+  EXPECT_EQ(block->Op(0)->Type(), "scale");
+  EXPECT_EQ(block->Op(1)->Input("X"), std::vector<std::string>({"x1"}));
+  EXPECT_EQ(boost::get<float>(block->Op(2)->GetAttr("scale")), 2.0f);
+  EXPECT_EQ(block->Op(3)->GetBlockAttrId("sub_block"), 1);
+  EXPECT_EQ(boost::get<BlockDesc*>(block->Op(3)->GetAttr("sub_block")),
+            program.MutableBlock(1));
+  EXPECT_EQ(block->Op(3)->GetBlocksAttrIds("sub_blocks"),
+            std::vector<int>({1}));
+
+  // op 0 is not materialized when the ops of the block are replaced
+  block->Op(1)->SetAttr("scale", 3.0f);
+  block->AppendOp()->SetType("fetch");
+  ProgramDesc program_restored(*program.Proto());
+  auto* block_restored = program_restored.MutableBlock(0);
+  ASSERT_EQ(block_restored->OpSize(), 5UL);
+  EXPECT_EQ(block_restored->Op(0)->Output("Out"),
+            std::vector<std::string>({"x1"}));
+  EXPECT_EQ(boost::get<float>(block_restored->Op(1)->GetAttr("scale")), 3.0f);
+  EXPECT_EQ(block_restored->Op(4)->Type(), "fetch");
+  for (size_t i = 0; i < 4; ++i) {
+    if (i == 1) continue;
+    EXPECT_EQ(block_restored->Op(i)->Proto()->SerializeAsString(),
+              global_block->Op(i)->Proto()->SerializeAsString());
+  }
+}
 }  // namespace framework
 }  // namespace paddle
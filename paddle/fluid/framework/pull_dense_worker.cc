@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 #include <time.h>
+#include <chrono>  // NOLINT
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
 
@@ -20,6 +21,7 @@ namespace framework {
 
 std::shared_ptr<PullDenseWorker> PullDenseWorker::s_instance_ = NULL;
 std::mutex PullDenseWorker::mutex_for_version_;
+std::condition_variable PullDenseWorker::version_cond_;
 std::map<uint64_t, uint64_t> PullDenseWorker::last_versions_;
 std::map<uint64_t, uint64_t> PullDenseWorker::current_version_;
 std::map<uint64_t, std::vector<uint64_t>> PullDenseWorker::training_versions_;
@@ -79,7 +81,11 @@ void PullDenseWorker::Wait(std::vector<::std::future<int32_t>>* status_vec) {
 
 void PullDenseWorker::Stop() {
   if (running_) {
-    running_ = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_for_version_);
+      running_ = false;
+    }
+    version_cond_.notify_all();
     t_.join();
   }
 }
@@ -112,15 +118,43 @@ int PullDenseWorker::Start() {
 void PullDenseWorker::Run() {
   while (running_) {
     PullDense(false);
-#ifndef _WIN32
-    usleep(sleep_time_ms_ * 1000);
-#endif
+    // Wakes up as soon as a table needs to be pulled, instead of polling,
+    // and checks once every sleep_time_ms_ at most. The tables are pulled
+    // every sleep_time_ms_ without a positive threshold.
+    std::unique_lock<std::mutex> lock(mutex_for_version_);
+    version_cond_.wait_for(
+        lock, std::chrono::milliseconds(sleep_time_ms_), [this] {
+          if (!running_) return true;
+          if (threshold_ <= 0) return false;
+          for (auto& versions : training_versions_) {
+            if (NeedUpdateUnlocked(versions.first)) return true;
+          }
+          return false;
+        });
   }
 }
 
 void PullDenseWorker::IncreaseThreadVersion(int thread_id, uint64_t table_id) {
-  std::lock_guard<std::mutex> lock(mutex_for_version_);
-  training_versions_[table_id][thread_id]++;
+  bool need_update = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_for_version_);
+    auto version = ++training_versions_[table_id][thread_id];
+    // the table is pulled after all the threads reach the threshold, so the
+    // versions of the others are only checked once this thread reaches it
+    need_update = version - last_versions_[table_id] >=
+                      static_cast<size_t>(threshold_) &&
+                  NeedUpdateUnlocked(table_id);
+  }
+  if (need_update) {
+    version_cond_.notify_one();
+  }
+}
+
+bool PullDenseWorker::NeedUpdateUnlocked(uint64_t table_id) const {
+  auto& version = training_versions_.at(table_id);
+  return *std::min_element(version.begin(), version.end()) -
+             last_versions_.at(table_id) >=
+         static_cast<size_t>(threshold_);
 }
 
 bool PullDenseWorker::CheckUpdateParam(uint64_t table_id) {
@@ -128,11 +162,7 @@ bool PullDenseWorker::CheckUpdateParam(uint64_t table_id) {
   auto& version = training_versions_[table_id];
   current_version_[table_id] =
       *(std::min_element(version.begin(), version.end()));
-  if (current_version_[table_id] - last_versions_[table_id] <
-      static_cast<size_t>(threshold_)) {
-    return false;
-  }
-  return true;
+  return NeedUpdateUnlocked(table_id);
 }
 
 void PullDenseWorker::ResetThreadVersion(uint64_t table_id) {
@@ -29,6 +29,11 @@ DEFINE_bool(
     "Delete local scope eagerly. It will reduce GPU memory usage but "
     "slow down the destruction of variables.(around 1% performance harm)");
 
+DEFINE_bool(use_var_slots, false,
+            "Whether the ops run by Executor and NaiveExecutor find their "
+            "variables in the scopes by the slots assigned when prepared, "
+            "instead of hashing the names in each scope.");
+
 // When in inference scenario, the scopes will not be written by two threads in
 // a mean time, but a scope may be read by multiple threads concurrently, and
 // the mutex will cause serious performance issue.
@@ -48,6 +53,52 @@ DEFINE_bool(
 namespace paddle {
 namespace framework {
 
+namespace {
+
+// The slots of the variable names, shared by all the scopes.
+class VarSlotRegistry {
+ public:
+  static VarSlotRegistry& Instance() {
+    static VarSlotRegistry registry;
+    return registry;
+  }
+
+  size_t Slot(const std::string& name) {
+    {
+      AutoRDLock guard(&lock_);
+      auto it = slots_.find(name);
+      if (it != slots_.end()) {
+        return it->second;
+      }
+    }
+    AutoWRLock guard(&lock_);
+    return slots_.emplace(name, slots_.size()).first->second;
+  }
+
+  bool Find(const std::string& name, size_t* slot) {
+    AutoRDLock guard(&lock_);
+    auto it = slots_.find(name);
+    if (it == slots_.end()) {
+      return false;
+    }
+    *slot = it->second;
+    return true;
+  }
+
+  size_t Size() {
+    AutoRDLock guard(&lock_);
+    return slots_.size();
+  }
+
+ private:
+  RWLock lock_;
+  std::unordered_map<std::string, size_t> slots_;
+};
+
+}  // namespace
+
+constexpr uintptr_t Scope::kVarNotInSlot;
+
 Scope::~Scope() { DropKids(); }
 
 Scope& Scope::NewScope() const {
@@ -88,6 +139,36 @@ Variable* Scope::FindLocalVar(const std::string& name) const {
   return FindVarLocally(name);
 }
 
+size_t Scope::VarSlot(const std::string& name) {
+  return VarSlotRegistry::Instance().Slot(name);
+}
+
+size_t Scope::VarSlotNum() { return VarSlotRegistry::Instance().Size(); }
+
+void Scope::ReserveVarSlots(size_t slot_num) const {
+  SCOPE_VARS_WRITER_LOCK
+  if (slot_num <= var_slots_.size()) {
+    return;
+  }
+  std::vector<std::atomic<uintptr_t>> var_slots(slot_num);
+  for (size_t i = 0; i < var_slots_.size(); ++i) {
+    var_slots[i].store(var_slots_[i].load());
+  }
+  var_slots_.swap(var_slots);
+}
+
+Variable* Scope::FindVar(size_t slot, const std::string& name) const {
+  Variable* var = nullptr;
+  {
+    SCOPE_VARS_READER_LOCK
+    var = FindVarLocally(slot, name);
+  }
+  if (var != nullptr) {
+    return var;
+  }
+  return (parent_ == nullptr) ? nullptr : parent_->FindVar(slot, name);
+}
+
 const Scope* Scope::FindScope(const Variable* var) const {
   SCOPE_VARS_READER_LOCK
   return FindScopeInternal(var);
@@ -141,6 +222,7 @@ void Scope::EraseVars(const std::vector<std::string>& var_names) {
   SCOPE_VARS_WRITER_LOCK
   for (auto it = vars_.begin(); it != vars_.end();) {
     if (var_set.find(it->first) != var_set.end()) {
+      ResetVarSlot(it->first, nullptr);
       it = vars_.erase(it);
     } else {
       ++it;
@@ -166,6 +248,7 @@ Variable* Scope::VarInternal(const std::string& name) {
   if (v != nullptr) return v;
   v = new Variable();
   vars_.emplace(name, std::unique_ptr<Variable>(v));
+  ResetVarSlot(name, v);
   VLOG(3) << "Create variable " << name;
   return v;
 }
@@ -194,8 +277,11 @@ void Scope::RenameInternal(const std::string& origin_name,
   auto new_it = vars_.find(new_name);
   PADDLE_ENFORCE(new_it == vars_.end(),
                  "The variable with name %s is already in the scope", new_name);
-  vars_[new_name].reset(origin_it->second.release());
+  auto* var = origin_it->second.release();
+  vars_[new_name].reset(var);
   vars_.erase(origin_it);
+  ResetVarSlot(origin_name, nullptr);
+  ResetVarSlot(new_name, var);
 }
 
 Variable* Scope::FindVarInternal(const std::string& name) const {
@@ -214,12 +300,43 @@ Variable* Scope::FindVarLocally(const std::string& name) const {
   return nullptr;
 }
 
+Variable* Scope::FindVarLocally(size_t slot, const std::string& name) const {
+  if (slot >= var_slots_.size()) {
+    return FindVarLocally(name);
+  }
+  // the cache may be filled by several readers at the same time, with the
+  // same value
+  auto cached = var_slots_[slot].load(std::memory_order_relaxed);
+  if (cached == kVarNotInSlot) {
+    return nullptr;
+  }
+  if (cached != 0) {
+    return reinterpret_cast<Variable*>(cached);
+  }
+  auto* var = FindVarLocally(name);
+  var_slots_[slot].store(
+      var != nullptr ? reinterpret_cast<uintptr_t>(var) : kVarNotInSlot,
+      std::memory_order_relaxed);
+  return var;
+}
+
+void Scope::ResetVarSlot(const std::string& name, Variable* var) const {
+  size_t slot;
+  if (var_slots_.empty() || !VarSlotRegistry::Instance().Find(name, &slot) ||
+      slot >= var_slots_.size()) {
+    return;
+  }
+  var_slots_[slot].store(
+      var != nullptr ? reinterpret_cast<uintptr_t>(var) : kVarNotInSlot);
+}
+
 void Scope::EraseVarsExcept(const std::unordered_set<Variable*>& vars) {
   SCOPE_VARS_WRITER_LOCK
   for (auto iter = vars_.begin(); iter != vars_.end();) {
     if (vars.count(iter->second.get()) != 0) {
       ++iter;
     } else {
+      ResetVarSlot(iter->first, nullptr);
       vars_.erase(iter++);
     }
   }
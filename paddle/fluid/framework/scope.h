@@ -18,6 +18,7 @@ extern "C" {
 #include <xxhash.h>
 }
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -80,6 +81,22 @@ class Scope {
   /// Caller doesn't own the returned Variable.
   Variable* FindLocalVar(const std::string& name) const;
 
+  /// The slot of a variable name, shared by all the scopes. The variables
+  /// can be found by the slots without hashing their names in the scopes
+  /// reserving the slots.
+  static size_t VarSlot(const std::string& name);
+
+  /// The number of the slots assigned.
+  static size_t VarSlotNum();
+
+  /// Reserve the slots [0, slot_num) in this scope, which cache whether
+  /// the variables are in this scope. It should not be called when the
+  /// variables of this scope are being found by slots in other threads.
+  void ReserveVarSlots(size_t slot_num) const;
+
+  /// The same as FindVar(name), with slot the result of VarSlot(name).
+  Variable* FindVar(size_t slot, const std::string& name) const;
+
   const Scope* parent() const { return parent_; }
 
   /// Find the scope or an ancestor scope that contains the given variable.
@@ -141,6 +158,17 @@ class Scope {
   // Called by FindVarInternal and Var.
   Variable* FindVarLocally(const std::string& name) const;
 
+  // Called by FindVar with slot.
+  Variable* FindVarLocally(size_t slot, const std::string& name) const;
+
+  // Called when a variable is created or erased in this scope.
+  void ResetVarSlot(const std::string& name, Variable* var) const;
+
+  // The caches of the slots, 0 for not known, kVarNotInSlot for not in this
+  // scope, otherwise the address of the variable.
+  static constexpr uintptr_t kVarNotInSlot = 1;
+  mutable std::vector<std::atomic<uintptr_t>> var_slots_;
+
   // Scope in `kids_` are owned by this class.
   mutable std::list<Scope*> kids_;
   const Scope* parent_{nullptr};
@@ -13,8 +13,15 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/scope_pool.h"
+#include <string>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/threadpool.h"
 
+DEFINE_bool(reuse_step_scopes, false,
+            "Whether while_op and recurrent_op reuse the step scopes of the "
+            "last run, instead of creating the new ones in each run.");
+
 namespace paddle {
 namespace framework {
 
@@ -50,5 +57,62 @@ void ScopePool::Clear() {
   scopes_.clear();
 }
 
+bool StepScopePool::IsEnabled() { return FLAGS_reuse_step_scopes; }
+
+StepScopePool::StepScopePool(const Scope &parent,
+                             std::vector<Scope *> *step_scopes)
+    : parent_(parent) {
+  if (IsEnabled()) {
+    for (auto *scope : *step_scopes) {
+      if (parent.HasKid(scope)) {
+        scopes_.push_back(scope);
+      }
+    }
+  } else {
+    for (auto *scope : *step_scopes) {
+      if (parent.HasKid(scope)) {
+        parent.DeleteScope(scope);
+      }
+    }
+  }
+  step_scopes->clear();
+}
+
+StepScopePool::~StepScopePool() {
+  for (auto *scope : scopes_) {
+    parent_.DeleteScope(scope);
+  }
+}
+
+Scope &StepScopePool::NewScope() {
+  if (scopes_.empty()) {
+    return parent_.NewScope();
+  }
+  auto *scope = scopes_.front();
+  scopes_.pop_front();
+  ResetStepScope(scope);
+  return *scope;
+}
+
+void StepScopePool::ResetStepScope(Scope *scope) {
+  std::vector<std::string> erased_vars;
+  for (auto &name : scope->LocalVarNames()) {
+    auto *var = scope->FindLocalVar(name);
+    if (var == nullptr || !var->IsInitialized()) {
+      continue;
+    }
+    if (var->IsType<LoDTensor>()) {
+      *var->GetMutable<LoDTensor>() = LoDTensor();
+    } else if (var->IsType<LoDTensorArray>()) {
+      var->GetMutable<LoDTensorArray>()->clear();
+    } else if (!var->IsType<std::vector<Scope *>>()) {
+      erased_vars.push_back(name);
+    }
+  }
+  if (!erased_vars.empty()) {
+    scope->EraseVars(erased_vars);
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
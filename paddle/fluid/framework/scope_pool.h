@@ -14,8 +14,10 @@
 
 #pragma once
 
+#include <deque>
 #include <mutex>  // NOLINT
 #include <unordered_set>
+#include <vector>
 #include "paddle/fluid/framework/scope.h"
 
 namespace paddle {
@@ -42,5 +44,39 @@ class ScopePool {
   std::mutex mtx_;
 };
 
+/**
+ * StepScopePool reuses the step scopes of while_op and recurrent_op kept in
+ * their step scopes variable by the last run, instead of deleting them and
+ * creating the new ones, so that the variables and the hash map nodes of
+ * the scopes are not allocated again in each run. It is enabled by
+ * FLAGS_reuse_step_scopes.
+ *
+ * The step scopes are reset before reused, see ResetStepScope, and the ones
+ * not reused are deleted when the pool is destroyed.
+ */
+class StepScopePool {
+ public:
+  static bool IsEnabled();
+
+  // Take the kid scopes of parent in step_scopes, which is cleared.
+  StepScopePool(const Scope &parent, std::vector<Scope *> *step_scopes);
+
+  ~StepScopePool();
+
+  // A reset kid scope of parent kept in the last run, or a new one.
+  Scope &NewScope();
+
+  // Release the memory of the variables in scope, as if they were created
+  // in a new scope: the tensors are replaced by the empty ones, the tensor
+  // arrays are cleared, and the variables of other types are erased,
+  // except the step scopes of the nested while_op and recurrent_op, whose
+  // scopes are kids of scope and are reused by the nested ops.
+  static void ResetStepScope(Scope *scope);
+
+ private:
+  const Scope &parent_;
+  std::deque<Scope *> scopes_;
+};
+
 }  // namespace framework
 }  // namespace paddle
@@ -0,0 +1,81 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/scope_pool.h"
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_rank_table.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/lod_tensor_array.h"
+
+DECLARE_bool(reuse_step_scopes);
+
+namespace paddle {
+namespace framework {
+
+TEST(StepScopePool, ResetStepScope) {
+  Scope scope;
+  auto* tensor = scope.Var("tensor")->GetMutable<LoDTensor>();
+  tensor->Resize({2, 3});
+  tensor->mutable_data<float>(platform::CPUPlace());
+  tensor->set_lod({{0, 1, 2}});
+  scope.Var("array")->GetMutable<LoDTensorArray>()->resize(3);
+  scope.Var("rank_table")->GetMutable<LoDRankTable>();
+  scope.Var("step_scopes")->GetMutable<std::vector<Scope*>>();
+
+  StepScopePool::ResetStepScope(&scope);
+  ASSERT_FALSE(scope.FindVar("tensor")->Get<LoDTensor>().IsInitialized());
+  ASSERT_TRUE(scope.FindVar("tensor")->Get<LoDTensor>().lod().empty());
+  ASSERT_TRUE(scope.FindVar("array")->Get<LoDTensorArray>().empty());
+  ASSERT_EQ(scope.FindVar("rank_table"), nullptr);
+  ASSERT_NE(scope.FindVar("step_scopes"), nullptr);
+}
+
+TEST(StepScopePool, Reuse) {
+  FLAGS_reuse_step_scopes = true;
+  Scope parent;
+  std::vector<Scope*> step_scopes;
+  {
+    StepScopePool pool(parent, &step_scopes);
+    for (int i = 0; i < 3; ++i) {
+      step_scopes.push_back(&pool.NewScope());
+    }
+  }
+  auto old_scopes = step_scopes;
+  Variable* var = old_scopes[0]->Var("x");
+  {
+    // the scopes of the last run are reused, and the ones not reused are
+    // deleted
+    StepScopePool pool(parent, &step_scopes);
+    ASSERT_TRUE(step_scopes.empty());
+    for (int i = 0; i < 2; ++i) {
+      step_scopes.push_back(&pool.NewScope());
+    }
+  }
+  ASSERT_EQ(step_scopes[0], old_scopes[0]);
+  ASSERT_EQ(step_scopes[1], old_scopes[1]);
+  ASSERT_EQ(step_scopes[0]->FindLocalVar("x"), var);
+  ASSERT_EQ(parent.kids().size(), 2UL);
+
+  FLAGS_reuse_step_scopes = false;
+  {
+    StepScopePool pool(parent, &step_scopes);
+    step_scopes.push_back(&pool.NewScope());
+  }
+  ASSERT_EQ(parent.kids().size(), 1UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -71,3 +71,37 @@ TEST(Scope, GetAllNames) {
 
   EXPECT_STREQ("a", str.c_str());
 }
+
+TEST(Scope, FindVarBySlot) {
+  Scope s;
+  Scope& ss = s.NewScope();
+  size_t slot_a = Scope::VarSlot("slot_a");
+  size_t slot_b = Scope::VarSlot("slot_b");
+  EXPECT_EQ(slot_a, Scope::VarSlot("slot_a"));
+  EXPECT_NE(slot_a, slot_b);
+  s.ReserveVarSlots(Scope::VarSlotNum());
+  ss.ReserveVarSlots(Scope::VarSlotNum());
+
+  Variable* a = s.Var("slot_a");
+  EXPECT_EQ(a, ss.FindVar(slot_a, "slot_a"));
+  EXPECT_EQ(nullptr, ss.FindVar(slot_b, "slot_b"));
+
+  // the cached results are updated when the variables change
+  Variable* b = ss.Var("slot_b");
+  EXPECT_EQ(b, ss.FindVar(slot_b, "slot_b"));
+  EXPECT_EQ(nullptr, s.FindVar(slot_b, "slot_b"));
+  Variable* local_a = ss.Var("slot_a");
+  EXPECT_EQ(local_a, ss.FindVar(slot_a, "slot_a"));
+  ss.EraseVars({"slot_a"});
+  EXPECT_EQ(a, ss.FindVar(slot_a, "slot_a"));
+  s.Rename("slot_a", "slot_c");
+  EXPECT_EQ(nullptr, ss.FindVar(slot_a, "slot_a"));
+  EXPECT_EQ(a, ss.FindVar(Scope::VarSlot("slot_c"), "slot_c"));
+
+  // the slots not reserved are found by the names
+  Scope& sss = ss.NewScope();
+  size_t slot_d = Scope::VarSlot("slot_d");
+  Variable* d = sss.Var("slot_d");
+  EXPECT_EQ(d, sss.FindVar(slot_d, "slot_d"));
+  EXPECT_EQ(b, sss.FindVar(slot_b, "slot_b"));
+}
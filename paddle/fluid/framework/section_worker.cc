@@ -97,6 +97,10 @@ void SyncFunctor::Synchronize() {
 std::atomic<int> SectionWorker::cpu_id_(0);
 void SectionWorker::Initialize(const TrainerDesc& trainer_desc) {
   dev_ctx_ = platform::DeviceContextPool::Instance().Get(place_);
+  if (platform::is_gpu_place(place_)) {
+    copy_ctx_.reset(new platform::CUDADeviceContext(
+        boost::get<platform::CUDAPlace>(place_)));
+  }
   std::shared_ptr<framework::ProgramDesc> program;
   program.reset(new ProgramDesc(
       trainer_desc.section_param().section_config(section_id_).program_desc()));
@@ -105,6 +109,30 @@ void SectionWorker::Initialize(const TrainerDesc& trainer_desc) {
   }
 }
 
+Scope* SectionWorker::CopyInputsToDevice(Scope* scope,
+                                         const platform::DeviceContext& ctx) {
+  Scope* exe_scope = nullptr;
+  if (scope->kids().empty()) {
+    exe_scope = &scope->NewScope();
+  } else {
+    exe_scope = scope->kids().front();
+    PADDLE_ENFORCE(scope->kids().size() == 1, "scope->kids().size(): %zu",
+                   scope->kids().size());
+  }
+
+  for (const std::string& name : *in_var_names_) {
+    const LoDTensor& src_tensor = scope->FindVar(name)->Get<LoDTensor>();
+    if (platform::is_gpu_place(src_tensor.place())) {
+      continue;
+    }
+    LoDTensor* gpu_tensor = exe_scope->Var(name)->GetMutable<LoDTensor>();
+    gpu_tensor->set_lod(src_tensor.lod());
+    TensorCopy(*static_cast<const Tensor*>(&src_tensor), place_, ctx,
+               static_cast<Tensor*>(gpu_tensor));
+  }
+  return exe_scope;
+}
+
 void SectionWorker::AutoSetCPUAffinity(bool reuse) {
   int thread_cpu_id = cpu_id_.fetch_add(1);
 
@@ -150,7 +178,20 @@ void SectionWorker::TrainFiles() {
   if (device_reader_ != nullptr) {
     device_reader_->Start();
   }
-  while (in_scope_queue_->Receive(&scope)) {
+  bool copy_to_device = section_id_ > 0 && platform::is_gpu_place(place_);
+  // the scope received while the ops of the last one run, whose inputs are
+  // being copied to the GPU
+  Scope* next_scope = nullptr;
+  auto receive = [&](Scope** s) {
+    if (next_scope != nullptr) {
+      *s = next_scope;
+      next_scope = nullptr;
+      return true;
+    }
+    return in_scope_queue_->Receive(s);
+  };
+  Scope* copied_scope = nullptr;
+  while (receive(&scope)) {
     if (device_reader_ != nullptr) {
       device_reader_->AssignFeedVar(*scope);
       batch_size = device_reader_->Next();
@@ -172,27 +213,15 @@ void SectionWorker::TrainFiles() {
     }
 
     Scope* exe_scope = scope;
-    if (section_id_ > 0 && platform::is_gpu_place(place_)) {
-      SEC_LOG << "CPU2GPU memory copy";
-
-      if (scope->kids().empty()) {
-        exe_scope = &scope->NewScope();
-      } else {
+    if (copy_to_device) {
+      if (copied_scope == scope) {
         exe_scope = scope->kids().front();
-        PADDLE_ENFORCE(scope->kids().size() == 1, "scope->kids().size(): %zu",
-                       scope->kids().size());
-      }
-
-      for (const std::string& name : *in_var_names_) {
-        const LoDTensor& src_tensor = scope->FindVar(name)->Get<LoDTensor>();
-        if (platform::is_gpu_place(src_tensor.place())) {
-          continue;
-        }
-        LoDTensor* gpu_tensor = exe_scope->Var(name)->GetMutable<LoDTensor>();
-        gpu_tensor->set_lod(src_tensor.lod());
-        TensorCopy(*static_cast<const Tensor*>(&src_tensor), place_, *dev_ctx_,
-                   static_cast<Tensor*>(gpu_tensor));
+        copied_scope = nullptr;
+      } else {
+        SEC_LOG << "CPU2GPU memory copy";
+        exe_scope = CopyInputsToDevice(scope, *copy_ctx_);
       }
+      copy_ctx_->Wait();
     }
 
     SEC_LOG << "begin running ops";
@@ -200,6 +229,11 @@ void SectionWorker::TrainFiles() {
     for (auto& op : ops_) {
       op->Run(*exe_scope, place_);
     }
+    if (copy_to_device && in_scope_queue_->TryReceive(&next_scope)) {
+      SEC_LOG << "CPU2GPU memory copy of the next scope";
+      CopyInputsToDevice(next_scope, *copy_ctx_);
+      copied_scope = next_scope;
+    }
     exe_scope->DropKids();
     // Wait for GPU calc finising, as the cudaMemcpy and GPU calc may be in
     // different streams
@@ -324,24 +358,7 @@ void SectionWorker::TrainFilesWithProfiler() {
     if (section_id_ > 0 && platform::is_gpu_place(place_)) {
       SEC_LOG << "CPU2GPU memory copy";
       trans_timer.Resume();
-      if (scope->kids().empty()) {
-        exe_scope = &scope->NewScope();
-      } else {
-        exe_scope = scope->kids().front();
-        PADDLE_ENFORCE(scope->kids().size() == 1, "scope->kids().size(): %zu",
-                       scope->kids().size());
-      }
-
-      for (const std::string& name : *in_var_names_) {
-        const LoDTensor& src_tensor = scope->FindVar(name)->Get<LoDTensor>();
-        if (platform::is_gpu_place(src_tensor.place())) {
-          continue;
-        }
-        LoDTensor* gpu_tensor = exe_scope->Var(name)->GetMutable<LoDTensor>();
-        gpu_tensor->set_lod(src_tensor.lod());
-        TensorCopy(*static_cast<const Tensor*>(&src_tensor), place_, *dev_ctx_,
-                   static_cast<Tensor*>(gpu_tensor));
-      }
+      exe_scope = CopyInputsToDevice(scope, *dev_ctx_);
       trans_timer.Pause();
     }
 
@@ -142,63 +142,63 @@ bool SelectedRows::HasKey(int64_t key) const {
 
 int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown,
                                      bool is_test) {
+  auto &shard = IndexShardOf(key);
   if (is_test) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
+    auto iter = shard.id_to_index.find(key);
+    if (iter == shard.id_to_index.end()) {
       return -1;
     } else {
       return iter->second;
     }
   }
 
-  rwlock_->RDLock();
-  auto iter = id_to_index_.find(key);
-  if (iter == id_to_index_.end()) {
-    rwlock_->UNLock();
-    if (!auto_grown) {
-      PADDLE_THROW("key %d not found", key);
-    }
-    rwlock_->WRLock();
-    auto map_size = id_to_index_.size();
-    auto vector_size = rows_.size();
-    if (map_size != vector_size) {
-      rwlock_->UNLock();
-      PADDLE_THROW(
-          "id_to_index_ size %d should have the same size with rows_ %d",
-          map_size, vector_size);
+  {
+    AutoRDLock read_guard(&shard.rwlock);
+    auto iter = shard.id_to_index.find(key);
+    if (iter != shard.id_to_index.end()) {
+      return iter->second;
     }
-    auto write_iter = id_to_index_.find(key);
-    if (write_iter == id_to_index_.end()) {
-      int row_num = rows_.size();
-      if (row_num == value_->dims()[0]) {
-        rwlock_->UNLock();
-        PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
-      }
-      // key logic to put a key into id_to_index_
-      rows_.push_back(key);
-      auto index = static_cast<int64_t>(rows_.size() - 1);
-      id_to_index_[key] = index;
-      rwlock_->UNLock();
-      return index;
-    } else {
-      auto index = write_iter->second;
-      rwlock_->UNLock();
-      return index;
+  }
+  if (!auto_grown) {
+    PADDLE_THROW("key %d not found", key);
+  }
+
+  AutoWRLock shard_guard(&shard.rwlock);
+  auto iter = shard.id_to_index.find(key);
+  if (iter != shard.id_to_index.end()) {
+    return iter->second;
+  }
+  int64_t index;
+  {
+    // key logic to put a key into rows_, the other shards are not blocked
+    AutoWRLock rows_guard(&id_index_->rows_lock);
+    int64_t row_num = rows_.size();
+    if (row_num == value_->dims()[0]) {
+      PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
     }
-  } else {
-    auto index = iter->second;
-    rwlock_->UNLock();
-    return index;
+    rows_.push_back(key);
+    index = row_num;
   }
+  shard.id_to_index[key] = index;
+  return index;
 }
 
 void SelectedRows::SyncIndex() {
-  rwlock_->WRLock();
-  id_to_index_.clear();
-  for (size_t i = 0; i < rows_.size(); ++i) {
-    id_to_index_[rows_[i]] = i;
+  // lock the shards before rows_, in the same order as AutoGrownIndex
+  auto *shards = IndexShards();
+  for (int i = 0; i < kIndexShardNum; ++i) {
+    shards[i].rwlock.WRLock();
+    shards[i].id_to_index.clear();
+  }
+  {
+    AutoWRLock rows_guard(&id_index_->rows_lock);
+    for (size_t i = 0; i < rows_.size(); ++i) {
+      IndexShardOf(rows_[i]).id_to_index[rows_[i]] = i;
+    }
+  }
+  for (int i = 0; i < kIndexShardNum; ++i) {
+    shards[i].rwlock.UNLock();
   }
-  rwlock_->UNLock();
 }
 
 void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
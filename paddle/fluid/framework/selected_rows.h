@@ -49,13 +49,13 @@ class SelectedRows {
   SelectedRows(const std::vector<int64_t>& rows, const int64_t& height)
       : rows_(rows), height_(height) {
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    id_index_.reset(new IdIndex);
   }
 
   SelectedRows() {
     height_ = 0;
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    id_index_.reset(new IdIndex);
   }
 
   const platform::Place& place() const { return value_->place(); }
@@ -107,9 +107,14 @@ class SelectedRows {
            bool auto_grown = false, bool is_test = false);
 
   /*
-   * @brief Get the index of the key from id_to_index_ map. If the key not
+   * @brief Get the index of the key from the id index. If the key not
    * exist,
-   * add the key into id_to_index_.
+   * add the key into the id index.
+   *
+   * The id index is split into shards by the hash of the keys, each of which
+   * has its own lock, so that the lookups of the keys in different shards do
+   * not wait for each other, and only the new keys are appended to rows_
+   * under the table lock.
    *
    * Note!!! this interface is only used when selected_rows is used as
    * parameters
@@ -120,11 +125,12 @@ class SelectedRows {
   int64_t AutoGrownIndex(int64_t key, bool auto_grown, bool is_test = false);
 
   /*
-   * @brief Get the index of the key from id_to_index_ map.
+   * @brief Get the index of the key from the id index.
    */
   inline int64_t GetIndexFromId(int64_t key) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
+    auto& id_to_index = IndexShardOf(key).id_to_index;
+    auto iter = id_to_index.find(key);
+    if (iter == id_to_index.end()) {
       return -1;
     } else {
       return iter->second;
@@ -142,15 +148,46 @@ class SelectedRows {
   }
 
  private:
+  struct IndexShard {
+    RWLock rwlock;
+    std::unordered_map<int64_t, int64_t> id_to_index;
+  };
+
+  // the number of the shards of the id index, which should be a power of 2
+  static constexpr int kIndexShardBits = 6;
+  static constexpr int kIndexShardNum = 1 << kIndexShardBits;
+
+  // The shards are created on the first use, since most of SelectedRows are
+  // the sparse gradients which never use the id index.
+  struct IdIndex {
+    // guards the appending to rows_
+    RWLock rows_lock;
+    std::once_flag shards_created;
+    std::unique_ptr<IndexShard[]> shards;
+  };
+
+  inline IndexShard* IndexShards() const {
+    std::call_once(id_index_->shards_created, [this] {
+      id_index_->shards.reset(new IndexShard[kIndexShardNum]);
+    });
+    return id_index_->shards.get();
+  }
+
+  inline IndexShard& IndexShardOf(int64_t key) const {
+    // The ids are usually split to the pservers by ids % pserver_num, so mix
+    // the bits of the ids by the Fibonacci hashing to make the shards even.
+    uint64_t hash = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL;
+    return IndexShards()[hash >> (64 - kIndexShardBits)];
+  }
+
   // Notice: rows can be duplicate. We can have {0, 4, 7, 0, 5, 7, 9} here.
   // SelectedRows are simply concated when adding together. Until a
   // SelectedRows add a Tensor, will the duplicate rows be handled.
   Vector<int64_t> rows_;
-  std::unordered_map<int64_t, int64_t>
-      id_to_index_;  // should not be used when rows_ has duplicate member
+  // the id index should not be used when rows_ has duplicate member
+  std::unique_ptr<IdIndex> id_index_{nullptr};
   std::unique_ptr<Tensor> value_{nullptr};
   int64_t height_;  // height indicates the underline tensor's height
-  std::unique_ptr<RWLock> rwlock_{nullptr};
 };
 
 /*
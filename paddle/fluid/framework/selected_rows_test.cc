@@ -124,6 +124,25 @@ TEST(SelectedRows, SparseTable) {
   }
 }
 
+TEST(SelectedRows, SyncIndex) {
+  platform::CPUPlace cpu;
+  SelectedRows table({5, 3, 9}, 10);
+  table.mutable_value()->mutable_data<float>(framework::make_ddim({4, 2}),
+                                             cpu);
+  table.SyncIndex();
+  ASSERT_EQ(table.AutoGrownIndex(5, false), 0);
+  ASSERT_EQ(table.AutoGrownIndex(3, false), 1);
+  ASSERT_EQ(table.AutoGrownIndex(9, false), 2);
+  ASSERT_EQ(table.GetIndexFromId(7), -1);
+  ASSERT_THROW(table.AutoGrownIndex(7, false), platform::EnforceNotMet);
+
+  ASSERT_EQ(table.AutoGrownIndex(7, true), 3);
+  ASSERT_EQ(table.GetIndexFromId(7), 3);
+  // the table is full
+  ASSERT_THROW(table.AutoGrownIndex(1, true), platform::EnforceNotMet);
+  ASSERT_EQ(table.rows().size(), 4UL);
+}
+
 void f1(SelectedRows* table, int table_size) {
   for (int i = 1000000; i > 0; --i) {
     auto id = i % table_size;
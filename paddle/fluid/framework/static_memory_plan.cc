@@ -0,0 +1,260 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/static_memory_plan.h"
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/memory/malloc.h"
+
+namespace paddle {
+namespace framework {
+
+constexpr size_t StaticMemoryPlan::kAlignment;
+
+namespace {
+
+// A part of the arena, which keeps the arena alive while it is in use.
+class ArenaAllocation : public memory::Allocation {
+ public:
+  ArenaAllocation(std::shared_ptr<memory::Allocation> arena, size_t offset,
+                  size_t size)
+      : Allocation(static_cast<uint8_t *>(arena->ptr()) + offset, size,
+                   arena->place()),
+        arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<memory::Allocation> arena_;
+};
+
+inline size_t AlignTo(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+struct VarUse {
+  size_t first_use{std::numeric_limits<size_t>::max()};
+  size_t last_use{0};
+  bool read{false};
+  // read before written by the ops
+  bool input{false};
+};
+
+struct TensorGroup {
+  size_t first_use{std::numeric_limits<size_t>::max()};
+  size_t last_use{0};
+  size_t size{0};
+  bool plannable{true};
+  std::vector<LoDTensor *> tensors;
+};
+
+}  // namespace
+
+size_t StaticMemoryPlan::PackBuffers(std::vector<Buffer> *buffers,
+                                     size_t alignment) {
+  std::vector<size_t> order(buffers->size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [buffers](size_t a, size_t b) {
+    return (*buffers)[a].size > (*buffers)[b].size;
+  });
+
+  size_t arena_size = 0;
+  std::vector<const Buffer *> placed;
+  std::vector<const Buffer *> live;
+  for (size_t idx : order) {
+    auto &buffer = (*buffers)[idx];
+    live.clear();
+    for (auto *other : placed) {
+      if (other->first_use <= buffer.last_use &&
+          buffer.first_use <= other->last_use) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(), [](const Buffer *a, const Buffer *b) {
+      return a->offset < b->offset;
+    });
+
+    // the first gap between the live buffers large enough for the buffer
+    size_t offset = 0;
+    for (auto *other : live) {
+      if (offset + buffer.size <= other->offset) {
+        break;
+      }
+      offset =
+          std::max(offset, AlignTo(other->offset + other->size, alignment));
+    }
+    buffer.offset = offset;
+    arena_size = std::max(arena_size, offset + buffer.size);
+    placed.push_back(&buffer);
+  }
+  return AlignTo(arena_size, alignment);
+}
+
+std::unique_ptr<StaticMemoryPlan> StaticMemoryPlan::Build(
+    const std::vector<std::unique_ptr<OperatorBase>> &ops, const Scope &scope,
+    const platform::Place &place,
+    const std::unordered_set<std::string> &outputs) {
+  std::unordered_map<std::string, VarUse> uses;
+  std::vector<std::string> var_names;
+  auto use_of = [&](const std::string &name) -> VarUse & {
+    auto it = uses.find(name);
+    if (it == uses.end()) {
+      var_names.push_back(name);
+      it = uses.emplace(name, VarUse()).first;
+    }
+    return it->second;
+  };
+
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto &op = ops[i];
+    // the input shapes are checked before the run, which are set by the
+    // feed ops during the run
+    if (op->HasAttr("sub_block") || op->Type() == "feed") {
+      LOG(WARNING) << "The static memory plan is disabled since the program "
+                   << "has the op " << op->Type();
+      return nullptr;
+    }
+    for (auto &pair : op->Inputs()) {
+      for (auto &name : pair.second) {
+        if (name == kEmptyVarName) continue;
+        auto &use = use_of(name);
+        if (use.first_use == std::numeric_limits<size_t>::max()) {
+          use.first_use = i;
+          use.input = true;
+        }
+        use.last_use = i;
+        use.read = true;
+      }
+    }
+    for (auto &pair : op->Outputs()) {
+      for (auto &name : pair.second) {
+        if (name == kEmptyVarName) continue;
+        auto &use = use_of(name);
+        if (use.first_use == std::numeric_limits<size_t>::max()) {
+          use.first_use = i;
+        }
+        use.last_use = std::max(use.last_use, i);
+      }
+    }
+  }
+
+  std::unique_ptr<StaticMemoryPlan> plan(new StaticMemoryPlan);
+  std::unordered_map<memory::Allocation *, size_t> group_of_holder;
+  std::vector<TensorGroup> groups;
+  for (auto &name : var_names) {
+    auto &use = uses[name];
+    auto *var = scope.FindVar(name);
+    if (var == nullptr || !var->IsType<LoDTensor>()) continue;
+    auto *tensor = var->GetMutable<LoDTensor>();
+    if (use.input) {
+      plan->inputs_.push_back({tensor, tensor->dims(), tensor->lod()});
+    }
+    if (!tensor->IsInitialized()) continue;
+
+    auto *holder = tensor->Holder().get();
+    auto it = group_of_holder.find(holder);
+    if (it == group_of_holder.end()) {
+      it = group_of_holder.emplace(holder, groups.size()).first;
+      groups.emplace_back();
+    }
+    auto &group = groups[it->second];
+    // the tensors sharing memory with the inputs or the parameters, or with
+    // an offset into their holders are left to the normal allocation
+    int64_t size = tensor->numel() * SizeOfType(tensor->type());
+    if (use.input || scope.FindLocalVar(name) != var ||
+        tensor->offset() != 0 ||
+        !platform::is_same_place(tensor->place(), place) || size <= 0) {
+      group.plannable = false;
+      continue;
+    }
+    // the outputs of the program, and the tensors never read, are kept
+    // until the end of the run
+    size_t last_use =
+        use.read && outputs.count(name) == 0 ? use.last_use : ops.size();
+    group.first_use = std::min(group.first_use, use.first_use);
+    group.last_use = std::max(group.last_use, last_use);
+    group.size = std::max(group.size, static_cast<size_t>(size));
+    group.tensors.push_back(tensor);
+  }
+
+  std::vector<Buffer> buffers;
+  std::vector<const TensorGroup *> buffer_groups;
+  for (auto &group : groups) {
+    if (!group.plannable || group.tensors.empty()) continue;
+    buffers.push_back({group.size, group.first_use, group.last_use, 0});
+    buffer_groups.push_back(&group);
+  }
+  if (buffers.empty()) {
+    VLOG(3) << "No tensor to plan in the static memory plan";
+    return nullptr;
+  }
+
+  size_t arena_size = PackBuffers(&buffers, kAlignment);
+  plan->arena_ = memory::AllocShared(place, arena_size);
+  size_t planned_bytes = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    planned_bytes += buffers[i].size;
+    for (auto *tensor : buffer_groups[i]->tensors) {
+      plan->tensors_.push_back(
+          {tensor, buffers[i].offset, buffers[i].size, nullptr});
+    }
+  }
+  VLOG(3) << "Static memory plan packs " << plan->tensors_.size()
+          << " tensors of " << planned_bytes << " bytes into an arena of "
+          << arena_size << " bytes";
+  return plan;
+}
+
+bool StaticMemoryPlan::Matches() const {
+  for (auto &input : inputs_) {
+    if (input.tensor->dims() != input.dims ||
+        input.tensor->lod() != input.lod) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StaticMemoryPlan::Bind() {
+  for (auto &planned : tensors_) {
+    auto *tensor = planned.tensor;
+    // the tensors released or shared with other tensors by the ops are not
+    // bound again
+    if (!tensor->IsInitialized() || tensor->offset() != 0) continue;
+    if (planned.view && tensor->Holder() == planned.view) continue;
+    int64_t size = tensor->numel() * SizeOfType(tensor->type());
+    if (size <= 0 || static_cast<size_t>(size) > planned.size) continue;
+    if (!planned.view || planned.view->size() != static_cast<size_t>(size)) {
+      planned.view = std::make_shared<ArenaAllocation>(arena_, planned.offset,
+                                                       size);
+    }
+    tensor->ResetHolderWithType(planned.view, tensor->type());
+  }
+}
+
+void StaticMemoryPlan::Unbind() {
+  for (auto &planned : tensors_) {
+    if (planned.view && planned.tensor->Holder() == planned.view) {
+      planned.tensor->clear();
+    }
+    planned.view.reset();
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,106 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+/**
+ * StaticMemoryPlan replays the allocations of the intermediate tensors of a
+ * program with fixed input shapes. It is built from the tensors after a
+ * warm-up run: the tensors are packed into one arena by their sizes and
+ * the op ranges they are used in, so that the tensors used at the same time
+ * do not overlap. Bind() then points the tensors into the arena before each
+ * later run, and the ops find their outputs allocated already.
+ *
+ * The plan only holds for the input shapes of the warm-up run, it has to be
+ * rebuilt if Matches() returns false.
+ */
+class StaticMemoryPlan {
+ public:
+  // The alignment of the offsets in the arena.
+  static constexpr size_t kAlignment = 256;
+
+  struct Buffer {
+    size_t size;
+    // the index of the first and the last op using the buffer
+    size_t first_use;
+    size_t last_use;
+    // the offset in the arena, set by PackBuffers()
+    size_t offset;
+  };
+
+  // Set the offsets of the buffers, so that the buffers whose lifetimes
+  // overlap do not overlap in the arena, and return the size of the arena.
+  // The buffers are placed greedily from the largest one.
+  static size_t PackBuffers(std::vector<Buffer>* buffers, size_t alignment);
+
+  // Build the plan of the tensors in scope after running ops on place once.
+  // The outputs of the program, e.g. read by the zero copy tensors after the
+  // run, are kept until the end of the run even if they are read by the
+  // later ops. Return nullptr if the ops can not be planned, e.g. with
+  // sub-blocks or the feed ops.
+  static std::unique_ptr<StaticMemoryPlan> Build(
+      const std::vector<std::unique_ptr<OperatorBase>>& ops,
+      const Scope& scope, const platform::Place& place,
+      const std::unordered_set<std::string>& outputs = {});
+
+  // Whether the shapes of the input tensors are the same as the warm-up run.
+  bool Matches() const;
+
+  // Point the planned tensors into the arena.
+  void Bind();
+
+  // Release the planned tensors bound into the arena, so that they are
+  // allocated normally in the next run.
+  void Unbind();
+
+  size_t ArenaSize() const { return arena_ ? arena_->size() : 0; }
+
+  size_t PlannedTensorNum() const { return tensors_.size(); }
+
+ private:
+  struct InputShape {
+    const LoDTensor* tensor;
+    DDim dims;
+    LoD lod;
+  };
+
+  struct PlannedTensor {
+    LoDTensor* tensor;
+    size_t offset;
+    // the bytes planned for the tensor, the largest of the tensors sharing
+    // its buffer
+    size_t size;
+    std::shared_ptr<memory::Allocation> view;
+  };
+
+  std::vector<InputShape> inputs_;
+  std::vector<PlannedTensor> tensors_;
+  std::shared_ptr<memory::Allocation> arena_;
+};
+
+}  // namespace framework
+}  // namespace paddle
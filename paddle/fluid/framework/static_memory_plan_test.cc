@@ -0,0 +1,76 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/static_memory_plan.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+using Buffer = StaticMemoryPlan::Buffer;
+
+static bool Overlaps(const Buffer &a, const Buffer &b) {
+  bool live_together = a.first_use <= b.last_use && b.first_use <= a.last_use;
+  bool share_memory =
+      a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+  return live_together && share_memory;
+}
+
+TEST(StaticMemoryPlan, ReuseDeadBuffers) {
+  // a chain of ops, each of which reads the output of the previous one
+  std::vector<Buffer> buffers = {
+      {1000, 0, 1, 0}, {2000, 1, 2, 0}, {1000, 2, 3, 0}, {500, 3, 4, 0}};
+  size_t arena_size = StaticMemoryPlan::PackBuffers(&buffers, 256);
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    ASSERT_EQ(buffers[i].offset % 256, 0UL);
+    ASSERT_LE(buffers[i].offset + buffers[i].size, arena_size);
+    for (size_t j = i + 1; j < buffers.size(); ++j) {
+      ASSERT_FALSE(Overlaps(buffers[i], buffers[j])) << i << " " << j;
+    }
+  }
+  // two buffers are live at most at a time
+  ASSERT_EQ(arena_size, 3072UL);
+  ASSERT_EQ(buffers[1].offset, 0UL);
+  ASSERT_EQ(buffers[0].offset, buffers[2].offset);
+}
+
+TEST(StaticMemoryPlan, AllLive) {
+  std::vector<Buffer> buffers = {
+      {100, 0, 5, 0}, {300, 1, 4, 0}, {200, 2, 3, 0}};
+  size_t arena_size = StaticMemoryPlan::PackBuffers(&buffers, 64);
+  ASSERT_EQ(buffers[1].offset, 0UL);
+  ASSERT_EQ(buffers[2].offset, 320UL);
+  ASSERT_EQ(buffers[0].offset, 576UL);
+  ASSERT_EQ(arena_size, 704UL);
+}
+
+TEST(StaticMemoryPlan, FillGap) {
+  // the smallest buffer fits into the gap behind the buffer reusing the
+  // memory of the dead one
+  std::vector<Buffer> buffers = {
+      {1024, 0, 1, 0}, {1024, 0, 3, 0}, {512, 2, 3, 0}, {256, 2, 2, 0}};
+  size_t arena_size = StaticMemoryPlan::PackBuffers(&buffers, 256);
+  ASSERT_EQ(arena_size, 2048UL);
+  ASSERT_EQ(buffers[2].offset, 0UL);
+  ASSERT_EQ(buffers[3].offset, 512UL);
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    for (size_t j = i + 1; j < buffers.size(); ++j) {
+      ASSERT_FALSE(Overlaps(buffers[i], buffers[j])) << i << " " << j;
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
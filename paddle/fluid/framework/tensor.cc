@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/tensor.h"
+#include <algorithm>
 #include "paddle/fluid/framework/var_type.h"
 
 namespace paddle {
@@ -48,6 +49,7 @@ void* Tensor::mutable_data(const platform::Place& place,
     PADDLE_ENFORCE_GE(requested_size, size);
     size = requested_size;
   }
+  ++version_;
   /* some versions of boost::variant don't have operator!= */
   if (holder_ == nullptr || !(holder_->place() == place) ||
       holder_->size() < size + offset_) {
@@ -69,7 +71,10 @@ void* Tensor::mutable_data(const platform::Place& place,
 
 Tensor& Tensor::ShareDataWith(const Tensor& src) {
   src.check_memory_size();
+  // the version never decreases, since the data of this tensor is changed
+  auto version = std::max(version_, src.version_) + 1;
   *this = src;
+  version_ = version;
   return *this;
 }
 
@@ -112,6 +117,7 @@ void Tensor::ResetHolder(std::shared_ptr<memory::Allocation> holder) {
     PADDLE_ENFORCE_EQ(numel() * SizeOfType(type()), holder->size());
   }
   holder_ = holder;
+  ++version_;
 }
 
 void Tensor::ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
@@ -158,6 +158,7 @@ class Tensor {
   void ShareBufferWith(const Tensor& tensor) {
     holder_ = tensor.holder_;
     offset_ = tensor.offset_;
+    ++version_;
   }
 
   bool IsSharedBufferWith(const Tensor& src) const {
@@ -168,9 +169,25 @@ class Tensor {
   size_t offset() const { return offset_; }
 
   std::shared_ptr<memory::Allocation> MoveMemoryHolder() {
+    ++version_;
     return std::move(holder_);
   }
 
+  /**
+   * @brief   The version of the data, which is increased whenever the data
+   *          may be modified through this tensor, i.e. the mutable memory
+   *          block is accessed or the memory block is reset.
+   *
+   * @note    The data modified through the other tensors sharing the
+   *          memory block does not change the version.
+   */
+  uint64_t version() const { return version_; }
+
+  // Called by the writers modifying the data without accessing the mutable
+  // memory block of this tensor, e.g. through the raw pointer got before, or
+  // through the other tensors sharing the memory block.
+  void BumpVersion() { ++version_; }
+
   void ResetHolder(std::shared_ptr<memory::Allocation> holder);
 
   void ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
@@ -211,6 +228,8 @@ class Tensor {
    *          PlaceHolder::ptr_ and where the tensor data really begins.
    */
   size_t offset_;
+
+  uint64_t version_{0};
 };
 
 }  // namespace framework
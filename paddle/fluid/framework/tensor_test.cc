@@ -252,6 +252,22 @@ TEST(Tensor, Layout) {
   ASSERT_EQ(src.layout(), framework::DataLayout::kAnyLayout);
 }
 
+TEST(Tensor, Version) {
+  framework::Tensor src;
+  src.mutable_data<int>({2, 3}, platform::CPUPlace());
+  auto version = src.version();
+  const framework::Tensor& const_src = src;
+  const_src.data<int>();
+  EXPECT_EQ(src.version(), version);
+
+  // both accessing and reallocating the mutable memory block change it
+  src.data<int>()[0] = 1;
+  EXPECT_GT(src.version(), version);
+  version = src.version();
+  src.mutable_data<int>(platform::CPUPlace());
+  EXPECT_GT(src.version(), version);
+}
+
 TEST(Tensor, FP16) {
   using platform::float16;
   framework::Tensor src;
@@ -13,6 +13,7 @@
    limitations under the License. */
 #include "paddle/fluid/framework/tensor_util.h"
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <utility>
@@ -557,6 +558,264 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
   }
 }
 
+namespace {
+
+// A slice of a buffer, which keeps the buffer alive. The slice can be of a
+// different place from the buffer, e.g. the pinned memory used as CPU memory.
+class SlicedAllocation : public memory::Allocation {
+ public:
+  SlicedAllocation(std::shared_ptr<memory::Allocation> buffer, size_t offset,
+                   size_t size)
+      : SlicedAllocation(buffer, offset, size, buffer->place()) {}
+
+  SlicedAllocation(std::shared_ptr<memory::Allocation> buffer, size_t offset,
+                   size_t size, const platform::Place& place)
+      : Allocation(static_cast<char*>(buffer->ptr()) + offset, size, place),
+        buffer_(std::move(buffer)) {}
+
+ private:
+  std::shared_ptr<memory::Allocation> buffer_;
+};
+
+const char* ReadFromMemory(const memory::Allocation& buffer, size_t* offset,
+                           size_t size) {
+  PADDLE_ENFORCE_LE(*offset + size, buffer.size(),
+                    platform::errors::OutOfRange(
+                        "Reading %d bytes at offset %d exceeds the buffer of "
+                        "%d bytes, the serialized tensor may be damaged.",
+                        size, *offset, buffer.size()));
+  const char* ptr = static_cast<const char*>(buffer.ptr()) + *offset;
+  *offset += size;
+  return ptr;
+}
+
+}  // namespace
+
+void TensorFromMemory(const std::shared_ptr<memory::Allocation>& buffer,
+                      size_t* offset, Tensor* tensor) {
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(buffer->place()), true,
+                    platform::errors::InvalidArgument(
+                        "The tensors can only be deserialized from the CPU "
+                        "memory."));
+  uint32_t version;
+  std::memcpy(&version, ReadFromMemory(*buffer, offset, sizeof(version)),
+              sizeof(version));
+  PADDLE_ENFORCE_EQ(
+      version, 0U,
+      platform::errors::InvalidArgument(
+          "tensor version %u is not supported, Only version 0 is supported",
+          version));
+  proto::VarType::TensorDesc desc;
+  {  // int32_t size
+     // proto buffer
+    int32_t size;
+    std::memcpy(&size, ReadFromMemory(*buffer, offset, sizeof(size)),
+                sizeof(size));
+    PADDLE_ENFORCE_EQ(
+        desc.ParseFromArray(ReadFromMemory(*buffer, offset, size), size), true,
+        platform::errors::InvalidArgument("Cannot parse tensor desc"));
+  }
+  {  // share tensor
+    std::vector<int64_t> dims;
+    dims.reserve(static_cast<size_t>(desc.dims().size()));
+    std::copy(desc.dims().begin(), desc.dims().end(), std::back_inserter(dims));
+    size_t size = product(framework::make_ddim(dims)) *
+                  framework::SizeOfType(desc.data_type());
+    size_t data_offset = *offset;
+    ReadFromMemory(*buffer, offset, size);
+    TensorShareBufferSlice(buffer, data_offset, framework::make_ddim(dims),
+                           desc.data_type(), tensor);
+  }
+}
+
+void TensorShareBufferSlice(const std::shared_ptr<memory::Allocation>& buffer,
+                            size_t offset, const DDim& dims,
+                            proto::VarType::Type type, Tensor* tensor) {
+  size_t size = product(dims) * framework::SizeOfType(type);
+  PADDLE_ENFORCE_LE(offset + size, buffer->size(),
+                    platform::errors::OutOfRange(
+                        "The slice of %d bytes at offset %d exceeds the "
+                        "buffer of %d bytes.",
+                        size, offset, buffer->size()));
+  tensor->clear();
+  tensor->Resize(dims);
+  tensor->ResetHolderWithType(
+      std::make_shared<SlicedAllocation>(buffer, offset, size), type);
+}
+
+TensorCopyEvent& TensorCopyEvent::operator=(TensorCopyEvent&& other) {
+  if (this != &other) {
+    Wait();
+    holders_ = std::move(other.holders_);
+#ifdef PADDLE_WITH_CUDA
+    event_ = std::move(other.event_);
+#endif
+  }
+  return *this;
+}
+
+void TensorCopyEvent::Wait() {
+#ifdef PADDLE_WITH_CUDA
+  if (event_) {
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaEventSynchronize(event_.get()),
+        platform::errors::External("Failed to wait for the tensor copy."));
+    event_.reset();
+  }
+#endif
+  holders_.clear();
+}
+
+bool TensorCopyEvent::Query() const {
+#ifdef PADDLE_WITH_CUDA
+  if (event_) {
+    auto status = cudaEventQuery(event_.get());
+    if (status == cudaErrorNotReady) {
+      return false;
+    }
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        status,
+        platform::errors::External("Failed to query the tensor copy."));
+  }
+#endif
+  return true;
+}
+
+void TensorCopyEvent::WaitOnCtx(const platform::DeviceContext& ctx) {
+#ifdef PADDLE_WITH_CUDA
+  if (event_ && platform::is_gpu_place(ctx.GetPlace())) {
+    auto stream =
+        reinterpret_cast<const platform::CUDADeviceContext&>(ctx).stream();
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaStreamWaitEvent(stream, event_.get(), 0),
+        platform::errors::External("Failed to wait for the tensor copy."));
+    return;
+  }
+#endif
+  // the work on CPU is launched synchronously
+  Wait();
+}
+
+TensorCopyEvent TensorCopyAsync(const Tensor& src,
+                                const platform::Place& dst_place,
+                                const platform::DeviceContext& ctx,
+                                Tensor* dst) {
+  TensorCopyEvent event;
+  auto src_place = src.place();
+  if (!platform::is_gpu_place(src_place) &&
+      !platform::is_gpu_place(dst_place)) {
+    TensorCopy(src, dst_place, ctx, dst);
+    return event;
+  }
+#ifdef PADDLE_WITH_CUDA
+  if (&src == dst) {
+    auto src_copy = src;
+    return TensorCopyAsync(src_copy, dst_place, ctx, dst);
+  }
+
+  VLOG(3) << "TensorCopyAsync " << src.dims() << " from " << src_place
+          << " to " << dst_place;
+  src.check_memory_size();
+  auto ctx_place = ctx.GetPlace();
+  PADDLE_ENFORCE_EQ(platform::is_gpu_place(ctx_place), true,
+                    platform::errors::InvalidArgument(
+                        "The copy from %s to %s should be carried out on a "
+                        "CUDA stream, but the context is of %s.",
+                        src_place, dst_place, ctx_place));
+  auto stream =
+      reinterpret_cast<const platform::CUDADeviceContext&>(ctx).stream();
+  auto size = src.numel() * SizeOfType(src.type());
+  auto src_ptr = src.data<void>();
+  event.holders_.emplace_back(src.Holder());
+
+  if (platform::is_cpu_place(dst_place)) {
+    PADDLE_ENFORCE_EQ(src_place, ctx_place,
+                      platform::errors::InvalidArgument(
+                          "The copy from %s to CPU should be carried out on "
+                          "the stream of %s, but the context is of %s.",
+                          src_place, src_place, ctx_place));
+    std::shared_ptr<memory::Allocation> pinned =
+        memory::AllocShared(platform::CUDAPinnedPlace(), size);
+    dst->clear();
+    dst->Resize(src.dims());
+    dst->set_layout(src.layout());
+    dst->ResetHolderWithType(std::make_shared<SlicedAllocation>(
+                                 pinned, 0, size, platform::CPUPlace()),
+                             src.type());
+    memory::Copy(platform::CUDAPinnedPlace(), pinned->ptr(),
+                 boost::get<platform::CUDAPlace>(src_place), src_ptr, size,
+                 stream);
+    event.holders_.emplace_back(std::move(pinned));
+  } else {
+    PADDLE_ENFORCE_EQ(dst_place, ctx_place,
+                      platform::errors::InvalidArgument(
+                          "The copy from %s to %s should be carried out on "
+                          "the stream of %s, but the context is of %s.",
+                          src_place, dst_place, dst_place, ctx_place));
+    dst->Resize(src.dims());
+    dst->set_layout(src.layout());
+    auto dst_ptr = dst->mutable_data(dst_place, src.type());
+    auto dst_gpu_place = boost::get<platform::CUDAPlace>(dst_place);
+    if (platform::is_cpu_place(src_place)) {
+      // the host returns once src is copied to the staging buffer
+      std::shared_ptr<memory::Allocation> pinned =
+          memory::AllocShared(platform::CUDAPinnedPlace(), size);
+      std::memcpy(pinned->ptr(), src_ptr, size);
+      memory::Copy(dst_gpu_place, dst_ptr, platform::CUDAPinnedPlace(),
+                   pinned->ptr(), size, stream);
+      event.holders_.emplace_back(std::move(pinned));
+    } else if (platform::is_cuda_pinned_place(src_place)) {
+      memory::Copy(dst_gpu_place, dst_ptr,
+                   boost::get<platform::CUDAPinnedPlace>(src_place), src_ptr,
+                   size, stream);
+    } else if (platform::is_gpu_place(src_place)) {
+      if (src_ptr == dst_ptr && src_place == dst_place) {
+        return event;
+      }
+      if (!platform::is_same_place(src_place, dst_place)) {
+        auto* src_ctx = static_cast<platform::CUDADeviceContext*>(
+            platform::DeviceContextPool::Instance().Get(src_place));
+        auto src_event = platform::CudaEventResourcePool::Instance().New(
+            boost::get<platform::CUDAPlace>(src_place).device);
+        PADDLE_ENFORCE_CUDA_SUCCESS(
+            cudaEventRecord(src_event.get(), src_ctx->stream()),
+            platform::errors::External("Failed to record the CUDA event."));
+        PADDLE_ENFORCE_CUDA_SUCCESS(
+            cudaStreamWaitEvent(stream, src_event.get(), 0),
+            platform::errors::External("Failed to wait for the CUDA event."));
+      }
+      memory::Copy(dst_gpu_place, dst_ptr,
+                   boost::get<platform::CUDAPlace>(src_place), src_ptr, size,
+                   stream);
+    } else {
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Copy from %s to %s is not supported.", src_place, dst_place));
+    }
+    event.holders_.emplace_back(dst->Holder());
+  }
+
+  event.event_ = platform::CudaEventResourcePool::Instance().New(
+      boost::get<platform::CUDAPlace>(ctx_place).device);
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaEventRecord(event.event_.get(), stream),
+      platform::errors::External("Failed to record the CUDA event."));
+#endif
+  return event;
+}
+
+TensorCopyEvent TensorCopyAsync(const Tensor& src,
+                                const platform::Place& dst_place,
+                                Tensor* dst) {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  const platform::DeviceContext* dev_ctx;
+  if (platform::is_gpu_place(dst_place)) {
+    dev_ctx = pool.Get(dst_place);
+  } else {
+    dev_ctx = pool.Get(src.place());
+  }
+  return TensorCopyAsync(src, dst_place, *dev_ctx, dst);
+}
+
 // get tensor data point by DLDataType
 void* GetDstPtrByDLDataType(DLDataType type, framework::Tensor* dst,
                             const platform::Place& dst_place) {
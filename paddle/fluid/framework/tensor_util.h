@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <memory>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/dlpack_tensor.h"
@@ -20,6 +21,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/platform/device_context.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cuda_resource_pool.h"
+#endif
 
 namespace paddle {
 namespace framework {
@@ -46,6 +50,58 @@ void TensorCopy(const Tensor& src, const platform::Place& dst_place,
 void TensorCopySync(const Tensor& src, const platform::Place& dst_place,
                     Tensor* dst);
 
+// The handle of a copy of TensorCopyAsync. It holds the allocations used by
+// the copy until the copy is finished, so the source and the destination
+// tensors can be released or reused by the caller meanwhile. Destroying the
+// handle of an unfinished copy waits for the copy.
+class TensorCopyEvent {
+ public:
+  // The handle of a finished copy.
+  TensorCopyEvent() = default;
+  TensorCopyEvent(TensorCopyEvent&& other) = default;
+  TensorCopyEvent& operator=(TensorCopyEvent&& other);
+  ~TensorCopyEvent() { Wait(); }
+
+  // Blocks until the copy is finished.
+  void Wait();
+
+  // Whether the copy is finished, which does not block.
+  bool Query() const;
+
+  // Makes the work launched on ctx afterwards wait for the copy, without
+  // blocking the host.
+  void WaitOnCtx(const platform::DeviceContext& ctx);
+
+ private:
+  friend TensorCopyEvent TensorCopyAsync(const Tensor& src,
+                                         const platform::Place& dst_place,
+                                         const platform::DeviceContext& ctx,
+                                         Tensor* dst);
+
+  std::vector<std::shared_ptr<memory::Allocation>> holders_;
+#ifdef PADDLE_WITH_CUDA
+  std::shared_ptr<platform::CudaEventObject> event_;
+#endif
+};
+
+// NOTE: Unlike TensorCopy, TensorCopyAsync never blocks the host:
+// 1. The copy from GPU to CPU is written to pinned memory, which dst holds
+//    as CPU memory, and the copy from CPU to GPU is staged in pinned memory,
+//    because the copies between a GPU and pageable memory are synchronous.
+// 2. The copy between two GPUs is carried out on the stream of ctx, which
+//    should belong to dst_place, after the work launched on the stream of
+//    src_place, which is waited by an event rather than src_ctx.Wait().
+// The copy on CPU is synchronous, and the returned handle is finished.
+TensorCopyEvent TensorCopyAsync(const Tensor& src,
+                                const platform::Place& dst_place,
+                                const platform::DeviceContext& ctx,
+                                Tensor* dst);
+
+// The copy is carried out on the stream of dst_place if it is a GPU,
+// otherwise on the stream of src.place(), the same as TensorCopy.
+TensorCopyEvent TensorCopyAsync(const Tensor& src,
+                                const platform::Place& dst_place, Tensor* dst);
+
 template <typename T>
 void TensorFromVector(const std::vector<T>& src,
                       const platform::DeviceContext& ctx, Tensor* dst);
@@ -75,6 +131,16 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
 void TensorFromStream(std::istream& is, Tensor* tensor,
                       const platform::DeviceContext& dev_ctx,
                       const size_t& seek, const std::vector<int64_t>& shape);
+// Deserialize the tensor at *offset of the CPU buffer, written by
+// TensorToStream, and advance *offset past it. The data is not copied, the
+// tensor holds a slice of the buffer instead.
+void TensorFromMemory(const std::shared_ptr<memory::Allocation>& buffer,
+                      size_t* offset, Tensor* tensor);
+// Make the tensor hold the bytes at offset of the buffer as its data, which
+// keeps the buffer alive.
+void TensorShareBufferSlice(const std::shared_ptr<memory::Allocation>& buffer,
+                            size_t offset, const DDim& dims,
+                            proto::VarType::Type type, Tensor* tensor);
 
 // convert dlpack's DLTensor to tensor
 void TensorFromDLPack(const ::DLTensor& dl_tensor, framework::Tensor* dst);
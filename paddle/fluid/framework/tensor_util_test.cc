@@ -118,6 +118,52 @@ TEST(TensorCopy, Tensor) {
 #endif
 }
 
+TEST(TensorCopyAsync, Tensor) {
+  Tensor src_tensor;
+  Tensor dst_tensor;
+  platform::CPUDeviceContext cpu_ctx((platform::CPUPlace()));
+
+  int* src_ptr =
+      src_tensor.mutable_data<int>(make_ddim({3, 3}), platform::CPUPlace());
+  for (int i = 0; i < 9; ++i) {
+    src_ptr[i] = i;
+  }
+
+  // the copy on CPU is finished once it returns
+  auto event =
+      TensorCopyAsync(src_tensor, platform::CPUPlace(), cpu_ctx, &dst_tensor);
+  EXPECT_TRUE(event.Query());
+  EXPECT_NE(dst_tensor.data<int>(), src_ptr);
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(dst_tensor.data<int>()[i], i);
+  }
+
+#ifdef PADDLE_WITH_CUDA
+  {
+    platform::CUDAPlace gpu_place(0);
+    platform::CUDADeviceContext gpu_ctx(gpu_place);
+    Tensor gpu_tensor;
+    Tensor cpu_tensor;
+    auto to_gpu =
+        TensorCopyAsync(src_tensor, gpu_place, gpu_ctx, &gpu_tensor);
+    // src can be reused once the copy to GPU is launched
+    src_tensor.mutable_data<int>(platform::CPUPlace())[0] = 100;
+    auto to_cpu = TensorCopyAsync(gpu_tensor, platform::CPUPlace(), gpu_ctx,
+                                  &cpu_tensor);
+    // gpu_tensor is held until the copy is finished
+    gpu_tensor.clear();
+    to_cpu.Wait();
+    EXPECT_TRUE(to_gpu.Query());
+    EXPECT_TRUE(to_cpu.Query());
+    EXPECT_TRUE(platform::is_cpu_place(cpu_tensor.place()));
+    EXPECT_EQ(cpu_tensor.dims(), src_tensor.dims());
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_EQ(cpu_tensor.data<int>()[i], i);
+    }
+  }
+#endif
+}
+
 TEST(TensorFromVector, Tensor) {
   {
     std::vector<int> src_vec = {1, 2, 3, 4, 5, 6, 7, 8, 9};
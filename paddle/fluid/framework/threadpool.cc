@@ -43,14 +43,14 @@ void ThreadPool::Init() {
       VLOG(1) << "set dist_threadpool_size to " << num_threads;
     }
     PADDLE_ENFORCE_GT(num_threads, 0);
-    threadpool_.reset(new ThreadPool(num_threads));
+    threadpool_.reset(new ThreadPool(num_threads, platform::CpuPool::kComm));
   }
 }
 
-ThreadPool::ThreadPool(int num_threads) : running_(true) {
+ThreadPool::ThreadPool(int num_threads, platform::CpuPool cpu_pool)
+    : running_(true), cpu_pool_(cpu_pool) {
   threads_.resize(num_threads);
   for (auto& thread : threads_) {
-    // TODO(Yancey1989): binding the thread on the specify CPU number
     thread.reset(new std::thread(std::bind(&ThreadPool::TaskLoop, this)));
   }
 }
@@ -90,6 +90,9 @@ void ThreadPool::TaskLoop() {
       task = std::move(tasks_.front());
       tasks_.pop();
     }
+    // The partition may be set after the thread starts, which costs
+    // nothing if it is not changed.
+    platform::BindThreadToCpuPool(cpu_pool_);
     // run the task
     task();
   }
@@ -106,7 +109,8 @@ ThreadPool* ThreadPoolIO::GetInstanceIO() {
 void ThreadPoolIO::InitIO() {
   if (io_threadpool_.get() == nullptr) {
     // TODO(typhoonzero1986): make this configurable
-    io_threadpool_.reset(new ThreadPool(FLAGS_io_threadpool_size));
+    io_threadpool_.reset(
+        new ThreadPool(FLAGS_io_threadpool_size, platform::CpuPool::kIO));
   }
 }
 
@@ -24,6 +24,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 #include "glog/logging.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
 
@@ -47,10 +48,12 @@ struct ExceptionHandler {
 };
 
 // ThreadPool maintains a queue of tasks, and runs them using a fixed
-// number of threads.
+// number of threads, which are bound to the CPU pool if the CPUs are
+// partitioned, see cpu_affinity.h.
 class ThreadPool {
  public:
-  explicit ThreadPool(int num_threads);
+  explicit ThreadPool(int num_threads,
+                      platform::CpuPool cpu_pool = platform::CpuPool::kNone);
 
   using Task = std::packaged_task<std::unique_ptr<platform::EnforceNotMet>()>;
 
@@ -116,6 +119,7 @@ class ThreadPool {
   std::mutex mutex_;
   bool running_;
   std::condition_variable scheduled_;
+  platform::CpuPool cpu_pool_;
 };
 
 class ThreadPoolIO : ThreadPool {
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/transfer_scope_cache.h"
+#include "paddle/fluid/platform/metrics.h"
 
 namespace paddle {
 namespace framework {
@@ -35,10 +36,18 @@ Scope* TryCreateTransferScope(OpKernelType type0, OpKernelType type1,
   infer_cache_key =
       CombineHash(infer_cache_key, std::hash<const Scope*>()(scope));
 
+  static auto* hits = platform::MetricsRegistry::Instance().Counter(
+      "paddle_transfer_scope_cache_hits_total",
+      "The transfer scopes found in the cache.");
+  static auto* misses = platform::MetricsRegistry::Instance().Counter(
+      "paddle_transfer_scope_cache_misses_total",
+      "The transfer scopes created since they are not in the cache.");
   auto it = global_transfer_data_cache().find(infer_cache_key);
   if (it != global_transfer_data_cache().end()) {
+    hits->Add();
     new_scope = global_transfer_data_cache()[infer_cache_key];
   } else {
+    misses->Add();
     new_scope = &scope->NewScope();
     global_transfer_data_cache()[infer_cache_key] = new_scope;
   }
@@ -36,6 +36,8 @@ class InferNoNeedBufferVarsFN;
 using VariableNameMap = std::map<std::string, std::vector<std::string>>;
 // TODO(panyx0718): Replace vector with something like gtl::Vector.
 using VariableValueMap = std::map<std::string, std::vector<Variable*>>;
+// The slots of the variables of VariableNameMap, see Scope::VarSlot.
+using VariableSlotMap = std::map<std::string, std::vector<size_t>>;
 
 // The order should be as same as framework.proto
 using Attribute =
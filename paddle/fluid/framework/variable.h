@@ -50,6 +50,7 @@ class Variable {
           "The Variable type must be %s, but the type it holds is %s.",
           ToTypeName(VarTypeTrait<T>::kId), ToTypeName(holder_->Type()));
     }
+    ++version_;
     return static_cast<T*>(holder_->Ptr());
   }
 
@@ -58,7 +59,24 @@ class Variable {
     return holder_ && holder_->Type() == VarTypeTrait<T>::kId;
   }
 
-  void Clear() { holder_.reset(); }
+  void Clear() {
+    holder_.reset();
+    ++version_;
+  }
+
+  // The version of the variable, which is increased whenever it may be
+  // modified, i.e. GetMutable or Clear is called, or the data of the tensor
+  // it holds is modified, see Tensor::version. The caches of the data derived
+  // from the variable can be invalidated by comparing the versions.
+  uint64_t Version() const {
+    uint64_t version = version_;
+    if (IsType<LoDTensor>()) {
+      version += Get<LoDTensor>().version();
+    } else if (IsType<Tensor>()) {
+      version += Get<Tensor>().version();
+    }
+    return version;
+  }
 
   int Type() const {
     PADDLE_ENFORCE(holder_ != nullptr, "Variable is not initialized.");
@@ -98,6 +116,7 @@ class Variable {
 
   // pointers to a PlaceholderImpl object indeed.
   std::unique_ptr<Placeholder> holder_;
+  uint64_t version_{0};
 };
 
 }  // namespace framework
@@ -39,5 +39,32 @@ TEST(Variable, GetMutable) {
   EXPECT_TRUE(false);
 }
 
+TEST(Variable, Version) {
+  Variable v;
+  auto version = v.Version();
+  auto* t = v.GetMutable<LoDTensor>();
+  EXPECT_GT(v.Version(), version);
+
+  version = v.Version();
+  t->mutable_data<float>({2, 3}, platform::CPUPlace());
+  EXPECT_GT(v.Version(), version);
+
+  // reading the variable keeps the version
+  version = v.Version();
+  v.Get<LoDTensor>().data<float>();
+  EXPECT_EQ(v.Version(), version);
+
+  // the writers through a raw pointer bump the version explicitly
+  t->BumpVersion();
+  EXPECT_GT(v.Version(), version);
+
+  // sharing the data of another tensor never decreases the version
+  version = v.Version();
+  LoDTensor other;
+  other.mutable_data<float>({2, 3}, platform::CPUPlace());
+  t->ShareDataWith(other);
+  EXPECT_GT(v.Version(), version);
+}
+
 }  // namespace framework
 }  // namespace paddle
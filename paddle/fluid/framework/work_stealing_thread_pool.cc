@@ -0,0 +1,163 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+#include <algorithm>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+// the pool and the index of the worker running on the current thread
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+inline int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t num_threads)
+    : start_ns_(NowNs()) {
+  PADDLE_ENFORCE_GT(num_threads, 0,
+                    platform::errors::InvalidArgument(
+                        "The thread number of WorkStealingThreadPool must be "
+                        "greater than 0, but received %d",
+                        num_threads));
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker);
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_[i]->thread = std::thread([this, i] { WorkerLoop(i); });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void WorkStealingThreadPool::Push(Task task) {
+  size_t index = current_pool == this
+                     ? current_worker
+                     : next_worker_.fetch_add(1) % workers_.size();
+  // counted before the task is visible, so that pending_ never underflows
+  pending_.fetch_add(1);
+  {
+    auto& worker = *workers_[index];
+    std::lock_guard<std::mutex> guard(worker.mutex);
+    worker.tasks.emplace_back(std::move(task));
+  }
+  // the sleeping threads check pending_ with mutex_ held before waiting, so
+  // that the notification can not be lost
+  if (sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    cv_.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::PopTask(size_t index, Task* task) {
+  {
+    auto& worker = *workers_[index];
+    std::lock_guard<std::mutex> guard(worker.mutex);
+    if (!worker.tasks.empty()) {
+      *task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    auto& victim = *workers_[(index + i) % workers_.size()];
+    std::lock_guard<std::mutex> guard(victim.mutex);
+    if (!victim.tasks.empty()) {
+      *task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      workers_[index]->steal_num.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::WorkerLoop(size_t index) {
+  current_pool = this;
+  current_worker = index;
+  auto& worker = *workers_[index];
+  Task task;
+  while (true) {
+    if (pending_.load() > 0 && PopTask(index, &task)) {
+      pending_.fetch_sub(1);
+      int64_t start = NowNs();
+      task();
+      task = nullptr;
+      worker.busy_ns.fetch_add(NowNs() - start, std::memory_order_relaxed);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping_.fetch_add(1);
+    cv_.wait(lock, [this] { return stop_ || pending_.load() > 0; });
+    sleeping_.fetch_sub(1);
+    if (stop_ && pending_.load() == 0) {
+      break;
+    }
+  }
+  current_pool = nullptr;
+}
+
+std::vector<double> WorkStealingThreadPool::Utilization() const {
+  double elapsed = static_cast<double>(
+      NowNs() - start_ns_.load(std::memory_order_relaxed));
+  std::vector<double> utilization;
+  utilization.reserve(workers_.size());
+  for (auto& worker : workers_) {
+    double busy = static_cast<double>(
+        worker->busy_ns.load(std::memory_order_relaxed));
+    utilization.push_back(elapsed > 0 ? std::min(busy / elapsed, 1.0) : 0);
+  }
+  return utilization;
+}
+
+std::vector<size_t> WorkStealingThreadPool::StealNum() const {
+  std::vector<size_t> steal_num;
+  steal_num.reserve(workers_.size());
+  for (auto& worker : workers_) {
+    steal_num.push_back(worker->steal_num.load(std::memory_order_relaxed));
+  }
+  return steal_num;
+}
+
+void WorkStealingThreadPool::ResetUtilization() {
+  start_ns_.store(NowNs(), std::memory_order_relaxed);
+  for (auto& worker : workers_) {
+    worker->busy_ns.store(0, std::memory_order_relaxed);
+    worker->steal_num.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,100 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+/**
+ * WorkStealingThreadPool runs the tasks on a fixed number of threads, each
+ * of which has its own task deque. A task pushed by a worker thread goes to
+ * the deque of the thread, which pops its latest task first, so that the
+ * tasks spawned by a task run on the same thread while the data they use
+ * are still in its cache. An idle thread steals the oldest task of the
+ * other threads. The tasks pushed from other threads are distributed to the
+ * workers in turn.
+ *
+ * Unlike a pool with one task queue, the threads only contend for the same
+ * lock when stealing, which makes it suitable for many small tasks.
+ * The tasks must not throw.
+ */
+class WorkStealingThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingThreadPool(size_t num_threads);
+
+  ~WorkStealingThreadPool();
+
+  WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+  WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+  void Push(Task task);
+
+  size_t NumThreads() const { return workers_.size(); }
+
+  // The part of the time each thread spends running tasks since the pool is
+  // created or ResetUtilization() is called.
+  std::vector<double> Utilization() const;
+
+  void ResetUtilization();
+
+  // The number of tasks each thread stole from the others since the pool is
+  // created or ResetUtilization() is called.
+  std::vector<size_t> StealNum() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::atomic<int64_t> busy_ns{0};
+    std::atomic<size_t> steal_num{0};
+    std::thread thread;
+  };
+
+  void WorkerLoop(size_t index);
+
+  // Pop a task from the deque of the worker, or steal one from the others.
+  bool PopTask(size_t index, Task* task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // the number of tasks pushed but not popped
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> next_worker_{0};
+
+  // the idle threads sleep on cv_
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<int> sleeping_{0};
+  bool stop_{false};
+
+  std::atomic<int64_t> start_ns_;
+};
+
+}  // namespace framework
+}  // namespace paddle
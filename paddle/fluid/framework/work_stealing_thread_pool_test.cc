@@ -0,0 +1,111 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+static void WaitFor(const std::atomic<int> &counter, int expected) {
+  while (counter.load() != expected) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(WorkStealingThreadPool, RunFromOutside) {
+  std::atomic<int> sum(0);
+  {
+    WorkStealingThreadPool pool(4);
+    ASSERT_EQ(pool.NumThreads(), 4UL);
+    for (int i = 1; i <= 1000; ++i) {
+      pool.Push([&sum, i] { sum.fetch_add(i); });
+    }
+  }
+  // the pending tasks are finished before the pool is destroyed
+  ASSERT_EQ(sum.load(), 1000 * 1001 / 2);
+}
+
+TEST(WorkStealingThreadPool, LatestSpawnedFirst) {
+  WorkStealingThreadPool pool(1);
+  std::atomic<int> done(0);
+  std::vector<int> order;
+  pool.Push([&] {
+    for (int i = 0; i < 3; ++i) {
+      pool.Push([&, i] {
+        order.push_back(i);
+        done.fetch_add(1);
+      });
+    }
+  });
+  WaitFor(done, 3);
+  ASSERT_EQ(order, std::vector<int>({2, 1, 0}));
+}
+
+TEST(WorkStealingThreadPool, Steal) {
+  WorkStealingThreadPool pool(4);
+  std::atomic<int> done(0);
+  const int kTaskNum = 64;
+  // all the tasks are pushed to the deque of one worker, and the idle
+  // workers steal them
+  pool.Push([&] {
+    for (int i = 0; i < kTaskNum; ++i) {
+      pool.Push([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        done.fetch_add(1);
+      });
+    }
+  });
+  WaitFor(done, kTaskNum);
+
+  size_t steal_num = 0;
+  for (auto num : pool.StealNum()) {
+    steal_num += num;
+  }
+  ASSERT_GT(steal_num, 0UL);
+
+  auto utilization = pool.Utilization();
+  ASSERT_EQ(utilization.size(), 4UL);
+  for (auto u : utilization) {
+    ASSERT_GE(u, 0.0);
+    ASSERT_LE(u, 1.0);
+  }
+  pool.ResetUtilization();
+  for (auto num : pool.StealNum()) {
+    ASSERT_EQ(num, 0UL);
+  }
+}
+
+TEST(WorkStealingThreadPool, Recursive) {
+  WorkStealingThreadPool pool(4);
+  std::atomic<int> done(0);
+  // a binary tree of tasks with 2^10 leaves
+  std::function<void(int)> spawn = [&](int depth) {
+    if (depth == 0) {
+      done.fetch_add(1);
+      return;
+    }
+    pool.Push([&spawn, depth] { spawn(depth - 1); });
+    pool.Push([&spawn, depth] { spawn(depth - 1); });
+  };
+  pool.Push([&spawn] { spawn(10); });
+  WaitFor(done, 1 << 10);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,169 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/amp_auto_cast.h"
+#include <algorithm>
+#include <utility>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/imperative/tracer.h"
+
+namespace paddle {
+namespace imperative {
+
+// Keeps the same as the lists of the static graph, see
+// python/paddle/fluid/contrib/mixed_precision/fp16_lists.py.
+AmpAutoCast::AmpAutoCast()
+    : white_list_({"conv2d", "matmul", "mul"}),
+      black_list_({"exp", "square", "log", "mean", "sum", "cos_sim", "softmax",
+                   "softmax_with_cross_entropy",
+                   "sigmoid_cross_entropy_with_logits", "cross_entropy",
+                   "cross_entropy2"}) {}
+
+void AmpAutoCast::SetOpLists(
+    const std::unordered_set<std::string>& white_list,
+    const std::unordered_set<std::string>& black_list) {
+  for (auto& type : white_list) {
+    PADDLE_ENFORCE_EQ(black_list.count(type), 0,
+                      platform::errors::InvalidArgument(
+                          "The op %s is on both the white list and the black "
+                          "list of the automatic mixed precision.",
+                          type));
+  }
+  white_list_ = white_list;
+  black_list_ = black_list;
+}
+
+static bool IsFloatTensor(const std::shared_ptr<VarBase>& var,
+                          framework::proto::VarType::Type data_type) {
+  return var && var->Var().IsType<framework::LoDTensor>() &&
+         var->DataType() == data_type;
+}
+
+NameVarBaseMap AmpAutoCast::CastInputs(Tracer* tracer, const std::string& type,
+                                       const NameVarBaseMap& ins,
+                                       const platform::Place& place,
+                                       bool trace_backward) {
+  auto src_type = framework::proto::VarType::FP16;
+  auto dst_type = framework::proto::VarType::FP32;
+  if (white_list_.count(type)) {
+    if (!HasFP16Kernel(type, place)) {
+      return {};
+    }
+    std::swap(src_type, dst_type);
+  } else if (!black_list_.count(type)) {
+    // The other ops run in float32 if they have both float16 and float32
+    // inputs.
+    bool has_fp16 = false;
+    bool has_fp32 = false;
+    for (auto& pair : ins) {
+      for (auto& var : pair.second) {
+        has_fp16 |= IsFloatTensor(var, framework::proto::VarType::FP16);
+        has_fp32 |= IsFloatTensor(var, framework::proto::VarType::FP32);
+      }
+    }
+    if (!has_fp16 || !has_fp32) {
+      return {};
+    }
+  }
+
+  NameVarBaseMap new_ins = ins;
+  bool casted = false;
+  for (auto& pair : new_ins) {
+    for (auto& var : pair.second) {
+      if (!IsFloatTensor(var, src_type)) continue;
+      if (dst_type == framework::proto::VarType::FP16) {
+        var = CastWithCache(tracer, var, place, trace_backward);
+      } else {
+        var = Cast(tracer, var, dst_type, place, trace_backward);
+      }
+      casted = true;
+    }
+  }
+  if (!casted) {
+    return {};
+  }
+  VLOG(5) << "Cast the inputs of op " << type << " to "
+          << framework::DataTypeToString(dst_type);
+  return new_ins;
+}
+
+std::shared_ptr<VarBase> AmpAutoCast::Cast(
+    Tracer* tracer, const std::shared_ptr<VarBase>& var,
+    framework::proto::VarType::Type data_type, const platform::Place& place,
+    bool trace_backward) {
+  auto out = std::make_shared<VarBase>(
+      true, tracer->GenerateUniqueName(var->Name() + "_auto_cast"));
+  framework::AttributeMap attrs;
+  attrs["in_dtype"] = static_cast<int>(var->DataType());
+  attrs["out_dtype"] = static_cast<int>(data_type);
+  tracer->TraceOp("cast", {{"X", {var}}}, {{"Out", {out}}}, std::move(attrs),
+                  place, trace_backward);
+  ++cast_op_num_;
+  return out;
+}
+
+std::shared_ptr<VarBase> AmpAutoCast::CastWithCache(
+    Tracer* tracer, const std::shared_ptr<VarBase>& var,
+    const platform::Place& place, bool trace_backward) {
+  if (!var->Persistable()) {
+    return Cast(tracer, var, framework::proto::VarType::FP16, place,
+                trace_backward);
+  }
+
+  // The copy without the grad op can not be used for the backward.
+  bool with_grad = trace_backward && !var->OverridedStopGradient();
+  auto iter = cache_.find(var->SharedVar().get());
+  if (iter != cache_.end() && iter->second.src.lock() == var->SharedVar() &&
+      iter->second.version == var->InplaceVersion() &&
+      (iter->second.with_grad || !with_grad)) {
+    VLOG(6) << "Reuse the float16 copy of " << var->Name();
+    return iter->second.var;
+  }
+
+  auto out =
+      Cast(tracer, var, framework::proto::VarType::FP16, place, trace_backward);
+  if (cache_.size() >= cache_sweep_size_) {
+    for (auto it = cache_.begin(); it != cache_.end();) {
+      if (it->second.src.expired()) {
+        it = cache_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    cache_sweep_size_ = std::max<size_t>(64, 2 * cache_.size());
+  }
+  cache_[var->SharedVar().get()] = {var->SharedVar(), var->InplaceVersion(),
+                                    with_grad, out};
+  return out;
+}
+
+bool AmpAutoCast::HasFP16Kernel(const std::string& type,
+                                const platform::Place& place) const {
+  auto& all_kernels = framework::OperatorWithKernel::AllOpKernels();
+  auto iter = all_kernels.find(type);
+  if (iter == all_kernels.end()) {
+    return false;
+  }
+  for (auto& pair : iter->second) {
+    if (pair.first.data_type_ == framework::proto::VarType::FP16 &&
+        platform::places_are_same_class(pair.first.place_, place)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace imperative
+}  // namespace paddle
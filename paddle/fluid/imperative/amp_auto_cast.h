@@ -0,0 +1,109 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+
+class Tracer;
+
+/*
+ * Casts the inputs of the traced ops for the automatic mixed precision. The
+ * float32 inputs of the ops on the white list, e.g. conv2d and mul, are cast
+ * to float16 if the op has a float16 kernel for the place, and the float16
+ * inputs of the ops on the black list, e.g. softmax and mean, are cast to
+ * float32. The float16 inputs of the other ops are cast to float32 only if
+ * the op has float32 inputs too. The casts are traced as the cast ops, so
+ * the grads flow back to the float32 variables.
+ *
+ * The float16 copies of the persistable variables, i.e. the parameters, are
+ * cached, and reused by the ops until the parameter is written again, which
+ * is told by its inplace version.
+ */
+class AmpAutoCast {
+  DISABLE_COPY_AND_ASSIGN(AmpAutoCast);
+
+ public:
+  AmpAutoCast();
+
+  void SetOpLists(const std::unordered_set<std::string>& white_list,
+                  const std::unordered_set<std::string>& black_list);
+
+  const std::unordered_set<std::string>& WhiteList() const {
+    return white_list_;
+  }
+
+  const std::unordered_set<std::string>& BlackList() const {
+    return black_list_;
+  }
+
+  // Returns the inputs after cast, or an empty map if none of the inputs
+  // needs casting.
+  NameVarBaseMap CastInputs(Tracer* tracer, const std::string& type,
+                            const NameVarBaseMap& ins,
+                            const platform::Place& place, bool trace_backward);
+
+  // The casted parameters traced for the backward can not be reused after
+  // the backward runs, since their grad ops are released.
+  void ClearCache() { cache_.clear(); }
+
+  size_t CachedVarNum() const { return cache_.size(); }
+
+  // The number of the cast ops traced.
+  size_t CastOpNum() const { return cast_op_num_; }
+
+ private:
+  struct CachedVar {
+    std::weak_ptr<VariableWrapper> src;
+    uint32_t version;
+    bool with_grad;
+    std::shared_ptr<VarBase> var;
+  };
+
+  std::shared_ptr<VarBase> Cast(Tracer* tracer,
+                                const std::shared_ptr<VarBase>& var,
+                                framework::proto::VarType::Type data_type,
+                                const platform::Place& place,
+                                bool trace_backward);
+
+  std::shared_ptr<VarBase> CastWithCache(Tracer* tracer,
+                                         const std::shared_ptr<VarBase>& var,
+                                         const platform::Place& place,
+                                         bool trace_backward);
+
+  // Returns true if the op has a float16 kernel for the place.
+  bool HasFP16Kernel(const std::string& type,
+                     const platform::Place& place) const;
+
+  std::unordered_set<std::string> white_list_;
+  std::unordered_set<std::string> black_list_;
+  std::unordered_map<const VariableWrapper*, CachedVar> cache_;
+  // The expired entries of cache_ are removed when its size reaches this.
+  size_t cache_sweep_size_{64};
+  size_t cast_op_num_{0};
+};
+
+}  // namespace imperative
+}  // namespace paddle
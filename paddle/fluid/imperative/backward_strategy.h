@@ -26,6 +26,9 @@ struct BackwardStrategy {
    * gradient, another is sum gradient once they are created */
   // TODO(jiabin): add more Strategy when we support
   bool sorted_sum_gradient_{false};
+  // The number of the threads running the ready grad ops. The grad ops run
+  // in the calling thread one by one if it is 1.
+  size_t num_threads_{1};
 };
 
 }  // namespace detail
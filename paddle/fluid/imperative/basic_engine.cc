@@ -15,6 +15,8 @@
 #include "paddle/fluid/imperative/basic_engine.h"
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <exception>
 #include <memory>
 #include <queue>
 #include <sstream>
@@ -26,6 +28,7 @@
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/op_base.h"
+#include "paddle/fluid/imperative/recompute.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/profiler.h"
@@ -111,6 +114,10 @@ void BasicEngine::PrepareGradAccumulators(const OpBase& op) {
       }
 
       accumulator->IncreaseRefCnt();
+      accumulator->RegisterTraceId(op.id());
+      if (hook_) {
+        ++pending_grads_[var.get()];
+      }
 
       VLOG(3) << "Prepare to acccumulate variable grad " << var->Name() << "("
               << var.get() << ")  with reference count "
@@ -156,101 +163,222 @@ void BasicEngine::PrepareDeps() {
   }
 }
 
-void BasicEngine::Execute() {
-  if (init_node_ == nullptr) {
-    return;
+void BasicEngine::RunOp(OpBase* cur_op) {
+  // Recompute the forward variables of the segment needed by the grad op
+  auto& segment = cur_op->GetRecomputeSegment();
+  if (segment) {
+    if (is_async_ && !platform::is_cpu_place(cur_op->place())) {
+      std::lock_guard<std::mutex> guard(device_mutex_);
+      segment->Recompute();
+    } else {
+      segment->Recompute();
+    }
   }
 
-  PrepareDeps();
-  // Start execute Computation graph
-  std::queue<std::shared_ptr<GradOpNode>> q;
-  q.push(std::move(init_node_));
+  // CheckBackWardInput
+  if (is_async_) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    CheckBackwardInputs(*cur_op);
+  } else {
+    CheckBackwardInputs(*cur_op);
+  }
 
-  size_t op_num = 0;
+  // Step 1: Run Backward
+  auto& bwd_ins = cur_op->GetInsMap();
+  auto& bwd_outs = cur_op->GetOutsMap();
 
-  while (!q.empty()) {
-    auto shared_cur_node = std::move(q.front());
-    q.pop();
+  NameVarMap<VariableWrapper> tmp_outs(bwd_outs);
+  std::vector<std::pair<GradientAccumulator*, std::shared_ptr<VariableWrapper>>>
+      need_accu_var_list;
+  // 1. construct the output map 2. replace the element in the map
+  // A var may be coresponding to several grad var in one op
+  for (auto& pair : tmp_outs) {
+    if (!pair.second.IsGrad()) {
+      continue;
+    }
 
-    for (auto& cur_op : *shared_cur_node) {
-      ++op_num;
+    for (auto& var : pair.second) {
+      if (!var) {
+        continue;
+      }
 
-      // CheckBackWardInput
-      CheckBackwardInputs(cur_op);
+      auto iter = accumulators_.find(var.get());
+      PADDLE_ENFORCE_EQ(
+          iter != accumulators_.end(), true,
+          platform::errors::NotFound("Cannot find gradient of variable %s",
+                                     var->Name()));
+      if (!var->OverridedStopGradient() && iter->second->RefCnt() == 1) {
+        continue;
+      }
 
-      // Step 1: Run Backward
-      auto& bwd_ins = cur_op.GetInsMap();
-      auto& bwd_outs = cur_op.GetOutsMap();
+      var = std::make_shared<VariableWrapper>("Gtmp@");
+      need_accu_var_list.emplace_back(iter->second.get(), var);
+    }
+  }
 
-      NameVarMap<VariableWrapper> tmp_outs(bwd_outs);
-      // 1. construct the output map 2. replace the element in the map
-      // A var may be coresponding to several grad var in one op
-      for (auto& pair : tmp_outs) {
-        if (!pair.second.IsGrad()) {
-          continue;
-        }
+  {
+    VLOG(3) << "Start to execute grad op " << cur_op->Type();
+    if (is_async_ && !platform::is_cpu_place(cur_op->place())) {
+      std::lock_guard<std::mutex> guard(device_mutex_);
+      OpBase::Run(cur_op->InnerOp(), bwd_ins, tmp_outs, cur_op->Attrs(),
+                  cur_op->place());
+    } else {
+      OpBase::Run(cur_op->InnerOp(), bwd_ins, tmp_outs, cur_op->Attrs(),
+                  cur_op->place());
+    }
+  }
 
-        for (auto& var : pair.second) {
-          if (!var) {
-            continue;
-          }
+  // Step 2: Sum Gradient
+  for (auto& pair : need_accu_var_list) {
+    if (is_async_) {
+      std::lock_guard<std::mutex> guard(pair.first->Mutex());
+      pair.first->Add(std::move(pair.second), cur_op->id());
+    } else {
+      pair.first->Add(std::move(pair.second), cur_op->id());
+    }
+  }
 
-          auto iter = accumulators_.find(var.get());
-          PADDLE_ENFORCE_EQ(
-              iter != accumulators_.end(), true,
-              platform::errors::NotFound("Cannot find gradient of variable %s",
-                                         var->Name()));
-          if (!var->OverridedStopGradient() && iter->second->RefCnt() == 1) {
-            continue;
+  // Step 3: Notify the finished gradients
+  if (hook_) {
+    std::vector<VariableWrapper*> ready_grads;
+    {
+      std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+      if (is_async_) lock.lock();
+      for (auto& pair : bwd_outs) {
+        if (!pair.second.IsGrad()) continue;
+        for (auto& var : pair.second) {
+          if (var && --pending_grads_[var.get()] == 0) {
+            ready_grads.push_back(var.get());
           }
-
-          var = std::make_shared<VariableWrapper>("Gtmp@");
-          need_accu_var_list_.emplace_back(iter->second.get(), var);
         }
       }
+    }
+    for (auto* var : ready_grads) {
+      hook_->OnGradReady(var);
+    }
+  }
 
-      {
-        VLOG(3) << "Start to execute grad op " << cur_op.Type();
-        OpBase::Run(cur_op.InnerOp(), bwd_ins, tmp_outs, cur_op.Attrs(),
-                    cur_op.place());
-      }
-
-      // Step 2: Sum Gradient
-      for (auto& pair : need_accu_var_list_) {
-        pair.first->Add(std::move(pair.second), cur_op.id());
-      }
+  VLOG(3) << "Remove op after op " << cur_op->Type() << " runs";
+  cur_op->ClearBackwardTrace();
+}
 
-      need_accu_var_list_.clear();
+std::vector<std::shared_ptr<GradOpNode>> BasicEngine::CollectReadyNodes(
+    const GradOpNode& node) {
+  std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+  if (is_async_) lock.lock();
+  std::vector<std::shared_ptr<GradOpNode>> ready_nodes;
+  for (auto& grad_pending_node : node.GradPendingNodes()) {
+    PADDLE_ENFORCE_NOT_NULL(grad_pending_node,
+                            platform::errors::NotFound(
+                                "Grad pending node should not be nullptr"));
+    auto iter = node_deps_.find(grad_pending_node.get());
+    if (iter == node_deps_.end()) {
+      continue;
+    }
 
-      VLOG(3) << "Remove op after op " << cur_op.Type() << " runs";
-      cur_op.ClearBackwardTrace();
+    if (--(iter->second) == 0) {
+      ready_nodes.push_back(grad_pending_node);
     }
+  }
+  return ready_nodes;
+}
 
-    // Step 3: Collect ready ops
-    for (auto& grad_pending_node : shared_cur_node->GradPendingNodes()) {
-      PADDLE_ENFORCE_NOT_NULL(grad_pending_node,
-                              platform::errors::NotFound(
-                                  "Grad pending node should not be nullptr"));
-      auto iter = node_deps_.find(grad_pending_node.get());
-      if (iter == node_deps_.end()) {
-        continue;
+void BasicEngine::Execute() {
+  if (init_node_ == nullptr) {
+    hook_.reset();
+    return;
+  }
+
+  PrepareDeps();
+  if (backward_strategy_.num_threads_ > 1) {
+    ExecuteAsync();
+  } else {
+    // Start execute Computation graph
+    std::queue<std::shared_ptr<GradOpNode>> q;
+    q.push(std::move(init_node_));
+
+    size_t op_num = 0;
+
+    while (!q.empty()) {
+      auto shared_cur_node = std::move(q.front());
+      q.pop();
+
+      for (auto& cur_op : *shared_cur_node) {
+        ++op_num;
+        RunOp(&cur_op);
       }
 
-      if (--(iter->second) == 0) {
-        q.push(grad_pending_node);
+      // Collect ready ops
+      for (auto& ready_node : CollectReadyNodes(*shared_cur_node)) {
+        q.push(std::move(ready_node));
       }
     }
+    VLOG(1) << "Backward op number: " << op_num;
+  }
+  if (hook_) {
+    hook_->OnBackwardEnd();
   }
   Clear();
+}
+
+void BasicEngine::ExecuteAsync() {
+  if (!pool_ || pool_size_ != backward_strategy_.num_threads_) {
+    pool_size_ = backward_strategy_.num_threads_;
+    pool_.reset(new ::ThreadPool(pool_size_));
+  }
+  is_async_ = true;
+
+  std::mutex running_mutex;
+  std::condition_variable running_cv;
+  size_t running_num = 0;
+  std::exception_ptr exception;
+
+  std::function<void(std::shared_ptr<GradOpNode>)> schedule;
+  schedule = [&](std::shared_ptr<GradOpNode> node) {
+    {
+      std::lock_guard<std::mutex> guard(running_mutex);
+      ++running_num;
+    }
+    pool_->enqueue([&, node] {
+      try {
+        for (auto& cur_op : *node) {
+          RunOp(&cur_op);
+        }
+        // The pending nodes are scheduled before the node is done, so that
+        // running_num is zero only after the last node.
+        for (auto& ready_node : CollectReadyNodes(*node)) {
+          schedule(std::move(ready_node));
+        }
+      } catch (...) {
+        VLOG(3) << "Stop scheduling the grad ops for the exception";
+        std::lock_guard<std::mutex> guard(running_mutex);
+        if (!exception) exception = std::current_exception();
+      }
+      std::lock_guard<std::mutex> guard(running_mutex);
+      if (--running_num == 0) {
+        running_cv.notify_all();
+      }
+    });
+  };
 
-  VLOG(1) << "Backward op number: " << op_num;
+  schedule(std::move(init_node_));
+  {
+    std::unique_lock<std::mutex> lock(running_mutex);
+    running_cv.wait(lock, [&] { return running_num == 0; });
+  }
+  is_async_ = false;
+  if (exception) {
+    Clear();
+    std::rethrow_exception(exception);
+  }
 }
 
 void BasicEngine::Clear() {
   init_node_.reset();
   node_deps_.clear();
   accumulators_.clear();
-  need_accu_var_list_.clear();
+  pending_grads_.clear();
+  hook_.reset();
 }
 
 }  // namespace imperative
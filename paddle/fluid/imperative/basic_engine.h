@@ -15,9 +15,11 @@
 #pragma once
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
+#include "ThreadPool.h"
 #include "paddle/fluid/imperative/backward_strategy.h"
 #include "paddle/fluid/imperative/engine.h"
 #include "paddle/fluid/imperative/gradient_accumulator.h"
@@ -34,6 +36,11 @@ class BasicEngine : public Engine {
 
   void Execute() override;
 
+  // The hook observes the gradients of the next backward only.
+  void SetGradientHook(std::shared_ptr<GradientHook> hook) {
+    hook_ = std::move(hook);
+  }
+
  private:
   void PrepareDeps();
 
@@ -41,6 +48,16 @@ class BasicEngine : public Engine {
 
   void PrepareGradAccumulators(const OpBase& op);
 
+  void RunOp(OpBase* op);
+
+  // Returns the pending nodes of node which are ready to run.
+  std::vector<std::shared_ptr<GradOpNode>> CollectReadyNodes(
+      const GradOpNode& node);
+
+  // Runs the ready grad nodes by a pool of num_threads_ threads, so that the
+  // independent branches of the backward overlap.
+  void ExecuteAsync();
+
   void Clear();
 
  private:
@@ -49,8 +66,18 @@ class BasicEngine : public Engine {
   std::unordered_map<GradOpNode*, size_t> node_deps_;
   std::unordered_map<VariableWrapper*, std::unique_ptr<GradientAccumulator>>
       accumulators_;
-  std::vector<std::pair<GradientAccumulator*, std::shared_ptr<VariableWrapper>>>
-      need_accu_var_list_;
+  // The grad ops not run yet writing the gradient var, counted only if
+  // hook_ is set.
+  std::unordered_map<VariableWrapper*, size_t> pending_grads_;
+  std::shared_ptr<GradientHook> hook_;
+  bool is_async_{false};
+  std::unique_ptr<::ThreadPool> pool_;
+  size_t pool_size_{0};
+  // Guards the states shared by the grad ops run by different threads.
+  std::mutex mutex_;
+  // The grad ops on the devices run one at a time, since they share the
+  // stream and the handles of the device context.
+  std::mutex device_mutex_;
 };
 
 }  // namespace imperative
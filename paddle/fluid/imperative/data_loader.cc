@@ -20,9 +20,13 @@
 #include <sys/wait.h>
 
 #include <atomic>
+#include <cerrno>
 #include <csignal>
 #include <map>
+#include <string>
+#include <utility>
 
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -149,6 +153,199 @@ void ThrowErrorIfLoadProcessFailed() {
   }
 }
 
+// The message of a batch in the pipe is the number of tensors, followed by
+// the ipc name, size, pool flag, type, dims and lod of each tensor. The
+// number -1 marks the end of the data.
+static constexpr int32_t kEndOfData = -1;
+
+static void WriteFull(int fd, const void *buf, size_t size) {
+  auto *ptr = static_cast<const char *>(buf);
+  while (size > 0) {
+    auto n = write(fd, ptr, size);
+    if (n < 0 && errno == EINTR) continue;
+    PADDLE_ENFORCE_GT(n, 0,
+                      platform::errors::Unavailable(
+                          "DataLoader child process failed to write the "
+                          "pipe: %s.",
+                          strerror(errno)));
+    ptr += n;
+    size -= n;
+  }
+}
+
+// Returns false if the pipe is closed before the first byte is read.
+static bool ReadFull(int fd, void *buf, size_t size) {
+  auto *ptr = static_cast<char *>(buf);
+  size_t total = size;
+  while (size > 0) {
+    auto n = read(fd, ptr, size);
+    if (n < 0 && errno == EINTR) continue;
+    PADDLE_ENFORCE_GE(n, 0,
+                      platform::errors::Unavailable(
+                          "DataLoader failed to read the pipe: %s.",
+                          strerror(errno)));
+    if (n == 0) {
+      PADDLE_ENFORCE_EQ(size, total,
+                        platform::errors::Unavailable(
+                            "The pipe of DataLoader is closed in the middle "
+                            "of a batch."));
+      return false;
+    }
+    ptr += n;
+    size -= n;
+  }
+  return true;
+}
+
+template <typename T>
+static void WriteValue(int fd, T value) {
+  WriteFull(fd, &value, sizeof(T));
+}
+
+template <typename T>
+static T ReadValue(int fd) {
+  T value;
+  PADDLE_ENFORCE_EQ(ReadFull(fd, &value, sizeof(T)), true,
+                    platform::errors::Unavailable(
+                        "The pipe of DataLoader is closed in the middle of a "
+                        "batch."));
+  return value;
+}
+
+template <typename T>
+static void WriteVector(int fd, const std::vector<T> &values) {
+  WriteValue<uint64_t>(fd, values.size());
+  WriteFull(fd, values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+static std::vector<T> ReadVector(int fd) {
+  std::vector<T> values(ReadValue<uint64_t>(fd));
+  if (!values.empty()) {
+    PADDLE_ENFORCE_EQ(ReadFull(fd, &values[0], values.size() * sizeof(T)),
+                      true, platform::errors::Unavailable(
+                                "The pipe of DataLoader is closed in the "
+                                "middle of a batch."));
+  }
+  return values;
+}
+
+void WriteTensorListToPipe(int fd,
+                           const std::vector<framework::LoDTensor> &tensors) {
+  WriteValue<int32_t>(fd, static_cast<int32_t>(tensors.size()));
+  for (auto &t : tensors) {
+    auto *holder = t.Holder().get();
+    std::string ipc_name;
+    bool from_pool = false;
+    auto *pool_writer_allocation =
+        dynamic_cast<memory::allocation::MemoryMapPoolWriterAllocation *>(
+            holder);
+    if (pool_writer_allocation != nullptr) {
+      // the file returns to the pool after the reader releases it
+      pool_writer_allocation->MarkSent();
+      ipc_name = pool_writer_allocation->ipc_name();
+      from_pool = true;
+    } else {
+      auto *mmap_writer_allocation =
+          dynamic_cast<memory::allocation::MemoryMapWriterAllocation *>(
+              holder);
+      PADDLE_ENFORCE_NOT_NULL(
+          mmap_writer_allocation,
+          platform::errors::PreconditionNotMet(
+              "LoDTensor is not in shared memory. Now only LoDTensor on "
+              "shared memory can be sent by DataLoader."));
+      ipc_name = mmap_writer_allocation->ipc_name();
+    }
+    WriteVector(fd, std::vector<char>(ipc_name.begin(), ipc_name.end()));
+    WriteValue<uint64_t>(fd, holder->size());
+    WriteValue<int32_t>(fd, from_pool);
+    WriteValue<int32_t>(fd, static_cast<int32_t>(t.type()));
+    WriteVector(fd, framework::vectorize(t.dims()));
+    WriteValue<uint64_t>(fd, t.lod().size());
+    for (auto &level : t.lod()) {
+      WriteVector(fd, std::vector<size_t>(level.begin(), level.end()));
+    }
+  }
+}
+
+void WriteEndOfDataToPipe(int fd) { WriteValue<int32_t>(fd, kEndOfData); }
+
+// Returns false at the end of the data.
+static bool ReadTensorListFromPipe(int fd,
+                                   std::vector<framework::LoDTensor> *tensors) {
+  int32_t tensor_num;
+  PADDLE_ENFORCE_EQ(ReadFull(fd, &tensor_num, sizeof(tensor_num)), true,
+                    platform::errors::Unavailable(
+                        "DataLoader child process exited before the end of "
+                        "the data."));
+  if (tensor_num == kEndOfData) return false;
+
+  tensors->resize(tensor_num);
+  for (auto &t : *tensors) {
+    auto name = ReadVector<char>(fd);
+    std::string ipc_name(name.begin(), name.end());
+    auto size = ReadValue<uint64_t>(fd);
+    std::shared_ptr<memory::allocation::Allocation> shared_reader_holder;
+    if (ReadValue<int32_t>(fd)) {
+      shared_reader_holder =
+          memory::allocation::RebuildMemoryMapPoolReaderAllocation(ipc_name,
+                                                                   size);
+    } else {
+      shared_reader_holder =
+          memory::allocation::RebuildMemoryMapReaderAllocation(ipc_name, size);
+    }
+    memory::allocation::MemoryMapFdSet::Instance().Insert(ipc_name);
+
+    t.ResetHolderWithType(
+        shared_reader_holder,
+        static_cast<framework::proto::VarType::Type>(ReadValue<int32_t>(fd)));
+    t.Resize(framework::make_ddim(ReadVector<int64_t>(fd)));
+    framework::LoD lod(ReadValue<uint64_t>(fd));
+    for (auto &level : lod) {
+      auto offsets = ReadVector<size_t>(fd);
+      level.assign(offsets.begin(), offsets.end());
+    }
+    t.set_lod(lod);
+  }
+  return true;
+}
+
+PipeBatchReader::PipeBatchReader(
+    int fd,
+    const std::shared_ptr<operators::reader::LoDTensorBlockingQueue> &queue)
+    : fd_(fd), queue_(queue) {
+  thread_ = std::thread([this] { ReadLoop(); });
+}
+
+PipeBatchReader::~PipeBatchReader() {
+  Join();
+  close(fd_);
+}
+
+void PipeBatchReader::Join() {
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void PipeBatchReader::ReadLoop() {
+  try {
+    std::vector<framework::LoDTensor> tensors;
+    while (ReadTensorListFromPipe(fd_, &tensors)) {
+      // the tensors are dropped if the queue has been closed
+      if (!queue_->IsClosed()) {
+        queue_->Push(std::move(tensors));
+      }
+      tensors.clear();
+    }
+    queue_->Close();
+  } catch (std::exception &ex) {
+    queue_->Kill();
+    LOG(ERROR) << "DataLoader reader thread raised an exception: "
+               << ex.what();
+  }
+}
+
 }  // namespace imperative
 }  // namespace paddle
 
@@ -18,6 +18,12 @@
 
 #include <unistd.h>
 #include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/operators/reader/lod_tensor_blocking_queue.h"
 
 namespace paddle {
 namespace imperative {
@@ -27,6 +33,37 @@ extern void EraseLoadProcessPID(int64_t key);
 extern void SetLoadProcessSignalHandler();
 extern void ThrowErrorIfLoadProcessFailed();
 
+// Writes the shared memory files of a batch to the pipe of the DataLoader
+// in the child process, the tensors are made by _convert_to_tensor_list.
+extern void WriteTensorListToPipe(
+    int fd, const std::vector<framework::LoDTensor> &tensors);
+extern void WriteEndOfDataToPipe(int fd);
+
+/*
+ * Reads the batches written by the child process of the DataLoader from
+ * the pipe, rebuilds the tensors on the shared memory files and pushes them
+ * into the blocking queue in a C++ thread, so the batches are moved without
+ * the GIL. After the queue is closed, the left batches are read and dropped
+ * until the end of the data, so that their files are released.
+ */
+class PipeBatchReader {
+ public:
+  PipeBatchReader(
+      int fd,
+      const std::shared_ptr<operators::reader::LoDTensorBlockingQueue> &queue);
+
+  ~PipeBatchReader();
+
+  void Join();
+
+ private:
+  void ReadLoop();
+
+  int fd_;
+  std::shared_ptr<operators::reader::LoDTensorBlockingQueue> queue_;
+  std::thread thread_;
+};
+
 }  // namespace imperative
 }  // namespace paddle
 
@@ -0,0 +1,326 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/elementwise_fusion.h"
+#include <sstream>
+#include <utility>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
+#include "paddle/fluid/framework/ir/fusion_group/operation.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/op_base.h"
+#include "paddle/fluid/platform/device_code.h"
+
+namespace paddle {
+namespace imperative {
+
+namespace fusion_group = framework::ir::fusion_group;
+
+ElementwiseFusion::ElementwiseFusion() {
+  fusion_group::OperationMap::Init();
+  if (framework::OpInfoMap::Instance().Has("fusion_group")) {
+    fusion_group_op_ =
+        framework::OpRegistry::CreateOp("fusion_group", {}, {}, {}, false);
+  }
+}
+
+ElementwiseFusion::~ElementwiseFusion() = default;
+
+static std::shared_ptr<VarBase> GetSingleVar(const NameVarBaseMap& vars,
+                                             const std::string& name) {
+  auto iter = vars.find(name);
+  if (iter == vars.end() || iter->second.size() != 1U) {
+    return nullptr;
+  }
+  return iter->second[0];
+}
+
+bool ElementwiseFusion::Defer(const std::string& type,
+                              const NameVarBaseMap& ins,
+                              const NameVarBaseMap& outs,
+                              const framework::AttributeMap& attrs,
+                              const platform::Place& place) {
+  if (!fusion_group_op_ || !fusion_group::OperationMap::Instance().Has(type)) {
+    return false;
+  }
+  // cast changes the data type, and sum has a variable number of inputs.
+  auto& operation = fusion_group::OperationMap::Instance().Get(type);
+  if (operation.type != 0 || operation.IsGradOp() || type == "cast" ||
+      operation.num_operands < 1 ||
+      ins.size() != operation.input_names.size() || outs.size() != 1U) {
+    return false;
+  }
+  if (!platform::is_cpu_place(place) && !platform::is_gpu_place(place)) {
+    return false;
+  }
+
+  // The outputs are new variables, so that the inputs of the deferred ops
+  // are not changed.
+  auto out = GetSingleVar(outs, operation.output_names[0]);
+  if (!out || FindVar(out) >= 0) {
+    return false;
+  }
+  std::vector<std::shared_ptr<VarBase>> inputs;
+  for (auto& name : operation.input_names) {
+    auto var = GetSingleVar(ins, name);
+    if (!var || var == out) {
+      return false;
+    }
+    inputs.emplace_back(var);
+  }
+
+  if (ops_.empty()) {
+    // The X of the first op decides the dims of the chain.
+    const auto& x = inputs[0]->Var();
+    if (!x.IsType<framework::LoDTensor>() ||
+        !x.Get<framework::LoDTensor>().IsInitialized()) {
+      return false;
+    }
+    const auto& tensor = x.Get<framework::LoDTensor>();
+    if (tensor.type() != framework::proto::VarType::FP32 &&
+        tensor.type() != framework::proto::VarType::FP64) {
+      return false;
+    }
+    place_ = place;
+    dims_ = tensor.dims();
+    dtype_ = tensor.type();
+  } else if (!platform::is_same_place(place, place_)) {
+    return false;
+  }
+
+  auto axis_iter = attrs.find("axis");
+  int axis = axis_iter == attrs.end() ? -1 : boost::get<int>(axis_iter->second);
+  std::vector<int64_t> broadcast_sizes(inputs.size(), 0);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!CheckInput(inputs[i], i == 1U, axis, &broadcast_sizes[i])) {
+      return false;
+    }
+  }
+
+  DeferredOp op;
+  op.type = type;
+  op.attrs = attrs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    int id = FindVar(inputs[i]);
+    if (id < 0) {
+      id = AddVar(inputs[i], false);
+    }
+    if (broadcast_sizes[i] > 0) {
+      broadcast_sizes_[id] = broadcast_sizes[i];
+    }
+    op.input_ids.emplace_back(id);
+  }
+  op.output_id = AddVar(out, true);
+  ops_.emplace_back(std::move(op));
+
+  // The dims and the data type are known before the op runs.
+  out->MutableVar()->GetMutable<framework::LoDTensor>()->Resize(dims_);
+  out->SetDataType(dtype_);
+  VLOG(5) << "Defer op " << type << ", " << ops_.size()
+          << " elementwise ops are deferred";
+  return true;
+}
+
+bool ElementwiseFusion::CheckInput(const std::shared_ptr<VarBase>& var,
+                                   bool is_y, int axis,
+                                   int64_t* broadcast_size) const {
+  int id = FindVar(var);
+  if (id >= 0 && is_output_[id]) {
+    return true;
+  }
+  if (!var->Var().IsType<framework::LoDTensor>()) {
+    return false;
+  }
+  const auto& tensor = var->Var().Get<framework::LoDTensor>();
+  if (!tensor.IsInitialized() || !tensor.lod().empty() ||
+      tensor.type() != dtype_ ||
+      !platform::is_same_place(tensor.place(), place_)) {
+    return false;
+  }
+  if (tensor.dims() == dims_) {
+    return true;
+  }
+  int offset = dims_.size() - tensor.dims().size();
+  if (!is_y || offset <= 0 || (axis != -1 && axis != offset) ||
+      framework::slice_ddim(dims_, offset, dims_.size()) != tensor.dims()) {
+    return false;
+  }
+  *broadcast_size = tensor.numel();
+  return true;
+}
+
+int ElementwiseFusion::FindVar(const std::shared_ptr<VarBase>& var) const {
+  auto iter = var_ids_.find(var->SharedVar().get());
+  return iter == var_ids_.end() ? -1 : iter->second;
+}
+
+int ElementwiseFusion::AddVar(const std::shared_ptr<VarBase>& var,
+                              bool is_output) {
+  int id = static_cast<int>(vars_.size());
+  vars_.emplace_back(var->SharedVar());
+  var_bases_.emplace_back(var);
+  is_output_.emplace_back(is_output);
+  var_ids_[var->SharedVar().get()] = id;
+  return id;
+}
+
+void ElementwiseFusion::Flush() {
+  if (ops_.empty()) {
+    return;
+  }
+
+  // The outputs held by neither a VarBase nor a grad op are intermediate.
+  std::vector<int> output_ids;
+  std::unordered_set<int> intermediate_ids;
+  for (size_t id = 0; id < vars_.size(); ++id) {
+    if (!is_output_[id]) continue;
+    if (var_bases_[id].expired() && vars_[id].use_count() == 1) {
+      intermediate_ids.insert(id);
+    } else {
+      output_ids.emplace_back(id);
+    }
+  }
+  if (output_ids.empty()) {
+    VLOG(3) << "Drop " << ops_.size()
+            << " deferred elementwise ops, whose outputs are not referenced";
+    Clear();
+    return;
+  }
+
+  std::string func_name =
+      ops_.size() > 1U ? GetFusedKernel(intermediate_ids) : "";
+  if (func_name.empty()) {
+    RunEach();
+    Clear();
+    return;
+  }
+
+  VLOG(3) << "Run " << ops_.size() << " deferred elementwise ops by "
+          << func_name;
+  NameVarMap<VariableWrapper> ins, outs;
+  auto& inputs = ins["Inputs"];
+  for (size_t id = 0; id < vars_.size(); ++id) {
+    if (!is_output_[id]) {
+      inputs.emplace_back(vars_[id]);
+    }
+  }
+  auto& outputs = outs["Outs"];
+  for (auto id : output_ids) {
+    outputs.emplace_back(vars_[id]);
+  }
+  std::string dtype = framework::DataTypeToString(dtype_);
+  framework::AttributeMap attrs;
+  attrs["type"] = 0;
+  attrs["func_name"] = func_name;
+  attrs["inputs_data_type"] = std::vector<std::string>(inputs.size(), dtype);
+  attrs["outs_data_type"] = std::vector<std::string>(outputs.size(), dtype);
+  OpBase::Run(*fusion_group_op_, ins, outs, attrs, place_);
+  Clear();
+}
+
+std::string ElementwiseFusion::GetFusedKernel(
+    const std::unordered_set<int>& intermediate_ids) {
+  // The chains with the same ops, data type, broadcast inputs and
+  // intermediate outputs share the kernel.
+  std::ostringstream key;
+  key << place_ << "," << framework::DataTypeToString(dtype_);
+  for (auto& op : ops_) {
+    key << ";" << op.type << "(";
+    for (auto id : op.input_ids) {
+      auto iter = broadcast_sizes_.find(id);
+      key << id;
+      if (iter != broadcast_sizes_.end()) {
+        key << "%" << iter->second;
+      }
+      key << ",";
+    }
+    key << ")" << op.output_id;
+    if (intermediate_ids.count(op.output_id)) {
+      key << "*";
+    }
+  }
+  auto iter = kernels_.find(key.str());
+  if (iter != kernels_.end()) {
+    return iter->second;
+  }
+
+  std::string dtype = framework::DataTypeToString(dtype_);
+  std::vector<fusion_group::OperationExpression> expressions;
+  for (auto& op : ops_) {
+    expressions.emplace_back(op.type, op.input_ids,
+                             std::vector<int>({op.output_id}), dtype, dtype);
+  }
+  auto& pool = platform::DeviceCodePool::Init({place_});
+  std::string func_name =
+      "DygraphFusedElementwise" + std::to_string(pool.size(place_));
+  bool use_gpu = platform::is_gpu_place(place_);
+  fusion_group::CodeGenerator code_generator(use_gpu);
+  std::string code_str = code_generator.Generate(
+      func_name, expressions, broadcast_sizes_, intermediate_ids);
+  VLOG(3) << code_str;
+
+  std::unique_ptr<platform::DeviceCode> device_code;
+  if (use_gpu) {
+#ifdef PADDLE_WITH_CUDA
+    device_code.reset(
+        new platform::CUDADeviceCode(place_, func_name, code_str));
+#endif
+  } else {
+    device_code.reset(new platform::CPUDeviceCode(place_, func_name, code_str));
+  }
+  if (device_code && device_code->Compile()) {
+    pool.Set(std::move(device_code));
+  } else {
+    LOG(WARNING) << "Failed to compile the fused kernel of " << ops_.size()
+                 << " elementwise ops, they are run one by one.";
+    func_name.clear();
+  }
+  kernels_[key.str()] = func_name;
+  return func_name;
+}
+
+void ElementwiseFusion::RunEach() const {
+  for (auto& op : ops_) {
+    auto& operation = fusion_group::OperationMap::Instance().Get(op.type);
+    NameVarMap<VariableWrapper> ins, outs;
+    for (size_t i = 0; i < op.input_ids.size(); ++i) {
+      ins[operation.input_names[i]].emplace_back(vars_[op.input_ids[i]]);
+    }
+    outs[operation.output_names[0]].emplace_back(vars_[op.output_id]);
+    auto op_base = framework::OpRegistry::CreateOp(op.type, {}, {}, {}, false);
+    OpBase::Run(*op_base, ins, outs, op.attrs, place_);
+  }
+}
+
+size_t ElementwiseFusion::CompiledKernelNum() const {
+  size_t num = 0;
+  for (auto& pair : kernels_) {
+    num += pair.second.empty() ? 0 : 1;
+  }
+  return num;
+}
+
+void ElementwiseFusion::Clear() {
+  ops_.clear();
+  vars_.clear();
+  var_bases_.clear();
+  is_output_.clear();
+  var_ids_.clear();
+  broadcast_sizes_.clear();
+}
+
+}  // namespace imperative
+}  // namespace paddle
@@ -0,0 +1,114 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/type_defs.h"
+#include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+class OperatorBase;
+}  // namespace framework
+}  // namespace paddle
+
+namespace paddle {
+namespace imperative {
+
+/*
+ * Defers the elementwise ops traced in dygraph, e.g. the ones of
+ * relu(x * w + b), and runs the chain of them by one kernel generated by the
+ * code generator of fusion_group when it is flushed. The outputs of the
+ * deferred ops get their dims and data types at once, and the intermediate
+ * outputs not referenced any more, neither by a VarBase nor by a grad op, are
+ * never written. The kernels are compiled once for each structure of the
+ * chain and cached in DeviceCodePool.
+ */
+class ElementwiseFusion {
+  DISABLE_COPY_AND_ASSIGN(ElementwiseFusion);
+
+ public:
+  ElementwiseFusion();
+
+  ~ElementwiseFusion();
+
+  // Returns false if the op is not deferred, e.g. it is not an elementwise op
+  // supported by fusion_group, or its inputs do not have the same dims as the
+  // chain, except the Y broadcast along the trailing dims. The deferred ops
+  // should be flushed before running the op then.
+  bool Defer(const std::string& type, const NameVarBaseMap& ins,
+             const NameVarBaseMap& outs, const framework::AttributeMap& attrs,
+             const platform::Place& place);
+
+  // Runs the deferred ops.
+  void Flush();
+
+  size_t DeferredOpNum() const { return ops_.size(); }
+
+  // The number of the fused kernels compiled.
+  size_t CompiledKernelNum() const;
+
+ private:
+  struct DeferredOp {
+    std::string type;
+    framework::AttributeMap attrs;
+    std::vector<int> input_ids;
+    int output_id;
+  };
+
+  // Returns -1 if the var is not in the chain.
+  int FindVar(const std::shared_ptr<VarBase>& var) const;
+
+  int AddVar(const std::shared_ptr<VarBase>& var, bool is_output);
+
+  // Only the Y of the binary ops can be broadcast to the dims of the chain,
+  // and broadcast_size is set to the number of its elements then.
+  bool CheckInput(const std::shared_ptr<VarBase>& var, bool is_y, int axis,
+                  int64_t* broadcast_size) const;
+
+  // Returns the name of the fused kernel, or an empty string if the kernel
+  // fails to be compiled.
+  std::string GetFusedKernel(const std::unordered_set<int>& intermediate_ids);
+
+  void RunEach() const;
+
+  void Clear();
+
+  std::vector<DeferredOp> ops_;
+  std::vector<std::shared_ptr<VariableWrapper>> vars_;
+  std::vector<std::weak_ptr<VarBase>> var_bases_;
+  std::vector<bool> is_output_;
+  std::unordered_map<const VariableWrapper*, int> var_ids_;
+  std::unordered_map<int, int64_t> broadcast_sizes_;
+  platform::Place place_;
+  framework::DDim dims_;
+  framework::proto::VarType::Type dtype_;
+
+  // The fused kernel of each structure of the chain, whose name is empty if
+  // the kernel fails to be compiled.
+  std::unordered_map<std::string, std::string> kernels_;
+  std::unique_ptr<framework::OperatorBase> fusion_group_op_;
+};
+
+}  // namespace imperative
+}  // namespace paddle
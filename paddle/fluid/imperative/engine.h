@@ -19,6 +19,22 @@
 namespace paddle {
 namespace imperative {
 
+class VariableWrapper;
+
+// Observes the gradients finished by the backward, e.g. to all-reduce the
+// gradients of the parameters while the backward of the other layers runs.
+class GradientHook {
+ public:
+  virtual ~GradientHook() = default;
+
+  // The gradient var is not changed by the backward any more. It may be
+  // called by the threads of the engine concurrently.
+  virtual void OnGradReady(VariableWrapper* var) = 0;
+
+  // All the grad ops of the backward have run.
+  virtual void OnBackwardEnd() = 0;
+};
+
 class Engine {
   DISABLE_COPY_AND_ASSIGN(Engine);
 
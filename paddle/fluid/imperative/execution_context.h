@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/operator.h"
@@ -24,6 +25,20 @@
 namespace paddle {
 namespace imperative {
 
+// The names of the attributes read through the execution context, which are
+// recorded by the cache of the kernels chosen by GetExpectedKernelType.
+struct ReadAttrs {
+  std::vector<std::string> names;
+  // Attrs() is called, so that any of the attributes may be read.
+  bool all{false};
+
+  void Add(const std::string& name) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+      names.push_back(name);
+    }
+  }
+};
+
 template <typename VarType>
 class DygraphExecutionContext : public framework::ExecutionContext {
   using Variable = framework::Variable;
@@ -92,13 +107,20 @@ class DygraphExecutionContext : public framework::ExecutionContext {
     return vec_res;
   }
 
+  void SetReadAttrs(ReadAttrs* read_attrs) { read_attrs_ = read_attrs; }
+
   bool HasAttr(const std::string& name) const override {
+    if (read_attrs_) read_attrs_->Add(name);
     return attrs_.count(name) != 0;
   }
 
-  const framework::AttributeMap& Attrs() const override { return attrs_; }
+  const framework::AttributeMap& Attrs() const override {
+    if (read_attrs_) read_attrs_->all = true;
+    return attrs_;
+  }
 
   const framework::Attribute& GetAttr(const std::string& name) const override {
+    if (read_attrs_) read_attrs_->Add(name);
     auto it = attrs_.find(name);
 
     PADDLE_ENFORCE_NE(
@@ -193,6 +215,7 @@ class DygraphExecutionContext : public framework::ExecutionContext {
   const NameVarMap<VarType>& var_base_map_in_;
   const NameVarMap<VarType>& var_base_map_out_;
   const framework::AttributeMap& attrs_;
+  ReadAttrs* read_attrs_{nullptr};
 };
 
 }  // namespace imperative
@@ -19,6 +19,12 @@ DEFINE_uint64(dygraph_debug, 0,
               "Debug level of dygraph. This flag is not "
               "open to users");
 
+DEFINE_bool(dygraph_cache_prepared_op, true,
+            "Whether the tracer of dygraph caches the ops and the kernels "
+            "chosen for them, so that the traced ops of the same type, "
+            "input types and attributes skip the creation of the op and "
+            "the lookup of the kernel.");
+
 namespace paddle {
 namespace imperative {
 
@@ -26,5 +32,7 @@ bool IsDebugEnabled() { return FLAGS_dygraph_debug != 0; }
 
 uint64_t GetDebugLevel() { return FLAGS_dygraph_debug; }
 
+bool IsPreparedOpCacheEnabled() { return FLAGS_dygraph_cache_prepared_op; }
+
 }  // namespace imperative
 }  // namespace paddle
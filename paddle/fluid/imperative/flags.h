@@ -21,6 +21,7 @@ namespace imperative {
 
 extern bool IsDebugEnabled();
 extern uint64_t GetDebugLevel();
+extern bool IsPreparedOpCacheEnabled();
 
 }  // namespace imperative
 }  // namespace paddle
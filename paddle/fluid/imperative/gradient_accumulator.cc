@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <utility>
 #include "paddle/fluid/framework/framework.pb.h"
@@ -24,6 +25,7 @@
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/float16.h"
 #include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
@@ -81,7 +83,7 @@ class TensorAddFunctor : public boost::static_visitor<> {
         dynamic_cast<platform::CUDADeviceContext*>(
             platform::DeviceContextPool::Instance().Get(place));
     auto blas = operators::math::GetBlas<platform::CUDADeviceContext, T>(*ctx);
-    blas.AXPY(numel_, 1., x_, y_);
+    blas.AXPY(numel_, static_cast<T>(1), x_, y_);
   }
 #else
   void operator()(const platform::CUDAPlace& place) {
@@ -100,6 +102,16 @@ class TensorAddFunctor : public boost::static_visitor<> {
   T* y_;
 };
 
+// There is no float16 AXPY of CPU blas, e.g. for the grads of the float16
+// variables of the automatic mixed precision.
+template <>
+void TensorAddFunctor<platform::float16>::operator()(
+    const platform::CPUPlace& place) {
+  for (int64_t i = 0; i < numel_; ++i) {
+    y_[i] += x_[i];
+  }
+}
+
 void TensorAdd(const framework::Variable& src, framework::Variable* dst) {
   auto* dst_tensor = dst->GetMutable<framework::LoDTensor>();
   auto& src_tensor = src.Get<framework::LoDTensor>();
@@ -130,6 +142,7 @@ void TensorAdd(const framework::Variable& src, framework::Variable* dst) {
 
   PADDLE_TENSOR_ADD(float);
   PADDLE_TENSOR_ADD(double);
+  PADDLE_TENSOR_ADD(platform::float16);
 
 #undef PADDLE_TENSOR_ADD
 
@@ -370,6 +383,8 @@ void SortedGradientAccumulator::Add(std::shared_ptr<VariableWrapper> var,
     if (ref_cnt_ == 1) {
       MoveOrCopyVar(dst_var, var->MutableVar(),
                     unchange_input || var->HasGradNode());
+    } else if (trace_ids_.size() == ref_cnt_) {
+      StreamingAdd(std::move(var), trace_id, unchange_input);
     } else {
       if (tmp_grad_vars_.empty()) {
         tmp_grad_vars_.reserve(ref_cnt_);
@@ -474,5 +489,65 @@ void SortedGradientAccumulator::Add(std::shared_ptr<VariableWrapper> var,
   }
 }
 
+void SortedGradientAccumulator::StreamingAdd(
+    std::shared_ptr<VariableWrapper> var, size_t trace_id,
+    bool unchange_input) {
+  if (sorted_grad_vars_.empty()) {
+    std::sort(trace_ids_.begin(), trace_ids_.end(), std::greater<size_t>());
+    sorted_grad_vars_.reserve(trace_ids_.size());
+    for (auto id : trace_ids_) {
+      sorted_grad_vars_.emplace_back(nullptr, id, false);
+    }
+    next_grad_ = 0;
+  }
+
+  // A grad op may generate several gradients of the variable, which share
+  // the trace id and are summed in the order they arrive.
+  auto iter = std::lower_bound(trace_ids_.begin(), trace_ids_.end(), trace_id,
+                               std::greater<size_t>());
+  size_t idx = std::max<size_t>(iter - trace_ids_.begin(), next_grad_);
+  while (idx < trace_ids_.size() && trace_ids_[idx] == trace_id &&
+         sorted_grad_vars_[idx].var) {
+    ++idx;
+  }
+  PADDLE_ENFORCE_EQ(
+      idx < trace_ids_.size() && trace_ids_[idx] == trace_id, true,
+      platform::errors::InvalidArgument(
+          "The gradient of %s generated by the grad op of trace id %d is not "
+          "registered to accumulate.",
+          var_->Name(), trace_id));
+
+  auto& info = sorted_grad_vars_[idx];
+  info.unchange_input = unchange_input || var->HasGradNode();
+  info.var = std::move(var);
+
+  auto* dst_var = var_->MutableVar();
+  while (next_grad_ < sorted_grad_vars_.size() &&
+         sorted_grad_vars_[next_grad_].var) {
+    auto& var_info = sorted_grad_vars_[next_grad_];
+    if (next_grad_ == 0) {
+      MoveOrCopyVar(dst_var, var_info.var->MutableVar(),
+                    var_info.unchange_input);
+    } else {
+      VariableWrapperAdd(var_info.var, var_, var_info.unchange_input);
+    }
+    var_info.var = nullptr;
+    ++next_grad_;
+  }
+
+  if (next_grad_ == sorted_grad_vars_.size()) {
+    sorted_grad_vars_.clear();
+    next_grad_ = 0;
+  }
+}
+
+size_t SortedGradientAccumulator::HeldVarNum() const {
+  size_t num = tmp_grad_vars_.size();
+  for (auto& var_info : sorted_grad_vars_) {
+    if (var_info.var) ++num;
+  }
+  return num;
+}
+
 }  // namespace imperative
 }  // namespace paddle
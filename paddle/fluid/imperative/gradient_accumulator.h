@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <utility>
 #include <vector>
 #include "paddle/fluid/imperative/layer.h"
@@ -35,9 +36,18 @@ class GradientAccumulator {
 
   inline size_t RefCnt() const { return ref_cnt_; }
 
+  // Tells the trace id of the grad op generating one of the gradients to
+  // accumulate before running the backward, which only makes sense to the
+  // accumulators summing the gradients in the order of the trace ids.
+  virtual void RegisterTraceId(size_t trace_id) {}
+
+  // Serializes Add of the grad ops run by different threads.
+  std::mutex& Mutex() { return mutex_; }
+
  protected:
   VariableWrapper* var_;
   size_t ref_cnt_{0};
+  std::mutex mutex_;
 };
 
 class EagerGradientAccumulator : public GradientAccumulator {
@@ -58,7 +68,21 @@ class SortedGradientAccumulator : public GradientAccumulator {
   void Add(std::shared_ptr<VariableWrapper> var, size_t trace_id,
            bool unchange_input) override;
 
+  // If the trace ids of all the gradients are registered, the gradients are
+  // summed in the sorted order as soon as the ones before them arrive, and
+  // released once summed. Otherwise all the gradients are held until the
+  // last one arrives.
+  void RegisterTraceId(size_t trace_id) override {
+    trace_ids_.push_back(trace_id);
+  }
+
+  // The number of the gradients arrived but not summed yet.
+  size_t HeldVarNum() const;
+
  private:
+  void StreamingAdd(std::shared_ptr<VariableWrapper> var, size_t trace_id,
+                    bool unchange_input);
+
   struct SavedVarInfo {
     SavedVarInfo(std::shared_ptr<VariableWrapper>&& v, size_t id,
                  bool enable_unchange_input)
@@ -72,6 +96,13 @@ class SortedGradientAccumulator : public GradientAccumulator {
   };
 
   std::vector<SavedVarInfo> tmp_grad_vars_;
+
+  std::vector<size_t> trace_ids_;
+  // The gradients in the sorted order of the trace ids, whose var is nullptr
+  // if not arrived or summed.
+  std::vector<SavedVarInfo> sorted_grad_vars_;
+  // The index of the next gradient to sum in sorted_grad_vars_.
+  size_t next_grad_{0};
 };
 
 }  // namespace imperative
@@ -321,7 +321,8 @@ static void OpBaseRunImpl(const framework::OperatorBase& op,
                           const NameVarMap<VarType>& ins,
                           const NameVarMap<VarType>& outs,
                           const framework::AttributeMap& attrs,
-                          const platform::Place& place) {
+                          const platform::Place& place,
+                          PreparedOpCache* cache) {
   auto* op_kernel = dynamic_cast<const framework::OperatorWithKernel*>(&op);
   PADDLE_ENFORCE_NOT_NULL(op_kernel, "only support op with kernel");
   auto& info = op.Info();
@@ -341,7 +342,9 @@ static void OpBaseRunImpl(const framework::OperatorBase& op,
 
   // VLOG(3) << "Running Op " << op.Type();
   VLOG(5) << LayerDebugString(op.Type(), ins, outs);
-  auto prepared_op = PreparedOp::Prepare(ins, outs, *op_kernel, place, attrs);
+  auto prepared_op =
+      cache ? cache->Prepare(ins, outs, place, attrs)
+            : PreparedOp::Prepare(ins, outs, *op_kernel, place, attrs);
 
   prepared_op.Run(ins, outs, attrs);
 
@@ -352,16 +355,16 @@ void OpBase::Run(const framework::OperatorBase& op,
                  const NameVarMap<VarBase>& ins,
                  const NameVarMap<VarBase>& outs,
                  const framework::AttributeMap& attrs,
-                 const platform::Place& place) {
-  OpBaseRunImpl<VarBase>(op, ins, outs, attrs, place);
+                 const platform::Place& place, PreparedOpCache* cache) {
+  OpBaseRunImpl<VarBase>(op, ins, outs, attrs, place, cache);
 }
 
 void OpBase::Run(const framework::OperatorBase& op,
                  const NameVarMap<VariableWrapper>& ins,
                  const NameVarMap<VariableWrapper>& outs,
                  const framework::AttributeMap& attrs,
-                 const platform::Place& place) {
-  OpBaseRunImpl<VariableWrapper>(op, ins, outs, attrs, place);
+                 const platform::Place& place, PreparedOpCache* cache) {
+  OpBaseRunImpl<VariableWrapper>(op, ins, outs, attrs, place, cache);
 }
 
 static void ClearNoNeedBufferInputs(OpBase* op) {
@@ -150,6 +150,10 @@ class VarBase {
 
   bool Persistable() const { return var_->Persistable(); }
 
+  uint32_t InplaceVersion() const { return var_->InplaceVersion(); }
+
+  void BumpInplaceVersion() { var_->BumpInplaceVersion(); }
+
   // Only grad var is allowed to call these 2 methods
   void SetGradNode(const std::shared_ptr<GradOpNode>& node) {
     grad_node_ = node;
@@ -27,6 +27,9 @@
 namespace paddle {
 namespace imperative {
 
+class PreparedOpCache;
+class RecomputeSegment;
+
 // TODO(zjl): to support py_func layer
 class OpBase {
  public:
@@ -119,6 +122,16 @@ class OpBase {
 
   void SetPlace(const platform::Place& place) { place_ = place; }
 
+  // The segment whose forward ops should be recomputed before running the
+  // grad op.
+  const std::shared_ptr<RecomputeSegment>& GetRecomputeSegment() const {
+    return recompute_segment_;
+  }
+
+  void SetRecomputeSegment(std::shared_ptr<RecomputeSegment> segment) {
+    recompute_segment_ = std::move(segment);
+  }
+
   void EnforceHasInOut() const {
     PADDLE_ENFORCE_NE(
         ins_.empty() && outs_.empty(), true,
@@ -138,17 +151,21 @@ class OpBase {
     return unique_id.fetch_add(1);
   }
 
+  // The kernel is chosen by cache if it is not nullptr, which is created for
+  // op.
   static void Run(const framework::OperatorBase& op,
                   const NameVarMap<VarBase>& ins,
                   const NameVarMap<VarBase>& outs,
                   const framework::AttributeMap& attrs,
-                  const platform::Place& place);
+                  const platform::Place& place,
+                  PreparedOpCache* cache = nullptr);
 
   static void Run(const framework::OperatorBase& op,
                   const NameVarMap<VariableWrapper>& ins,
                   const NameVarMap<VariableWrapper>& outs,
                   const framework::AttributeMap& attrs,
-                  const platform::Place& place);
+                  const platform::Place& place,
+                  PreparedOpCache* cache = nullptr);
 
  private:
   NameVarMap<VariableWrapper> ins_;
@@ -157,6 +174,7 @@ class OpBase {
   std::unique_ptr<framework::OperatorBase> op_;
   platform::Place place_;
   size_t id_{-1UL};
+  std::shared_ptr<RecomputeSegment> recompute_segment_;
 
   std::vector<std::function<void()>> backward_hooks_;
 };
@@ -27,6 +27,7 @@
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/op_base.h"
+#include "paddle/fluid/imperative/recompute.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -864,6 +865,11 @@ void PartialGradTask::RunEachOp(OpBase *op) {
     }
   }
 
+  // Recompute the forward variables of the segment needed by the grad op
+  if (op->GetRecomputeSegment()) {
+    op->GetRecomputeSegment()->Recompute();
+  }
+
   // Run op
   OpBase::Run(op->InnerOp(), tmp_ins, tmp_outs, op->Attrs(), op->place());
 
@@ -88,15 +88,10 @@ PreparedOp::PreparedOp(const framework::OperatorBase& op,
       dev_ctx_(dev_ctx),
       kernel_configs_(kernel_configs) {}
 
-template <typename VarType>
-PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
-                         const NameVarMap<VarType>& outs,
-                         const framework::OperatorWithKernel& op,
-                         platform::Place place,
-                         const framework::AttributeMap& attrs) {
-  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
-  auto* dev_ctx = pool.Get(place);
-
+// Returns the kernel of the expected kernel type registered in the op.
+static const framework::OperatorWithKernel::OpKernelFunc& GetKernelFunc(
+    const framework::OperatorWithKernel& op,
+    const framework::OpKernelType& expected_kernel_key) {
   // check if op[type] has kernel registered.
   auto& all_op_kernels = op.AllOpKernels();
   auto kernels_iter = all_op_kernels.find(op.Type());
@@ -107,6 +102,23 @@ PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
   }
 
   auto& kernels = kernels_iter->second;
+  auto kernel_iter = kernels.find(expected_kernel_key);
+  // TODO(jiabin): Add operator.cc's line 1000 part back when we need that case
+  if (kernel_iter == kernels.end()) {
+    PADDLE_THROW("op %s does not have kernel for %s", op.Type(),
+                 KernelTypeToString(expected_kernel_key));
+  }
+  return kernel_iter->second;
+}
+
+template <typename VarType>
+PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
+                         const NameVarMap<VarType>& outs,
+                         const framework::OperatorWithKernel& op,
+                         platform::Place place,
+                         const framework::AttributeMap& attrs) {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto* dev_ctx = pool.Get(place);
 
   framework::RuntimeContext ctx({}, {});
   auto expected_kernel_key =
@@ -114,12 +126,7 @@ PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
           op, framework::Scope(), *dev_ctx, ctx, nullptr, ins, outs, attrs));
   VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
 
-  auto kernel_iter = kernels.find(expected_kernel_key);
-  // TODO(jiabin): Add operator.cc's line 1000 part back when we need that case
-  if (kernel_iter == kernels.end()) {
-    PADDLE_THROW("op %s does not have kernel for %s", op.Type(),
-                 KernelTypeToString(expected_kernel_key));
-  }
+  auto& func = GetKernelFunc(op, expected_kernel_key);
   std::vector<framework::KernelConfig>* kernel_configs =
       op.GetKernelConfig(expected_kernel_key);
 
@@ -129,7 +136,7 @@ PreparedOp PrepareOpImpl(const NameVarMap<VarType>& ins,
   }
 
   PrepareDataImpl<VarType>(place, ins, op, expected_kernel_key);
-  return PreparedOp(op, ctx, kernel_iter->second, dev_ctx, kernel_configs);
+  return PreparedOp(op, ctx, func, dev_ctx, kernel_configs);
 }
 
 PreparedOp PreparedOp::Prepare(const NameVarMap<VarBase>& ins,
@@ -148,6 +155,151 @@ PreparedOp PreparedOp::Prepare(const NameVarMap<VariableWrapper>& ins,
   return PrepareOpImpl<VariableWrapper>(ins, outs, op, place, attrs);
 }
 
+bool PreparedOpCache::VarSignature::operator==(
+    const VarSignature& other) const {
+  if (type != other.type || data_type != other.data_type ||
+      initialized != other.initialized) {
+    return false;
+  }
+  return !initialized ||
+         (platform::is_same_place(place, other.place) &&
+          layout == other.layout);
+}
+
+template <typename VarType>
+PreparedOpCache::VarSignature PreparedOpCache::GetSignature(
+    const std::shared_ptr<VarType>& var) {
+  VarSignature signature{framework::proto::VarType::LOD_TENSOR,
+                         framework::proto::VarType::FP32, false,
+                         platform::CPUPlace(),
+                         framework::DataLayout::kAnyLayout};
+  if (var) {
+    signature.type = var->Type();
+    signature.data_type = var->DataType();
+    const auto* tensor = GetTensorFromVar(var->Var());
+    if (tensor && tensor->IsInitialized()) {
+      signature.initialized = true;
+      signature.place = tensor->place();
+      signature.layout = tensor->layout();
+    }
+  }
+  return signature;
+}
+
+template <typename VarType>
+bool PreparedOpCache::Match(const Entry& entry,
+                            const NameVarMap<VarType>& ins,
+                            const platform::Place& place,
+                            const framework::AttributeMap& attrs) const {
+  if (!platform::is_same_place(entry.place, place) ||
+      entry.inputs.size() != ins.size() ||
+      (entry.all_attrs && entry.attrs.size() != attrs.size())) {
+    return false;
+  }
+  for (auto& attr : entry.attrs) {
+    auto it = attrs.find(attr.first);
+    if (it == attrs.end() || !(it->second == attr.second)) return false;
+  }
+  for (auto& name : entry.missing_attrs) {
+    if (attrs.count(name)) return false;
+  }
+
+  // Both are ordered by the names of the inputs.
+  auto input = entry.inputs.begin();
+  for (auto& name_pair : ins) {
+    if (input->first != name_pair.first ||
+        input->second.size() != name_pair.second.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < name_pair.second.size(); ++i) {
+      if (!(input->second[i] == GetSignature<VarType>(name_pair.second[i]))) {
+        return false;
+      }
+    }
+    ++input;
+  }
+  return true;
+}
+
+template <typename VarType>
+PreparedOp PreparedOpCache::PrepareImpl(const NameVarMap<VarType>& ins,
+                                        const NameVarMap<VarType>& outs,
+                                        const platform::Place& place,
+                                        const framework::AttributeMap& attrs) {
+  for (auto& entry : entries_) {
+    if (Match<VarType>(entry, ins, place, attrs)) {
+      PrepareDataImpl<VarType>(entry.dev_ctx->GetPlace(), ins, op_,
+                               entry.kernel_key);
+      return PreparedOp(op_, ctx_, entry.func, entry.dev_ctx,
+                        entry.kernel_configs);
+    }
+  }
+
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto* dev_ctx = pool.Get(place);
+  framework::Scope scope;
+  ReadAttrs read_attrs;
+  DygraphExecutionContext<VarType> exe_ctx(op_, scope, *dev_ctx, ctx_, nullptr,
+                                           ins, outs, attrs);
+  exe_ctx.SetReadAttrs(&read_attrs);
+  auto expected_kernel_key = op_.GetExpectedKernelType(exe_ctx);
+  VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
+
+  auto& func = GetKernelFunc(op_, expected_kernel_key);
+  std::vector<framework::KernelConfig>* kernel_configs =
+      op_.GetKernelConfig(expected_kernel_key);
+  if (!(expected_kernel_key.place_ == place)) {
+    dev_ctx = pool.Get(expected_kernel_key.place_);
+  }
+  PrepareDataImpl<VarType>(dev_ctx->GetPlace(), ins, op_, expected_kernel_key);
+
+  if (entries_.size() < kMaxEntries) {
+    Entry entry(expected_kernel_key);
+    entry.place = place;
+    for (auto& name_pair : ins) {
+      std::vector<VarSignature> signatures;
+      for (auto& var : name_pair.second) {
+        signatures.push_back(GetSignature<VarType>(var));
+      }
+      entry.inputs.emplace_back(name_pair.first, std::move(signatures));
+    }
+    entry.all_attrs = read_attrs.all;
+    if (read_attrs.all) {
+      entry.attrs.assign(attrs.begin(), attrs.end());
+    } else {
+      for (auto& name : read_attrs.names) {
+        auto it = attrs.find(name);
+        if (it == attrs.end()) {
+          entry.missing_attrs.push_back(name);
+        } else {
+          entry.attrs.emplace_back(name, it->second);
+        }
+      }
+    }
+    entry.func = func;
+    entry.dev_ctx = dev_ctx;
+    entry.kernel_configs = kernel_configs;
+    VLOG(3) << "Cache the kernel " << expected_kernel_key << " of "
+            << op_.Type();
+    entries_.push_back(std::move(entry));
+  }
+  return PreparedOp(op_, ctx_, func, dev_ctx, kernel_configs);
+}
+
+PreparedOp PreparedOpCache::Prepare(const NameVarMap<VarBase>& ins,
+                                    const NameVarMap<VarBase>& outs,
+                                    const platform::Place& place,
+                                    const framework::AttributeMap& attrs) {
+  return PrepareImpl<VarBase>(ins, outs, place, attrs);
+}
+
+PreparedOp PreparedOpCache::Prepare(const NameVarMap<VariableWrapper>& ins,
+                                    const NameVarMap<VariableWrapper>& outs,
+                                    const platform::Place& place,
+                                    const framework::AttributeMap& attrs) {
+  return PrepareImpl<VariableWrapper>(ins, outs, place, attrs);
+}
+
 template <typename VarType>
 static void PreparedOpRunImpl(
     const framework::OperatorBase& op, const framework::RuntimeContext& ctx,
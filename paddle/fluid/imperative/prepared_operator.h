@@ -20,6 +20,7 @@
 #include "paddle/fluid/framework/data_transform.h"
 #include "paddle/fluid/framework/op_kernel_type.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/imperative/execution_context.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 
@@ -75,5 +76,76 @@ class PreparedOp {
   std::vector<framework::KernelConfig>* kernel_configs_;
 };
 
+// Caches the kernels chosen for an op, so that the traced ops of the same
+// type skip GetExpectedKernelType and the lookup of the kernels. An entry is
+// reused by the ops whose inputs have the same types, data types, places and
+// layouts, and whose attributes read by GetExpectedKernelType are the same.
+class PreparedOpCache {
+ public:
+  explicit PreparedOpCache(const framework::OperatorWithKernel& op)
+      : op_(op), ctx_({}, {}) {}
+
+  PreparedOp Prepare(const NameVarMap<VarBase>& ins,
+                     const NameVarMap<VarBase>& outs,
+                     const platform::Place& place,
+                     const framework::AttributeMap& attrs);
+
+  PreparedOp Prepare(const NameVarMap<VariableWrapper>& ins,
+                     const NameVarMap<VariableWrapper>& outs,
+                     const platform::Place& place,
+                     const framework::AttributeMap& attrs);
+
+  size_t Size() const { return entries_.size(); }
+
+ private:
+  struct VarSignature {
+    framework::proto::VarType::Type type;
+    framework::proto::VarType::Type data_type;
+    bool initialized;
+    platform::Place place;
+    framework::DataLayout layout;
+
+    bool operator==(const VarSignature& other) const;
+  };
+
+  struct Entry {
+    explicit Entry(const framework::OpKernelType& key) : kernel_key(key) {}
+
+    platform::Place place;
+    std::vector<std::pair<std::string, std::vector<VarSignature>>> inputs;
+    // The attributes read by GetExpectedKernelType, and whether they exist.
+    std::vector<std::pair<std::string, framework::Attribute>> attrs;
+    std::vector<std::string> missing_attrs;
+    bool all_attrs;
+
+    framework::OpKernelType kernel_key;
+    framework::OperatorWithKernel::OpKernelFunc func;
+    platform::DeviceContext* dev_ctx;
+    std::vector<framework::KernelConfig>* kernel_configs;
+  };
+
+  template <typename VarType>
+  static VarSignature GetSignature(const std::shared_ptr<VarType>& var);
+
+  template <typename VarType>
+  bool Match(const Entry& entry, const NameVarMap<VarType>& ins,
+             const platform::Place& place,
+             const framework::AttributeMap& attrs) const;
+
+  template <typename VarType>
+  PreparedOp PrepareImpl(const NameVarMap<VarType>& ins,
+                         const NameVarMap<VarType>& outs,
+                         const platform::Place& place,
+                         const framework::AttributeMap& attrs);
+
+  // The op of many kernel types, e.g. chosen by the attributes changed by
+  // each step, is not cached beyond the limit.
+  static constexpr size_t kMaxEntries = 16;
+
+  const framework::OperatorWithKernel& op_;
+  framework::RuntimeContext ctx_;
+  std::vector<Entry> entries_;
+};
+
 }  // namespace imperative
 }  // namespace paddle
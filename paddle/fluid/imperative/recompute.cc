@@ -0,0 +1,120 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/recompute.h"
+#include <limits>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/op_base.h"
+
+namespace paddle {
+namespace imperative {
+
+void RecomputeSegment::FixRandomSeed(framework::AttributeMap* attrs) {
+  auto seed_iter = attrs->find("seed");
+  if (seed_iter == attrs->end() || seed_iter->second.type() != typeid(int)) {
+    return;
+  }
+  // The ops with the attribute fix_seed, e.g., dropout, use the seed only if
+  // fix_seed is true, and the other ones, e.g., uniform_random, use a random
+  // seed if the seed is 0.
+  auto fix_seed_iter = attrs->find("fix_seed");
+  if (fix_seed_iter != attrs->end()) {
+    if (boost::get<bool>(fix_seed_iter->second)) return;
+    fix_seed_iter->second = true;
+  } else if (boost::get<int>(seed_iter->second) != 0) {
+    return;
+  }
+  std::uniform_int_distribution<int> dist(1, std::numeric_limits<int>::max());
+  seed_iter->second = dist(random_engine_);
+}
+
+static NameVarMap<VariableWrapper> ToVariableWrapperMap(
+    const NameVarBaseMap& vars) {
+  NameVarMap<VariableWrapper> result;
+  for (auto& pair : vars) {
+    auto& var_list = result[pair.first];
+    for (auto& var : pair.second) {
+      var_list.emplace_back(var ? var->SharedVar() : nullptr);
+    }
+  }
+  return result;
+}
+
+void RecomputeSegment::Record(const std::string& type,
+                              const NameVarBaseMap& ins,
+                              const NameVarBaseMap& outs,
+                              const framework::AttributeMap& attrs,
+                              const platform::Place& place) {
+  RecordedOp op;
+  op.type = type;
+  op.ins = ToVariableWrapperMap(ins);
+  op.outs = ToVariableWrapperMap(outs);
+  op.attrs = attrs;
+  op.place = place;
+  ops_.emplace_back(std::move(op));
+
+  for (auto& pair : outs) {
+    for (auto& var : pair.second) {
+      if (var) {
+        generated_vars_.emplace_back(var, var->SharedVar().get());
+      }
+    }
+  }
+}
+
+size_t RecomputeSegment::End() {
+  for (auto& pair : generated_vars_) {
+    if (!pair.first.expired()) continue;
+    auto* var = pair.second->MutableVar();
+    if (!var->IsType<framework::LoDTensor>()) continue;
+    // The dims and the data type are kept for the grad ops.
+    var->GetMutable<framework::LoDTensor>()->clear();
+    released_vars_.insert(pair.second);
+  }
+  generated_vars_.clear();
+  VLOG(3) << "Release " << released_vars_.size()
+          << " variables of the recompute segment of " << ops_.size()
+          << " ops";
+  return released_vars_.size();
+}
+
+void RecomputeSegment::Recompute() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (recomputed_) return;
+  recomputed_ = true;
+  if (released_vars_.empty()) return;
+
+  for (auto& recorded_op : ops_) {
+    VLOG(5) << "Recompute op " << recorded_op.type;
+    // The outputs not released are written to the temporary variables, so
+    // that the variables held by others are not changed.
+    NameVarMap<VariableWrapper> outs(recorded_op.outs);
+    for (auto& pair : outs) {
+      for (auto& var : pair.second) {
+        if (var && released_vars_.count(var.get()) == 0) {
+          var = std::make_shared<VariableWrapper>(var->Name());
+        }
+      }
+    }
+    auto op = framework::OpRegistry::CreateOp(recorded_op.type, {}, {}, {},
+                                              false);
+    OpBase::Run(*op, recorded_op.ins, outs, recorded_op.attrs,
+                recorded_op.place);
+  }
+  released_vars_.clear();
+}
+
+}  // namespace imperative
+}  // namespace paddle
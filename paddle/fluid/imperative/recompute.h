@@ -0,0 +1,82 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/type_defs.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+
+/*
+ * Records the forward ops traced in a recompute segment. The tensors of the
+ * intermediate variables of the segment are released at the end of the
+ * forward, and computed again by running the recorded ops just before the
+ * first grad op of the segment runs. Only the inputs and the outputs of the
+ * segment are kept during the forward, so the memory of the activations is
+ * saved at the cost of running the forward of the segment twice.
+ */
+class RecomputeSegment {
+  DISABLE_COPY_AND_ASSIGN(RecomputeSegment);
+
+ public:
+  RecomputeSegment() : random_engine_(std::random_device()()) {}
+
+  // Fixes the seed of the random op, e.g., dropout, so that it generates the
+  // same values when recomputed.
+  void FixRandomSeed(framework::AttributeMap* attrs);
+
+  void Record(const std::string& type, const NameVarBaseMap& ins,
+              const NameVarBaseMap& outs, const framework::AttributeMap& attrs,
+              const platform::Place& place);
+
+  // Releases the tensors of the variables generated in the segment and not
+  // held by any VarBase, and returns the number of them.
+  size_t End();
+
+  // Runs the recorded ops to regenerate the released variables. It only
+  // runs once, even if called by several grad ops.
+  void Recompute();
+
+ private:
+  struct RecordedOp {
+    std::string type;
+    NameVarMap<VariableWrapper> ins;
+    NameVarMap<VariableWrapper> outs;
+    framework::AttributeMap attrs;
+    platform::Place place;
+  };
+
+  std::vector<RecordedOp> ops_;
+  std::vector<std::pair<std::weak_ptr<VarBase>, VariableWrapper*>>
+      generated_vars_;
+  std::unordered_set<VariableWrapper*> released_vars_;
+  bool recomputed_{false};
+  std::mt19937 random_engine_;
+  std::mutex mutex_;
+};
+
+}  // namespace imperative
+}  // namespace paddle
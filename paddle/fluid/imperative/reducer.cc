@@ -0,0 +1,201 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/reducer.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/platform/collective_helper.h"
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/nccl_helper.h"
+
+namespace paddle {
+namespace imperative {
+
+#if defined(PADDLE_WITH_NCCL)
+Reducer::Reducer(const std::vector<std::shared_ptr<VarBase>>& params,
+                 int64_t bucket_bytes, const platform::CUDAPlace& place,
+                 int ring_id)
+    : place_(place), ring_id_(ring_id) {
+  int64_t bucket_size = 0;
+  auto bucket_dtype = framework::proto::VarType::FP32;
+  for (auto it = params.rbegin(); it != params.rend(); ++it) {
+    auto& param = *it;
+    if (!param || !param->HasGradVar()) continue;
+    auto& grad = param->GradVarBase()->SharedVar();
+    if (bucket_index_.count(grad.get())) continue;
+
+    auto dtype = param->DataType();
+    int64_t bytes = 0;
+    if (param->Var().IsType<framework::LoDTensor>()) {
+      bytes = param->Var().Get<framework::LoDTensor>().numel() *
+              framework::SizeOfType(dtype);
+    }
+    if (buckets_.empty() || bucket_size >= bucket_bytes ||
+        dtype != bucket_dtype) {
+      buckets_.emplace_back();
+      buckets_.back().dtype = dtype;
+      bucket_size = 0;
+      bucket_dtype = dtype;
+    }
+    bucket_size += bytes;
+    auto& bucket = buckets_.back();
+    int64_t numel = bytes / framework::SizeOfType(dtype);
+    bucket.grads.push_back(grad);
+    bucket.offsets.push_back(bucket.numel);
+    bucket.numels.push_back(numel);
+    bucket.numel += numel;
+    bucket_index_[grad.get()] = buckets_.size() - 1;
+  }
+  ResetBuckets();
+
+  platform::CUDADeviceGuard guard(place_.device);
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaEventCreateWithFlags(&compute_event_, cudaEventDisableTiming));
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaEventCreateWithFlags(&comm_event_, cudaEventDisableTiming));
+  VLOG(3) << "Make " << buckets_.size() << " buckets of " << params.size()
+          << " parameters to all-reduce";
+}
+
+Reducer::~Reducer() {
+  platform::CUDADeviceGuard guard(place_.device);
+  cudaEventDestroy(compute_event_);
+  cudaEventDestroy(comm_event_);
+}
+
+void Reducer::ResetBuckets() {
+  for (auto& bucket : buckets_) {
+    bucket.pending_num = bucket.grads.size();
+  }
+  next_bucket_ = 0;
+}
+
+void Reducer::OnGradReady(VariableWrapper* var) {
+  auto it = bucket_index_.find(var);
+  if (it == bucket_index_.end()) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& bucket = buckets_[it->second];
+  if (bucket.pending_num > 0) {
+    --bucket.pending_num;
+  }
+  LaunchReadyBuckets();
+}
+
+void Reducer::LaunchReadyBuckets() {
+  while (next_bucket_ < buckets_.size() &&
+         buckets_[next_bucket_].pending_num == 0) {
+    Launch(&buckets_[next_bucket_]);
+    ++next_bucket_;
+  }
+}
+
+void Reducer::Launch(Bucket* bucket) {
+  auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  auto* comm = platform::NCCLCommContext::Instance().Get(ring_id_, place_);
+  // The all-reduce waits for the grad ops launched before on the compute
+  // stream, but the grad ops launched after it do not wait for it.
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaEventRecord(compute_event_, dev_ctx->stream()));
+  auto stream = comm->stream();
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaStreamWaitEvent(stream, compute_event_, 0));
+
+  // The tensors of the gradients, nullptr for the gradients not generated by
+  // the backward, whose slots in the buffer are zero.
+  std::vector<framework::LoDTensor*> tensors(bucket->grads.size(), nullptr);
+  for (size_t i = 0; i < bucket->grads.size(); ++i) {
+    auto& grad = bucket->grads[i];
+    auto* var = grad->MutableVar();
+    if (!var->IsInitialized()) continue;
+    PADDLE_ENFORCE_EQ(var->IsType<framework::LoDTensor>(), true,
+                      platform::errors::Unimplemented(
+                          "The gradient %s to all-reduce is not dense, which "
+                          "is not supported by Reducer.",
+                          grad->Name()));
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    if (!tensor->IsInitialized()) continue;
+    PADDLE_ENFORCE_EQ(
+        platform::is_same_place(tensor->place(), place_), true,
+        platform::errors::InvalidArgument(
+            "The gradient %s to all-reduce is not on the place of the "
+            "communicator.",
+            grad->Name()));
+    PADDLE_ENFORCE_EQ(
+        tensor->numel() == bucket->numels[i] && tensor->type() == bucket->dtype,
+        true, platform::errors::InvalidArgument(
+                  "The gradient %s to all-reduce does not match the "
+                  "parameter in the numel or the data type.",
+                  grad->Name()));
+    tensors[i] = tensor;
+  }
+
+  auto nccl_dtype = platform::ToNCCLDataType(bucket->dtype);
+  // A bucket of one gradient is all-reduced in place. The buffer is
+  // all-reduced even if no gradient is generated, so that all the trainers
+  // call NCCL the same times.
+  if (tensors.size() == 1 && tensors[0] != nullptr) {
+    void* data = tensors[0]->data<void>();
+    PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllReduce(
+        data, data, tensors[0]->numel(), nccl_dtype, ncclSum, comm->comm(),
+        stream));
+    return;
+  }
+
+  size_t elem_size = framework::SizeOfType(bucket->dtype);
+  if (!bucket->buffer) {
+    bucket->buffer = memory::Alloc(place_, bucket->numel * elem_size);
+  }
+  auto* buffer = reinterpret_cast<uint8_t*>(bucket->buffer->ptr());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto* dst = buffer + bucket->offsets[i] * elem_size;
+    size_t bytes = bucket->numels[i] * elem_size;
+    if (tensors[i] == nullptr) {
+      PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemsetAsync(dst, 0, bytes, stream));
+    } else {
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaMemcpyAsync(dst, tensors[i]->data<void>(), bytes,
+                          cudaMemcpyDeviceToDevice, stream));
+    }
+  }
+  PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllReduce(
+      buffer, buffer, bucket->numel, nccl_dtype, ncclSum, comm->comm(),
+      stream));
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    if (tensors[i] == nullptr) continue;
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaMemcpyAsync(
+        tensors[i]->data<void>(), buffer + bucket->offsets[i] * elem_size,
+        bucket->numels[i] * elem_size, cudaMemcpyDeviceToDevice, stream));
+  }
+}
+
+void Reducer::OnBackwardEnd() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  // The gradients not generated by the backward are never ready.
+  while (next_bucket_ < buckets_.size()) {
+    Launch(&buckets_[next_bucket_]);
+    ++next_bucket_;
+  }
+
+  auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  auto* comm = platform::NCCLCommContext::Instance().Get(ring_id_, place_);
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(comm_event_, comm->stream()));
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaStreamWaitEvent(dev_ctx->stream(), comm_event_, 0));
+  ResetBuckets();
+}
+#endif
+
+}  // namespace imperative
+}  // namespace paddle
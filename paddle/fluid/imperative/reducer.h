@@ -0,0 +1,87 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/imperative/engine.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+
+#if defined(PADDLE_WITH_NCCL)
+/*
+ * All-reduces the gradients of the parameters of the data parallel training
+ * by buckets while the backward runs. The gradients of a bucket are packed
+ * into a buffer of the bucket and all-reduced by one call of NCCL on the
+ * stream of the communicator as soon as all of them are finished, and the
+ * compute stream waits for all the buckets at the end of the backward. The
+ * buckets are all-reduced in the same order by all the trainers, even if the
+ * gradients are finished in different orders.
+ */
+class Reducer : public GradientHook {
+ public:
+  // The parameters are in the order of the forward, and the buckets are made
+  // in the reverse order, which is the order the backward finishes them.
+  Reducer(const std::vector<std::shared_ptr<VarBase>>& params,
+          int64_t bucket_bytes, const platform::CUDAPlace& place,
+          int ring_id = 0);
+
+  ~Reducer();
+
+  void OnGradReady(VariableWrapper* var) override;
+
+  void OnBackwardEnd() override;
+
+  size_t BucketNum() const { return buckets_.size(); }
+
+ private:
+  struct Bucket {
+    std::vector<std::shared_ptr<VariableWrapper>> grads;
+    // The offsets and the numels of the gradients in the buffer.
+    std::vector<int64_t> offsets;
+    std::vector<int64_t> numels;
+    int64_t numel{0};
+    framework::proto::VarType::Type dtype{framework::proto::VarType::FP32};
+    // Allocated at the first launch, and kept for the following steps.
+    memory::AllocationPtr buffer;
+    size_t pending_num{0};
+  };
+
+  void ResetBuckets();
+
+  void LaunchReadyBuckets();
+
+  void Launch(Bucket* bucket);
+
+  std::vector<Bucket> buckets_;
+  std::unordered_map<VariableWrapper*, size_t> bucket_index_;
+  // The first bucket not launched by the current backward.
+  size_t next_bucket_{0};
+  platform::CUDAPlace place_;
+  int ring_id_;
+  cudaEvent_t compute_event_;
+  cudaEvent_t comm_event_;
+  std::mutex mutex_;
+};
+#endif
+
+}  // namespace imperative
+}  // namespace paddle
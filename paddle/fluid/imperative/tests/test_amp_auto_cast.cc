@@ -0,0 +1,137 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/basic_engine.h"
+#include "paddle/fluid/imperative/tracer.h"
+
+namespace paddle {
+namespace imperative {
+
+using vb_vector = std::vector<std::shared_ptr<imperative::VarBase>>;
+
+using var_pair = std::pair<std::string, vb_vector>;
+
+static std::shared_ptr<VarBase> CreateVar(const std::string& name,
+                                          float value) {
+  auto var = std::make_shared<VarBase>(true, name);
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({2, 3}));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) {
+    data[i] = value;
+  }
+  return var;
+}
+
+static std::shared_ptr<VarBase> TraceOp(Tracer* tracer, const std::string& type,
+                                        const NameVarBaseMap& ins,
+                                        bool trace_backward = false) {
+  auto out = std::make_shared<VarBase>(true, tracer->GenerateUniqueName());
+  tracer->TraceOp(type, ins, {var_pair("Out", {out})}, {},
+                  platform::CPUPlace(), trace_backward);
+  return out;
+}
+
+TEST(test_amp_auto_cast, op_lists) {
+  Tracer tracer;
+  tracer.SetEnableAutoCast(true);
+  auto* amp = tracer.GetAmpAutoCast();
+  // mul has no float16 kernel for CPU.
+  ASSERT_EQ(amp->WhiteList().count("mul"), 1UL);
+  ASSERT_ANY_THROW(amp->SetOpLists({"assign"}, {"assign"}));
+  amp->SetOpLists({"assign"}, {});
+
+  auto w = CreateVar("w", 2.0f);
+  w->SetPersistable(true);
+  auto x = CreateVar("x", 1.0f);
+  auto out = TraceOp(&tracer, "assign", {var_pair("X", {x})});
+  ASSERT_EQ(out->DataType(), framework::proto::VarType::FP16);
+  ASSERT_EQ(amp->CastOpNum(), 1UL);
+  ASSERT_EQ(amp->CachedVarNum(), 0UL);
+
+  // The float16 copy of the parameter is reused until it is written.
+  TraceOp(&tracer, "assign", {var_pair("X", {w})});
+  out = TraceOp(&tracer, "assign", {var_pair("X", {w})});
+  ASSERT_EQ(out->DataType(), framework::proto::VarType::FP16);
+  ASSERT_EQ(amp->CastOpNum(), 2UL);
+  ASSERT_EQ(amp->CachedVarNum(), 1UL);
+  tracer.TraceOp("elementwise_add", {var_pair("X", {x}), var_pair("Y", {x})},
+                 {var_pair("Out", {w})}, {}, platform::CPUPlace(), false);
+  TraceOp(&tracer, "assign", {var_pair("X", {w})});
+  ASSERT_EQ(amp->CastOpNum(), 3UL);
+
+  // The float16 input is cast to float32 if the op has both of them.
+  auto sum = TraceOp(&tracer, "elementwise_add",
+                     {var_pair("X", {out}), var_pair("Y", {x})});
+  ASSERT_EQ(sum->DataType(), framework::proto::VarType::FP32);
+  ASSERT_EQ(amp->CastOpNum(), 4UL);
+
+  amp->SetOpLists({}, {"assign"});
+  out = TraceOp(&tracer, "assign", {var_pair("X", {out})});
+  ASSERT_EQ(out->DataType(), framework::proto::VarType::FP32);
+  ASSERT_EQ(amp->CastOpNum(), 5UL);
+
+  tracer.SetEnableAutoCast(false);
+  amp->SetOpLists({"assign"}, {});
+  out = TraceOp(&tracer, "assign", {var_pair("X", {x})});
+  ASSERT_EQ(out->DataType(), framework::proto::VarType::FP32);
+  ASSERT_EQ(amp->CastOpNum(), 5UL);
+}
+
+TEST(test_amp_auto_cast, backward) {
+  Tracer tracer;
+  tracer.SetEnableAutoCast(true);
+  tracer.GetAmpAutoCast()->SetOpLists({"assign"}, {});
+  auto w = CreateVar("w", 2.0f);
+  w->SetPersistable(true);
+  w->SetOverridedStopGradient(false);
+  auto x = CreateVar("x", 1.0f);
+
+  // The float16 copy of w traced without the grad op is not reused.
+  TraceOp(&tracer, "assign", {var_pair("X", {w})});
+  auto w_fp16 = TraceOp(&tracer, "assign", {var_pair("X", {w})}, true);
+  auto w_fp16_2 = TraceOp(&tracer, "assign", {var_pair("X", {w})}, true);
+  ASSERT_EQ(tracer.GetAmpAutoCast()->CastOpNum(), 2UL);
+  auto h = TraceOp(&tracer, "elementwise_add",
+                   {var_pair("X", {w_fp16}), var_pair("Y", {x})}, true);
+  auto y = TraceOp(&tracer, "elementwise_add",
+                   {var_pair("X", {h}), var_pair("Y", {w_fp16_2})}, true);
+  auto loss = TraceOp(&tracer, "reduce_sum", {var_pair("X", {y})}, true);
+
+  tracer.ClearAutoCastCache();
+  detail::BackwardStrategy back_st;
+  BasicEngine engine;
+  engine.Init(loss.get(), back_st);
+  engine.Execute();
+
+  const auto& grad = w->GradVar().Get<framework::LoDTensor>();
+  ASSERT_EQ(grad.type(), framework::proto::VarType::FP32);
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_FLOAT_EQ(grad.data<float>()[i], 2.0f);
+  }
+  ASSERT_EQ(tracer.GetAmpAutoCast()->CachedVarNum(), 0UL);
+}
+
+}  // namespace imperative
+}  // namespace paddle
+
+USE_OP(assign);
+USE_OP(cast);
+USE_OP(elementwise_add);
+USE_OP(reduce_sum);
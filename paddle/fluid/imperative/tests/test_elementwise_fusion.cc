@@ -0,0 +1,147 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/basic_engine.h"
+#include "paddle/fluid/imperative/tracer.h"
+
+namespace paddle {
+namespace imperative {
+
+using vb_vector = std::vector<std::shared_ptr<imperative::VarBase>>;
+
+using var_pair = std::pair<std::string, vb_vector>;
+
+static void SetTensor(const std::shared_ptr<VarBase>& var,
+                      const std::vector<int64_t>& dims,
+                      const std::vector<float>& values) {
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim(dims));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (size_t i = 0; i < values.size(); ++i) {
+    data[i] = values[i];
+  }
+}
+
+// Traces out = relu(x * w + b) and loss = reduce_sum(out), in which b is
+// broadcast, and the elementwise ops are deferred until reduce_sum.
+static std::map<std::string, std::shared_ptr<VarBase>> TraceChain(
+    Tracer* tracer, bool trace_backward) {
+  std::map<std::string, std::shared_ptr<VarBase>> vars;
+  for (auto name : {"x", "w", "b", "h1", "h2", "out", "loss"}) {
+    vars[name].reset(new VarBase(true, name));
+  }
+  std::vector<float> x_values;
+  for (int i = 0; i < 10; ++i) {
+    x_values.push_back(i - 4.5f);
+  }
+  SetTensor(vars["x"], {2, 5}, x_values);
+  SetTensor(vars["w"], {2, 5}, std::vector<float>(10, 2.0f));
+  SetTensor(vars["b"], {5}, {0.0f, 1.0f, 2.0f, 3.0f, 4.0f});
+  vars["x"]->SetOverridedStopGradient(false);
+
+  platform::CPUPlace place;
+  tracer->TraceOp("elementwise_mul",
+                  {var_pair("X", {vars["x"]}), var_pair("Y", {vars["w"]})},
+                  {var_pair("Out", {vars["h1"]})}, {}, place, trace_backward);
+  tracer->TraceOp("elementwise_add",
+                  {var_pair("X", {vars["h1"]}), var_pair("Y", {vars["b"]})},
+                  {var_pair("Out", {vars["h2"]})}, {}, place, trace_backward);
+  tracer->TraceOp("relu", {var_pair("X", {vars["h2"]})},
+                  {var_pair("Out", {vars["out"]})}, {}, place,
+                  trace_backward);
+  return vars;
+}
+
+static float Relu(float x) { return x > 0 ? x : 0; }
+
+TEST(test_elementwise_fusion, fuse_chain) {
+  Tracer tracer;
+  tracer.SetEnableElementwiseFusion(true);
+  auto vars = TraceChain(&tracer, false);
+  ASSERT_EQ(tracer.GetElementwiseFusion()->DeferredOpNum(), 3UL);
+  const auto& out = vars["out"]->Var().Get<framework::LoDTensor>();
+  ASSERT_FALSE(out.IsInitialized());
+  ASSERT_EQ(out.dims(), framework::make_ddim({2, 5}));
+
+  // h2 is not referenced any more, so it is not written.
+  vars.erase("h2");
+  platform::CPUPlace place;
+  tracer.TraceOp("reduce_sum", {var_pair("X", {vars["out"]})},
+                 {var_pair("Out", {vars["loss"]})}, {}, place, false);
+  ASSERT_EQ(tracer.GetElementwiseFusion()->DeferredOpNum(), 0UL);
+  ASSERT_EQ(tracer.GetElementwiseFusion()->CompiledKernelNum(), 1UL);
+
+  const auto& h1 = vars["h1"]->Var().Get<framework::LoDTensor>();
+  float sum = 0;
+  for (int i = 0; i < 10; ++i) {
+    float expected = Relu((i - 4.5f) * 2.0f + i % 5);
+    ASSERT_FLOAT_EQ(h1.data<float>()[i], (i - 4.5f) * 2.0f);
+    ASSERT_FLOAT_EQ(out.data<float>()[i], expected);
+    sum += expected;
+  }
+  ASSERT_FLOAT_EQ(
+      vars["loss"]->Var().Get<framework::LoDTensor>().data<float>()[0], sum);
+
+  // The chain of the same structure reuses the kernel.
+  vars = TraceChain(&tracer, false);
+  vars.erase("h2");
+  tracer.SetEnableElementwiseFusion(false);
+  ASSERT_TRUE(vars["out"]->Var().Get<framework::LoDTensor>().IsInitialized());
+  ASSERT_EQ(tracer.GetElementwiseFusion()->CompiledKernelNum(), 1UL);
+
+  // The ops are not deferred when disabled.
+  vars = TraceChain(&tracer, false);
+  ASSERT_EQ(tracer.GetElementwiseFusion()->DeferredOpNum(), 0UL);
+  ASSERT_TRUE(vars["out"]->Var().Get<framework::LoDTensor>().IsInitialized());
+}
+
+TEST(test_elementwise_fusion, backward) {
+  Tracer tracer;
+  tracer.SetEnableElementwiseFusion(true);
+  auto vars = TraceChain(&tracer, true);
+  ASSERT_EQ(tracer.GetElementwiseFusion()->DeferredOpNum(), 3UL);
+  for (auto name : {"h1", "h2"}) {
+    vars.erase(name);
+  }
+  platform::CPUPlace place;
+  tracer.TraceOp("reduce_sum", {var_pair("X", {vars["out"]})},
+                 {var_pair("Out", {vars["loss"]})}, {}, place, true);
+
+  detail::BackwardStrategy back_st;
+  BasicEngine engine;
+  engine.Init(vars["loss"].get(), back_st);
+  engine.Execute();
+
+  const auto& grad = vars["x"]->GradVar().Get<framework::LoDTensor>();
+  ASSERT_EQ(grad.numel(), 10);
+  for (int i = 0; i < 10; ++i) {
+    float h2 = (i - 4.5f) * 2.0f + i % 5;
+    ASSERT_FLOAT_EQ(grad.data<float>()[i], h2 > 0 ? 2.0f : 0.0f);
+  }
+}
+
+}  // namespace imperative
+}  // namespace paddle
+
+USE_OP(elementwise_mul);
+USE_OP(elementwise_add);
+USE_OP(relu);
+USE_OP(reduce_sum);
+USE_OP(fusion_group);
@@ -314,5 +314,53 @@ TEST(test_gradient_accumulator, test_unchange_input) {
   }
 }
 
+static void TestStreamingSortedAccumulation(
+    const std::vector<size_t>& arrive_order,
+    const std::vector<size_t>& expected_held_nums) {
+  platform::CPUPlace place;
+  framework::DDim dim{10, 20};
+  std::vector<framework::Variable> grads(arrive_order.size());
+  for (auto& grad : grads) {
+    grad = RandomTensor<float>(dim, place);
+  }
+
+  // Sums the gradients by holding all of them as the reference.
+  auto ref_var = std::make_shared<VariableWrapper>("ref_var");
+  ref_var->SetOverridedStopGradient(false);
+  SortedGradientAccumulator ref_accum(ref_var.get());
+  auto var = std::make_shared<VariableWrapper>("var");
+  var->SetOverridedStopGradient(false);
+  SortedGradientAccumulator accum(var.get());
+  for (size_t i = 0; i < grads.size(); ++i) {
+    ref_accum.IncreaseRefCnt();
+    accum.IncreaseRefCnt();
+    accum.RegisterTraceId(i);
+  }
+
+  for (size_t i = 0; i < arrive_order.size(); ++i) {
+    auto trace_id = arrive_order[i];
+    auto ref_grad = std::make_shared<VariableWrapper>("ref_grad");
+    CopyVar(grads[trace_id], ref_grad->MutableVar());
+    ref_accum.Add(ref_grad, trace_id, false);
+
+    auto grad = std::make_shared<VariableWrapper>("grad");
+    CopyVar(grads[trace_id], grad->MutableVar());
+    std::weak_ptr<VariableWrapper> weak_grad = grad;
+    accum.Add(std::move(grad), trace_id, false);
+    ASSERT_EQ(accum.HeldVarNum(), expected_held_nums[i]);
+    // The gradient is released as soon as it is summed.
+    ASSERT_EQ(weak_grad.expired(), expected_held_nums[i] == 0);
+  }
+  ASSERT_TRUE(IsEqualVar(var->Var(), ref_var->Var()));
+}
+
+TEST(test_gradient_accumulator, test_streaming_sorted_accumulation) {
+  // The gradients arrive in the sorted order, and none is held.
+  TestStreamingSortedAccumulation({3, 2, 1, 0}, {0, 0, 0, 0});
+  // The gradients are held until the one of the largest trace id arrives.
+  TestStreamingSortedAccumulation({0, 1, 2, 3}, {1, 2, 3, 0});
+  TestStreamingSortedAccumulation({3, 1, 0, 2}, {0, 1, 2, 0});
+}
+
 }  // namespace imperative
 }  // namespace paddle
@@ -17,9 +17,12 @@
 //
 
 #include <paddle/fluid/framework/op_registry.h>
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/imperative/basic_engine.h"
@@ -494,6 +497,220 @@ static void TestVarOpDestructionMain(const platform::Place& place,
   }
 }
 
+template <typename T>
+static void SetTensor(const std::shared_ptr<imperative::VarBase>& var,
+                      const std::vector<int64_t>& dims) {
+  platform::CPUPlace place;
+  std::vector<T> src_data(10, 2.0);
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim(dims));
+  paddle::memory::Copy(place, tensor->mutable_data<T>(place), place,
+                       src_data.data(), sizeof(T) * src_data.size());
+}
+
+template <typename T>
+static std::shared_ptr<imperative::VarBase> TraceMul(
+    imperative::Tracer* tracer, const std::string& name) {
+  std::shared_ptr<imperative::VarBase> x_in(
+      new imperative::VarBase(true, name + "_x"));
+  std::shared_ptr<imperative::VarBase> y_in(
+      new imperative::VarBase(true, name + "_y"));
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, name + "_out"));
+  SetTensor<T>(x_in, {2, 5});
+  SetTensor<T>(y_in, {5, 2});
+
+  imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in)),
+                                    var_pair("Y", vb_vector(1, y_in))};
+  imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  tracer->TraceOp("mul", ins, outs, mul_attr_map, platform::CPUPlace(), true);
+  return vout;
+}
+
+TEST(test_tracer, test_cache_prepared_op) {
+  imperative::Tracer tracer;
+  for (int i = 0; i < 3; ++i) {
+    auto vout = TraceMul<float>(&tracer, "float_" + std::to_string(i));
+    const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+    for (int j = 0; j < out_tensor.numel(); j++) {
+      ASSERT_EQ(out_tensor.data<float>()[j], 20.0);
+    }
+  }
+  // The kernel chosen for the first op is reused by the others.
+  ASSERT_EQ(tracer.CachedKernelNum("mul"), 1UL);
+
+  auto vout = TraceMul<double>(&tracer, "double");
+  const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+  ASSERT_EQ(out_tensor.type(), framework::proto::VarType::FP64);
+  for (int j = 0; j < out_tensor.numel(); j++) {
+    ASSERT_EQ(out_tensor.data<double>()[j], 20.0);
+  }
+  ASSERT_EQ(tracer.CachedKernelNum("mul"), 2UL);
+}
+
+class RecordGradientHook : public GradientHook {
+ public:
+  void OnGradReady(VariableWrapper* var) override {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++ready_count_[var->Name()];
+  }
+
+  void OnBackwardEnd() override { ++end_count_; }
+
+  std::map<std::string, int> ready_count_;
+  int end_count_{0};
+
+ private:
+  std::mutex mutex_;
+};
+
+static void TestBranchBackward(size_t num_threads) {
+  // loss = reduce_sum(mul(x, y1) + mul(x, y2))
+  imperative::Tracer tracer;
+  std::map<std::string, std::shared_ptr<imperative::VarBase>> vars;
+  for (auto name : {"x", "y1", "y2", "out1", "out2", "sum", "loss"}) {
+    vars[name].reset(new imperative::VarBase(true, name));
+  }
+  SetTensor<float>(vars["x"], {2, 5});
+  SetTensor<float>(vars["y1"], {5, 2});
+  SetTensor<float>(vars["y2"], {5, 2});
+  for (auto name : {"x", "y1", "y2"}) {
+    vars[name]->SetOverridedStopGradient(false);
+  }
+
+  platform::CPUPlace place;
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  for (auto pair :
+       {std::make_pair("y1", "out1"), std::make_pair("y2", "out2")}) {
+    imperative::NameVarBaseMap ins = {
+        var_pair("X", vb_vector(1, vars["x"])),
+        var_pair("Y", vb_vector(1, vars[pair.first]))};
+    imperative::NameVarBaseMap outs = {
+        var_pair("Out", vb_vector(1, vars[pair.second]))};
+    tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true);
+  }
+  imperative::NameVarBaseMap add_ins = {
+      var_pair("X", vb_vector(1, vars["out1"])),
+      var_pair("Y", vb_vector(1, vars["out2"]))};
+  imperative::NameVarBaseMap add_outs = {
+      var_pair("Out", vb_vector(1, vars["sum"]))};
+  tracer.TraceOp("elementwise_add", add_ins, add_outs, {}, place, true);
+  imperative::NameVarBaseMap reduce_ins = {
+      var_pair("X", vb_vector(1, vars["sum"]))};
+  imperative::NameVarBaseMap reduce_outs = {
+      var_pair("Out", vb_vector(1, vars["loss"]))};
+  tracer.TraceOp("reduce_sum", reduce_ins, reduce_outs, {}, place, true);
+
+  auto hook = std::make_shared<RecordGradientHook>();
+  detail::BackwardStrategy back_st;
+  back_st.num_threads_ = num_threads;
+  imperative::BasicEngine engine;
+  engine.SetGradientHook(hook);
+  engine.Init(vars["loss"].get(), back_st);
+  engine.Execute();
+
+  // The gradient of x is accumulated by both of the branches.
+  const auto& x_grad = vars["x"]->GradVar().Get<framework::LoDTensor>();
+  ASSERT_EQ(x_grad.numel(), 10);
+  for (int i = 0; i < x_grad.numel(); ++i) {
+    ASSERT_EQ(x_grad.data<float>()[i], 8.0);
+  }
+  for (auto name : {"y1", "y2"}) {
+    const auto& y_grad = vars[name]->GradVar().Get<framework::LoDTensor>();
+    for (int i = 0; i < y_grad.numel(); ++i) {
+      ASSERT_EQ(y_grad.data<float>()[i], 4.0);
+    }
+  }
+
+  // Each gradient is finished once.
+  for (auto name : {"x", "y1", "y2"}) {
+    ASSERT_EQ(hook->ready_count_[vars[name]->GradVarName()], 1);
+  }
+  ASSERT_EQ(hook->end_count_, 1);
+}
+
+TEST(test_tracer, test_backward_with_branches) {
+  TestBranchBackward(1);
+  TestBranchBackward(4);
+}
+
+TEST(test_tracer, test_recompute) {
+  // loss = reduce_sum(mul(mul(x, y1), y2)), in which mul(x, y1) is recomputed
+  imperative::Tracer tracer;
+  std::map<std::string, std::shared_ptr<imperative::VarBase>> vars;
+  for (auto name : {"x", "y1", "y2", "h", "out", "loss"}) {
+    vars[name].reset(new imperative::VarBase(true, name));
+  }
+  SetTensor<float>(vars["x"], {2, 5});
+  SetTensor<float>(vars["y1"], {5, 2});
+  SetTensor<float>(vars["y2"], {2, 5});
+  for (auto name : {"x", "y1", "y2"}) {
+    vars[name]->SetOverridedStopGradient(false);
+  }
+
+  platform::CPUPlace place;
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  tracer.BeginRecompute();
+  ASSERT_TRUE(tracer.IsRecomputing());
+  for (auto names : {std::make_tuple("x", "y1", "h"),
+                     std::make_tuple("h", "y2", "out")}) {
+    imperative::NameVarBaseMap ins = {
+        var_pair("X", vb_vector(1, vars[std::get<0>(names)])),
+        var_pair("Y", vb_vector(1, vars[std::get<1>(names)]))};
+    imperative::NameVarBaseMap outs = {
+        var_pair("Out", vb_vector(1, vars[std::get<2>(names)]))};
+    tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true);
+  }
+  // h is not referenced by any VarBase at the end of the segment.
+  auto h_var = vars["h"]->SharedVar();
+  vars.erase("h");
+  ASSERT_EQ(tracer.EndRecompute(), 1UL);
+  ASSERT_FALSE(tracer.IsRecomputing());
+  ASSERT_FALSE(h_var->Var().Get<framework::LoDTensor>().IsInitialized());
+  ASSERT_TRUE(vars["out"]->Var().Get<framework::LoDTensor>().IsInitialized());
+
+  imperative::NameVarBaseMap reduce_ins = {
+      var_pair("X", vb_vector(1, vars["out"]))};
+  imperative::NameVarBaseMap reduce_outs = {
+      var_pair("Out", vb_vector(1, vars["loss"]))};
+  tracer.TraceOp("reduce_sum", reduce_ins, reduce_outs, {}, place, true);
+
+  detail::BackwardStrategy back_st;
+  imperative::BasicEngine engine;
+  engine.Init(vars["loss"].get(), back_st);
+  engine.Execute();
+
+  // h = 20, the gradient of h = 10, and the gradient of y2 needs h.
+  ASSERT_TRUE(h_var->Var().Get<framework::LoDTensor>().IsInitialized());
+  for (auto name : {"x", "y1", "y2"}) {
+    const auto& grad = vars[name]->GradVar().Get<framework::LoDTensor>();
+    ASSERT_EQ(grad.numel(), 10);
+    for (int i = 0; i < grad.numel(); ++i) {
+      ASSERT_EQ(grad.data<float>()[i], 40.0);
+    }
+  }
+}
+
+TEST(test_recompute_segment, fix_random_seed) {
+  imperative::RecomputeSegment segment;
+  framework::AttributeMap dropout_attrs = {{"fix_seed", false}, {"seed", 0}};
+  segment.FixRandomSeed(&dropout_attrs);
+  ASSERT_TRUE(boost::get<bool>(dropout_attrs["fix_seed"]));
+  ASSERT_NE(boost::get<int>(dropout_attrs["seed"]), 0);
+
+  framework::AttributeMap fixed_attrs = {{"fix_seed", true}, {"seed", 5}};
+  segment.FixRandomSeed(&fixed_attrs);
+  ASSERT_EQ(boost::get<int>(fixed_attrs["seed"]), 5);
+
+  framework::AttributeMap random_attrs = {{"seed", 0}};
+  segment.FixRandomSeed(&random_attrs);
+  ASSERT_NE(boost::get<int>(random_attrs["seed"]), 0);
+}
+
 TEST(test_tracer, test_var_op_destruction) {
   TestVarOpDestructionMain(platform::CPUPlace());
 #ifdef PADDLE_WITH_CUDA
@@ -16,6 +16,7 @@
 #include <unordered_set>
 #include <utility>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/flags.h"
 #include "paddle/fluid/imperative/op_base.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/string/string_helper.h"
@@ -46,22 +47,80 @@ void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
                      const NameVarBaseMap& outs, framework::AttributeMap attrs,
                      const platform::Place& place, bool trace_backward) {
   VLOG(1) << "Trace Op: " << type;
-  auto op = framework::OpRegistry::CreateOp(type, {}, {}, {}, false);
+  std::unique_ptr<framework::OperatorBase> uncached_op;
+  framework::OperatorBase* op = nullptr;
+  PreparedOpCache* cache = nullptr;
+  if (IsPreparedOpCacheEnabled()) {
+    auto& cached_op = cached_ops_[type];
+    if (!cached_op.op) {
+      cached_op.op = framework::OpRegistry::CreateOp(type, {}, {}, {}, false);
+      auto* op_kernel =
+          dynamic_cast<framework::OperatorWithKernel*>(cached_op.op.get());
+      if (op_kernel) {
+        cached_op.cache.reset(new PreparedOpCache(*op_kernel));
+      }
+    }
+    op = cached_op.op.get();
+    cache = cached_op.cache.get();
+  } else {
+    uncached_op = framework::OpRegistry::CreateOp(type, {}, {}, {}, false);
+    op = uncached_op.get();
+  }
   const auto& op_info = op->Info();
   auto* attr_checker = op_info.Checker();
   if (attr_checker) {
     attr_checker->Check(&attrs, true);
   }
 
-  OpBase::Run(*op, ins, outs, attrs, place);
+  NameVarBaseMap casted_ins;
+  if (enable_auto_cast_) {
+    casted_ins =
+        amp_auto_cast_->CastInputs(this, type, ins, place, trace_backward);
+  }
+  const auto& op_ins = casted_ins.empty() ? ins : casted_ins;
+
+  // The ops are not deferred if they are recorded by others.
+  bool deferred = false;
+#if !defined(_WIN32) && !defined(__APPLE__)
+  if (enable_elementwise_fusion_ && !recompute_segment_ &&
+      !enable_program_desc_tracing_) {
+    deferred = elementwise_fusion_->Defer(type, op_ins, outs, attrs, place);
+  }
+#endif
+
+  if (!deferred) {
+    FlushElementwiseFusion();
+    if (recompute_segment_) {
+      recompute_segment_->FixRandomSeed(&attrs);
+    }
+
+    OpBase::Run(*op, op_ins, outs, attrs, place, cache);
+
+    if (recompute_segment_) {
+      recompute_segment_->Record(type, op_ins, outs, attrs, place);
+    }
+  }
+
+  for (auto& pair : outs) {
+    for (auto& var : pair.second) {
+      if (var) {
+        var->BumpInplaceVersion();
+      }
+    }
+  }
 
   if (enable_program_desc_tracing_) {
     VLOG(5) << "Trace op " << type << " into ProgramDesc";
-    program_desc_tracer_->InsertOp(type, ins, outs, attrs);
+    program_desc_tracer_->InsertOp(type, op_ins, outs, attrs);
   }
 
-  if (ComputeRequiredGrad(ins, outs, trace_backward)) {
-    CreateGradOpNode(*op, ins, outs, attrs, place);
+  if (ComputeRequiredGrad(op_ins, outs, trace_backward)) {
+    auto grad_node = CreateGradOpNode(*op, op_ins, outs, attrs, place);
+    if (grad_node && recompute_segment_) {
+      for (auto& grad_op : *grad_node) {
+        grad_op.SetRecomputeSegment(recompute_segment_);
+      }
+    }
   } else {
     VLOG(3) << "No Grad to track for Op: " << type;
   }
@@ -73,6 +132,48 @@ void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
   TraceOp(type, ins, outs, std::move(attrs), expected_place_, no_grad_);
 }
 
+void Tracer::SetEnableElementwiseFusion(bool enabled) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  if (enabled && !elementwise_fusion_) {
+    elementwise_fusion_.reset(new ElementwiseFusion());
+  }
+  if (!enabled) {
+    FlushElementwiseFusion();
+  }
+  enable_elementwise_fusion_ = enabled;
+#else
+  if (enabled) {
+    LOG(WARNING) << "The elementwise fusion is not enabled for Windows/MacOS "
+                    "now.";
+  }
+#endif
+}
+
+void Tracer::FlushElementwiseFusion() {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  if (elementwise_fusion_) {
+    elementwise_fusion_->Flush();
+  }
+#endif
+}
+
+void Tracer::BeginRecompute() {
+  PADDLE_ENFORCE_EQ(recompute_segment_, nullptr,
+                    platform::errors::PreconditionNotMet(
+                        "The recompute segments can not be nested."));
+  recompute_segment_ = std::make_shared<RecomputeSegment>();
+}
+
+size_t Tracer::EndRecompute() {
+  PADDLE_ENFORCE_NOT_NULL(
+      recompute_segment_,
+      platform::errors::PreconditionNotMet(
+          "EndRecompute is called without BeginRecompute."));
+  auto released_num = recompute_segment_->End();
+  recompute_segment_ = nullptr;
+  return released_num;
+}
+
 bool Tracer::ComputeRequiredGrad(const NameVarBaseMap& ins,
                                  const NameVarBaseMap& outs,
                                  bool trace_backward) {
@@ -21,9 +21,13 @@
 #include <unordered_map>
 #include <vector>
 #include "ThreadPool.h"
+#include "paddle/fluid/imperative/amp_auto_cast.h"
 #include "paddle/fluid/imperative/basic_engine.h"
+#include "paddle/fluid/imperative/elementwise_fusion.h"
 #include "paddle/fluid/imperative/jit/program_desc_tracer.h"
 #include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/prepared_operator.h"
+#include "paddle/fluid/imperative/recompute.h"
 #include "paddle/fluid/platform/macros.h"
 
 namespace paddle {
@@ -48,7 +52,8 @@ class Tracer {
   Tracer()
       : basic_engine_(new BasicEngine()),
         program_desc_tracer_(new jit::ProgramDescTracer()),
-        generator_(new UniqueNameGenerator()) {
+        generator_(new UniqueNameGenerator()),
+        amp_auto_cast_(new AmpAutoCast()) {
     expected_place_ = platform::CPUPlace();
   }
 
@@ -90,13 +95,76 @@ class Tracer {
 
   void SetNoGrad(bool no_grad) { no_grad_ = no_grad; }
 
+  // The ops traced between BeginRecompute and EndRecompute make a recompute
+  // segment, whose intermediate variables are released at the end and
+  // recomputed by the backward. EndRecompute returns the number of the
+  // released variables.
+  void BeginRecompute();
+
+  size_t EndRecompute();
+
+  bool IsRecomputing() const { return recompute_segment_ != nullptr; }
+
+  // The elementwise ops are deferred and run by the fused kernels if enabled,
+  // see ElementwiseFusion. Disabling it runs the deferred ops.
+  void SetEnableElementwiseFusion(bool enabled);
+
+  bool IsElementwiseFusionEnabled() const {
+    return enable_elementwise_fusion_;
+  }
+
+  // Runs the deferred elementwise ops, it should be called before reading the
+  // values of the variables traced.
+  void FlushElementwiseFusion();
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+  const ElementwiseFusion* GetElementwiseFusion() const {
+    return elementwise_fusion_.get();
+  }
+#endif
+
+  // The inputs of the ops are cast to float16 or float32 by the op lists of
+  // the automatic mixed precision if enabled, see AmpAutoCast.
+  void SetEnableAutoCast(bool enabled) { enable_auto_cast_ = enabled; }
+
+  bool IsAutoCastEnabled() const { return enable_auto_cast_; }
+
+  AmpAutoCast* GetAmpAutoCast() { return amp_auto_cast_.get(); }
+
+  // It should be called before the backward runs.
+  void ClearAutoCastCache() { amp_auto_cast_->ClearCache(); }
+
+  // The number of the kernels cached for the ops of type.
+  size_t CachedKernelNum(const std::string& type) const {
+    auto it = cached_ops_.find(type);
+    return it == cached_ops_.end() || !it->second.cache
+               ? 0
+               : it->second.cache->Size();
+  }
+
  private:
+  // The op of a type is created once and reused by all the traced ops of the
+  // type, which have neither inputs nor attributes.
+  struct CachedOp {
+    std::unique_ptr<framework::OperatorBase> op;
+    std::unique_ptr<PreparedOpCache> cache;
+  };
+
+
   std::unique_ptr<BasicEngine> basic_engine_;
   std::unique_ptr<jit::ProgramDescTracer> program_desc_tracer_;
   bool enable_program_desc_tracing_{false};
   std::unique_ptr<UniqueNameGenerator> generator_;
   platform::Place expected_place_;
   bool no_grad_{false};
+  std::unordered_map<std::string, CachedOp> cached_ops_;
+  std::shared_ptr<RecomputeSegment> recompute_segment_;
+  bool enable_elementwise_fusion_{false};
+  std::unique_ptr<AmpAutoCast> amp_auto_cast_;
+  bool enable_auto_cast_{false};
+#if !defined(_WIN32) && !defined(__APPLE__)
+  std::unique_ptr<ElementwiseFusion> elementwise_fusion_;
+#endif
 };
 
 // To access static variable current_tracer
@@ -67,6 +67,13 @@ class VariableWrapper {
 
   bool Persistable() const { return persistable_; }
 
+  // The version is bumped each time the variable is written by a traced op,
+  // so that the values derived from it, e.g. the casted ones, can be reused
+  // until it changes.
+  uint32_t InplaceVersion() const { return inplace_version_; }
+
+  void BumpInplaceVersion() { ++inplace_version_; }
+
   const std::string& Name() const { return name_; }
 
   void SetName(const std::string& name) { name_ = name; }
@@ -145,6 +152,7 @@ class VariableWrapper {
   // should override the frameworks setting (-1) unset, (1) true, (0) false
   int overrided_stop_gradient_{-1};
   bool persistable_{false};
+  uint32_t inplace_version_{0};
 
   framework::proto::VarType::Type type_{framework::proto::VarType::LOD_TENSOR};
   framework::proto::VarType::Type data_type_{framework::proto::VarType::FP32};
@@ -60,6 +60,7 @@ struct Argument {
   using unique_ptr_t = std::unique_ptr<void, std::function<void(void*)>>;
   using fusion_statis_t = std::unordered_map<std::string, int>;
   using input_shape_t = std::map<std::string, std::vector<int>>;
+  using input_shapes_t = std::vector<input_shape_t>;
 
   bool Has(const std::string& key) const { return valid_fields_.count(key); }
   // If we set the model using config.SetModelBuffer,
@@ -132,6 +133,7 @@ struct Argument {
   DECL_ARGUMENT_FIELD(model_program_path, ModelProgramPath, std::string);
   DECL_ARGUMENT_FIELD(model_params_path, ModelParamsPath, std::string);
   DECL_ARGUMENT_FIELD(model_from_memory, ModelFromMemory, bool);
+  DECL_ARGUMENT_FIELD(memory_mapped_params, MemoryMappedParams, bool);
   DECL_ARGUMENT_FIELD(optim_cache_dir, OptimCacheDir, std::string);
   DECL_ARGUMENT_FIELD(enable_analysis_optim, EnableAnalysisOptim, bool);
 
@@ -183,6 +185,13 @@ struct Argument {
   DECL_ARGUMENT_FIELD(min_input_shape, MinInputShape, input_shape_t);
   DECL_ARGUMENT_FIELD(max_input_shape, MaxInputShape, input_shape_t);
   DECL_ARGUMENT_FIELD(optim_input_shape, OptimInputShape, input_shape_t);
+  // The optimization profiles besides the one above.
+  DECL_ARGUMENT_FIELD(extra_min_input_shapes, ExtraMinInputShapes,
+                      input_shapes_t);
+  DECL_ARGUMENT_FIELD(extra_max_input_shapes, ExtraMaxInputShapes,
+                      input_shapes_t);
+  DECL_ARGUMENT_FIELD(extra_optim_input_shapes, ExtraOptimInputShapes,
+                      input_shapes_t);
   DECL_ARGUMENT_FIELD(disable_trt_plugin_fp16, CloseTrtPluginFp16, bool);
 
   DECL_ARGUMENT_FIELD(use_tensorrt, UseTensorRT, bool);
@@ -194,12 +203,14 @@ struct Argument {
   DECL_ARGUMENT_FIELD(tensorrt_use_static_engine, TensorRtUseStaticEngine,
                       bool);
   DECL_ARGUMENT_FIELD(tensorrt_use_calib_mode, TensorRtUseCalibMode, bool);
+  DECL_ARGUMENT_FIELD(tensorrt_build_threads, TensorRtBuildThreads, int);
 
   DECL_ARGUMENT_FIELD(lite_passes_filter, LitePassesFilter,
                       std::vector<std::string>);
   DECL_ARGUMENT_FIELD(lite_ops_filter, LiteOpsFilter, std::vector<std::string>);
   DECL_ARGUMENT_FIELD(lite_precision_mode, LitePrecisionMode,
                       AnalysisConfig::Precision);
+  DECL_ARGUMENT_FIELD(lite_zero_copy, LiteZeroCopy, bool);
 
   // Memory optimized related.
   DECL_ARGUMENT_FIELD(enable_memory_optim, EnableMemoryOptim, bool);
@@ -36,10 +36,12 @@ limitations under the License. */
 #include <io.h>
 #define GCC_ATTRIBUTE(attr__)
 #define MKDIR(path) _mkdir(path)
+#define RMDIR(path) _rmdir(path)
 #else
 #include <unistd.h>
 #define GCC_ATTRIBUTE(attr__) __attribute__((attr__));
 #define MKDIR(path) mkdir(path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH)
+#define RMDIR(path) rmdir(path)
 #endif
 #define __SHOULD_USE_RESULT__ GCC_ATTRIBUTE(warn_unused_result)
 
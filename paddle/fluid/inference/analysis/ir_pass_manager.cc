@@ -130,11 +130,19 @@ void IRPassManager::CreatePasses(Argument *argument,
       pass->Set("optim_input_shape",
                 new std::map<std::string, std::vector<int>>(
                     argument->optim_input_shape()));
+      using input_shapes_t = Argument::input_shapes_t;
+      pass->Set("extra_min_input_shapes",
+                new input_shapes_t(argument->extra_min_input_shapes()));
+      pass->Set("extra_max_input_shapes",
+                new input_shapes_t(argument->extra_max_input_shapes()));
+      pass->Set("extra_optim_input_shapes",
+                new input_shapes_t(argument->extra_optim_input_shapes()));
       // Setting the disable_trt_plugin_fp16 to true means that TRT plugin will
       // not
       // run fp16.
       pass->Set("disable_trt_plugin_fp16",
                 new bool(argument->disable_trt_plugin_fp16()));
+      pass->Set("build_threads", new int(argument->tensorrt_build_threads()));
     }
     if (pass_name == "ngraph_subgraph_pass") {
       pass->Set("program",
@@ -150,6 +158,7 @@ void IRPassManager::CreatePasses(Argument *argument,
       pass->Set("predictor_id", new int(argument->predictor_id()));
       pass->Set("enable_int8", new bool(enable_int8));
       pass->Set("use_gpu", new bool(argument->use_gpu()));
+      pass->Set("zero_copy", new bool(argument->lite_zero_copy()));
     }
     disable_logs_ = argument->disable_logs();
     if (pass_name == "fc_fuse_pass") {
@@ -13,9 +13,15 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
 #include <map>
 #include <set>
+#include <sstream>
+#include <thread>  // NOLINT
 
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 #include "paddle/fluid/framework/ir/subgraph_detector.h"
 #include "paddle/fluid/inference/analysis/helper.h"
@@ -31,6 +37,120 @@ namespace analysis {
 
 using framework::ir::Node;
 
+// Run the jobs building the engines by num_threads threads. Only the
+// building of the converted networks runs in parallel, since the op
+// converters are serialized by OpConverter::ConvertBlock.
+static void BuildEngines(const std::vector<std::function<void()>> &jobs,
+                         int num_threads) {
+  num_threads = std::min(num_threads, static_cast<int>(jobs.size()));
+  if (num_threads <= 1) {
+    for (auto &job : jobs) job();
+    return;
+  }
+  LOG(INFO) << "Build " << jobs.size() << " TRT engines by " << num_threads
+            << " threads.";
+  std::atomic<size_t> next_job(0);
+  std::vector<std::exception_ptr> errors(num_threads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i] {
+      try {
+        for (size_t job = next_job++; job < jobs.size(); job = next_job++) {
+          jobs[job]();
+        }
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  for (auto &error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
+// The bytes of a sample of the variable, by the shape without the batch.
+static size_t SampleBytes(const Node *var) {
+  if (!var->Var() ||
+      var->Var()->GetType() != framework::proto::VarType::LOD_TENSOR) {
+    return 0;
+  }
+  auto shape = var->Var()->GetShape();
+  size_t numel = 1;
+  for (size_t i = 1; i < shape.size(); ++i) {
+    numel *= static_cast<size_t>(std::abs(shape[i]));
+  }
+  return numel * framework::SizeOfType(var->Var()->GetDataType());
+}
+
+// Logs the ops without converters between the ops converted to TensorRT,
+// which split the TensorRT subgraphs. Each tensor between them is either an
+// input or an output of an engine, which is copied across the boundary of
+// the engine and Fluid, and keeps TensorRT from fusing the layers.
+static void ReportRejectedOps(
+    const framework::ir::Graph &graph,
+    const std::function<bool(const Node *)> &teller) {
+  struct RejectedOp {
+    int num{0};
+    // the ops with the converted ops both before and after them
+    int splits{0};
+    int boundary_tensors{0};
+    size_t boundary_bytes{0};
+  };
+  std::map<std::string, RejectedOp> rejected;
+  for (auto *node : graph.Nodes()) {
+    if (!node->IsOp() || !node->Op() || teller(node)) continue;
+    auto op_type = node->Op()->Type();
+    if (op_type == "feed" || op_type == "fetch") continue;
+    auto &op = rejected[op_type];
+    ++op.num;
+    bool after_trt = false, before_trt = false;
+    for (auto *in : node->inputs) {
+      for (auto *producer : in->inputs) {
+        if (teller(producer)) {
+          after_trt = true;
+          ++op.boundary_tensors;
+          op.boundary_bytes += SampleBytes(in);
+          break;
+        }
+      }
+    }
+    for (auto *out : node->outputs) {
+      for (auto *consumer : out->outputs) {
+        if (teller(consumer)) {
+          before_trt = true;
+          ++op.boundary_tensors;
+          op.boundary_bytes += SampleBytes(out);
+          break;
+        }
+      }
+    }
+    if (after_trt && before_trt) ++op.splits;
+  }
+
+  using Entry = std::pair<std::string, RejectedOp>;
+  std::vector<Entry> ops;
+  for (auto &op : rejected) {
+    if (op.second.boundary_tensors > 0) ops.emplace_back(op);
+  }
+  if (ops.empty()) return;
+  std::sort(ops.begin(), ops.end(), [](const Entry &a, const Entry &b) {
+    return a.second.splits != b.second.splits
+               ? a.second.splits > b.second.splits
+               : a.second.boundary_bytes > b.second.boundary_bytes;
+  });
+  string::PrettyLogDetail(
+      "---  %d op types without TRT converters are next to the TRT ops",
+      ops.size());
+  for (auto &op : ops) {
+    string::PrettyLogDetail(
+        "       %s: %d ops, %d splitting the subgraphs, %d tensors copied "
+        "across the engines of %d bytes per sample",
+        op.first, op.second.num, op.second.splits, op.second.boundary_tensors,
+        op.second.boundary_bytes);
+  }
+}
+
 void analysis::TensorRtSubgraphPass::ApplyImpl(
     framework::ir::Graph *graph) const {
   framework::ir::FusePassBase::Init("tensorrt_subgraph_pass", graph);
@@ -43,6 +163,8 @@ void analysis::TensorRtSubgraphPass::ApplyImpl(
                                              no_calib_int8);
   };
 
+  ReportRejectedOps(*graph, teller);
+
   framework::ir::SubGraphFuser fuser(
       graph, teller, Get<int>("min_subgraph_size") /*min subgraph size*/,
       "tensorrt_engine");
@@ -53,10 +175,14 @@ void analysis::TensorRtSubgraphPass::ApplyImpl(
   // those parameter already exist in trt, and should not have another copy in
   // fluid.
   std::vector<std::string> repetitive_params;
+  // The engines are built after all the subgraphs are converted to the
+  // tensorrt_engine ops.
+  std::vector<std::function<void()>> build_jobs;
 
   for (auto *node : graph->Nodes()) {
     if (node->IsOp() && !framework::ir::Agent(node).subgraph()->empty()) {
-      CreateTensorRTOp(node, graph, graph_param_names, &repetitive_params);
+      CreateTensorRTOp(node, graph, graph_param_names, &repetitive_params,
+                       &build_jobs);
 
       std::unordered_set<const Node *> nodes2remove(
           framework::ir::Agent(node).subgraph()->begin(),
@@ -72,6 +198,9 @@ void analysis::TensorRtSubgraphPass::ApplyImpl(
     }
   }
   framework::ir::GraphSafeRemoveNodes(graph, nodes2remove);
+
+  int build_threads = Has("build_threads") ? Get<int>("build_threads") : 1;
+  BuildEngines(build_jobs, build_threads);
   graph->Set(framework::ir::kRepetitiveParamAttr,
              new std::vector<std::string>(repetitive_params));
 }
@@ -94,7 +223,8 @@ std::string GenerateEngineKey(const std::set<std::string> &engine_inputs,
 void TensorRtSubgraphPass::CreateTensorRTOp(
     framework::ir::Node *node, framework::ir::Graph *graph,
     const std::vector<std::string> &graph_params,
-    std::vector<std::string> *repetitive_params) const {
+    std::vector<std::string> *repetitive_params,
+    std::vector<std::function<void()>> *build_jobs) const {
   auto *op_desc = node->Op();
   auto &subgraph = *framework::ir::Agent(node).subgraph();
   PADDLE_ENFORCE(!subgraph.empty());
@@ -172,6 +302,11 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
       Get<std::map<std::string, std::vector<int>>>("max_input_shape");
   auto opt_input_shape =
       Get<std::map<std::string, std::vector<int>>>("optim_input_shape");
+  using input_shapes_t = std::vector<std::map<std::string, std::vector<int>>>;
+  auto extra_min_input_shapes = Get<input_shapes_t>("extra_min_input_shapes");
+  auto extra_max_input_shapes = Get<input_shapes_t>("extra_max_input_shapes");
+  auto extra_opt_input_shapes =
+      Get<input_shapes_t>("extra_optim_input_shapes");
 
   // The following procedure is used to rename all the intermediate
   // variables and the output variables of the subgraph.
@@ -232,6 +367,23 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
   // when running in the 'use_serialize' mode, there is a bug.
   auto engine_key = GenerateEngineKey(input_names_with_id, output_names_with_id,
                                       std::to_string(0));
+  // The serialized engine has all the optimization profiles, so the extra
+  // profiles are a part of the key.
+  if (!extra_min_input_shapes.empty()) {
+    std::stringstream profiles;
+    for (auto *shapes : {&extra_min_input_shapes, &extra_max_input_shapes,
+                         &extra_opt_input_shapes}) {
+      for (auto &profile : *shapes) {
+        for (auto &input : profile) {
+          profiles << input.first << ':';
+          for (auto dim : input.second) profiles << dim << ',';
+        }
+        profiles << ';';
+      }
+    }
+    engine_key +=
+        "_" + std::to_string(std::hash<std::string>()(profiles.str()));
+  }
   auto predictor_id = Get<int>("predictor_id");
 
   // Get "" when there is no cached calibration table data.
@@ -252,7 +404,8 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
   op_desc->SetAttr("engine_serialized_data", trt_engine_serialized_data);
   op_desc->Flush();
 
-  std::unique_ptr<tensorrt::TRTInt8Calibrator> calibrator;
+  // The calibrator is used when the engine is built.
+  std::shared_ptr<tensorrt::TRTInt8Calibrator> calibrator;
   if (enable_int8 && calibration_data.size() != 0) {
     calibrator.reset(new tensorrt::TRTInt8Calibrator(calibration_data));
     LOG(INFO) << "RUN Paddle TRT int8 calibration mode...";
@@ -279,6 +432,9 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
     min_input_shape = {};
     max_input_shape = {};
     opt_input_shape = {};
+    extra_min_input_shapes.clear();
+    extra_max_input_shapes.clear();
+    extra_opt_input_shapes.clear();
   }
 
   if (min_input_shape.size() > 0 && TRT_VERSION > 6000) {
@@ -300,6 +456,11 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
                   precision_mode, calibrator.get(), Get<int>("gpu_device_id"),
                   min_input_shape, max_input_shape, opt_input_shape,
                   disable_trt_plugin_fp16);
+  for (size_t i = 0; i < extra_min_input_shapes.size(); ++i) {
+    trt_engine->AddShapeProfile(extra_min_input_shapes[i],
+                                extra_max_input_shapes[i],
+                                extra_opt_input_shapes[i]);
+  }
 
   bool need_serialize = (use_static_engine && !load_from_memory);
   if (need_serialize) {
@@ -322,24 +483,31 @@ void TensorRtSubgraphPass::CreateTensorRTOp(
                "kernel etc). This process may cost a lot of time.";
 
   auto *scope = param_scope();
-  framework::BlockDesc block_desc_temp(nullptr, block_desc.Proto());
+  auto block_proto =
+      std::make_shared<framework::proto::BlockDesc>(*block_desc.Proto());
+  std::vector<std::string> engine_inputs(input_names.begin(),
+                                         input_names.end());
   std::unordered_set<std::string> param_set(params.begin(), params.end());
-  inference::Singleton<inference::tensorrt::OpConverter>::Global()
-      .ConvertBlockToTRTEngine(
-          &block_desc_temp, *scope,
-          std::vector<std::string>(input_names.begin(), input_names.end()),
-          param_set, output_mapping, trt_engine);
-
-  if (need_serialize) {
-    nvinfer1::IHostMemory *serialized_engine_data = trt_engine->Serialize();
-    trt_engine_serialized_data =
-        std::string((const char *)serialized_engine_data->data(),
-                    serialized_engine_data->size());
-    SaveTrtEngineSerializedDataToFile(
-        GetTrtEngineSerializedPath(Get<std::string>("model_opt_cache_dir"),
-                                   engine_key),
-        trt_engine_serialized_data);
-  }
+  std::string serialized_path =
+      need_serialize
+          ? GetTrtEngineSerializedPath(Get<std::string>("model_opt_cache_dir"),
+                                       engine_key)
+          : "";
+  build_jobs->emplace_back([block_proto, scope, engine_inputs, param_set,
+                            output_mapping, trt_engine, calibrator,
+                            need_serialize, serialized_path] {
+    framework::BlockDesc block_desc_temp(nullptr, block_proto.get());
+    inference::Singleton<inference::tensorrt::OpConverter>::Global()
+        .ConvertBlockToTRTEngine(&block_desc_temp, *scope, engine_inputs,
+                                 param_set, output_mapping, trt_engine);
+    if (need_serialize) {
+      nvinfer1::IHostMemory *serialized_engine_data = trt_engine->Serialize();
+      SaveTrtEngineSerializedDataToFile(
+          serialized_path,
+          std::string((const char *)serialized_engine_data->data(),
+                      serialized_engine_data->size()));
+    }
+  });
 }
 
 }  // namespace analysis
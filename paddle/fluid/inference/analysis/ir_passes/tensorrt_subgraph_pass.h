@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -34,7 +35,8 @@ class TensorRtSubgraphPass : public framework::ir::FusePassBase {
  private:
   void CreateTensorRTOp(framework::ir::Node *x, framework::ir::Graph *graph,
                         const std::vector<std::string> &graph_params,
-                        std::vector<std::string> *repetitive_params) const;
+                        std::vector<std::string> *repetitive_params,
+                        std::vector<std::function<void()>> *build_jobs) const;
   void CleanIntermediateOutputs(framework::ir::Node *node);
 };
 
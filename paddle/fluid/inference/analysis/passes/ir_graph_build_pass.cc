@@ -39,16 +39,19 @@ void IrGraphBuildPass::RunImpl(Argument *argument) {
   platform::Place place;
   place = platform::CPUPlace();
 
+  bool use_mmap = argument->memory_mapped_params_valid() &&
+                  argument->memory_mapped_params();
   if (argument->model_dir_valid()) {
-    auto program =
-        LoadModel(argument->model_dir(), argument->scope_ptr(), place);
+    auto program = LoadModel(argument->model_dir(), argument->scope_ptr(),
+                             place, use_mmap);
     argument->SetMainProgram(program.release());
   } else if (argument->model_program_path_valid() &&
              argument->model_params_path_valid()) {
     auto program = LoadModel(
         argument->model_program_path(), argument->model_params_path(),
         argument->scope_ptr(), place,
-        argument->model_from_memory_valid() && argument->model_from_memory());
+        argument->model_from_memory_valid() && argument->model_from_memory(),
+        use_mmap);
     argument->SetMainProgram(program.release());
   } else {
     PADDLE_THROW(
@@ -64,18 +67,18 @@ void IrGraphBuildPass::RunImpl(Argument *argument) {
 
 std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
     const std::string &path, framework::Scope *scope,
-    const platform::Place &place) {
+    const platform::Place &place, bool use_mmap) {
   framework::Executor exe(place);
-  return Load(&exe, scope, path);
+  return Load(&exe, scope, path, use_mmap);
 }
 
 std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
     const std::string &program_path, const std::string &params_path,
     framework::Scope *scope, const platform::Place &place,
-    bool model_from_memory) {
+    bool model_from_memory, bool use_mmap) {
   framework::Executor exe(place);
   if (!model_from_memory) {
-    return Load(&exe, scope, program_path, params_path);
+    return Load(&exe, scope, program_path, params_path, use_mmap);
   } else {
     return LoadFromMemory(&exe, scope, program_path, params_path);
   }
@@ -35,11 +35,11 @@ class IrGraphBuildPass : public AnalysisPass {
  private:
   std::unique_ptr<framework::ProgramDesc> LoadModel(
       const std::string &path, framework::Scope *scope,
-      const platform::Place &place);
+      const platform::Place &place, bool use_mmap);
   std::unique_ptr<framework::ProgramDesc> LoadModel(
       const std::string &program_path, const std::string &params_path,
       framework::Scope *scope, const platform::Place &place,
-      bool model_from_memory);
+      bool model_from_memory, bool use_mmap);
 
   std::string model_binary_str_;
 };
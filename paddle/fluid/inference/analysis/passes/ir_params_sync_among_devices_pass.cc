@@ -13,21 +13,197 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/analysis/passes/ir_params_sync_among_devices_pass.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include "paddle/fluid/framework/data_layout.h"
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/enforce.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/gpu_info.h"
+#include "paddle/fluid/platform/stream/cuda_stream.h"
+
+DECLARE_bool(inference_params_contiguous);
+#endif
 
 namespace paddle {
 namespace inference {
 namespace analysis {
 
+#ifdef PADDLE_WITH_CUDA
+// Uploads the host memory to the GPU by two pinned staging buffers in turn,
+// so that the parameters are packed into one of them while the other is
+// copied on a stream of its own. The copies to the consecutive device
+// memory are merged, e.g., the parameters placed in one allocation.
+class ParamsUploader {
+ public:
+  ParamsUploader(const platform::CUDAPlace &place, size_t staging_size)
+      : place_(place), stream_(place), staging_size_(staging_size) {
+    platform::CUDADeviceGuard guard(place_.device);
+    for (int i = 0; i < 2; ++i) {
+      staging_[i] = memory::Alloc(platform::CUDAPinnedPlace(), staging_size_);
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaEventCreateWithFlags(&events_[i], cudaEventDisableTiming),
+          platform::errors::External("Failed to create the cuda event."));
+    }
+  }
+
+  ~ParamsUploader() {
+    platform::CUDADeviceGuard guard(place_.device);
+    for (auto &event : events_) {
+      cudaEventDestroy(event);
+    }
+  }
+
+  void Upload(const void *src, void *dst, size_t size) {
+    auto *src_bytes = reinterpret_cast<const char *>(src);
+    auto *dst_bytes = reinterpret_cast<char *>(dst);
+    while (size > 0) {
+      if (used_ == staging_size_) Flush();
+      size_t n = std::min(size, staging_size_ - used_);
+      std::memcpy(reinterpret_cast<char *>(staging_[current_]->ptr()) + used_,
+                  src_bytes, n);
+      if (!segments_.empty() && segments_.back().dst + segments_.back().size ==
+                                    dst_bytes) {
+        segments_.back().size += n;
+      } else {
+        segments_.push_back({dst_bytes, used_, n});
+      }
+      used_ += n;
+      src_bytes += n;
+      dst_bytes += n;
+      size -= n;
+    }
+  }
+
+  void Wait() {
+    Flush();
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaStreamSynchronize(stream_.stream()),
+        platform::errors::External("Failed to upload the parameters."));
+  }
+
+ private:
+  struct Segment {
+    char *dst;
+    size_t offset;
+    size_t size;
+  };
+
+  void Flush() {
+    if (segments_.empty()) return;
+    platform::CUDADeviceGuard guard(place_.device);
+    auto *staging = reinterpret_cast<char *>(staging_[current_]->ptr());
+    for (auto &segment : segments_) {
+      platform::GpuMemcpyAsync(segment.dst, staging + segment.offset,
+                               segment.size, cudaMemcpyHostToDevice,
+                               stream_.stream());
+    }
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaEventRecord(events_[current_], stream_.stream()),
+        platform::errors::External("Failed to record the cuda event."));
+    segments_.clear();
+    used_ = 0;
+    // the other buffer is packed after its copies are done
+    current_ ^= 1;
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaEventSynchronize(events_[current_]),
+        platform::errors::External("Failed to wait for the cuda event."));
+  }
+
+  platform::CUDAPlace place_;
+  platform::stream::CUDAStream stream_;
+  size_t staging_size_;
+  memory::AllocationPtr staging_[2];
+  cudaEvent_t events_[2];
+  int current_{0};
+  size_t used_{0};
+  std::vector<Segment> segments_;
+};
+
+// The parameters of each data type are placed in one allocation if
+// FLAGS_inference_params_contiguous, or in their own allocations.
+static void AllocParamsOnGPU(
+    const std::vector<framework::LoDTensor *> &params,
+    const std::vector<framework::proto::VarType::Type> &types,
+    const platform::CUDAPlace &place) {
+  if (!FLAGS_inference_params_contiguous) {
+    for (size_t i = 0; i < params.size(); ++i) {
+      params[i]->mutable_data(place, types[i]);
+    }
+    return;
+  }
+  std::map<framework::proto::VarType::Type, int64_t> numels;
+  for (size_t i = 0; i < params.size(); ++i) {
+    numels[types[i]] += params[i]->numel();
+  }
+  std::map<framework::proto::VarType::Type, framework::Tensor> buffers;
+  std::map<framework::proto::VarType::Type, int64_t> offsets;
+  for (auto &numel : numels) {
+    if (numel.second == 0) continue;
+    auto &buffer = buffers[numel.first];
+    buffer.Resize({numel.second});
+    buffer.mutable_data(place, numel.first);
+  }
+  for (size_t i = 0; i < params.size(); ++i) {
+    auto *t = params[i];
+    if (t->numel() == 0) {
+      t->mutable_data(place, types[i]);
+      continue;
+    }
+    auto dims = t->dims();
+    auto &offset = offsets[types[i]];
+    t->ShareDataWith(
+        buffers[types[i]].Slice(offset, offset + t->numel()).Resize(dims));
+    offset += t->numel();
+  }
+}
+
+// The staging buffers are no larger than the parameters.
+static constexpr size_t kMaxStagingSize = 64 << 20;
+
+static void UploadParams(const std::vector<framework::LoDTensor *> &params,
+                         const platform::CUDAPlace &place) {
+  if (params.empty()) return;
+  // the host memory is kept by cpu_params until uploaded
+  std::vector<framework::Tensor> cpu_params(params.size());
+  std::vector<framework::proto::VarType::Type> types(params.size());
+  std::vector<size_t> sizes(params.size());
+  size_t total_size = 0;
+  for (size_t i = 0; i < params.size(); ++i) {
+    cpu_params[i].ShareDataWith(*params[i]);
+    types[i] = params[i]->type();
+    sizes[i] = params[i]->numel() * framework::SizeOfType(types[i]);
+    total_size += sizes[i];
+  }
+  for (auto *t : params) {
+    auto dims = t->dims();
+    t->clear();
+    t->Resize(dims);
+  }
+  AllocParamsOnGPU(params, types, place);
+
+  ParamsUploader uploader(
+      place, std::max<size_t>(std::min(total_size, kMaxStagingSize), 1));
+  for (size_t i = 0; i < params.size(); ++i) {
+    if (sizes[i] == 0) continue;
+    uploader.Upload(cpu_params[i].data<void>(), params[i]->data<void>(),
+                    sizes[i]);
+  }
+  uploader.Wait();
+  VLOG(3) << "Upload " << params.size() << " params of " << total_size
+          << " bytes";
+}
+#endif
+
 void IrParamsSyncAmongDevicesPass::RunImpl(Argument *argument) {
   PADDLE_ENFORCE(argument->scope_valid());
   PADDLE_ENFORCE(argument->use_gpu_valid());
 
-  platform::Place place;
-
   // The parameters are on the cpu, therefore, synchronization is not necessary.
   if (!argument->use_gpu()) return;
 
@@ -41,7 +217,7 @@ void IrParamsSyncAmongDevicesPass::RunImpl(Argument *argument) {
   LOG(INFO) << "Sync params from CPU to GPU";
 
   PADDLE_ENFORCE(argument->gpu_device_id_valid());
-  place = platform::CUDAPlace(argument->gpu_device_id());
+  platform::CUDAPlace place(argument->gpu_device_id());
 
   auto *scope = argument->scope_ptr();
   std::vector<std::string> all_vars = scope->LocalVarNames();
@@ -49,6 +225,7 @@ void IrParamsSyncAmongDevicesPass::RunImpl(Argument *argument) {
   // We get all the vars from local_scope instead of the ProgramDesc.
   // Because there exists the case that new parameter variables are not added to
   // the program in the analysis pass.
+  std::vector<framework::LoDTensor *> params;
   for (auto &var_name : all_vars) {
     if (std::count(repetitive_params.begin(), repetitive_params.end(),
                    var_name)) {
@@ -60,21 +237,25 @@ void IrParamsSyncAmongDevicesPass::RunImpl(Argument *argument) {
     if (var->IsType<framework::LoDTensor>() ||
         var->IsType<framework::Tensor>()) {
       auto *t = var->GetMutable<framework::LoDTensor>();
-
-      platform::CPUPlace cpu_place;
-      framework::LoDTensor temp_tensor;
-      temp_tensor.Resize(t->dims());
-      temp_tensor.mutable_data<float>(cpu_place);
-
-      // Copy the parameter data to a tmp tensor.
-      TensorCopySync(*t, cpu_place, &temp_tensor);
-      // Reallocation the space on GPU
-      t->clear();
-
-      // Copy parameter data to newly allocated GPU space.
-      TensorCopySync(temp_tensor, place, t);
+      if (!t->IsInitialized() || !platform::is_cpu_place(t->place())) {
+        continue;
+      }
+      params.push_back(t);
     }
   }
+
+#ifdef PADDLE_WITH_CUDA
+  // The parameters are packed into the pinned memory and copied in large
+  // chunks, instead of a synchronous copy each.
+  UploadParams(params, place);
+#else
+  for (auto *t : params) {
+    framework::LoDTensor temp_tensor;
+    TensorCopySync(*t, platform::CPUPlace(), &temp_tensor);
+    t->clear();
+    TensorCopySync(temp_tensor, place, t);
+  }
+#endif
 }
 
 std::string IrParamsSyncAmongDevicesPass::repr() const {
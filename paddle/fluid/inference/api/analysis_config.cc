@@ -76,6 +76,18 @@ void AnalysisConfig::EnableUseGpu(uint64_t memory_pool_init_size_mb,
 
   Update();
 }
+void AnalysisConfig::SetGpuMemoryBudget(uint64_t budget_mb,
+                                        bool spill_to_host) {
+  gpu_memory_budget_mb_ = budget_mb;
+  gpu_memory_spill_to_host_ = spill_to_host;
+
+  Update();
+}
+void AnalysisConfig::EnableGpuMultiStream(bool x) {
+  gpu_multi_stream_ = x;
+
+  Update();
+}
 void AnalysisConfig::DisableGpu() {
   use_gpu_ = false;
 
@@ -104,10 +116,24 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   // GPU related.
   CP_MEMBER(use_gpu_);
   CP_MEMBER(use_cudnn_);
+  CP_MEMBER(use_nhwc_layout_);
   CP_MEMBER(device_id_);
   CP_MEMBER(memory_pool_init_size_mb_);
+  CP_MEMBER(gpu_memory_budget_mb_);
+  CP_MEMBER(gpu_memory_spill_to_host_);
+  CP_MEMBER(gpu_multi_stream_);
 
   CP_MEMBER(enable_memory_optim_);
+  CP_MEMBER(static_memory_plan_);
+  CP_MEMBER(memory_mapped_params_);
+  CP_MEMBER(cuda_graph_);
+  // fuse pass auto-tuning related.
+  CP_MEMBER(fuse_pass_auto_tune_);
+  CP_MEMBER(fuse_pass_tune_batch_size_);
+  CP_MEMBER(fuse_pass_tune_seq_len_);
+  CP_MEMBER(fuse_pass_tune_repeat_);
+  CP_MEMBER(optim_model_cache_);
+  CP_MEMBER(fuse_passes_tuned_off_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -122,21 +148,28 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(use_mkldnn_);
   CP_MEMBER(mkldnn_enabled_op_types_);
   CP_MEMBER(mkldnn_cache_capacity_);
+  CP_MEMBER(mkldnn_batch_buckets_);
   // Quantization related.
   CP_MEMBER(use_mkldnn_quantizer_);
   CP_MEMBER(mkldnn_quantizer_config_);
   CP_MEMBER(min_input_shape_);
   CP_MEMBER(max_input_shape_);
   CP_MEMBER(optim_input_shape_);
+  CP_MEMBER(extra_min_input_shapes_);
+  CP_MEMBER(extra_max_input_shapes_);
+  CP_MEMBER(extra_optim_input_shapes_);
   CP_MEMBER(disable_trt_plugin_fp16_);
+  CP_MEMBER(trt_engine_build_threads_);
 
   CP_MEMBER(use_lite_);
   CP_MEMBER(lite_precision_mode_);
   CP_MEMBER(lite_passes_filter_);
   CP_MEMBER(lite_ops_filter_);
+  CP_MEMBER(lite_zero_copy_);
 
   // profile related.
   CP_MEMBER(with_profile_);
+  CP_MEMBER(op_latency_stats_);
 
   // glog related.
   CP_MEMBER(with_glog_info_);
@@ -148,6 +181,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(specify_input_name_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(cpu_thread_partition_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -175,6 +209,17 @@ void AnalysisConfig::EnableCUDNN() {
   Update();
 }
 
+void AnalysisConfig::EnableNHWCLayout() {
+#ifdef PADDLE_WITH_CUDA
+  use_nhwc_layout_ = use_gpu_;
+#else
+  LOG(ERROR) << "Please compile with CUDA first to use NHWC layout";
+  use_nhwc_layout_ = false;
+#endif
+
+  Update();
+}
+
 void AnalysisConfig::EnableMKLDNN() {
 #ifdef PADDLE_WITH_MKLDNN
   use_mkldnn_ = true;
@@ -195,6 +240,28 @@ void AnalysisConfig::SetMkldnnCacheCapacity(int capacity) {
 #endif
 }
 
+void AnalysisConfig::SetMkldnnBatchBuckets(const std::vector<int> &buckets) {
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    PADDLE_ENFORCE_GT(buckets[i], 0,
+                      platform::errors::InvalidArgument(
+                          "The MKLDNN batch buckets should be positive, but "
+                          "got %d.",
+                          buckets[i]));
+    PADDLE_ENFORCE_EQ(i == 0 || buckets[i] > buckets[i - 1], true,
+                      platform::errors::InvalidArgument(
+                          "The MKLDNN batch buckets should be ascending, but "
+                          "got %d after %d.",
+                          buckets[i], i == 0 ? 0 : buckets[i - 1]));
+  }
+#ifdef PADDLE_WITH_MKLDNN
+  mkldnn_batch_buckets_ = buckets;
+#else
+  LOG(ERROR) << "Please compile with MKLDNN first to set MKLDNN batch buckets";
+  mkldnn_batch_buckets_.clear();
+#endif
+  Update();
+}
+
 void AnalysisConfig::EnableMkldnnQuantizer() {
 #ifdef PADDLE_WITH_MKLDNN
   if (!mkldnn_quantizer_config_)
@@ -260,6 +327,28 @@ void AnalysisConfig::SetTRTDynamicShapeInfo(
   disable_trt_plugin_fp16_ = disable_trt_plugin_fp16;
 }
 
+void AnalysisConfig::SetTRTEngineBuildThreads(int num_threads) {
+  PADDLE_ENFORCE_GE(num_threads, 1,
+                    platform::errors::InvalidArgument(
+                        "The number of the threads building the TensorRT "
+                        "engines should be at least 1, but received %d.",
+                        num_threads));
+  trt_engine_build_threads_ = num_threads;
+}
+
+void AnalysisConfig::AddTRTDynamicShapeProfile(
+    std::map<std::string, std::vector<int>> min_input_shape,
+    std::map<std::string, std::vector<int>> max_input_shape,
+    std::map<std::string, std::vector<int>> optim_input_shape) {
+  PADDLE_ENFORCE_EQ(min_input_shape_.empty(), false,
+                    platform::errors::PreconditionNotMet(
+                        "Please call SetTRTDynamicShapeInfo before adding "
+                        "the other TensorRT optimization profiles."));
+  extra_min_input_shapes_.push_back(min_input_shape);
+  extra_max_input_shapes_.push_back(max_input_shape);
+  extra_optim_input_shapes_.push_back(optim_input_shape);
+}
+
 // TODO(Superjomn) refactor this, buggy.
 void AnalysisConfig::Update() {
   auto info = SerializeInfoCache();
@@ -305,6 +394,17 @@ void AnalysisConfig::Update() {
 #endif
   }
 
+  if (use_gpu() && use_nhwc_layout_) {
+#ifdef PADDLE_WITH_CUDA
+    if (!enable_ir_optim_) {
+      LOG(ERROR)
+          << "EnableNHWCLayout() only works when IR optimization is enabled.";
+    } else {
+      pass_builder()->EnableNHWCLayout();
+    }
+#endif
+  }
+
   if (use_ngraph_) {
     if (!enable_ir_optim_) {
       LOG(ERROR)
@@ -377,8 +477,12 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << use_gpu_;
   ss << use_fc_padding_;
+  ss << use_nhwc_layout_;
   ss << device_id_;
   ss << memory_pool_init_size_mb_;
+  ss << gpu_memory_budget_mb_;
+  ss << gpu_memory_spill_to_host_;
+  ss << gpu_multi_stream_;
 
   ss << use_tensorrt_;
   ss << tensorrt_workspace_size_;
@@ -386,11 +490,21 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << tensorrt_min_subgraph_size_;
 
   ss << enable_memory_optim_;
+  ss << static_memory_plan_;
+  ss << memory_mapped_params_;
+  ss << cuda_graph_;
+
+  ss << fuse_pass_auto_tune_;
+  ss << fuse_pass_tune_batch_size_;
+  ss << fuse_pass_tune_seq_len_;
+  ss << fuse_pass_tune_repeat_;
+  ss << optim_model_cache_;
 
   ss << use_ngraph_;
 
   ss << use_mkldnn_;
   ss << mkldnn_cache_capacity_;
+  for (auto bucket : mkldnn_batch_buckets_) ss << bucket << ",";
   for (auto &item : mkldnn_enabled_op_types_) ss << item;
   ss << ";";
 
@@ -398,6 +512,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << model_from_memory_;
 
   ss << with_profile_;
+  ss << op_latency_stats_;
 
   ss << with_glog_info_;
 
@@ -407,8 +522,10 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  ss << cpu_thread_partition_;
 
   ss << use_lite_;
+  ss << lite_zero_copy_;
 
   return ss.str();
 }
@@ -420,6 +537,12 @@ void AnalysisConfig::SetCpuMathLibraryNumThreads(
   Update();
 }
 
+void AnalysisConfig::SetCpuThreadPartition(const std::string &spec) {
+  cpu_thread_partition_ = spec;
+
+  Update();
+}
+
 float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #ifdef PADDLE_WITH_CUDA
   // Get the GPU memory details and calculate the fraction of memory for the
@@ -445,6 +568,50 @@ bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
 
+void AnalysisConfig::EnableStaticMemoryPlan(bool x) {
+  static_memory_plan_ = x;
+  Update();
+}
+
+void AnalysisConfig::EnableMemoryMappedParams(bool x) {
+  memory_mapped_params_ = x;
+  Update();
+}
+
+void AnalysisConfig::EnableCUDAGraph(bool x) {
+  cuda_graph_ = x;
+  Update();
+}
+
+void AnalysisConfig::EnableFusePassAutoTune(int batch_size, int seq_len,
+                                            int repeat) {
+  PADDLE_ENFORCE_GT(batch_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The batch size to tune the fuse passes should be "
+                        "greater than 0, but received %d.",
+                        batch_size));
+  PADDLE_ENFORCE_GT(seq_len, 0,
+                    platform::errors::InvalidArgument(
+                        "The sequence length to tune the fuse passes should "
+                        "be greater than 0, but received %d.",
+                        seq_len));
+  PADDLE_ENFORCE_GT(repeat, 0,
+                    platform::errors::InvalidArgument(
+                        "The repeat times to tune the fuse passes should be "
+                        "greater than 0, but received %d.",
+                        repeat));
+  fuse_pass_auto_tune_ = true;
+  fuse_pass_tune_batch_size_ = batch_size;
+  fuse_pass_tune_seq_len_ = seq_len;
+  fuse_pass_tune_repeat_ = repeat;
+  Update();
+}
+
+void AnalysisConfig::EnableOptimModelCache(bool x) {
+  optim_model_cache_ = x;
+  Update();
+}
+
 void AnalysisConfig::SetModelBuffer(const char *prog_buffer,
                                     size_t prog_buffer_size,
                                     const char *param_buffer,
@@ -478,6 +645,11 @@ void AnalysisConfig::EnableProfile() {
   Update();
 }
 
+void AnalysisConfig::EnableOpLatencyStats(bool x) {
+  op_latency_stats_ = x;
+  Update();
+}
+
 void AnalysisConfig::DisableGlogInfo() {
   with_glog_info_ = false;
   Update();
@@ -486,11 +658,12 @@ void AnalysisConfig::DisableGlogInfo() {
 void AnalysisConfig::EnableLiteEngine(
     AnalysisConfig::Precision precision_mode,
     const std::vector<std::string> &passes_filter,
-    const std::vector<std::string> &ops_filter) {
+    const std::vector<std::string> &ops_filter, bool zero_copy) {
   use_lite_ = true;
   lite_precision_mode_ = precision_mode;
   lite_passes_filter_ = passes_filter;
   lite_ops_filter_ = ops_filter;
+  lite_zero_copy_ = zero_copy;
   Update();
 }
 
@@ -15,9 +15,14 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <cstdio>
+#include <map>
 #include <memory>
+#include <random>
 #include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -35,7 +40,9 @@
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
 #include "paddle/fluid/inference/utils/singleton.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/place.h"
@@ -69,6 +76,66 @@ bool IsPersistable(const framework::VarDesc *var) {
   }
   return false;
 }
+
+// Bind the thread running the predictor and its threads of the CPU math
+// library to the compute CPUs, which does nothing if the CPUs are not
+// partitioned or the threads are already bound.
+void BindCpuThreads() {
+  paddle::platform::BindThreadToCpuPool(paddle::platform::CpuPool::kCompute);
+  paddle::platform::BindOpenMPThreadsToCpuPool();
+}
+
+// Pad the batch of the inputs with zeros up to the smallest bucket not less
+// than it, and return the bucket, or -1 if the inputs are not padded, e.g.
+// they have LoD, different batch sizes, or a batch over all the buckets.
+int PadToBatchBucket(const std::vector<PaddleTensor> &inputs,
+                     const std::vector<int> &buckets,
+                     std::vector<PaddleTensor> *padded_inputs) {
+  if (inputs.empty()) return -1;
+  int batch = -1;
+  for (auto &input : inputs) {
+    if (!input.lod.empty() || input.shape.empty()) return -1;
+    if (batch >= 0 && input.shape[0] != batch) return -1;
+    batch = input.shape[0];
+  }
+  if (batch <= 0) return -1;
+  auto it = std::lower_bound(buckets.begin(), buckets.end(), batch);
+  if (it == buckets.end() || *it == batch) return -1;
+  int bucket = *it;
+
+  padded_inputs->resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto &input = inputs[i];
+    auto &padded = (*padded_inputs)[i];
+    padded.name = input.name;
+    padded.dtype = input.dtype;
+    padded.shape = input.shape;
+    padded.shape[0] = bucket;
+    size_t length = input.data.length();
+    size_t padded_length = length / batch * bucket;
+    padded.data.Resize(padded_length);
+    std::memcpy(padded.data.data(), input.data.data(), length);
+    std::memset(static_cast<char *>(padded.data.data()) + length, 0,
+                padded_length - length);
+  }
+  return bucket;
+}
+
+// Trim the padded rows of the outputs of the batch padded to bucket.
+void TrimBatchBucket(int batch, int bucket,
+                     std::vector<PaddleTensor> *outputs) {
+  for (auto &output : *outputs) {
+    if (!output.lod.empty() || output.shape.empty() ||
+        output.shape[0] != bucket) {
+      continue;
+    }
+    size_t length = output.data.length() / bucket * batch;
+    PaddleBuf data(length);
+    std::memcpy(data.data(), output.data.data(), length);
+    output.data = std::move(data);
+    output.shape[0] = batch;
+  }
+}
 }  // namespace
 
 bool PaddleTensorToLoDTensor(const PaddleTensor &pt, framework::LoDTensor *t,
@@ -138,6 +205,9 @@ bool AnalysisPredictor::Init(
 
   // no matter with or without MKLDNN
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  if (!config_.cpu_thread_partition().empty()) {
+    paddle::platform::SetCpuThreadPartition(config_.cpu_thread_partition());
+  }
 
   if (!PrepareScope(parent_scope)) {
     return false;
@@ -145,6 +215,9 @@ bool AnalysisPredictor::Init(
   if (!CreateExecutor()) {
     return false;
   }
+  // the parameters loaded are in the GPU memory budget too
+  memory::allocation::AllocationContextGuard allocation_context_guard(
+      allocation_context_.get());
   if (!PrepareProgram(program)) {
     return false;
   }
@@ -197,7 +270,13 @@ bool AnalysisPredictor::PrepareProgram(
     // if enable_ir_optim_ is false,
     // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc) will
     // not be executed.
-    OptimizeInferenceProgram();
+    std::string cache_dir = OptimModelCacheDir();
+    if (cache_dir.empty() || !LoadOptimModelCache(cache_dir)) {
+      OptimizeInferenceProgram();
+      if (!cache_dir.empty()) {
+        SaveOptimModelCache(cache_dir);
+      }
+    }
   } else {
     // If the program is passed from external, no need to optimize it, this
     // logic is used in the clone scenario.
@@ -212,6 +291,25 @@ bool AnalysisPredictor::CreateExecutor() {
   if (config_.use_gpu_) {
     status_use_gpu_ = true;
     place_ = paddle::platform::CUDAPlace(config_.device_id_);
+    if (config_.gpu_memory_budget_mb_ > 0) {
+      allocation_context_ =
+          memory::allocation::AllocatorFacade::Instance()
+              .CreateAllocationContext(place_,
+                                       config_.gpu_memory_budget_mb_ << 20,
+                                       config_.gpu_memory_spill_to_host_);
+    }
+#ifdef PADDLE_WITH_CUDA
+    if (config_.gpu_multi_stream_) {
+      stream_context_.reset(new platform::CUDAContext(
+          boost::get<platform::CUDAPlace>(place_)));
+      // nested in the GPU memory budget
+      memory::allocation::AllocationContextGuard allocation_context_guard(
+          allocation_context_.get());
+      stream_allocation_context_ =
+          memory::allocation::AllocatorFacade::Instance()
+              .CreateStreamAllocationContext(place_, stream_context_->Stream());
+    }
+#endif
   } else {
     place_ = paddle::platform::CPUPlace();
   }
@@ -221,6 +319,23 @@ bool AnalysisPredictor::CreateExecutor() {
 bool AnalysisPredictor::PrepareExecutor() {
   executor_->Prepare(sub_scope_, *inference_program_, 0,
                      config_.use_feed_fetch_ops_);
+  if (config_.static_memory_plan_) {
+    // the fetch targets are read after the run, e.g. by the zero copy
+    // tensors without the fetch ops
+    std::vector<std::string> output_names;
+    for (auto *op : inference_program_->Block(0).AllOps()) {
+      if (op->Type() == "fetch") {
+        output_names.push_back(op->Input("X")[0]);
+      }
+    }
+    executor_->EnableStaticMemoryPlan(true, output_names);
+  }
+  if (config_.cuda_graph_) {
+    executor_->EnableCUDAGraph();
+  }
+  if (config_.op_latency_stats_) {
+    executor_->EnableOpLatencyStats();
+  }
 
   PADDLE_ENFORCE_NOT_NULL(sub_scope_);
 
@@ -232,12 +347,18 @@ void AnalysisPredictor::MkldnnPreSet(const std::vector<PaddleTensor> &inputs) {
   VLOG(2) << "AnalysisPredictor::Run get_cur_mkldnn_session_id="
           << platform::get_cur_mkldnn_session_id();
   // In cache clearing mode.
-  if (config_.mkldnn_cache_capacity_ > 0) {
+  if (config_.mkldnn_cache_capacity_ > 0 ||
+      !config_.mkldnn_batch_buckets_.empty()) {
     VLOG(2) << "In mkldnn cache clear mode.";
     platform::set_cur_mkldnn_session_id(
         platform::kMKLDNNSessionID_CacheClearing);
-    platform::set_cur_input_shape_cache_capacity(
-        config_.mkldnn_cache_capacity_);
+    // Keep the primitives of all the batch buckets and an unbucketed shape.
+    int capacity = config_.mkldnn_cache_capacity_;
+    int bucket_num = config_.mkldnn_batch_buckets_.size();
+    if (bucket_num > 0) {
+      capacity = std::max(capacity, bucket_num + 1);
+    }
+    platform::set_cur_input_shape_cache_capacity(capacity);
     // Set current_input_shape for caching dynamic shape.
     std::stringstream ss;
     for (size_t i = 0; i < inputs.size(); ++i) {
@@ -254,7 +375,8 @@ void AnalysisPredictor::MkldnnPreSet(const std::vector<PaddleTensor> &inputs) {
 void AnalysisPredictor::MkldnnPostReset() {
 #ifdef PADDLE_WITH_MKLDNN
   // In cache clearing mode.
-  if (config_.mkldnn_cache_capacity_ > 0) {
+  if (config_.mkldnn_cache_capacity_ > 0 ||
+      !config_.mkldnn_batch_buckets_.empty()) {
     paddle::platform::set_cur_mkldnn_session_id(
         platform::kMKLDNNSessionID_Default);
     platform::set_cur_input_shape_cache_capacity(0);
@@ -267,16 +389,30 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  BindCpuThreads();
+  const std::vector<PaddleTensor> *feed_inputs = &inputs;
+  std::vector<PaddleTensor> padded_inputs;
+  int batch_bucket = -1;
+  if (config_.use_mkldnn_ && !config_.mkldnn_batch_buckets_.empty()) {
+    batch_bucket = PadToBatchBucket(inputs, config_.mkldnn_batch_buckets_,
+                                    &padded_inputs);
+    if (batch_bucket > 0) feed_inputs = &padded_inputs;
+  }
 #ifdef PADDLE_WITH_MKLDNN
-  if (config_.use_mkldnn_) MkldnnPreSet(inputs);
+  if (config_.use_mkldnn_) MkldnnPreSet(*feed_inputs);
 #endif
   VLOG(3) << "Predictor::predict";
   inference::Timer timer;
   timer.tic();
+  memory::allocation::AllocationContextGuard allocation_context_guard(
+      RunAllocationContext());
+#ifdef PADDLE_WITH_CUDA
+  platform::CUDAThreadContextGuard stream_guard(&stream_context_);
+#endif
   // set feed variable
   framework::Scope *scope = sub_scope_ ? sub_scope_ : scope_.get();
   PADDLE_ENFORCE_NOT_NULL(scope, "The scope should not be nullptr.");
-  if (!SetFeed(inputs, scope)) {
+  if (!SetFeed(*feed_inputs, scope)) {
     LOG(ERROR) << "fail to set feed";
     return false;
   }
@@ -290,6 +426,9 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
     LOG(ERROR) << "fail to get fetches";
     return false;
   }
+  if (batch_bucket > 0) {
+    TrimBatchBucket(inputs[0].shape[0], batch_bucket, output_data);
+  }
 
   VLOG(3) << "predict cost: " << timer.toc() << "ms";
 
@@ -400,6 +539,7 @@ void AnalysisPredictor::PrepareArgument() {
   argument_.SetEnableAnalysisOptim(config_.enable_ir_optim_);
   argument_.SetEnableMemoryOptim(config_.enable_memory_optim());
   argument_.SetModelFromMemory(config_.model_from_memory_);
+  argument_.SetMemoryMappedParams(config_.memory_mapped_params_);
   // Analyze inference_program
   argument_.SetPredictorID(predictor_id_);
   argument_.SetOptimCacheDir(config_.opt_cache_dir_);
@@ -428,13 +568,18 @@ void AnalysisPredictor::PrepareArgument() {
     argument_.SetMinInputShape(config_.min_input_shape_);
     argument_.SetMaxInputShape(config_.max_input_shape_);
     argument_.SetOptimInputShape(config_.optim_input_shape_);
+    argument_.SetExtraMinInputShapes(config_.extra_min_input_shapes_);
+    argument_.SetExtraMaxInputShapes(config_.extra_max_input_shapes_);
+    argument_.SetExtraOptimInputShapes(config_.extra_optim_input_shapes_);
     argument_.SetCloseTrtPluginFp16(config_.disable_trt_plugin_fp16_);
+    argument_.SetTensorRtBuildThreads(config_.trt_engine_build_threads_);
   }
 
   if (config_.lite_engine_enabled()) {
     argument_.SetLitePrecisionMode(config_.lite_precision_mode_);
     argument_.SetLitePassesFilter(config_.lite_passes_filter_);
     argument_.SetLiteOpsFilter(config_.lite_ops_filter_);
+    argument_.SetLiteZeroCopy(config_.lite_zero_copy_);
     LOG(INFO) << "Lite subgraph engine is enabled";
   }
 
@@ -518,7 +663,14 @@ std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<
     }
   }
 
-  std::unique_ptr<PaddlePredictor> predictor(new AnalysisPredictor(config));
+  std::unique_ptr<PaddlePredictor> predictor;
+  if (config.fuse_pass_auto_tune_enabled() && config.ir_optim()) {
+    AnalysisConfig tuned_config(config);
+    AnalysisPredictor::TuneFusePasses(&tuned_config);
+    predictor.reset(new AnalysisPredictor(tuned_config));
+  } else {
+    predictor.reset(new AnalysisPredictor(config));
+  }
   // Each config can only be used for one predictor.
   config.SetInValid();
   auto predictor_p = dynamic_cast<AnalysisPredictor *>(predictor.get());
@@ -534,6 +686,227 @@ std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<
   return predictor;
 }
 
+namespace {
+
+constexpr char kFusePassTuneFile[] = "fuse_pass_tune_result";
+// A fuse pass is only turned off if the model runs faster by this ratio
+// without it, so that the noise of the timing does not flip the decisions.
+constexpr double kFusePassTuneMinGain = 0.03;
+
+bool IsFusePass(const std::string &pass) {
+  return pass.find("fuse_pass") != std::string::npos;
+}
+
+// The tuning result is only reused for the same device and inputs.
+std::string FusePassTuneKey(const AnalysisConfig &config) {
+  std::stringstream ss;
+  ss << (config.use_gpu() ? "gpu" : "cpu")
+     << " batch_size=" << config.fuse_pass_tune_batch_size()
+     << " seq_len=" << config.fuse_pass_tune_seq_len();
+  return ss.str();
+}
+
+std::string FusePassTuneFile(const AnalysisConfig &config) {
+  std::string dir;
+  if (!config.opt_cache_dir().empty()) {
+    dir = config.opt_cache_dir();
+  } else if (!config.model_dir().empty()) {
+    dir = config.model_dir();
+  } else if (!config.model_from_memory() && !config.prog_file().empty()) {
+    dir = inference::analysis::GetDirRoot(config.prog_file());
+  }
+  return dir.empty() ? "" : dir + "/" + kFusePassTuneFile;
+}
+
+// The file holds the key at the first line, and a pass turned off per line.
+bool LoadFusePassTuneResult(const std::string &path, const std::string &key,
+                            std::vector<std::string> *passes) {
+  std::ifstream fin(path);
+  std::string line;
+  if (!fin.is_open() || !std::getline(fin, line) || line != key) {
+    return false;
+  }
+  passes->clear();
+  while (std::getline(fin, line)) {
+    if (!line.empty()) {
+      passes->push_back(line);
+    }
+  }
+  return true;
+}
+
+void SaveFusePassTuneResult(const std::string &path, const std::string &key,
+                            const std::vector<std::string> &passes) {
+  std::ofstream fout(path);
+  if (!fout.is_open()) {
+    LOG(WARNING) << "Cannot save the result of tuning the fuse passes to "
+                 << path;
+    return;
+  }
+  fout << key << "\n";
+  for (auto &pass : passes) {
+    fout << pass << "\n";
+  }
+}
+
+// The zero inputs of the feed ops in program, whose unknown dims are
+// batch_size for the first one, or batch_size * seq_len for the LoD inputs,
+// and 1 for the others.
+bool MakeFusePassTuneInputs(const framework::ProgramDesc &program,
+                            int batch_size, int seq_len,
+                            std::vector<PaddleTensor> *inputs) {
+  const framework::BlockDesc &block = program.Block(0);
+  std::map<int, PaddleTensor> feeds;
+  for (auto *op : block.AllOps()) {
+    if (op->Type() != "feed") {
+      continue;
+    }
+    auto *var = block.FindVar(op->Output("Out")[0]);
+    if (var == nullptr || var->GetLoDLevel() > 1) {
+      return false;
+    }
+    PaddleTensor tensor;
+    tensor.name = var->Name();
+    bool has_lod = var->GetLoDLevel() == 1;
+    auto shape = var->GetShape();
+    size_t numel = 1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+      int64_t dim = shape[i];
+      if (dim < 0) {
+        dim = i > 0 ? 1 : (has_lod ? batch_size * seq_len : batch_size);
+      }
+      tensor.shape.push_back(static_cast<int>(dim));
+      numel *= static_cast<size_t>(dim);
+    }
+    if (has_lod) {
+      std::vector<size_t> level;
+      for (int i = 0; i <= batch_size; ++i) {
+        level.push_back(static_cast<size_t>(i * seq_len));
+      }
+      tensor.lod.push_back(level);
+    }
+    size_t size_of_type = 0;
+    switch (var->GetDataType()) {
+      case framework::proto::VarType::FP32:
+        tensor.dtype = PaddleDType::FLOAT32;
+        size_of_type = sizeof(float);
+        break;
+      case framework::proto::VarType::INT64:
+        tensor.dtype = PaddleDType::INT64;
+        size_of_type = sizeof(int64_t);
+        break;
+      case framework::proto::VarType::INT32:
+        tensor.dtype = PaddleDType::INT32;
+        size_of_type = sizeof(int32_t);
+        break;
+      default:
+        return false;
+    }
+    tensor.data.Resize(numel * size_of_type);
+    std::memset(tensor.data.data(), 0, tensor.data.length());
+    feeds[boost::get<int>(op->GetAttr("col"))] = std::move(tensor);
+  }
+  inputs->clear();
+  for (auto &pair : feeds) {
+    inputs->push_back(std::move(pair.second));
+  }
+  return !inputs->empty();
+}
+
+}  // namespace
+
+double AnalysisPredictor::BenchmarkFusePasses(const AnalysisConfig &config,
+                                              std::string *program) {
+  AnalysisConfig trial_config(config);
+  trial_config.SwitchUseFeedFetchOps(true);
+  trial_config.with_profile_ = false;
+  trial_config.with_glog_info_ = false;
+  trial_config.optim_model_cache_ = false;
+  try {
+    AnalysisPredictor predictor(trial_config);
+    if (!predictor.Init(nullptr)) {
+      return -1;
+    }
+    *program = predictor.GetSerializedProgram();
+
+    std::vector<PaddleTensor> inputs, outputs;
+    if (!MakeFusePassTuneInputs(predictor.program(),
+                                config.fuse_pass_tune_batch_size(),
+                                config.fuse_pass_tune_seq_len(), &inputs)) {
+      return -1;
+    }
+    // warm up, e.g. the allocations and the caches of the kernels
+    for (int i = 0; i < 2; ++i) {
+      if (!predictor.Run(inputs, &outputs)) {
+        return -1;
+      }
+    }
+    inference::Timer timer;
+    timer.tic();
+    for (int i = 0; i < config.fuse_pass_tune_repeat(); ++i) {
+      if (!predictor.Run(inputs, &outputs)) {
+        return -1;
+      }
+    }
+    return timer.toc() / config.fuse_pass_tune_repeat();
+  } catch (const std::exception &e) {
+    VLOG(3) << "Cannot benchmark the model: " << e.what();
+    return -1;
+  }
+}
+
+void AnalysisPredictor::TuneFusePasses(AnalysisConfig *config) {
+  std::string path = FusePassTuneFile(*config);
+  std::string key = FusePassTuneKey(*config);
+  std::vector<std::string> off_passes;
+  if (!path.empty() && LoadFusePassTuneResult(path, key, &off_passes)) {
+    LOG(INFO) << "Load the fuse passes turned off from " << path;
+    for (auto &pass : off_passes) {
+      config->pass_builder()->DeletePass(pass);
+    }
+    config->fuse_passes_tuned_off_ = off_passes;
+    return;
+  }
+
+  std::string best_program;
+  double best_ms = BenchmarkFusePasses(*config, &best_program);
+  if (best_ms < 0) {
+    LOG(WARNING) << "Cannot run the model on the zero inputs, skip tuning "
+                    "the fuse passes.";
+    return;
+  }
+  // Try turning off the fuse passes one by one, so that the later ones are
+  // timed with the earlier decisions.
+  std::vector<std::string> passes = config->pass_builder()->AllPasses();
+  for (auto &pass : passes) {
+    if (!IsFusePass(pass)) {
+      continue;
+    }
+    AnalysisConfig trial_config(*config);
+    trial_config.pass_builder()->DeletePass(pass);
+    std::string program;
+    double ms = BenchmarkFusePasses(trial_config, &program);
+    // skip the passes changing nothing of the model
+    if (ms < 0 || program == best_program) {
+      continue;
+    }
+    LOG(INFO) << "Tune " << pass << ": " << best_ms << " ms with it, " << ms
+              << " ms without it";
+    if (ms < best_ms * (1 - kFusePassTuneMinGain)) {
+      config->pass_builder()->DeletePass(pass);
+      off_passes.push_back(pass);
+      best_ms = ms;
+      best_program = program;
+    }
+  }
+  LOG(INFO) << "Turn off " << off_passes.size()
+            << " fuse passes by auto-tuning";
+  config->fuse_passes_tuned_off_ = off_passes;
+  if (!path.empty()) {
+    SaveFusePassTuneResult(path, key, off_passes);
+  }
+}
+
 bool AnalysisPredictor::MkldnnQuantize() {
 #if PADDLE_WITH_MKLDNN
   if (!mkldnn_quantizer_)
@@ -617,6 +990,11 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
   } else {
     auto gpu_place = boost::get<platform::CUDAPlace>(place_);
     res->SetPlace(PaddlePlace::kGPU, gpu_place.GetDeviceId());
+#ifdef PADDLE_WITH_CUDA
+    if (stream_context_) {
+      res->stream_ = stream_context_->Stream();
+    }
+#endif
   }
 
   return res;
@@ -634,12 +1012,23 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
   } else {
     auto gpu_place = boost::get<platform::CUDAPlace>(place_);
     res->SetPlace(PaddlePlace::kGPU, gpu_place.GetDeviceId());
+#ifdef PADDLE_WITH_CUDA
+    if (stream_context_) {
+      res->stream_ = stream_context_->Stream();
+    }
+#endif
   }
   return res;
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  BindCpuThreads();
+  memory::allocation::AllocationContextGuard allocation_context_guard(
+      RunAllocationContext());
+#ifdef PADDLE_WITH_CUDA
+  platform::CUDAThreadContextGuard stream_guard(&stream_context_);
+#endif
   executor_->Run();
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
@@ -651,6 +1040,40 @@ bool AnalysisPredictor::ZeroCopyRun() {
   return true;
 }
 
+bool AnalysisPredictor::ZeroCopyRunAsync(std::function<void(bool)> callback) {
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place_)) {
+    platform::CUDAThreadContextGuard stream_guard(&stream_context_);
+    if (!ZeroCopyRun()) {
+      callback(false);
+      return false;
+    }
+    // The kernels of the clones are queued on the same stream unless they
+    // own streams, then the callbacks are called in the order of the runs.
+    auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+        platform::DeviceContextPool::Instance().Get(place_));
+    dev_ctx->AddStreamCallback([callback] { callback(true); });
+    return true;
+  }
+#endif
+  return PaddlePredictor::ZeroCopyRunAsync(std::move(callback));
+}
+
+std::map<std::string, OpLatencyStats> AnalysisPredictor::GetOpLatencyStats() {
+  std::map<std::string, OpLatencyStats> stats;
+  for (auto &item : executor_->op_latency_histograms()) {
+    auto &histogram = *item.second;
+    auto &op_stats = stats[item.first];
+    op_stats.count = histogram.Count();
+    op_stats.mean_us = histogram.MeanNs() / 1000;
+    op_stats.p50_us = histogram.QuantileNs(0.5) / 1000;
+    op_stats.p90_us = histogram.QuantileNs(0.9) / 1000;
+    op_stats.p99_us = histogram.QuantileNs(0.99) / 1000;
+    op_stats.max_us = histogram.MaxNs() / 1000.0;
+  }
+  return stats;
+}
+
 bool AnalysisPredictor::LoadProgramDesc() {
   // Initialize the inference program
   std::string filename;
@@ -673,8 +1096,8 @@ bool AnalysisPredictor::LoadProgramDesc() {
     return false;
   }
 
-  // Create ProgramDesc
-  framework::proto::ProgramDesc proto;
+  // Create ProgramDesc, which is parsed on the arena of the ProgramDesc
+  // rather than copied from a proto parsed.
   if (!config_.model_from_memory()) {
     std::string pb_content;
     // Read binary
@@ -687,11 +1110,10 @@ bool AnalysisPredictor::LoadProgramDesc() {
     fin.read(&(pb_content.at(0)), pb_content.size());
     fin.close();
 
-    proto.ParseFromString(pb_content);
+    inference_program_.reset(new framework::ProgramDesc(pb_content));
   } else {
-    proto.ParseFromString(config_.prog_file());
+    inference_program_.reset(new framework::ProgramDesc(config_.prog_file()));
   }
-  inference_program_.reset(new framework::ProgramDesc(proto));
   return true;
 }
 
@@ -727,6 +1149,7 @@ bool AnalysisPredictor::LoadParameters() {
         op->SetType("load");
         op->SetOutput("Out", {new_var->Name()});
         op->SetAttr("file_path", {config_.model_dir() + "/" + new_var->Name()});
+        op->SetAttr("use_mmap", config_.memory_mapped_params_);
         op->CheckAttrs();
       }
     }
@@ -740,6 +1163,7 @@ bool AnalysisPredictor::LoadParameters() {
     op->SetType("load_combine");
     op->SetOutput("Out", params);
     op->SetAttr("file_path", {config_.params_file()});
+    op->SetAttr("use_mmap", config_.memory_mapped_params_);
     op->CheckAttrs();
   }
 
@@ -806,6 +1230,13 @@ bool AnalysisPredictor::SaveTrtCalibToDisk() {
 #endif
 
 AnalysisPredictor::~AnalysisPredictor() {
+#ifdef PADDLE_WITH_CUDA
+  // the work queued on the stream of the predictor may use its scope
+  if (stream_context_) {
+    stream_context_->Wait();
+    stream_context_->WaitStreamCallback();
+  }
+#endif
 #if PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled() &&
       config_.tensorrt_precision_mode_ == AnalysisConfig::Precision::kInt8 &&
@@ -910,6 +1341,182 @@ void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
   platform::CPUPlace place;
   framework::Executor exe(place);
   exe.Run(save_program, scope(), 0, true, true);
+
+  if (config_.fuse_pass_auto_tune_enabled()) {
+    SaveFusePassTuneResult(dir + "/" + kFusePassTuneFile,
+                           FusePassTuneKey(config_),
+                           config_.fuse_passes_tuned_off_);
+  }
+}
+
+namespace {
+
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+
+// FNV-1a, which keeps the same across the processes and the builds.
+uint64_t HashBytes(const char *data, size_t size, uint64_t hash) {
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t HashString(const std::string &str, uint64_t hash) {
+  // the size separates the successive strings
+  uint64_t size = str.size();
+  hash = HashBytes(reinterpret_cast<const char *>(&size), sizeof(size), hash);
+  return HashBytes(str.data(), str.size(), hash);
+}
+
+uint64_t HashFile(const std::string &path, uint64_t hash) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      fin.is_open(), true,
+      platform::errors::NotFound("Cannot open file %s to hash.", path));
+  std::vector<char> buffer(1 << 20);
+  while (fin) {
+    fin.read(buffer.data(), buffer.size());
+    hash = HashBytes(buffer.data(), fin.gcount(), hash);
+  }
+  return hash;
+}
+
+std::vector<std::string> PersistableNames(const framework::BlockDesc &block) {
+  std::vector<std::string> names;
+  for (auto *var : block.AllVars()) {
+    if (IsPersistable(var)) {
+      names.push_back(var->Name());
+    }
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+}  // namespace
+
+std::string AnalysisPredictor::OptimModelCacheDir() {
+  if (!config_.optim_model_cache_enabled() || !config_.ir_optim()) {
+    return "";
+  }
+  if (config_.model_from_memory() || config_.tensorrt_engine_enabled() ||
+      config_.lite_engine_enabled() || config_.mkldnn_quantizer_enabled()) {
+    LOG(WARNING) << "The optimized model is not cached for the models from "
+                    "memory, or with TensorRT, Lite or the MKLDNN quantizer.";
+    return "";
+  }
+
+  uint64_t hash = HashString(get_version(), kFnvOffsetBasis);
+  hash = HashString(config_.SerializeInfoCache(), hash);
+  for (auto &pass : config_.pass_builder()->AllPasses()) {
+    hash = HashString(pass, hash);
+  }
+  hash = HashString(inference_program_->Proto()->SerializeAsString(), hash);
+  if (!config_.params_file().empty()) {
+    hash = HashFile(config_.params_file(), hash);
+  } else {
+    for (auto &name : PersistableNames(inference_program_->Block(0))) {
+      hash = HashFile(config_.model_dir() + "/" + name, hash);
+    }
+  }
+
+  std::string root = config_.opt_cache_dir();
+  if (root.empty()) {
+    root = inference::analysis::GetOrCreateModelOptCacheDir(
+        config_.model_dir().empty()
+            ? inference::analysis::GetDirRoot(config_.prog_file())
+            : config_.model_dir());
+  }
+  std::stringstream ss;
+  ss << root << "/optim_model_" << std::hex << hash;
+  return ss.str();
+}
+
+bool AnalysisPredictor::LoadOptimModelCache(const std::string &dir) {
+  std::ifstream fin(dir + "/model", std::ios::in | std::ios::binary);
+  if (!fin.is_open()) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << fin.rdbuf();
+  framework::proto::ProgramDesc proto;
+  if (!proto.ParseFromString(buffer.str())) {
+    LOG(WARNING) << "Cannot parse the optimized model cached in " << dir;
+    return false;
+  }
+  std::shared_ptr<framework::ProgramDesc> program(
+      new framework::ProgramDesc(proto));
+
+  framework::ProgramDesc load_program;
+  auto *load_block = load_program.MutableBlock(0);
+  auto params = PersistableNames(program->Block(0));
+  for (auto &name : params) {
+    auto *var = program->Block(0).FindVar(name);
+    auto *new_var = load_block->Var(name);
+    new_var->SetShape(var->GetShape());
+    new_var->SetDataType(var->GetDataType());
+    new_var->SetType(var->GetType());
+    new_var->SetLoDLevel(var->GetLoDLevel());
+    new_var->SetPersistable(true);
+  }
+  auto *op = load_block->AppendOp();
+  op->SetType("load_combine");
+  op->SetOutput("Out", params);
+  op->SetAttr("file_path", dir + "/params");
+  op->SetAttr("use_mmap", config_.memory_mapped_params_);
+  op->CheckAttrs();
+
+  // The parameters of a cache being written by another process may be
+  // incomplete, then the model is optimized again.
+  try {
+    executor_->CreateVariables(*program, 0, true, sub_scope_);
+    framework::NaiveExecutor e(place_);
+    e.Prepare(scope_.get(), load_program, 0, false);
+    e.Run();
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Cannot load the optimized model cached in " << dir
+                 << ": " << e.what();
+    return false;
+  }
+  inference_program_ = program;
+  config_.PartiallyRelease();
+  LOG(INFO) << "Load the optimized model cached in " << dir;
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimModelCache(const std::string &dir) {
+  if (!inference::analysis::PathExists(dir) && MKDIR(dir.c_str()) == -1 &&
+      !inference::analysis::PathExists(dir)) {
+    LOG(WARNING) << "Cannot create the directory " << dir
+                 << " to cache the optimized model.";
+    return;
+  }
+  // Save to a directory of this predictor first, then move the parameters
+  // and the program into the cache, so that the other processes never see
+  // a partial program.
+  std::stringstream ss;
+  ss << dir << "/tmp_" << std::hex << std::random_device()();
+  std::string tmp_dir = ss.str();
+  if (MKDIR(tmp_dir.c_str()) == -1) {
+    LOG(WARNING) << "Cannot create the directory " << tmp_dir
+                 << " to cache the optimized model.";
+    return;
+  }
+  SaveOptimModel(tmp_dir);
+  bool saved = true;
+  for (const char *file : {"params", "model"}) {
+    std::string tmp_file = tmp_dir + "/" + file;
+    // the renaming fails on Windows if another process has cached it
+    if (std::rename(tmp_file.c_str(), (dir + "/" + file).c_str()) != 0) {
+      std::remove(tmp_file.c_str());
+      saved = false;
+    }
+  }
+  std::remove((tmp_dir + "/" + kFusePassTuneFile).c_str());
+  RMDIR(tmp_dir.c_str());
+  if (saved) {
+    LOG(INFO) << "Cache the optimized model in " << dir;
+  }
 }
 
 template <>
@@ -954,4 +1561,5 @@ USE_TRT_CONVERTER(gelu);
 USE_TRT_CONVERTER(multihead_matmul);
 USE_TRT_CONVERTER(fused_embedding_eltwise_layernorm);
 USE_TRT_CONVERTER(skip_layernorm);
+USE_TRT_CONVERTER(slice);
 #endif
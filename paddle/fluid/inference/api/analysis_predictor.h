@@ -25,6 +25,8 @@
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/memory/allocation/budget_allocator.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/string/printf.h"
 #ifdef PADDLE_WITH_TESTING
 #include <gtest/gtest.h>
@@ -163,6 +165,23 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool ZeroCopyRun() override;
+  ///
+  /// \brief Run the prediction engine without waiting for the GPU, see
+  /// PaddlePredictor::ZeroCopyRunAsync
+  ///
+  /// \param[in] callback called with whether the run succeeds after it
+  /// finishes
+  /// \return Whether the run is queued
+  ///
+  bool ZeroCopyRunAsync(std::function<void(bool)> callback) override;
+
+  ///
+  /// \brief Get the latency stats of the ops, see
+  /// PaddlePredictor::GetOpLatencyStats
+  ///
+  /// \return the latency stats by the op types and the subgraph engines
+  ///
+  std::map<std::string, OpLatencyStats> GetOpLatencyStats() override;
 
   ///
   /// \brief Create feed fetch variables
@@ -233,6 +252,15 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   void SaveOptimModel(const std::string &dir);
 
+  ///
+  /// \brief Turn off the fuse passes of config making the model slower on
+  /// the device, or the ones saved by a previous tuning of the same device
+  /// and inputs, see AnalysisConfig::EnableFusePassAutoTune
+  ///
+  /// \param[in] config the config with the fuse pass auto-tuning enabled
+  ///
+  static void TuneFusePasses(AnalysisConfig *config);
+
  protected:
   ///
   /// \brief Prepare predictor's required programs, including loading model
@@ -274,6 +302,40 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool LoadParameters();
+  ///
+  /// \brief Get the directory caching the optimized model of the config,
+  /// see AnalysisConfig::EnableOptimModelCache
+  ///
+  /// \return the cache directory, or empty if the model is not cached
+  ///
+  std::string OptimModelCacheDir();
+  ///
+  /// \brief Load the optimized program and parameters cached.
+  ///
+  /// \param[in] dir the cache directory
+  /// \return Whether the cache is hit
+  ///
+  bool LoadOptimModelCache(const std::string &dir);
+  ///
+  /// \brief Save the optimized program and parameters to the cache.
+  ///
+  /// \param[in] dir the cache directory
+  ///
+  void SaveOptimModelCache(const std::string &dir);
+  ///
+  /// \brief Get the allocation context of the runs
+  ///
+  /// \return the context in the stream of the predictor if it owns one, or
+  /// the context of the GPU memory budget, or nullptr
+  ///
+  memory::allocation::AllocationContext *RunAllocationContext() const {
+#ifdef PADDLE_WITH_CUDA
+    if (stream_allocation_context_) {
+      return stream_allocation_context_.get();
+    }
+#endif
+    return allocation_context_.get();
+  }
 
   ///
   /// \brief Prepare input data, only used in Run()
@@ -344,12 +406,27 @@ class AnalysisPredictor : public PaddlePredictor {
   bool SaveTrtCalibToDisk();
 #endif
 
+  ///
+  /// \brief Time the model optimized by config on the zero inputs for the
+  /// fuse pass auto-tuning
+  ///
+  /// \param[in] config the config to optimize the model
+  /// \param[out] program the serialized program optimized
+  /// \return the average latency in ms, or a negative value if the model
+  /// cannot run on the zero inputs
+  ///
+  static double BenchmarkFusePasses(const AnalysisConfig &config,
+                                    std::string *program);
+
 // Some more detailed tests, they are made the friends of the predictor, so that
 // the all the details can be tested.
 #if PADDLE_WITH_TESTING
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, gpu_memory_budget);
+  FRIEND_TEST(AnalysisPredictor, gpu_multi_stream);
+  FRIEND_TEST(AnalysisPredictor, optim_model_cache);
 #endif
 
  private:
@@ -357,6 +434,16 @@ class AnalysisPredictor : public PaddlePredictor {
   Argument argument_;
   std::unique_ptr<NaiveExecutor> executor_;
   platform::Place place_;
+  // limits the GPU memory allocated by the predictor, nullptr if there is
+  // no GPU memory budget
+  std::shared_ptr<memory::allocation::AllocationContext> allocation_context_;
+#ifdef PADDLE_WITH_CUDA
+  // the stream and the handles of the predictor, and the allocation context
+  // in the stream, nullptr unless AnalysisConfig::EnableGpuMultiStream
+  std::unique_ptr<platform::CUDAContext> stream_context_;
+  std::shared_ptr<memory::allocation::AllocationContext>
+      stream_allocation_context_;
+#endif
   std::shared_ptr<framework::Scope> scope_;
   framework::Scope *sub_scope_{nullptr};
   std::shared_ptr<framework::ProgramDesc> inference_program_;
@@ -15,9 +15,16 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>  // NOLINT
+#include <numeric>
 #include <thread>  // NOLINT
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/tests/api/tester_helper.h"
@@ -99,6 +106,89 @@ TEST(AnalysisPredictor, analysis_on) {
   inference::CompareTensor(outputs.front(), naive_outputs.front());
 }
 
+TEST(AnalysisPredictor, fuse_pass_auto_tune) {
+  std::string cache_dir = "./fuse_pass_tune_cache";
+  MKDIR(cache_dir.c_str());
+  std::remove((cache_dir + "/fuse_pass_tune_result").c_str());
+
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SetOptimCacheDir(cache_dir);
+  config.EnableFusePassAutoTune(4, 1, 2);
+  ASSERT_TRUE(config.fuse_pass_auto_tune_enabled());
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  ASSERT_TRUE(predictor);
+
+  // The result is saved with the key of the device and the inputs.
+  std::ifstream fin(cache_dir + "/fuse_pass_tune_result");
+  ASSERT_TRUE(fin.is_open());
+  std::string key;
+  std::getline(fin, key);
+  EXPECT_EQ(key, "cpu batch_size=4 seq_len=1");
+  std::vector<std::string> off_passes;
+  for (std::string pass; std::getline(fin, pass);) {
+    off_passes.push_back(pass);
+  }
+
+  // The later predictors reuse the result.
+  AnalysisConfig tuned_config;
+  tuned_config.SetModel(FLAGS_dirname);
+  tuned_config.SetOptimCacheDir(cache_dir);
+  tuned_config.EnableFusePassAutoTune(4, 1, 2);
+  AnalysisConfig copied_config(tuned_config);
+  AnalysisPredictor::TuneFusePasses(&copied_config);
+  for (auto& pass : off_passes) {
+    auto& passes = copied_config.pass_builder()->AllPasses();
+    EXPECT_EQ(std::count(passes.begin(), passes.end(), pass), 0);
+  }
+  ASSERT_TRUE(CreatePaddlePredictor<AnalysisConfig>(tuned_config));
+}
+
+TEST(AnalysisPredictor, optim_model_cache) {
+  std::string cache_dir = "./optim_model_cache";
+  MKDIR(cache_dir.c_str());
+
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SetOptimCacheDir(cache_dir);
+  config.EnableOptimModelCache();
+  ASSERT_TRUE(config.optim_model_cache_enabled());
+  AnalysisConfig cached_config(config);
+
+  AnalysisPredictor keyed_predictor(config);
+  ASSERT_TRUE(keyed_predictor.LoadProgramDesc());
+  std::string dir = keyed_predictor.OptimModelCacheDir();
+  ASSERT_FALSE(dir.empty());
+  std::remove((dir + "/model").c_str());
+  std::remove((dir + "/params").c_str());
+
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  ASSERT_TRUE(inference::analysis::FileExists(dir + "/model"));
+  ASSERT_TRUE(inference::analysis::FileExists(dir + "/params"));
+
+  // The later predictor loads the optimized model cached.
+  auto cached_predictor = CreatePaddlePredictor<AnalysisConfig>(cached_config);
+  ASSERT_TRUE(cached_predictor);
+  EXPECT_EQ(
+      static_cast<AnalysisPredictor*>(cached_predictor.get())
+          ->GetSerializedProgram(),
+      static_cast<AnalysisPredictor*>(predictor.get())->GetSerializedProgram());
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs, cached_outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  ASSERT_TRUE(cached_predictor->Run(inputs, &cached_outputs));
+  ASSERT_EQ(outputs.size(), cached_outputs.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    inference::CompareTensor(outputs[i], cached_outputs[i]);
+  }
+}
+
 TEST(AnalysisPredictor, ZeroCopy) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -137,6 +227,125 @@ TEST(AnalysisPredictor, ZeroCopy) {
   LOG(INFO) << "output_data: " << out_data;
 }
 
+TEST(AnalysisPredictor, ZeroCopyRunAsync) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+#ifdef PADDLE_WITH_CUDA
+  config.EnableUseGpu(100, 0);
+#endif
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  // The clones run on the same stream from one thread.
+  const int kRuns = 3;
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors;
+  std::vector<std::promise<bool>> done(kRuns);
+  for (int run = 0; run < kRuns; ++run) {
+    predictors.emplace_back(predictor->Clone());
+    for (auto& name : predictors[run]->GetInputNames()) {
+      auto input = predictors[run]->GetInputTensor(name);
+      std::vector<int64_t> data{run, run + 1, run + 2, run + 3};
+      input->Reshape({4, 1});
+      input->copy_from_cpu(data.data());
+    }
+    ASSERT_TRUE(predictors[run]->ZeroCopyRunAsync(
+        [&done, run](bool success) { done[run].set_value(success); }));
+  }
+
+  for (int run = 0; run < kRuns; ++run) {
+    ASSERT_TRUE(done[run].get_future().get());
+    auto& output_name = predictors[run]->GetOutputNames()[0];
+    auto output = predictors[run]->GetOutputTensor(output_name);
+    auto shape = output->shape();
+    std::vector<float> async_out(std::accumulate(
+        shape.begin(), shape.end(), 1, std::multiplies<int>()));
+    output->copy_to_cpu(async_out.data());
+
+    // compare with the synchronous run
+    for (auto& name : predictor->GetInputNames()) {
+      auto input = predictor->GetInputTensor(name);
+      std::vector<int64_t> data{run, run + 1, run + 2, run + 3};
+      input->Reshape({4, 1});
+      input->copy_from_cpu(data.data());
+    }
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+    std::vector<float> out(async_out.size());
+    predictor->GetOutputTensor(output_name)->copy_to_cpu(out.data());
+    for (size_t i = 0; i < out.size(); ++i) {
+      EXPECT_NEAR(async_out[i], out[i], 1e-5);
+    }
+  }
+}
+
+TEST(AnalysisPredictor, op_latency_stats) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+  config.EnableOpLatencyStats();
+  ASSERT_TRUE(config.op_latency_stats_enabled());
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  const int kRuns = 3;
+  for (int run = 0; run < kRuns; ++run) {
+    for (auto& name : predictor->GetInputNames()) {
+      auto input = predictor->GetInputTensor(name);
+      std::vector<int64_t> data{0, 1, 2, 3};
+      input->Reshape({4, 1});
+      input->copy_from_cpu(data.data());
+    }
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+  }
+
+  auto stats = predictor->GetOpLatencyStats();
+  ASSERT_FALSE(stats.empty());
+  for (auto& item : stats) {
+    auto& op_stats = item.second;
+    EXPECT_GE(op_stats.count, static_cast<uint64_t>(kRuns)) << item.first;
+    EXPECT_LE(op_stats.p50_us, op_stats.p99_us) << item.first;
+    EXPECT_LE(op_stats.p99_us, op_stats.max_us) << item.first;
+  }
+
+  // the clones have their own stats
+  auto clone = predictor->Clone();
+  EXPECT_TRUE(clone->GetOpLatencyStats().empty());
+}
+
+#ifdef PADDLE_WITH_MKLDNN
+TEST(AnalysisPredictor, mkldnn_batch_buckets) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.EnableMKLDNN();
+  EXPECT_ANY_THROW(config.SetMkldnnBatchBuckets({8, 4}));
+  EXPECT_ANY_THROW(config.SetMkldnnBatchBuckets({0, 4}));
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  config.SetMkldnnBatchBuckets({4, 8});
+  auto bucket_predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  // the batch of 3 is padded to 4, and the outputs are trimmed back
+  int64_t data[3] = {1, 2, 3};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({3, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs;
+  std::vector<PaddleTensor> bucket_outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  ASSERT_TRUE(bucket_predictor->Run(inputs, &bucket_outputs));
+  ASSERT_EQ(outputs.size(), bucket_outputs.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_EQ(outputs[i].shape, bucket_outputs[i].shape);
+    ASSERT_EQ(outputs[i].data.length(), bucket_outputs[i].data.length());
+    const float* out = static_cast<const float*>(outputs[i].data.data());
+    const float* bucket_out =
+        static_cast<const float*>(bucket_outputs[i].data.data());
+    for (size_t j = 0; j < outputs[i].data.length() / sizeof(float); ++j) {
+      EXPECT_NEAR(out[j], bucket_out[j], 1e-5);
+    }
+  }
+}
+#endif
+
 TEST(AnalysisPredictor, Clone) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -193,6 +402,93 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+#ifdef PADDLE_WITH_CUDA
+TEST(AnalysisPredictor, gpu_memory_budget) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.EnableUseGpu(100, 0);
+  // small enough to spill some allocations
+  config.SetGpuMemoryBudget(1, true);
+
+  auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+  ASSERT_TRUE(predictor->allocation_context_);
+  auto allocator =
+      std::dynamic_pointer_cast<memory::allocation::BudgetAllocator>(
+          predictor->allocation_context_->allocator());
+  ASSERT_TRUE(allocator);
+  ASSERT_EQ(allocator->Budget(), 1UL << 20);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  ASSERT_LE(allocator->AllocatedBytes(), allocator->Budget());
+  ASSERT_GT(allocator->AllocatedBytes() + allocator->SpilledBytes(), 0UL);
+}
+
+TEST(AnalysisPredictor, gpu_multi_stream) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.EnableUseGpu(100, 0);
+  config.SwitchUseFeedFetchOps(false);
+  config.EnableGpuMultiStream();
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  // Each clone runs on its own stream in its own thread.
+  const int kThreads = 4;
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors;
+  for (int i = 0; i < kThreads; ++i) {
+    predictors.emplace_back(predictor->Clone());
+    auto* clone = static_cast<AnalysisPredictor*>(predictors[i].get());
+    ASSERT_TRUE(clone->stream_context_);
+    ASSERT_TRUE(clone->stream_allocation_context_);
+  }
+  auto run = [](PaddlePredictor* predictor, int start,
+                std::vector<float>* out) {
+    for (auto& name : predictor->GetInputNames()) {
+      std::vector<int64_t> data{start, start + 1, start + 2, start + 3};
+      auto input = predictor->GetInputTensor(name);
+      input->Reshape({4, 1});
+      input->copy_from_cpu(data.data());
+    }
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+    auto output =
+        predictor->GetOutputTensor(predictor->GetOutputNames().front());
+    auto shape = output->shape();
+    out->resize(std::accumulate(shape.begin(), shape.end(), 1,
+                                std::multiplies<int>()));
+    output->copy_to_cpu(out->data());
+  };
+
+  std::vector<std::vector<float>> outputs(kThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int repeat = 0; repeat < 10; ++repeat) {
+        run(predictors[i].get(), i, &outputs[i]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kThreads; ++i) {
+    std::vector<float> expected;
+    run(predictor.get(), i, &expected);
+    ASSERT_EQ(outputs[i].size(), expected.size());
+    for (size_t j = 0; j < expected.size(); ++j) {
+      EXPECT_NEAR(outputs[i][j], expected[j], 1e-5);
+    }
+  }
+}
+#endif
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
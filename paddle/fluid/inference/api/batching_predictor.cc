@@ -0,0 +1,299 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/batching_predictor.h"
+#include <glog/logging.h>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+
+namespace {
+
+size_t BatchSizeOf(const PaddleTensor &tensor) {
+  return tensor.lod.empty() ? tensor.shape[0] : tensor.lod[0].size() - 1;
+}
+
+size_t RowBytesOf(const PaddleTensor &tensor) {
+  size_t bytes = PaddleDtypeSize(tensor.dtype);
+  for (size_t i = 1; i < tensor.shape.size(); ++i) {
+    bytes *= tensor.shape[i];
+  }
+  return bytes;
+}
+
+bool CheckInput(const PaddleTensor &tensor) {
+  if (tensor.shape.empty() || tensor.shape[0] < 0) {
+    LOG(ERROR) << "the input [" << tensor.name
+               << "] should have the batch dimension";
+    return false;
+  }
+  if (RowBytesOf(tensor) * tensor.shape[0] != tensor.data.length()) {
+    LOG(ERROR) << "the data length " << tensor.data.length()
+               << " of the input [" << tensor.name
+               << "] does not match its shape";
+    return false;
+  }
+  for (auto &level : tensor.lod) {
+    if (level.empty() || level[0] != 0) {
+      LOG(ERROR) << "the LoD of the input [" << tensor.name
+                 << "] should start with 0";
+      return false;
+    }
+  }
+  if (!tensor.lod.empty() &&
+      tensor.lod.back().back() != static_cast<size_t>(tensor.shape[0])) {
+    LOG(ERROR) << "the LoD of the input [" << tensor.name
+               << "] does not match its first dimension " << tensor.shape[0];
+    return false;
+  }
+  return true;
+}
+
+// The inputs of the requests with the same signature can be concatenated.
+std::string SignatureOf(const std::vector<PaddleTensor> &inputs) {
+  std::stringstream ss;
+  for (auto &tensor : inputs) {
+    ss << tensor.name << ':' << tensor.dtype << ':' << tensor.lod.size();
+    for (size_t i = 1; i < tensor.shape.size(); ++i) {
+      ss << ',' << tensor.shape[i];
+    }
+    ss << ';';
+  }
+  return ss.str();
+}
+
+// Slice the sequences [begin, end) of the top level of lod, and return the
+// slice of rows.
+std::pair<size_t, size_t> SliceLoD(
+    const std::vector<std::vector<size_t>> &lod, size_t begin, size_t end,
+    std::vector<std::vector<size_t>> *sliced_lod) {
+  sliced_lod->resize(lod.size());
+  for (size_t i = 0; i < lod.size(); ++i) {
+    auto &level = (*sliced_lod)[i];
+    level.clear();
+    for (size_t j = begin; j <= end; ++j) {
+      level.push_back(lod[i][j] - lod[i][begin]);
+    }
+    begin = lod[i][begin];
+    end = lod[i][end];
+  }
+  return std::make_pair(begin, end);
+}
+
+}  // namespace
+
+BatchingPredictor::BatchingPredictor(
+    std::unique_ptr<PaddlePredictor> predictor, const BatchingConfig &config)
+    : predictor_(std::move(predictor)), config_(config) {
+  PADDLE_ENFORCE_NOT_NULL(predictor_, platform::errors::InvalidArgument(
+                                          "The predictor to run the batches "
+                                          "should not be null."));
+  PADDLE_ENFORCE_GT(config_.max_batch_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The max_batch_size should be positive, but got %d.",
+                        config_.max_batch_size));
+  PADDLE_ENFORCE_GE(config_.batch_timeout_us, 0,
+                    platform::errors::InvalidArgument(
+                        "The batch_timeout_us should not be negative, but got "
+                        "%d.",
+                        config_.batch_timeout_us));
+  batch_thread_ = std::thread([this] { BatchLoop(); });
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  batch_thread_.join();
+}
+
+bool BatchingPredictor::Run(const std::vector<PaddleTensor> &inputs,
+                            std::vector<PaddleTensor> *output_data,
+                            int batch_size) {
+  if (inputs.empty()) {
+    LOG(ERROR) << "the inputs of BatchingPredictor should not be empty";
+    return false;
+  }
+  for (auto &tensor : inputs) {
+    if (!CheckInput(tensor)) return false;
+  }
+
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = output_data;
+  request.signature = SignatureOf(inputs);
+  request.batch_size = BatchSizeOf(inputs[0]);
+  request.arrival = std::chrono::steady_clock::now();
+  auto result = request.result.get_future();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    requests_.push_back(&request);
+    queued_batch_size_ += request.batch_size;
+  }
+  cv_.notify_all();
+  return result.get();
+}
+
+std::unique_ptr<PaddlePredictor> BatchingPredictor::Clone() {
+  return CreateBatchingPredictor(predictor_->Clone(), config_);
+}
+
+void BatchingPredictor::BatchLoop() {
+  while (true) {
+    auto batch = PopBatch();
+    if (batch.empty()) return;
+    bool success = false;
+    try {
+      success = RunBatch(batch);
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "fail to run the batch of " << batch.size()
+                 << " requests: " << e.what();
+    }
+    for (auto *request : batch) {
+      request->result.set_value(success);
+    }
+  }
+}
+
+std::vector<BatchingPredictor::Request *> BatchingPredictor::PopBatch() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+  if (requests_.empty()) return {};
+
+  // the requests buffered are run right away when stopping
+  auto deadline = requests_.front()->arrival +
+                  std::chrono::microseconds(config_.batch_timeout_us);
+  cv_.wait_until(lock, deadline, [this] {
+    return stop_ ||
+           queued_batch_size_ >= static_cast<size_t>(config_.max_batch_size);
+  });
+
+  std::vector<Request *> batch{requests_.front()};
+  size_t batch_size = requests_.front()->batch_size;
+  requests_.pop_front();
+  for (auto it = requests_.begin(); it != requests_.end();) {
+    auto *request = *it;
+    if (request->signature == batch[0]->signature &&
+        batch_size + request->batch_size <=
+            static_cast<size_t>(config_.max_batch_size)) {
+      batch.push_back(request);
+      batch_size += request->batch_size;
+      it = requests_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  queued_batch_size_ -= batch_size;
+  return batch;
+}
+
+bool BatchingPredictor::RunBatch(const std::vector<Request *> &batch) {
+  if (batch.size() == 1) {
+    return predictor_->Run(*batch[0]->inputs, batch[0]->outputs);
+  }
+
+  const auto &first_inputs = *batch[0]->inputs;
+  std::vector<PaddleTensor> inputs(first_inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto &input = inputs[i];
+    input.name = first_inputs[i].name;
+    input.dtype = first_inputs[i].dtype;
+    input.shape = first_inputs[i].shape;
+    input.shape[0] = 0;
+    input.lod.assign(first_inputs[i].lod.size(), std::vector<size_t>{0});
+    size_t length = 0;
+    for (auto *request : batch) {
+      auto &tensor = (*request->inputs)[i];
+      input.shape[0] += tensor.shape[0];
+      length += tensor.data.length();
+      for (size_t j = 0; j < tensor.lod.size(); ++j) {
+        auto &level = input.lod[j];
+        size_t offset = level.back();
+        for (size_t k = 1; k < tensor.lod[j].size(); ++k) {
+          level.push_back(offset + tensor.lod[j][k]);
+        }
+      }
+    }
+    input.data.Resize(length);
+    char *data = static_cast<char *>(input.data.data());
+    for (auto *request : batch) {
+      auto &tensor = (*request->inputs)[i].data;
+      std::memcpy(data, tensor.data(), tensor.length());
+      data += tensor.length();
+    }
+  }
+
+  std::vector<PaddleTensor> outputs;
+  if (!predictor_->Run(inputs, &outputs)) return false;
+
+  // Split the outputs by the batch sizes, or by the rows of the first inputs.
+  size_t total_batch_size = 0;
+  for (auto *request : batch) {
+    request->outputs->resize(outputs.size());
+    total_batch_size += request->batch_size;
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto &output = outputs[i];
+    bool split_by_batch = output.lod.empty()
+                              ? output.shape.size() > 0 &&
+                                    output.shape[0] ==
+                                        static_cast<int>(total_batch_size)
+                              : BatchSizeOf(output) == total_batch_size;
+    bool split_by_rows =
+        output.lod.empty() && output.shape.size() > 0 &&
+        output.shape[0] == inputs[0].shape[0];
+    if (!split_by_batch && !split_by_rows) {
+      LOG(ERROR) << "can not split the output [" << output.name
+                 << "] of the batch of " << total_batch_size;
+      return false;
+    }
+
+    size_t row_bytes = RowBytesOf(output);
+    size_t begin = 0;
+    for (auto *request : batch) {
+      size_t end = begin + (split_by_batch ? request->batch_size
+                                           : (*request->inputs)[0].shape[0]);
+      auto &tensor = (*request->outputs)[i];
+      tensor.name = output.name;
+      tensor.dtype = output.dtype;
+      tensor.shape = output.shape;
+      tensor.lod.clear();
+      auto rows = output.lod.empty()
+                      ? std::make_pair(begin, end)
+                      : SliceLoD(output.lod, begin, end, &tensor.lod);
+      tensor.shape[0] = rows.second - rows.first;
+      tensor.data.Resize((rows.second - rows.first) * row_bytes);
+      std::memcpy(tensor.data.data(),
+                  static_cast<char *>(output.data.data()) +
+                      rows.first * row_bytes,
+                  tensor.data.length());
+      begin = end;
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<PaddlePredictor> CreateBatchingPredictor(
+    std::unique_ptr<PaddlePredictor> predictor, const BatchingConfig &config) {
+  return std::unique_ptr<PaddlePredictor>(
+      new BatchingPredictor(std::move(predictor), config));
+}
+
+}  // namespace paddle
@@ -0,0 +1,130 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_api.h"
+
+///
+/// \file batching_predictor.h
+///
+/// \brief BatchingPredictor merges the concurrent requests into batches to
+/// run an underlying predictor fewer times with larger batches
+///
+/// \since 1.8.0
+///
+
+namespace paddle {
+
+///
+/// \class BatchingPredictor
+///
+/// \brief The batching predictor buffers the requests of the concurrent Run
+/// calls, until the total batch size reaches max_batch_size or the first
+/// request waits for batch_timeout_us. The inputs of the buffered requests are
+/// concatenated along the batch dimension, i.e. the first dimension and the
+/// LoD, the underlying predictor runs once, and the outputs are split back to
+/// the callers.
+///
+/// The batch size of a request is the number of sequences of its first input
+/// if it has LoD, or its first dimension otherwise. Only the requests with the
+/// same input names, data types, trailing dimensions and LoD levels are
+/// batched together. An output is split by its sequences if it has LoD, or by
+/// its first dimension, which should be the total batch size, or the total
+/// first dimension of the first inputs, e.g. the outputs per word.
+///
+/// Run is thread safe, and the ZeroCopy APIs are not supported.
+///
+class BatchingPredictor : public PaddlePredictor {
+ public:
+  ///
+  /// \brief Construct a new Batching Predictor object
+  ///
+  /// \param[in] predictor the predictor which runs the batches
+  /// \param[in] config the batching config
+  ///
+  BatchingPredictor(std::unique_ptr<PaddlePredictor> predictor,
+                    const BatchingConfig &config);
+  ///
+  /// \brief Destroy the Batching Predictor object, after the buffered
+  /// requests are run
+  ///
+  ~BatchingPredictor();
+
+  ///
+  /// \brief Run the request in a batch with the concurrent requests
+  ///
+  /// \param[in] inputs input tensors
+  /// \param[out] output_data output tensors
+  /// \param[in] batch_size unused, the batch size is got from the inputs
+  /// \return Whether the function executed successfully
+  ///
+  bool Run(const std::vector<PaddleTensor> &inputs,
+           std::vector<PaddleTensor> *output_data,
+           int batch_size = -1) override;
+
+  std::vector<std::string> GetInputNames() override {
+    return predictor_->GetInputNames();
+  }
+  std::map<std::string, std::vector<int64_t>> GetInputTensorShape() override {
+    return predictor_->GetInputTensorShape();
+  }
+  std::vector<std::string> GetOutputNames() override {
+    return predictor_->GetOutputNames();
+  }
+
+  ///
+  /// \brief Clone to get a new batching predictor over a clone of the
+  /// underlying predictor
+  ///
+  /// \return get a new predictor
+  ///
+  std::unique_ptr<PaddlePredictor> Clone() override;
+
+ private:
+  struct Request {
+    const std::vector<PaddleTensor> *inputs;
+    std::vector<PaddleTensor> *outputs;
+    // the requests with the same signature can be batched together
+    std::string signature;
+    size_t batch_size;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<bool> result;
+  };
+
+  void BatchLoop();
+  std::vector<Request *> PopBatch();
+  bool RunBatch(const std::vector<Request *> &batch);
+
+  std::unique_ptr<PaddlePredictor> predictor_;
+  BatchingConfig config_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Request *> requests_;
+  size_t queued_batch_size_{0};
+  bool stop_{false};
+  std::thread batch_thread_;
+};
+
+}  // namespace paddle
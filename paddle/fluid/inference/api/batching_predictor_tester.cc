@@ -0,0 +1,201 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/batching_predictor.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+
+/*
+ * Output "double" is the input doubled with its LoD, and "sum" is the sum of
+ * each sequence of the input, with the shape [sequences, 1].
+ */
+class SeqSumPredictor : public PaddlePredictor {
+ public:
+  explicit SeqSumPredictor(std::atomic<int> *run_times)
+      : run_times_(run_times) {}
+
+  bool Run(const std::vector<PaddleTensor> &inputs,
+           std::vector<PaddleTensor> *output_data,
+           int batch_size = -1) override {
+    ++*run_times_;
+    auto &input = inputs[0];
+    const float *x = static_cast<const float *>(input.data.data());
+    output_data->resize(2);
+    auto &doubled = (*output_data)[0];
+    doubled.name = "double";
+    doubled.dtype = PaddleDType::FLOAT32;
+    doubled.shape = input.shape;
+    doubled.lod = input.lod;
+    doubled.data.Resize(input.data.length());
+    float *y = static_cast<float *>(doubled.data.data());
+    for (int i = 0; i < input.shape[0]; ++i) {
+      y[i] = x[i] * 2;
+    }
+
+    auto &sum = (*output_data)[1];
+    auto &offsets = input.lod[0];
+    sum.name = "sum";
+    sum.dtype = PaddleDType::FLOAT32;
+    sum.shape = {static_cast<int>(offsets.size() - 1), 1};
+    sum.data.Resize((offsets.size() - 1) * sizeof(float));
+    float *s = static_cast<float *>(sum.data.data());
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+      s[i] = 0;
+      for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+        s[i] += x[j];
+      }
+    }
+    return true;
+  }
+
+  std::unique_ptr<PaddlePredictor> Clone() override {
+    return std::unique_ptr<PaddlePredictor>(new SeqSumPredictor(run_times_));
+  }
+
+ private:
+  std::atomic<int> *run_times_;
+};
+
+PaddleTensor MakeSequences(const std::vector<size_t> &lengths, float start) {
+  PaddleTensor tensor;
+  tensor.name = "x";
+  tensor.dtype = PaddleDType::FLOAT32;
+  tensor.lod.push_back({0});
+  for (auto length : lengths) {
+    tensor.lod[0].push_back(tensor.lod[0].back() + length);
+  }
+  int rows = tensor.lod[0].back();
+  tensor.shape = {rows, 1};
+  tensor.data.Resize(rows * sizeof(float));
+  float *data = static_cast<float *>(tensor.data.data());
+  for (int i = 0; i < rows; ++i) {
+    data[i] = start + i;
+  }
+  return tensor;
+}
+
+void CheckOutputs(const PaddleTensor &input,
+                  const std::vector<PaddleTensor> &outputs) {
+  ASSERT_EQ(outputs.size(), 2UL);
+  const float *x = static_cast<const float *>(input.data.data());
+  auto &doubled = outputs[0];
+  ASSERT_EQ(doubled.shape, input.shape);
+  EXPECT_EQ(doubled.lod, input.lod);
+  const float *y = static_cast<const float *>(doubled.data.data());
+  for (int i = 0; i < input.shape[0]; ++i) {
+    EXPECT_EQ(y[i], x[i] * 2);
+  }
+
+  auto &offsets = input.lod[0];
+  auto &sum = outputs[1];
+  ASSERT_EQ(sum.shape,
+            std::vector<int>({static_cast<int>(offsets.size() - 1), 1}));
+  EXPECT_TRUE(sum.lod.empty());
+  const float *s = static_cast<const float *>(sum.data.data());
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    float expected = 0;
+    for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+      expected += x[j];
+    }
+    EXPECT_EQ(s[i], expected);
+  }
+}
+
+TEST(BatchingPredictor, single_request) {
+  std::atomic<int> run_times(0);
+  BatchingConfig config;
+  config.batch_timeout_us = 0;
+  auto predictor = CreateBatchingPredictor(
+      std::unique_ptr<PaddlePredictor>(new SeqSumPredictor(&run_times)),
+      config);
+  std::vector<PaddleTensor> inputs;
+  inputs.push_back(MakeSequences({3, 1}, 1));
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  CheckOutputs(inputs[0], outputs);
+  EXPECT_EQ(run_times, 1);
+}
+
+TEST(BatchingPredictor, concurrent_requests) {
+  const int kThreads = 4;
+  std::atomic<int> run_times(0);
+  BatchingConfig config;
+  // the batch is run once the requests of all the threads come
+  config.max_batch_size = kThreads;
+  config.batch_timeout_us = 10 * 1000 * 1000;
+  auto predictor = CreateBatchingPredictor(
+      std::unique_ptr<PaddlePredictor>(new SeqSumPredictor(&run_times)),
+      config);
+
+  std::vector<std::vector<PaddleTensor>> inputs(kThreads);
+  std::vector<std::vector<PaddleTensor>> outputs(kThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    inputs[i].push_back(MakeSequences({static_cast<size_t>(i + 1)}, i * 10));
+    threads.emplace_back([&, i] {
+      EXPECT_TRUE(predictor->Run(inputs[i], &outputs[i]));
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kThreads; ++i) {
+    CheckOutputs(inputs[i][0], outputs[i]);
+  }
+  EXPECT_EQ(run_times, 1);
+}
+
+TEST(BatchingPredictor, incompatible_requests) {
+  std::atomic<int> run_times(0);
+  BatchingConfig config;
+  config.max_batch_size = 8;
+  config.batch_timeout_us = 1000;
+  auto predictor = CreateBatchingPredictor(
+      std::unique_ptr<PaddlePredictor>(new SeqSumPredictor(&run_times)),
+      config);
+
+  // the requests of different input names are not batched together
+  std::vector<PaddleTensor> inputs0{MakeSequences({2}, 0)};
+  std::vector<PaddleTensor> inputs1{MakeSequences({3, 2}, 5)};
+  inputs1[0].name = "y";
+  std::vector<PaddleTensor> outputs0;
+  std::vector<PaddleTensor> outputs1;
+  std::thread thread0(
+      [&] { EXPECT_TRUE(predictor->Run(inputs0, &outputs0)); });
+  std::thread thread1(
+      [&] { EXPECT_TRUE(predictor->Run(inputs1, &outputs1)); });
+  thread0.join();
+  thread1.join();
+  CheckOutputs(inputs0[0], outputs0);
+  CheckOutputs(inputs1[0], outputs1);
+  EXPECT_EQ(run_times, 2);
+}
+
+TEST(BatchingPredictor, invalid_input) {
+  std::atomic<int> run_times(0);
+  auto predictor = CreateBatchingPredictor(
+      std::unique_ptr<PaddlePredictor>(new SeqSumPredictor(&run_times)),
+      BatchingConfig());
+  std::vector<PaddleTensor> inputs{MakeSequences({2, 2}, 0)};
+  inputs[0].lod[0].back() = 5;
+  std::vector<PaddleTensor> outputs;
+  EXPECT_FALSE(predictor->Run(inputs, &outputs));
+  EXPECT_EQ(run_times, 0);
+}
+
+}  // namespace paddle
@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/enforce.h"
 
@@ -113,8 +114,10 @@ void ZeroCopyTensor::copy_from_cpu(const T *data) {
     auto *dev_ctx =
         static_cast<const platform::CUDADeviceContext *>(pool.Get(gpu_place));
 
+    auto stream = stream_ != nullptr ? static_cast<cudaStream_t>(stream_)
+                                     : dev_ctx->stream();
     memory::Copy(gpu_place, static_cast<void *>(t_data), platform::CPUPlace(),
-                 data, ele_size, dev_ctx->stream());
+                 data, ele_size, stream);
 #else
     PADDLE_THROW("Not compiled with CUDA, should not reach here.");
 #endif
@@ -136,10 +139,12 @@ void ZeroCopyTensor::copy_to_cpu(T *data) {
     auto gpu_place = boost::get<platform::CUDAPlace>(t_place);
     auto *dev_ctx =
         static_cast<const platform::CUDADeviceContext *>(pool.Get(gpu_place));
+    auto stream = stream_ != nullptr ? static_cast<cudaStream_t>(stream_)
+                                     : dev_ctx->stream();
     memory::Copy(platform::CPUPlace(), static_cast<void *>(data), gpu_place,
-                 t_data, ele_num * sizeof(T), dev_ctx->stream());
+                 t_data, ele_num * sizeof(T), stream);
 
-    cudaStreamSynchronize(dev_ctx->stream());
+    cudaStreamSynchronize(stream);
 #else
     PADDLE_THROW("Not compile with CUDA, should not reach here.");
 #endif
@@ -185,6 +190,70 @@ std::vector<int> ZeroCopyTensor::shape() const {
   return framework::vectorize<int>(tensor->dims());
 }
 
+int ZeroCopyTensor::CopyShapeTo(int *shape, int capacity) const {
+  EAGER_GET_TENSOR;
+  auto &dims = tensor->dims();
+  for (int i = 0; i < dims.size() && i < capacity; ++i) {
+    shape[i] = dims[i];
+  }
+  return dims.size();
+}
+
+void ZeroCopyTensor::ShareExternalData(void *data, size_t length,
+                                       PaddleDType dtype) {
+  EAGER_GET_TENSOR;
+  PADDLE_ENFORCE_NOT_NULL(data, platform::errors::InvalidArgument(
+                                    "The external data shared as the tensor "
+                                    "[%s] should not be null.",
+                                    name_));
+  framework::proto::VarType::Type type;
+  switch (dtype) {
+    case PaddleDType::FLOAT32:
+      type = framework::proto::VarType::FP32;
+      break;
+    case PaddleDType::INT64:
+      type = framework::proto::VarType::INT64;
+      break;
+    case PaddleDType::INT32:
+      type = framework::proto::VarType::INT32;
+      break;
+    case PaddleDType::UINT8:
+      type = framework::proto::VarType::UINT8;
+      break;
+    default:
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Unsupported data type %d of the external data.",
+          static_cast<int>(dtype)));
+  }
+  size_t element_size = PaddleDtypeSize(dtype);
+  if (input_or_output_) {
+    PADDLE_ENFORCE_LE(tensor->numel() * element_size, length,
+                      platform::errors::InvalidArgument(
+                          "The external data of %d bytes is too small for "
+                          "the input [%s] of shape [%s].",
+                          length, name_, tensor->dims()));
+  } else {
+    // the ops resize the output before writing it
+    tensor->Resize(framework::make_ddim(
+        {static_cast<int64_t>(length / element_size)}));
+  }
+  platform::Place place;
+  if (place_ == PaddlePlace::kGPU) {
+    place = platform::CUDAPlace(device_);
+  } else {
+    place = platform::CPUPlace();
+  }
+  // the allocation does not own the memory
+  tensor->ResetHolderWithType(
+      std::make_shared<memory::Allocation>(data, length, place), type);
+}
+
+bool ZeroCopyTensor::SharesExternalData(const void *data) const {
+  EAGER_GET_TENSOR;
+  return tensor->IsInitialized() && tensor->Holder()->ptr() == data &&
+         tensor->offset() == 0;
+}
+
 void ZeroCopyTensor::SetLoD(const std::vector<std::vector<size_t>> &x) {
   EAGER_GET_TENSOR;
   framework::LoD lod;
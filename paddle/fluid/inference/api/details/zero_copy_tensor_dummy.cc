@@ -39,6 +39,15 @@ void *ZeroCopyTensor::FindTensor() const { return nullptr; }
 
 std::vector<int> ZeroCopyTensor::shape() const { return {}; }
 
+int ZeroCopyTensor::CopyShapeTo(int *shape, int capacity) const { return 0; }
+
+void ZeroCopyTensor::ShareExternalData(void *data, size_t length,
+                                       PaddleDType dtype) {}
+
+bool ZeroCopyTensor::SharesExternalData(const void *data) const {
+  return false;
+}
+
 void ZeroCopyTensor::SetLoD(const std::vector<std::vector<size_t>> &x) {}
 
 std::vector<std::vector<size_t>> ZeroCopyTensor::lod() const {
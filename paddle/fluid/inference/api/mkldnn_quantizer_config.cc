@@ -53,6 +53,19 @@ MkldnnQuantizerConfig::MkldnnQuantizerConfig() {
   rules_["reshape2"]["ShapeTensor"] = ScaleAlgo::NONE;
   rules_["reshape2"]["XShape"] = ScaleAlgo::NONE;
   rules_["reshape2"]["Out"] = ScaleAlgo::NONE;
+
+  // Only the FC of X and WeightX is quantized in fusion_gru and fusion_lstm,
+  // the recurrent part and the outputs stay fp32.
+  for (auto op_type : {"fusion_gru", "fusion_lstm"}) {
+    rules_[op_type]["X"] = ScaleAlgo::KL;
+    rules_[op_type]["WeightX"] = ScaleAlgo::MAX_CH_T;
+    for (auto conn_name :
+         {"H0", "C0", "WeightH", "Bias", "Hidden", "Cell", "XX",
+          "BatchedInput", "BatchedOut", "BatchedHidden", "BatchedCell",
+          "ReorderedH0", "ReorderedC0", "CheckedCell"}) {
+      rules_[op_type][conn_name] = ScaleAlgo::NONE;
+    }
+  }
 }
 
 ScaleAlgo MkldnnQuantizerConfig::scale_algo(
@@ -129,6 +129,9 @@ struct AnalysisConfig {
   void SetOptimCacheDir(const std::string& opt_cache_dir) {
     opt_cache_dir_ = opt_cache_dir;
   }
+  /** Get the path of optimization cache directory.
+   */
+  const std::string& opt_cache_dir() const { return opt_cache_dir_; }
   /** Get the model directory path.
    */
   const std::string& model_dir() const { return model_dir_; }
@@ -170,6 +173,36 @@ struct AnalysisConfig {
   /** Get the proportion of the initial memory pool size compared to the device.
    */
   float fraction_of_gpu_memory_for_pool() const;
+  /**
+   * \brief Limit the GPU memory allocated by the predictor, so that several
+   * predictors can share a GPU without one starving the others.
+   * @param budget_mb the GPU memory budget of the predictor in MB, 0 means no
+   * limit.
+   * @param spill_to_host whether the allocations beyond the budget are moved
+   * to the host memory mapped into the GPU, which is slower to access, or
+   * fail the prediction with an exception (default is true).
+   */
+  void SetGpuMemoryBudget(uint64_t budget_mb, bool spill_to_host = true);
+  /** Get the GPU memory budget in MB of the predictor, 0 means no limit.
+   */
+  uint64_t gpu_memory_budget_mb() const { return gpu_memory_budget_mb_; }
+  /** A bool state telling whether the allocations beyond the GPU memory
+   * budget are moved to the host memory.
+   */
+  bool gpu_memory_spill_to_host() const { return gpu_memory_spill_to_host_; }
+  /**
+   * \brief Run the predictor on its own CUDA stream and cuDNN/cuBLAS handles,
+   * rather than the stream of the device shared by all the predictors, so
+   * that the predictors, e.g. the clones run by different threads, run on
+   * the GPU concurrently. The GPU memory freed by the predictor is reused by
+   * the others only after its work queued finishes. The zero copy tensors
+   * copy on the stream of their predictor too.
+   * @param x whether to use a CUDA stream of the predictor (default is true).
+   */
+  void EnableGpuMultiStream(bool x = true);
+  /** A bool state telling whether the predictor owns a CUDA stream.
+   */
+  bool gpu_multi_stream_enabled() const { return gpu_multi_stream_; }
 
   /** Turn on CUDNN
    */
@@ -178,6 +211,14 @@ struct AnalysisConfig {
    */
   bool cudnn_enabled() const { return use_cudnn_; }
 
+  /** Turn on running the conv regions of the model in NHWC, which makes the
+   * convolutions faster on the GPUs with the tensor cores, e.g. in float16.
+   */
+  void EnableNHWCLayout();
+  /** A boolean state telling whether to run the conv regions in NHWC.
+   */
+  bool nhwc_layout_enabled() const { return use_nhwc_layout_; }
+
   /** \brief Control whether to perform IR graph optimization.
    *
    * If turned off, the AnalysisConfig will act just like a NativeConfig.
@@ -244,14 +285,39 @@ struct AnalysisConfig {
       std::map<std::string, std::vector<int>> max_input_shape,
       std::map<std::string, std::vector<int>> optim_input_shape,
       bool disable_trt_plugin_fp16 = false);
+  /**
+   *  \brief Set the number of the threads building the TensorRT engines of
+   *  the subgraphs in parallel, 1 by default. Each builder takes its own
+   *  workspace of the GPU memory at the same time.
+   *  @param num_threads the number of the building threads
+   */
+  void SetTRTEngineBuildThreads(int num_threads);
+  /**
+   *  \brief Add an optimization profile for TensorRT Dynamic shape mode
+   *  besides the one set by SetTRTDynamicShapeInfo, which should be called
+   *  first. The engine runs each request with the first profile whose range
+   *  contains the input shapes, and all the profiles are serialized into the
+   *  static engine cache.
+   *  @param min_input_shape the min input shape of the subgraph input
+   *  @param max_input_shape the max input shape of the subgraph input
+   *  @param opt_input_shape the opt input shape of the subgraph input
+   */
+  void AddTRTDynamicShapeProfile(
+      std::map<std::string, std::vector<int>> min_input_shape,
+      std::map<std::string, std::vector<int>> max_input_shape,
+      std::map<std::string, std::vector<int>> optim_input_shape);
 
   /**
    *  \brief Turn on the usage of Lite sub-graph engine.
+   *
+   *  \param zero_copy Whether the inputs and the outputs of the Lite
+   *  sub-graphs share their memory with the Fluid tensors, instead of being
+   *  copied. The outputs are valid until the predictor runs again.
    */
   void EnableLiteEngine(
       AnalysisConfig::Precision precision_mode = Precision::kFloat32,
       const std::vector<std::string>& passes_filter = {},
-      const std::vector<std::string>& ops_filter = {});
+      const std::vector<std::string>& ops_filter = {}, bool zero_copy = false);
 
   /** A boolean state indicating whether the Lite sub-graph engine is used.
   */
@@ -278,6 +344,22 @@ struct AnalysisConfig {
    *  Default 0 means don't cache any shape.
    */
   void SetMkldnnCacheCapacity(int capacity);
+  /** \brief Set the batch buckets for MKLDNN.
+   *
+   * The batch of the inputs in Run is padded with zeros up to the smallest
+   * bucket not less than it, and the outputs of the padded batch are
+   * trimmed back, so the primitives are only created for the buckets,
+   * which are all kept in the cache. It is only for the models computing
+   * the samples independently, and the inputs with LoD, with different
+   * batch sizes, or with a batch over all the buckets are not padded.
+   * ZeroCopyRun is not supported.
+   * @param buckets the ascending positive batch sizes.
+   */
+  void SetMkldnnBatchBuckets(const std::vector<int>& buckets);
+  /** Get the batch buckets for MKLDNN. */
+  const std::vector<int>& mkldnn_batch_buckets() const {
+    return mkldnn_batch_buckets_;
+  }
   /** A boolean state telling whether to use the MKLDNN.
    */
   bool mkldnn_enabled() const { return use_mkldnn_; }
@@ -291,6 +373,19 @@ struct AnalysisConfig {
     return cpu_math_library_num_threads_;
   }
 
+  /** Partition the CPUs of the process between the compute, io and comm
+   * threads by the spec like "compute=0-11;io=12-13;comm=14-15", which binds
+   * the threads running the predictor and the threads of the CPU math
+   * library to the compute CPUs. The partition is process-wide, so the
+   * predictors in a process should use the same one.
+   */
+  void SetCpuThreadPartition(const std::string &spec);
+  /** A string state telling the partition of the CPUs, empty if it is not set.
+   */
+  const std::string &cpu_thread_partition() const {
+    return cpu_thread_partition_;
+  }
+
   /** Transform the AnalysisConfig to NativeConfig.
    */
   NativeConfig ToNativeConfig() const;
@@ -330,6 +425,85 @@ struct AnalysisConfig {
   /** Tell whether the memory optimization is activated. */
   bool enable_memory_optim() const;
 
+  /** \brief Turn on the static memory plan.
+   *
+   * The intermediate tensors of the first run are packed into one arena by
+   * their lifetimes, and the later runs with the same input shapes place
+   * the tensors in the arena rather than allocating them one by one. The
+   * plan is built again when the input shapes change.
+   * @param x whether to use the static memory plan (default is true).
+   */
+  void EnableStaticMemoryPlan(bool x = true);
+  /** Tell whether the static memory plan is activated. */
+  bool static_memory_plan_enabled() const { return static_memory_plan_; }
+
+  /** \brief Load the parameters by memory mapping the parameter files.
+   *
+   * The parameters loaded on CPU share the pages of the mapped file rather
+   * than copy them, so the predictors in different processes, e.g. the
+   * workers of a prefork server, share one physical copy of the parameters.
+   * The mapping is private: the pages written, e.g. by the fuse passes, are
+   * copied, and the file is never modified. The pages of a large embedding
+   * table are read when its rows are first looked up, so neither the load
+   * time nor the resident memory grows with the size of the table, see
+   * FLAGS_advise_mapped_embedding_rows to read the rows of a batch ahead.
+   * @param x whether to memory map the parameters (default is true).
+   */
+  void EnableMemoryMappedParams(bool x = true);
+  /** Tell whether the parameters are memory mapped. */
+  bool memory_mapped_params_enabled() const { return memory_mapped_params_; }
+
+  /** \brief Turn on the CUDA graph.
+   *
+   * The kernels of a run are captured into a CUDA graph after a warm-up
+   * run, and the later runs replay the graph by one launch while the shapes
+   * and the addresses of the inputs stay the same, so the inputs should be
+   * copied into the zero copy tensors. It is turned off if the program can
+   * not be captured, e.g. some of the ops run on CPU. It requires GPU and
+   * CUDA 10.1 or later.
+   * @param x whether to use the CUDA graph (default is true).
+   */
+  void EnableCUDAGraph(bool x = true);
+  /** Tell whether the CUDA graph is activated. */
+  bool cuda_graph_enabled() const { return cuda_graph_; }
+
+  /** \brief Turn on the auto-tuning of the fuse passes.
+   *
+   * Before creating the predictor, each fuse pass changing the model, e.g.
+   * fc_gru_fuse_pass, is turned off in turn, and kept off if the model runs
+   * faster without it on the device. The model is timed on the zero inputs
+   * of batch_size samples, seq_len steps each for the LoD inputs, repeat
+   * times. The passes turned off are saved in fuse_pass_tune_result of the
+   * optimization cache directory or the model directory, and reused by the
+   * later predictors of the same device and inputs. SaveOptimModel saves
+   * them next to the optimized model too.
+   * @param batch_size the batch size of the inputs timed.
+   * @param seq_len the sequence length of the LoD inputs timed.
+   * @param repeat the times to run the model for each candidate.
+   */
+  void EnableFusePassAutoTune(int batch_size = 1, int seq_len = 1,
+                              int repeat = 10);
+  /** Tell whether the auto-tuning of the fuse passes is activated. */
+  bool fuse_pass_auto_tune_enabled() const { return fuse_pass_auto_tune_; }
+  int fuse_pass_tune_batch_size() const { return fuse_pass_tune_batch_size_; }
+  int fuse_pass_tune_seq_len() const { return fuse_pass_tune_seq_len_; }
+  int fuse_pass_tune_repeat() const { return fuse_pass_tune_repeat_; }
+
+  /** \brief Turn on the cache of the optimized model.
+   *
+   * The program and the parameters after the IR analysis are saved in the
+   * optimization cache directory, or _opt_cache of the model directory,
+   * under a key of the hash of the model and the parameters, the config
+   * and the version of Paddle. The later predictors of the same key load
+   * them directly and skip the IR analysis. It is turned off for the models
+   * from memory, and with TensorRT, Lite or the MKLDNN quantizer, whose
+   * results can not be saved in the program.
+   * @param x whether to cache the optimized model (default is true).
+   */
+  void EnableOptimModelCache(bool x = true);
+  /** Tell whether the optimized model is cached. */
+  bool optim_model_cache_enabled() const { return optim_model_cache_; }
+
   /** \brief Turn on profiling report.
    *
    * If not turned on, no profiling report will be generateed.
@@ -339,6 +513,23 @@ struct AnalysisConfig {
    */
   bool profile_enabled() const { return with_profile_; }
 
+  /** \brief Turn on the latency stats of the ops.
+   *
+   * Unlike the profiler, it is cheap enough to keep on in production: the
+   * latency of each op run is recorded into a lock-free histogram of its op
+   * type, or of its subgraph engine, e.g. "tensorrt_engine:<engine_key>",
+   * which are got by PaddlePredictor::GetOpLatencyStats. The latency is the
+   * host time of the op, so it does not include the asynchronous kernels on
+   * GPU, and the replays of the CUDA graph are not recorded.
+   * @param x whether to record the latency stats of the ops (default is
+   * true).
+   */
+  void EnableOpLatencyStats(bool x = true);
+  /** A boolean state telling whether the latency stats of the ops are
+   * recorded.
+   */
+  bool op_latency_stats_enabled() const { return op_latency_stats_; }
+
   /** \brief Disable GLOG information output for security.
    *
    * If called, no LOG(INFO) logs will be generated.
@@ -375,8 +566,12 @@ struct AnalysisConfig {
   bool use_gpu_{false};
   int device_id_{0};
   uint64_t memory_pool_init_size_mb_{100};  // initial size is 100MB.
+  uint64_t gpu_memory_budget_mb_{0};        // no limit by default.
+  bool gpu_memory_spill_to_host_{true};
+  bool gpu_multi_stream_{false};
 
   bool use_cudnn_{false};
+  bool use_nhwc_layout_{false};
 
   // Padding related
   bool use_fc_padding_{true};
@@ -402,10 +597,31 @@ struct AnalysisConfig {
   std::map<std::string, std::vector<int>> min_input_shape_{};
   std::map<std::string, std::vector<int>> max_input_shape_{};
   std::map<std::string, std::vector<int>> optim_input_shape_{};
+  // the optimization profiles besides the one above
+  std::vector<std::map<std::string, std::vector<int>>>
+      extra_min_input_shapes_{};
+  std::vector<std::map<std::string, std::vector<int>>>
+      extra_max_input_shapes_{};
+  std::vector<std::map<std::string, std::vector<int>>>
+      extra_optim_input_shapes_{};
   bool disable_trt_plugin_fp16_{false};
+  int trt_engine_build_threads_{1};
 
   // memory reuse related.
   bool enable_memory_optim_{false};
+  bool static_memory_plan_{false};
+  bool memory_mapped_params_{false};
+  bool cuda_graph_{false};
+
+  // fuse pass auto-tuning related.
+  bool fuse_pass_auto_tune_{false};
+  int fuse_pass_tune_batch_size_{1};
+  int fuse_pass_tune_seq_len_{1};
+  int fuse_pass_tune_repeat_{10};
+  // the fuse passes turned off by the auto-tuning
+  std::vector<std::string> fuse_passes_tuned_off_;
+
+  bool optim_model_cache_{false};
 
   bool use_ngraph_{false};
   bool use_mkldnn_{false};
@@ -420,8 +636,10 @@ struct AnalysisConfig {
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  std::string cpu_thread_partition_;
 
   bool with_profile_{false};
+  bool op_latency_stats_{false};
 
   bool with_glog_info_{true};
 
@@ -434,9 +652,11 @@ struct AnalysisConfig {
   std::vector<std::string> lite_passes_filter_;
   std::vector<std::string> lite_ops_filter_;
   Precision lite_precision_mode_;
+  bool lite_zero_copy_{false};
 
   // mkldnn related.
   int mkldnn_cache_capacity_{0};
+  std::vector<int> mkldnn_batch_buckets_;
   bool use_mkldnn_quantizer_{false};
   std::shared_ptr<MkldnnQuantizerConfig> mkldnn_quantizer_config_;
 
@@ -23,6 +23,8 @@
  */
 
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -171,6 +173,24 @@ class ZeroCopyTensor {
 
   std::vector<int> shape() const;
 
+  /** Copy at most capacity dimensions of the shape into shape without
+   * allocation, and return the rank.
+   */
+  int CopyShapeTo(int* shape, int capacity) const;
+
+  /** Share the external memory of length bytes in the place of the tensor
+   * as the tensor of dtype, without copy. An input should be reshaped first,
+   * and the memory holds its data. The ops write an output into the memory
+   * if it fits, otherwise the output is reallocated, which is told by
+   * SharesExternalData. The memory should be kept while it is shared.
+   */
+  void ShareExternalData(void* data, size_t length, PaddleDType dtype);
+
+  /** Tell whether the tensor is still in the memory shared by
+   * ShareExternalData.
+   */
+  bool SharesExternalData(const void* data) const;
+
   void SetLoD(const std::vector<std::vector<size_t>>& x);
   std::vector<std::vector<size_t>> lod() const;
   const std::string& name() const { return name_; }
@@ -197,6 +217,22 @@ class ZeroCopyTensor {
   PaddlePlace place_;
   PaddleDType dtype_;
   int device_;
+  // the cudaStream_t of the predictor to copy in if it owns one, or nullptr
+  // for the stream of the device
+  void* stream_{nullptr};
+};
+
+/** The latency stats of an op type or a subgraph engine, in microseconds.
+ * The quantiles are estimated by the histogram buckets, whose relative
+ * error is within 1/8.
+ */
+struct OpLatencyStats {
+  uint64_t count{0}; /*!< the times the ops ran. */
+  double mean_us{0};
+  double p50_us{0};
+  double p90_us{0};
+  double p99_us{0};
+  double max_us{0};
 };
 
 /** A simple Inference API for Paddle.
@@ -268,6 +304,42 @@ class PaddlePredictor {
    */
   virtual bool ZeroCopyRun() { return false; }
 
+  /**
+   * \brief Run the predictor with zero-copied inputs and outputs without
+   * waiting for the device.
+   *
+   * NOTE Only works in AnalysisPredictor.
+   *
+   * On GPU, the kernels are queued on the CUDA stream of the device, and the
+   * callback is called with whether the run succeeds from the stream
+   * callback thread of the device after they finish, where the outputs can
+   * be read. A slow callback delays the callbacks of the later runs on the
+   * device. Elsewhere the run is synchronous, and the callback is called
+   * before returning.
+   *
+   * The inputs should be kept, and the predictor should not be run again,
+   * until the callback is called. To run several requests at a time from one
+   * thread, run the clones of the predictor.
+   *
+   * \return Whether the run is queued, the callback is called whatever.
+   */
+  virtual bool ZeroCopyRunAsync(std::function<void(bool)> callback) {
+    bool success = ZeroCopyRun();
+    callback(success);
+    return success;
+  }
+
+  /** \brief Get the latency stats of the ops since the predictor was
+   * created, by the op types, or "type:engine_key" for the subgraph engine
+   * ops, e.g. tensorrt_engine.
+   *
+   * NOTE Only works in AnalysisPredictor with
+   * `AnalysisConfig.EnableOpLatencyStats()`. Each clone has its own stats.
+   */
+  virtual std::map<std::string, OpLatencyStats> GetOpLatencyStats() {
+    return {};
+  }
+
   /** Clone a predictor that share the model weights, the Cloned predictor
    * should be thread-safe.
    */
@@ -357,6 +429,34 @@ enum class PaddleEngineKind {
 template <typename ConfigT, PaddleEngineKind engine>
 std::unique_ptr<PaddlePredictor> CreatePaddlePredictor(const ConfigT& config);
 
+/** The configs of the predictor merging the concurrent requests into batches.
+ */
+struct BatchingConfig {
+  int max_batch_size{32}; /*!< the max total batch size of a run. */
+  int batch_timeout_us{1000}; /*!< the max time a request waits for others. */
+};
+
+/*! \fn std::unique_ptr<PaddlePredictor> CreateBatchingPredictor(
+ * std::unique_ptr<PaddlePredictor> predictor, const BatchingConfig& config);
+ *
+ * \brief Create a predictor whose thread-safe Run merges the requests of the
+ * concurrent callers into batches, which are run by `predictor`, e.g. to serve
+ * many clients with the batch size 1 efficiently on GPU.
+ *
+ * Usage:
+ *
+ * \code{.cpp}
+ * BatchingConfig batching_config;
+ * batching_config.max_batch_size = 16;
+ * auto predictor = CreateBatchingPredictor(CreatePaddlePredictor(config),
+ *                                          batching_config);
+ * // in each serving thread
+ * predictor->Run(inputs, &outputs);
+ * \endcode
+ */
+std::unique_ptr<PaddlePredictor> CreateBatchingPredictor(
+    std::unique_ptr<PaddlePredictor> predictor, const BatchingConfig& config);
+
 int PaddleDtypeSize(PaddleDType dtype);
 
 std::string get_version();
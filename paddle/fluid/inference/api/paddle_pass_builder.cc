@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/api/paddle_pass_builder.h"
+#include <algorithm>
 #ifdef PADDLE_WITH_CUDA
 #include <cudnn.h>
 #endif
@@ -105,6 +106,7 @@ GpuPassStrategy::GpuPassStrategy() : PassStrategy({}) {
     //   "identity_scale_op_clean_pass",             //
     "is_test_pass",                                  //
         "simplify_with_basic_ops_pass",              //
+        "constant_folding_pass",                     //
         "conv_affine_channel_fuse_pass",             //
         "conv_eltwiseadd_affine_channel_fuse_pass",  //
         "conv_bn_fuse_pass",                         //
@@ -120,6 +122,8 @@ GpuPassStrategy::GpuPassStrategy() : PassStrategy({}) {
         "conv_elementwise_add_fuse_pass",       //
 #endif                                          //
         "transpose_flatten_concat_fuse_pass",   //
+        // after the fusions of fc and conv2d, which need the dense weights
+        "block_sparse_weight_pass",  //
         // following pass should be located in the last, since it will
         // work on all fused ops.
         "runtime_context_cache_pass"
@@ -135,6 +139,18 @@ void GpuPassStrategy::EnableCUDNN() {
   use_cudnn_ = true;
 }
 
+void GpuPassStrategy::EnableNHWCLayout() {
+  if (!use_nhwc_layout_) {
+    // After the batch_norms are folded into the convs, and before the convs
+    // are fused into conv2d_fusion, which only supports NCHW.
+    auto it = std::find(passes_.begin(), passes_.end(),
+                        "conv_eltwiseadd_bn_fuse_pass");
+    passes_.insert(it == passes_.end() ? it : it + 1,
+                   "layout_propagation_pass");
+  }
+  use_nhwc_layout_ = true;
+}
+
 void GpuPassStrategy::EnableMKLDNN() {
   LOG(ERROR) << "GPU not support MKLDNN yet";
 }
@@ -151,10 +167,12 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
   // NOTE the large fusions should be located in the front, so that they will
   // not be damaged by smaller ones.
   passes_.assign({"simplify_with_basic_ops_pass",   //
+                  "constant_folding_pass",          //
                   "attention_lstm_fuse_pass",       //
                   "seqconv_eltadd_relu_fuse_pass",  //
                   // "seqpool_concat_fuse_pass",    //
                   "seqpool_cvm_concat_fuse_pass",  //
+                  "embedding_seqpool_cvm_concat_fuse_pass",  //
                   // "embedding_fc_lstm_fuse_pass", //
                   "fc_lstm_fuse_pass",                       //
                   "mul_lstm_fuse_pass",                      //
@@ -168,7 +186,10 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
                   "conv_eltwiseadd_bn_fuse_pass",            //
                   "conv_transpose_bn_fuse_pass",             //
                   "conv_transpose_eltwiseadd_bn_fuse_pass",  //
-                  "is_test_pass",                            //
+                  // after the fusions of fc and conv2d, which need the
+                  // dense weights
+                  "block_sparse_weight_pass",  //
+                  "is_test_pass",              //
                   // following pass should be located in the last, since
                   // it will work on all fused ops.
                   "runtime_context_cache_pass"});
@@ -178,6 +199,10 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
 
 void CpuPassStrategy::EnableCUDNN() { LOG(ERROR) << "CPU not support cuDNN"; }
 
+void CpuPassStrategy::EnableNHWCLayout() {
+  LOG(ERROR) << "CPU not support NHWC layout propagation";
+}
+
 void CpuPassStrategy::EnableMKLDNN() {
 // TODO(Superjomn) Consider the way to mix CPU with GPU.
 #ifdef PADDLE_WITH_MKLDNN
@@ -102,6 +102,10 @@ class PassStrategy : public PaddlePassBuilder {
    */
   virtual void EnableMkldnnQuantizer() {}
 
+  /** Enable running the conv regions in NHWC
+   */
+  virtual void EnableNHWCLayout() {}
+
   bool use_gpu() const { return use_gpu_; }
 
   virtual ~PassStrategy() = default;
@@ -132,6 +136,7 @@ class CpuPassStrategy : public PassStrategy {
   void EnableNgraph() override;
   void EnableMKLDNN() override;
   void EnableMkldnnQuantizer() override;
+  void EnableNHWCLayout() override;
 
  protected:
   bool use_ngraph_{false};
@@ -148,17 +153,20 @@ class GpuPassStrategy : public PassStrategy {
       : PassStrategy(other.AllPasses()) {
     use_gpu_ = true;
     use_cudnn_ = other.use_cudnn_;
+    use_nhwc_layout_ = other.use_nhwc_layout_;
   }
 
   void EnableCUDNN() override;
   void EnableNgraph() override;
   void EnableMKLDNN() override;
   void EnableMkldnnQuantizer() override;
+  void EnableNHWCLayout() override;
 
   virtual ~GpuPassStrategy() = default;
 
  protected:
   bool use_cudnn_{false};
+  bool use_nhwc_layout_{false};
 };
 
 extern const std::vector<std::string> kTRTSubgraphPasses;
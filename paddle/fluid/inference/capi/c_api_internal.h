@@ -15,6 +15,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "paddle/fluid/inference/api/paddle_analysis_config.h"
 #include "paddle/fluid/inference/api/paddle_api.h"
 #include "paddle/fluid/inference/capi/paddle_c_api.h"
@@ -37,6 +39,19 @@ struct PD_PaddleBuf {
 
 struct PD_Predictor {
   std::unique_ptr<paddle::PaddlePredictor> predictor;
+  // the names returned by PD_GetOpLatencyStats
+  std::vector<std::string> op_latency_names;
+};
+
+struct PD_ZeroCopyBinding {
+  struct Output {
+    std::unique_ptr<paddle::ZeroCopyTensor> tensor;
+    void* data;
+    size_t capacity;
+    PD_DataType dtype;
+  };
+  PD_Predictor* predictor;
+  std::vector<Output> outputs;
 };
 
 namespace paddle {
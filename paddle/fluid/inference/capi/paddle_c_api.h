@@ -39,6 +39,7 @@ typedef enum PD_DataType PD_DataType;
 typedef struct PD_PaddleBuf PD_PaddleBuf;
 typedef struct PD_AnalysisConfig PD_AnalysisConfig;
 typedef struct PD_Predictor PD_Predictor;
+typedef struct PD_ZeroCopyBinding PD_ZeroCopyBinding;
 
 typedef struct PD_Buffer {
   void* data;
@@ -67,6 +68,15 @@ typedef struct PD_ZeroCopyData {
   int* shape;
   int shape_size;
 } PD_ZeroCopyData;
+typedef struct PD_OpLatencyStats {
+  const char* name;
+  uint64_t count;
+  double mean_us;
+  double p50_us;
+  double p90_us;
+  double p99_us;
+  double max_us;
+} PD_OpLatencyStats;
 typedef struct InTensorShape {
   char* name;
   int* tensor_shape;
@@ -259,6 +269,12 @@ PADDLE_CAPI_EXPORT extern void PD_EnableProfile(PD_AnalysisConfig* config);
 PADDLE_CAPI_EXPORT extern bool PD_ProfileEnabled(
     const PD_AnalysisConfig* config);
 
+PADDLE_CAPI_EXPORT extern void PD_EnableOpLatencyStats(
+    PD_AnalysisConfig* config, bool x);
+
+PADDLE_CAPI_EXPORT extern bool PD_OpLatencyStatsEnabled(
+    const PD_AnalysisConfig* config);
+
 PADDLE_CAPI_EXPORT extern void PD_SetInValid(PD_AnalysisConfig* config);
 
 PADDLE_CAPI_EXPORT extern bool PD_IsValid(const PD_AnalysisConfig* config);
@@ -273,6 +289,11 @@ PADDLE_CAPI_EXPORT extern PD_Predictor* PD_NewPredictor(
 
 PADDLE_CAPI_EXPORT extern void PD_DeletePredictor(PD_Predictor* predictor);
 
+// Create a predictor sharing the parameters of the predictor, to run in
+// another thread.
+PADDLE_CAPI_EXPORT extern PD_Predictor* PD_ClonePredictor(
+    const PD_Predictor* predictor);
+
 PADDLE_CAPI_EXPORT extern int PD_GetInputNum(const PD_Predictor*);
 
 PADDLE_CAPI_EXPORT extern int PD_GetOutputNum(const PD_Predictor*);
@@ -290,6 +311,56 @@ PADDLE_CAPI_EXPORT extern void PD_GetZeroCopyOutput(PD_Predictor* predictor,
 
 PADDLE_CAPI_EXPORT extern void PD_ZeroCopyRun(PD_Predictor* predictor);
 
+// Called with whether the run succeeds and the user_data passed to
+// PD_ZeroCopyRunAsync.
+typedef void (*PD_ZeroCopyRunCallback)(bool success, void* user_data);
+
+// Queue the run on the GPU and return without waiting for it, the callback
+// is called after it finishes. Elsewhere the run is synchronous. The
+// predictor should not be run again until the callback is called.
+PADDLE_CAPI_EXPORT extern bool PD_ZeroCopyRunAsync(
+    PD_Predictor* predictor, PD_ZeroCopyRunCallback callback, void* user_data);
+
+// The binding of the caller-owned memory to the inputs and outputs of a
+// predictor with SwitchUseFeedFetchOps off. After binding once, each
+// PD_ZeroCopyRunBound reads the inputs from and writes the outputs into the
+// bound memory, in the place of the predictor, without copy or allocation
+// in the C API. The temporaries of the ops can be placed without allocation
+// too by the static memory plan.
+PADDLE_CAPI_EXPORT extern PD_ZeroCopyBinding* PD_NewZeroCopyBinding(
+    PD_Predictor* predictor);
+
+PADDLE_CAPI_EXPORT extern void PD_DeleteZeroCopyBinding(
+    PD_ZeroCopyBinding* binding);
+
+// Bind the data of the shape to the input, which is bound again when its
+// data or shape changes.
+PADDLE_CAPI_EXPORT extern void PD_ZeroCopyBindInput(
+    PD_ZeroCopyBinding* binding, const char* name, void* data,
+    PD_DataType dtype, const int* shape, int shape_size);
+
+// Bind the memory of capacity bytes to the output, and return its index.
+// The output is copied into the memory if an op replaces its memory, and an
+// output larger than the memory fails the run.
+PADDLE_CAPI_EXPORT extern int PD_ZeroCopyBindOutput(
+    PD_ZeroCopyBinding* binding, const char* name, void* data,
+    size_t capacity, PD_DataType dtype);
+
+PADDLE_CAPI_EXPORT extern bool PD_ZeroCopyRunBound(
+    PD_ZeroCopyBinding* binding);
+
+// Copy at most capacity dimensions of the shape of the output of the index
+// after a run into shape, and return its rank.
+PADDLE_CAPI_EXPORT extern int PD_ZeroCopyBoundOutputShape(
+    const PD_ZeroCopyBinding* binding, int index, int* shape, int capacity);
+
+// Fill the latency stats of at most capacity op types or subgraph engines
+// into stats, and return the number of them all. The names are valid until
+// the next call with the predictor.
+PADDLE_CAPI_EXPORT extern int PD_GetOpLatencyStats(PD_Predictor* predictor,
+                                                   PD_OpLatencyStats* stats,
+                                                   int capacity);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -250,6 +250,16 @@ bool PD_ProfileEnabled(const PD_AnalysisConfig* config) {
   return config->config.profile_enabled();
 }
 
+void PD_EnableOpLatencyStats(PD_AnalysisConfig* config, bool x) {
+  PADDLE_ENFORCE_NOT_NULL(config);
+  config->config.EnableOpLatencyStats(x);
+}
+
+bool PD_OpLatencyStatsEnabled(const PD_AnalysisConfig* config) {
+  PADDLE_ENFORCE_NOT_NULL(config);
+  return config->config.op_latency_stats_enabled();
+}
+
 void PD_SetInValid(PD_AnalysisConfig* config) {
   PADDLE_ENFORCE_NOT_NULL(config);
   config->config.SetInValid();
@@ -53,6 +53,28 @@ inline void VisitDataType(PD_DataType type, Visitor visitor) {
       paddle::platform::errors::InvalidArgument("Unsupported data type."));
 }
 
+// Copy the output reallocated by the ops into the bound memory.
+struct PD_BoundOutputCopyFunctor {
+  const PD_ZeroCopyBinding::Output* output;
+  bool* success;
+
+  template <typename OutT>
+  void apply() {
+    paddle::PaddlePlace place;
+    int size = 0;
+    const OutT* data = output->tensor->data<OutT>(&place, &size);
+    size_t length = size * sizeof(OutT);
+    if (place != paddle::PaddlePlace::kCPU || length > output->capacity) {
+      LOG(ERROR) << "the output [" << output->tensor->name() << "] of "
+                 << length << " bytes does not fit the bound memory of "
+                 << output->capacity << " bytes";
+      *success = false;
+      return;
+    }
+    std::memcpy(output->data, data, length);
+  }
+};
+
 struct PD_ZeroCopyFunctor {
   PD_ZeroCopyData* output_i;
   paddle::ZeroCopyTensor* output_t;
@@ -187,6 +209,13 @@ void PD_DeletePredictor(PD_Predictor* predictor) {
   }
 }
 
+PD_Predictor* PD_ClonePredictor(const PD_Predictor* predictor) {
+  PADDLE_ENFORCE_NOT_NULL(predictor);
+  PD_Predictor* cloned = new PD_Predictor;
+  cloned->predictor = predictor->predictor->Clone();
+  return cloned;
+}
+
 int PD_GetInputNum(const PD_Predictor* predictor) {
   return static_cast<int>(predictor->predictor->GetInputNames().size());
 }
@@ -302,4 +331,100 @@ void PD_GetZeroCopyOutput(PD_Predictor* predictor, PD_ZeroCopyTensor* tensor) {
 void PD_ZeroCopyRun(PD_Predictor* predictor) {
   predictor->predictor->ZeroCopyRun();
 }
+
+bool PD_ZeroCopyRunAsync(PD_Predictor* predictor,
+                         PD_ZeroCopyRunCallback callback, void* user_data) {
+  PADDLE_ENFORCE_NOT_NULL(
+      callback, paddle::platform::errors::InvalidArgument(
+                    "The callback of PD_ZeroCopyRunAsync should not be null."));
+  return predictor->predictor->ZeroCopyRunAsync(
+      [callback, user_data](bool success) { callback(success, user_data); });
+}
+
+PD_ZeroCopyBinding* PD_NewZeroCopyBinding(PD_Predictor* predictor) {
+  PADDLE_ENFORCE_NOT_NULL(predictor);
+  PD_ZeroCopyBinding* binding = new PD_ZeroCopyBinding;
+  binding->predictor = predictor;
+  return binding;
+}
+
+void PD_DeleteZeroCopyBinding(PD_ZeroCopyBinding* binding) {
+  delete binding;
+}
+
+void PD_ZeroCopyBindInput(PD_ZeroCopyBinding* binding, const char* name,
+                          void* data, PD_DataType dtype, const int* shape,
+                          int shape_size) {
+  PADDLE_ENFORCE_NOT_NULL(binding);
+  auto input = binding->predictor->predictor->GetInputTensor(name);
+  std::vector<int> dims(shape, shape + shape_size);
+  input->Reshape(dims);
+  size_t length = paddle::PaddleDtypeSize(ConvertToPaddleDType(dtype));
+  for (int dim : dims) {
+    length *= dim;
+  }
+  input->ShareExternalData(data, length, ConvertToPaddleDType(dtype));
+}
+
+int PD_ZeroCopyBindOutput(PD_ZeroCopyBinding* binding, const char* name,
+                          void* data, size_t capacity, PD_DataType dtype) {
+  PADDLE_ENFORCE_NOT_NULL(binding);
+  PD_ZeroCopyBinding::Output output;
+  output.tensor = binding->predictor->predictor->GetOutputTensor(name);
+  output.data = data;
+  output.capacity = capacity;
+  output.dtype = dtype;
+  output.tensor->ShareExternalData(data, capacity,
+                                   ConvertToPaddleDType(dtype));
+  binding->outputs.push_back(std::move(output));
+  return static_cast<int>(binding->outputs.size()) - 1;
+}
+
+bool PD_ZeroCopyRunBound(PD_ZeroCopyBinding* binding) {
+  PADDLE_ENFORCE_NOT_NULL(binding);
+  if (!binding->predictor->predictor->ZeroCopyRun()) return false;
+  bool success = true;
+  for (auto& output : binding->outputs) {
+    if (output.tensor->SharesExternalData(output.data)) continue;
+    // Rarely an op replaces the memory of the output, e.g. by sharing the
+    // memory of its input, then the output is copied.
+    VisitDataType(output.dtype, PD_BoundOutputCopyFunctor{&output, &success});
+  }
+  return success;
+}
+
+int PD_ZeroCopyBoundOutputShape(const PD_ZeroCopyBinding* binding, int index,
+                                int* shape, int capacity) {
+  PADDLE_ENFORCE_NOT_NULL(binding);
+  PADDLE_ENFORCE_LT(
+      index, static_cast<int>(binding->outputs.size()),
+      paddle::platform::errors::OutOfRange(
+          "The index %d of the bound output is out of range.", index));
+  return binding->outputs[index].tensor->CopyShapeTo(shape, capacity);
+}
+
+int PD_GetOpLatencyStats(PD_Predictor* predictor, PD_OpLatencyStats* stats,
+                         int capacity) {
+  PADDLE_ENFORCE_NOT_NULL(predictor);
+  auto all_stats = predictor->predictor->GetOpLatencyStats();
+  auto& names = predictor->op_latency_names;
+  names.clear();
+  for (auto& item : all_stats) {
+    names.push_back(item.first);
+  }
+  int i = 0;
+  for (auto& item : all_stats) {
+    if (i >= capacity) break;
+    auto& op_stats = item.second;
+    stats[i].name = names[i].c_str();
+    stats[i].count = op_stats.count;
+    stats[i].mean_us = op_stats.mean_us;
+    stats[i].p50_us = op_stats.p50_us;
+    stats[i].p90_us = op_stats.p90_us;
+    stats[i].p99_us = op_stats.p99_us;
+    stats[i].max_us = op_stats.max_us;
+    ++i;
+  }
+  return static_cast<int>(all_stats.size());
+}
 }  // extern "C"
@@ -16,11 +16,15 @@ limitations under the License. */
 
 #include <algorithm>
 #include <fstream>
+#include <thread>  // NOLINT
 #include <vector>
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/version.h"
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/pybind/pybind.h"
 
@@ -56,6 +60,31 @@ void ReadBinaryFile(const std::string& filename, std::string* contents) {
   fin.close();
 }
 
+// Load the persistables from the indexed tensors file directly, without the
+// load program, which maps the file or reads the tensors in parallel.
+void LoadIndexedPersistables(const platform::Place& place,
+                             framework::Scope* scope,
+                             const std::vector<std::string>& paramlist,
+                             const std::string& param_filename,
+                             bool use_mmap) {
+  std::vector<framework::LoDTensor*> tensors;
+  for (auto& name : paramlist) {
+    tensors.push_back(scope->Var(name)->GetMutable<framework::LoDTensor>());
+  }
+#ifndef _WIN32
+  if (use_mmap && platform::is_cpu_place(place)) {
+    std::shared_ptr<memory::Allocation> mapping =
+        memory::allocation::AllocateMemoryMapFileAllocation(param_filename);
+    framework::DeserializeIndexedFromMemory(mapping, tensors);
+    return;
+  }
+#endif
+  int num_threads =
+      std::max<unsigned>(1, std::thread::hardware_concurrency());
+  framework::DeserializeIndexedFromFile(param_filename, tensors, place,
+                                        num_threads);
+}
+
 bool IsPersistable(const framework::VarDesc* var) {
   if (var->Persistable() &&
       var->GetType() != framework::proto::VarType::FEED_MINIBATCH &&
@@ -70,7 +99,7 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
                       const std::string& param_filename,
-                      bool model_from_memory = false) {
+                      bool model_from_memory, bool use_mmap) {
   const framework::BlockDesc& global_block = main_program.Block(0);
 
   framework::ProgramDesc* load_program = new framework::ProgramDesc();
@@ -101,6 +130,7 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
         op->SetType("load");
         op->SetOutput("Out", {new_var->Name()});
         op->SetAttr("file_path", {dirname + "/" + new_var->Name()});
+        op->SetAttr("use_mmap", use_mmap);
         op->CheckAttrs();
       }
     }
@@ -109,12 +139,20 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
   if (!param_filename.empty()) {
     // sort paramlist to have consistent ordering
     std::sort(paramlist.begin(), paramlist.end());
+    if (!model_from_memory &&
+        framework::IsIndexedTensorsFile(param_filename)) {
+      LoadIndexedPersistables(executor->GetPlace(), scope, paramlist,
+                              param_filename, use_mmap);
+      delete load_program;
+      return;
+    }
     // append just the load_combine op
     framework::OpDesc* op = load_block->AppendOp();
     op->SetType("load_combine");
     op->SetOutput("Out", paramlist);
     op->SetAttr("file_path", {param_filename});
     op->SetAttr("model_from_memory", {model_from_memory});
+    op->SetAttr("use_mmap", use_mmap);
     op->CheckAttrs();
   }
 
@@ -125,7 +163,8 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
 
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
-                                             const std::string& dirname) {
+                                             const std::string& dirname,
+                                             bool use_mmap) {
   std::string model_filename = dirname + "/__model__";
   std::string program_desc_str;
   VLOG(3) << "loading model from " << model_filename;
@@ -139,13 +178,14 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
 
   // model_from_memory is false in separate parameters.
   LoadPersistables(executor, scope, *main_program, dirname, "",
-                   false /* model_from_memory */);
+                   false /* model_from_memory */, use_mmap);
   return main_program;
 }
 
 std::unique_ptr<framework::ProgramDesc> Load(
     framework::Executor* executor, framework::Scope* scope,
-    const std::string& prog_filename, const std::string& param_filename) {
+    const std::string& prog_filename, const std::string& param_filename,
+    bool use_mmap) {
   std::string program_desc_str;
   ReadBinaryFile(prog_filename, &program_desc_str);
 
@@ -156,7 +196,7 @@ std::unique_ptr<framework::ProgramDesc> Load(
                  main_program->Version());
 
   LoadPersistables(executor, scope, *main_program, "", param_filename,
-                   false /* model_from_memory */);
+                   false /* model_from_memory */, use_mmap);
   return main_program;
 }
 
@@ -31,16 +31,20 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
                       const std::string& param_filename,
-                      bool model_from_memory);
+                      bool model_from_memory, bool use_mmap = false);
 
+// The parameter files are memory mapped if use_mmap is true, see the
+// use_mmap attribute of load_op and load_combine_op.
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
-                                             const std::string& dirname);
+                                             const std::string& dirname,
+                                             bool use_mmap = false);
 
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& prog_filename,
-                                             const std::string& param_filename);
+                                             const std::string& param_filename,
+                                             bool use_mmap = false);
 
 std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
     framework::Executor* executor, framework::Scope* scope,
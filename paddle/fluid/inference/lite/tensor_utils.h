@@ -27,6 +27,11 @@ template <typename DstTensor, typename SrcTensor>
 void TensorCopyAsync(DstTensor* dst, const SrcTensor& src,
                      const platform::DeviceContext& ctx);
 
+// Bind dst to the memory of src without copying. The memory is still owned
+// by src, so dst is only valid until src is resized or released.
+template <typename DstTensor, typename SrcTensor>
+void TensorDataShare(DstTensor* dst, const SrcTensor& src);
+
 }  // namespace utils
 }  // namespace lite
 }  // namespace inference
@@ -110,6 +110,29 @@ TEST(LiteEngineOp, TensorCopyAsync) {
 #endif
 }
 
+TEST(LiteEngineOp, TensorDataShare) {
+  std::vector<float> vector({1, 2, 3, 4});
+  framework::LoDTensor lod_tensor;
+  framework::TensorFromVector(vector, &lod_tensor);
+  framework::LoD lod({{0, 2, 4}});
+  lod_tensor.Resize({4, 1});
+  lod_tensor.set_lod(lod);
+  // Share with lite::Tensor.
+  paddle::lite::Tensor lite_tensor;
+  TensorDataShare(&lite_tensor, lod_tensor);
+  ASSERT_EQ(lite_tensor.raw_data(), lod_tensor.data<void>());
+  ASSERT_EQ(lite_tensor.dims().Vectorize(),
+            framework::vectorize(lod_tensor.dims()));
+  // Share back to LoDTensor.
+  framework::LoDTensor lod_tensor_n;
+  TensorDataShare(&lod_tensor_n, lite_tensor);
+  ASSERT_EQ(lod_tensor_n.data<void>(), lod_tensor.data<void>());
+  std::vector<float> result;
+  TensorToVector(lod_tensor_n, &result);
+  ASSERT_EQ(result, vector);
+  ASSERT_EQ(lod_tensor_n.lod(), lod_tensor.lod());
+}
+
 }  // namespace utils
 }  // namespace lite
 }  // namespace inference
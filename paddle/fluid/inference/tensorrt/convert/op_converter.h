@@ -137,7 +137,18 @@ class OpConverter {
         std::vector<int64_t> input_shape;
         input_shape.push_back(-1);
         for (size_t i = 1; i < ranks; i++) {
-          if (min_input_shape[i] != max_input_shape[i]) {
+          // the dim varying among the optimization profiles is dynamic too
+          bool varying = false;
+          for (int profile = 1; profile < engine->profile_num(); ++profile) {
+            auto min_shape = engine->min_input_shape(profile)[input];
+            auto max_shape = engine->max_input_shape(profile)[input];
+            if (min_shape.size() != ranks || max_shape.size() != ranks ||
+                min_shape[i] != min_input_shape[i] ||
+                max_shape[i] != min_input_shape[i]) {
+              varying = true;
+            }
+          }
+          if (varying || min_input_shape[i] != max_input_shape[i]) {
             input_shape.push_back(-1);
           } else {
             input_shape.push_back(min_input_shape[i]);
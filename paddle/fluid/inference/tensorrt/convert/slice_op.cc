@@ -0,0 +1,69 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+#include "paddle/fluid/inference/tensorrt/plugin/slice_op_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+class SliceOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert fluid slice op to tensorrt layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    int input_num = op_desc.Input("Input").size();
+    PADDLE_ENFORCE_EQ(input_num, 1,
+                      platform::errors::InvalidArgument(
+                          "The slice op converter expects 1 input, but got %d.",
+                          input_num));
+    auto* input = engine_->GetITensor(op_desc.Input("Input")[0]);
+    auto input_dims = input->getDimensions();
+
+    // Get attrs, and the axes of the input dims without the batch
+    auto starts = boost::get<std::vector<int>>(op_desc.GetAttr("starts"));
+    auto ends = boost::get<std::vector<int>>(op_desc.GetAttr("ends"));
+    auto axes = boost::get<std::vector<int>>(op_desc.GetAttr("axes"));
+    PADDLE_ENFORCE_EQ(
+        starts.size() == axes.size() && ends.size() == axes.size(), true,
+        platform::errors::InvalidArgument(
+            "The starts, ends and axes of the slice op should be of the same "
+            "size, but got %d, %d and %d.",
+            starts.size(), ends.size(), axes.size()));
+    for (auto& axis : axes) {
+      // slice on batch is not supported in TensorRT
+      PADDLE_ENFORCE_NE(axis, 0, platform::errors::InvalidArgument(
+                                     "The slice op on the batch axis can not "
+                                     "be converted to TensorRT."));
+      axis += (axis < 0) ? input_dims.nbDims : -1;
+    }
+
+    plugin::SlicePlugin* plugin = new plugin::SlicePlugin(starts, ends, axes);
+    nvinfer1::IPluginLayer* layer =
+        engine_->AddPlugin(&input, input_num, plugin);
+
+    auto output_name = op_desc.Output("Out")[0];
+    RreplenishLayerAndOutput(layer, "slice", {output_name}, test_mode);
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(slice, SliceOpConverter);
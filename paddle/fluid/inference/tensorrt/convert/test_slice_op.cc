@@ -0,0 +1,51 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+#include "paddle/fluid/inference/tensorrt/convert/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+TEST(slice_op, test_slice) {
+  std::unordered_set<std::string> parameters;
+  framework::Scope scope;
+  TRTConvertValidation validator(10, parameters, scope, 1000);
+  validator.DeclInputVar("slice_input", nvinfer1::DimsCHW(3, 4, 5));
+  validator.DeclOutputVar("slice_out", nvinfer1::DimsCHW(2, 4, 2));
+
+  // Prepare Op description
+  framework::OpDesc desc;
+  desc.SetType("slice");
+  desc.SetInput("Input", {"slice_input"});
+  desc.SetOutput("Out", {"slice_out"});
+
+  desc.SetAttr("axes", std::vector<int>({1, 3}));
+  desc.SetAttr("starts", std::vector<int>({1, -3}));
+  desc.SetAttr("ends", std::vector<int>({10, -1}));
+  desc.SetAttr("decrease_axis", std::vector<int>());
+
+  validator.SetOp(*desc.Proto());
+
+  validator.Execute(1);
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP(slice);
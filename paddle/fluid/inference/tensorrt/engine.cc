@@ -39,7 +39,10 @@ void TensorRTEngine::InitNetwork() {
             nvinfer1::NetworkDefinitionCreationFlag::kEXPLICIT_BATCH)));
     infer_builder_config_.reset(infer_builder_->createBuilderConfig());
     infer_ptr<nvinfer1::IBuilderConfig> infer_builder_config_;
-    optim_profile_.reset(infer_builder_->createOptimizationProfile());
+    optim_profiles_.clear();
+    for (int i = 0; i < profile_num(); ++i) {
+      optim_profiles_.push_back(infer_builder_->createOptimizationProfile());
+    }
 #endif
   } else {
     infer_network_.reset(infer_builder_->createNetwork());
@@ -47,9 +50,9 @@ void TensorRTEngine::InitNetwork() {
 }
 
 void TensorRTEngine::Execute(int batch_size, std::vector<void *> *buffers,
-                             cudaStream_t stream) {
+                             cudaStream_t stream, int profile) {
   freshDeviceId();
-  auto infer_context = context();
+  auto infer_context = context(profile);
   if (!with_dynamic_shape()) {
     infer_context->enqueue(batch_size, buffers->data(), stream, nullptr);
   } else {
@@ -148,18 +151,23 @@ void TensorRTEngine::FreezeNetwork() {
 
   if (with_dynamic_shape_) {
 #if IS_TRT_VERSION_GE(6000)
-    for (auto &input : min_input_shape_) {
-      optim_profile_->setDimensions(
-          input.first.c_str(), nvinfer1::OptProfileSelector::kMIN,
-          Vec2TRT_Dims(input.second, input.first, true));
-      optim_profile_->setDimensions(
-          input.first.c_str(), nvinfer1::OptProfileSelector::kMAX,
-          Vec2TRT_Dims(max_input_shape_[input.first], input.first, true));
-      optim_profile_->setDimensions(
-          input.first.c_str(), nvinfer1::OptProfileSelector::kOPT,
-          Vec2TRT_Dims(optim_input_shape_[input.first], input.first, true));
+    for (int i = 0; i < profile_num(); ++i) {
+      auto *optim_profile = optim_profiles_[i];
+      auto max_input_shape = this->max_input_shape(i);
+      auto optim_input_shape = this->optim_input_shape(i);
+      for (auto &input : min_input_shape(i)) {
+        optim_profile->setDimensions(
+            input.first.c_str(), nvinfer1::OptProfileSelector::kMIN,
+            Vec2TRT_Dims(input.second, input.first, true));
+        optim_profile->setDimensions(
+            input.first.c_str(), nvinfer1::OptProfileSelector::kMAX,
+            Vec2TRT_Dims(max_input_shape[input.first], input.first, true));
+        optim_profile->setDimensions(
+            input.first.c_str(), nvinfer1::OptProfileSelector::kOPT,
+            Vec2TRT_Dims(optim_input_shape[input.first], input.first, true));
+      }
+      infer_builder_config_->addOptimizationProfile(optim_profile);
     }
-    infer_builder_config_->addOptimizationProfile(optim_profile_.get());
     if (WithFp16()) {
       infer_builder_config_->setFlag(nvinfer1::BuilderFlag::kFP16);
       if (disable_trt_plugin_fp16()) {
@@ -280,6 +288,74 @@ nvinfer1::IPluginLayer *TensorRTEngine::AddPlugin(
   return network()->addPluginExt(inputs, num_inputs, *plugin);
 }
 
+void TensorRTEngine::AddShapeProfile(const ShapeMapType &min_input_shape,
+                                     const ShapeMapType &max_input_shape,
+                                     const ShapeMapType &optim_input_shape) {
+  PADDLE_ENFORCE_EQ(with_dynamic_shape_, true,
+                    platform::errors::PreconditionNotMet(
+                        "The optimization profiles can only be added in the "
+                        "dynamic shape mode."));
+  for (auto *shapes : {&min_input_shape, &max_input_shape,
+                       &optim_input_shape}) {
+    PADDLE_ENFORCE_EQ(shapes->size(), min_input_shape_.size(),
+                      platform::errors::InvalidArgument(
+                          "The optimization profile should have %d inputs "
+                          "as the first one, but got %d.",
+                          min_input_shape_.size(), shapes->size()));
+    for (auto &input : min_input_shape_) {
+      PADDLE_ENFORCE_EQ(shapes->count(input.first), 1UL,
+                        platform::errors::InvalidArgument(
+                            "The input %s is missing in the optimization "
+                            "profile.",
+                            input.first));
+    }
+  }
+  extra_min_input_shapes_.push_back(min_input_shape);
+  extra_max_input_shapes_.push_back(max_input_shape);
+  extra_optim_input_shapes_.push_back(optim_input_shape);
+}
+
+int TensorRTEngine::SelectProfile(
+    const std::map<std::string, std::vector<int64_t>> &input_shapes) {
+  if (profile_num() == 1) return 0;
+  for (int i = 0; i < profile_num(); ++i) {
+    auto min_input_shape = this->min_input_shape(i);
+    auto max_input_shape = this->max_input_shape(i);
+    bool contained = true;
+    for (auto &input : input_shapes) {
+      auto it = min_input_shape.find(input.first);
+      if (it == min_input_shape.end()) continue;
+      auto &min_shape = it->second;
+      auto &max_shape = max_input_shape[input.first];
+      auto &shape = input.second;
+      if (shape.size() != min_shape.size()) {
+        contained = false;
+        break;
+      }
+      for (size_t j = 0; j < shape.size(); ++j) {
+        if (shape[j] < min_shape[j] || shape[j] > max_shape[j]) {
+          contained = false;
+          break;
+        }
+      }
+      if (!contained) break;
+    }
+    if (contained) return i;
+  }
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "The input shapes are out of the ranges of all the %d optimization "
+      "profiles of the TensorRT engine.",
+      profile_num()));
+}
+
+int TensorRTEngine::GetBindingIndex(const std::string &name, int profile) {
+  int index = infer_engine_->getBindingIndex(name.c_str());
+  if (profile > 0) {
+    index += profile * (infer_engine_->getNbBindings() / profile_num());
+  }
+  return index;
+}
+
 void TensorRTEngine::freshDeviceId() {
   int count;
   cudaGetDeviceCount(&count);
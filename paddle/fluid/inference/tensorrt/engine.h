@@ -177,17 +177,33 @@ class TensorRTEngine {
   nvinfer1::ITensor* GetITensor(const std::string& name);
 
   nvinfer1::ICudaEngine* engine() { return infer_engine_.get(); }
-  nvinfer1::IExecutionContext* context() {
+  // Get the execution context of the current thread, which runs with the
+  // profile-th optimization profile.
+  nvinfer1::IExecutionContext* context(int profile = 0) {
     std::unique_lock<std::mutex> lock(mutex_);
     const std::thread::id tid = std::this_thread::get_id();
-    if (infer_context_.find(tid) == infer_context_.end()) {
+    auto& contexts = infer_context_[tid];
+    if (contexts.size() <= static_cast<size_t>(profile)) {
+      contexts.resize(profile + 1);
+    }
+    if (contexts[profile] == nullptr) {
       PADDLE_ENFORCE_NOT_NULL(
           infer_engine_,
           platform::errors::InvalidArgument(
               "You should build engine first and then set the context."));
-      infer_context_[tid].reset(infer_engine_->createExecutionContext());
+      contexts[profile].reset(infer_engine_->createExecutionContext());
+#if IS_TRT_VERSION_GE(6000)
+      if (profile > 0) {
+        PADDLE_ENFORCE_EQ(
+            contexts[profile]->setOptimizationProfile(profile), true,
+            platform::errors::Unavailable(
+                "Fail to set the optimization profile %d of the TensorRT "
+                "execution context, it may be used by another context.",
+                profile));
+      }
+#endif
     }
-    return infer_context_[tid].get();
+    return contexts[profile].get();
   }
 
   nvinfer1::IHostMemory* Serialize() {
@@ -260,7 +276,26 @@ class TensorRTEngine {
   // environment.
   void FreezeNetwork();
   void Execute(int batch_size, std::vector<void*>* buffers,
-               cudaStream_t stream = nullptr);
+               cudaStream_t stream = nullptr, int profile = 0);
+
+  // Add an optimization profile for the dynamic shape mode besides the one
+  // given at the construction, which should have the same inputs. It should
+  // be called before FreezeNetwork or Deserialize.
+  void AddShapeProfile(const ShapeMapType& min_input_shape,
+                       const ShapeMapType& max_input_shape,
+                       const ShapeMapType& optim_input_shape);
+  int profile_num() const {
+    if (!with_dynamic_shape_) return 1;
+    return 1 + static_cast<int>(extra_min_input_shapes_.size());
+  }
+  // Select the first optimization profile whose range contains the shapes of
+  // the inputs.
+  int SelectProfile(
+      const std::map<std::string, std::vector<int64_t>>& input_shapes);
+  // The binding index of the input or output name for the profile-th
+  // optimization profile, the bindings of each profile are placed one
+  // after another.
+  int GetBindingIndex(const std::string& name, int profile = 0);
 
   nvinfer1::INetworkDefinition* network() {
     if (with_dynamic_shape_) {
@@ -273,6 +308,18 @@ class TensorRTEngine {
   ShapeMapType min_input_shape() { return min_input_shape_; }
   ShapeMapType max_input_shape() { return max_input_shape_; }
   ShapeMapType optim_input_shape() { return optim_input_shape_; }
+  ShapeMapType min_input_shape(int profile) {
+    return profile == 0 ? min_input_shape_
+                        : extra_min_input_shapes_[profile - 1];
+  }
+  ShapeMapType max_input_shape(int profile) {
+    return profile == 0 ? max_input_shape_
+                        : extra_max_input_shapes_[profile - 1];
+  }
+  ShapeMapType optim_input_shape(int profile) {
+    return profile == 0 ? optim_input_shape_
+                        : extra_optim_input_shapes_[profile - 1];
+  }
   bool disable_trt_plugin_fp16() { return disable_trt_plugin_fp16_; }
   bool with_dynamic_shape() { return with_dynamic_shape_; }
 
@@ -307,6 +354,10 @@ class TensorRTEngine {
   ShapeMapType min_input_shape_;
   ShapeMapType max_input_shape_;
   ShapeMapType optim_input_shape_;
+  // the optimization profiles besides the first one above
+  std::vector<ShapeMapType> extra_min_input_shapes_;
+  std::vector<ShapeMapType> extra_max_input_shapes_;
+  std::vector<ShapeMapType> extra_optim_input_shapes_;
   bool disable_trt_plugin_fp16_{false};
   nvinfer1::ILogger& logger_;
 
@@ -330,7 +381,9 @@ class TensorRTEngine {
   infer_ptr<nvinfer1::IBuilder> infer_builder_;
   infer_ptr<nvinfer1::INetworkDefinition> infer_network_;
   infer_ptr<nvinfer1::ICudaEngine> infer_engine_;
-  std::unordered_map<std::thread::id, infer_ptr<nvinfer1::IExecutionContext>>
+  // the execution contexts of each thread, indexed by the profiles
+  std::unordered_map<std::thread::id,
+                     std::vector<infer_ptr<nvinfer1::IExecutionContext>>>
       infer_context_;
   infer_ptr<nvinfer1::IHostMemory> ihost_memory_;
   std::unordered_map<nvinfer1::ITensor*, float> quant_dynamic_range_;
@@ -340,7 +393,8 @@ class TensorRTEngine {
   infer_ptr<nvinfer1::INetworkDefinition> infer_networkv2_;
 #if IS_TRT_VERSION_GE(6000)
   infer_ptr<nvinfer1::IBuilderConfig> infer_builder_config_;
-  std::unique_ptr<nvinfer1::IOptimizationProfile> optim_profile_;
+  // the optimization profiles are owned by the builder
+  std::vector<nvinfer1::IOptimizationProfile*> optim_profiles_;
   std::vector<std::unique_ptr<plugin::DynamicPluginTensorRT>> owned_pluginv2_;
 #endif
   std::mutex mutex_;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/tensorrt/op_teller.h"
+#include <algorithm>
 
 namespace paddle {
 namespace inference {
@@ -33,6 +34,30 @@ struct SimpleOpTypeSetTeller : public Teller {
 
   bool operator()(const std::string& op_type, const framework::OpDesc& desc,
                   bool use_no_calib_int8) override {
+    // The multihead_matmul of the packed sequences has no BiasQK, which runs
+    // on the native kernel.
+    if (op_type == "multihead_matmul") {
+      auto& inputs = desc.Inputs();
+      auto it = inputs.find("BiasQK");
+      if (it == inputs.end() || it->second.empty()) return false;
+    }
+    // The slice plugin slices by the attributes on the axes besides the
+    // batch, and keeps the sliced axes.
+    if (op_type == "slice") {
+      auto& inputs = desc.Inputs();
+      for (auto& name : {"StartsTensor", "EndsTensor", "StartsTensorList",
+                         "EndsTensorList"}) {
+        auto it = inputs.find(name);
+        if (it != inputs.end() && !it->second.empty()) return false;
+      }
+      if (desc.HasAttr("decrease_axis") &&
+          !boost::get<std::vector<int>>(desc.GetAttr("decrease_axis"))
+               .empty()) {
+        return false;
+      }
+      auto axes = boost::get<std::vector<int>>(desc.GetAttr("axes"));
+      if (std::find(axes.begin(), axes.end(), 0) != axes.end()) return false;
+    }
     if (use_no_calib_int8) {
       return int8_teller_set.count(op_type);
     } else {
@@ -72,6 +97,7 @@ struct SimpleOpTypeSetTeller : public Teller {
       "instance_norm",
       "gelu",
       "layer_norm",
+      "slice",
   };
 };
 
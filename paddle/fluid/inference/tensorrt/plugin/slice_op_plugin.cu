@@ -0,0 +1,122 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include "glog/logging.h"
+#include "paddle/fluid/inference/tensorrt/plugin/slice_op_plugin.h"
+#include "paddle/fluid/inference/tensorrt/plugin/trt_plugin_factory.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+SlicePlugin *CreateSlicePluginDeserialize(const void *buffer, size_t length) {
+  return new SlicePlugin(buffer, length);
+}
+REGISTER_TRT_PLUGIN("slice_plugin", CreateSlicePluginDeserialize);
+
+std::vector<int> SlicePlugin::SliceOffsets(const nvinfer1::Dims &input_dims,
+                                           nvinfer1::Dims *output_dims) const {
+  *output_dims = input_dims;
+  std::vector<int> offsets(input_dims.nbDims, 0);
+  for (size_t i = 0; i < axes_.size(); ++i) {
+    int axis = axes_[i];
+    assert(axis >= 0 && axis < input_dims.nbDims);
+    int dim = input_dims.d[axis];
+    int start = starts_[i] < 0 ? starts_[i] + dim : starts_[i];
+    int end = ends_[i] < 0 ? ends_[i] + dim : ends_[i];
+    start = std::min(std::max(start, 0), dim);
+    end = std::min(std::max(end, 0), dim);
+    offsets[axis] = start;
+    output_dims->d[axis] = std::max(end - start, 0);
+  }
+  return offsets;
+}
+
+nvinfer1::Dims SlicePlugin::getOutputDimensions(int index,
+                                                const nvinfer1::Dims *inputDims,
+                                                int nbInputs) {
+  assert(nbInputs == 1);
+  assert(index < this->getNbOutputs());
+  nvinfer1::Dims output_dims;
+  SliceOffsets(inputDims[0], &output_dims);
+  return output_dims;
+}
+
+// The batch is the first dim of the params.
+static constexpr int kMaxSliceRank = nvinfer1::Dims::MAX_DIMS + 1;
+
+struct SliceParams {
+  int rank;
+  int out_dims[kMaxSliceRank];
+  int in_strides[kMaxSliceRank];
+  int offsets[kMaxSliceRank];
+};
+
+__global__ void slice_kernel(int num, SliceParams params, const float *input,
+                             float *output) {
+  int index = blockIdx.x * blockDim.x + threadIdx.x;
+  if (index < num) {
+    int remain = index;
+    int in_index = 0;
+    for (int i = params.rank - 1; i >= 0; --i) {
+      int coord = remain % params.out_dims[i];
+      remain /= params.out_dims[i];
+      in_index += (coord + params.offsets[i]) * params.in_strides[i];
+    }
+    output[index] = input[in_index];
+  }
+}
+
+int SlicePlugin::enqueue(int batch_size, const void *const *inputs,
+                         void **outputs, void *workspace, cudaStream_t stream) {
+  const auto &input_dims = this->getInputDims(0);
+  nvinfer1::Dims output_dims;
+  auto offsets = SliceOffsets(input_dims, &output_dims);
+
+  SliceParams params;
+  params.rank = input_dims.nbDims + 1;
+  params.out_dims[0] = batch_size;
+  params.offsets[0] = 0;
+  for (int i = 0; i < input_dims.nbDims; i++) {
+    params.out_dims[i + 1] = output_dims.d[i];
+    params.offsets[i + 1] = offsets[i];
+  }
+  int stride = 1;
+  for (int i = input_dims.nbDims; i >= 0; i--) {
+    params.in_strides[i] = stride;
+    stride *= i > 0 ? input_dims.d[i - 1] : batch_size;
+  }
+  int num = 1;
+  for (int i = 0; i < params.rank; i++) {
+    num *= params.out_dims[i];
+  }
+  if (num == 0) return 0;
+
+  const float *input = reinterpret_cast<const float *>(inputs[0]);
+  float *output = reinterpret_cast<float **>(outputs)[0];
+  int threads = 512;
+  int blocks = (num + threads - 1) / threads;
+  slice_kernel<<<blocks, threads, 0, stream>>>(num, params, input, output);
+
+  return cudaGetLastError() != cudaSuccess;
+}
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,90 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/inference/tensorrt/engine.h"
+#include "paddle/fluid/inference/tensorrt/plugin/trt_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+// Slices the input on the axes of the dims without the batch. The starts and
+// ends are the same as the attributes of the slice op, that the negative ones
+// count from the end of the axes, and they are clamped to the dims.
+class SlicePlugin : public PluginTensorRT {
+ private:
+  std::vector<int> starts_;
+  std::vector<int> ends_;
+  std::vector<int> axes_;
+
+ protected:
+  size_t getSerializationSize() override {
+    return getBaseSerializationSize() + SerializedSize(getPluginType()) +
+           SerializedSize(starts_) + SerializedSize(ends_) +
+           SerializedSize(axes_);
+  }
+
+  // TRT will call this func when we need to serialize the configuration of
+  // tensorrt.
+  // It should not be called by users.
+  void serialize(void *buffer) override {
+    SerializeValue(&buffer, getPluginType());
+    serializeBase(buffer);
+    SerializeValue(&buffer, starts_);
+    SerializeValue(&buffer, ends_);
+    SerializeValue(&buffer, axes_);
+  }
+
+ public:
+  SlicePlugin(const std::vector<int> &starts, const std::vector<int> &ends,
+              const std::vector<int> &axes)
+      : starts_(starts), ends_(ends), axes_(axes) {}
+
+  // It was used for tensorrt deserialization.
+  // It should not be called by users.
+  SlicePlugin(void const *serialData, size_t serialLength) {
+    deserializeBase(serialData, serialLength);
+    DeserializeValue(&serialData, &serialLength, &starts_);
+    DeserializeValue(&serialData, &serialLength, &ends_);
+    DeserializeValue(&serialData, &serialLength, &axes_);
+  }
+  ~SlicePlugin() {}
+
+  SlicePlugin *clone() const override {
+    return new SlicePlugin(starts_, ends_, axes_);
+  }
+
+  const char *getPluginType() const override { return "slice_plugin"; }
+  int getNbOutputs() const override { return 1; }
+  nvinfer1::Dims getOutputDimensions(int index, const nvinfer1::Dims *inputs,
+                                     int nbInputDims) override;
+  int enqueue(int batchSize, const void *const *inputs, void **outputs,
+              void *workspace, cudaStream_t stream) override;
+
+ private:
+  // Returns the start of each dim of the input, and sets the output dims.
+  std::vector<int> SliceOffsets(const nvinfer1::Dims &input_dims,
+                                nvinfer1::Dims *output_dims) const;
+};
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
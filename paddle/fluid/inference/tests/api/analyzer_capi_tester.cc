@@ -71,6 +71,48 @@ void zero_copy_run() {
 
 TEST(PD_PredictorZeroCopyRun, zero_copy_run) { zero_copy_run(); }
 
+TEST(PD_ZeroCopyBinding, run_bound) {
+  std::string model_dir = FLAGS_infer_model;
+  std::string prog_file = model_dir + "/model";
+  std::string params_file = model_dir + "/params";
+  PD_AnalysisConfig *config = PD_NewAnalysisConfig();
+  PD_DisableGpu(config);
+  PD_SwitchUseFeedFetchOps(config, false);
+  PD_SetModel(config, prog_file.c_str(), params_file.c_str());
+  PD_Predictor *predictor = PD_NewPredictor(config);
+
+  int shape[4] = {1, 3, 318, 318};
+  std::vector<float> input(1 * 3 * 318 * 318, 0.5);
+  std::vector<float> output(1 << 20);
+  PD_ZeroCopyBinding *binding = PD_NewZeroCopyBinding(predictor);
+  PD_ZeroCopyBindInput(binding, "data", input.data(), PD_FLOAT32, shape, 4);
+  int index = PD_ZeroCopyBindOutput(binding, PD_GetOutputName(predictor, 0),
+                                    output.data(),
+                                    output.size() * sizeof(float), PD_FLOAT32);
+  ASSERT_EQ(index, 0);
+
+  ASSERT_TRUE(PD_ZeroCopyRunBound(binding));
+  int out_shape[8];
+  int rank = PD_ZeroCopyBoundOutputShape(binding, 0, out_shape, 8);
+  ASSERT_GT(rank, 0);
+  int numel = 1;
+  for (int i = 0; i < rank; ++i) {
+    numel *= out_shape[i];
+  }
+  ASSERT_LE(numel, static_cast<int>(output.size()));
+  std::vector<float> first(output.begin(), output.begin() + numel);
+
+  // the later runs read and write the same bound memory
+  ASSERT_TRUE(PD_ZeroCopyRunBound(binding));
+  for (int i = 0; i < numel; ++i) {
+    EXPECT_FLOAT_EQ(output[i], first[i]);
+  }
+
+  PD_DeleteZeroCopyBinding(binding);
+  PD_DeletePredictor(predictor);
+  PD_DeleteAnalysisConfig(config);
+}
+
 #ifdef PADDLE_WITH_MKLDNN
 TEST(PD_AnalysisConfig, profile_mkldnn) {
   std::string model_dir = FLAGS_infer_model;
@@ -64,5 +64,40 @@ TEST(AnalysisPredictor, use_gpu) {
   output_t->copy_to_cpu(out_data.data());
 }
 
+TEST(AnalysisPredictor, multiple_profiles) {
+  std::string model_dir = FLAGS_infer_model + "/test_trt_dy_conv";
+  AnalysisConfig config;
+  config.EnableUseGpu(100, 0);
+  config.SetModel(model_dir);
+  config.SwitchUseFeedFetchOps(false);
+  config.EnableTensorRtEngine(1 << 30, 1, 1,
+                              AnalysisConfig::Precision::kFloat32, false, true);
+  // the small and the large images are run with the different profiles
+  config.SetTRTDynamicShapeInfo({{"image", {1, 1, 3, 3}}},
+                                {{"image", {1, 1, 10, 10}}},
+                                {{"image", {1, 1, 3, 3}}});
+  config.AddTRTDynamicShapeProfile({{"image", {1, 1, 11, 11}}},
+                                   {{"image", {1, 1, 32, 32}}},
+                                   {{"image", {1, 1, 16, 16}}});
+  auto predictor = CreatePaddlePredictor(config);
+  auto input_names = predictor->GetInputNames();
+  auto output_names = predictor->GetOutputNames();
+  for (int size : {3, 16, 32, 5}) {
+    std::vector<float> input(size * size, 0);
+    auto input_t = predictor->GetInputTensor(input_names[0]);
+    input_t->Reshape({1, 1, size, size});
+    input_t->copy_from_cpu(input.data());
+
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+
+    auto output_t = predictor->GetOutputTensor(output_names[0]);
+    std::vector<int> output_shape = output_t->shape();
+    int out_num = std::accumulate(output_shape.begin(), output_shape.end(), 1,
+                                  std::multiplies<int>());
+    std::vector<float> out_data(out_num);
+    output_t->copy_to_cpu(out_data.data());
+  }
+}
+
 }  // namespace inference
 }  // namespace paddle
@@ -183,6 +183,13 @@ class Allocator {
  protected:
   virtual Allocation* AllocateImpl(size_t size) = 0;
   virtual void FreeImpl(Allocation* allocation);
+
+  // Used by the Allocate() overloads of derived allocators, which take more
+  // arguments than the size, to register themselves like Allocate() does.
+  inline AllocationPtr WrapAllocation(Allocation* allocation) {
+    allocation->RegisterDecoratedAllocator(this);
+    return AllocationPtr(allocation);
+  }
 };
 
 using AllocationDeleter = Allocator::AllocationDeleter;
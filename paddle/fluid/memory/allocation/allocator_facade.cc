@@ -15,23 +15,32 @@
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include <gflags/gflags.h>
 #include <map>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/budget_allocator.h"
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include "paddle/fluid/memory/allocation/locked_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/retained_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/metrics.h"
+#include "paddle/fluid/platform/numa.h"
 #include "paddle/fluid/platform/place.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/memory/allocation/cuda_allocator.h"
 #include "paddle/fluid/memory/allocation/pinned_allocator.h"
+#include "paddle/fluid/memory/allocation/stream_ordered_allocator.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #endif
@@ -45,6 +54,25 @@ DEFINE_bool(use_system_allocator, false,
             "Whether to use system allocator to allocate CPU and GPU memory. "
             "Only used for unittests.");
 
+DEFINE_bool(use_thread_cached_cpu_allocator, false,
+            "Whether to cache small CPU allocations in the threads freeing "
+            "them, so that multi-thread trainers do not contend on the lock "
+            "of the CPU allocator.");
+
+DEFINE_uint64(gpu_slab_allocator_max_size, 0,
+              "The GPU allocations not larger than this size in bytes are "
+              "served from the size class free lists of SlabAllocator rather "
+              "than the best-fit search of the GPU allocator. 0 disables "
+              "SlabAllocator.");
+
+DECLARE_bool(numa_aware);
+
+DEFINE_bool(enable_allocator_stats, true,
+            "Whether to count the bytes allocated by the allocator of each "
+            "place, which are queried by AllocatorFacade::GetStats and "
+            "recorded into the timeline of profiler. The chunks reserved by "
+            "the allocators are reported even if it is false.");
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -75,7 +103,19 @@ class AllocatorFacadePrivate {
              ++dev_id) {
           InitAutoGrowthCUDAAllocator(platform::CUDAPlace(dev_id));
         }
-        InitNaiveBestFitCUDAPinnedAllocator();
+        InitAutoGrowthCUDAPinnedAllocator();
+#endif
+        break;
+      }
+
+      case AllocatorStrategy::kStreamOrdered: {
+        InitNaiveBestFitCPUAllocator();
+#ifdef PADDLE_WITH_CUDA
+        for (int dev_id = 0; dev_id < platform::GetCUDADeviceCount();
+             ++dev_id) {
+          InitStreamOrderedCUDAAllocator(platform::CUDAPlace(dev_id));
+        }
+        InitAutoGrowthCUDAPinnedAllocator();
 #endif
         break;
       }
@@ -85,6 +125,15 @@ class AllocatorFacadePrivate {
                      static_cast<int>(strategy));
       }
     }
+    if (FLAGS_use_thread_cached_cpu_allocator) {
+      WrapCPUThreadCachedAllocator();
+    }
+    if (FLAGS_numa_aware) {
+      InitNumaCPUAllocators();
+    }
+    if (FLAGS_gpu_slab_allocator_max_size > 0) {
+      WrapCUDASlabAllocator(FLAGS_gpu_slab_allocator_max_size);
+    }
     InitZeroSizeAllocators();
     InitSystemAllocators();
 
@@ -92,11 +141,22 @@ class AllocatorFacadePrivate {
       WrapCUDARetryAllocator(FLAGS_gpu_allocator_retry_time);
     }
 
+    if (FLAGS_enable_allocator_stats) {
+      WrapStatAllocator();
+    }
+
     CheckAllocThreadSafe();
   }
 
   inline const std::shared_ptr<Allocator>& GetAllocator(
       const platform::Place& place, size_t size) {
+    if (UNLIKELY(!numa_cpu_allocators_.empty()) && size > 0 &&
+        platform::is_cpu_place(place)) {
+      int node = platform::GetCurrentNumaNode();
+      if (node >= 0 && node < static_cast<int>(numa_cpu_allocators_.size())) {
+        return numa_cpu_allocators_[node];
+      }
+    }
     const auto& allocators =
         (size > 0 ? (UNLIKELY(FLAGS_use_system_allocator) ? system_allocators_
                                                           : allocators_)
@@ -107,6 +167,137 @@ class AllocatorFacadePrivate {
     return iter->second;
   }
 
+  // the context of the current thread which place is allocated in, or
+  // nullptr
+  inline AllocationContext* GetAllocationContext(const platform::Place& place,
+                                                 size_t size) const {
+    auto* context = AllocationContext::Current();
+    if (UNLIKELY(context != nullptr) && size > 0 && context->place() == place) {
+      return context;
+    }
+    return nullptr;
+  }
+
+  std::shared_ptr<AllocationContext> CreateAllocationContext(
+      const platform::Place& place, size_t budget, bool spill_to_host) {
+    auto iter = allocators_.find(place);
+    PADDLE_ENFORCE_NE(iter, allocators_.end(),
+                      platform::errors::NotFound(
+                          "No such allocator for the place, %s", place));
+    std::shared_ptr<Allocator> spill_allocator;
+    if (spill_to_host) {
+#ifdef PADDLE_WITH_CUDA
+      PADDLE_ENFORCE_EQ(platform::is_gpu_place(place), true,
+                        platform::errors::InvalidArgument(
+                            "Only the allocations on GPU can be spilled to "
+                            "host, but the place is %s",
+                            place));
+      spill_allocator = std::make_shared<CUDAMappedPinnedAllocator>(
+          boost::get<platform::CUDAPlace>(place));
+#else
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Spilling the allocations to host requires compiling with CUDA"));
+#endif
+    }
+    VLOG(1) << "Create an allocation context of " << place << ", budget "
+            << budget << " bytes, spill to host: " << spill_to_host;
+    return std::make_shared<AllocationContext>(
+        place,
+        std::make_shared<BudgetAllocator>(iter->second, budget,
+                                          std::move(spill_allocator)));
+  }
+
+  std::shared_ptr<AllocationContext> CreateRetainedAllocationContext(
+      const platform::Place& place) {
+    // nested in the current context, e.g. to keep within the budget
+    std::shared_ptr<Allocator> underlying_allocator;
+    auto* context = AllocationContext::Current();
+    if (context != nullptr && context->place() == place) {
+      underlying_allocator = context->allocator();
+    } else {
+      auto iter = allocators_.find(place);
+      PADDLE_ENFORCE_NE(iter, allocators_.end(),
+                        platform::errors::NotFound(
+                            "No such allocator for the place, %s", place));
+      underlying_allocator = iter->second;
+    }
+    return std::make_shared<AllocationContext>(
+        place, std::make_shared<RetainedAllocator>(underlying_allocator));
+  }
+
+#ifdef PADDLE_WITH_CUDA
+  std::shared_ptr<AllocationContext> CreateStreamAllocationContext(
+      const platform::Place& place, cudaStream_t stream) {
+    PADDLE_ENFORCE_EQ(platform::is_gpu_place(place), true,
+                      platform::errors::InvalidArgument(
+                          "Only the allocations on GPU can be allocated in a "
+                          "stream, but the place is %s",
+                          place));
+    auto gpu_place = boost::get<platform::CUDAPlace>(place);
+    std::shared_ptr<StreamOrderedAllocator> allocator;
+    auto* context = AllocationContext::Current();
+    if (context != nullptr && context->place() == place) {
+      allocator = std::make_shared<StreamOrderedAllocator>(
+          context->allocator(), gpu_place);
+    } else if (stream_ordered_allocators_.count(place)) {
+      allocator = stream_ordered_allocators_.at(place);
+    } else {
+      auto iter = allocators_.find(place);
+      PADDLE_ENFORCE_NE(iter, allocators_.end(),
+                        platform::errors::NotFound(
+                            "No such allocator for the place, %s", place));
+      allocator =
+          std::make_shared<StreamOrderedAllocator>(iter->second, gpu_place);
+    }
+    return std::make_shared<AllocationContext>(
+        place, std::make_shared<StreamBoundAllocator>(allocator, stream));
+  }
+
+  inline AllocationPtr Alloc(const platform::Place& place, size_t size,
+                             cudaStream_t stream) {
+    auto* context = GetAllocationContext(place, size);
+    if (context != nullptr) {
+      return context->allocator()->Allocate(size);
+    }
+    if (size > 0 && LIKELY(!FLAGS_use_system_allocator)) {
+      auto iter = stream_ordered_allocators_.find(place);
+      if (iter != stream_ordered_allocators_.end()) {
+        auto allocation = iter->second->Allocate(size, stream);
+        auto stat_iter = stat_allocators_.find(place);
+        if (stat_iter != stat_allocators_.end()) {
+          allocation = stat_iter->second->Track(std::move(allocation));
+        }
+        return allocation;
+      }
+    }
+    return GetAllocator(place, size)->Allocate(size);
+  }
+#endif
+
+  AllocatorStats GetStats(const platform::Place& place) const {
+    auto iter = stat_allocators_.find(place);
+    if (iter != stat_allocators_.end()) {
+      return iter->second->GetStats();
+    }
+    PADDLE_ENFORCE_EQ(
+        allocators_.count(place), 1,
+        platform::errors::NotFound("No such allocator for the place, %s",
+                                   place));
+    AllocatorStats stats;
+    auto getter_iter = chunk_stats_getters_.find(place);
+    if (getter_iter != chunk_stats_getters_.end()) {
+      stats.chunk_stats = getter_iter->second();
+    }
+    return stats;
+  }
+
+  void ResetPeakStats(const platform::Place& place) {
+    auto iter = stat_allocators_.find(place);
+    if (iter != stat_allocators_.end()) {
+      iter->second->ResetPeak();
+    }
+  }
+
  private:
   void InitSystemAllocators() {
     system_allocators_[platform::CPUPlace()] = std::make_shared<CPUAllocator>();
@@ -121,25 +312,63 @@ class AllocatorFacadePrivate {
 #endif
   }
 
+  void InitNaiveBestFitAllocator(const platform::Place& place) {
+    auto allocator = std::make_shared<NaiveBestFitAllocator>(place);
+    chunk_stats_getters_[place] = [allocator] {
+      return allocator->GetChunkStats();
+    };
+    allocators_[place] = allocator;
+  }
+
   void InitNaiveBestFitCPUAllocator() {
-    allocators_[platform::CPUPlace()] =
-        std::make_shared<NaiveBestFitAllocator>(platform::CPUPlace());
+    InitNaiveBestFitAllocator(platform::CPUPlace());
   }
 
 #ifdef PADDLE_WITH_CUDA
   void InitNaiveBestFitCUDAPinnedAllocator() {
-    allocators_[platform::CUDAPinnedPlace()] =
-        std::make_shared<NaiveBestFitAllocator>(platform::CUDAPinnedPlace());
+    InitNaiveBestFitAllocator(platform::CUDAPinnedPlace());
+  }
+
+  // The pinned memory is pooled like the GPU memory, so that the staging
+  // buffers of the copies from host to device, e.g. in the readers, can be
+  // allocated for every batch without calling cudaHostAlloc.
+  void InitAutoGrowthCUDAPinnedAllocator() {
+    platform::CUDAPinnedPlace place;
+    // the same alignment as the GPU memory
+    size_t alignment = 256;
+    auto allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+        std::make_shared<CPUPinnedAllocator>(), alignment,
+        platform::CUDAPinnedMinChunkSize());
+    chunk_stats_getters_[place] = [allocator] {
+      return allocator->GetChunkStats();
+    };
+    allocators_[place] = allocator;
   }
 
   void InitNaiveBestFitCUDAAllocator(platform::CUDAPlace p) {
-    allocators_[p] = std::make_shared<NaiveBestFitAllocator>(p);
+    InitNaiveBestFitAllocator(p);
   }
 
-  void InitAutoGrowthCUDAAllocator(platform::CUDAPlace p) {
+  std::shared_ptr<AutoGrowthBestFitAllocator> CreateAutoGrowthCUDAAllocator(
+      platform::CUDAPlace p) {
     auto cuda_allocator = std::make_shared<CUDAAllocator>(p);
-    allocators_[p] = std::make_shared<AutoGrowthBestFitAllocator>(
+    auto allocator = std::make_shared<AutoGrowthBestFitAllocator>(
         cuda_allocator, platform::GpuMinChunkSize());
+    chunk_stats_getters_[p] = [allocator] {
+      return allocator->GetChunkStats();
+    };
+    return allocator;
+  }
+
+  void InitAutoGrowthCUDAAllocator(platform::CUDAPlace p) {
+    allocators_[p] = CreateAutoGrowthCUDAAllocator(p);
+  }
+
+  void InitStreamOrderedCUDAAllocator(platform::CUDAPlace p) {
+    auto allocator = std::make_shared<StreamOrderedAllocator>(
+        CreateAutoGrowthCUDAAllocator(p), p);
+    stream_ordered_allocators_[p] = allocator;
+    allocators_[p] = allocator;
   }
 #endif
 
@@ -190,6 +419,84 @@ class AllocatorFacadePrivate {
     CheckAllocThreadSafe(system_allocators_);
   }
 
+  // The CPU memory pools of the NUMA nodes, which the threads bound to the
+  // nodes allocate from.
+  void InitNumaCPUAllocators() {
+    int node_count = platform::GetNumaNodeCount();
+    if (node_count <= 1) {
+      return;
+    }
+    // the chunks are aligned to the pages by CPUAllocator, which places them
+    // on the node, so the allocations need only the cache line alignment
+    size_t alignment = 64;
+    for (int node = 0; node < node_count; ++node) {
+      numa_cpu_allocators_.emplace_back(
+          std::make_shared<AutoGrowthBestFitAllocator>(
+              std::make_shared<CPUAllocator>(node), alignment,
+              platform::CpuMaxChunkSize()));
+    }
+    VLOG(1) << "Create the CPU memory pools of " << node_count
+            << " NUMA nodes";
+  }
+
+  void WrapCPUThreadCachedAllocator() {
+    auto& allocator = allocators_[platform::CPUPlace()];
+    allocator = std::make_shared<ThreadCachedAllocator>(allocator);
+  }
+
+  void WrapCUDASlabAllocator(size_t max_size) {
+    for (auto& pair : allocators_) {
+      if (platform::is_gpu_place(pair.first)) {
+        pair.second = std::make_shared<SlabAllocator>(pair.second, max_size);
+      }
+    }
+  }
+
+  void WrapStatAllocator() {
+    for (auto& pair : allocators_) {
+      StatAllocator::ChunkStatsGetter getter;
+      auto iter = chunk_stats_getters_.find(pair.first);
+      if (iter != chunk_stats_getters_.end()) {
+        getter = iter->second;
+      }
+      auto allocator = std::make_shared<StatAllocator>(pair.second, getter);
+      stat_allocators_[pair.first] = allocator;
+      pair.second = allocator;
+      RegisterStatMetrics(pair.first, allocator.get());
+    }
+  }
+
+  // Export the stats of the place as gauges, which are read when the
+  // metrics are scraped. The allocators live until the process ends.
+  void RegisterStatMetrics(const platform::Place& place,
+                           const StatAllocator* allocator) {
+    std::ostringstream labels;
+    labels << "place=\"" << place << "\"";
+    auto& registry = platform::MetricsRegistry::Instance();
+    registry.RegisterGaugeCallback(
+        "paddle_allocator_allocated_bytes", "The bytes allocated now.",
+        [allocator] {
+          return static_cast<double>(allocator->GetStats().allocated_bytes);
+        },
+        labels.str());
+    registry.RegisterGaugeCallback(
+        "paddle_allocator_peak_allocated_bytes",
+        "The peak of the bytes allocated.",
+        [allocator] {
+          return static_cast<double>(
+              allocator->GetStats().peak_allocated_bytes);
+        },
+        labels.str());
+    registry.RegisterGaugeCallback(
+        "paddle_allocator_reserved_bytes",
+        "The bytes of the chunks reserved by the allocator.",
+        [allocator] {
+          return static_cast<double>(
+              allocator->GetStats().chunk_stats.reserved_bytes);
+        },
+        labels.str());
+  }
+
   void WrapCUDARetryAllocator(size_t retry_time) {
     PADDLE_ENFORCE_GT(retry_time, 0, "Retry time must be larger than 0");
     for (auto& pair : allocators_) {
@@ -203,6 +510,19 @@ class AllocatorFacadePrivate {
   AllocatorMap allocators_;
   AllocatorMap zero_size_allocators_;
   AllocatorMap system_allocators_;
+  // indexed by the NUMA node, empty if not FLAGS_numa_aware
+  std::vector<std::shared_ptr<Allocator>> numa_cpu_allocators_;
+  // the allocators_ wrapped by StatAllocator, and the functions reporting the
+  // chunks of the allocators_
+  std::map<platform::Place, std::shared_ptr<StatAllocator>> stat_allocators_;
+  std::map<platform::Place, StatAllocator::ChunkStatsGetter>
+      chunk_stats_getters_;
+#ifdef PADDLE_WITH_CUDA
+  // the allocators_ of GPU places with the stream_ordered strategy, they are
+  // kept here since allocators_ may be wrapped by RetryAllocator
+  std::map<platform::Place, std::shared_ptr<StreamOrderedAllocator>>
+      stream_ordered_allocators_;
+#endif
 };
 
 // Pimpl. Make interface clean.
@@ -223,9 +543,46 @@ std::shared_ptr<Allocation> AllocatorFacade::AllocShared(
 
 AllocationPtr AllocatorFacade::Alloc(const platform::Place& place,
                                      size_t size) {
+  auto* context = m_->GetAllocationContext(place, size);
+  if (context != nullptr) {
+    return context->allocator()->Allocate(size);
+  }
   return m_->GetAllocator(place, size)->Allocate(size);
 }
 
+#ifdef PADDLE_WITH_CUDA
+AllocationPtr AllocatorFacade::Alloc(const platform::Place& place, size_t size,
+                                     cudaStream_t stream) {
+  return m_->Alloc(place, size, stream);
+}
+#endif
+
+AllocatorStats AllocatorFacade::GetStats(const platform::Place& place) const {
+  return m_->GetStats(place);
+}
+
+void AllocatorFacade::ResetPeakStats(const platform::Place& place) {
+  m_->ResetPeakStats(place);
+}
+
+std::shared_ptr<AllocationContext> AllocatorFacade::CreateAllocationContext(
+    const platform::Place& place, size_t budget, bool spill_to_host) {
+  return m_->CreateAllocationContext(place, budget, spill_to_host);
+}
+
+std::shared_ptr<AllocationContext>
+AllocatorFacade::CreateRetainedAllocationContext(const platform::Place& place) {
+  return m_->CreateRetainedAllocationContext(place);
+}
+
+#ifdef PADDLE_WITH_CUDA
+std::shared_ptr<AllocationContext>
+AllocatorFacade::CreateStreamAllocationContext(const platform::Place& place,
+                                               cudaStream_t stream) {
+  return m_->CreateStreamAllocationContext(place, stream);
+}
+#endif
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
@@ -13,8 +13,13 @@
 // limitations under the License.
 
 #pragma once
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
 #include <memory>
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
+#include "paddle/fluid/memory/allocation/budget_allocator.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -44,6 +49,48 @@ class AllocatorFacade {
   // Allocate a unique allocation.
   AllocationPtr Alloc(const platform::Place& place, size_t size);
 
+#ifdef PADDLE_WITH_CUDA
+  // Allocate a unique allocation used in stream. With the stream_ordered
+  // allocator strategy, the allocation is reused in stream as soon as it is
+  // freed, and in other streams after they wait for the work of stream
+  // queued before the free. It is the same as Alloc(place, size) with other
+  // strategies or places.
+  AllocationPtr Alloc(const platform::Place& place, size_t size,
+                      cudaStream_t stream);
+#endif
+
+  // The bytes allocated by the allocator of place, and the chunks it reserves.
+  // Only the chunks are reported if FLAGS_enable_allocator_stats is false.
+  AllocatorStats GetStats(const platform::Place& place) const;
+
+  // Reset the peak of the bytes allocated of place to the bytes allocated now,
+  // e.g. to measure the peak of each iteration.
+  void ResetPeakStats(const platform::Place& place);
+
+  // Create a context limiting the bytes allocated on place to budget, while
+  // it is set to the allocating thread by AllocationContextGuard. The
+  // allocations beyond the budget are spilled to the host memory mapped into
+  // the GPU if spill_to_host is true, or fail with BadAlloc otherwise.
+  std::shared_ptr<AllocationContext> CreateAllocationContext(
+      const platform::Place& place, size_t budget, bool spill_to_host);
+
+  // Create a context with a RetainedAllocator, which keeps the memory
+  // allocated on place while the context is set, e.g. during capturing a
+  // CUDA graph, until the allocator is released. The memory is allocated in
+  // the current context of the thread if its place matches.
+  std::shared_ptr<AllocationContext> CreateRetainedAllocationContext(
+      const platform::Place& place);
+
+#ifdef PADDLE_WITH_CUDA
+  // Create a context allocating in stream on the GPU place, e.g. for a
+  // thread running on its own stream, so that the allocations freed by the
+  // thread are not reused by the other streams before its work queued
+  // finishes. The memory is allocated in the current context of the thread
+  // if its place matches.
+  std::shared_ptr<AllocationContext> CreateStreamAllocationContext(
+      const platform::Place& place, cudaStream_t stream);
+#endif
+
   // TODO(yy): Allocate a Copy-On-Write allocation?
  private:
   AllocatorFacade();
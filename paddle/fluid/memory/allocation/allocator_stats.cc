@@ -0,0 +1,144 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
+#include <algorithm>
+#include <utility>
+#include "paddle/fluid/platform/memory_profiler.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+int AllocatorStats::SizeClass(size_t size) {
+  if (size <= 1) {
+    return 0;
+  }
+  int size_class = 63 - __builtin_clzll(static_cast<uint64_t>(size));
+  return std::min(size_class, kSizeClassNum - 1);
+}
+
+double AllocatorStats::Fragmentation() const {
+  if (chunk_stats.free_bytes == 0) {
+    return 0;
+  }
+  return 1.0 - static_cast<double>(chunk_stats.largest_free_block) /
+                   static_cast<double>(chunk_stats.free_bytes);
+}
+
+StatAllocator::StatAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                             ChunkStatsGetter chunk_stats_getter)
+    : underlying_allocator_(std::move(underlying_allocator)),
+      chunk_stats_getter_(std::move(chunk_stats_getter)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of StatAllocator must not be null"));
+  for (auto &count : size_histogram_) {
+    count = 0;
+  }
+}
+
+AllocatorStats StatAllocator::GetStats() const {
+  AllocatorStats stats;
+  stats.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  stats.peak_allocated_bytes =
+      peak_allocated_bytes_.load(std::memory_order_relaxed);
+  stats.total_allocated_bytes =
+      total_allocated_bytes_.load(std::memory_order_relaxed);
+  stats.alloc_count = alloc_count_.load(std::memory_order_relaxed);
+  stats.free_count = free_count_.load(std::memory_order_relaxed);
+  stats.size_histogram.reserve(AllocatorStats::kSizeClassNum);
+  for (auto &count : size_histogram_) {
+    stats.size_histogram.push_back(count.load(std::memory_order_relaxed));
+  }
+  if (chunk_stats_getter_) {
+    stats.chunk_stats = chunk_stats_getter_();
+  }
+  return stats;
+}
+
+void StatAllocator::ResetPeak() {
+  peak_allocated_bytes_.store(allocated_bytes_.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+}
+
+AllocationPtr StatAllocator::Track(AllocationPtr allocation) {
+  auto *ptr = allocation.release();
+  RecordAllocate(ptr);
+  return WrapAllocation(ptr);
+}
+
+Allocation *StatAllocator::AllocateImpl(size_t size) {
+  platform::NvtxRange nvtx_range("Allocate");
+  auto *allocation = underlying_allocator_->Allocate(size).release();
+  RecordAllocate(allocation);
+  return allocation;
+}
+
+void StatAllocator::RecordAllocate(Allocation *allocation) {
+  size_t allocation_size = allocation->size();
+  size_t allocated =
+      allocated_bytes_.fetch_add(allocation_size, std::memory_order_relaxed) +
+      allocation_size;
+  size_t peak = peak_allocated_bytes_.load(std::memory_order_relaxed);
+  while (allocated > peak &&
+         !peak_allocated_bytes_.compare_exchange_weak(
+             peak, allocated, std::memory_order_relaxed)) {
+  }
+  total_allocated_bytes_.fetch_add(allocation_size, std::memory_order_relaxed);
+  alloc_count_.fetch_add(1, std::memory_order_relaxed);
+  size_histogram_[AllocatorStats::SizeClass(allocation_size)].fetch_add(
+      1, std::memory_order_relaxed);
+  if (UNLIKELY(platform::IsProfileEnabled())) {
+    RecordMemStat(allocation->place());
+  }
+  if (UNLIKELY(platform::MemoryProfiler::IsEnabled())) {
+    platform::MemoryProfiler::Instance().RecordAlloc(
+        allocation->ptr(), allocation_size, allocation->place());
+  }
+}
+
+void StatAllocator::FreeImpl(Allocation *allocation) {
+  size_t allocation_size = allocation->size();
+  platform::Place place = allocation->place();
+  platform::NvtxRange nvtx_range("Free");
+  if (UNLIKELY(platform::MemoryProfiler::IsEnabled())) {
+    platform::MemoryProfiler::Instance().RecordFree(allocation->ptr(), place);
+  }
+  // the allocation may be from Track(), so it is freed by the allocator
+  // which allocates it rather than underlying_allocator_
+  Allocator::FreeImpl(allocation);
+  allocated_bytes_.fetch_sub(allocation_size, std::memory_order_relaxed);
+  free_count_.fetch_add(1, std::memory_order_relaxed);
+  size_histogram_[AllocatorStats::SizeClass(allocation_size)].fetch_sub(
+      1, std::memory_order_relaxed);
+  if (UNLIKELY(platform::IsProfileEnabled())) {
+    RecordMemStat(place);
+  }
+}
+
+void StatAllocator::RecordMemStat(const platform::Place &place) const {
+  size_t reserved_bytes =
+      chunk_stats_getter_ ? chunk_stats_getter_().reserved_bytes : 0;
+  platform::RecordMemStat(place,
+                          allocated_bytes_.load(std::memory_order_relaxed),
+                          peak_allocated_bytes_.load(std::memory_order_relaxed),
+                          reserved_bytes);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
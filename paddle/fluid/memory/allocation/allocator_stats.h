@@ -0,0 +1,117 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// The chunks an allocator reserves from the system allocator.
+struct ChunkStats {
+  size_t reserved_bytes{0};
+  size_t chunk_num{0};
+  // the free bytes inside the chunks, and the largest free block of them
+  size_t free_bytes{0};
+  size_t largest_free_block{0};
+  // the number of times the allocator defragments after running out of
+  // memory, and the bytes of the partially used chunks released by them
+  size_t defragment_num{0};
+  size_t recovered_bytes{0};
+};
+
+struct AllocatorStats {
+  // The number of size classes in size_histogram. Size class i holds the
+  // allocations with size in [2^i, 2^(i+1)), and the last one holds all the
+  // larger allocations.
+  static constexpr int kSizeClassNum = 40;
+
+  static int SizeClass(size_t size);
+
+  size_t allocated_bytes{0};
+  size_t peak_allocated_bytes{0};
+  // the bytes of all the allocations since the allocator is created
+  size_t total_allocated_bytes{0};
+  size_t alloc_count{0};
+  size_t free_count{0};
+  // the number of the allocations in use by size class
+  std::vector<size_t> size_histogram;
+
+  // zero if the allocator does not report its chunks
+  ChunkStats chunk_stats;
+
+  // The part of the free bytes in the chunks which can not be used by an
+  // allocation as large as all of them, 0 if there are no free bytes.
+  double Fragmentation() const;
+};
+
+/**
+ * StatAllocator counts the allocations of the underlying allocator. The
+ * counters are updated without lock, so that it can wrap the allocators
+ * of AllocatorFacade at little cost. The chunks of the underlying allocator
+ * are reported by chunk_stats_getter, which is only called by GetStats()
+ * and when the profiler is enabled.
+ */
+class StatAllocator : public Allocator {
+ public:
+  using ChunkStatsGetter = std::function<ChunkStats()>;
+
+  explicit StatAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                         ChunkStatsGetter chunk_stats_getter = nullptr);
+
+  bool IsAllocThreadSafe() const override {
+    return underlying_allocator_->IsAllocThreadSafe();
+  }
+
+  AllocatorStats GetStats() const;
+
+  // Count an allocation of the underlying allocator which is not allocated
+  // by Allocate(size), e.g. by the Allocate() overloads taking more arguments
+  // than the size.
+  AllocationPtr Track(AllocationPtr allocation);
+
+  // reset the peak to the bytes allocated now
+  void ResetPeak();
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  void RecordAllocate(Allocation *allocation);
+
+  void RecordMemStat(const platform::Place &place) const;
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  ChunkStatsGetter chunk_stats_getter_;
+
+  std::atomic<size_t> allocated_bytes_{0};
+  std::atomic<size_t> peak_allocated_bytes_{0};
+  std::atomic<size_t> total_allocated_bytes_{0};
+  std::atomic<size_t> alloc_count_{0};
+  std::atomic<size_t> free_count_{0};
+  std::atomic<size_t> size_histogram_[AllocatorStats::kSizeClassNum];
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
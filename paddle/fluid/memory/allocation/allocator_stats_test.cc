@@ -0,0 +1,129 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(AllocatorStats, SizeClass) {
+  ASSERT_EQ(AllocatorStats::SizeClass(0), 0);
+  ASSERT_EQ(AllocatorStats::SizeClass(1), 0);
+  ASSERT_EQ(AllocatorStats::SizeClass(2), 1);
+  ASSERT_EQ(AllocatorStats::SizeClass(3), 1);
+  ASSERT_EQ(AllocatorStats::SizeClass(1024), 10);
+  ASSERT_EQ(AllocatorStats::SizeClass(2047), 10);
+  ASSERT_EQ(AllocatorStats::SizeClass(static_cast<size_t>(1) << 62),
+            AllocatorStats::kSizeClassNum - 1);
+}
+
+TEST(StatAllocator, Counters) {
+  StatAllocator allocator(std::make_shared<CPUAllocator>());
+  auto allocation1 = allocator.Allocate(1000);
+  auto allocation2 = allocator.Allocate(3000);
+  auto stats = allocator.GetStats();
+  ASSERT_EQ(stats.allocated_bytes, 4000UL);
+  ASSERT_EQ(stats.peak_allocated_bytes, 4000UL);
+  ASSERT_EQ(stats.alloc_count, 2UL);
+  ASSERT_EQ(stats.size_histogram.size(),
+            static_cast<size_t>(AllocatorStats::kSizeClassNum));
+  ASSERT_EQ(stats.size_histogram[9], 1UL);
+  ASSERT_EQ(stats.size_histogram[11], 1UL);
+  ASSERT_EQ(stats.chunk_stats.chunk_num, 0UL);
+  ASSERT_EQ(stats.Fragmentation(), 0);
+
+  allocation2.reset();
+  stats = allocator.GetStats();
+  ASSERT_EQ(stats.allocated_bytes, 1000UL);
+  ASSERT_EQ(stats.peak_allocated_bytes, 4000UL);
+  ASSERT_EQ(stats.total_allocated_bytes, 4000UL);
+  ASSERT_EQ(stats.free_count, 1UL);
+  ASSERT_EQ(stats.size_histogram[11], 0UL);
+
+  allocator.ResetPeak();
+  ASSERT_EQ(allocator.GetStats().peak_allocated_bytes, 1000UL);
+  allocation1.reset();
+  ASSERT_EQ(allocator.GetStats().allocated_bytes, 0UL);
+}
+
+TEST(StatAllocator, ChunkStats) {
+  auto auto_growth_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      std::make_shared<CPUAllocator>(), 256, 4096);
+  StatAllocator allocator(auto_growth_allocator, [auto_growth_allocator] {
+    return auto_growth_allocator->GetChunkStats();
+  });
+
+  std::vector<AllocationPtr> allocations;
+  for (int i = 0; i < 16; ++i) {
+    allocations.emplace_back(allocator.Allocate(256));
+  }
+  auto stats = allocator.GetStats();
+  ASSERT_EQ(stats.chunk_stats.chunk_num, 1UL);
+  // the chunk may be larger than 4096 bytes for the alignment
+  size_t reserved = stats.chunk_stats.reserved_bytes;
+  ASSERT_GE(reserved, 4096UL);
+  ASSERT_EQ(stats.chunk_stats.free_bytes, reserved - 4096);
+
+  // free every other allocation, the freed blocks can not be merged
+  for (size_t i = 0; i < allocations.size(); i += 2) {
+    allocations[i].reset();
+  }
+  stats = allocator.GetStats();
+  ASSERT_EQ(stats.allocated_bytes, 8 * 256UL);
+  ASSERT_EQ(stats.chunk_stats.free_bytes, reserved - 8 * 256);
+  ASSERT_EQ(stats.chunk_stats.largest_free_block, 256UL);
+  ASSERT_DOUBLE_EQ(stats.Fragmentation(),
+                   1.0 - 256.0 / static_cast<double>(reserved - 8 * 256));
+
+  allocations.clear();
+  stats = allocator.GetStats();
+  ASSERT_EQ(stats.chunk_stats.free_bytes, reserved);
+  ASSERT_EQ(stats.chunk_stats.largest_free_block, reserved);
+  ASSERT_EQ(stats.Fragmentation(), 0);
+}
+
+TEST(StatAllocator, MultiThread) {
+  auto allocator =
+      std::make_shared<StatAllocator>(std::make_shared<CPUAllocator>());
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([allocator] {
+      std::vector<AllocationPtr> allocations;
+      for (int j = 0; j < 1000; ++j) {
+        allocations.emplace_back(allocator->Allocate(64));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto stats = allocator->GetStats();
+  ASSERT_EQ(stats.allocated_bytes, 0UL);
+  ASSERT_EQ(stats.alloc_count, 8000UL);
+  ASSERT_EQ(stats.free_count, 8000UL);
+  ASSERT_EQ(stats.total_allocated_bytes, 8000 * 64UL);
+  ASSERT_GE(stats.peak_allocated_bytes, 1000 * 64UL);
+  ASSERT_LE(stats.peak_allocated_bytes, 8000 * 64UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -33,6 +33,14 @@ DEFINE_bool(free_when_no_cache_hit, false,
             "chunk would be freed when out of memory occurs. This flag "
             "only works when FLAGS_allocator_strategy=auto_growth.");
 
+DEFINE_bool(auto_growth_defragment, false,
+            "Whether to defragment when out of memory occurs. If true, "
+            "after failing to allocate a chunk, the partially used chunks "
+            "are released as soon as all their blocks are freed, e.g. by "
+            "garbage collection while RetryAllocator waits, so that the "
+            "retry can allocate a fresh chunk from the coalesced memory. This "
+            "flag only works when FLAGS_allocator_strategy=auto_growth.");
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -68,6 +76,7 @@ Allocation *AutoGrowthBestFitAllocator::AllocateImpl(size_t size) {
       block_it->size_ = size;
       block_it->is_free_ = false;
     }
+    FinishDefragment(size);
   } else {
     if (FLAGS_free_when_no_cache_hit) {
       FreeIdleChunks();
@@ -77,10 +86,19 @@ Allocation *AutoGrowthBestFitAllocator::AllocateImpl(size_t size) {
     try {
       chunks_.emplace_back(underlying_allocator_->Allocate(realloc_size));
     } catch (BadAlloc &ex) {
-      if (FLAGS_free_when_no_cache_hit) throw ex;
+      if (FLAGS_free_when_no_cache_hit) {
+        StartDefragment(size);
+        throw ex;
+      }
       FreeIdleChunks();
-      chunks_.emplace_back(underlying_allocator_->Allocate(realloc_size));
+      try {
+        chunks_.emplace_back(underlying_allocator_->Allocate(realloc_size));
+      } catch (BadAlloc &) {
+        StartDefragment(size);
+        throw;
+      }
     }
+    FinishDefragment(size);
 
     auto *chunk = &(*chunks_.rbegin());
     realloc_size = chunk->allocation_->size();
@@ -135,7 +153,62 @@ void AutoGrowthBestFitAllocator::FreeImpl(Allocation *allocation) {
 
   if (FLAGS_free_idle_chunk) {
     FreeIdleChunks();
+  } else if (defragmenting_ && blocks.size() == 1) {
+    auto chunk_it = std::find_if(
+        chunks_.begin(), chunks_.end(),
+        [&blocks](const Chunk &chunk) { return &chunk.blocks_ == &blocks; });
+    size_t size = block_it->size_;
+    VLOG(2) << "Free chunk with size " << size << " while defragmenting";
+    free_blocks_.erase(std::make_pair(size, block_it->ptr_));
+    chunks_.erase(chunk_it);
+    defragment_released_bytes_ += size;
+  }
+}
+
+void AutoGrowthBestFitAllocator::StartDefragment(size_t size) {
+  if (!FLAGS_auto_growth_defragment || defragmenting_) {
+    return;
+  }
+  size_t fragmented_bytes = 0;
+  for (auto &pair : free_blocks_) {
+    fragmented_bytes += pair.first.first;
+  }
+  VLOG(1) << "Start to defragment with " << free_blocks_.size()
+          << " free blocks of " << fragmented_bytes << " bytes in "
+          << chunks_.size() << " chunks";
+  defragmenting_ = true;
+  defragment_size_ = size;
+  defragment_released_bytes_ = 0;
+}
+
+void AutoGrowthBestFitAllocator::FinishDefragment(size_t size) {
+  if (!defragmenting_ || size < defragment_size_) {
+    return;
+  }
+  VLOG(1) << "Finish defragmenting, " << defragment_released_bytes_
+          << " bytes of partially used chunks are released";
+  defragmenting_ = false;
+  ++defragment_num_;
+  recovered_bytes_ += defragment_released_bytes_;
+  defragment_released_bytes_ = 0;
+}
+
+ChunkStats AutoGrowthBestFitAllocator::GetChunkStats() const {
+  std::lock_guard<std::mutex> guard(mtx_);
+  ChunkStats stats;
+  stats.chunk_num = chunks_.size();
+  for (auto &chunk : chunks_) {
+    stats.reserved_bytes += chunk.allocation_->size();
+  }
+  for (auto &pair : free_blocks_) {
+    stats.free_bytes += pair.first.first;
+  }
+  if (!free_blocks_.empty()) {
+    stats.largest_free_block = free_blocks_.rbegin()->first.first;
   }
+  stats.defragment_num = defragment_num_;
+  stats.recovered_bytes = recovered_bytes_;
+  return stats;
 }
 
 void AutoGrowthBestFitAllocator::FreeIdleChunks() {
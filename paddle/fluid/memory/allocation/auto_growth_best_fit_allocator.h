@@ -20,6 +20,7 @@
 #include <mutex>  // NOLINT
 #include <utility>
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 
 namespace paddle {
 namespace memory {
@@ -33,6 +34,8 @@ class AutoGrowthBestFitAllocator : public Allocator {
 
   bool IsAllocThreadSafe() const override { return true; }
 
+  ChunkStats GetChunkStats() const;
+
  protected:
   Allocation *AllocateImpl(size_t size) override;
 
@@ -41,6 +44,14 @@ class AutoGrowthBestFitAllocator : public Allocator {
  private:
   void FreeIdleChunks();
 
+  // Start to defragment after failing to allocate a chunk for size if
+  // FLAGS_auto_growth_defragment is true.
+  void StartDefragment(size_t size);
+
+  // Finish defragmenting if size is not less than the size failed to
+  // allocate.
+  void FinishDefragment(size_t size);
+
   template <typename T>
   using List = std::list<T>;
 
@@ -80,6 +91,17 @@ class AutoGrowthBestFitAllocator : public Allocator {
   size_t alignment_;
   size_t chunk_size_;
 
+  // While defragmenting, the chunks become idle are released as soon as
+  // their last blocks are freed, instead of caching their memory for the
+  // small allocations, which would make the chunks partially used again.
+  bool defragmenting_{false};
+  // the size failed to allocate, defragmenting finishes when it is allocated
+  size_t defragment_size_{0};
+  size_t defragment_num_{0};
+  size_t recovered_bytes_{0};
+  // the bytes released while defragmenting this time
+  size_t defragment_released_bytes_{0};
+
   mutable std::mutex mtx_;
 };
 
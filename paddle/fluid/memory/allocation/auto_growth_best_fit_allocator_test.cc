@@ -19,6 +19,7 @@
 
 DECLARE_bool(free_idle_chunk);
 DECLARE_bool(free_when_no_cache_hit);
+DECLARE_bool(auto_growth_defragment);
 
 namespace paddle {
 namespace memory {
@@ -150,6 +151,52 @@ static void TestFreeWhenNoCacheHit(bool free_when_no_cache_hit) {
             allocate_size[2] + alignment);
 }
 
+static void TestDefragment(bool defragment) {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  FLAGS_auto_growth_defragment = defragment;
+  size_t alignment = 256;
+  size_t chunk_size = 4096 + alignment;
+  size_t small_size = 1024 + alignment;
+  size_t large_size = 8192 + alignment;
+  auto underlying_allocator = std::make_shared<LimitedResourceAllocator>(
+      2 * chunk_size + small_size);
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      underlying_allocator, alignment);
+
+  auto x = ag_allocator->Allocate(4096);
+  auto y = ag_allocator->Allocate(4096);
+  x.reset();
+  // the chunk of x is partially used by s
+  auto s = ag_allocator->Allocate(1024);
+  y.reset();
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 2 * chunk_size);
+
+  // the chunk of y is released, but the chunk of x is not idle
+  ASSERT_THROW(ag_allocator->Allocate(8192), BadAlloc);
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), chunk_size);
+
+  // freed while waiting for other allocations to be freed, e.g. by
+  // RetryAllocator, then another small allocation comes before the retry
+  s.reset();
+  auto s2 = ag_allocator->Allocate(1024);
+  auto stats = ag_allocator->GetChunkStats();
+  if (defragment) {
+    ASSERT_EQ(underlying_allocator->AllocatedSize(), small_size);
+    auto large = ag_allocator->Allocate(8192);
+    ASSERT_EQ(underlying_allocator->AllocatedSize(), small_size + large_size);
+    stats = ag_allocator->GetChunkStats();
+    ASSERT_EQ(stats.defragment_num, 1UL);
+    ASSERT_GE(stats.recovered_bytes, 4096UL);
+  } else {
+    ASSERT_EQ(underlying_allocator->AllocatedSize(), chunk_size);
+    ASSERT_THROW(ag_allocator->Allocate(8192), BadAlloc);
+    ASSERT_EQ(stats.defragment_num, 0UL);
+    ASSERT_EQ(stats.recovered_bytes, 0UL);
+  }
+  FLAGS_auto_growth_defragment = false;
+}
+
 TEST(test_auto_growth_allocator, test_free_idle_chunk) {
   for (auto free_idle_chunk : {false, true}) {
     for (auto free_when_no_cache_hit : {false, true}) {
@@ -163,6 +210,11 @@ TEST(test_auto_growth_allocator, test_free_when_no_cache_hit) {
   TestFreeWhenNoCacheHit(true);
 }
 
+TEST(test_auto_growth_allocator, test_defragment) {
+  TestDefragment(false);
+  TestDefragment(true);
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
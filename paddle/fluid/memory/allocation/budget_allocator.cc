@@ -0,0 +1,119 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/budget_allocator.h"
+#include <utility>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// The allocation of spill_allocator, which is freed by BudgetAllocator to
+// count the spilled bytes.
+class SpilledAllocation : public Allocation {
+ public:
+  explicit SpilledAllocation(AllocationPtr allocation)
+      : Allocation(allocation->ptr(), allocation->size(), allocation->place()),
+        underlying_allocation_(std::move(allocation)) {}
+
+ private:
+  AllocationPtr underlying_allocation_;
+};
+
+BudgetAllocator::BudgetAllocator(
+    std::shared_ptr<Allocator> underlying_allocator, size_t budget,
+    std::shared_ptr<Allocator> spill_allocator)
+    : underlying_allocator_(std::move(underlying_allocator)),
+      budget_(budget),
+      spill_allocator_(std::move(spill_allocator)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of BudgetAllocator must not be null"));
+}
+
+bool BudgetAllocator::Reserve(size_t size) {
+  size_t allocated = allocated_bytes_.load(std::memory_order_relaxed);
+  do {
+    if (allocated + size > budget_) {
+      return false;
+    }
+  } while (!allocated_bytes_.compare_exchange_weak(
+      allocated, allocated + size, std::memory_order_relaxed));
+  return true;
+}
+
+// The allocations can be larger than the requested size, e.g. rounded up by
+// AutoGrowthBestFitAllocator, so that the bytes are charged by the size of
+// the allocation, which is the one released by FreeImpl.
+Allocation *BudgetAllocator::AllocateImpl(size_t size) {
+  if (LIKELY(Reserve(size))) {
+    AllocationPtr allocation;
+    try {
+      allocation = underlying_allocator_->Allocate(size);
+    } catch (...) {
+      allocated_bytes_.fetch_sub(size, std::memory_order_relaxed);
+      throw;
+    }
+    if (allocation->size() > size) {
+      allocated_bytes_.fetch_add(allocation->size() - size,
+                                 std::memory_order_relaxed);
+    } else if (allocation->size() < size) {
+      allocated_bytes_.fetch_sub(size - allocation->size(),
+                                 std::memory_order_relaxed);
+    }
+    return allocation.release();
+  }
+
+  if (spill_allocator_ == nullptr) {
+    PADDLE_THROW_BAD_ALLOC(platform::errors::ResourceExhausted(
+        "Cannot allocate %d bytes, since %d bytes of the budget %d bytes "
+        "have been allocated",
+        size, AllocatedBytes(), budget_));
+  }
+  auto allocation = spill_allocator_->Allocate(size);
+  spilled_bytes_.fetch_add(allocation->size(), std::memory_order_relaxed);
+  spill_num_.fetch_add(1, std::memory_order_relaxed);
+  VLOG(10) << "Spill " << size << " bytes beyond the budget " << budget_
+           << " bytes, spilled bytes: " << SpilledBytes();
+  return new SpilledAllocation(std::move(allocation));
+}
+
+void BudgetAllocator::FreeImpl(Allocation *allocation) {
+  size_t size = allocation->size();
+  if (dynamic_cast<SpilledAllocation *>(allocation) != nullptr) {
+    delete allocation;
+    spilled_bytes_.fetch_sub(size, std::memory_order_relaxed);
+  } else {
+    Allocator::FreeImpl(allocation);
+    allocated_bytes_.fetch_sub(size, std::memory_order_relaxed);
+  }
+}
+
+static thread_local AllocationContext *current_context = nullptr;
+
+AllocationContext *AllocationContext::Current() { return current_context; }
+
+AllocationContextGuard::AllocationContextGuard(AllocationContext *context)
+    : prev_context_(current_context) {
+  current_context = context;
+}
+
+AllocationContextGuard::~AllocationContextGuard() {
+  current_context = prev_context_;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
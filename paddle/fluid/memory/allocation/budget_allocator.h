@@ -0,0 +1,118 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * BudgetAllocator limits the bytes allocated from the underlying allocator
+ * to a budget. The allocations beyond the budget are spilled to
+ * spill_allocator, e.g. host memory mapped into the device, or fail with
+ * BadAlloc if there is no spill_allocator, so that they can be caught
+ * rather than exhausting the memory shared with other users of the
+ * underlying allocator.
+ */
+class BudgetAllocator : public Allocator {
+ public:
+  BudgetAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                  size_t budget,
+                  std::shared_ptr<Allocator> spill_allocator = nullptr);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t Budget() const { return budget_; }
+
+  // the bytes allocated from the underlying allocator, which are within the
+  // budget, and the bytes allocated from spill_allocator
+  size_t AllocatedBytes() const {
+    return allocated_bytes_.load(std::memory_order_relaxed);
+  }
+  size_t SpilledBytes() const {
+    return spilled_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // the number of allocations spilled since the allocator is created
+  size_t SpillNum() const { return spill_num_.load(std::memory_order_relaxed); }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  // reserve size bytes of the budget, returns false if exceeding it
+  bool Reserve(size_t size);
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  size_t budget_;
+  std::shared_ptr<Allocator> spill_allocator_;
+
+  std::atomic<size_t> allocated_bytes_{0};
+  std::atomic<size_t> spilled_bytes_{0};
+  std::atomic<size_t> spill_num_{0};
+};
+
+/**
+ * AllocationContext routes the allocations of a user on its place to its
+ * own allocator, e.g. an inference predictor to its BudgetAllocator. The
+ * context is set to the current thread by AllocationContextGuard, and
+ * AllocatorFacade allocates in the context of the current thread if the
+ * place matches.
+ */
+class AllocationContext {
+ public:
+  AllocationContext(const platform::Place &place,
+                    std::shared_ptr<Allocator> allocator)
+      : place_(place), allocator_(std::move(allocator)) {}
+
+  const platform::Place &place() const { return place_; }
+
+  const std::shared_ptr<Allocator> &allocator() const { return allocator_; }
+
+  // the context of the current thread, nullptr if there is none
+  static AllocationContext *Current();
+
+ private:
+  platform::Place place_;
+  std::shared_ptr<Allocator> allocator_;
+
+  friend class AllocationContextGuard;
+};
+
+class AllocationContextGuard {
+ public:
+  // context can be nullptr, which allocates without context in the scope
+  explicit AllocationContextGuard(AllocationContext *context);
+
+  ~AllocationContextGuard();
+
+  AllocationContextGuard(const AllocationContextGuard &) = delete;
+  AllocationContextGuard &operator=(const AllocationContextGuard &) = delete;
+
+ private:
+  AllocationContext *prev_context_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
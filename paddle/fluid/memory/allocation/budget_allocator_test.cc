@@ -0,0 +1,110 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/budget_allocator.h"
+#include <memory>
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(BudgetAllocator, FailBeyondBudget) {
+  BudgetAllocator allocator(std::make_shared<CPUAllocator>(), 4096);
+  auto allocation1 = allocator.Allocate(3000);
+  ASSERT_EQ(allocator.AllocatedBytes(), 3000UL);
+  ASSERT_THROW(allocator.Allocate(2000), BadAlloc);
+  ASSERT_EQ(allocator.AllocatedBytes(), 3000UL);
+
+  auto allocation2 = allocator.Allocate(1096);
+  ASSERT_EQ(allocator.AllocatedBytes(), 4096UL);
+  allocation1.reset();
+  allocation2.reset();
+  ASSERT_EQ(allocator.AllocatedBytes(), 0UL);
+  ASSERT_EQ(allocator.SpillNum(), 0UL);
+}
+
+TEST(BudgetAllocator, SpillBeyondBudget) {
+  BudgetAllocator allocator(std::make_shared<CPUAllocator>(), 4096,
+                            std::make_shared<CPUAllocator>());
+  auto allocation1 = allocator.Allocate(3000);
+  auto allocation2 = allocator.Allocate(2000);
+  ASSERT_NE(allocation2->ptr(), nullptr);
+  ASSERT_EQ(allocation2->size(), 2000UL);
+  ASSERT_EQ(allocator.AllocatedBytes(), 3000UL);
+  ASSERT_EQ(allocator.SpilledBytes(), 2000UL);
+  ASSERT_EQ(allocator.SpillNum(), 1UL);
+
+  allocation2.reset();
+  ASSERT_EQ(allocator.SpilledBytes(), 0UL);
+  // the budget is not used by the spilled allocations
+  auto allocation3 = allocator.Allocate(1000);
+  ASSERT_EQ(allocator.AllocatedBytes(), 4000UL);
+  ASSERT_EQ(allocator.SpillNum(), 1UL);
+}
+
+TEST(BudgetAllocator, AlignedAllocations) {
+  // the allocations of AutoGrowthBestFitAllocator are rounded up to 256
+  // bytes, which are charged and released as a whole
+  auto underlying = std::make_shared<AutoGrowthBestFitAllocator>(
+      std::make_shared<CPUAllocator>(), 256, 1 << 20);
+  BudgetAllocator allocator(underlying, 4096,
+                            std::make_shared<AutoGrowthBestFitAllocator>(
+                                std::make_shared<CPUAllocator>(), 256));
+  for (int i = 0; i < 100; ++i) {
+    auto allocation1 = allocator.Allocate(100);
+    auto allocation2 = allocator.Allocate(1000);
+    ASSERT_EQ(allocator.AllocatedBytes(),
+              allocation1->size() + allocation2->size());
+  }
+  ASSERT_EQ(allocator.AllocatedBytes(), 0UL);
+
+  auto allocation1 = allocator.Allocate(4000);
+  ASSERT_EQ(allocator.AllocatedBytes(), 4096UL);
+  // the budget is used up by the rounded up allocation
+  auto allocation2 = allocator.Allocate(10);
+  ASSERT_EQ(allocator.SpillNum(), 1UL);
+  ASSERT_EQ(allocator.SpilledBytes(), allocation2->size());
+  allocation2.reset();
+  allocation1.reset();
+  ASSERT_EQ(allocator.AllocatedBytes(), 0UL);
+  ASSERT_EQ(allocator.SpilledBytes(), 0UL);
+  ASSERT_NO_THROW(allocator.Allocate(4096));
+}
+
+TEST(AllocationContext, Guard) {
+  ASSERT_EQ(AllocationContext::Current(), nullptr);
+  AllocationContext context1(
+      platform::CPUPlace(),
+      std::make_shared<BudgetAllocator>(std::make_shared<CPUAllocator>(), 1));
+  AllocationContext context2(
+      platform::CPUPlace(),
+      std::make_shared<BudgetAllocator>(std::make_shared<CPUAllocator>(), 1));
+  {
+    AllocationContextGuard guard1(&context1);
+    ASSERT_EQ(AllocationContext::Current(), &context1);
+    {
+      AllocationContextGuard guard2(&context2);
+      ASSERT_EQ(AllocationContext::Current(), &context2);
+    }
+    ASSERT_EQ(AllocationContext::Current(), &context1);
+  }
+  ASSERT_EQ(AllocationContext::Current(), nullptr);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
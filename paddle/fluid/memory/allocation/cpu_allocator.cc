@@ -15,6 +15,7 @@
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include <stdlib.h>
 #include <string>
+#include "paddle/fluid/platform/numa.h"
 
 namespace paddle {
 namespace memory {
@@ -39,6 +40,9 @@ Allocation *CPUAllocator::AllocateImpl(size_t size) {
 #else
   PADDLE_ENFORCE_EQ(posix_memalign(&p, kAlignment, size), 0, "Alloc %ld error!",
                     size);
+  if (numa_node_ >= 0 && !platform::SetMemoryNumaNode(p, size, numa_node_)) {
+    VLOG(10) << "Failed to place the CPU memory on NUMA node " << numa_node_;
+  }
 #endif
   return new Allocation(p, size, platform::CPUPlace());
 }
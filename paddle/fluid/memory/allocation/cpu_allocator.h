@@ -31,14 +31,25 @@ namespace allocation {
 //
 // NOTE(yy): It is no need to use `BestFitAllocator` in CPU. We can import
 // an open-sourced allocator into Paddle.
+//
+// The memory is placed on numa_node when it is touched first if numa_node is
+// not -1.
 class CPUAllocator : public Allocator {
  public:
   constexpr static size_t kAlignment = 4096UL;
+
+  explicit CPUAllocator(int numa_node = -1) : numa_node_(numa_node) {}
+
   bool IsAllocThreadSafe() const override;
 
+  int numa_node() const { return numa_node_; }
+
  protected:
   void FreeImpl(Allocation* allocation) override;
   Allocation* AllocateImpl(size_t size) override;
+
+ private:
+  int numa_node_;
 };
 }  // namespace allocation
 }  // namespace memory
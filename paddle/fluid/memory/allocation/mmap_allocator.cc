@@ -23,8 +23,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <map>
 #include <random>
 #include <string>
+#include <vector>
 #include <utility>
 
 namespace paddle {
@@ -51,6 +54,38 @@ MemoryMapReaderAllocation::~MemoryMapReaderAllocation() {
   VLOG(3) << "~MemoryMapReaderAllocation: " << this->ipc_name();
 }
 
+namespace {
+
+// the files mapped by AllocateMemoryMapFileAllocation, by the addresses
+struct MappedFiles {
+  std::map<uintptr_t, size_t> ranges;
+  std::mutex mtx;
+};
+
+MappedFiles &GetMappedFiles() {
+  static MappedFiles files;
+  return files;
+}
+
+// the ranges to read ahead at most this number of pages apart are merged,
+// since reading the pages between them costs less than one more madvise
+constexpr uintptr_t kAdviseMergePages = 8;
+
+}  // namespace
+
+MemoryMapFileAllocation::~MemoryMapFileAllocation() {
+  if (this->size() == 0) return;
+  {
+    auto &files = GetMappedFiles();
+    std::lock_guard<std::mutex> guard(files.mtx);
+    files.ranges.erase(reinterpret_cast<uintptr_t>(this->ptr()));
+  }
+  PADDLE_ENFORCE_NE(
+      munmap(this->ptr(), this->size()), -1,
+      platform::errors::Unavailable("could not unmap the file %s",
+                                    this->path()));
+}
+
 std::string GetIPCName() {
   static std::random_device rd;
   std::string handle = "/paddle_";
@@ -101,6 +136,266 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(fd, -1, platform::errors::NotFound(
+                                "could not open the file %s", path));
+  struct stat st;
+  PADDLE_ENFORCE_EQ(
+      fstat(fd, &st), 0,
+      platform::errors::Unavailable("could not get the size of %s", path));
+  size_t size = static_cast<size_t>(st.st_size);
+  // mmap fails on the empty files
+  void *ptr = nullptr;
+  if (size > 0) {
+    ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    PADDLE_ENFORCE_NE(ptr, MAP_FAILED, platform::errors::Unavailable(
+                                           "could not map the file %s", path));
+  }
+  close(fd);
+  if (size > 0) {
+    auto &files = GetMappedFiles();
+    std::lock_guard<std::mutex> guard(files.mtx);
+    files.ranges[reinterpret_cast<uintptr_t>(ptr)] = size;
+  }
+  return std::make_shared<MemoryMapFileAllocation>(ptr, size, path);
+}
+
+bool IsInMemoryMapFile(const void *ptr, size_t size) {
+  auto begin = reinterpret_cast<uintptr_t>(ptr);
+  auto &files = GetMappedFiles();
+  std::lock_guard<std::mutex> guard(files.mtx);
+  auto it = files.ranges.upper_bound(begin);
+  if (it == files.ranges.begin()) return false;
+  --it;
+  return begin + size <= it->first + it->second;
+}
+
+size_t AdviseMemoryMapWillNeed(
+    std::vector<std::pair<const void *, size_t>> ranges) {
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  std::vector<std::pair<uintptr_t, uintptr_t>> pages;
+  pages.reserve(ranges.size());
+  for (auto &range : ranges) {
+    if (range.second == 0) continue;
+    auto begin = reinterpret_cast<uintptr_t>(range.first);
+    auto end = begin + range.second;
+    pages.emplace_back(begin / page_size * page_size,
+                       (end + page_size - 1) / page_size * page_size);
+  }
+  std::sort(pages.begin(), pages.end());
+
+  size_t advised = 0;
+  for (size_t i = 0; i < pages.size();) {
+    auto begin = pages[i].first;
+    auto end = pages[i].second;
+    for (++i; i < pages.size() &&
+              pages[i].first <= end + kAdviseMergePages * page_size;
+         ++i) {
+      end = std::max(end, pages[i].second);
+    }
+    // the advice only affects the performance, and is dropped on failure
+    if (madvise(reinterpret_cast<void *>(begin), end - begin,
+                MADV_WILLNEED) != 0) {
+      VLOG(4) << "madvise(MADV_WILLNEED) fails on " << end - begin
+              << " bytes at " << begin;
+    }
+    ++advised;
+  }
+  return advised;
+}
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "The state of the shared memory files must be lock free to be "
+              "shared between processes");
+
+constexpr int32_t MemoryMapPoolHeader::kFree;
+constexpr int32_t MemoryMapPoolHeader::kSent;
+constexpr int32_t MemoryMapPoolHeader::kOrphaned;
+constexpr size_t MemoryMapPoolHeader::kSize;
+
+struct MemoryMapPoolWriterAllocation::Block {
+  std::string ipc_name;
+  void *base_ptr;
+  // the bytes mapped, including the header
+  size_t mapped_size;
+  // whether an allocation of this process is using the file
+  std::atomic<bool> held{false};
+
+  std::atomic<int32_t> *state() const {
+    return &static_cast<MemoryMapPoolHeader *>(base_ptr)->state;
+  }
+};
+
+MemoryMapPoolWriterAllocation::MemoryMapPoolWriterAllocation(
+    void *ptr, size_t size, std::shared_ptr<Block> block)
+    : Allocation(ptr, size, platform::CPUPlace()), block_(std::move(block)) {}
+
+const std::string &MemoryMapPoolWriterAllocation::ipc_name() const {
+  return block_->ipc_name;
+}
+
+void MemoryMapPoolWriterAllocation::MarkSent() {
+  block_->state()->store(MemoryMapPoolHeader::kSent, std::memory_order_release);
+}
+
+MemoryMapPoolWriterAllocation::~MemoryMapPoolWriterAllocation() {
+  block_->held.store(false, std::memory_order_release);
+}
+
+MemoryMapPoolReaderAllocation::MemoryMapPoolReaderAllocation(
+    void *base_ptr, size_t size, std::string ipc_name)
+    : Allocation(static_cast<uint8_t *>(base_ptr) + MemoryMapPoolHeader::kSize,
+                 size, platform::CPUPlace()),
+      base_ptr_(base_ptr),
+      ipc_name_(std::move(ipc_name)) {}
+
+MemoryMapPoolReaderAllocation::~MemoryMapPoolReaderAllocation() {
+  auto *state = &static_cast<MemoryMapPoolHeader *>(base_ptr_)->state;
+  int32_t expected = MemoryMapPoolHeader::kSent;
+  // the reads of the data must finish before the writer reuses the file
+  bool released = state->compare_exchange_strong(expected,
+                                                 MemoryMapPoolHeader::kFree,
+                                                 std::memory_order_acq_rel);
+  PADDLE_ENFORCE_NE(
+      munmap(base_ptr_, this->size() + MemoryMapPoolHeader::kSize), -1,
+      platform::errors::Unavailable("could not unmap the shared memory file %s",
+                                    this->ipc_name()));
+  if (!released && expected == MemoryMapPoolHeader::kOrphaned) {
+    shm_unlink(this->ipc_name().c_str());
+  }
+  MemoryMapFdSet::Instance().Remove(this->ipc_name());
+  VLOG(3) << "~MemoryMapPoolReaderAllocation: " << this->ipc_name();
+}
+
+static size_t MemoryMapPoolCapacity(size_t size) {
+  size_t capacity = 4096;
+  while (capacity < size) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+MemoryMapAllocationPool &MemoryMapAllocationPool::Instance() {  // NOLINT
+  static MemoryMapAllocationPool pool;
+  return pool;
+}
+
+void MemoryMapAllocationPool::DropInheritedBlocks() {
+  if (pid_ != getpid()) {
+    blocks_.clear();
+    pid_ = getpid();
+  }
+}
+
+std::shared_ptr<MemoryMapPoolWriterAllocation>
+MemoryMapAllocationPool::Allocate(size_t size) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  DropInheritedBlocks();
+  std::shared_ptr<Block> best;
+  for (auto &block : blocks_) {
+    if (block->held.load(std::memory_order_acquire) ||
+        block->mapped_size - MemoryMapPoolHeader::kSize < size ||
+        block->state()->load(std::memory_order_acquire) !=
+            MemoryMapPoolHeader::kFree) {
+      continue;
+    }
+    if (best == nullptr || block->mapped_size < best->mapped_size) {
+      best = block;
+    }
+  }
+
+  if (best == nullptr) {
+    size_t mapped_size =
+        MemoryMapPoolHeader::kSize + MemoryMapPoolCapacity(size);
+    best = std::make_shared<Block>();
+    best->ipc_name = GetIPCName();
+    best->mapped_size = mapped_size;
+
+    int fd = shm_open(best->ipc_name.c_str(), O_RDWR | O_CREAT, 0644);
+    PADDLE_ENFORCE_NE(
+        fd, -1, platform::errors::Unavailable("File descriptor %s open failed",
+                                              best->ipc_name.c_str()));
+    PADDLE_ENFORCE_EQ(ftruncate(fd, mapped_size), 0,
+                      platform::errors::Unavailable(
+                          "Fruncate a file to a specified length failed!"));
+    best->base_ptr =
+        mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    PADDLE_ENFORCE_NE(best->base_ptr, MAP_FAILED,
+                      platform::errors::Unavailable(
+                          "Memory map failed when create shared memory."));
+    close(fd);
+    // the file is filled with zero by ftruncate, i.e. kFree
+    blocks_.emplace_back(best);
+    VLOG(3) << "MemoryMapAllocationPool: create " << best->ipc_name
+            << ", pool size: " << blocks_.size();
+  }
+
+  best->held.store(true, std::memory_order_release);
+  return std::make_shared<MemoryMapPoolWriterAllocation>(
+      static_cast<uint8_t *>(best->base_ptr) + MemoryMapPoolHeader::kSize, size,
+      best);
+}
+
+size_t MemoryMapAllocationPool::BlockNum() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  DropInheritedBlocks();
+  return blocks_.size();
+}
+
+size_t MemoryMapAllocationPool::FreeBlockNum() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  DropInheritedBlocks();
+  size_t num = 0;
+  for (auto &block : blocks_) {
+    if (!block->held.load(std::memory_order_acquire) &&
+        block->state()->load(std::memory_order_acquire) ==
+            MemoryMapPoolHeader::kFree) {
+      ++num;
+    }
+  }
+  return num;
+}
+
+void MemoryMapAllocationPool::Clear() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  DropInheritedBlocks();
+  VLOG(3) << "PID: " << getpid() << ", MemoryMapAllocationPool: pool size - "
+          << blocks_.size();
+  for (auto &block : blocks_) {
+    int32_t state = block->state()->exchange(MemoryMapPoolHeader::kOrphaned,
+                                             std::memory_order_acq_rel);
+    if (state != MemoryMapPoolHeader::kSent) {
+      shm_unlink(block->ipc_name.c_str());
+    }
+    // the tensors of this process may still use the memory at exit
+    if (!block->held.load(std::memory_order_acquire)) {
+      munmap(block->base_ptr, block->mapped_size);
+    }
+  }
+  blocks_.clear();
+}
+
+MemoryMapAllocationPool::~MemoryMapAllocationPool() { Clear(); }
+
+std::shared_ptr<MemoryMapPoolReaderAllocation>
+RebuildMemoryMapPoolReaderAllocation(const std::string &ipc_name, size_t size) {
+  int fd = shm_open(ipc_name.c_str(), O_RDWR, 0644);
+  PADDLE_ENFORCE_NE(
+      fd, -1, platform::errors::Unavailable("File descriptor %s open failed",
+                                            ipc_name.c_str()));
+
+  // the reader writes the state in the header when releasing the file
+  void *ptr = mmap(NULL, MemoryMapPoolHeader::kSize + size,
+                   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  PADDLE_ENFORCE_NE(ptr, MAP_FAILED,
+                    platform::errors::Unavailable(
+                        "Memory map failed when rebuild shared memory."));
+  close(fd);
+  return std::make_shared<MemoryMapPoolReaderAllocation>(ptr, size, ipc_name);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
@@ -16,11 +16,15 @@
 
 #ifndef _WIN32
 
+#include <sys/types.h>
+
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 
@@ -58,12 +62,150 @@ class MemoryMapReaderAllocation : public Allocation {
   std::string ipc_name_;
 };
 
+/**
+ * MemoryMapFileAllocation maps a regular file, e.g. the parameters of a
+ * model, privately: the pages are shared with the page cache, and so with
+ * the other processes mapping the same file, until they are written, which
+ * copies the written pages only. The file is opened read-only and never
+ * modified.
+ */
+class MemoryMapFileAllocation : public Allocation {
+ public:
+  explicit MemoryMapFileAllocation(void *ptr, size_t size, std::string path)
+      : Allocation(ptr, size, platform::CPUPlace()), path_(std::move(path)) {}
+
+  inline const std::string &path() const { return path_; }
+
+  ~MemoryMapFileAllocation() override;
+
+ private:
+  std::string path_;
+};
+
 std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
     size_t size);
 
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &path);
+
+/**
+ * Whether [ptr, ptr + size) is in a file mapped by
+ * AllocateMemoryMapFileAllocation, whose pages may be read from the disk on
+ * the first access.
+ */
+bool IsInMemoryMapFile(const void *ptr, size_t size);
+
+/**
+ * Ask the kernel to read ahead the pages of the ranges of the mapped files,
+ * so that the pages not in memory are read by one batch of requests in the
+ * background, rather than by one synchronous page fault after another. The
+ * ranges are rounded to the pages, and the ranges a few pages apart are
+ * merged. It returns the number of the merged ranges.
+ */
+size_t AdviseMemoryMapWillNeed(
+    std::vector<std::pair<const void *, size_t>> ranges);
+
+/**
+ * The shared memory files of MemoryMapAllocationPool begin with a header
+ * holding the state of the file, which is shared by the writer process and
+ * the reader process:
+ *
+ *   kFree:     the writer can reuse the file for a new allocation.
+ *   kSent:     the file is sent to the reader, the reader sets it back to
+ *              kFree after releasing the tensor.
+ *   kOrphaned: the writer has exited while the file is sent, the reader
+ *              unlinks the file after releasing the tensor.
+ */
+struct MemoryMapPoolHeader {
+  static constexpr int32_t kFree = 0;
+  static constexpr int32_t kSent = 1;
+  static constexpr int32_t kOrphaned = 2;
+
+  // the data follows the header at this offset
+  static constexpr size_t kSize = 64;
+
+  std::atomic<int32_t> state;
+};
+
+class MemoryMapAllocationPool;
+
+class MemoryMapPoolWriterAllocation : public Allocation {
+ public:
+  struct Block;
+
+  MemoryMapPoolWriterAllocation(void *ptr, size_t size,
+                                std::shared_ptr<Block> block);
+
+  const std::string &ipc_name() const;
+
+  // The file is in use by the reader after it is sent, and the writer can
+  // not reuse it until the reader releases it.
+  void MarkSent();
+
+  ~MemoryMapPoolWriterAllocation() override;
+
+ private:
+  std::shared_ptr<Block> block_;
+};
+
+class MemoryMapPoolReaderAllocation : public Allocation {
+ public:
+  MemoryMapPoolReaderAllocation(void *base_ptr, size_t size,
+                                std::string ipc_name);
+
+  inline const std::string &ipc_name() const { return ipc_name_; }
+
+  ~MemoryMapPoolReaderAllocation() override;
+
+ private:
+  void *base_ptr_;
+  std::string ipc_name_;
+};
+
+/**
+ * MemoryMapAllocationPool keeps the shared memory files allocated by the
+ * writer process, e.g. the child process of DataLoader, so that the files
+ * released by the reader process are reused by the following batches rather
+ * than created, faulted in and unlinked for every tensor. The capacity of
+ * the files is rounded up to power of 2, so the batches of variable sizes
+ * can reuse them too.
+ */
+class MemoryMapAllocationPool {
+ public:
+  static MemoryMapAllocationPool &Instance();  // NOLINT
+
+  std::shared_ptr<MemoryMapPoolWriterAllocation> Allocate(size_t size);
+
+  // the number of files in the pool, and the number of the reusable ones
+  size_t BlockNum();
+  size_t FreeBlockNum();
+
+  // Unlink the reusable files, and leave the files in use by the reader to be
+  // unlinked by the reader.
+  void Clear();
+
+  ~MemoryMapAllocationPool();
+
+ private:
+  using Block = MemoryMapPoolWriterAllocation::Block;
+
+  MemoryMapAllocationPool() = default;
+
+  // the pool of the parent process is inherited by fork(), but the files
+  // belong to the parent process
+  void DropInheritedBlocks();
+
+  std::vector<std::shared_ptr<Block>> blocks_;
+  pid_t pid_{0};
+  std::mutex mtx_;
+};
+
+std::shared_ptr<MemoryMapPoolReaderAllocation>
+RebuildMemoryMapPoolReaderAllocation(const std::string &ipc_name, size_t size);
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
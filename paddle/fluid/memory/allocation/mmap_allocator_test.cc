@@ -16,7 +16,16 @@
 
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -47,6 +56,127 @@ TEST(MemoryMapAllocation, test_allocation_base) {
   }
 }
 
+TEST(MemoryMapAllocationPool, test_reuse) {
+  auto &pool = MemoryMapAllocationPool::Instance();
+  size_t block_num = pool.BlockNum();
+  size_t data_size = 4UL * 1024;
+  auto writer_holder = pool.Allocate(data_size);
+  std::string ipc_name = writer_holder->ipc_name();
+  auto *writer_ptr = static_cast<int32_t *>(writer_holder->ptr());
+  for (int32_t i = 0; i < 1024; ++i) {
+    writer_ptr[i] = i;
+  }
+  // the file can not be reused while the writer holds it
+  ASSERT_NE(pool.Allocate(data_size)->ipc_name(), ipc_name);
+  ASSERT_EQ(pool.BlockNum(), block_num + 2);
+
+  writer_holder->MarkSent();
+  writer_holder.reset();
+  // nor while the reader holds it
+  ASSERT_EQ(pool.FreeBlockNum(), 1UL);
+
+  pid_t fpid = fork();
+  if (fpid == 0) {
+    auto reader_holder =
+        RebuildMemoryMapPoolReaderAllocation(ipc_name, data_size);
+    auto *reader_ptr = static_cast<int32_t *>(reader_holder->ptr());
+    for (int32_t i = 0; i < 1024; ++i) {
+      if (reader_ptr[i] != i) {
+        _exit(1);
+      }
+    }
+    reader_holder.reset();
+    _exit(0);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(fpid, &status, 0), fpid);
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+
+  // the file released by the reader is reused
+  ASSERT_EQ(pool.FreeBlockNum(), 2UL);
+  ASSERT_EQ(pool.Allocate(data_size / 2)->ipc_name(), ipc_name);
+  ASSERT_EQ(pool.BlockNum(), block_num + 2);
+}
+
+TEST(MemoryMapAllocationPool, test_orphaned) {
+  auto &pool = MemoryMapAllocationPool::Instance();
+  size_t data_size = 1024;
+  auto writer_holder = pool.Allocate(data_size);
+  std::string ipc_name = writer_holder->ipc_name();
+  writer_holder->MarkSent();
+  writer_holder.reset();
+  // the writer exits before the reader releases the file
+  pool.Clear();
+  ASSERT_EQ(pool.BlockNum(), 0UL);
+
+  auto reader_holder =
+      RebuildMemoryMapPoolReaderAllocation(ipc_name, data_size);
+  reader_holder.reset();
+  // the reader unlinks the file
+  ASSERT_EQ(shm_open(ipc_name.c_str(), O_RDONLY, 0644), -1);
+}
+
+TEST(MemoryMapFileAllocation, test_copy_on_write) {
+  std::string path = "/tmp/paddle_mmap_file_test_" + std::to_string(getpid());
+  {
+    std::ofstream fout(path, std::ios::binary);
+    for (int32_t i = 0; i < 1024; ++i) {
+      fout.write(reinterpret_cast<const char *>(&i), sizeof(i));
+    }
+  }
+
+  auto holder = AllocateMemoryMapFileAllocation(path);
+  ASSERT_EQ(holder->size(), 1024 * sizeof(int32_t));
+  auto *ptr = static_cast<int32_t *>(holder->ptr());
+  for (int32_t i = 0; i < 1024; ++i) {
+    ASSERT_EQ(ptr[i], i);
+  }
+  // the writes are private, and the file is not modified
+  ptr[0] = -1;
+  holder.reset();
+  {
+    std::ifstream fin(path, std::ios::binary);
+    int32_t first = -1;
+    fin.read(reinterpret_cast<char *>(&first), sizeof(first));
+    ASSERT_EQ(first, 0);
+  }
+  unlink(path.c_str());
+}
+
+TEST(MemoryMapFileAllocation, test_advise_will_need) {
+  std::string path =
+      "/tmp/paddle_mmap_advise_test_" + std::to_string(getpid());
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  {
+    std::ofstream fout(path, std::ios::binary);
+    std::string page(page_size, 'a');
+    for (int i = 0; i < 64; ++i) {
+      fout.write(page.data(), page.size());
+    }
+  }
+
+  auto holder = AllocateMemoryMapFileAllocation(path);
+  auto *ptr = static_cast<const char *>(holder->ptr());
+  ASSERT_TRUE(IsInMemoryMapFile(ptr, holder->size()));
+  ASSERT_TRUE(IsInMemoryMapFile(ptr + page_size, page_size));
+  ASSERT_FALSE(IsInMemoryMapFile(ptr, holder->size() + 1));
+  int local = 0;
+  ASSERT_FALSE(IsInMemoryMapFile(&local, sizeof(local)));
+
+  // the rows in the pages 0, 1 and 4 are merged, and the page 40 is apart
+  std::vector<std::pair<const void *, size_t>> rows = {
+      {ptr + 40 * page_size + 8, 16},
+      {ptr + 4 * page_size, 16},
+      {ptr + page_size - 8, 16},
+      {ptr, 0}};
+  ASSERT_EQ(AdviseMemoryMapWillNeed(rows), 2UL);
+  ASSERT_EQ(ptr[40 * page_size + 8], 'a');
+
+  holder.reset();
+  ASSERT_FALSE(IsInMemoryMapFile(ptr, page_size));
+  unlink(path.c_str());
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
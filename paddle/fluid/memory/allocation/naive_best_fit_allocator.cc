@@ -310,10 +310,47 @@ size_t Usage::operator()(const platform::CUDAPinnedPlace &cuda_pinned) const {
   PADDLE_THROW("'CUDAPinnedPlace' is not supported in CPU only device.");
 #endif
 }
+
+allocation::ChunkStats BuddyChunkStats(BuddyAllocator *buddy_allocator) {
+  allocation::ChunkStats stats;
+  stats.reserved_bytes = buddy_allocator->Reserved();
+  stats.chunk_num = buddy_allocator->ChunkNum();
+  stats.free_bytes = buddy_allocator->FreeBytes();
+  stats.largest_free_block = buddy_allocator->LargestFreeBlock();
+  return stats;
+}
+
+struct ChunkStatsVisitor
+    : public boost::static_visitor<allocation::ChunkStats> {
+  allocation::ChunkStats operator()(const platform::CPUPlace &cpu) const {
+    return BuddyChunkStats(GetCPUBuddyAllocator());
+  }
+
+  allocation::ChunkStats operator()(const platform::CUDAPlace &gpu) const {
+#ifdef PADDLE_WITH_CUDA
+    return BuddyChunkStats(GetGPUBuddyAllocator(gpu.device));
+#else
+    PADDLE_THROW("'CUDAPlace' is not supported in CPU only device.");
+#endif
+  }
+
+  allocation::ChunkStats operator()(
+      const platform::CUDAPinnedPlace &cuda_pinned) const {
+#ifdef PADDLE_WITH_CUDA
+    return BuddyChunkStats(GetCUDAPinnedBuddyAllocator());
+#else
+    PADDLE_THROW("'CUDAPinnedPlace' is not supported in CPU only device.");
+#endif
+  }
+};
 }  // namespace legacy
 
 namespace allocation {
 
+ChunkStats NaiveBestFitAllocator::GetChunkStats() const {
+  return boost::apply_visitor(legacy::ChunkStatsVisitor(), place_);
+}
+
 Allocation *NaiveBestFitAllocator::AllocateImpl(size_t size) {
   void *ptr = boost::apply_visitor(legacy::AllocVisitor(size), place_);
   auto *tmp_alloc = new Allocation(ptr, size, place_);
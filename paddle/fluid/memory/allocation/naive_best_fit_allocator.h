@@ -19,6 +19,7 @@
 #include <utility>
 #include <vector>
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 #include "paddle/fluid/platform/place.h"
 namespace paddle {
 namespace memory {
@@ -30,6 +31,10 @@ class NaiveBestFitAllocator : public Allocator {
 
   bool IsAllocThreadSafe() const override { return true; }
 
+  // the chunks of the BuddyAllocator of place_, which is shared by all the
+  // NaiveBestFitAllocators of the place
+  ChunkStats GetChunkStats() const;
+
  protected:
   Allocation *AllocateImpl(size_t size) override;
   void FreeImpl(Allocation *allocation) override;
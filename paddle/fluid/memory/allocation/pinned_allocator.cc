@@ -15,6 +15,7 @@
 #include "paddle/fluid/memory/allocation/pinned_allocator.h"
 #include <cuda.h>
 #include <cuda_runtime.h>
+#include "paddle/fluid/platform/cuda_device_guard.h"
 
 namespace paddle {
 namespace memory {
@@ -29,6 +30,35 @@ Allocation *CPUPinnedAllocator::AllocateImpl(size_t size) {
   PADDLE_ENFORCE(cudaHostAlloc(&ptr, size, cudaHostAllocPortable));
   return new Allocation(ptr, size, platform::CUDAPinnedPlace());
 }
+
+class CUDAMappedPinnedAllocation : public Allocation {
+ public:
+  CUDAMappedPinnedAllocation(void *device_ptr, void *host_ptr, size_t size,
+                             const platform::CUDAPlace &place)
+      : Allocation(device_ptr, size, place), host_ptr_(host_ptr) {}
+
+  void *host_ptr() const { return host_ptr_; }
+
+ private:
+  void *host_ptr_;
+};
+
+void CUDAMappedPinnedAllocator::FreeImpl(Allocation *allocation) {
+  auto *mapped_allocation =
+      static_cast<CUDAMappedPinnedAllocation *>(allocation);
+  PADDLE_ENFORCE(cudaFreeHost(mapped_allocation->host_ptr()));
+  delete allocation;
+}
+
+Allocation *CUDAMappedPinnedAllocator::AllocateImpl(size_t size) {
+  platform::CUDADeviceGuard guard(place_.device);
+  void *host_ptr;
+  PADDLE_ENFORCE(cudaHostAlloc(&host_ptr, size,
+                               cudaHostAllocPortable | cudaHostAllocMapped));
+  void *device_ptr;
+  PADDLE_ENFORCE(cudaHostGetDevicePointer(&device_ptr, host_ptr, 0));
+  return new CUDAMappedPinnedAllocation(device_ptr, host_ptr, size, place_);
+}
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
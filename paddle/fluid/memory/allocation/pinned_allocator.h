@@ -14,6 +14,7 @@
 
 #pragma once
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
 
 namespace paddle {
 namespace memory {
@@ -29,6 +30,24 @@ class CPUPinnedAllocator : public Allocator {
   Allocation *AllocateImpl(size_t size) override;
 };
 
+// Allocator uses `cudaHostAlloc` with `cudaHostAllocMapped`, the allocations
+// are host memory accessed by the kernels of place through PCIe, e.g. to
+// spill the allocations of place beyond its memory.
+class CUDAMappedPinnedAllocator : public Allocator {
+ public:
+  explicit CUDAMappedPinnedAllocator(const platform::CUDAPlace &place)
+      : place_(place) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+ protected:
+  void FreeImpl(Allocation *allocation) override;
+  Allocation *AllocateImpl(size_t size) override;
+
+ private:
+  platform::CUDAPlace place_;
+};
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
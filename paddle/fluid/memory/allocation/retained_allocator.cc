@@ -0,0 +1,89 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/retained_allocator.h"
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace {
+
+class RetainedAllocation : public Allocation {
+ public:
+  RetainedAllocation(std::shared_ptr<Allocation> underlying_allocation,
+                     std::shared_ptr<RetainedAllocator> allocator)
+      : Allocation(underlying_allocation->ptr(), underlying_allocation->size(),
+                   underlying_allocation->place()),
+        underlying_allocation_(std::move(underlying_allocation)),
+        allocator_(std::move(allocator)) {}
+
+  std::shared_ptr<RetainedAllocator> MoveAllocator() {
+    return std::move(allocator_);
+  }
+
+ private:
+  std::shared_ptr<Allocation> underlying_allocation_;
+  std::shared_ptr<RetainedAllocator> allocator_;
+};
+
+}  // namespace
+
+RetainedAllocator::RetainedAllocator(
+    std::shared_ptr<Allocator> underlying_allocator)
+    : underlying_allocator_(std::move(underlying_allocator)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of RetainedAllocator must not be null"));
+}
+
+size_t RetainedAllocator::RetainedBytes() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return retained_bytes_;
+}
+
+void RetainedAllocator::Release() {
+  std::vector<std::shared_ptr<Allocation>> allocations;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    allocations.swap(retained_allocations_);
+    retained_bytes_ = 0;
+  }
+}
+
+Allocation *RetainedAllocator::AllocateImpl(size_t size) {
+  std::shared_ptr<Allocation> underlying_allocation =
+      underlying_allocator_->Allocate(size);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    retained_allocations_.push_back(underlying_allocation);
+    retained_bytes_ += underlying_allocation->size();
+  }
+  return new RetainedAllocation(std::move(underlying_allocation),
+                                shared_from_this());
+}
+
+void RetainedAllocator::FreeImpl(Allocation *allocation) {
+  // the allocation may hold the last reference of the allocator, which is
+  // destroyed after the allocation, and nothing is accessed after that
+  auto self = static_cast<RetainedAllocation *>(allocation)->MoveAllocator();
+  delete allocation;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,66 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * RetainedAllocator keeps the memory of its allocations after they are
+ * freed, until Release() is called or the allocator is destroyed. It is
+ * used while capturing a CUDA graph, whose kernels keep using the memory
+ * allocated during the capture, e.g. the temporary buffers of the kernels,
+ * every time the graph is replayed.
+ *
+ * The allocations keep the allocator alive, so it must be created by
+ * std::make_shared.
+ */
+class RetainedAllocator
+    : public Allocator,
+      public std::enable_shared_from_this<RetainedAllocator> {
+ public:
+  explicit RetainedAllocator(std::shared_ptr<Allocator> underlying_allocator);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // the bytes of the allocations retained, both in use and freed
+  size_t RetainedBytes() const;
+
+  // Stop retaining the allocations, the memory of the freed ones is
+  // returned to the underlying allocator.
+  void Release();
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<Allocation>> retained_allocations_;
+  size_t retained_bytes_{0};
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,80 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/retained_allocator.h"
+#include <memory>
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// counts the bytes allocated from the underlying allocator
+class CountingAllocator : public Allocator {
+ public:
+  size_t AllocatedBytes() const { return allocated_bytes_; }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override {
+    allocated_bytes_ += size;
+    return underlying_allocator_.Allocate(size).release();
+  }
+
+  void FreeImpl(Allocation *allocation) override {
+    allocated_bytes_ -= allocation->size();
+    Allocator::FreeImpl(allocation);
+  }
+
+ private:
+  CPUAllocator underlying_allocator_;
+  size_t allocated_bytes_{0};
+};
+
+TEST(RetainedAllocator, RetainFreed) {
+  auto counting_allocator = std::make_shared<CountingAllocator>();
+  auto allocator = std::make_shared<RetainedAllocator>(counting_allocator);
+
+  auto allocation1 = allocator->Allocate(1000);
+  auto allocation2 = allocator->Allocate(2000);
+  void *ptr = allocation1->ptr();
+  allocation1.reset();
+  // the freed memory is not reused
+  auto allocation3 = allocator->Allocate(1000);
+  ASSERT_NE(allocation3->ptr(), ptr);
+  ASSERT_EQ(allocator->RetainedBytes(), 4000UL);
+  ASSERT_EQ(counting_allocator->AllocatedBytes(), 4000UL);
+
+  allocator->Release();
+  ASSERT_EQ(allocator->RetainedBytes(), 0UL);
+  // the allocations in use are kept
+  ASSERT_EQ(counting_allocator->AllocatedBytes(), 3000UL);
+  allocation2.reset();
+  ASSERT_EQ(counting_allocator->AllocatedBytes(), 1000UL);
+}
+
+TEST(RetainedAllocator, OutliveAllocator) {
+  auto counting_allocator = std::make_shared<CountingAllocator>();
+  auto allocator = std::make_shared<RetainedAllocator>(counting_allocator);
+  auto allocation = allocator->Allocate(1000);
+  allocator.reset();
+  // the allocation keeps the allocator alive
+  ASSERT_EQ(counting_allocator->AllocatedBytes(), 1000UL);
+  allocation.reset();
+  ASSERT_EQ(counting_allocator->AllocatedBytes(), 0UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,134 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+#include <algorithm>
+#include <utility>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace {
+
+class SlabAllocation : public Allocation {
+ public:
+  SlabAllocation(void *ptr, int size_class, const platform::Place &place)
+      : Allocation(ptr, SlabAllocator::ClassSize(size_class), place),
+        size_class_(size_class) {}
+
+  int size_class() const { return size_class_; }
+
+ private:
+  int size_class_;
+};
+
+}  // namespace
+
+constexpr size_t SlabAllocator::kMinClassSize;
+constexpr size_t SlabAllocator::kMinSlabSize;
+constexpr size_t SlabAllocator::kMinBlocksPerSlab;
+
+SlabAllocator::SlabAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                             size_t max_size)
+    : underlying_allocator_(std::move(underlying_allocator)),
+      max_size_(max_size) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of SlabAllocator must not be null"));
+  PADDLE_ENFORCE_GT(max_size_, 0,
+                    platform::errors::InvalidArgument(
+                        "The max size of SlabAllocator must be larger than 0"));
+  int class_num = SizeClass(max_size_) + 1;
+  // round max_size_ up to the size class, which is allocated from the slabs
+  max_size_ = ClassSize(class_num - 1);
+  for (int i = 0; i < class_num; ++i) {
+    lists_.emplace_back(new SizeClassList());
+  }
+}
+
+int SlabAllocator::SizeClass(size_t size) {
+  if (size <= kMinClassSize) {
+    return 0;
+  }
+  // log2 of size rounded up to the power of 2, minus log2(kMinClassSize)
+  return 64 - __builtin_clzll(static_cast<uint64_t>(size - 1)) - 8;
+}
+
+size_t SlabAllocator::SlabSize(int size_class) {
+  return std::max(kMinSlabSize, ClassSize(size_class) * kMinBlocksPerSlab);
+}
+
+size_t SlabAllocator::SlabBytes() {
+  size_t bytes = 0;
+  for (size_t i = 0; i < lists_.size(); ++i) {
+    std::lock_guard<std::mutex> guard(lists_[i]->mtx);
+    bytes += lists_[i]->slabs.size() * SlabSize(static_cast<int>(i));
+  }
+  return bytes;
+}
+
+void SlabAllocator::AllocateSlab(int size_class, SizeClassList *list) {
+  size_t slab_size = SlabSize(size_class);
+  size_t class_size = ClassSize(size_class);
+  auto slab = underlying_allocator_->Allocate(slab_size);
+  auto *ptr = static_cast<uint8_t *>(slab->ptr());
+  // pushed in the reverse order, so that the blocks are taken in the order
+  // of address
+  for (size_t offset = slab_size; offset >= class_size; offset -= class_size) {
+    list->free_blocks.push_back(ptr + offset - class_size);
+  }
+  list->slabs.emplace_back(std::move(slab));
+  VLOG(10) << "SlabAllocator: allocate a slab of " << slab_size
+           << " bytes for size class " << class_size;
+}
+
+Allocation *SlabAllocator::AllocateImpl(size_t size) {
+  if (size > max_size_) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+  int size_class = SizeClass(size);
+  auto &list = *lists_[size_class];
+  void *ptr;
+  platform::Place place;
+  {
+    std::lock_guard<std::mutex> guard(list.mtx);
+    if (list.free_blocks.empty()) {
+      AllocateSlab(size_class, &list);
+    }
+    ptr = list.free_blocks.back();
+    list.free_blocks.pop_back();
+    place = list.slabs.back()->place();
+  }
+  return new SlabAllocation(ptr, size_class, place);
+}
+
+void SlabAllocator::FreeImpl(Allocation *allocation) {
+  auto *slab_allocation = dynamic_cast<SlabAllocation *>(allocation);
+  if (slab_allocation == nullptr) {
+    Allocator::FreeImpl(allocation);
+    return;
+  }
+  auto &list = *lists_[slab_allocation->size_class()];
+  {
+    std::lock_guard<std::mutex> guard(list.mtx);
+    list.free_blocks.push_back(slab_allocation->ptr());
+  }
+  delete slab_allocation;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
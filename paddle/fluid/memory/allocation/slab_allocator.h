@@ -0,0 +1,82 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * SlabAllocator serves small allocations, e.g. the scalars, LoD offsets and
+ * temporary storages of GPU kernels, from slabs of the underlying allocator.
+ * Sizes not larger than max_size are rounded up to power of 2 size classes
+ * starting from kMinClassSize, and each size class keeps a free list of
+ * blocks carved from its slabs, so allocating and freeing them is O(1)
+ * rather than a best-fit search of the underlying allocator. The slabs are
+ * kept until the allocator is destroyed. Larger allocations go to the
+ * underlying allocator directly.
+ */
+class SlabAllocator : public Allocator {
+ public:
+  // kMinClassSize keeps the blocks aligned like the GPU allocations
+  static constexpr size_t kMinClassSize = 256;
+  static constexpr size_t kMinSlabSize = 64 << 10;
+  static constexpr size_t kMinBlocksPerSlab = 16;
+
+  SlabAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                size_t max_size);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // the size class of size, size must not be larger than max_size
+  static int SizeClass(size_t size);
+
+  static size_t ClassSize(int size_class) {
+    return kMinClassSize << size_class;
+  }
+
+  static size_t SlabSize(int size_class);
+
+  // the bytes of the slabs allocated from the underlying allocator
+  size_t SlabBytes();
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  struct SizeClassList {
+    std::mutex mtx;
+    std::vector<void *> free_blocks;
+    std::vector<AllocationPtr> slabs;
+  };
+
+  // carve a new slab of size_class into free blocks, with list->mtx held
+  void AllocateSlab(int size_class, SizeClassList *list);
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  size_t max_size_;
+  std::vector<std::unique_ptr<SizeClassList>> lists_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,100 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+#include <memory>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(SlabAllocator, SizeClass) {
+  ASSERT_EQ(SlabAllocator::SizeClass(1), 0);
+  ASSERT_EQ(SlabAllocator::SizeClass(256), 0);
+  ASSERT_EQ(SlabAllocator::SizeClass(257), 1);
+  ASSERT_EQ(SlabAllocator::SizeClass(512), 1);
+  ASSERT_EQ(SlabAllocator::SizeClass(4096), 4);
+  ASSERT_EQ(SlabAllocator::ClassSize(4), 4096UL);
+  ASSERT_EQ(SlabAllocator::SlabSize(0), SlabAllocator::kMinSlabSize);
+  ASSERT_EQ(SlabAllocator::SlabSize(10),
+            SlabAllocator::ClassSize(10) * SlabAllocator::kMinBlocksPerSlab);
+}
+
+TEST(SlabAllocator, Reuse) {
+  SlabAllocator allocator(std::make_shared<CPUAllocator>(), 4096);
+  auto allocation = allocator.Allocate(100);
+  ASSERT_EQ(allocation->size(), 256UL);
+  ASSERT_EQ(allocator.SlabBytes(), SlabAllocator::kMinSlabSize);
+  void *ptr = allocation->ptr();
+  allocation.reset();
+  // the freed block is taken at once
+  ASSERT_EQ(allocator.Allocate(200)->ptr(), ptr);
+
+  // the blocks of a slab are distinct and aligned
+  size_t block_num = SlabAllocator::kMinSlabSize / 256;
+  std::vector<AllocationPtr> allocations;
+  std::set<void *> ptrs;
+  for (size_t i = 0; i < block_num; ++i) {
+    allocations.emplace_back(allocator.Allocate(256));
+    ptrs.insert(allocations.back()->ptr());
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(allocations.back()->ptr()) % 256,
+              0UL);
+  }
+  ASSERT_EQ(ptrs.size(), block_num);
+  ASSERT_EQ(allocator.SlabBytes(), SlabAllocator::kMinSlabSize);
+  allocations.emplace_back(allocator.Allocate(256));
+  ASSERT_EQ(allocator.SlabBytes(), 2 * SlabAllocator::kMinSlabSize);
+}
+
+TEST(SlabAllocator, LargeAllocation) {
+  SlabAllocator allocator(std::make_shared<CPUAllocator>(), 4000);
+  // max_size is rounded up to the size class
+  ASSERT_EQ(allocator.Allocate(4096)->size(), 4096UL);
+  ASSERT_EQ(allocator.SlabBytes(), SlabAllocator::SlabSize(4));
+
+  auto allocation = allocator.Allocate(5000);
+  ASSERT_EQ(allocation->size(), 5000UL);
+  ASSERT_EQ(allocator.SlabBytes(), SlabAllocator::SlabSize(4));
+}
+
+TEST(SlabAllocator, MultiThread) {
+  auto allocator =
+      std::make_shared<SlabAllocator>(std::make_shared<CPUAllocator>(), 4096);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([allocator, i] {
+      std::vector<AllocationPtr> allocations;
+      for (int j = 0; j < 1000; ++j) {
+        allocations.emplace_back(allocator->Allocate((i + j) % 4096 + 1));
+        auto *ptr = static_cast<uint8_t *>(allocations.back()->ptr());
+        ptr[0] = static_cast<uint8_t>(j);
+        if (j % 3 == 0) {
+          allocations.pop_back();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
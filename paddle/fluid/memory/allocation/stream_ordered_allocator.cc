@@ -0,0 +1,168 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/stream_ordered_allocator.h"
+#include <utility>
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+StreamOrderedAllocator::StreamOrderedAllocator(
+    std::shared_ptr<Allocator> underlying_allocator,
+    const platform::CUDAPlace &place)
+    : underlying_allocator_(std::move(underlying_allocator)), place_(place) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of StreamOrderedAllocator must not be null"));
+  PADDLE_ENFORCE_EQ(underlying_allocator_->IsAllocThreadSafe(), true,
+                    platform::errors::InvalidArgument(
+                        "Underlying allocator of StreamOrderedAllocator must "
+                        "be thread safe"));
+}
+
+StreamOrderedAllocator::~StreamOrderedAllocator() {
+  platform::CUDADeviceGuard guard(place_.device);
+  std::lock_guard<std::mutex> guard_lock(mtx_);
+  ReleaseImpl();
+  for (auto event : events_) {
+    cudaEventDestroy(event);
+  }
+}
+
+AllocationPtr StreamOrderedAllocator::Allocate(size_t size,
+                                               cudaStream_t stream) {
+  auto allocation = TakeFreeBlock(size, stream);
+  if (allocation == nullptr) {
+    allocation = UnderlyingAllocate(size);
+  }
+  return WrapAllocation(
+      new StreamOrderedAllocation(std::move(allocation), stream));
+}
+
+void StreamOrderedAllocator::Release() {
+  platform::CUDADeviceGuard guard(place_.device);
+  std::lock_guard<std::mutex> guard_lock(mtx_);
+  ReleaseImpl();
+}
+
+Allocation *StreamOrderedAllocator::AllocateImpl(size_t size) {
+  return UnderlyingAllocate(size).release();
+}
+
+void StreamOrderedAllocator::FreeImpl(Allocation *allocation) {
+  auto *stream_allocation = dynamic_cast<StreamOrderedAllocation *>(allocation);
+  if (stream_allocation == nullptr) {
+    // allocated by Allocate(size)
+    Allocator::FreeImpl(allocation);
+    return;
+  }
+  cudaStream_t stream = stream_allocation->stream();
+  FreeBlock block;
+  block.allocation_ = std::move(stream_allocation->underlying_allocation_);
+  delete stream_allocation;
+
+  platform::CUDADeviceGuard guard(place_.device);
+  std::lock_guard<std::mutex> guard_lock(mtx_);
+  block.event_ = GetEvent();
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(block.event_, stream));
+  size_t block_size = block.allocation_->size();
+  free_blocks_[stream].emplace(block_size, std::move(block));
+}
+
+AllocationPtr StreamOrderedAllocator::TakeFreeBlock(size_t size,
+                                                    cudaStream_t stream) {
+  std::lock_guard<std::mutex> guard_lock(mtx_);
+  if (free_blocks_.empty()) {
+    return nullptr;
+  }
+  // a block at most twice as large as size is used, so that small
+  // allocations do not hold large blocks
+  auto take = [size](FreeBlocks *blocks) -> FreeBlocks::iterator {
+    auto iter = blocks->lower_bound(size);
+    if (iter != blocks->end() && iter->first / 2 <= size) {
+      return iter;
+    }
+    return blocks->end();
+  };
+
+  auto same_stream = free_blocks_.find(stream);
+  if (same_stream != free_blocks_.end()) {
+    auto iter = take(&same_stream->second);
+    if (iter != same_stream->second.end()) {
+      auto allocation = std::move(iter->second.allocation_);
+      events_.push_back(iter->second.event_);
+      same_stream->second.erase(iter);
+      return allocation;
+    }
+  }
+
+  for (auto &pair : free_blocks_) {
+    if (pair.first == stream) {
+      continue;
+    }
+    auto iter = take(&pair.second);
+    if (iter != pair.second.end()) {
+      platform::CUDADeviceGuard guard(place_.device);
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaStreamWaitEvent(stream, iter->second.event_, 0));
+      auto allocation = std::move(iter->second.allocation_);
+      events_.push_back(iter->second.event_);
+      pair.second.erase(iter);
+      return allocation;
+    }
+  }
+  return nullptr;
+}
+
+AllocationPtr StreamOrderedAllocator::UnderlyingAllocate(size_t size) {
+  try {
+    return underlying_allocator_->Allocate(size);
+  } catch (BadAlloc &) {
+    VLOG(2) << "Release the cached allocations of StreamOrderedAllocator on "
+            << place_ << " and retry to allocate " << size << " bytes";
+    Release();
+    return underlying_allocator_->Allocate(size);
+  }
+}
+
+cudaEvent_t StreamOrderedAllocator::GetEvent() {
+  if (!events_.empty()) {
+    cudaEvent_t event = events_.back();
+    events_.pop_back();
+    return event;
+  }
+  cudaEvent_t event;
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  return event;
+}
+
+void StreamOrderedAllocator::ReleaseImpl() {
+  for (auto &pair : free_blocks_) {
+    for (auto &block : pair.second) {
+      // the kernels using the block may not have finished yet
+      PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventSynchronize(block.second.event_));
+      events_.push_back(block.second.event_);
+    }
+  }
+  free_blocks_.clear();
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
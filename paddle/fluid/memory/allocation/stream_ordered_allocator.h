@@ -0,0 +1,133 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cuda_runtime.h>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * StreamOrderedAllocation is an allocation used in the CUDA stream it is
+ * allocated on.
+ */
+class StreamOrderedAllocation : public Allocation {
+ public:
+  StreamOrderedAllocation(AllocationPtr allocation, cudaStream_t stream)
+      : Allocation(allocation->ptr(), allocation->size(), allocation->place()),
+        underlying_allocation_(std::move(allocation)),
+        stream_(stream) {}
+
+  cudaStream_t stream() const { return stream_; }
+
+ private:
+  AllocationPtr underlying_allocation_;
+  cudaStream_t stream_;
+
+  friend class StreamOrderedAllocator;
+};
+
+/**
+ * StreamOrderedAllocator caches the allocations freed by
+ * Allocate(size, stream) in a free list of their stream. An allocation is
+ * reused at once on the same stream, since the kernels of a stream run in
+ * order. On other streams it is reused after the stream waits for the event
+ * recorded when it was freed, so no cudaStreamSynchronize is needed.
+ *
+ * Allocate(size) is not stream ordered, it goes to the underlying allocator
+ * directly as before. The cached allocations are given back to the
+ * underlying allocator when it runs out of memory.
+ */
+class StreamOrderedAllocator : public Allocator {
+ public:
+  StreamOrderedAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                         const platform::CUDAPlace &place);
+
+  ~StreamOrderedAllocator();
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  using Allocator::Allocate;
+
+  AllocationPtr Allocate(size_t size, cudaStream_t stream);
+
+  // Give all cached allocations back to the underlying allocator.
+  void Release();
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  struct FreeBlock {
+    AllocationPtr allocation_;
+    // recorded on the stream of the allocation when it is freed
+    cudaEvent_t event_;
+  };
+
+  using FreeBlocks = std::multimap<size_t, FreeBlock>;
+
+  // Take a cached allocation of at least size bytes for stream, returns
+  // nullptr if there is none.
+  AllocationPtr TakeFreeBlock(size_t size, cudaStream_t stream);
+
+  AllocationPtr UnderlyingAllocate(size_t size);
+
+  cudaEvent_t GetEvent();
+
+  void ReleaseImpl();
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  platform::CUDAPlace place_;
+  std::map<cudaStream_t, FreeBlocks> free_blocks_;
+  std::vector<cudaEvent_t> events_;
+  std::mutex mtx_;
+};
+
+/**
+ * StreamBoundAllocator allocates in the stream it is bound to by a
+ * StreamOrderedAllocator, e.g. for the allocation context of a thread
+ * running on its own stream, so that Allocate(size) is stream ordered too.
+ */
+class StreamBoundAllocator : public Allocator {
+ public:
+  StreamBoundAllocator(std::shared_ptr<StreamOrderedAllocator> allocator,
+                       cudaStream_t stream)
+      : allocator_(std::move(allocator)), stream_(stream) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override {
+    return allocator_->Allocate(size, stream_).release();
+  }
+
+ private:
+  std::shared_ptr<StreamOrderedAllocator> allocator_;
+  cudaStream_t stream_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
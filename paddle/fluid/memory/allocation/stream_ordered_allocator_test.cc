@@ -0,0 +1,139 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/stream_ordered_allocator.h"
+#include <cuda_runtime.h>
+#include <memory>
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cuda_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class CountedAllocator : public Allocator {
+ public:
+  explicit CountedAllocator(std::shared_ptr<Allocator> allocator)
+      : underlying_allocator_(std::move(allocator)) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t AllocatedCount() const { return allocated_count_; }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override {
+    ++allocated_count_;
+    return underlying_allocator_->Allocate(size).release();
+  }
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+  size_t allocated_count_{0};
+};
+
+TEST(StreamOrderedAllocator, ReuseInStreams) {
+  platform::CUDAPlace place(0);
+  auto counted_allocator = std::make_shared<CountedAllocator>(
+      std::make_shared<AutoGrowthBestFitAllocator>(
+          std::make_shared<CUDAAllocator>(place), 256));
+  StreamOrderedAllocator allocator(counted_allocator, place);
+
+  cudaStream_t stream1, stream2;
+  ASSERT_EQ(cudaStreamCreateWithFlags(&stream1, cudaStreamNonBlocking),
+            cudaSuccess);
+  ASSERT_EQ(cudaStreamCreateWithFlags(&stream2, cudaStreamNonBlocking),
+            cudaSuccess);
+
+  auto allocation = allocator.Allocate(4096, stream1);
+  void *ptr = allocation->ptr();
+  ASSERT_EQ(cudaMemsetAsync(ptr, 0, 4096, stream1), cudaSuccess);
+  allocation.reset();
+  ASSERT_EQ(counted_allocator->AllocatedCount(), 1UL);
+
+  // reused at once in the same stream
+  allocation = allocator.Allocate(4000, stream1);
+  ASSERT_EQ(allocation->ptr(), ptr);
+  allocation.reset();
+
+  // too large for the cached allocation
+  auto large_allocation = allocator.Allocate(8192, stream1);
+  ASSERT_NE(large_allocation->ptr(), ptr);
+  ASSERT_EQ(counted_allocator->AllocatedCount(), 2UL);
+
+  // reused in another stream after waiting for stream1
+  allocation = allocator.Allocate(4096, stream2);
+  ASSERT_EQ(allocation->ptr(), ptr);
+  ASSERT_EQ(counted_allocator->AllocatedCount(), 2UL);
+  ASSERT_EQ(cudaMemsetAsync(allocation->ptr(), 1, 4096, stream2),
+            cudaSuccess);
+  allocation.reset();
+  large_allocation.reset();
+
+  // Allocate(size) is not cached
+  auto plain_allocation = allocator.Allocate(4096);
+  ASSERT_EQ(counted_allocator->AllocatedCount(), 3UL);
+  plain_allocation.reset();
+
+  allocator.Release();
+  allocation = allocator.Allocate(4096, stream1);
+  ASSERT_EQ(counted_allocator->AllocatedCount(), 4UL);
+  allocation.reset();
+
+  ASSERT_EQ(cudaStreamSynchronize(stream1), cudaSuccess);
+  ASSERT_EQ(cudaStreamSynchronize(stream2), cudaSuccess);
+  ASSERT_EQ(cudaStreamDestroy(stream1), cudaSuccess);
+  ASSERT_EQ(cudaStreamDestroy(stream2), cudaSuccess);
+}
+
+TEST(StreamBoundAllocator, AllocateInStream) {
+  platform::CUDAPlace place(0);
+  auto counted_allocator = std::make_shared<CountedAllocator>(
+      std::make_shared<AutoGrowthBestFitAllocator>(
+          std::make_shared<CUDAAllocator>(place), 256));
+  auto stream_ordered_allocator =
+      std::make_shared<StreamOrderedAllocator>(counted_allocator, place);
+
+  cudaStream_t stream1, stream2;
+  ASSERT_EQ(cudaStreamCreateWithFlags(&stream1, cudaStreamNonBlocking),
+            cudaSuccess);
+  ASSERT_EQ(cudaStreamCreateWithFlags(&stream2, cudaStreamNonBlocking),
+            cudaSuccess);
+  StreamBoundAllocator allocator1(stream_ordered_allocator, stream1);
+  StreamBoundAllocator allocator2(stream_ordered_allocator, stream2);
+
+  // the allocations of Allocate(size) are cached in the stream bound
+  auto allocation = allocator1.Allocate(4096);
+  void *ptr = allocation->ptr();
+  allocation.reset();
+  allocation = allocator1.Allocate(4096);
+  ASSERT_EQ(allocation->ptr(), ptr);
+  allocation.reset();
+  ASSERT_EQ(counted_allocator->AllocatedCount(), 1UL);
+
+  allocation = allocator2.Allocate(4096);
+  ASSERT_EQ(allocation->ptr(), ptr);
+  ASSERT_EQ(counted_allocator->AllocatedCount(), 1UL);
+  allocation.reset();
+
+  ASSERT_EQ(cudaStreamSynchronize(stream1), cudaSuccess);
+  ASSERT_EQ(cudaStreamSynchronize(stream2), cudaSuccess);
+  stream_ordered_allocator->Release();
+  ASSERT_EQ(cudaStreamDestroy(stream1), cudaSuccess);
+  ASSERT_EQ(cudaStreamDestroy(stream2), cudaSuccess);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
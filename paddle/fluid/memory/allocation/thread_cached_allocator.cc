@@ -0,0 +1,235 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace {
+
+constexpr int kClassNum = 11;
+
+class ThreadCachedAllocation : public Allocation {
+ public:
+  ThreadCachedAllocation(AllocationPtr allocation, int size_class)
+      : Allocation(allocation->ptr(),
+                   ThreadCachedAllocator::ClassSize(size_class),
+                   allocation->place()),
+        underlying_allocation_(std::move(allocation)),
+        size_class_(size_class) {}
+
+  int size_class() const { return size_class_; }
+
+ private:
+  AllocationPtr underlying_allocation_;
+  int size_class_;
+};
+
+}  // namespace
+
+class ThreadCachedAllocator::CentralCache {
+ public:
+  explicit CentralCache(std::shared_ptr<Allocator> underlying_allocator)
+      : underlying_allocator_(std::move(underlying_allocator)) {}
+
+  ~CentralCache() {
+    for (auto &list : free_lists_) {
+      for (auto *allocation : list) {
+        delete allocation;
+      }
+    }
+  }
+
+  Allocation *Allocate(int size_class) {
+    {
+      std::lock_guard<std::mutex> guard(mtx_[size_class]);
+      auto &list = free_lists_[size_class];
+      if (!list.empty()) {
+        auto *allocation = list.back();
+        list.pop_back();
+        return allocation;
+      }
+    }
+    return new ThreadCachedAllocation(
+        underlying_allocator_->Allocate(ClassSize(size_class)), size_class);
+  }
+
+  // Move at most n allocations of size_class to out, at least one is moved.
+  void Fetch(int size_class, size_t n, std::vector<Allocation *> *out) {
+    {
+      std::lock_guard<std::mutex> guard(mtx_[size_class]);
+      auto &list = free_lists_[size_class];
+      size_t num = std::min(n, list.size());
+      out->insert(out->end(), list.end() - num, list.end());
+      list.resize(list.size() - num);
+    }
+    if (out->empty()) {
+      out->push_back(Allocate(size_class));
+    }
+  }
+
+  // Move the last n allocations of list here.
+  void Return(int size_class, std::vector<Allocation *> *list, size_t n) {
+    std::lock_guard<std::mutex> guard(mtx_[size_class]);
+    auto &free_list = free_lists_[size_class];
+    free_list.insert(free_list.end(), list->end() - n, list->end());
+    list->resize(list->size() - n);
+  }
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+  std::mutex mtx_[kClassNum];
+  std::vector<Allocation *> free_lists_[kClassNum];
+};
+
+class ThreadCachedAllocator::ThreadCache {
+ public:
+  explicit ThreadCache(std::shared_ptr<CentralCache> central_cache)
+      : central_cache_(std::move(central_cache)) {}
+
+  ~ThreadCache() {
+    for (int i = 0; i < kClassNum; ++i) {
+      central_cache_->Return(i, &lists_[i], lists_[i].size());
+    }
+  }
+
+  Allocation *Allocate(int size_class) {
+    auto &list = lists_[size_class];
+    if (list.empty()) {
+      central_cache_->Fetch(size_class, BatchSize(size_class), &list);
+    }
+    auto *allocation = list.back();
+    list.pop_back();
+    return allocation;
+  }
+
+  void Free(int size_class, Allocation *allocation) {
+    auto &list = lists_[size_class];
+    list.push_back(allocation);
+    size_t batch_size = BatchSize(size_class);
+    if (list.size() > 2 * batch_size) {
+      central_cache_->Return(size_class, &list, batch_size);
+    }
+  }
+
+ private:
+  std::shared_ptr<CentralCache> central_cache_;
+  std::vector<Allocation *> lists_[kClassNum];
+};
+
+namespace {
+
+// These thread locals are trivially destructible, so they can still be read
+// while the thread exits, e.g. by allocations freed in the destructors of
+// other thread locals.
+thread_local bool thread_caches_destroyed = false;
+thread_local uint64_t last_allocator_id = 0;
+thread_local void *last_thread_cache = nullptr;
+
+template <typename ThreadCache>
+struct ThreadCacheMap {
+  ~ThreadCacheMap() {
+    thread_caches_destroyed = true;
+    last_allocator_id = 0;
+    last_thread_cache = nullptr;
+  }
+
+  std::unordered_map<uint64_t, std::unique_ptr<ThreadCache>> caches;
+};
+
+}  // namespace
+
+ThreadCachedAllocator::ThreadCachedAllocator(
+    const std::shared_ptr<Allocator> &underlying_allocator)
+    : central_cache_(std::make_shared<CentralCache>(underlying_allocator)),
+      underlying_allocator_(underlying_allocator) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of ThreadCachedAllocator must not be null"));
+  PADDLE_ENFORCE_EQ(underlying_allocator_->IsAllocThreadSafe(), true,
+                    platform::errors::InvalidArgument(
+                        "Underlying allocator of ThreadCachedAllocator must "
+                        "be thread safe"));
+  static std::atomic<uint64_t> next_id(1);
+  id_ = next_id++;
+}
+
+int ThreadCachedAllocator::SizeClass(size_t size) {
+  if (size <= kMinClassSize) {
+    return 0;
+  }
+  // log2 of size rounded up to the power of 2, minus log2(kMinClassSize)
+  return 64 - __builtin_clzll(static_cast<uint64_t>(size - 1)) - 6;
+}
+
+size_t ThreadCachedAllocator::BatchSize(int size_class) {
+  size_t num = kMaxCachedBytesPerClass / ClassSize(size_class) / 2;
+  return std::max<size_t>(1, std::min<size_t>(32, num));
+}
+
+ThreadCachedAllocator::ThreadCache *ThreadCachedAllocator::GetThreadCache() {
+  if (last_allocator_id == id_) {
+    return static_cast<ThreadCache *>(last_thread_cache);
+  }
+  if (thread_caches_destroyed) {
+    return nullptr;
+  }
+  thread_local ThreadCacheMap<ThreadCache> cache_map;
+  auto &cache = cache_map.caches[id_];
+  if (cache == nullptr) {
+    cache.reset(new ThreadCache(central_cache_));
+  }
+  last_allocator_id = id_;
+  last_thread_cache = cache.get();
+  return cache.get();
+}
+
+Allocation *ThreadCachedAllocator::AllocateImpl(size_t size) {
+  if (size > kMaxClassSize) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+  int size_class = SizeClass(size);
+  auto *thread_cache = GetThreadCache();
+  if (thread_cache == nullptr) {
+    return central_cache_->Allocate(size_class);
+  }
+  return thread_cache->Allocate(size_class);
+}
+
+void ThreadCachedAllocator::FreeImpl(Allocation *allocation) {
+  if (allocation->size() > kMaxClassSize) {
+    Allocator::FreeImpl(allocation);
+    return;
+  }
+  int size_class =
+      static_cast<ThreadCachedAllocation *>(allocation)->size_class();
+  auto *thread_cache = GetThreadCache();
+  if (thread_cache == nullptr) {
+    std::vector<Allocation *> list{allocation};
+    central_cache_->Return(size_class, &list, 1);
+    return;
+  }
+  thread_cache->Free(size_class, allocation);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,76 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * ThreadCachedAllocator caches small allocations in the thread which frees
+ * them, like tcmalloc. Sizes are rounded up to power of 2 size classes from
+ * kMinClassSize to kMaxClassSize, and each thread keeps at most
+ * kMaxCachedBytesPerClass bytes of free allocations per size class. The
+ * allocations move between the thread caches and a shared central cache in
+ * batches, so the lock of the central cache and the underlying allocator is
+ * not taken by every allocation. Larger allocations go to the underlying
+ * allocator directly.
+ */
+class ThreadCachedAllocator : public Allocator {
+ public:
+  static constexpr size_t kMinClassSize = 64;
+  static constexpr size_t kMaxClassSize = 64 << 10;
+  static constexpr size_t kMaxCachedBytesPerClass = 256 << 10;
+
+  explicit ThreadCachedAllocator(
+      const std::shared_ptr<Allocator> &underlying_allocator);
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // the size class of size, size must not be larger than kMaxClassSize
+  static int SizeClass(size_t size);
+
+  static size_t ClassSize(int size_class) {
+    return kMinClassSize << size_class;
+  }
+
+  // the number of allocations moved between the caches at a time
+  static size_t BatchSize(int size_class);
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  class CentralCache;
+  class ThreadCache;
+
+  ThreadCache *GetThreadCache();
+
+  std::shared_ptr<CentralCache> central_cache_;
+  std::shared_ptr<Allocator> underlying_allocator_;
+  // to find the thread caches of this allocator
+  uint64_t id_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,120 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class CountedCPUAllocator : public Allocator {
+ public:
+  bool IsAllocThreadSafe() const override { return true; }
+
+  int AllocatedCount() const { return allocated_count_; }
+  int LiveCount() const { return live_count_; }
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override {
+    ++allocated_count_;
+    ++live_count_;
+    return new Allocation(malloc(size), size, platform::CPUPlace());
+  }
+
+  void FreeImpl(Allocation *allocation) override {
+    --live_count_;
+    free(allocation->ptr());
+    delete allocation;
+  }
+
+ private:
+  std::atomic<int> allocated_count_{0};
+  std::atomic<int> live_count_{0};
+};
+
+TEST(ThreadCachedAllocator, SizeClass) {
+  ASSERT_EQ(ThreadCachedAllocator::SizeClass(1), 0);
+  ASSERT_EQ(ThreadCachedAllocator::SizeClass(64), 0);
+  ASSERT_EQ(ThreadCachedAllocator::SizeClass(65), 1);
+  ASSERT_EQ(ThreadCachedAllocator::SizeClass(128), 1);
+  ASSERT_EQ(ThreadCachedAllocator::SizeClass(64 << 10), 10);
+  for (size_t size = 1; size <= ThreadCachedAllocator::kMaxClassSize;
+       size += 97) {
+    int size_class = ThreadCachedAllocator::SizeClass(size);
+    ASSERT_GE(ThreadCachedAllocator::ClassSize(size_class), size);
+    if (size_class > 0) {
+      ASSERT_LT(ThreadCachedAllocator::ClassSize(size_class - 1), size);
+    }
+  }
+}
+
+TEST(ThreadCachedAllocator, ReuseInThread) {
+  auto counted_allocator = std::make_shared<CountedCPUAllocator>();
+  {
+    ThreadCachedAllocator allocator(counted_allocator);
+    auto allocation = allocator.Allocate(100);
+    ASSERT_EQ(allocation->size(), 128UL);
+    void *ptr = allocation->ptr();
+    memset(ptr, 0, allocation->size());
+    allocation.reset();
+    allocation = allocator.Allocate(120);
+    ASSERT_EQ(allocation->ptr(), ptr);
+    ASSERT_EQ(counted_allocator->AllocatedCount(), 1);
+
+    // large allocations are not cached
+    auto large_allocation = allocator.Allocate(1 << 20);
+    ASSERT_EQ(counted_allocator->AllocatedCount(), 2);
+    large_allocation.reset();
+    ASSERT_EQ(counted_allocator->LiveCount(), 1);
+  }
+}
+
+TEST(ThreadCachedAllocator, MultiThread) {
+  auto counted_allocator = std::make_shared<CountedCPUAllocator>();
+  auto allocator = std::make_shared<ThreadCachedAllocator>(counted_allocator);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([allocator, i] {
+      std::vector<AllocationPtr> allocations;
+      for (int round = 0; round < 100; ++round) {
+        for (size_t size = 8; size <= (16 << 10); size *= 2) {
+          auto allocation = allocator->Allocate(size + i);
+          memset(allocation->ptr(), i, size + i);
+          allocations.emplace_back(std::move(allocation));
+        }
+        if (round % 3 == 0) {
+          allocations.clear();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // the allocations are reused instead of allocated from the underlying
+  // allocator every time
+  ASSERT_LT(counted_allocator->AllocatedCount(), 8 * 100 * 12 / 4);
+  allocator.reset();
+  ASSERT_EQ(counted_allocator->LiveCount(), 0);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -164,6 +164,30 @@ void BuddyAllocator::Free(void* p) {
 }
 
 size_t BuddyAllocator::Used() { return total_used_; }
+
+size_t BuddyAllocator::Reserved() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_used_ + total_free_;
+}
+
+size_t BuddyAllocator::ChunkNum() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return chunk_num_;
+}
+
+size_t BuddyAllocator::FreeBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_free_;
+}
+
+size_t BuddyAllocator::LargestFreeBlock() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t largest = 0;
+  for (auto &block : pool_) {
+    largest = std::max(largest, std::get<1>(block));
+  }
+  return largest;
+}
 size_t BuddyAllocator::GetMinChunkSize() { return min_chunk_size_; }
 size_t BuddyAllocator::GetMaxChunkSize() { return max_chunk_size_; }
 
@@ -214,6 +238,7 @@ BuddyAllocator::PoolSet::iterator BuddyAllocator::RefillPool(
                                      allocate_bytes, nullptr, nullptr);
 
   total_free_ += allocate_bytes;
+  ++chunk_num_;
 
   // dump the block into pool
   return pool_.insert(IndexSizeAddress(index, allocate_bytes, p)).first;
@@ -41,6 +41,12 @@ class BuddyAllocator {
   void* Alloc(size_t unaligned_size);
   void Free(void* ptr);
   size_t Used();
+  // the bytes of the chunks allocated from system, and the number of them
+  size_t Reserved();
+  size_t ChunkNum();
+  // the free bytes in the chunks, and the largest free block of them
+  size_t FreeBytes();
+  size_t LargestFreeBlock();
   size_t GetMinChunkSize();
   size_t GetMaxChunkSize();
 
@@ -84,6 +90,8 @@ class BuddyAllocator {
 
   size_t realloc_size_ = 0;  // the size of re-allocated chunk
 
+  size_t chunk_num_ = 0;  // the number of chunks allocated from system
+
  private:
   /**
    * \brief A list of free allocation
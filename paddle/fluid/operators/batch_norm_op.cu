@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_layout.h"
 #include "paddle/fluid/operators/batch_norm_op.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/reduce_ops/cub_reduce.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
 #include "paddle/fluid/platform/float16.h"
 
@@ -339,6 +340,62 @@ static __global__ void KeBNBackwardScaleBias(
   }
 }
 
+template <typename T>
+struct BNScaleBiasGradPair {
+  HOSTDEVICE inline BNScaleBiasGradPair() {}
+  HOSTDEVICE inline BNScaleBiasGradPair(const T &ds, const T &db)
+      : ds_(ds), db_(db) {}
+
+  T ds_;
+  T db_;
+};
+
+template <typename T>
+struct BNScaleBiasGradPairSum {
+  __device__ __forceinline__ BNScaleBiasGradPair<T> operator()(
+      const BNScaleBiasGradPair<T> &p1,
+      const BNScaleBiasGradPair<T> &p2) const {
+    return BNScaleBiasGradPair<T>(p1.ds_ + p2.ds_, p1.db_ + p2.db_);
+  }
+};
+
+// Load the terms of dscale and dbias of the element (j, k) of NHWC data
+// viewed as [N * HxW, C].
+template <typename T>
+struct BNScaleBiasGradNHWCLoader {
+  using U = BatchNormParamType<T>;
+
+  __device__ __forceinline__ BNScaleBiasGradPair<U> operator()(int i, int j,
+                                                              int k) const {
+    const int index = j * C + k;
+    U dy_val = static_cast<U>(dy[index]);
+    return BNScaleBiasGradPair<U>(
+        dy_val * (static_cast<U>(x[index]) - mean[k]), dy_val);
+  }
+
+  const T *dy;
+  const T *x;
+  const U *mean;
+  int C;
+};
+
+template <typename T>
+struct BNScaleBiasGradStorer {
+  using U = BatchNormParamType<T>;
+
+  __device__ __forceinline__ void operator()(
+      int k, const BNScaleBiasGradPair<U> &val) const {
+    U inv_var_k = 1.0 / sqrt(variance[k] + epsilon);
+    dscale[k] = val.ds_ * inv_var_k;
+    dbias[k] = val.db_;
+  }
+
+  const U *variance;
+  double epsilon;
+  U *dscale;
+  U *dbias;
+};
+
 template <typename T, framework::DataLayout layout>
 static __global__ void KeBNBackwardData(const T *dy,
                                         const BatchNormParamType<T> *scale,
@@ -702,11 +759,15 @@ class BatchNormGradKernel<platform::CUDADeviceContext, T>
               running_var_data, epsilon, C, H * W, num, d_x->data<T>());
         }
         if (d_scale && d_bias) {
-          KeBNBackwardScaleBias<T, block, framework::DataLayout::kNHWC><<<
-              grid2, block, 0, dev_ctx.stream()>>>(
-              d_y->data<T>(), x->data<T>(), running_mean_data, running_var_data,
-              epsilon, N, C, H * W * D, d_scale->data<BatchNormParamType<T>>(),
-              d_bias->data<BatchNormParamType<T>>());
+          // Reduce over N * HxW by the threads along the contiguous channels.
+          using U = BatchNormParamType<T>;
+          ReduceHigherDim(
+              ctx.GetPlace(), dev_ctx.stream(), 1, N * H * W * D, C,
+              BNScaleBiasGradPair<U>(0, 0), BNScaleBiasGradPairSum<U>(),
+              BNScaleBiasGradNHWCLoader<T>{d_y->data<T>(), x->data<T>(),
+                                           running_mean_data, C},
+              BNScaleBiasGradStorer<T>{running_var_data, epsilon,
+                                       d_scale->data<U>(), d_bias->data<U>()});
         }
       }
     }
@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/benchmark/op_tester.h"
 #include <fstream>
+#include <iomanip>
+#include <map>
+#include <utility>
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_info.h"
@@ -31,6 +34,112 @@ namespace benchmark {
 DEFINE_string(op_config_list, "", "Path of op config file.");
 DEFINE_int32(specified_config_id, -1, "Test the specified op config.");
 
+static platform::Place GetPlace(int device_id) {
+  if (device_id >= 0) {
+    return platform::CUDAPlace(device_id);
+  }
+  return platform::CPUPlace();
+}
+
+static framework::LibraryType GetLibraryType(const std::string &backend) {
+  if (backend == "cudnn") {
+    return framework::LibraryType::kCUDNN;
+  } else if (backend == "mkldnn") {
+    return framework::LibraryType::kMKLDNN;
+  }
+  return framework::LibraryType::kPlain;
+}
+
+// Whether the op has a kernel of the backend on the place, and the attr to
+// choose it.
+static bool HasBackendKernel(const OpTesterConfig &config) {
+  if (config.backend.empty()) {
+    return true;
+  }
+  auto library_type = GetLibraryType(config.backend);
+  if (library_type != framework::LibraryType::kPlain) {
+    const auto &attr_name = "use_" + config.backend;
+    const auto &proto =
+        framework::OpInfoMap::Instance().Get(config.op_type).Proto();
+    bool has_attr = false;
+    for (int i = 0; i != proto.attrs_size(); ++i) {
+      has_attr = has_attr || proto.attrs(i).name() == attr_name;
+    }
+    if (!has_attr) {
+      return false;
+    }
+  }
+  auto &all_kernels = framework::OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(config.op_type);
+  if (it == all_kernels.end()) {
+    return false;
+  }
+  auto place = GetPlace(config.device_id);
+  for (auto &pair : it->second) {
+    if (pair.first.library_type_ == library_type &&
+        platform::places_are_same_class(pair.first.place_, place)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Runs all the cases of the sweep, and prints the latencies of the backends
+// of each case with the fastest one marked by "*".
+static void RunSweep(const OpTesterConfig &sweep) {
+  std::vector<std::pair<OpTesterConfig, double>> results;
+  for (auto &config : sweep.Expand()) {
+    if (!HasBackendKernel(config)) {
+      LOG(INFO) << "Skip the backend " << config.backend << " of op "
+                << config.op_type << ", which has no kernel on the place.";
+      continue;
+    }
+    OpTester tester;
+    tester.Init(config);
+    tester.Run();
+    results.emplace_back(config, tester.Runtime());
+  }
+
+  std::stringstream ss;
+  ss << "\n------------------------->  Sweep of " << sweep.op_type
+     << "  <-------------------------\n";
+  ss << std::setw(12) << std::left << "Backend" << std::setw(14)
+     << "Latency(ms)" << std::setw(10) << "Speedup"
+     << "Winner\n";
+  std::map<std::string, int> wins;
+  for (size_t begin = 0; begin < results.size();) {
+    auto case_str = results[begin].first.CaseString();
+    size_t end = begin;
+    size_t winner = begin;
+    while (end < results.size() &&
+           results[end].first.CaseString() == case_str) {
+      if (results[end].second < results[winner].second) {
+        winner = end;
+      }
+      ++end;
+    }
+    ss << case_str << "\n";
+    for (size_t i = begin; i < end; ++i) {
+      const auto &backend = results[i].first.backend;
+      double speedup = results[i].second > 0
+                           ? results[begin].second / results[i].second
+                           : 0.0;
+      ss << std::setw(12) << (backend.empty() ? "default" : backend)
+         << std::setw(14) << results[i].second << std::setw(10) << speedup
+         << (i == winner ? "*" : "") << "\n";
+    }
+    ++wins[results[winner].first.backend.empty()
+               ? "default"
+               : results[winner].first.backend];
+    begin = end;
+  }
+  ss << "Wins:";
+  for (auto &pair : wins) {
+    ss << " " << pair.first << " " << pair.second;
+  }
+  LOG(INFO) << ss.str();
+}
+
 void OpTester::Init(const std::string &filename) {
   Init(OpTesterConfig(filename));
 }
@@ -50,11 +159,7 @@ void OpTester::Init(const OpTesterConfig &config) {
     LOG(FATAL) << "Op \"" << config_.op_type << "\" is not registered.";
   }
 
-  if (config_.device_id >= 0) {
-    place_ = paddle::platform::CUDAPlace(config_.device_id);
-  } else {
-    place_ = paddle::platform::CPUPlace();
-  }
+  place_ = GetPlace(config_.device_id);
 
   framework::InitDevices(false);
   scope_.reset(new paddle::framework::Scope());
@@ -242,6 +347,16 @@ void OpTester::CreateOpDesc() {
         PADDLE_THROW("Unsupport attr type %d", type);
     }
   }
+
+  // Chooses the kernel of the backend by the attrs the ops choose it by.
+  if (!config_.backend.empty()) {
+    if (attr_types.count("use_cudnn")) {
+      op_desc_.SetAttr("use_cudnn", config_.backend == "cudnn");
+    }
+    if (attr_types.count("use_mkldnn")) {
+      op_desc_.SetAttr("use_mkldnn", config_.backend == "mkldnn");
+    }
+  }
 }
 
 framework::VarDesc *OpTester::Var(const std::string &name) {
@@ -491,13 +606,15 @@ TEST(op_tester, base) {
         op_configs.push_back(config);
       }
     }
-    if (FLAGS_specified_config_id >= 0 &&
-        FLAGS_specified_config_id < static_cast<int>(op_configs.size())) {
-      OpTester tester;
-      tester.Init(op_configs[FLAGS_specified_config_id]);
-      tester.Run();
-    } else {
-      for (size_t i = 0; i < op_configs.size(); ++i) {
+    for (size_t i = 0; i < op_configs.size(); ++i) {
+      if (FLAGS_specified_config_id >= 0 &&
+          FLAGS_specified_config_id < static_cast<int>(op_configs.size()) &&
+          FLAGS_specified_config_id != static_cast<int>(i)) {
+        continue;
+      }
+      if (op_configs[i].IsSweep()) {
+        RunSweep(op_configs[i]);
+      } else {
         OpTester tester;
         tester.Init(op_configs[i]);
         tester.Run();
@@ -517,6 +634,25 @@ TEST(op_tester, base) {
   }
 }
 
+TEST(op_tester, sweep) {
+  std::istringstream is(
+      "{ op_type elementwise_add\n"
+      "  input { name X; dims 64x64,128x128; }\n"
+      "  input { name Y; dims 64x1,128x1; }\n"
+      "  dtypes fp32,fp64\n"
+      "  backends plain,mkldnn\n"
+      "}");
+  OpTesterConfig config;
+  ASSERT_TRUE(config.Init(is));
+  ASSERT_TRUE(config.IsSweep());
+  auto configs = config.Expand();
+  ASSERT_EQ(configs.size(), 8UL);
+  ASSERT_EQ(configs[7].CaseString(), "X: 128x128 fp64, Y: 128x1 fp64");
+  ASSERT_EQ(configs[7].backend, "mkldnn");
+  ASSERT_FALSE(configs[7].IsSweep());
+  RunSweep(config);
+}
+
 }  // namespace benchmark
 }  // namespace operators
 }  // namespace paddle
@@ -36,6 +36,9 @@ class OpTester {
 
   void Run();
 
+  // The average latency in ms of the last Run.
+  double Runtime() const { return config_.runtime; }
+
   std::string DebugString();
 
  private:
@@ -39,6 +39,32 @@ static void EraseEndSep(std::string* str,
   }
 }
 
+static std::vector<std::string> Split(const std::string& str, char delim) {
+  std::vector<std::string> tokens;
+  std::string token;
+  std::istringstream token_stream(str);
+  while (std::getline(token_stream, token, delim)) {
+    if (!token.empty()) {
+      tokens.push_back(token);
+    }
+  }
+  return tokens;
+}
+
+static std::string NormalizeDType(const std::string& dtype_str) {
+  if (dtype_str == "int32" || dtype_str == "int") {
+    return "int32";
+  } else if (dtype_str == "int64" || dtype_str == "long") {
+    return "int64";
+  } else if (dtype_str == "fp32" || dtype_str == "float") {
+    return "fp32";
+  } else if (dtype_str == "fp64" || dtype_str == "double") {
+    return "fp64";
+  } else {
+    PADDLE_THROW("Unsupported dtype %s", dtype_str.c_str());
+  }
+}
+
 OpInputConfig::OpInputConfig(std::istream& is) {
   std::string sep;
   is >> sep;
@@ -69,17 +95,7 @@ void OpInputConfig::ParseDType(std::istream& is) {
   is >> dtype_str;
   EraseEndSep(&dtype_str);
 
-  if (dtype_str == "int32" || dtype_str == "int") {
-    dtype = "int32";
-  } else if (dtype_str == "int64" || dtype_str == "long") {
-    dtype = "int64";
-  } else if (dtype_str == "fp32" || dtype_str == "float") {
-    dtype = "fp32";
-  } else if (dtype_str == "fp64" || dtype_str == "double") {
-    dtype = "fp64";
-  } else {
-    PADDLE_THROW("Unsupported dtype %s", dtype_str.c_str());
-  }
+  dtype = NormalizeDType(dtype_str);
   VLOG(4) << "dtype of input " << name << " is: " << dtype;
 }
 
@@ -101,13 +117,20 @@ void OpInputConfig::ParseInitializer(std::istream& is) {
 void OpInputConfig::ParseDims(std::istream& is) {
   std::string dims_str;
   is >> dims_str;
+  EraseEndSep(&dims_str);
 
-  dims.clear();
-  std::string token;
-  std::istringstream token_stream(dims_str);
-  while (std::getline(token_stream, token, 'x')) {
-    dims.push_back(std::stoi(token));
+  sweep_dims.clear();
+  for (auto& shape_str : Split(dims_str, ',')) {
+    std::vector<int64_t> shape;
+    for (auto& token : Split(shape_str, 'x')) {
+      shape.push_back(std::stoi(token));
+    }
+    sweep_dims.push_back(shape);
   }
+  PADDLE_ENFORCE_GT(sweep_dims.size(), 0,
+                    platform::errors::InvalidArgument(
+                        "The dims of input %s is empty.", name));
+  dims = sweep_dims[0];
 }
 
 void OpInputConfig::ParseLoD(std::istream& is) {
@@ -180,6 +203,31 @@ bool OpTesterConfig::Init(std::istream& is) {
         inputs.push_back(input_config);
       } else if (sep == "attrs" || sep == "attrs:") {
         ParseAttrs(is);
+      } else if (sep == "dtypes" || sep == "dtypes:") {
+        std::string dtypes_str;
+        is >> dtypes_str;
+        EraseEndSep(&dtypes_str);
+        dtypes.clear();
+        for (auto& dtype : Split(dtypes_str, ',')) {
+          dtypes.push_back(NormalizeDType(dtype));
+        }
+      } else if (sep == "backends" || sep == "backends:") {
+        std::string backends_str;
+        is >> backends_str;
+        EraseEndSep(&backends_str);
+        backends = Split(backends_str, ',');
+        if (Has(backends, "all")) {
+          backends = {"plain", "cudnn", "mkldnn"};
+        }
+        const std::vector<std::string> supported_backends = {"plain", "cudnn",
+                                                             "mkldnn"};
+        for (auto& item : backends) {
+          PADDLE_ENFORCE_EQ(Has(supported_backends, item), true,
+                            platform::errors::InvalidArgument(
+                                "Unsupported backend %s, which should be "
+                                "plain, cudnn or mkldnn.",
+                                item));
+        }
       } else {
         if (sep != kEndSeparator) {
           return false;
@@ -224,6 +272,80 @@ const OpInputConfig* OpTesterConfig::GetInput(const std::string& name) {
   return nullptr;
 }
 
+bool OpTesterConfig::IsSweep() const {
+  if (!dtypes.empty() || !backends.empty()) {
+    return true;
+  }
+  for (auto& input : inputs) {
+    if (input.sweep_dims.size() > 1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<OpTesterConfig> OpTesterConfig::Expand() const {
+  size_t num_shapes = 1;
+  for (auto& input : inputs) {
+    if (input.sweep_dims.size() > 1) {
+      PADDLE_ENFORCE_EQ(
+          num_shapes == 1 || num_shapes == input.sweep_dims.size(), true,
+          platform::errors::InvalidArgument(
+              "The inputs of op %s sweep different numbers of shapes, %d of "
+              "input %s vs %d.",
+              op_type, input.sweep_dims.size(), input.name, num_shapes));
+      num_shapes = input.sweep_dims.size();
+    }
+  }
+  std::vector<std::string> case_dtypes = dtypes;
+  if (case_dtypes.empty()) {
+    case_dtypes.push_back("");
+  }
+  std::vector<std::string> case_backends = backends;
+  if (case_backends.empty()) {
+    case_backends.push_back("");
+  }
+
+  std::vector<OpTesterConfig> configs;
+  for (size_t i = 0; i < num_shapes; ++i) {
+    for (auto& dtype : case_dtypes) {
+      for (auto& case_backend : case_backends) {
+        OpTesterConfig config(*this);
+        config.dtypes.clear();
+        config.backends.clear();
+        config.backend = case_backend;
+        for (auto& input : config.inputs) {
+          if (input.sweep_dims.size() > 1) {
+            input.dims = input.sweep_dims[i];
+          }
+          input.sweep_dims = {input.dims};
+          bool is_float = input.dtype == "fp32" || input.dtype == "fp64";
+          if (!dtype.empty() && is_float) {
+            input.dtype = dtype;
+          }
+        }
+        configs.push_back(config);
+      }
+    }
+  }
+  return configs;
+}
+
+std::string OpTesterConfig::CaseString() const {
+  std::stringstream ss;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (i > 0) {
+      ss << ", ";
+    }
+    ss << inputs[i].name << ": ";
+    for (size_t j = 0; j < inputs[i].dims.size(); ++j) {
+      ss << (j > 0 ? "x" : "") << inputs[i].dims[j];
+    }
+    ss << " " << inputs[i].dtype;
+  }
+  return ss.str();
+}
+
 }  // namespace benchmark
 }  // namespace operators
 }  // namespace paddle
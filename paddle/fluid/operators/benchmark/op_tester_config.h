@@ -38,6 +38,9 @@ struct OpInputConfig {
   std::string initializer{"random"};  // random, natural, zeros, file
   std::string filename{""};
   std::vector<int64_t> dims;
+  // The shapes to sweep, e.g. "dims: 64x64,128x128", of which dims is the
+  // first one.
+  std::vector<std::vector<int64_t>> sweep_dims;
   std::vector<std::vector<size_t>> lod;
 };
 
@@ -51,9 +54,26 @@ struct OpTesterConfig {
 
   const OpInputConfig* GetInput(const std::string& name);
 
+  bool IsSweep() const;
+
+  // Expands the sweep into the configs of the cases. The i-th case of the
+  // shapes takes the i-th shape of each input, or the only one if an input
+  // has only one, and each case of the shapes is run with each of the
+  // dtypes and the backends.
+  std::vector<OpTesterConfig> Expand() const;
+
+  // The shapes and the dtypes of the inputs, e.g. "X: 64x64 fp32".
+  std::string CaseString() const;
+
   std::string op_type;
   std::vector<OpInputConfig> inputs;
   std::unordered_map<std::string, std::string> attrs;
+  // The dtypes swept for the floating-point inputs, e.g. "dtypes: fp32,fp64".
+  std::vector<std::string> dtypes;
+  // The kernels compared, in plain, cudnn and mkldnn, or all of them by
+  // "backends: all". The ones not registered for the op are skipped.
+  std::vector<std::string> backends;
+  std::string backend{""};  // The backend of an expanded config.
   int device_id{-1};  // CPU: -1
   int repeat{1};
   int profile{0};
@@ -0,0 +1,138 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/block_sparse_conv2d_op.h"
+#include <vector>
+
+namespace paddle {
+namespace operators {
+
+class BlockSparseConv2DOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->HasInput("Input"), true,
+                      platform::errors::NotFound(
+                          "Input(Input) of block_sparse_conv2d should not be "
+                          "null."));
+    PADDLE_ENFORCE_EQ(ctx->HasOutput("Output"), true,
+                      platform::errors::NotFound(
+                          "Output(Output) of block_sparse_conv2d should not "
+                          "be null."));
+
+    auto weight_shape = ctx->Attrs().Get<std::vector<int>>("weight_shape");
+    PADDLE_ENFORCE_EQ(weight_shape.size(), 2UL,
+                      platform::errors::InvalidArgument(
+                          "The weight_shape of block_sparse_conv2d should be "
+                          "[output_channels, input_channels], but received "
+                          "size %d.",
+                          weight_shape.size()));
+    CheckBlockSparseWeight(ctx, "block_sparse_conv2d", weight_shape[0],
+                           weight_shape[1]);
+
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      PADDLE_ENFORCE_EQ(
+          framework::product(bias_dims), weight_shape[0],
+          platform::errors::InvalidArgument(
+              "The shape of Bias of block_sparse_conv2d should be [%d], but "
+              "received [%s].",
+              weight_shape[0], bias_dims));
+    }
+
+    auto in_dims = ctx->GetInputDim("Input");
+    PADDLE_ENFORCE_EQ(in_dims.size(), 4,
+                      platform::errors::InvalidArgument(
+                          "Input(Input) of block_sparse_conv2d should be a "
+                          "4-D tensor of NCHW, but received rank %d.",
+                          in_dims.size()));
+    if (ctx->IsRuntime() || in_dims[1] > 0) {
+      PADDLE_ENFORCE_EQ(
+          in_dims[1], weight_shape[1],
+          platform::errors::InvalidArgument(
+              "The input channels %d of block_sparse_conv2d do not match the "
+              "filter channels %d.",
+              in_dims[1], weight_shape[1]));
+    }
+    ctx->SetOutputDim("Output", framework::make_ddim({in_dims[0],
+                                                      weight_shape[0],
+                                                      in_dims[2], in_dims[3]}));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "Input"),
+        ctx.GetPlace());
+  }
+};
+
+class BlockSparseConv2DOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input",
+             "(Tensor) The input tensor of convolution operator, with shape "
+             "[N, C_in, H, W].");
+    AddInput("Values",
+             "(Tensor), The nonzero blocks of the filter, with shape "
+             "[nnz_blocks, block_height, block_width].");
+    AddInput("Offsets",
+             "(Tensor<int>), The offsets of the first nonzero block of each "
+             "block row in Values, with shape [C_out / block_height + 1].");
+    AddInput("Columns",
+             "(Tensor<int>), The block column of each nonzero block, with "
+             "shape [nnz_blocks].");
+    AddInput("Bias",
+             "(Tensor, optional) Bias to be added to each output channel, "
+             "with shape [C_out].")
+        .AsDispensable();
+    AddOutput("Output",
+              "(Tensor) The output tensor of convolution operator, with "
+              "shape [N, C_out, H, W].");
+    AddAttr<std::vector<int>>(
+        "weight_shape",
+        "(vector<int>) The shape [C_out, C_in] of the dense 1x1 filter.");
+    AddAttr<std::vector<int>>(
+        "block_shape",
+        "(vector<int>) The shape [block_height, block_width] of the blocks "
+        "of the filter.");
+    AddComment(R"DOC(
+Block Sparse Convolution Operator.
+
+It computes the 1x1 convolution of NCHW with stride 1, no padding and a
+single group, whose filter of [C_out, C_in] has most of the blocks zero.
+The filter is stored in the block compressed sparse row (BSR) format by
+Values, Offsets and Columns, and each image of [C_in, H * W] is multiplied
+by it without the zero blocks. It is created by block_sparse_weight_pass.
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(
+    block_sparse_conv2d, ops::BlockSparseConv2DOp,
+    ops::BlockSparseConv2DOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(
+    block_sparse_conv2d,
+    ops::BlockSparseConv2DOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::BlockSparseConv2DOpKernel<paddle::platform::CPUDeviceContext,
+                                   double>);
@@ -0,0 +1,56 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/operators/block_sparse_fc_op.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename DeviceContext, typename T>
+class BlockSparseConv2DOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const paddle::framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* output = ctx.Output<Tensor>("Output");
+    auto weight_shape = ctx.Attr<std::vector<int>>("weight_shape");
+
+    auto in_dims = input->dims();
+    output->Resize(
+        framework::make_ddim({in_dims[0], weight_shape[0], in_dims[2],
+                              in_dims[3]}));
+    const T* input_data = input->data<T>();
+    T* output_data = output->mutable_data<T>(ctx.GetPlace());
+
+    // The filter of [C_out, C_in, 1, 1] is the sparse matrix of
+    // [C_out, C_in], and each image of [C_in, H * W] is multiplied.
+    auto weight =
+        GetBlockSparseWeight<T>(ctx, weight_shape[0], weight_shape[1]);
+    const int spatial_size = static_cast<int>(in_dims[2] * in_dims[3]);
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    math::BlockSparseFunctor<DeviceContext, T> sparse;
+    for (int64_t i = 0; i < in_dims[0]; ++i) {
+      sparse.MatMul(dev_ctx, weight, spatial_size,
+                    input_data + i * weight_shape[1] * spatial_size,
+                    output_data + i * weight_shape[0] * spatial_size,
+                    bias ? bias->data<T>() : nullptr);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
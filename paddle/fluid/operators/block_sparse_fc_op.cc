@@ -0,0 +1,163 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/block_sparse_fc_op.h"
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+
+class BlockSparseFCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->HasInput("Input"), true,
+                      platform::errors::NotFound(
+                          "Input(Input) of block_sparse_fc should not be "
+                          "null."));
+    PADDLE_ENFORCE_EQ(ctx->HasOutput("Out"), true,
+                      platform::errors::NotFound(
+                          "Output(Out) of block_sparse_fc should not be "
+                          "null."));
+
+    auto weight_shape = ctx->Attrs().Get<std::vector<int>>("weight_shape");
+    PADDLE_ENFORCE_EQ(weight_shape.size(), 2UL,
+                      platform::errors::InvalidArgument(
+                          "The weight_shape of block_sparse_fc should be "
+                          "[in_features, out_features], but received size "
+                          "%d.",
+                          weight_shape.size()));
+    // The sparse matrix is the transposed weight of [out_features,
+    // in_features].
+    CheckBlockSparseWeight(ctx, "block_sparse_fc", weight_shape[1],
+                           weight_shape[0]);
+
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      PADDLE_ENFORCE_EQ(
+          framework::product(bias_dims), weight_shape[1],
+          platform::errors::InvalidArgument(
+              "The shape of Bias of block_sparse_fc should be [%d], but "
+              "received [%s].",
+              weight_shape[1], bias_dims));
+    }
+    auto& activation_type = ctx->Attrs().Get<std::string>("activation_type");
+    PADDLE_ENFORCE_EQ(activation_type.empty() || activation_type == "relu",
+                      true,
+                      platform::errors::Unimplemented(
+                          "Activation %s is not supported in block_sparse_fc "
+                          "now.",
+                          activation_type));
+
+    auto in_dims = ctx->GetInputDim("Input");
+    int in_num_col_dims = ctx->Attrs().Get<int>("in_num_col_dims");
+    PADDLE_ENFORCE_GT(
+        in_dims.size(), in_num_col_dims,
+        platform::errors::InvalidArgument(
+            "The rank of Input of block_sparse_fc should be larger than "
+            "in_num_col_dims %d, but received %d.",
+            in_num_col_dims, in_dims.size()));
+    auto in_mat_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    if (ctx->IsRuntime() || in_mat_dims[1] > 0) {
+      PADDLE_ENFORCE_EQ(
+          in_mat_dims[1], weight_shape[0],
+          platform::errors::InvalidArgument(
+              "The input width %d of block_sparse_fc does not match the "
+              "weight height %d.",
+              in_mat_dims[1], weight_shape[0]));
+    }
+
+    std::vector<int64_t> output_dims;
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      output_dims.push_back(in_dims[i]);
+    }
+    output_dims.push_back(weight_shape[1]);
+    ctx->SetOutputDim("Out", framework::make_ddim(output_dims));
+    ctx->ShareLoD("Input", "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "Input"),
+        ctx.GetPlace());
+  }
+};
+
+class BlockSparseFCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input",
+             "(Tensor), The input tensor of fully connected operator.");
+    AddInput("Values",
+             "(Tensor), The nonzero blocks of the transposed weight, with "
+             "shape [nnz_blocks, block_height, block_width].");
+    AddInput("Offsets",
+             "(Tensor<int>), The offsets of the first nonzero block of each "
+             "block row in Values, with shape "
+             "[out_features / block_height + 1].");
+    AddInput("Columns",
+             "(Tensor<int>), The block column of each nonzero block, with "
+             "shape [nnz_blocks].");
+    AddInput("Bias",
+             "(Tensor, optional) Bias vector with shape [out_features].")
+        .AsDispensable();
+    AddOutput("Out",
+              "(Tensor) The output tensor of fully connected operator. ");
+    AddAttr<int>("in_num_col_dims",
+                 "(int, default 1), The fc op can take tensors with more than "
+                 "two dimensions as its inputs.")
+        .SetDefault(1)
+        .EqualGreaterThan(1);
+    AddAttr<std::string>("activation_type",
+                         "Activation type used in fully connected operator.")
+        .SetDefault("");
+    AddAttr<std::vector<int>>(
+        "weight_shape",
+        "(vector<int>) The shape [in_features, out_features] of the dense "
+        "weight.");
+    AddAttr<std::vector<int>>(
+        "block_shape",
+        "(vector<int>) The shape [block_height, block_width] of the blocks "
+        "of the transposed weight.");
+    AddComment(R"DOC(
+Block Sparse Fully Connected Operator.
+
+It computes the fc of the weight W of [in_features, out_features], most of
+whose blocks are zero. The transposed weight W^T is stored in the block
+compressed sparse row (BSR) format by Values, Offsets and Columns, and
+
+    Out = Act(Input * W + Bias)
+
+skips the zero blocks. It is created by block_sparse_weight_pass.
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(
+    block_sparse_fc, ops::BlockSparseFCOp, ops::BlockSparseFCOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(
+    block_sparse_fc,
+    ops::BlockSparseFCOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::BlockSparseFCOpKernel<paddle::platform::CPUDeviceContext, double>);
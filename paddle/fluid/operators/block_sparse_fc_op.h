@@ -0,0 +1,134 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/block_sparse.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// Checks the weight of [rows, cols] in the BSR format, which is given by
+// Input(Values), Input(Offsets) and Input(Columns).
+inline void CheckBlockSparseWeight(framework::InferShapeContext* ctx,
+                                   const std::string& op_type, int64_t rows,
+                                   int64_t cols) {
+  for (auto name : {"Values", "Offsets", "Columns"}) {
+    PADDLE_ENFORCE_EQ(ctx->HasInput(name), true,
+                      platform::errors::NotFound(
+                          "Input(%s) of %s should not be null.", name,
+                          op_type));
+  }
+  auto block_shape = ctx->Attrs().Get<std::vector<int>>("block_shape");
+  PADDLE_ENFORCE_EQ(block_shape.size(), 2UL,
+                    platform::errors::InvalidArgument(
+                        "The block_shape of %s should be [block_height, "
+                        "block_width], but received size %d.",
+                        op_type, block_shape.size()));
+  PADDLE_ENFORCE_EQ(
+      block_shape[0] > 0 && block_shape[1] > 0 &&
+          rows % block_shape[0] == 0 && cols % block_shape[1] == 0,
+      true, platform::errors::InvalidArgument(
+                "The weight of [%d, %d] cannot be tiled into the blocks of "
+                "[%d, %d] in %s.",
+                rows, cols, block_shape[0], block_shape[1], op_type));
+
+  auto values_dims = ctx->GetInputDim("Values");
+  auto offsets_dims = ctx->GetInputDim("Offsets");
+  auto columns_dims = ctx->GetInputDim("Columns");
+  PADDLE_ENFORCE_EQ(
+      values_dims.size(), 3,
+      platform::errors::InvalidArgument(
+          "Input(Values) of %s should be [nnz_blocks, block_height, "
+          "block_width], but received rank %d.",
+          op_type, values_dims.size()));
+  PADDLE_ENFORCE_EQ(
+      values_dims[1] == block_shape[0] && values_dims[2] == block_shape[1],
+      true, platform::errors::InvalidArgument(
+                "The blocks of Input(Values) of %s should be [%d, %d], but "
+                "received [%d, %d].",
+                op_type, block_shape[0], block_shape[1], values_dims[1],
+                values_dims[2]));
+  PADDLE_ENFORCE_EQ(offsets_dims.size(), 1,
+                    platform::errors::InvalidArgument(
+                        "Input(Offsets) of %s should be 1-D.", op_type));
+  PADDLE_ENFORCE_EQ(
+      offsets_dims[0], rows / block_shape[0] + 1,
+      platform::errors::InvalidArgument(
+          "Input(Offsets) of %s should have %d elements, but received %d.",
+          op_type, rows / block_shape[0] + 1, offsets_dims[0]));
+  PADDLE_ENFORCE_EQ(
+      columns_dims.size() == 1 && columns_dims[0] == values_dims[0], true,
+      platform::errors::InvalidArgument(
+          "Input(Columns) of %s should have one element for each block of "
+          "Input(Values), but received shape [%s].",
+          op_type, columns_dims));
+}
+
+template <typename T>
+math::BlockSparseMatrix<T> GetBlockSparseWeight(
+    const framework::ExecutionContext& ctx, int rows, int cols) {
+  auto block_shape = ctx.Attr<std::vector<int>>("block_shape");
+  math::BlockSparseMatrix<T> weight;
+  weight.rows = rows;
+  weight.cols = cols;
+  weight.block_height = block_shape[0];
+  weight.block_width = block_shape[1];
+  weight.values = ctx.Input<Tensor>("Values")->data<T>();
+  weight.offsets = ctx.Input<Tensor>("Offsets")->data<int>();
+  weight.columns = ctx.Input<Tensor>("Columns")->data<int>();
+  return weight;
+}
+
+template <typename DeviceContext, typename T>
+class BlockSparseFCOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const paddle::framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<framework::LoDTensor>("Input");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* output = ctx.Output<framework::LoDTensor>("Out");
+    int in_num_col_dims = ctx.Attr<int>("in_num_col_dims");
+    bool with_relu = ctx.Attr<std::string>("activation_type") == "relu";
+    auto weight_shape = ctx.Attr<std::vector<int>>("weight_shape");
+
+    auto in_mat_dims =
+        framework::flatten_to_2d(input->dims(), in_num_col_dims);
+    std::vector<int64_t> output_dims;
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      output_dims.push_back(input->dims()[i]);
+    }
+    output_dims.push_back(weight_shape[1]);
+    output->Resize(framework::make_ddim(output_dims));
+    output->set_lod(input->lod());
+
+    // The weight of fc [K, N] is stored transposed, so that each output
+    // feature is a row of the sparse matrix.
+    auto weight =
+        GetBlockSparseWeight<T>(ctx, weight_shape[1], weight_shape[0]);
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    math::BlockSparseFunctor<DeviceContext, T> sparse;
+    sparse.MatMulTransposed(dev_ctx, static_cast<int>(in_mat_dims[0]),
+                            input->data<T>(), weight,
+                            output->mutable_data<T>(ctx.GetPlace()),
+                            bias ? bias->data<T>() : nullptr, with_relu);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/controlflow/conditional_block_op.h"
+#include "paddle/fluid/platform/profiler.h"
+
+DECLARE_bool(use_mkldnn);
 
 namespace paddle {
 namespace operators {
@@ -53,14 +56,18 @@ class ConditionalBlockInferOp : public ConditionalOp {
       auto *scope_var = scope.FindVar(Output("Scope"));
       PADDLE_ENFORCE(scope_var != nullptr, "Must set scope");
       auto *scopes = scope_var->GetMutable<std::vector<framework::Scope *>>();
-      scopes->resize(1);
-      scopes->front() = &scope.NewScope();
-      auto &cur_scope = *scopes->front();
+      auto &cur_scope = PrepareSubScope(scope, dev_place, scopes);
 
       framework::Executor exec(dev_place);
       auto *block = Attr<framework::BlockDesc *>("sub_block");
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false);
-      scope.DeleteScope(scopes->front());
+      platform::RecordBlock b(block->ID());
+      if (FLAGS_use_mkldnn) exec.EnableMKLDNN(*block->Program());
+      auto ctx = ctx_pool_.Acquire(*block->Program(), block->ID());
+      exec.RunPreparedContext(ctx.get(), &cur_scope, false);
+      if (!framework::StepScopePool::IsEnabled()) {
+        scope.DeleteScope(scopes->front());
+        scopes->clear();
+      }
     }
   }
 };
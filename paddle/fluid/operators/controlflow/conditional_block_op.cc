@@ -16,6 +16,9 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/assign_op.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/profiler.h"
+
+DECLARE_bool(use_mkldnn);
 
 namespace paddle {
 namespace operators {
@@ -58,18 +61,18 @@ class ConditionalBlockOp : public ConditionalOp {
       auto *scope_var = scope.FindVar(Output(ConditionalOp::kScope));
       PADDLE_ENFORCE(scope_var != nullptr, "Must set scope");
       auto *scopes = scope_var->GetMutable<std::vector<framework::Scope *>>();
-      scopes->resize(1);
-      scopes->front() = &scope.NewScope();
-      auto &cur_scope = *scopes->front();
+      auto &cur_scope = PrepareSubScope(scope, dev_place, scopes);
       framework::Executor exec(dev_place);
       auto *block = Attr<framework::BlockDesc *>("sub_block");
       VLOG(3) << "Conditional block.idx = " << block->ID()
               << ", scope = " << &cur_scope;
       auto &skip_vars =
           Attr<std::vector<std::string>>(ConditionalOp::kSkipEagerDeletionVars);
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false, true,
-               skip_vars, /* force_disable_gc */ false,
-               /* keep_kid_scopes */ true);
+      platform::RecordBlock b(block->ID());
+      if (FLAGS_use_mkldnn) exec.EnableMKLDNN(*block->Program());
+      auto ctx = ctx_pool_.Acquire(*block->Program(), block->ID(), skip_vars);
+      exec.RunPreparedContext(ctx.get(), &cur_scope, false, true,
+                              /* keep_kids */ true);
     }
   }
 };
@@ -130,9 +133,12 @@ class ConditionalBlockGradOp : public ConditionalOp {
 
       VLOG(3) << "Conditional Grad block.idx = " << block->ID()
               << ", scope = " << &cur_scope;
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false, true,
-               inside_grads, /* force_disable_gc */ false,
-               /* keep_kid_scopes */ false);
+      platform::RecordBlock b(block->ID());
+      if (FLAGS_use_mkldnn) exec.EnableMKLDNN(*block->Program());
+      auto ctx =
+          ctx_pool_.Acquire(*block->Program(), block->ID(), inside_grads);
+      exec.RunPreparedContext(ctx.get(), &cur_scope, false, true,
+                              /* keep_kids */ false);
 
       AssignLocalGradientToParentScope(dev_place, cur_scope, scope,
                                        inside_grads, outside_grads);
@@ -20,6 +20,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope_pool.h"
 #include "paddle/fluid/framework/var_type.h"
 
 namespace paddle {
@@ -79,6 +80,28 @@ class ConditionalOp : public framework::OperatorBase {
     }
     return res;
   }
+
+  // The scope to run the sub-block in. It is the scope kept in scopes by the
+  // last run, reset, if FLAGS_reuse_step_scopes is set, or a new kid scope.
+  framework::Scope &PrepareSubScope(
+      const framework::Scope &scope, const platform::Place &place,
+      std::vector<framework::Scope *> *scopes) const {
+    if (framework::StepScopePool::IsEnabled()) {
+      if (!scopes->empty()) {
+        // the tensors of the last run may be still used on the device
+        platform::DeviceContextPool::Instance().Get(place)->Wait();
+      }
+      framework::StepScopePool pool(scope, scopes);
+      scopes->push_back(&pool.NewScope());
+    } else {
+      scopes->resize(1);
+      scopes->front() = &scope.NewScope();
+    }
+    return *scopes->front();
+  }
+
+  // the prepared contexts of the sub-block, reused across the runs
+  mutable framework::ExecutorPrepareContextPool ctx_pool_;
 };
 
 class ConditionalBlockOpProtoMaker : public framework::OpProtoAndCheckerMaker {
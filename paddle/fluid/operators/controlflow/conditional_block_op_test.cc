@@ -24,6 +24,9 @@ limitations under the License. */
 
 USE_NO_KERNEL_OP(conditional_block);
 USE_NO_KERNEL_OP(conditional_block_grad);
+USE_OP(elementwise_add);
+
+DECLARE_bool(reuse_step_scopes);
 
 using LoDTensor = paddle::framework::LoDTensor;
 using LoDTensorArray = paddle::framework::LoDTensorArray;
@@ -78,3 +81,64 @@ TEST(ConditionalBlockGrad, NoNeedRunLoDTensorArray) {
     }
   }
 }
+
+TEST(ConditionalBlock, ReuseSubScopeAndContext) {
+  FLAGS_reuse_step_scopes = true;
+  Place place = paddle::platform::CPUPlace();
+  Scope scope;
+
+  paddle::framework::ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto& name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(
+        paddle::framework::proto::VarType::LOD_TENSOR);
+  }
+  auto* sub_block = program.AppendBlock(*main_block);
+  auto* add = sub_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  bool* cond_data = scope.Var("condition")->GetMutable<LoDTensor>()
+                        ->mutable_data<bool>({1}, place);
+  cond_data[0] = true;
+  float* a_data =
+      scope.Var("a")->GetMutable<LoDTensor>()->mutable_data<float>({4}, place);
+  float* b_data =
+      scope.Var("b")->GetMutable<LoDTensor>()->mutable_data<float>({4}, place);
+  for (int i = 0; i < 4; ++i) {
+    b_data[i] = static_cast<float>(i);
+  }
+  scope.Var("c")->GetMutable<LoDTensor>();
+  auto* scopes = scope.Var("sub_scope")->GetMutable<std::vector<Scope*>>();
+
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"sub_block", sub_block});
+  attrs.insert({"is_scalar_condition", true});
+  // the vars of the parent scope are not collected by the sub-block
+  attrs.insert({"skip_eager_deletion_vars",
+                std::vector<std::string>({"a", "b", "c"})});
+  auto conditional_op = paddle::framework::OpRegistry::CreateOp(
+      "conditional_block", {{"Cond", {"condition"}}, {"Input", {"a", "b"}}},
+      {{"Out", {"c"}}, {"Scope", {"sub_scope"}}}, attrs);
+
+  Scope* first_scope = nullptr;
+  for (int run = 0; run < 3; ++run) {
+    for (int i = 0; i < 4; ++i) {
+      a_data[i] = static_cast<float>(run);
+    }
+    conditional_op->Run(scope, place);
+    ASSERT_EQ(scopes->size(), 1UL);
+    if (run == 0) {
+      first_scope = scopes->front();
+    } else {
+      EXPECT_EQ(scopes->front(), first_scope);
+    }
+    const float* c_data = scope.FindVar("c")->Get<LoDTensor>().data<float>();
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(c_data[i], static_cast<float>(run + i));
+    }
+  }
+  FLAGS_reuse_step_scopes = false;
+}
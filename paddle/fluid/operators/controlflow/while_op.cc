@@ -17,6 +17,7 @@
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope_pool.h"
 #include "paddle/fluid/framework/var_type.h"
 #include "paddle/fluid/operators/controlflow/while_op_helper.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
@@ -65,13 +66,8 @@ class WhileOp : public framework::OperatorBase {
 
     if (step_scopes->size() > 0) {
       platform::DeviceContextPool::Instance().Get(dev_place)->Wait();
-      for (auto &s : *step_scopes) {
-        if (scope.HasKid(s)) {
-          scope.DeleteScope(s);
-        }
-      }
-      step_scopes->clear();
     }
+    framework::StepScopePool step_scope_pool(scope, step_scopes);
 
     PADDLE_ENFORCE_EQ(step_scopes->size(), 0, "The StepScope should be empty.");
 
@@ -80,10 +76,10 @@ class WhileOp : public framework::OperatorBase {
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
 
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto ctx = ctx_pool_.Acquire(*program, block->ID(), skip_vars);
     if (!is_test) {
       while (cond_data) {
-        auto &current_scope = scope.NewScope();
+        auto &current_scope = step_scope_pool.NewScope();
         step_scopes->push_back(&current_scope);
         executor.RunPreparedContext(ctx.get(), &current_scope, false, true,
                                     true);
@@ -91,7 +87,7 @@ class WhileOp : public framework::OperatorBase {
             GetCondData(scope.FindVar(Input(kCondition))->Get<LoDTensor>());
       }
     } else {
-      auto &current_scope = scope.NewScope();
+      auto &current_scope = step_scope_pool.NewScope();
       executor.CreateVariables(*program, &current_scope, block->ID());
       while (cond_data) {
         for (auto &name : current_scope.LocalVarNames()) {
@@ -112,9 +108,18 @@ class WhileOp : public framework::OperatorBase {
         cond_data =
             GetCondData(scope.FindVar(Input(kCondition))->Get<LoDTensor>());
       }
-      scope.DeleteScope(&current_scope);
+      if (framework::StepScopePool::IsEnabled()) {
+        // kept for the next run
+        step_scopes->push_back(&current_scope);
+      } else {
+        scope.DeleteScope(&current_scope);
+      }
     }
   }
+
+ private:
+  // the prepared contexts of the step block, reused across the runs
+  mutable framework::ExecutorPrepareContextPool ctx_pool_;
 };
 
 class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -172,7 +177,7 @@ class WhileGradOp : public framework::OperatorBase {
 
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto ctx = ctx_pool_.Acquire(*program, block->ID(), skip_vars);
 
     auto *step_scopes =
         scope.FindVar(Input(kStepScopes))->GetMutable<StepScopeVar>();
@@ -317,10 +322,21 @@ class WhileGradOp : public framework::OperatorBase {
         cur_scope.Rename(new_inside_name, inside_grad_name);
       }
       dev_ctx.Wait();
-      const_cast<framework::Scope &>(scope).DeleteScope(&cur_scope);
+      if (framework::StepScopePool::IsEnabled()) {
+        // release the memory, and keep the scope for the next forward run
+        framework::StepScopePool::ResetStepScope(&cur_scope);
+      } else {
+        const_cast<framework::Scope &>(scope).DeleteScope(&cur_scope);
+      }
+    }
+    if (!framework::StepScopePool::IsEnabled()) {
+      step_scopes->clear();
     }
-    step_scopes->clear();
   }
+
+ private:
+  // the prepared contexts of the step block, reused across the runs
+  mutable framework::ExecutorPrepareContextPool ctx_pool_;
 };
 
 template <typename T>
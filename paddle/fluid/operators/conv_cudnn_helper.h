@@ -17,10 +17,13 @@ limitations under the License. */
 #include <algorithm>
 #include <array>
 #include <memory>
+#include <sstream>
+#include <string>
 #include <vector>
 #include "paddle/fluid/framework/operator_kernel_configs.h"
 #include "paddle/fluid/operators/conv_cudnn_op_cache.h"
 #include "paddle/fluid/platform/cudnn_desc.h"
+#include "paddle/fluid/platform/gpu_info.h"
 namespace paddle {
 namespace operators {
 
@@ -111,6 +114,44 @@ struct ConvArgs {
       : x(x), w(w), o(o), s(s), p(p), d(d) {}
 };
 
+// The key of the algorithm of args in ConvAlgorithmsFile, which is made of
+// the descriptors of the input and the filter with their data types and
+// layouts, the conv params, the workspace limit, the GPU model and the cuDNN
+// version, since the best algorithm depends on all of them.
+static std::string ConvAlgorithmsFileKey(const char* kind,
+                                         const ConvArgs& args,
+                                         size_t workspace_size_limit) {
+  constexpr int kMaxDims = 8;
+  cudnnDataType_t dtype;
+  cudnnTensorFormat_t format;
+  int nb_dims;
+  int dims[kMaxDims];
+  int strides[kMaxDims];
+  std::ostringstream key;
+  PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnGetTensorNdDescriptor(
+      args.idesc.desc(), kMaxDims, &dtype, &nb_dims, dims, strides));
+  key << kind << ";x:" << dtype;
+  for (int i = 0; i < nb_dims; ++i) {
+    key << "," << dims[i] << "/" << strides[i];
+  }
+  PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cudnnGetFilterNdDescriptor(
+      args.wdesc.desc(), kMaxDims, &dtype, &format, &nb_dims, dims));
+  key << ";w:" << dtype << "/" << format;
+  for (int i = 0; i < nb_dims; ++i) {
+    key << "," << dims[i];
+  }
+  key << ";s:" << args.s << ";p:" << args.p << ";d:" << args.d
+      << ";ws:" << workspace_size_limit;
+
+  cudaDeviceProp prop;
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaGetDeviceProperties(&prop, platform::GetCurrentDeviceId()));
+  std::string gpu(prop.name);
+  std::replace(gpu.begin(), gpu.end(), ' ', '_');
+  key << ";gpu:" << gpu << ";cudnn:" << platform::dynload::cudnnGetVersion();
+  return key.str();
+}
+
 template <typename perf_t>
 struct SearchAlgorithm {};
 
@@ -199,6 +240,18 @@ struct SearchAlgorithm<cudnnConvolutionFwdAlgoPerf_t> {
 
       algo = algo_cache.GetAlgorithm(
           x_dims, w_dims, args.s, args.p, args.d, 0, [&]() {
+            auto& algos_file = ConvAlgorithmsFile::Instance();
+            std::string file_key;
+            if (algos_file.Enabled()) {
+              file_key = ConvAlgorithmsFileKey("fwd", args,
+                                               workspace_size_limit);
+              int file_algo;
+              if (algos_file.Get(file_key, &file_algo)) {
+                VLOG(3) << "load algo " << file_algo << " of " << file_key;
+                return static_cast<algo_t>(file_algo);
+              }
+            }
+
             int returned_algo_count;
             std::array<perf_t, kNUM_CUDNN_FWD_ALGS> perf_stat;
 
@@ -220,6 +273,9 @@ struct SearchAlgorithm<cudnnConvolutionFwdAlgoPerf_t> {
               VLOG(3) << stat.algo << ": " << stat.status << " " << stat.time
                       << " " << stat.memory;
             }
+            if (algos_file.Enabled()) {
+              algos_file.Set(file_key, static_cast<int>(perf_stat[0].algo));
+            }
             return perf_stat[0].algo;
           });
     }
@@ -337,6 +393,18 @@ struct SearchAlgorithm<cudnnConvolutionBwdDataAlgoPerf_t> {
 
       algo = algo_cache.GetAlgorithm(
           x_dims, w_dims, args.s, args.p, args.d, 0, [&]() {
+            auto& algos_file = ConvAlgorithmsFile::Instance();
+            std::string file_key;
+            if (algos_file.Enabled()) {
+              file_key = ConvAlgorithmsFileKey("bwd_data", args,
+                                               workspace_size_limit);
+              int file_algo;
+              if (algos_file.Get(file_key, &file_algo)) {
+                VLOG(3) << "load algo " << file_algo << " of " << file_key;
+                return static_cast<algo_t>(file_algo);
+              }
+            }
+
             int returned_algo_count;
             std::array<perf_t, kNUM_CUDNN_FWD_ALGS> perf_stat;
 
@@ -361,6 +429,9 @@ struct SearchAlgorithm<cudnnConvolutionBwdDataAlgoPerf_t> {
                       << " " << stat.memory;
             }
 
+            if (algos_file.Enabled()) {
+              algos_file.Set(file_key, static_cast<int>(perf_stat[0].algo));
+            }
             return perf_stat[0].algo;
           });
     }
@@ -465,6 +536,18 @@ struct SearchAlgorithm<cudnnConvolutionBwdFilterAlgoPerf_t> {
 
       algo = algo_cache.GetAlgorithm(
           x_dims, w_dims, args.s, args.p, args.d, 0, [&]() {
+            auto& algos_file = ConvAlgorithmsFile::Instance();
+            std::string file_key;
+            if (algos_file.Enabled()) {
+              file_key = ConvAlgorithmsFileKey("bwd_filter", args,
+                                               workspace_size_limit);
+              int file_algo;
+              if (algos_file.Get(file_key, &file_algo)) {
+                VLOG(3) << "load algo " << file_algo << " of " << file_key;
+                return static_cast<algo_t>(file_algo);
+              }
+            }
+
             int returned_algo_count;
             std::array<perf_t, kNUM_CUDNN_FWD_ALGS> perf_stat;
             auto cudnn_find_func = [&](void* cudnn_workspace_ptr) {
@@ -487,6 +570,9 @@ struct SearchAlgorithm<cudnnConvolutionBwdFilterAlgoPerf_t> {
               VLOG(3) << stat.algo << ": " << stat.status << " " << stat.time
                       << " " << stat.memory;
             }
+            if (algos_file.Enabled()) {
+              algos_file.Set(file_key, static_cast<int>(perf_stat[0].algo));
+            }
             return perf_stat[0].algo;
           });
     }
@@ -14,7 +14,10 @@ limitations under the License. */
 
 #pragma once
 
+#include <fstream>
 #include <functional>
+#include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/operator.h"
@@ -23,6 +26,7 @@ limitations under the License. */
 DECLARE_uint64(conv_workspace_size_limit);
 DECLARE_bool(cudnn_exhaustive_search);
 DECLARE_int64(cudnn_exhaustive_search_times);
+DECLARE_string(cudnn_algo_cache_file);
 
 namespace paddle {
 namespace operators {
@@ -40,5 +44,54 @@ static constexpr size_t kNUM_CUDNN_BWD_FILTER_ALGS = 4;
 static constexpr size_t kNUM_CUDNN_BWD_DATA_ALGS = 5;
 #endif
 
+// The algorithms found by the exhaustive search of all the processes, which
+// are loaded from FLAGS_cudnn_algo_cache_file once and appended to it, so
+// that the search of a convolution is not run again by the next processes.
+class ConvAlgorithmsFile {
+ public:
+  static ConvAlgorithmsFile& Instance() {
+    static ConvAlgorithmsFile file;
+    return file;
+  }
+
+  bool Enabled() const { return !path_.empty(); }
+
+  bool Get(const std::string& key, int* algo) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = algos_.find(key);
+    if (it == algos_.end()) return false;
+    *algo = it->second;
+    return true;
+  }
+
+  void Set(const std::string& key, int algo) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!algos_.emplace(key, algo).second || path_.empty()) return;
+    std::ofstream fout(path_, std::ios::app);
+    if (!fout) {
+      LOG(WARNING) << "can not save the cudnn conv algorithms to " << path_;
+      return;
+    }
+    fout << key << " " << algo << "\n";
+  }
+
+ private:
+  ConvAlgorithmsFile() : path_(FLAGS_cudnn_algo_cache_file) {
+    if (path_.empty()) return;
+    std::ifstream fin(path_);
+    std::string key;
+    int algo;
+    while (fin >> key >> algo) {
+      algos_[key] = algo;
+    }
+    VLOG(3) << "load " << algos_.size() << " cudnn conv algorithms from "
+            << path_;
+  }
+
+  std::string path_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, int> algos_;
+};
+
 }  // namespace operators
 }  // namespace paddle
@@ -783,7 +783,8 @@ namespace ops = paddle::operators;
 REGISTER_OPERATOR(conv2d, ops::ConvOp, ops::Conv2DOpMaker,
                   ops::ConvOpInferVarType,
                   ops::Conv2DGradMaker<paddle::framework::OpDesc>,
-                  ops::Conv2DGradMaker<paddle::imperative::OpBase>);
+                  ops::Conv2DGradMaker<paddle::imperative::OpBase>,
+                  ops::ConvOpCostEstimator);
 REGISTER_OPERATOR(conv2d_grad, ops::ConvOpGrad,
                   ops::Conv2DDoubleGradMaker<paddle::framework::OpDesc>,
                   ops::Conv2DDoubleGradMaker<paddle::imperative::OpBase>);
@@ -793,13 +794,15 @@ REGISTER_OPERATOR(conv2d_grad_grad, ops::ConvOpDoubleGrad);
 REGISTER_OPERATOR(depthwise_conv2d, ops::ConvOp, ops::Conv2DOpMaker,
                   ops::ConvOpInferVarType,
                   ops::Conv2DGradMaker<paddle::framework::OpDesc>,
-                  ops::Conv2DGradMaker<paddle::imperative::OpBase>);
+                  ops::Conv2DGradMaker<paddle::imperative::OpBase>,
+                  ops::ConvOpCostEstimator);
 REGISTER_OPERATOR(depthwise_conv2d_grad, ops::ConvOpGrad);
 
 REGISTER_OPERATOR(conv3d, ops::ConvOp, ops::Conv3DOpMaker,
                   ops::ConvOpInferVarType,
                   ops::Conv3DGradMaker<paddle::framework::OpDesc>,
-                  ops::Conv3DGradMaker<paddle::imperative::OpBase>);
+                  ops::Conv3DGradMaker<paddle::imperative::OpBase>,
+                  ops::ConvOpCostEstimator);
 REGISTER_OPERATOR(conv3d_grad, ops::ConvOpGrad,
                   ops::Conv3DDoubleGradMaker<paddle::framework::OpDesc>,
                   ops::Conv3DDoubleGradMaker<paddle::imperative::OpBase>);
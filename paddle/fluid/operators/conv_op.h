@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/cpu_conv.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/vol2col.h"
@@ -250,6 +251,20 @@ class ConvOpInferVarType : public framework::PassInDtypeAndVarTypeToOutput {
   }
 };
 
+class ConvOpCostEstimator : public framework::OpCostEstimator {
+ public:
+  framework::OpCost operator()(
+      const framework::ExecutionContext& ctx) const override {
+    // Each element of Output is a dot product of a filter of an output
+    // channel, whose length is C / groups * prod(ksize).
+    auto* filter = ctx.Input<Tensor>("Filter");
+    int64_t filter_size = filter->numel() / filter->dims()[0];
+    framework::OpCost cost;
+    cost.flops = 2.0 * ctx.Output<Tensor>("Output")->numel() * filter_size;
+    return cost;
+  }
+};
+
 class ConvOp : public framework::OperatorWithKernel {
  public:
   using framework::OperatorWithKernel::OperatorWithKernel;
@@ -357,6 +372,25 @@ class GemmConvKernel : public framework::OpKernel<T> {
     // o_d,o_h, o_w}
     size_t data_dim = filter_shape_vec.size() - 2;
 
+    // the 2-D convolution on CPU may be computed without im2col, by Winograd
+    // or directly for depthwise, which is selected by the shapes
+    if (platform::is_cpu_place(context.GetPlace()) && data_dim == 2U) {
+      auto algo = math::SelectCPUConvAlgo(framework::vectorize(trans_in_dims),
+                                          filter_shape_vec, groups, strides,
+                                          paddings, dilations);
+      if (algo != math::CPUConvAlgo::kIm2ColGemm) {
+        math::CPUConvFunctor<T> conv;
+        conv(context.template device_context<platform::CPUDeviceContext>(),
+             algo, transformed_input, filter, strides, paddings, dilations,
+             &transformed_output);
+        if (channel_last) {
+          TransToChannelLast<DeviceContext, T>(context, &transformed_output,
+                                               output);
+        }
+        return;
+      }
+    }
+
     std::vector<int64_t> col_shape_vec(1 + 2 * data_dim);
     col_shape_vec[0] = trans_in_dims[1] / groups;
     for (size_t j = 0; j < data_dim; ++j) {
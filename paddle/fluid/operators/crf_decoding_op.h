@@ -14,10 +14,12 @@ limitations under the License. */
 
 #pragma once
 #include <limits>
+#include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/sequence_parallel.h"
 
 namespace paddle {
 namespace operators {
@@ -39,6 +41,13 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
     math::SetConstant<DeviceContext, int64_t>()(
         ctx.template device_context<DeviceContext>(), decoded_path, 0);
 
+    // The kernel is got once, since the cache of the jit kernels is not
+    // thread safe.
+    const int64_t tag_num = transition_weights->dims()[1];
+    auto decode = jit::KernelFuncs<jit::CRFDecodingTuple<T>,
+                                   platform::CPUPlace>::Cache()
+                      .At(tag_num);
+
     bool has_length = ctx.HasInput("Length");
     if (has_length) {
       auto* length = ctx.Input<Tensor>("Length");
@@ -50,14 +59,25 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
       emission_weights_tmp.Resize({in_dims[0] * in_dims[1], in_dims[2]});
 
       decoded_path->Resize({in_dims[0] * in_dims[1], 1});
+      // the accumulated lengths, by which the sequences are balanced
+      std::vector<size_t> offsets(seq_num + 1, 0);
       for (size_t i = 0; i < seq_num; ++i) {
-        if (length_data[i] == 0) continue;
-        int64_t start_pos = i * in_dims[1];
-        int64_t end_pos = start_pos + static_cast<int64_t>(length_data[i]);
-        Tensor decoded_path_one_seq = decoded_path->Slice(start_pos, end_pos);
-        Decode(emission_weights_tmp.Slice(start_pos, end_pos),
-               *transition_weights, &decoded_path_one_seq);
+        offsets[i + 1] = offsets[i] + static_cast<size_t>(length_data[i]);
       }
+      math::ParallelForSequences(
+          offsets.data(), seq_num, tag_num * tag_num,
+          [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+              if (length_data[i] == 0) continue;
+              int64_t start_pos = i * in_dims[1];
+              int64_t end_pos =
+                  start_pos + static_cast<int64_t>(length_data[i]);
+              Tensor decoded_path_one_seq =
+                  decoded_path->Slice(start_pos, end_pos);
+              Decode(emission_weights_tmp.Slice(start_pos, end_pos),
+                     *transition_weights, decode, &decoded_path_one_seq);
+            }
+          });
       decoded_path->Resize({in_dims[0], in_dims[1]});
 
       if (label) {
@@ -82,14 +102,19 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
       const size_t level = 0;
       const size_t seq_num = lod[level].size() - 1;
 
-      for (size_t i = 0; i < seq_num; ++i) {
-        if (lod[level][i] == lod[level][i + 1]) continue;
-        int64_t start_pos = static_cast<int64_t>(lod[level][i]);
-        int64_t end_pos = static_cast<int64_t>(lod[level][i + 1]);
-        Tensor decoded_path_one_seq = decoded_path->Slice(start_pos, end_pos);
-        Decode(emission_weights->Slice(start_pos, end_pos), *transition_weights,
-               &decoded_path_one_seq);
-      }
+      math::ParallelForSequences(
+          lod[level].data(), seq_num, tag_num * tag_num,
+          [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+              if (lod[level][i] == lod[level][i + 1]) continue;
+              int64_t start_pos = static_cast<int64_t>(lod[level][i]);
+              int64_t end_pos = static_cast<int64_t>(lod[level][i + 1]);
+              Tensor decoded_path_one_seq =
+                  decoded_path->Slice(start_pos, end_pos);
+              Decode(emission_weights->Slice(start_pos, end_pos),
+                     *transition_weights, decode, &decoded_path_one_seq);
+            }
+          });
       if (label) {
         PADDLE_ENFORCE_EQ(label->NumLevels(), 1UL,
                           "The Input(Label) should be a sequence.");
@@ -104,6 +129,7 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
 
  private:
   void Decode(const Tensor& emission_weights, const Tensor& transition_weights,
+              typename jit::CRFDecodingTuple<T>::func_type ker,
               Tensor* decoded_path) const {
     auto emission_dims = emission_weights.dims();
     const size_t seq_len = emission_dims[0];
@@ -120,9 +146,6 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
     Tensor track;
     int* track_value =
         track.mutable_data<int>(emission_dims, platform::CPUPlace());
-    auto ker =
-        jit::KernelFuncs<jit::CRFDecodingTuple<T>, platform::CPUPlace>::Cache()
-            .At(tag_num);
     ker(static_cast<int>(seq_len), x, w, alpha_value, track_value, tag_num);
     T max_score = -std::numeric_limits<T>::max();
     int max_i = 0;
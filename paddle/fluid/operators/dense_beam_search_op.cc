@@ -0,0 +1,145 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/dense_beam_search_op.h"
+
+namespace paddle {
+namespace operators {
+
+class DenseBeamSearchOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    for (const std::string& arg :
+         std::vector<std::string>({"PreIds", "PreScores", "Scores"})) {
+      PADDLE_ENFORCE_EQ(
+          ctx->HasInput(arg), true,
+          platform::errors::NotFound(
+              "Input(%s) of DenseBeamSearchOp is not found.", arg));
+    }
+    for (const std::string& arg : std::vector<std::string>(
+             {"SelectedIds", "SelectedScores", "ParentIdx"})) {
+      PADDLE_ENFORCE_EQ(
+          ctx->HasOutput(arg), true,
+          platform::errors::NotFound(
+              "Output(%s) of DenseBeamSearchOp is not found.", arg));
+    }
+
+    auto pre_ids_dims = ctx->GetInputDim("PreIds");
+    auto scores_dims = ctx->GetInputDim("Scores");
+    PADDLE_ENFORCE_EQ(pre_ids_dims.size(), 2,
+                      platform::errors::InvalidArgument(
+                          "Input(PreIds) should be a 2-D tensor of shape "
+                          "[batch_size, beam_size], but received %d-D.",
+                          pre_ids_dims.size()));
+    PADDLE_ENFORCE_EQ(
+        scores_dims.size() == 2 || scores_dims.size() == 3, true,
+        platform::errors::InvalidArgument(
+            "Input(Scores) should be a tensor of shape [batch_size, "
+            "beam_size, K] or [batch_size * beam_size, K], but received "
+            "%d-D.",
+            scores_dims.size()));
+    if (ctx->IsRuntime()) {
+      PADDLE_ENFORCE_EQ(ctx->GetInputDim("PreScores"), pre_ids_dims,
+                        platform::errors::InvalidArgument(
+                            "Input(PreScores) should have the same shape as "
+                            "Input(PreIds)."));
+      PADDLE_ENFORCE_EQ(
+          framework::product(scores_dims) % framework::product(pre_ids_dims),
+          0, platform::errors::InvalidArgument(
+                 "Input(Scores) should hold K candidates for every beam."));
+      if (ctx->HasInput("Ids")) {
+        PADDLE_ENFORCE_EQ(ctx->GetInputDim("Ids"), scores_dims,
+                          platform::errors::InvalidArgument(
+                              "Input(Ids) should have the same shape as "
+                              "Input(Scores)."));
+      }
+    }
+    ctx->SetOutputDim("SelectedIds", pre_ids_dims);
+    ctx->SetOutputDim("SelectedScores", pre_ids_dims);
+    ctx->SetOutputDim("ParentIdx", pre_ids_dims);
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "Scores"),
+        ctx.device_context());
+  }
+};
+
+class DenseBeamSearchOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("PreIds",
+             "(Tensor) The ids selected at the previous step, of shape "
+             "[batch_size, beam_size] and data type int64.");
+    AddInput("PreScores",
+             "(Tensor) The accumulated scores of Input(PreIds), of shape "
+             "[batch_size, beam_size].");
+    AddInput("Ids",
+             "(Tensor) The ids of the K candidates of every beam, of shape "
+             "[batch_size, beam_size, K] or [batch_size * beam_size, K], "
+             "e.g. from top_k. If not set, the candidates are the indices "
+             "in Input(Scores).")
+        .AsDispensable();
+    AddInput("Scores",
+             "(Tensor) The scores of the K candidates of every beam, of shape "
+             "[batch_size, beam_size, K] or [batch_size * beam_size, K].");
+    AddOutput("SelectedIds",
+              "(Tensor) The ids selected at this step, of shape "
+              "[batch_size, beam_size].");
+    AddOutput("SelectedScores",
+              "(Tensor) The accumulated scores of Output(SelectedIds).");
+    AddOutput("ParentIdx",
+              "(Tensor) The beams in the batch which Output(SelectedIds) "
+              "extend, of shape [batch_size, beam_size] and data type int64, "
+              "which feeds the Parents of gather_tree.");
+    AddAttr<int>("end_id",
+                 "The token id which indicates the end of a sequence.");
+    AddAttr<bool>("is_accumulated",
+                  "Whether Input(Scores) are accumulated scores. If false, "
+                  "they are the probabilities of this step, whose log is "
+                  "added to Input(PreScores).")
+        .SetDefault(true);
+    AddComment(R"DOC(
+DenseBeamSearch Operator.
+
+Does the beam search of one time step on fixed-shape tensors of
+[batch_size, beam_size], without LoD. Every batch keeps beam_size beams: the
+top beam_size candidates of all its beams are selected, and the finished beams,
+whose last id is end_id, are only extended with end_id and keep their scores.
+Since the shapes never change, all the states of the decoding loop stay on the
+device, and the sequences of all the steps are backtraced by gather_tree with
+Output(ParentIdx).
+
+At the first step, set the scores of all but the first beam of every batch to
+-inf, so that the beams are not selected several times.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(
+    dense_beam_search, ops::DenseBeamSearchOp, ops::DenseBeamSearchOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(dense_beam_search, ops::DenseBeamSearchOpKernel<float>,
+                       ops::DenseBeamSearchOpKernel<double>);
@@ -0,0 +1,127 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <cub/cub.cuh>
+#include <limits>
+#include "paddle/fluid/operators/dense_beam_search_op.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+struct DenseBeamCandidate {
+  T score;
+  int index;
+};
+
+template <typename T>
+struct BetterBeamCandidate {
+  __device__ DenseBeamCandidate<T> operator()(
+      const DenseBeamCandidate<T>& a, const DenseBeamCandidate<T>& b) const {
+    return IsBetterBeamCandidate(a.score, a.index, b.score, b.index) ? a : b;
+  }
+};
+
+// One block for every batch, which selects the beams one at a time: every
+// round takes the best candidate ranked after the one selected by the
+// previous round, so that no candidate list is kept.
+template <typename T, int BlockDim>
+__global__ void KeDenseBeamSearch(
+    const int64_t* pre_ids, const T* pre_scores, const int64_t* ids,
+    const T* scores, const int beam_size, const int width,
+    const int64_t end_id, const bool is_accumulated, int64_t* selected_ids,
+    T* selected_scores, int64_t* parent_idx) {
+  typedef cub::BlockReduce<DenseBeamCandidate<T>, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ DenseBeamCandidate<T> last;
+
+  int offset = blockIdx.x * beam_size;
+  int num_candidates = beam_size * width;
+  if (threadIdx.x == 0) {
+    last.score = std::numeric_limits<T>::infinity();
+    last.index = -1;
+  }
+  __syncthreads();
+
+  for (int k = 0; k < beam_size; k++) {
+    DenseBeamCandidate<T> prev = last;
+    DenseBeamCandidate<T> best;
+    best.score = -std::numeric_limits<T>::infinity();
+    best.index = num_candidates;
+    for (int c = threadIdx.x; c < num_candidates; c += BlockDim) {
+      int beam = c / width;
+      T score = DenseBeamCandidateScore(
+          pre_ids[offset + beam] == end_id, c - beam * width,
+          pre_scores[offset + beam], scores[offset * width + c],
+          is_accumulated);
+      if (IsBetterBeamCandidate(prev.score, prev.index, score, c) &&
+          IsBetterBeamCandidate(score, c, best.score, best.index)) {
+        best.score = score;
+        best.index = c;
+      }
+    }
+    DenseBeamCandidate<T> winner =
+        BlockReduce(temp_storage).Reduce(best, BetterBeamCandidate<T>());
+    if (threadIdx.x == 0) {
+      int beam = winner.index / width;
+      bool finished = pre_ids[offset + beam] == end_id;
+      selected_ids[offset + k] =
+          finished ? end_id
+                   : (ids ? ids[offset * width + winner.index]
+                          : winner.index - beam * width);
+      selected_scores[offset + k] = winner.score;
+      parent_idx[offset + k] = beam;
+      last = winner;
+    }
+    __syncthreads();
+  }
+}
+
+template <typename T>
+class DenseBeamSearchOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* pre_ids = ctx.Input<Tensor>("PreIds");
+    auto* pre_scores = ctx.Input<Tensor>("PreScores");
+    auto* ids = ctx.Input<Tensor>("Ids");
+    auto* scores = ctx.Input<Tensor>("Scores");
+    auto* selected_ids = ctx.Output<Tensor>("SelectedIds");
+    auto* selected_scores = ctx.Output<Tensor>("SelectedScores");
+    auto* parent_idx = ctx.Output<Tensor>("ParentIdx");
+    int64_t end_id = ctx.Attr<int>("end_id");
+    bool is_accumulated = ctx.Attr<bool>("is_accumulated");
+
+    int batch_size = pre_ids->dims()[0];
+    int beam_size = pre_ids->dims()[1];
+    int width = scores->numel() / (batch_size * beam_size);
+
+    constexpr int kBlockDim = 256;
+    auto stream = ctx.cuda_device_context().stream();
+    KeDenseBeamSearch<T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
+        pre_ids->data<int64_t>(), pre_scores->data<T>(),
+        ids ? ids->data<int64_t>() : nullptr, scores->data<T>(), beam_size,
+        width, end_id, is_accumulated,
+        selected_ids->mutable_data<int64_t>(ctx.GetPlace()),
+        selected_scores->mutable_data<T>(ctx.GetPlace()),
+        parent_idx->mutable_data<int64_t>(ctx.GetPlace()));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(dense_beam_search,
+                        ops::DenseBeamSearchOpCUDAKernel<float>,
+                        ops::DenseBeamSearchOpCUDAKernel<double>);
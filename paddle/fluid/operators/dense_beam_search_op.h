@@ -0,0 +1,114 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// The accumulated score of the candidate in column col of a beam. A finished
+// beam, whose last id is end_id, only extends itself with end_id from column
+// 0 and keeps its score.
+template <typename T>
+HOSTDEVICE inline T DenseBeamCandidateScore(const bool finished,
+                                            const int64_t col,
+                                            const T pre_score, const T score,
+                                            const bool is_accumulated) {
+  if (finished) {
+    return col == 0 ? pre_score : -std::numeric_limits<T>::infinity();
+  }
+  return is_accumulated ? score : pre_score + static_cast<T>(log(score));
+}
+
+// The candidates are ranked by the score, and by the index among the
+// candidates of the batch for equal scores, so that every device selects the
+// same candidates.
+template <typename T>
+HOSTDEVICE inline bool IsBetterBeamCandidate(const T score, const int index,
+                                             const T other_score,
+                                             const int other_index) {
+  return score > other_score || (score == other_score && index < other_index);
+}
+
+template <typename T>
+class DenseBeamSearchOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* pre_ids = ctx.Input<Tensor>("PreIds");
+    auto* pre_scores = ctx.Input<Tensor>("PreScores");
+    auto* ids = ctx.Input<Tensor>("Ids");
+    auto* scores = ctx.Input<Tensor>("Scores");
+    auto* selected_ids = ctx.Output<Tensor>("SelectedIds");
+    auto* selected_scores = ctx.Output<Tensor>("SelectedScores");
+    auto* parent_idx = ctx.Output<Tensor>("ParentIdx");
+    int64_t end_id = ctx.Attr<int>("end_id");
+    bool is_accumulated = ctx.Attr<bool>("is_accumulated");
+
+    int batch_size = pre_ids->dims()[0];
+    int beam_size = pre_ids->dims()[1];
+    int width = scores->numel() / (batch_size * beam_size);
+
+    const int64_t* pre_ids_data = pre_ids->data<int64_t>();
+    const T* pre_scores_data = pre_scores->data<T>();
+    const int64_t* ids_data = ids ? ids->data<int64_t>() : nullptr;
+    const T* scores_data = scores->data<T>();
+    auto* selected_ids_data =
+        selected_ids->mutable_data<int64_t>(ctx.GetPlace());
+    auto* selected_scores_data =
+        selected_scores->mutable_data<T>(ctx.GetPlace());
+    auto* parent_idx_data = parent_idx->mutable_data<int64_t>(ctx.GetPlace());
+
+    int num_candidates = beam_size * width;
+    std::vector<T> candidate_scores(num_candidates);
+    std::vector<int> order(num_candidates);
+    for (int i = 0; i < batch_size; i++) {
+      int offset = i * beam_size;
+      for (int c = 0; c < num_candidates; c++) {
+        int beam = c / width;
+        candidate_scores[c] = DenseBeamCandidateScore(
+            pre_ids_data[offset + beam] == end_id, c % width,
+            pre_scores_data[offset + beam], scores_data[offset * width + c],
+            is_accumulated);
+      }
+      std::iota(order.begin(), order.end(), 0);
+      std::partial_sort(order.begin(), order.begin() + beam_size, order.end(),
+                        [&candidate_scores](int a, int b) {
+                          return IsBetterBeamCandidate(candidate_scores[a], a,
+                                                       candidate_scores[b], b);
+                        });
+      for (int k = 0; k < beam_size; k++) {
+        int c = order[k];
+        int beam = c / width;
+        bool finished = pre_ids_data[offset + beam] == end_id;
+        selected_ids_data[offset + k] =
+            finished ? end_id
+                     : (ids_data ? ids_data[offset * width + c] : c % width);
+        selected_scores_data[offset + k] = candidate_scores[c];
+        parent_idx_data[offset + k] = beam;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
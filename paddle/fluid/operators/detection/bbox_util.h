@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/operators/math.h"
 
 namespace paddle {
 namespace operators {
@@ -46,6 +47,37 @@ inline HOSTDEVICE T RoIArea(const T* box, bool normalized) {
   }
 }
 
+/*
+ * transform that computes the target bounding-box regression delta
+ * given one proposal box and its ground-truth box.
+ */
+template <typename T>
+inline HOSTDEVICE void BoxToDelta(const T* ex_box, const T* gt_box,
+                                  const float* weights, const bool normalized,
+                                  T* delta) {
+  const T ex_w = ex_box[2] - ex_box[0] + (normalized == false);
+  const T ex_h = ex_box[3] - ex_box[1] + (normalized == false);
+  const T ex_ctr_x = ex_box[0] + static_cast<T>(0.5) * ex_w;
+  const T ex_ctr_y = ex_box[1] + static_cast<T>(0.5) * ex_h;
+
+  const T gt_w = gt_box[2] - gt_box[0] + (normalized == false);
+  const T gt_h = gt_box[3] - gt_box[1] + (normalized == false);
+  const T gt_ctr_x = gt_box[0] + static_cast<T>(0.5) * gt_w;
+  const T gt_ctr_y = gt_box[1] + static_cast<T>(0.5) * gt_h;
+
+  delta[0] = (gt_ctr_x - ex_ctr_x) / ex_w;
+  delta[1] = (gt_ctr_y - ex_ctr_y) / ex_h;
+  delta[2] = real_log(gt_w / ex_w);
+  delta[3] = real_log(gt_h / ex_h);
+
+  if (weights) {
+    delta[0] = delta[0] / weights[0];
+    delta[1] = delta[1] / weights[1];
+    delta[2] = delta[2] / weights[2];
+    delta[3] = delta[3] / weights[3];
+  }
+}
+
 /*
  * transform that computes target bounding-box regression deltas
  * given proposal boxes and ground-truth boxes.
@@ -54,32 +86,12 @@ template <typename T>
 inline void BoxToDelta(const int box_num, const framework::Tensor& ex_boxes,
                        const framework::Tensor& gt_boxes, const float* weights,
                        const bool normalized, framework::Tensor* box_delta) {
-  auto ex_boxes_et = framework::EigenTensor<T, 2>::From(ex_boxes);
-  auto gt_boxes_et = framework::EigenTensor<T, 2>::From(gt_boxes);
-  auto trg = framework::EigenTensor<T, 2>::From(*box_delta);
-  T ex_w, ex_h, ex_ctr_x, ex_ctr_y, gt_w, gt_h, gt_ctr_x, gt_ctr_y;
+  const T* ex_boxes_data = ex_boxes.data<T>();
+  const T* gt_boxes_data = gt_boxes.data<T>();
+  T* box_delta_data = box_delta->data<T>();
   for (int64_t i = 0; i < box_num; ++i) {
-    ex_w = ex_boxes_et(i, 2) - ex_boxes_et(i, 0) + (normalized == false);
-    ex_h = ex_boxes_et(i, 3) - ex_boxes_et(i, 1) + (normalized == false);
-    ex_ctr_x = ex_boxes_et(i, 0) + 0.5 * ex_w;
-    ex_ctr_y = ex_boxes_et(i, 1) + 0.5 * ex_h;
-
-    gt_w = gt_boxes_et(i, 2) - gt_boxes_et(i, 0) + (normalized == false);
-    gt_h = gt_boxes_et(i, 3) - gt_boxes_et(i, 1) + (normalized == false);
-    gt_ctr_x = gt_boxes_et(i, 0) + 0.5 * gt_w;
-    gt_ctr_y = gt_boxes_et(i, 1) + 0.5 * gt_h;
-
-    trg(i, 0) = (gt_ctr_x - ex_ctr_x) / ex_w;
-    trg(i, 1) = (gt_ctr_y - ex_ctr_y) / ex_h;
-    trg(i, 2) = std::log(gt_w / ex_w);
-    trg(i, 3) = std::log(gt_h / ex_h);
-
-    if (weights) {
-      trg(i, 0) = trg(i, 0) / weights[0];
-      trg(i, 1) = trg(i, 1) / weights[1];
-      trg(i, 2) = trg(i, 2) / weights[2];
-      trg(i, 3) = trg(i, 3) / weights[3];
-    }
+    BoxToDelta<T>(ex_boxes_data + i * 4, gt_boxes_data + i * 4, weights,
+                  normalized, box_delta_data + i * 4);
   }
 }
 
@@ -93,34 +105,39 @@ void Gather(const T* in, const int in_stride, const int* index, const int num,
   }
 }
 
+// The overlap of two boxes of [xmin, ymin, xmax, ymax] in pixels.
+template <typename T>
+inline HOSTDEVICE T BoxOverlap(const T* r_box, const T* c_box) {
+  const T zero = static_cast<T>(0.0);
+  T r_box_area = (r_box[2] - r_box[0] + 1) * (r_box[3] - r_box[1] + 1);
+  T c_box_area = (c_box[2] - c_box[0] + 1) * (c_box[3] - c_box[1] + 1);
+  T x_min = r_box[0] > c_box[0] ? r_box[0] : c_box[0];
+  T y_min = r_box[1] > c_box[1] ? r_box[1] : c_box[1];
+  T x_max = r_box[2] < c_box[2] ? r_box[2] : c_box[2];
+  T y_max = r_box[3] < c_box[3] ? r_box[3] : c_box[3];
+  T inter_w = x_max - x_min + 1;
+  T inter_h = y_max - y_min + 1;
+  inter_w = inter_w > zero ? inter_w : zero;
+  inter_h = inter_h > zero ? inter_h : zero;
+  T inter_area = inter_w * inter_h;
+  return (inter_area == zero)
+             ? zero
+             : inter_area / (r_box_area + c_box_area - inter_area);
+}
+
 template <typename T>
 void BboxOverlaps(const framework::Tensor& r_boxes,
                   const framework::Tensor& c_boxes,
                   framework::Tensor* overlaps) {
-  auto r_boxes_et = framework::EigenTensor<T, 2>::From(r_boxes);
-  auto c_boxes_et = framework::EigenTensor<T, 2>::From(c_boxes);
-  auto overlaps_et = framework::EigenTensor<T, 2>::From(*overlaps);
+  const T* r_boxes_data = r_boxes.data<T>();
+  const T* c_boxes_data = c_boxes.data<T>();
+  T* overlaps_data = overlaps->data<T>();
   int r_num = r_boxes.dims()[0];
   int c_num = c_boxes.dims()[0];
-  auto zero = static_cast<T>(0.0);
-  T r_box_area, c_box_area, x_min, y_min, x_max, y_max, inter_w, inter_h,
-      inter_area;
   for (int i = 0; i < r_num; ++i) {
-    r_box_area = (r_boxes_et(i, 2) - r_boxes_et(i, 0) + 1) *
-                 (r_boxes_et(i, 3) - r_boxes_et(i, 1) + 1);
     for (int j = 0; j < c_num; ++j) {
-      c_box_area = (c_boxes_et(j, 2) - c_boxes_et(j, 0) + 1) *
-                   (c_boxes_et(j, 3) - c_boxes_et(j, 1) + 1);
-      x_min = std::max(r_boxes_et(i, 0), c_boxes_et(j, 0));
-      y_min = std::max(r_boxes_et(i, 1), c_boxes_et(j, 1));
-      x_max = std::min(r_boxes_et(i, 2), c_boxes_et(j, 2));
-      y_max = std::min(r_boxes_et(i, 3), c_boxes_et(j, 3));
-      inter_w = std::max(x_max - x_min + 1, zero);
-      inter_h = std::max(y_max - y_min + 1, zero);
-      inter_area = inter_w * inter_h;
-      overlaps_et(i, j) =
-          (inter_area == 0.) ? 0 : inter_area /
-                                       (r_box_area + c_box_area - inter_area);
+      overlaps_data[i * c_num + j] =
+          BoxOverlap<T>(r_boxes_data + i * 4, c_boxes_data + j * 4);
     }
   }
 }
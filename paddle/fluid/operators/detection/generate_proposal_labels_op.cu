@@ -0,0 +1,340 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/detection/bbox_util.h"
+#include "paddle/fluid/operators/detection/sample_util.cu.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+namespace {
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+constexpr int kBoxDim = 4;
+
+// The proposals are the gt boxes followed by the rois mapped to the original
+// image, or the rois of which the first gt_num ones are not mapped for the
+// cascade rcnn, the same as SampleRoisForOneImage on CPU.
+template <typename T>
+__global__ void ProposalBoxesKernel(const T* rpn_rois, const T* gt_boxes,
+                                    int gt_num, int proposals_num,
+                                    const T* im_info, bool is_cascade_rcnn,
+                                    T* boxes) {
+  const int gt_size = gt_num * kBoxDim;
+  CUDA_1D_KERNEL_LOOP(i, proposals_num * kBoxDim) {
+    if (is_cascade_rcnn) {
+      boxes[i] = i < gt_size ? rpn_rois[i] : rpn_rois[i] / im_info[2];
+    } else {
+      boxes[i] = i < gt_size ? gt_boxes[i] : rpn_rois[i - gt_size] / im_info[2];
+    }
+  }
+}
+
+// The same foreground and background candidates as SampleFgBgGt on CPU,
+// where the gt box of each foreground is the first one of its max overlap.
+template <typename T>
+__global__ void FgBgCandidateFlagsKernel(
+    const T* boxes, int proposals_num, const T* gt_boxes, int gt_num,
+    const int* is_crowd, T lowest, float fg_thresh, float bg_thresh_hi,
+    float bg_thresh_lo, bool is_cascade_rcnn, int* fg_flags, int* bg_flags,
+    int* mapped_gt_inds) {
+  const float epsilon = 0.00001;
+  CUDA_1D_KERNEL_LOOP(i, proposals_num) {
+    const T* box = boxes + i * kBoxDim;
+    T max_overlap = lowest;
+    for (int j = 0; j < gt_num; ++j) {
+      max_overlap = max(max_overlap, BoxOverlap<T>(box, gt_boxes + j * 4));
+    }
+    if (i < gt_num && is_crowd[i]) {
+      max_overlap = -1.0;
+    }
+    fg_flags[i] = 0;
+    bg_flags[i] = 0;
+    if (is_cascade_rcnn && ((box[2] - box[0] + 1) <= 0 ||
+                            (box[3] - box[1] + 1) <= 0)) {
+      continue;
+    }
+    if (max_overlap >= fg_thresh) {
+      for (int j = 0; j < gt_num; ++j) {
+        T diff = max_overlap - BoxOverlap<T>(box, gt_boxes + j * 4);
+        if ((diff < 0 ? -diff : diff) < epsilon) {
+          fg_flags[i] = 1;
+          mapped_gt_inds[i] = j;
+          break;
+        }
+      }
+    } else if (max_overlap >= bg_thresh_lo && max_overlap < bg_thresh_hi) {
+      bg_flags[i] = 1;
+    }
+  }
+}
+
+// Write the sampled rois of the foregrounds followed by the backgrounds,
+// whose targets and weights are zeros except the ones of the labels of the
+// foregrounds.
+template <typename T>
+__global__ void SampledRoisKernel(const T* boxes, const T* gt_boxes,
+                                  const int* gt_classes, const int* fg_inds,
+                                  int fg_num, const int* bg_inds, int rois_num,
+                                  const int* mapped_gt_inds, const T* im_info,
+                                  const float* bbox_reg_weights,
+                                  int class_nums, bool is_cls_agnostic,
+                                  T* rois, int* labels, T* bbox_targets,
+                                  T* bbox_inside_weights,
+                                  T* bbox_outside_weights) {
+  CUDA_1D_KERNEL_LOOP(i, rois_num) {
+    const int index = i < fg_num ? fg_inds[i] : bg_inds[i - fg_num];
+    const T* box = boxes + index * kBoxDim;
+    for (int k = 0; k < kBoxDim; ++k) {
+      rois[i * kBoxDim + k] = box[k] * im_info[2];
+    }
+    const int gt_index = i < fg_num ? mapped_gt_inds[index] : 0;
+    int label = i < fg_num ? gt_classes[gt_index] : 0;
+    labels[i] = label;
+    if (label > 0) {
+      if (is_cls_agnostic) {
+        label = 1;
+      }
+      const int64_t dst_idx =
+          static_cast<int64_t>(i) * kBoxDim * class_nums + kBoxDim * label;
+      BoxToDelta<T>(box, gt_boxes + gt_index * kBoxDim, bbox_reg_weights,
+                    false, bbox_targets + dst_idx);
+      for (int k = 0; k < kBoxDim; ++k) {
+        bbox_inside_weights[dst_idx + k] = 1;
+        bbox_outside_weights[dst_idx + k] = 1;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+/*
+ * \brief The CUDA kernel of generate_proposal_labels, which samples the same
+ * rois and targets as the CPU kernel without copying the rois and the gt
+ * boxes to host.
+ *
+ * The proposals and their candidates of each image are computed by the
+ * kernels, and the candidates are sampled by the random keys on device if
+ * use_random, so only the numbers of them are copied to host for the shapes.
+ */
+template <typename T>
+class GenerateProposalLabelsCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* rpn_rois = context.Input<LoDTensor>("RpnRois");
+    auto* gt_classes = context.Input<LoDTensor>("GtClasses");
+    auto* is_crowd = context.Input<LoDTensor>("IsCrowd");
+    auto* gt_boxes = context.Input<LoDTensor>("GtBoxes");
+    auto* im_info = context.Input<LoDTensor>("ImInfo");
+
+    auto* rois = context.Output<LoDTensor>("Rois");
+    auto* labels_int32 = context.Output<LoDTensor>("LabelsInt32");
+    auto* bbox_targets = context.Output<LoDTensor>("BboxTargets");
+    auto* bbox_inside_weights = context.Output<LoDTensor>("BboxInsideWeights");
+    auto* bbox_outside_weights =
+        context.Output<LoDTensor>("BboxOutsideWeights");
+
+    int batch_size_per_im = context.Attr<int>("batch_size_per_im");
+    float fg_fraction = context.Attr<float>("fg_fraction");
+    float fg_thresh = context.Attr<float>("fg_thresh");
+    float bg_thresh_hi = context.Attr<float>("bg_thresh_hi");
+    float bg_thresh_lo = context.Attr<float>("bg_thresh_lo");
+    std::vector<float> bbox_reg_weights =
+        context.Attr<std::vector<float>>("bbox_reg_weights");
+    int class_nums = context.Attr<int>("class_nums");
+    bool use_random = context.Attr<bool>("use_random");
+    bool is_cascade_rcnn = context.Attr<bool>("is_cascade_rcnn");
+    bool is_cls_agnostic = context.Attr<bool>("is_cls_agnostic");
+    PADDLE_ENFORCE_EQ(rpn_rois->lod().size(), 1UL,
+                      "GenerateProposalLabelsOp rpn_rois needs 1 level of LoD");
+    PADDLE_ENFORCE_EQ(
+        gt_classes->lod().size(), 1UL,
+        "GenerateProposalLabelsOp gt_classes needs 1 level of LoD");
+    PADDLE_ENFORCE_EQ(is_crowd->lod().size(), 1UL,
+                      "GenerateProposalLabelsOp is_crowd needs 1 level of LoD");
+    PADDLE_ENFORCE_EQ(gt_boxes->lod().size(), 1UL,
+                      "GenerateProposalLabelsOp gt_boxes needs 1 level of LoD");
+    int64_t n = static_cast<int64_t>(rpn_rois->lod().back().size() - 1);
+    int64_t max_num = n * batch_size_per_im;
+    int width = kBoxDim * class_nums;
+
+    auto place = context.GetPlace();
+    auto gpu_place = boost::get<platform::CUDAPlace>(place);
+    auto& dev_ctx = context.cuda_device_context();
+    auto stream = dev_ctx.stream();
+
+    T* rois_data = rois->mutable_data<T>({max_num, kBoxDim}, place);
+    int* labels_data = labels_int32->mutable_data<int>({max_num, 1}, place);
+    T* bbox_targets_data =
+        bbox_targets->mutable_data<T>({max_num, width}, place);
+    T* bbox_inside_weights_data =
+        bbox_inside_weights->mutable_data<T>({max_num, width}, place);
+    T* bbox_outside_weights_data =
+        bbox_outside_weights->mutable_data<T>({max_num, width}, place);
+    math::SetConstant<platform::CUDADeviceContext, T> set_zero;
+    set_zero(dev_ctx, bbox_targets, static_cast<T>(0));
+    set_zero(dev_ctx, bbox_inside_weights, static_cast<T>(0));
+    set_zero(dev_ctx, bbox_outside_weights, static_cast<T>(0));
+
+    Tensor bbox_reg_weights_t;
+    float* bbox_reg_weights_data = nullptr;
+    if (!bbox_reg_weights.empty()) {
+      int weights_num = static_cast<int>(bbox_reg_weights.size());
+      bbox_reg_weights_data =
+          bbox_reg_weights_t.mutable_data<float>({weights_num}, place);
+      memory::Copy(gpu_place, bbox_reg_weights_data, platform::CPUPlace(),
+                   bbox_reg_weights.data(), sizeof(float) * weights_num,
+                   stream);
+    }
+
+    std::random_device rnd;
+    uint64_t seed = rnd();
+    uint64_t sample_offset = 0;
+    const T lowest = std::numeric_limits<T>::lowest();
+
+    Tensor counts;
+    int* counts_data = counts.mutable_data<int>({2}, place);
+    std::vector<int> host_counts(2);
+
+    std::vector<size_t> lod0(1, 0);
+    int64_t num_rois = 0;
+    auto rpn_rois_lod = rpn_rois->lod().back();
+    auto gt_classes_lod = gt_classes->lod().back();
+    auto is_crowd_lod = is_crowd->lod().back();
+    auto gt_boxes_lod = gt_boxes->lod().back();
+    for (int i = 0; i < n; ++i) {
+      if (rpn_rois_lod[i] == rpn_rois_lod[i + 1]) {
+        lod0.emplace_back(num_rois);
+        continue;
+      }
+      Tensor rpn_rois_slice =
+          rpn_rois->Slice(rpn_rois_lod[i], rpn_rois_lod[i + 1]);
+      Tensor gt_classes_slice =
+          gt_classes->Slice(gt_classes_lod[i], gt_classes_lod[i + 1]);
+      Tensor is_crowd_slice =
+          is_crowd->Slice(is_crowd_lod[i], is_crowd_lod[i + 1]);
+      Tensor gt_boxes_slice =
+          gt_boxes->Slice(gt_boxes_lod[i], gt_boxes_lod[i + 1]);
+      const T* im_info_data = im_info->data<T>() + i * 3;
+      int gt_num = static_cast<int>(gt_boxes_slice.dims()[0]);
+      int proposals_num = static_cast<int>(rpn_rois_slice.dims()[0]);
+      if (!is_cascade_rcnn) {
+        proposals_num += gt_num;
+      }
+
+      // Compute the proposals and their candidates
+      Tensor boxes, fg_flags, bg_flags, mapped_gt_inds, fg_inds, bg_inds;
+      T* boxes_data = boxes.mutable_data<T>({proposals_num, kBoxDim}, place);
+      int* fg_flags_data = fg_flags.mutable_data<int>({proposals_num}, place);
+      int* bg_flags_data = bg_flags.mutable_data<int>({proposals_num}, place);
+      int* mapped_gt_inds_data =
+          mapped_gt_inds.mutable_data<int>({proposals_num}, place);
+      int* fg_inds_data = fg_inds.mutable_data<int>({proposals_num}, place);
+      int* bg_inds_data = bg_inds.mutable_data<int>({proposals_num}, place);
+      ProposalBoxesKernel<T><<<SampleBlocks(proposals_num * kBoxDim),
+                               kSampleThreads, 0, stream>>>(
+          rpn_rois_slice.data<T>(), gt_boxes_slice.data<T>(), gt_num,
+          proposals_num, im_info_data, is_cascade_rcnn, boxes_data);
+      FgBgCandidateFlagsKernel<T><<<SampleBlocks(proposals_num),
+                                    kSampleThreads, 0, stream>>>(
+          boxes_data, proposals_num, gt_boxes_slice.data<T>(), gt_num,
+          is_crowd_slice.data<int>(), lowest, fg_thresh, bg_thresh_hi,
+          bg_thresh_lo, is_cascade_rcnn, fg_flags_data, bg_flags_data,
+          mapped_gt_inds_data);
+      SelectFlaggedIndices(dev_ctx, fg_flags_data, proposals_num,
+                           fg_inds_data, counts_data);
+      SelectFlaggedIndices(dev_ctx, bg_flags_data, proposals_num,
+                           bg_inds_data, counts_data + 1);
+      memory::Copy(platform::CPUPlace(), host_counts.data(), gpu_place,
+                   counts_data, sizeof(int) * 2, stream);
+      dev_ctx.Wait();
+
+      // Sample the foregrounds and the backgrounds
+      int fg_num = host_counts[0];
+      int bg_num = host_counts[1];
+      if (!is_cascade_rcnn) {
+        int fg_rois_per_im = std::floor(batch_size_per_im * fg_fraction);
+        int fg_rois_per_this_image = std::min(fg_rois_per_im, fg_num);
+        RandomSampleIndices(dev_ctx, fg_inds_data, fg_num,
+                            fg_rois_per_this_image, use_random, seed,
+                            sample_offset++);
+        int bg_rois_per_image = batch_size_per_im - fg_rois_per_this_image;
+        int bg_rois_per_this_image =
+            std::max(std::min(bg_rois_per_image, bg_num), 0);
+        RandomSampleIndices(dev_ctx, bg_inds_data, bg_num,
+                            bg_rois_per_this_image, use_random, seed,
+                            sample_offset++);
+        fg_num = fg_rois_per_this_image;
+        bg_num = bg_rois_per_this_image;
+      }
+
+      int rois_num = fg_num + bg_num;
+      PADDLE_ENFORCE_LE(num_rois + rois_num, max_num,
+                        platform::errors::OutOfRange(
+                            "The sampled rois of GenerateProposalLabelsOp "
+                            "should be at most batch_size_per_im %d for each "
+                            "image, but got %d in total for %d images.",
+                            batch_size_per_im, num_rois + rois_num, i + 1));
+      SampledRoisKernel<T><<<SampleBlocks(rois_num), kSampleThreads, 0,
+                             stream>>>(
+          boxes_data, gt_boxes_slice.data<T>(), gt_classes_slice.data<int>(),
+          fg_inds_data, fg_num, bg_inds_data, rois_num, mapped_gt_inds_data,
+          im_info_data, bbox_reg_weights_data, class_nums, is_cls_agnostic,
+          rois_data + num_rois * kBoxDim, labels_data + num_rois,
+          bbox_targets_data + num_rois * width,
+          bbox_inside_weights_data + num_rois * width,
+          bbox_outside_weights_data + num_rois * width);
+
+      num_rois += rois_num;
+      lod0.emplace_back(num_rois);
+    }
+
+    framework::LoD lod;
+    lod.emplace_back(lod0);
+    rois->set_lod(lod);
+    labels_int32->set_lod(lod);
+    bbox_targets->set_lod(lod);
+    bbox_inside_weights->set_lod(lod);
+    bbox_outside_weights->set_lod(lod);
+    rois->Resize({num_rois, kBoxDim});
+    labels_int32->Resize({num_rois, 1});
+    bbox_targets->Resize({num_rois, width});
+    bbox_inside_weights->Resize({num_rois, width});
+    bbox_outside_weights->Resize({num_rois, width});
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(generate_proposal_labels,
+                        ops::GenerateProposalLabelsCUDAKernel<float>,
+                        ops::GenerateProposalLabelsCUDAKernel<double>);
@@ -82,9 +82,18 @@ class MultiClassNMSOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
-    return framework::OpKernelType(
-        OperatorWithKernel::IndicateVarDataType(ctx, "Scores"),
-        platform::CPUPlace());
+    auto data_type = OperatorWithKernel::IndicateVarDataType(ctx, "Scores");
+    // The CUDA kernel suppresses the boxes of [xmin, ymin, xmax, ymax] in the
+    // 3-D Input(Scores) without the adaptive threshold, by which the
+    // overlaps of all the boxes are computed in parallel. The others still
+    // run on CPU.
+    if (platform::is_gpu_place(ctx.GetPlace()) &&
+        ctx.Input<framework::Tensor>("Scores")->dims().size() == 3 &&
+        ctx.Input<framework::Tensor>("BBoxes")->dims()[2] == 4 &&
+        ctx.Attr<float>("nms_eta") >= 1.f) {
+      return framework::OpKernelType(data_type, ctx.GetPlace());
+    }
+    return framework::OpKernelType(data_type, platform::CPUPlace());
   }
 };
 
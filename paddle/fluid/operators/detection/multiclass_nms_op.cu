@@ -0,0 +1,561 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <vector>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+namespace {
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+// The candidates of a class are suppressed by the bits of 64 candidates each.
+constexpr int kNMSBoxesPerBlock = sizeof(uint64_t) * 8;
+constexpr int kNMSThreads = 256;
+constexpr int kNMSMaxBlocks = 4096;
+constexpr int kNMSMaxGridZ = 65535;
+
+inline int NMSBlocks(int n) {
+  return std::max(1, std::min((n + kNMSThreads - 1) / kNMSThreads,
+                              kNMSMaxBlocks));
+}
+
+struct SegmentOffsetFunctor {
+  int segment_size;
+  __host__ __device__ int operator()(int i) const { return i * segment_size; }
+};
+
+// Get the segment s of i, where offsets[s] <= i < offsets[s + 1], and
+// offsets[0] <= i < offsets[num_segments].
+__device__ __forceinline__ int SegmentOf(const int* offsets, int num_segments,
+                                         int i) {
+  int lo = 0;
+  int hi = num_segments;
+  while (hi - lo > 1) {
+    int mid = (lo + hi) / 2;
+    if (offsets[mid] <= i) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// The same as BBoxArea and JaccardOverlap in nms_util.h.
+template <typename T>
+__device__ __forceinline__ T BBoxAreaOnDevice(const T* box, bool normalized) {
+  if (box[2] < box[0] || box[3] < box[1]) {
+    return static_cast<T>(0.);
+  }
+  const T w = box[2] - box[0];
+  const T h = box[3] - box[1];
+  return normalized ? w * h : (w + 1) * (h + 1);
+}
+
+template <typename T>
+__device__ __forceinline__ T JaccardOverlapOnDevice(const T* box1,
+                                                    const T* box2,
+                                                    bool normalized) {
+  if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
+      box2[3] < box1[1]) {
+    return static_cast<T>(0.);
+  }
+  const T inter_xmin = max(box1[0], box2[0]);
+  const T inter_ymin = max(box1[1], box2[1]);
+  const T inter_xmax = min(box1[2], box2[2]);
+  const T inter_ymax = min(box1[3], box2[3]);
+  T norm = normalized ? static_cast<T>(0.) : static_cast<T>(1.);
+  const T inter_area =
+      (inter_xmax - inter_xmin + norm) * (inter_ymax - inter_ymin + norm);
+  const T bbox1_area = BBoxAreaOnDevice<T>(box1, normalized);
+  const T bbox2_area = BBoxAreaOnDevice<T>(box2, normalized);
+  return inter_area / (bbox1_area + bbox2_area - inter_area);
+}
+
+__global__ void InitBoxIndexKernel(int n, int num_boxes, int* indices) {
+  CUDA_1D_KERNEL_LOOP(i, n) { indices[i] = i % num_boxes; }
+}
+
+// The scores of each (image, class) segment are sorted descending, so the
+// candidates of a class are the first scores larger than score_threshold, at
+// most top_k of them.
+template <typename T>
+__global__ void CountCandidatesKernel(const T* sorted_scores, int num_segments,
+                                      int num_classes, int num_boxes,
+                                      int background_label, T score_threshold,
+                                      int top_k, int* counts) {
+  CUDA_1D_KERNEL_LOOP(s, num_segments) {
+    if (s % num_classes == background_label) {
+      counts[s] = 0;
+      continue;
+    }
+    const T* scores = sorted_scores + static_cast<int64_t>(s) * num_boxes;
+    int lo = 0;
+    int hi = num_boxes;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (scores[mid] > score_threshold) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    counts[s] = top_k > -1 ? min(lo, top_k) : lo;
+  }
+}
+
+// Set the bit j of mask[s][i][j / 64] if the candidate j of the segment s
+// overlaps the candidate i by more than nms_threshold for j > i. Only the
+// words of the blocks on and after the diagonal are read by NMSSelectKernel.
+template <typename T>
+__global__ void NMSMaskKernel(const T* boxes, const int* sorted_indices,
+                              const int* counts, int num_segments,
+                              int num_classes, int num_boxes,
+                              int max_candidates, int col_blocks,
+                              T nms_threshold, bool normalized,
+                              uint64_t* mask) {
+  const int row_start = blockIdx.y;
+  const int col_start = blockIdx.x;
+  __shared__ T block_boxes[kNMSBoxesPerBlock * 4];
+  for (int s = blockIdx.z; s < num_segments; s += gridDim.z) {
+    const int n = counts[s];
+    if (col_start < row_start || col_start * kNMSBoxesPerBlock >= n) {
+      continue;
+    }
+    const int row_size = min(n - row_start * kNMSBoxesPerBlock,
+                             kNMSBoxesPerBlock);
+    const int col_size = min(n - col_start * kNMSBoxesPerBlock,
+                             kNMSBoxesPerBlock);
+    const T* image_boxes =
+        boxes + static_cast<int64_t>(s / num_classes) * num_boxes * 4;
+    const int* indices = sorted_indices + static_cast<int64_t>(s) * num_boxes;
+
+    __syncthreads();
+    if (threadIdx.x < col_size) {
+      const int j = col_start * kNMSBoxesPerBlock + threadIdx.x;
+      const T* box = image_boxes + indices[j] * 4;
+      for (int k = 0; k < 4; ++k) {
+        block_boxes[threadIdx.x * 4 + k] = box[k];
+      }
+    }
+    __syncthreads();
+
+    if (threadIdx.x < row_size) {
+      const int i = row_start * kNMSBoxesPerBlock + threadIdx.x;
+      const T* cur_box = image_boxes + indices[i] * 4;
+      const int start = row_start == col_start ? threadIdx.x + 1 : 0;
+      uint64_t t = 0;
+      for (int j = start; j < col_size; ++j) {
+        if (JaccardOverlapOnDevice<T>(cur_box, block_boxes + j * 4,
+                                      normalized) > nms_threshold) {
+          t |= 1ULL << j;
+        }
+      }
+      mask[(static_cast<int64_t>(s) * max_candidates + i) * col_blocks +
+           col_start] = t;
+    }
+  }
+}
+
+// Select the candidates of the segment blockIdx.x greedily by the mask, which
+// are the kept positions of the sorted candidates in the order of scores.
+__global__ void NMSSelectKernel(const uint64_t* mask, const int* counts,
+                                int max_candidates, int col_blocks, int* kept,
+                                int* kept_counts) {
+  extern __shared__ uint64_t removed[];
+  const int s = blockIdx.x;
+  const int n = counts[s];
+  const int blocks = (n + kNMSBoxesPerBlock - 1) / kNMSBoxesPerBlock;
+  for (int j = threadIdx.x; j < blocks; j += blockDim.x) {
+    removed[j] = 0;
+  }
+  __syncthreads();
+
+  const uint64_t* seg_mask =
+      mask + static_cast<int64_t>(s) * max_candidates * col_blocks;
+  int* seg_kept = kept + static_cast<int64_t>(s) * max_candidates;
+  int num_kept = 0;
+  for (int i = 0; i < n; ++i) {
+    const int nblock = i / kNMSBoxesPerBlock;
+    if (removed[nblock] & (1ULL << (i % kNMSBoxesPerBlock))) continue;
+    if (threadIdx.x == 0) {
+      seg_kept[num_kept] = i;
+    }
+    ++num_kept;
+    // All the threads have read the bit of i before the words are updated.
+    __syncthreads();
+    const uint64_t* row = seg_mask + static_cast<int64_t>(i) * col_blocks;
+    for (int j = nblock + threadIdx.x; j < blocks; j += blockDim.x) {
+      removed[j] |= row[j];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    kept_counts[s] = num_kept;
+  }
+}
+
+// Gather the kept candidates of all the segments into the flat arrays, which
+// are ordered by image, then by class, then by score descending, the same
+// order as the outputs of the CPU kernel.
+template <typename T>
+__global__ void GatherCandidatesKernel(
+    const T* sorted_scores, const int* sorted_indices, const int* kept,
+    const int* offsets, int num_segments, int num_boxes, int max_candidates,
+    int num_candidates, T* scores, int* box_indices, int* segments) {
+  CUDA_1D_KERNEL_LOOP(f, num_candidates) {
+    const int s = SegmentOf(offsets, num_segments, f);
+    const int t = kept[static_cast<int64_t>(s) * max_candidates + f -
+                       offsets[s]];
+    const int64_t k = static_cast<int64_t>(s) * num_boxes + t;
+    scores[f] = sorted_scores[k];
+    box_indices[f] = sorted_indices[k];
+    segments[f] = s;
+  }
+}
+
+// Mark the first keep_top_k candidates of each image in the order of scores,
+// where sorted[f] is the flat position of the f-th sorted candidate.
+__global__ void MarkTopKeptKernel(const int* sorted, const int* image_offsets,
+                                  int num_images, int num_candidates,
+                                  int keep_top_k, int* selected) {
+  CUDA_1D_KERNEL_LOOP(f, num_candidates) {
+    const int image = SegmentOf(image_offsets, num_images, f);
+    if (f - image_offsets[image] < keep_top_k) {
+      selected[sorted[f]] = 1;
+    }
+  }
+}
+
+// Write the selected candidates to the rows of Out and Index. All the
+// candidates are selected if selected is nullptr, and the row of the
+// candidate f is rows[f] otherwise.
+template <typename T>
+__global__ void MultiClassOutputKernel(const T* boxes, const T* scores,
+                                       const int* box_indices,
+                                       const int* segments,
+                                       const int* selected, const int* rows,
+                                       int num_candidates, int num_classes,
+                                       int num_boxes, T* out, int* index) {
+  CUDA_1D_KERNEL_LOOP(f, num_candidates) {
+    if (selected != nullptr && !selected[f]) continue;
+    const int row = selected != nullptr ? rows[f] : f;
+    const int s = segments[f];
+    const int64_t box = static_cast<int64_t>(s / num_classes) * num_boxes +
+                        box_indices[f];
+    T* o = out + static_cast<int64_t>(row) * 6;
+    o[0] = static_cast<T>(s % num_classes);
+    o[1] = scores[f];
+    for (int k = 0; k < 4; ++k) {
+      o[2 + k] = boxes[box * 4 + k];
+    }
+    if (index != nullptr) {
+      index[row] = static_cast<int>(box);
+    }
+  }
+}
+
+template <typename T, typename OffsetIterator>
+void SortPairsDescending(const platform::CUDADeviceContext& dev_ctx,
+                         const T* keys_in, T* keys_out, const int* values_in,
+                         int* values_out, int num_items, int num_segments,
+                         OffsetIterator offsets) {
+  size_t temp_storage_bytes = 0;
+  auto err = cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      nullptr, temp_storage_bytes, keys_in, keys_out, values_in, values_out,
+      num_items, num_segments, offsets, offsets + 1, 0, sizeof(T) * 8,
+      dev_ctx.stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      err,
+      "MultiClassNMS failed as could not launch "
+      "cub::DeviceSegmentedRadixSort::SortPairsDescending to calculate "
+      "temp_storage_bytes, status:%s.",
+      cudaGetErrorString(err));
+
+  Tensor temp_storage;
+  temp_storage.mutable_data<uint8_t>(dev_ctx.GetPlace(), temp_storage_bytes);
+  err = cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      temp_storage.data<uint8_t>(), temp_storage_bytes, keys_in, keys_out,
+      values_in, values_out, num_items, num_segments, offsets, offsets + 1, 0,
+      sizeof(T) * 8, dev_ctx.stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      err,
+      "MultiClassNMS failed as could not launch "
+      "cub::DeviceSegmentedRadixSort::SortPairsDescending to sort scores, "
+      "temp_storage_bytes:%d status:%s.",
+      temp_storage_bytes, cudaGetErrorString(err));
+}
+
+void ExclusiveSum(const platform::CUDADeviceContext& dev_ctx, const int* in,
+                  int* out, int n) {
+  size_t temp_storage_bytes = 0;
+  auto err = cub::DeviceScan::ExclusiveSum(nullptr, temp_storage_bytes, in,
+                                           out, n, dev_ctx.stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      err,
+      "MultiClassNMS failed as could not launch cub::DeviceScan::ExclusiveSum "
+      "to calculate temp_storage_bytes, status:%s.",
+      cudaGetErrorString(err));
+  Tensor temp_storage;
+  temp_storage.mutable_data<uint8_t>(dev_ctx.GetPlace(), temp_storage_bytes);
+  err = cub::DeviceScan::ExclusiveSum(temp_storage.data<uint8_t>(),
+                                      temp_storage_bytes, in, out, n,
+                                      dev_ctx.stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      err,
+      "MultiClassNMS failed as could not launch cub::DeviceScan::ExclusiveSum, "
+      "status:%s.",
+      cudaGetErrorString(err));
+}
+
+}  // namespace
+
+/*
+ * \brief The multi-class NMS of the 3-D Input(Scores) [N, C, M] and
+ * Input(BBoxes) [N, M, 4] without the adaptive threshold.
+ *
+ * The scores of all the N * C (image, class) segments are sorted by one
+ * segmented sort to get the candidates of each class. The overlaps of the
+ * candidates of all the classes are computed in parallel into bit masks, and
+ * each class is suppressed greedily by the masks in one block. Then at most
+ * keep_top_k detections of each image are selected by another segmented sort,
+ * so only the numbers of the candidates and the detections are copied to host
+ * for the shapes of the outputs.
+ */
+template <typename T>
+class MultiClassNMSCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* boxes = ctx.Input<LoDTensor>("BBoxes");
+    auto* scores = ctx.Input<LoDTensor>("Scores");
+    auto* outs = ctx.Output<LoDTensor>("Out");
+    bool return_index = ctx.HasOutput("Index");
+    auto* index = ctx.Output<LoDTensor>("Index");
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto place = boost::get<platform::CUDAPlace>(ctx.GetPlace());
+    auto stream = dev_ctx.stream();
+
+    auto score_dims = scores->dims();
+    PADDLE_ENFORCE_EQ(
+        score_dims.size() == 3 && boxes->dims()[2] == 4 &&
+            ctx.Attr<float>("nms_eta") >= 1.f,
+        true,
+        platform::errors::InvalidArgument(
+            "The CUDA kernel of %s only supports the 3-D Input(Scores) and "
+            "the boxes of [xmin, ymin, xmax, ymax] without the adaptive NMS.",
+            ctx.Type()));
+    const int num_images = static_cast<int>(score_dims[0]);
+    const int num_classes = static_cast<int>(score_dims[1]);
+    const int num_boxes = static_cast<int>(score_dims[2]);
+    const int num_segments = num_images * num_classes;
+    const int num_scores = num_segments * num_boxes;
+
+    int background_label = ctx.Attr<int>("background_label");
+    int nms_top_k = ctx.Attr<int>("nms_top_k");
+    int keep_top_k = ctx.Attr<int>("keep_top_k");
+    bool normalized = ctx.Attr<bool>("normalized");
+    T nms_threshold = static_cast<T>(ctx.Attr<float>("nms_threshold"));
+    T score_threshold = static_cast<T>(ctx.Attr<float>("score_threshold"));
+
+    // 1. Sort the scores of each class and count its candidates.
+    Tensor box_indices, sorted_scores, sorted_indices, counts;
+    int* box_indices_data =
+        box_indices.mutable_data<int>({num_scores}, ctx.GetPlace());
+    T* sorted_scores_data =
+        sorted_scores.mutable_data<T>({num_scores}, ctx.GetPlace());
+    int* sorted_indices_data =
+        sorted_indices.mutable_data<int>({num_scores}, ctx.GetPlace());
+    int* counts_data = counts.mutable_data<int>({num_segments}, ctx.GetPlace());
+    InitBoxIndexKernel<<<NMSBlocks(num_scores), kNMSThreads, 0, stream>>>(
+        num_scores, num_boxes, box_indices_data);
+    cub::CountingInputIterator<int> counting_iter(0);
+    cub::TransformInputIterator<int, SegmentOffsetFunctor,
+                                cub::CountingInputIterator<int>>
+        segment_offsets(counting_iter, SegmentOffsetFunctor{num_boxes});
+    SortPairsDescending<T>(dev_ctx, scores->data<T>(), sorted_scores_data,
+                           box_indices_data, sorted_indices_data, num_scores,
+                           num_segments, segment_offsets);
+    CountCandidatesKernel<T><<<NMSBlocks(num_segments), kNMSThreads, 0,
+                               stream>>>(
+        sorted_scores_data, num_segments, num_classes, num_boxes,
+        background_label, score_threshold, nms_top_k, counts_data);
+
+    std::vector<int> host_counts(num_segments);
+    memory::Copy(platform::CPUPlace(), host_counts.data(), place, counts_data,
+                 sizeof(int) * num_segments, stream);
+    dev_ctx.Wait();
+    int max_candidates =
+        num_segments > 0
+            ? *std::max_element(host_counts.begin(), host_counts.end())
+            : 0;
+
+    // 2. Suppress the candidates of each class by the masks of the overlaps.
+    Tensor kept, kept_counts;
+    int* kept_data = kept.mutable_data<int>(
+        {std::max(num_segments * max_candidates, 1)}, ctx.GetPlace());
+    int* kept_counts_data =
+        kept_counts.mutable_data<int>({num_segments}, ctx.GetPlace());
+    if (max_candidates > 0) {
+      const int col_blocks =
+          (max_candidates + kNMSBoxesPerBlock - 1) / kNMSBoxesPerBlock;
+      Tensor mask;
+      auto* mask_data =
+          reinterpret_cast<uint64_t*>(mask.mutable_data<int64_t>(
+              {static_cast<int64_t>(num_segments) * max_candidates *
+               col_blocks},
+              ctx.GetPlace()));
+      dim3 blocks(col_blocks, col_blocks,
+                  std::min(num_segments, kNMSMaxGridZ));
+      NMSMaskKernel<T><<<blocks, kNMSBoxesPerBlock, 0, stream>>>(
+          boxes->data<T>(), sorted_indices_data, counts_data, num_segments,
+          num_classes, num_boxes, max_candidates, col_blocks, nms_threshold,
+          normalized, mask_data);
+      NMSSelectKernel<<<num_segments, kNMSBoxesPerBlock,
+                        col_blocks * sizeof(uint64_t), stream>>>(
+          mask_data, counts_data, max_candidates, col_blocks, kept_data,
+          kept_counts_data);
+      memory::Copy(platform::CPUPlace(), host_counts.data(), place,
+                   kept_counts_data, sizeof(int) * num_segments, stream);
+      dev_ctx.Wait();
+    }
+
+    // 3. Keep at most keep_top_k detections of each image.
+    std::vector<int> offsets(num_segments + 1, 0);
+    for (int s = 0; s < num_segments; ++s) {
+      offsets[s + 1] = offsets[s] + host_counts[s];
+    }
+    std::vector<size_t> batch_starts = {0};
+    std::vector<int> image_offsets(num_images + 1, 0);
+    bool need_top_kept = false;
+    for (int i = 0; i < num_images; ++i) {
+      image_offsets[i + 1] = offsets[(i + 1) * num_classes];
+      int num_det = image_offsets[i + 1] - image_offsets[i];
+      if (keep_top_k > -1 && num_det > keep_top_k) {
+        num_det = keep_top_k;
+        need_top_kept = true;
+      }
+      batch_starts.push_back(batch_starts.back() + num_det);
+    }
+
+    const int num_candidates = offsets.back();
+    const int num_kept = static_cast<int>(batch_starts.back());
+    if (num_kept == 0) {
+      if (return_index) {
+        outs->mutable_data<T>({0, 6}, ctx.GetPlace());
+        index->mutable_data<int>({0, 1}, ctx.GetPlace());
+      } else {
+        outs->mutable_data<T>({1, 1}, ctx.GetPlace());
+        math::SetConstant<platform::CUDADeviceContext, T>()(
+            dev_ctx, outs, static_cast<T>(-1));
+        batch_starts = {0, 1};
+      }
+    } else {
+      Tensor offsets_t, cand_scores, cand_indices, cand_segments;
+      int* offsets_data =
+          offsets_t.mutable_data<int>({num_segments + 1}, ctx.GetPlace());
+      memory::Copy(place, offsets_data, platform::CPUPlace(), offsets.data(),
+                   sizeof(int) * (num_segments + 1), stream);
+      T* cand_scores_data =
+          cand_scores.mutable_data<T>({num_candidates}, ctx.GetPlace());
+      int* cand_indices_data =
+          cand_indices.mutable_data<int>({num_candidates}, ctx.GetPlace());
+      int* cand_segments_data =
+          cand_segments.mutable_data<int>({num_candidates}, ctx.GetPlace());
+      GatherCandidatesKernel<T><<<NMSBlocks(num_candidates), kNMSThreads, 0,
+                                  stream>>>(
+          sorted_scores_data, sorted_indices_data, kept_data, offsets_data,
+          num_segments, num_boxes, max_candidates, num_candidates,
+          cand_scores_data, cand_indices_data, cand_segments_data);
+
+      Tensor selected, rows;
+      int* selected_data = nullptr;
+      int* rows_data = nullptr;
+      if (need_top_kept) {
+        Tensor image_offsets_t, positions, sorted_cand_scores,
+            sorted_positions;
+        int* image_offsets_data =
+            image_offsets_t.mutable_data<int>({num_images + 1},
+                                              ctx.GetPlace());
+        memory::Copy(place, image_offsets_data, platform::CPUPlace(),
+                     image_offsets.data(), sizeof(int) * (num_images + 1),
+                     stream);
+        int* positions_data =
+            positions.mutable_data<int>({num_candidates}, ctx.GetPlace());
+        InitBoxIndexKernel<<<NMSBlocks(num_candidates), kNMSThreads, 0,
+                             stream>>>(num_candidates, num_candidates,
+                                       positions_data);
+        int* sorted_positions_data = sorted_positions.mutable_data<int>(
+            {num_candidates}, ctx.GetPlace());
+        SortPairsDescending<T>(
+            dev_ctx, cand_scores_data,
+            sorted_cand_scores.mutable_data<T>({num_candidates},
+                                               ctx.GetPlace()),
+            positions_data, sorted_positions_data, num_candidates, num_images,
+            image_offsets_data);
+
+        selected_data =
+            selected.mutable_data<int>({num_candidates}, ctx.GetPlace());
+        math::SetConstant<platform::CUDADeviceContext, int>()(dev_ctx,
+                                                              &selected, 0);
+        MarkTopKeptKernel<<<NMSBlocks(num_candidates), kNMSThreads, 0,
+                            stream>>>(sorted_positions_data,
+                                      image_offsets_data, num_images,
+                                      num_candidates, keep_top_k,
+                                      selected_data);
+        rows_data = rows.mutable_data<int>({num_candidates}, ctx.GetPlace());
+        ExclusiveSum(dev_ctx, selected_data, rows_data, num_candidates);
+      }
+
+      T* out_data = outs->mutable_data<T>({num_kept, 6}, ctx.GetPlace());
+      int* index_data =
+          return_index ? index->mutable_data<int>({num_kept, 1},
+                                                  ctx.GetPlace())
+                       : nullptr;
+      MultiClassOutputKernel<T><<<NMSBlocks(num_candidates), kNMSThreads, 0,
+                                  stream>>>(
+          boxes->data<T>(), cand_scores_data, cand_indices_data,
+          cand_segments_data, selected_data, rows_data, num_candidates,
+          num_classes, num_boxes, out_data, index_data);
+    }
+
+    framework::LoD lod;
+    lod.emplace_back(batch_starts);
+    if (return_index) {
+      index->set_lod(lod);
+    }
+    outs->set_lod(lod);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(multiclass_nms, ops::MultiClassNMSCUDAKernel<float>,
+                        ops::MultiClassNMSCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(multiclass_nms2, ops::MultiClassNMSCUDAKernel<float>,
+                        ops::MultiClassNMSCUDAKernel<double>);
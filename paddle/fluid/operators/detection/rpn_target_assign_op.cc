@@ -78,7 +78,7 @@ class RpnTargetAssignOp : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(
         OperatorWithKernel::IndicateVarDataType(ctx, "Anchor"),
-        platform::CPUPlace());
+        ctx.GetPlace());
   }
 };
 
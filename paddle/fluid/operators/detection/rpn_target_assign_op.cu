@@ -0,0 +1,449 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/detection/bbox_util.h"
+#include "paddle/fluid/operators/detection/sample_util.cu.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+namespace {
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+// The counts of one image copied to host.
+enum RpnCount {
+  kInsideNum = 0,
+  kGtNum,
+  kFgCandidateNum,
+  kBgCandidateNum,
+  kFakeNum,
+  kFgNum,
+  kBgNum,
+  kRpnCountNum,
+};
+
+template <typename T>
+__global__ void InsideAnchorFlagsKernel(const T* anchor, int anchor_num,
+                                        const T* im_info,
+                                        float rpn_straddle_thresh,
+                                        int* flags) {
+  CUDA_1D_KERNEL_LOOP(i, anchor_num) {
+    const T* box = anchor + i * 4;
+    flags[i] = rpn_straddle_thresh < 0 ||
+               (box[0] >= -rpn_straddle_thresh &&
+                box[1] >= -rpn_straddle_thresh &&
+                box[2] < im_info[1] + rpn_straddle_thresh &&
+                box[3] < im_info[0] + rpn_straddle_thresh);
+  }
+}
+
+__global__ void NotCrowdFlagsKernel(const int* is_crowd, int gt_num,
+                                    int* flags) {
+  CUDA_1D_KERNEL_LOOP(i, gt_num) { flags[i] = is_crowd[i] == 0; }
+}
+
+template <typename T>
+__global__ void GatherScaledBoxesKernel(const T* boxes, const int* indices,
+                                        const int* num, const T* im_info,
+                                        T* out) {
+  CUDA_1D_KERNEL_LOOP(i, *num * 4) {
+    out[i] = boxes[indices[i / 4] * 4 + i % 4] * im_info[2];
+  }
+}
+
+// Compute the overlaps of the inside anchors and the gt boxes, and the max
+// overlap of each anchor with its first gt box of the max overlap.
+template <typename T>
+__global__ void AnchorOverlapsKernel(const T* anchor, const int* inds_inside,
+                                     int inside_num, const T* gt_boxes,
+                                     int gt_num, T lowest, T* overlaps,
+                                     T* anchor_to_gt_max,
+                                     int* anchor_to_gt_argmax) {
+  CUDA_1D_KERNEL_LOOP(i, inside_num) {
+    const T* box = anchor + inds_inside[i] * 4;
+    T max_overlap = lowest;
+    int argmax = 0;
+    for (int j = 0; j < gt_num; ++j) {
+      T overlap = BoxOverlap<T>(box, gt_boxes + j * 4);
+      overlaps[static_cast<int64_t>(i) * gt_num + j] = overlap;
+      if (overlap > max_overlap) {
+        max_overlap = overlap;
+        argmax = j;
+      }
+    }
+    anchor_to_gt_max[i] = max_overlap;
+    anchor_to_gt_argmax[i] = argmax;
+  }
+}
+
+// The max overlap of the gt box blockIdx.x with all the inside anchors.
+template <typename T>
+__global__ void GtOverlapMaxKernel(const T* overlaps, int inside_num,
+                                   int gt_num, T lowest,
+                                   T* gt_to_anchor_max) {
+  typedef cub::BlockReduce<T, kSampleThreads> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  const int j = blockIdx.x;
+  T max_overlap = lowest;
+  for (int i = threadIdx.x; i < inside_num; i += blockDim.x) {
+    max_overlap =
+        max(max_overlap, overlaps[static_cast<int64_t>(i) * gt_num + j]);
+  }
+  max_overlap = BlockReduce(temp_storage).Reduce(max_overlap, cub::Max());
+  if (threadIdx.x == 0) {
+    gt_to_anchor_max[j] = max_overlap;
+  }
+}
+
+// The same candidates as ScoreAssign on CPU: the foreground anchors have the
+// max overlap of any gt box or an overlap of at least rpn_positive_overlap,
+// and the background anchors have max overlaps below rpn_negative_overlap.
+template <typename T>
+__global__ void FgBgCandidateFlagsKernel(
+    const T* overlaps, int inside_num, int gt_num, const T* gt_to_anchor_max,
+    const T* anchor_to_gt_max, float rpn_positive_overlap,
+    float rpn_negative_overlap, int* fg_flags, int* bg_flags) {
+  const float epsilon = 0.00001;
+  CUDA_1D_KERNEL_LOOP(i, inside_num) {
+    bool is_anchor_with_max_overlap = false;
+    for (int j = 0; j < gt_num; ++j) {
+      T diff = overlaps[static_cast<int64_t>(i) * gt_num + j] -
+               gt_to_anchor_max[j];
+      if ((diff < 0 ? -diff : diff) < epsilon) {
+        is_anchor_with_max_overlap = true;
+        break;
+      }
+    }
+    fg_flags[i] = is_anchor_with_max_overlap ||
+                  anchor_to_gt_max[i] >= rpn_positive_overlap;
+    bg_flags[i] = anchor_to_gt_max[i] < rpn_negative_overlap;
+  }
+}
+
+__global__ void ScatterLabelsKernel(const int* indices, int num, int label,
+                                    int* labels) {
+  CUDA_1D_KERNEL_LOOP(i, num) { labels[indices[i]] = label; }
+}
+
+// Label the sampled background anchors, and count the ones labeled
+// foreground before, each of which is replaced by a fake foreground.
+__global__ void BgLabelsKernel(const int* bg_inds, int bg_num, int* labels,
+                               int* fake_num) {
+  CUDA_1D_KERNEL_LOOP(i, bg_num) {
+    int index = bg_inds[i];
+    if (labels[index] == 1) {
+      atomicAdd(fake_num, 1);
+    }
+    labels[index] = 0;
+  }
+}
+
+__global__ void LabelFlagsKernel(const int* labels, int num, int* fg_flags,
+                                 int* bg_flags) {
+  CUDA_1D_KERNEL_LOOP(i, num) {
+    fg_flags[i] = labels[i] == 1;
+    bg_flags[i] = labels[i] == 0;
+  }
+}
+
+// The fake foregrounds are the first sampled foreground candidate with the
+// inside weights of 0, followed by the foregrounds of the inside weights of 1.
+template <typename T>
+__global__ void LocationTargetsKernel(
+    const T* anchor, const int* inds_inside, const T* gt_boxes,
+    const int* anchor_to_gt_argmax, const int* fg_candidates,
+    const int* fg_inds, int fake_num, int loc_num, int anchor_offset,
+    int* loc_index, T* tgt_bbox, T* bbox_inside_weight) {
+  CUDA_1D_KERNEL_LOOP(i, loc_num) {
+    int index = i < fake_num ? fg_candidates[0] : fg_inds[i - fake_num];
+    int anchor_index = inds_inside[index];
+    loc_index[i] = anchor_index + anchor_offset;
+    BoxToDelta<T>(anchor + anchor_index * 4,
+                  gt_boxes + anchor_to_gt_argmax[index] * 4, nullptr, false,
+                  tgt_bbox + i * 4);
+    T weight = i < fake_num ? static_cast<T>(0.) : static_cast<T>(1.);
+    for (int k = 0; k < 4; ++k) {
+      bbox_inside_weight[i * 4 + k] = weight;
+    }
+  }
+}
+
+__global__ void ScoreTargetsKernel(const int* inds_inside, const int* fg_inds,
+                                   int fg_num, const int* bg_inds,
+                                   int score_num, int anchor_offset,
+                                   int* score_index, int* tgt_lbl) {
+  CUDA_1D_KERNEL_LOOP(i, score_num) {
+    int index = i < fg_num ? fg_inds[i] : bg_inds[i - fg_num];
+    score_index[i] = inds_inside[index] + anchor_offset;
+    tgt_lbl[i] = i < fg_num;
+  }
+}
+
+}  // namespace
+
+/*
+ * \brief The CUDA kernel of rpn_target_assign, which assigns the same targets
+ * as the CPU kernel without copying the anchors and the gt boxes to host.
+ *
+ * The inside anchors, the overlaps and the candidates of each image are
+ * filtered and computed by the kernels, and the anchors are sampled by the
+ * random keys on device if use_random, so only the numbers of them are copied
+ * to host for the shapes.
+ */
+template <typename T>
+class RpnTargetAssignCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* anchor = context.Input<Tensor>("Anchor");  // (H*W*A) * 4
+    auto* gt_boxes = context.Input<LoDTensor>("GtBoxes");
+    auto* is_crowd = context.Input<LoDTensor>("IsCrowd");
+    auto* im_info = context.Input<LoDTensor>("ImInfo");
+
+    auto* loc_index = context.Output<LoDTensor>("LocationIndex");
+    auto* score_index = context.Output<LoDTensor>("ScoreIndex");
+    auto* tgt_bbox = context.Output<LoDTensor>("TargetBBox");
+    auto* tgt_lbl = context.Output<LoDTensor>("TargetLabel");
+    auto* bbox_inside_weight = context.Output<LoDTensor>("BBoxInsideWeight");
+
+    PADDLE_ENFORCE_EQ(gt_boxes->lod().size(), 1UL,
+                      "RpnTargetAssignOp gt_boxes needs 1 level of LoD");
+    PADDLE_ENFORCE_EQ(is_crowd->lod().size(), 1UL,
+                      "RpnTargetAssignOp is_crowd needs 1 level of LoD");
+    int anchor_num = static_cast<int>(anchor->dims()[0]);
+    int64_t batch_num = static_cast<int64_t>(gt_boxes->lod().back().size() - 1);
+
+    int rpn_batch_size_per_im = context.Attr<int>("rpn_batch_size_per_im");
+    float rpn_straddle_thresh = context.Attr<float>("rpn_straddle_thresh");
+    float rpn_positive_overlap = context.Attr<float>("rpn_positive_overlap");
+    float rpn_negative_overlap = context.Attr<float>("rpn_negative_overlap");
+    float rpn_fg_fraction = context.Attr<float>("rpn_fg_fraction");
+    bool use_random = context.Attr<bool>("use_random");
+    bool sampling = rpn_fg_fraction > 0 && rpn_batch_size_per_im > 0;
+
+    int64_t max_num = batch_num * rpn_batch_size_per_im;
+    auto place = context.GetPlace();
+    auto gpu_place = boost::get<platform::CUDAPlace>(place);
+    auto& dev_ctx = context.cuda_device_context();
+    auto stream = dev_ctx.stream();
+
+    int* loc_index_data = loc_index->mutable_data<int>({max_num}, place);
+    int* score_index_data = score_index->mutable_data<int>({max_num}, place);
+    T* tgt_bbox_data = tgt_bbox->mutable_data<T>({max_num, 4}, place);
+    int* tgt_lbl_data = tgt_lbl->mutable_data<int>({max_num, 1}, place);
+    T* bbox_inside_weight_data =
+        bbox_inside_weight->mutable_data<T>({max_num, 4}, place);
+
+    std::random_device rnd;
+    uint64_t seed = rnd();
+    uint64_t sample_offset = 0;
+    const T lowest = std::numeric_limits<T>::lowest();
+
+    Tensor counts;
+    int* counts_data = counts.mutable_data<int>({kRpnCountNum}, place);
+    std::vector<int> host_counts(kRpnCountNum);
+    auto copy_counts = [&](int first, int num) {
+      memory::Copy(platform::CPUPlace(), host_counts.data() + first, gpu_place,
+                   counts_data + first, sizeof(int) * num, stream);
+      dev_ctx.Wait();
+    };
+    math::SetConstant<platform::CUDADeviceContext, int> set_int;
+
+    std::vector<size_t> lod0_loc(1, 0);
+    std::vector<size_t> lod0_score(1, 0);
+    int total_loc_num = 0;
+    int total_score_num = 0;
+    auto gt_boxes_lod = gt_boxes->lod().back();
+    auto is_crowd_lod = is_crowd->lod().back();
+    for (int i = 0; i < batch_num; ++i) {
+      Tensor gt_boxes_slice =
+          gt_boxes->Slice(gt_boxes_lod[i], gt_boxes_lod[i + 1]);
+      Tensor is_crowd_slice =
+          is_crowd->Slice(is_crowd_lod[i], is_crowd_lod[i + 1]);
+      const T* im_info_data = im_info->data<T>() + i * 3;
+      int all_gt_num = static_cast<int>(gt_boxes_slice.dims()[0]);
+
+      // Filter straddle anchor and crowd gt
+      Tensor anchor_flags, inds_inside, gt_flags, ncrowd_inds;
+      int* anchor_flags_data =
+          anchor_flags.mutable_data<int>({anchor_num}, place);
+      int* inds_inside_data =
+          inds_inside.mutable_data<int>({anchor_num}, place);
+      int* gt_flags_data = gt_flags.mutable_data<int>({all_gt_num}, place);
+      int* ncrowd_inds_data =
+          ncrowd_inds.mutable_data<int>({all_gt_num}, place);
+      InsideAnchorFlagsKernel<T><<<SampleBlocks(anchor_num), kSampleThreads, 0,
+                                   stream>>>(anchor->data<T>(), anchor_num,
+                                             im_info_data, rpn_straddle_thresh,
+                                             anchor_flags_data);
+      SelectFlaggedIndices(dev_ctx, anchor_flags_data, anchor_num,
+                           inds_inside_data, counts_data + kInsideNum);
+      NotCrowdFlagsKernel<<<SampleBlocks(all_gt_num), kSampleThreads, 0,
+                            stream>>>(is_crowd_slice.data<int>(), all_gt_num,
+                                      gt_flags_data);
+      SelectFlaggedIndices(dev_ctx, gt_flags_data, all_gt_num,
+                           ncrowd_inds_data, counts_data + kGtNum);
+      Tensor ncrowd_gt_boxes;
+      T* ncrowd_gt_boxes_data =
+          ncrowd_gt_boxes.mutable_data<T>({all_gt_num, 4}, place);
+      GatherScaledBoxesKernel<T><<<SampleBlocks(all_gt_num * 4),
+                                   kSampleThreads, 0, stream>>>(
+          gt_boxes_slice.data<T>(), ncrowd_inds_data, counts_data + kGtNum,
+          im_info_data, ncrowd_gt_boxes_data);
+      copy_counts(kInsideNum, 2);
+      int inside_num = host_counts[kInsideNum];
+      int gt_num = host_counts[kGtNum];
+
+      // Compute the overlaps and the candidates
+      Tensor overlaps, anchor_to_gt_max, anchor_to_gt_argmax, gt_to_anchor_max;
+      T* overlaps_data = overlaps.mutable_data<T>({inside_num, gt_num}, place);
+      T* anchor_to_gt_max_data =
+          anchor_to_gt_max.mutable_data<T>({inside_num}, place);
+      int* argmax_data =
+          anchor_to_gt_argmax.mutable_data<int>({inside_num}, place);
+      T* gt_to_anchor_max_data =
+          gt_to_anchor_max.mutable_data<T>({gt_num}, place);
+      AnchorOverlapsKernel<T><<<SampleBlocks(inside_num), kSampleThreads, 0,
+                                stream>>>(
+          anchor->data<T>(), inds_inside_data, inside_num,
+          ncrowd_gt_boxes_data, gt_num, lowest, overlaps_data,
+          anchor_to_gt_max_data, argmax_data);
+      if (gt_num > 0) {
+        GtOverlapMaxKernel<T><<<gt_num, kSampleThreads, 0, stream>>>(
+            overlaps_data, inside_num, gt_num, lowest, gt_to_anchor_max_data);
+      }
+
+      Tensor fg_flags, bg_flags, fg_candidates, bg_candidates;
+      int* fg_flags_data = fg_flags.mutable_data<int>({inside_num}, place);
+      int* bg_flags_data = bg_flags.mutable_data<int>({inside_num}, place);
+      int* fg_candidates_data =
+          fg_candidates.mutable_data<int>({inside_num}, place);
+      int* bg_candidates_data =
+          bg_candidates.mutable_data<int>({inside_num}, place);
+      FgBgCandidateFlagsKernel<T><<<SampleBlocks(inside_num), kSampleThreads,
+                                    0, stream>>>(
+          overlaps_data, inside_num, gt_num, gt_to_anchor_max_data,
+          anchor_to_gt_max_data, rpn_positive_overlap, rpn_negative_overlap,
+          fg_flags_data, bg_flags_data);
+      SelectFlaggedIndices(dev_ctx, fg_flags_data, inside_num,
+                           fg_candidates_data, counts_data + kFgCandidateNum);
+      SelectFlaggedIndices(dev_ctx, bg_flags_data, inside_num,
+                           bg_candidates_data, counts_data + kBgCandidateNum);
+      copy_counts(kFgCandidateNum, 2);
+
+      // Sample the foregrounds and the backgrounds
+      int fg_fake_num = host_counts[kFgCandidateNum];
+      if (sampling) {
+        int fg_num = static_cast<int>(rpn_fg_fraction * rpn_batch_size_per_im);
+        RandomSampleIndices(dev_ctx, fg_candidates_data, fg_fake_num, fg_num,
+                            use_random, seed, sample_offset++);
+        fg_fake_num = std::min(fg_fake_num, fg_num);
+      }
+      int bg_sampled_num = host_counts[kBgCandidateNum];
+      // No background is dropped if the foregrounds are more than the batch,
+      // the same as ReservoirSampling of a negative number on CPU.
+      if (sampling && rpn_batch_size_per_im >= fg_fake_num) {
+        int bg_num = rpn_batch_size_per_im - fg_fake_num;
+        RandomSampleIndices(dev_ctx, bg_candidates_data, bg_sampled_num,
+                            bg_num, use_random, seed, sample_offset++);
+        bg_sampled_num = std::min(bg_sampled_num, bg_num);
+      }
+
+      Tensor labels;
+      int* labels_data = labels.mutable_data<int>({inside_num}, place);
+      set_int(dev_ctx, &labels, -1);
+      set_int(dev_ctx, &counts, 0);
+      ScatterLabelsKernel<<<SampleBlocks(fg_fake_num), kSampleThreads, 0,
+                            stream>>>(fg_candidates_data, fg_fake_num, 1,
+                                      labels_data);
+      BgLabelsKernel<<<SampleBlocks(bg_sampled_num), kSampleThreads, 0,
+                       stream>>>(bg_candidates_data, bg_sampled_num,
+                                 labels_data, counts_data + kFakeNum);
+      LabelFlagsKernel<<<SampleBlocks(inside_num), kSampleThreads, 0,
+                         stream>>>(labels_data, inside_num, fg_flags_data,
+                                   bg_flags_data);
+      Tensor fg_inds, bg_inds;
+      int* fg_inds_data = fg_inds.mutable_data<int>({inside_num}, place);
+      int* bg_inds_data = bg_inds.mutable_data<int>({inside_num}, place);
+      SelectFlaggedIndices(dev_ctx, fg_flags_data, inside_num, fg_inds_data,
+                           counts_data + kFgNum);
+      SelectFlaggedIndices(dev_ctx, bg_flags_data, inside_num, bg_inds_data,
+                           counts_data + kBgNum);
+      copy_counts(kFakeNum, 3);
+      int fake_num = host_counts[kFakeNum];
+      int fg_num = host_counts[kFgNum];
+      int bg_num = host_counts[kBgNum];
+
+      // Write the targets of the foregrounds and the backgrounds
+      int loc_num = fake_num + fg_num;
+      int score_num = fg_num + bg_num;
+      PADDLE_ENFORCE_LE(total_loc_num + loc_num, max_num);
+      PADDLE_ENFORCE_LE(total_score_num + score_num, max_num);
+      int anchor_offset = i * anchor_num;
+      LocationTargetsKernel<T><<<SampleBlocks(loc_num), kSampleThreads, 0,
+                                 stream>>>(
+          anchor->data<T>(), inds_inside_data, ncrowd_gt_boxes_data,
+          argmax_data, fg_candidates_data, fg_inds_data, fake_num, loc_num,
+          anchor_offset, loc_index_data + total_loc_num,
+          tgt_bbox_data + total_loc_num * 4,
+          bbox_inside_weight_data + total_loc_num * 4);
+      ScoreTargetsKernel<<<SampleBlocks(score_num), kSampleThreads, 0,
+                           stream>>>(
+          inds_inside_data, fg_inds_data, fg_num, bg_inds_data, score_num,
+          anchor_offset, score_index_data + total_score_num,
+          tgt_lbl_data + total_score_num);
+
+      total_loc_num += loc_num;
+      total_score_num += score_num;
+      lod0_loc.emplace_back(total_loc_num);
+      lod0_score.emplace_back(total_score_num);
+    }
+
+    framework::LoD lod_loc, loc_score;
+    lod_loc.emplace_back(lod0_loc);
+    loc_score.emplace_back(lod0_score);
+    loc_index->set_lod(lod_loc);
+    score_index->set_lod(loc_score);
+    tgt_bbox->set_lod(lod_loc);
+    tgt_lbl->set_lod(loc_score);
+    bbox_inside_weight->set_lod(lod_loc);
+    loc_index->Resize({total_loc_num});
+    score_index->Resize({total_score_num});
+    tgt_bbox->Resize({total_loc_num, 4});
+    tgt_lbl->Resize({total_score_num, 1});
+    bbox_inside_weight->Resize({total_loc_num, 4});
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(rpn_target_assign,
+                        ops::RpnTargetAssignCUDAKernel<float>,
+                        ops::RpnTargetAssignCUDAKernel<double>);
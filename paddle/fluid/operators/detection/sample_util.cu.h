@@ -0,0 +1,113 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <curand_kernel.h>
+#include <algorithm>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+
+constexpr int kSampleThreads = 256;
+constexpr int kSampleMaxBlocks = 4096;
+
+inline int SampleBlocks(int n) {
+  return std::max(1, std::min((n + kSampleThreads - 1) / kSampleThreads,
+                              kSampleMaxBlocks));
+}
+
+/*
+ * \brief Select the indices i in [0, n) of flags[i] != 0 into indices in the
+ * ascending order, whose number is written to num_selected on device.
+ */
+inline void SelectFlaggedIndices(const platform::CUDADeviceContext& dev_ctx,
+                                 const int* flags, int n, int* indices,
+                                 int* num_selected) {
+  cub::CountingInputIterator<int> counting_iter(0);
+  size_t temp_storage_bytes = 0;
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cub::DeviceSelect::Flagged(nullptr, temp_storage_bytes, counting_iter,
+                                 flags, indices, num_selected, n,
+                                 dev_ctx.stream()),
+      "Failed to calculate temp_storage_bytes of cub::DeviceSelect::Flagged.");
+  framework::Tensor temp_storage;
+  temp_storage.mutable_data<uint8_t>(dev_ctx.GetPlace(), temp_storage_bytes);
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cub::DeviceSelect::Flagged(temp_storage.data<uint8_t>(),
+                                 temp_storage_bytes, counting_iter, flags,
+                                 indices, num_selected, n, dev_ctx.stream()),
+      "Failed to launch cub::DeviceSelect::Flagged.");
+}
+
+static __global__ void RandomSampleKeysKernel(int n, uint64_t seed,
+                                              uint64_t offset, float* keys) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    curandStatePhilox4_32_10_t state;
+    curand_init(seed, i, offset, &state);
+    keys[i] = curand_uniform(&state);
+  }
+}
+
+/*
+ * \brief Move a uniformly random subset of num elements of indices[0, n) to
+ * indices[0, num) if n > num, in a random order. Nothing is changed if n <=
+ * num or not use_random, so the first num ones are sampled as the
+ * ReservoirSampling on CPU without use_random.
+ *
+ * Each element gets a random key of the Philox generator of the subsequence
+ * of its position, where offset should be different for each sampling of the
+ * same seed, and the elements of the smallest keys are sampled.
+ */
+inline void RandomSampleIndices(const platform::CUDADeviceContext& dev_ctx,
+                                int* indices, int n, int num, bool use_random,
+                                uint64_t seed, uint64_t offset) {
+  if (!use_random || n <= num) return;
+  framework::Tensor keys, sorted_keys, sorted_indices;
+  float* keys_data = keys.mutable_data<float>({n}, dev_ctx.GetPlace());
+  float* sorted_keys_data =
+      sorted_keys.mutable_data<float>({n}, dev_ctx.GetPlace());
+  int* sorted_indices_data =
+      sorted_indices.mutable_data<int>({n}, dev_ctx.GetPlace());
+  RandomSampleKeysKernel<<<SampleBlocks(n), kSampleThreads, 0,
+                           dev_ctx.stream()>>>(n, seed, offset, keys_data);
+
+  size_t temp_storage_bytes = 0;
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cub::DeviceRadixSort::SortPairs(nullptr, temp_storage_bytes, keys_data,
+                                      sorted_keys_data, indices,
+                                      sorted_indices_data, n, 0,
+                                      sizeof(float) * 8, dev_ctx.stream()),
+      "Failed to calculate temp_storage_bytes of "
+      "cub::DeviceRadixSort::SortPairs.");
+  framework::Tensor temp_storage;
+  temp_storage.mutable_data<uint8_t>(dev_ctx.GetPlace(), temp_storage_bytes);
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cub::DeviceRadixSort::SortPairs(
+          temp_storage.data<uint8_t>(), temp_storage_bytes, keys_data,
+          sorted_keys_data, indices, sorted_indices_data, n, 0,
+          sizeof(float) * 8, dev_ctx.stream()),
+      "Failed to launch cub::DeviceRadixSort::SortPairs.");
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaMemcpyAsync(indices, sorted_indices_data, sizeof(int) * num,
+                      cudaMemcpyDeviceToDevice, dev_ctx.stream()),
+      "Failed to copy the sampled indices.");
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,117 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/adaptive_send_tuner.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+AdaptiveSendTuner::AdaptiveSendTuner(int max_merge_num, int max_concurrency)
+    : max_merge_num_(max_merge_num),
+      max_concurrency_(max_concurrency),
+      merge_num_(max_merge_num),
+      concurrency_(max_concurrency) {
+  PADDLE_ENFORCE_GT(max_merge_num_, 0,
+                    platform::errors::InvalidArgument(
+                        "The max number of the merged gradients should be "
+                        "positive, but got %d.",
+                        max_merge_num_));
+  PADDLE_ENFORCE_GT(max_concurrency_, 0,
+                    platform::errors::InvalidArgument(
+                        "The max number of the concurrent sends should be "
+                        "positive, but got %d.",
+                        max_concurrency_));
+  stats_ = Stats{merge_num_, concurrency_, 0, 0, 0, 0, 0, 0};
+}
+
+int AdaptiveSendTuner::MergeNum() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return merge_num_;
+}
+
+int AdaptiveSendTuner::Concurrency() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return concurrency_;
+}
+
+void AdaptiveSendTuner::RecordSend(int merged_num, int64_t bytes,
+                                   int64_t latency_us) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++round_send_num_;
+  round_merged_num_ += merged_num;
+  round_bytes_ += bytes;
+  round_latency_us_ += latency_us;
+  ++stats_.send_num;
+  stats_.send_bytes += bytes;
+}
+
+void AdaptiveSendTuner::Tune(double queue_depth_ratio, int64_t round_us) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  stats_.queue_depth_ratio = queue_depth_ratio;
+  if (round_send_num_ == 0) {
+    return;
+  }
+  double avg_merged_num =
+      static_cast<double>(round_merged_num_) / round_send_num_;
+  double bytes_per_sec =
+      round_us > 0 ? round_bytes_ * 1e6 / round_us : last_bytes_per_sec_;
+
+  if (queue_depth_ratio >= kBackedUpRatio) {
+    merge_num_ = std::min(merge_num_ * 2, max_merge_num_);
+  } else if (avg_merged_num < merge_num_) {
+    // the sends stopped merging to wait for the gradients
+    merge_num_ = std::max(static_cast<int>(std::ceil(avg_merged_num)), 1);
+  }
+
+  if (last_bytes_per_sec_ > 0) {
+    double change = (bytes_per_sec - last_bytes_per_sec_) / last_bytes_per_sec_;
+    if (change < -kBandwidthTolerance) {
+      concurrency_step_ = -concurrency_step_;
+    }
+    if (std::fabs(change) > kBandwidthTolerance) {
+      concurrency_ = std::min(std::max(concurrency_ + concurrency_step_, 1),
+                              max_concurrency_);
+    }
+  } else {
+    concurrency_ = std::max(concurrency_ + concurrency_step_, 1);
+  }
+  last_bytes_per_sec_ = bytes_per_sec;
+
+  stats_.merge_num = merge_num_;
+  stats_.concurrency = concurrency_;
+  stats_.avg_merged_num = avg_merged_num;
+  stats_.avg_latency_us =
+      static_cast<double>(round_latency_us_) / round_send_num_;
+  stats_.bytes_per_sec = bytes_per_sec;
+
+  round_send_num_ = 0;
+  round_merged_num_ = 0;
+  round_bytes_ = 0;
+  round_latency_us_ = 0;
+}
+
+AdaptiveSendTuner::Stats AdaptiveSendTuner::GetStats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
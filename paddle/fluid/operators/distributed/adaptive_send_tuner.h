@@ -0,0 +1,86 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Tune the number of the gradients merged into one send and the number of
+// the vars sent at the same time by the AsyncCommunicator, from the queue
+// depth, the rpc latency and the bandwidth measured in each send round.
+//
+// The merge number is doubled while the queues are backed up, so that the
+// gradients are sent by fewer and bigger rpcs, and is lowered to what the
+// sends really merge while they wait for the gradients, so that the
+// gradients are not held back. The concurrency climbs towards the bandwidth:
+// it keeps moving in the same direction while the bandwidth of the rounds
+// grows, and turns back when it drops.
+class AdaptiveSendTuner {
+ public:
+  struct Stats {
+    int merge_num;
+    int concurrency;
+    double queue_depth_ratio;
+    double avg_merged_num;
+    double avg_latency_us;
+    double bytes_per_sec;
+    int64_t send_num;
+    int64_t send_bytes;
+  };
+
+  AdaptiveSendTuner(int max_merge_num, int max_concurrency);
+
+  int MergeNum() const;
+  int Concurrency() const;
+
+  // Record a send of merged_num gradients taking latency_us.
+  void RecordSend(int merged_num, int64_t bytes, int64_t latency_us);
+
+  // Tune by the sends recorded in the round, queue_depth_ratio is the max
+  // fill ratio of the send queues at the beginning of the round.
+  void Tune(double queue_depth_ratio, int64_t round_us);
+
+  Stats GetStats() const;
+
+ private:
+  // the relative change of the bandwidth taken as noise
+  static constexpr double kBandwidthTolerance = 0.05;
+  static constexpr double kBackedUpRatio = 0.5;
+
+  const int max_merge_num_;
+  const int max_concurrency_;
+
+  mutable std::mutex mutex_;
+  int merge_num_;
+  int concurrency_;
+  int concurrency_step_ = -1;
+  double last_bytes_per_sec_ = 0;
+
+  // the sends of the current round
+  int64_t round_send_num_ = 0;
+  int64_t round_merged_num_ = 0;
+  int64_t round_bytes_ = 0;
+  int64_t round_latency_us_ = 0;
+
+  Stats stats_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
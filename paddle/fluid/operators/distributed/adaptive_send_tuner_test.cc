@@ -0,0 +1,88 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/adaptive_send_tuner.h"
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(AdaptiveSendTuner, MergeNum) {
+  AdaptiveSendTuner tuner(16, 4);
+  EXPECT_EQ(tuner.MergeNum(), 16);
+
+  // the sends wait for the gradients
+  tuner.RecordSend(3, 1000, 100);
+  tuner.RecordSend(2, 1000, 100);
+  tuner.Tune(0, 1000);
+  EXPECT_EQ(tuner.MergeNum(), 3);
+
+  // the queues are backed up
+  tuner.RecordSend(3, 1000, 100);
+  tuner.Tune(0.75, 1000);
+  EXPECT_EQ(tuner.MergeNum(), 6);
+  tuner.RecordSend(6, 1000, 100);
+  tuner.Tune(1, 1000);
+  tuner.RecordSend(12, 1000, 100);
+  tuner.Tune(1, 1000);
+  EXPECT_EQ(tuner.MergeNum(), 16);
+
+  // nothing is tuned without sends
+  tuner.Tune(0, 1000);
+  EXPECT_EQ(tuner.MergeNum(), 16);
+
+  auto stats = tuner.GetStats();
+  EXPECT_EQ(stats.send_num, 5);
+  EXPECT_EQ(stats.send_bytes, 5000);
+  EXPECT_DOUBLE_EQ(stats.avg_merged_num, 12);
+  EXPECT_DOUBLE_EQ(stats.avg_latency_us, 100);
+  EXPECT_DOUBLE_EQ(stats.bytes_per_sec, 1e6);
+}
+
+TEST(AdaptiveSendTuner, Concurrency) {
+  AdaptiveSendTuner tuner(1, 4);
+  EXPECT_EQ(tuner.Concurrency(), 4);
+
+  // the first round probes a lower concurrency
+  tuner.RecordSend(1, 1000, 100);
+  tuner.Tune(0, 1000);
+  EXPECT_EQ(tuner.Concurrency(), 3);
+
+  // keep going while the bandwidth grows
+  tuner.RecordSend(1, 2000, 100);
+  tuner.Tune(0, 1000);
+  EXPECT_EQ(tuner.Concurrency(), 2);
+
+  // turn back when it drops
+  tuner.RecordSend(1, 1000, 100);
+  tuner.Tune(0, 1000);
+  EXPECT_EQ(tuner.Concurrency(), 3);
+
+  // stay while it is flat
+  tuner.RecordSend(1, 1010, 100);
+  tuner.Tune(0, 1000);
+  EXPECT_EQ(tuner.Concurrency(), 3);
+
+  tuner.RecordSend(1, 2000, 100);
+  tuner.Tune(0, 1000);
+  tuner.RecordSend(1, 4000, 100);
+  tuner.Tune(0, 1000);
+  EXPECT_EQ(tuner.Concurrency(), 4);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
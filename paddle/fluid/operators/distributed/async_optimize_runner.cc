@@ -0,0 +1,274 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/async_optimize_runner.h"
+
+#include <algorithm>
+#include <future>  // NOLINT
+#include <unordered_set>
+#include <utility>
+
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The ops computing each row of their outputs from the same rows of their
+// inputs, so that a block of them can be run on the row ranges.
+static const std::unordered_set<std::string> kRowwiseOps = {
+    "sgd",      "momentum", "adam", "adamax", "adagrad", "decayed_adagrad",
+    "adadelta", "rmsprop",  "ftrl", "scale",  "sum",     "assign"};
+
+AsyncOptimizeRunner::AsyncOptimizeRunner(
+    framework::Executor* executor, framework::Scope* scope,
+    std::unordered_map<std::string,
+                       std::shared_ptr<framework::ExecutorPrepareContext>>*
+        grad_to_prepared_ctx,
+    int num_threads, int64_t min_shard_numel)
+    : executor_(executor),
+      scope_(scope),
+      grad_to_prepared_ctx_(grad_to_prepared_ctx),
+      num_threads_(num_threads),
+      min_shard_numel_(min_shard_numel) {
+  PADDLE_ENFORCE_NOT_NULL(executor_, platform::errors::InvalidArgument(
+                                         "The executor should not be null."));
+  PADDLE_ENFORCE_NOT_NULL(scope_, platform::errors::InvalidArgument(
+                                      "The scope should not be null."));
+  PADDLE_ENFORCE_NOT_NULL(
+      grad_to_prepared_ctx_,
+      platform::errors::InvalidArgument(
+          "The prepared contexts of the gradients should not be null."));
+  PADDLE_ENFORCE_GT(num_threads_, 0,
+                    platform::errors::InvalidArgument(
+                        "The number of the threads to run the optimize "
+                        "blocks should be positive, but got %d.",
+                        num_threads_));
+
+  for (auto& grad_and_ctx : *grad_to_prepared_ctx_) {
+    auto* queue = new GradQueue();
+    queue->scope = &scope_->NewScope();
+    queue->shardable = true;
+    for (auto& op : grad_and_ctx.second->ops_) {
+      if (kRowwiseOps.count(op->Type()) == 0) {
+        queue->shardable = false;
+        break;
+      }
+    }
+    VLOG(3) << "the optimize block of " << grad_and_ctx.first
+            << (queue->shardable ? " can" : " can not")
+            << " be run on the row ranges";
+    queues_[grad_and_ctx.first].reset(queue);
+  }
+
+  update_pool_.reset(new framework::ThreadPool(num_threads_));
+  shard_pool_.reset(new framework::ThreadPool(num_threads_));
+}
+
+AsyncOptimizeRunner::~AsyncOptimizeRunner() {
+  Wait();
+  update_pool_.reset();
+  shard_pool_.reset();
+  for (auto& grad_and_queue : queues_) {
+    scope_->DeleteScope(grad_and_queue.second->scope);
+  }
+}
+
+bool AsyncOptimizeRunner::Push(const std::string& var_name,
+                               framework::Scope* request_scope) {
+  auto it = queues_.find(var_name);
+  if (it == queues_.end()) return false;
+  auto* var = request_scope->FindVar(var_name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) return false;
+  auto& grad = var->Get<framework::LoDTensor>();
+  if (!grad.IsInitialized() || !platform::is_cpu_place(grad.place()) ||
+      grad.type() != framework::proto::VarType::FP32) {
+    return false;
+  }
+
+  auto* queue = it->second.get();
+  {
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    if (queue->pending_num == 0) {
+      // the received tensor is not used by the request any more
+      queue->pending.ShareDataWith(grad);
+    } else {
+      PADDLE_ENFORCE_EQ(
+          queue->pending.dims(), grad.dims(),
+          platform::errors::InvalidArgument(
+              "The gradients of %s should have the same shape, but got [%s] "
+              "and [%s].",
+              var_name, queue->pending.dims(), grad.dims()));
+      auto& dev_ctx = *platform::DeviceContextPool::Instance()
+                           .GetByPlace(platform::CPUPlace());
+      auto blas = math::GetBlas<platform::CPUDeviceContext, float>(dev_ctx);
+      blas.AXPY(grad.numel(), 1.f, grad.data<float>(),
+                queue->pending.data<float>());
+    }
+    ++queue->pending_num;
+    if (queue->running) return true;
+    queue->running = true;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++running_num_;
+  }
+  update_pool_->RunAndGetException(
+      [this, var_name, queue] { RunUpdates(var_name, queue); });
+  return true;
+}
+
+void AsyncOptimizeRunner::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return running_num_ == 0; });
+}
+
+void AsyncOptimizeRunner::RunUpdates(const std::string& var_name,
+                                     GradQueue* queue) {
+  auto* grad =
+      queue->scope->Var(var_name)->GetMutable<framework::LoDTensor>();
+  while (true) {
+    {
+      std::lock_guard<std::mutex> guard(queue->mutex);
+      if (queue->pending_num == 0) {
+        queue->running = false;
+        break;
+      }
+      VLOG(4) << "apply " << queue->pending_num << " gradients of "
+              << var_name;
+      grad->ShareDataWith(queue->pending);
+      queue->pending = framework::LoDTensor();
+      queue->pending_num = 0;
+    }
+    try {
+      RunBlock(var_name, queue);
+    } catch (platform::EnforceNotMet& e) {
+      LOG(ERROR) << "fail to run the optimize block of " << var_name << ": "
+                 << e.what();
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    --running_num_;
+  }
+  cv_.notify_all();
+}
+
+void AsyncOptimizeRunner::RunBlock(const std::string& var_name,
+                                   GradQueue* queue) {
+  auto* ctx = grad_to_prepared_ctx_->at(var_name).get();
+  auto& grad = queue->scope->FindVar(var_name)->Get<framework::LoDTensor>();
+  int64_t shard_num = 1;
+  if (queue->shardable && min_shard_numel_ > 0 && grad.dims().size() > 0) {
+    shard_num = std::min({static_cast<int64_t>(num_threads_),
+                          grad.numel() / min_shard_numel_, grad.dims()[0]});
+  }
+  if (shard_num <= 1 || !BindShards(var_name, queue, shard_num)) {
+    executor_->RunPreparedContext(ctx, queue->scope);
+    return;
+  }
+
+  std::vector<std::future<std::unique_ptr<platform::EnforceNotMet>>> fs;
+  for (int64_t i = 0; i < shard_num; ++i) {
+    fs.emplace_back(shard_pool_->RunAndGetException([this, queue, i] {
+      executor_->RunPreparedContext(queue->shard_ctxs[i].get(),
+                                    queue->shard_scopes[i]);
+    }));
+  }
+  std::unique_ptr<platform::EnforceNotMet> ex;
+  for (auto& f : fs) {
+    auto shard_ex = f.get();
+    if (shard_ex != nullptr && ex == nullptr) {
+      ex = std::move(shard_ex);
+    }
+  }
+  if (ex != nullptr) {
+    throw *ex;
+  }
+}
+
+bool AsyncOptimizeRunner::BindShards(const std::string& var_name,
+                                     GradQueue* queue, size_t shard_num) {
+  auto* ctx = grad_to_prepared_ctx_->at(var_name).get();
+  std::unordered_set<std::string> names;
+  for (auto& op : ctx->ops_) {
+    for (auto& name : op->InputVars()) {
+      names.insert(name);
+    }
+    for (auto& name : op->OutputVars(true)) {
+      names.insert(name);
+    }
+  }
+  names.erase(framework::kEmptyVarName);
+  for (auto& name : names) {
+    auto* var = queue->scope->FindVar(name);
+    if (var != nullptr && var->IsInitialized() &&
+        !var->IsType<framework::LoDTensor>()) {
+      VLOG(3) << "run the optimize block of " << var_name
+              << " as a whole for the var " << name;
+      return false;
+    }
+  }
+
+  while (queue->shard_ctxs.size() < shard_num) {
+    queue->shard_ctxs.emplace_back(
+        framework::Executor::Prepare(ctx->prog_, ctx->block_id_));
+    queue->shard_scopes.push_back(&queue->scope->NewScope());
+  }
+
+  auto& grad = queue->scope->FindVar(var_name)->Get<framework::LoDTensor>();
+  int64_t rows = grad.dims()[0];
+  for (auto& name : names) {
+    // the vars not found are created by the block in the local scopes
+    auto* var = queue->scope->FindVar(name);
+    if (var == nullptr) continue;
+    if (!var->IsInitialized() ||
+        !var->Get<framework::LoDTensor>().IsInitialized()) {
+      // the outputs are written by each range into its own var
+      for (size_t i = 1; i < shard_num; ++i) {
+        queue->shard_scopes[i]->Var(name)->GetMutable<framework::LoDTensor>();
+      }
+      continue;
+    }
+    auto& tensor = var->Get<framework::LoDTensor>();
+    if (tensor.dims() == grad.dims()) {
+      for (size_t i = 0; i < shard_num; ++i) {
+        int64_t begin = rows * i / shard_num;
+        int64_t end = rows * (i + 1) / shard_num;
+        queue->shard_scopes[i]
+            ->Var(name)
+            ->GetMutable<framework::LoDTensor>()
+            ->ShareDataWith(tensor.Slice(begin, end));
+      }
+    } else {
+      for (size_t i = 1; i < shard_num; ++i) {
+        auto* shard_var = queue->shard_scopes[i]->Var(name);
+        framework::TensorCopySync(
+            tensor, tensor.place(),
+            shard_var->GetMutable<framework::LoDTensor>());
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
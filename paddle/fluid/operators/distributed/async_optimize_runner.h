@@ -0,0 +1,107 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/threadpool.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Run the optimize blocks of the async pserver in a thread pool, instead of
+// on the rpc threads receiving the gradients.
+//
+// The dense gradients of a var received while its block is running are
+// summed and applied by one more run, so a block never runs concurrently
+// with itself and the rpc threads return right away. The sum is the same
+// update as the successive runs for sgd.
+//
+// The block of a large gradient is run on the row ranges of its vars in
+// parallel, if all of its ops are elementwise. The vars of the shape of the
+// gradient are sliced, and the other ones, e.g. the learning rate and the
+// beta pows of adam, are updated by the first range only.
+class AsyncOptimizeRunner {
+ public:
+  AsyncOptimizeRunner(
+      framework::Executor* executor, framework::Scope* scope,
+      std::unordered_map<std::string,
+                         std::shared_ptr<framework::ExecutorPrepareContext>>*
+          grad_to_prepared_ctx,
+      int num_threads, int64_t min_shard_numel);
+
+  // Wait for the pending gradients to be applied.
+  ~AsyncOptimizeRunner();
+
+  // Queue the gradient var_name in request_scope to be applied, or return
+  // false if it should be applied by the caller, i.e. it is not a dense
+  // float gradient on CPU.
+  bool Push(const std::string& var_name, framework::Scope* request_scope);
+
+  void Wait();
+
+ private:
+  struct GradQueue {
+    std::mutex mutex;
+    // the sum of the gradients received since the last run
+    framework::LoDTensor pending;
+    size_t pending_num{0};
+    bool running{false};
+    bool shardable{false};
+    // the scope holding the gradient being applied
+    framework::Scope* scope{nullptr};
+    // the contexts and scopes to run the block on the row ranges
+    std::vector<std::unique_ptr<framework::ExecutorPrepareContext>>
+        shard_ctxs;
+    std::vector<framework::Scope*> shard_scopes;
+  };
+
+  void RunUpdates(const std::string& var_name, GradQueue* queue);
+  void RunBlock(const std::string& var_name, GradQueue* queue);
+  bool BindShards(const std::string& var_name, GradQueue* queue,
+                  size_t shard_num);
+
+  framework::Executor* executor_;
+  framework::Scope* scope_;
+  std::unordered_map<std::string,
+                     std::shared_ptr<framework::ExecutorPrepareContext>>*
+      grad_to_prepared_ctx_;
+  int num_threads_;
+  int64_t min_shard_numel_;
+
+  std::unordered_map<std::string, std::unique_ptr<GradQueue>> queues_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t running_num_{0};
+
+  std::unique_ptr<framework::ThreadPool> update_pool_;
+  // the ranges are run in another pool, which the updates wait for
+  std::unique_ptr<framework::ThreadPool> shard_pool_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
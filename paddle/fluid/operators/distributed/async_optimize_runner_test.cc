@@ -0,0 +1,145 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/async_optimize_runner.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace distributed = paddle::operators::distributed;
+
+USE_OP(sgd);
+USE_OP(scale);
+
+constexpr int64_t kRows = 8;
+constexpr int64_t kCols = 4;
+
+// Block 1 updates w by sgd and doubles the counter.
+void BuildProgram(framework::ProgramDesc* program) {
+  auto* root_block = program->MutableBlock(0);
+  for (auto name : {"w", "w@GRAD", "lr", "counter"}) {
+    auto* var = root_block->Var(name);
+    var->SetType(framework::proto::VarType::LOD_TENSOR);
+    var->SetPersistable(std::string(name) != "w@GRAD");
+  }
+
+  auto* block = program->AppendBlock(*root_block);
+  auto* sgd = block->AppendOp();
+  sgd->SetType("sgd");
+  sgd->SetInput("Param", {"w"});
+  sgd->SetInput("Grad", {"w@GRAD"});
+  sgd->SetInput("LearningRate", {"lr"});
+  sgd->SetOutput("ParamOut", {"w"});
+
+  auto* scale = block->AppendOp();
+  scale->SetType("scale");
+  scale->SetInput("X", {"counter"});
+  scale->SetOutput("Out", {"counter"});
+  scale->SetAttr("scale", 2.f);
+}
+
+void FillTensor(framework::Variable* var, framework::DDim dims,
+                float value) {
+  auto* tensor = var->GetMutable<framework::LoDTensor>();
+  auto* data = tensor->mutable_data<float>(dims, platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = value;
+  }
+}
+
+void PushGrad(distributed::AsyncOptimizeRunner* runner,
+              framework::Scope* scope, float value) {
+  auto& request_scope = scope->NewScope();
+  FillTensor(request_scope.Var("w@GRAD"), {kRows, kCols}, value);
+  EXPECT_TRUE(runner->Push("w@GRAD", &request_scope));
+  scope->DeleteScope(&request_scope);
+}
+
+TEST(AsyncOptimizeRunner, RunOnRowRanges) {
+  framework::ProgramDesc program;
+  BuildProgram(&program);
+  framework::Scope scope;
+  FillTensor(scope.Var("w"), {kRows, kCols}, 10.f);
+  FillTensor(scope.Var("lr"), {1}, 0.5f);
+  FillTensor(scope.Var("counter"), {1}, 1.f);
+
+  platform::CPUPlace place;
+  framework::Executor executor(place);
+  std::unordered_map<std::string,
+                     std::shared_ptr<framework::ExecutorPrepareContext>>
+      grad_to_prepared_ctx;
+  grad_to_prepared_ctx["w@GRAD"] = executor.Prepare(program, 1);
+
+  // 4 ranges of 2 rows
+  distributed::AsyncOptimizeRunner runner(&executor, &scope,
+                                          &grad_to_prepared_ctx, 4, 8);
+  PushGrad(&runner, &scope, 2.f);
+  runner.Wait();
+  const auto& w = scope.FindVar("w")->Get<framework::LoDTensor>();
+  for (int64_t i = 0; i < w.numel(); ++i) {
+    EXPECT_FLOAT_EQ(w.data<float>()[i], 9.f);
+  }
+  // the vars not sliced are updated by one range
+  EXPECT_FLOAT_EQ(
+      scope.FindVar("counter")->Get<framework::LoDTensor>().data<float>()[0],
+      2.f);
+
+  // the gradients queued are summed
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 5; ++j) {
+        PushGrad(&runner, &scope, 1.f);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  runner.Wait();
+  for (int64_t i = 0; i < w.numel(); ++i) {
+    EXPECT_FLOAT_EQ(w.data<float>()[i], -1.f);
+  }
+}
+
+TEST(AsyncOptimizeRunner, PushUnsupportedGrad) {
+  framework::ProgramDesc program;
+  BuildProgram(&program);
+  framework::Scope scope;
+  platform::CPUPlace place;
+  framework::Executor executor(place);
+  std::unordered_map<std::string,
+                     std::shared_ptr<framework::ExecutorPrepareContext>>
+      grad_to_prepared_ctx;
+  grad_to_prepared_ctx["w@GRAD"] = executor.Prepare(program, 1);
+  distributed::AsyncOptimizeRunner runner(&executor, &scope,
+                                          &grad_to_prepared_ctx, 2, 1024);
+
+  auto& request_scope = scope.NewScope();
+  request_scope.Var("w@GRAD")->GetMutable<framework::SelectedRows>();
+  FillTensor(request_scope.Var("b@GRAD"), {kRows}, 1.f);
+  EXPECT_FALSE(runner.Push("w@GRAD", &request_scope));
+  EXPECT_FALSE(runner.Push("b@GRAD", &request_scope));
+  scope.DeleteScope(&request_scope);
+}
@@ -443,9 +443,10 @@ VarHandlePtr BRPCClient::AsyncSendMessage(const std::string& ep,
 
 VarHandlePtr BRPCClient::AsyncCheckpointNotify(const std::string& ep,
                                                const std::string& dir,
-                                               int64_t time_out) {
+                                               bool delta, int64_t time_out) {
   sendrecv::VariableMessage req;
-  req.set_varname(CHECKPOINT_SAVE_MESSAGE);
+  req.set_varname(delta ? CHECKPOINT_DELTA_SAVE_MESSAGE
+                        : CHECKPOINT_SAVE_MESSAGE);
   req.set_out_varname(dir);
 
   return AsyncSendVarMessage(ep, "CheckPointNotifyRPC", req, time_out);
@@ -102,7 +102,7 @@ class BRPCClient : public RPCClient {
       const std::string& ep, int64_t time_out = FLAGS_rpc_deadline) override;
 
   VarHandlePtr AsyncCheckpointNotify(
-      const std::string& ep, const std::string& dir,
+      const std::string& ep, const std::string& dir, bool delta = false,
       int64_t time_out = FLAGS_rpc_deadline) override;
 
   bool Wait() override;
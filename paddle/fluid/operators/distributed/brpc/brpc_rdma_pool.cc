@@ -15,6 +15,7 @@
 #ifdef PADDLE_WITH_BRPC_RDMA
 
 #include "paddle/fluid/operators/distributed/brpc/brpc_rdma_pool.h"
+#include <utility>
 #include "brpc/channel.h"
 #include "brpc/rdma/rdma_helper.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -23,6 +24,18 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+RdmaMemPool::RdmaMemPool()
+    : RdmaMemPool(
+          [](void* data, size_t size) {
+            return brpc::rdma::RegisterMemoryForRdma(data, size);
+          },
+          [](void* data) { brpc::rdma::DeregisterMemoryForRdma(data); }) {}
+
+RdmaMemPool::RdmaMemPool(RegisterFn register_fn, DeregisterFn deregister_fn)
+    : register_fn_(std::move(register_fn)),
+      deregister_fn_(std::move(deregister_fn)),
+      access_(PTHREAD_RWLOCK_INITIALIZER) {}
+
 RdmaMemPool& RdmaMemPool::Instance() {
   static RdmaMemPool* g_rdma_mem_pool = new RdmaMemPool();
   return *g_rdma_mem_pool;
@@ -50,25 +63,54 @@ void* RdmaMemPool::Find(const std::string& varname, int64_t size) {
 
 void RdmaMemPool::Register(const std::string& varname, void* data,
                            int64_t data_size) {
-  void* old = Find(varname, data_size);
-  if (old != nullptr) {
-    if (data != old) {
-      PADDLE_ENFORCE(false, "var:%s data:%ld != %ld", varname, data, old);
-    }
+  pthread_rwlock_rdlock(&access_);
+  auto it = pool_.find(varname);
+  bool registered = it != pool_.end() && it->second.data == data &&
+                    it->second.data_size == data_size;
+  pthread_rwlock_unlock(&access_);
+  if (registered) {
     VLOG(7) << "Find on rdma:" << varname << " data:" << data
             << " data_size:" << data_size;
     return;
   }
 
-  VarInfo info;
+  pthread_rwlock_wrlock(&access_);
+  // The buffer of the var is moved, e.g. the tensor is resized. The old
+  // buffer is deregistered now, or after the payloads in flight sending it.
+  auto& info = pool_[varname];
+  if (info.data != nullptr) {
+    auto old = regions_.find(info.data);
+    if (old != regions_.end()) {
+      --old->second.owners;
+      MaybeDeregister(info.data);
+    }
+  }
   info.data = data;
   info.data_size = data_size;
 
-  pthread_rwlock_wrlock(&access_);
-  pool_[varname] = info;
+  auto& region = regions_[data];
+  if (region.owners > 0 || region.inflight > 0) {
+    // shared with another var, or still in flight
+    int64_t registered_size = region.size;
+    if (registered_size == data_size) {
+      ++region.owners;
+    } else {
+      info.data = nullptr;
+      info.data_size = 0;
+    }
+    pthread_rwlock_unlock(&access_);
+    PADDLE_ENFORCE_EQ(registered_size, data_size,
+                      platform::errors::AlreadyExists(
+                          "The rdma buffer %p of var %s is registered with "
+                          "%d bytes, but got %d bytes.",
+                          data, varname, registered_size, data_size));
+    return;
+  }
+  region.size = data_size;
+  region.owners = 1;
+  int ret = register_fn_(data, data_size);
   pthread_rwlock_unlock(&access_);
-
-  if (brpc::rdma::RegisterMemoryForRdma(data, data_size)) {
+  if (ret != 0) {
     LOG(FATAL) << "register " << varname << " data:" << data
                << " data_size:" << data_size << " error";
   }
@@ -77,6 +119,48 @@ void RdmaMemPool::Register(const std::string& varname, void* data,
           << " data_size:" << data_size;
 }
 
+void RdmaMemPool::Acquire(void* data) {
+  pthread_rwlock_wrlock(&access_);
+  auto it = regions_.find(data);
+  bool found = it != regions_.end();
+  if (found) {
+    ++it->second.inflight;
+  }
+  pthread_rwlock_unlock(&access_);
+  PADDLE_ENFORCE_EQ(found, true,
+                    platform::errors::NotFound(
+                        "The rdma buffer %p is not registered.", data));
+}
+
+void RdmaMemPool::Release(void* data) {
+  pthread_rwlock_wrlock(&access_);
+  auto it = regions_.find(data);
+  if (it != regions_.end() && it->second.inflight > 0) {
+    --it->second.inflight;
+    MaybeDeregister(data);
+  }
+  pthread_rwlock_unlock(&access_);
+}
+
+size_t RdmaMemPool::RegisteredNum() {
+  pthread_rwlock_rdlock(&access_);
+  size_t num = regions_.size();
+  pthread_rwlock_unlock(&access_);
+  return num;
+}
+
+void RdmaMemPool::MaybeDeregister(void* data) {
+  auto it = regions_.find(data);
+  if (it == regions_.end() || it->second.owners > 0 ||
+      it->second.inflight > 0) {
+    return;
+  }
+  VLOG(4) << "deregister on rdma data:" << data
+          << " data_size:" << it->second.size;
+  regions_.erase(it);
+  deregister_fn_(data);
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
@@ -16,6 +16,7 @@
 #ifdef PADDLE_WITH_BRPC_RDMA
 
 #include <pthread.h>  // NOLINT
+#include <functional>
 #include <string>
 #include <unordered_map>
 
@@ -25,17 +26,37 @@ namespace distributed {
 
 /*
  * This class is used to avoid duplicated registion of brpc::rdma.
+ *
+ * The buffer of a var is registered once, and kept registered while it is
+ * the buffer of the var. When the buffer of the var moves, e.g. the tensor
+ * is resized or the pinned staging buffer is reallocated, the old buffer is
+ * deregistered once the payloads sending it are released, so that the
+ * registrations do not grow, and the freed memory is not left registered
+ * to be registered again when it is allocated for another buffer.
  */
 class RdmaMemPool {
  public:
+  using RegisterFn = std::function<int(void*, size_t)>;
+  using DeregisterFn = std::function<void(void*)>;
+
   static RdmaMemPool& Instance();
-  RdmaMemPool() : access_(PTHREAD_RWLOCK_INITIALIZER) {}
+  RdmaMemPool();
+  // the registration functions of brpc::rdma can be replaced in the tests
+  RdmaMemPool(RegisterFn register_fn, DeregisterFn deregister_fn);
 
   virtual ~RdmaMemPool() { pthread_rwlock_destroy(&access_); }
 
   void Register(const std::string& varname, void* data, int64_t size);
   void* Find(const std::string& varname, int64_t size);
 
+  // Hold the registered buffer data while a payload sending it is in
+  // flight, and release it after the payload is released.
+  void Acquire(void* data);
+  void Release(void* data);
+
+  // the number of the registered buffers
+  size_t RegisteredNum();
+
  private:
   struct VarInfo {
     void* data;
@@ -44,8 +65,22 @@ class RdmaMemPool {
     VarInfo() : data(nullptr), data_size(0) {}
   };
 
+  struct Region {
+    int64_t size{0};
+    // the vars whose buffer it is, and the payloads in flight sending it
+    int owners{0};
+    int inflight{0};
+  };
+
+  // deregister the region if it is neither owned nor in flight, with the
+  // write lock held
+  void MaybeDeregister(void* data);
+
  private:
   std::unordered_map<std::string, VarInfo> pool_;
+  std::unordered_map<void*, Region> regions_;
+  RegisterFn register_fn_;
+  DeregisterFn deregister_fn_;
   pthread_rwlock_t access_;
 };
 
@@ -0,0 +1,99 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/brpc/brpc_rdma_pool.h"
+
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+class FakeRdma {
+ public:
+  RdmaMemPool::RegisterFn RegisterFn() {
+    return [this](void* data, size_t size) {
+      // registering a registered buffer fails as brpc::rdma does
+      return registered.insert(data).second ? 0 : -1;
+    };
+  }
+
+  RdmaMemPool::DeregisterFn DeregisterFn() {
+    return [this](void* data) { registered.erase(data); };
+  }
+
+  std::set<void*> registered;
+};
+
+TEST(RdmaMemPool, register_once) {
+  FakeRdma rdma;
+  RdmaMemPool pool(rdma.RegisterFn(), rdma.DeregisterFn());
+  std::vector<char> buffer(64);
+  pool.Register("x", buffer.data(), buffer.size());
+  pool.Register("x", buffer.data(), buffer.size());
+  ASSERT_EQ(rdma.registered.size(), 1UL);
+  ASSERT_EQ(pool.Find("x", buffer.size()), buffer.data());
+}
+
+TEST(RdmaMemPool, deregister_moved_buffer) {
+  FakeRdma rdma;
+  RdmaMemPool pool(rdma.RegisterFn(), rdma.DeregisterFn());
+  std::vector<char> buffer1(64), buffer2(128), buffer3(256);
+
+  // the old buffer not in flight is deregistered at once
+  pool.Register("x", buffer1.data(), buffer1.size());
+  pool.Register("x", buffer2.data(), buffer2.size());
+  ASSERT_EQ(rdma.registered, std::set<void*>({buffer2.data()}));
+
+  // the old buffer in flight is deregistered after the payload is released
+  pool.Acquire(buffer2.data());
+  pool.Register("x", buffer3.data(), buffer3.size());
+  ASSERT_EQ(rdma.registered,
+            std::set<void*>({buffer2.data(), buffer3.data()}));
+  pool.Release(buffer2.data());
+  ASSERT_EQ(rdma.registered, std::set<void*>({buffer3.data()}));
+  ASSERT_EQ(pool.RegisteredNum(), 1UL);
+
+  // the memory freed and allocated again is registered again
+  pool.Register("x", buffer1.data(), buffer1.size());
+  ASSERT_EQ(rdma.registered, std::set<void*>({buffer1.data()}));
+
+  // the buffer of the var in flight stays registered
+  pool.Acquire(buffer1.data());
+  pool.Release(buffer1.data());
+  ASSERT_EQ(rdma.registered, std::set<void*>({buffer1.data()}));
+  ASSERT_EQ(pool.Find("x", buffer1.size()), buffer1.data());
+}
+
+TEST(RdmaMemPool, shared_buffer) {
+  FakeRdma rdma;
+  RdmaMemPool pool(rdma.RegisterFn(), rdma.DeregisterFn());
+  std::vector<char> buffer1(64), buffer2(64);
+  pool.Register("x", buffer1.data(), buffer1.size());
+  pool.Register("y", buffer1.data(), buffer1.size());
+  ASSERT_EQ(rdma.registered.size(), 1UL);
+  // still the buffer of y
+  pool.Register("x", buffer2.data(), buffer2.size());
+  ASSERT_EQ(rdma.registered,
+            std::set<void*>({buffer1.data(), buffer2.data()}));
+  pool.Register("y", buffer2.data(), buffer2.size());
+  ASSERT_EQ(rdma.registered, std::set<void*>({buffer2.data()}));
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -18,7 +18,9 @@ limitations under the License. */
 #include <sys/time.h>
 #include <limits>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <thread>  // NOLINT
+#include <unordered_map>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/operators/distributed/brpc/brpc_rdma_pool.h"
@@ -68,6 +70,38 @@ class IOBufWriter {
   }
 
 #ifdef PADDLE_WITH_BRPC_RDMA
+  // The payloads appended as the user data of the IOBufs, whose deleters
+  // only get the data pointers.
+  static std::mutex& PayloadsMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+  static std::unordered_multimap<void*, std::pair<void (*)(void*), void*>>&
+  Payloads() {
+    static std::unordered_multimap<void*, std::pair<void (*)(void*), void*>>
+        payloads;
+    return payloads;
+  }
+
+  static void ReleasePayload(void* data) {
+    std::pair<void (*)(void*), void*> destroy;
+    {
+      std::lock_guard<std::mutex> guard(PayloadsMutex());
+      auto it = Payloads().find(data);
+      if (it == Payloads().end()) {
+        LOG(ERROR) << "the payload of the rdma buffer " << data
+                   << " is not found";
+        return;
+      }
+      destroy = it->second;
+      Payloads().erase(it);
+    }
+    // the buffer is deregistered before it is freed by the payload, if it
+    // is no longer the buffer of its var
+    RdmaMemPool::Instance().Release(data);
+    destroy.first(destroy.second);
+  }
+
   static void AppendRdmaZeroCopy(const std::string varname, butil::IOBuf* iobuf,
                                  int k, const char* v, int64_t vlen,
                                  bool in_cuda_pinned, void (*destroy)(void*),
@@ -79,14 +113,26 @@ class IOBufWriter {
     iobuf->append(reinterpret_cast<char*>(&k), 4);
     iobuf->append(reinterpret_cast<char*>(&vlen), 8);
 
-    RdmaMemPool::Instance().Register(
-        varname, static_cast<void*>(const_cast<char*>(v)), vlen);
-
-    // FIXME(gongwb): use append_zerocopy
-    // iobuf->append_zerocopy(v, vlen, nullptr);
-    iobuf->append(v, vlen);
-    destroy(user_data);
-    return;
+    if (vlen == 0) {
+      destroy(user_data);
+      return;
+    }
+    void* data = static_cast<void*>(const_cast<char*>(v));
+    RdmaMemPool::Instance().Register(varname, data, vlen);
+    RdmaMemPool::Instance().Acquire(data);
+
+    // The registered buffer is sent without copying, and the payload holding
+    // it is released after the IOBuf is sent.
+    {
+      std::lock_guard<std::mutex> guard(PayloadsMutex());
+      Payloads().emplace(data, std::make_pair(destroy, user_data));
+    }
+    if (iobuf->append_user_data(data, vlen, IOBufWriter::ReleasePayload) !=
+        0) {
+      ReleasePayload(data);
+      LOG(FATAL) << "AppendRdmaZeroCopy varname:" << varname
+                 << " fails to append the user data";
+    }
   }
 #endif
 
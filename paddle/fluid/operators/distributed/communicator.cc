@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/communicator.h"
 #include <gflags/gflags.h>
 #include <paddle/fluid/framework/program_desc.h>
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <map>
 #include <thread>  // NOLINT
@@ -27,6 +28,9 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/distributed.h"
 #include "paddle/fluid/operators/distributed/parameter_recv.h"
 #include "paddle/fluid/operators/distributed/parameter_send.h"
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
+#include "paddle/fluid/platform/metrics.h"
 #include "paddle/fluid/string/printf.h"
 #include "paddle/fluid/string/split.h"
 
@@ -77,6 +81,9 @@ void AsyncCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
       send_varname_to_queue_[iter.first] =
           std::make_shared<BlockingQueue<std::shared_ptr<Variable>>>(
               send_queue_size_);
+      for (auto &splited_var_name : iter.second.splited_var_names) {
+        SetSendCompression(splited_var_name, grad_compression_);
+      }
     }
     send_threadpool_.reset(new ::ThreadPool(thread_pool_size_));
   }
@@ -145,23 +152,144 @@ AsyncCommunicator::~AsyncCommunicator() {
   if (recv_thread_) recv_thread_->join();
 }
 
+void AsyncCommunicator::AddCompressionError(const std::string &var_name) {
+  // The rows of the sparse gradients change in every batch, so only the
+  // errors of the dense ones are kept.
+  auto *var = send_scope_->FindVar(var_name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) return;
+  auto *tensor = var->GetMutable<framework::LoDTensor>();
+  if (tensor->type() != framework::proto::VarType::FP32 ||
+      tensor->numel() == 0) {
+    return;
+  }
+  auto *error = send_scope_->Var(var_name + "@COMPRESSION_ERROR")
+                    ->GetMutable<framework::LoDTensor>();
+  if (!error->IsInitialized() || error->dims() != tensor->dims()) {
+    error->Resize(tensor->dims());
+    float *data = error->mutable_data<float>(platform::CPUPlace());
+    std::fill(data, data + error->numel(), 0.0f);
+  }
+  // the same rows as the int8 scales of the serialized blocks
+  int64_t rows = tensor->dims().size() > 1 ? tensor->dims()[0] : 1;
+  AddGradCompressionError(grad_compression_, tensor->data<float>(), rows,
+                          tensor->numel() / rows, error->data<float>());
+}
+
+framework::LoDTensor *AsyncCommunicator::HostAggregatedVar(
+    Scope *scope, const std::string &var_name) {
+  auto *var = scope->FindVar(var_name);
+  if (var == nullptr || !var->IsType<framework::LoDTensor>()) return nullptr;
+  auto *tensor = var->GetMutable<framework::LoDTensor>();
+  if (!tensor->IsInitialized() ||
+      tensor->type() != framework::proto::VarType::FP32 ||
+      !platform::is_cpu_place(tensor->place())) {
+    return nullptr;
+  }
+  return tensor;
+}
+
+bool AsyncCommunicator::HasHostGrads(const std::string &var_name) {
+  if (host_aggregator_ == nullptr || !host_aggregator_->IsLeader()) {
+    return false;
+  }
+  auto *tensor = HostAggregatedVar(send_scope_.get(), var_name);
+  return tensor != nullptr &&
+         host_aggregator_->HasPendingGrads(var_name, tensor->numel());
+}
+
+bool AsyncCommunicator::AggregateOnHost(const std::string &var_name,
+                                        bool merged) {
+  // the sparse gradients are sent by each trainer
+  auto *tensor = HostAggregatedVar(send_scope_.get(), var_name);
+  if (tensor == nullptr) return merged;
+  float *data = tensor->data<float>();
+  if (!host_aggregator_->IsLeader()) {
+    if (merged) {
+      host_aggregator_->PushGrad(var_name, data, tensor->numel());
+    }
+    return false;
+  }
+  if (!merged) {
+    std::fill(data, data + tensor->numel(), 0.0f);
+  }
+  int taken = host_aggregator_->TakeGrads(var_name, data, tensor->numel());
+  VLOG(4) << "take " << taken << " gradients of " << var_name
+          << " from the host";
+  return merged || taken > 0;
+}
+
+// the metrics of all the communicators, got once for the send and recv tasks
+struct CommMetrics {
+  platform::MetricCounter *sends;
+  platform::MetricCounter *send_bytes;
+  platform::LatencyHistogram *send_latency;
+  platform::MetricCounter *recvs;
+  platform::LatencyHistogram *recv_latency;
+};
+
+static CommMetrics &GetCommMetrics() {
+  static CommMetrics metrics = [] {
+    auto &registry = platform::MetricsRegistry::Instance();
+    return CommMetrics{
+        registry.Counter("paddle_communicator_sends_total",
+                         "The merged variables sent by the communicator."),
+        registry.Counter("paddle_communicator_send_bytes_total",
+                         "The bytes sent by the communicator."),
+        registry.Histogram("paddle_communicator_send_latency_ns",
+                           "The nanoseconds sending a merged variable."),
+        registry.Counter("paddle_communicator_recvs_total",
+                         "The parameters received by the communicator."),
+        registry.Histogram("paddle_communicator_recv_latency_ns",
+                           "The nanoseconds receiving a parameter.")};
+  }();
+  return metrics;
+}
+
+// the bytes of the merged gradient sent
+static int64_t SendBytes(const Variable &var) {
+  if (var.IsType<framework::LoDTensor>()) {
+    auto &tensor = var.Get<framework::LoDTensor>();
+    return tensor.numel() * framework::SizeOfType(tensor.type());
+  } else if (var.IsType<framework::SelectedRows>()) {
+    auto &slr = var.Get<framework::SelectedRows>();
+    return slr.value().numel() * framework::SizeOfType(slr.value().type()) +
+           slr.rows().size() * sizeof(int64_t);
+  }
+  return 0;
+}
+
 void AsyncCommunicator::SendThread() {
   VLOG(3) << "SendThread start!";
+  platform::BindThreadToCpuPool(platform::CpuPool::kComm);
   while (running_) {
     std::vector<std::future<void>> task_futures;
     task_futures.reserve(send_varname_to_ctx_.size());
     VLOG(4) << "run send graph";
     auto before_run_send_graph = GetCurrentUS();
+    int max_merge_num = max_merge_var_num_;
+    int concurrency = static_cast<int>(send_varname_to_queue_.size());
+    double queue_depth_ratio = 0;
+    if (send_tuner_ != nullptr) {
+      max_merge_num = send_tuner_->MergeNum();
+      concurrency = send_tuner_->Concurrency();
+      for (auto &iter : send_varname_to_queue_) {
+        queue_depth_ratio = std::max(
+            queue_depth_ratio, static_cast<double>(iter.second->Size()) /
+                                   iter.second->Cap());
+      }
+    }
+    size_t finished_task_num = 0;
     for (auto &iter : send_varname_to_queue_) {
       auto &var_name = iter.first;
       auto &var_queue = iter.second;
-      if (var_queue->Size() > 0) {
-        auto send_task = [this, &var_name, &var_queue] {
+      if (var_queue->Size() > 0 || HasHostGrads(var_name)) {
+        auto send_task = [this, &var_name, &var_queue, max_merge_num] {
+          platform::BindThreadToCpuPool(platform::CpuPool::kComm);
           VLOG(4) << var_name << " merge and send";
           std::vector<std::shared_ptr<Variable>> vars;
           int merged_var_num = 0;
           int wait_times = 0;
-          while (merged_var_num < max_merge_var_num_) {
+          while (merged_var_num < max_merge_num) {
             if (var_queue->Size() == 0) {
               VLOG(4) << "wait_times -> " << wait_times;
               if (wait_times >= send_wait_times_) {
@@ -183,7 +311,9 @@ void AsyncCommunicator::SendThread() {
           }
           auto before_merge = GetCurrentUS();
           auto &ctx = send_varname_to_ctx_.at(var_name);
-          if (ctx.use_send_handler) {
+          if (vars.empty()) {
+            // only the gradients of the other trainers on the host
+          } else if (ctx.use_send_handler) {
             MergeVars<float>(var_name, vars, send_scope_.get(), ctx.merge_add);
           } else {
             MergeVars<int64_t>(var_name, vars, send_scope_.get(),
@@ -192,12 +322,35 @@ void AsyncCommunicator::SendThread() {
           auto after_merge = GetCurrentUS();
           VLOG(4) << "merge " << merged_var_num << " " << var_name
                   << " use time " << after_merge - before_merge;
+          if (host_aggregator_ != nullptr &&
+              !AggregateOnHost(var_name, !vars.empty())) {
+            return;
+          }
+          if (grad_compression_ != GradCompression::kNone) {
+            AddCompressionError(var_name);
+          }
           auto send_functor = distributed::ParameterSend<float>();
           send_functor(ctx, *send_scope_, true, 1);
           auto after_send = GetCurrentUS();
           VLOG(4) << "send " << var_name << " use time "
                   << after_send - after_merge;
+          int64_t send_bytes = SendBytes(*send_scope_->FindVar(var_name));
+          auto &metrics = GetCommMetrics();
+          metrics.sends->Add();
+          metrics.send_bytes->Add(send_bytes);
+          metrics.send_latency->Record(
+              static_cast<uint64_t>((after_send - after_merge) * 1000));
+          if (send_tuner_ != nullptr) {
+            send_tuner_->RecordSend(
+                merged_var_num, send_bytes,
+                static_cast<int64_t>(after_send - after_merge));
+          }
         };
+        // at most concurrency vars are sent at the same time
+        if (task_futures.size() - finished_task_num >=
+            static_cast<size_t>(concurrency)) {
+          task_futures[finished_task_num++].wait();
+        }
         task_futures.emplace_back(
             send_threadpool_->enqueue(std::move(send_task)));
       } else {
@@ -211,6 +364,18 @@ void AsyncCommunicator::SendThread() {
 
     VLOG(4) << "run send graph use time "
             << after_run_send_graph - before_run_send_graph;
+    if (send_tuner_ != nullptr) {
+      send_tuner_->Tune(
+          queue_depth_ratio,
+          static_cast<int64_t>(after_run_send_graph - before_run_send_graph));
+      auto stats = send_tuner_->GetStats();
+      VLOG(3) << "communicator merge_num " << stats.merge_num
+              << ", concurrency " << stats.concurrency << ", queue depth "
+              << stats.queue_depth_ratio << ", merge factor "
+              << stats.avg_merged_num << ", rpc latency "
+              << stats.avg_latency_us << " us, " << stats.bytes_per_sec
+              << " bytes/s";
+    }
     Recv();
   }
   VLOG(1) << "communicator stopped, send thread exit";
@@ -218,6 +383,7 @@ void AsyncCommunicator::SendThread() {
 
 void AsyncCommunicator::RecvThread() {
   VLOG(3) << "RecvThread start!";
+  platform::BindThreadToCpuPool(platform::CpuPool::kComm);
   while (running_) {
     int grad_num = grad_num_.load();
     if (grad_num > min_send_grad_num_before_recv_) {
@@ -252,10 +418,29 @@ void AsyncCommunicator::RecvAll() {
   task_futures.reserve(recv_varname_to_ctx_.size());
   for (auto &iter : recv_varname_to_ctx_) {
     auto recv_task = [this, &iter] {
+      platform::BindThreadToCpuPool(platform::CpuPool::kComm);
       auto &var_name = iter.first;
       VLOG(4) << "recv var " << var_name;
+      auto *param = host_aggregator_ == nullptr
+                        ? nullptr
+                        : HostAggregatedVar(recv_scope_, var_name);
+      if (param != nullptr && !host_aggregator_->IsLeader()) {
+        // the parameter received by the leader of the host
+        host_aggregator_->FetchParam(var_name, param->data<float>(),
+                                     param->numel());
+        return;
+      }
       auto recv_functor = distributed::ParameterRecv<float>();
+      auto before_recv = GetCurrentUS();
       recv_functor(iter.second, *recv_scope_);
+      auto &metrics = GetCommMetrics();
+      metrics.recvs->Add();
+      metrics.recv_latency->Record(
+          static_cast<uint64_t>((GetCurrentUS() - before_recv) * 1000));
+      if (param != nullptr) {
+        host_aggregator_->PublishParam(var_name, param->data<float>(),
+                                       param->numel());
+      }
     };
     task_futures.emplace_back(recv_threadpool_->enqueue(std::move(recv_task)));
   }
@@ -303,6 +488,29 @@ void AsyncCommunicator::Stop() {
   VLOG(1) << "Communicator stop done";
 }
 
+std::map<std::string, double> AsyncCommunicator::GetStats() const {
+  std::map<std::string, double> stats;
+  double queue_depth = 0;
+  for (auto &iter : send_varname_to_queue_) {
+    queue_depth =
+        std::max(queue_depth, static_cast<double>(iter.second->Size()));
+  }
+  stats["queue_depth"] = queue_depth;
+  stats["merge_num"] = max_merge_var_num_;
+  stats["concurrency"] = thread_pool_size_;
+  if (send_tuner_ != nullptr) {
+    auto tuner_stats = send_tuner_->GetStats();
+    stats["merge_num"] = tuner_stats.merge_num;
+    stats["concurrency"] = tuner_stats.concurrency;
+    stats["merge_factor"] = tuner_stats.avg_merged_num;
+    stats["rpc_latency_us"] = tuner_stats.avg_latency_us;
+    stats["bytes_per_sec"] = tuner_stats.bytes_per_sec;
+    stats["send_num"] = tuner_stats.send_num;
+    stats["send_bytes"] = tuner_stats.send_bytes;
+  }
+  return stats;
+}
+
 void AsyncCommunicator::Send(const std::vector<std::string> &var_names,
                              const std::vector<std::string> &var_tables,
                              const framework::Scope &scope) {
@@ -316,6 +524,13 @@ void AsyncCommunicator::Send(const std::vector<std::string> &var_names,
       grad_var->IsInitialized(), true,
       platform::errors::InvalidArgument("grad var should be inited"));
 
+  // the rows updated by the sparse gradient are prefetched again
+  if (grad_var->IsType<framework::SelectedRows>()) {
+    auto &slr = grad_var->Get<framework::SelectedRows>();
+    PrefetchCache::InvalidateRows(framework::GradOriginalVarName(var_name),
+                                  slr.rows());
+  }
+
   auto tmp_grad_var = std::make_shared<Variable>();
   framework::CopyVariable(*grad_var, tmp_grad_var.get());
   auto &queue = send_varname_to_queue_.at(var_name);
@@ -464,6 +679,7 @@ void GeoSgdCommunicator::Send(const std::vector<std::string> &sparse_var_names,
 
 void GeoSgdCommunicator::SendThread() {
   VLOG(1) << "SendThread start!";
+  platform::BindThreadToCpuPool(platform::CpuPool::kComm);
   auto before_run_training = GetCurrentUS();
 
   while (running_) {
@@ -501,6 +717,7 @@ void GeoSgdCommunicator::SendThread() {
           // sparse var: merge->send->recv
           for (auto &splited_var_name : iter.second.splited_var_names) {
             auto send_task = [this, &var_name, &splited_var_name] {
+              platform::BindThreadToCpuPool(platform::CpuPool::kComm);
               auto before_run_geo = GetCurrentUS();
               VLOG(4) << "ids_send_vec_ size: " << ids_send_vec_.size();
               auto ids_set =
@@ -517,6 +734,7 @@ void GeoSgdCommunicator::SendThread() {
         } else {
           for (auto &splited_var_name : iter.second.splited_var_names) {
             auto send_task = [this, &var_name, &splited_var_name] {
+              platform::BindThreadToCpuPool(platform::CpuPool::kComm);
               auto before_run_geo = GetCurrentUS();
               SendUpdateDenseVars(var_name, splited_var_name);
               RecvUpdateDenseVars(var_name, splited_var_name);
@@ -1039,6 +1257,7 @@ void HalfAsyncCommunicator::Clean() {
 
 void HalfAsyncCommunicator::ConsumeThread() {
   VLOG(3) << "ConsumeThread start!";
+  platform::BindThreadToCpuPool(platform::CpuPool::kComm);
   while (running_) {
     while (running_) {
       if (barrier_counter_.load() >= barrier_trigger_.load() &&
@@ -1058,6 +1277,7 @@ void HalfAsyncCommunicator::ConsumeThread() {
       auto &var_queue = iter.second;
       if (var_queue->Size() > 0) {
         auto send_task = [this, &var_name, &var_queue] {
+          platform::BindThreadToCpuPool(platform::CpuPool::kComm);
           VLOG(3) << var_name << " merge and send";
           std::vector<std::shared_ptr<Variable>> vars;
           size_t merged_var_num = 0;
@@ -1146,6 +1366,7 @@ void HalfAsyncCommunicator::Recv() {
   task_futures.reserve(recv_varname_to_ctx_.size());
   for (auto &iter : recv_varname_to_ctx_) {
     auto recv_task = [this, &iter] {
+      platform::BindThreadToCpuPool(platform::CpuPool::kComm);
       auto &var_name = iter.first;
       VLOG(4) << "recv var " << var_name;
       auto recv_functor = distributed::ParameterRecv<float>();
@@ -28,7 +28,10 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/operators/distributed/adaptive_send_tuner.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/grad_compression.h"
+#include "paddle/fluid/operators/distributed/host_aggregator.h"
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/rpc_common.h"
 #include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
@@ -193,6 +196,9 @@ class Communicator {
 
   virtual void Barrier() {}
   virtual void BarrierTriggerDecrement() {}
+
+  // the internal states of the communicator, e.g. the queue depth
+  virtual std::map<std::string, double> GetStats() const { return {}; }
   virtual void BarrierTriggerReset(int init_counter) {}
 
   virtual void InitImpl(const RpcCtxMap& send_varname_to_ctx,
@@ -249,6 +255,22 @@ class AsyncCommunicator : public Communicator {
     send_queue_size_ = std::stoi(envs.at("communicator_send_queue_size"));
     is_sgd_optimizer_ =
         static_cast<bool>(std::stoi(envs.at("communicator_is_sgd_optimizer")));
+    if (envs.count("communicator_grad_compression")) {
+      grad_compression_ =
+          ParseGradCompression(envs.at("communicator_grad_compression"));
+    }
+    if (envs.count("communicator_adaptive_send") &&
+        std::stoi(envs.at("communicator_adaptive_send"))) {
+      send_tuner_.reset(
+          new AdaptiveSendTuner(max_merge_var_num_, thread_pool_size_));
+    }
+    if (envs.count("communicator_local_trainers") &&
+        std::stoi(envs.at("communicator_local_trainers")) > 1) {
+      host_aggregator_.reset(new HostAggregator(
+          envs.at("communicator_host_aggregation_name"),
+          std::stoi(envs.at("communicator_local_trainers")),
+          std::stoi(envs.at("communicator_local_rank"))));
+    }
     VLOG(0) << "AsyncCommunicator Initialized";
   }
   ~AsyncCommunicator();
@@ -272,7 +294,21 @@ class AsyncCommunicator : public Communicator {
             const std::vector<std::string>& var_tables,
             const framework::Scope& scope) override;
 
+  std::map<std::string, double> GetStats() const override;
+
  private:
+  // the error feedback of the merged dense gradient before sending
+  void AddCompressionError(const std::string& var_name);
+
+  // the dense FP32 var of the scope aggregated on the host, or nullptr
+  framework::LoDTensor* HostAggregatedVar(Scope* scope,
+                                          const std::string& var_name);
+  bool HasHostGrads(const std::string& var_name);
+  // Push the merged gradient to the leader on the followers, or add the
+  // gradients of the followers into it on the leader, and return whether
+  // to send it to the pservers.
+  bool AggregateOnHost(const std::string& var_name, bool merged);
+
   int min_send_grad_num_before_recv_;
   int thread_pool_size_;
   int max_merge_var_num_;
@@ -280,6 +316,15 @@ class AsyncCommunicator : public Communicator {
   int send_queue_size_;
   bool independent_recv_thread_;
   bool is_sgd_optimizer_;
+  // the compression of the FP32 gradients sent, whose errors are kept in
+  // send_scope_ and sent with the later gradients
+  GradCompression grad_compression_{GradCompression::kNone};
+  // only the leader trainer of the host sends the dense gradients and
+  // receives the dense parameters if it is set
+  std::unique_ptr<HostAggregator> host_aggregator_{nullptr};
+  // tune the merge number and the send concurrency from the measured sends
+  // if it is set, or they are fixed by the flags
+  std::unique_ptr<AdaptiveSendTuner> send_tuner_{nullptr};
 
  private:
   std::unordered_map<std::string,
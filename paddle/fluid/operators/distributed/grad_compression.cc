@@ -0,0 +1,138 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/grad_compression.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+GradCompression ParseGradCompression(const std::string& name) {
+  if (name.empty() || name == "none") {
+    return GradCompression::kNone;
+  } else if (name == "fp16") {
+    return GradCompression::kFP16;
+  } else if (name == "int8") {
+    return GradCompression::kINT8;
+  }
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "The gradient compression should be none, fp16 or int8, but got %s.",
+      name));
+}
+
+size_t CompressedGradBytes(GradCompression compression, int64_t rows,
+                           int64_t width) {
+  switch (compression) {
+    case GradCompression::kFP16:
+      return rows * width * sizeof(platform::float16);
+    case GradCompression::kINT8:
+      return rows * (sizeof(float) + width * sizeof(int8_t));
+    default:
+      return rows * width * sizeof(float);
+  }
+}
+
+void CompressGrad(GradCompression compression, const float* x, int64_t rows,
+                  int64_t width, void* out) {
+  if (compression == GradCompression::kFP16) {
+    auto* y = static_cast<platform::float16*>(out);
+    for (int64_t i = 0; i < rows * width; ++i) {
+      y[i] = static_cast<platform::float16>(x[i]);
+    }
+  } else if (compression == GradCompression::kINT8) {
+    auto* scales = static_cast<float*>(out);
+    auto* y = reinterpret_cast<int8_t*>(scales + rows);
+    for (int64_t i = 0; i < rows; ++i) {
+      const float* row = x + i * width;
+      float max_abs = 0;
+      for (int64_t j = 0; j < width; ++j) {
+        max_abs = std::max(max_abs, std::fabs(row[j]));
+      }
+      scales[i] = max_abs / 127;
+      float inv_scale = max_abs > 0 ? 127 / max_abs : 0;
+      for (int64_t j = 0; j < width; ++j) {
+        y[i * width + j] = static_cast<int8_t>(std::round(row[j] * inv_scale));
+      }
+    }
+  } else {
+    std::copy(x, x + rows * width, static_cast<float*>(out));
+  }
+}
+
+void DecompressGrad(GradCompression compression, const void* in, int64_t rows,
+                    int64_t width, float* y) {
+  if (compression == GradCompression::kFP16) {
+    auto* x = static_cast<const platform::float16*>(in);
+    for (int64_t i = 0; i < rows * width; ++i) {
+      y[i] = static_cast<float>(x[i]);
+    }
+  } else if (compression == GradCompression::kINT8) {
+    auto* scales = static_cast<const float*>(in);
+    auto* x = reinterpret_cast<const int8_t*>(scales + rows);
+    for (int64_t i = 0; i < rows; ++i) {
+      for (int64_t j = 0; j < width; ++j) {
+        y[i * width + j] = x[i * width + j] * scales[i];
+      }
+    }
+  } else {
+    auto* x = static_cast<const float*>(in);
+    std::copy(x, x + rows * width, y);
+  }
+}
+
+void AddGradCompressionError(GradCompression compression, float* x,
+                             int64_t rows, int64_t width, float* error) {
+  int64_t numel = rows * width;
+  for (int64_t i = 0; i < numel; ++i) {
+    x[i] += error[i];
+  }
+  std::vector<char> compressed(CompressedGradBytes(compression, rows, width));
+  CompressGrad(compression, x, rows, width, compressed.data());
+  DecompressGrad(compression, compressed.data(), rows, width, error);
+  for (int64_t i = 0; i < numel; ++i) {
+    error[i] = x[i] - error[i];
+  }
+}
+
+namespace {
+std::mutex send_compression_mutex;
+std::unordered_map<std::string, GradCompression> send_compressions;
+}  // namespace
+
+void SetSendCompression(const std::string& var_name,
+                        GradCompression compression) {
+  std::lock_guard<std::mutex> guard(send_compression_mutex);
+  if (compression == GradCompression::kNone) {
+    send_compressions.erase(var_name);
+  } else {
+    send_compressions[var_name] = compression;
+  }
+}
+
+GradCompression GetSendCompression(const std::string& var_name) {
+  std::lock_guard<std::mutex> guard(send_compression_mutex);
+  auto it = send_compressions.find(var_name);
+  return it == send_compressions.end() ? GradCompression::kNone : it->second;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
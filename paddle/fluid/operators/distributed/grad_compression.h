@@ -0,0 +1,64 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The lossy compression of the FP32 gradients on the wire. The values in
+// VariableMessage.compression.
+enum class GradCompression {
+  kNone = 0,
+  // cast to float16
+  kFP16 = 1,
+  // int8 with a scale per row, max |x| / 127, before the int8 values
+  kINT8 = 2,
+};
+
+// Parse "none", "fp16" or "int8".
+GradCompression ParseGradCompression(const std::string& name);
+
+// The bytes of the rows x width floats compressed.
+size_t CompressedGradBytes(GradCompression compression, int64_t rows,
+                           int64_t width);
+
+// Compress the rows x width floats x into out of CompressedGradBytes.
+void CompressGrad(GradCompression compression, const float* x, int64_t rows,
+                  int64_t width, void* out);
+
+void DecompressGrad(GradCompression compression, const void* in, int64_t rows,
+                    int64_t width, float* y);
+
+// The error feedback: add the error of the last compression kept in error
+// to x, and keep the error of compressing x now, x - Decompress(Compress(x)),
+// into error, so that the errors are sent with the later gradients.
+void AddGradCompressionError(GradCompression compression, float* x,
+                             int64_t rows, int64_t width, float* error);
+
+// The compression of the FP32 vars serialized by the names, e.g. the
+// gradient blocks sent by the communicator. The vars not set are not
+// compressed.
+void SetSendCompression(const std::string& var_name,
+                        GradCompression compression);
+GradCompression GetSendCompression(const std::string& var_name);
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
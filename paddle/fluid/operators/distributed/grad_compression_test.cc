@@ -0,0 +1,126 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/grad_compression.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+std::vector<float> MakeGrad(int64_t rows, int64_t width) {
+  std::vector<float> x(rows * width);
+  for (size_t i = 0; i < x.size(); ++i) {
+    // rows of different ranges
+    x[i] = std::sin(i * 0.37f) * (i / width + 1);
+  }
+  return x;
+}
+
+void CheckRoundTrip(GradCompression compression, float rel_error) {
+  const int64_t rows = 4, width = 33;
+  auto x = MakeGrad(rows, width);
+  std::vector<char> buffer(CompressedGradBytes(compression, rows, width));
+  CompressGrad(compression, x.data(), rows, width, buffer.data());
+  std::vector<float> y(x.size());
+  DecompressGrad(compression, buffer.data(), rows, width, y.data());
+  for (int64_t r = 0; r < rows; ++r) {
+    float max_abs = 0;
+    for (int64_t c = 0; c < width; ++c) {
+      max_abs = std::max(max_abs, std::fabs(x[r * width + c]));
+    }
+    for (int64_t c = 0; c < width; ++c) {
+      EXPECT_NEAR(y[r * width + c], x[r * width + c], max_abs * rel_error);
+    }
+  }
+}
+
+TEST(GradCompression, parse) {
+  EXPECT_EQ(ParseGradCompression("none"), GradCompression::kNone);
+  EXPECT_EQ(ParseGradCompression("fp16"), GradCompression::kFP16);
+  EXPECT_EQ(ParseGradCompression("int8"), GradCompression::kINT8);
+  EXPECT_ANY_THROW(ParseGradCompression("int4"));
+}
+
+TEST(GradCompression, bytes) {
+  EXPECT_EQ(CompressedGradBytes(GradCompression::kFP16, 3, 5), 30UL);
+  EXPECT_EQ(CompressedGradBytes(GradCompression::kINT8, 3, 5),
+            3 * sizeof(float) + 15);
+}
+
+TEST(GradCompression, fp16_round_trip) {
+  CheckRoundTrip(GradCompression::kFP16, 1e-3);
+}
+
+TEST(GradCompression, int8_round_trip) {
+  CheckRoundTrip(GradCompression::kINT8, 0.5f / 127 + 1e-6);
+}
+
+TEST(GradCompression, zero_rows) {
+  std::vector<float> x(8, 0.0f);
+  std::vector<char> buffer(
+      CompressedGradBytes(GradCompression::kINT8, 2, 4));
+  CompressGrad(GradCompression::kINT8, x.data(), 2, 4, buffer.data());
+  std::vector<float> y(8, 1.0f);
+  DecompressGrad(GradCompression::kINT8, buffer.data(), 2, 4, y.data());
+  for (auto v : y) {
+    EXPECT_EQ(v, 0.0f);
+  }
+}
+
+TEST(GradCompression, error_feedback) {
+  // The sum of the gradients decompressed follows the sum of the original
+  // ones with the error kept, instead of drifting away.
+  const int64_t rows = 2, width = 16;
+  std::vector<float> error(rows * width, 0.0f);
+  std::vector<double> sent_sum(rows * width, 0.0);
+  std::vector<double> grad_sum(rows * width, 0.0);
+  std::vector<char> buffer(
+      CompressedGradBytes(GradCompression::kINT8, rows, width));
+  std::vector<float> y(rows * width);
+  for (int step = 0; step < 100; ++step) {
+    auto x = MakeGrad(rows, width);
+    for (size_t i = 0; i < x.size(); ++i) {
+      x[i] = x[i] * 0.01f + 1e-4f * step;
+      grad_sum[i] += x[i];
+    }
+    AddGradCompressionError(GradCompression::kINT8, x.data(), rows, width,
+                            error.data());
+    CompressGrad(GradCompression::kINT8, x.data(), rows, width,
+                 buffer.data());
+    DecompressGrad(GradCompression::kINT8, buffer.data(), rows, width,
+                   y.data());
+    for (size_t i = 0; i < y.size(); ++i) {
+      sent_sum[i] += y[i];
+    }
+  }
+  for (size_t i = 0; i < error.size(); ++i) {
+    EXPECT_NEAR(sent_sum[i] + error[i], grad_sum[i], 1e-4);
+  }
+}
+
+TEST(GradCompression, send_compression) {
+  EXPECT_EQ(GetSendCompression("w@GRAD.block0"), GradCompression::kNone);
+  SetSendCompression("w@GRAD.block0", GradCompression::kFP16);
+  EXPECT_EQ(GetSendCompression("w@GRAD.block0"), GradCompression::kFP16);
+  SetSendCompression("w@GRAD.block0", GradCompression::kNone);
+  EXPECT_EQ(GetSendCompression("w@GRAD.block0"), GradCompression::kNone);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -410,19 +410,20 @@ VarHandlePtr GRPCClient::AsyncSendComplete(const std::string& ep,
 
 VarHandlePtr GRPCClient::AsyncCheckpointNotify(const std::string& ep,
                                                const std::string& dir,
-                                               int64_t time_out) {
+                                               bool delta, int64_t time_out) {
   const auto ch = GetChannel(ep);
 
   CheckpointNotifyProcessor* s = new CheckpointNotifyProcessor(ch);
 
   const std::string method = kCheckPointNotifyRPC;
+  const std::string message =
+      delta ? CHECKPOINT_DELTA_SAVE_MESSAGE : CHECKPOINT_SAVE_MESSAGE;
 
-  VarHandlePtr h(
-      new VarHandle(ep, method, CHECKPOINT_SAVE_MESSAGE, nullptr, nullptr));
+  VarHandlePtr h(new VarHandle(ep, method, message, nullptr, nullptr));
   s->Prepare(h, time_out);
 
   sendrecv::VariableMessage req;
-  req.set_varname(CHECKPOINT_SAVE_MESSAGE);
+  req.set_varname(message);
   req.set_out_varname(dir);
 
   platform::RecordRPCEvent record_event(method);
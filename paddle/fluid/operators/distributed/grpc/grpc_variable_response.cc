@@ -301,6 +301,14 @@ int GRPCVariableResponse::Parse(Source* source) {
         meta_.set_trainer_id(trainer_id);
         break;
       }
+      case sendrecv::VariableMessage::kCompressionFieldNumber: {
+        uint64_t compression = 0;
+        if (!input.ReadVarint64(&compression)) {
+          return tag;
+        }
+        meta_.set_compression(static_cast<int>(compression));
+        break;
+      }
       case sendrecv::VariableMessage::kTableNameFieldNumber: {
         uint32_t length;
         if ((wt != WIRETYPE_LENGTH_DELIMITED) || !input.ReadVarint32(&length)) {
@@ -13,9 +13,15 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/distributed/heart_beat_monitor.h"
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <ctime>
 
+DEFINE_int32(worker_lost_heartbeat_secs, 0,
+             "the time interval after which a worker not updating any "
+             "variable is dropped from the barriers of the sync mode, 0 to "
+             "never drop the workers");
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -41,11 +47,16 @@ void HeartBeatMonitor::Update(const int worker_id, std::string be_monitored_var,
     return;
   }
 
+  bool heartbeat = FLAGS_worker_lost_heartbeat_secs > 0 && status == RUNNING;
   if ((be_monitored_var == be_monitored_var_ && status == RUNNING) ||
-      status == COMPLETED) {
+      status == COMPLETED || heartbeat) {
     auto timestamp = GetCurrentUS();
+    std::lock_guard<std::mutex> guard(mutex_);
     UnderMonitoredWorker& worker = worker_status_map_.at(worker_id);
 
+    if (worker.status == LOST) {
+      LOG(WARNING) << "worker " << worker_id << " is back";
+    }
     if (worker.status != COMPLETED) {
       worker.status = status;
     }
@@ -56,7 +67,14 @@ void HeartBeatMonitor::Update(const int worker_id, std::string be_monitored_var,
 
 void HeartBeatMonitor::LostWorkerMonitor() {
   VLOG(1) << "worker heartbeat monitor start at No.0 parameter server";
+  int check_interval_secs = 30;
+  if (FLAGS_worker_lost_heartbeat_secs > 0) {
+    check_interval_secs = std::max(
+        1, std::min(check_interval_secs, FLAGS_worker_lost_heartbeat_secs / 2));
+  }
   while (running_) {
+    std::vector<int> lost_workers;
+    std::unique_lock<std::mutex> lock(mutex_);
     for (int id = 0; id < workers_; ++id) {
       auto& worker = worker_status_map_.at(id);
 
@@ -68,6 +86,10 @@ void HeartBeatMonitor::LostWorkerMonitor() {
         VLOG(4) << "worker " << worker.id << " is under COMPLETED";
         continue;
       }
+      if (worker.status == LOST) {
+        VLOG(4) << "worker " << worker.id << " is under LOST";
+        continue;
+      }
 
       auto timestamp = GetCurrentUS();
 
@@ -75,6 +97,17 @@ void HeartBeatMonitor::LostWorkerMonitor() {
               << " timestamp is " << worker.timestamp << " the interval is "
               << timestamp - worker.timestamp;
 
+      if (FLAGS_worker_lost_heartbeat_secs > 0) {
+        if (timestamp - worker.timestamp >= FLAGS_worker_lost_heartbeat_secs) {
+          LOG(WARNING) << "the latest update of worker " << worker.id
+                       << " is " << timestamp - worker.timestamp
+                       << " secs ago, drop it as lost";
+          worker.status = LOST;
+          lost_workers.push_back(worker.id);
+        }
+        continue;
+      }
+
       if (timestamp - worker.timestamp >= FLAGS_worker_update_interval_secs) {
         PADDLE_THROW(
             "the latest update of worker %d is %d secs ago, we doubt the "
@@ -83,8 +116,16 @@ void HeartBeatMonitor::LostWorkerMonitor() {
             worker.id, FLAGS_worker_update_interval_secs);
       }
     }
+    auto handler = lost_worker_handler_;
+    lock.unlock();
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(30 * 1000));
+    if (handler) {
+      for (auto id : lost_workers) {
+        handler(id);
+      }
+    }
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(check_interval_secs * 1000));
   }
   VLOG(1) << "worker heartbeat monitor stopped, thread exit";
 }
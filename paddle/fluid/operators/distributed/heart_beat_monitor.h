@@ -35,7 +35,7 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
-enum WorkerStatus { UNINITED = 0, RUNNING, COMPLETED };
+enum WorkerStatus { UNINITED = 0, RUNNING, COMPLETED, LOST };
 
 struct UnderMonitoredWorker {
   int id;
@@ -101,6 +101,14 @@ class HeartBeatMonitor {
   void Update(const int worker_id, std::string be_monitored_var,
               WorkerStatus status);
 
+  // Called with the id of a worker missing its heartbeats for
+  // worker_lost_heartbeat_secs, after which the worker is taken as lost
+  // until it updates again.
+  void SetLostWorkerHandler(std::function<void(int)> handler) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    lost_worker_handler_ = std::move(handler);
+  }
+
   void LostWorkerMonitor();
 
  private:
@@ -120,6 +128,7 @@ class HeartBeatMonitor {
   std::string be_monitored_var_;
   std::unordered_map<int, UnderMonitoredWorker> worker_status_map_;
   std::unique_ptr<std::thread> monitor_thread_{nullptr};
+  std::function<void(int)> lost_worker_handler_;
   std::mutex mutex_;
   bool running_ = false;
 };
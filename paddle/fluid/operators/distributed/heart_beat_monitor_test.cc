@@ -15,10 +15,14 @@
 #include "paddle/fluid/operators/distributed/heart_beat_monitor.h"
 
 #include <algorithm>
+#include <mutex>  // NOLINT
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "gtest/gtest.h"
 
+DECLARE_int32(worker_lost_heartbeat_secs);
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -52,6 +56,41 @@ TEST(HeartBeatMonitor, All) {
   monitor->Stop();
 }
 
+TEST(HeartBeatMonitor, DropLostWorker) {
+  FLAGS_worker_lost_heartbeat_secs = 2;
+  std::string var = "w@GRAD";
+  HeartBeatMonitor monitor(3, true, var);
+  std::mutex mutex;
+  std::vector<int> lost;
+  monitor.SetLostWorkerHandler([&](int id) {
+    std::lock_guard<std::mutex> guard(mutex);
+    lost.push_back(id);
+  });
+
+  // any var updated is a heartbeat, and worker 2 never starts
+  monitor.Update(0, "fc_w@GRAD", RUNNING);
+  monitor.Update(1, var, RUNNING);
+  for (int i = 0; i < 20; ++i) {
+    monitor.Update(1, var, RUNNING);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    EXPECT_EQ(lost, std::vector<int>({0}));
+  }
+
+  // the lost worker is back
+  monitor.Update(0, var, RUNNING);
+  monitor.Update(1, var, COMPLETED);
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    EXPECT_EQ(lost, std::vector<int>({0}));
+  }
+  monitor.Stop();
+  FLAGS_worker_lost_heartbeat_secs = 0;
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
@@ -0,0 +1,218 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/host_aggregator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>  // NOLINT
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+namespace {
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "The lock in the shared memory should be lock free.");
+
+// The header of a slot in the shared memory, zero initialized by the
+// system when the segment is created.
+struct alignas(64) SlotHeader {
+  std::atomic<int> lock;
+  // the followers pushed to a gradient slot, or the version of the
+  // parameter slot
+  int64_t count;
+};
+
+class SlotLock {
+ public:
+  explicit SlotLock(SlotHeader* header) : header_(header) {
+    while (header_->lock.exchange(1, std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+  ~SlotLock() { header_->lock.store(0, std::memory_order_release); }
+
+ private:
+  SlotHeader* header_;
+};
+
+SlotHeader* HeaderOf(void* ptr, int slot) {
+  return reinterpret_cast<SlotHeader*>(ptr) + slot;
+}
+
+float* DataOf(void* ptr, int slots, int slot, int64_t numel) {
+  auto* data = reinterpret_cast<float*>(HeaderOf(ptr, slots));
+  return data + slot * numel;
+}
+
+}  // namespace
+
+HostAggregator::HostAggregator(const std::string& name, int local_trainers,
+                               int local_rank)
+    : name_(name), local_trainers_(local_trainers), local_rank_(local_rank) {
+  PADDLE_ENFORCE_GT(local_trainers_, 1,
+                    platform::errors::InvalidArgument(
+                        "The host aggregation needs more than 1 trainers, but "
+                        "got %d.",
+                        local_trainers_));
+  PADDLE_ENFORCE_EQ(
+      local_rank_ >= 0 && local_rank_ < local_trainers_, true,
+      platform::errors::InvalidArgument(
+          "The local rank %d should be in [0, %d).", local_rank_,
+          local_trainers_));
+  PADDLE_ENFORCE_EQ(name_.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "The name of the host aggregation is empty."));
+}
+
+HostAggregator::~HostAggregator() {
+  for (auto& iter : segments_) {
+    auto& segment = iter.second;
+    munmap(segment.ptr, segment.size);
+    if (IsLeader()) {
+      shm_unlink(segment.shm_name.c_str());
+    }
+  }
+}
+
+HostAggregator::Segment* HostAggregator::GetSegment(
+    const std::string& var_name, int64_t numel) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = segments_.find(var_name);
+  if (it != segments_.end()) {
+    PADDLE_ENFORCE_EQ(it->second.numel, numel,
+                      platform::errors::InvalidArgument(
+                          "The var %s is aggregated with %d elements, but "
+                          "got %d.",
+                          var_name, it->second.numel, numel));
+    return &it->second;
+  }
+
+  Segment segment;
+  segment.shm_name = "/" + name_ + "_" + var_name;
+  std::replace(segment.shm_name.begin() + 1, segment.shm_name.end(), '/',
+               '_');
+  segment.size = local_trainers_ * sizeof(SlotHeader) +
+                 local_trainers_ * numel * sizeof(float);
+  segment.numel = numel;
+  // Any trainer may create the segment first, and all of them truncate it
+  // to the same size.
+  int fd = shm_open(segment.shm_name.c_str(), O_RDWR | O_CREAT, 0600);
+  PADDLE_ENFORCE_NE(fd, -1, platform::errors::Unavailable(
+                                "Fail to open the shared memory %s.",
+                                segment.shm_name));
+  PADDLE_ENFORCE_EQ(ftruncate(fd, segment.size), 0,
+                    platform::errors::Unavailable(
+                        "Fail to truncate the shared memory %s to %d bytes.",
+                        segment.shm_name, segment.size));
+  segment.ptr =
+      mmap(NULL, segment.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(segment.ptr, MAP_FAILED,
+                    platform::errors::Unavailable(
+                        "Fail to map the shared memory %s.", segment.shm_name));
+  VLOG(1) << "map the shared memory " << segment.shm_name << " of "
+          << segment.size << " bytes";
+  return &segments_.emplace(var_name, segment).first->second;
+}
+
+void HostAggregator::PushGrad(const std::string& var_name, const float* grad,
+                              int64_t numel) {
+  PADDLE_ENFORCE_EQ(IsLeader(), false,
+                    platform::errors::PreconditionNotMet(
+                        "The leader trainer should not push the gradients."));
+  auto* segment = GetSegment(var_name, numel);
+  auto* header = HeaderOf(segment->ptr, local_rank_);
+  float* data = DataOf(segment->ptr, local_trainers_, local_rank_, numel);
+  SlotLock lock(header);
+  if (header->count == 0) {
+    std::memcpy(data, grad, numel * sizeof(float));
+  } else {
+    for (int64_t i = 0; i < numel; ++i) {
+      data[i] += grad[i];
+    }
+  }
+  header->count = 1;
+}
+
+bool HostAggregator::HasPendingGrads(const std::string& var_name,
+                                     int64_t numel) {
+  auto* segment = GetSegment(var_name, numel);
+  for (int slot = 1; slot < local_trainers_; ++slot) {
+    auto* header = HeaderOf(segment->ptr, slot);
+    SlotLock lock(header);
+    if (header->count > 0) return true;
+  }
+  return false;
+}
+
+int HostAggregator::TakeGrads(const std::string& var_name, float* grad,
+                              int64_t numel) {
+  PADDLE_ENFORCE_EQ(IsLeader(), true,
+                    platform::errors::PreconditionNotMet(
+                        "Only the leader trainer takes the gradients."));
+  auto* segment = GetSegment(var_name, numel);
+  int taken = 0;
+  for (int slot = 1; slot < local_trainers_; ++slot) {
+    auto* header = HeaderOf(segment->ptr, slot);
+    const float* data = DataOf(segment->ptr, local_trainers_, slot, numel);
+    SlotLock lock(header);
+    if (header->count == 0) continue;
+    for (int64_t i = 0; i < numel; ++i) {
+      grad[i] += data[i];
+    }
+    header->count = 0;
+    ++taken;
+  }
+  return taken;
+}
+
+void HostAggregator::PublishParam(const std::string& var_name,
+                                  const float* param, int64_t numel) {
+  PADDLE_ENFORCE_EQ(IsLeader(), true,
+                    platform::errors::PreconditionNotMet(
+                        "Only the leader trainer publishes the parameters."));
+  auto* segment = GetSegment(var_name, numel);
+  auto* header = HeaderOf(segment->ptr, 0);
+  SlotLock lock(header);
+  std::memcpy(DataOf(segment->ptr, local_trainers_, 0, numel), param,
+              numel * sizeof(float));
+  ++header->count;
+}
+
+bool HostAggregator::FetchParam(const std::string& var_name, float* param,
+                                int64_t numel) {
+  auto* segment = GetSegment(var_name, numel);
+  auto* header = HeaderOf(segment->ptr, 0);
+  SlotLock lock(header);
+  if (header->count == 0) return false;
+  std::memcpy(param, DataOf(segment->ptr, local_trainers_, 0, numel),
+              numel * sizeof(float));
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,84 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The aggregation of the dense gradients and parameters of the trainers on
+// a host over the shared memory, so that only the leader trainer, the local
+// rank 0, communicates with the pservers.
+//
+// Each var has a shared memory segment named by the aggregation name and
+// the var, with a slot of the latest parameter published by the leader and
+// a slot of the accumulated gradient for each follower. The followers add
+// their gradients into their slots, and the leader takes them out and adds
+// them into its own before sending. The leader publishes the parameters it
+// receives, and the followers fetch them instead of receiving.
+//
+// The name should be unique to the job on the host, the segments are
+// removed by the leader.
+class HostAggregator {
+ public:
+  HostAggregator(const std::string& name, int local_trainers, int local_rank);
+  ~HostAggregator();
+
+  bool IsLeader() const { return local_rank_ == 0; }
+
+  // Add the gradient of the follower into its slot.
+  void PushGrad(const std::string& var_name, const float* grad,
+                int64_t numel);
+
+  bool HasPendingGrads(const std::string& var_name, int64_t numel);
+
+  // Add the gradients of the followers pushed since the last take into grad
+  // on the leader, and return the number of the followers taken.
+  int TakeGrads(const std::string& var_name, float* grad, int64_t numel);
+
+  void PublishParam(const std::string& var_name, const float* param,
+                    int64_t numel);
+
+  // Copy the parameter published by the leader into param, return false if
+  // it is not published yet.
+  bool FetchParam(const std::string& var_name, float* param, int64_t numel);
+
+ private:
+  struct Segment {
+    std::string shm_name;
+    void* ptr;
+    size_t size;
+    int64_t numel;
+  };
+
+  Segment* GetSegment(const std::string& var_name, int64_t numel);
+
+  const std::string name_;
+  const int local_trainers_;
+  const int local_rank_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Segment> segments_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
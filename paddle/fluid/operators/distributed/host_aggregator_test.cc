@@ -0,0 +1,80 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/host_aggregator.h"
+
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// the trainers of a host are simulated by the aggregators in one process
+std::string AggregationName() {
+  return "paddle_host_aggregator_test_" + std::to_string(getpid());
+}
+
+TEST(HostAggregator, grads) {
+  auto name = AggregationName();
+  HostAggregator leader(name, 3, 0);
+  HostAggregator follower1(name, 3, 1);
+  HostAggregator follower2(name, 3, 2);
+
+  std::vector<float> grad{1, 2, 3};
+  EXPECT_FALSE(leader.HasPendingGrads("w@GRAD", 3));
+  follower1.PushGrad("w@GRAD", grad.data(), 3);
+  // the gradients pushed before the leader takes them are accumulated
+  follower1.PushGrad("w@GRAD", grad.data(), 3);
+  follower2.PushGrad("w@GRAD", grad.data(), 3);
+  EXPECT_TRUE(leader.HasPendingGrads("w@GRAD", 3));
+
+  std::vector<float> merged{10, 20, 30};
+  EXPECT_EQ(leader.TakeGrads("w@GRAD", merged.data(), 3), 2);
+  EXPECT_EQ(merged, std::vector<float>({13, 26, 39}));
+  EXPECT_FALSE(leader.HasPendingGrads("w@GRAD", 3));
+  EXPECT_EQ(leader.TakeGrads("w@GRAD", merged.data(), 3), 0);
+  EXPECT_EQ(merged, std::vector<float>({13, 26, 39}));
+
+  EXPECT_ANY_THROW(leader.PushGrad("w@GRAD", grad.data(), 3));
+  EXPECT_ANY_THROW(follower1.TakeGrads("w@GRAD", merged.data(), 3));
+  // the numel of a var is fixed
+  EXPECT_ANY_THROW(follower1.PushGrad("w@GRAD", grad.data(), 2));
+}
+
+TEST(HostAggregator, params) {
+  auto name = AggregationName();
+  HostAggregator leader(name, 2, 0);
+  HostAggregator follower(name, 2, 1);
+
+  std::vector<float> param{-1, -1};
+  EXPECT_FALSE(follower.FetchParam("w", param.data(), 2));
+  std::vector<float> recved{0.5f, 1.5f};
+  leader.PublishParam("w", recved.data(), 2);
+  EXPECT_TRUE(follower.FetchParam("w", param.data(), 2));
+  EXPECT_EQ(param, recved);
+}
+
+TEST(HostAggregator, invalid) {
+  EXPECT_ANY_THROW(HostAggregator("x", 1, 0));
+  EXPECT_ANY_THROW(HostAggregator("x", 2, 2));
+  EXPECT_ANY_THROW(HostAggregator("", 2, 0));
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
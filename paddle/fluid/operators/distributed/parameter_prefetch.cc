@@ -28,6 +28,7 @@
 #include "paddle/fluid/framework/tensor.h"
 
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
@@ -229,8 +230,32 @@ void prefetchs(const std::vector<std::string>& id_var_names,
   }
 
   std::unordered_map<int64_t, std::vector<float>> recved_vec_map;
-  prefetch_core(ids_union, tables, height_sections, context, scope,
-                &recved_vec_map);
+  auto* cache = PrefetchCache::GetInstance(persistable_var_name);
+  if (cache != nullptr) {
+    // only the ids not cached are prefetched
+    cache->NextStep();
+    std::vector<int64_t> missed_ids;
+    std::vector<float> row;
+    for (auto id : ids_union) {
+      if (cache->Lookup(id, &row)) {
+        recved_vec_map[id] = row;
+      } else {
+        missed_ids.push_back(id);
+      }
+    }
+    VLOG(3) << "prefetch " << missed_ids.size() << " of " << ids_union.size()
+            << " ids of " << persistable_var_name << " not cached";
+    if (!missed_ids.empty()) {
+      prefetch_core(missed_ids, tables, height_sections, context, scope,
+                    &recved_vec_map);
+    }
+    for (auto id : missed_ids) {
+      cache->Insert(id, recved_vec_map[id]);
+    }
+  } else {
+    prefetch_core(ids_union, tables, height_sections, context, scope,
+                  &recved_vec_map);
+  }
 
   auto padding_idx = distributed::kNoPadding;
 
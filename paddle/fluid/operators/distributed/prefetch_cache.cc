@@ -0,0 +1,114 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+DEFINE_int64(prefetch_cache_capacity, 0,
+             "The max rows cached on the trainer for each distributed lookup "
+             "table, 0 to disable the cache.");
+DEFINE_int64(prefetch_cache_max_staleness, 10,
+             "The rows of the prefetch cache are fetched again after this "
+             "number of steps.");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+void PrefetchCache::NextStep() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++step_;
+}
+
+bool PrefetchCache::Lookup(int64_t id, std::vector<float>* out) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = index_.find(id);
+  if (it == index_.end()) return false;
+  if (step_ - it->second->step > max_staleness_) {
+    rows_.erase(it->second);
+    index_.erase(it);
+    return false;
+  }
+  rows_.splice(rows_.begin(), rows_, it->second);
+  *out = it->second->value;
+  return true;
+}
+
+void PrefetchCache::Insert(int64_t id, const std::vector<float>& row) {
+  if (capacity_ == 0) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = index_.find(id);
+  if (it != index_.end()) {
+    it->second->step = step_;
+    it->second->value = row;
+    rows_.splice(rows_.begin(), rows_, it->second);
+    return;
+  }
+  if (rows_.size() >= capacity_) {
+    index_.erase(rows_.back().id);
+    rows_.pop_back();
+  }
+  rows_.push_front(Row{id, step_, row});
+  index_[id] = rows_.begin();
+}
+
+void PrefetchCache::Invalidate(const std::vector<int64_t>& ids) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto id : ids) {
+    auto it = index_.find(id);
+    if (it != index_.end()) {
+      rows_.erase(it->second);
+      index_.erase(it);
+    }
+  }
+}
+
+size_t PrefetchCache::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return rows_.size();
+}
+
+static std::mutex caches_mutex;
+static std::unordered_map<std::string, std::unique_ptr<PrefetchCache>> caches;
+
+PrefetchCache* PrefetchCache::GetInstance(const std::string& table_name) {
+  if (FLAGS_prefetch_cache_capacity <= 0) return nullptr;
+  std::lock_guard<std::mutex> guard(caches_mutex);
+  auto& cache = caches[table_name];
+  if (cache == nullptr) {
+    VLOG(1) << "create the prefetch cache of " << table_name << " with "
+            << FLAGS_prefetch_cache_capacity << " rows";
+    cache.reset(new PrefetchCache(FLAGS_prefetch_cache_capacity,
+                                  FLAGS_prefetch_cache_max_staleness));
+  }
+  return cache.get();
+}
+
+void PrefetchCache::InvalidateRows(const std::string& table_name,
+                                   const std::vector<int64_t>& ids) {
+  PrefetchCache* cache = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(caches_mutex);
+    auto it = caches.find(table_name);
+    if (it == caches.end()) return;
+    cache = it->second.get();
+  }
+  cache->Invalidate(ids);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,81 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The trainer side cache of the rows prefetched from a distributed lookup
+// table, so that only the ids not cached are prefetched from the pservers.
+//
+// At most capacity rows are kept, the least recently used row is evicted
+// first. A row fetched more than max_staleness steps ago is fetched again,
+// where a step is a prefetch of the table, and the rows updated by the
+// sparse gradients of this trainer are invalidated.
+class PrefetchCache {
+ public:
+  PrefetchCache(size_t capacity, int64_t max_staleness)
+      : capacity_(capacity), max_staleness_(max_staleness) {}
+
+  // Start the prefetch of the next batch.
+  void NextStep();
+
+  // Copy the row of id into out if it is cached and not stale.
+  bool Lookup(int64_t id, std::vector<float>* out);
+
+  void Insert(int64_t id, const std::vector<float>& row);
+
+  void Invalidate(const std::vector<int64_t>& ids);
+
+  size_t Size();
+
+  // The cache of the table created by the flag prefetch_cache_capacity, or
+  // nullptr if the cache is disabled.
+  static PrefetchCache* GetInstance(const std::string& table_name);
+
+  // Invalidate the rows of the table if it has a cache.
+  static void InvalidateRows(const std::string& table_name,
+                             const std::vector<int64_t>& ids);
+
+ private:
+  struct Row {
+    int64_t id;
+    int64_t step;
+    std::vector<float> value;
+  };
+
+  const size_t capacity_;
+  const int64_t max_staleness_;
+
+  std::mutex mutex_;
+  int64_t step_{0};
+  // in the order of the last use, the most recent first
+  std::list<Row> rows_;
+  std::unordered_map<int64_t, std::list<Row>::iterator> index_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,93 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+DECLARE_int64(prefetch_cache_capacity);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(PrefetchCache, lookup) {
+  PrefetchCache cache(4, 10);
+  std::vector<float> row;
+  EXPECT_FALSE(cache.Lookup(1, &row));
+  cache.Insert(1, {1.0f, 2.0f});
+  ASSERT_TRUE(cache.Lookup(1, &row));
+  EXPECT_EQ(row, std::vector<float>({1.0f, 2.0f}));
+  cache.Insert(1, {3.0f, 4.0f});
+  ASSERT_TRUE(cache.Lookup(1, &row));
+  EXPECT_EQ(row, std::vector<float>({3.0f, 4.0f}));
+  EXPECT_EQ(cache.Size(), 1UL);
+}
+
+TEST(PrefetchCache, evict_least_recently_used) {
+  PrefetchCache cache(2, 10);
+  std::vector<float> row;
+  cache.Insert(1, {1.0f});
+  cache.Insert(2, {2.0f});
+  // 2 becomes the least recently used
+  EXPECT_TRUE(cache.Lookup(1, &row));
+  cache.Insert(3, {3.0f});
+  EXPECT_EQ(cache.Size(), 2UL);
+  EXPECT_TRUE(cache.Lookup(1, &row));
+  EXPECT_FALSE(cache.Lookup(2, &row));
+  EXPECT_TRUE(cache.Lookup(3, &row));
+}
+
+TEST(PrefetchCache, staleness) {
+  PrefetchCache cache(4, 2);
+  std::vector<float> row;
+  cache.Insert(1, {1.0f});
+  cache.NextStep();
+  cache.NextStep();
+  EXPECT_TRUE(cache.Lookup(1, &row));
+  cache.NextStep();
+  EXPECT_FALSE(cache.Lookup(1, &row));
+  EXPECT_EQ(cache.Size(), 0UL);
+}
+
+TEST(PrefetchCache, invalidate) {
+  PrefetchCache cache(4, 10);
+  std::vector<float> row;
+  cache.Insert(1, {1.0f});
+  cache.Insert(2, {2.0f});
+  cache.Invalidate({2, 5});
+  EXPECT_TRUE(cache.Lookup(1, &row));
+  EXPECT_FALSE(cache.Lookup(2, &row));
+}
+
+TEST(PrefetchCache, instance) {
+  FLAGS_prefetch_cache_capacity = 0;
+  EXPECT_EQ(PrefetchCache::GetInstance("emb"), nullptr);
+  // the rows of the tables without caches are ignored
+  PrefetchCache::InvalidateRows("emb", {1});
+
+  FLAGS_prefetch_cache_capacity = 8;
+  auto* cache = PrefetchCache::GetInstance("emb");
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(PrefetchCache::GetInstance("emb"), cache);
+  cache->Insert(1, {1.0f});
+  PrefetchCache::InvalidateRows("emb", {1});
+  std::vector<float> row;
+  EXPECT_FALSE(cache->Lookup(1, &row));
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
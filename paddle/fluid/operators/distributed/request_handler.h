@@ -66,6 +66,7 @@ constexpr char kCheckPointNotifyRPC[] = "CheckPointNotifyRPC";
 #define LEARNING_RATE_DECAY_COUNTER "@LR_DECAY_COUNTER@"
 
 #define CHECKPOINT_SAVE_MESSAGE "SAVE@CHECKPOINTNOTIFY"
+#define CHECKPOINT_DELTA_SAVE_MESSAGE "SAVE_DELTA@CHECKPOINTNOTIFY"
 #define CHECKPOINT_LOAD_MESSAGE "LOAD@CHECKPOINTNOTIFY"
 
 enum DistributedMode { kSync = 0, kAsync = 1, kHalfAsync = 2, kGeo = 3 };
@@ -151,6 +152,8 @@ class VarHandle {
 
 typedef std::shared_ptr<VarHandle> VarHandlePtr;
 
+class AsyncOptimizeRunner;
+
 class RequestHandler {
  public:
   explicit RequestHandler(int distributed_mode)
@@ -159,6 +162,7 @@ class RequestHandler {
         executor_(nullptr),
         scope_(nullptr),
         program_(nullptr),
+        async_optimize_runner_(nullptr),
         rpc_server_(nullptr) {}
 
   virtual ~RequestHandler() {}
@@ -188,6 +192,10 @@ class RequestHandler {
     grad_to_prepared_ctx_ = g;
   }
 
+  void SetAsyncOptimizeRunner(AsyncOptimizeRunner* runner) {
+    async_optimize_runner_ = runner;
+  }
+
   void SetSparseGradToParam(std::unordered_map<std::string, std::string>* g) {
     sparse_grad_to_param_ = g;
   }
@@ -246,6 +254,8 @@ class RequestHandler {
                      std::shared_ptr<framework::ExecutorPrepareContext>>*
       grad_to_prepared_ctx_;
   std::unordered_map<std::string, std::string>* sparse_grad_to_param_;
+  // runs the optimize blocks out of the rpc threads if set
+  AsyncOptimizeRunner* async_optimize_runner_;
 
   // used for lr decay
   std::shared_ptr<framework::ExecutorPrepareContext> lr_decay_prepared_ctx_;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/distributed/request_handler_impl.h"
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -22,13 +23,16 @@
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/operators/distributed/rpc_server.h"
 #include "paddle/fluid/string/piece.h"
 #include "paddle/fluid/string/printf.h"
 #include "paddle/fluid/string/split.h"
 
+#include "paddle/fluid/operators/distributed/async_optimize_runner.h"
 #include "paddle/fluid/operators/distributed/async_sparse_param_update_recorder.h"
 #include "paddle/fluid/operators/distributed/heart_beat_monitor.h"
+#include "paddle/fluid/operators/distributed/sparse_table_delta_recorder.h"
 
 namespace paddle {
 namespace operators {
@@ -38,6 +42,60 @@ namespace distributed {
 // to directory specified.
 constexpr char LOOKUP_TABLE_PATH[] = "kLookupTablePath";
 
+// Record the rows of the sparse table updated by the received gradient for
+// the delta checkpoints.
+static void RecordTableDelta(const std::string& grad_name,
+                             const framework::Variable* var) {
+  auto* recorder = SparseTableDeltaRecorder::GetInstance();
+  if (recorder == nullptr || var == nullptr || !recorder->HasGrad(grad_name) ||
+      !var->IsType<framework::SelectedRows>()) {
+    return;
+  }
+  recorder->Update(grad_name, var->Get<framework::SelectedRows>().rows());
+}
+
+// Record the heartbeat of the trainer in the sync mode, and readmit the
+// trainer if it is dropped as lost. Return whether it is dropped, whose
+// barriers are not counted until the next round.
+static bool SyncHeartBeat(RPCServer* rpc_server, const int trainer_id,
+                          const std::string& varname) {
+  if (HeartBeatMonitor::GetInstance() == nullptr) return false;
+  HeartBeatMonitor::GetInstance()->Update(trainer_id, varname, RUNNING);
+  if (!rpc_server->IsClientDropped(trainer_id)) return false;
+  rpc_server->RejoinClient(trainer_id);
+  return true;
+}
+
+// Write the rows of the table into file_path, in the format of the table
+// saved by the save op, with the height of the table.
+static void SaveTableRows(framework::SelectedRows* table,
+                          const std::vector<int64_t>& rows,
+                          const std::string& file_path,
+                          const platform::DeviceContext& dev_ctx) {
+  framework::SelectedRows delta(rows, table->height());
+  auto dims = table->value().dims();
+  dims[0] = static_cast<int64_t>(rows.size());
+  auto* value = delta.mutable_value();
+  value->Resize(dims);
+  value->mutable_data(platform::CPUPlace(), table->value().type());
+  if (!rows.empty()) {
+    framework::Tensor ids;
+    auto* ids_data = ids.mutable_data<int64_t>(
+        {static_cast<int64_t>(rows.size())}, platform::CPUPlace());
+    std::copy(rows.begin(), rows.end(), ids_data);
+    table->Get(ids, value, false, true);
+  }
+
+  MkDirRecursively(DirName(file_path).c_str());
+  std::ofstream fout(file_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable(
+                        "Cannot open %s to save the delta of the sparse "
+                        "table.",
+                        file_path));
+  framework::SerializeToStream(fout, delta, dev_ctx);
+}
+
 bool RequestSendHandler::Handle(const std::string& varname,
                                 framework::Scope* scope,
                                 framework::Variable* invar,
@@ -50,6 +108,10 @@ bool RequestSendHandler::Handle(const std::string& varname,
   // Sync
   if (varname == BATCH_BARRIER_MESSAGE) {
     VLOG(3) << "sync: recv BATCH_BARRIER_MESSAGE";
+    if (SyncHeartBeat(rpc_server_, trainer_id, varname)) {
+      VLOG(3) << "sync: skip the barrier of dropped trainer " << trainer_id;
+      return true;
+    }
     rpc_server_->IncreaseBatchBarrier(kRequestSend);
   } else if (varname == COMPLETE_MESSAGE) {
     VLOG(3) << "sync: recv complete message";
@@ -58,7 +120,10 @@ bool RequestSendHandler::Handle(const std::string& varname,
       HeartBeatMonitor::GetInstance()->Update(trainer_id, "", COMPLETED);
     }
 
-    rpc_server_->Complete();
+    // the dropped trainer is not counted already
+    if (!rpc_server_->IsClientDropped(trainer_id)) {
+      rpc_server_->Complete();
+    }
   } else {
     // Async
     if (distributed_mode_ != DistributedMode::kSync) {
@@ -89,11 +154,17 @@ bool RequestSendHandler::Handle(const std::string& varname,
         AsyncSparseParamUpdateRecorder::GetInstance()->Update(run_varname,
                                                               grad_slr.rows());
       }
+      RecordTableDelta(run_varname, scope->FindVar(run_varname));
+      if (async_optimize_runner_ != nullptr &&
+          async_optimize_runner_->Push(run_varname, scope)) {
+        return true;
+      }
       executor_->RunPreparedContext((*grad_to_prepared_ctx_)[run_varname].get(),
                                     scope);
 
       return true;
     } else {  // sync
+      SyncHeartBeat(rpc_server_, trainer_id, varname);
       rpc_server_->WaitCond(kRequestSend);
       VLOG(3) << "sync: processing received var: " << varname;
 
@@ -101,6 +172,7 @@ bool RequestSendHandler::Handle(const std::string& varname,
         LOG(FATAL) << "sync: Can not find server side var: " << varname;
         return false;
       }
+      RecordTableDelta(varname, invar);
     }
   }
   return true;
@@ -120,8 +192,13 @@ bool RequestGetHandler::Handle(const std::string& varname,
   if (distributed_mode_ == DistributedMode::kSync) {
     if (varname == FETCH_BARRIER_MESSAGE) {
       VLOG(3) << "sync: recv fetch barrier message";
+      if (SyncHeartBeat(rpc_server_, trainer_id, varname)) {
+        VLOG(3) << "sync: skip the barrier of dropped trainer " << trainer_id;
+        return true;
+      }
       rpc_server_->IncreaseBatchBarrier(kRequestGet);
     } else {
+      SyncHeartBeat(rpc_server_, trainer_id, varname);
       rpc_server_->WaitCond(kRequestGet);
       *outvar = scope_->FindVar(varname);
     }
@@ -249,6 +326,46 @@ bool RequestCheckpointHandler::Handle(const std::string& varname,
       checkpoint_notify_id != -1,
       "when checkpoint_notify_id = -1, there should be no RPC invoke.");
 
+  // the table is the input of the save op in the checkpoint block
+  std::string lookup_table_name;
+  for (auto& op : checkpoint_prepared_ctx_->ops_) {
+    if (op->Type() == "save") {
+      lookup_table_name = op->Input("X");
+    }
+  }
+  auto* recorder = SparseTableDeltaRecorder::GetInstance();
+  bool recorded = recorder != nullptr && recorder->HasTable(lookup_table_name);
+
+  if (varname == CHECKPOINT_DELTA_SAVE_MESSAGE) {
+    PADDLE_ENFORCE_EQ(recorded, true,
+                      platform::errors::PreconditionNotMet(
+                          "The updated rows of the sparse table %s are not "
+                          "recorded for the delta checkpoint.",
+                          lookup_table_name));
+    std::vector<int64_t> rows;
+    recorder->TakeRows(lookup_table_name, &rows);
+    VLOG(4) << "RequestCheckpointHandler save " << rows.size()
+            << " updated rows of " << lookup_table_name << " to "
+            << out_var_name;
+    auto* table = scope_->FindVar(lookup_table_name)
+                      ->GetMutable<framework::SelectedRows>();
+    try {
+      SaveTableRows(table, rows, out_var_name, *dev_ctx_);
+    } catch (...) {
+      // the rows are saved by the next delta
+      recorder->AddRows(lookup_table_name, rows);
+      throw;
+    }
+    return true;
+  }
+
+  // a full checkpoint is the new base of the deltas, the rows updated
+  // during the save are saved by the next delta
+  if (recorded) {
+    std::vector<int64_t> rows;
+    recorder->TakeRows(lookup_table_name, &rows);
+  }
+
   // TODO(tangwei12): find out why scope will be error.
   auto* lt_var = scope_->FindVar(LOOKUP_TABLE_PATH)->GetMutable<std::string>();
   lt_var->clear();
@@ -46,7 +46,8 @@ void RPCServer::WaitBarrier(const std::string& rpc_name) {
   VLOG(3) << "WaitBarrier in: " << rpc_name;
   std::unique_lock<std::mutex> lock(this->mutex_);
   barrier_cond_.wait(lock, [this, &rpc_name] {
-    return ((barrier_counter_[rpc_name] == client_num_ && client_num_ != 0) ||
+    // the barrier of a client dropped in the round may be counted
+    return ((barrier_counter_[rpc_name] >= client_num_ && client_num_ != 0) ||
             exit_flag_.load());
   });
 
@@ -85,6 +86,34 @@ void RPCServer::Complete() {
   barrier_cond_.notify_all();
 }
 
+void RPCServer::DropClient(int client_id) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (dropped_clients_.count(client_id) > 0) return;
+    dropped_clients_.insert(client_id);
+    client_num_--;
+    // the gradients of the dropped client are not sent any more
+    need_reset_all_vars_ = true;
+    LOG(WARNING) << "drop client " << client_id << ", decrease client_num to "
+                 << client_num_;
+  }
+  barrier_cond_.notify_all();
+}
+
+bool RPCServer::IsClientDropped(int client_id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return dropped_clients_.count(client_id) > 0;
+}
+
+void RPCServer::RejoinClient(int client_id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (dropped_clients_.count(client_id) == 0) return;
+  if (rejoined_clients_.insert(client_id).second) {
+    LOG(WARNING) << "client " << client_id
+                 << " rejoins the barriers from the next round";
+  }
+}
+
 bool RPCServer::NeedResetAllVars() {
   std::unique_lock<std::mutex> lock(mutex_);
   return need_reset_all_vars_;
@@ -102,6 +131,13 @@ void RPCServer::ResetBarrierCounter() {
     t.second = 0;
   }
   need_reset_all_vars_ = false;
+  for (auto client_id : rejoined_clients_) {
+    dropped_clients_.erase(client_id);
+    client_num_++;
+    VLOG(3) << "readmit client " << client_id << ", increase client_num to "
+            << client_num_;
+  }
+  rejoined_clients_.clear();
 }
 
 void RPCServer::RegisterRPC(const std::string& rpc_name,
@@ -101,6 +101,18 @@ class RPCServer {
 
   void Complete();
 
+  // Drop a lost client from the barriers, which are then reached by the
+  // rest of the clients.
+  void DropClient(int client_id);
+
+  // Whether the client is dropped, or is readmitted but not counted by
+  // the barriers until the next round.
+  bool IsClientDropped(int client_id);
+
+  // Readmit a dropped client, e.g. a replacement of the lost trainer, which
+  // is counted by the barriers again from the next round.
+  void RejoinClient(int client_id);
+
   void ResetBarrierCounter();
 
   bool NeedResetAllVars();
@@ -112,6 +124,8 @@ class RPCServer {
   std::mutex mutex_;
   std::unordered_map<std::string, int> barrier_counter_;
   std::condition_variable barrier_cond_;
+  std::set<int> dropped_clients_;
+  std::set<int> rejoined_clients_;
 
   std::unordered_map<std::string, int> rpc_cond_map_;
   std::atomic<int> cur_cond_;
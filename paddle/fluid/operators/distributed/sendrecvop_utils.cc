@@ -16,9 +16,12 @@ limitations under the License. */
 #include <nccl.h>
 #endif
 #include <memory>
+#include <mutex>  // NOLINT
 #include <thread>  // NOLINT
+#include <unordered_map>
 
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/operators/distributed/grad_compression.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include "paddle/fluid/platform/port.h"
@@ -33,22 +36,37 @@ namespace distributed {
 
 using VarMsg = sendrecv::VariableMessage;
 
+#ifdef PADDLE_WITH_CUDA
+std::shared_ptr<memory::Allocation> GetPinnedStagingBuffer(
+    const std::string& var_name, size_t size) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::shared_ptr<memory::Allocation>>
+      buffers;
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& buffer = buffers[var_name];
+  if (buffer == nullptr || buffer.use_count() > 1 || buffer->size() < size) {
+    buffer = memory::AllocShared(platform::CUDAPinnedPlace(), size);
+  }
+  return buffer;
+}
+#endif
+
 static TensorPayload GetCommunicationAllocationFromTensor(
-    const platform::DeviceContext& ctx, const framework::Tensor& tensor) {
+    const platform::DeviceContext& ctx, const framework::Tensor& tensor,
+    const std::string& var_name) {
   if (is_gpu_place(ctx.GetPlace())) {
 #ifdef PADDLE_WITH_CUDA
     PADDLE_ENFORCE(is_gpu_place(tensor.place()));
     auto& gpu_dev_ctx =
         reinterpret_cast<const platform::CUDADeviceContext&>(ctx);
     auto copy_size = tensor.numel() * framework::SizeOfType(tensor.type());
-    platform::CUDAPinnedPlace cuda_pinned;
-    auto result = memory::AllocShared(cuda_pinned, copy_size);
+    auto result = GetPinnedStagingBuffer(var_name, copy_size);
 
-    memory::Copy(cuda_pinned, result->ptr(),
+    memory::Copy(platform::CUDAPinnedPlace(), result->ptr(),
                  boost::get<platform::CUDAPlace>(tensor.place()),
                  tensor.data<void>(), copy_size, gpu_dev_ctx.stream());
     ctx.Wait();
-    return TensorPayload(result);
+    return TensorPayload(result, copy_size);
 #else
     PADDLE_THROW("This situation should not be happened");
 #endif
@@ -56,6 +74,27 @@ static TensorPayload GetCommunicationAllocationFromTensor(
     return TensorPayload(tensor);
   }
 }
+// Compress the FP32 payload of the var set by SetSendCompression.
+static TensorPayload CompressPayload(const framework::Tensor& tensor,
+                                     const TensorPayload& payload,
+                                     VarMsg* request) {
+  auto compression = GetSendCompression(request->varname());
+  if (compression == GradCompression::kNone ||
+      tensor.type() != framework::proto::VarType::FP32 ||
+      tensor.numel() == 0) {
+    return payload;
+  }
+  // the rows of a 2-D or higher tensor have their own int8 scales
+  int64_t rows = tensor.dims().size() > 1 ? tensor.dims()[0] : 1;
+  int64_t width = tensor.numel() / rows;
+  size_t bytes = CompressedGradBytes(compression, rows, width);
+  auto compressed = memory::AllocShared(platform::CPUPlace(), bytes);
+  CompressGrad(compression, static_cast<const float*>(payload.ptr()), rows,
+               width, compressed->ptr());
+  request->set_compression(static_cast<int>(compression));
+  return TensorPayload(compressed, bytes);
+}
+
 TensorPayload GetTensorPayload(framework::Variable* var,
                                const platform::DeviceContext& ctx,
                                VarMsg* request) {
@@ -76,7 +115,10 @@ TensorPayload GetTensorPayload(framework::Variable* var,
       }
     }
   }
-  return GetCommunicationAllocationFromTensor(ctx, tensor);
+  return CompressPayload(
+      tensor,
+      GetCommunicationAllocationFromTensor(ctx, tensor, request->varname()),
+      request);
 }
 
 TensorPayload GetSelectedRowsPayload(framework::Variable* var,
@@ -92,11 +134,17 @@ TensorPayload GetSelectedRowsPayload(framework::Variable* var,
   }
 
   auto* tensor = slr->mutable_value();
-  return GetCommunicationAllocationFromTensor(ctx, *tensor);
+  return CompressPayload(
+      *tensor,
+      GetCommunicationAllocationFromTensor(ctx, *tensor, request->varname()),
+      request);
 }
 
 TensorPayload::TensorPayload(std::shared_ptr<memory::Allocation> allocation)
     : allocation_(allocation), offset_(0), memory_size_(allocation->size()) {}
+TensorPayload::TensorPayload(std::shared_ptr<memory::Allocation> allocation,
+                             size_t memory_size)
+    : allocation_(allocation), offset_(0), memory_size_(memory_size) {}
 TensorPayload::TensorPayload(const framework::Tensor& tensor)
     : allocation_(tensor.Holder()),
       offset_(tensor.offset()),
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 #include <iostream>
+#include <memory>
 #include <string>
 #include <typeindex>
 #include <vector>
@@ -37,6 +38,9 @@ class TensorPayload final {
  public:
   explicit TensorPayload(const framework::Tensor& tensor);
   explicit TensorPayload(std::shared_ptr<memory::Allocation> allocation);
+  // the allocation may be larger than the payload
+  TensorPayload(std::shared_ptr<memory::Allocation> allocation,
+                size_t memory_size);
 
   TensorPayload(const TensorPayload& o) = default;
   TensorPayload& operator=(const TensorPayload& o) = default;
@@ -65,6 +69,14 @@ TensorPayload GetSelectedRowsPayload(framework::Variable* var,
                                      const platform::DeviceContext& ctx,
                                      VarMsg* request);
 
+#ifdef PADDLE_WITH_CUDA
+// The pinned buffer of the var to stage the copies between the GPU and the
+// rpc messages. It is reused across the steps, unless the last one is still
+// held, e.g. by a message in flight, or smaller than size.
+std::shared_ptr<memory::Allocation> GetPinnedStagingBuffer(
+    const std::string& var_name, size_t size);
+#endif
+
 inline framework::proto::VarType::Type ToVarType(
     sendrecv::VariableMessage::Type type) {
   switch (type) {
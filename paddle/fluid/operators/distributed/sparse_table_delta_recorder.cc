@@ -0,0 +1,101 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/sparse_table_delta_recorder.h"
+
+#include <algorithm>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+std::unique_ptr<SparseTableDeltaRecorder> SparseTableDeltaRecorder::recorder_(
+    nullptr);
+
+SparseTableDeltaRecorder::SparseTableDeltaRecorder(
+    const std::unordered_map<std::string, std::string>& grad_to_table)
+    : grad_to_table_(grad_to_table) {
+  for (auto& grad_and_table : grad_to_table_) {
+    VLOG(3) << "record the rows of table " << grad_and_table.second
+            << " updated by " << grad_and_table.first;
+    auto& table = tables_[grad_and_table.second];
+    if (table == nullptr) {
+      table.reset(new TableRows());
+    }
+  }
+}
+
+void SparseTableDeltaRecorder::Update(const std::string& grad_name,
+                                      const std::vector<int64_t>& rows) {
+  auto it = grad_to_table_.find(grad_name);
+  PADDLE_ENFORCE_EQ(it != grad_to_table_.end(), true,
+                    platform::errors::NotFound(
+                        "The gradient %s does not update a recorded sparse "
+                        "table.",
+                        grad_name));
+  AddRows(it->second, rows);
+}
+
+void SparseTableDeltaRecorder::AddRows(const std::string& table_name,
+                                       const std::vector<int64_t>& rows) {
+  auto it = tables_.find(table_name);
+  PADDLE_ENFORCE_EQ(
+      it != tables_.end(), true,
+      platform::errors::NotFound("The sparse table %s is not recorded.",
+                                 table_name));
+  std::vector<std::vector<int64_t>> shard_rows(1 << kShardBits);
+  for (auto id : rows) {
+    shard_rows[ShardOf(id)].push_back(id);
+  }
+  for (size_t i = 0; i < shard_rows.size(); ++i) {
+    if (shard_rows[i].empty()) continue;
+    auto& shard = it->second->shards[i];
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    shard.rows.insert(shard_rows[i].begin(), shard_rows[i].end());
+  }
+}
+
+void SparseTableDeltaRecorder::TakeRows(const std::string& table_name,
+                                        std::vector<int64_t>* rows) {
+  auto it = tables_.find(table_name);
+  PADDLE_ENFORCE_EQ(
+      it != tables_.end(), true,
+      platform::errors::NotFound("The sparse table %s is not recorded.",
+                                 table_name));
+  rows->clear();
+  for (auto& shard : it->second->shards) {
+    std::unordered_set<int64_t> shard_rows;
+    {
+      std::lock_guard<std::mutex> guard(shard.mutex);
+      shard_rows.swap(shard.rows);
+    }
+    rows->insert(rows->end(), shard_rows.begin(), shard_rows.end());
+  }
+  std::sort(rows->begin(), rows->end());
+  VLOG(3) << "take " << rows->size() << " updated rows of table "
+          << table_name;
+}
+
+void SparseTableDeltaRecorder::Init(
+    const std::unordered_map<std::string, std::string>& grad_to_table) {
+  if (recorder_ == nullptr) {
+    recorder_.reset(new SparseTableDeltaRecorder(grad_to_table));
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
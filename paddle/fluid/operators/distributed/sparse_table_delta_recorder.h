@@ -0,0 +1,90 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Record the rows of the sparse tables updated by the gradients received
+// since the last checkpoint, so that a delta checkpoint writes only these
+// rows instead of the whole table.
+//
+// The rows of a table are kept in shards by the hash of the ids, each of
+// which has its own lock, so that the rpc threads receiving the gradients
+// do not wait for each other.
+class SparseTableDeltaRecorder {
+ public:
+  explicit SparseTableDeltaRecorder(
+      const std::unordered_map<std::string, std::string>& grad_to_table);
+
+  bool HasGrad(const std::string& grad_name) const {
+    return grad_to_table_.find(grad_name) != grad_to_table_.end();
+  }
+
+  bool HasTable(const std::string& table_name) const {
+    return tables_.find(table_name) != tables_.end();
+  }
+
+  // Record the rows of the table updated by the gradient grad_name.
+  void Update(const std::string& grad_name, const std::vector<int64_t>& rows);
+
+  // Record the rows of the table, e.g. to put back the rows taken by a
+  // failed checkpoint.
+  void AddRows(const std::string& table_name,
+               const std::vector<int64_t>& rows);
+
+  // Take the sorted rows of the table updated since the last take.
+  void TakeRows(const std::string& table_name, std::vector<int64_t>* rows);
+
+  static void Init(
+      const std::unordered_map<std::string, std::string>& grad_to_table);
+
+  static SparseTableDeltaRecorder* GetInstance() { return recorder_.get(); }
+
+ private:
+  static constexpr int kShardBits = 4;
+
+  struct RowShard {
+    std::mutex mutex;
+    std::unordered_set<int64_t> rows;
+  };
+
+  struct TableRows {
+    RowShard shards[1 << kShardBits];
+  };
+
+  static size_t ShardOf(int64_t id) {
+    return (static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL) >>
+           (64 - kShardBits);
+  }
+
+  std::unordered_map<std::string, std::string> grad_to_table_;
+  std::unordered_map<std::string, std::unique_ptr<TableRows>> tables_;
+
+  static std::unique_ptr<SparseTableDeltaRecorder> recorder_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,69 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/sparse_table_delta_recorder.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(SparseTableDeltaRecorder, TakeRows) {
+  std::unordered_map<std::string, std::string> grad_to_table;
+  grad_to_table["emb@GRAD.trainer_0"] = "emb";
+  grad_to_table["emb@GRAD.trainer_1"] = "emb";
+  SparseTableDeltaRecorder recorder(grad_to_table);
+  EXPECT_TRUE(recorder.HasGrad("emb@GRAD.trainer_0"));
+  EXPECT_FALSE(recorder.HasGrad("fc@GRAD"));
+  EXPECT_TRUE(recorder.HasTable("emb"));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; ++i) {
+    threads.emplace_back([&recorder, i] {
+      auto grad_name = "emb@GRAD.trainer_" + std::to_string(i);
+      for (int64_t j = 0; j < 100; ++j) {
+        recorder.Update(grad_name, {j * 2 + i, 1000});
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int64_t> rows;
+  recorder.TakeRows("emb", &rows);
+  ASSERT_EQ(rows.size(), 201UL);
+  for (int64_t i = 0; i < 200; ++i) {
+    EXPECT_EQ(rows[i], i);
+  }
+  EXPECT_EQ(rows[200], 1000);
+
+  // the rows are taken once
+  recorder.TakeRows("emb", &rows);
+  EXPECT_TRUE(rows.empty());
+
+  recorder.AddRows("emb", {7, 3, 7});
+  recorder.TakeRows("emb", &rows);
+  EXPECT_EQ(rows, std::vector<int64_t>({3, 7}));
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
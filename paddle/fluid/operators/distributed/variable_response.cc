@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/distributed/variable_response.h"
+#include <cstring>
 #include <vector>
+#include "paddle/fluid/operators/distributed/grad_compression.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 
 DEFINE_string(rpc_server_profile_path, "./profile_ps",
@@ -36,9 +38,11 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
 #ifdef PADDLE_WITH_CUDA
     auto& gpu_dev_ctx =
         static_cast<const platform::CUDADeviceContext&>(dev_ctx);
-    platform::CPUPlace cpu;
+    // Gather the chunks into the pinned buffer of the var, and copy it to
+    // the GPU at once, instead of a pageable copy per chunk.
+    auto staging = GetPinnedStagingBuffer(meta_.varname(), length);
 
-    char* p = reinterpret_cast<char*>(dest);
+    char* p = reinterpret_cast<char*>(staging->ptr());
     while (total_written < length) {
       if (!input->GetDirectBufferPointer(&data, &size_to_write)) {
         return false;
@@ -50,15 +54,16 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
         size_to_write = length - total_written;
       }
       // This log is useful to see how long a internal block size is of rpc.
-      VLOG(7) << "copy " << size_to_write << " data to CUDAPlace";
-      memory::Copy(boost::get<platform::CUDAPlace>(place),
-                   reinterpret_cast<void*>(p), cpu, data, size_to_write,
-                   gpu_dev_ctx.stream());
+      VLOG(7) << "copy " << size_to_write << " data to CUDAPinnedPlace";
+      memcpy(p, data, size_to_write);
       p += size_to_write;
       total_written += size_to_write;
 
       input->Skip(size_to_write);
     }
+    memory::Copy(boost::get<platform::CUDAPlace>(place), dest,
+                 platform::CUDAPinnedPlace(), staging->ptr(), length,
+                 gpu_dev_ctx.stream());
     gpu_dev_ctx.Wait();
 #else
     PADDLE_THROW("Unexpected branch");
@@ -91,6 +96,39 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
   return true;
 }
 
+bool VariableResponse::ReadCompressed(
+    ::google::protobuf::io::CodedInputStream* input,
+    const platform::DeviceContext& ctx, framework::Tensor* tensor,
+    int64_t length) {
+  auto compression = static_cast<GradCompression>(meta_.compression());
+  PADDLE_ENFORCE_EQ(tensor->type(), framework::proto::VarType::FP32,
+                    platform::errors::InvalidArgument(
+                        "Only the FP32 var can be compressed, but the var %s "
+                        "is %s.",
+                        meta_.varname(),
+                        framework::DataTypeToString(tensor->type())));
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(tensor->place()), true,
+                    platform::errors::Unimplemented(
+                        "The compressed var %s can only be received on CPU.",
+                        meta_.varname()));
+  auto& dims = tensor->dims();
+  int64_t rows = dims.size() > 1 ? dims[0] : 1;
+  int64_t width = rows == 0 ? 0 : tensor->numel() / rows;
+  PADDLE_ENFORCE_EQ(
+      static_cast<size_t>(length),
+      CompressedGradBytes(compression, rows, width),
+      platform::errors::InvalidArgument(
+          "The compressed bytes %d of the var %s does not match its dims.",
+          length, meta_.varname()));
+  std::vector<char> compressed(length);
+  if (!ReadRaw(input, ctx, platform::CPUPlace(), compressed.data(), length)) {
+    return false;
+  }
+  DecompressGrad(compression, compressed.data(), rows, width,
+                 tensor->data<float>());
+  return true;
+}
+
 bool VariableResponse::CopyLodTensorData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, const framework::DDim& dims,
@@ -119,6 +157,9 @@ bool VariableResponse::CopyLodTensorData(
   VLOG(6) << "Tensor.memory_size = " << tensor->memory_size()
           << ", Buffer Size = " << length << ", dims:" << dims
           << ", numel:" << tensor->numel();
+  if (meta_.compression() != 0) {
+    return ReadCompressed(input, ctx, tensor, length);
+  }
   PADDLE_ENFORCE_GE(tensor->memory_size(), static_cast<unsigned int>(length));
   return ReadRaw(input, ctx, tensor->place(), tensor_data, length);
 }
@@ -140,6 +181,10 @@ bool VariableResponse::CopySelectRowsTensorData(
   slr->set_height(meta_.slr_height());
   auto* tensor = slr->mutable_value();
   tensor->Resize(dims);
+  if (meta_.compression() != 0) {
+    tensor->mutable_data(ctx.GetPlace(), ToVarType(meta_.data_type()));
+    return ReadCompressed(input, ctx, tensor, length);
+  }
   PADDLE_ENFORCE_EQ(
       static_cast<size_t>(tensor->numel()),
       length / framework::SizeOfType(paddle::operators::distributed::ToVarType(
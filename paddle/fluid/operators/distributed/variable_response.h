@@ -114,6 +114,12 @@ class VariableResponse {
                          const platform::DeviceContext& ctx,
                          const framework::DDim& dims, int length);
 
+  // Read and decompress the FP32 data compressed by meta_.compression into
+  // the tensor allocated.
+  bool ReadCompressed(::google::protobuf::io::CodedInputStream* input,
+                      const platform::DeviceContext& ctx,
+                      framework::Tensor* tensor, int64_t length);
+
   bool ProcSerializedField(int tag,
                            ::google::protobuf::io::CodedInputStream* input,
                            int64_t num_bytes);
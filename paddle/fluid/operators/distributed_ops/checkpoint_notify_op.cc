@@ -39,13 +39,15 @@ class CheckpointNotifyOp : public framework::OperatorBase {
     std::string dir = Attr<std::string>("dir");
     std::string lookup_table_name = Attr<std::string>("lookup_table");
     int trainer_id = Attr<int>("trainer_id");
+    bool delta = Attr<bool>("delta");
 
     distributed::RPCClient* rpc_client =
         distributed::RPCClient::GetInstance<RPCCLIENT_T>(trainer_id);
     for (size_t i = 0; i < epmap.size(); i++) {
       auto lookup_table_save_dir =
           string::Sprintf("%s/%s_%d", dir, lookup_table_name, i);
-      rpc_client->AsyncCheckpointNotify(epmap[i], lookup_table_save_dir);
+      rpc_client->AsyncCheckpointNotify(epmap[i], lookup_table_save_dir,
+                                        delta);
       VLOG(3) << "checkpoint notify sending lookup table: " << lookup_table_name
               << " and dir:" << dir << " to " << epmap[i];
     }
@@ -65,6 +67,11 @@ class CheckpointNotifyOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<std::string>("lookup_table",
                          "(string, default '') the lookup table name");
     AddAttr<int>("trainer_id", "trainer id from 0 ~ worker_num.").SetDefault(0);
+    AddAttr<bool>("delta",
+                  "(bool, default false) save only the rows of the lookup "
+                  "table updated since the last checkpoint, which are merged "
+                  "into the last full checkpoint by the load op")
+        .SetDefault(false);
     AddComment(R"DOC(
 CheckpointNotify operator
 
@@ -24,9 +24,11 @@ limitations under the License. */
 #include "paddle/fluid/operators/distributed/distributed.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
+#include "paddle/fluid/operators/distributed/async_optimize_runner.h"
 #include "paddle/fluid/operators/distributed/async_sparse_param_update_recorder.h"
 #include "paddle/fluid/operators/distributed/heart_beat_monitor.h"
 #include "paddle/fluid/operators/distributed/request_handler_impl.h"
+#include "paddle/fluid/operators/distributed/sparse_table_delta_recorder.h"
 #include "paddle/fluid/operators/distributed_ops/listen_and_serv_op.h"
 
 #include "paddle/fluid/platform/profiler.h"
@@ -34,6 +36,13 @@ limitations under the License. */
 DEFINE_int32(rpc_send_thread_num, 12, "number of threads for rpc send");
 DEFINE_int32(rpc_get_thread_num, 12, "number of threads for rpc get");
 DEFINE_int32(rpc_prefetch_thread_num, 12, "number of threads for rpc prefetch");
+DEFINE_int32(rpc_async_optimize_thread_num, 0,
+             "number of threads to run the optimize blocks in async mode, "
+             "0 to run them on the rpc send threads");
+DEFINE_int64(rpc_async_optimize_shard_numel, 1 << 20,
+             "min numel of each row range of a dense parameter updated in "
+             "parallel in async mode");
+DECLARE_int32(worker_lost_heartbeat_secs);
 
 namespace paddle {
 namespace operators {
@@ -278,6 +287,15 @@ void ListenAndServOp::RunAsyncLoop(framework::Executor *executor,
   request_get_handler_->SetGradToPreparedCtx(&grad_to_prepared_ctx);
   request_prefetch_handler_->SetGradToPreparedCtx(&grad_to_prepared_ctx);
 
+  std::unique_ptr<distributed::AsyncOptimizeRunner> optimize_runner;
+  if (FLAGS_rpc_async_optimize_thread_num > 0) {
+    optimize_runner.reset(new distributed::AsyncOptimizeRunner(
+        executor, recv_scope, &grad_to_prepared_ctx,
+        FLAGS_rpc_async_optimize_thread_num,
+        FLAGS_rpc_async_optimize_shard_numel));
+    request_send_handler_->SetAsyncOptimizeRunner(optimize_runner.get());
+  }
+
   while (true) {
     if (rpc_service_->IsExit()) {
       VLOG(4) << "get exit!rpc_processor break!";
@@ -286,6 +304,48 @@ void ListenAndServOp::RunAsyncLoop(framework::Executor *executor,
 
     sleep(1);
   }  // while(true)
+
+  if (optimize_runner) {
+    request_send_handler_->SetAsyncOptimizeRunner(nullptr);
+    optimize_runner->Wait();
+  }
+}
+
+// Record the rows of the lookup table saved by the checkpoint block updated
+// by its gradients, i.e. the Grad of its optimizer and the inputs of the sum
+// op producing it in sync mode.
+static void InitTableDeltaRecorder(const framework::ProgramDesc &program,
+                                   int checkpoint_block_id) {
+  std::string table_name;
+  for (auto *op : program.Block(checkpoint_block_id).AllOps()) {
+    if (op->Type() == "save") {
+      table_name = op->Input("X")[0];
+    }
+  }
+  if (table_name.empty()) return;
+
+  std::unordered_map<std::string, std::string> grad_to_table;
+  for (size_t i = 0; i < program.Size(); ++i) {
+    auto ops = program.Block(i).AllOps();
+    for (auto *op : ops) {
+      if (op->Inputs().count("Param") == 0 || op->Inputs().count("Grad") == 0 ||
+          op->Input("Param") != std::vector<std::string>{table_name}) {
+        continue;
+      }
+      for (auto &grad_name : op->Input("Grad")) {
+        grad_to_table[grad_name] = table_name;
+        for (auto *sum_op : ops) {
+          if (sum_op->Type() == "sum" &&
+              sum_op->Output("Out") == std::vector<std::string>{grad_name}) {
+            for (auto &part_name : sum_op->Input("X")) {
+              grad_to_table[part_name] = table_name;
+            }
+          }
+        }
+      }
+    }
+  }
+  distributed::SparseTableDeltaRecorder::Init(grad_to_table);
 }
 
 static void FillRequestCtx(
@@ -400,6 +460,7 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
     auto ctx = executor.Prepare(*program, checkpoint_block_id);
     // see: https://stackoverflow.com/a/14856553
     ckpt_pre_context = std::move(ctx);
+    InitTableDeltaRecorder(*program, checkpoint_block_id);
   }
 
   std::shared_ptr<framework::ExecutorPrepareContext> lr_decay_context = nullptr;
@@ -471,6 +532,16 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
   signal(SIGTERM, SignalHandler::StopAndExit);
 
   if (distributed_mode == distributed::DistributedMode::kSync) {
+    if (FLAGS_worker_lost_heartbeat_secs > 0) {
+      // every pserver drops the lost trainers from its own barriers
+      distributed::HeartBeatMonitor::Init(fan_in, true, "");
+      auto rpc_service = rpc_service_;
+      distributed::HeartBeatMonitor::GetInstance()->SetLostWorkerHandler(
+          [rpc_service](int trainer_id) {
+            rpc_service->DropClient(trainer_id);
+          });
+    }
+
     // start the server listening after all member initialized.
     server_thread_.reset(new std::thread(RunServer, rpc_service_));
     VLOG(3) << "wait server thread to become ready...";
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <glog/logging.h>
 #include <algorithm>
+#include <array>
 #include <functional>  // for multiplies
 #include <iterator>
 #include <vector>
@@ -39,12 +40,6 @@ constexpr int ELEMWISE_MAX_BLOCK_DIM = 1024;
 
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/for_range.h"
-#define GetDivMod(dividend, divisor, div, mod) \
-  do {                                         \
-    const auto dividend_copy = dividend;       \
-    *div = dividend_copy / divisor;            \
-    *mod = dividend_copy % divisor;            \
-  } while (0)
 
 namespace paddle {
 namespace operators {
@@ -184,83 +179,245 @@ void CommonForwardBroadcastCPU(const framework::Tensor *x,
 }
 
 #ifdef __NVCC__
-template <typename Functor, typename T>
-__global__ void CommonForwardBroadcastCUDAKernel(
-    const int *x_strides_array, const int *y_strides_array,
-    const int *out_dims_array, const T *x, const T *y, T *out, int out_size,
-    int max_dim, Functor func, const bool is_xsize_larger) {
-  for (int out_index = blockIdx.x * blockDim.x + threadIdx.x;
-       out_index < out_size; out_index += blockDim.x * gridDim.x) {
-    int x_index = 0;
-    int y_index = 0;
-    int out_index_quotient = out_index;
-    int remainder = 0;
+constexpr int ELEMWISE_MAX_RANK = framework::DDim::kMaxRank;
+
+/*
+ * \brief Divide by a divisor fixed on host with a multiplication and a
+ * shift, instead of the integer division which is much slower on GPU, see
+ * "Division by Invariant Integers using Multiplication" by Granlund and
+ * Montgomery. The dividend should be less than 2^31.
+ */
+struct FastDivMod {
+  FastDivMod() : divisor(1), multiplier(1), shift(0) {}
+
+  explicit FastDivMod(int d) : divisor(static_cast<uint32_t>(d)) {
+    for (shift = 0; shift < 31; ++shift) {
+      if ((1U << shift) >= divisor) break;
+    }
+    uint64_t one = 1;
+    uint64_t m = ((one << 32) * ((one << shift) - divisor)) / divisor + 1;
+    multiplier = static_cast<uint32_t>(m);
+  }
+
+  __device__ __forceinline__ uint32_t Div(uint32_t n) const {
+    return (__umulhi(n, multiplier) + n) >> shift;
+  }
+
+  __device__ __forceinline__ void DivMod(uint32_t n, uint32_t *q,
+                                         uint32_t *r) const {
+    uint32_t quotient = Div(n);
+    *r = n - quotient * divisor;
+    *q = quotient;
+  }
+
+  uint32_t divisor;
+  uint32_t multiplier;
+  uint32_t shift;
+};
+
+/*
+ * \brief Map the linear index over dims to the offsets of kNum tensors of
+ * the given strides, by the divisors and strides passed to the kernels by
+ * value instead of the arrays copied to device for each launch.
+ */
+template <int kNum>
+struct StridedIndexer {
+  // dims and strides are of the outermost dim first.
+  StridedIndexer(const std::vector<int> &dims,
+                 const std::array<std::vector<int>, kNum> &in_strides)
+      : rank(static_cast<int>(dims.size())) {
+    PADDLE_ENFORCE_EQ(rank >= 1 && rank <= ELEMWISE_MAX_RANK, true,
+                      platform::errors::InvalidArgument(
+                          "The rank of the merged broadcast dims should be "
+                          "in [1, %d], but got %d.",
+                          ELEMWISE_MAX_RANK, rank));
+    // The divisors and strides are stored of the innermost dim first.
+    for (int i = 0; i < rank; ++i) {
+      divmods[i] = FastDivMod(dims[rank - 1 - i]);
+      for (int n = 0; n < kNum; ++n) {
+        strides[n][i] = in_strides[n][rank - 1 - i];
+      }
+    }
+  }
+
+  __device__ __forceinline__ void operator()(int index, int *offsets) const {
+#pragma unroll
+    for (int n = 0; n < kNum; ++n) offsets[n] = 0;
+    uint32_t quotient = index;
+    uint32_t remainder = 0;
+#pragma unroll
+    for (int i = 0; i < ELEMWISE_MAX_RANK - 1; ++i) {
+      if (i >= rank - 1) break;
+      divmods[i].DivMod(quotient, &quotient, &remainder);
 #pragma unroll
-    for (int i = max_dim - 1; i >= 0; --i) {
-      GetDivMod(out_index_quotient, out_dims_array[i], &out_index_quotient,
-                &remainder);
-      x_index += remainder * x_strides_array[i];
-      y_index += remainder * y_strides_array[i];
+      for (int n = 0; n < kNum; ++n) offsets[n] += remainder * strides[n][i];
     }
-    if (is_xsize_larger) {
-      out[out_index] = func(x[x_index], y[y_index]);
+    // The quotient is the index of the outermost dim, which needs no divmod.
+#pragma unroll
+    for (int n = 0; n < kNum; ++n) {
+      offsets[n] += quotient * strides[n][rank - 1];
+    }
+  }
+
+  int rank;
+  FastDivMod divmods[ELEMWISE_MAX_RANK];
+  int strides[kNum][ELEMWISE_MAX_RANK];
+};
+
+// Merge the adjacent dims, over each of which x and y are both broadcast or
+// both not, into one dim and drop the dims of size 1 in out, which reduces
+// the divmods of each index to the number of the broadcast patterns, e.g.
+// x=[2,3,4,5], y=[2,1,1,5] is merged into x=[2,12,5], y=[2,1,5].
+inline void MergeBroadcastDims(const int *x_dims_array,
+                               const int *y_dims_array,
+                               const int *out_dims_array, int max_dim,
+                               std::vector<int> *x_dims,
+                               std::vector<int> *y_dims,
+                               std::vector<int> *out_dims) {
+  x_dims->clear();
+  y_dims->clear();
+  out_dims->clear();
+  bool last_x_broadcast = false;
+  bool last_y_broadcast = false;
+  for (int i = 0; i < max_dim; ++i) {
+    if (out_dims_array[i] == 1) continue;
+    bool x_broadcast = x_dims_array[i] == 1;
+    bool y_broadcast = y_dims_array[i] == 1;
+    if (!out_dims->empty() && x_broadcast == last_x_broadcast &&
+        y_broadcast == last_y_broadcast) {
+      x_dims->back() *= x_dims_array[i];
+      y_dims->back() *= y_dims_array[i];
+      out_dims->back() *= out_dims_array[i];
     } else {
-      out[out_index] = func(y[y_index], x[x_index]);
+      x_dims->push_back(x_dims_array[i]);
+      y_dims->push_back(y_dims_array[i]);
+      out_dims->push_back(out_dims_array[i]);
+    }
+    last_x_broadcast = x_broadcast;
+    last_y_broadcast = y_broadcast;
+  }
+  if (out_dims->empty()) {
+    x_dims->push_back(1);
+    y_dims->push_back(1);
+    out_dims->push_back(1);
+  }
+}
+
+// The strides of a contiguous tensor of dims, which are 0 over the dims of
+// size 1 to broadcast.
+inline std::vector<int> BroadcastStrides(const std::vector<int> &dims) {
+  std::vector<int> strides(dims.size());
+  int stride = 1;
+  for (int i = static_cast<int>(dims.size()) - 1; i >= 0; --i) {
+    strides[i] = dims[i] == 1 ? 0 : stride;
+    stride *= dims[i];
+  }
+  return strides;
+}
+
+template <typename T, int VecSize>
+struct alignas(sizeof(T) * VecSize) AlignedVector {
+  T val[VecSize];
+};
+
+template <int VecSize, typename T>
+inline bool IsAlignedVector(const T *ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % (sizeof(T) * VecSize) == 0;
+}
+
+// Load VecSize elements from in + offset, which are all in[offset] if the
+// innermost dim is broadcast, or the aligned vector otherwise.
+template <typename T, int VecSize>
+__device__ __forceinline__ void LoadBroadcastVector(const T *in, int offset,
+                                                    bool broadcast, T *vals) {
+  if (broadcast) {
+    T val = in[offset];
+#pragma unroll
+    for (int k = 0; k < VecSize; ++k) vals[k] = val;
+  } else {
+    auto vec =
+        *reinterpret_cast<const AlignedVector<T, VecSize> *>(in + offset);
+#pragma unroll
+    for (int k = 0; k < VecSize; ++k) vals[k] = vec.val[k];
+  }
+}
+
+// Each thread computes VecSize adjacent elements of out, which lie in one
+// row of the innermost dim since its size is divisible by VecSize, so that
+// x and y are loaded and out is stored by the vectors of VecSize elements.
+template <typename Functor, typename T, typename OutType, int VecSize>
+__global__ void CommonForwardBroadcastCUDAKernel(
+    StridedIndexer<2> indexer, const T *x, const T *y, OutType *out,
+    int vec_num, bool x_inner_broadcast, bool y_inner_broadcast, Functor func,
+    const bool is_xsize_larger) {
+  for (int vec_index = blockIdx.x * blockDim.x + threadIdx.x;
+       vec_index < vec_num; vec_index += blockDim.x * gridDim.x) {
+    int out_index = vec_index * VecSize;
+    int offsets[2];
+    indexer(out_index, offsets);
+    T x_vals[VecSize];
+    T y_vals[VecSize];
+    LoadBroadcastVector<T, VecSize>(x, offsets[0], x_inner_broadcast, x_vals);
+    LoadBroadcastVector<T, VecSize>(y, offsets[1], y_inner_broadcast, y_vals);
+    AlignedVector<OutType, VecSize> out_vec;
+#pragma unroll
+    for (int k = 0; k < VecSize; ++k) {
+      out_vec.val[k] = is_xsize_larger ? func(x_vals[k], y_vals[k])
+                                       : func(y_vals[k], x_vals[k]);
     }
+    *reinterpret_cast<AlignedVector<OutType, VecSize> *>(out + out_index) =
+        out_vec;
   }
 }
 
-template <typename Functor, typename T>
+template <typename Functor, typename T, typename OutType = T>
 void CommonForwardBroadcastCUDA(
     const framework::Tensor *x, const framework::Tensor *y,
     framework::Tensor *z, int *x_dims_array, int *y_dims_array,
     int *out_dims_array, int max_dim, const platform::CUDADeviceContext &ctx,
     Functor func, const bool is_xsize_larger = true) {
-  const auto gplace = boost::get<platform::CUDAPlace>(ctx.GetPlace());
-  auto cplace = platform::CPUPlace();
   const T *x_data = x->data<T>();
   const T *y_data = y->data<T>();
-  T *out_data = z->mutable_data<T>(ctx.GetPlace());
-
-  std::vector<int> x_strides_array(max_dim);
-  std::vector<int> y_strides_array(max_dim);
-  int x_stride = 1;
-  int y_stride = 1;
-  for (int i = max_dim - 1; i >= 0; i--) {
-    x_strides_array[i] = x_dims_array[i] == 1 ? 0 : x_stride;
-    y_strides_array[i] = y_dims_array[i] == 1 ? 0 : y_stride;
-    x_stride *= x_dims_array[i];
-    y_stride *= y_dims_array[i];
-  }
-
-  int bytes = max_dim * sizeof(int);
-  auto x_strides_array_tmp = memory::Alloc(ctx, bytes);
-  int *x_strides_array_gpu =
-      reinterpret_cast<int *>(x_strides_array_tmp->ptr());
-  memory::Copy(gplace, x_strides_array_gpu, cplace, x_strides_array.data(),
-               bytes, ctx.stream());
-
-  auto y_strides_array_tmp = memory::Alloc(ctx, bytes);
-  int *y_strides_array_gpu =
-      reinterpret_cast<int *>(y_strides_array_tmp->ptr());
-  memory::Copy(gplace, y_strides_array_gpu, cplace, y_strides_array.data(),
-               bytes, ctx.stream());
-
-  auto out_dims_array_tmp = memory::Alloc(ctx, bytes);
-  int *out_dims_array_gpu = reinterpret_cast<int *>(out_dims_array_tmp->ptr());
-  memory::Copy(gplace, out_dims_array_gpu, cplace, out_dims_array, bytes,
-               ctx.stream());
+  OutType *out_data = z->mutable_data<OutType>(ctx.GetPlace());
 
   const int out_size = std::accumulate(out_dims_array, out_dims_array + max_dim,
                                        1, std::multiplies<int>());
-  dim3 gird_size = dim3(
-      (out_size + PADDLE_CUDA_THREAD_SIZE - 1) / PADDLE_CUDA_THREAD_SIZE, 1);
+  if (out_size == 0) return;
+
+  std::vector<int> x_dims;
+  std::vector<int> y_dims;
+  std::vector<int> out_dims;
+  MergeBroadcastDims(x_dims_array, y_dims_array, out_dims_array, max_dim,
+                     &x_dims, &y_dims, &out_dims);
+  StridedIndexer<2> indexer(
+      out_dims, {BroadcastStrides(x_dims), BroadcastStrides(y_dims)});
+  bool x_inner_broadcast = x_dims.back() == 1;
+  bool y_inner_broadcast = y_dims.back() == 1;
+
+  // 128-bit vectors for float and double, and 64-bit ones for float16.
+  constexpr int kVecSize = sizeof(T) == 8 ? 2 : 4;
+  bool use_vector = out_dims.back() % kVecSize == 0 &&
+                    (x_inner_broadcast || IsAlignedVector<kVecSize>(x_data)) &&
+                    (y_inner_broadcast || IsAlignedVector<kVecSize>(y_data)) &&
+                    IsAlignedVector<kVecSize>(out_data);
+  int vec_size = use_vector ? kVecSize : 1;
+  int vec_num = out_size / vec_size;
+  dim3 grid_size = dim3(
+      (vec_num + PADDLE_CUDA_THREAD_SIZE - 1) / PADDLE_CUDA_THREAD_SIZE, 1);
   dim3 block_size = dim3(PADDLE_CUDA_THREAD_SIZE, 1);
 
-  CommonForwardBroadcastCUDAKernel<
-      Functor, T><<<gird_size, block_size, 0, ctx.stream()>>>(
-      x_strides_array_gpu, y_strides_array_gpu, out_dims_array_gpu, x_data,
-      y_data, out_data, out_size, max_dim, func, is_xsize_larger);
+  if (use_vector) {
+    CommonForwardBroadcastCUDAKernel<
+        Functor, T, OutType,
+        kVecSize><<<grid_size, block_size, 0, ctx.stream()>>>(
+        indexer, x_data, y_data, out_data, vec_num, x_inner_broadcast,
+        y_inner_broadcast, func, is_xsize_larger);
+  } else {
+    CommonForwardBroadcastCUDAKernel<
+        Functor, T, OutType, 1><<<grid_size, block_size, 0, ctx.stream()>>>(
+        indexer, x_data, y_data, out_data, vec_num, x_inner_broadcast,
+        y_inner_broadcast, func, is_xsize_larger);
+  }
 }
 
 #endif  // __NVCC__
@@ -304,74 +461,122 @@ void CommonGradBroadcastCPU(
   }
 }
 
-inline void ComputeBroadcastKernelSize(int *x_dims_array, int *out_dims_array,
-                                       int *x_blocks, int *x_threads,
-                                       int max_dim) {
-  *x_blocks = 1;
-  *x_threads = 1;
-  for (int i = 0; i < max_dim; i++) {
-    if (x_dims_array[i] == out_dims_array[i]) {
-      *x_blocks *= x_dims_array[i];
-    } else {
-      *x_threads *= out_dims_array[i];
-    }
+#ifdef __NVCC__
+// Reduce the gradient of an input over its broadcast dims, whose innermost
+// dim is reduced: each block sums the reduced elements of one element of the
+// gradient, which are read by the adjacent threads from the adjacent memory.
+template <typename T, typename OP>
+__global__ void CommonGradBroadcastRowCUDAKernel(
+    StridedIndexer<2> indexer, StridedIndexer<1> kept_indexer,
+    StridedIndexer<1> reduce_indexer, const T *x, const T *y, const T *out,
+    const T *dout, int reduce_num, OP op, T *d) {
+  int i = blockIdx.x;
+  int tid = threadIdx.x;
+  int kept_offset;
+  kept_indexer(i, &kept_offset);
+  T val(0);
+  for (int j = tid; j < reduce_num; j += blockDim.x) {
+    int reduce_offset;
+    reduce_indexer(j, &reduce_offset);
+    int out_index = kept_offset + reduce_offset;
+    int offsets[2];
+    indexer(out_index, offsets);
+    val += op(x[offsets[0]], y[offsets[1]], out[out_index], dout[out_index]);
+  }
+  val = paddle::platform::reduceSum(val, tid, blockDim.x);
+  if (tid == 0) {
+    d[i] = val;
   }
 }
 
-inline void ComputeBroadcastTranspositionArray(const int *x_one_indexs,
-                                               int *x_trans_indexs,
-                                               const int max_dim,
-                                               const int x_one_size) {
-  int diff = max_dim - x_one_size;
-  std::copy_n(x_one_indexs, x_one_size, x_trans_indexs + diff);
-  int p = 0;
-  int q = diff;
-  for (int i = 0; i < max_dim; ++i) {
-    if (q < max_dim && i == x_trans_indexs[q]) {
-      ++q;
-    } else {
-      x_trans_indexs[p++] = i;
-    }
+// Reduce the gradient of an input over its broadcast dims, whose innermost
+// dim is kept: the threads of each row of a block sum the adjacent elements
+// of the gradient, so the reads of each step of the reduction are coalesced.
+template <typename T, typename OP>
+__global__ void CommonGradBroadcastColCUDAKernel(
+    StridedIndexer<2> indexer, StridedIndexer<1> kept_indexer,
+    StridedIndexer<1> reduce_indexer, const T *x, const T *y, const T *out,
+    const T *dout, int kept_num, int reduce_num, OP op, T *d) {
+  __shared__ T sdata[BLOCK_Y][BLOCK_X + 1];
+  int i = blockIdx.x * BLOCK_X + threadIdx.x;
+  T val(0);
+  if (i < kept_num) {
+    int kept_offset;
+    kept_indexer(i, &kept_offset);
+    for (int j = threadIdx.y; j < reduce_num; j += BLOCK_Y) {
+      int reduce_offset;
+      reduce_indexer(j, &reduce_offset);
+      int out_index = kept_offset + reduce_offset;
+      int offsets[2];
+      indexer(out_index, offsets);
+      val += op(x[offsets[0]], y[offsets[1]], out[out_index], dout[out_index]);
+    }
+  }
+  sdata[threadIdx.y][threadIdx.x] = val;
+  __syncthreads();
+  for (int stride = BLOCK_Y / 2; stride > 0; stride >>= 1) {
+    if (threadIdx.y < stride) {
+      sdata[threadIdx.y][threadIdx.x] +=
+          sdata[threadIdx.y + stride][threadIdx.x];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.y == 0 && i < kept_num) {
+    d[i] = sdata[0][threadIdx.x];
   }
 }
 
-#ifdef __NVCC__
-template <typename T, typename DX_OP>
-__global__ void CommonGradBroadcastCUDAKernel(
-    const int *x_strides_array, const int *y_strides_array,
-    const int *out_dims_array, const int *y_strides_order,
-    const int *y_dims_order, const T *x, const T *y, const T *out,
-    const T *dout, T *dx, int out_size, int max_dim, int thread_num,
-    DX_OP dx_op) {
-  T val(0);
-  int i = blockIdx.x;
-  int tid = threadIdx.x;
-  for (int j = tid; j < thread_num; j += blockDim.x) {
-    const int X_index = i * thread_num + j;
-    int out_index = X_index;
-    int C_index = 0;
-    int B_index = i * thread_num + j;
-    int remainder = 0;
-#pragma unroll
-    for (int d = max_dim - 1; d >= 0; --d) {
-      GetDivMod(B_index, y_dims_order[d], &B_index, &remainder);
-      C_index += remainder * y_strides_order[d];
-    }
-    int x_index = 0;
-    int y_index = 0;
-    int C_index_val = C_index;
-#pragma unroll
-    for (int d = max_dim - 1; d >= 0; --d) {
-      GetDivMod(C_index_val, out_dims_array[d], &C_index_val, &remainder);
-      x_index += remainder * x_strides_array[d];
-      y_index += remainder * y_strides_array[d];
-    }
-    out_index = C_index;
-    val += dx_op(x[x_index], y[y_index], out[out_index], dout[out_index]);
-  }
-  val = paddle::platform::reduceSum(val, tid, thread_num);
-  if (threadIdx.x == 0) {
-    dx[i] = val;
+// Compute the gradient d of the input of the merged dims in_dims, which is
+// reduced by op over the dims broadcast to out_dims.
+template <typename T, typename OP>
+void CommonGradBroadcastReduceCUDA(const StridedIndexer<2> &indexer,
+                                   const std::vector<int> &in_dims,
+                                   const std::vector<int> &out_dims,
+                                   const T *x, const T *y, const T *out,
+                                   const T *dout, OP op, T *d,
+                                   cudaStream_t stream) {
+  std::vector<int> out_strides = BroadcastStrides(out_dims);
+  std::vector<int> kept_dims;
+  std::vector<int> kept_strides;
+  std::vector<int> reduce_dims;
+  std::vector<int> reduce_strides;
+  for (size_t i = 0; i < out_dims.size(); ++i) {
+    if (in_dims[i] == out_dims[i]) {
+      kept_dims.push_back(out_dims[i]);
+      kept_strides.push_back(out_strides[i]);
+    } else {
+      reduce_dims.push_back(out_dims[i]);
+      reduce_strides.push_back(out_strides[i]);
+    }
+  }
+  if (kept_dims.empty()) {
+    kept_dims.push_back(1);
+    kept_strides.push_back(0);
+  }
+  if (reduce_dims.empty()) {
+    reduce_dims.push_back(1);
+    reduce_strides.push_back(0);
+  }
+  const int kept_num = std::accumulate(kept_dims.begin(), kept_dims.end(), 1,
+                                       std::multiplies<int>());
+  const int reduce_num = std::accumulate(
+      reduce_dims.begin(), reduce_dims.end(), 1, std::multiplies<int>());
+  StridedIndexer<1> kept_indexer(kept_dims, {kept_strides});
+  StridedIndexer<1> reduce_indexer(reduce_dims, {reduce_strides});
+
+  if (in_dims.back() != out_dims.back()) {
+    int block_size = std::min(ELEMWISE_MAX_BLOCK_DIM, reduce_num);
+    CommonGradBroadcastRowCUDAKernel<T, OP><<<kept_num, block_size, 0,
+                                              stream>>>(
+        indexer, kept_indexer, reduce_indexer, x, y, out, dout, reduce_num, op,
+        d);
+  } else {
+    dim3 block_size = dim3(BLOCK_X, BLOCK_Y);
+    int grid_size = (kept_num + BLOCK_X - 1) / BLOCK_X;
+    CommonGradBroadcastColCUDAKernel<T, OP><<<grid_size, block_size, 0,
+                                              stream>>>(
+        indexer, kept_indexer, reduce_indexer, x, y, out, dout, kept_num,
+        reduce_num, op, d);
   }
 }
 
@@ -575,8 +780,6 @@ void CommonGradBroadcastCUDA(
     framework::Tensor *dx, framework::Tensor *dy, int *x_dims_array,
     int *y_dims_array, int *out_dims_array, int max_dim,
     const platform::CUDADeviceContext &ctx, DX_OP dx_op, DY_OP dy_op) {
-  const auto gplace = boost::get<platform::CUDAPlace>(ctx.GetPlace());
-  auto cplace = platform::CPUPlace();
   const T *x_data = x.data<T>();
   const T *y_data = y.data<T>();
   const T *out_data = out.data<T>();
@@ -584,58 +787,8 @@ void CommonGradBroadcastCUDA(
   T *dx_data = dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace());
   T *dy_data = dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace());
 
-  std::vector<int> x_one_indexs;
-  std::vector<int> y_one_indexs;
-  for (int i = 0; i < max_dim; i++) {
-    if (x_dims_array[i] != y_dims_array[i]) {
-      if (x_dims_array[i] == 1) {
-        x_one_indexs.push_back(i);
-      }
-      if (y_dims_array[i] == 1) {
-        y_one_indexs.push_back(i);
-      }
-    }
-  }
-
-  std::vector<int> x_trans_indexs(max_dim);
-  std::vector<int> y_trans_indexs(max_dim);
-  ComputeBroadcastTranspositionArray(x_one_indexs.data(), x_trans_indexs.data(),
-                                     max_dim, x_one_indexs.size());
-  ComputeBroadcastTranspositionArray(y_one_indexs.data(), y_trans_indexs.data(),
-                                     max_dim, y_one_indexs.size());
-
-  // compute array stride for cuda kernel;
-  // e.g. x.dims=[2,3,4], x_stride=[12,4,1]
-  std::vector<int> x_strides_array(max_dim);
-  std::vector<int> y_strides_array(max_dim);
-  std::vector<int> out_strides_array(max_dim);
-  int x_stride = 1;
-  int y_stride = 1;
-  int z_stride = 1;
-  for (int i = max_dim - 1; i >= 0; i--) {
-    x_strides_array[i] = x_dims_array[i] == 1 ? 0 : x_stride;
-    y_strides_array[i] = y_dims_array[i] == 1 ? 0 : y_stride;
-    out_strides_array[i] = z_stride;
-    x_stride *= x_dims_array[i];
-    y_stride *= y_dims_array[i];
-    z_stride *= out_dims_array[i];
-  }
-
-  std::vector<int> x_strides_order(max_dim);
-  std::vector<int> y_strides_order(max_dim);
-  std::vector<int> x_dims_order(max_dim);
-  std::vector<int> y_dims_order(max_dim);
-  for (int i = 0; i < max_dim; ++i) {
-    x_strides_order[i] = out_strides_array[x_trans_indexs[i]];
-    y_strides_order[i] = out_strides_array[y_trans_indexs[i]];
-    x_dims_order[i] = out_dims_array[x_trans_indexs[i]];
-    y_dims_order[i] = out_dims_array[y_trans_indexs[i]];
-  }
   std::vector<int> x_broadcast_pos;
   std::vector<int> y_broadcast_pos;
-
-  int bytes = max_dim * sizeof(int);
-
   for (int i = 0; i < max_dim; ++i) {
     if (x_dims_array[i] != out_dims_array[i] && x_dims_array[i] == 1) {
       x_broadcast_pos.emplace_back(i);
@@ -827,70 +980,25 @@ void CommonGradBroadcastCUDA(
     if (can_split_y && can_split_x) return;
   }
 
-  // Should remove memory copy, use reg instead.
-  int x_blocks = 0;
-  int x_threads = 0;
-  ComputeBroadcastKernelSize(x_dims_array, out_dims_array, &x_blocks,
-                             &x_threads, max_dim);
-  int y_blocks = 0;
-  int y_threads = 0;
-  ComputeBroadcastKernelSize(y_dims_array, out_dims_array, &y_blocks,
-                             &y_threads, max_dim);
-
-  auto x_strides_array_tmp = memory::Alloc(ctx, bytes);
-  int *x_strides_array_gpu =
-      reinterpret_cast<int *>(x_strides_array_tmp->ptr());
-  memory::Copy(gplace, x_strides_array_gpu, cplace, x_strides_array.data(),
-               bytes, ctx.stream());
-
-  auto y_strides_array_tmp = memory::Alloc(ctx, bytes);
-  int *y_strides_array_gpu =
-      reinterpret_cast<int *>(y_strides_array_tmp->ptr());
-  memory::Copy(gplace, y_strides_array_gpu, cplace, y_strides_array.data(),
-               bytes, ctx.stream());
-
-  auto out_dims_array_tmp = memory::Alloc(ctx, bytes);
-  int *out_dims_array_gpu = reinterpret_cast<int *>(out_dims_array_tmp->ptr());
-  memory::Copy(gplace, out_dims_array_gpu, cplace, out_dims_array, bytes,
-               ctx.stream());
-
   const int out_size = std::accumulate(out_dims_array, out_dims_array + max_dim,
                                        1, std::multiplies<int>());
-  int x_block_size = std::min(ELEMWISE_MAX_BLOCK_DIM, x_threads);
-  int y_block_size = std::min(ELEMWISE_MAX_BLOCK_DIM, y_threads);
+  if (out_size == 0) return;
+  std::vector<int> x_dims;
+  std::vector<int> y_dims;
+  std::vector<int> out_dims;
+  MergeBroadcastDims(x_dims_array, y_dims_array, out_dims_array, max_dim,
+                     &x_dims, &y_dims, &out_dims);
+  StridedIndexer<2> indexer(
+      out_dims, {BroadcastStrides(x_dims), BroadcastStrides(y_dims)});
   if (dx && !can_split_x) {
-    auto x_strides_order_tmp = memory::Alloc(ctx, bytes);
-    int *x_strides_order_gpu =
-        reinterpret_cast<int *>(x_strides_order_tmp->ptr());
-    memory::Copy(gplace, x_strides_order_gpu, cplace, x_strides_order.data(),
-                 bytes, ctx.stream());
-
-    auto x_dims_order_tmp = memory::Alloc(ctx, bytes);
-    int *x_dims_order_gpu = reinterpret_cast<int *>(x_dims_order_tmp->ptr());
-    memory::Copy(gplace, x_dims_order_gpu, cplace, x_dims_order.data(), bytes,
-                 ctx.stream());
-    CommonGradBroadcastCUDAKernel<
-        T, DX_OP><<<x_blocks, x_block_size, 0, ctx.stream()>>>(
-        x_strides_array_gpu, y_strides_array_gpu, out_dims_array_gpu,
-        x_strides_order_gpu, x_dims_order_gpu, x_data, y_data, out_data,
-        dout_data, dx_data, out_size, max_dim, x_threads, dx_op);
+    CommonGradBroadcastReduceCUDA<T, DX_OP>(indexer, x_dims, out_dims, x_data,
+                                            y_data, out_data, dout_data, dx_op,
+                                            dx_data, stream);
   }
   if (dy && !can_split_y) {
-    auto y_strides_order_tmp = memory::Alloc(ctx, bytes);
-    int *y_strides_order_gpu =
-        reinterpret_cast<int *>(y_strides_order_tmp->ptr());
-    memory::Copy(gplace, y_strides_order_gpu, cplace, y_strides_order.data(),
-                 bytes, ctx.stream());
-
-    auto y_dims_order_tmp = memory::Alloc(ctx, bytes);
-    int *y_dims_order_gpu = reinterpret_cast<int *>(y_dims_order_tmp->ptr());
-    memory::Copy(gplace, y_dims_order_gpu, cplace, y_dims_order.data(), bytes,
-                 ctx.stream());
-    CommonGradBroadcastCUDAKernel<
-        T, DY_OP><<<y_blocks, y_block_size, 0, ctx.stream()>>>(
-        x_strides_array_gpu, y_strides_array_gpu, out_dims_array_gpu,
-        y_strides_order_gpu, y_dims_order_gpu, x_data, y_data, out_data,
-        dout_data, dy_data, out_size, max_dim, y_threads, dy_op);
+    CommonGradBroadcastReduceCUDA<T, DY_OP>(indexer, y_dims, out_dims, x_data,
+                                            y_data, out_data, dout_data, dy_op,
+                                            dy_data, stream);
   }
 }
 
@@ -1625,7 +1733,7 @@ void CommonElementwiseBroadcastForward(
 
   if (platform::is_gpu_place(ctx.GetPlace())) {
 #ifdef __NVCC__
-    CommonForwardBroadcastCUDA<Functor, T>(
+    CommonForwardBroadcastCUDA<Functor, T, OutType>(
         x, y, z, x_dims_array.data(), y_dims_array.data(),
         out_dims_array.data(), max_dim,
         ctx.template device_context<platform::CUDADeviceContext>(), func,
@@ -119,6 +119,34 @@ struct ChannelClipAndFakeQuantFunctor<platform::CPUDeviceContext, T> {
 template struct ChannelClipAndFakeQuantFunctor<platform::CPUDeviceContext,
                                                float>;
 
+template <typename T>
+struct FindChannelAbsMaxAndFakeQuantDequantFunctor<platform::CPUDeviceContext,
+                                                   T> {
+  void operator()(const platform::CPUDeviceContext& ctx,
+                  const framework::Tensor& in, const int bin_cnt,
+                  const int channel, framework::Tensor* out_scale,
+                  framework::Tensor* out) {
+    T* scale_data = out_scale->mutable_data<T>(ctx.GetPlace());
+    out->mutable_data<T>(ctx.GetPlace());
+    FindChannelAbsMaxFunctor<platform::CPUDeviceContext, T>()(
+        ctx, in.data<T>(), in.numel(), channel, scale_data);
+    for (int i = 0; i < channel; i++) {
+      T s = scale_data[i];
+      T inv_s = inverse(s);
+      framework::Tensor one_channel_in = in.Slice(i, i + 1);
+      framework::Tensor one_channel_out = out->Slice(i, i + 1);
+      auto in_e = framework::EigenVector<T>::Flatten(one_channel_in);
+      auto out_e = framework::EigenVector<T>::Flatten(one_channel_out);
+      out_e.device(*ctx.eigen_device()) =
+          (s / bin_cnt) *
+          (bin_cnt * inv_s * in_e.cwiseMin(s).cwiseMax(-s)).round();
+    }
+  }
+};
+
+template struct FindChannelAbsMaxAndFakeQuantDequantFunctor<
+    platform::CPUDeviceContext, float>;
+
 template <typename T>
 struct FindRangeAbsMaxFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& ctx,
@@ -225,6 +253,34 @@ $$Out = round(X/scale * range)$$
   }
 };
 
+class FakeQuantizeDequantizeAbsMaxOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) Input is float data type.");
+    AddOutput("Out",
+              "(Tensor) Output of the quantized and then dequantized tensor, "
+              "saved as float data type.");
+    AddOutput("OutScale", "(Tensor) Current scale");
+    AddAttr<int>("bit_length", "(int, default 8)")
+        .SetDefault(8)
+        .AddCustomChecker([](const int& bit_length) {
+          PADDLE_ENFORCE(bit_length >= 1 && bit_length <= 16,
+                         "'bit_length' should be between 1 and 16.");
+        });
+    AddComment(R"DOC(
+FakeQuantizeDequantizeAbsMax operator
+
+It does fake_quantize_abs_max and then fake_dequantize_max_abs in one op.
+
+$$scale = max(abs(X))$$
+$$range = 2^{bit_length - 1} - 1$$
+$$Out = round(X/scale * range) * scale / range$$
+
+)DOC");
+  }
+};
+
 class FakeChannelWiseQuantizeAbsMaxOp : public framework::OperatorWithKernel {
  public:
   using framework::OperatorWithKernel::OperatorWithKernel;
@@ -279,6 +335,35 @@ $$0 \leq c \lt \ the\ channel\ number\ of\ X$$
   }
 };
 
+class FakeChannelWiseQuantizeDequantizeAbsMaxOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) Input is float data type.");
+    AddOutput("Out",
+              "(Tensor) Output of the quantized and then dequantized tensor, "
+              "saved as float data type.");
+    AddOutput("OutScale", "(Tensor) Current channel wise scale");
+    AddAttr<int>("bit_length", "(int, default 8)")
+        .SetDefault(8)
+        .AddCustomChecker([](const int& bit_length) {
+          PADDLE_ENFORCE(bit_length >= 1 && bit_length <= 16,
+                         "'bit_length' should be between 1 and 16.");
+        });
+    AddComment(R"DOC(
+It does fake_channel_wise_quantize_abs_max and then
+fake_channel_wise_dequantize_max_abs in one op, each channel of the input X
+has a scale value.
+
+$$scale_c = max(abs(X_c))$$
+$$range = 2^{bit\_length - 1} - 1$$
+$$Out_c = round(\frac{X_c * range} {scale_c}) * \frac{scale_c} {range}$$
+In above three formulas, the range value of c is as follow:
+$$0 \leq c \lt \ the\ channel\ number\ of\ X$$
+)DOC");
+  }
+};
+
 class FakeQuantizeRangeAbsMaxOp : public framework::OperatorWithKernel {
  public:
   FakeQuantizeRangeAbsMaxOp(const std::string& type,
@@ -505,6 +590,14 @@ REGISTER_OPERATOR(
 REGISTER_OP_CPU_KERNEL(fake_quantize_abs_max,
                        ops::FakeQuantizeAbsMaxKernel<CPU, float>);
 
+REGISTER_OPERATOR(
+    fake_quantize_dequantize_abs_max, ops::FakeQuantizeAbsMaxOp,
+    ops::FakeQuantizeDequantizeAbsMaxOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(fake_quantize_dequantize_abs_max,
+                       ops::FakeQuantizeDequantizeAbsMaxKernel<CPU, float>);
+
 REGISTER_OPERATOR(
     fake_quantize_range_abs_max, ops::FakeQuantizeRangeAbsMaxOp,
     ops::FakeQuantizeRangeAbsMaxOpMaker,
@@ -541,6 +634,16 @@ REGISTER_OPERATOR(
 REGISTER_OP_CPU_KERNEL(fake_channel_wise_quantize_abs_max,
                        ops::FakeChannelWiseQuantizeAbsMaxKernel<CPU, float>);
 
+REGISTER_OPERATOR(
+    fake_channel_wise_quantize_dequantize_abs_max,
+    ops::FakeChannelWiseQuantizeAbsMaxOp,
+    ops::FakeChannelWiseQuantizeDequantizeAbsMaxOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(
+    fake_channel_wise_quantize_dequantize_abs_max,
+    ops::FakeChannelWiseQuantizeDequantizeAbsMaxKernel<CPU, float>);
+
 REGISTER_OPERATOR(
     moving_average_abs_max_scale, ops::MovingAverageAbsMaxScaleOp,
     ops::MovingAverageAbsMaxScaleOpMaker,
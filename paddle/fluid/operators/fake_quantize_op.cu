@@ -13,7 +13,6 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <string>
-#include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/fake_quantize_op.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 
@@ -233,25 +232,120 @@ struct ChannelClipAndFakeQuantFunctor<platform::CUDADeviceContext, T> {
 template struct ChannelClipAndFakeQuantFunctor<platform::CUDADeviceContext,
                                                float>;
 
+// Each block finds the abs max of a channel and then quantizes-dequantizes
+// the channel by it, so that the scale never leaves the block.
 template <typename T>
-__global__ void FindRangeAbsMaxAndFillArray(const T* cur_scale,
-                                            const T* last_scale,
-                                            const int64_t* iter,
-                                            const int window_size, T* scale_arr,
-                                            T* out_scale, int* need_find_max,
-                                            int* out_size) {
-  int it = iter[0];
-  int idx = it % window_size;
-  T removed = scale_arr[idx];
-  T cur = cur_scale[0];
-  scale_arr[idx] = cur;
-  T max = last_scale[0];
-  out_scale[0] = max < cur ? cur : max;
-  if (fabs(removed - max) < 1e-6) {
-    need_find_max[0] = 1;
-    out_size[0] = it > window_size ? window_size : it;
-  } else {
-    need_find_max[0] = 0;
+__global__ void FindChannelAbsMaxAndQuantDequantKernel(const T* in, const int n,
+                                                       const int c,
+                                                       const int bin_cnt,
+                                                       T* scale, T* out) {
+  int tid = threadIdx.x;
+  int channel_size = n / c;
+  const T* in_c = in + blockIdx.x * channel_size;
+  T* out_c = out + blockIdx.x * channel_size;
+  extern __shared__ T shared_max_data[];
+  shared_max_data[tid] = T(0);
+  for (int i = tid; i < channel_size; i += blockDim.x) {
+    T tmp = fabs(in_c[i]);
+    if (tmp > shared_max_data[tid]) {
+      shared_max_data[tid] = tmp;
+    }
+  }
+  __syncthreads();
+  for (int i = blockDim.x / 2; i > 0; i >>= 1) {
+    if (tid < i && (shared_max_data[tid] < shared_max_data[tid + i])) {
+      shared_max_data[tid] = shared_max_data[tid + i];
+    }
+    __syncthreads();
+  }
+
+  T s = shared_max_data[0];
+  if (tid == 0) {
+    scale[blockIdx.x] = s;
+  }
+  T inv_s = inverse(s);
+  for (int i = tid; i < channel_size; i += blockDim.x) {
+    T x = in_c[i];
+    T v = x > s ? s : x;
+    v = v < -s ? -s : v;
+    v = bin_cnt * inv_s * v;
+    out_c[i] = round(v) * s / bin_cnt;
+  }
+}
+
+template <typename T>
+struct FindChannelAbsMaxAndFakeQuantDequantFunctor<platform::CUDADeviceContext,
+                                                   T> {
+  void operator()(const platform::CUDADeviceContext& ctx,
+                  const framework::Tensor& in, const int bin_cnt,
+                  const int channel, framework::Tensor* out_scale,
+                  framework::Tensor* out) {
+    int num = in.numel();
+    int block = 1024;
+    int grid = channel;
+
+    const T* in_data = in.data<T>();
+    T* scale_data = out_scale->mutable_data<T>(ctx.GetPlace());
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+
+    FindChannelAbsMaxAndQuantDequantKernel<
+        T><<<grid, block, 1024 * sizeof(T), ctx.stream()>>>(
+        in_data, num, channel, bin_cnt, scale_data, out_data);
+  }
+};
+
+template struct FindChannelAbsMaxAndFakeQuantDequantFunctor<
+    platform::CUDADeviceContext, float>;
+
+// Updates the window of the scales and the scale in one block. The abs max of
+// the window is only searched again when the removed scale was the max, which
+// is decided on the device instead of copying the flag to the host.
+template <typename T, int BlockDim>
+__global__ void FindRangeAbsMaxKernel(const T* cur_scale, const T* last_scale,
+                                      const int64_t* iter,
+                                      const int window_size, T* scale_arr,
+                                      T* out_scale) {
+  __shared__ T shared_max_data[BlockDim];
+  __shared__ bool need_find_max;
+  __shared__ int size;
+  int tid = threadIdx.x;
+  if (tid == 0) {
+    int64_t it = iter[0];
+    int idx = it % window_size;
+    T removed = scale_arr[idx];
+    T cur = cur_scale[0];
+    scale_arr[idx] = cur;
+    T max = last_scale[0];
+    need_find_max = false;
+    if (max < cur) {
+      max = cur;
+    } else if (fabs(removed - max) < 1e-6) {
+      need_find_max = true;
+      size = it > window_size ? window_size : it;
+    }
+    out_scale[0] = max;
+  }
+  __syncthreads();
+  if (!need_find_max) {
+    return;
+  }
+
+  shared_max_data[tid] = T(0);
+  for (int i = tid; i < size; i += BlockDim) {
+    T tmp = fabs(scale_arr[i]);
+    if (tmp > shared_max_data[tid]) {
+      shared_max_data[tid] = tmp;
+    }
+  }
+  __syncthreads();
+  for (int i = BlockDim / 2; i > 0; i >>= 1) {
+    if (tid < i && (shared_max_data[tid] < shared_max_data[tid + i])) {
+      shared_max_data[tid] = shared_max_data[tid + i];
+    }
+    __syncthreads();
+  }
+  if (tid == 0) {
+    out_scale[0] = shared_max_data[0];
   }
 }
 
@@ -267,31 +361,30 @@ struct FindRangeAbsMaxFunctor<platform::CUDADeviceContext, T> {
     T* scale_arr = scales_arr->mutable_data<T>(gpu_place);
     T* out_scale_data = out_scale->mutable_data<T>(gpu_place);
 
-    framework::Tensor need_find_max, out_size;
-    int* find_max = need_find_max.mutable_data<int>({1}, gpu_place);
-    int* out_size_data = out_size.mutable_data<int>({1}, gpu_place);
-
-    FindRangeAbsMaxAndFillArray<T><<<1, 1, 0, ctx.stream()>>>(
+    constexpr int kBlockDim = 1024;
+    FindRangeAbsMaxKernel<T, kBlockDim><<<1, kBlockDim, 0, ctx.stream()>>>(
         cur_scale.data<T>(), last_scale.data<T>(), iter.data<int64_t>(),
-        window_size, scale_arr, out_scale_data, find_max, out_size_data);
-
-    int g_find_max;
-    memory::Copy(platform::CPUPlace(), &g_find_max, gpu_place, find_max,
-                 sizeof(int), ctx.stream());
-    ctx.Wait();
-    if (g_find_max) {
-      int len;
-      memory::Copy(platform::CPUPlace(), &len, gpu_place, out_size_data,
-                   sizeof(int), ctx.stream());
-      ctx.Wait();
-      FindAbsMaxFunctor<platform::CUDADeviceContext, T>()(ctx, scale_arr, len,
-                                                          out_scale_data);
-    }
+        window_size, scale_arr, out_scale_data);
   }
 };
 
 template struct FindRangeAbsMaxFunctor<platform::CUDADeviceContext, float>;
 
+template <typename T>
+__global__ void FindMovingAverageAbsMaxKernel(const T* in_accum,
+                                              const T* in_state,
+                                              const T* cur_scale,
+                                              const float rate, T* out_state,
+                                              T* out_accum, T* out_scale) {
+  T state = rate * in_state[0] + 1;
+  T accum = rate * in_accum[0] + cur_scale[0];
+  out_state[0] = state;
+  out_accum[0] = accum;
+  out_scale[0] = accum / state;
+}
+
+// The scale is updated on the device, so that the training never waits for
+// the copies of the scalars to the host.
 template <typename T>
 struct FindMovingAverageAbsMaxFunctor<platform::CUDADeviceContext, T> {
   void operator()(const platform::CUDADeviceContext& ctx,
@@ -300,28 +393,11 @@ struct FindMovingAverageAbsMaxFunctor<platform::CUDADeviceContext, T> {
                   const float rate, framework::Tensor* out_state,
                   framework::Tensor* out_accum, framework::Tensor* out_scale) {
     const auto gpu_place = boost::get<platform::CUDAPlace>(ctx.GetPlace());
-
-    T accum;
-    T state;
-    T scale;
-    memory::Copy(platform::CPUPlace(), &accum, gpu_place, in_accum.data<T>(),
-                 sizeof(T), ctx.stream());
-    memory::Copy(platform::CPUPlace(), &state, gpu_place, in_state.data<T>(),
-                 sizeof(T), ctx.stream());
-    memory::Copy(platform::CPUPlace(), &scale, gpu_place, cur_scale, sizeof(T),
-                 ctx.stream());
-    ctx.Wait();
-    state = rate * state + 1;
-    accum = rate * accum + scale;
-    scale = accum / state;
-
-    memory::Copy(gpu_place, out_accum->mutable_data<T>(gpu_place),
-                 platform::CPUPlace(), &accum, sizeof(T), ctx.stream());
-    memory::Copy(gpu_place, out_state->mutable_data<T>(gpu_place),
-                 platform::CPUPlace(), &state, sizeof(T), ctx.stream());
-    memory::Copy(gpu_place, out_scale->mutable_data<T>(gpu_place),
-                 platform::CPUPlace(), &scale, sizeof(T), ctx.stream());
-    ctx.Wait();
+    FindMovingAverageAbsMaxKernel<T><<<1, 1, 0, ctx.stream()>>>(
+        in_accum.data<T>(), in_state.data<T>(), cur_scale, rate,
+        out_state->mutable_data<T>(gpu_place),
+        out_accum->mutable_data<T>(gpu_place),
+        out_scale->mutable_data<T>(gpu_place));
   }
 };
 
@@ -337,6 +413,11 @@ REGISTER_OP_CUDA_KERNEL(fake_quantize_abs_max,
                         ops::FakeQuantizeAbsMaxKernel<CUDA, float>);
 REGISTER_OP_CUDA_KERNEL(fake_channel_wise_quantize_abs_max,
                         ops::FakeChannelWiseQuantizeAbsMaxKernel<CUDA, float>);
+REGISTER_OP_CUDA_KERNEL(fake_quantize_dequantize_abs_max,
+                        ops::FakeQuantizeDequantizeAbsMaxKernel<CUDA, float>);
+REGISTER_OP_CUDA_KERNEL(
+    fake_channel_wise_quantize_dequantize_abs_max,
+    ops::FakeChannelWiseQuantizeDequantizeAbsMaxKernel<CUDA, float>);
 REGISTER_OP_CUDA_KERNEL(fake_quantize_range_abs_max,
                         ops::FakeQuantizeRangeAbsMaxKernel<CUDA, float>);
 REGISTER_OP_CUDA_KERNEL(
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
@@ -76,9 +77,14 @@ class FCOpKernel : public framework::OpKernel<T> {
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
 
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    std::shared_ptr<const math::PackedGemmWeight<T>> packed_w;
+    if (!padding_weights) {
+      packed_w = math::GetPackedGemmWeight<T>(dev_ctx, *w, w_dims0, w_dims1);
+    }
     math::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, M, w_dims1, w_dims0, input_data, w_data, output_data,
-       bias ? bias->data<T>() : NULL, with_relu, padding_weights);
+       bias ? bias->data<T>() : NULL, with_relu, padding_weights,
+       packed_w.get());
   }
 };
 
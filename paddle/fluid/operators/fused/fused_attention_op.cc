@@ -0,0 +1,340 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_attention_op.h"
+#include <memory>
+#include <string>
+
+namespace paddle {
+namespace operators {
+
+class FusedAttentionOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->HasInput("Q"), true,
+                      platform::errors::NotFound(
+                          "Input(Q) of fused_attention should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("K"), true,
+                      platform::errors::NotFound(
+                          "Input(K) of fused_attention should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("V"), true,
+                      platform::errors::NotFound(
+                          "Input(V) of fused_attention should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasOutput("Out"), true,
+                      platform::errors::NotFound(
+                          "Output(Out) of "
+                          "fused_attention should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasOutput("SoftmaxLse"), true,
+                      platform::errors::NotFound(
+                          "Output(SoftmaxLse) of "
+                          "fused_attention should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasOutput("SeedOut"), true,
+                      platform::errors::NotFound(
+                          "Output(SeedOut) of "
+                          "fused_attention should not be null."));
+
+    auto q_dims = ctx->GetInputDim("Q");
+    auto k_dims = ctx->GetInputDim("K");
+    auto v_dims = ctx->GetInputDim("V");
+    int rank = q_dims.size();
+    PADDLE_ENFORCE_GE(rank, 3, platform::errors::InvalidArgument(
+                                   "The rank of Input(Q) of fused_attention "
+                                   "should be at least 3, but received %d.",
+                                   rank));
+    PADDLE_ENFORCE_EQ(
+        k_dims.size(), rank,
+        platform::errors::InvalidArgument(
+            "The ranks of Input(Q) and Input(K) of fused_attention should be "
+            "the same, but received %d and %d.",
+            rank, k_dims.size()));
+    PADDLE_ENFORCE_EQ(
+        v_dims.size(), rank,
+        platform::errors::InvalidArgument(
+            "The ranks of Input(Q) and Input(V) of fused_attention should be "
+            "the same, but received %d and %d.",
+            rank, v_dims.size()));
+    bool varlen = ctx->Attrs().Get<bool>("varlen");
+    if (varlen) {
+      PADDLE_ENFORCE_EQ(
+          rank, 3, platform::errors::InvalidArgument(
+                       "The varlen inputs of fused_attention should be "
+                       "[total_len, num_heads, dim], but received rank %d.",
+                       rank));
+      PADDLE_ENFORCE_EQ(
+          ctx->HasInput("BiasQK"), false,
+          platform::errors::InvalidArgument(
+              "Input(BiasQK) of fused_attention is not supported with the "
+              "varlen inputs, which need no padding mask."));
+    }
+    if (ctx->IsRuntime()) {
+      if (varlen) {
+        PADDLE_ENFORCE_EQ(
+            q_dims[1] == k_dims[1] && q_dims[1] == v_dims[1], true,
+            platform::errors::InvalidArgument(
+                "The numbers of the heads of Input(Q), Input(K) and Input(V) "
+                "of fused_attention should be the same, but received [%s], "
+                "[%s] and [%s].",
+                q_dims, k_dims, v_dims));
+        PADDLE_ENFORCE_EQ(
+            k_dims[0], v_dims[0],
+            platform::errors::InvalidArgument(
+                "The total lengths of Input(K) and Input(V) of "
+                "fused_attention should be the same, but received %d and %d.",
+                k_dims[0], v_dims[0]));
+      } else {
+        for (int i = 0; i < rank - 2; ++i) {
+          PADDLE_ENFORCE_EQ(
+              q_dims[i] == k_dims[i] && q_dims[i] == v_dims[i], true,
+              platform::errors::InvalidArgument(
+                  "The batch dims of Input(Q), Input(K) and Input(V) of "
+                  "fused_attention should be the same, but received [%s], "
+                  "[%s] and [%s].",
+                  q_dims, k_dims, v_dims));
+        }
+        PADDLE_ENFORCE_EQ(
+            k_dims[rank - 2], v_dims[rank - 2],
+            platform::errors::InvalidArgument(
+                "The sequence lengths of Input(K) and Input(V) of "
+                "fused_attention should be the same, but received %d and %d.",
+                k_dims[rank - 2], v_dims[rank - 2]));
+      }
+      PADDLE_ENFORCE_EQ(
+          q_dims[rank - 1], k_dims[rank - 1],
+          platform::errors::InvalidArgument(
+              "The last dims of Input(Q) and Input(K) of fused_attention "
+              "should be the same, but received %d and %d.",
+              q_dims[rank - 1], k_dims[rank - 1]));
+    }
+
+    auto lse_dims = framework::slice_ddim(q_dims, 0, rank - 1);
+    if (ctx->HasInput("BiasQK")) {
+      auto bias_dims = ctx->GetInputDim("BiasQK");
+      auto score_dims = framework::vectorize(lse_dims);
+      score_dims.push_back(k_dims[rank - 2]);
+      if (ctx->IsRuntime()) {
+        PADDLE_ENFORCE_EQ(
+            bias_dims, framework::make_ddim(score_dims),
+            platform::errors::InvalidArgument(
+                "The shape of Input(BiasQK) of fused_attention should be the "
+                "same as the attention scores [%s], but received [%s].",
+                framework::make_ddim(score_dims), bias_dims));
+      }
+    }
+
+    auto out_dims = q_dims;
+    out_dims[rank - 1] = v_dims[rank - 1];
+    ctx->SetOutputDim("Out", out_dims);
+    ctx->SetOutputDim("SoftmaxLse", lse_dims);
+    ctx->SetOutputDim("SeedOut", {1});
+    ctx->ShareLoD("Q", "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "Q"), ctx.GetPlace());
+  }
+};
+
+class FusedAttentionOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Q", "(Tensor) The queries, with shape [..., seq_q, head_dim].");
+    AddInput("K", "(Tensor) The keys, with shape [..., seq_k, head_dim].");
+    AddInput("V", "(Tensor) The values, with shape [..., seq_k, value_dim].");
+    AddInput("BiasQK",
+             "(Tensor, optional) The bias added to the attention scores, "
+             "with shape [..., seq_q, seq_k].")
+        .AsDispensable();
+    AddOutput("Out",
+              "(Tensor) The output, with shape [..., seq_q, value_dim].");
+    AddOutput("SoftmaxLse",
+              "(Tensor) The log-sum-exp of the rows of the attention scores, "
+              "with shape [..., seq_q], which is saved for the backward.")
+        .AsIntermediate();
+    AddOutput("SeedOut",
+              "(Tensor) The seed of the dropout on CPU, with shape [1], which "
+              "is saved for the backward.")
+        .AsIntermediate();
+    AddAttr<float>("alpha", "The scale of the attention scores.")
+        .SetDefault(1.0f);
+    AddAttr<bool>("varlen",
+                  "(bool, default false) If true, Q, K and V are the packed "
+                  "sequences of LoDTensor, with shape [total_len, num_heads, "
+                  "dim], and each query attends to the keys of its own "
+                  "sequence given by the LoD.")
+        .SetDefault(false);
+    AddAttr<float>("dropout_prob",
+                   "Probability of setting the attention weights to zero.")
+        .SetDefault(0.0f)
+        .AddCustomChecker([](const float &drop_p) {
+          PADDLE_ENFORCE_EQ(drop_p >= 0.0f && drop_p <= 1.0f, true,
+                            platform::errors::InvalidArgument(
+                                "'dropout_prob' must be between 0.0 and 1.0."));
+        });
+    AddAttr<bool>("is_test",
+                  "(bool, default false) Set to true for inference only, false "
+                  "for training.")
+        .SetDefault(false);
+    AddAttr<bool>("fix_seed",
+                  "A flag indicating whether to use a fixed seed to generate "
+                  "the dropout. NOTE: DO NOT set this flag to true in "
+                  "training. Setting this flag to true is only useful in "
+                  "unittest or for debug that always the same output units "
+                  "will be dropped.")
+        .SetDefault(false);
+    AddAttr<int>("seed", "Dropout random seed.").SetDefault(0);
+    AddAttr<std::string>(
+        "dropout_implementation",
+        "[\"downgrade_in_infer\"|\"upscale_in_train\"], the same as the "
+        "attribute of dropout.")
+        .SetDefault("downgrade_in_infer")
+        .AddCustomChecker([](const std::string &type) {
+          PADDLE_ENFORCE_EQ(
+              type == "downgrade_in_infer" || type == "upscale_in_train", true,
+              platform::errors::InvalidArgument(
+                  "dropout_implementation can only be downgrade_in_infer or "
+                  "upscale_in_train"));
+        });
+    AddComment(R"DOC(
+FusedAttention Operator.
+
+It computes the attention
+
+    Out = dropout(softmax(alpha * Q * K^T + BiasQK)) * V
+
+in one operator, which replaces matmul, scale, elementwise_add, softmax,
+dropout and matmul, and is created by fuse_attention_pass.
+
+The softmax is computed block by block over the keys with a running max and
+sum, so neither the forward nor the backward stores the attention scores of
+shape [..., seq_q, seq_k]. Only the log-sum-exp of each row is saved to
+SoftmaxLse, and the dropout is regenerated from SeedOut in the backward.
+
+With varlen, the sequences of different lengths are packed without padding,
+e.g. the outputs of fc reshaped to [total_len, num_heads, dim], so neither
+the padding nor its mask is computed.
+)DOC");
+  }
+};
+
+template <typename T>
+class FusedAttentionGradOpMaker : public framework::SingleGradOpMaker<T> {
+ public:
+  using framework::SingleGradOpMaker<T>::SingleGradOpMaker;
+
+ protected:
+  void Apply(GradOpPtr<T> op) const override {
+    op->SetType("fused_attention_grad");
+    op->SetInput("Q", this->Input("Q"));
+    op->SetInput("K", this->Input("K"));
+    op->SetInput("V", this->Input("V"));
+    op->SetInput("BiasQK", this->Input("BiasQK"));
+    op->SetInput("Out", this->Output("Out"));
+    op->SetInput("SoftmaxLse", this->Output("SoftmaxLse"));
+    op->SetInput("SeedOut", this->Output("SeedOut"));
+    op->SetInput(framework::GradVarName("Out"), this->OutputGrad("Out"));
+    op->SetOutput(framework::GradVarName("Q"), this->InputGrad("Q"));
+    op->SetOutput(framework::GradVarName("K"), this->InputGrad("K"));
+    op->SetOutput(framework::GradVarName("V"), this->InputGrad("V"));
+    op->SetAttrMap(this->Attrs());
+  }
+};
+
+class FusedAttentionGradOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->HasInput("Q"), true,
+                      platform::errors::NotFound(
+                          "Input(Q) of "
+                          "fused_attention_grad should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("K"), true,
+                      platform::errors::NotFound(
+                          "Input(K) of "
+                          "fused_attention_grad should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("V"), true,
+                      platform::errors::NotFound(
+                          "Input(V) of "
+                          "fused_attention_grad should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("Out"), true,
+                      platform::errors::NotFound(
+                          "Input(Out) of "
+                          "fused_attention_grad should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("SoftmaxLse"), true,
+                      platform::errors::NotFound(
+                          "Input(SoftmaxLse) of "
+                          "fused_attention_grad should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("SeedOut"), true,
+                      platform::errors::NotFound(
+                          "Input(SeedOut) of "
+                          "fused_attention_grad should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput(framework::GradVarName("Out")), true,
+                      platform::errors::NotFound(
+                          "Input(%s) of fused_attention_grad should not be "
+                          "null.",
+                          framework::GradVarName("Out")));
+
+    for (auto &name : {"Q", "K", "V"}) {
+      auto grad_name = framework::GradVarName(name);
+      if (ctx->HasOutput(grad_name)) {
+        ctx->SetOutputDim(grad_name, ctx->GetInputDim(name));
+        ctx->ShareLoD(name, grad_name);
+      }
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return framework::OpKernelType(OperatorWithKernel::IndicateVarDataType(
+                                       ctx, framework::GradVarName("Out")),
+                                   ctx.GetPlace());
+  }
+
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string &var_name, const Tensor &tensor,
+      const framework::OpKernelType &expected_kernel_type) const override {
+    // The log-sum-exp is kept in float for float16, and the seed is on CPU.
+    if (var_name == "SoftmaxLse" || var_name == "SeedOut") {
+      return framework::OpKernelType(tensor.type(), tensor.place(),
+                                     tensor.layout());
+    }
+    return framework::OpKernelType(expected_kernel_type.data_type_,
+                                   tensor.place(), tensor.layout());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_attention, ops::FusedAttentionOp,
+                  ops::FusedAttentionOpMaker,
+                  ops::FusedAttentionGradOpMaker<paddle::framework::OpDesc>,
+                  ops::FusedAttentionGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OPERATOR(fused_attention_grad, ops::FusedAttentionGradOp);
+
+REGISTER_OP_CPU_KERNEL(
+    fused_attention,
+    ops::FusedAttentionKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusedAttentionKernel<paddle::platform::CPUDeviceContext, double>);
+REGISTER_OP_CPU_KERNEL(
+    fused_attention_grad,
+    ops::FusedAttentionGradKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusedAttentionGradKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,116 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_attention_op.cu.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+class FusedAttentionCUDAKernel : public framework::OpKernel<T> {
+  using AccT = typename AttentionAccType<T>::Type;
+
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* q = ctx.Input<Tensor>("Q");
+    auto* k = ctx.Input<Tensor>("K");
+    auto* v = ctx.Input<Tensor>("V");
+    auto* bias = ctx.Input<Tensor>("BiasQK");
+    auto* out = ctx.Output<Tensor>("Out");
+    auto* lse = ctx.Output<Tensor>("SoftmaxLse");
+    auto* seed_out = ctx.Output<Tensor>("SeedOut");
+
+    auto dims = GetCUDAAttentionDims(ctx);
+    auto dropout = GetAttentionDropout(ctx, seed_out);
+    AccT alpha = static_cast<AccT>(ctx.Attr<float>("alpha"));
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    FusedAttentionForwardCUDA<T, AccT>(
+        dev_ctx, q->data<T>(), k->data<T>(), v->data<T>(),
+        bias ? bias->data<T>() : nullptr, out->mutable_data<T>(ctx.GetPlace()),
+        lse->mutable_data<AccT>(ctx.GetPlace()), dims, alpha, dropout);
+  }
+};
+
+template <typename T>
+class FusedAttentionGradCUDAKernel : public framework::OpKernel<T> {
+  using AccT = typename AttentionAccType<T>::Type;
+
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* q = ctx.Input<Tensor>("Q");
+    auto* k = ctx.Input<Tensor>("K");
+    auto* v = ctx.Input<Tensor>("V");
+    auto* bias = ctx.Input<Tensor>("BiasQK");
+    auto* out = ctx.Input<Tensor>("Out");
+    auto* lse = ctx.Input<Tensor>("SoftmaxLse");
+    auto* d_out = ctx.Input<Tensor>(framework::GradVarName("Out"));
+    auto* d_q = ctx.Output<Tensor>(framework::GradVarName("Q"));
+    auto* d_k = ctx.Output<Tensor>(framework::GradVarName("K"));
+    auto* d_v = ctx.Output<Tensor>(framework::GradVarName("V"));
+
+    auto dims = GetCUDAAttentionDims(ctx);
+    auto dropout = GetAttentionGradDropout(ctx);
+    AccT alpha = static_cast<AccT>(ctx.Attr<float>("alpha"));
+    size_t shared_size =
+        (kRowsPerBlock + kWarpSize) * (dims.head_dim + dims.value_dim) *
+            sizeof(AccT) +
+        2 * kWarpSize * sizeof(AccT);
+    CheckAttentionDims(dims, shared_size);
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    const AccT* lse_data = lse->data<AccT>();
+    int64_t rows = out->numel() / dims.value_dim;
+    auto delta = ctx.AllocateTmpTensor<AccT, platform::CUDADeviceContext>(
+        framework::make_ddim({rows}), dev_ctx);
+    dim3 block(kWarpSize, kRowsPerBlock);
+    AttentionDeltaKernel<T, AccT><<<(rows + kRowsPerBlock - 1) / kRowsPerBlock,
+                                    block, 0, dev_ctx.stream()>>>(
+        out->data<T>(), d_out->data<T>(), delta.data<AccT>(), rows,
+        dims.value_dim);
+
+    if (d_q) {
+      dim3 grid(dims.batch, (dims.seq_q + kRowsPerBlock - 1) / kRowsPerBlock);
+      FusedAttentionGradQKernel<T, AccT><<<grid, block, shared_size,
+                                           dev_ctx.stream()>>>(
+          q->data<T>(), k->data<T>(), v->data<T>(), bias_data,
+          d_out->data<T>(), lse_data, delta.data<AccT>(),
+          d_q->mutable_data<T>(ctx.GetPlace()), dims, alpha, dropout);
+    }
+    if (d_k || d_v) {
+      dim3 grid(dims.batch, (dims.seq_k + kRowsPerBlock - 1) / kRowsPerBlock);
+      FusedAttentionGradKVKernel<T, AccT><<<grid, block, shared_size,
+                                            dev_ctx.stream()>>>(
+          q->data<T>(), k->data<T>(), v->data<T>(), bias_data,
+          d_out->data<T>(), lse_data, delta.data<AccT>(),
+          d_k ? d_k->mutable_data<T>(ctx.GetPlace()) : nullptr,
+          d_v ? d_v->mutable_data<T>(ctx.GetPlace()) : nullptr, dims, alpha,
+          dropout);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+namespace plat = paddle::platform;
+REGISTER_OP_CUDA_KERNEL(fused_attention, ops::FusedAttentionCUDAKernel<float>,
+                        ops::FusedAttentionCUDAKernel<double>,
+                        ops::FusedAttentionCUDAKernel<plat::float16>);
+REGISTER_OP_CUDA_KERNEL(fused_attention_grad,
+                        ops::FusedAttentionGradCUDAKernel<float>,
+                        ops::FusedAttentionGradCUDAKernel<double>,
+                        ops::FusedAttentionGradCUDAKernel<plat::float16>);
@@ -0,0 +1,432 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include "paddle/fluid/operators/fused/fused_attention_op.h"
+#include "paddle/fluid/platform/cuda_device_function.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+
+// Each warp of a block computes a row of the attention, and the keys (or the
+// queries in the backward of K and V) are loaded to the shared memory by
+// tiles of kWarpSize rows, each lane of a warp computing a score of the tile.
+constexpr int kWarpSize = 32;
+constexpr int kRowsPerBlock = 4;
+// The accumulated dims of each lane, so that head_dim and value_dim are at
+// most kWarpSize * kMaxDimsPerLane.
+constexpr int kMaxDimsPerLane = 4;
+constexpr unsigned kFullWarpMask = 0xFFFFFFFF;
+constexpr size_t kMaxSharedMemory = 48 * 1024;
+
+template <typename T>
+struct AttentionAccType {
+  using Type = T;
+};
+
+template <>
+struct AttentionAccType<platform::float16> {
+  using Type = float;
+};
+
+template <typename T>
+__device__ __forceinline__ T WarpReduceSum(T val) {
+  for (int offset = kWarpSize / 2; offset > 0; offset >>= 1) {
+    val += platform::CudaShuffleXorSync(kFullWarpMask, val, offset);
+  }
+  return val;
+}
+
+template <typename T>
+__device__ __forceinline__ T WarpReduceMax(T val) {
+  for (int offset = kWarpSize / 2; offset > 0; offset >>= 1) {
+    T other = platform::CudaShuffleXorSync(kFullWarpMask, val, offset);
+    val = other > val ? other : val;
+  }
+  return val;
+}
+
+// Load rows [row_begin, row_begin + rows) of the num_rows rows of dim
+// elements to the shared memory, the r-th of which starts at
+// src + r * row_stride * dim, filling the rows out of range with zero.
+template <typename T, typename AccT>
+__device__ __forceinline__ void LoadRows(const T* src, int row_begin,
+                                         int rows, int num_rows, int dim,
+                                         int row_stride, AccT* dst) {
+  int tid = threadIdx.y * kWarpSize + threadIdx.x;
+  for (int idx = tid; idx < rows * dim; idx += kRowsPerBlock * kWarpSize) {
+    int row = row_begin + idx / dim;
+    dst[idx] = row < num_rows
+                   ? static_cast<AccT>(
+                         src[static_cast<int64_t>(row) * row_stride * dim +
+                             idx % dim])
+                   : static_cast<AccT>(0);
+  }
+}
+
+// The forward. grid: [dims.batch, ceil(dims.seq_q / kRowsPerBlock)], where
+// the blocks out of the shorter sequences of the varlen inputs return.
+template <typename T, typename AccT>
+__global__ void FusedAttentionForwardKernel(const T* q, const T* k,
+                                            const T* v, const T* bias, T* out,
+                                            AccT* lse, AttentionDims dims,
+                                            AccT alpha,
+                                            AttentionDropout dropout) {
+  extern __shared__ __align__(sizeof(double)) unsigned char shared_buf[];
+  const int head_dim = dims.head_dim;
+  const int value_dim = dims.value_dim;
+  const int stride = dims.row_stride;
+  AccT* s_q = reinterpret_cast<AccT*>(shared_buf);
+  AccT* s_k = s_q + kRowsPerBlock * head_dim;
+  AccT* s_v = s_k + kWarpSize * head_dim;
+
+  const AttentionGroup group = dims.Group(blockIdx.x);
+  const int seq_q = group.seq_q;
+  const int seq_k = group.seq_k;
+  const int lane = threadIdx.x;
+  const int row_begin = blockIdx.y * kRowsPerBlock;
+  if (row_begin >= seq_q) return;
+  const int i = row_begin + threadIdx.y;
+  q += group.q_base * head_dim;
+  k += group.k_base * head_dim;
+  v += group.k_base * value_dim;
+  LoadRows(q, row_begin, kRowsPerBlock, seq_q, head_dim, stride, s_q);
+  const AccT* q_row = s_q + threadIdx.y * head_dim;
+  const int64_t row = group.q_base + static_cast<int64_t>(i) * stride;
+
+  AccT acc[kMaxDimsPerLane];
+  for (int r = 0; r < kMaxDimsPerLane; ++r) {
+    acc[r] = 0;
+  }
+  AccT row_max = static_cast<AccT>(kAttentionLowest);
+  AccT row_sum = 0;
+  for (int j0 = 0; j0 < seq_k; j0 += kWarpSize) {
+    int cols = min(kWarpSize, seq_k - j0);
+    __syncthreads();
+    LoadRows(k, j0, cols, seq_k, head_dim, stride, s_k);
+    LoadRows(v, j0, cols, seq_k, value_dim, stride, s_v);
+    __syncthreads();
+    // The rows are the same in a warp.
+    if (i >= seq_q) continue;
+
+    int j = j0 + lane;
+    AccT s = static_cast<AccT>(kAttentionLowest);
+    if (lane < cols) {
+      const AccT* k_row = s_k + lane * head_dim;
+      AccT dot = 0;
+      for (int d = 0; d < head_dim; ++d) {
+        dot += q_row[d] * k_row[d];
+      }
+      s = alpha * dot;
+      if (bias) {
+        s += static_cast<AccT>(bias[row * dims.seq_k + j]);
+      }
+    }
+    AccT new_max = WarpReduceMax(s);
+    new_max = new_max > row_max ? new_max : row_max;
+    AccT p = lane < cols ? exp(s - new_max) : static_cast<AccT>(0);
+    AccT correction = exp(row_max - new_max);
+    row_sum = row_sum * correction + WarpReduceSum(p);
+    AccT pd = p * static_cast<AccT>(dropout.Factor(row * dims.seq_k + j));
+    for (int r = 0; r < kMaxDimsPerLane; ++r) {
+      acc[r] *= correction;
+    }
+    for (int c = 0; c < cols; ++c) {
+      AccT pc = platform::CudaShuffleSync(kFullWarpMask, pd, c);
+      const AccT* v_row = s_v + c * value_dim;
+      for (int r = 0; r < kMaxDimsPerLane; ++r) {
+        int d = lane + r * kWarpSize;
+        if (d < value_dim) {
+          acc[r] += pc * v_row[d];
+        }
+      }
+    }
+    row_max = new_max;
+  }
+  if (i >= seq_q) return;
+  for (int r = 0; r < kMaxDimsPerLane; ++r) {
+    int d = lane + r * kWarpSize;
+    if (d < value_dim) {
+      out[row * value_dim + d] = static_cast<T>(acc[r] / row_sum);
+    }
+  }
+  if (lane == 0) {
+    lse[row] = row_max + log(row_sum);
+  }
+}
+
+// delta = rowsum(dOut .* Out). grid: [ceil(rows / kRowsPerBlock)].
+template <typename T, typename AccT>
+__global__ void AttentionDeltaKernel(const T* out, const T* d_out, AccT* delta,
+                                     int64_t rows, int value_dim) {
+  int64_t row = static_cast<int64_t>(blockIdx.x) * kRowsPerBlock + threadIdx.y;
+  if (row >= rows) return;
+  AccT sum = 0;
+  for (int d = threadIdx.x; d < value_dim; d += kWarpSize) {
+    sum += static_cast<AccT>(out[row * value_dim + d]) *
+           static_cast<AccT>(d_out[row * value_dim + d]);
+  }
+  sum = WarpReduceSum(sum);
+  if (threadIdx.x == 0) {
+    delta[row] = sum;
+  }
+}
+
+// The gradient of Q. grid: [dims.batch, ceil(dims.seq_q / kRowsPerBlock)].
+template <typename T, typename AccT>
+__global__ void FusedAttentionGradQKernel(
+    const T* q, const T* k, const T* v, const T* bias, const T* d_out,
+    const AccT* lse, const AccT* delta, T* d_q, AttentionDims dims,
+    AccT alpha, AttentionDropout dropout) {
+  extern __shared__ __align__(sizeof(double)) unsigned char shared_buf[];
+  const int head_dim = dims.head_dim;
+  const int value_dim = dims.value_dim;
+  const int stride = dims.row_stride;
+  AccT* s_q = reinterpret_cast<AccT*>(shared_buf);
+  AccT* s_d_out = s_q + kRowsPerBlock * head_dim;
+  AccT* s_k = s_d_out + kRowsPerBlock * value_dim;
+  AccT* s_v = s_k + kWarpSize * head_dim;
+
+  const AttentionGroup group = dims.Group(blockIdx.x);
+  const int seq_q = group.seq_q;
+  const int seq_k = group.seq_k;
+  const int lane = threadIdx.x;
+  const int row_begin = blockIdx.y * kRowsPerBlock;
+  if (row_begin >= seq_q) return;
+  const int i = row_begin + threadIdx.y;
+  q += group.q_base * head_dim;
+  d_out += group.q_base * value_dim;
+  k += group.k_base * head_dim;
+  v += group.k_base * value_dim;
+  LoadRows(q, row_begin, kRowsPerBlock, seq_q, head_dim, stride, s_q);
+  LoadRows(d_out, row_begin, kRowsPerBlock, seq_q, value_dim, stride,
+           s_d_out);
+  const AccT* q_row = s_q + threadIdx.y * head_dim;
+  const AccT* d_out_row = s_d_out + threadIdx.y * value_dim;
+  const int64_t row = group.q_base + static_cast<int64_t>(i) * stride;
+  const AccT row_lse = i < seq_q ? lse[row] : static_cast<AccT>(0);
+  const AccT row_delta = i < seq_q ? delta[row] : static_cast<AccT>(0);
+
+  AccT acc[kMaxDimsPerLane];
+  for (int r = 0; r < kMaxDimsPerLane; ++r) {
+    acc[r] = 0;
+  }
+  for (int j0 = 0; j0 < seq_k; j0 += kWarpSize) {
+    int cols = min(kWarpSize, seq_k - j0);
+    __syncthreads();
+    LoadRows(k, j0, cols, seq_k, head_dim, stride, s_k);
+    LoadRows(v, j0, cols, seq_k, value_dim, stride, s_v);
+    __syncthreads();
+    if (i >= seq_q) continue;
+
+    int j = j0 + lane;
+    AccT ds = 0;
+    if (lane < cols) {
+      const AccT* k_row = s_k + lane * head_dim;
+      const AccT* v_row = s_v + lane * value_dim;
+      AccT s = 0;
+      for (int d = 0; d < head_dim; ++d) {
+        s += q_row[d] * k_row[d];
+      }
+      s *= alpha;
+      if (bias) {
+        s += static_cast<AccT>(bias[row * dims.seq_k + j]);
+      }
+      AccT p = exp(s - row_lse);
+      AccT z = static_cast<AccT>(dropout.Factor(row * dims.seq_k + j));
+      AccT dpd = 0;
+      for (int d = 0; d < value_dim; ++d) {
+        dpd += d_out_row[d] * v_row[d];
+      }
+      ds = p * (dpd * z - row_delta);
+    }
+    for (int c = 0; c < cols; ++c) {
+      AccT dsc = platform::CudaShuffleSync(kFullWarpMask, ds, c);
+      const AccT* k_row = s_k + c * head_dim;
+      for (int r = 0; r < kMaxDimsPerLane; ++r) {
+        int d = lane + r * kWarpSize;
+        if (d < head_dim) {
+          acc[r] += dsc * k_row[d];
+        }
+      }
+    }
+  }
+  if (i >= seq_q) return;
+  for (int r = 0; r < kMaxDimsPerLane; ++r) {
+    int d = lane + r * kWarpSize;
+    if (d < head_dim) {
+      d_q[row * head_dim + d] = static_cast<T>(alpha * acc[r]);
+    }
+  }
+}
+
+// The gradients of K and V, where each warp computes a key and loops over
+// the tiles of the queries.
+// grid: [dims.batch, ceil(dims.seq_k / kRowsPerBlock)].
+template <typename T, typename AccT>
+__global__ void FusedAttentionGradKVKernel(
+    const T* q, const T* k, const T* v, const T* bias, const T* d_out,
+    const AccT* lse, const AccT* delta, T* d_k, T* d_v, AttentionDims dims,
+    AccT alpha, AttentionDropout dropout) {
+  extern __shared__ __align__(sizeof(double)) unsigned char shared_buf[];
+  const int head_dim = dims.head_dim;
+  const int value_dim = dims.value_dim;
+  const int stride = dims.row_stride;
+  AccT* s_k = reinterpret_cast<AccT*>(shared_buf);
+  AccT* s_v = s_k + kRowsPerBlock * head_dim;
+  AccT* s_q = s_v + kRowsPerBlock * value_dim;
+  AccT* s_d_out = s_q + kWarpSize * head_dim;
+  AccT* s_lse = s_d_out + kWarpSize * value_dim;
+  AccT* s_delta = s_lse + kWarpSize;
+
+  const AttentionGroup group = dims.Group(blockIdx.x);
+  const int seq_q = group.seq_q;
+  const int seq_k = group.seq_k;
+  const int lane = threadIdx.x;
+  const int tid = threadIdx.y * kWarpSize + lane;
+  const int row_begin = blockIdx.y * kRowsPerBlock;
+  if (row_begin >= seq_k) return;
+  const int j = row_begin + threadIdx.y;
+  q += group.q_base * head_dim;
+  d_out += group.q_base * value_dim;
+  k += group.k_base * head_dim;
+  v += group.k_base * value_dim;
+  LoadRows(k, row_begin, kRowsPerBlock, seq_k, head_dim, stride, s_k);
+  LoadRows(v, row_begin, kRowsPerBlock, seq_k, value_dim, stride, s_v);
+  const AccT* k_row = s_k + threadIdx.y * head_dim;
+  const AccT* v_row = s_v + threadIdx.y * value_dim;
+
+  AccT d_k_acc[kMaxDimsPerLane];
+  AccT d_v_acc[kMaxDimsPerLane];
+  for (int r = 0; r < kMaxDimsPerLane; ++r) {
+    d_k_acc[r] = 0;
+    d_v_acc[r] = 0;
+  }
+  for (int i0 = 0; i0 < seq_q; i0 += kWarpSize) {
+    int rows = min(kWarpSize, seq_q - i0);
+    __syncthreads();
+    LoadRows(q, i0, rows, seq_q, head_dim, stride, s_q);
+    LoadRows(d_out, i0, rows, seq_q, value_dim, stride, s_d_out);
+    if (tid < rows) {
+      int64_t row = group.q_base + static_cast<int64_t>(i0 + tid) * stride;
+      s_lse[tid] = lse[row];
+      s_delta[tid] = delta[row];
+    }
+    __syncthreads();
+    if (j >= seq_k) continue;
+
+    int64_t row = group.q_base + static_cast<int64_t>(i0 + lane) * stride;
+    AccT pd = 0;
+    AccT ds = 0;
+    if (lane < rows) {
+      const AccT* q_row = s_q + lane * head_dim;
+      const AccT* d_out_row = s_d_out + lane * value_dim;
+      AccT s = 0;
+      for (int d = 0; d < head_dim; ++d) {
+        s += q_row[d] * k_row[d];
+      }
+      s *= alpha;
+      if (bias) {
+        s += static_cast<AccT>(bias[row * dims.seq_k + j]);
+      }
+      AccT p = exp(s - s_lse[lane]);
+      AccT z = static_cast<AccT>(dropout.Factor(row * dims.seq_k + j));
+      AccT dpd = 0;
+      for (int d = 0; d < value_dim; ++d) {
+        dpd += d_out_row[d] * v_row[d];
+      }
+      pd = p * z;
+      ds = p * (dpd * z - s_delta[lane]);
+    }
+    for (int c = 0; c < rows; ++c) {
+      AccT pdc = platform::CudaShuffleSync(kFullWarpMask, pd, c);
+      AccT dsc = platform::CudaShuffleSync(kFullWarpMask, ds, c);
+      const AccT* q_row = s_q + c * head_dim;
+      const AccT* d_out_row = s_d_out + c * value_dim;
+      for (int r = 0; r < kMaxDimsPerLane; ++r) {
+        int d = lane + r * kWarpSize;
+        if (d < head_dim) {
+          d_k_acc[r] += dsc * q_row[d];
+        }
+        if (d < value_dim) {
+          d_v_acc[r] += pdc * d_out_row[d];
+        }
+      }
+    }
+  }
+  if (j >= seq_k) return;
+  const int64_t key = group.k_base + static_cast<int64_t>(j) * stride;
+  for (int r = 0; r < kMaxDimsPerLane; ++r) {
+    int d = lane + r * kWarpSize;
+    if (d_k && d < head_dim) {
+      d_k[key * head_dim + d] = static_cast<T>(alpha * d_k_acc[r]);
+    }
+    if (d_v && d < value_dim) {
+      d_v[key * value_dim + d] = static_cast<T>(d_v_acc[r]);
+    }
+  }
+}
+
+inline void CheckAttentionDims(const AttentionDims& dims, size_t shared_size) {
+  PADDLE_ENFORCE_LE(
+      std::max(dims.head_dim, dims.value_dim), kWarpSize * kMaxDimsPerLane,
+      platform::errors::Unimplemented(
+          "The CUDA kernel of fused_attention supports the head dims up to %d, "
+          "but received %d and %d.",
+          kWarpSize * kMaxDimsPerLane, dims.head_dim, dims.value_dim));
+  PADDLE_ENFORCE_LE(shared_size, kMaxSharedMemory,
+                    platform::errors::Unimplemented(
+                        "The CUDA kernel of fused_attention needs %d bytes "
+                        "of shared memory, which is more than %d.",
+                        shared_size, kMaxSharedMemory));
+}
+
+// Run the forward on the device, where the offsets of the varlen dims should
+// be on the device.
+template <typename T, typename AccT>
+void FusedAttentionForwardCUDA(const platform::CUDADeviceContext& dev_ctx,
+                               const T* q, const T* k, const T* v,
+                               const T* bias, T* out, AccT* lse,
+                               const AttentionDims& dims, AccT alpha,
+                               const AttentionDropout& dropout) {
+  size_t shared_size = (kRowsPerBlock * dims.head_dim +
+                        kWarpSize * (dims.head_dim + dims.value_dim)) *
+                       sizeof(AccT);
+  CheckAttentionDims(dims, shared_size);
+  if (dims.batch == 0 || dims.seq_q == 0) return;
+  dim3 grid(dims.batch, (dims.seq_q + kRowsPerBlock - 1) / kRowsPerBlock);
+  dim3 block(kWarpSize, kRowsPerBlock);
+  FusedAttentionForwardKernel<T, AccT><<<grid, block, shared_size,
+                                         dev_ctx.stream()>>>(
+      q, k, v, bias, out, lse, dims, alpha, dropout);
+}
+
+// Get the dims of the inputs of fused_attention, whose offsets of the varlen
+// inputs are on the device.
+inline AttentionDims GetCUDAAttentionDims(
+    const framework::ExecutionContext& ctx) {
+  auto dims = GetAttentionDims(ctx);
+  if (dims.q_lod != nullptr) {
+    dims.q_lod =
+        ctx.Input<LoDTensor>("Q")->lod().back().CUDAData(ctx.GetPlace());
+    dims.k_lod =
+        ctx.Input<LoDTensor>("K")->lod().back().CUDAData(ctx.GetPlace());
+  }
+  return dims;
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,418 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+// The scores are never less than it, which is used instead of the -inf to
+// start the running max of the softmax.
+constexpr double kAttentionLowest = -1e30;
+
+// The number of the keys processed at a time by the CPU kernel.
+constexpr int kAttentionBlockSize = 64;
+
+// The g-th group of the attention, whose r-th query is the row
+// q_base + r * row_stride of Q, and r-th key the row k_base + r * row_stride
+// of K and V.
+struct AttentionGroup {
+  int64_t q_base;
+  int64_t k_base;
+  int seq_q;
+  int seq_k;
+};
+
+/*
+ * The dense inputs are Q: [..., seq_q, head_dim], K: [..., seq_k, head_dim]
+ * and V: [..., seq_k, value_dim], where all the leading dims are batch, and
+ * each batch is a group.
+ *
+ * The varlen inputs are the packed sequences of LoDTensor, Q:
+ * [total_q, num_heads, head_dim], K: [total_k, num_heads, head_dim] and V:
+ * [total_k, num_heads, value_dim], where each (sequence, head) is a group
+ * and no padding is computed. The groups are given by the offsets q_lod and
+ * k_lod of the sequences, seq_q and seq_k are the max lengths, and
+ * row_stride is num_heads.
+ */
+struct AttentionDims {
+  int64_t batch;
+  int seq_q;
+  int seq_k;
+  int head_dim;
+  int value_dim;
+  int row_stride = 1;
+  const size_t* q_lod = nullptr;
+  const size_t* k_lod = nullptr;
+
+  HOSTDEVICE inline AttentionGroup Group(int64_t g) const {
+    AttentionGroup group;
+    if (q_lod == nullptr) {
+      group.q_base = g * seq_q;
+      group.k_base = g * seq_k;
+      group.seq_q = seq_q;
+      group.seq_k = seq_k;
+    } else {
+      int64_t s = g / row_stride;
+      int64_t h = g % row_stride;
+      group.q_base = static_cast<int64_t>(q_lod[s]) * row_stride + h;
+      group.k_base = static_cast<int64_t>(k_lod[s]) * row_stride + h;
+      group.seq_q = static_cast<int>(q_lod[s + 1] - q_lod[s]);
+      group.seq_k = static_cast<int>(k_lod[s + 1] - k_lod[s]);
+    }
+    return group;
+  }
+};
+
+inline AttentionDims GetAttentionDims(const framework::DDim& q_dims,
+                                      const framework::DDim& k_dims,
+                                      const framework::DDim& v_dims) {
+  int rank = q_dims.size();
+  AttentionDims dims;
+  dims.batch = framework::product(framework::slice_ddim(q_dims, 0, rank - 2));
+  dims.seq_q = static_cast<int>(q_dims[rank - 2]);
+  dims.seq_k = static_cast<int>(k_dims[rank - 2]);
+  dims.head_dim = static_cast<int>(q_dims[rank - 1]);
+  dims.value_dim = static_cast<int>(v_dims[rank - 1]);
+  return dims;
+}
+
+inline int MaxSequenceLength(const framework::Vector<size_t>& lod) {
+  size_t max_len = 0;
+  for (size_t i = 0; i + 1 < lod.size(); ++i) {
+    max_len = std::max(max_len, lod[i + 1] - lod[i]);
+  }
+  return static_cast<int>(max_len);
+}
+
+// Get the dims of the varlen inputs, whose q_lod and k_lod are the offsets
+// of the last level of the LoD on CPU.
+inline AttentionDims GetVarlenAttentionDims(const LoDTensor& q,
+                                            const LoDTensor& k,
+                                            const LoDTensor& v) {
+  for (auto* t : {&q, &k}) {
+    PADDLE_ENFORCE_EQ(
+        t->lod().empty(), false,
+        platform::errors::InvalidArgument(
+            "The varlen inputs of fused_attention should have the LoD."));
+    PADDLE_ENFORCE_EQ(
+        t->lod().back().back(), static_cast<size_t>(t->dims()[0]),
+        platform::errors::InvalidArgument(
+            "The last offset of the LoD of the varlen inputs of "
+            "fused_attention should be the total length %d, but got %d.",
+            t->dims()[0], t->lod().back().back()));
+  }
+  auto& q_lod = q.lod().back();
+  auto& k_lod = k.lod().back();
+  PADDLE_ENFORCE_EQ(q_lod.size(), k_lod.size(),
+                    platform::errors::InvalidArgument(
+                        "The numbers of the sequences of Input(Q) and "
+                        "Input(K) of fused_attention should be the same, but "
+                        "got %d and %d.",
+                        q_lod.size() - 1, k_lod.size() - 1));
+  AttentionDims dims;
+  dims.row_stride = static_cast<int>(q.dims()[1]);
+  dims.batch = static_cast<int64_t>(q_lod.size() - 1) * dims.row_stride;
+  dims.seq_q = MaxSequenceLength(q_lod);
+  dims.seq_k = MaxSequenceLength(k_lod);
+  dims.head_dim = static_cast<int>(q.dims()[2]);
+  dims.value_dim = static_cast<int>(v.dims()[2]);
+  dims.q_lod = q_lod.data();
+  dims.k_lod = k_lod.data();
+  return dims;
+}
+
+inline AttentionDims GetAttentionDims(const framework::ExecutionContext& ctx) {
+  auto* q = ctx.Input<LoDTensor>("Q");
+  auto* k = ctx.Input<LoDTensor>("K");
+  auto* v = ctx.Input<LoDTensor>("V");
+  if (ctx.Attr<bool>("varlen")) {
+    return GetVarlenAttentionDims(*q, *k, *v);
+  }
+  return GetAttentionDims(q->dims(), k->dims(), v->dims());
+}
+
+// The dropout of the attention weights. Whether an element is dropped is
+// decided by a hash of the seed and its index instead of a stored mask, so
+// that the backward regenerates it block by block, without the full
+// [seq_q, seq_k] matrix.
+struct AttentionDropout {
+  float prob;
+  bool is_test;
+  bool upscale_in_train;
+  uint32_t seed;
+
+  HOSTDEVICE inline float Factor(uint64_t index) const {
+    if (is_test) {
+      return upscale_in_train ? 1.0f : 1.0f - prob;
+    }
+    if (prob == 0.0f) {
+      return 1.0f;
+    }
+    uint64_t x = index * 0x9E3779B97F4A7C15ULL ^
+                 static_cast<uint64_t>(seed) * 0xD6E8FEB86659FD93ULL;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    float uniform = static_cast<float>(x >> 40) * (1.0f / 16777216.0f);
+    if (uniform < prob) {
+      return 0.0f;
+    }
+    return upscale_in_train ? 1.0f / (1.0f - prob) : 1.0f;
+  }
+};
+
+// Get the dropout of fused_attention, and save the seed used to
+// Output(SeedOut), which is always on CPU.
+inline AttentionDropout GetAttentionDropout(
+    const framework::ExecutionContext& ctx, Tensor* seed_out) {
+  AttentionDropout dropout;
+  dropout.prob = ctx.Attr<float>("dropout_prob");
+  dropout.is_test = ctx.Attr<bool>("is_test");
+  dropout.upscale_in_train =
+      ctx.Attr<std::string>("dropout_implementation") == "upscale_in_train";
+  // NOTE: fixed seed should only be used in unittest or for debug.
+  // Guarantee to use random seed in training.
+  int seed = 0;
+  if (ctx.Attr<bool>("fix_seed")) {
+    seed = ctx.Attr<int>("seed");
+  } else {
+    std::random_device rnd;
+    seed = static_cast<int>(rnd());
+  }
+  seed_out->Resize({1});
+  seed_out->mutable_data<int>(platform::CPUPlace())[0] = seed;
+  dropout.seed = static_cast<uint32_t>(seed);
+  return dropout;
+}
+
+// Get the dropout of fused_attention_grad with the seed of the forward.
+inline AttentionDropout GetAttentionGradDropout(
+    const framework::ExecutionContext& ctx) {
+  AttentionDropout dropout;
+  dropout.prob = ctx.Attr<float>("dropout_prob");
+  dropout.is_test = ctx.Attr<bool>("is_test");
+  dropout.upscale_in_train =
+      ctx.Attr<std::string>("dropout_implementation") == "upscale_in_train";
+  auto* seed = ctx.Input<Tensor>("SeedOut");
+  if (platform::is_cpu_place(seed->place())) {
+    dropout.seed = static_cast<uint32_t>(seed->data<int>()[0]);
+  } else {
+    Tensor cpu_seed;
+    framework::TensorCopySync(*seed, platform::CPUPlace(), &cpu_seed);
+    dropout.seed = static_cast<uint32_t>(cpu_seed.data<int>()[0]);
+  }
+  return dropout;
+}
+
+template <typename T>
+inline T AttentionDot(const T* x, const T* y, int n) {
+  T sum = 0;
+  for (int i = 0; i < n; ++i) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+/*
+ * Out = dropout(softmax(alpha * Q * K^T + BiasQK)) * V
+ *
+ * The softmax is computed online over the blocks of the keys, so that only
+ * the running max and sum of each row are kept, and the log-sum-exp of the
+ * rows is saved to Output(SoftmaxLse) for the backward.
+ */
+template <typename DeviceContext, typename T>
+class FusedAttentionKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* q = ctx.Input<Tensor>("Q");
+    auto* k = ctx.Input<Tensor>("K");
+    auto* v = ctx.Input<Tensor>("V");
+    auto* bias = ctx.Input<Tensor>("BiasQK");
+    auto* out = ctx.Output<Tensor>("Out");
+    auto* lse = ctx.Output<Tensor>("SoftmaxLse");
+    auto* seed_out = ctx.Output<Tensor>("SeedOut");
+
+    auto dims = GetAttentionDims(ctx);
+    auto dropout = GetAttentionDropout(ctx, seed_out);
+    T alpha = static_cast<T>(ctx.Attr<float>("alpha"));
+
+    const T* q_data = q->data<T>();
+    const T* k_data = k->data<T>();
+    const T* v_data = v->data<T>();
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    T* lse_data = lse->mutable_data<T>(ctx.GetPlace());
+
+    std::vector<T> scores(kAttentionBlockSize);
+    std::vector<T> acc(dims.value_dim);
+    for (int64_t g = 0; g < dims.batch; ++g) {
+      auto group = dims.Group(g);
+      for (int i = 0; i < group.seq_q; ++i) {
+        int64_t row = group.q_base + i * dims.row_stride;
+        const T* q_row = q_data + row * dims.head_dim;
+        const T* bias_row = bias_data ? bias_data + row * dims.seq_k : nullptr;
+        T row_max = static_cast<T>(kAttentionLowest);
+        T row_sum = 0;
+        std::fill(acc.begin(), acc.end(), static_cast<T>(0));
+        for (int j0 = 0; j0 < group.seq_k; j0 += kAttentionBlockSize) {
+          int cols = std::min(kAttentionBlockSize, group.seq_k - j0);
+          T block_max = static_cast<T>(kAttentionLowest);
+          for (int c = 0; c < cols; ++c) {
+            int j = j0 + c;
+            int64_t key = group.k_base + j * dims.row_stride;
+            T s = alpha * AttentionDot(q_row, k_data + key * dims.head_dim,
+                                       dims.head_dim);
+            if (bias_row) {
+              s += bias_row[j];
+            }
+            scores[c] = s;
+            block_max = std::max(block_max, s);
+          }
+          T new_max = std::max(row_max, block_max);
+          T correction = std::exp(row_max - new_max);
+          row_sum *= correction;
+          for (auto& a : acc) {
+            a *= correction;
+          }
+          for (int c = 0; c < cols; ++c) {
+            int j = j0 + c;
+            T p = std::exp(scores[c] - new_max);
+            row_sum += p;
+            T pd = p * static_cast<T>(dropout.Factor(row * dims.seq_k + j));
+            if (pd == static_cast<T>(0)) continue;
+            const T* v_row =
+                v_data + (group.k_base + j * dims.row_stride) * dims.value_dim;
+            for (int d = 0; d < dims.value_dim; ++d) {
+              acc[d] += pd * v_row[d];
+            }
+          }
+          row_max = new_max;
+        }
+        T* out_row = out_data + row * dims.value_dim;
+        for (int d = 0; d < dims.value_dim; ++d) {
+          out_row[d] = acc[d] / row_sum;
+        }
+        lse_data[row] = row_max + std::log(row_sum);
+      }
+    }
+  }
+};
+
+/*
+ * With P = softmax(S), Z the dropout factors, and the gradient dOut:
+ *   dV = (P .* Z)^T * dOut
+ *   dS = P .* (dOut * V^T .* Z - rowsum(dOut .* Out))
+ *   dQ = alpha * dS * K, dK = alpha * dS^T * Q
+ * P and Z are recomputed element by element from Input(SoftmaxLse) and the
+ * seed.
+ */
+template <typename DeviceContext, typename T>
+class FusedAttentionGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* q = ctx.Input<Tensor>("Q");
+    auto* k = ctx.Input<Tensor>("K");
+    auto* v = ctx.Input<Tensor>("V");
+    auto* bias = ctx.Input<Tensor>("BiasQK");
+    auto* out = ctx.Input<Tensor>("Out");
+    auto* lse = ctx.Input<Tensor>("SoftmaxLse");
+    auto* d_out = ctx.Input<Tensor>(framework::GradVarName("Out"));
+    auto* d_q = ctx.Output<Tensor>(framework::GradVarName("Q"));
+    auto* d_k = ctx.Output<Tensor>(framework::GradVarName("K"));
+    auto* d_v = ctx.Output<Tensor>(framework::GradVarName("V"));
+
+    auto dims = GetAttentionDims(ctx);
+    auto dropout = GetAttentionGradDropout(ctx);
+    T alpha = static_cast<T>(ctx.Attr<float>("alpha"));
+
+    const T* q_data = q->data<T>();
+    const T* k_data = k->data<T>();
+    const T* v_data = v->data<T>();
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    const T* out_data = out->data<T>();
+    const T* lse_data = lse->data<T>();
+    const T* d_out_data = d_out->data<T>();
+    auto get_grad = [&](Tensor* grad) -> T* {
+      if (grad == nullptr) return nullptr;
+      T* data = grad->mutable_data<T>(ctx.GetPlace());
+      std::fill(data, data + grad->numel(), static_cast<T>(0));
+      return data;
+    };
+    T* d_q_data = get_grad(d_q);
+    T* d_k_data = get_grad(d_k);
+    T* d_v_data = get_grad(d_v);
+
+    for (int64_t g = 0; g < dims.batch; ++g) {
+      auto group = dims.Group(g);
+      for (int i = 0; i < group.seq_q; ++i) {
+        int64_t row = group.q_base + i * dims.row_stride;
+        const T* q_row = q_data + row * dims.head_dim;
+        const T* d_out_row = d_out_data + row * dims.value_dim;
+        const T* bias_row = bias_data ? bias_data + row * dims.seq_k : nullptr;
+        T delta = AttentionDot(d_out_row, out_data + row * dims.value_dim,
+                               dims.value_dim);
+        for (int j = 0; j < group.seq_k; ++j) {
+          int64_t key = group.k_base + j * dims.row_stride;
+          const T* k_row = k_data + key * dims.head_dim;
+          const T* v_row = v_data + key * dims.value_dim;
+          T s = alpha * AttentionDot(q_row, k_row, dims.head_dim);
+          if (bias_row) {
+            s += bias_row[j];
+          }
+          T p = std::exp(s - lse_data[row]);
+          T z = static_cast<T>(dropout.Factor(row * dims.seq_k + j));
+          if (d_v_data && p * z != static_cast<T>(0)) {
+            T* d_v_row = d_v_data + key * dims.value_dim;
+            for (int d = 0; d < dims.value_dim; ++d) {
+              d_v_row[d] += p * z * d_out_row[d];
+            }
+          }
+          T ds = p * (AttentionDot(d_out_row, v_row, dims.value_dim) * z -
+                      delta);
+          if (d_q_data) {
+            T* d_q_row = d_q_data + row * dims.head_dim;
+            for (int d = 0; d < dims.head_dim; ++d) {
+              d_q_row[d] += alpha * ds * k_row[d];
+            }
+          }
+          if (d_k_data) {
+            T* d_k_row = d_k_data + key * dims.head_dim;
+            for (int d = 0; d < dims.head_dim; ++d) {
+              d_k_row[d] += alpha * ds * q_row[d];
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
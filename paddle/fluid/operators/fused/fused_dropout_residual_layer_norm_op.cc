@@ -0,0 +1,304 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_dropout_residual_layer_norm_op.h"
+#include <memory>
+#include <string>
+
+namespace paddle {
+namespace operators {
+
+class FusedDropoutResidualLayerNormOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->HasInput("X"), true,
+                      platform::errors::NotFound(
+                          "Input(X) of "
+                          "fused_dropout_residual_layer_norm should not be "
+                          "null."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("Residual"), true,
+                      platform::errors::NotFound(
+                          "Input(Residual) of "
+                          "fused_dropout_residual_layer_norm should not be "
+                          "null."));
+    for (auto &name : {"Y", "DropoutResidualOut", "Mean", "Variance"}) {
+      PADDLE_ENFORCE_EQ(ctx->HasOutput(name), true,
+                        platform::errors::NotFound(
+                            "Output(%s) of "
+                            "fused_dropout_residual_layer_norm should not be "
+                            "null.",
+                            name));
+    }
+
+    auto x_dims = ctx->GetInputDim("X");
+    auto residual_dims = ctx->GetInputDim("Residual");
+    if (ctx->IsRuntime()) {
+      PADDLE_ENFORCE_EQ(
+          x_dims, residual_dims,
+          platform::errors::InvalidArgument(
+              "The shapes of Input(X) and Input(Residual) of "
+              "fused_dropout_residual_layer_norm should be the same, but "
+              "received [%s] and [%s].",
+              x_dims, residual_dims));
+    }
+    int begin_norm_axis = ctx->Attrs().Get<int>("begin_norm_axis");
+    PADDLE_ENFORCE_EQ(
+        begin_norm_axis > 0 && begin_norm_axis < x_dims.size(), true,
+        platform::errors::InvalidArgument(
+            "Attr(begin_norm_axis) of fused_dropout_residual_layer_norm "
+            "should be in the range [1, %d), but received %d.",
+            x_dims.size(), begin_norm_axis));
+    auto matrix_dim = framework::flatten_to_2d(x_dims, begin_norm_axis);
+    int64_t rows = matrix_dim[0];
+    int64_t cols = matrix_dim[1];
+    for (auto &name : {"Scale", "Bias"}) {
+      if (ctx->HasInput(name) && ctx->IsRuntime()) {
+        auto dims = ctx->GetInputDim(name);
+        PADDLE_ENFORCE_EQ(
+            dims.size() == 1 && dims[0] == cols, true,
+            platform::errors::InvalidArgument(
+                "The shape of Input(%s) of fused_dropout_residual_layer_norm "
+                "should be [%d], but received [%s].",
+                name, cols, dims));
+      }
+    }
+
+    ctx->SetOutputDim("Y", x_dims);
+    ctx->SetOutputDim("DropoutResidualOut", x_dims);
+    if (ctx->Attrs().Get<bool>("is_test") == false) {
+      ctx->SetOutputDim("DropoutMask", {rows, DropoutMaskBytes(cols)});
+    }
+    ctx->SetOutputDim("Mean", {rows});
+    ctx->SetOutputDim("Variance", {rows});
+    ctx->ShareLoD("X", "Y");
+    ctx->ShareLoD("X", "DropoutResidualOut");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "X"), ctx.GetPlace());
+  }
+};
+
+class FusedDropoutResidualLayerNormOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) The input dropped out, e.g. the output of fc.");
+    AddInput("Residual",
+             "(Tensor) The residual added to the dropout of X, with the same "
+             "shape as X.");
+    AddInput("Scale",
+             "(Tensor, optional) The scale of the layer_norm, with shape "
+             "[right], where right is the product of the dims of X from "
+             "begin_norm_axis.")
+        .AsDispensable();
+    AddInput("Bias",
+             "(Tensor, optional) The bias of the layer_norm, with shape "
+             "[right].")
+        .AsDispensable();
+    AddOutput("Y", "(Tensor) The output, with the same shape as X.");
+    AddOutput("DropoutMask",
+              "(Tensor) The dropout mask of uint8 by bits, with shape [left, "
+              "ceil(right / 8)], which is saved for the backward. It is not "
+              "computed if is_test is true.")
+        .AsIntermediate();
+    AddOutput("DropoutResidualOut",
+              "(Tensor) Residual + dropout(X), the input of the layer_norm, "
+              "which is saved for the backward.")
+        .AsIntermediate();
+    AddOutput("Mean", "(Tensor) The mean of the layer_norm, with shape [left].")
+        .AsIntermediate();
+    AddOutput("Variance",
+              "(Tensor) The variance of the layer_norm, with shape [left].")
+        .AsIntermediate();
+    AddAttr<float>("dropout_prob", "Probability of setting units of X to zero.")
+        .SetDefault(0.5f)
+        .AddCustomChecker([](const float &drop_p) {
+          PADDLE_ENFORCE_EQ(drop_p >= 0.0f && drop_p <= 1.0f, true,
+                            platform::errors::InvalidArgument(
+                                "'dropout_prob' must be between 0.0 and 1.0."));
+        });
+    AddAttr<bool>("is_test",
+                  "(bool, default false) Set to true for inference only, false "
+                  "for training.")
+        .SetDefault(false);
+    AddAttr<bool>("fix_seed",
+                  "A flag indicating whether to use a fixed seed to generate "
+                  "random mask. NOTE: DO NOT set this flag to true in "
+                  "training. Setting this flag to true is only useful in "
+                  "unittest or for debug that always the same output units "
+                  "will be dropped.")
+        .SetDefault(false);
+    AddAttr<int>("seed", "Dropout random seed.").SetDefault(0);
+    AddAttr<std::string>(
+        "dropout_implementation",
+        "[\"downgrade_in_infer\"|\"upscale_in_train\"], the same as the "
+        "attribute of dropout.")
+        .SetDefault("downgrade_in_infer")
+        .AddCustomChecker([](const std::string &type) {
+          PADDLE_ENFORCE_EQ(
+              type == "downgrade_in_infer" || type == "upscale_in_train", true,
+              platform::errors::InvalidArgument(
+                  "dropout_implementation can only be downgrade_in_infer or "
+                  "upscale_in_train"));
+        });
+    AddAttr<float>("epsilon",
+                   "Constant for numerical stability of the layer_norm.")
+        .SetDefault(1e-5)
+        .AddCustomChecker([](const float &epsilon) {
+          PADDLE_ENFORCE_EQ(epsilon >= 0.0f && epsilon <= 0.001f, true,
+                            platform::errors::InvalidArgument(
+                                "'epsilon' should be between 0.0 and 0.001."));
+        });
+    AddAttr<int>("begin_norm_axis",
+                 "The dims of X from begin_norm_axis are normalized, the same "
+                 "as the attribute of layer_norm.")
+        .SetDefault(1);
+    AddComment(R"DOC(
+FusedDropoutResidualLayerNorm Operator.
+
+It computes the residual block of the transformer
+
+    DropoutResidualOut = Residual + dropout(X)
+    Y = layer_norm(DropoutResidualOut) * Scale + Bias
+
+in one operator, which replaces dropout, elementwise_add and layer_norm, and
+is created by fuse_dropout_residual_layer_norm_pass. The backward is fused
+as well, and computes the gradients of X and Residual in one pass over the
+rows.
+
+The dropout mask is saved by bits instead of a byte for each element, and
+the output of the dropout is not saved, since the backward only needs the
+input of the layer_norm.
+)DOC");
+  }
+};
+
+template <typename T>
+class FusedDropoutResidualLayerNormGradOpMaker
+    : public framework::SingleGradOpMaker<T> {
+ public:
+  using framework::SingleGradOpMaker<T>::SingleGradOpMaker;
+
+ protected:
+  void Apply(GradOpPtr<T> op) const override {
+    op->SetType("fused_dropout_residual_layer_norm_grad");
+    op->SetInput("DropoutResidualOut", this->Output("DropoutResidualOut"));
+    op->SetInput("DropoutMask", this->Output("DropoutMask"));
+    op->SetInput("Mean", this->Output("Mean"));
+    op->SetInput("Variance", this->Output("Variance"));
+    if (this->HasInput("Scale")) {
+      op->SetInput("Scale", this->Input("Scale"));
+      op->SetOutput(framework::GradVarName("Scale"), this->InputGrad("Scale"));
+    }
+    if (this->HasInput("Bias")) {
+      op->SetOutput(framework::GradVarName("Bias"), this->InputGrad("Bias"));
+    }
+    op->SetInput(framework::GradVarName("Y"), this->OutputGrad("Y"));
+    op->SetOutput(framework::GradVarName("X"), this->InputGrad("X"));
+    op->SetOutput(framework::GradVarName("Residual"),
+                  this->InputGrad("Residual"));
+    op->SetAttrMap(this->Attrs());
+  }
+};
+
+class FusedDropoutResidualLayerNormGradOp
+    : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    for (auto &name : {"DropoutResidualOut", "Mean", "Variance"}) {
+      PADDLE_ENFORCE_EQ(ctx->HasInput(name), true,
+                        platform::errors::NotFound(
+                            "Input(%s) of "
+                            "fused_dropout_residual_layer_norm_grad should "
+                            "not be null.",
+                            name));
+    }
+    PADDLE_ENFORCE_EQ(ctx->HasInput(framework::GradVarName("Y")), true,
+                      platform::errors::NotFound(
+                          "Input(%s) of fused_dropout_residual_layer_norm_grad "
+                          "should not be null.",
+                          framework::GradVarName("Y")));
+
+    auto z_dims = ctx->GetInputDim("DropoutResidualOut");
+    for (auto &name : {"X", "Residual"}) {
+      auto grad_name = framework::GradVarName(name);
+      if (ctx->HasOutput(grad_name)) {
+        ctx->SetOutputDim(grad_name, z_dims);
+        ctx->ShareLoD("DropoutResidualOut", grad_name);
+      }
+    }
+    auto matrix_dim = framework::flatten_to_2d(
+        z_dims, ctx->Attrs().Get<int>("begin_norm_axis"));
+    for (auto &name : {"Scale", "Bias"}) {
+      auto grad_name = framework::GradVarName(name);
+      if (ctx->HasOutput(grad_name)) {
+        ctx->SetOutputDim(grad_name, {matrix_dim[1]});
+      }
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return framework::OpKernelType(OperatorWithKernel::IndicateVarDataType(
+                                       ctx, framework::GradVarName("Y")),
+                                   ctx.GetPlace());
+  }
+
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string &var_name, const Tensor &tensor,
+      const framework::OpKernelType &expected_kernel_type) const override {
+    // The mask is kept in uint8.
+    if (var_name == "DropoutMask") {
+      return framework::OpKernelType(tensor.type(), tensor.place(),
+                                     tensor.layout());
+    }
+    return framework::OpKernelType(expected_kernel_type.data_type_,
+                                   tensor.place(), tensor.layout());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(
+    fused_dropout_residual_layer_norm, ops::FusedDropoutResidualLayerNormOp,
+    ops::FusedDropoutResidualLayerNormOpMaker,
+    ops::FusedDropoutResidualLayerNormGradOpMaker<paddle::framework::OpDesc>,
+    ops::FusedDropoutResidualLayerNormGradOpMaker<
+        paddle::imperative::OpBase>);
+REGISTER_OPERATOR(fused_dropout_residual_layer_norm_grad,
+                  ops::FusedDropoutResidualLayerNormGradOp);
+
+REGISTER_OP_CPU_KERNEL(
+    fused_dropout_residual_layer_norm,
+    ops::FusedDropoutResidualLayerNormKernel<
+        paddle::platform::CPUDeviceContext, float>,
+    ops::FusedDropoutResidualLayerNormKernel<
+        paddle::platform::CPUDeviceContext, double>);
+REGISTER_OP_CPU_KERNEL(
+    fused_dropout_residual_layer_norm_grad,
+    ops::FusedDropoutResidualLayerNormGradKernel<
+        paddle::platform::CPUDeviceContext, float>,
+    ops::FusedDropoutResidualLayerNormGradKernel<
+        paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,301 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <curand_kernel.h>
+#include <cub/cub.cuh>
+#include "paddle/fluid/operators/fused/fused_dropout_residual_layer_norm_op.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+
+// Each block computes a row, and each thread the bytes of the mask
+// [tid, tid + kRowBlockDim, ...), i.e. kDropoutMaskBits elements at a time.
+constexpr int kRowBlockDim = 256;
+// The blocks of the gradients of Scale and Bias, each of which reduces
+// kColBlockDimX columns over the rows by kColBlockDimY threads.
+constexpr int kColBlockDimX = 32;
+constexpr int kColBlockDimY = 8;
+
+template <typename T>
+struct ResidualLayerNormPair {
+  T first;
+  T second;
+
+  HOSTDEVICE inline ResidualLayerNormPair() {}
+  HOSTDEVICE inline ResidualLayerNormPair(T first, T second)
+      : first(first), second(second) {}
+};
+
+template <typename T>
+struct ResidualLayerNormPairSum {
+  __device__ __forceinline__ ResidualLayerNormPair<T> operator()(
+      const ResidualLayerNormPair<T>& a,
+      const ResidualLayerNormPair<T>& b) const {
+    return ResidualLayerNormPair<T>(a.first + b.first, a.second + b.second);
+  }
+};
+
+template <typename T>
+__global__ void FusedDropoutResidualLayerNormForward(
+    const T* x, const T* residual, const T* scale, const T* bias, int seed,
+    ResidualDropout dropout, float epsilon, int64_t cols, uint8_t* mask, T* z,
+    T* y, T* mean, T* var) {
+  using BlockReduce =
+      cub::BlockReduce<ResidualLayerNormPair<double>, kRowBlockDim>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ double row_mean;
+  __shared__ double row_inv_std;
+
+  int64_t row = blockIdx.x;
+  int64_t bytes = DropoutMaskBytes(cols);
+  int64_t offset = row * cols;
+  T factor = static_cast<T>(dropout.Factor());
+  ResidualLayerNormPair<double> moments(0, 0);
+  for (int64_t b = threadIdx.x; b < bytes; b += kRowBlockDim) {
+    float rand[kDropoutMaskBits];
+    if (dropout.HasMask()) {
+      curandStatePhilox4_32_10_t state;
+      curand_init(seed, row * bytes + b, 0, &state);
+      for (int k = 0; k < kDropoutMaskBits; k += 4) {
+        float4 rand4 = curand_uniform4(&state);
+        rand[k] = rand4.x;
+        rand[k + 1] = rand4.y;
+        rand[k + 2] = rand4.z;
+        rand[k + 3] = rand4.w;
+      }
+    }
+    uint8_t bits = 0;
+    for (int k = 0; k < kDropoutMaskBits; ++k) {
+      int64_t j = b * kDropoutMaskBits + k;
+      if (j >= cols) break;
+      bool kept = !dropout.HasMask() ||
+                  (rand[k] >= dropout.prob && dropout.prob < 1.0f);
+      bits |= static_cast<uint8_t>(kept) << k;
+      T value = residual[offset + j] + (kept ? factor * x[offset + j] : 0);
+      z[offset + j] = value;
+      double v = static_cast<double>(value);
+      moments.first += v;
+      moments.second += v * v;
+    }
+    if (mask) {
+      mask[row * bytes + b] = bits;
+    }
+  }
+  moments = BlockReduce(temp_storage)
+                .Reduce(moments, ResidualLayerNormPairSum<double>());
+  if (threadIdx.x == 0) {
+    double m = moments.first / cols;
+    double v = moments.second / cols - m * m;
+    v = v > 0 ? v : 0;
+    mean[row] = static_cast<T>(m);
+    var[row] = static_cast<T>(v);
+    row_mean = m;
+    row_inv_std = rsqrt(v + epsilon);
+  }
+  // The elements of z written by the other threads are visible after the
+  // barrier.
+  __syncthreads();
+
+  for (int64_t j = threadIdx.x; j < cols; j += kRowBlockDim) {
+    T out = static_cast<T>((static_cast<double>(z[offset + j]) - row_mean) *
+                           row_inv_std);
+    if (scale) {
+      out *= scale[j];
+    }
+    if (bias) {
+      out += bias[j];
+    }
+    y[offset + j] = out;
+  }
+}
+
+template <typename T>
+__global__ void FusedDropoutResidualLayerNormGradInput(
+    const T* z, const T* mean, const T* var, const T* scale, const T* d_y,
+    const uint8_t* mask, ResidualDropout dropout, float epsilon, int64_t cols,
+    T* d_x, T* d_residual) {
+  using BlockReduce = cub::BlockReduce<ResidualLayerNormPair<T>, kRowBlockDim>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ T d_norm_mean;
+  __shared__ T d_norm_dot_mean;
+
+  int64_t row = blockIdx.x;
+  int64_t offset = row * cols;
+  T row_mean = mean[row];
+  T inv_std = rsqrt(var[row] + static_cast<T>(epsilon));
+  ResidualLayerNormPair<T> sums(0, 0);
+  for (int64_t j = threadIdx.x; j < cols; j += kRowBlockDim) {
+    T z_norm = (z[offset + j] - row_mean) * inv_std;
+    T d_norm = scale ? d_y[offset + j] * scale[j] : d_y[offset + j];
+    sums.first += d_norm;
+    sums.second += d_norm * z_norm;
+  }
+  sums = BlockReduce(temp_storage).Reduce(sums, ResidualLayerNormPairSum<T>());
+  if (threadIdx.x == 0) {
+    d_norm_mean = sums.first / cols;
+    d_norm_dot_mean = sums.second / cols;
+  }
+  __syncthreads();
+
+  const uint8_t* mask_row =
+      mask ? mask + row * DropoutMaskBytes(cols) : nullptr;
+  T factor = static_cast<T>(dropout.Factor());
+  for (int64_t j = threadIdx.x; j < cols; j += kRowBlockDim) {
+    T z_norm = (z[offset + j] - row_mean) * inv_std;
+    T d_norm = scale ? d_y[offset + j] * scale[j] : d_y[offset + j];
+    T d_z = (d_norm - d_norm_mean - z_norm * d_norm_dot_mean) * inv_std;
+    if (d_residual) {
+      d_residual[offset + j] = d_z;
+    }
+    if (d_x) {
+      bool kept = mask_row == nullptr || DropoutMaskKept(mask_row, j);
+      d_x[offset + j] = kept ? d_z * factor : static_cast<T>(0);
+    }
+  }
+}
+
+template <typename T>
+__global__ void FusedDropoutResidualLayerNormGradParam(
+    const T* z, const T* mean, const T* var, const T* d_y, float epsilon,
+    int64_t rows, int64_t cols, T* d_scale, T* d_bias) {
+  __shared__ T scale_sums[kColBlockDimY][kColBlockDimX];
+  __shared__ T bias_sums[kColBlockDimY][kColBlockDimX];
+
+  int64_t j = static_cast<int64_t>(blockIdx.x) * kColBlockDimX + threadIdx.x;
+  T scale_sum = 0;
+  T bias_sum = 0;
+  if (j < cols) {
+    for (int64_t i = threadIdx.y; i < rows; i += kColBlockDimY) {
+      T d = d_y[i * cols + j];
+      if (d_scale) {
+        T inv_std = rsqrt(var[i] + static_cast<T>(epsilon));
+        scale_sum += d * (z[i * cols + j] - mean[i]) * inv_std;
+      }
+      bias_sum += d;
+    }
+  }
+  scale_sums[threadIdx.y][threadIdx.x] = scale_sum;
+  bias_sums[threadIdx.y][threadIdx.x] = bias_sum;
+  __syncthreads();
+  if (threadIdx.y == 0 && j < cols) {
+    for (int k = 1; k < kColBlockDimY; ++k) {
+      scale_sum += scale_sums[k][threadIdx.x];
+      bias_sum += bias_sums[k][threadIdx.x];
+    }
+    if (d_scale) {
+      d_scale[j] = scale_sum;
+    }
+    if (d_bias) {
+      d_bias[j] = bias_sum;
+    }
+  }
+}
+
+template <typename T>
+class FusedDropoutResidualLayerNormCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* residual = ctx.Input<Tensor>("Residual");
+    auto* scale = ctx.Input<Tensor>("Scale");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* y = ctx.Output<Tensor>("Y");
+    auto* z = ctx.Output<Tensor>("DropoutResidualOut");
+    auto* mean = ctx.Output<Tensor>("Mean");
+    auto* var = ctx.Output<Tensor>("Variance");
+    auto dropout = GetResidualDropout(ctx);
+
+    auto matrix_dim =
+        framework::flatten_to_2d(x->dims(), ctx.Attr<int>("begin_norm_axis"));
+    int64_t rows = matrix_dim[0];
+    int64_t cols = matrix_dim[1];
+    if (rows == 0) return;
+    auto* mask = ctx.Output<Tensor>("DropoutMask");
+    uint8_t* mask_data = !dropout.is_test && mask
+                             ? mask->mutable_data<uint8_t>(ctx.GetPlace())
+                             : nullptr;
+    int seed = dropout.HasMask() ? GetResidualDropoutSeed(ctx) : 0;
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    FusedDropoutResidualLayerNormForward<
+        T><<<rows, kRowBlockDim, 0, dev_ctx.stream()>>>(
+        x->data<T>(), residual->data<T>(), scale ? scale->data<T>() : nullptr,
+        bias ? bias->data<T>() : nullptr, seed, dropout,
+        ctx.Attr<float>("epsilon"), cols, mask_data,
+        z->mutable_data<T>(ctx.GetPlace()), y->mutable_data<T>(ctx.GetPlace()),
+        mean->mutable_data<T>(ctx.GetPlace()),
+        var->mutable_data<T>(ctx.GetPlace()));
+  }
+};
+
+template <typename T>
+class FusedDropoutResidualLayerNormGradCUDAKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* z = ctx.Input<Tensor>("DropoutResidualOut");
+    auto* mean = ctx.Input<Tensor>("Mean");
+    auto* var = ctx.Input<Tensor>("Variance");
+    auto* scale = ctx.Input<Tensor>("Scale");
+    auto* d_y = ctx.Input<Tensor>(framework::GradVarName("Y"));
+    auto* d_x = ctx.Output<Tensor>(framework::GradVarName("X"));
+    auto* d_residual = ctx.Output<Tensor>(framework::GradVarName("Residual"));
+    auto* d_scale = ctx.Output<Tensor>(framework::GradVarName("Scale"));
+    auto* d_bias = ctx.Output<Tensor>(framework::GradVarName("Bias"));
+    auto dropout = GetResidualDropout(ctx);
+    float epsilon = ctx.Attr<float>("epsilon");
+
+    auto matrix_dim =
+        framework::flatten_to_2d(z->dims(), ctx.Attr<int>("begin_norm_axis"));
+    int64_t rows = matrix_dim[0];
+    int64_t cols = matrix_dim[1];
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto stream = dev_ctx.stream();
+
+    if ((d_x || d_residual) && rows > 0) {
+      const uint8_t* mask_data =
+          dropout.HasMask() ? ctx.Input<Tensor>("DropoutMask")->data<uint8_t>()
+                            : nullptr;
+      FusedDropoutResidualLayerNormGradInput<
+          T><<<rows, kRowBlockDim, 0, stream>>>(
+          z->data<T>(), mean->data<T>(), var->data<T>(),
+          scale ? scale->data<T>() : nullptr, d_y->data<T>(), mask_data,
+          dropout, epsilon, cols,
+          d_x ? d_x->mutable_data<T>(ctx.GetPlace()) : nullptr,
+          d_residual ? d_residual->mutable_data<T>(ctx.GetPlace()) : nullptr);
+    }
+    if (d_scale || d_bias) {
+      dim3 block(kColBlockDimX, kColBlockDimY);
+      int grid = (cols + kColBlockDimX - 1) / kColBlockDimX;
+      FusedDropoutResidualLayerNormGradParam<T><<<grid, block, 0, stream>>>(
+          z->data<T>(), mean->data<T>(), var->data<T>(), d_y->data<T>(),
+          epsilon, rows, cols,
+          d_scale ? d_scale->mutable_data<T>(ctx.GetPlace()) : nullptr,
+          d_bias ? d_bias->mutable_data<T>(ctx.GetPlace()) : nullptr);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_dropout_residual_layer_norm,
+                        ops::FusedDropoutResidualLayerNormCUDAKernel<float>,
+                        ops::FusedDropoutResidualLayerNormCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(
+    fused_dropout_residual_layer_norm_grad,
+    ops::FusedDropoutResidualLayerNormGradCUDAKernel<float>,
+    ops::FusedDropoutResidualLayerNormGradCUDAKernel<double>);
@@ -0,0 +1,264 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// The dropout mask keeps a bit for each element, and each row of the mask
+// starts at a new byte, so that a byte of the mask belongs to a single row.
+constexpr int kDropoutMaskBits = 8;
+
+HOSTDEVICE inline int64_t DropoutMaskBytes(int64_t cols) {
+  return (cols + kDropoutMaskBits - 1) / kDropoutMaskBits;
+}
+
+HOSTDEVICE inline bool DropoutMaskKept(const uint8_t* mask_row, int64_t col) {
+  return (mask_row[col / kDropoutMaskBits] >> (col % kDropoutMaskBits)) & 1;
+}
+
+// The dropout of X before it is added to Residual.
+struct ResidualDropout {
+  float prob;
+  bool is_test;
+  bool upscale_in_train;
+
+  // Whether the mask is generated, otherwise every element is kept.
+  HOSTDEVICE inline bool HasMask() const { return !is_test && prob > 0.0f; }
+
+  // The factor of the kept elements.
+  HOSTDEVICE inline float Factor() const {
+    if (is_test) {
+      return upscale_in_train ? 1.0f : 1.0f - prob;
+    }
+    if (!upscale_in_train) {
+      return 1.0f;
+    }
+    return prob < 1.0f ? 1.0f / (1.0f - prob) : 0.0f;
+  }
+};
+
+inline ResidualDropout GetResidualDropout(
+    const framework::ExecutionContext& ctx) {
+  ResidualDropout dropout;
+  dropout.prob = ctx.Attr<float>("dropout_prob");
+  dropout.is_test = ctx.Attr<bool>("is_test");
+  dropout.upscale_in_train =
+      ctx.Attr<std::string>("dropout_implementation") == "upscale_in_train";
+  return dropout;
+}
+
+inline int GetResidualDropoutSeed(const framework::ExecutionContext& ctx) {
+  // NOTE: fixed seed should only be used in unittest or for debug.
+  // Guarantee to use random seed in training.
+  if (ctx.Attr<bool>("fix_seed")) {
+    return ctx.Attr<int>("seed");
+  }
+  std::random_device rnd;
+  return static_cast<int>(rnd());
+}
+
+/*
+ * Z = Residual + dropout(X)
+ * Y = layer_norm(Z) * Scale + Bias
+ *
+ * Z is saved to Output(DropoutResidualOut) as the input of the layer_norm,
+ * and the dropout mask to Output(DropoutMask) by bits, for the backward.
+ */
+template <typename DeviceContext, typename T>
+class FusedDropoutResidualLayerNormKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* residual = ctx.Input<Tensor>("Residual");
+    auto* scale = ctx.Input<Tensor>("Scale");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* y = ctx.Output<Tensor>("Y");
+    auto* z = ctx.Output<Tensor>("DropoutResidualOut");
+    auto* mean = ctx.Output<Tensor>("Mean");
+    auto* var = ctx.Output<Tensor>("Variance");
+    auto epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto dropout = GetResidualDropout(ctx);
+
+    auto matrix_dim =
+        framework::flatten_to_2d(x->dims(), ctx.Attr<int>("begin_norm_axis"));
+    int64_t rows = matrix_dim[0];
+    int64_t cols = matrix_dim[1];
+    int64_t bytes = DropoutMaskBytes(cols);
+
+    const T* x_data = x->data<T>();
+    const T* residual_data = residual->data<T>();
+    const T* scale_data = scale ? scale->data<T>() : nullptr;
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    T* y_data = y->mutable_data<T>(ctx.GetPlace());
+    T* z_data = z->mutable_data<T>(ctx.GetPlace());
+    T* mean_data = mean->mutable_data<T>(ctx.GetPlace());
+    T* var_data = var->mutable_data<T>(ctx.GetPlace());
+    auto* mask = ctx.Output<Tensor>("DropoutMask");
+    uint8_t* mask_data = nullptr;
+    if (!dropout.is_test && mask) {
+      mask_data = mask->mutable_data<uint8_t>(ctx.GetPlace());
+      std::memset(mask_data, 0, rows * bytes);
+    }
+
+    std::minstd_rand engine;
+    if (dropout.HasMask()) {
+      engine.seed(GetResidualDropoutSeed(ctx));
+    }
+    std::uniform_real_distribution<float> dist(0, 1);
+    T factor = static_cast<T>(dropout.Factor());
+    for (int64_t i = 0; i < rows; ++i) {
+      const T* x_row = x_data + i * cols;
+      const T* residual_row = residual_data + i * cols;
+      T* z_row = z_data + i * cols;
+      uint8_t* mask_row = mask_data ? mask_data + i * bytes : nullptr;
+      T sum = 0;
+      for (int64_t j = 0; j < cols; ++j) {
+        bool kept = true;
+        if (dropout.HasMask()) {
+          kept = dist(engine) >= dropout.prob && dropout.prob < 1.0f;
+        }
+        if (mask_row) {
+          mask_row[j / kDropoutMaskBits] |= static_cast<uint8_t>(kept)
+                                            << (j % kDropoutMaskBits);
+        }
+        z_row[j] = residual_row[j] + (kept ? factor * x_row[j] : 0);
+        sum += z_row[j];
+      }
+      T row_mean = sum / cols;
+      T square_sum = 0;
+      for (int64_t j = 0; j < cols; ++j) {
+        square_sum += (z_row[j] - row_mean) * (z_row[j] - row_mean);
+      }
+      T row_var = square_sum / cols;
+      mean_data[i] = row_mean;
+      var_data[i] = row_var;
+
+      T inv_std = 1 / std::sqrt(row_var + epsilon);
+      T* y_row = y_data + i * cols;
+      for (int64_t j = 0; j < cols; ++j) {
+        T out = (z_row[j] - row_mean) * inv_std;
+        if (scale_data) {
+          out *= scale_data[j];
+        }
+        if (bias_data) {
+          out += bias_data[j];
+        }
+        y_row[j] = out;
+      }
+    }
+  }
+};
+
+/*
+ * With Z_hat the normalized Z, and dZ_hat = dY * Scale:
+ *   dZ = (dZ_hat - mean(dZ_hat) - Z_hat * mean(dZ_hat * Z_hat)) / std
+ *   dResidual = dZ, dX = dZ * mask * factor
+ *   dScale = colsum(dY * Z_hat), dBias = colsum(dY)
+ */
+template <typename DeviceContext, typename T>
+class FusedDropoutResidualLayerNormGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* z = ctx.Input<Tensor>("DropoutResidualOut");
+    auto* mean = ctx.Input<Tensor>("Mean");
+    auto* var = ctx.Input<Tensor>("Variance");
+    auto* scale = ctx.Input<Tensor>("Scale");
+    auto* d_y = ctx.Input<Tensor>(framework::GradVarName("Y"));
+    auto* d_x = ctx.Output<Tensor>(framework::GradVarName("X"));
+    auto* d_residual = ctx.Output<Tensor>(framework::GradVarName("Residual"));
+    auto* d_scale = ctx.Output<Tensor>(framework::GradVarName("Scale"));
+    auto* d_bias = ctx.Output<Tensor>(framework::GradVarName("Bias"));
+    auto epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto dropout = GetResidualDropout(ctx);
+
+    auto matrix_dim =
+        framework::flatten_to_2d(z->dims(), ctx.Attr<int>("begin_norm_axis"));
+    int64_t rows = matrix_dim[0];
+    int64_t cols = matrix_dim[1];
+    int64_t bytes = DropoutMaskBytes(cols);
+
+    const T* z_data = z->data<T>();
+    const T* mean_data = mean->data<T>();
+    const T* var_data = var->data<T>();
+    const T* scale_data = scale ? scale->data<T>() : nullptr;
+    const T* d_y_data = d_y->data<T>();
+    const uint8_t* mask_data =
+        dropout.HasMask() ? ctx.Input<Tensor>("DropoutMask")->data<uint8_t>()
+                          : nullptr;
+    T* d_x_data = d_x ? d_x->mutable_data<T>(ctx.GetPlace()) : nullptr;
+    T* d_residual_data =
+        d_residual ? d_residual->mutable_data<T>(ctx.GetPlace()) : nullptr;
+    auto get_param_grad = [&](Tensor* grad) -> T* {
+      if (grad == nullptr) return nullptr;
+      T* data = grad->mutable_data<T>(ctx.GetPlace());
+      std::fill(data, data + cols, static_cast<T>(0));
+      return data;
+    };
+    T* d_scale_data = get_param_grad(d_scale);
+    T* d_bias_data = get_param_grad(d_bias);
+
+    T factor = static_cast<T>(dropout.Factor());
+    for (int64_t i = 0; i < rows; ++i) {
+      const T* z_row = z_data + i * cols;
+      const T* d_y_row = d_y_data + i * cols;
+      T row_mean = mean_data[i];
+      T inv_std = 1 / std::sqrt(var_data[i] + epsilon);
+      T d_norm_sum = 0;
+      T d_norm_dot = 0;
+      for (int64_t j = 0; j < cols; ++j) {
+        T z_norm = (z_row[j] - row_mean) * inv_std;
+        T d_norm = scale_data ? d_y_row[j] * scale_data[j] : d_y_row[j];
+        d_norm_sum += d_norm;
+        d_norm_dot += d_norm * z_norm;
+        if (d_scale_data) {
+          d_scale_data[j] += d_y_row[j] * z_norm;
+        }
+        if (d_bias_data) {
+          d_bias_data[j] += d_y_row[j];
+        }
+      }
+      if (!d_x_data && !d_residual_data) continue;
+      T d_norm_mean = d_norm_sum / cols;
+      T d_norm_dot_mean = d_norm_dot / cols;
+      const uint8_t* mask_row = mask_data ? mask_data + i * bytes : nullptr;
+      for (int64_t j = 0; j < cols; ++j) {
+        T z_norm = (z_row[j] - row_mean) * inv_std;
+        T d_norm = scale_data ? d_y_row[j] * scale_data[j] : d_y_row[j];
+        T d_z = (d_norm - d_norm_mean - z_norm * d_norm_dot_mean) * inv_std;
+        if (d_residual_data) {
+          d_residual_data[i * cols + j] = d_z;
+        }
+        if (d_x_data) {
+          bool kept = mask_row == nullptr || DropoutMaskKept(mask_row, j);
+          d_x_data[i * cols + j] = kept ? d_z * factor : 0;
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,206 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_embedding_seqpool_cvm_concat_op.h"
+#include <memory>
+#include "paddle/fluid/framework/var_type_inference.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedEmbeddingSeqPoolCVMConcatOp
+    : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_GE(ctx->Inputs("Ids").size(), 1UL,
+                      platform::errors::InvalidArgument(
+                          "Inputs(Ids) of FusedEmbeddingSeqPoolCVMConcatOp "
+                          "should not be empty."));
+    PADDLE_ENFORCE_GE(ctx->Inputs("W").size(), 1UL,
+                      platform::errors::InvalidArgument(
+                          "Inputs(W) of FusedEmbeddingSeqPoolCVMConcatOp "
+                          "should not be empty."));
+    PADDLE_ENFORCE_EQ(ctx->HasInput("CVM"), true,
+                      platform::errors::InvalidArgument(
+                          "Input(CVM) of FusedEmbeddingSeqPoolCVMConcatOp "
+                          "should not be null."));
+    PADDLE_ENFORCE_EQ(ctx->HasOutput("Out"), true,
+                      platform::errors::InvalidArgument(
+                          "Output(Out) of FusedEmbeddingSeqPoolCVMConcatOp "
+                          "should not be null."));
+
+    size_t slot_num = ctx->Inputs("Ids").size();
+    auto tables_dims = ctx->GetInputsDim("W");
+    PADDLE_ENFORCE_EQ(
+        tables_dims.size() == 1UL || tables_dims.size() == slot_num, true,
+        platform::errors::InvalidArgument(
+            "The number of Input(W) should be 1 or the number of Input(Ids) "
+            "%d, but got %d.",
+            slot_num, tables_dims.size()));
+    for (auto& dims : tables_dims) {
+      PADDLE_ENFORCE_EQ(dims.size(), 2,
+                        platform::errors::InvalidArgument(
+                            "The dims size of Input(W) should be 2."));
+      PADDLE_ENFORCE_EQ(dims[1], tables_dims[0][1],
+                        platform::errors::InvalidArgument(
+                            "The width of all Input(W) should be equal."));
+    }
+    bool use_cvm = ctx->Attrs().Get<bool>("use_cvm");
+    PADDLE_ENFORCE_GT(tables_dims[0][1], 2,
+                      platform::errors::InvalidArgument(
+                          "The width of Input(W) should be greater than 2 "
+                          "for show and click, but got %d.",
+                          tables_dims[0][1]));
+
+    // The output height should be confirmed in Compute,
+    // since input lod is not accessible here.
+    int64_t slot_width =
+        EmbeddingSeqPoolCVMWidth(tables_dims[0][1], use_cvm);
+    ctx->SetOutputDim(
+        "Out", framework::make_ddim(
+                   {-1, slot_width * static_cast<int64_t>(slot_num)}));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = OperatorWithKernel::IndicateVarDataType(ctx, "W");
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class FusedEmbeddingSeqPoolCVMConcatOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Ids",
+             "(LoDTensor) The ids of each slot with type int64, whose LoD "
+             "level is 1 and last dimension size is 1.")
+        .AsDuplicable();
+    AddInput("W",
+             "(Tensor) The embedding table shared by all the slots, or one "
+             "table for each slot, which is a learnable parameter.")
+        .AsDuplicable();
+    AddInput("CVM",
+             "(Tensor), a 2-D Tensor with shape [N x 2], where N is the batch "
+             "size, 2 is show and click.");
+    AddOutput("Out",
+              "(LoDTensor) The pooled embeddings of all the slots after cvm, "
+              "concatenated along axis 1.");
+    AddAttr<std::string>("pooltype",
+                         "(string, default 'SUM') the pooltype of "
+                         "SequencePoolOp.")
+        .SetDefault("SUM")
+        .InEnum({"AVERAGE", "SUM", "SQRT"});
+    AddAttr<bool>("use_cvm",
+                  "(bool, default true) use cvm or drop show and click.")
+        .SetDefault(true);
+    AddAttr<int64_t>("padding_idx",
+                     "(int64, default -1) "
+                     "If the value is -1, it makes no effect to lookup. "
+                     "Otherwise the given value indicates padding the "
+                     "embedding with zeros whenever lookup encounters it in "
+                     "Ids.")
+        .SetDefault(kNoPadding);
+    AddAttr<bool>(framework::kAllKernelsMustComputeRuntimeShape,
+                  "Skip calling InferShape() function in the runtime.")
+        .SetDefault(true);
+    AddComment(R"DOC(
+FusedEmbeddingSeqPoolCVMConcat Operator.
+
+Fusion of lookup_table, sequence_pool, cvm and concat of all the slots.
+
+For each slot, the embeddings of the ids of each sequence are gathered and
+pooled in one pass, then the cvm is applied and the result is written into
+the concatenated output directly.
+
+The gradient of W is a SelectedRows, whose rows are the ids of all the slots
+using the table.
+
+)DOC");
+  }
+};
+
+class FusedEmbeddingSeqPoolCVMConcatOpGrad
+    : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    ctx->SetOutputsDim(framework::GradVarName("W"), ctx->GetInputsDim("W"));
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = OperatorWithKernel::IndicateVarDataType(ctx, "W");
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class FusedEmbeddingSeqPoolCVMConcatOpGradVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(framework::InferVarTypeContext* ctx) const override {
+    auto data_type = ctx->GetDataType(ctx->Input("W")[0]);
+    for (auto& out_var_name : ctx->Output(framework::GradVarName("W"))) {
+      VLOG(3) << "fused_embedding_seqpool_cvm_concat_grad op "
+              << out_var_name << " is set to SelectedRows";
+      ctx->SetType(out_var_name, framework::proto::VarType::SELECTED_ROWS);
+      ctx->SetDataType(out_var_name, data_type);
+    }
+  }
+};
+
+template <typename T>
+class FusedEmbeddingSeqPoolCVMConcatGradOpMaker
+    : public framework::SingleGradOpMaker<T> {
+ public:
+  using framework::SingleGradOpMaker<T>::SingleGradOpMaker;
+
+ protected:
+  void Apply(GradOpPtr<T> op) const override {
+    op->SetType("fused_embedding_seqpool_cvm_concat_grad");
+    op->SetInput("Ids", this->Input("Ids"));
+    op->SetInput("W", this->Input("W"));
+    op->SetInput("CVM", this->Input("CVM"));
+    op->SetInput(framework::GradVarName("Out"), this->OutputGrad("Out"));
+    op->SetOutput(framework::GradVarName("W"), this->InputGrad("W"));
+    op->SetAttrMap(this->Attrs());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(
+    fused_embedding_seqpool_cvm_concat, ops::FusedEmbeddingSeqPoolCVMConcatOp,
+    ops::FusedEmbeddingSeqPoolCVMConcatGradOpMaker<paddle::framework::OpDesc>,
+    ops::FusedEmbeddingSeqPoolCVMConcatGradOpMaker<
+        paddle::imperative::OpBase>,
+    ops::FusedEmbeddingSeqPoolCVMConcatOpMaker);
+REGISTER_OPERATOR(fused_embedding_seqpool_cvm_concat_grad,
+                  ops::FusedEmbeddingSeqPoolCVMConcatOpGrad,
+                  ops::FusedEmbeddingSeqPoolCVMConcatOpGradVarTypeInference);
+
+REGISTER_OP_CPU_KERNEL(fused_embedding_seqpool_cvm_concat,
+                       ops::FusedEmbeddingSeqPoolCVMConcatKernel<float>,
+                       ops::FusedEmbeddingSeqPoolCVMConcatKernel<double>);
+REGISTER_OP_CPU_KERNEL(fused_embedding_seqpool_cvm_concat_grad,
+                       ops::FusedEmbeddingSeqPoolCVMConcatGradKernel<float>,
+                       ops::FusedEmbeddingSeqPoolCVMConcatGradKernel<double>);
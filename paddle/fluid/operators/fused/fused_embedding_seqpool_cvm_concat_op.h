@@ -0,0 +1,214 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/operators/fused/fused_embedding_seq_pool_op.h"
+
+namespace paddle {
+namespace operators {
+
+// The width of the output of each slot, which drops show and click if the
+// cvm is not used.
+inline int64_t EmbeddingSeqPoolCVMWidth(int64_t emb_width, bool use_cvm) {
+  return use_cvm ? emb_width : emb_width - 2;
+}
+
+template <typename T>
+T EmbeddingSeqPoolScale(const std::string &pooltype, int64_t h) {
+  if (h == 0 || pooltype == "SUM") return static_cast<T>(1);
+  if (pooltype == "AVERAGE") return static_cast<T>(1) / h;
+  return static_cast<T>(1) / std::sqrt(static_cast<T>(h));
+}
+
+template <typename T>
+class FusedEmbeddingSeqPoolCVMConcatKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto ids = context.MultiInput<LoDTensor>("Ids");
+    auto tables = context.MultiInput<LoDTensor>("W");
+    auto *output_t = context.Output<LoDTensor>("Out");
+    const auto &pooltype = context.Attr<std::string>("pooltype");
+    bool use_cvm = context.Attr<bool>("use_cvm");
+    int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+
+    size_t slot_num = ids.size();
+    PADDLE_ENFORCE_EQ(tables.size() == 1UL || tables.size() == slot_num, true,
+                      platform::errors::InvalidArgument(
+                          "The number of Input(W) should be 1 or the number "
+                          "of Input(Ids) %d, but got %d.",
+                          slot_num, tables.size()));
+    PADDLE_ENFORCE_EQ(ids[0]->lod().size(), 1UL,
+                      platform::errors::InvalidArgument(
+                          "The LoD level of Input(Ids) should be 1."));
+    int64_t emb_width = tables[0]->dims()[1];
+    int64_t slot_width = EmbeddingSeqPoolCVMWidth(emb_width, use_cvm);
+    int64_t out_width = slot_width * slot_num;
+    size_t batch_size = ids[0]->lod()[0].size() - 1;
+
+    output_t->Resize({static_cast<int64_t>(batch_size), out_width});
+    framework::LoD out_lod(1);
+    out_lod[0].resize(batch_size + 1);
+    for (size_t i = 0; i <= batch_size; ++i) {
+      out_lod[0][i] = i;
+    }
+    output_t->set_lod(out_lod);
+    T *output = output_t->mutable_data<T>(context.GetPlace());
+
+    auto vadd =
+        jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+            emb_width);
+    auto vscal =
+        jit::KernelFuncs<jit::VScalTuple<T>, platform::CPUPlace>::Cache().At(
+            emb_width);
+    std::vector<T> pooled(emb_width);
+    for (size_t s = 0; s < slot_num; ++s) {
+      const auto *table_t = tables[tables.size() == 1UL ? 0 : s];
+      const T *table = table_t->data<T>();
+      int64_t table_height = table_t->dims()[0];
+      PADDLE_ENFORCE_EQ(table_t->dims()[1], emb_width,
+                        platform::errors::InvalidArgument(
+                            "The width of all Input(W) should be equal."));
+      const auto &lod = ids[s]->lod()[0];
+      PADDLE_ENFORCE_EQ(lod.size(), batch_size + 1,
+                        platform::errors::InvalidArgument(
+                            "The batch size of all Input(Ids) should be "
+                            "equal."));
+      PADDLE_ENFORCE_EQ(ids[s]->numel(), static_cast<int64_t>(lod.back()),
+                        platform::errors::InvalidArgument(
+                            "The last dimension of Input(Ids) should be 1."));
+      const int64_t *id_data = ids[s]->data<int64_t>();
+      for (int64_t i = 0; i < ids[s]->numel(); ++i) {
+        if (padding_idx != kNoPadding && id_data[i] == padding_idx) continue;
+        PADDLE_ENFORCE_EQ(
+            id_data[i] >= 0 && id_data[i] < table_height, true,
+            platform::errors::InvalidArgument(
+                "The id of Input(Ids) %d expected >= 0 and < %ld, but "
+                "got %ld.",
+                s, table_height, id_data[i]));
+      }
+
+      for (size_t i = 0; i < batch_size; ++i) {
+        T *dst = use_cvm ? output + i * out_width + s * slot_width
+                         : pooled.data();
+        // gather and pool the rows of the sequence in one pass
+        std::memset(dst, 0, emb_width * sizeof(T));
+        for (size_t j = lod[i]; j < lod[i + 1]; ++j) {
+          if (id_data[j] == padding_idx) continue;
+          vadd(table + id_data[j] * emb_width, dst, dst, emb_width);
+        }
+        T scale = EmbeddingSeqPoolScale<T>(pooltype, lod[i + 1] - lod[i]);
+        if (scale != static_cast<T>(1)) {
+          vscal(&scale, dst, dst, emb_width);
+        }
+        if (use_cvm) {
+          dst[0] = std::log(dst[0] + 1);
+          dst[1] = std::log(dst[1] + 1) - dst[0];
+        } else {
+          std::memcpy(output + i * out_width + s * slot_width, dst + 2,
+                      slot_width * sizeof(T));
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+class FusedEmbeddingSeqPoolCVMConcatGradKernel
+    : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto ids = context.MultiInput<LoDTensor>("Ids");
+    auto tables = context.MultiInput<LoDTensor>("W");
+    auto *cvm = context.Input<Tensor>("CVM");
+    auto *d_output =
+        context.Input<LoDTensor>(framework::GradVarName("Out"));
+    auto d_tables =
+        context.MultiOutput<SelectedRows>(framework::GradVarName("W"));
+    const auto &pooltype = context.Attr<std::string>("pooltype");
+    bool use_cvm = context.Attr<bool>("use_cvm");
+    int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+
+    size_t slot_num = ids.size();
+    int64_t emb_width = tables[0]->dims()[1];
+    int64_t slot_width = EmbeddingSeqPoolCVMWidth(emb_width, use_cvm);
+    int64_t out_width = slot_width * slot_num;
+    size_t batch_size = ids[0]->lod()[0].size() - 1;
+    PADDLE_ENFORCE_EQ(
+        cvm->dims()[0], static_cast<int64_t>(batch_size),
+        platform::errors::InvalidArgument(
+            "The height of Input(CVM) should be the batch size %d, but got "
+            "%d.",
+            batch_size, cvm->dims()[0]));
+
+    // The rows of a shared table are the ids of all the slots in order, and
+    // row_offsets is where the rows of each slot begin.
+    std::vector<int64_t> row_offsets(slot_num);
+    for (size_t t = 0; t < d_tables.size(); ++t) {
+      std::vector<int64_t> rows;
+      for (size_t s = t; s < slot_num; s += d_tables.size()) {
+        row_offsets[s] = rows.size();
+        const int64_t *id_data = ids[s]->data<int64_t>();
+        rows.insert(rows.end(), id_data, id_data + ids[s]->numel());
+      }
+      d_tables[t]->set_height(tables[t]->dims()[0]);
+      d_tables[t]->set_rows(rows);
+      d_tables[t]->mutable_value()->mutable_data<T>(
+          framework::make_ddim(
+              {static_cast<int64_t>(rows.size()), emb_width}),
+          context.GetPlace());
+    }
+
+    const T *cvm_data = cvm->data<T>();
+    const T *d_output_data = d_output->data<T>();
+    std::vector<T> pooled_grad(emb_width);
+    for (size_t s = 0; s < slot_num; ++s) {
+      const auto &lod = ids[s]->lod()[0];
+      const int64_t *id_data = ids[s]->data<int64_t>();
+      T *d_table = d_tables[s % d_tables.size()]->mutable_value()->data<T>() +
+                   row_offsets[s] * emb_width;
+      for (size_t i = 0; i < batch_size; ++i) {
+        // the grad of the pooled embedding, whose show and click are the
+        // cvm of the instance
+        const T *dy = d_output_data + i * out_width + s * slot_width;
+        if (use_cvm) {
+          std::memcpy(pooled_grad.data(), dy, emb_width * sizeof(T));
+        } else {
+          std::memcpy(pooled_grad.data() + 2, dy, slot_width * sizeof(T));
+        }
+        pooled_grad[0] = cvm_data[i * 2];
+        pooled_grad[1] = cvm_data[i * 2 + 1];
+        T scale = EmbeddingSeqPoolScale<T>(pooltype, lod[i + 1] - lod[i]);
+        for (int64_t k = 0; k < emb_width; ++k) {
+          pooled_grad[k] *= scale;
+        }
+        for (size_t j = lod[i]; j < lod[i + 1]; ++j) {
+          T *dst = d_table + j * emb_width;
+          if (id_data[j] == padding_idx) {
+            std::memset(dst, 0, emb_width * sizeof(T));
+          } else {
+            std::memcpy(dst, pooled_grad.data(), emb_width * sizeof(T));
+          }
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
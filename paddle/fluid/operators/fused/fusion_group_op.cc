@@ -35,27 +35,59 @@ class FusionGroupOp : public framework::OperatorWithKernel {
             "Expected the number of outputs >= 1. Recived %d.", num_outs));
 
     int type = ctx->Attrs().Get<int>("type");
-    PADDLE_ENFORCE_EQ(type, 0UL,
+    PADDLE_ENFORCE_EQ(type == 0 || type == 1, true,
                       platform::errors::InvalidArgument(
-                          "Only support fusion of elementwise operations."));
+                          "Only support fusion of elementwise operations, "
+                          "and the ones followed by a reduction."));
 
+    // The inputs with smaller ranks are broadcast to the one with the
+    // largest rank along the trailing dims.
     std::vector<framework::DDim> x_dims = ctx->GetInputsDim("Inputs");
-    if (type == 0) {
-      for (size_t i = 1; i < num_ins; ++i) {
-        PADDLE_ENFORCE_EQ(x_dims[0], x_dims[i],
-                          platform::errors::InvalidArgument(
-                              "All the inputs' dims should be the same."));
+    size_t full_index = 0;
+    for (size_t i = 1; i < num_ins; ++i) {
+      if (x_dims[i].size() > x_dims[full_index].size()) {
+        full_index = i;
       }
-      std::vector<framework::DDim> out_dims;
-      for (size_t j = 0; j < num_outs; ++j) {
-        out_dims.push_back(x_dims[0]);
+    }
+    const framework::DDim& full_dims = x_dims[full_index];
+    for (size_t i = 0; i < num_ins; ++i) {
+      int offset = full_dims.size() - x_dims[i].size();
+      PADDLE_ENFORCE_EQ(
+          framework::slice_ddim(full_dims, offset, full_dims.size()),
+          x_dims[i],
+          platform::errors::InvalidArgument(
+              "All the inputs' dims should be the same, or the trailing "
+              "dims of Inputs[%d] whose dims are [%s], but received [%s].",
+              full_index, full_dims, x_dims[i]));
+    }
+
+    std::vector<framework::DDim> out_dims(num_outs, full_dims);
+    if (type == 1) {
+      int reduce_out_index = ctx->Attrs().Get<int>("reduce_out_index");
+      int reduce_num_dims = ctx->Attrs().Get<int>("reduce_num_dims");
+      PADDLE_ENFORCE_EQ(
+          reduce_out_index >= 0 &&
+              reduce_out_index < static_cast<int>(num_outs),
+          true, platform::errors::InvalidArgument(
+                    "Expected 0 <= reduce_out_index < %d. Received %d.",
+                    num_outs, reduce_out_index));
+      PADDLE_ENFORCE_EQ(
+          reduce_num_dims > 0 && reduce_num_dims < full_dims.size(), true,
+          platform::errors::InvalidArgument(
+              "Expected 0 < reduce_num_dims < %d. Received %d.",
+              full_dims.size(), reduce_num_dims));
+      std::vector<int64_t> reduce_dims = framework::vectorize(full_dims);
+      reduce_dims.resize(full_dims.size() - reduce_num_dims);
+      if (ctx->Attrs().Get<bool>("keep_dim")) {
+        reduce_dims.resize(full_dims.size(), 1);
       }
-      ctx->SetOutputsDim("Outs", out_dims);
+      out_dims[reduce_out_index] = framework::make_ddim(reduce_dims);
     }
+    ctx->SetOutputsDim("Outs", out_dims);
 
-    // Only lod of Inputs[0] would be shared with Outs.
+    // Only lod of the input with the largest rank would be shared with Outs.
     for (size_t j = 0; j < num_outs; ++j) {
-      ctx->ShareLoD("Inputs", /*->*/ "Outs", 0, j);
+      ctx->ShareLoD("Inputs", /*->*/ "Outs", full_index, j);
     }
   }
 
@@ -63,7 +95,7 @@ class FusionGroupOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(framework::proto::VarType::FP32,
-                                   platform::CUDAPlace(0));
+                                   ctx.GetPlace());
   };
 };
 
@@ -85,13 +117,28 @@ class FusionGroupOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<int>("type", "Fusion type.").SetDefault(0);
     AddAttr<std::string>("func_name", "Name of the generated functions.")
         .SetDefault("");
+    AddAttr<int>("reduce_out_index",
+                 "The index of the output holding the result of the "
+                 "reduction, only used when type is 1.")
+        .SetDefault(-1);
+    AddAttr<int>("reduce_num_dims",
+                 "The number of the trailing dims reduced, only used when "
+                 "type is 1.")
+        .SetDefault(0);
+    AddAttr<bool>("keep_dim",
+                  "Whether to retain the dims reduced with length 1, only "
+                  "used when type is 1.")
+        .SetDefault(false);
     AddComment(R"DOC(
 fusion_group Operator.
 
 It is used to execute a generated CUDA kernel which fuse the computation of
 multiple operators into one. It supports several types:
 0, fused computation of elementwise operations in which all the dims of inputs
-    and outputs should be exactly the same.
+    and outputs should be exactly the same, except the inputs broadcast along
+    the trailing dims, e.g. a bias.
+1, fused computation of elementwise operations followed by a reduction along
+    the trailing dims, whose output is Outs[reduce_out_index].
 )DOC");
   }
 };
@@ -101,3 +148,7 @@ multiple operators into one. It supports several types:
 
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(fusion_group, ops::FusionGroupOp, ops::FusionGroupOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fusion_group,
+    ops::FusionGroupKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusionGroupKernel<paddle::platform::CPUDeviceContext, double>);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
@@ -58,8 +59,12 @@ class FusionGroupKernel : public framework::OpKernel<T> {
         platform::DeviceCodePool::Instance().Get(place, func_name);
     VLOG(3) << "func_name: " << func_name;
 
-    if (type == 0) {
-      size_t n = ins[0]->numel();
+    if (type == 0 || type == 1) {
+      // The inputs broadcast have fewer elements.
+      size_t n = 0;
+      for (size_t i = 0; i < num_ins; ++i) {
+        n = std::max(n, static_cast<size_t>(ins[i]->numel()));
+      }
       std::vector<void*> args;
       args.push_back(&n);
       std::vector<const void*> ptrs(num_ins + num_outs);
@@ -15,6 +15,8 @@ limitations under the License. */
 #include "paddle/fluid/operators/fused/fusion_gru_op.h"
 #include <cstring>  // for memcpy
 #include <string>
+#include <vector>
+#include "paddle/fluid/operators/fused/fusion_rnn_fc.h"
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/fc.h"
@@ -154,6 +156,20 @@ void FusionGRUOpMaker::Make() {
                 "(bool, default: True) "
                 "whether to use seq mode to compute GRU.")
       .SetDefault(true);
+  AddAttr<bool>("use_quantizer",
+                "(bool, default false) "
+                "Set to true for operators that should be quantized and use "
+                "the int8 WeightX.")
+      .SetDefault(false);
+  AddAttr<float>("Scale_data",
+                 "(float, default 1.0f) The quantize scale of input data, "
+                 "used with the int8 WeightX.")
+      .SetDefault(1.0f);
+  AddAttr<std::vector<float>>("Scale_weights",
+                              "(std::vector<float>, default {1.0f}) The "
+                              "quantize scales of the columns of the int8 "
+                              "WeightX.")
+      .SetDefault({1.0f});
   AddComment(R"DOC(
 The Fusion complete GRU Operator.
 This operator fuse the fully-connected operator into GRU, 
@@ -205,7 +221,6 @@ class FusionGRUKernel : public framework::OpKernel<T> {
       jit::KernelFuncs<jit::GRUHtPart2Tuple<T>, platform::CPUPlace>::Cache() \
           .At(attr);                                                         \
   const T* x_data = x->data<T>();                                            \
-  const T* wx_data = wx->data<T>();                                          \
   const T* wh_data = wh->data<T>();                                          \
   auto place = ctx.GetPlace();                                               \
   T* xx_data = xx->mutable_data<T>(place)
@@ -220,10 +235,8 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     T* hidden_out_data = hidden_out->mutable_data<T>(place);
     auto blas = math::GetBlas<DeviceContext, T>(ctx);
 
-    auto& dev_ctx = ctx.template device_context<DeviceContext>();
-    math::FCFunctor<DeviceContext, T> fc;
-    fc(dev_ctx, total_T, D3, M, x_data, wx_data, xx_data,
-       bias ? bias->data<T>() : nullptr);
+    FusionRNNFC(ctx, total_T, D3, M, x_data, *wx, xx_data,
+                bias ? bias->data<T>() : nullptr);
 
     int xx_offset = D3;
     int gate_offset = D;
@@ -293,16 +306,15 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
 
-    math::FCFunctor<DeviceContext, T> fc;
     if (M > D3) {
-      fc(dev_ctx, total_T, D3, M, x_data, wx_data, xx_data,
-         bias ? bias->data<T>() : nullptr);
+      FusionRNNFC(ctx, total_T, D3, M, x_data, *wx, xx_data,
+                  bias ? bias->data<T>() : nullptr);
       to_batch(dev_ctx, *xx, batched_input, true, is_reverse);
     } else {
       to_batch(dev_ctx, *x, xx, true, is_reverse);
       batched_input->set_lod(xx->lod());
-      fc(dev_ctx, total_T, D3, M, xx_data, wx_data, batched_input_data,
-         bias ? bias->data<T>() : nullptr);
+      FusionRNNFC(ctx, total_T, D3, M, xx_data, *wx, batched_input_data,
+                  bias ? bias->data<T>() : nullptr);
     }
 
     auto batched_lod = batched_input->lod();
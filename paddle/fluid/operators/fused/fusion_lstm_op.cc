@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/fused/fusion_lstm_op.h"
 #include <string>
+#include <vector>
+#include "paddle/fluid/operators/fused/fusion_rnn_fc.h"
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/fc.h"
@@ -190,6 +192,20 @@ void FusionLSTMOpMaker::Make() {
                 "(bool, default: True) "
                 "whether to use seq mode to compute.")
       .SetDefault(true);
+  AddAttr<bool>("use_quantizer",
+                "(bool, default false) "
+                "Set to true for operators that should be quantized and use "
+                "the int8 WeightX.")
+      .SetDefault(false);
+  AddAttr<float>("Scale_data",
+                 "(float, default 1.0f) The quantize scale of input data, "
+                 "used with the int8 WeightX.")
+      .SetDefault(1.0f);
+  AddAttr<std::vector<float>>("Scale_weights",
+                              "(std::vector<float>, default {1.0f}) The "
+                              "quantize scales of the columns of the int8 "
+                              "WeightX.")
+      .SetDefault({1.0f});
   AddAttr<std::string>("gate_activation",
                        "(string, default: sigmoid)"
                        "The activation for input gate, forget gate and output "
@@ -237,7 +253,6 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
 
 #define INIT_OTHER_DEFINES                                                     \
   const T* x_data = x->data<T>();                                              \
-  const T* wx_data = wx->data<T>();                                            \
   const T* wh_data = wh->data<T>();                                            \
   /* diagonal weight*/                                                         \
   const T* wp_data = bias->data<T>() + D4;                                     \
@@ -282,9 +297,7 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     T* c_out_data = cell_out->mutable_data<T>(place);
     auto blas = math::GetBlas<DeviceContext, T>(ctx);
 
-    auto& dev_ctx = ctx.template device_context<DeviceContext>();
-    math::FCFunctor<DeviceContext, T> fc;
-    fc(dev_ctx, total_T, D4, M, x_data, wx_data, xx_data, bias->data<T>());
+    FusionRNNFC(ctx, total_T, D4, M, x_data, *wx, xx_data, bias->data<T>());
 
     int xx_offset = D4;
     int gate_offset = D;
@@ -361,15 +374,15 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
-    math::FCFunctor<DeviceContext, T> fc;
     if (M > D4) {
-      fc(dev_ctx, x_dims[0], D4, M, x_data, wx_data, xx_data, bias->data<T>());
+      FusionRNNFC(ctx, x_dims[0], D4, M, x_data, *wx, xx_data,
+                  bias->data<T>());
       to_batch(dev_ctx, *xx, batched_input, true, is_reverse);
     } else {
       to_batch(dev_ctx, *x, xx, true, is_reverse);
       batched_input->set_lod(xx->lod());
-      fc(dev_ctx, x_dims[0], D4, M, xx_data, wx_data, batched_input_data,
-         bias->data<T>());
+      FusionRNNFC(ctx, x_dims[0], D4, M, xx_data, *wx, batched_input_data,
+                  bias->data<T>());
     }
 
     auto batched_lod = batched_input->lod();
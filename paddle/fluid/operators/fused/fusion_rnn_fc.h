@@ -0,0 +1,60 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <type_traits>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/fc.h"
+
+namespace paddle {
+namespace operators {
+
+/*
+ * Compute Y = X * WeightX + B of the fusion_gru and fusion_lstm ops, where X
+ * is M x K and WeightX is K x N. The WeightX is int8 after the op is
+ * quantized by cpu_quantize_pass, with the attrs Scale_data of X and
+ * Scale_weights of the columns of WeightX.
+ */
+template <typename T>
+void FusionRNNFC(const framework::ExecutionContext& ctx, const int M,
+                 const int N, const int K, const T* X,
+                 const framework::Tensor& weight_x, T* Y,
+                 const T* B = nullptr) {
+  using DeviceContext = platform::CPUDeviceContext;
+  auto& dev_ctx = ctx.template device_context<DeviceContext>();
+  if (weight_x.type() == framework::proto::VarType::INT8) {
+    PADDLE_ENFORCE_EQ(std::is_same<T, float>::value, true,
+                      platform::errors::Unimplemented(
+                          "The int8 WeightX of %s only supports the float "
+                          "input.",
+                          ctx.Type()));
+    auto w_scales = ctx.Attr<std::vector<float>>("Scale_weights");
+    PADDLE_ENFORCE_EQ(w_scales.size(), static_cast<size_t>(N),
+                      platform::errors::InvalidArgument(
+                          "The size of Scale_weights of %s should be %d, but "
+                          "got %d.",
+                          ctx.Type(), N, w_scales.size()));
+    math::QuantizedFCFunctor<DeviceContext> fc;
+    fc(dev_ctx, M, N, K, reinterpret_cast<const float*>(X),
+       ctx.Attr<float>("Scale_data"), weight_x.data<int8_t>(), w_scales.data(),
+       reinterpret_cast<float*>(Y), reinterpret_cast<const float*>(B));
+  } else {
+    math::FCFunctor<DeviceContext, T> fc;
+    fc(dev_ctx, M, N, K, X, weight_x.data<T>(), Y, B);
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
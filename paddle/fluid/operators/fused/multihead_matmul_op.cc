@@ -37,10 +37,6 @@ class MultiHeadMatMulV2Op : public framework::OperatorWithKernel {
         context->HasInput("Bias"), true,
         platform::errors::InvalidArgument(
             "Input(Bias) of MultiHeadMatMul should not be null."));
-    PADDLE_ENFORCE_EQ(
-        context->HasInput("BiasQK"), true,
-        platform::errors::InvalidArgument(
-            "Input(BiasQK) of MultiHeadMatMul should not be null."));
     PADDLE_ENFORCE_EQ(
         context->HasOutput("Out"), true,
         platform::errors::InvalidArgument(
@@ -62,13 +58,22 @@ class MultiHeadMatMulV2Op : public framework::OperatorWithKernel {
             "%d-D tensor now.",
             dim_bias_q.size()));
 
-    auto dim_bias_qk = context->GetInputDim("BiasQK");
-    PADDLE_ENFORCE_GT(
-        dim_bias_qk.size(), 3,
-        platform::errors::InvalidArgument(
-            "Multihead input bias qk should be at least 4-D tensor, "
-            "but it's %d-D tensor now.",
-            dim_bias_qk.size()));
+    // The 2-D input is the packed sequences of LoDTensor, which needs no
+    // mask of the padding.
+    auto dim_input = context->GetInputDim("Input");
+    if (dim_input.size() != 2) {
+      PADDLE_ENFORCE_EQ(
+          context->HasInput("BiasQK"), true,
+          platform::errors::InvalidArgument(
+              "Input(BiasQK) of MultiHeadMatMul should not be null."));
+      auto dim_bias_qk = context->GetInputDim("BiasQK");
+      PADDLE_ENFORCE_GT(
+          dim_bias_qk.size(), 3,
+          platform::errors::InvalidArgument(
+              "Multihead input bias qk should be at least 4-D tensor, "
+              "but it's %d-D tensor now.",
+              dim_bias_qk.size()));
+    }
 
     int head_number = context->Attrs().Get<int>("head_number");
     PADDLE_ENFORCE_GT(
@@ -77,7 +82,6 @@ class MultiHeadMatMulV2Op : public framework::OperatorWithKernel {
             "Multihead input head number should be at least 1, but it %d now.",
             head_number));
     // modify this
-    auto dim_input = context->GetInputDim("Input");
     context->SetOutputDim("Out", dim_input);
     context->ShareLoD("Input", /*->*/ "Out");
   }
@@ -89,7 +93,10 @@ class MultiHeadMatMulV2OpMaker : public framework::OpProtoAndCheckerMaker {
     AddInput("Input", "The input of MultiHeadMatMul op");
     AddInput("W", "The weight input of MultiHeadMatMul op");
     AddInput("Bias", "The bias input of MultiHeadMatMul op");
-    AddInput("BiasQK", "The QK bias input of MultiHeadMatMul op");
+    AddInput("BiasQK",
+             "The QK bias input of MultiHeadMatMul op, which is not needed "
+             "by the 2-D Input of the packed sequences.")
+        .AsDispensable();
     AddOutput("Out", "The output of MultiHeadMatMul op");
     AddAttr<bool>("transpose_Q",
                   R"DOC(If true, use the transpose of `Q`.
@@ -115,6 +122,10 @@ Not suggest to use in other case except has same structure as ernie.
 Example of matrix multiplication with head_number of B
 - X: [B, M, K], Y: [B, K, N] => Out: [B, M, N]
 
+If Input is 2-D, it is the sequences of LoDTensor packed without padding,
+with shape [total_len, hidden], and the attention is computed within each
+sequence of the LoD.
+
 )DOC");
   }
 };
@@ -18,6 +18,7 @@
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/operators/fused/fused_attention_op.cu.h"
 #include "paddle/fluid/operators/math/bert_encoder_functor.h"
 #include "paddle/fluid/operators/math/blas.h"
 
@@ -140,6 +141,10 @@ class MultiHeadMatMulV2Kernel : public framework::OpKernel<T> {
   void Compute(const framework::ExecutionContext &context) const override {
     using Tensor = framework::Tensor;
     auto *input = context.Input<framework::Tensor>("Input");
+    if (input->dims().size() == 2) {
+      ComputeVarlen(context);
+      return;
+    }
     auto *w = context.Input<framework::Tensor>("W");
     auto *bias = context.Input<framework::Tensor>("Bias");
 
@@ -214,6 +219,86 @@ class MultiHeadMatMulV2Kernel : public framework::OpKernel<T> {
     transpose<T><<<grid, block, 0, stream>>>(tptr, output_d, batch, seq_len,
                                              head_number, head_size);
   }
+
+ private:
+  // Input: the packed sequences of LoDTensor [total_len, hidden], whose
+  // attention is computed within each sequence of the LoD by the kernel of
+  // fused_attention, so neither the padding nor BiasQK is needed.
+  void ComputeVarlen(const framework::ExecutionContext &context) const {
+    using Tensor = framework::Tensor;
+    auto *input = context.Input<framework::LoDTensor>("Input");
+    auto *w = context.Input<framework::Tensor>("W");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+    auto *out = context.Output<framework::Tensor>("Out");
+    PADDLE_ENFORCE_EQ(
+        input->lod().empty(), false,
+        platform::errors::InvalidArgument(
+            "The 2-D Input(Input) of MultiHeadMatMul should be the packed "
+            "sequences with the LoD."));
+    PADDLE_ENFORCE_EQ(
+        input->lod().back().back(), static_cast<size_t>(input->dims()[0]),
+        platform::errors::InvalidArgument(
+            "The last offset of the LoD of Input(Input) of MultiHeadMatMul "
+            "should be the total length %d, but got %d.",
+            input->dims()[0], input->lod().back().back()));
+
+    int head_number = context.Attr<int>("head_number");
+    float scale = context.Attr<float>("alpha");
+    auto &device_ctx = context.template device_context<DeviceContext>();
+    auto stream = device_ctx.stream();
+    int total_len = input->dims()[0];
+    int all_head_size = w->dims()[2];
+    int head_size = all_head_size / head_number;
+    // Each token is a batch of TransQKVWithBias, which is the grid.y.
+    PADDLE_ENFORCE_LE(total_len, 65535,
+                      platform::errors::Unimplemented(
+                          "The total length of the packed sequences of "
+                          "MultiHeadMatMul should be at most 65535, but got "
+                          "%d.",
+                          total_len));
+
+    // (T, hidden) * (hidden, 3 * N * H) -> (T, 3, N, H)
+    const Tensor w_matrix =
+        framework::ReshapeToMatrix(*w, 1 /*y_num_col_dims*/);
+    Tensor temp_out_tensor;
+    temp_out_tensor.Resize({total_len, 3 * all_head_size});
+    auto *temp_out_data = temp_out_tensor.mutable_data<T>(context.GetPlace());
+    auto blas = math::GetBlas<platform::CUDADeviceContext, T>(device_ctx);
+    blas.MatMul(*input, w_matrix, &temp_out_tensor);
+
+    // (T, 3, N, H) + bias -> (3, T, N, H), i.e. Q, K and V of the packed
+    // inputs of fused_attention.
+    Tensor qkv_tensor;
+    qkv_tensor.Resize({3, total_len, all_head_size});
+    auto *qkv_data = qkv_tensor.mutable_data<T>(context.GetPlace());
+    TransQKVWithBias(total_len, 1, head_size, head_number, temp_out_data,
+                     bias->data<T>(), qkv_data, stream);
+
+    auto &lod = input->lod().back();
+    AttentionDims dims;
+    dims.row_stride = head_number;
+    dims.batch = static_cast<int64_t>(lod.size() - 1) * head_number;
+    dims.seq_q = MaxSequenceLength(lod);
+    dims.seq_k = dims.seq_q;
+    dims.head_dim = head_size;
+    dims.value_dim = head_size;
+    dims.q_lod = lod.CUDAData(context.GetPlace());
+    dims.k_lod = dims.q_lod;
+    AttentionDropout dropout;
+    dropout.prob = 0.0f;
+    dropout.is_test = true;
+    dropout.upscale_in_train = true;
+    dropout.seed = 0;
+
+    Tensor lse;
+    lse.Resize({total_len, head_number});
+    int64_t qkv_size = static_cast<int64_t>(total_len) * all_head_size;
+    out->Resize({total_len, all_head_size});
+    FusedAttentionForwardCUDA<T, T>(
+        device_ctx, qkv_data, qkv_data + qkv_size, qkv_data + 2 * qkv_size,
+        nullptr, out->mutable_data<T>(context.GetPlace()),
+        lse.mutable_data<T>(context.GetPlace()), dims, scale, dropout);
+  }
 };
 
 }  // namespace operators
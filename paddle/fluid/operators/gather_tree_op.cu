@@ -66,8 +66,8 @@ class GatherTreeOpCUDAKernel : public framework::OpKernel<T> {
         std::min(static_cast<int64_t>(dev_ctx.GetMaxPhysicalThreadCount()),
                  batch_size * beam_size);
     const int grid = std::max(max_threads / block, 1);
-    GatherTree<<<grid, block>>>(ids_data, parents_data, out_data, max_length,
-                                batch_size, beam_size);
+    GatherTree<<<grid, block, 0, dev_ctx.stream()>>>(
+        ids_data, parents_data, out_data, max_length, batch_size, beam_size);
   }
 };
 
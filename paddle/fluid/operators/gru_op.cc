@@ -257,12 +257,8 @@ class GRUCPUKernel : public framework::OpKernel<T> {
     bool is_reverse = context.Attr<bool>("is_reverse");
     math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
     auto& dev_ctx = context.template device_context<DeviceContext>();
-    to_batch(dev_ctx, *input, batch_gate, true, is_reverse);
-
-    if (bias) {
-      math::RowwiseAdd<DeviceContext, T> add_bias;
-      add_bias(dev_ctx, *batch_gate, *bias, batch_gate);
-    }
+    // the bias is added while reordering the input into the batch
+    to_batch(dev_ctx, *input, batch_gate, true, is_reverse, bias);
 
     int frame_size = hidden_dims[1];
     math::GRUMetaValue<T> gru_value;
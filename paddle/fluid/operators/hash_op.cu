@@ -0,0 +1,156 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "paddle/fluid/operators/hash_op.h"
+#include "paddle/fluid/platform/gpu_launch_param_config.h"
+
+namespace paddle {
+namespace operators {
+
+constexpr uint64_t kXXH64Prime1 = 11400714785074694791ULL;
+constexpr uint64_t kXXH64Prime2 = 14029467366897019727ULL;
+constexpr uint64_t kXXH64Prime3 = 1609587929392839161ULL;
+constexpr uint64_t kXXH64Prime4 = 9650029242287828579ULL;
+constexpr uint64_t kXXH64Prime5 = 2870177450012600261ULL;
+
+__device__ __forceinline__ uint64_t XXH64Rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+__device__ __forceinline__ uint64_t XXH64Round(uint64_t acc, uint64_t input) {
+  acc += input * kXXH64Prime2;
+  acc = XXH64Rotl(acc, 31);
+  return acc * kXXH64Prime1;
+}
+
+__device__ __forceinline__ uint64_t XXH64MergeRound(uint64_t acc,
+                                                    uint64_t val) {
+  acc ^= XXH64Round(0, val);
+  return acc * kXXH64Prime1 + kXXH64Prime4;
+}
+
+// The inputs of hash are the rows of int32 or int64, which are aligned to 4
+// bytes, so that the 8 bytes lanes are read as two 4 bytes words.
+__device__ __forceinline__ uint64_t XXH64Read64(const uint32_t* p) {
+  return static_cast<uint64_t>(p[0]) | (static_cast<uint64_t>(p[1]) << 32);
+}
+
+// The same as XXH64 of xxHash on the little endian devices, of the inputs
+// whose length is a multiple of 4 bytes.
+__device__ uint64_t XXH64Device(const uint32_t* input, size_t len,
+                                uint64_t seed) {
+  const uint32_t* p = input;
+  const uint32_t* end = input + len / 4;
+  uint64_t h64;
+  if (len >= 32) {
+    const uint32_t* limit = end - 8;
+    uint64_t v1 = seed + kXXH64Prime1 + kXXH64Prime2;
+    uint64_t v2 = seed + kXXH64Prime2;
+    uint64_t v3 = seed + 0;
+    uint64_t v4 = seed - kXXH64Prime1;
+    do {
+      v1 = XXH64Round(v1, XXH64Read64(p));
+      v2 = XXH64Round(v2, XXH64Read64(p + 2));
+      v3 = XXH64Round(v3, XXH64Read64(p + 4));
+      v4 = XXH64Round(v4, XXH64Read64(p + 6));
+      p += 8;
+    } while (p <= limit);
+    h64 = XXH64Rotl(v1, 1) + XXH64Rotl(v2, 7) + XXH64Rotl(v3, 12) +
+          XXH64Rotl(v4, 18);
+    h64 = XXH64MergeRound(h64, v1);
+    h64 = XXH64MergeRound(h64, v2);
+    h64 = XXH64MergeRound(h64, v3);
+    h64 = XXH64MergeRound(h64, v4);
+  } else {
+    h64 = seed + kXXH64Prime5;
+  }
+  h64 += static_cast<uint64_t>(len);
+
+  while (p + 2 <= end) {
+    h64 ^= XXH64Round(0, XXH64Read64(p));
+    h64 = XXH64Rotl(h64, 27) * kXXH64Prime1 + kXXH64Prime4;
+    p += 2;
+  }
+  if (p < end) {
+    h64 ^= static_cast<uint64_t>(*p) * kXXH64Prime1;
+    h64 = XXH64Rotl(h64, 23) * kXXH64Prime2 + kXXH64Prime3;
+  }
+
+  h64 ^= h64 >> 33;
+  h64 *= kXXH64Prime2;
+  h64 ^= h64 >> 29;
+  h64 *= kXXH64Prime3;
+  h64 ^= h64 >> 32;
+  return h64;
+}
+
+// Each thread hashes a row by one seed.
+template <typename T>
+__global__ void KeHash(const T* input, T* output, int64_t seq_length,
+                       int64_t last_dim, int num_hash, int64_t mod_by) {
+  int64_t num = seq_length * num_hash;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < num;
+       i += blockDim.x * gridDim.x) {
+    int64_t idx = i / num_hash;
+    int ihash = static_cast<int>(i % num_hash);
+    const uint32_t* row =
+        reinterpret_cast<const uint32_t*>(input + idx * last_dim);
+    output[i] = static_cast<T>(
+        XXH64Device(row, sizeof(T) * last_dim, static_cast<uint64_t>(ihash)) %
+        static_cast<uint64_t>(mod_by));
+  }
+}
+
+template <typename T>
+class HashCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* out_t = context.Output<framework::LoDTensor>("Out");
+    auto* in_t = context.Input<framework::LoDTensor>("X");
+    int64_t mod_by = context.Attr<int64_t>("mod_by");
+    int num_hash = context.Attr<int>("num_hash");
+
+    auto in_dims = in_t->dims();
+
+    std::vector<int64_t> out_dims;
+    HashOutputSize(in_dims, out_dims, num_hash);
+    out_t->Resize(framework::make_ddim(out_dims));
+    auto* output = out_t->mutable_data<T>(context.GetPlace());
+
+    int64_t seq_length = in_dims[0];
+    int64_t last_dim = in_dims[in_dims.size() - 1];
+    int64_t num = seq_length * num_hash;
+    if (num > 0) {
+      auto& dev_ctx = context.cuda_device_context();
+      auto config = platform::GetGpuLaunchConfig1D(
+          dev_ctx, static_cast<int>(std::min<int64_t>(
+                       num, std::numeric_limits<int>::max())));
+      KeHash<T><<<config.block_per_grid.x, config.thread_per_block.x, 0,
+                  dev_ctx.stream()>>>(in_t->data<T>(), output, seq_length,
+                                      last_dim, num_hash, mod_by);
+    }
+
+    out_t->set_lod(in_t->lod());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(hash, ops::HashCUDAKernel<int>,
+                        ops::HashCUDAKernel<int64_t>);
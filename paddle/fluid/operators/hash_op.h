@@ -53,15 +53,18 @@ class HashKernel : public framework::OpKernel<T> {
     out_t->Resize(framework::make_ddim(out_dims));
     auto* output = out_t->mutable_data<T>(context.GetPlace());
 
-    auto seq_length = in_dims[0];
+    int64_t seq_length = in_dims[0];
     auto last_dim = in_dims[in_dims.size() - 1];
     auto* input = in_t->data<T>();
-    for (int idx = 0; idx < seq_length; ++idx) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t idx = 0; idx < seq_length; ++idx) {
+      const T* row = input + idx * last_dim;
       for (int ihash = 0; ihash != num_hash; ++ihash) {
         output[idx * num_hash + ihash] =
-            XXH64(input, sizeof(T) * last_dim, ihash) % mod_by;
+            XXH64(row, sizeof(T) * last_dim, ihash) % mod_by;
       }
-      input += last_dim;
     }
 
     out_t->set_lod(in_t->lod());
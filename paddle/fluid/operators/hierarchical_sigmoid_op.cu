@@ -0,0 +1,373 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cub/cub.cuh>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/hierarchical_sigmoid_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+using platform::PADDLE_CUDA_NUM_THREADS;
+
+#define CUDA_KERNEL_LOOP(i, n)                                     \
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+// The threads of a block that reduce the dot product of a node, and the
+// threads of a block that update the rows of a node.
+constexpr int kHSigmoidBlockDim = 128;
+// The maximum number of blocks of a launch, each of which loops over the
+// nodes.
+constexpr int kHSigmoidMaxGridDim = 4096;
+
+static inline int HSigmoidGridDim(int64_t n) {
+  return static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>(n, static_cast<int64_t>(kHSigmoidMaxGridDim))));
+}
+
+// The path codes of a batch laid out like PreOut. index(i, j) is the row of
+// the weight of the j-th node on the path of the sample i, or -1 after the end
+// of the path, and bit(i, j) is its binary code.
+struct PathCodes {
+  std::vector<int64_t> index;
+  std::vector<int64_t> bit;
+};
+
+template <typename CodeTable>
+static void EncodePaths(const CodeTable& code_table, int64_t batch_size,
+                        int64_t code_length, PathCodes* codes) {
+  codes->index.assign(batch_size * code_length, -1);
+  codes->bit.assign(batch_size * code_length, 0);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    auto code = code_table.get_code(i);
+    int length = code.get_length();
+    for (int j = 0; j < length; ++j) {
+      codes->index[i * code_length + j] = code.calc_index(j);
+      codes->bit[i * code_length + j] = code.calc_bit(j) ? 1 : 0;
+    }
+  }
+}
+
+// The path codes are computed on the host by the code tables of
+// matrix_bit_code.h, on host copies of Label, PathTable and PathCode.
+static void GetPathCodes(const framework::ExecutionContext& ctx,
+                         const platform::CUDADeviceContext& dev_ctx,
+                         int64_t batch_size, int64_t code_length,
+                         framework::LoDTensor* host_path, PathCodes* codes) {
+  auto* path = ctx.Input<framework::LoDTensor>("PathTable");
+  auto* code = ctx.Input<framework::LoDTensor>("PathCode");
+  std::vector<int64_t> label;
+  framework::TensorToVector(
+      detail::Ref(ctx.Input<framework::LoDTensor>("Label")), dev_ctx, &label);
+  dev_ctx.Wait();
+  if (path) {
+    framework::LoDTensor host_code;
+    framework::TensorCopySync(*path, platform::CPUPlace(), host_path);
+    framework::TensorCopySync(*code, platform::CPUPlace(), &host_code);
+    EncodePaths(math::CustomCodeTable<int64_t>(*host_path, host_code,
+                                               label.data()),
+                batch_size, code_length, codes);
+  } else {
+    size_t num_classes = static_cast<size_t>(ctx.Attr<int>("num_classes"));
+    EncodePaths(math::SimpleCodeTable(num_classes, label.data()), batch_size,
+                code_length, codes);
+  }
+}
+
+// pre_out(i, j) = clip(bias(index(i, j)) + x.row(i) * w.row(index(i, j)))
+// on the path, and 0 after its end, one block per node.
+template <typename T, int BlockDim>
+__global__ void HSigmoidPreOutKernel(const T* x, const T* w, const T* bias,
+                                     const int64_t* index, int64_t num_nodes,
+                                     int64_t code_length, int64_t dim,
+                                     T* pre_out) {
+  typedef cub::BlockReduce<T, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  for (int64_t e = blockIdx.x; e < num_nodes; e += gridDim.x) {
+    int64_t row = index[e];
+    if (row < 0) {
+      if (threadIdx.x == 0) {
+        pre_out[e] = static_cast<T>(0);
+      }
+      continue;
+    }
+    const T* x_row = x + (e / code_length) * dim;
+    const T* w_row = w + row * dim;
+    T sum = static_cast<T>(0);
+    for (int64_t k = threadIdx.x; k < dim; k += BlockDim) {
+      sum += x_row[k] * w_row[k];
+    }
+    sum = BlockReduce(temp_storage).Sum(sum);
+    if (threadIdx.x == 0) {
+      T o = sum + (bias == nullptr ? static_cast<T>(0) : bias[row]);
+      o = o < static_cast<T>(-40.0) ? static_cast<T>(-40.0) : o;
+      o = o > static_cast<T>(40.0) ? static_cast<T>(40.0) : o;
+      pre_out[e] = o;
+    }
+    // temp_storage is reused by the next node.
+    __syncthreads();
+  }
+}
+
+// out(i) = \sum_j softrelu(pre_out(i, j)) - \sum_j bit(i, j) * pre_out(i, j),
+// and pre_out keeps the softrelu for the gradient, as on the CPU.
+template <typename T>
+__global__ void HSigmoidOutKernel(const int64_t* bit, int64_t batch_size,
+                                  int64_t code_length, T* pre_out, T* out) {
+  CUDA_KERNEL_LOOP(i, batch_size) {
+    T sum = static_cast<T>(0);
+    for (int64_t j = 0; j < code_length; ++j) {
+      int64_t e = i * code_length + j;
+      T o = pre_out[e];
+      if (bit[e]) {
+        sum -= o;
+      }
+      o = log(static_cast<T>(1) + exp(o));
+      sum += o;
+      pre_out[e] = o;
+    }
+    out[i] = sum;
+  }
+}
+
+// pre_out_grad(i, j) = (sigmoid(pre_out(i, j)) - bit(i, j)) * out_grad(i),
+// where pre_out holds the softrelu of the forward.
+template <typename T>
+__global__ void HSigmoidPreOutGradKernel(const T* pre_out, const int64_t* bit,
+                                         const T* out_grad, int64_t num_nodes,
+                                         int64_t code_length,
+                                         T* pre_out_grad) {
+  CUDA_KERNEL_LOOP(e, num_nodes) {
+    T grad = static_cast<T>(1) - static_cast<T>(1) / exp(pre_out[e]);
+    pre_out_grad[e] = (grad - bit[e]) * out_grad[e / code_length];
+  }
+}
+
+template <typename T>
+__global__ void HSigmoidBiasGradKernel(const T* pre_out_grad,
+                                       const int64_t* index, int64_t num_nodes,
+                                       T* bias_grad) {
+  CUDA_KERNEL_LOOP(e, num_nodes) {
+    if (index[e] >= 0) {
+      platform::CudaAtomicAdd(bias_grad + index[e], pre_out_grad[e]);
+    }
+  }
+}
+
+// rows.row(index(i, j)) += pre_out_grad(i, j) * x.row(i), one block per node.
+// The nodes shared by the paths add to the same row.
+template <typename T, int BlockDim>
+__global__ void HSigmoidWeightGradKernel(const T* pre_out_grad, const T* x,
+                                         const int64_t* index,
+                                         int64_t num_nodes,
+                                         int64_t code_length, int64_t dim,
+                                         T* rows) {
+  for (int64_t e = blockIdx.x; e < num_nodes; e += gridDim.x) {
+    int64_t row = index[e];
+    if (row < 0) {
+      continue;
+    }
+    const T* x_row = x + (e / code_length) * dim;
+    T* w_row = rows + row * dim;
+    T grad = pre_out_grad[e];
+    for (int64_t k = threadIdx.x; k < dim; k += BlockDim) {
+      platform::CudaAtomicAdd(w_row + k, grad * x_row[k]);
+    }
+  }
+}
+
+// x_grad.row(i) = \sum_j pre_out_grad(i, j) * w.row(index(i, j)), one block
+// per sample.
+template <typename T, int BlockDim>
+__global__ void HSigmoidInputGradKernel(const T* pre_out_grad, const T* w,
+                                        const int64_t* index,
+                                        int64_t batch_size,
+                                        int64_t code_length, int64_t dim,
+                                        T* x_grad) {
+  for (int64_t i = blockIdx.x; i < batch_size; i += gridDim.x) {
+    for (int64_t k = threadIdx.x; k < dim; k += BlockDim) {
+      T sum = static_cast<T>(0);
+      for (int64_t j = 0; j < code_length; ++j) {
+        int64_t e = i * code_length + j;
+        if (index[e] >= 0) {
+          sum += pre_out_grad[e] * w[index[e] * dim + k];
+        }
+      }
+      x_grad[i * dim + k] = sum;
+    }
+  }
+}
+
+template <typename DeviceContext, typename T>
+class HierarchicalSigmoidCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto& in = detail::Ref(ctx.Input<framework::LoDTensor>("X"));
+    auto& w = detail::Ref(ctx.Input<framework::LoDTensor>("W"));
+    auto* path = ctx.Input<framework::LoDTensor>("PathTable");
+    auto* bias = ctx.Input<framework::LoDTensor>("Bias");
+    auto* out = ctx.Output<framework::LoDTensor>("Out");
+    auto* pre_out = ctx.Output<framework::LoDTensor>("PreOut");
+    size_t num_classes = static_cast<size_t>(ctx.Attr<int>("num_classes"));
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto stream = dev_ctx.stream();
+
+    int64_t code_length =
+        path ? path->dims()[1] : math::FindLastSet(num_classes - 1);
+    int64_t batch_size = in.dims()[0];
+    int64_t num_nodes = batch_size * code_length;
+
+    framework::LoDTensor host_path;
+    PathCodes codes;
+    GetPathCodes(ctx, dev_ctx, batch_size, code_length, &host_path, &codes);
+    framework::Tensor index, bit;
+    framework::TensorFromVector(codes.index, dev_ctx, &index);
+    framework::TensorFromVector(codes.bit, dev_ctx, &bit);
+
+    auto* pre_out_data = pre_out->mutable_data<T>(
+        framework::make_ddim({batch_size, code_length}), ctx.GetPlace());
+    HSigmoidPreOutKernel<T, kHSigmoidBlockDim><<<HSigmoidGridDim(num_nodes),
+                                                 kHSigmoidBlockDim, 0,
+                                                 stream>>>(
+        in.data<T>(), w.data<T>(), bias ? bias->data<T>() : nullptr,
+        index.data<int64_t>(), num_nodes, code_length, in.dims()[1],
+        pre_out_data);
+    HSigmoidOutKernel<T><<<(batch_size + PADDLE_CUDA_NUM_THREADS - 1) /
+                               PADDLE_CUDA_NUM_THREADS,
+                           PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
+        bit.data<int64_t>(), batch_size, code_length, pre_out_data,
+        out->mutable_data<T>(ctx.GetPlace()));
+    // codes is released on return.
+    dev_ctx.Wait();
+  }
+};
+
+template <typename DeviceContext, typename T>
+class HierarchicalSigmoidGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto& in = detail::Ref(ctx.Input<framework::LoDTensor>("X"));
+    auto& w = detail::Ref(ctx.Input<framework::LoDTensor>("W"));
+    auto* path = ctx.Input<framework::LoDTensor>("PathTable");
+    auto* in_grad =
+        ctx.Output<framework::LoDTensor>(framework::GradVarName("X"));
+    bool is_sparse = ctx.Attr<bool>("is_sparse");
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto stream = dev_ctx.stream();
+    math::SetConstant<DeviceContext, T> zero;
+    auto& pre_out = detail::Ref(ctx.Input<framework::LoDTensor>("PreOut"));
+    auto& out_grad = detail::Ref(
+        ctx.Input<framework::LoDTensor>(framework::GradVarName("Out")));
+
+    int64_t batch_size = pre_out.dims()[0];
+    int64_t code_length = pre_out.dims()[1];
+    int64_t num_nodes = pre_out.numel();
+    int64_t dim = in.dims()[1];
+    int loop_grid_dim =
+        (num_nodes + PADDLE_CUDA_NUM_THREADS - 1) / PADDLE_CUDA_NUM_THREADS;
+
+    framework::LoDTensor host_path;
+    PathCodes codes;
+    GetPathCodes(ctx, dev_ctx, batch_size, code_length, &host_path, &codes);
+    framework::Tensor index, bit;
+    framework::TensorFromVector(codes.index, dev_ctx, &index);
+    framework::TensorFromVector(codes.bit, dev_ctx, &bit);
+    const int64_t* index_data = index.data<int64_t>();
+
+    framework::LoDTensor pre_out_grad;
+    T* pre_out_grad_data =
+        pre_out_grad.mutable_data<T>(pre_out.dims(), ctx.GetPlace());
+    HSigmoidPreOutGradKernel<T><<<loop_grid_dim, PADDLE_CUDA_NUM_THREADS, 0,
+                                  stream>>>(
+        pre_out.data<T>(), bit.data<int64_t>(), out_grad.data<T>(), num_nodes,
+        code_length, pre_out_grad_data);
+
+    auto* bias_grad =
+        ctx.Output<framework::LoDTensor>(framework::GradVarName("Bias"));
+    if (bias_grad) {
+      T* bias_grad_data = bias_grad->mutable_data<T>(ctx.GetPlace());
+      zero(dev_ctx, bias_grad, static_cast<T>(0.0));
+      HSigmoidBiasGradKernel<T><<<loop_grid_dim, PADDLE_CUDA_NUM_THREADS, 0,
+                                  stream>>>(pre_out_grad_data, index_data,
+                                            num_nodes, bias_grad_data);
+    }
+
+    framework::Tensor rows_index;
+    if (!is_sparse) {
+      auto* w_grad =
+          ctx.Output<framework::LoDTensor>(framework::GradVarName("W"));
+      T* w_grad_data = w_grad->mutable_data<T>(ctx.GetPlace());
+      zero(dev_ctx, w_grad, static_cast<T>(0.0));
+      HSigmoidWeightGradKernel<T, kHSigmoidBlockDim><<<
+          HSigmoidGridDim(num_nodes), kHSigmoidBlockDim, 0, stream>>>(
+          pre_out_grad_data, in.data<T>(), index_data, num_nodes, code_length,
+          dim, w_grad_data);
+    } else {
+      PADDLE_ENFORCE(path != nullptr,
+                     "Sparse mode should not be used without custom tree!");
+      framework::Vector<int64_t> real_rows = PathToRows(host_path);
+      auto* w_grad =
+          ctx.Output<framework::SelectedRows>(framework::GradVarName("W"));
+      w_grad->set_rows(real_rows);
+      w_grad->set_height(w.dims()[0]);
+      auto* w_grad_value = w_grad->mutable_value();
+      framework::DDim temp_dim(w.dims());
+      temp_dim[0] = real_rows.size();
+      T* w_grad_data = w_grad_value->mutable_data<T>(temp_dim, ctx.GetPlace());
+      zero(dev_ctx, w_grad_value, static_cast<T>(0.0));
+
+      // The rows of the nodes in the SelectedRows gradient.
+      std::unordered_map<int64_t, int64_t> row_index;
+      for (size_t i = 0; i < real_rows.size(); ++i) {
+        row_index[real_rows[i]] = i;
+      }
+      for (auto& node : codes.index) {
+        if (node >= 0) {
+          node = row_index.at(node);
+        }
+      }
+      framework::TensorFromVector(codes.index, dev_ctx, &rows_index);
+      HSigmoidWeightGradKernel<T, kHSigmoidBlockDim><<<
+          HSigmoidGridDim(num_nodes), kHSigmoidBlockDim, 0, stream>>>(
+          pre_out_grad_data, in.data<T>(), rows_index.data<int64_t>(),
+          num_nodes, code_length, dim, w_grad_data);
+    }
+
+    HSigmoidInputGradKernel<T, kHSigmoidBlockDim><<<
+        HSigmoidGridDim(batch_size), kHSigmoidBlockDim, 0, stream>>>(
+        pre_out_grad_data, w.data<T>(), index_data, batch_size, code_length,
+        dim, in_grad->mutable_data<T>(ctx.GetPlace()));
+    // codes is released on return.
+    dev_ctx.Wait();
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+using GPUCtx = paddle::platform::CUDADeviceContext;
+REGISTER_OP_CUDA_KERNEL(
+    hierarchical_sigmoid,
+    ops::HierarchicalSigmoidCUDAKernel<GPUCtx, float>,
+    ops::HierarchicalSigmoidCUDAKernel<GPUCtx, double>);
+REGISTER_OP_CUDA_KERNEL(
+    hierarchical_sigmoid_grad,
+    ops::HierarchicalSigmoidGradCUDAKernel<GPUCtx, float>,
+    ops::HierarchicalSigmoidGradCUDAKernel<GPUCtx, double>);
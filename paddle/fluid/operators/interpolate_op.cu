@@ -10,7 +10,10 @@
    limitations under the License. */
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <vector>
 #include "paddle/fluid/operators/interpolate_op.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 #include "paddle/fluid/platform/gpu_launch_config.h"
@@ -21,250 +24,203 @@ namespace operators {
 using framework::Tensor;
 using DataLayout = framework::DataLayout;
 
+namespace detail {
+template <typename T, int VecSize>
+struct alignas(sizeof(T) * VecSize) AlignedVector {
+  T val[VecSize];
+};
+}  // namespace detail
+
+// The number of the channels interpolated by a thread of the NHWC kernels.
+template <typename T>
+constexpr int GetInterpVecSize() {
+  return sizeof(T) >= 16 ? 1 : static_cast<int>(16 / sizeof(T));
+}
+
+template <int VecSize, typename T>
+inline bool IsInterpVectorAligned(const T* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % (sizeof(T) * VecSize) == 0;
+}
+
+// Appends a table of 4-byte fields to the buffer copied to the device and
+// returns its offset, so that all the tables are copied at once.
 template <typename T>
+static size_t AppendInterpTable(const std::vector<T>& table,
+                                std::vector<int>* buffer) {
+  static_assert(sizeof(T) % sizeof(int) == 0,
+                "The interpolation tables only hold 4-byte fields.");
+  size_t offset = buffer->size();
+  buffer->resize(offset + table.size() * sizeof(T) / sizeof(int));
+  std::memcpy(buffer->data() + offset, table.data(), table.size() * sizeof(T));
+  return offset;
+}
+
+// The 2D kernels view the tensor as num_images images of num_channels
+// channels, see GetInterpImages, and every thread handles VecSize
+// contiguous channels of a pixel.
+template <typename T, int VecSize>
 __global__ void KeNearestNeighborInterpFw(
-    const T* in, const size_t in_img_h, const size_t in_img_w,
-    const size_t input_h, const size_t input_w, T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const float ratio_h, const float ratio_w,
-    const bool align_corners, const DataLayout data_layout) {
-  int nthreads = output_h * output_w;
+    const T* in, const int in_img_h, const int in_img_w, T* out,
+    const int out_img_h, const int out_img_w, const int num_images,
+    const int num_channels, const int* table_h, const int* table_w) {
+  using VecType = detail::AlignedVector<T, VecSize>;
+  int vec_channels = num_channels / VecSize;
+  int nthreads = num_images * out_img_h * out_img_w * vec_channels;
   int tid = blockIdx.x * blockDim.x + threadIdx.x;
   int stride = blockDim.x * gridDim.x;
   for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-
-    int channel_id, out_img_idy, out_img_idx;
-    if (data_layout == DataLayout::kNCHW) {
-      channel_id = out_id_w / out_img_size;
-      out_img_idy = (out_id_w % out_img_size) / out_img_w;
-      out_img_idx = tid % out_img_w;
-    } else {
-      out_img_idy = out_id_w / (out_img_w * num_channels);
-      out_img_idx = out_id_w % (out_img_w * num_channels) / num_channels;
-      channel_id = tid % num_channels;
-    }
-
-    int in_img_idy = (align_corners)
-                         ? static_cast<int>(ratio_h * out_img_idy + 0.5)
-                         : static_cast<int>(ratio_h * out_img_idy);
-    int in_img_idx = (align_corners)
-                         ? static_cast<int>(ratio_w * out_img_idx + 0.5)
-                         : static_cast<int>(ratio_w * out_img_idx);
-
-    if (data_layout == DataLayout::kNCHW) {
-      out[tid] = in[out_id_h * input_w + channel_id * in_img_size +
-                    in_img_idy * in_img_w + in_img_idx];
-    } else {
-      out[tid] = in[out_id_h * input_w + in_img_idy * in_img_w * num_channels +
-                    in_img_idx * num_channels + channel_id];
-    }
+    int channel_id = tid % vec_channels * VecSize;
+    int pixel_id = tid / vec_channels;
+    int out_img_idx = pixel_id % out_img_w;
+    int out_img_idy = pixel_id / out_img_w % out_img_h;
+    int image_id = pixel_id / (out_img_w * out_img_h);
+
+    const T* in_pos = &in[((image_id * in_img_h + table_h[out_img_idy]) *
+                               in_img_w +
+                           table_w[out_img_idx]) *
+                              num_channels +
+                          channel_id];
+    *reinterpret_cast<VecType*>(&out[pixel_id * num_channels + channel_id]) =
+        *reinterpret_cast<const VecType*>(in_pos);
   }
 }
 
-template <typename T>
+// Every thread sums the gradients of the output pixels reading its input
+// pixel, so that no atomic is needed.
+template <typename T, int VecSize>
 __global__ void KeNearestNeighborInterpBw(
-    T* in, const size_t in_img_h, const size_t in_img_w, const size_t input_h,
-    const size_t input_w, const T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const float ratio_h, const float ratio_w,
-    const bool align_corners, const DataLayout data_layout) {
-  int nthreads = output_h * output_w;
+    T* in, const int in_img_h, const int in_img_w, const T* out,
+    const int out_img_h, const int out_img_w, const int num_images,
+    const int num_channels, const InterpRange* ranges_h,
+    const InterpRange* ranges_w) {
+  using VecType = detail::AlignedVector<T, VecSize>;
+  int vec_channels = num_channels / VecSize;
+  int nthreads = num_images * in_img_h * in_img_w * vec_channels;
   int tid = blockIdx.x * blockDim.x + threadIdx.x;
   int stride = blockDim.x * gridDim.x;
   for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-
-    int channel_id, out_img_idy, out_img_idx;
-    if (data_layout == DataLayout::kNCHW) {
-      channel_id = out_id_w / out_img_size;
-      out_img_idy = (out_id_w % out_img_size) / out_img_w;
-      out_img_idx = tid % out_img_w;
-    } else {
-      out_img_idy = out_id_w / (out_img_w * num_channels);
-      out_img_idx = out_id_w % (out_img_w * num_channels) / num_channels;
-      channel_id = tid % num_channels;
+    int channel_id = tid % vec_channels * VecSize;
+    int pixel_id = tid / vec_channels;
+    int in_img_idx = pixel_id % in_img_w;
+    int in_img_idy = pixel_id / in_img_w % in_img_h;
+    int image_id = pixel_id / (in_img_w * in_img_h);
+    InterpRange range_h = ranges_h[in_img_idy];
+    InterpRange range_w = ranges_w[in_img_idx];
+
+    const T* out_img =
+        &out[image_id * out_img_h * out_img_w * num_channels + channel_id];
+    VecType grad;
+#pragma unroll
+    for (int i = 0; i < VecSize; i++) {
+      grad.val[i] = static_cast<T>(0);
     }
-
-    int in_img_idy = (align_corners)
-                         ? static_cast<int>(ratio_h * out_img_idy + 0.5)
-                         : static_cast<int>(ratio_h * out_img_idy);
-    int in_img_idx = (align_corners)
-                         ? static_cast<int>(ratio_w * out_img_idx + 0.5)
-                         : static_cast<int>(ratio_w * out_img_idx);
-
-    T* in_pos;
-    if (data_layout == DataLayout::kNCHW) {
-      in_pos = &in[out_id_h * input_w + channel_id * in_img_size +
-                   in_img_idy * in_img_w + in_img_idx];
-    } else {
-      in_pos = &in[out_id_h * input_w + in_img_idy * in_img_w * num_channels +
-                   in_img_idx * num_channels + channel_id];
+    for (int k = range_h.begin; k < range_h.end; k++) {
+      for (int l = range_w.begin; l < range_w.end; l++) {
+        VecType out_grad = *reinterpret_cast<const VecType*>(
+            &out_img[(k * out_img_w + l) * num_channels]);
+#pragma unroll
+        for (int i = 0; i < VecSize; i++) {
+          grad.val[i] += out_grad.val[i];
+        }
+      }
     }
-    const T out_pos = out[out_id_h * output_w + out_id_w];
-    platform::CudaAtomicAdd(in_pos, out_pos);
+    *reinterpret_cast<VecType*>(&in[pixel_id * num_channels + channel_id]) =
+        grad;
   }
 }
 
-template <typename T>
-__global__ void KeBilinearInterpFw(
-    const T* in, const size_t in_img_h, const size_t in_img_w,
-    const size_t input_h, const size_t input_w, T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const float ratio_h, const float ratio_w,
-    const bool align_corners, const int align_mode,
-    const DataLayout data_layout) {
-  int nthreads = output_h * output_w;
+template <typename T, int VecSize>
+__global__ void KeBilinearInterpFw(const T* in, const int in_img_h,
+                                   const int in_img_w, T* out,
+                                   const int out_img_h, const int out_img_w,
+                                   const int num_images, const int num_channels,
+                                   const LinearInterpCoeff* table_h,
+                                   const LinearInterpCoeff* table_w) {
+  using VecType = detail::AlignedVector<T, VecSize>;
+  int vec_channels = num_channels / VecSize;
+  int nthreads = num_images * out_img_h * out_img_w * vec_channels;
   int tid = blockIdx.x * blockDim.x + threadIdx.x;
   int stride = blockDim.x * gridDim.x;
-  bool align_flag = (align_mode == 0 && !align_corners);
   for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-
-    int channel_id, out_img_idy, out_img_idx;
-    if (data_layout == DataLayout::kNCHW) {
-      channel_id = out_id_w / out_img_size;
-      out_img_idy = (out_id_w % out_img_size) / out_img_w;
-      out_img_idx = tid % out_img_w;
-    } else {
-      out_img_idy = out_id_w / (out_img_w * num_channels);
-      out_img_idx = out_id_w % (out_img_w * num_channels) / num_channels;
-      channel_id = tid % num_channels;
-    }
-
-    int in_img_idy = align_flag
-                         ? static_cast<int>(ratio_h * (out_img_idy + 0.5) - 0.5)
-                         : static_cast<int>(ratio_h * out_img_idy);
-    in_img_idy = (in_img_idy > 0) ? in_img_idy : 0;
-    int h_id = (in_img_idy < in_img_h - 1) ? 1 : 0;
-    T src_h = ratio_h * (out_img_idy + 0.5) - 0.5;
-    src_h = (src_h > 0) ? src_h : 0;
-    T h1lambda =
-        align_flag ? src_h - in_img_idy : ratio_h * out_img_idy - in_img_idy;
-    T h2lambda = 1.f - h1lambda;
-
-    int in_img_idx = align_flag
-                         ? static_cast<int>(ratio_w * (out_img_idx + 0.5) - 0.5)
-                         : static_cast<int>(ratio_w * out_img_idx);
-    in_img_idx = (in_img_idx > 0) ? in_img_idx : 0;
-    int w_id = (in_img_idx < in_img_w - 1) ? 1 : 0;
-    T src_w = ratio_w * (out_img_idx + 0.5) - 0.5;
-    src_w = (src_w > 0) ? src_w : 0;
-    T w1lambda =
-        align_flag ? src_w - in_img_idx : ratio_w * out_img_idx - in_img_idx;
-    T w2lambda = 1.f - w1lambda;
-
-    if (data_layout == DataLayout::kNCHW) {
-      const T* in_pos = &in[out_id_h * input_w + channel_id * in_img_size +
-                            in_img_idy * in_img_w + in_img_idx];
-
-      // bilinear interpolation
-      out[out_id_h * output_w + out_id_w] =
-          h2lambda * (w2lambda * in_pos[0] + w1lambda * in_pos[w_id]) +
-          h1lambda * (w2lambda * in_pos[h_id * in_img_w] +
-                      w1lambda * in_pos[h_id * in_img_w + w_id]);
-    } else {
-      const T* in_pos =
-          &in[out_id_h * input_w + in_img_idy * in_img_w * num_channels +
-              in_img_idx * num_channels + channel_id];
-
-      // bilinear interpolation
-      out[out_id_h * output_w + out_id_w] =
-          h2lambda *
-              (w2lambda * in_pos[0] + w1lambda * in_pos[w_id * num_channels]) +
-          h1lambda * (w2lambda * in_pos[h_id * in_img_w * num_channels] +
-                      w1lambda * in_pos[h_id * in_img_w * num_channels +
-                                        w_id * num_channels]);
+    int channel_id = tid % vec_channels * VecSize;
+    int pixel_id = tid / vec_channels;
+    int out_img_idx = pixel_id % out_img_w;
+    int out_img_idy = pixel_id / out_img_w % out_img_h;
+    int image_id = pixel_id / (out_img_w * out_img_h);
+    LinearInterpCoeff coeff_h = table_h[out_img_idy];
+    LinearInterpCoeff coeff_w = table_w[out_img_idx];
+
+    const T* in_img =
+        &in[image_id * in_img_h * in_img_w * num_channels + channel_id];
+    const T* in_lo = &in_img[coeff_h.lo * in_img_w * num_channels];
+    const T* in_hi = &in_img[coeff_h.hi * in_img_w * num_channels];
+    int lo = coeff_w.lo * num_channels;
+    int hi = coeff_w.hi * num_channels;
+    VecType in_ll = *reinterpret_cast<const VecType*>(&in_lo[lo]);
+    VecType in_lh = *reinterpret_cast<const VecType*>(&in_lo[hi]);
+    VecType in_hl = *reinterpret_cast<const VecType*>(&in_hi[lo]);
+    VecType in_hh = *reinterpret_cast<const VecType*>(&in_hi[hi]);
+
+    // bilinear interpolation
+    VecType out_vec;
+#pragma unroll
+    for (int i = 0; i < VecSize; i++) {
+      out_vec.val[i] = static_cast<T>(
+          coeff_h.w_lo *
+              (coeff_w.w_lo * in_ll.val[i] + coeff_w.w_hi * in_lh.val[i]) +
+          coeff_h.w_hi *
+              (coeff_w.w_lo * in_hl.val[i] + coeff_w.w_hi * in_hh.val[i]));
     }
+    *reinterpret_cast<VecType*>(&out[pixel_id * num_channels + channel_id]) =
+        out_vec;
   }
 }
 
-template <typename T>
+// Every thread gathers the weighted gradients of the output pixels reading
+// its input pixel, so that no atomic is needed.
+template <typename T, int VecSize>
 __global__ void KeBilinearInterpBw(
-    T* in, const size_t in_img_h, const size_t in_img_w, const size_t input_h,
-    const size_t input_w, const T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const T ratio_h, const T ratio_w,
-    const bool align_corners, const int align_mode,
-    const DataLayout data_layout) {
-  int nthreads = output_h * output_w;
+    T* in, const int in_img_h, const int in_img_w, const T* out,
+    const int out_img_h, const int out_img_w, const int num_images,
+    const int num_channels, const LinearInterpCoeff* table_h,
+    const LinearInterpCoeff* table_w, const InterpRange* ranges_h,
+    const InterpRange* ranges_w) {
+  using VecType = detail::AlignedVector<T, VecSize>;
+  int vec_channels = num_channels / VecSize;
+  int nthreads = num_images * in_img_h * in_img_w * vec_channels;
   int tid = blockIdx.x * blockDim.x + threadIdx.x;
   int stride = blockDim.x * gridDim.x;
-  bool align_flag = (align_mode == 0 && !align_corners);
   for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-
-    int channel_id, out_img_idy, out_img_idx;
-    if (data_layout == DataLayout::kNCHW) {
-      channel_id = out_id_w / out_img_size;
-      out_img_idy = (out_id_w % out_img_size) / out_img_w;
-      out_img_idx = tid % out_img_w;
-    } else {
-      out_img_idy = out_id_w / (out_img_w * num_channels);
-      out_img_idx = out_id_w % (out_img_w * num_channels) / num_channels;
-      channel_id = tid % num_channels;
-    }
-
-    int in_img_idy = align_flag ? ratio_h * (out_img_idy + 0.5) - 0.5
-                                : ratio_h * out_img_idy;
-    in_img_idy = (in_img_idy > 0) ? in_img_idy : 0;
-    int h_id = (in_img_idy < in_img_h - 1) ? 1 : 0;
-    T src_h = ratio_h * (out_img_idy + 0.5) - 0.5;
-    src_h = (src_h > 0) ? src_h : 0;
-    T h1lambda =
-        align_flag ? src_h - in_img_idy : ratio_h * out_img_idy - in_img_idy;
-    T h2lambda = 1.f - h1lambda;
-
-    int in_img_idx = align_flag ? ratio_w * (out_img_idx + 0.5) - 0.5
-                                : ratio_w * out_img_idx;
-    in_img_idx = (in_img_idx > 0) ? in_img_idx : 0;
-    int w_id = (in_img_idx < in_img_w - 1) ? 1 : 0;
-    T src_w = ratio_w * (out_img_idx + 0.5) - 0.5;
-    src_w = (src_w > 0) ? src_w : 0;
-    T w1lambda =
-        align_flag ? src_w - in_img_idx : ratio_w * out_img_idx - in_img_idx;
-    T w2lambda = 1.f - w1lambda;
-
-    T* in_pos;
-    if (data_layout == DataLayout::kNCHW) {
-      in_pos = &in[out_id_h * input_w + channel_id * in_img_size +
-                   in_img_idy * in_img_w + in_img_idx];
-    } else {
-      in_pos = &in[out_id_h * input_w + in_img_idy * in_img_w * num_channels +
-                   in_img_idx * num_channels + channel_id];
+    int channel_id = tid % vec_channels * VecSize;
+    int pixel_id = tid / vec_channels;
+    int in_img_idx = pixel_id % in_img_w;
+    int in_img_idy = pixel_id / in_img_w % in_img_h;
+    int image_id = pixel_id / (in_img_w * in_img_h);
+    InterpRange range_h = ranges_h[in_img_idy];
+    InterpRange range_w = ranges_w[in_img_idx];
+
+    const T* out_img =
+        &out[image_id * out_img_h * out_img_w * num_channels + channel_id];
+    VecType grad;
+#pragma unroll
+    for (int i = 0; i < VecSize; i++) {
+      grad.val[i] = static_cast<T>(0);
     }
-
-    const T* out_pos = &out[out_id_h * output_w + out_id_w];
-
-    if (data_layout == DataLayout::kNCHW) {
-      platform::CudaAtomicAdd(&in_pos[0], h2lambda * w2lambda * out_pos[0]);
-      platform::CudaAtomicAdd(&in_pos[w_id], h2lambda * w1lambda * out_pos[0]);
-      platform::CudaAtomicAdd(&in_pos[h_id * in_img_w],
-                              h1lambda * w2lambda * out_pos[0]);
-      platform::CudaAtomicAdd(&in_pos[h_id * in_img_w + w_id],
-                              h1lambda * w1lambda * out_pos[0]);
-    } else {
-      platform::CudaAtomicAdd(&in_pos[0], h2lambda * w2lambda * out_pos[0]);
-      platform::CudaAtomicAdd(&in_pos[w_id * num_channels],
-                              h2lambda * w1lambda * out_pos[0]);
-      platform::CudaAtomicAdd(&in_pos[h_id * in_img_w * num_channels],
-                              h1lambda * w2lambda * out_pos[0]);
-      platform::CudaAtomicAdd(
-          &in_pos[h_id * in_img_w * num_channels + w_id * num_channels],
-          h1lambda * w1lambda * out_pos[0]);
+    for (int k = range_h.begin; k < range_h.end; k++) {
+      float h_lambda = LinearInterpWeight(table_h[k], in_img_idy);
+      for (int l = range_w.begin; l < range_w.end; l++) {
+        T lambda = static_cast<T>(
+            h_lambda * LinearInterpWeight(table_w[l], in_img_idx));
+        VecType out_grad = *reinterpret_cast<const VecType*>(
+            &out_img[(k * out_img_w + l) * num_channels]);
+#pragma unroll
+        for (int i = 0; i < VecSize; i++) {
+          grad.val[i] += lambda * out_grad.val[i];
+        }
+      }
     }
+    *reinterpret_cast<VecType*>(&in[pixel_id * num_channels + channel_id]) =
+        grad;
   }
 }
 
@@ -582,26 +538,60 @@ static void Interpolate2DCUDAFwd(const framework::ExecutionContext& ctx,
                               : static_cast<float>(in_w) / out_w;
   }
 
-  int in_hw = in_h * in_w;
-  int out_hw = out_h * out_w;
-  int in_chw = c * in_hw;
-  int out_chw = c * out_hw;
-
-  int pixelNum = n * out_chw;
+  int num_images, num_channels;
+  GetInterpImages(n, c, data_layout, &num_images, &num_channels);
+  constexpr int kVecSize = GetInterpVecSize<T>();
+  bool vectorized = num_channels % kVecSize == 0 &&
+                    IsInterpVectorAligned<kVecSize>(input_data) &&
+                    IsInterpVectorAligned<kVecSize>(output_data);
+  int pixelNum = n * c * out_h * out_w / (vectorized ? kVecSize : 1);
 
   platform::GpuLaunchConfig config =
       platform::getGpuLaunchConfig(pixelNum, ctx);
+  auto stream = ctx.cuda_device_context().stream();
 
+  std::vector<int> tables;
+  Tensor tables_tensor;
   if ("nearest" == interp_method) {
-    KeNearestNeighborInterpFw<T><<<config.blocks, config.threads, 0,
-                                   ctx.cuda_device_context().stream()>>>(
-        input_data, in_h, in_w, n, in_chw, output_data, out_h, out_w, n,
-        out_chw, c, ratio_h, ratio_w, align_corners, data_layout);
+    size_t offset_h = AppendInterpTable(
+        GetNearestInterpTable(ratio_h, out_h, align_corners), &tables);
+    size_t offset_w = AppendInterpTable(
+        GetNearestInterpTable(ratio_w, out_w, align_corners), &tables);
+    framework::TensorFromVector(tables, ctx.device_context(), &tables_tensor);
+    const int* table_h = tables_tensor.data<int>() + offset_h;
+    const int* table_w = tables_tensor.data<int>() + offset_w;
+    if (vectorized) {
+      KeNearestNeighborInterpFw<T, kVecSize><<<config.blocks, config.threads,
+                                               0, stream>>>(
+          input_data, in_h, in_w, output_data, out_h, out_w, num_images,
+          num_channels, table_h, table_w);
+    } else {
+      KeNearestNeighborInterpFw<T, 1><<<config.blocks, config.threads, 0,
+                                        stream>>>(
+          input_data, in_h, in_w, output_data, out_h, out_w, num_images,
+          num_channels, table_h, table_w);
+    }
   } else if ("bilinear" == interp_method) {
-    KeBilinearInterpFw<T><<<config.blocks, config.threads, 0,
-                            ctx.cuda_device_context().stream()>>>(
-        input_data, in_h, in_w, n, in_chw, output_data, out_h, out_w, n,
-        out_chw, c, ratio_h, ratio_w, align_corners, align_mode, data_layout);
+    bool align_flag = (align_mode == 0 && !align_corners);
+    size_t offset_h = AppendInterpTable(
+        GetLinearInterpTable(ratio_h, in_h, out_h, align_flag), &tables);
+    size_t offset_w = AppendInterpTable(
+        GetLinearInterpTable(ratio_w, in_w, out_w, align_flag), &tables);
+    framework::TensorFromVector(tables, ctx.device_context(), &tables_tensor);
+    auto* table_h = reinterpret_cast<const LinearInterpCoeff*>(
+        tables_tensor.data<int>() + offset_h);
+    auto* table_w = reinterpret_cast<const LinearInterpCoeff*>(
+        tables_tensor.data<int>() + offset_w);
+    if (vectorized) {
+      KeBilinearInterpFw<T, kVecSize><<<config.blocks, config.threads, 0,
+                                        stream>>>(
+          input_data, in_h, in_w, output_data, out_h, out_w, num_images,
+          num_channels, table_h, table_w);
+    } else {
+      KeBilinearInterpFw<T, 1><<<config.blocks, config.threads, 0, stream>>>(
+          input_data, in_h, in_w, output_data, out_h, out_w, num_images,
+          num_channels, table_h, table_w);
+    }
   }
 }
 
@@ -763,11 +753,9 @@ static void Interpolate2DCUDABwd(const framework::ExecutionContext& ctx,
   } else {
     dim_grad = {n, in_h, in_w, c};
   }
-  input_grad->mutable_data<T>(dim_grad, ctx.GetPlace());
+  // The gradient of every input pixel is gathered, which writes all the
+  // elements without filling zeros first.
   auto* input_grad_data = input_grad->mutable_data<T>(dim_grad, ctx.GetPlace());
-  auto& device_ctx = ctx.template device_context<platform::CUDADeviceContext>();
-  math::SetConstant<platform::CUDADeviceContext, T> zero;
-  zero(device_ctx, input_grad, static_cast<T>(0.0));
 
   if (in_h == out_h && in_w == out_w) {
     framework::TensorCopy(output_grad, ctx.GetPlace(), input_grad);
@@ -785,27 +773,74 @@ static void Interpolate2DCUDABwd(const framework::ExecutionContext& ctx,
                               : static_cast<float>(in_w) / out_w;
   }
 
-  int in_hw = in_h * in_w;
-  int out_hw = out_h * out_w;
-  int in_chw = c * in_hw;
-  int out_chw = c * out_hw;
-
-  int pixelNum = n * out_chw;
+  int num_images, num_channels;
+  GetInterpImages(n, c, data_layout, &num_images, &num_channels);
+  constexpr int kVecSize = GetInterpVecSize<T>();
+  bool vectorized = num_channels % kVecSize == 0 &&
+                    IsInterpVectorAligned<kVecSize>(input_grad_data) &&
+                    IsInterpVectorAligned<kVecSize>(output_grad_data);
+  int pixelNum = n * c * in_h * in_w / (vectorized ? kVecSize : 1);
 
   platform::GpuLaunchConfig config =
       platform::getGpuLaunchConfig(pixelNum, ctx);
+  auto stream = ctx.cuda_device_context().stream();
 
+  std::vector<int> tables;
+  Tensor tables_tensor;
   if ("nearest" == interp_method) {
-    KeNearestNeighborInterpBw<T><<<config.blocks, config.threads, 0,
-                                   ctx.cuda_device_context().stream()>>>(
-        input_grad_data, in_h, in_w, n, in_chw, output_grad_data, out_h, out_w,
-        n, out_chw, c, ratio_h, ratio_w, align_corners, data_layout);
+    size_t offset_h = AppendInterpTable(
+        GetNearestInterpRanges(
+            GetNearestInterpTable(ratio_h, out_h, align_corners), in_h),
+        &tables);
+    size_t offset_w = AppendInterpTable(
+        GetNearestInterpRanges(
+            GetNearestInterpTable(ratio_w, out_w, align_corners), in_w),
+        &tables);
+    framework::TensorFromVector(tables, ctx.device_context(), &tables_tensor);
+    auto* ranges_h = reinterpret_cast<const InterpRange*>(
+        tables_tensor.data<int>() + offset_h);
+    auto* ranges_w = reinterpret_cast<const InterpRange*>(
+        tables_tensor.data<int>() + offset_w);
+    if (vectorized) {
+      KeNearestNeighborInterpBw<T, kVecSize><<<config.blocks, config.threads,
+                                               0, stream>>>(
+          input_grad_data, in_h, in_w, output_grad_data, out_h, out_w,
+          num_images, num_channels, ranges_h, ranges_w);
+    } else {
+      KeNearestNeighborInterpBw<T, 1><<<config.blocks, config.threads, 0,
+                                        stream>>>(
+          input_grad_data, in_h, in_w, output_grad_data, out_h, out_w,
+          num_images, num_channels, ranges_h, ranges_w);
+    }
   } else if ("bilinear" == interp_method) {
-    KeBilinearInterpBw<T><<<config.blocks, config.threads, 0,
-                            ctx.cuda_device_context().stream()>>>(
-        input_grad_data, in_h, in_w, n, in_chw, output_grad_data, out_h, out_w,
-        n, out_chw, c, ratio_h, ratio_w, align_corners, align_mode,
-        data_layout);
+    bool align_flag = (align_mode == 0 && !align_corners);
+    auto coeffs_h = GetLinearInterpTable(ratio_h, in_h, out_h, align_flag);
+    auto coeffs_w = GetLinearInterpTable(ratio_w, in_w, out_w, align_flag);
+    size_t offsets[] = {
+        AppendInterpTable(coeffs_h, &tables),
+        AppendInterpTable(coeffs_w, &tables),
+        AppendInterpTable(GetLinearInterpRanges(coeffs_h, in_h), &tables),
+        AppendInterpTable(GetLinearInterpRanges(coeffs_w, in_w), &tables)};
+    framework::TensorFromVector(tables, ctx.device_context(), &tables_tensor);
+    const int* tables_data = tables_tensor.data<int>();
+    auto* table_h =
+        reinterpret_cast<const LinearInterpCoeff*>(tables_data + offsets[0]);
+    auto* table_w =
+        reinterpret_cast<const LinearInterpCoeff*>(tables_data + offsets[1]);
+    auto* ranges_h =
+        reinterpret_cast<const InterpRange*>(tables_data + offsets[2]);
+    auto* ranges_w =
+        reinterpret_cast<const InterpRange*>(tables_data + offsets[3]);
+    if (vectorized) {
+      KeBilinearInterpBw<T, kVecSize><<<config.blocks, config.threads, 0,
+                                        stream>>>(
+          input_grad_data, in_h, in_w, output_grad_data, out_h, out_w,
+          num_images, num_channels, table_h, table_w, ranges_h, ranges_w);
+    } else {
+      KeBilinearInterpBw<T, 1><<<config.blocks, config.threads, 0, stream>>>(
+          input_grad_data, in_h, in_w, output_grad_data, out_h, out_w,
+          num_images, num_channels, table_h, table_w, ranges_h, ranges_w);
+    }
   }
 }
 
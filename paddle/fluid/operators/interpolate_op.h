@@ -14,6 +14,7 @@
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
@@ -75,31 +76,127 @@ inline void ExtractNCDWH(const framework::DDim& dims,
   }
 }
 
+// The two source pixels of an output pixel along one axis of the bilinear
+// interpolation and their weights, out = in[lo] * w_lo + in[hi] * w_hi.
+struct LinearInterpCoeff {
+  int lo;
+  int hi;
+  float w_lo;
+  float w_hi;
+};
+
+// The output pixels [begin, end) along one axis which read a source pixel,
+// it lets the backward gather the gradient of every input pixel instead of
+// scattering the gradient of the outputs.
+struct InterpRange {
+  int begin;
+  int end;
+};
+
+HOSTDEVICE inline float LinearInterpWeight(const LinearInterpCoeff& coeff,
+                                           const int in_idx) {
+  return (coeff.lo == in_idx ? coeff.w_lo : 0.f) +
+         (coeff.hi == in_idx ? coeff.w_hi : 0.f);
+}
+
+inline std::vector<LinearInterpCoeff> GetLinearInterpTable(
+    const float ratio, const int in_size, const int out_size,
+    const bool align_flag) {
+  std::vector<LinearInterpCoeff> table(out_size);
+  for (int k = 0; k < out_size; k++) {
+    int lo = align_flag ? static_cast<int>(ratio * (k + 0.5) - 0.5)
+                        : static_cast<int>(ratio * k);
+    lo = (lo > 0) ? lo : 0;
+    float idx_src = ratio * (k + 0.5) - 0.5;
+    idx_src = (idx_src > 0) ? idx_src : 0;
+    float d = align_flag ? idx_src - lo : ratio * k - lo;
+    table[k].lo = lo;
+    table[k].hi = (lo + 1) < (in_size - 1) ? (lo + 1) : (in_size - 1);
+    table[k].w_lo = 1.f - d;
+    table[k].w_hi = d;
+  }
+  return table;
+}
+
+inline std::vector<int> GetNearestInterpTable(const float ratio,
+                                              const int out_size,
+                                              const bool align_corners) {
+  std::vector<int> table(out_size);
+  for (int k = 0; k < out_size; k++) {
+    table[k] = (align_corners) ? static_cast<int>(ratio * k + 0.5)
+                               : static_cast<int>(ratio * k);
+  }
+  return table;
+}
+
+// The source indices grow with the output indices, so the output pixels
+// reading a source pixel are always contiguous.
+inline void ExtendInterpRange(const int out_idx, InterpRange* range) {
+  if (range->begin == range->end) {
+    range->begin = out_idx;
+  }
+  range->end = out_idx + 1;
+}
+
+inline std::vector<InterpRange> GetLinearInterpRanges(
+    const std::vector<LinearInterpCoeff>& table, const int in_size) {
+  std::vector<InterpRange> ranges(in_size, InterpRange{0, 0});
+  for (size_t k = 0; k < table.size(); k++) {
+    ExtendInterpRange(k, &ranges[table[k].lo]);
+    if (table[k].hi != table[k].lo) {
+      ExtendInterpRange(k, &ranges[table[k].hi]);
+    }
+  }
+  return ranges;
+}
+
+inline std::vector<InterpRange> GetNearestInterpRanges(
+    const std::vector<int>& table, const int in_size) {
+  std::vector<InterpRange> ranges(in_size, InterpRange{0, 0});
+  for (size_t k = 0; k < table.size(); k++) {
+    ExtendInterpRange(k, &ranges[table[k]]);
+  }
+  return ranges;
+}
+
+// Views the NCHW tensor as N * C images of one channel and the NHWC tensor
+// as N images of C channels, so that the 2D kernels handle both layouts with
+// the channels innermost.
+inline void GetInterpImages(const int n, const int c,
+                            const DataLayout& data_layout, int* num_images,
+                            int* num_channels) {
+  *num_images = data_layout == DataLayout::kNCHW ? n * c : n;
+  *num_channels = data_layout == DataLayout::kNCHW ? 1 : c;
+}
+
 template <typename T>
 static void NearestNeighborInterpolate(const Tensor& input, Tensor* output,
                                        const float ratio_h, const float ratio_w,
+                                       const int in_h, const int in_w,
                                        const int n, const int c,
                                        const int out_h, const int out_w,
                                        const bool align_corners,
                                        const DataLayout& data_layout) {
-  auto input_t = EigenTensor<T, 4>::From(input);
-  auto output_t = EigenTensor<T, 4>::From(*output);
-  for (int k = 0; k < out_h; k++) {  // loop for images
-    int in_k = (align_corners) ? static_cast<int>(ratio_h * k + 0.5)
-                               : static_cast<int>(ratio_h * k);
+  auto table_h = GetNearestInterpTable(ratio_h, out_h, align_corners);
+  auto table_w = GetNearestInterpTable(ratio_w, out_w, align_corners);
+  int num_images, num_channels;
+  GetInterpImages(n, c, data_layout, &num_images, &num_channels);
+  const T* in = input.data<T>();
+  T* out = output->data<T>();
 
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int row = 0; row < num_images * out_h; row++) {
+    int image = row / out_h;
+    const T* in_row =
+        in + (image * in_h + table_h[row % out_h]) * in_w * num_channels;
+    T* out_row = out + row * out_w * num_channels;
     for (int l = 0; l < out_w; l++) {
-      int in_l = (align_corners) ? static_cast<int>(ratio_w * l + 0.5)
-                                 : static_cast<int>(ratio_w * l);
-
-      for (int i = 0; i < n; i++) {    // loop for batches
-        for (int j = 0; j < c; j++) {  // loop for channels
-          if (data_layout == DataLayout::kNCHW) {
-            output_t(i, j, k, l) = input_t(i, j, in_k, in_l);
-          } else {
-            output_t(i, k, l, j) = input_t(i, in_k, in_l, j);
-          }
-        }
+      const T* in_pixel = in_row + table_w[l] * num_channels;
+      T* out_pixel = out_row + l * num_channels;
+      for (int j = 0; j < num_channels; j++) {
+        out_pixel[j] = in_pixel[j];
       }
     }
   }
@@ -113,87 +210,38 @@ static void BilinearInterpolation(const Tensor& input, Tensor* output,
                                   const bool align_corners,
                                   const bool align_mode,
                                   const DataLayout data_layout) {
-  auto input_t = EigenTensor<T, 4>::From(input);
-  auto output_t = EigenTensor<T, 4>::From(*output);
   bool align_flag = (align_mode == 0 && !align_corners);
+  auto table_h = GetLinearInterpTable(ratio_h, in_h, out_h, align_flag);
+  auto table_w = GetLinearInterpTable(ratio_w, in_w, out_w, align_flag);
+  int num_images, num_channels;
+  GetInterpImages(n, c, data_layout, &num_images, &num_channels);
+  const T* in = input.data<T>();
+  T* out = output->data<T>();
+  const int in_row_size = in_w * num_channels;
 
-  std::vector<int> vy_n, vy_s;
-  std::vector<float> vd_n, vd_s;
-  vy_n.reserve(out_h);
-  vy_s.reserve(out_h);
-  vd_n.reserve(out_h);
-  vd_s.reserve(out_h);
 #ifdef PADDLE_WITH_MKLML
 #pragma omp parallel for
 #endif
-  for (int k = 0; k < out_h; k++) {
-    int y_n = align_flag ? static_cast<int>(ratio_h * (k + 0.5) - 0.5)
-                         : static_cast<int>(ratio_h * k);
-    y_n = (y_n > 0) ? y_n : 0;
-    int y_s = (y_n + 1) < (in_h - 1) ? (y_n + 1) : (in_h - 1);
-    float idx_src_y = ratio_h * (k + 0.5) - 0.5;
-    idx_src_y = (idx_src_y > 0) ? idx_src_y : 0;
-    float d_n = align_flag ? idx_src_y - y_n : ratio_h * k - y_n;
-    float d_s = 1.f - d_n;
-    {
-      vy_n[k] = y_n;
-      vy_s[k] = y_s;
-      vd_n[k] = d_n;
-      vd_s[k] = d_s;
-    }
-  }
-
-  std::vector<int> vx_w, vx_e;
-  std::vector<float> vd_w, vd_e;
-  vx_w.reserve(out_w);
-  vx_e.reserve(out_w);
-  vd_w.reserve(out_w);
-  vd_e.reserve(out_w);
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-  for (int l = 0; l < out_w; l++) {
-    int x_w = (align_mode == 0 && !align_corners)
-                  ? static_cast<int>(ratio_w * (l + 0.5) - 0.5)
-                  : static_cast<int>(ratio_w * l);
-    x_w = (x_w > 0) ? x_w : 0;
-    int x_e = (x_w + 1) < (in_w - 1) ? (x_w + 1) : (in_w - 1);
-    float idx_src_x = ratio_w * (l + 0.5) - 0.5;
-    idx_src_x = (idx_src_x > 0) ? idx_src_x : 0;
-    float d_w = align_flag ? idx_src_x - x_w : ratio_w * l - x_w;
-    float d_e = 1.f - d_w;
-    {
-      vx_w[l] = x_w;
-      vx_e[l] = x_e;
-      vd_w[l] = d_w;
-      vd_e[l] = d_e;
-    }
-  }
-
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for collapse(4)
-#endif
-  for (int i = 0; i < n; i++) {          // loop for batches
-    for (int j = 0; j < c; j++) {        // loop for channels
-      for (int k = 0; k < out_h; k++) {  // loop for images
-        for (int l = 0; l < out_w; l++) {
-          // bilinear interpolation
-          T out_t;
-          if (data_layout == DataLayout::kNCHW) {
-            out_t = input_t(i, j, vy_n[k], vx_w[l]) * vd_s[k] * vd_e[l] +
-                    input_t(i, j, vy_s[k], vx_w[l]) * vd_n[k] * vd_e[l] +
-                    input_t(i, j, vy_n[k], vx_e[l]) * vd_s[k] * vd_w[l] +
-                    input_t(i, j, vy_s[k], vx_e[l]) * vd_n[k] * vd_w[l];
-            output_t(i, j, k, l) = out_t;
-
-          } else {
-            out_t = input_t(i, vy_n[k], vx_w[l], j) * vd_s[k] * vd_e[l] +
-                    input_t(i, vy_s[k], vx_w[l], j) * vd_n[k] * vd_e[l] +
-                    input_t(i, vy_n[k], vx_e[l], j) * vd_s[k] * vd_w[l] +
-                    input_t(i, vy_s[k], vx_e[l], j) * vd_n[k] * vd_w[l];
-            output_t(i, k, l, j) = out_t;
-          }
-        }
+  for (int row = 0; row < num_images * out_h; row++) {
+    const LinearInterpCoeff& coeff_h = table_h[row % out_h];
+    const T* in_img = in + row / out_h * in_h * in_row_size;
+    const T* in_lo = in_img + coeff_h.lo * in_row_size;
+    const T* in_hi = in_img + coeff_h.hi * in_row_size;
+    T* out_row = out + row * out_w * num_channels;
+    for (int l = 0; l < out_w; l++) {
+      const LinearInterpCoeff& coeff_w = table_w[l];
+      const int lo = coeff_w.lo * num_channels;
+      const int hi = coeff_w.hi * num_channels;
+      const float w_ll = coeff_h.w_lo * coeff_w.w_lo;
+      const float w_lh = coeff_h.w_lo * coeff_w.w_hi;
+      const float w_hl = coeff_h.w_hi * coeff_w.w_lo;
+      const float w_hh = coeff_h.w_hi * coeff_w.w_hi;
+      T* out_pixel = out_row + l * num_channels;
+      // The channels are contiguous in NHWC, this loop is vectorized.
+      for (int j = 0; j < num_channels; j++) {
+        out_pixel[j] = static_cast<T>(
+            w_ll * in_lo[lo + j] + w_lh * in_lo[hi + j] +
+            w_hl * in_hi[lo + j] + w_hh * in_hi[hi + j]);
       }
     }
   }
@@ -345,25 +393,36 @@ static void TrilinearInterpolation(
 template <typename T>
 static void NearestNeighborInterpolateGrad(
     const Tensor& output_grad, Tensor* input_grad, const float ratio_h,
-    const float ratio_w, const int n, const int c, const int out_h,
-    const int out_w, const bool align_corners, const DataLayout data_layout) {
-  auto input_grad_t = EigenTensor<T, 4>::From(*input_grad);
-  auto output_grad_t = EigenTensor<T, 4>::From(output_grad);
-
-  for (int k = 0; k < out_h; k++) {  // loop for images
-    int in_k = (align_corners) ? static_cast<int>(ratio_h * k + 0.5)
-                               : static_cast<int>(ratio_h * k);
-
-    for (int l = 0; l < out_w; l++) {
-      int in_l = (align_corners) ? static_cast<int>(ratio_w * l + 0.5)
-                                 : static_cast<int>(ratio_w * l);
-
-      for (int i = 0; i < n; i++) {    // loop for batches
-        for (int j = 0; j < c; j++) {  // loop for channels
-          if (data_layout == DataLayout::kNCHW) {
-            input_grad_t(i, j, in_k, in_l) += output_grad_t(i, j, k, l);
-          } else {
-            input_grad_t(i, in_k, in_l, j) += output_grad_t(i, k, l, j);
+    const float ratio_w, const int in_h, const int in_w, const int n,
+    const int c, const int out_h, const int out_w, const bool align_corners,
+    const DataLayout data_layout) {
+  auto ranges_h = GetNearestInterpRanges(
+      GetNearestInterpTable(ratio_h, out_h, align_corners), in_h);
+  auto ranges_w = GetNearestInterpRanges(
+      GetNearestInterpTable(ratio_w, out_w, align_corners), in_w);
+  int num_images, num_channels;
+  GetInterpImages(n, c, data_layout, &num_images, &num_channels);
+  const T* out_grad = output_grad.data<T>();
+  T* in_grad = input_grad->data<T>();
+  const int out_row_size = out_w * num_channels;
+
+  // Every row of the input gradient sums the output pixels reading it, so
+  // that the rows are computed in parallel.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int row = 0; row < num_images * in_h; row++) {
+    const InterpRange& range_h = ranges_h[row % in_h];
+    const T* out_img = out_grad + row / in_h * out_h * out_row_size;
+    T* in_row = in_grad + row * in_w * num_channels;
+    for (int k = range_h.begin; k < range_h.end; k++) {
+      const T* out_row = out_img + k * out_row_size;
+      for (int l = 0; l < in_w; l++) {
+        T* in_pixel = in_row + l * num_channels;
+        for (int x = ranges_w[l].begin; x < ranges_w[l].end; x++) {
+          const T* out_pixel = out_row + x * num_channels;
+          for (int j = 0; j < num_channels; j++) {
+            in_pixel[j] += out_pixel[j];
           }
         }
       }
@@ -377,44 +436,36 @@ static void BilinearInterpolationGrad(
     const float ratio_w, const int in_h, const int in_w, const int n,
     const int c, const int out_h, const int out_w, const bool align_corners,
     const int align_mode, const DataLayout data_layout) {
-  auto input_grad_t = EigenTensor<T, 4>::From(*input_grad);
-  auto output_grad_t = EigenTensor<T, 4>::From(output_grad);
   bool align_flag = (align_mode == 0 && !align_corners);
-  for (int k = 0; k < out_h; k++) {  // loop for images
-    int y_n = align_flag ? static_cast<int>(ratio_h * (k + 0.5) - 0.5)
-                         : static_cast<int>(ratio_h * k);
-    y_n = (y_n > 0) ? y_n : 0;
-    int y_s = (y_n + 1) < (in_h - 1) ? (y_n + 1) : (in_h - 1);
-    float idx_src_y = ratio_h * (k + 0.5) - 0.5;
-    idx_src_y = (idx_src_y > 0) ? idx_src_y : 0;
-    float d_n = align_flag ? idx_src_y - y_n : ratio_h * k - y_n;
-    float d_s = 1.f - d_n;
-
-    for (int l = 0; l < out_w; l++) {
-      int x_w = align_flag ? static_cast<int>(ratio_w * (l + 0.5) - 0.5)
-                           : static_cast<int>(ratio_w * l);
-      x_w = (x_w > 0) ? x_w : 0;
-      int x_e = (x_w + 1) < (in_w - 1) ? (x_w + 1) : (in_w - 1);
-      float idx_src_x = ratio_w * (l + 0.5) - 0.5;
-      idx_src_x = (idx_src_x > 0) ? idx_src_x : 0;
-      float d_w = align_flag ? idx_src_x - x_w : ratio_w * l - x_w;
-      float d_e = 1.f - d_w;
-
-      for (int i = 0; i < n; i++) {    // loop for batches
-        for (int j = 0; j < c; j++) {  // loop for channels
-          // bilinear interpolation grad
-          if (data_layout == DataLayout::kNCHW) {
-            const T grad = output_grad_t(i, j, k, l);
-            input_grad_t(i, j, y_n, x_w) += static_cast<T>(grad * d_s * d_e);
-            input_grad_t(i, j, y_s, x_w) += static_cast<T>(grad * d_n * d_e);
-            input_grad_t(i, j, y_n, x_e) += static_cast<T>(grad * d_s * d_w);
-            input_grad_t(i, j, y_s, x_e) += static_cast<T>(grad * d_n * d_w);
-          } else {
-            const T grad = output_grad_t(i, k, l, j);
-            input_grad_t(i, y_n, x_w, j) += static_cast<T>(grad * d_s * d_e);
-            input_grad_t(i, y_s, x_w, j) += static_cast<T>(grad * d_n * d_e);
-            input_grad_t(i, y_n, x_e, j) += static_cast<T>(grad * d_s * d_w);
-            input_grad_t(i, y_s, x_e, j) += static_cast<T>(grad * d_n * d_w);
+  auto table_h = GetLinearInterpTable(ratio_h, in_h, out_h, align_flag);
+  auto table_w = GetLinearInterpTable(ratio_w, in_w, out_w, align_flag);
+  auto ranges_h = GetLinearInterpRanges(table_h, in_h);
+  auto ranges_w = GetLinearInterpRanges(table_w, in_w);
+  int num_images, num_channels;
+  GetInterpImages(n, c, data_layout, &num_images, &num_channels);
+  const T* out_grad = output_grad.data<T>();
+  T* in_grad = input_grad->data<T>();
+  const int out_row_size = out_w * num_channels;
+
+  // Every row of the input gradient gathers the output pixels reading it,
+  // so that the rows are computed in parallel.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int row = 0; row < num_images * in_h; row++) {
+    const int y = row % in_h;
+    const T* out_img = out_grad + row / in_h * out_h * out_row_size;
+    T* in_row = in_grad + row * in_w * num_channels;
+    for (int k = ranges_h[y].begin; k < ranges_h[y].end; k++) {
+      const float w_h = LinearInterpWeight(table_h[k], y);
+      const T* out_row = out_img + k * out_row_size;
+      for (int l = 0; l < in_w; l++) {
+        T* in_pixel = in_row + l * num_channels;
+        for (int x = ranges_w[l].begin; x < ranges_w[l].end; x++) {
+          const float w = w_h * LinearInterpWeight(table_w[x], l);
+          const T* out_pixel = out_row + x * num_channels;
+          for (int j = 0; j < num_channels; j++) {
+            in_pixel[j] += static_cast<T>(w * out_pixel[j]);
           }
         }
       }
@@ -585,8 +636,9 @@ static void Interpolate2DCPUFwd(const framework::ExecutionContext& ctx,
                              out_h, out_w, align_corners, align_mode,
                              data_layout);
   } else if ("nearest" == interp_method) {
-    NearestNeighborInterpolate<T>(input, output, ratio_h, ratio_w, n, c, out_h,
-                                  out_w, align_corners, data_layout);
+    NearestNeighborInterpolate<T>(input, output, ratio_h, ratio_w, in_h, in_w,
+                                  n, c, out_h, out_w, align_corners,
+                                  data_layout);
   }
 }
 
@@ -757,8 +809,8 @@ static void Interpolate2DCPUBwd(const framework::ExecutionContext& ctx,
                                  align_mode, data_layout);
   } else if ("nearest" == interp_method) {
     NearestNeighborInterpolateGrad<T>(output_grad, input_grad, ratio_h, ratio_w,
-                                      n, c, out_h, out_w, align_corners,
-                                      data_layout);
+                                      in_h, in_w, n, c, out_h, out_w,
+                                      align_corners, data_layout);
   }
 }
 
@@ -0,0 +1,83 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/autotune.h"
+#include <fstream>
+#include <sstream>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/operators/jit/helper.h"
+
+DEFINE_bool(jit_autotune, false,
+            "Time all the candidate implementations of a jit kernel on the "
+            "first use of an attr, and use the fastest one instead of the "
+            "first one in the order of jitcode, more and refer.");
+DEFINE_int32(jit_autotune_repeat, 100,
+             "The times to run each implementation when autotuning.");
+DEFINE_string(jit_autotune_cache_file, "",
+              "The file to load and save the autotuned implementations, so "
+              "that the kernels are not tuned again by the next runs.");
+
+namespace paddle {
+namespace operators {
+namespace jit {
+
+bool AutotuneEnabled() { return FLAGS_jit_autotune; }
+
+int AutotuneRepeat() { return FLAGS_jit_autotune_repeat; }
+
+std::string AutotuneKey(KernelType type, const char* dtype, int64_t attr_key) {
+  std::ostringstream key;
+  key << to_string(type) << "_" << dtype << "_" << attr_key;
+  return key.str();
+}
+
+AutotuneCache& AutotuneCache::Instance() {
+  static AutotuneCache cache;
+  return cache;
+}
+
+AutotuneCache::AutotuneCache() : path_(FLAGS_jit_autotune_cache_file) {
+  if (path_.empty()) return;
+  std::ifstream fin(path_);
+  std::string key, impl_type;
+  while (fin >> key >> impl_type) {
+    impl_types_[key] = impl_type;
+  }
+  VLOG(3) << "load " << impl_types_.size() << " autotuned jit kernels from "
+          << path_;
+}
+
+bool AutotuneCache::Get(const std::string& key, std::string* impl_type) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = impl_types_.find(key);
+  if (it == impl_types_.end()) return false;
+  *impl_type = it->second;
+  return true;
+}
+
+void AutotuneCache::Set(const std::string& key, const std::string& impl_type) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!impl_types_.emplace(key, impl_type).second || path_.empty()) return;
+  std::ofstream fout(path_, std::ios::app);
+  if (!fout) {
+    LOG(WARNING) << "can not save the autotuned jit kernels to " << path_;
+    return;
+  }
+  fout << key << " " << impl_type << "\n";
+}
+
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
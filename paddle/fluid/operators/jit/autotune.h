@@ -0,0 +1,170 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/operators/jit/kernel_base.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+
+// Return the average time in us of running func with args for repeat times,
+// after running it for burning times.
+template <typename Func, typename... Args>
+double TimeFunc(int burning, int repeat, Func func, Args... args) {
+  for (int i = 0; i < burning; ++i) {
+    func(args...);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    func(args...);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         repeat;
+}
+
+bool AutotuneEnabled();
+
+int AutotuneRepeat();
+
+std::string AutotuneKey(KernelType type, const char* dtype, int64_t attr_key);
+
+// The implementation types tuned as the best for the attrs, shared by all
+// the threads and persisted to FLAGS_jit_autotune_cache_file if set, so
+// that the kernels are tuned once for each attr.
+class AutotuneCache {
+ public:
+  static AutotuneCache& Instance();
+
+  bool Get(const std::string& key, std::string* impl_type);
+
+  void Set(const std::string& key, const std::string& impl_type);
+
+ private:
+  AutotuneCache();
+
+  std::mutex mutex_;
+  std::string path_;
+  std::unordered_map<std::string, std::string> impl_types_;
+  DISABLE_COPY_AND_ASSIGN(AutotuneCache);
+};
+
+template <typename T>
+void AutotuneRandomVec(std::vector<T>* vec) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<double> uniform_dist(-2., 2.);
+  for (auto& v : *vec) {
+    v = static_cast<T>(uniform_dist(rng));
+  }
+}
+
+// The inputs to time the kernels of KernelTuple with the attr. The kernels
+// without the inputs are not tuned.
+template <typename KernelTuple, typename Enable = void>
+struct AutotuneArgs {
+  static constexpr bool kTunable = false;
+  explicit AutotuneArgs(const typename KernelTuple::attr_type&) {}
+  double Time(typename KernelTuple::func_type) { return 0.; }
+};
+
+// XYZN and AXYN, whose a is read as a scalar
+template <typename KernelTuple>
+struct AutotuneArgs<KernelTuple,
+                    typename std::enable_if<std::is_base_of<
+                        XYZNTuple<typename KernelTuple::data_type>,
+                        KernelTuple>::value>::type> {
+  using T = typename KernelTuple::data_type;
+  static constexpr bool kTunable = true;
+  explicit AutotuneArgs(int d) : d(d), x(d), y(d), z(d) {
+    AutotuneRandomVec(&x);
+    AutotuneRandomVec(&y);
+  }
+  double Time(typename KernelTuple::func_type func) {
+    return TimeFunc(1, AutotuneRepeat(), func, x.data(), y.data(), z.data(),
+                    d);
+  }
+  int d;
+  std::vector<T> x, y, z;
+};
+
+// XYN and XRN, whose res is a scalar
+template <typename KernelTuple>
+struct AutotuneArgs<KernelTuple,
+                    typename std::enable_if<std::is_base_of<
+                        XYNTuple<typename KernelTuple::data_type>,
+                        KernelTuple>::value>::type> {
+  using T = typename KernelTuple::data_type;
+  static constexpr bool kTunable = true;
+  explicit AutotuneArgs(int d) : d(d), x(d), y(d) { AutotuneRandomVec(&x); }
+  double Time(typename KernelTuple::func_type func) {
+    return TimeFunc(1, AutotuneRepeat(), func, x.data(), y.data(), d);
+  }
+  int d;
+  std::vector<T> x, y;
+};
+
+template <typename KernelTuple>
+struct AutotuneArgs<KernelTuple,
+                    typename std::enable_if<std::is_same<
+                        SeqPoolTuple<typename KernelTuple::data_type>,
+                        KernelTuple>::value>::type> {
+  using T = typename KernelTuple::data_type;
+  static constexpr bool kTunable = true;
+  explicit AutotuneArgs(const seq_pool_attr_t& attr)
+      : attr(attr), x(attr.h * attr.w), y(attr.w) {
+    AutotuneRandomVec(&x);
+  }
+  double Time(typename KernelTuple::func_type func) {
+    return TimeFunc(1, AutotuneRepeat(), func, x.data(), y.data(), &attr);
+  }
+  seq_pool_attr_t attr;
+  std::vector<T> x, y;
+};
+
+template <typename KernelTuple>
+struct AutotuneArgs<KernelTuple,
+                    typename std::enable_if<std::is_same<
+                        MatMulTuple<typename KernelTuple::data_type>,
+                        KernelTuple>::value>::type> {
+  using T = typename KernelTuple::data_type;
+  static constexpr bool kTunable = true;
+  explicit AutotuneArgs(const matmul_attr_t& attr)
+      : attr(attr),
+        a(attr.m * attr.k),
+        b(attr.k * attr.n),
+        c(attr.m * attr.n) {
+    AutotuneRandomVec(&a);
+    AutotuneRandomVec(&b);
+  }
+  double Time(typename KernelTuple::func_type func) {
+    return TimeFunc(1, AutotuneRepeat(), func, a.data(), b.data(), c.data(),
+                    &attr);
+  }
+  matmul_attr_t attr;
+  std::vector<T> a, b, c;
+};
+
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
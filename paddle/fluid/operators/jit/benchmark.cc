@@ -20,7 +20,6 @@
 #include "glog/logging.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/operators/jit/kernels.h"
-#include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/platform/variant.h"  // for UNUSED
@@ -93,15 +92,8 @@ struct BenchFunc {
   // return this function avg time
   // TODO(TJ): clear cache every time
   double operator()(const typename KernelTuple::func_type tgt, Args... args) {
-    for (int i = 0; i < FLAGS_burning; ++i) {
-      tgt(args...);
-    }
-    auto start = paddle::platform::PosixInNsec() * 1e-3;
-    for (int i = 0; i < FLAGS_repeat; ++i) {
-      tgt(args...);
-    }
-    auto end = paddle::platform::PosixInNsec() * 1e-3;
-    return static_cast<double>(end - start) / FLAGS_repeat;
+    return paddle::operators::jit::TimeFunc(FLAGS_burning, FLAGS_repeat, tgt,
+                                            args...);
   }
 };
 
@@ -26,34 +26,19 @@ void VXXJitCode::genCode() {
   // do not need push stack, and do not need save avx512reg if do not use avx512
   int offset = 0;
   if (with_relu_) {
-    vxorps(ymm_zero, ymm_zero, ymm_zero);
+    // the vex encoded xor clears the upper bits of the ymm and zmm as well
+    vxorps(xmm_zero, xmm_zero, xmm_zero);
   }
-  if (scalar_index_ == 1) {
-    vbroadcastss(ymm_src1, ptr[param1]);
-  } else if (scalar_index_ == 2) {
-    vbroadcastss(ymm_src2, ptr[param2]);
+  int rest = num_;
+  if (platform::MayIUse(platform::avx512f) && rest >= ZMM_FLOAT_BLOCK) {
+    // the scalar broadcasted to the zmm is used by the ymm and xmm blocks
+    genBlocks<zmm_t>(rest / ZMM_FLOAT_BLOCK, ZMM_FLOAT_BLOCK, true, &offset);
+    rest %= ZMM_FLOAT_BLOCK;
+    genBlocks<ymm_t>(rest / YMM_FLOAT_BLOCK, YMM_FLOAT_BLOCK, false, &offset);
+  } else {
+    genBlocks<ymm_t>(rest / YMM_FLOAT_BLOCK, YMM_FLOAT_BLOCK, true, &offset);
   }
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
-    if (scalar_index_ != 1) {
-      vmovups(ymm_src1, ptr[param1 + offset]);
-    }
-    if (scalar_index_ != 2) {
-      vmovups(ymm_src2, ptr[param2 + offset]);
-    }
-    if (type_ == operand_type::MUL) {
-      vmulps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::ADD) {
-      vaddps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::SUB) {
-      vsubps(ymm_dst, ymm_src1, ymm_src2);
-    }
-    if (with_relu_) {
-      vmaxps(ymm_dst, ymm_zero, ymm_dst);
-    }
-    vmovups(ptr[param3 + offset], ymm_dst);
-    offset += sizeof(float) * YMM_FLOAT_BLOCK;
-  }
-  int rest = num_ % YMM_FLOAT_BLOCK;
+  rest %= YMM_FLOAT_BLOCK;
   while (rest > 0) {
     int block = XMM_FLOAT_BLOCK;
     if (rest >= 4) {
@@ -67,6 +67,38 @@ class VXXJitCode : public JitCode {
   void genCode() override;
 
  private:
+  // Compute num_blocks blocks of the vectors from offset by the regs JMM,
+  // broadcasting the scalar first if needed.
+  template <typename JMM>
+  void genBlocks(int num_blocks, int block, bool broadcast, int* offset) {
+    JMM jmm_src1(0), jmm_src2(1), jmm_dst(2), jmm_zero(3);
+    if (broadcast && scalar_index_ == 1) {
+      vbroadcastss(jmm_src1, ptr[param1]);
+    } else if (broadcast && scalar_index_ == 2) {
+      vbroadcastss(jmm_src2, ptr[param2]);
+    }
+    for (int i = 0; i < num_blocks; ++i) {
+      if (scalar_index_ != 1) {
+        vmovups(jmm_src1, ptr[param1 + *offset]);
+      }
+      if (scalar_index_ != 2) {
+        vmovups(jmm_src2, ptr[param2 + *offset]);
+      }
+      if (type_ == operand_type::MUL) {
+        vmulps(jmm_dst, jmm_src1, jmm_src2);
+      } else if (type_ == operand_type::ADD) {
+        vaddps(jmm_dst, jmm_src1, jmm_src2);
+      } else if (type_ == operand_type::SUB) {
+        vsubps(jmm_dst, jmm_src1, jmm_src2);
+      }
+      if (with_relu_) {
+        vmaxps(jmm_dst, jmm_zero, jmm_dst);
+      }
+      vmovups(ptr[param3 + *offset], jmm_dst);
+      *offset += sizeof(float) * block;
+    }
+  }
+
   int num_;
   operand_type type_;
   int scalar_index_;
@@ -79,11 +111,6 @@ class VXXJitCode : public JitCode {
   xmm_t xmm_src2 = xmm_t(1);
   xmm_t xmm_dst = xmm_t(2);
   xmm_t xmm_zero = xmm_t(3);
-
-  ymm_t ymm_src1 = ymm_t(0);
-  ymm_t ymm_src2 = ymm_t(1);
-  ymm_t ymm_dst = ymm_t(2);
-  ymm_t ymm_zero = ymm_t(3);
 };
 
 #define DECLARE_BLAS_JITCODE(name, op_type, scalar_idx, with_relu)             \
@@ -96,6 +96,25 @@ class SeqPoolJitCode : public JitCode {
     }
   }
 
+  // Pool the blocks of the width from w_begin by the regs JMM, and return
+  // the width pooled.
+  template <typename JMM>
+  int pool_blocks(int w_begin, int block, int max_num_regs) {
+    const int num_block = (w_ - w_begin) / block;
+    const int num_groups = num_block / max_num_regs;
+    const int rest_num_regs = num_block % max_num_regs;
+    const int group_len = max_num_regs * block * sizeof(float);
+    const int w_offset = w_begin * sizeof(float);
+    for (int g = 0; g < num_groups; ++g) {
+      pool_height<JMM>(w_offset + g * group_len, block, max_num_regs);
+    }
+    if (rest_num_regs > 0) {
+      pool_height<JMM>(w_offset + num_groups * group_len, block,
+                       rest_num_regs);
+    }
+    return w_begin + num_block * block;
+  }
+
   void pool_height_of_rest_width(int rest, int w_offset, int max_num_regs) {
     const int rest_used_num_regs = load_rest(rest, w_offset, 0);
     const bool has_block4 = rest / 4 > 0;
@@ -21,6 +21,7 @@
 #include <unordered_map>
 #include <utility>  // for std::move
 #include <vector>
+#include "paddle/fluid/operators/jit/autotune.h"
 #include "paddle/fluid/operators/jit/gen_base.h"
 #include "paddle/fluid/operators/jit/kernel_base.h"
 #include "paddle/fluid/operators/jit/kernel_key.h"
@@ -177,6 +178,50 @@ typename KernelTuple::func_type GetDefaultBestFunc(
   return funcs[0];
 }
 
+// Time all the candidates of this attr and return the fastest one. The
+// winner is kept in AutotuneCache by its implementation type, so that the
+// other threads and the next runs with the same cache file reuse it.
+template <typename KernelTuple, typename PlaceType = platform::CPUPlace>
+typename KernelTuple::func_type GetAutotunedBestFunc(
+    const typename KernelTuple::attr_type& attr) {
+  using T = typename KernelTuple::data_type;
+  auto funcs = GetAllCandidateFuncsWithTypes<KernelTuple, PlaceType>(attr);
+  PADDLE_ENFORCE_GE(funcs.size(), 1UL,
+                    platform::errors::NotFound(
+                        "No kernel of %s is found for the attr.",
+                        to_string(KernelTuple::kernel_type)));
+  using Args = AutotuneArgs<KernelTuple>;
+  if (!Args::kTunable || funcs.size() == 1UL) {
+    return funcs[0].second;
+  }
+  auto key = AutotuneKey(KernelTuple::kernel_type, typeid(T).name(),
+                         JitCodeKey<typename KernelTuple::attr_type>(attr));
+  auto& cache = AutotuneCache::Instance();
+  std::string impl_type;
+  if (cache.Get(key, &impl_type)) {
+    for (auto& f : funcs) {
+      if (f.first == impl_type) return f.second;
+    }
+    VLOG(3) << "the autotuned " << impl_type << " of " << key
+            << " is not found, tune it again";
+  }
+
+  Args args(attr);
+  size_t best = 0;
+  double best_time = -1.;
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    double t = args.Time(funcs[i].second);
+    VLOG(4) << key << " " << funcs[i].first << ": " << t << " us";
+    if (best_time < 0 || t < best_time) {
+      best = i;
+      best_time = t;
+    }
+  }
+  VLOG(3) << "autotune " << key << " to " << funcs[best].first;
+  cache.Set(key, funcs[best].first);
+  return funcs[best].second;
+}
+
 extern std::map<size_t, std::shared_ptr<void>>& GetFuncCacheMap();
 
 template <typename KernelTuple, typename PlaceType>
@@ -205,8 +250,11 @@ class KernelFuncs {
     if (Has(key)) {
       return funcs_.at(key);
     }
-    // If do not have this attr in cache then get the default best
-    auto func = GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
+    // If do not have this attr in cache then get the default best,
+    // or the fastest one if autotuned
+    auto func = AutotuneEnabled()
+                    ? GetAutotunedBestFunc<KernelTuple, PlaceType>(attr)
+                    : GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
     Insert(key, func);
     return func;
   }
@@ -0,0 +1,307 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/more/neon/neon.h"
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace neon {
+
+#define NEON_FLOAT_BLOCK 4
+
+void MatMul(const float* a, const float* b, float* c,
+            const matmul_attr_t* attr) {
+  const int m = attr->m;
+  const int n = attr->n;
+  const int k = attr->k;
+  // 4 blocks of the row of c are accumulated in the regs over k
+  constexpr int block = NEON_FLOAT_BLOCK * 4;
+  for (int i = 0; i < m; ++i) {
+    const float* pa = a + i * k;
+    float* pc = c + i * n;
+    int j = 0;
+    for (; j + block <= n; j += block) {
+      float32x4_t acc0 = vdupq_n_f32(0.f);
+      float32x4_t acc1 = vdupq_n_f32(0.f);
+      float32x4_t acc2 = vdupq_n_f32(0.f);
+      float32x4_t acc3 = vdupq_n_f32(0.f);
+      for (int l = 0; l < k; ++l) {
+        const float* pb = b + l * n + j;
+        float32x4_t va = vdupq_n_f32(pa[l]);
+        acc0 = vmlaq_f32(acc0, vld1q_f32(pb), va);
+        acc1 = vmlaq_f32(acc1, vld1q_f32(pb + 4), va);
+        acc2 = vmlaq_f32(acc2, vld1q_f32(pb + 8), va);
+        acc3 = vmlaq_f32(acc3, vld1q_f32(pb + 12), va);
+      }
+      vst1q_f32(pc + j, acc0);
+      vst1q_f32(pc + j + 4, acc1);
+      vst1q_f32(pc + j + 8, acc2);
+      vst1q_f32(pc + j + 12, acc3);
+    }
+    for (; j + NEON_FLOAT_BLOCK <= n; j += NEON_FLOAT_BLOCK) {
+      float32x4_t acc = vdupq_n_f32(0.f);
+      for (int l = 0; l < k; ++l) {
+        acc = vmlaq_f32(acc, vld1q_f32(b + l * n + j), vdupq_n_f32(pa[l]));
+      }
+      vst1q_f32(pc + j, acc);
+    }
+    for (; j < n; ++j) {
+      float sum = 0.f;
+      for (int l = 0; l < k; ++l) {
+        sum += pa[l] * b[l * n + j];
+      }
+      pc[j] = sum;
+    }
+  }
+}
+
+#define NEON_BINARY_KERNEL(name, vop, sop)                         \
+  void name(const float* x, const float* y, float* z, int n) {     \
+    int i = 0;                                                     \
+    for (; i + NEON_FLOAT_BLOCK <= n; i += NEON_FLOAT_BLOCK) {     \
+      vst1q_f32(z + i, vop(vld1q_f32(x + i), vld1q_f32(y + i)));   \
+    }                                                              \
+    for (; i < n; ++i) {                                           \
+      z[i] = x[i] sop y[i];                                        \
+    }                                                              \
+  }
+
+NEON_BINARY_KERNEL(VMul, vmulq_f32, *);
+NEON_BINARY_KERNEL(VAdd, vaddq_f32, +);
+
+#undef NEON_BINARY_KERNEL
+
+void VScal(const float* a, const float* x, float* y, int n) {
+  const float32x4_t va = vdupq_n_f32(a[0]);
+  int i = 0;
+  for (; i + NEON_FLOAT_BLOCK <= n; i += NEON_FLOAT_BLOCK) {
+    vst1q_f32(y + i, vmulq_f32(va, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = a[0] * x[i];
+  }
+}
+
+void VAddBias(const float* a, const float* x, float* y, int n) {
+  const float32x4_t va = vdupq_n_f32(a[0]);
+  int i = 0;
+  for (; i + NEON_FLOAT_BLOCK <= n; i += NEON_FLOAT_BLOCK) {
+    vst1q_f32(y + i, vaddq_f32(va, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = a[0] + x[i];
+  }
+}
+
+void VRelu(const float* x, float* y, int n) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  int i = 0;
+  for (; i + NEON_FLOAT_BLOCK <= n; i += NEON_FLOAT_BLOCK) {
+    vst1q_f32(y + i, vmaxq_f32(zero, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = x[i] > 0.f ? x[i] : 0.f;
+  }
+}
+
+void VSquare(const float* x, float* y, int n) {
+  int i = 0;
+  for (; i + NEON_FLOAT_BLOCK <= n; i += NEON_FLOAT_BLOCK) {
+    float32x4_t vx = vld1q_f32(x + i);
+    vst1q_f32(y + i, vmulq_f32(vx, vx));
+  }
+  for (; i < n; ++i) {
+    y[i] = x[i] * x[i];
+  }
+}
+
+// exp(x) = 2^n * exp(g), where n = floor(x * log2(e) + 0.5) and exp(g) is
+// approximated by the polynomial, with the same constants as the jitcode.
+static inline float32x4_t ExpPs(float32x4_t x) {
+  x = vminq_f32(x, vdupq_n_f32(88.3762626647949f));
+  x = vmaxq_f32(x, vdupq_n_f32(-88.3762626647949f));
+
+  float32x4_t fx = vmlaq_f32(vdupq_n_f32(0.5f), x,
+                             vdupq_n_f32(1.44269504088896341f));
+  // floor by truncating, and minus 1 if the truncated one is larger
+  float32x4_t tmp = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+  uint32x4_t mask = vcgtq_f32(tmp, fx);
+  fx = vsubq_f32(
+      tmp, vreinterpretq_f32_u32(vandq_u32(
+               mask, vreinterpretq_u32_f32(vdupq_n_f32(1.f)))));
+
+  x = vmlsq_f32(x, fx, vdupq_n_f32(0.693359375f));
+  x = vmlsq_f32(x, fx, vdupq_n_f32(-2.12194440e-4f));
+
+  float32x4_t y = vdupq_n_f32(1.9875691500E-4f);
+  y = vmlaq_f32(vdupq_n_f32(1.3981999507E-3f), y, x);
+  y = vmlaq_f32(vdupq_n_f32(8.3334519073E-3f), y, x);
+  y = vmlaq_f32(vdupq_n_f32(4.1665795894E-2f), y, x);
+  y = vmlaq_f32(vdupq_n_f32(1.6666665459E-1f), y, x);
+  y = vmlaq_f32(vdupq_n_f32(5.0000001201E-1f), y, x);
+  y = vmlaq_f32(vaddq_f32(x, vdupq_n_f32(1.f)), y, vmulq_f32(x, x));
+
+  int32x4_t pow2n = vshlq_n_s32(
+      vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(0x7f)), 23);
+  return vmulq_f32(y, vreinterpretq_f32_s32(pow2n));
+}
+
+void VExp(const float* x, float* y, int n) {
+  int i = 0;
+  for (; i + NEON_FLOAT_BLOCK <= n; i += NEON_FLOAT_BLOCK) {
+    vst1q_f32(y + i, ExpPs(vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = std::exp(x[i]);
+  }
+}
+
+void HMax(const float* x, float* res, int n) {
+  int i = 0;
+  float result = x[0];
+  if (n >= NEON_FLOAT_BLOCK) {
+    float32x4_t vmax = vld1q_f32(x);
+    for (i = NEON_FLOAT_BLOCK; i + NEON_FLOAT_BLOCK <= n;
+         i += NEON_FLOAT_BLOCK) {
+      vmax = vmaxq_f32(vmax, vld1q_f32(x + i));
+    }
+    float32x2_t half = vpmax_f32(vget_low_f32(vmax), vget_high_f32(vmax));
+    half = vpmax_f32(half, half);
+    result = vget_lane_f32(half, 0);
+  }
+  for (; i < n; ++i) {
+    result = std::max(result, x[i]);
+  }
+  res[0] = result;
+}
+
+void HSum(const float* x, float* res, int n) {
+  int i = 0;
+  float32x4_t vsum = vdupq_n_f32(0.f);
+  for (; i + NEON_FLOAT_BLOCK <= n; i += NEON_FLOAT_BLOCK) {
+    vsum = vaddq_f32(vsum, vld1q_f32(x + i));
+  }
+  float32x2_t half = vpadd_f32(vget_low_f32(vsum), vget_high_f32(vsum));
+  half = vpadd_f32(half, half);
+  float result = vget_lane_f32(half, 0);
+  for (; i < n; ++i) {
+    result += x[i];
+  }
+  res[0] = result;
+}
+
+void SeqPool(const float* x, float* y, const seq_pool_attr_t* attr) {
+  const int w = attr->w;
+  std::memcpy(y, x, sizeof(float) * w);
+  for (int h = 1; h < attr->h; ++h) {
+    VAdd(y, x + h * w, y, w);
+  }
+  if (attr->type == SeqPoolType::kAvg || attr->type == SeqPoolType::kSqrt) {
+    float scalar = 1.f;
+    if (attr->type == SeqPoolType::kAvg) {
+      scalar = scalar / static_cast<float>(attr->h);
+    } else {
+      scalar = scalar / std::sqrt(static_cast<float>(attr->h));
+    }
+    VScal(&scalar, y, y, w);
+  }
+}
+
+void EmbSeqPool(const float* table, const int64_t* idx, float* out,
+                const emb_seq_pool_attr_t* attr) {
+  PADDLE_ENFORCE_EQ(attr->table_width * attr->index_width, attr->out_width);
+  auto check_idx_value_valid = [&](int64_t i) {
+    PADDLE_ENFORCE_LT(idx[i], attr->table_height, "idx value: %d, i: %d",
+                      idx[i], i);
+    PADDLE_ENFORCE_GE(idx[i], 0, "idx value: %d, i: %d", idx[i], i);
+  };
+
+  const int w = static_cast<int>(attr->table_width);
+  for (int64_t j = 0; j != attr->index_width; ++j) {
+    check_idx_value_valid(j);
+    std::memcpy(out + j * w, table + idx[j] * w, sizeof(float) * w);
+  }
+  for (int64_t h = 1; h < attr->index_height; ++h) {
+    for (int64_t j = 0; j < attr->index_width; ++j) {
+      int64_t i = h * attr->index_width + j;
+      check_idx_value_valid(i);
+      VAdd(out + j * w, table + idx[i] * w, out + j * w, w);
+    }
+  }
+}
+
+#undef NEON_FLOAT_BLOCK
+
+// The NEON is always available on the aarch64 CPUs. The small ones are left
+// to refer, which costs no more than the loads of the NEON regs.
+bool MatMulKernel::CanBeUsed(const matmul_attr_t& attr) const {
+  return attr.n >= 4;
+}
+
+bool SeqPoolKernel::CanBeUsed(const seq_pool_attr_t& attr) const {
+  return attr.w >= 4;
+}
+
+bool EmbSeqPoolKernel::CanBeUsed(const emb_seq_pool_attr_t& attr) const {
+  return attr.table_width >= 4 && attr.pool_type == SeqPoolType::kSum;
+}
+
+#define NEON_USE_ME_IF_BLOCK(name) \
+  bool name##Kernel::CanBeUsed(const int& d) const { return d >= 4; }
+
+NEON_USE_ME_IF_BLOCK(VMul);
+NEON_USE_ME_IF_BLOCK(VAdd);
+NEON_USE_ME_IF_BLOCK(VScal);
+NEON_USE_ME_IF_BLOCK(VAddBias);
+NEON_USE_ME_IF_BLOCK(VRelu);
+NEON_USE_ME_IF_BLOCK(VSquare);
+NEON_USE_ME_IF_BLOCK(VExp);
+NEON_USE_ME_IF_BLOCK(HMax);
+NEON_USE_ME_IF_BLOCK(HSum);
+
+#undef NEON_USE_ME_IF_BLOCK
+
+}  // namespace neon
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace neon = paddle::operators::jit::more::neon;
+
+#define REGISTER_NEON_KERNEL(func) \
+  REGISTER_JITKERNEL_MORE(k##func, neon, neon::func##Kernel)
+
+REGISTER_NEON_KERNEL(MatMul);
+REGISTER_NEON_KERNEL(VMul);
+REGISTER_NEON_KERNEL(VAdd);
+REGISTER_NEON_KERNEL(VScal);
+REGISTER_NEON_KERNEL(VAddBias);
+REGISTER_NEON_KERNEL(VRelu);
+REGISTER_NEON_KERNEL(VSquare);
+REGISTER_NEON_KERNEL(VExp);
+REGISTER_NEON_KERNEL(HMax);
+REGISTER_NEON_KERNEL(HSum);
+REGISTER_NEON_KERNEL(SeqPool);
+REGISTER_NEON_KERNEL(EmbSeqPool);
+
+#undef REGISTER_NEON_KERNEL
@@ -0,0 +1,88 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/operators/jit/kernel_base.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace neon {
+
+// The kernels implemented by the NEON intrinsics for the ARM CPUs, on which
+// neither the jitcode nor MKL is available. The LSTM, GRU and the
+// activations of mix are composed of them as well.
+
+void MatMul(const float* a, const float* b, float* c,
+            const matmul_attr_t* attr);
+
+void VMul(const float* x, const float* y, float* z, int n);
+void VAdd(const float* x, const float* y, float* z, int n);
+
+void VScal(const float* a, const float* x, float* y, int n);
+void VAddBias(const float* a, const float* x, float* y, int n);
+
+void VRelu(const float* x, float* y, int n);
+void VSquare(const float* x, float* y, int n);
+void VExp(const float* x, float* y, int n);
+
+void HMax(const float* x, float* res, int n);
+void HSum(const float* x, float* res, int n);
+
+void SeqPool(const float* x, float* y, const seq_pool_attr_t* attr);
+void EmbSeqPool(const float* table, const int64_t* idx, float* out,
+                const emb_seq_pool_attr_t* attr);
+
+#define DECLARE_NEON_KERNEL(name)                                        \
+  class name##Kernel : public KernelMore<name##Tuple<float>> {           \
+   public:                                                               \
+    name##Kernel() { this->func = name; }                                \
+    bool CanBeUsed(const typename name##Tuple<float>::attr_type&) const \
+        override;                                                        \
+    const char* ImplType() const override { return "NEON"; }             \
+  }
+
+// ABCMNK
+DECLARE_NEON_KERNEL(MatMul);
+
+// XYZN
+DECLARE_NEON_KERNEL(VMul);
+DECLARE_NEON_KERNEL(VAdd);
+
+// AXYN
+DECLARE_NEON_KERNEL(VScal);
+DECLARE_NEON_KERNEL(VAddBias);
+
+// XYN
+DECLARE_NEON_KERNEL(VRelu);
+DECLARE_NEON_KERNEL(VSquare);
+DECLARE_NEON_KERNEL(VExp);
+
+// XRN
+DECLARE_NEON_KERNEL(HMax);
+DECLARE_NEON_KERNEL(HSum);
+
+// others
+DECLARE_NEON_KERNEL(SeqPool);
+DECLARE_NEON_KERNEL(EmbSeqPool);
+
+#undef DECLARE_NEON_KERNEL
+
+}  // namespace neon
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
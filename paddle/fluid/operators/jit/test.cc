@@ -1088,6 +1088,30 @@ TEST(JITKernel_helper, GetAllCandidateFuncs) {
   }
 }
 
+TEST(JITKernel_helper, GetAutotunedBestFunc) {
+  std::vector<float> x(20), y(20), tgt(20);
+  RandomVec<float>(20, x.data());
+  RandomVec<float>(20, y.data());
+  auto ref = jit::GetReferFunc<jit::VMulTuple<float>>();
+  ref(x.data(), y.data(), tgt.data(), 20);
+  auto best = jit::GetAutotunedBestFunc<jit::VMulTuple<float>, CPUPlace>(20);
+  std::vector<float> z(20);
+  best(x.data(), y.data(), z.data(), 20);
+  ExpectEQ<float>(z.data(), tgt.data(), 20);
+
+  // the tuned one is reused
+  auto funcs =
+      jit::GetAllCandidateFuncsWithTypes<jit::VMulTuple<float>, CPUPlace>(20);
+  if (funcs.size() > 1UL) {
+    std::string impl_type;
+    auto key = jit::AutotuneKey(jit::kVMul, typeid(float).name(), 20);
+    EXPECT_TRUE(jit::AutotuneCache::Instance().Get(key, &impl_type));
+    EXPECT_TRUE(
+        (jit::GetAutotunedBestFunc<jit::VMulTuple<float>, CPUPlace>(20)) ==
+        best);
+  }
+}
+
 TEST(JITKernel_helper, pack_weights) {
   const int N = 8 * 60, K = 2;
   float src[K][N], yref[K][N], y[K * N];
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/operators/layer_norm_op.h"
+#include "paddle/fluid/operators/reduce_ops/cub_reduce.h"
 
 namespace paddle {
 namespace operators {
@@ -50,8 +51,8 @@ static __device__ __forceinline__ double real_sqrt(double x) { return sqrt(x); }
 
 template <typename T>
 struct PairForLayerNorm {
-  __device__ __forceinline__ PairForLayerNorm() {}
-  __device__ __forceinline__ PairForLayerNorm(const T &first, const T &second)
+  HOSTDEVICE inline PairForLayerNorm() {}
+  HOSTDEVICE inline PairForLayerNorm(const T &first, const T &second)
       : first_(first), second_(second) {}
 
   T first_;
@@ -61,12 +62,23 @@ struct PairForLayerNorm {
 template <typename T>
 struct PairForLayerNormAddFunctor {
   __device__ __forceinline__ PairForLayerNorm<T> operator()(
-      const PairForLayerNorm<T> &p1, const PairForLayerNorm<T> &p2) {
+      const PairForLayerNorm<T> &p1, const PairForLayerNorm<T> &p2) const {
     return PairForLayerNorm<T>(p1.first_ + p2.first_, p1.second_ + p2.second_);
   }
 };
 
-template <typename T, int BlockDim>
+template <typename T>
+struct PairForLayerNormMomentFunctor {
+  __device__ __forceinline__ PairForLayerNorm<double> operator()(
+      const T &x) const {
+    double val = static_cast<double>(x);
+    return PairForLayerNorm<double>(val, val * val);
+  }
+};
+
+// The row of x should be aligned to the vectors of VecSize elements, by
+// which it is loaded to calculate mean and var.
+template <typename T, int BlockDim, int VecSize>
 __global__ void LayerNormForward(const T *x, const T *scale, const T *bias,
                                  T *y, T *mean, T *var, float epsilon,
                                  int feature_size) {
@@ -77,24 +89,20 @@ __global__ void LayerNormForward(const T *x, const T *scale, const T *bias,
   int end_idx = (blockIdx.x + 1) * feature_size;
 
   // Step 1: Reduce to calculate mean and var
-  double mean_val = 0;
-  double var_val = 0;
-  for (int i = beg_idx; i < end_idx; i += BlockDim) {
-    T tmp = x[i];
-    mean_val += tmp;
-    var_val += (tmp * tmp);
-  }
-  auto pair = BlockReduce(temp_storage)
-                  .Reduce(PairForLayerNorm<double>(mean_val, var_val),
-                          PairForLayerNormAddFunctor<double>());
+  auto pair = detail::ThreadReduceRow<T, PairForLayerNorm<double>, VecSize>(
+      x + blockIdx.x * feature_size, feature_size, threadIdx.x, BlockDim,
+      PairForLayerNorm<double>(0, 0), PairForLayerNormAddFunctor<double>(),
+      PairForLayerNormMomentFunctor<T>());
+  pair = BlockReduce(temp_storage)
+             .Reduce(pair, PairForLayerNormAddFunctor<double>());
   if (threadIdx.x == 0) {
     auto tmp = pair.first_ / feature_size;
     mean[blockIdx.x] = static_cast<T>(tmp);
     var[blockIdx.x] = static_cast<T>(pair.second_ / feature_size - tmp * tmp);
   }
   __syncthreads();
-  mean_val = mean[blockIdx.x];
-  var_val = static_cast<T>(real_sqrt(var[blockIdx.x] + epsilon));
+  double mean_val = mean[blockIdx.x];
+  double var_val = static_cast<T>(real_sqrt(var[blockIdx.x] + epsilon));
 
   // Step 2: Calculate y
   if (scale != nullptr) {
@@ -124,87 +132,77 @@ __global__ void LayerNormForward(const T *x, const T *scale, const T *bias,
   }
 }
 
-// Make sure that d_scale != nullptr && d_bias != nullptr
-// Since d_scale != nullptr, scale would not be nullptr
-template <typename T, int BlockDim, bool HasDx>
-__global__ void LayerNormBackwardGradientAll(const T *x, const T *d_y,
-                                             T *d_scale, T *d_bias, T *d_x,
-                                             const T *mean, const T *var,
-                                             const T *scale, float epsilon,
-                                             int batch_size, int feature_size) {
-  using BlockReduce = cub::BlockReduce<PairForLayerNorm<T>, BlockDim>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-
-  int beg_idx = threadIdx.x * feature_size + blockIdx.x;
-  int end_idx = batch_size * feature_size + blockIdx.x;
-  int stride = BlockDim * feature_size;
-
-  T d_scale_partial = 0, d_bias_partial = 0;
-
-  for (int i = beg_idx; i < end_idx; i += stride) {
-    int row_idx = i / feature_size;
-    auto var_val = static_cast<T>(real_sqrt(var[row_idx] + epsilon));
-    d_scale_partial += d_y[i] * (x[i] - mean[row_idx]) / var_val;
-    d_bias_partial += d_y[i];
-    if (HasDx) {
-      d_x[i] = d_y[i] * scale[blockIdx.x] / var_val;
+template <typename T>
+static void LayerNormForwardCUDA(const T *x, const T *scale, const T *bias,
+                                 T *y, T *mean, T *var, float epsilon,
+                                 int batch_size, int feature_size,
+                                 cudaStream_t stream) {
+  constexpr int kVecSize = detail::GetVectorSize<T>();
+  bool use_vector =
+      feature_size % kVecSize == 0 &&
+      reinterpret_cast<uintptr_t>(x) % (sizeof(T) * kVecSize) == 0;
+  if (use_vector) {
+    switch (GetDesiredBlockDim(feature_size)) {
+      FIXED_BLOCK_DIM_CASE(
+          LayerNormForward<T, kBlockDim,
+                           kVecSize><<<batch_size, kBlockDim, 0, stream>>>(
+              x, scale, bias, y, mean, var, epsilon, feature_size));
+      default:
+        PADDLE_THROW(platform::errors::InvalidArgument(
+            "Product from begin_norm_axis to end in layer_norm must be "
+            "larger than 1"));
+        break;
+    }
+  } else {
+    switch (GetDesiredBlockDim(feature_size)) {
+      FIXED_BLOCK_DIM_CASE(
+          LayerNormForward<T, kBlockDim,
+                           1><<<batch_size, kBlockDim, 0, stream>>>(
+              x, scale, bias, y, mean, var, epsilon, feature_size));
+      default:
+        PADDLE_THROW(platform::errors::InvalidArgument(
+            "Product from begin_norm_axis to end in layer_norm must be "
+            "larger than 1"));
+        break;
     }
-  }
-
-  auto pair = BlockReduce(temp_storage)
-                  .Reduce(PairForLayerNorm<T>(d_scale_partial, d_bias_partial),
-                          PairForLayerNormAddFunctor<T>());
-
-  if (threadIdx.x == 0) {
-    d_scale[blockIdx.x] = pair.first_;
-    d_bias[blockIdx.x] = pair.second_;
   }
 }
 
-// Make sure that there is only one true expression: d_scale != nullptr
-// or d_bias != nullptr
-// Notice: scale may be nullptr
-template <typename T, int BlockDim, bool HasDx, bool HasDScale>
-__global__ void LayerNormBackwardGradientScaleOrBias(
-    const T *x, const T *d_y, T *d_scale, T *d_bias, T *d_x, const T *mean,
-    const T *var, const T *scale, float epsilon, int batch_size,
-    int feature_size) {
-  using BlockReduce = cub::BlockReduce<T, BlockDim>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-  int beg_idx = threadIdx.x * feature_size + blockIdx.x;
-  int end_idx = batch_size * feature_size + blockIdx.x;
-  int stride = BlockDim * feature_size;
-  T d_scale_or_d_bias_partial = 0;
-
-  for (int i = beg_idx; i < end_idx; i += stride) {
-    int row_idx = i / feature_size;
-    auto var_val = static_cast<T>(real_sqrt(var[row_idx] + epsilon));
-    if (HasDScale) {
-      d_scale_or_d_bias_partial += d_y[i] * (x[i] - mean[row_idx]) / var_val;
-    } else {  // d_bias != nullptr
-      d_scale_or_d_bias_partial += d_y[i];
-    }
-
-    if (HasDx) {
-      if (scale != nullptr) {
-        d_x[i] = d_y[i] * scale[blockIdx.x] / var_val;
-      } else {
-        d_x[i] = d_y[i] / var_val;
-      }
+// Load the terms of d_scale and d_bias of x[j][k] of [batch, feature]
+template <typename T>
+struct LayerNormScaleBiasGradLoader {
+  __device__ __forceinline__ PairForLayerNorm<T> operator()(int i, int j,
+                                                            int k) const {
+    int idx = j * feature_size + k;
+    T d_scale_val = 0;
+    if (has_d_scale) {
+      auto var_val = static_cast<T>(real_sqrt(var[j] + epsilon));
+      d_scale_val = d_y[idx] * (x[idx] - mean[j]) / var_val;
     }
+    return PairForLayerNorm<T>(d_scale_val, d_y[idx]);
   }
 
-  d_scale_or_d_bias_partial =
-      BlockReduce(temp_storage).Reduce(d_scale_or_d_bias_partial, cub::Sum());
+  const T *x;
+  const T *d_y;
+  const T *mean;
+  const T *var;
+  float epsilon;
+  int feature_size;
+  bool has_d_scale;
+};
 
-  if (threadIdx.x == 0) {
-    if (HasDScale) {
-      d_scale[blockIdx.x] = d_scale_or_d_bias_partial;
-    } else {
-      d_bias[blockIdx.x] = d_scale_or_d_bias_partial;
-    }
+// Notice: d_scale or d_bias may be nullptr
+template <typename T>
+struct LayerNormScaleBiasGradStorer {
+  __device__ __forceinline__ void operator()(
+      int idx, const PairForLayerNorm<T> &val) const {
+    if (d_scale != nullptr) d_scale[idx] = val.first_;
+    if (d_bias != nullptr) d_bias[idx] = val.second_;
   }
-}
+
+  T *d_scale;
+  T *d_bias;
+};
 
 template <typename T, int BlockDim>
 __global__ void LayerNormBackwardPostProcessToCalculateDX(const T *x, T *d_x,
@@ -320,7 +318,8 @@ template <typename T>
 static void LayerNormBackward(const T *x, const T *d_y, const T *scale,
                               const T *mean, const T *var, T *d_x, T *d_scale,
                               T *d_bias, float epsilon, int batch_size,
-                              int feature_size, cudaStream_t stream) {
+                              int feature_size, const platform::Place &place,
+                              cudaStream_t stream) {
   const int kMaxBlockDim = 512;
   int gradient_flag = ((d_x != nullptr ? 1 : 0) << 2) |
                       ((d_scale != nullptr ? 1 : 0) << 1) |
@@ -343,90 +342,23 @@ static void LayerNormBackward(const T *x, const T *d_y, const T *scale,
     return;
   }
 
-  auto block_dim = GetDesiredBlockDim(batch_size);
-  switch (gradient_flag) {
-    case 1:  // d_x == nulptr, d_scale == nullptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, false,
-                             false><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      break;
-    case 2:  // d_x == nullptr, d_scale != nullptr, d_bias == nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, false,
-                             true><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      break;
-    case 3:  // d_x == nullptr, d_scale != nulptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardGradientAll<
-                T, kBlockDim, false><<<feature_size, kBlockDim, 0, stream>>>(
-                x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon,
-                batch_size, feature_size));
-      }
-      break;
-    case 4:  // d_x != nullptr, d_scale == nullptr, d_bias == nullptr
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardGradientOnlyDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_y, d_x, mean, var, scale, epsilon, feature_size));
-      }
-      break;
-    case 5:  // d_x != nulptr, d_scale == nullptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, true,
-                             false><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardPostProcessToCalculateDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_x, mean, var, epsilon, feature_size));
-      }
-      break;
-    case 6:  // d_x != nullptr, d_scale != nullptr, d_bias == nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, true,
-                             true><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardPostProcessToCalculateDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_x, mean, var, epsilon, feature_size));
-      }
-      break;
-    case 7:  // d_x != nullptr, d_scale != nullptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardGradientAll<
-                T, kBlockDim, true><<<feature_size, kBlockDim, 0, stream>>>(
-                x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon,
-                batch_size, feature_size));
-      }
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardPostProcessToCalculateDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_x, mean, var, epsilon, feature_size));
-      }
-      break;
-    default:
-      break;
+  // d_scale and d_bias are reduced over the batch by the threads along the
+  // features, whose loads are coalesced. d_x is calculated row by row.
+  if (d_scale != nullptr || d_bias != nullptr) {
+    ReduceHigherDim(place, stream, 1, batch_size, feature_size,
+                    PairForLayerNorm<T>(0, 0), PairForLayerNormAddFunctor<T>(),
+                    LayerNormScaleBiasGradLoader<T>{x, d_y, mean, var, epsilon,
+                                                    feature_size,
+                                                    d_scale != nullptr},
+                    LayerNormScaleBiasGradStorer<T>{d_scale, d_bias});
+  }
+  if (d_x != nullptr) {
+    switch (GetDesiredBlockDim(feature_size)) {
+      FIXED_BLOCK_DIM_CASE(
+          LayerNormBackwardGradientOnlyDX<
+              T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
+              x, d_y, d_x, mean, var, scale, epsilon, feature_size));
+    }
   }
 }
 
@@ -441,16 +373,8 @@ void LayerNormDirectCUDAFunctor<T>::operator()(cudaStream_t stream,
   auto matrix_dim = framework::flatten_to_2d(x_dims, begin_norm_axis);
   int batch_size = static_cast<int>(matrix_dim[0]);
   int feature_size = static_cast<int>(matrix_dim[1]);
-  switch (GetDesiredBlockDim(feature_size)) {
-    FIXED_BLOCK_DIM_CASE(
-        LayerNormForward<T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-            input, scale, bias, output, mean, variance, eps, feature_size));
-    default:
-      PADDLE_THROW(platform::errors::InvalidArgument(
-          "Product from begin_norm_axis to end in layer_norm must be larger "
-          "than 1"));
-      break;
-  }
+  LayerNormForwardCUDA<T>(input, scale, bias, output, mean, variance, eps,
+                          batch_size, feature_size, stream);
 }
 
 template <typename T>
@@ -482,16 +406,9 @@ class LayerNormKernel<platform::CUDADeviceContext, T>
 
     auto stream = ctx.cuda_device_context().stream();
 
-    switch (GetDesiredBlockDim(feature_size)) {
-      FIXED_BLOCK_DIM_CASE(
-          LayerNormForward<T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-              x_data, scale_data, bias_data, y_data, mean_data, var_data,
-              epsilon, feature_size));
-      default:
-        PADDLE_THROW(
-            "Product from begin_norm_axis to end must be larger than 1");
-        break;
-    }
+    LayerNormForwardCUDA<T>(x_data, scale_data, bias_data, y_data, mean_data,
+                            var_data, epsilon, batch_size, feature_size,
+                            stream);
   }
 };
 
@@ -535,7 +452,7 @@ class LayerNormGradKernel<platform::CUDADeviceContext, T>
 
     LayerNormBackward<T>(x_data, d_y_data, scale_data, mean_data, var_data,
                          d_x_data, d_scale_data, d_bias_data, epsilon,
-                         batch_size, feature_size, stream);
+                         batch_size, feature_size, ctx.GetPlace(), stream);
   }
 };
 template class LayerNormDirectCUDAFunctor<float>;
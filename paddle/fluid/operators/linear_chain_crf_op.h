@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <map>
+#include <mutex>  // NOLINT
+#include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/sequence_parallel.h"
 
 namespace paddle {
 namespace operators {
@@ -50,6 +54,39 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// The rows [starts[i], ends[i]) of the i-th sequence, either of the LoD or
+// of the lengths of the padded sequences. offsets are the accumulated
+// lengths, by which the sequences are balanced in ParallelForSequences.
+struct CRFSequences {
+  CRFSequences(const framework::ExecutionContext& ctx, int64_t max_len) {
+    if (ctx.HasInput("Length")) {
+      const Tensor* length = ctx.Input<framework::Tensor>("Length");
+      const int64_t* length_data = length->data<int64_t>();
+      for (int64_t i = 0; i < length->numel(); ++i) {
+        starts.push_back(i * max_len);
+        ends.push_back(i * max_len + length_data[i]);
+      }
+    } else {
+      auto& lod = ctx.Input<LoDTensor>("Label")->lod();
+      PADDLE_ENFORCE_NE(lod.size(), 0, "Input(Label) must be a sequence.");
+      for (size_t i = 0; i + 1 < lod[0].size(); ++i) {
+        starts.push_back(static_cast<int64_t>(lod[0][i]));
+        ends.push_back(static_cast<int64_t>(lod[0][i + 1]));
+      }
+    }
+    offsets.push_back(0);
+    for (size_t i = 0; i < starts.size(); ++i) {
+      offsets.push_back(offsets.back() + (ends[i] - starts[i]));
+    }
+  }
+
+  size_t size() const { return starts.size(); }
+
+  std::vector<int64_t> starts;
+  std::vector<int64_t> ends;
+  std::vector<size_t> offsets;
+};
+
 template <typename DeviceContext, typename T>
 class LinearChainCRFOpKernel : public framework::OpKernel<T> {
  public:
@@ -78,11 +115,8 @@ class LinearChainCRFOpKernel : public framework::OpKernel<T> {
     int64_t seq_num = 0;
     int64_t batch_size;
     int64_t tag_num;
-    const int64_t* length_data = nullptr;
-    framework::LoD in_lod;
     if (ctx.HasInput("Length")) {
       const Tensor* label_length = ctx.Input<framework::Tensor>("Length");
-      length_data = label_length->data<int64_t>();
       seq_num = label_length->numel();
       PADDLE_ENFORCE_EQ(seq_num, emission_dims[0],
                         "the size of Input(length) must be equal to "
@@ -101,12 +135,13 @@ class LinearChainCRFOpKernel : public framework::OpKernel<T> {
       math::set_constant(ctx.device_context(), emission_exps, 0.0);
       math::set_constant(ctx.device_context(), alpha, 0.0);
     } else {
-      in_lod = ctx.Input<LoDTensor>("Label")->lod();
+      auto& in_lod = ctx.Input<LoDTensor>("Label")->lod();
       PADDLE_ENFORCE_NE(in_lod.size(), 0, "Input(Label) must be a sequence.");
       seq_num = in_lod[0].size() - 1;
       batch_size = emission_dims[0];
       tag_num = emission_dims[1];
     }
+    CRFSequences seqs(ctx, ctx.HasInput("Length") ? emission_dims[1] : 0);
 
     // Resize the output tensor to its correct dimension.
     ll->Resize({seq_num, 1});
@@ -130,30 +165,31 @@ class LinearChainCRFOpKernel : public framework::OpKernel<T> {
     auto w_exps = EigenMatrix<T>::From(*transition_exps);
     w_exps.device(place) = w.exp();
     T* log_likelihood = ll->data<T>();
-    for (int64_t i = 0; i < seq_num; ++i) {
-      int64_t start_pos = 0;
-      int64_t end_pos = 0;
-      if (ctx.HasInput("Length")) {
-        start_pos = i * emission_dims[1];
-        end_pos = start_pos + length_data[i];
-      } else {
-        start_pos = static_cast<int64_t>(in_lod[0][i]);
-        end_pos = static_cast<int64_t>(in_lod[0][i + 1]);
-      }
-      if (end_pos == start_pos) {
-        // If an empty input sequence is given, pad 0 for its cost.
-        log_likelihood[i] = 0.;
-        continue;
-      }
-      const Tensor one_seq = emission_weights_tmp.Slice(start_pos, end_pos);
-      Tensor one_seq_row_max = emission_row_max.Slice(start_pos, end_pos);
-      Tensor one_seq_exps = emission_exps_tmp.Slice(start_pos, end_pos);
-      const Tensor one_seq_label = label_tmp.Slice(start_pos, end_pos);
-      Tensor one_seq_alpha = alpha_tmp.Slice(start_pos, end_pos);
-      log_likelihood[i] = ForwardOneSequence(
-          one_seq, one_seq_row_max, one_seq_exps, *transition_weights,
-          *transition_exps, one_seq_label, &one_seq_alpha);
-    }
+    // The sequences are independent, and each writes its own rows of the
+    // outputs.
+    math::ParallelForSequences(
+        seqs.offsets.data(), seqs.size(), tag_num * tag_num,
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            int64_t start_pos = seqs.starts[i];
+            int64_t end_pos = seqs.ends[i];
+            if (end_pos == start_pos) {
+              // If an empty input sequence is given, pad 0 for its cost.
+              log_likelihood[i] = 0.;
+              continue;
+            }
+            const Tensor one_seq =
+                emission_weights_tmp.Slice(start_pos, end_pos);
+            Tensor one_seq_row_max =
+                emission_row_max.Slice(start_pos, end_pos);
+            Tensor one_seq_exps = emission_exps_tmp.Slice(start_pos, end_pos);
+            const Tensor one_seq_label = label_tmp.Slice(start_pos, end_pos);
+            Tensor one_seq_alpha = alpha_tmp.Slice(start_pos, end_pos);
+            log_likelihood[i] = ForwardOneSequence(
+                one_seq, one_seq_row_max, one_seq_exps, *transition_weights,
+                *transition_exps, one_seq_label, &one_seq_alpha);
+          }
+        });
   };
 
  private:
@@ -182,13 +218,21 @@ class LinearChainCRFOpKernel : public framework::OpKernel<T> {
     T ll = -x_row_max[0] - std::log(NormalizeL1<T>(alpha_value, tag_num));
 
     for (size_t k = 1; k < seq_length; ++k) {
-      for (size_t i = 0; i < tag_num; ++i) {
-        T sum = 0.;
-        for (size_t j = 0; j < tag_num; ++j) {
-          sum += alpha_value[(k - 1) * tag_num + j] *  // (*)
-                 w_exps[(j + state_trans_base_idx) * tag_num + i];
+      // The rows of w_exps are added up in the inner loop, which is over the
+      // contiguous memory and vectorized, in the same order of j as the sum
+      // of each tag.
+      const T* prev = alpha_value + (k - 1) * tag_num;
+      T* cur = alpha_value + k * tag_num;
+      std::fill(cur, cur + tag_num, static_cast<T>(0));
+      for (size_t j = 0; j < tag_num; ++j) {
+        const T a = prev[j];  // (*)
+        const T* w_row = w_exps + (j + state_trans_base_idx) * tag_num;
+        for (size_t i = 0; i < tag_num; ++i) {
+          cur[i] += a * w_row[i];
         }
-        alpha_value[k * tag_num + i] = x_exps[k * tag_num + i] * sum;
+      }
+      for (size_t i = 0; i < tag_num; ++i) {
+        cur[i] *= x_exps[k * tag_num + i];
       }
       // NormalizeL1 is to avoid underflow or overflow at (*).
       ll -= x_row_max[k] +
@@ -236,14 +280,7 @@ class LinearChainCRFGradOpKernel : public framework::OpKernel<T> {
     Tensor label_tmp = *label;
     Tensor emission_exps_tmp = *emission_exps;
     Tensor emission_grad_tmp = *emission_grad;
-    // getting seq_num  using padding or not
-    int64_t seq_num = 0;
-    framework::LoD in_lod;
-    const int64_t* length_data = nullptr;
     if (ctx.HasInput("Length")) {
-      const Tensor* label_length = ctx.Input<framework::Tensor>("Length");
-      length_data = label_length->data<int64_t>();
-      seq_num = label_length->numel();
       auto emission_dims = emission_grad->dims();
       auto label_dims = label->dims();
       emission_grad_tmp.Resize(
@@ -252,11 +289,9 @@ class LinearChainCRFGradOpKernel : public framework::OpKernel<T> {
       alpha_tmp.Resize({emission_dims[0] * emission_dims[1], emission_dims[2]});
       emission_exps_tmp.Resize(
           {emission_dims[0] * emission_dims[1], emission_dims[2]});
-    } else {
-      in_lod = ctx.Input<LoDTensor>("Label")->lod();
-      PADDLE_ENFORCE_NE(in_lod.size(), 0, "Input(Label) must be a sequence.");
-      seq_num = static_cast<int64_t>(in_lod[0].size() - 1);
     }
+    CRFSequences seqs(
+        ctx, ctx.HasInput("Length") ? emission_grad->dims()[1] : 0);
 
     Tensor* transition_grad =
         ctx.Output<Tensor>(framework::GradVarName("Transition"));
@@ -279,31 +314,54 @@ class LinearChainCRFGradOpKernel : public framework::OpKernel<T> {
       beta.Resize({emission_dims[0] * emission_dims[1], emission_dims[2]});
     }
 
-    for (int64_t i = 0; i < seq_num; ++i) {
-      int64_t start_pos = 0;
-      int64_t end_pos = 0;
-      if (ctx.HasInput("Length")) {
-        start_pos = i * emission_dims[1];
-        end_pos = start_pos + length_data[i];
-      } else {
-        start_pos = static_cast<int64_t>(in_lod[0][i]);
-        end_pos = static_cast<int64_t>(in_lod[0][i + 1]);
-      }
-
-      if (end_pos == start_pos) {
-        continue;
+    // Each chunk of the sequences adds up the gradient of the transitions
+    // of its own, which are summed up in the order of the chunks, so that
+    // the result does not depend on the scheduling of the threads.
+    std::map<size_t, Tensor> chunk_transition_grads;
+    std::mutex mutex;
+    auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    int64_t tag_num = emission_dims[emission_dims.size() - 1];
+    math::ParallelForSequences(
+        seqs.offsets.data(), seqs.size(), tag_num * tag_num,
+        [&](size_t begin, size_t end) {
+          Tensor chunk_transition_grad;
+          if (transition_grad) {
+            chunk_transition_grad.mutable_data<T>(transition_grad->dims(),
+                                                  platform::CPUPlace());
+            math::set_constant(dev_ctx, &chunk_transition_grad, 0.);
+          }
+          for (size_t i = begin; i < end; ++i) {
+            int64_t start_pos = seqs.starts[i];
+            int64_t end_pos = seqs.ends[i];
+            if (end_pos == start_pos) {
+              continue;
+            }
+            const Tensor one_seq_emission_exps =
+                emission_exps_tmp.Slice(start_pos, end_pos);
+            const Tensor one_seq_label = label_tmp.Slice(start_pos, end_pos);
+            const Tensor one_seq_alpha = alpha_tmp.Slice(start_pos, end_pos);
+            Tensor one_seq_beta = beta.Slice(start_pos, end_pos);
+            Tensor one_seq_emission_grad =
+                emission_grad_tmp.Slice(start_pos, end_pos);
+            BackwardOneSequence(
+                dev_ctx, ll_grad[i], one_seq_emission_exps, *transition_exps,
+                one_seq_alpha, one_seq_label, &one_seq_beta,
+                transition_grad ? &chunk_transition_grad : nullptr,
+                &one_seq_emission_grad);
+          }
+          if (transition_grad) {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunk_transition_grads[begin] = chunk_transition_grad;
+          }
+        });
+    if (transition_grad) {
+      T* trans_grad = transition_grad->data<T>();
+      for (auto& pair : chunk_transition_grads) {
+        const T* chunk_grad = pair.second.data<T>();
+        for (int64_t i = 0; i < transition_grad->numel(); ++i) {
+          trans_grad[i] += chunk_grad[i];
+        }
       }
-      const Tensor one_seq_emission_exps =
-          emission_exps_tmp.Slice(start_pos, end_pos);
-      const Tensor one_seq_label = label_tmp.Slice(start_pos, end_pos);
-      const Tensor one_seq_alpha = alpha_tmp.Slice(start_pos, end_pos);
-      Tensor one_seq_beta = beta.Slice(start_pos, end_pos);
-      Tensor one_seq_emission_grad =
-          emission_grad_tmp.Slice(start_pos, end_pos);
-      BackwardOneSequence(
-          ctx.template device_context<platform::CPUDeviceContext>(), ll_grad[i],
-          one_seq_emission_exps, *transition_exps, one_seq_alpha, one_seq_label,
-          &one_seq_beta, transition_grad, &one_seq_emission_grad);
     }
   };
 
@@ -329,13 +387,19 @@ class LinearChainCRFGradOpKernel : public framework::OpKernel<T> {
       beta_value[(seq_length - 1) * tag_num + i] = w_exps[tag_num + i];
     }
     NormalizeL1<T>(beta_value + (seq_length - 1) * tag_num, tag_num);
+    // the products of x_exps and beta of the next position, shared by the
+    // sums of all the tags
+    std::vector<T> next_prob(tag_num);
     for (int k = static_cast<int>(seq_length) - 2; k >= 0; --k) {
+      for (size_t j = 0; j < tag_num; ++j) {
+        next_prob[j] =
+            x_exps[(k + 1) * tag_num + j] * beta_value[(k + 1) * tag_num + j];
+      }
       for (size_t i = 0; i < tag_num; ++i) {
+        const T* w_row = w_exps + (i + state_trans_base_idx) * tag_num;
         T sum = 0.;
         for (size_t j = 0; j < tag_num; ++j) {
-          sum += w_exps[(i + state_trans_base_idx) * tag_num + j] *  // (**)
-                 x_exps[(k + 1) * tag_num + j] *
-                 beta_value[(k + 1) * tag_num + j];
+          sum += w_row[j] * next_prob[j];  // (**)
         }
         beta_value[k * tag_num + i] = sum;
       }
@@ -42,6 +42,7 @@ class LiteEngineOp : public framework::OperatorBase {
   paddle::lite::Predictor *engine_;
   framework::proto::VarType::Type precision_;
   bool use_gpu_;
+  bool zero_copy_;
 
  public:
   LiteEngineOp(const std::string &type,
@@ -60,6 +61,7 @@ class LiteEngineOp : public framework::OperatorBase {
       precision_ = framework::proto::VarType_Type_FP32;
     }
     use_gpu_ = Attr<bool>("use_gpu");
+    zero_copy_ = HasAttr("zero_copy") && Attr<bool>("zero_copy");
   }
 
  protected:
@@ -77,6 +79,12 @@ class LiteEngineOp : public framework::OperatorBase {
           inference::analysis::GetFromScope<framework::LoDTensor>(scope,
                                                                   in_names_[i]);
       paddle::lite::Tensor *dst_t = engine_->GetInput(i);
+      if (zero_copy_) {
+        VLOG(3) << "[Share] fluid -> lite (" << in_names_[i] << " -> "
+                << engine_->GetInputNames()[i] << ")";
+        inference::lite::utils::TensorDataShare(dst_t, src_t);
+        continue;
+      }
       VLOG(3) << "[Copy] fluid -> lite (" << in_names_[i] << " -> "
               << engine_->GetInputNames()[i] << ")";
       inference::lite::utils::TensorCopyAsync(dst_t, src_t, *ctx);
@@ -95,6 +103,14 @@ class LiteEngineOp : public framework::OperatorBase {
       framework::LoDTensor *dst_t =
           &inference::analysis::GetFromScope<framework::LoDTensor>(
               scope, out_names_[i]);
+      // The outputs shared with Lite are valid until the engine runs again,
+      // as the outputs of the other ops of the program are.
+      if (zero_copy_) {
+        VLOG(3) << "[Share] lite -> fluid (" << out_names_[i] << " -> "
+                << engine_->GetOutputNames()[i] << ")";
+        inference::lite::utils::TensorDataShare(dst_t, src_t);
+        continue;
+      }
       VLOG(3) << "[Copy] lite -> fluid (" << out_names_[i] << " -> "
               << engine_->GetOutputNames()[i] << ")";
       inference::lite::utils::TensorCopyAsync(dst_t, src_t, *ctx);
@@ -59,6 +59,14 @@ class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
                   "If true, file_path is in memory, and LoDTensors will be "
                   "loaded directly from memory")
         .SetDefault(false);
+    AddAttr<bool>("use_mmap",
+                  "(boolean, default false)"
+                  "If true, the file is memory mapped, and the LoDTensors "
+                  "loaded on CPU share the mapped memory rather than copy "
+                  "it, so that the processes loading the same file share one "
+                  "physical copy of it. The pages written are copied, and the "
+                  "file is never modified.")
+        .SetDefault(false);
     AddComment(R"DOC(
 LoadCombine Operator.
 
@@ -14,17 +14,28 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/io/async_checkpoint.h"
 #include "paddle/fluid/framework/op_registry.h"
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace operators {
+
+// the threads reading the indexed tensors file
+constexpr int kLoadCombineNumThreads = 8;
+
 template <typename DeviceContext, typename T>
 class LoadCombineOpKernel : public framework::OpKernel<T> {
  public:
@@ -33,11 +44,39 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     auto filename = ctx.Attr<std::string>("file_path");
     auto load_as_fp16 = ctx.Attr<bool>("load_as_fp16");
     auto model_from_memory = ctx.Attr<bool>("model_from_memory");
+    auto use_mmap = ctx.Attr<bool>("use_mmap");
     auto out_var_names = ctx.OutputNames("Out");
+    if (!model_from_memory) {
+      // the file may be being written by the async save_combine_op
+      framework::AsyncCheckpointWriter::Instance().Wait();
+    }
 
     PADDLE_ENFORCE_GT(
         static_cast<int>(out_var_names.size()), 0,
         "The number of output variables should be greater than 0.");
+    bool is_indexed =
+        model_from_memory
+            ? framework::IsIndexedTensorsBuffer(filename.data(),
+                                                filename.size())
+            : framework::IsIndexedTensorsFile(filename);
+    if (is_indexed) {
+      LoadParamsFromIndexed(ctx, place, filename, model_from_memory, use_mmap,
+                            load_as_fp16, out_var_names);
+      return;
+    }
+#ifndef _WIN32
+    // the tensors on the other devices, or converted to float16, are copied
+    // anyway
+    if (use_mmap && !model_from_memory && !load_as_fp16 &&
+        platform::is_cpu_place(place)) {
+      LoadParamsFromMappedFile(ctx, filename, out_var_names);
+      return;
+    }
+#endif
+    if (use_mmap) {
+      VLOG(3) << "OP(LoadCombine) copies the parameters of " << filename
+              << " rather than sharing the mapping";
+    }
     if (!model_from_memory) {
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE(static_cast<bool>(fin),
@@ -55,6 +94,75 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     }
   }
 
+  void LoadParamsFromIndexed(
+      const framework::ExecutionContext &context, const platform::Place &place,
+      const std::string &filename, bool model_from_memory, bool use_mmap,
+      bool load_as_fp16, const std::vector<std::string> &out_var_names) const {
+    auto out_vars = context.MultiOutputVar("Out");
+    std::vector<framework::LoDTensor *> tensors;
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i], platform::errors::NotFound(
+                           "Output variable %s cannot be found.",
+                           out_var_names[i]));
+      tensors.push_back(out_vars[i]->GetMutable<framework::LoDTensor>());
+    }
+
+    if (model_from_memory) {
+      auto buffer = memory::AllocShared(platform::CPUPlace(), filename.size());
+      std::memcpy(buffer->ptr(), filename.data(), filename.size());
+      framework::DeserializeIndexedFromMemory(buffer, tensors);
+      if (!platform::is_cpu_place(place)) {
+        for (auto *tensor : tensors) {
+          framework::Tensor copied;
+          framework::TensorCopySync(*tensor, place, &copied);
+          tensor->ShareDataWith(copied);
+        }
+      }
+#ifndef _WIN32
+    } else if (use_mmap && platform::is_cpu_place(place)) {
+      std::shared_ptr<memory::Allocation> mapping =
+          memory::allocation::AllocateMemoryMapFileAllocation(filename);
+      framework::DeserializeIndexedFromMemory(mapping, tensors);
+#endif
+    } else {
+      int num_threads = std::min<int>(
+          kLoadCombineNumThreads,
+          std::max<unsigned>(1, std::thread::hardware_concurrency()));
+      framework::DeserializeIndexedFromFile(filename, tensors, place,
+                                            num_threads);
+    }
+
+    if (load_as_fp16) {
+      for (auto *var : out_vars) {
+        TransToFP16(place, var);
+      }
+    }
+  }
+
+#ifndef _WIN32
+  void LoadParamsFromMappedFile(
+      const framework::ExecutionContext &context, const std::string &filename,
+      const std::vector<std::string> &out_var_names) const {
+    std::shared_ptr<memory::Allocation> mapping =
+        memory::allocation::AllocateMemoryMapFileAllocation(filename);
+    auto out_vars = context.MultiOutputVar("Out");
+    size_t offset = 0;
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i], platform::errors::NotFound(
+                           "Output variable %s cannot be found.",
+                           out_var_names[i]));
+      auto *tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
+      framework::DeserializeFromMemory(mapping, &offset, tensor);
+    }
+    PADDLE_ENFORCE_EQ(offset, mapping->size(),
+                      platform::errors::InvalidArgument(
+                          "You are not allowed to load partial data via "
+                          "load_combine_op, use load_op instead."));
+  }
+#endif
+
   void LoadParamsFromBuffer(
       const framework::ExecutionContext &context, const platform::Place &place,
       std::istream *buffer, bool load_as_fp16,
@@ -78,25 +186,8 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
       // Get data from fin to tensor
       DeserializeFromStream(*buffer, tensor, dev_ctx);
 
-      auto in_dtype = tensor->type();
-      auto out_dtype =
-          load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-      if (in_dtype != out_dtype) {
-        // convert to float16 tensor
-        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor fp16_tensor;
-        // copy LoD info to the new tensor
-        fp16_tensor.set_lod(tensor->lod());
-        framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
-                                 &fp16_tensor);
-
-        // reset output tensor
-        out_vars[i]->Clear();
-        tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
-        tensor->set_lod(fp16_tensor.lod());
-        tensor->ShareDataWith(fp16_tensor);
+      if (load_as_fp16) {
+        TransToFP16(place, out_vars[i]);
       }
     }
     buffer->peek();
@@ -104,6 +195,30 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                    "You are not allowed to load partial data via "
                    "load_combine_op, use load_op instead.");
   }
+
+  void TransToFP16(const platform::Place &place,
+                   framework::Variable *var) const {
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    auto in_dtype = tensor->type();
+    auto out_dtype = framework::proto::VarType::FP16;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+      auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+      framework::LoDTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
+                               &fp16_tensor);
+
+      // reset output tensor
+      var->Clear();
+      tensor = var->GetMutable<framework::LoDTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
+    }
+  }
 };
 
 }  // namespace operators
@@ -53,6 +53,18 @@ class LoadOpProtoMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<std::vector<int64_t>>("shape",
                                   "(vector<int64_t>) The shape of the output")
         .SetDefault({});
+    AddAttr<std::vector<std::string>>(
+        "delta_file_paths",
+        "(vector<string>) The delta checkpoints of the SelectedRows table "
+        "saved by checkpoint_notify after the one in \"file_path\", whose "
+        "rows are merged into the loaded table in order.")
+        .SetDefault({});
+    AddAttr<bool>(
+        "use_mmap",
+        "(bool, default false) If true, the LoDTensor loaded on CPU shares "
+        "the pages of the privately memory mapped file rather than copies "
+        "it, see the use_mmap attribute of load_combine_op.")
+        .SetDefault(false);
     AddComment(
         "Load operator will load a LoDTensor / SelectedRows variable from "
         "disk "
@@ -14,12 +14,18 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/io/async_checkpoint.h"
 #include "paddle/fluid/framework/op_registry.h"
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -33,6 +39,8 @@ class LoadOpKernel : public framework::OpKernel<T> {
     // FIXME(yuyang18): We save variable to local file now, but we should change
     // it to save an output stream.
     auto filename = ctx.Attr<std::string>("file_path");
+    // the file may be being written by the async save_op
+    framework::AsyncCheckpointWriter::Instance().Wait();
     std::ifstream fin(filename, std::ios::binary);
     PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s for load op",
                    filename);
@@ -46,9 +54,23 @@ class LoadOpKernel : public framework::OpKernel<T> {
     PADDLE_ENFORCE(out_var != nullptr, "Output variable cannot be found ");
 
     if (out_var->IsType<framework::LoDTensor>()) {
+#ifndef _WIN32
+      // the tensors on the other devices, or converted to float16, are
+      // copied anyway
+      if (ctx.Attr<bool>("use_mmap") && platform::is_cpu_place(place) &&
+          ctx.Attr<int64_t>("seek") == -1 && !ctx.Attr<bool>("load_as_fp16")) {
+        LoadMappedLodTensor(filename, out_var);
+        return;
+      }
+#endif
       LoadLodTensor(fin, place, out_var, ctx);
     } else if (out_var->IsType<framework::SelectedRows>()) {
       LoadSelectedRows(fin, place, out_var);
+      auto delta_paths = ctx.Attr<std::vector<std::string>>("delta_file_paths");
+      if (!delta_paths.empty()) {
+        MergeTableDeltas(delta_paths, place,
+                         out_var->GetMutable<framework::SelectedRows>());
+      }
     } else {
       PADDLE_ENFORCE(
           false,
@@ -99,6 +121,17 @@ class LoadOpKernel : public framework::OpKernel<T> {
     }
   }
 
+#ifndef _WIN32
+  void LoadMappedLodTensor(const std::string &filename,
+                           framework::Variable *var) const {
+    std::shared_ptr<memory::Allocation> mapping =
+        memory::allocation::AllocateMemoryMapFileAllocation(filename);
+    size_t offset = 0;
+    framework::DeserializeFromMemory(
+        mapping, &offset, var->GetMutable<framework::LoDTensor>());
+  }
+#endif
+
   void LoadSelectedRows(std::istream &fin, const platform::Place &place,
                         framework::Variable *var) const {
     auto *selectedRows = var->GetMutable<framework::SelectedRows>();
@@ -108,6 +141,70 @@ class LoadOpKernel : public framework::OpKernel<T> {
     framework::DeserializeFromStream(fin, selectedRows, dev_ctx);
     selectedRows->SyncIndex();
   }
+
+  // Overwrite the rows of the table by the rows of the deltas in order. The
+  // value of the table is grown once if the new rows do not fit in.
+  void MergeTableDeltas(const std::vector<std::string> &delta_paths,
+                        const platform::Place &place,
+                        framework::SelectedRows *table) const {
+    PADDLE_ENFORCE_EQ(platform::is_cpu_place(place), true,
+                      platform::errors::Unimplemented(
+                          "The deltas of the table can only be merged on "
+                          "CPU."));
+    auto &dev_ctx = *platform::DeviceContextPool::Instance().Get(place);
+    auto *value = table->mutable_value();
+    int64_t row_numel = framework::product(
+        framework::slice_ddim(value->dims(), 1, value->dims().size()));
+    size_t row_bytes = row_numel * framework::SizeOfType(value->type());
+
+    std::vector<framework::SelectedRows> deltas(delta_paths.size());
+    std::unordered_set<int64_t> new_ids;
+    for (size_t i = 0; i < delta_paths.size(); ++i) {
+      std::ifstream fin(delta_paths[i], std::ios::binary);
+      PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                        platform::errors::Unavailable(
+                            "Cannot open the delta %s of the table.",
+                            delta_paths[i]));
+      framework::DeserializeFromStream(fin, &deltas[i], dev_ctx);
+      auto &delta_value = deltas[i].value();
+      PADDLE_ENFORCE_EQ(
+          delta_value.type() == value->type() &&
+              delta_value.numel() ==
+                  row_numel * static_cast<int64_t>(deltas[i].rows().size()),
+          true, platform::errors::InvalidArgument(
+                    "The rows of the delta %s do not match the table.",
+                    delta_paths[i]));
+      for (auto id : deltas[i].rows()) {
+        if (!table->HasKey(id)) new_ids.insert(id);
+      }
+    }
+
+    int64_t rows_num = table->rows().size();
+    int64_t capacity = value->dims()[0];
+    if (rows_num + static_cast<int64_t>(new_ids.size()) > capacity) {
+      framework::Tensor grown;
+      auto dims = value->dims();
+      dims[0] = rows_num + new_ids.size();
+      grown.Resize(dims);
+      grown.mutable_data(place, value->type());
+      std::memcpy(grown.data<void>(), value->data<void>(),
+                  rows_num * row_bytes);
+      value->ShareDataWith(grown);
+    }
+
+    auto *data = reinterpret_cast<char *>(value->data<void>());
+    for (auto &delta : deltas) {
+      auto *delta_data =
+          reinterpret_cast<const char *>(delta.value().data<void>());
+      for (size_t i = 0; i < delta.rows().size(); ++i) {
+        int64_t index = table->AutoGrownIndex(delta.rows()[i], true);
+        std::memcpy(data + index * row_bytes, delta_data + i * row_bytes,
+                    row_bytes);
+      }
+    }
+    VLOG(3) << "merge " << deltas.size() << " deltas into the table with "
+            << new_ids.size() << " new rows";
+  }
 };
 
 }  // namespace operators
@@ -115,6 +115,88 @@ or not. And the output only shares the LoD information with input Ids.
   }
 };
 
+class LookupTableDequantSGDOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(
+        ctx->HasInput("Param"), true,
+        platform::errors::InvalidArgument(
+            "Input(Param) of LookupTableDequantSGDOp should not be null."));
+    PADDLE_ENFORCE_EQ(
+        ctx->HasInput("Grad"), true,
+        platform::errors::InvalidArgument(
+            "Input(Grad) of LookupTableDequantSGDOp should not be null."));
+    PADDLE_ENFORCE_EQ(
+        ctx->HasInput("LearningRate"), true,
+        platform::errors::InvalidArgument(
+            "Input(LearningRate) of LookupTableDequantSGDOp should not be "
+            "null."));
+    PADDLE_ENFORCE_EQ(
+        ctx->HasOutput("ParamOut"), true,
+        platform::errors::InvalidArgument(
+            "Output(ParamOut) of LookupTableDequantSGDOp should not be null."));
+    PADDLE_ENFORCE_EQ(
+        ctx->GetInputsVarType("Grad").front(),
+        framework::proto::VarType::SELECTED_ROWS,
+        platform::errors::InvalidArgument(
+            "The Grad of LookupTableDequantSGD should be SelectedRows."));
+
+    auto param_dims = ctx->GetInputDim("Param");
+    PADDLE_ENFORCE_EQ(
+        param_dims.size(), 2,
+        platform::errors::InvalidArgument(
+            "The dimensions of the quantized Param must be 2, but received "
+            "Param's shape = [%s].",
+            param_dims));
+    PADDLE_ENFORCE_GE(param_dims[1], 2,
+                      platform::errors::InvalidArgument(
+                          "the second dim of Param should be greater or "
+                          "equal to 2, but the actual shape is [%s]",
+                          param_dims));
+    PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("LearningRate")), 1,
+                      platform::errors::InvalidArgument(
+                          "Learning rate should have 1 element."));
+    ctx->SetOutputDim("ParamOut", param_dims);
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = OperatorWithKernel::IndicateVarDataType(ctx, "Param");
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class LookupTableDequantSGDOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param",
+             "(Tensor) The quantized embedding table of "
+             "lookup_table_dequant.");
+    AddInput("Grad",
+             "(SelectedRows) The gradient of the dequantized rows of Param.");
+    AddInput("LearningRate", "(Tensor) The learning rate of SGD.");
+    AddOutput("ParamOut",
+              "(Tensor) The updated quantized embedding table, which should "
+              "be the same variable as Param.");
+    AddComment(R"DOC(
+Lookup Table Dequant SGD Operator.
+
+The sparse SGD update of the quantized embedding table of
+lookup_table_dequant. The rows of `Param` in `Grad` are dequantized,
+updated in fp32 by
+
+$$param\_out = param - learning\_rate * grad$$
+
+and quantized again by their new min and max in place, so that the table
+is trained without keeping an fp32 copy of it.
+
+)DOC");
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -126,3 +208,11 @@ REGISTER_OPERATOR(
     paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
 REGISTER_OP_CPU_KERNEL(lookup_table_dequant,
                        ops::LookupTableDequantKernel<float>);
+
+REGISTER_OPERATOR(
+    lookup_table_dequant_sgd, ops::LookupTableDequantSGDOp,
+    ops::LookupTableDequantSGDOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(lookup_table_dequant_sgd,
+                       ops::LookupTableDequantSGDKernel<float>);
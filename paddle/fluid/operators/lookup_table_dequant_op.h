@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
 
 #ifdef PADDLE_WITH_DISTRIBUTE
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
@@ -46,6 +48,25 @@ void dequant(const unsigned char *in, T *out, float min, float max,
   }
 }
 
+// The inverse of dequant: the row is quantized to pow_2_bits levels from its
+// min to its max, which are written to min and max.
+template <typename T>
+void quant(const T *in, unsigned char *out, float *min, float *max,
+           int emb_size, int pow_2_bits) {
+  float lo = static_cast<float>(*std::min_element(in, in + emb_size));
+  float hi = static_cast<float>(*std::max_element(in, in + emb_size));
+  float scale = (hi - lo) / pow_2_bits;
+  for (int i = 0; i < emb_size; ++i) {
+    int x = scale > 0.f
+                ? static_cast<int>((static_cast<float>(in[i]) - lo) / scale +
+                                   0.5f)
+                : 0;
+    out[i] = static_cast<unsigned char>(std::min(x, pow_2_bits - 1));
+  }
+  *min = lo;
+  *max = hi;
+}
+
 constexpr int64_t kNoPadding = -1;
 
 template <typename T>
@@ -105,5 +126,54 @@ class LookupTableDequantKernel : public framework::OpKernel<T> {
   }
 };
 
+// Each row of the quantized table updated by the SelectedRows gradient is
+// dequantized, updated by SGD in fp32, and quantized again in place.
+template <typename T>
+class LookupTableDequantSGDKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    const auto *grad_var = context.InputVar("Grad");
+    PADDLE_ENFORCE_EQ(grad_var->IsType<SelectedRows>(), true,
+                      platform::errors::InvalidArgument(
+                          "The Grad of lookup_table_dequant_sgd should be "
+                          "SelectedRows, but received %s.",
+                          framework::ToTypeName(grad_var->Type())));
+    auto *param_t = context.Input<LoDTensor>("Param");
+    auto *param_out_t = context.Output<LoDTensor>("ParamOut");
+    PADDLE_ENFORCE_EQ(param_t, param_out_t,
+                      platform::errors::InvalidArgument(
+                          "The lookup_table_dequant_sgd should update Param "
+                          "in place."));
+    const auto &grad = grad_var->Get<SelectedRows>();
+    int64_t row_number = param_t->dims()[0];
+    int64_t quant_number = param_t->dims()[1];
+    int64_t row_width = (quant_number - 2) * 4;
+    PADDLE_ENFORCE_EQ(
+        grad.value().numel(),
+        static_cast<int64_t>(grad.rows().size()) * row_width,
+        platform::errors::InvalidArgument(
+            "The width of the rows of Grad should be %ld, which is the "
+            "width of the dequantized Param, but received the shape [%s].",
+            row_width, grad.value().dims()));
+
+    float lr = context.Input<Tensor>("LearningRate")->data<float>()[0];
+    auto *table = param_out_t->mutable_data<float>(context.GetPlace());
+    int pow_2_bits = static_cast<int>(pow(2, 8));
+    math::scatter::MergeAndUpdate<T>(
+        grad, row_number, [&](int64_t row, const T *g) {
+          float *quant_row = table + row * quant_number;
+          auto *tensor_buf = reinterpret_cast<unsigned char *>(quant_row + 2);
+          std::vector<T> value(row_width);
+          dequant(tensor_buf, value.data(), quant_row[0], quant_row[1],
+                  row_width, pow_2_bits);
+          for (int64_t j = 0; j < row_width; ++j) {
+            value[j] -= lr * g[j];
+          }
+          quant(value.data(), tensor_buf, quant_row, quant_row + 1, row_width,
+                pow_2_bits);
+        });
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
@@ -14,19 +14,27 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/operators/math/blas.h"
 
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
 #ifdef PADDLE_WITH_DISTRIBUTE
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
 #endif
 
+DECLARE_bool(advise_mapped_embedding_rows);
+
 namespace paddle {
 namespace operators {
 
@@ -37,6 +45,70 @@ using DDim = framework::DDim;
 
 constexpr int64_t kNoPadding = -1;
 
+// The rows are gathered in parallel if the output has more elements.
+constexpr int64_t kGatherParallelNumel = 1 << 16;
+// The row of the id kGatherPrefetchDistance ahead is prefetched, at most
+// kGatherPrefetchBytes of it, and the hardware prefetcher follows the rest.
+constexpr int64_t kGatherPrefetchDistance = 8;
+constexpr int64_t kGatherPrefetchBytes = 256;
+
+inline void PrefetchRow(const void *row, int64_t bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+  const char *p = static_cast<const char *>(row);
+  bytes = std::min(bytes, kGatherPrefetchBytes);
+  for (int64_t i = 0; i < bytes; i += 64) {
+    __builtin_prefetch(p + i);
+  }
+#endif
+}
+
+// Copy the rows of table indexed by ids to output, and fill the rows of
+// padding_idx by 0. The ids are split into one contiguous chunk for each
+// thread, so that the output pages are first touched by the thread writing
+// them.
+template <typename T>
+void GatherRows(const T *table, const int64_t *ids, int64_t ids_numel,
+                int64_t row_width, int64_t padding_idx, T *output) {
+  size_t row_bytes = row_width * sizeof(T);
+#ifdef PADDLE_WITH_MKLML
+  bool parallel = ids_numel * row_width >= kGatherParallelNumel;
+#pragma omp parallel for schedule(static) if (parallel)
+#endif
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (i + kGatherPrefetchDistance < ids_numel &&
+        ids[i + kGatherPrefetchDistance] != padding_idx) {
+      PrefetchRow(table + ids[i + kGatherPrefetchDistance] * row_width,
+                  row_bytes);
+    }
+    if (ids[i] == padding_idx) {
+      memset(output + i * row_width, 0, row_bytes);
+    } else {
+      memcpy(output + i * row_width, table + ids[i] * row_width, row_bytes);
+    }
+  }
+}
+
+#ifndef _WIN32
+// Read ahead the pages of the rows of a memory mapped table before gathering
+// them, so that the rows not in memory are read from the disk together
+// rather than one page fault at a time.
+template <typename T>
+void AdviseMappedRows(const T *table, const int64_t *ids, int64_t ids_numel,
+                      int64_t row_width, int64_t padding_idx) {
+  size_t row_bytes = row_width * sizeof(T);
+  std::vector<std::pair<const void *, size_t>> rows;
+  rows.reserve(ids_numel);
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (ids[i] != padding_idx) {
+      rows.emplace_back(table + ids[i] * row_width, row_bytes);
+    }
+  }
+  size_t advised = memory::allocation::AdviseMemoryMapWillNeed(rows);
+  VLOG(4) << "read ahead " << rows.size() << " rows of the mapped table by "
+          << advised << " ranges";
+}
+#endif
+
 template <typename T>
 class LookupTableKernel : public framework::OpKernel<T> {
  public:
@@ -82,10 +154,9 @@ class LookupTableKernel : public framework::OpKernel<T> {
         auto *table = table_t->data<T>();
         auto *output = output_t->mutable_data<T>(context.GetPlace());
 
+        // check the ids before the parallel gather, which can not throw
         for (int64_t i = 0; i < ids_numel; ++i) {
-          if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-            memset(output + i * row_width, 0, row_width * sizeof(T));
-          } else {
+          if (padding_idx == kNoPadding || ids[i] != padding_idx) {
             PADDLE_ENFORCE_LT(
                 ids[i], row_number,
                 "Variable value (input) of OP(fluid.layers.embedding) "
@@ -98,20 +169,26 @@ class LookupTableKernel : public framework::OpKernel<T> {
                 "expected >= 0 and < %ld, but got %ld. Please check input "
                 "value.",
                 row_number, ids[i]);
-            memcpy(output + i * row_width, table + ids[i] * row_width,
-                   row_width * sizeof(T));
           }
         }
+        // the ids checked are >= 0, so that kNoPadding matches none of them
+#ifndef _WIN32
+        if (FLAGS_advise_mapped_embedding_rows &&
+            memory::allocation::IsInMemoryMapFile(
+                table, table_t->numel() * sizeof(T))) {
+          AdviseMappedRows(table, ids, ids_numel, row_width, padding_idx);
+        }
+#endif
+        GatherRows(table, ids, ids_numel, row_width, padding_idx, output);
       } else if (table_var->IsType<SelectedRows>()) {
         const auto &table_t = table_var->Get<SelectedRows>();
         int64_t row_width = table_t.value().dims()[1];
         const auto *table = table_t.value().data<T>();
         auto *output = output_t->mutable_data<T>(context.GetPlace());
-        auto input_data_type = table_t.value().type();
+        // the indexes of the ids in the table, and kNoPadding for padding_idx
+        std::vector<int64_t> id_indexes(ids_numel, kNoPadding);
         for (int64_t i = 0; i < ids_numel; ++i) {
-          if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-            memset(output + i * row_width, 0, row_width * sizeof(T));
-          } else {
+          if (padding_idx == kNoPadding || ids[i] != padding_idx) {
             PADDLE_ENFORCE_GE(
                 ids[i], 0,
                 "Variable value (input) of OP(fluid.layers.embedding) "
@@ -121,16 +198,11 @@ class LookupTableKernel : public framework::OpKernel<T> {
             PADDLE_ENFORCE_GE(
                 id_index, 0, "the input key should be exists. But received %d.",
                 id_index);
-            if (input_data_type == framework::proto::VarType::INT8) {
-              memcpy(output + i * row_width, table + id_index * row_width,
-                     row_width * sizeof(T));
-            } else {
-              auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
-              blas.VCOPY(row_width, table + id_index * row_width,
-                         output + i * row_width);
-            }
+            id_indexes[i] = id_index;
           }
         }
+        GatherRows(table, id_indexes.data(), ids_numel, row_width, kNoPadding,
+                   output);
       }
     }
   }
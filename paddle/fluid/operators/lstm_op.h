@@ -54,22 +54,23 @@ class LSTMKernel : public framework::OpKernel<T> {
     auto* cell_out = ctx.Output<LoDTensor>("Cell");
     cell_out->mutable_data<T>(ctx.GetPlace());
 
-    bool is_reverse = ctx.Attr<bool>("is_reverse");
-    math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
-    auto& device_ctx = ctx.template device_context<DeviceContext>();
-    to_batch(device_ctx, *input, batch_gate, true, is_reverse);
-
     auto in_dims = input->dims();
     int frame_size = static_cast<int>(in_dims[1] / 4);
     framework::DDim dims({in_dims[0], frame_size});
 
+    // the gate bias is added while reordering the input into the batch
+    Tensor gate_bias;
     if (bias) {
       Tensor b = *bias;
       b.Resize({bias->numel(), 1});
-      Tensor gate_bias = b.Slice(0, 4 * frame_size);
-      math::RowwiseAdd<DeviceContext, T> add_bias;
-      add_bias(device_ctx, *batch_gate, gate_bias, batch_gate);
+      gate_bias = b.Slice(0, 4 * frame_size);
     }
+    bool is_reverse = ctx.Attr<bool>("is_reverse");
+    math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
+    auto& device_ctx = ctx.template device_context<DeviceContext>();
+    to_batch(device_ctx, *input, batch_gate, true, is_reverse,
+             bias ? &gate_bias : nullptr);
+    bool in_order = math::IsIdentityBatchOrder(batch_gate->lod());
 
     math::LstmMetaValue<T> lstm_value;
     if (bias && ctx.Attr<bool>("use_peepholes")) {
@@ -99,10 +100,17 @@ class LSTMKernel : public framework::OpKernel<T> {
     }
 
     // Use the local variable as here.
+    // The batch hidden and cell are the outputs themselves if the batch is
+    // in the order of the input, which need not be reordered back.
     LoDTensor batch_hidden, batch_cell;
     auto* batch_cell_pre_act = ctx.Output<LoDTensor>("BatchCellPreAct");
-    batch_hidden.mutable_data<T>(dims, ctx.GetPlace());
-    batch_cell.mutable_data<T>(dims, ctx.GetPlace());
+    if (in_order) {
+      batch_hidden.ShareDataWith(*hidden_out);
+      batch_cell.ShareDataWith(*cell_out);
+    } else {
+      batch_hidden.mutable_data<T>(dims, ctx.GetPlace());
+      batch_cell.mutable_data<T>(dims, ctx.GetPlace());
+    }
     batch_cell_pre_act->mutable_data<T>(dims, ctx.GetPlace());
 
     auto batch_starts = batch_gate->lod()[0];
@@ -157,6 +165,7 @@ class LSTMKernel : public framework::OpKernel<T> {
           gate_act, cell_act, cand_act);
       lstm_value.prev_state_value = lstm_value.state_value;
     }
+    if (in_order) return;
 
     math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
     batch_hidden.set_lod(batch_gate->lod());
@@ -113,23 +113,24 @@ class LSTMPKernel : public framework::OpKernel<T> {
     auto* cell_out = ctx.Output<LoDTensor>("Cell");
     cell_out->mutable_data<T>(ctx.GetPlace());
 
-    bool is_reverse = ctx.Attr<bool>("is_reverse");
-    math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
-    auto& device_ctx = ctx.template device_context<DeviceContext>();
-    to_batch(device_ctx, *input, batch_gate, true, is_reverse);
-
     auto in_dims = input->dims();
     int frame_size = static_cast<int>(in_dims[1] / 4);
     framework::DDim dims({in_dims[0], frame_size});
     framework::DDim proj_dims({in_dims[0], proj_weight->dims()[1]});
 
+    // the gate bias is added while reordering the input into the batch
+    Tensor gate_bias;
     if (bias) {
       Tensor b = *bias;
       b.Resize({bias->numel(), 1});
-      Tensor gate_bias = b.Slice(0, 4 * frame_size);
-      math::RowwiseAdd<DeviceContext, T> add_bias;
-      add_bias(device_ctx, *batch_gate, gate_bias, batch_gate);
+      gate_bias = b.Slice(0, 4 * frame_size);
     }
+    bool is_reverse = ctx.Attr<bool>("is_reverse");
+    math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
+    auto& device_ctx = ctx.template device_context<DeviceContext>();
+    to_batch(device_ctx, *input, batch_gate, true, is_reverse,
+             bias ? &gate_bias : nullptr);
+    bool in_order = math::IsIdentityBatchOrder(batch_gate->lod());
 
     math::LstmMetaValue<T> lstmp_value;
     if (bias && ctx.Attr<bool>("use_peepholes")) {
@@ -165,8 +166,15 @@ class LSTMPKernel : public framework::OpKernel<T> {
     batch_cell_pre_act->mutable_data<T>(dims, ctx.GetPlace());
     auto* batch_hidden = ctx.Output<LoDTensor>("BatchHidden");
     batch_hidden->mutable_data<T>(dims, ctx.GetPlace());    // T x D
-    batch_proj.mutable_data<T>(proj_dims, ctx.GetPlace());  // T x P
-    batch_cell.mutable_data<T>(dims, ctx.GetPlace());       // T x D
+    // The batch projection and cell are the outputs themselves if the batch
+    // is in the order of the input, which need not be reordered back.
+    if (in_order) {
+      batch_proj.ShareDataWith(*proj_out);
+      batch_cell.ShareDataWith(*cell_out);
+    } else {
+      batch_proj.mutable_data<T>(proj_dims, ctx.GetPlace());  // T x P
+      batch_cell.mutable_data<T>(dims, ctx.GetPlace());       // T x D
+    }
 
     auto batch_starts = batch_gate->lod()[0];
     size_t num_batch = batch_starts.size() - 1;
@@ -235,6 +243,7 @@ class LSTMPKernel : public framework::OpKernel<T> {
               _ClipFunctor<T>(-1.0 * proj_clip, proj_clip));
       }
     }
+    if (in_order) return;
 
     math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
     batch_proj.set_lod(batch_gate->lod());
@@ -14,7 +14,9 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/beam_search.h"
 #include <algorithm>
+#include <limits>
 #include <map>
+#include "paddle/fluid/operators/math/topk.h"
 
 namespace paddle {
 namespace operators {
@@ -233,6 +235,11 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
       seq_width *= scores->dims()[i];
     }
 
+    // the scores of a prefix and the top beam_size of them, which are reused
+    // by all the prefixes
+    std::vector<float> candidate_scores(seq_width);
+    std::vector<float> top_scores(beam_size);
+    std::vector<int64_t> top_indices(beam_size);
     for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
       size_t seq_offset_start = abs_lod[lod_level][seq_id];
       size_t seq_offset_end = abs_lod[lod_level][seq_id + 1];
@@ -251,12 +258,31 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
           Insert(&top_beam, item, beam_size);
         } else {
           size_t index = offset * seq_width;
-          for (size_t d = 0; d < seq_width; d++, index++) {
-            int64_t id = ids_data ? ids_data[index] : static_cast<int64_t>(d);
-            float score = is_accumulated
-                              ? scores_data[index]
-                              : pre_score + std::log(scores_data[index]);
-            Item item(offset, id, score);
+          for (size_t d = 0; d < seq_width; d++) {
+            candidate_scores[d] =
+                is_accumulated ? scores_data[index + d]
+                               : pre_score + std::log(scores_data[index + d]);
+          }
+          // Only the candidates not less than the beam_size-th largest score
+          // of the prefix can be left in top_beam, since the others are less
+          // than beam_size items of the same offset. They are inserted in
+          // the order of the ids, so that the ties are resolved as before.
+          bool prune = beam_size > 0 && seq_width > beam_size;
+          float threshold = std::numeric_limits<float>::lowest();
+          if (prune) {
+            SelectTopK(candidate_scores.data(),
+                       static_cast<int64_t>(seq_width),
+                       static_cast<int64_t>(beam_size), top_scores.data(),
+                       top_indices.data(), LargerFirst<float>());
+            threshold = top_scores[beam_size - 1];
+          }
+          for (size_t d = 0; d < seq_width; d++) {
+            if (prune && candidate_scores[d] < threshold) {
+              continue;
+            }
+            int64_t id =
+                ids_data ? ids_data[index + d] : static_cast<int64_t>(d);
+            Item item(offset, id, candidate_scores[d]);
             Insert(&top_beam, item, beam_size);
           }
         }
@@ -154,6 +154,19 @@ struct CUBlas<platform::float16> {
 #endif
   }
 
+  // The elements are accumulated in float32.
+  static void AXPY(cublasHandle_t handle, int n, const float16 *alpha,
+                   const float16 *x, int incx, float16 *y, int incy) {
+#if CUDA_VERSION >= 8000
+    float f_alpha = static_cast<float>(*alpha);
+    PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::cublasAxpyEx(
+        handle, n, &f_alpha, CUDA_R_32F, x, CUDA_R_16F, incx, y, CUDA_R_16F,
+        incy, CUDA_R_32F));
+#else
+    PADDLE_THROW("cublasAxpyEx is supported on cuda >= 8.0");
+#endif
+  }
+
   // NOTES: GEMM_EX can use Tensor Core to accelerate matrix multiply.
   // https://docs.nvidia.com/cuda/cublas/index.html#cublassetmathmode
   template <typename... ARGS>
@@ -0,0 +1,94 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/block_sparse.h"
+#include <algorithm>
+#include <cstring>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+class BlockSparseFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void MatMulTransposed(const platform::CPUDeviceContext& context,
+                        const int M, const T* X, const BlockSparseMatrix<T>& S,
+                        T* Y, const T* B = nullptr, bool relu = false) {
+    const int bh = S.block_height;
+    const int bw = S.block_width;
+    const int block_rows = S.rows / bh;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int m = 0; m < M; ++m) {
+      const T* x = X + m * S.cols;
+      T* y = Y + m * S.rows;
+      for (int r = 0; r < block_rows; ++r) {
+        for (int i = 0; i < bh; ++i) {
+          T sum = B ? B[r * bh + i] : static_cast<T>(0);
+          for (int k = S.offsets[r]; k < S.offsets[r + 1]; ++k) {
+            const T* block = S.values + (k * bh + i) * bw;
+            const T* x_block = x + S.columns[k] * bw;
+            for (int j = 0; j < bw; ++j) {
+              sum += block[j] * x_block[j];
+            }
+          }
+          y[r * bh + i] = relu ? std::max(sum, static_cast<T>(0)) : sum;
+        }
+      }
+    }
+  }
+
+  void MatMul(const platform::CPUDeviceContext& context,
+              const BlockSparseMatrix<T>& S, const int N, const T* X, T* Y,
+              const T* B = nullptr, bool relu = false) {
+    const int bh = S.block_height;
+    const int bw = S.block_width;
+    const int block_rows = S.rows / bh;
+    // The rows of Y are accumulated from the rows of X, which are contiguous.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int r = 0; r < block_rows; ++r) {
+      for (int i = 0; i < bh; ++i) {
+        T* y = Y + (r * bh + i) * N;
+        T bias = B ? B[r * bh + i] : static_cast<T>(0);
+        std::fill(y, y + N, bias);
+        for (int k = S.offsets[r]; k < S.offsets[r + 1]; ++k) {
+          const T* block = S.values + (k * bh + i) * bw;
+          for (int j = 0; j < bw; ++j) {
+            const T* x = X + (S.columns[k] * bw + j) * N;
+            const T s = block[j];
+            for (int n = 0; n < N; ++n) {
+              y[n] += s * x[n];
+            }
+          }
+        }
+        if (relu) {
+          for (int n = 0; n < N; ++n) {
+            y[n] = std::max(y[n], static_cast<T>(0));
+          }
+        }
+      }
+    }
+  }
+};
+
+template class BlockSparseFunctor<platform::CPUDeviceContext, float>;
+template class BlockSparseFunctor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,117 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/math/block_sparse.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+__device__ __forceinline__ T Load(const T* data) {
+#if __CUDA_ARCH__ >= 350
+  return __ldg(data);
+#else
+  return *data;
+#endif
+}
+
+// Each thread computes Y[m, row], and the threads of a block share the row m
+// of X, which is read from the cache.
+template <typename T, bool DoRelu>
+__global__ void BlockSparseMatMulTransposedKernel(
+    const T* X, BlockSparseMatrix<T> S, T* Y, const T* B) {
+  const int m = blockIdx.x;
+  const int row = blockIdx.y * blockDim.x + threadIdx.x;
+  if (row >= S.rows) return;
+  const int bh = S.block_height;
+  const int bw = S.block_width;
+  const int r = row / bh;
+  const int i = row - r * bh;
+  const T* x = X + m * S.cols;
+  T sum = B ? Load(B + row) : static_cast<T>(0);
+  for (int k = Load(S.offsets + r); k < Load(S.offsets + r + 1); ++k) {
+    const T* block = S.values + (k * bh + i) * bw;
+    const T* x_block = x + Load(S.columns + k) * bw;
+    for (int j = 0; j < bw; ++j) {
+      sum += Load(block + j) * Load(x_block + j);
+    }
+  }
+  Y[m * S.rows + row] = DoRelu ? max(sum, static_cast<T>(0)) : sum;
+}
+
+// Each thread computes Y[row, n], so that X and Y are accessed coalesced.
+template <typename T, bool DoRelu>
+__global__ void BlockSparseMatMulKernel(BlockSparseMatrix<T> S, const int N,
+                                        const T* X, T* Y, const T* B) {
+  const int row = blockIdx.y;
+  const int n = blockIdx.x * blockDim.x + threadIdx.x;
+  if (n >= N) return;
+  const int bh = S.block_height;
+  const int bw = S.block_width;
+  const int r = row / bh;
+  const int i = row - r * bh;
+  T sum = B ? Load(B + row) : static_cast<T>(0);
+  for (int k = Load(S.offsets + r); k < Load(S.offsets + r + 1); ++k) {
+    const T* block = S.values + (k * bh + i) * bw;
+    const T* x = X + Load(S.columns + k) * bw * N + n;
+    for (int j = 0; j < bw; ++j) {
+      sum += Load(block + j) * Load(x + j * N);
+    }
+  }
+  Y[row * N + n] = DoRelu ? max(sum, static_cast<T>(0)) : sum;
+}
+
+template <typename T>
+class BlockSparseFunctor<platform::CUDADeviceContext, T> {
+ public:
+  void MatMulTransposed(const platform::CUDADeviceContext& context,
+                        const int M, const T* X, const BlockSparseMatrix<T>& S,
+                        T* Y, const T* B = nullptr, bool relu = false) {
+    if (M == 0) return;
+    const int threads = std::min(256, S.rows);
+    dim3 blocks(M, (S.rows + threads - 1) / threads);
+    if (relu) {
+      BlockSparseMatMulTransposedKernel<
+          T, true><<<blocks, threads, 0, context.stream()>>>(X, S, Y, B);
+    } else {
+      BlockSparseMatMulTransposedKernel<
+          T, false><<<blocks, threads, 0, context.stream()>>>(X, S, Y, B);
+    }
+  }
+
+  void MatMul(const platform::CUDADeviceContext& context,
+              const BlockSparseMatrix<T>& S, const int N, const T* X, T* Y,
+              const T* B = nullptr, bool relu = false) {
+    if (N == 0) return;
+    const int threads = std::min(256, N);
+    dim3 blocks((N + threads - 1) / threads, S.rows);
+    if (relu) {
+      BlockSparseMatMulKernel<
+          T, true><<<blocks, threads, 0, context.stream()>>>(S, N, X, Y, B);
+    } else {
+      BlockSparseMatMulKernel<
+          T, false><<<blocks, threads, 0, context.stream()>>>(S, N, X, Y, B);
+    }
+  }
+};
+
+template class BlockSparseFunctor<platform::CUDADeviceContext, float>;
+template class BlockSparseFunctor<platform::CUDADeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,63 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * A matrix S of [rows, cols] in the block compressed sparse row (BSR) format.
+ * S is tiled into the blocks of [block_height, block_width], and only the
+ * nonzero blocks are stored:
+ *
+ *   offsets: [rows / block_height + 1], the nonzero blocks of the block row i
+ *            are offsets[i], ..., offsets[i + 1] - 1.
+ *   columns: [nnz_blocks], the block column of each nonzero block.
+ *   values:  [nnz_blocks, block_height, block_width], the elements of each
+ *            nonzero block in the row major.
+ */
+template <typename T>
+struct BlockSparseMatrix {
+  int rows;
+  int cols;
+  int block_height;
+  int block_width;
+  const T* values;
+  const int* offsets;
+  const int* columns;
+};
+
+template <typename DeviceContext, typename T>
+class BlockSparseFunctor {
+ public:
+  // Y[M, S.rows] = X[M, S.cols] * S^T + B, which is the fc with the weight
+  // S^T, and B is of [S.rows].
+  void MatMulTransposed(const DeviceContext& context, const int M, const T* X,
+                        const BlockSparseMatrix<T>& S, T* Y,
+                        const T* B = nullptr, bool relu = false);
+
+  // Y[S.rows, N] = S * X[S.cols, N] + B, which is the 1x1 conv of NCHW with
+  // the filter S, and B is of [S.rows].
+  void MatMul(const DeviceContext& context, const BlockSparseMatrix<T>& S,
+              const int N, const T* X, T* Y, const T* B = nullptr,
+              bool relu = false);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
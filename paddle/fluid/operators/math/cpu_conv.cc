@@ -0,0 +1,345 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_conv.h"
+#include <algorithm>
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+using Tensor = framework::Tensor;
+
+// The Winograd transforms need enough channels to be amortized by the
+// gemms of the tiles.
+static constexpr int64_t kWinogradMinChannels = 16;
+// F(4x4, 3x3) needs larger outputs than F(2x2, 3x3) to fill its tiles.
+static constexpr int64_t kWinogradF4x3MinOutputSize = 16;
+static constexpr int64_t kWinogradF2x3MinOutputSize = 4;
+
+CPUConvAlgo SelectCPUConvAlgo(const std::vector<int64_t>& input_shape,
+                              const std::vector<int64_t>& filter_shape,
+                              int groups, const std::vector<int>& strides,
+                              const std::vector<int>& paddings,
+                              const std::vector<int>& dilations) {
+  if (input_shape.size() != 4U || filter_shape.size() != 4U ||
+      paddings.size() != 4U) {
+    return CPUConvAlgo::kIm2ColGemm;
+  }
+  int64_t channels = input_shape[1];
+  if (groups > 1 && groups == channels && filter_shape[0] % channels == 0) {
+    return CPUConvAlgo::kDepthwise;
+  }
+
+  bool winograd = groups == 1 && filter_shape[2] == 3 &&
+                  filter_shape[3] == 3 && channels >= kWinogradMinChannels &&
+                  filter_shape[0] >= kWinogradMinChannels;
+  for (size_t i = 0; i < strides.size(); ++i) {
+    winograd = winograd && strides[i] == 1 && dilations[i] == 1;
+  }
+  if (!winograd) {
+    return CPUConvAlgo::kIm2ColGemm;
+  }
+  int64_t output_height = input_shape[2] + paddings[0] + paddings[1] - 2;
+  int64_t output_width = input_shape[3] + paddings[2] + paddings[3] - 2;
+  int64_t output_size = std::min(output_height, output_width);
+  if (output_size >= kWinogradF4x3MinOutputSize) {
+    return CPUConvAlgo::kWinogradF4x3;
+  }
+  if (output_size >= kWinogradF2x3MinOutputSize) {
+    return CPUConvAlgo::kWinogradF2x3;
+  }
+  return CPUConvAlgo::kIm2ColGemm;
+}
+
+/*
+ * The matrices of Winograd F(m x m, 3 x 3), where the output tile Y of the
+ * input tile d of size alpha = m + 2 and the filter g is
+ *   Y = AT * [(G * g * GT) .* (BT * d * B)] * A
+ */
+template <int M>
+struct WinogradMatrices;
+
+template <>
+struct WinogradMatrices<2> {
+  static const double kBT[4][4];
+  static const double kG[4][3];
+  static const double kAT[2][4];
+};
+
+const double WinogradMatrices<2>::kBT[4][4] = {
+    {1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+const double WinogradMatrices<2>::kG[4][3] = {
+    {1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+const double WinogradMatrices<2>::kAT[2][4] = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+
+template <>
+struct WinogradMatrices<4> {
+  static const double kBT[6][6];
+  static const double kG[6][3];
+  static const double kAT[4][6];
+};
+
+const double WinogradMatrices<4>::kBT[6][6] = {
+    {4, 0, -5, 0, 1, 0},  {0, -4, -4, 1, 1, 0}, {0, 4, -4, -1, 1, 0},
+    {0, -2, -1, 2, 1, 0}, {0, 2, -1, -2, 1, 0}, {0, 4, 0, -5, 0, 1}};
+const double WinogradMatrices<4>::kG[6][3] = {
+    {1.0 / 4, 0, 0},
+    {-1.0 / 6, -1.0 / 6, -1.0 / 6},
+    {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+    {1.0 / 24, 1.0 / 12, 1.0 / 6},
+    {1.0 / 24, -1.0 / 12, 1.0 / 6},
+    {0, 0, 1}};
+const double WinogradMatrices<4>::kAT[4][6] = {{1, 1, 1, 1, 1, 0},
+                                               {0, 1, -1, 2, -2, 0},
+                                               {0, 1, 1, 4, 4, 0},
+                                               {0, 1, -1, 8, -8, 1}};
+
+/*
+ * The filter and the input are transformed into alpha * alpha matrices,
+ * U[xi] with shape [K, C] and V[xi] with shape [C, P] for each position xi
+ * of the tiles, where P is the number of the tiles of an image. Then the
+ * transformed output M[xi] = U[xi] * V[xi] is computed by gemm, and
+ * transformed back into the output tiles.
+ */
+template <typename T, int M>
+static void WinogradConv(const platform::CPUDeviceContext& context,
+                         const Tensor& input, const Tensor& filter,
+                         const std::vector<int>& paddings, Tensor* output) {
+  using Matrices = WinogradMatrices<M>;
+  constexpr int kAlpha = M + 2;
+  constexpr int kTileSize = kAlpha * kAlpha;
+  const int64_t batch_size = input.dims()[0];
+  const int64_t channels = input.dims()[1];
+  const int64_t input_height = input.dims()[2];
+  const int64_t input_width = input.dims()[3];
+  const int64_t filter_num = filter.dims()[0];
+  const int64_t output_height = output->dims()[2];
+  const int64_t output_width = output->dims()[3];
+  const int64_t tiles_h = (output_height + M - 1) / M;
+  const int64_t tiles_w = (output_width + M - 1) / M;
+  const int64_t tiles = tiles_h * tiles_w;
+  const int pad_top = paddings[0];
+  const int pad_left = paddings[2];
+
+  const T* filter_data = filter.data<T>();
+  std::vector<T> u(kTileSize * filter_num * channels);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t kc = 0; kc < filter_num * channels; ++kc) {
+    const T* g = filter_data + kc * 9;
+    T tmp[kAlpha][3];
+    for (int a = 0; a < kAlpha; ++a) {
+      for (int j = 0; j < 3; ++j) {
+        tmp[a][j] = static_cast<T>(Matrices::kG[a][0]) * g[j] +
+                    static_cast<T>(Matrices::kG[a][1]) * g[3 + j] +
+                    static_cast<T>(Matrices::kG[a][2]) * g[6 + j];
+      }
+    }
+    for (int a = 0; a < kAlpha; ++a) {
+      for (int b = 0; b < kAlpha; ++b) {
+        u[(a * kAlpha + b) * filter_num * channels + kc] =
+            tmp[a][0] * static_cast<T>(Matrices::kG[b][0]) +
+            tmp[a][1] * static_cast<T>(Matrices::kG[b][1]) +
+            tmp[a][2] * static_cast<T>(Matrices::kG[b][2]);
+      }
+    }
+  }
+
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  const T* input_data = input.data<T>();
+  T* output_data = output->data<T>();
+  std::vector<T> v(kTileSize * channels * tiles);
+  std::vector<T> m(kTileSize * filter_num * tiles);
+  for (int64_t n = 0; n < batch_size; ++n) {
+    const T* image = input_data + n * channels * input_height * input_width;
+    T* out = output_data + n * filter_num * output_height * output_width;
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t cp = 0; cp < channels * tiles; ++cp) {
+      const T* plane = image + (cp / tiles) * input_height * input_width;
+      int64_t h0 = (cp % tiles) / tiles_w * M - pad_top;
+      int64_t w0 = (cp % tiles) % tiles_w * M - pad_left;
+      T d[kAlpha][kAlpha];
+      for (int i = 0; i < kAlpha; ++i) {
+        for (int j = 0; j < kAlpha; ++j) {
+          int64_t h = h0 + i;
+          int64_t w = w0 + j;
+          d[i][j] = h >= 0 && h < input_height && w >= 0 && w < input_width
+                        ? plane[h * input_width + w]
+                        : static_cast<T>(0);
+        }
+      }
+      T tmp[kAlpha][kAlpha];
+      for (int a = 0; a < kAlpha; ++a) {
+        for (int j = 0; j < kAlpha; ++j) {
+          T sum = 0;
+          for (int i = 0; i < kAlpha; ++i) {
+            sum += static_cast<T>(Matrices::kBT[a][i]) * d[i][j];
+          }
+          tmp[a][j] = sum;
+        }
+      }
+      for (int a = 0; a < kAlpha; ++a) {
+        for (int b = 0; b < kAlpha; ++b) {
+          T sum = 0;
+          for (int j = 0; j < kAlpha; ++j) {
+            sum += tmp[a][j] * static_cast<T>(Matrices::kBT[b][j]);
+          }
+          v[(a * kAlpha + b) * channels * tiles + cp] = sum;
+        }
+      }
+    }
+
+    for (int xi = 0; xi < kTileSize; ++xi) {
+      blas.GEMM(CblasNoTrans, CblasNoTrans, filter_num, tiles, channels,
+                static_cast<T>(1), u.data() + xi * filter_num * channels,
+                v.data() + xi * channels * tiles, static_cast<T>(0),
+                m.data() + xi * filter_num * tiles);
+    }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t kp = 0; kp < filter_num * tiles; ++kp) {
+      T* plane = out + (kp / tiles) * output_height * output_width;
+      int64_t h0 = (kp % tiles) / tiles_w * M;
+      int64_t w0 = (kp % tiles) % tiles_w * M;
+      T tmp[M][kAlpha];
+      for (int a = 0; a < M; ++a) {
+        for (int j = 0; j < kAlpha; ++j) {
+          T sum = 0;
+          for (int i = 0; i < kAlpha; ++i) {
+            sum += static_cast<T>(Matrices::kAT[a][i]) *
+                   m[(i * kAlpha + j) * filter_num * tiles + kp];
+          }
+          tmp[a][j] = sum;
+        }
+      }
+      for (int a = 0; a < M && h0 + a < output_height; ++a) {
+        for (int b = 0; b < M && w0 + b < output_width; ++b) {
+          T sum = 0;
+          for (int j = 0; j < kAlpha; ++j) {
+            sum += tmp[a][j] * static_cast<T>(Matrices::kAT[b][j]);
+          }
+          plane[(h0 + a) * output_width + w0 + b] = sum;
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Each output plane is accumulated by the rows of its input plane, where
+ * the range of the output columns reading inside the input is computed for
+ * each column of the filter, so that the inner loop has no branch.
+ */
+template <typename T>
+static void DepthwiseConv(const Tensor& input, const Tensor& filter,
+                          const std::vector<int>& strides,
+                          const std::vector<int>& paddings,
+                          const std::vector<int>& dilations,
+                          Tensor* output) {
+  const int64_t batch_size = input.dims()[0];
+  const int64_t channels = input.dims()[1];
+  const int64_t input_height = input.dims()[2];
+  const int64_t input_width = input.dims()[3];
+  const int64_t filter_num = filter.dims()[0];
+  const int64_t filter_height = filter.dims()[2];
+  const int64_t filter_width = filter.dims()[3];
+  const int64_t output_height = output->dims()[2];
+  const int64_t output_width = output->dims()[3];
+  const int64_t multiplier = filter_num / channels;
+  const int stride_h = strides[0], stride_w = strides[1];
+  const int dilation_h = dilations[0], dilation_w = dilations[1];
+  const int pad_top = paddings[0], pad_left = paddings[2];
+
+  std::vector<int64_t> col_begin(filter_width), col_end(filter_width);
+  for (int64_t kw = 0; kw < filter_width; ++kw) {
+    int64_t offset = kw * dilation_w - pad_left;
+    col_begin[kw] =
+        offset >= 0 ? 0 : (-offset + stride_w - 1) / stride_w;
+    col_end[kw] = input_width - 1 - offset < 0
+                      ? 0
+                      : std::min(output_width,
+                                 (input_width - 1 - offset) / stride_w + 1);
+  }
+
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t nk = 0; nk < batch_size * filter_num; ++nk) {
+    int64_t n = nk / filter_num;
+    int64_t k = nk % filter_num;
+    const T* in = input_data +
+                  (n * channels + k / multiplier) * input_height * input_width;
+    const T* weight = filter_data + k * filter_height * filter_width;
+    T* out = output_data + nk * output_height * output_width;
+    std::fill(out, out + output_height * output_width, static_cast<T>(0));
+    for (int64_t oh = 0; oh < output_height; ++oh) {
+      T* out_row = out + oh * output_width;
+      for (int64_t kh = 0; kh < filter_height; ++kh) {
+        int64_t h = oh * stride_h - pad_top + kh * dilation_h;
+        if (h < 0 || h >= input_height) continue;
+        const T* in_row = in + h * input_width;
+        for (int64_t kw = 0; kw < filter_width; ++kw) {
+          T w = weight[kh * filter_width + kw];
+          const T* in_col = in_row + kw * dilation_w - pad_left;
+          for (int64_t ow = col_begin[kw]; ow < col_end[kw]; ++ow) {
+            out_row[ow] += w * in_col[ow * stride_w];
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void CPUConvFunctor<T>::operator()(const platform::CPUDeviceContext& context,
+                                   CPUConvAlgo algo, const Tensor& input,
+                                   const Tensor& filter,
+                                   const std::vector<int>& strides,
+                                   const std::vector<int>& paddings,
+                                   const std::vector<int>& dilations,
+                                   Tensor* output) {
+  switch (algo) {
+    case CPUConvAlgo::kWinogradF2x3:
+      WinogradConv<T, 2>(context, input, filter, paddings, output);
+      break;
+    case CPUConvAlgo::kWinogradF4x3:
+      WinogradConv<T, 4>(context, input, filter, paddings, output);
+      break;
+    case CPUConvAlgo::kDepthwise:
+      DepthwiseConv<T>(input, filter, strides, paddings, dilations, output);
+      break;
+    default:
+      PADDLE_THROW(platform::errors::InvalidArgument(
+          "The im2col + gemm convolution is not computed by "
+          "CPUConvFunctor."));
+  }
+}
+
+template class CPUConvFunctor<float>;
+template class CPUConvFunctor<double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
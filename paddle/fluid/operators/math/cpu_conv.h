@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The algorithms of the 2-D convolution on CPU besides im2col + gemm.
+ *
+ * kWinogradF2x3 and kWinogradF4x3 are the Winograd F(2x2, 3x3) and
+ * F(4x4, 3x3), which need no im2col buffer and do fewer multiplications for
+ * 3x3 filters with stride 1. kDepthwise computes the depthwise convolution
+ * directly, whose gemm per group is too small to be efficient.
+ */
+enum class CPUConvAlgo {
+  kIm2ColGemm = 0,
+  kWinogradF2x3,
+  kWinogradF4x3,
+  kDepthwise,
+};
+
+/*
+ * \brief Select the algorithm by the shapes of the NCHW input and the
+ * filter, where paddings is {top, bottom, left, right}.
+ */
+CPUConvAlgo SelectCPUConvAlgo(const std::vector<int64_t>& input_shape,
+                              const std::vector<int64_t>& filter_shape,
+                              int groups, const std::vector<int>& strides,
+                              const std::vector<int>& paddings,
+                              const std::vector<int>& dilations);
+
+/*
+ * \brief Compute the 2-D convolution of the NCHW input by the algorithm
+ * other than kIm2ColGemm, whose paddings is {top, bottom, left, right}.
+ */
+template <typename T>
+class CPUConvFunctor {
+ public:
+  void operator()(const platform::CPUDeviceContext& context, CPUConvAlgo algo,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations,
+                  framework::Tensor* output);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
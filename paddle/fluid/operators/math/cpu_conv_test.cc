@@ -0,0 +1,109 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_conv.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace math = paddle::operators::math;
+
+// Compare the convolution of the selected algorithm with the naive one.
+void TestCPUConv(const std::vector<int64_t>& input_shape,
+                 const std::vector<int64_t>& filter_shape, int groups,
+                 const std::vector<int>& strides,
+                 const std::vector<int>& paddings,
+                 const std::vector<int>& dilations, math::CPUConvAlgo algo) {
+  ASSERT_EQ(math::SelectCPUConvAlgo(input_shape, filter_shape, groups,
+                                    strides, paddings, dilations),
+            algo);
+  int64_t n = input_shape[0], c = input_shape[1], h = input_shape[2],
+          w = input_shape[3];
+  int64_t k = filter_shape[0], kh = filter_shape[2], kw = filter_shape[3];
+  int64_t oh = (h + paddings[0] + paddings[1] - dilations[0] * (kh - 1) - 1) /
+                   strides[0] +
+               1;
+  int64_t ow = (w + paddings[2] + paddings[3] - dilations[1] * (kw - 1) - 1) /
+                   strides[1] +
+               1;
+
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  paddle::framework::Tensor input, filter, output;
+  double* input_data =
+      input.mutable_data<double>(paddle::framework::make_ddim(input_shape),
+                                 place);
+  double* filter_data =
+      filter.mutable_data<double>(paddle::framework::make_ddim(filter_shape),
+                                  place);
+  double* output_data = output.mutable_data<double>({n, k, oh, ow}, place);
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<double> dist(-1, 1);
+  for (int64_t i = 0; i < input.numel(); ++i) input_data[i] = dist(rng);
+  for (int64_t i = 0; i < filter.numel(); ++i) filter_data[i] = dist(rng);
+
+  math::CPUConvFunctor<double> conv;
+  conv(context, algo, input, filter, strides, paddings, dilations, &output);
+
+  int64_t group_c = c / groups, group_k = k / groups;
+  for (int64_t b = 0; b < n; ++b) {
+    for (int64_t o = 0; o < k; ++o) {
+      for (int64_t y = 0; y < oh; ++y) {
+        for (int64_t x = 0; x < ow; ++x) {
+          double expected = 0;
+          for (int64_t i = 0; i < group_c; ++i) {
+            int64_t plane = b * c + o / group_k * group_c + i;
+            for (int64_t fy = 0; fy < kh; ++fy) {
+              for (int64_t fx = 0; fx < kw; ++fx) {
+                int64_t iy = y * strides[0] - paddings[0] + fy * dilations[0];
+                int64_t ix = x * strides[1] - paddings[2] + fx * dilations[1];
+                if (iy < 0 || iy >= h || ix < 0 || ix >= w) continue;
+                expected += input_data[(plane * h + iy) * w + ix] *
+                            filter_data[((o * group_c + i) * kh + fy) * kw +
+                                        fx];
+              }
+            }
+          }
+          ASSERT_NEAR(output_data[((b * k + o) * oh + y) * ow + x], expected,
+                      1e-9);
+        }
+      }
+    }
+  }
+}
+
+TEST(CPUConv, Winograd) {
+  TestCPUConv({2, 16, 9, 11}, {16, 16, 3, 3}, 1, {1, 1}, {1, 1, 1, 1},
+              {1, 1}, math::CPUConvAlgo::kWinogradF2x3);
+  TestCPUConv({1, 16, 7, 6}, {16, 16, 3, 3}, 1, {1, 1}, {0, 0, 0, 0},
+              {1, 1}, math::CPUConvAlgo::kWinogradF2x3);
+  TestCPUConv({2, 16, 20, 23}, {17, 16, 3, 3}, 1, {1, 1}, {1, 0, 2, 1},
+              {1, 1}, math::CPUConvAlgo::kWinogradF4x3);
+}
+
+TEST(CPUConv, Depthwise) {
+  TestCPUConv({2, 8, 13, 12}, {8, 1, 3, 3}, 8, {1, 1}, {1, 1, 1, 1}, {1, 1},
+              math::CPUConvAlgo::kDepthwise);
+  TestCPUConv({2, 4, 13, 12}, {8, 1, 5, 3}, 4, {2, 3}, {2, 1, 0, 3}, {2, 1},
+              math::CPUConvAlgo::kDepthwise);
+}
+
+TEST(CPUConv, SelectIm2ColGemm) {
+  EXPECT_EQ(math::SelectCPUConvAlgo({1, 8, 13, 12}, {8, 8, 3, 3}, 1, {1, 1},
+                                    {1, 1, 1, 1}, {1, 1}),
+            math::CPUConvAlgo::kIm2ColGemm);
+  EXPECT_EQ(math::SelectCPUConvAlgo({1, 32, 13, 12}, {32, 32, 3, 3}, 1,
+                                    {2, 2}, {1, 1, 1, 1}, {1, 1}),
+            math::CPUConvAlgo::kIm2ColGemm);
+}
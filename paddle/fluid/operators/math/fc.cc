@@ -13,6 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/fc.h"
+#ifdef PADDLE_WITH_MKLDNN
+#include <mkldnn.h>
+#endif
+#include <algorithm>
+#include <cmath>
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 
@@ -26,7 +31,8 @@ class FCFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context, const int M,
                   const int N, const int K, const T* X, const T* W, T* Y,
                   const T* B = nullptr, bool relu = false,
-                  bool padding_weights = false) {
+                  bool padding_weights = false,
+                  const PackedGemmWeight<T>* packed_w = nullptr) {
     auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
     framework::Tensor Y1;
     T* Y1_data = nullptr;
@@ -44,6 +50,8 @@ class FCFunctor<platform::CPUDeviceContext, T> {
       }
       blas.GEMM(false, false, M, N, K, static_cast<T>(1.0), X1_data, KK, W, NN,
                 static_cast<T>(0.0), Y1_data, NN);
+    } else if (packed_w) {
+      packed_w->MatMul(context, M, X, Y);
     } else {
       blas.MatMul(M, N, K, X, W, Y);
     }
@@ -82,6 +90,53 @@ class FCFunctor<platform::CPUDeviceContext, T> {
 template class FCFunctor<platform::CPUDeviceContext, float>;
 template class FCFunctor<platform::CPUDeviceContext, double>;
 
+template <>
+void QuantizedFCFunctor<platform::CPUDeviceContext>::operator()(
+    const platform::CPUDeviceContext& context, const int M, const int N,
+    const int K, const float* X, const float x_scale, const int8_t* W,
+    const float* w_scales, float* Y, const float* B) {
+  framework::Tensor X1, Y1;
+  int8_t* X1_data = X1.mutable_data<int8_t>({M * K}, platform::CPUPlace());
+  int32_t* Y1_data = Y1.mutable_data<int32_t>({M * N}, platform::CPUPlace());
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < M * K; i++) {
+    float x = std::round(X[i] * x_scale);
+    X1_data[i] = static_cast<int8_t>(std::min(std::max(x, -128.f), 127.f));
+  }
+#ifdef PADDLE_WITH_MKLDNN
+  const int32_t offset = 0;
+  auto status = mkldnn_gemm_s8s8s32('N', 'N', 'F', M, N, K, 1.f, X1_data, K,
+                                    0, W, N, 0, 0.f, Y1_data, N, &offset);
+  PADDLE_ENFORCE_EQ(status, mkldnn_success,
+                    platform::errors::External(
+                        "The int8 GEMM of MKL-DNN fails with status %d.",
+                        static_cast<int>(status)));
+#else
+  for (int i = 0; i < M; i++) {
+    int32_t* y = Y1_data + i * N;
+    std::fill(y, y + N, 0);
+    for (int k = 0; k < K; k++) {
+      int32_t x = X1_data[i * K + k];
+      const int8_t* w = W + k * N;
+      for (int j = 0; j < N; j++) {
+        y[j] += x * w[j];
+      }
+    }
+  }
+#endif
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      Y[i * N + j] = Y1_data[i * N + j] / (x_scale * w_scales[j]) +
+                     (B ? B[j] : 0.f);
+    }
+  }
+}
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
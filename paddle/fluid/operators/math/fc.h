@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <string>
+#include "paddle/fluid/operators/math/packed_gemm_weight.h"
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
@@ -27,9 +28,29 @@ class FCFunctor {
   void operator()(const DeviceContext& context, const int M, const int N,
                   const int K, const T* X, const T* W, T* Y,
                   const T* B = nullptr, bool relu = false,
-                  bool weight_pass = false);
+                  bool weight_pass = false,
+                  const PackedGemmWeight<T>* packed_w = nullptr);
 };
 
+// The FC of the int8 weights W of K x N, whose columns are quantized by the
+// scales w_scales, i.e. W = round(W_fp32 * w_scales). The input X is
+// quantized by x_scale on the fly, and the int32 product is dequantized to
+// the fp32 output Y.
+template <typename DeviceContext>
+class QuantizedFCFunctor {
+ public:
+  void operator()(const DeviceContext& context, const int M, const int N,
+                  const int K, const float* X, const float x_scale,
+                  const int8_t* W, const float* w_scales, float* Y,
+                  const float* B = nullptr);
+};
+
+template <>
+void QuantizedFCFunctor<platform::CPUDeviceContext>::operator()(
+    const platform::CPUDeviceContext& context, const int M, const int N,
+    const int K, const float* X, const float x_scale, const int8_t* W,
+    const float* w_scales, float* Y, const float* B);
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
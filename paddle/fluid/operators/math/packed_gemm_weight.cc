@@ -0,0 +1,157 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_gemm_weight.h"
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "gflags/gflags.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+DECLARE_bool(use_packed_gemm_weights);
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+PackedGemmWeight<T>::PackedGemmWeight(
+    const platform::CPUDeviceContext& context, const T* W, const int K,
+    const int N)
+    : K_(K), N_(N) {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  packed_ = blas.GEMM_ALLOC(CblasBMatrix, 1 /*height of C*/, N, K);
+  PADDLE_ENFORCE_NOT_NULL(
+      packed_, platform::errors::ResourceExhausted(
+                   "Failed to allocate the packed weight of %d x %d.", K, N));
+  blas.GEMM_PACK(CblasBMatrix, CblasNoTrans, 1 /*height of C*/, N, K, T(1.0),
+                 W, N, packed_);
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The packed GEMM weights are only supported with MKLML."));
+#endif
+}
+
+template <typename T>
+PackedGemmWeight<T>::~PackedGemmWeight() {
+#ifdef PADDLE_WITH_MKLML
+  if (packed_) {
+    CBlas<T>::GEMM_FREE(packed_);
+  }
+#endif
+}
+
+template <typename T>
+void PackedGemmWeight<T>::MatMul(const platform::CPUDeviceContext& context,
+                                 const int M, const T* X, T* Y) const {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  blas.GEMM_COMPUTE(CblasNoTrans, CblasPacked, M, N_, K_, X, K_, packed_, N_,
+                    T(0.0), Y, N_);
+#endif
+}
+
+namespace {
+
+template <typename T>
+struct PackedGemmWeightEntry {
+  std::weak_ptr<memory::Allocation> holder;
+  size_t offset{0};
+  uint64_t version{0};
+  int K{0};
+  int N{0};
+  // nullptr if it is used only once since it is changed
+  std::shared_ptr<const PackedGemmWeight<T>> packed;
+
+  bool IsValidFor(const framework::Tensor& w, const int K,
+                  const int N) const {
+    return !holder.expired() && holder.lock() == w.Holder() &&
+           offset == w.offset() && version == w.version() && this->K == K &&
+           this->N == N;
+  }
+};
+
+template <typename T>
+class PackedGemmWeightCache {
+ public:
+  static PackedGemmWeightCache& Instance() {
+    static PackedGemmWeightCache cache;
+    return cache;
+  }
+
+  std::shared_ptr<const PackedGemmWeight<T>> Get(
+      const platform::CPUDeviceContext& context, const framework::Tensor& w,
+      const int K, const int N) {
+    std::lock_guard<std::mutex> guard(mu_);
+    auto iter = entries_.find(&w);
+    if (iter == entries_.end()) {
+      // the entries of the weights released are dropped with the new ones
+      for (auto it = entries_.begin(); it != entries_.end();) {
+        it = it->second.holder.expired() ? entries_.erase(it) : ++it;
+      }
+      iter = entries_.emplace(&w, PackedGemmWeightEntry<T>()).first;
+    }
+
+    auto& entry = iter->second;
+    if (!entry.IsValidFor(w, K, N)) {
+      entry.holder = w.Holder();
+      entry.offset = w.offset();
+      entry.version = w.version();
+      entry.K = K;
+      entry.N = N;
+      entry.packed.reset();
+      return nullptr;
+    }
+    if (!entry.packed) {
+      VLOG(3) << "Pack the GEMM weight of " << K << " x " << N;
+      entry.packed.reset(new PackedGemmWeight<T>(context, w.data<T>(), K, N));
+    }
+    return entry.packed;
+  }
+
+ private:
+  PackedGemmWeightCache() = default;
+
+  std::mutex mu_;
+  std::unordered_map<const framework::Tensor*, PackedGemmWeightEntry<T>>
+      entries_;
+};
+
+}  // namespace
+
+template <typename T>
+std::shared_ptr<const PackedGemmWeight<T>> GetPackedGemmWeight(
+    const platform::CPUDeviceContext& context, const framework::Tensor& w,
+    const int K, const int N) {
+#ifdef PADDLE_WITH_MKLML
+  if (FLAGS_use_packed_gemm_weights) {
+    return PackedGemmWeightCache<T>::Instance().Get(context, w, K, N);
+  }
+#endif
+  return nullptr;
+}
+
+template class PackedGemmWeight<float>;
+template class PackedGemmWeight<double>;
+
+template std::shared_ptr<const PackedGemmWeight<float>> GetPackedGemmWeight(
+    const platform::CPUDeviceContext& context, const framework::Tensor& w,
+    const int K, const int N);
+template std::shared_ptr<const PackedGemmWeight<double>> GetPackedGemmWeight(
+    const platform::CPUDeviceContext& context, const framework::Tensor& w,
+    const int K, const int N);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
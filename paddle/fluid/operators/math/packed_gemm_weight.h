@@ -0,0 +1,71 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The weight W of K x N packed by cblas_?gemm_pack of MKL, which performs
+// the GEMM faster than the row-major W, since W is not packed by every GEMM.
+template <typename T>
+class PackedGemmWeight {
+ public:
+  PackedGemmWeight(const platform::CPUDeviceContext& context, const T* W,
+                   const int K, const int N);
+
+  ~PackedGemmWeight();
+
+  // Y = X * W, where X is of M x K.
+  void MatMul(const platform::CPUDeviceContext& context, const int M,
+              const T* X, T* Y) const;
+
+  int K() const { return K_; }
+  int N() const { return N_; }
+
+ private:
+  T* packed_{nullptr};
+  int K_;
+  int N_;
+
+  DISABLE_COPY_AND_ASSIGN(PackedGemmWeight);
+};
+
+// Returns the packed weight of w of K x N when FLAGS_use_packed_gemm_weights
+// is set, otherwise nullptr. The packed weights are cached per tensor, and
+// repacked once w is changed, see Tensor::version. A weight is packed when it
+// is used the second time without being changed, so that the weights changed
+// by every iteration are never packed.
+template <typename T>
+std::shared_ptr<const PackedGemmWeight<T>> GetPackedGemmWeight(
+    const platform::CPUDeviceContext& context, const framework::Tensor& w,
+    const int K, const int N);
+
+#ifdef PADDLE_WITH_CUDA
+template <typename T>
+inline std::shared_ptr<const PackedGemmWeight<T>> GetPackedGemmWeight(
+    const platform::CUDADeviceContext& context, const framework::Tensor& w,
+    const int K, const int N) {
+  return nullptr;
+}
+#endif
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,72 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_gemm_weight.h"
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+DECLARE_bool(use_packed_gemm_weights);
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+TEST(PackedGemmWeight, cache) {
+  const int M = 3, K = 4, N = 5;
+  platform::CPUDeviceContext context;
+  framework::Tensor w;
+  float* w_data = w.mutable_data<float>({K, N}, platform::CPUPlace());
+  for (int i = 0; i < K * N; ++i) {
+    w_data[i] = static_cast<float>(i % 7) - 3.f;
+  }
+
+  FLAGS_use_packed_gemm_weights = false;
+  EXPECT_EQ(GetPackedGemmWeight<float>(context, w, K, N), nullptr);
+  FLAGS_use_packed_gemm_weights = true;
+#ifdef PADDLE_WITH_MKLML
+  // packed when it is used the second time
+  EXPECT_EQ(GetPackedGemmWeight<float>(context, w, K, N), nullptr);
+  auto packed = GetPackedGemmWeight<float>(context, w, K, N);
+  ASSERT_NE(packed, nullptr);
+  EXPECT_EQ(GetPackedGemmWeight<float>(context, w, K, N), packed);
+
+  std::vector<float> x(M * K), y(M * N);
+  for (int i = 0; i < M * K; ++i) {
+    x[i] = static_cast<float>(i % 5) - 2.f;
+  }
+  packed->MatMul(context, M, x.data(), y.data());
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      float expected = 0.f;
+      for (int k = 0; k < K; ++k) {
+        expected += x[i * K + k] * w_data[k * N + j];
+      }
+      EXPECT_FLOAT_EQ(y[i * N + j], expected);
+    }
+  }
+
+  // repacked once it is changed
+  w.mutable_data<float>(platform::CPUPlace())[0] = 10.f;
+  EXPECT_EQ(GetPackedGemmWeight<float>(context, w, K, N), nullptr);
+  EXPECT_NE(GetPackedGemmWeight<float>(context, w, K, N), nullptr);
+#else
+  EXPECT_EQ(GetPackedGemmWeight<float>(context, w, K, N), nullptr);
+#endif
+  FLAGS_use_packed_gemm_weights = false;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
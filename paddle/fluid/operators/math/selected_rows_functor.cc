@@ -254,6 +254,9 @@ elementwise_add_to(const DeviceContext& ctx, BlasT<DeviceContext, T>* blas,
   }
 }
 
+// The merged rows are summed in parallel if the input has more elements.
+constexpr int64_t kMergeAddParallelNumel = 1 << 16;
+
 template <typename T>
 struct MergeAdd<platform::CPUDeviceContext, T> {
   framework::SelectedRows operator()(const platform::CPUDeviceContext& context,
@@ -357,19 +360,46 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
         rows_to_id[merge_rows[i]] = i;
       }
 
-      auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+      // Group the input rows by the merged rows in the order of the inputs,
+      // so that each merged row is summed by one thread without the locks
+      // and the result does not depend on the number of the threads.
+      std::vector<size_t> offsets(merge_rows.size() + 1, 0);
+      std::vector<size_t> out_ids;
+      out_ids.reserve(row_num);
+      for (auto* input : inputs) {
+        for (auto row : input->rows()) {
+          out_ids.push_back(rows_to_id[row]);
+          ++offsets[out_ids.back() + 1];
+        }
+      }
+      for (size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+      }
+      std::vector<const T*> in_rows(row_num);
+      std::vector<size_t> pos(offsets.begin(), offsets.end() - 1);
+      size_t k = 0;
       for (auto* input : inputs) {
         if (input->rows().size() == 0) {
           continue;
         }
         auto* input_data = input->value().data<T>();
-        auto& input_rows = input->rows();
+        for (size_t i = 0; i < input->rows().size(); ++i, ++k) {
+          in_rows[pos[out_ids[k]]++] = &input_data[i * input_width];
+        }
+      }
 
-        for (size_t i = 0; i < input_rows.size(); i++) {
-          size_t out_i = rows_to_id[input_rows[i]];
+      auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+      int64_t merged_num = static_cast<int64_t>(merge_rows.size());
+#ifdef PADDLE_WITH_MKLML
+      bool parallel = static_cast<int64_t>(row_num) * input_width >=
+                      kMergeAddParallelNumel;
+#pragma omp parallel for if (parallel)
+#endif
+      for (int64_t i = 0; i < merged_num; ++i) {
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
           elementwise_add_to<platform::CPUDeviceContext, T>(
-              context, &blas, static_cast<size_t>(input_width),
-              &input_data[i * input_width], &out_data[out_i * input_width]);
+              context, &blas, static_cast<size_t>(input_width), in_rows[j],
+              &out_data[i * input_width]);
         }
       }
     }
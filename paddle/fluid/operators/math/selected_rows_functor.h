@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -105,6 +106,79 @@ struct MergeAverage {
                   framework::SelectedRows* output);
 };
 
+// The grads with at least kMergeUpdateParallelRows rows are merged and
+// updated by kMergeUpdateShardNum shards in parallel.
+constexpr size_t kMergeUpdateParallelRows = 1 << 12;
+constexpr int kMergeUpdateShardNum = 16;
+
+/*
+ * Merge the duplicated rows of the CPU SelectedRows grad, and call
+ * update(row, value) once for each distinct row with the sum of the values
+ * of the row, added in the order of the rows as MergeAdd does, but without
+ * creating the merged SelectedRows. The rows are hashed to the shards,
+ * which are run in parallel, so that a row is always updated by one thread,
+ * and update must not throw. The rows are checked to be in [0, height).
+ */
+template <typename T, typename Update>
+void MergeAndUpdate(const framework::SelectedRows& grad, int64_t height,
+                    Update update) {
+  size_t num = grad.rows().size();
+  if (num == 0) {
+    return;
+  }
+  const int64_t* rows = grad.rows().data();
+  const T* values = grad.value().data<T>();
+  int64_t width = grad.value().numel() / static_cast<int64_t>(num);
+
+  int shard_num = 1;
+#ifdef PADDLE_WITH_MKLML
+  if (num >= kMergeUpdateParallelRows) {
+    shard_num = kMergeUpdateShardNum;
+  }
+#endif
+  // the positions of the rows of each shard
+  std::vector<std::vector<size_t>> shards(shard_num);
+  for (size_t i = 0; i < num; ++i) {
+    PADDLE_ENFORCE_EQ(
+        rows[i] >= 0 && rows[i] < height, true,
+        platform::errors::OutOfRange(
+            "The row %d of the grad should be in [0, %d).", rows[i], height));
+    int shard = shard_num == 1
+                    ? 0
+                    : static_cast<int>((static_cast<uint64_t>(rows[i]) *
+                                        0x9E3779B97F4A7C15ULL) >>
+                                       60);
+    shards[shard].push_back(i);
+  }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (int s = 0; s < shard_num; ++s) {
+    auto& positions = shards[s];
+    std::stable_sort(positions.begin(), positions.end(),
+                     [rows](size_t a, size_t b) { return rows[a] < rows[b]; });
+    std::vector<T> merged;
+    for (size_t k = 0; k < positions.size();) {
+      int64_t row = rows[positions[k]];
+      const T* value = values + positions[k] * width;
+      size_t end = k + 1;
+      if (end < positions.size() && rows[positions[end]] == row) {
+        merged.assign(value, value + width);
+        for (; end < positions.size() && rows[positions[end]] == row; ++end) {
+          const T* dup = values + positions[end] * width;
+          for (int64_t j = 0; j < width; ++j) {
+            merged[j] += dup[j];
+          }
+        }
+        value = merged.data();
+      }
+      update(row, value);
+      k = end;
+    }
+  }
+}
+
 enum class ScatterOps { ASSIGN, ADD, SUB, SUBBY, MUL, DIV, DIVBY };
 
 // out = selected_rows_in / tensor
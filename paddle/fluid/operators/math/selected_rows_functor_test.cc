@@ -403,6 +403,52 @@ TEST(selected_rows_functor, cpu_merge_add_multi) {
   }
 }
 
+TEST(selected_rows_functor, cpu_merge_add_multi_large) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+
+  // enough rows to be merged in parallel
+  int64_t height = 1000;
+  int64_t row_numel = 64;
+  std::vector<std::unique_ptr<paddle::framework::SelectedRows>> selected_rows;
+  std::vector<const paddle::framework::SelectedRows*> inputs;
+  for (int n = 0; n < 2; ++n) {
+    std::vector<int64_t> rows;
+    for (int64_t i = 0; i < 4 * height; ++i) {
+      rows.push_back((i * 7 + n) % height);
+    }
+    selected_rows.emplace_back(
+        new paddle::framework::SelectedRows(rows, height));
+    auto* value = selected_rows.back()->mutable_value();
+    auto* data = value->mutable_data<float>(
+        paddle::framework::make_ddim(
+            {static_cast<int64_t>(rows.size()), row_numel}),
+        cpu_place);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      for (int64_t j = 0; j < row_numel; ++j) {
+        data[i * row_numel + j] = rows[i] + n;
+      }
+    }
+    inputs.push_back(selected_rows.back().get());
+  }
+
+  paddle::framework::SelectedRows output;
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add_functor;
+  merge_add_functor(ctx, inputs, &output, true);
+
+  ASSERT_EQ(output.rows().size(), static_cast<size_t>(height));
+  auto* out_data = output.value().data<float>();
+  for (int64_t i = 0; i < height; ++i) {
+    EXPECT_EQ(output.rows()[i], i);
+    // each row is added 4 times by each input
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j], 8 * i + 4);
+    }
+  }
+}
+
 TEST(selected_rows_functor, cpu_merge_add_multi_noduplicated) {
   paddle::platform::CPUPlace cpu_place;
   paddle::platform::CPUDeviceContext ctx(cpu_place);
@@ -466,6 +512,61 @@ TEST(selected_rows_functor, cpu_merge_add_multi_noduplicated) {
   }
 }
 
+TEST(selected_rows_functor, cpu_merge_and_update) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+  int64_t height = 1000;
+  int64_t row_numel = 4;
+
+  // more rows than kMergeUpdateParallelRows, to be merged by the shards
+  std::vector<int64_t> rows;
+  for (int64_t i = 0; i < 10000; ++i) {
+    rows.push_back((i * 7) % height);
+  }
+  paddle::framework::SelectedRows selected_rows(rows, height);
+  auto* in_value = selected_rows.mutable_value();
+  float* in_data = in_value->mutable_data<float>(
+      paddle::framework::make_ddim(
+          {static_cast<int64_t>(rows.size()), row_numel}),
+      cpu_place);
+  for (int64_t i = 0; i < in_value->numel(); ++i) {
+    in_data[i] = static_cast<float>(i % 13);
+  }
+
+  std::vector<float> updated(height * row_numel, 0.0);
+  std::vector<int> update_count(height, 0);
+  paddle::operators::math::scatter::MergeAndUpdate<float>(
+      selected_rows, height, [&](int64_t row, const float* value) {
+        ++update_count[row];
+        for (int64_t j = 0; j < row_numel; ++j) {
+          updated[row * row_numel + j] = value[j];
+        }
+      });
+
+  paddle::framework::SelectedRows merged;
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add_functor;
+  merge_add_functor(ctx, selected_rows, &merged, true);
+  ASSERT_EQ(merged.rows().size(), static_cast<size_t>(height));
+  auto* merged_data = merged.value().data<float>();
+  for (size_t i = 0; i < merged.rows().size(); ++i) {
+    int64_t row = merged.rows()[i];
+    EXPECT_EQ(update_count[row], 1);
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(updated[row * row_numel + j], merged_data[i * row_numel + j]);
+    }
+  }
+
+  std::vector<int64_t> out_of_range{0, height};
+  paddle::framework::SelectedRows invalid(out_of_range, height);
+  invalid.mutable_value()->mutable_data<float>(
+      paddle::framework::make_ddim({2, row_numel}), cpu_place);
+  EXPECT_THROW(paddle::operators::math::scatter::MergeAndUpdate<float>(
+                   invalid, height, [](int64_t row, const float* value) {}),
+               paddle::platform::EnforceNotMet);
+}
+
 TEST(selected_rows_functor, cpu_sum_to) {
   paddle::platform::CPUPlace cpu_place;
   paddle::platform::CPUDeviceContext ctx(cpu_place);
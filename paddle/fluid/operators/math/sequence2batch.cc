@@ -24,7 +24,8 @@ class CopyMatrixRowsFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::Tensor& src,
                   framework::Vector<size_t> index_lod, framework::Tensor* dst,
-                  bool is_src_index) {
+                  bool is_src_index,
+                  const framework::Tensor* bias = nullptr) {
     size_t* index = index_lod.data();
     auto src_dims = src.dims();
     auto dst_dims = dst->dims();
@@ -39,7 +40,21 @@ class CopyMatrixRowsFunctor<platform::CPUDeviceContext, T> {
     auto* src_data = src.data<T>();
     auto* dst_data = dst->data<T>();
     const int sz = width * sizeof(T);
-    if (is_src_index) {
+    if (bias) {
+      PADDLE_ENFORCE_EQ(bias->numel(), width,
+                        platform::errors::InvalidArgument(
+                            "The size of bias should be the width %d of src, "
+                            "but got %d.",
+                            width, bias->numel()));
+      const T* bias_data = bias->data<T>();
+      for (int i = 0; i < height; ++i) {
+        const T* src_row = src_data + (is_src_index ? index[i] : i) * width;
+        T* dst_row = dst_data + (is_src_index ? i : index[i]) * width;
+        for (int j = 0; j < width; ++j) {
+          dst_row[j] = src_row[j] + bias_data[j];
+        }
+      }
+    } else if (is_src_index) {
       for (int i = 0; i < height; ++i) {
         memcpy(dst_data + i * width, src_data + index[i] * width, sz);
       }
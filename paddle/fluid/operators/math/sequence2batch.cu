@@ -19,8 +19,8 @@ namespace math {
 
 template <typename T, int BlockDimX, int BlockDimY, int GridDimX>
 __global__ void CopyMatrixRowsKernel(const T* src, T* dst, const size_t* index,
-                                     int64_t height, int64_t width,
-                                     bool is_src_index) {
+                                     const T* bias, int64_t height,
+                                     int64_t width, bool is_src_index) {
   int idx = threadIdx.x;
   int idy = threadIdx.y;
   int id = blockIdx.x + idy * GridDimX;
@@ -29,8 +29,14 @@ __global__ void CopyMatrixRowsKernel(const T* src, T* dst, const size_t* index,
     int dst_idx = is_src_index ? id : index[id];
     const T* src_data = src + src_idx * width;
     T* dst_data = dst + dst_idx * width;
-    for (int i = idx; i < width; i += BlockDimX) {
-      dst_data[i] = src_data[i];
+    if (bias) {
+      for (int i = idx; i < width; i += BlockDimX) {
+        dst_data[i] = src_data[i] + bias[i];
+      }
+    } else {
+      for (int i = idx; i < width; i += BlockDimX) {
+        dst_data[i] = src_data[i];
+      }
     }
     id += BlockDimY * GridDimX;
   }
@@ -42,7 +48,8 @@ class CopyMatrixRowsFunctor<platform::CUDADeviceContext, T> {
   void operator()(const platform::CUDADeviceContext& context,
                   const framework::Tensor& src,
                   framework::Vector<size_t> index_lod, framework::Tensor* dst,
-                  bool is_src_index) {
+                  bool is_src_index,
+                  const framework::Tensor* bias = nullptr) {
     auto src_dims = src.dims();
     auto dst_dims = dst->dims();
     PADDLE_ENFORCE_EQ(src_dims.size(), 2,
@@ -55,13 +62,22 @@ class CopyMatrixRowsFunctor<platform::CUDADeviceContext, T> {
     auto width = dst_dims[1];
     auto* src_data = src.data<T>();
     auto* dst_data = dst->data<T>();
+    const T* bias_data = nullptr;
+    if (bias) {
+      PADDLE_ENFORCE_EQ(bias->numel(), width,
+                        platform::errors::InvalidArgument(
+                            "The size of bias should be the width %d of src, "
+                            "but got %d.",
+                            width, bias->numel()));
+      bias_data = bias->data<T>();
+    }
 
     dim3 threads(128, 8);
     dim3 grid(8, 1);
     auto stream = context.stream();
     CopyMatrixRowsKernel<T, 128, 8, 8><<<grid, threads, 0, stream>>>(
-        src_data, dst_data, index_lod.CUDAData(context.GetPlace()), height,
-        width, is_src_index);
+        src_data, dst_data, index_lod.CUDAData(context.GetPlace()), bias_data,
+        height, width, is_src_index);
   }
 };
 
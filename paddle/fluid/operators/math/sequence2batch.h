@@ -36,11 +36,23 @@ class CopyMatrixRowsFunctor {
   // If is_src_index is false,
   // copy the input src to the indexed rows of output dst.
   // The indexed rows are based on the input index.
+  // If bias is not null, it is added to each row while copying.
   void operator()(const DeviceContext& context, const framework::Tensor& src,
                   framework::Vector<size_t> index_lod, framework::Tensor* dst,
-                  bool is_src_index);
+                  bool is_src_index, const framework::Tensor* bias = nullptr);
 };
 
+// Whether the rows of the batch of batch_lod are in the order of the
+// LoDTensor, as for one sequence or the sequences of length 1 not reversed,
+// so that the batch can share the memory of the LoDTensor without reorder.
+inline bool IsIdentityBatchOrder(const framework::LoD& batch_lod) {
+  const auto& index = batch_lod[1];
+  for (size_t i = 0; i < index.size(); ++i) {
+    if (index[i] != i) return false;
+  }
+  return true;
+}
+
 template <typename DeviceContext, typename T>
 class LoDTensor2BatchFunctor {
   // Calculate the length of each sequence and
@@ -58,10 +70,13 @@ class LoDTensor2BatchFunctor {
   };
 
  public:
+  // If bias is not null, it is added to each row of the batch in the same
+  // pass as the reorder.
   void operator()(const DeviceContext& context,
                   const framework::LoDTensor& lod_tensor,
                   framework::LoDTensor* batch, bool is_cal_batch_lod,
-                  bool is_reverse = false) const {
+                  bool is_reverse = false,
+                  const framework::Tensor* bias = nullptr) const {
     if (!is_cal_batch_lod) {
       auto lods = batch->lod();
       PADDLE_ENFORCE_GT(lods.size(), 2UL,
@@ -71,7 +86,7 @@ class LoDTensor2BatchFunctor {
           lods[1].size(), static_cast<size_t>(lod_tensor.dims()[0]),
           "The LoD information should be consistent with the dims.");
       CopyMatrixRowsFunctor<DeviceContext, T> to_batch;
-      to_batch(context, lod_tensor, lods[1], batch, true);
+      to_batch(context, lod_tensor, lods[1], batch, true, bias);
       return;
     }
 
@@ -86,8 +101,11 @@ class LoDTensor2BatchFunctor {
       seq_info.emplace_back(lod[seq_id], length, seq_id);
     }
 
-    std::sort(seq_info.begin(), seq_info.end(),
-              [](SeqInfo a, SeqInfo b) { return a.length > b.length; });
+    // the sequences of the same length are kept in order, so that the batch
+    // of the sequences of length 1 is in the order of lod_tensor
+    std::stable_sort(
+        seq_info.begin(), seq_info.end(),
+        [](const SeqInfo& a, const SeqInfo& b) { return a.length > b.length; });
 
     // Calculate the start position of each batch.
     // example:  sequences = {s0, s1, s2}
@@ -150,7 +168,7 @@ class LoDTensor2BatchFunctor {
     batch->set_lod(batch_lods);
 
     CopyMatrixRowsFunctor<DeviceContext, T> to_batch;
-    to_batch(context, lod_tensor, batch_lods[1], batch, true);
+    to_batch(context, lod_tensor, batch_lods[1], batch, true, bias);
   }
 };
 
@@ -0,0 +1,115 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The sequences are processed in parallel if they have more elements.
+constexpr int64_t kSequenceParallelNumel = 1 << 16;
+// The chunks of the sequences for each thread, which are scheduled
+// dynamically to balance the rest of the cost.
+constexpr size_t kSequenceChunksPerThread = 4;
+
+/*
+ * \brief Split the num_seq sequences of offsets into at most num_chunks
+ * contiguous chunks of about the same cost, where the cost of a sequence is
+ * its number of rows plus one, so that the empty sequences are counted.
+ * The c-th chunk is the sequences [bounds[c], bounds[c + 1]).
+ */
+inline std::vector<size_t> SplitSequences(const size_t* offsets,
+                                          size_t num_seq, size_t num_chunks) {
+  auto cost = [offsets](size_t i) { return offsets[i] - offsets[0] + i; };
+  size_t total = cost(num_seq);
+  std::vector<size_t> bounds(1, 0);
+  for (size_t c = 1; c < num_chunks; ++c) {
+    size_t target = total * c / num_chunks;
+    // The first sequence whose cost before it is at least target.
+    size_t lo = bounds.back();
+    size_t hi = num_seq;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (cost(mid) < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo > bounds.back() && lo < num_seq) {
+      bounds.push_back(lo);
+    }
+  }
+  bounds.push_back(num_seq);
+  return bounds;
+}
+
+/*
+ * \brief Call func(begin, end) on the chunks of the sequences [begin, end)
+ * of offsets, which are balanced by the rows and run in parallel if the rows
+ * of width elements are more than kSequenceParallelNumel elements.
+ *
+ * The offsets should be on CPU, e.g. the data of a level of the LoD, and
+ * func should only write the rows of its own sequences. If func throws, the
+ * first exception is rethrown after all the chunks finish.
+ */
+template <typename Func>
+void ParallelForSequences(const size_t* offsets, size_t num_seq,
+                          int64_t width, Func&& func) {
+  size_t num_chunks = 1;
+#ifdef PADDLE_WITH_MKLML
+  int64_t numel = static_cast<int64_t>(offsets[num_seq] - offsets[0]) * width;
+  if (numel >= kSequenceParallelNumel) {
+    num_chunks = std::min(
+        num_seq, static_cast<size_t>(omp_get_max_threads()) *
+                     kSequenceChunksPerThread);
+  }
+#endif
+  if (num_chunks <= 1) {
+    func(static_cast<size_t>(0), num_seq);
+    return;
+  }
+  std::vector<size_t> bounds = SplitSequences(offsets, num_seq, num_chunks);
+  int64_t chunks = static_cast<int64_t>(bounds.size()) - 1;
+  // an exception can not escape from the parallel region
+  std::exception_ptr error;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t c = 0; c < chunks; ++c) {
+    try {
+      func(bounds[c], bounds[c + 1]);
+    } catch (...) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp critical
+#endif
+      if (!error) error = std::current_exception();
+    }
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
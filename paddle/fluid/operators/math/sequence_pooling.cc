@@ -12,11 +12,15 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <string>
 
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/sequence_parallel.h"
 #include "paddle/fluid/operators/math/sequence_pooling.h"
 
 namespace paddle {
@@ -32,6 +36,9 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// The CPU functors process the sequences in parallel by ParallelForSequences,
+// each chunk of which only writes the rows of its own sequences.
+
 template <typename T, bool is_test>
 class MaxSeqPoolFunctor {
  public:
@@ -53,34 +60,36 @@ class MaxSeqPoolFunctor {
                       "The dimension of index and output shall be same.");
 
     auto lod_level = input.lod().size();
-    auto starts = input.lod()[lod_level - 1];
+    auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
     const T* in_data = input.data<T>();
     T* out_data = output->data<T>();
     int* max_index = index->data<int>();
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      if (starts[i] == starts[i + 1]) {
-        for (int64_t k = 0; k < dim; ++k) {
-          out_data[i * dim + k] = pad_value;
-          max_index[i * dim + k] = -1;
+    ParallelForSequences(starts, num_seq, dim, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        T* out_row = out_data + i * dim;
+        int* index_row = max_index + i * dim;
+        if (starts[i] == starts[i + 1]) {
+          std::fill(out_row, out_row + dim, pad_value);
+          std::fill(index_row, index_row + dim, -1);
+          continue;
         }
-        continue;
-      }
-      for (int64_t k = 0; k < dim; ++k) {
-        out_data[i * dim + k] = in_data[starts[i] * dim + k];
-        max_index[i * dim + k] = starts[i];
-      }
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
-        for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
-            max_index[i * dim + k] = j;
+        std::memcpy(out_row, in_data + starts[i] * dim, dim * sizeof(T));
+        std::fill(index_row, index_row + dim, static_cast<int>(starts[i]));
+        for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+          const T* in_row = in_data + j * dim;
+          for (int64_t k = 0; k < dim; ++k) {
+            if (in_row[k] > out_row[k]) {
+              out_row[k] = in_row[k];
+              index_row[k] = static_cast<int>(j);
+            }
           }
         }
       }
-    }
+    });
   }
 };
 // Instantisation of Max Sequence Pooling for test phase eg. no need to fill
@@ -103,29 +112,29 @@ class MaxSeqPoolFunctor<T, true> {
     }
 
     auto lod_level = input.lod().size();
-    auto starts = input.lod()[lod_level - 1];
+    auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
     const T* in_data = input.data<T>();
     T* out_data = output->data<T>();
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      if (starts[i] == starts[i + 1]) {
-        for (int64_t k = 0; k < dim; ++k) {
-          out_data[i * dim + k] = pad_value;
+    ParallelForSequences(starts, num_seq, dim, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        T* out_row = out_data + i * dim;
+        if (starts[i] == starts[i + 1]) {
+          std::fill(out_row, out_row + dim, pad_value);
+          continue;
         }
-        continue;
-      }
-      std::memcpy(&out_data[i * dim], &in_data[starts[i] * dim],
-                  dim * sizeof(T));
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
-        for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
+        std::memcpy(out_row, in_data + starts[i] * dim, dim * sizeof(T));
+        for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+          const T* in_row = in_data + j * dim;
+          for (int64_t k = 0; k < dim; ++k) {
+            out_row[k] = std::max(out_row[k], in_row[k]);
           }
         }
       }
-    }
+    });
   }
 };
 template <typename T>
@@ -154,17 +163,24 @@ class MaxSeqPoolGradFunctor {
     const int* max_index = index.data<int>();
     T* ig_data = in_grad->data<T>();
 
-    SetConstant<platform::CPUDeviceContext, T> set_zero;
-    set_zero(context, in_grad, static_cast<T>(0.0));
+    auto lod_level = in_grad->lod().size();
+    auto& lod = in_grad->lod()[lod_level - 1];
+    const size_t* starts = lod.data();
     int64_t num_seq = og_dims[0];
     int64_t dim = out_grad.numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      for (int64_t j = 0; j < dim; ++j) {
-        int step_id = max_index[i * dim + j];
-        if (step_id == -1) continue;
-        ig_data[step_id * dim + j] = og_data[i * dim + j];
+    // The max index of a sequence is in its own rows, which are zeroed by
+    // the same chunk.
+    ParallelForSequences(starts, num_seq, dim, [&](size_t begin, size_t end) {
+      std::memset(ig_data + starts[begin] * dim, 0,
+                  (starts[end] - starts[begin]) * dim * sizeof(T));
+      for (size_t i = begin; i < end; ++i) {
+        for (int64_t j = 0; j < dim; ++j) {
+          int step_id = max_index[i * dim + j];
+          if (step_id == -1) continue;
+          ig_data[step_id * dim + j] = og_data[i * dim + j];
+        }
       }
-    }
+    });
   }
 };
 
@@ -181,23 +197,22 @@ class LastSeqPoolFunctor {
     // Calculate the size of each item in sequence
     int64_t item_size = input.numel() / input.dims()[0];
     auto lod_level = input.lod().size();
-    auto lod = input.lod()[lod_level - 1];
-    int seq_num = static_cast<int>(lod.size()) - 1;
-    for (int i = 0; i < seq_num; ++i) {
-      // Calculate the length of each sequence
-      int64_t seq_len = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      if (seq_len == 0) {
-        for (int j = 0; j < item_size; ++j) {
-          out_data[j] = pad_value;
+    auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    size_t seq_num = lod.size() - 1;
+    ParallelForSequences(starts, seq_num, item_size, [&](size_t begin,
+                                                         size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        T* out_row = out_data + i * item_size;
+        if (starts[i] == starts[i + 1]) {
+          std::fill(out_row, out_row + item_size, pad_value);
+        } else {
+          // Copy the last item of sequence to output
+          std::memcpy(out_row, in_data + (starts[i + 1] - 1) * item_size,
+                      item_size * sizeof(T));
         }
-      } else {
-        // Point to the begin of next sequence
-        in_data += seq_len * item_size;
-        // Copy the last item of sequence to output
-        std::memcpy(out_data, (in_data - item_size), item_size * sizeof(T));
       }
-      out_data += item_size;
-    }
+    });
   }
 };
 
@@ -214,52 +229,68 @@ class FirstSeqPoolFunctor {
     // Calculate the size of each item in sequence
     int64_t item_size = input.numel() / input.dims()[0];
     auto lod_level = input.lod().size();
-    auto lod = input.lod()[lod_level - 1];
-    int seq_num = static_cast<int>(lod.size()) - 1;
-    for (int i = 0; i < seq_num; ++i) {
-      // Calculate the length of each sequence
-      int64_t seq_len = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      if (seq_len == 0) {
-        for (int j = 0; j < item_size; ++j) {
-          out_data[j] = pad_value;
+    auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    size_t seq_num = lod.size() - 1;
+    ParallelForSequences(starts, seq_num, item_size, [&](size_t begin,
+                                                         size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        T* out_row = out_data + i * item_size;
+        if (starts[i] == starts[i + 1]) {
+          std::fill(out_row, out_row + item_size, pad_value);
+        } else {
+          // Copy the first item of sequence to output
+          std::memcpy(out_row, in_data + starts[i] * item_size,
+                      item_size * sizeof(T));
         }
-      } else {
-        // Copy the first item of sequence to output
-        std::memcpy(out_data, in_data, item_size * sizeof(T));
-        // Point to the next sequence
-        in_data += seq_len * item_size;
       }
-      out_data += item_size;
-    }
+    });
   }
 };
 
+// The gradient of the SUM, AVERAGE and SQRT pooling, where each row of the
+// i-th sequence of in_grad is the i-th row of out_grad scaled by
+// 1, 1 / h and 1 / sqrt(h) respectively. The first row is scaled and the
+// rest are copied from it.
 template <typename T>
-class SumSeqPoolGradFunctor {
+class ScaledSeqPoolGradFunctor {
  public:
   void operator()(const platform::CPUDeviceContext& context,
+                  const std::string& pooltype,
                   const framework::LoDTensor& out_grad,
                   framework::LoDTensor* in_grad) {
     auto lod_level = in_grad->lod().size();
-    auto lod = in_grad->lod()[lod_level - 1];
+    auto& lod = in_grad->lod()[lod_level - 1];
     int64_t out_w = out_grad.numel() / out_grad.dims()[0];
     int64_t in_w = in_grad->numel() / in_grad->dims()[0];
     PADDLE_ENFORCE_EQ(
         in_w, out_w,
         "The feature size of input@Grad and output@Grad shall be same.");
+    const size_t* starts = lod.data();
     const T* out_g_data = out_grad.data<T>();
     T* in_g_data = in_grad->mutable_data<T>(context.GetPlace());
+    bool average = pooltype == "AVERAGE";
+    bool use_sqrt = pooltype == "SQRT";
     auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      if (h == 0) continue;
-      int64_t in_offset = lod[i] * in_w;
-      const T* out_pos = out_g_data + i * out_w;
-      T* in_pos = in_g_data + in_offset;
-      for (int r = 0; r != h; ++r) {
-        blas.VCOPY(in_w, out_pos, in_pos + r * in_w);
+    ParallelForSequences(starts, lod.size() - 1, in_w, [&](size_t begin,
+                                                           size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        int64_t h = static_cast<int64_t>(starts[i + 1] - starts[i]);
+        if (h == 0) continue;
+        const T* out_pos = out_g_data + i * out_w;
+        T* in_pos = in_g_data + starts[i] * in_w;
+        blas.VCOPY(in_w, out_pos, in_pos);
+        if (average) {
+          blas.SCAL(in_w, static_cast<T>(1) / static_cast<T>(h), in_pos);
+        } else if (use_sqrt) {
+          blas.SCAL(in_w, static_cast<T>(1) / std::sqrt(static_cast<T>(h)),
+                    in_pos);
+        }
+        for (int64_t r = 1; r < h; ++r) {
+          std::memcpy(in_pos + r * in_w, in_pos, in_w * sizeof(T));
+        }
       }
-    }
+    });
   }
 };
 
@@ -293,58 +324,56 @@ class SequencePoolFunctor<platform::CPUDeviceContext, T> {
       return;
     }
     auto lod_level = input.lod().size();
-    auto lod = input.lod()[lod_level - 1];
+    auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    size_t seq_num = lod.size() - 1;
+    int64_t w = input.numel() / input.dims()[0];
+    const T* src = input.data<T>();
+    T* dst = output->mutable_data<T>(context.GetPlace());
     if (pooltype == "SUM") {
       auto place = context.GetPlace();
       PADDLE_ENFORCE_EQ(
           platform::is_cpu_place(place), true,
           "Sequence_pool should run on CPU Device when pooltype is SUM");
-      const T* src = input.data<T>();
-      T* dst = output->mutable_data<T>(place);
-      jit::seq_pool_attr_t attr(
-          static_cast<int>(input.numel() / input.dims()[0]),
-          jit::SeqPoolType::kSum);
+      jit::seq_pool_attr_t attr(static_cast<int>(w), jit::SeqPoolType::kSum);
       auto seqpool =
           jit::KernelFuncs<jit::SeqPoolTuple<T>, platform::CPUPlace>::Cache()
               .At(attr);
-      for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-        attr.h = static_cast<int>(lod[i + 1] - lod[i]);
-        if (attr.h == 0) {
-          for (int j = 0; j < attr.w; ++j) {
-            dst[j] = pad_value;
+      ParallelForSequences(starts, seq_num, w, [&](size_t begin, size_t end) {
+        jit::seq_pool_attr_t seq_attr(attr.w, jit::SeqPoolType::kSum);
+        for (size_t i = begin; i < end; ++i) {
+          seq_attr.h = static_cast<int>(starts[i + 1] - starts[i]);
+          if (seq_attr.h == 0) {
+            std::fill(dst + i * w, dst + (i + 1) * w, pad_value);
+          } else {
+            seqpool(src + starts[i] * w, dst + i * w, &seq_attr);
           }
-        } else {
-          seqpool(src, dst, &attr);
         }
-        dst += attr.w;
-        src += attr.h * attr.w;
-      }
+      });
       return;
     }
+    PADDLE_ENFORCE_EQ(pooltype == "AVERAGE" || pooltype == "SQRT", true,
+                      "unsupported pooling pooltype");
+    bool average = pooltype == "AVERAGE";
     auto& place = *context.eigen_device();
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      Tensor out_t = output->Slice(i, i + 1);
-      int64_t w = input.numel() / input.dims()[0];
-      if (lod[i] == lod[i + 1]) {
-        for (int j = 0; j < w; ++j) {
-          out_t.data<T>()[j] = pad_value;
+    ParallelForSequences(starts, seq_num, w, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        T* out_row = dst + i * w;
+        if (starts[i] == starts[i + 1]) {
+          std::fill(out_row, out_row + w, pad_value);
+          continue;
+        }
+        int64_t h = static_cast<int64_t>(starts[i + 1] - starts[i]);
+        typename EigenMatrix<T>::ConstType in_e(src + starts[i] * w, h, w);
+        typename EigenVector<T>::Type out_e(out_row, w);
+        if (average) {
+          out_e.device(place) = in_e.mean(Eigen::array<int, 1>({{0}}));
+        } else {
+          out_e.device(place) = in_e.sum(Eigen::array<int, 1>({{0}})) /
+                                std::sqrt(static_cast<T>(h));
         }
-        continue;
-      }
-      Tensor in_t =
-          input.Slice(static_cast<int>(lod[i]), static_cast<int>(lod[i + 1]));
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      auto in_e = EigenMatrix<T>::From(in_t, framework::make_ddim({h, w}));
-      auto out_e = EigenVector<T>::Flatten(out_t);
-      if (pooltype == "AVERAGE") {
-        out_e.device(place) = in_e.mean(Eigen::array<int, 1>({{0}}));
-      } else if (pooltype == "SQRT") {
-        out_e.device(place) = in_e.sum(Eigen::array<int, 1>({{0}})) /
-                              std::sqrt(static_cast<T>(h));
-      } else {
-        PADDLE_THROW("unsupported pooling pooltype");
       }
-    }
+    });
   }
 };
 
@@ -363,46 +392,33 @@ class SequencePoolGradFunctor<platform::CPUDeviceContext, T> {
       return;
     }
 
-    if (pooltype == "LAST" || pooltype == "FIRST") {
-      // set X@Grad be zero at first when pooltype is LAST/FIRST
-      math::SetConstant<platform::CPUDeviceContext, T> functor;
-      functor(context, in_grad, 0);
-    }
-
-    if (pooltype == "SUM") {
-      math::SumSeqPoolGradFunctor<T> sum_pool_grad;
-      sum_pool_grad(context, out_grad, in_grad);
+    if (pooltype == "SUM" || pooltype == "AVERAGE" || pooltype == "SQRT") {
+      math::ScaledSeqPoolGradFunctor<T> scaled_pool_grad;
+      scaled_pool_grad(context, pooltype, out_grad, in_grad);
       return;
     }
 
+    PADDLE_ENFORCE_EQ(pooltype == "LAST" || pooltype == "FIRST", true,
+                      "unsupported pooling pooltype");
     auto lod_level = in_grad->lod().size();
-    auto lod = in_grad->lod()[lod_level - 1];
-    auto& place = *context.eigen_device();
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      if (lod[i] == lod[i + 1]) continue;
-      auto in_g_t = in_grad->Slice(static_cast<int>(lod[i]),
-                                   static_cast<int>(lod[i + 1]));
-      auto out_g_t = out_grad.Slice(i, i + 1);
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      int64_t w = in_grad->numel() / in_grad->dims()[0];
-      auto in_g_e = EigenMatrix<T>::From(in_g_t, {h, w});
-      auto out_g_e = EigenMatrix<T>::From(out_g_t, {1, w});
-      auto out_g_e_v = EigenVector<T>::Flatten(out_g_t);
-      Eigen::DSizes<int, 2> bcast(h, 1);
-
-      if (pooltype == "AVERAGE") {
-        in_g_e.device(place) = (out_g_e / static_cast<T>(h)).broadcast(bcast);
-      } else if (pooltype == "SQRT") {
-        in_g_e.device(place) =
-            (out_g_e / std::sqrt(static_cast<T>(h))).broadcast(bcast);
-      } else if (pooltype == "LAST") {
-        in_g_e.chip(h - 1, 0).device(place) = out_g_e_v;
-      } else if (pooltype == "FIRST") {
-        in_g_e.chip(0, 0).device(place) = out_g_e_v;
-      } else {
-        PADDLE_THROW("unsupported pooling pooltype");
+    auto& lod = in_grad->lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    int64_t w = in_grad->numel() / in_grad->dims()[0];
+    const T* out_g_data = out_grad.data<T>();
+    T* in_g_data = in_grad->mutable_data<T>(context.GetPlace());
+    bool last = pooltype == "LAST";
+    // X@Grad is zero except the last or first row of each sequence, which
+    // is zeroed by the same chunk.
+    ParallelForSequences(starts, lod.size() - 1, w, [&](size_t begin,
+                                                        size_t end) {
+      std::memset(in_g_data + starts[begin] * w, 0,
+                  (starts[end] - starts[begin]) * w * sizeof(T));
+      for (size_t i = begin; i < end; ++i) {
+        if (starts[i] == starts[i + 1]) continue;
+        size_t row = last ? starts[i + 1] - 1 : starts[i];
+        std::memcpy(in_g_data + row * w, out_g_data + i * w, w * sizeof(T));
       }
-    }
+    });
   }
 };
 
@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_pooling.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
 #include <vector>
 
 template <typename DeviceContext, typename T>
@@ -112,6 +115,82 @@ TEST(SequencePoolingGrad, CPU_SUM) {
                                                                     lod2, 128);
 }
 
+// Many short sequences, some of which are empty, whose elements are more than
+// kSequenceParallelNumel so that they are pooled in parallel.
+static paddle::framework::LoD ManyShortSequences() {
+  std::vector<size_t> offsets{0};
+  for (size_t i = 0; i < 3000; ++i) {
+    offsets.push_back(offsets.back() + i % 5);
+  }
+  return {offsets};
+}
+
+TEST(SequencePoolingGrad, CPU_SUM_ManySequences) {
+  auto place = paddle::platform::CPUPlace();
+  auto *context = static_cast<paddle::platform::CPUDeviceContext *>(
+      paddle::platform::DeviceContextPool::Instance().Get(place));
+  TestSequencePoolingSum<paddle::platform::CPUDeviceContext, float>(
+      *context, ManyShortSequences(), 32);
+}
+
+TEST(SequencePooling, CPU_ManySequences) {
+  auto place = paddle::platform::CPUPlace();
+  auto *context = static_cast<paddle::platform::CPUDeviceContext *>(
+      paddle::platform::DeviceContextPool::Instance().Get(place));
+  auto lod = ManyShortSequences();
+  const int64_t width = 32;
+  const size_t num_seq = lod[0].size() - 1;
+  const float pad_value = -1.0f;
+
+  paddle::framework::LoDTensor input;
+  input.set_lod(lod);
+  float *in_data = input.mutable_data<float>(
+      {static_cast<int64_t>(lod[0].back()), width}, place);
+  for (int64_t i = 0; i < input.numel(); ++i) {
+    in_data[i] = static_cast<float>((i * 7) % 13) - 6.0f;
+  }
+
+  for (std::string pooltype : {"SUM", "AVERAGE", "SQRT", "MAX", "FIRST"}) {
+    paddle::framework::LoDTensor output;
+    paddle::framework::Tensor index;
+    float *out_data = output.mutable_data<float>(
+        {static_cast<int64_t>(num_seq), width}, place);
+    index.mutable_data<int>({static_cast<int64_t>(num_seq), width}, place);
+    paddle::operators::math::SequencePoolFunctor<
+        paddle::platform::CPUDeviceContext, float>()(
+        *context, pooltype, pad_value, input, &output, false, &index);
+
+    for (size_t i = 0; i < num_seq; ++i) {
+      size_t begin = lod[0][i];
+      size_t end = lod[0][i + 1];
+      for (int64_t k = 0; k < width; ++k) {
+        float expected = pad_value;
+        if (end > begin) {
+          float sum = 0.0f;
+          float max = in_data[begin * width + k];
+          for (size_t j = begin; j < end; ++j) {
+            sum += in_data[j * width + k];
+            max = std::max(max, in_data[j * width + k]);
+          }
+          float h = static_cast<float>(end - begin);
+          if (pooltype == "SUM") {
+            expected = sum;
+          } else if (pooltype == "AVERAGE") {
+            expected = sum / h;
+          } else if (pooltype == "SQRT") {
+            expected = sum / std::sqrt(h);
+          } else if (pooltype == "MAX") {
+            expected = max;
+          } else {
+            expected = in_data[begin * width + k];
+          }
+        }
+        EXPECT_NEAR(out_data[i * width + k], expected, 1e-5) << pooltype;
+      }
+    }
+  }
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(SequencePoolingGrad, CUDA_SUM) {
   auto place = paddle::platform::CUDAPlace(0);
@@ -25,6 +25,14 @@ template class SoftmaxFunctor<platform::CPUDeviceContext, double, true>;
 template class SoftmaxFunctor<platform::CPUDeviceContext, double, false>;
 template class SoftmaxGradFunctor<platform::CPUDeviceContext, float>;
 template class SoftmaxGradFunctor<platform::CPUDeviceContext, double>;
+template class SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext,
+                                              float>;
+template class SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext,
+                                              double>;
+template class SoftmaxWithCrossEntropyGradFunctor<platform::CPUDeviceContext,
+                                                  float>;
+template class SoftmaxWithCrossEntropyGradFunctor<platform::CPUDeviceContext,
+                                                  double>;
 
 }  // namespace math
 }  // namespace operators
@@ -35,6 +35,31 @@ class SoftmaxGradFunctor {
                   framework::Tensor* x_grad);
 };
 
+// Compute the softmax of the 2-D logits with the cross entropy loss of the
+// labels in one pass for each row, where the softmax is along the last axis.
+// It is only defined for CPU.
+template <typename DeviceContext, typename T>
+class SoftmaxWithCrossEntropyFunctor {
+ public:
+  void operator()(const DeviceContext& context,
+                  const framework::Tensor* logits,
+                  const framework::Tensor* labels, const bool soft_label,
+                  const int ignore_index, framework::Tensor* softmax,
+                  framework::Tensor* loss);
+};
+
+// Compute the gradient of the logits of SoftmaxWithCrossEntropyFunctor in
+// one pass for each row, where logits_grad may be the same as softmax.
+template <typename DeviceContext, typename T>
+class SoftmaxWithCrossEntropyGradFunctor {
+ public:
+  void operator()(const DeviceContext& context,
+                  const framework::Tensor* loss_grad,
+                  const framework::Tensor* softmax,
+                  const framework::Tensor* labels, const bool soft_label,
+                  const int ignore_index, framework::Tensor* logits_grad);
+};
+
 #ifdef PADDLE_WITH_CUDA
 template <typename T>
 class SoftmaxCUDNNFunctor {
@@ -36,6 +36,54 @@ struct ValueClip {
   }
 };
 
+// The jit kernels computing the softmax of the rows of width n.
+template <typename T>
+class SoftmaxRowKernels {
+ public:
+  explicit SoftmaxRowKernels(int n)
+      : n_(n),
+        hmax_(jit::KernelFuncs<jit::HMaxTuple<T>, platform::CPUPlace>::Cache()
+                  .At(n)),
+        hsum_(jit::KernelFuncs<jit::HSumTuple<T>, platform::CPUPlace>::Cache()
+                  .At(n)),
+        vaddbias_(
+            jit::KernelFuncs<jit::VAddBiasTuple<T>, platform::CPUPlace>::Cache()
+                .At(n)),
+        vexp_(jit::KernelFuncs<jit::VExpTuple<T>, platform::CPUPlace>::Cache()
+                  .At(n)),
+        vscal_(jit::KernelFuncs<jit::VScalTuple<T>, platform::CPUPlace>::Cache()
+                   .At(n)) {}
+
+  // Compute y = exp(x + shift) with shift = -max(x), return the sum of y.
+  // x + shift is clipped by ValueClip if clip is true.
+  T Exp(const T* x, T* y, bool clip, T* shift) const {
+    hmax_(x, shift, n_);
+    *shift = static_cast<T>(0) - *shift;
+    vaddbias_(shift, x, y, n_);
+    if (clip) {
+      ValueClip<T> value_clip;
+      for (int i = 0; i < n_; ++i) {
+        y[i] = value_clip(y[i]);
+      }
+    }
+    vexp_(y, y, n_);
+    T sum;
+    hsum_(y, &sum, n_);
+    return sum;
+  }
+
+  // Compute y = alpha * x.
+  void Scale(T alpha, const T* x, T* y) const { vscal_(&alpha, x, y, n_); }
+
+ private:
+  int n_;
+  typename jit::HMaxTuple<T>::func_type hmax_;
+  typename jit::HSumTuple<T>::func_type hsum_;
+  typename jit::VAddBiasTuple<T>::func_type vaddbias_;
+  typename jit::VExpTuple<T>::func_type vexp_;
+  typename jit::VScalTuple<T>::func_type vscal_;
+};
+
 template <typename DeviceContext, typename T, bool is_test>
 void SoftmaxEigen(const DeviceContext& context, const int axis_dim,
                   const framework::Tensor* X, framework::Tensor* Y) {
@@ -117,22 +165,16 @@ class SoftmaxFunctor<DeviceContext, T, is_test, enable_if_CPU<DeviceContext>> {
     const int batch_size = in_dims[kBatchDim];
     const int num_remain = num_classes / axis_dim;
 
-    if (num_remain == 1 && platform::MayIUse(platform::avx)) {
+    if (num_remain == 1) {
+      // the shifted logits are clipped only for training, as the jit softmax
+      // for float inference
       const T* in_data = X->data<T>();
       T* out_data = Y->data<T>();
+      SoftmaxRowKernels<T> kernels(num_classes);
       for (int bs = 0; bs < batch_size; ++bs) {
-        T max_val = *std::max_element(in_data, in_data + num_classes);
-        max_val *= static_cast<T>(-1);
-        vec_add_bias<T, platform::avx>(num_classes, max_val, in_data, out_data);
-        vec_clip<T, platform::avx>(num_classes, static_cast<T>(-64), out_data,
-                                   out_data);
-        vec_exp<T>(num_classes, out_data, out_data);
-
-        T sum = 0;
-        vec_sum<T, platform::avx>(num_classes, out_data, &sum);
-        sum = static_cast<T>(1) / sum;
-        vec_scal<T, platform::avx>(num_classes, sum, out_data, out_data);
-
+        T shift;
+        T sum = kernels.Exp(in_data, out_data, !is_test, &shift);
+        kernels.Scale(static_cast<T>(1) / sum, out_data, out_data);
         in_data += num_classes;
         out_data += num_classes;
       }
@@ -233,6 +275,92 @@ class SoftmaxGradFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
   }
 };
 
+template <typename DeviceContext, typename T>
+void SoftmaxWithCrossEntropyFunctor<DeviceContext, T>::operator()(
+    const DeviceContext& context, const framework::Tensor* logits,
+    const framework::Tensor* labels, const bool soft_label,
+    const int ignore_index, framework::Tensor* softmax,
+    framework::Tensor* loss) {
+  const int batch_size = logits->dims()[0];
+  const int num_classes = logits->dims()[1];
+  const T* logits_data = logits->data<T>();
+  T* softmax_data = softmax->data<T>();
+  T* loss_data = loss->data<T>();
+  SoftmaxRowKernels<T> kernels(num_classes);
+  ValueClip<T> value_clip;
+  for (int i = 0; i < batch_size; ++i) {
+    const T* x = logits_data + i * num_classes;
+    T* y = softmax_data + i * num_classes;
+    // log(softmax) is clip(x + shift) - log(sum), which is computed from the
+    // logits with no more pass over the softmax
+    T shift;
+    T sum = kernels.Exp(x, y, true, &shift);
+    kernels.Scale(static_cast<T>(1) / sum, y, y);
+    T log_sum = std::log(sum);
+    if (soft_label) {
+      const T* label = labels->data<T>() + i * num_classes;
+      T loss_value = 0;
+      for (int j = 0; j < num_classes; ++j) {
+        loss_value -= label[j] * (value_clip(x[j] + shift) - log_sum);
+      }
+      loss_data[i] = loss_value;
+    } else {
+      int64_t label = labels->data<int64_t>()[i];
+      if (label == ignore_index) {
+        loss_data[i] = 0;
+        continue;
+      }
+      PADDLE_ENFORCE_GE(label, 0,
+                        platform::errors::OutOfRange(
+                            "label value should >= 0 when label "
+                            "value(%f) not equal to ignore_index(%f)",
+                            label, ignore_index));
+      PADDLE_ENFORCE_LT(
+          label, num_classes,
+          platform::errors::OutOfRange(
+              "label value should less than the shape of axis dimension "
+              "when label value(%f) not equal to ignore_index(%f), But "
+              "received label value as %ld and shape of axis dimension "
+              "is %d",
+              label, ignore_index, label, num_classes));
+      loss_data[i] = log_sum - value_clip(x[label] + shift);
+    }
+  }
+}
+
+template <typename DeviceContext, typename T>
+void SoftmaxWithCrossEntropyGradFunctor<DeviceContext, T>::operator()(
+    const DeviceContext& context, const framework::Tensor* loss_grad,
+    const framework::Tensor* softmax, const framework::Tensor* labels,
+    const bool soft_label, const int ignore_index,
+    framework::Tensor* logits_grad) {
+  const int batch_size = softmax->dims()[0];
+  const int num_classes = softmax->dims()[1];
+  const T* loss_grad_data = loss_grad->data<T>();
+  const T* softmax_data = softmax->data<T>();
+  T* logits_grad_data = logits_grad->data<T>();
+  auto vscal =
+      jit::KernelFuncs<jit::VScalTuple<T>, platform::CPUPlace>::Cache().At(
+          num_classes);
+  for (int i = 0; i < batch_size; ++i) {
+    T dout = loss_grad_data[i];
+    const T* y = softmax_data + i * num_classes;
+    T* dx = logits_grad_data + i * num_classes;
+    if (soft_label) {
+      const T* label = labels->data<T>() + i * num_classes;
+      for (int j = 0; j < num_classes; ++j) {
+        dx[j] = dout * (y[j] - label[j]);
+      }
+    } else {
+      vscal(&dout, y, dx, num_classes);
+      int64_t label = labels->data<int64_t>()[i];
+      if (label != ignore_index) {
+        dx[label] -= dout;
+      }
+    }
+  }
+}
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
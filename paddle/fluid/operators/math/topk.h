@@ -0,0 +1,204 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The orders of the (value, index) pairs selected by SelectTopK, where the
+// pairs before the others are selected first. The pairs of the same value
+// are ordered by the index, so that the results are deterministic.
+template <typename T>
+struct LargerFirst {
+  bool operator()(T lv, int64_t li, T rv, int64_t ri) const {
+    return lv > rv || (lv == rv && li < ri);
+  }
+};
+
+template <typename T>
+struct SmallerFirst {
+  bool operator()(T lv, int64_t li, T rv, int64_t ri) const {
+    return lv < rv || (lv == rv && li < ri);
+  }
+};
+
+struct IdentityIndex {
+  int64_t operator()(int64_t i) const { return i; }
+};
+
+namespace detail {
+
+// Sift down the pair at i of the heap of size n, whose top is the pair after
+// all the others in the order of cmp.
+template <typename T, typename Compare>
+inline void SiftDown(T* values, int64_t* indices, int64_t i, int64_t n,
+                     Compare cmp) {
+  T value = values[i];
+  int64_t index = indices[i];
+  while (true) {
+    int64_t child = 2 * i + 1;
+    if (child >= n) break;
+    if (child + 1 < n && cmp(values[child], indices[child], values[child + 1],
+                             indices[child + 1])) {
+      ++child;
+    }
+    if (!cmp(value, index, values[child], indices[child])) break;
+    values[i] = values[child];
+    indices[i] = indices[child];
+    i = child;
+  }
+  values[i] = value;
+  indices[i] = index;
+}
+
+}  // namespace detail
+
+// Select the first k pairs of (x[i], index_of(i)) for i in [0, n) in the
+// order of cmp into values and indices, which are sorted in the order.
+//
+// The pairs are selected by a heap of size k kept in values and indices, so
+// nothing is allocated. The elements are checked against the top of the
+// heap by blocks, and most of the blocks have no element to push when k is
+// much smaller than n, which are skipped by a check without branches.
+template <typename T, typename IndexOf, typename Compare>
+void SelectTopK(const T* x, IndexOf index_of, int64_t n, int64_t k,
+                T* values, int64_t* indices, Compare cmp) {
+  k = std::min(k, n);
+  if (k <= 0) return;
+  for (int64_t i = 0; i < k; ++i) {
+    values[i] = x[i];
+    indices[i] = index_of(i);
+  }
+  for (int64_t i = k / 2 - 1; i >= 0; --i) {
+    detail::SiftDown(values, indices, i, k, cmp);
+  }
+
+  auto push = [&](int64_t i) {
+    int64_t index = index_of(i);
+    if (cmp(x[i], index, values[0], indices[0])) {
+      values[0] = x[i];
+      indices[0] = index;
+      detail::SiftDown(values, indices, 0, k, cmp);
+    }
+  };
+  constexpr int64_t kBlockSize = 16;
+  int64_t i = k;
+  for (; i + kBlockSize <= n; i += kBlockSize) {
+    T top_value = values[0];
+    int64_t top_index = indices[0];
+    bool any = false;
+    for (int64_t j = i; j < i + kBlockSize; ++j) {
+      any |= cmp(x[j], index_of(j), top_value, top_index);
+    }
+    if (!any) continue;
+    for (int64_t j = i; j < i + kBlockSize; ++j) {
+      push(j);
+    }
+  }
+  for (; i < n; ++i) {
+    push(i);
+  }
+
+  // sort the heap by moving its top after the others
+  for (int64_t m = k - 1; m > 0; --m) {
+    std::swap(values[0], values[m]);
+    std::swap(indices[0], indices[m]);
+    detail::SiftDown(values, indices, 0, m, cmp);
+  }
+}
+
+// Select the first k elements of x[0, n) with their indices in the order of
+// cmp. All of them are sorted in place of indices if k is n.
+template <typename T, typename Compare>
+void SelectTopK(const T* x, int64_t n, int64_t k, T* values, int64_t* indices,
+                Compare cmp) {
+  if (k < n) {
+    SelectTopK(x, IdentityIndex(), n, k, values, indices, cmp);
+    return;
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    indices[i] = i;
+  }
+  std::sort(indices, indices + n, [x, cmp](int64_t l, int64_t r) {
+    return cmp(x[l], l, x[r], r);
+  });
+  for (int64_t i = 0; i < n; ++i) {
+    values[i] = x[indices[i]];
+  }
+}
+
+// Select the first k elements of each row of x with shape [rows, n] in the
+// order of cmp into values and indices with shape [rows, k].
+//
+// The rows are selected in parallel. If the rows are fewer than the threads
+// and long enough, each row is split into parts selected in parallel, whose
+// k elements are merged by another selection.
+template <typename T, typename Compare>
+void SelectTopKRows(const T* x, int64_t rows, int64_t n, int64_t k,
+                    T* values, int64_t* indices, Compare cmp) {
+  k = std::min(k, n);
+  int64_t parts = 1;
+#ifdef PADDLE_WITH_MKLML
+  constexpr int64_t kMinPartSize = 1 << 14;
+  int64_t threads = omp_get_max_threads();
+  if (rows < threads && k < n) {
+    parts = std::min((threads + rows - 1) / rows,
+                     n / std::max(kMinPartSize, 4 * k));
+  }
+#endif
+  if (parts <= 1) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (rows > 1)
+#endif
+    for (int64_t r = 0; r < rows; ++r) {
+      SelectTopK(x + r * n, n, k, values + r * k, indices + r * k, cmp);
+    }
+    return;
+  }
+
+  std::vector<T> part_values(rows * parts * k);
+  std::vector<int64_t> part_indices(rows * parts * k);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t p = 0; p < rows * parts; ++p) {
+    int64_t r = p / parts;
+    int64_t begin = n * (p % parts) / parts;
+    int64_t end = n * (p % parts + 1) / parts;
+    SelectTopK(x + r * n + begin, [begin](int64_t i) { return begin + i; },
+               end - begin, k, part_values.data() + p * k,
+               part_indices.data() + p * k, cmp);
+  }
+  for (int64_t r = 0; r < rows; ++r) {
+    const int64_t* row_indices = part_indices.data() + r * parts * k;
+    SelectTopK(part_values.data() + r * parts * k,
+               [row_indices](int64_t i) { return row_indices[i]; },
+               parts * k, k, values + r * k, indices + r * k, cmp);
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
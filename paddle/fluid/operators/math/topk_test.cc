@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/topk.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+template <typename Compare>
+void TestSelectTopKRows(int64_t rows, int64_t n, int64_t k, int range) {
+  std::mt19937 rng(n + k);
+  std::uniform_int_distribution<int> dist(0, range);
+  std::vector<float> x(rows * n);
+  for (auto& v : x) {
+    v = static_cast<float>(dist(rng));
+  }
+  std::vector<float> values(rows * k);
+  std::vector<int64_t> indices(rows * k);
+  Compare cmp;
+  paddle::operators::math::SelectTopKRows(x.data(), rows, n, k, values.data(),
+                                          indices.data(), cmp);
+
+  for (int64_t r = 0; r < rows; ++r) {
+    std::vector<int64_t> expected(n);
+    for (int64_t i = 0; i < n; ++i) {
+      expected[i] = i;
+    }
+    const float* row = x.data() + r * n;
+    std::sort(expected.begin(), expected.end(), [&](int64_t a, int64_t b) {
+      return cmp(row[a], a, row[b], b);
+    });
+    for (int64_t i = 0; i < k; ++i) {
+      ASSERT_EQ(indices[r * k + i], expected[i]);
+      ASSERT_EQ(values[r * k + i], row[expected[i]]);
+    }
+  }
+}
+
+TEST(SelectTopK, Larger) {
+  using Compare = paddle::operators::math::LargerFirst<float>;
+  TestSelectTopKRows<Compare>(3, 1, 1, 10);
+  TestSelectTopKRows<Compare>(5, 100, 5, 1000);
+  // the ties are ordered by the index
+  TestSelectTopKRows<Compare>(5, 100, 20, 3);
+  // the rows are split into parts if the threads are more than the rows
+  TestSelectTopKRows<Compare>(1, 1 << 18, 10, 1 << 20);
+  TestSelectTopKRows<Compare>(2, 1 << 17, 100, 5);
+}
+
+TEST(SelectTopK, FullSort) {
+  TestSelectTopKRows<paddle::operators::math::LargerFirst<float>>(4, 77, 77,
+                                                                   10);
+  TestSelectTopKRows<paddle::operators::math::SmallerFirst<float>>(4, 77, 77,
+                                                                    10);
+}
@@ -473,6 +473,23 @@ or not. But the output only shares the LoD information with input `X`.
   }
 };
 
+class MatMulOpCostEstimator : public framework::OpCostEstimator {
+ public:
+  framework::OpCost operator()(
+      const framework::ExecutionContext& ctx) const override {
+    // Each element of Out is a dot product of length K.
+    auto x_dims = ctx.Input<framework::Tensor>("X")->dims();
+    int rank = x_dims.size();
+    int64_t k = x_dims[rank - 1];
+    if (rank > 1 && ctx.Attr<bool>("transpose_X")) {
+      k = x_dims[rank - 2];
+    }
+    framework::OpCost cost;
+    cost.flops = 2.0 * ctx.Output<framework::Tensor>("Out")->numel() * k;
+    return cost;
+  }
+};
+
 class MatMulOpGrad : public framework::OperatorWithKernel {
  public:
   using framework::OperatorWithKernel::OperatorWithKernel;
@@ -520,7 +537,8 @@ class MatMulOpGradMaker : public framework::SingleGradOpMaker<T> {
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(matmul, ops::MatMulOp, ops::MatMulOpMaker,
                   ops::MatMulOpGradMaker<paddle::framework::OpDesc>,
-                  ops::MatMulOpGradMaker<paddle::imperative::OpBase>);
+                  ops::MatMulOpGradMaker<paddle::imperative::OpBase>,
+                  ops::MatMulOpCostEstimator);
 REGISTER_OPERATOR(matmul_grad, ops::MatMulOpGrad);
 REGISTER_OP_CPU_KERNEL(
     matmul, ops::MatMulKernel<paddle::platform::CPUDeviceContext, float>,
@@ -100,6 +100,11 @@ class AucOpMaker : public framework::OpProtoAndCheckerMaker {
         .SetDefault((2 << 12) - 1);
     AddAttr<int>("slide_steps", "Use slide steps to calc batch auc.")
         .SetDefault(1);
+    AddAttr<bool>("accumulate_only",
+                  "Only accumulate the statistics into StatPosOut and "
+                  "StatNegOut without computing AUC, which is computed from "
+                  "the statistics when needed, e.g. at the end of a pass.")
+        .SetDefault(false);
     AddComment(R"DOC(
 Area Under The Curve (AUC) Operator.
 
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/metrics/auc_op.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 
@@ -80,28 +81,31 @@ __global__ void AddDataKernel(const int64_t *label_data, const T *pred_data,
     }
   }
 }
+// auc is nullptr if only the statistics are accumulated
 __global__ void CalcAucKernel(int64_t *stat_pos, int64_t *stat_neg,
                               int num_thresholds, double *auc,
                               bool need_add_batch_num) {
-  *auc = 0.0f;
-  double totPos = 0.0;
-  double totNeg = 0.0;
-  double totPosPrev = 0.0;
-  double totNegPrev = 0.0;
-
-  int idx = num_thresholds;
-
-  while (idx >= 0) {
-    totPosPrev = totPos;
-    totNegPrev = totNeg;
-    totPos += stat_pos[idx];
-    totNeg += stat_neg[idx];
-    *auc += (totNeg - totNegPrev) * (totPos + totPosPrev) / 2.0;
-    --idx;
-  }
+  if (auc != nullptr) {
+    *auc = 0.0f;
+    double totPos = 0.0;
+    double totNeg = 0.0;
+    double totPosPrev = 0.0;
+    double totNegPrev = 0.0;
+
+    int idx = num_thresholds;
+
+    while (idx >= 0) {
+      totPosPrev = totPos;
+      totNegPrev = totNeg;
+      totPos += stat_pos[idx];
+      totNeg += stat_neg[idx];
+      *auc += (totNeg - totNegPrev) * (totPos + totPosPrev) / 2.0;
+      --idx;
+    }
 
-  if (totPos > 0.0 && totNeg > 0.0) {
-    *auc = *auc / totPos / totNeg;
+    if (totPos > 0.0 && totNeg > 0.0) {
+      *auc = *auc / totPos / totNeg;
+    }
   }
   if (need_add_batch_num) {
     stat_pos[num_thresholds + 1] += 1;
@@ -118,6 +122,7 @@ class AucCUDAKernel : public framework::OpKernel<T> {
 
     int num_thresholds = ctx.Attr<int>("num_thresholds");
     int slide_steps = ctx.Attr<int>("slide_steps");
+    bool accumulate_only = ctx.Attr<bool>("accumulate_only");
 
     // Only use output var for now, make sure it's persistable and
     // not cleaned up for each batch.
@@ -133,29 +138,32 @@ class AucCUDAKernel : public framework::OpKernel<T> {
     auto *pos_in_data = stat_pos_in_tensor->data<int64_t>();
     auto *stat_neg_in_tensor = ctx.Input<Tensor>("StatNeg");
     auto *neg_in_data = stat_neg_in_tensor->data<int64_t>();
+    auto stream =
+        ctx.template device_context<platform::CUDADeviceContext>().stream();
+    auto place = boost::get<platform::CUDAPlace>(ctx.GetPlace());
+    size_t stat_bytes = ((1 + slide_steps) * (num_thresholds + 1) +
+                         (slide_steps > 0 ? 1 : 0)) *
+                        sizeof(int64_t);
+    // copy on the stream, so that the host does not wait for the device
     if (stat_pos_in_tensor != stat_pos) {
-      cudaMemcpy(origin_stat_pos, pos_in_data,
-                 ((1 + slide_steps) * (num_thresholds + 1) +
-                  (slide_steps > 0 ? 1 : 0)) *
-                     sizeof(int64_t),
-                 cudaMemcpyDeviceToDevice);
+      memory::Copy(place, origin_stat_pos, place, pos_in_data, stat_bytes,
+                   stream);
     }
     if (stat_neg_in_tensor != stat_neg) {
-      cudaMemcpy(origin_stat_neg, neg_in_data,
-                 ((1 + slide_steps) * (num_thresholds + 1) +
-                  (slide_steps > 0 ? 1 : 0)) *
-                     sizeof(int64_t),
-                 cudaMemcpyDeviceToDevice);
+      memory::Copy(place, origin_stat_neg, place, neg_in_data, stat_bytes,
+                   stream);
     }
 
     statAuc(ctx, label, predict, num_thresholds, slide_steps, origin_stat_pos,
             origin_stat_neg);
+    if (accumulate_only && slide_steps == 0) {
+      return;
+    }
     int sum_offset = slide_steps * (num_thresholds + 1);
-    auto stream =
-        ctx.template device_context<platform::CUDADeviceContext>().stream();
     CalcAucKernel<<<1, 1, 0, stream>>>(
         origin_stat_pos + sum_offset, origin_stat_neg + sum_offset,
-        num_thresholds, auc_value, slide_steps > 0);
+        num_thresholds, accumulate_only ? nullptr : auc_value,
+        slide_steps > 0);
   }
 
  private:
@@ -178,31 +186,29 @@ class AucCUDAKernel : public framework::OpKernel<T> {
     auto stream =
         ctx.template device_context<platform::CUDADeviceContext>().stream();
     if (slide_steps == 0) {
-      AddDataKernel<<<(batch_size + PADDLE_CUDA_NUM_THREADS - 1) /
-                          PADDLE_CUDA_NUM_THREADS,
-                      PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
-          label_data, inference_data, inference_width, num_thresholds,
-          origin_stat_pos, origin_stat_neg, batch_size, slide_steps);
+      if (batch_size > 0) {
+        AddDataKernel<<<(batch_size + PADDLE_CUDA_NUM_THREADS - 1) /
+                            PADDLE_CUDA_NUM_THREADS,
+                        PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
+            label_data, inference_data, inference_width, num_thresholds,
+            origin_stat_pos, origin_stat_neg, batch_size, slide_steps);
+      }
       return;
     }
-    // the last number of origin_stat_pos store the index should be used in
-    // current step
-    int cur_step_index =
-        static_cast<int>(origin_stat_pos[(slide_steps + 1) * bucket_length]) %
-        slide_steps;
-    int cur_step_begin = cur_step_index * bucket_length;
-    int sum_step_begin = slide_steps * bucket_length;
-
+    // the last number of origin_stat_pos stores the index should be used in
+    // current step, which is read by the kernels on device
     ClearObsoleteDataKernel<<<(bucket_length + PADDLE_CUDA_NUM_THREADS - 1) /
                                   PADDLE_CUDA_NUM_THREADS,
                               PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
         origin_stat_pos, origin_stat_neg, bucket_length, slide_steps);
 
-    AddDataKernel<<<(batch_size + PADDLE_CUDA_NUM_THREADS - 1) /
-                        PADDLE_CUDA_NUM_THREADS,
-                    PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
-        label_data, inference_data, inference_width, num_thresholds,
-        origin_stat_pos, origin_stat_neg, batch_size, slide_steps);
+    if (batch_size > 0) {
+      AddDataKernel<<<(batch_size + PADDLE_CUDA_NUM_THREADS - 1) /
+                          PADDLE_CUDA_NUM_THREADS,
+                      PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
+          label_data, inference_data, inference_width, num_thresholds,
+          origin_stat_pos, origin_stat_neg, batch_size, slide_steps);
+    }
     UpdateSumDataKernel<<<(bucket_length + PADDLE_CUDA_NUM_THREADS - 1) /
                               PADDLE_CUDA_NUM_THREADS,
                           PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
@@ -32,6 +32,7 @@ class AucKernel : public framework::OpKernel<T> {
 
     int num_thresholds = ctx.Attr<int>("num_thresholds");
     int slide_steps = ctx.Attr<int>("slide_steps");
+    bool accumulate_only = ctx.Attr<bool>("accumulate_only");
 
     // Only use output var for now, make sure it's persistable and
     // not cleaned up for each batch.
@@ -63,9 +64,11 @@ class AucKernel : public framework::OpKernel<T> {
     statAuc(label, predict, num_thresholds, slide_steps, origin_stat_pos,
             origin_stat_neg);
 
-    int sum_offset = slide_steps * (num_thresholds + 1);
-    calcAuc(origin_stat_pos + sum_offset, origin_stat_neg + sum_offset,
-            num_thresholds, auc_value);
+    if (!accumulate_only) {
+      int sum_offset = slide_steps * (num_thresholds + 1);
+      calcAuc(origin_stat_pos + sum_offset, origin_stat_neg + sum_offset,
+              num_thresholds, auc_value);
+    }
     if (slide_steps) {
       origin_stat_pos[(slide_steps + 1) * (num_thresholds + 1)] += 1;
       origin_stat_neg[(slide_steps + 1) * (num_thresholds + 1)] += 1;
@@ -421,6 +421,9 @@ class ConvMKLDNNOpKernel : public paddle::framework::OpKernel<T> {
     auto src_key = key + key_tid + "@src_mem_p";
     auto weights_key = key + key_tid + "@weights_mem_p";
     auto bias_key = key + key_tid + "@bias_mem_p";
+    // the reordered weights and bias for inference are shared by the threads
+    auto shared_weights_key = key + "@weights_mem_p";
+    auto shared_bias_key = key + "@bias_mem_p";
     auto user_src_key = key + key_tid + "@user_src_mem_p";
     auto user_residual_key = key + key_tid + "@user_residual_data_mem_p";
     auto src_reorder_key = key + key_tid + "@src_mem_preorder_p";
@@ -671,7 +674,11 @@ class ConvMKLDNNOpKernel : public paddle::framework::OpKernel<T> {
         src_memory_p->set_data_handle(to_void_cast<T>(input_data));
       }
       auto weights_memory_p = std::static_pointer_cast<mkldnn::memory>(
-          dev_ctx.GetBlob(weights_key));
+          dev_ctx.GetBlob(shared_weights_key));
+      if (weights_memory_p == nullptr) {
+        weights_memory_p = std::static_pointer_cast<mkldnn::memory>(
+            dev_ctx.GetBlob(weights_key));
+      }
       dst_memory_p =
           std::static_pointer_cast<mkldnn::memory>(dev_ctx.GetBlob(dst_key));
       conv_pd =
@@ -701,8 +708,12 @@ class ConvMKLDNNOpKernel : public paddle::framework::OpKernel<T> {
         astream.wait();
       }
 
-      auto bias_memory_p =
-          std::static_pointer_cast<mkldnn::memory>(dev_ctx.GetBlob(bias_key));
+      auto bias_memory_p = std::static_pointer_cast<mkldnn::memory>(
+          dev_ctx.GetBlob(shared_bias_key));
+      if (bias_memory_p == nullptr) {
+        bias_memory_p = std::static_pointer_cast<mkldnn::memory>(
+            dev_ctx.GetBlob(bias_key));
+      }
 
       if (bias_memory_p) {
         conv_p->execute(astream, {{MKLDNN_ARG_SRC, *src_memory_p},
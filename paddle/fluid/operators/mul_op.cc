@@ -213,6 +213,20 @@ class MulOpInferVarType : public framework::PassInDtypeAndVarTypeToOutput {
   }
 };
 
+class MulOpCostEstimator : public framework::OpCostEstimator {
+ public:
+  framework::OpCost operator()(
+      const framework::ExecutionContext& ctx) const override {
+    // Each element of Out is a dot product of length K.
+    auto x_dims = ctx.Input<Tensor>("X")->dims();
+    int64_t k = framework::flatten_to_2d(
+        x_dims, ctx.Attr<int>("x_num_col_dims"))[1];
+    framework::OpCost cost;
+    cost.flops = 2.0 * ctx.Output<Tensor>("Out")->numel() * k;
+    return cost;
+  }
+};
+
 class MulGradOp : public framework::OperatorWithKernel {
  public:
   using framework::OperatorWithKernel::OperatorWithKernel;
@@ -312,7 +326,8 @@ class MulDoubleGradMaker : public framework::SingleGradOpMaker<T> {
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(mul, ops::MulOp, ops::MulOpMaker, ops::MulOpInferVarType,
                   ops::MulOpGradMaker<paddle::framework::OpDesc>,
-                  ops::MulOpGradMaker<paddle::imperative::OpBase>);
+                  ops::MulOpGradMaker<paddle::imperative::OpBase>,
+                  ops::MulOpCostEstimator);
 
 REGISTER_OPERATOR(mul_grad, ops::MulGradOp,
                   ops::MulDoubleGradMaker<paddle::framework::OpDesc>,
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/packed_gemm_weight.h"
 
 namespace paddle {
 namespace operators {
@@ -26,6 +27,32 @@ using Tensor = framework::Tensor;
 
 constexpr int kMULMKLDNNINT8 = 1;
 
+// Computes z = x_matrix * y_matrix by the weight y packed for the GEMM, and
+// returns false if y is not packed, see math::GetPackedGemmWeight.
+template <typename T>
+bool MulWithPackedY(const platform::CPUDeviceContext& dev_ctx, const Tensor& y,
+                    const Tensor& x_matrix, const Tensor& y_matrix,
+                    Tensor* z) {
+  auto packed_y = math::GetPackedGemmWeight<T>(
+      dev_ctx, y, static_cast<int>(y_matrix.dims()[0]),
+      static_cast<int>(y_matrix.dims()[1]));
+  if (!packed_y) {
+    return false;
+  }
+  packed_y->MatMul(dev_ctx, static_cast<int>(x_matrix.dims()[0]),
+                   x_matrix.data<T>(), z->data<T>());
+  return true;
+}
+
+#ifdef PADDLE_WITH_CUDA
+template <typename T>
+bool MulWithPackedY(const platform::CUDADeviceContext& dev_ctx,
+                    const Tensor& y, const Tensor& x_matrix,
+                    const Tensor& y_matrix, Tensor* z) {
+  return false;
+}
+#endif
+
 template <typename DeviceContext, typename T>
 class MulKernel : public framework::OpKernel<T> {
  public:
@@ -50,9 +77,11 @@ class MulKernel : public framework::OpKernel<T> {
       z->Resize({x_matrix.dims()[0], y_matrix.dims()[1]});
     }
 
-    auto blas = math::GetBlas<DeviceContext, T>(context);
-
-    blas.MatMul(x_matrix, y_matrix, z);
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (!MulWithPackedY<T>(dev_ctx, *y, x_matrix, y_matrix, z)) {
+      auto blas = math::GetBlas<DeviceContext, T>(context);
+      blas.MatMul(x_matrix, y_matrix, z);
+    }
     if (z_dim.size() != 2) {
       z->Resize(z_dim);
     }
@@ -93,9 +93,12 @@ class NCEOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext &ctx) const override {
+    // The parameter prefetch of the remote table runs on the host.
+    platform::Place place = ctx.Attr<bool>("remote_prefetch")
+                                ? platform::Place(platform::CPUPlace())
+                                : ctx.GetPlace();
     return framework::OpKernelType(
-        OperatorWithKernel::IndicateVarDataType(ctx, "Input"),
-        platform::CPUPlace());
+        OperatorWithKernel::IndicateVarDataType(ctx, "Input"), place);
   }
 };
 
@@ -271,9 +274,12 @@ class NCEOpGrad : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext &ctx) const override {
+    // The parameter prefetch of the remote table runs on the host.
+    platform::Place place = ctx.Attr<bool>("remote_prefetch")
+                                ? platform::Place(platform::CPUPlace())
+                                : ctx.GetPlace();
     return framework::OpKernelType(
-        OperatorWithKernel::IndicateVarDataType(ctx, "Input"),
-        platform::CPUPlace());
+        OperatorWithKernel::IndicateVarDataType(ctx, "Input"), place);
   }
 };
 
@@ -0,0 +1,374 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cub/cub.cuh>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/nce_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+using platform::PADDLE_CUDA_NUM_THREADS;
+
+#define CUDA_KERNEL_LOOP(i, n)                                     \
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+// The threads of a block that reduce the dot product of a sample, and the
+// threads of a block that update the rows of a sample.
+constexpr int kNCEBlockDim = 128;
+// The maximum number of blocks of a launch, each of which loops over the
+// samples.
+constexpr int kNCEMaxGridDim = 4096;
+
+static inline int NCEGridDim(int64_t n) {
+  return static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>(n, static_cast<int64_t>(kNCEMaxGridDim))));
+}
+
+// logits[i] = sigmoid(bias[labels[i]] + x.row(i / num_sampled) *
+// w.row(labels[i])), one block per sample.
+template <typename T, int BlockDim>
+__global__ void NCELogitsKernel(const T *x, const T *w, const T *bias,
+                                const int64_t *labels, int64_t num_samples,
+                                int64_t num_sampled, int64_t dim, T *logits) {
+  typedef cub::BlockReduce<T, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  for (int64_t i = blockIdx.x; i < num_samples; i += gridDim.x) {
+    const T *x_row = x + (i / num_sampled) * dim;
+    const T *w_row = w + labels[i] * dim;
+    T sum = static_cast<T>(0);
+    for (int64_t k = threadIdx.x; k < dim; k += BlockDim) {
+      sum += x_row[k] * w_row[k];
+    }
+    sum = BlockReduce(temp_storage).Sum(sum);
+    if (threadIdx.x == 0) {
+      T o = sum + (bias == nullptr ? static_cast<T>(0) : bias[labels[i]]);
+      logits[i] = static_cast<T>(1) / (static_cast<T>(1) + exp(-o));
+    }
+    // temp_storage is reused by the next sample.
+    __syncthreads();
+  }
+}
+
+// probs[i] is the probability of the sample i times num_neg_samples.
+template <typename T>
+__global__ void NCECostKernel(const T *logits, const float *probs,
+                              const T *sample_weight, int64_t batch_size,
+                              int64_t num_sampled, int64_t num_true_class,
+                              T *cost) {
+  CUDA_KERNEL_LOOP(i, batch_size) {
+    T w = sample_weight == nullptr ? static_cast<T>(1) : sample_weight[i];
+    T sum = static_cast<T>(0);
+    for (int64_t j = 0; j < num_sampled; ++j) {
+      T o = logits[i * num_sampled + j];
+      T b = probs[i * num_sampled + j];
+      sum += (j < num_true_class) ? -log(o / (o + b)) : -log(b / (o + b));
+    }
+    cost[i] = w * sum;
+  }
+}
+
+template <typename T>
+__global__ void NCESampleGradKernel(const T *d_out, const T *logits,
+                                    const float *probs, const T *sample_weight,
+                                    int64_t num_samples, int64_t num_sampled,
+                                    int64_t num_true_class, T *sample_grad) {
+  CUDA_KERNEL_LOOP(i, num_samples) {
+    int64_t label_idx = i % num_sampled;
+    int64_t sample_idx = i / num_sampled;
+    T b = probs[i];
+    T o = logits[i];
+    T w = sample_weight == nullptr ? static_cast<T>(1)
+                                   : sample_weight[sample_idx];
+    T grad = label_idx < num_true_class ? w * (b / (o + b)) * (o - 1)
+                                        : w * (o * (1 - o) / (o + b));
+    sample_grad[i] = grad * d_out[sample_idx];
+  }
+}
+
+template <typename T>
+__global__ void NCEBiasGradKernel(const T *sample_grad, const int64_t *labels,
+                                  int64_t num_samples, T *d_bias) {
+  CUDA_KERNEL_LOOP(i, num_samples) {
+    platform::CudaAtomicAdd(d_bias + labels[i], sample_grad[i]);
+  }
+}
+
+// rows.row(index[i]) += sample_grad[i] * x.row(i / num_sampled), one block
+// per sample. The samples of the same label add to the same row.
+template <typename T, int BlockDim>
+__global__ void NCEWeightGradKernel(const T *sample_grad, const T *x,
+                                    const int64_t *index, int64_t num_samples,
+                                    int64_t num_sampled, int64_t dim,
+                                    T *rows) {
+  for (int64_t i = blockIdx.x; i < num_samples; i += gridDim.x) {
+    const T *x_row = x + (i / num_sampled) * dim;
+    T *row = rows + index[i] * dim;
+    T grad = sample_grad[i];
+    for (int64_t k = threadIdx.x; k < dim; k += BlockDim) {
+      platform::CudaAtomicAdd(row + k, grad * x_row[k]);
+    }
+  }
+}
+
+// d_x.row(i) = \sum_j sample_grad[i, j] * w.row(labels[i, j]), one block per
+// row of the input.
+template <typename T, int BlockDim>
+__global__ void NCEInputGradKernel(const T *sample_grad, const T *w,
+                                   const int64_t *labels, int64_t batch_size,
+                                   int64_t num_sampled, int64_t dim, T *d_x) {
+  for (int64_t i = blockIdx.x; i < batch_size; i += gridDim.x) {
+    for (int64_t k = threadIdx.x; k < dim; k += BlockDim) {
+      T sum = static_cast<T>(0);
+      for (int64_t j = 0; j < num_sampled; ++j) {
+        int64_t s = i * num_sampled + j;
+        sum += sample_grad[s] * w[labels[s] * dim + k];
+      }
+      d_x[i * dim + k] = sum;
+    }
+  }
+}
+
+// The samplers of math/sampler.h run on the host, so the custom distribution
+// is copied out to host_dists, which must outlive the sampler.
+static Sampler *CreateHostSampler(const framework::ExecutionContext &context,
+                                  std::vector<Tensor> *host_dists) {
+  const char *names[] = {"CustomDistProbs", "CustomDistAlias",
+                         "CustomDistAliasProbs"};
+  host_dists->resize(3);
+  if (context.Attr<int>("sampler") == 2) {
+    for (size_t i = 0; i < host_dists->size(); ++i) {
+      framework::TensorCopySync(*context.Input<Tensor>(names[i]),
+                                platform::CPUPlace(), &(*host_dists)[i]);
+    }
+  }
+  return CreateSampler(context, &(*host_dists)[0], &(*host_dists)[1],
+                       &(*host_dists)[2]);
+}
+
+// The probabilities of the samples times num_neg_samples, on the device.
+static void SampleProbs(const platform::CUDADeviceContext &dev_ctx,
+                        const Sampler &sampler,
+                        const std::vector<int64_t> &sample_labels,
+                        int num_neg_samples, Tensor *probs) {
+  std::vector<float> host_probs(sample_labels.size());
+  for (size_t i = 0; i < sample_labels.size(); ++i) {
+    host_probs[i] = sampler.Probability(sample_labels[i]) * num_neg_samples;
+  }
+  framework::TensorFromVector(host_probs, dev_ctx, probs);
+  // host_probs is released on return.
+  dev_ctx.Wait();
+}
+
+template <typename DeviceContext, typename T>
+class NCECUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto &dev_ctx = context.template device_context<DeviceContext>();
+    auto stream = dev_ctx.stream();
+    int num_neg_samples = context.Attr<int>("num_neg_samples");
+
+    std::vector<Tensor> host_dists;
+    std::unique_ptr<Sampler> sampler(CreateHostSampler(context, &host_dists));
+
+    // The samples are drawn on the host and copied to the device.
+    auto label = context.Input<Tensor>("Label");
+    std::vector<int64_t> host_label;
+    framework::TensorToVector(*label, dev_ctx, &host_label);
+    dev_ctx.Wait();
+
+    auto sample_labels = context.Output<Tensor>("SampleLabels");
+    auto sample_labels_dims = sample_labels->dims();
+    std::vector<int64_t> host_sample_labels(sample_labels->numel());
+    SampleLabels(context, host_label.data(), sampler.get(),
+                 host_sample_labels.data());
+    for (size_t x = 0; x < host_sample_labels.size(); x++) {
+      PADDLE_ENFORCE_GE(host_sample_labels[x], 0,
+                        "ValueError: Every sample label should be "
+                        "non-negative. But received: "
+                        "Input(SampleLabels)[%d] = %d",
+                        x, host_sample_labels[x]);
+    }
+    framework::TensorFromVector(host_sample_labels, dev_ctx, sample_labels);
+    sample_labels->Resize(sample_labels_dims);
+    Tensor probs;
+    SampleProbs(dev_ctx, *sampler, host_sample_labels, num_neg_samples,
+                &probs);
+
+    int64_t num_samples = sample_labels->numel();
+    int64_t batch_size = sample_labels_dims[0];
+    int64_t num_sampled = sample_labels_dims[1];
+    int64_t num_true_class = label->dims()[1];
+    auto *input = context.Input<Tensor>("Input");
+    int64_t dim = input->dims()[1];
+    auto bias = context.Input<Tensor>("Bias");
+    auto sample_weight = context.Input<Tensor>("SampleWeight");
+
+    auto sample_out = context.Output<Tensor>("SampleLogits");
+    T *sample_out_data = sample_out->mutable_data<T>(context.GetPlace());
+    NCELogitsKernel<T, kNCEBlockDim><<<NCEGridDim(num_samples), kNCEBlockDim,
+                                       0, stream>>>(
+        input->data<T>(), context.Input<Tensor>("Weight")->data<T>(),
+        bias == nullptr ? nullptr : bias->data<T>(),
+        sample_labels->data<int64_t>(), num_samples, num_sampled, dim,
+        sample_out_data);
+
+    auto out = context.Output<Tensor>("Cost");
+    NCECostKernel<T><<<(batch_size + PADDLE_CUDA_NUM_THREADS - 1) /
+                           PADDLE_CUDA_NUM_THREADS,
+                       PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
+        sample_out_data, probs.data<float>(),
+        sample_weight == nullptr ? nullptr : sample_weight->data<T>(),
+        batch_size, num_sampled, num_true_class,
+        out->mutable_data<T>(context.GetPlace()));
+  }
+};
+
+template <typename DeviceContext, typename T>
+class NCEGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto &dev_ctx = context.template device_context<DeviceContext>();
+    auto stream = dev_ctx.stream();
+    int num_neg_samples = context.Attr<int>("num_neg_samples");
+    math::SetConstant<DeviceContext, T> zero;
+
+    std::vector<Tensor> host_dists;
+    std::unique_ptr<Sampler> sampler(CreateHostSampler(context, &host_dists));
+
+    auto sample_labels = context.Input<Tensor>("SampleLabels");
+    const int64_t *sample_labels_data = sample_labels->data<int64_t>();
+    std::vector<int64_t> host_sample_labels;
+    framework::TensorToVector(*sample_labels, dev_ctx, &host_sample_labels);
+    dev_ctx.Wait();
+    Tensor probs;
+    SampleProbs(dev_ctx, *sampler, host_sample_labels, num_neg_samples,
+                &probs);
+
+    int64_t num_samples = sample_labels->numel();
+    int64_t batch_size = sample_labels->dims()[0];
+    int64_t num_sampled = sample_labels->dims()[1];
+    int64_t num_true_class = context.Input<Tensor>("Label")->dims()[1];
+    auto sample_weight = context.Input<Tensor>("SampleWeight");
+    const T *x_data = context.Input<Tensor>("Input")->data<T>();
+    int grid_dim = NCEGridDim(num_samples);
+    int loop_grid_dim = (num_samples + PADDLE_CUDA_NUM_THREADS - 1) /
+                        PADDLE_CUDA_NUM_THREADS;
+
+    Tensor sample_grad;
+    T *sample_grad_data =
+        sample_grad.mutable_data<T>(sample_labels->dims(), context.GetPlace());
+    NCESampleGradKernel<T><<<loop_grid_dim, PADDLE_CUDA_NUM_THREADS, 0,
+                             stream>>>(
+        context.Input<Tensor>(framework::GradVarName("Cost"))->data<T>(),
+        context.Input<Tensor>("SampleLogits")->data<T>(), probs.data<float>(),
+        sample_weight == nullptr ? nullptr : sample_weight->data<T>(),
+        num_samples, num_sampled, num_true_class, sample_grad_data);
+
+    auto d_bias = context.Output<Tensor>(framework::GradVarName("Bias"));
+    if (d_bias != nullptr) {
+      T *d_bias_data = d_bias->mutable_data<T>(context.GetPlace());
+      zero(dev_ctx, d_bias, static_cast<T>(0));
+      NCEBiasGradKernel<T><<<loop_grid_dim, PADDLE_CUDA_NUM_THREADS, 0,
+                             stream>>>(sample_grad_data, sample_labels_data,
+                                       num_samples, d_bias_data);
+    }
+
+    bool is_sparse = context.Attr<bool>("is_sparse");
+    if (!is_sparse) {
+      auto d_w = context.Output<Tensor>(framework::GradVarName("Weight"));
+      if (d_w != nullptr) {
+        T *d_w_data = d_w->mutable_data<T>(context.GetPlace());
+        zero(dev_ctx, d_w, static_cast<T>(0));
+        NCEWeightGradKernel<T, kNCEBlockDim><<<grid_dim, kNCEBlockDim, 0,
+                                               stream>>>(
+            sample_grad_data, x_data, sample_labels_data, num_samples,
+            num_sampled, d_w->dims()[1], d_w_data);
+      }
+    } else {
+      std::set<int64_t> st(host_sample_labels.begin(),
+                           host_sample_labels.end());
+      std::vector<int64_t> labels(st.begin(), st.end());
+
+      auto *table_var = context.InputVar("Weight");
+      DDim table_dim;
+      if (table_var->IsType<LoDTensor>()) {
+        table_dim = context.Input<LoDTensor>("Weight")->dims();
+      } else if (table_var->IsType<SelectedRows>()) {
+        auto *table_t = context.Input<SelectedRows>("Weight");
+        table_dim = table_t->value().dims();
+      } else {
+        PADDLE_THROW(
+            "The parameter Weight of a NCE_OP "
+            "must be either LoDTensor or SelectedRows");
+      }
+
+      auto d_w = context.Output<SelectedRows>(framework::GradVarName("Weight"));
+      d_w->set_rows(labels);
+      d_w->set_height(table_dim[0]);
+
+      auto *d_table_value = d_w->mutable_value();
+      d_table_value->Resize(
+          {static_cast<int64_t>(labels.size()), table_dim[1]});
+      T *d_w_data = d_table_value->mutable_data<T>(context.GetPlace());
+      zero(dev_ctx, d_table_value, static_cast<T>(0));
+
+      // The row of each sample in the SelectedRows gradient.
+      std::unordered_map<int64_t, int64_t> label_index;
+      for (size_t i = 0; i < labels.size(); ++i) {
+        label_index[labels[i]] = i;
+      }
+      std::vector<int64_t> host_index(host_sample_labels.size());
+      for (size_t i = 0; i < host_sample_labels.size(); ++i) {
+        host_index[i] = label_index.at(host_sample_labels[i]);
+      }
+      Tensor index;
+      framework::TensorFromVector(host_index, dev_ctx, &index);
+      NCEWeightGradKernel<T, kNCEBlockDim><<<grid_dim, kNCEBlockDim, 0,
+                                             stream>>>(
+          sample_grad_data, x_data, index.data<int64_t>(), num_samples,
+          num_sampled, table_dim[1], d_w_data);
+      // host_index is released on return.
+      dev_ctx.Wait();
+    }
+
+    auto d_x = context.Output<Tensor>(framework::GradVarName("Input"));
+    if (d_x != nullptr) {
+      T *d_x_data = d_x->mutable_data<T>(context.GetPlace());
+      NCEInputGradKernel<T, kNCEBlockDim><<<NCEGridDim(batch_size),
+                                            kNCEBlockDim, 0, stream>>>(
+          sample_grad_data, context.Input<Tensor>("Weight")->data<T>(),
+          sample_labels_data, batch_size, num_sampled, d_x->dims()[1],
+          d_x_data);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+using GPUCtx = paddle::platform::CUDADeviceContext;
+REGISTER_OP_CUDA_KERNEL(nce, ops::NCECUDAKernel<GPUCtx, float>,
+                        ops::NCECUDAKernel<GPUCtx, double>);
+REGISTER_OP_CUDA_KERNEL(nce_grad, ops::NCEGradCUDAKernel<GPUCtx, float>,
+                        ops::NCEGradCUDAKernel<GPUCtx, double>);
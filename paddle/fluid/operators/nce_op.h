@@ -19,10 +19,12 @@ limitations under the License. */
 #include <random>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/sampler.h"
 #include "unsupported/Eigen/CXX11/Tensor"
 
@@ -43,20 +45,17 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
-template <typename DeviceContext, typename T>
-void PrepareSamples(const framework::ExecutionContext &context,
-                    Sampler *sampler) {
-  auto label = context.Input<Tensor>("Label");
-  const int64_t *label_data = label->data<int64_t>();
-  auto label_dims = label->dims();
+// Fills sample_labels_data, which has the dims of Output(SampleLabels), with
+// the true labels of each row followed by its negative samples. label_data
+// and sample_labels_data are on the host.
+static inline void SampleLabels(const framework::ExecutionContext &context,
+                                const int64_t *label_data, Sampler *sampler,
+                                int64_t *sample_labels_data) {
+  auto label_dims = context.Input<Tensor>("Label")->dims();
   // for unitest
   std::vector<int> custom_neg_classes =
       context.Attr<std::vector<int>>("custom_neg_classes");
-
-  auto sample_labels = context.Output<Tensor>("SampleLabels");
-  auto sample_labels_dims = sample_labels->dims();
-  int64_t *sample_labels_data =
-      sample_labels->mutable_data<int64_t>(context.GetPlace());
+  auto sample_labels_dims = context.Output<Tensor>("SampleLabels")->dims();
 
   int num_label = label_dims.size() == 2 ? label_dims[1] : 1;
   int index = 0;
@@ -78,61 +77,74 @@ void PrepareSamples(const framework::ExecutionContext &context,
   }
 }
 
+template <typename DeviceContext, typename T>
+void PrepareSamples(const framework::ExecutionContext &context,
+                    Sampler *sampler) {
+  auto label = context.Input<Tensor>("Label");
+  auto sample_labels = context.Output<Tensor>("SampleLabels");
+  SampleLabels(context, label->data<int64_t>(), sampler,
+               sample_labels->mutable_data<int64_t>(context.GetPlace()));
+}
+
+// Creates the sampler of Attr(sampler). The tables of the custom distribution
+// are only read for the sampler 2, and must be on the host.
+static inline Sampler *CreateSampler(const framework::ExecutionContext &context,
+                                     const Tensor *dist_probs,
+                                     const Tensor *dist_alias,
+                                     const Tensor *dist_alias_probs) {
+  int sampler_type = context.Attr<int>("sampler");
+  int seed = context.Attr<int>("seed");
+  int num_total_classes = context.Attr<int>("num_total_classes");
+
+  switch (sampler_type) {
+    case 0: {
+      return new math::UniformSampler(num_total_classes - 1, seed);
+    }
+    case 1: {
+      return new math::LogUniformSampler(num_total_classes - 1, seed);
+    }
+    case 2: {
+      PADDLE_ENFORCE_EQ(
+          dist_probs->numel(), num_total_classes,
+          "ShapeError: The number of elements in Input(CustomDistProbs) "
+          "should be equal to the number of total classes. But Received: "
+          "Input(CustomDistProbs).numel() = %d, Attr(num_total_classes) "
+          "= %d.",
+          dist_probs->numel(), num_total_classes);
+      PADDLE_ENFORCE_EQ(
+          dist_alias->numel(), num_total_classes,
+          "ShapeError: The number of elements in Input(CustomDistAlias) "
+          "should be equal to the number of total classes. But Received: "
+          "Input(CustomDistAlias).numel() = %d, Attr(num_total_classes) "
+          "= %d.",
+          dist_alias->numel(), num_total_classes);
+      PADDLE_ENFORCE_EQ(
+          dist_alias_probs->numel(), num_total_classes,
+          "ShapeError: The number of elements in Input(CustomDistAliasProbs) "
+          "should be equal to the number of total classes. But Received: "
+          "Input(CustomDistAliasProbs).numel() = %d, "
+          "Attr(num_total_classes) = %d.",
+          dist_alias_probs->numel(), num_total_classes);
+
+      const float *probs_data = dist_probs->data<float>();
+      const int *alias_data = dist_alias->data<int>();
+      const float *alias_probs_data = dist_alias_probs->data<float>();
+      return new math::CustomSampler(num_total_classes - 1, probs_data,
+                                     alias_data, alias_probs_data, seed);
+    }
+    default: { PADDLE_THROW("Unsupported SamplerType."); }
+  }
+}
+
 template <typename DeviceContext, typename T>
 class NCEKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext &context) const override {
-    int sampler_type = context.Attr<int>("sampler");
-    int seed = context.Attr<int>("seed");
-    int num_total_classes = context.Attr<int>("num_total_classes");
     int num_neg_samples = context.Attr<int>("num_neg_samples");
-
-    Sampler *sampler;
-    switch (sampler_type) {
-      case 0: {
-        sampler = new math::UniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 1: {
-        sampler = new math::LogUniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 2: {
-        auto dist_probs = context.Input<Tensor>("CustomDistProbs");
-        auto dist_alias = context.Input<Tensor>("CustomDistAlias");
-        auto dist_alias_probs = context.Input<Tensor>("CustomDistAliasProbs");
-
-        PADDLE_ENFORCE_EQ(
-            dist_probs->numel(), num_total_classes,
-            "ShapeError: The number of elements in Input(CustomDistProbs) "
-            "should be equal to the number of total classes. But Received: "
-            "Input(CustomDistProbs).numel() = %d, Attr(num_total_classes) "
-            "= %d.",
-            dist_probs->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(
-            dist_alias->numel(), num_total_classes,
-            "ShapeError: The number of elements in Input(CustomDistAlias) "
-            "should be equal to the number of total classes. But Received: "
-            "Input(CustomDistAlias).numel() = %d, Attr(num_total_classes) "
-            "= %d.",
-            dist_alias->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(
-            dist_alias_probs->numel(), num_total_classes,
-            "ShapeError: The number of elements in Input(CustomDistAliasProbs) "
-            "should be equal to the number of total classes. But Received: "
-            "Input(CustomDistAliasProbs).numel() = %d, "
-            "Attr(num_total_classes) = %d.",
-            dist_alias_probs->numel(), num_total_classes);
-
-        const float *probs_data = dist_probs->data<float>();
-        const int *alias_data = dist_alias->data<int>();
-        const float *alias_probs_data = dist_alias_probs->data<float>();
-        sampler = new math::CustomSampler(num_total_classes - 1, probs_data,
-                                          alias_data, alias_probs_data, seed);
-        break;
-      }
-      default: { PADDLE_THROW("Unsupported SamplerType."); }
-    }
+    Sampler *sampler = CreateSampler(
+        context, context.Input<Tensor>("CustomDistProbs"),
+        context.Input<Tensor>("CustomDistAlias"),
+        context.Input<Tensor>("CustomDistAliasProbs"));
 
     PrepareSamples<DeviceContext, T>(context, sampler);
     auto sample_labels = context.Output<Tensor>("SampleLabels");
@@ -174,8 +186,12 @@ class NCEKernel : public framework::OpKernel<T> {
         sample_out_data[i] = 0;
       }
     }
-    // forward mul
-    auto input_mat = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
+    // forward mul, the dot products of the input rows and the gathered weight
+    // rows
+    auto *input = context.Input<Tensor>("Input");
+    const T *input_data = input->data<T>();
+    int64_t dim = input->dims()[1];
+    auto blas = math::GetBlas<DeviceContext, T>(context);
 
     // for remote prefetch
     auto remote_prefetch = context.Attr<bool>("remote_prefetch");
@@ -190,7 +206,7 @@ class NCEKernel : public framework::OpKernel<T> {
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
         labels.push_back(sample_labels_data[i]);
       }
-      std::set<T> st(labels.begin(), labels.end());
+      std::set<int64_t> st(labels.begin(), labels.end());
       labels.assign(st.begin(), st.end());
 
       framework::Scope &local_scope = context.scope().NewScope();
@@ -227,30 +243,27 @@ class NCEKernel : public framework::OpKernel<T> {
           "parameter prefetch!");
 #endif
 
-      auto weight_mat = EigenMatrix<T>::From(
-          (local_scope.Var("Weight@Prefetch")->Get<framework::LoDTensor>()));
+      const T *weight_data = local_scope.Var("Weight@Prefetch")
+                                 ->Get<framework::LoDTensor>()
+                                 .data<T>();
+      std::unordered_map<int64_t, int64_t> label_index;
+      for (size_t i = 0; i < labels.size(); ++i) {
+        label_index[labels[i]] = i;
+      }
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        std::vector<int64_t>::iterator it =
-            std::find(labels.begin(), labels.end(), sample_labels_data[i]);
-        int idx = std::distance(labels.begin(), it);
-
-        Eigen::Tensor<T, 0, Eigen::RowMajor, Eigen::DenseIndex> result =
-            (input_mat.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-             weight_mat.chip(idx, 0))
-                .sum();
-        sample_out_data[i] += result(0);
+        int64_t idx = label_index.at(sample_labels_data[i]);
+        sample_out_data[i] +=
+            blas.DOT(dim, input_data + (i / sampled_labels_num) * dim,
+                     weight_data + idx * dim);
         sample_out_data[i] = (1. / (1. + exp(-sample_out_data[i])));
       }
       context.scope().DeleteScope(&local_scope);
     } else {
-      auto weight_mat =
-          EigenMatrix<T>::From(*(context.Input<Tensor>("Weight")));
+      const T *weight_data = context.Input<Tensor>("Weight")->data<T>();
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        Eigen::Tensor<T, 0, Eigen::RowMajor, Eigen::DenseIndex> result =
-            (input_mat.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-             weight_mat.chip(sample_labels_data[i], 0))
-                .sum();
-        sample_out_data[i] += result(0);
+        sample_out_data[i] +=
+            blas.DOT(dim, input_data + (i / sampled_labels_num) * dim,
+                     weight_data + sample_labels_data[i] * dim);
         sample_out_data[i] = (1. / (1. + exp(-sample_out_data[i])));
       }
     }
@@ -288,60 +301,15 @@ class NCEGradKernel : public framework::OpKernel<T> {
       sample_weight_data = sample_weight->data<T>();
     }
     int num_neg_samples = context.Attr<int>("num_neg_samples");
-    int num_total_classes = context.Attr<int>("num_total_classes");
     int num_true_class = 1;
     if (label != nullptr) {
       num_true_class = label->dims()[1];
     }
 
-    int sampler_type = context.Attr<int>("sampler");
-    int seed = context.Attr<int>("seed");
-    Sampler *sampler;
-    switch (sampler_type) {
-      case 0: {
-        sampler = new math::UniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 1: {
-        sampler = new math::LogUniformSampler(num_total_classes - 1, seed);
-        break;
-      }
-      case 2: {
-        auto dist_probs = context.Input<Tensor>("CustomDistProbs");
-        auto dist_alias = context.Input<Tensor>("CustomDistAlias");
-        auto dist_alias_probs = context.Input<Tensor>("CustomDistAliasProbs");
-
-        PADDLE_ENFORCE_EQ(
-            dist_probs->numel(), num_total_classes,
-            "ShapeError: The number of elements in Input(CustomDistProbs) "
-            "should be equal to the number of total classes. But Received: "
-            "Input(CustomDistProbs).numel() = %d, Attr(num_total_classes) "
-            "= %d.",
-            dist_probs->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(
-            dist_alias->numel(), num_total_classes,
-            "ShapeError: The number of elements in Input(CustomDistAlias) "
-            "should be equal to the number of total classes. But Received: "
-            "Input(CustomDistAlias).numel() = %d, Attr(num_total_classes) "
-            "= %d.",
-            dist_alias->numel(), num_total_classes);
-        PADDLE_ENFORCE_EQ(
-            dist_alias_probs->numel(), num_total_classes,
-            "ShapeError: The number of elements in Input(CustomDistAliasProbs) "
-            "should be equal to the number of total classes. But Received: "
-            "Input(CustomDistAliasProbs).numel() = %d, "
-            "Attr(num_total_classes) = %d.",
-            dist_alias_probs->numel(), num_total_classes);
-
-        const float *probs_data = dist_probs->data<float>();
-        const int *alias_data = dist_alias->data<int>();
-        const float *alias_probs_data = dist_alias_probs->data<float>();
-        sampler = new math::CustomSampler(num_total_classes - 1, probs_data,
-                                          alias_data, alias_probs_data, seed);
-        break;
-      }
-      default: { PADDLE_THROW("Unsupported SamplerType."); }
-    }
+    Sampler *sampler = CreateSampler(
+        context, context.Input<Tensor>("CustomDistProbs"),
+        context.Input<Tensor>("CustomDistAlias"),
+        context.Input<Tensor>("CustomDistAliasProbs"));
 
     //    T b = 1. / num_total_classes * num_neg_samples;
     Tensor sample_grad;  // tmp tensor
@@ -371,6 +339,9 @@ class NCEGradKernel : public framework::OpKernel<T> {
     }
 
     bool is_sparse = context.Attr<bool>("is_sparse");
+    int64_t sampled_labels_num = sample_labels->dims()[1];
+    const T *x_data = context.Input<Tensor>("Input")->data<T>();
+    auto blas = math::GetBlas<DeviceContext, T>(context);
 
     if (!is_sparse) {
       // get d_w
@@ -378,12 +349,11 @@ class NCEGradKernel : public framework::OpKernel<T> {
       if (d_w != nullptr) {
         auto d_w_data = d_w->mutable_data<T>(context.GetPlace());
         std::fill(d_w_data, d_w_data + d_w->numel(), 0.0);
-        auto d_w_matrix = EigenMatrix<T>::From(*d_w);
-        auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
+        int64_t dim = d_w->dims()[1];
         for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-          d_w_matrix.chip(sample_labels_data[i], 0) +=
-              x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-              sample_grad_data[i];
+          blas.AXPY(dim, sample_grad_data[i],
+                    x_data + (i / sampled_labels_num) * dim,
+                    d_w_data + sample_labels_data[i] * dim);
         }
       }
     } else {
@@ -391,7 +361,7 @@ class NCEGradKernel : public framework::OpKernel<T> {
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
         labels.push_back(sample_labels_data[i]);
       }
-      std::set<T> st(labels.begin(), labels.end());
+      std::set<int64_t> st(labels.begin(), labels.end());
       labels.assign(st.begin(), st.end());
 
       auto *table_var = context.InputVar("Weight");
@@ -418,12 +388,17 @@ class NCEGradKernel : public framework::OpKernel<T> {
       auto d_w_data = d_table_value->mutable_data<T>(context.GetPlace());
       std::fill(d_w_data, d_w_data + d_table_value->numel(), 0.0);
 
-      auto d_w_matrix = EigenMatrix<T>::From(*d_table_value);
-      auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
+      // d_w->Index searches the rows linearly, so the row of each label is
+      // looked up in a hash map instead
+      std::unordered_map<int64_t, int64_t> label_index;
+      for (size_t i = 0; i < labels.size(); ++i) {
+        label_index[labels[i]] = i;
+      }
+      int64_t dim = table_dim[1];
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        d_w_matrix.chip(d_w->Index(sample_labels_data[i]), 0) +=
-            x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-            sample_grad_data[i];
+        blas.AXPY(dim, sample_grad_data[i],
+                  x_data + (i / sampled_labels_num) * dim,
+                  d_w_data + label_index.at(sample_labels_data[i]) * dim);
       }
     }
 
@@ -432,11 +407,12 @@ class NCEGradKernel : public framework::OpKernel<T> {
     if (d_x != nullptr) {
       auto *d_x_data = d_x->mutable_data<T>(context.GetPlace());
       std::fill(d_x_data, d_x_data + d_x->numel(), 0.0);
-      auto d_x_matrix = EigenMatrix<T>::From(*d_x);
-      auto w_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Weight")));
+      const T *w_data = context.Input<Tensor>("Weight")->data<T>();
+      int64_t dim = d_x->dims()[1];
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        d_x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) +=
-            w_matrix.chip(sample_labels_data[i], 0) * sample_grad_data[i];
+        blas.AXPY(dim, sample_grad_data[i],
+                  w_data + sample_labels_data[i] * dim,
+                  d_x_data + (i / sampled_labels_num) * dim);
       }
     }
 
@@ -115,32 +115,22 @@ struct SparseAdagradFunctor<platform::CPUDeviceContext, T> {
                   const framework::SelectedRows& grad,
                   const framework::Tensor& learning_rate, T epsilon,
                   framework::Tensor* moment, framework::Tensor* param) {
-    // 1. g_m.rows = set(g.rows)
+    // The duplicated rows of g are merged, and m += g_m * g_m and the
+    // parameter are updated row by row, without the merged SelectedRows.
     auto grad_width = grad.value().dims()[1];
-    math::scatter::MergeAdd<platform::CPUDeviceContext, T> merge_func;
-    auto grad_merge = merge_func(context, grad);
-    auto& merge_rows = grad_merge.rows();
-    auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
-
-    // 2. m += g_m * g_m
-    auto grad_square =
-        SquareSelectedRows<platform::CPUDeviceContext, T>(context, grad_merge);
-
-    math::SelectedRowsAddToTensor<platform::CPUDeviceContext, T> functor;
-    functor(context, grad_square, moment);
-
-    // 3. update parameter
-    auto* lr = learning_rate.data<T>();
+    T lr = learning_rate.data<T>()[0];
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
 
-    for (size_t i = 0; i < merge_rows.size(); i++) {
-      for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
-      }
-    }
+    math::scatter::MergeAndUpdate<T>(
+        grad, moment->dims()[0], [&](int64_t row, const T* g) {
+          T* p = param_data + row * grad_width;
+          T* m = moment_data + row * grad_width;
+          for (int64_t j = 0; j < grad_width; j++) {
+            m[j] += g[j] * g[j];
+            p[j] -= lr * g[j] / (std::sqrt(m[j]) + epsilon);
+          }
+        });
   }
 };
 
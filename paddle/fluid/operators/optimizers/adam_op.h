@@ -464,7 +464,9 @@ class AdamOpKernel : public framework::OpKernel<T> {
 
       framework::SelectedRows tmp_grad_merge;
       const framework::SelectedRows* grad_merge_ptr;
-      if (is_strict_sorted) {
+      // In lazy mode, the duplicated rows are merged by MergeAndUpdate when
+      // the moments and the parameter are updated.
+      if (is_strict_sorted || lazy_mode) {
         grad_merge_ptr = grad;
       } else {
         // merge duplicated rows if any.
@@ -495,14 +497,12 @@ class AdamOpKernel : public framework::OpKernel<T> {
           beta2 * beta2_pow->data<T>()[0];
       if (lazy_mode) {
         VLOG(3) << "run cpu lazy mode";
-        size_t row_count = grad_merge.rows().size();
-        std::vector<int64_t> cpu_rows(grad_merge.rows());
-        for (size_t row_index = 0; row_index < row_count; ++row_index) {
-          for (size_t offset = 0; offset < row_numel; ++offset) {
-            size_t i = cpu_rows[row_index] * row_numel + offset;
-            functor.adam_update(i, grad_data[row_index * row_numel + offset]);
-          }
-        }
+        scatter::MergeAndUpdate<T>(
+            grad_merge, param->dims()[0], [&](int64_t row, const T* g) {
+              for (size_t offset = 0; offset < row_numel; ++offset) {
+                functor.adam_update(row * row_numel + offset, g[offset]);
+              }
+            });
       }
 #ifndef _WIN32
       else if (FLAGS_inner_op_parallelism > 1 &&  // NOLINT
@@ -39,11 +39,12 @@ class FTRLOp : public framework::OperatorWithKernel {
             framework::proto::VarType::LOD_TENSOR,
         "The input var's type should be LoDTensor, but the received is %s",
         ctx->Inputs("Param").front(), ctx->GetInputsVarType("Param").front());
-    PADDLE_ENFORCE(
-        ctx->GetInputsVarType("Grad").front() ==
-            framework::proto::VarType::LOD_TENSOR,
-        "The input var's type should be LoDTensor, but the received is %s",
-        ctx->Inputs("Grad").front(), ctx->GetInputsVarType("Grad").front());
+    auto grad_type = ctx->GetInputsVarType("Grad").front();
+    PADDLE_ENFORCE(grad_type == framework::proto::VarType::LOD_TENSOR ||
+                       grad_type == framework::proto::VarType::SELECTED_ROWS,
+                   "The input var's type should be LoDTensor or SelectedRows, "
+                   "but the received is %s",
+                   ctx->Inputs("Grad").front(), grad_type);
 
     PADDLE_ENFORCE(ctx->HasOutput("ParamOut"),
                    "Output(ParamOut) of FTRL should not be null.");
@@ -90,8 +91,10 @@ class FTRLOpMaker : public framework::OpProtoAndCheckerMaker {
              "(Tensor, default Tensor<float>) "
              "Accumulator that accumulates linear gradients.");
     AddInput("Grad",
-             "(Tensor, default Tensor<float>) "
-             "Input gradient of the parameter.");
+             "(Tensor or SelectedRows, default Tensor<float>) "
+             "Input gradient of the parameter. The SelectedRows gradient "
+             "is only supported on CPU, and updates the parameter and the "
+             "accumulators in place.");
     AddInput("LearningRate",
              "(Tensor, default Tensor<float>) "
              "The learning rate should be a tensor of size 1.");
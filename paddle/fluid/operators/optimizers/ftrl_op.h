@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <cmath>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
 
 namespace paddle {
 namespace operators {
@@ -24,6 +27,41 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenVector = framework::EigenVector<T, MajorType, IndexType>;
 
+// Update the rows of the parameter and the accumulators in place by the
+// SelectedRows gradient, whose duplicated rows are merged, on CPU.
+template <typename T>
+void SparseFTRLUpdate(const framework::SelectedRows& grad, T lr, T l1, T l2,
+                      T lr_power, framework::Tensor* param,
+                      framework::Tensor* sq_accum,
+                      framework::Tensor* lin_accum) {
+  int64_t width = param->numel() / param->dims()[0];
+  T* p_data = param->data<T>();
+  T* sq_data = sq_accum->data<T>();
+  T* lin_data = lin_accum->data<T>();
+  bool sqrt_power = lr_power == static_cast<T>(-0.5);
+  math::scatter::MergeAndUpdate<T>(
+      grad, param->dims()[0], [&](int64_t row, const T* g) {
+        T* p = p_data + row * width;
+        T* sq = sq_data + row * width;
+        T* lin = lin_data + row * width;
+        for (int64_t j = 0; j < width; ++j) {
+          T new_accum = sq[j] + g[j] * g[j];
+          T new_pow = sqrt_power ? std::sqrt(new_accum)
+                                 : std::pow(new_accum, -lr_power);
+          T old_pow =
+              sqrt_power ? std::sqrt(sq[j]) : std::pow(sq[j], -lr_power);
+          lin[j] += g[j] - (new_pow - old_pow) / lr * p[j];
+          if (std::abs(lin[j]) > l1) {
+            T sign = static_cast<T>((lin[j] > 0) - (lin[j] < 0));
+            p[j] = (l1 * sign - lin[j]) / (new_pow / lr + 2 * l2);
+          } else {
+            p[j] = static_cast<T>(0);
+          }
+          sq[j] = new_accum;
+        }
+      });
+}
+
 template <typename DeviceContext, typename T>
 class FTRLOpKernel : public framework::OpKernel<T> {
  public:
@@ -35,8 +73,9 @@ class FTRLOpKernel : public framework::OpKernel<T> {
                    ctx.InputNames("Param").front(),
                    framework::ToTypeName(param_var->Type()));
     const auto* grad_var = ctx.InputVar("Grad");
-    PADDLE_ENFORCE(grad_var->IsType<framework::LoDTensor>(),
-                   "The Var(%s)'s type should be LoDTensor, "
+    PADDLE_ENFORCE(grad_var->IsType<framework::LoDTensor>() ||
+                       grad_var->IsType<framework::SelectedRows>(),
+                   "The Var(%s)'s type should be LoDTensor or SelectedRows, "
                    "but the received is %s",
                    ctx.InputNames("Grad").front(),
                    framework::ToTypeName(grad_var->Type()));
@@ -49,12 +88,35 @@ class FTRLOpKernel : public framework::OpKernel<T> {
     sq_accum_out->mutable_data<T>(ctx.GetPlace());
     lin_accum_out->mutable_data<T>(ctx.GetPlace());
 
-    auto grad = ctx.Input<Tensor>("Grad");
-
     auto l1 = static_cast<T>(ctx.Attr<float>("l1"));
     auto l2 = static_cast<T>(ctx.Attr<float>("l2"));
     auto lr_power = static_cast<T>(ctx.Attr<float>("lr_power"));
 
+    if (grad_var->IsType<framework::SelectedRows>()) {
+      PADDLE_ENFORCE_EQ(platform::is_cpu_place(ctx.GetPlace()), true,
+                        platform::errors::Unimplemented(
+                            "The SelectedRows gradient of FTRL is only "
+                            "supported on CPU."));
+      PADDLE_ENFORCE_EQ(ctx.Input<Tensor>("Param"), param_out,
+                        platform::errors::InvalidArgument(
+                            "The sparse FTRL should update Param in place."));
+      PADDLE_ENFORCE_EQ(
+          ctx.Input<Tensor>("SquaredAccumulator"), sq_accum_out,
+          platform::errors::InvalidArgument(
+              "The sparse FTRL should update SquaredAccumulator in place."));
+      PADDLE_ENFORCE_EQ(
+          ctx.Input<Tensor>("LinearAccumulator"), lin_accum_out,
+          platform::errors::InvalidArgument(
+              "The sparse FTRL should update LinearAccumulator in place."));
+      SparseFTRLUpdate<T>(*ctx.Input<framework::SelectedRows>("Grad"),
+                          ctx.Input<Tensor>("LearningRate")->data<T>()[0], l1,
+                          l2, lr_power, param_out, sq_accum_out,
+                          lin_accum_out);
+      return;
+    }
+
+    auto grad = ctx.Input<Tensor>("Grad");
+
     auto p = EigenVector<T>::Flatten(*ctx.Input<Tensor>("Param"));
     auto sq_accum =
         EigenVector<T>::Flatten(*ctx.Input<Tensor>("SquaredAccumulator"));
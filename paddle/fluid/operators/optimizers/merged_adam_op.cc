@@ -0,0 +1,83 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/merged_adam_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedAdamOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(Tensor) Input parameters").AsDuplicable();
+    AddInput("Grad", "(Tensor) Input gradients").AsDuplicable();
+    AddInput("LearningRate",
+             "(Tensor) Learning rate of all the parameters, or one for each "
+             "of them")
+        .AsDuplicable();
+    AddInput("Moment1", "(Tensor) Input first moments").AsDuplicable();
+    AddInput("Moment2", "(Tensor) Input second moments").AsDuplicable();
+    AddInput("Beta1Pow", "(Tensor) Input beta1 power accumulators")
+        .AsDuplicable();
+    AddInput("Beta2Pow", "(Tensor) Input beta2 power accumulators")
+        .AsDuplicable();
+
+    AddOutput("ParamOut",
+              "(Tensor) Output parameters, which share memory with "
+              "Input(Param)")
+        .AsDuplicable();
+    AddOutput("Moment1Out", "(Tensor) Output first moments").AsDuplicable();
+    AddOutput("Moment2Out", "(Tensor) Output second moments").AsDuplicable();
+    AddOutput("Beta1PowOut", "(Tensor) Output beta1 power accumulators")
+        .AsDuplicable();
+    AddOutput("Beta2PowOut", "(Tensor) Output beta2 power accumulators")
+        .AsDuplicable();
+
+    AddAttr<float>("beta1",
+                   "(float, default 0.9) "
+                   "Exponential decay rate for the "
+                   "first moment estimates.")
+        .SetDefault(0.9f);
+    AddAttr<float>("beta2",
+                   "(float, default 0.999) "
+                   "exponential decay rate for the "
+                   "second moment estimates.")
+        .SetDefault(0.999f);
+    AddAttr<float>("epsilon",
+                   "(float, default 1.0e-8) "
+                   "Constant for numerical stability")
+        .SetDefault(1.0e-8f);
+
+    AddComment(R"DOC(
+Merged Adam Optimizer.
+
+Update each of the parameters with dense gradients as the adam op, whose
+states are updated in place. The parameters are not coalesced, and all of them
+are updated by a few kernels on GPU, each of which updates the chunks of many
+parameters by the tables of their pointers and sizes.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(merged_adam, ops::MergedAdamOp,
+                             ops::MergedAdamOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    merged_adam,
+    ops::MergedAdamOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::MergedAdamOpKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,172 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/merged_adam_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+// The beta pows on CPU are passed by values, and the ones on GPU by pointers,
+// which are updated by MergedAdamUpdateBetaPow after all the parameters.
+template <typename T>
+struct MergedAdamArgs {
+  static constexpr int kMaxTensors = 24;
+  ChunkTable table;
+  int64_t numel[kMaxTensors];
+  T* param[kMaxTensors];
+  const T* grad[kMaxTensors];
+  T* moment1[kMaxTensors];
+  T* moment2[kMaxTensors];
+  const T* lr[kMaxTensors];
+  const T* beta1_pow_ptr[kMaxTensors];
+  const T* beta2_pow_ptr[kMaxTensors];
+  T beta1_pow[kMaxTensors];
+  T beta2_pow[kMaxTensors];
+};
+
+template <typename T>
+struct MergedAdamBetaPowArgs {
+  static constexpr int kMaxTensors = 128;
+  int num;
+  T* beta1_pow[kMaxTensors];
+  T* beta2_pow[kMaxTensors];
+};
+
+template <typename T>
+__global__ void MergedAdamKernel(MergedAdamArgs<T> args, T beta1, T beta2,
+                                 T epsilon) {
+  int64_t begin, end;
+  int t = ChunkOfBlock(args.table, args.numel, &begin, &end);
+  T beta1_pow =
+      args.beta1_pow_ptr[t] ? *args.beta1_pow_ptr[t] : args.beta1_pow[t];
+  T beta2_pow =
+      args.beta2_pow_ptr[t] ? *args.beta2_pow_ptr[t] : args.beta2_pow[t];
+  T lr = *args.lr[t] * sqrt(static_cast<T>(1.0) - beta2_pow) /
+         (static_cast<T>(1.0) - beta1_pow);
+
+  T* param = args.param[t];
+  const T* grad = args.grad[t];
+  T* moment1 = args.moment1[t];
+  T* moment2 = args.moment2[t];
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    T g = grad[i];
+    T mom1 = beta1 * moment1[i] + (static_cast<T>(1.0) - beta1) * g;
+    T mom2 = beta2 * moment2[i] + (static_cast<T>(1.0) - beta2) * g * g;
+    moment1[i] = mom1;
+    moment2[i] = mom2;
+    param[i] -= lr * (mom1 / (sqrt(mom2) + epsilon));
+  }
+}
+
+template <typename T>
+__global__ void MergedAdamUpdateBetaPow(MergedAdamBetaPowArgs<T> args,
+                                        T beta1, T beta2) {
+  int i = threadIdx.x;
+  if (i < args.num) {
+    *args.beta1_pow[i] *= beta1;
+    *args.beta2_pow[i] *= beta2;
+  }
+}
+
+template <typename T>
+class MergedAdamOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto mom1s = GetInPlaceTensors(ctx, "Moment1", "Moment1Out");
+    auto mom2s = GetInPlaceTensors(ctx, "Moment2", "Moment2Out");
+    auto beta1_pows = GetInPlaceTensors(ctx, "Beta1Pow", "Beta1PowOut");
+    auto beta2_pows = GetInPlaceTensors(ctx, "Beta2Pow", "Beta2PowOut");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto stream = ctx.cuda_device_context().stream();
+
+    std::vector<int64_t> numels(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      numels[i] = params[i]->numel();
+    }
+    using Args = MergedAdamArgs<T>;
+    MultiTensorApply<Args::kMaxTensors>(
+        numels, kMultiTensorApplyChunkSize,
+        [&](int first, int num, const ChunkTable& table, int blocks) {
+          Args args;
+          args.table = table;
+          for (int j = 0; j < num; ++j) {
+            int i = first + j;
+            args.numel[j] = numels[i];
+            args.param[j] = params[i]->data<T>();
+            args.grad[j] = grads[i]->data<T>();
+            args.moment1[j] = mom1s[i]->data<T>();
+            args.moment2[j] = mom2s[i]->data<T>();
+            args.lr[j] = lrs[i]->data<T>();
+            bool cpu_pow = platform::is_cpu_place(beta1_pows[i]->place());
+            args.beta1_pow_ptr[j] =
+                cpu_pow ? nullptr : beta1_pows[i]->data<T>();
+            args.beta1_pow[j] = cpu_pow ? beta1_pows[i]->data<T>()[0] : 0;
+            cpu_pow = platform::is_cpu_place(beta2_pows[i]->place());
+            args.beta2_pow_ptr[j] =
+                cpu_pow ? nullptr : beta2_pows[i]->data<T>();
+            args.beta2_pow[j] = cpu_pow ? beta2_pows[i]->data<T>()[0] : 0;
+          }
+          MergedAdamKernel<T><<<blocks, kMultiTensorApplyThreads, 0,
+                                stream>>>(args, beta1, beta2, epsilon);
+        });
+
+    // The beta pows are updated after all the kernels, since the chunks of a
+    // parameter may be updated by two kernels.
+    MergedAdamBetaPowArgs<T> pow_args;
+    pow_args.num = 0;
+    auto update_pows = [&] {
+      MergedAdamUpdateBetaPow<
+          T><<<1, MergedAdamBetaPowArgs<T>::kMaxTensors, 0, stream>>>(
+          pow_args, beta1, beta2);
+      pow_args.num = 0;
+    };
+    for (size_t i = 0; i < params.size(); ++i) {
+      bool cpu_pow1 = platform::is_cpu_place(beta1_pows[i]->place());
+      bool cpu_pow2 = platform::is_cpu_place(beta2_pows[i]->place());
+      PADDLE_ENFORCE_EQ(
+          cpu_pow1, cpu_pow2,
+          platform::errors::InvalidArgument(
+              "The %d-th Input(Beta1Pow) and Input(Beta2Pow) of merged_adam "
+              "should be on the same place.",
+              i));
+      if (cpu_pow1) {
+        beta1_pows[i]->data<T>()[0] *= beta1;
+        beta2_pows[i]->data<T>()[0] *= beta2;
+        continue;
+      }
+      pow_args.beta1_pow[pow_args.num] = beta1_pows[i]->data<T>();
+      pow_args.beta2_pow[pow_args.num] = beta2_pows[i]->data<T>();
+      if (++pow_args.num == MergedAdamBetaPowArgs<T>::kMaxTensors) {
+        update_pows();
+      }
+    }
+    if (pow_args.num > 0) {
+      update_pows();
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(merged_adam, ops::MergedAdamOpCUDAKernel<float>,
+                        ops::MergedAdamOpCUDAKernel<double>);
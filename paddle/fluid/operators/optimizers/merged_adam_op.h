@@ -0,0 +1,83 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/operators/optimizers/adam_op.h"
+#include "paddle/fluid/operators/optimizers/merged_optimizer_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedAdamOp : public MergedOptimizerOp {
+ public:
+  using MergedOptimizerOp::MergedOptimizerOp;
+
+ protected:
+  std::vector<std::pair<std::string, std::string>> InPlaceStates()
+      const override {
+    return {{"Moment1", "Moment1Out"},
+            {"Moment2", "Moment2Out"},
+            {"Beta1Pow", "Beta1PowOut"},
+            {"Beta2Pow", "Beta2PowOut"}};
+  }
+
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string& var_name, const framework::Tensor& tensor,
+      const framework::OpKernelType& expected_kernel_type) const override {
+    // The beta pows are used in place wherever they are.
+    if (var_name == "Beta1Pow" || var_name == "Beta2Pow") {
+      return expected_kernel_type;
+    }
+    return framework::OpKernelType(expected_kernel_type.data_type_,
+                                   tensor.place(), tensor.layout());
+  }
+};
+
+template <typename DeviceContext, typename T>
+class MergedAdamOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto mom1s = GetInPlaceTensors(ctx, "Moment1", "Moment1Out");
+    auto mom2s = GetInPlaceTensors(ctx, "Moment2", "Moment2Out");
+    auto beta1_pows = GetInPlaceTensors(ctx, "Beta1Pow", "Beta1PowOut");
+    auto beta2_pows = GetInPlaceTensors(ctx, "Beta2Pow", "Beta2PowOut");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    for (size_t i = 0; i < params.size(); ++i) {
+      T* beta1_pow = beta1_pows[i]->data<T>();
+      T* beta2_pow = beta2_pows[i]->data<T>();
+      T* param = params[i]->data<T>();
+      T* mom1 = mom1s[i]->data<T>();
+      T* mom2 = mom2s[i]->data<T>();
+      AdamFunctor<T, CPUAdam> functor(beta1, beta2, epsilon, beta1_pow,
+                                      beta2_pow, mom1, mom1, mom2, mom2,
+                                      lrs[i]->data<T>(), grads[i]->data<T>(),
+                                      param, param);
+      functor(params[i]->numel());
+      beta1_pow[0] *= beta1;
+      beta2_pow[0] *= beta2;
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,75 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/merged_lamb_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedLambOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(LoDTensor) Input parameters").AsDuplicable();
+    AddInput("Grad", "(LoDTensor) Input gradients").AsDuplicable();
+    AddInput("LearningRate",
+             "(Tensor) Learning rate of all the parameters, or one for each "
+             "of them")
+        .AsDuplicable();
+    AddInput("Moment1", "(Tensor) Input first moments").AsDuplicable();
+    AddInput("Moment2", "(Tensor) Input second moments").AsDuplicable();
+
+    AddOutput("ParamOut",
+              "(Tensor) Output parameters, which share memory with "
+              "Input(Param)")
+        .AsDuplicable();
+    AddOutput("Moment1Out", "(Tensor) Output first moments").AsDuplicable();
+    AddOutput("Moment2Out", "(Tensor) Output second moments").AsDuplicable();
+
+    AddAttr<float>("weight_decay", "(float) Weight decay rate.");
+    AddAttr<float>("beta1",
+                   "(float, default 0.9) The exponential decay rate for the "
+                   "1st moment estimates.")
+        .SetDefault(0.9);
+    AddAttr<float>("beta2",
+                   "(float, default 0.999) The exponential decay rate for the "
+                   "2nd moment estimates.")
+        .SetDefault(0.999);
+    AddAttr<float>("epsilon",
+                   "(float, default 1.0e-6) "
+                   "Constant for numerical stability.")
+        .SetDefault(1.0e-6f);
+
+    AddComment(R"DOC(
+Merged LAMB Optimizer.
+
+Update each of the parameters with dense gradients as the lamb op, whose trust
+ratio is computed by its own norms. On GPU, the moments and the norms of all
+the parameters are computed by a few kernels, each of which processes the
+chunks of many parameters by the tables of their pointers and sizes, and so
+are the updates.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(merged_lamb, ops::MergedLambOp,
+                             ops::MergedLambOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    merged_lamb,
+    ops::MergedLambOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::MergedLambOpKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,163 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/optimizers/merged_lamb_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+// The square sums of the param and the trust ratio div of the i-th parameter
+// are sums[2 * i] and sums[2 * i + 1], where i is first plus the index of the
+// tensor in the launch.
+template <typename T>
+struct MergedLambArgs {
+  static constexpr int kMaxTensors = 36;
+  ChunkTable table;
+  int first;
+  T* sums;
+  int64_t numel[kMaxTensors];
+  T* param[kMaxTensors];
+  const T* grad[kMaxTensors];
+  T* moment1[kMaxTensors];
+  T* moment2[kMaxTensors];
+  T* trust_ratio_div[kMaxTensors];
+  const T* lr[kMaxTensors];
+};
+
+template <typename T>
+__global__ void MergedLambMomentKernel(MergedLambArgs<T> args, T weight_decay,
+                                       T beta1, T beta2, T epsilon) {
+  int64_t begin, end;
+  int t = ChunkOfBlock(args.table, args.numel, &begin, &end);
+  const T* param = args.param[t];
+  const T* grad = args.grad[t];
+  T* moment1 = args.moment1[t];
+  T* moment2 = args.moment2[t];
+  T* trust_ratio_div = args.trust_ratio_div[t];
+  T p_sum = 0;
+  T t_sum = 0;
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    T g = grad[i];
+    T p = param[i];
+    T mom1 = beta1 * moment1[i] + (1 - beta1) * g;
+    T mom2 = beta2 * moment2[i] + (1 - beta2) * g * g;
+    moment1[i] = mom1;
+    moment2[i] = mom2;
+    T trust = mom1 / (sqrt(mom2) + epsilon) + weight_decay * p;
+    trust_ratio_div[i] = trust;
+    p_sum += p * p;
+    t_sum += trust * trust;
+  }
+  BlockAtomicAddSums(p_sum, t_sum, args.sums + 2 * (args.first + t));
+}
+
+template <typename T>
+__global__ void MergedLambParamKernel(MergedLambArgs<T> args) {
+  int64_t begin, end;
+  int t = ChunkOfBlock(args.table, args.numel, &begin, &end);
+  const T* sums = args.sums + 2 * (args.first + t);
+  T p_norm = sqrt(sums[0]);
+  T t_norm = sqrt(sums[1]);
+  T lr = *args.lr[t];
+  if (p_norm > 0 && t_norm > 0) {
+    lr *= p_norm / t_norm;
+  }
+  T* param = args.param[t];
+  const T* trust_ratio_div = args.trust_ratio_div[t];
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    param[i] -= lr * trust_ratio_div[i];
+  }
+}
+
+template <typename T>
+class MergedLambOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto mom1s = GetInPlaceTensors(ctx, "Moment1", "Moment1Out");
+    auto mom2s = GetInPlaceTensors(ctx, "Moment2", "Moment2Out");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T weight_decay = static_cast<T>(ctx.Attr<float>("weight_decay"));
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto& dev_ctx = ctx.cuda_device_context();
+    auto stream = dev_ctx.stream();
+
+    int n = static_cast<int>(params.size());
+    std::vector<int64_t> numels(n);
+    std::vector<int64_t> offsets(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      numels[i] = params[i]->numel();
+      offsets[i + 1] = offsets[i] + numels[i];
+    }
+    // The trust ratio divs of all the parameters are in one buffer, and the
+    // square sums are in another.
+    framework::Tensor trust_ratio_div_t =
+        ctx.AllocateTmpTensor<T, platform::CUDADeviceContext>({offsets[n]},
+                                                              dev_ctx);
+    framework::Tensor sums_t =
+        ctx.AllocateTmpTensor<T, platform::CUDADeviceContext>({2 * n},
+                                                              dev_ctx);
+    math::SetConstant<platform::CUDADeviceContext, T>()(dev_ctx, &sums_t, 0);
+    T* trust_ratio_div = trust_ratio_div_t.data<T>();
+    T* sums = sums_t.data<T>();
+
+    using Args = MergedLambArgs<T>;
+    auto make_args = [&](int first, int num, const ChunkTable& table) {
+      Args args;
+      args.table = table;
+      args.first = first;
+      args.sums = sums;
+      for (int j = 0; j < num; ++j) {
+        int i = first + j;
+        args.numel[j] = numels[i];
+        args.param[j] = params[i]->data<T>();
+        args.grad[j] = grads[i]->data<T>();
+        args.moment1[j] = mom1s[i]->data<T>();
+        args.moment2[j] = mom2s[i]->data<T>();
+        args.trust_ratio_div[j] = trust_ratio_div + offsets[i];
+        args.lr[j] = lrs[i]->data<T>();
+      }
+      return args;
+    };
+    // All the norms are reduced before the updates, since the chunks of a
+    // parameter may be in two launches.
+    MultiTensorApply<Args::kMaxTensors>(
+        numels, kMultiTensorApplyChunkSize,
+        [&](int first, int num, const ChunkTable& table, int blocks) {
+          MergedLambMomentKernel<T><<<blocks, kMultiTensorApplyThreads, 0,
+                                      stream>>>(
+              make_args(first, num, table), weight_decay, beta1, beta2,
+              epsilon);
+        });
+    MultiTensorApply<Args::kMaxTensors>(
+        numels, kMultiTensorApplyChunkSize,
+        [&](int first, int num, const ChunkTable& table, int blocks) {
+          MergedLambParamKernel<T><<<blocks, kMultiTensorApplyThreads, 0,
+                                     stream>>>(make_args(first, num, table));
+        });
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(merged_lamb, ops::MergedLambOpCUDAKernel<float>,
+                        ops::MergedLambOpCUDAKernel<double>);
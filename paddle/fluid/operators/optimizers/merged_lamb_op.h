@@ -0,0 +1,79 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/operators/optimizers/lamb_op.h"
+#include "paddle/fluid/operators/optimizers/merged_optimizer_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedLambOp : public MergedOptimizerOp {
+ public:
+  using MergedOptimizerOp::MergedOptimizerOp;
+
+ protected:
+  std::vector<std::pair<std::string, std::string>> InPlaceStates()
+      const override {
+    return {{"Moment1", "Moment1Out"}, {"Moment2", "Moment2Out"}};
+  }
+};
+
+template <typename DeviceContext, typename T>
+class MergedLambOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto mom1s = GetInPlaceTensors(ctx, "Moment1", "Moment1Out");
+    auto mom2s = GetInPlaceTensors(ctx, "Moment2", "Moment2Out");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T weight_decay = static_cast<T>(ctx.Attr<float>("weight_decay"));
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    for (size_t i = 0; i < params.size(); ++i) {
+      platform::ForRange<DeviceContext> for_range(dev_ctx, params[i]->numel());
+      framework::Tensor trust_ratio_div =
+          ctx.AllocateTmpTensor<T, DeviceContext>(params[i]->dims(), dev_ctx);
+      T* param = params[i]->data<T>();
+      T* mom1 = mom1s[i]->data<T>();
+      T* mom2 = mom2s[i]->data<T>();
+      // lamb does no bias correction, so the beta pows are not needed
+      LambMomentUpdateFunctor<T> moment_update_functor(
+          weight_decay, beta1, beta2, epsilon, nullptr, nullptr, mom1, mom1,
+          mom2, mom2, grads[i]->data<T>(), param,
+          trust_ratio_div.template data<T>());
+      for_range(moment_update_functor);
+
+      auto p = framework::EigenVector<T>::Flatten(*params[i]);
+      auto t = framework::EigenVector<T>::Flatten(trust_ratio_div);
+      Eigen::Tensor<T, 0, Eigen::RowMajor> p_norm = p.square().sum().sqrt();
+      Eigen::Tensor<T, 0, Eigen::RowMajor> t_norm = t.square().sum().sqrt();
+      LambParamUpateFunctor<T> param_update_functor(
+          lrs[i]->data<T>(), param, p_norm.data(),
+          trust_ratio_div.template data<T>(), t_norm.data(), param);
+      for_range(param_update_functor);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
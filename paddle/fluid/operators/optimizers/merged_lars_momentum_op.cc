@@ -0,0 +1,70 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/merged_lars_momentum_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedLarsMomentumOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(Tensor) Input parameters").AsDuplicable();
+    AddInput("Grad", "(Tensor) Input gradients").AsDuplicable();
+    AddInput("Velocity", "(Tensor) Input velocities").AsDuplicable();
+    AddInput("LearningRate",
+             "(Tensor) Learning rate of all the parameters, or one for each "
+             "of them")
+        .AsDuplicable();
+
+    AddOutput("ParamOut",
+              "(Tensor) Output parameters, which share memory with "
+              "Input(Param)")
+        .AsDuplicable();
+    AddOutput("VelocityOut",
+              "(Tensor) Output velocities, which share memory with "
+              "Input(Velocity)")
+        .AsDuplicable();
+
+    AddAttr<float>("mu", "(float) Momentum coefficient");
+    AddAttr<float>("lars_coeff", "(float, default 0.001) LARS coefficient.")
+        .SetDefault(0.001);
+    AddAttr<float>("lars_weight_decay",
+                   "(float, default 0.0005) LARS weight decay")
+        .SetDefault(0.0005);
+
+    AddComment(R"DOC(
+Merged Lars Momentum Optimizer.
+
+Update each of the parameters with dense gradients as the lars_momentum op,
+whose local learning rate is computed by its own norms. On GPU, the norms of
+all the parameters are computed by a few kernels, each of which reduces the
+chunks of many parameters by the tables of their pointers and sizes, and so
+are the updates.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(merged_lars_momentum, ops::MergedLarsMomentumOp,
+                             ops::MergedLarsMomentumOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    merged_lars_momentum,
+    ops::MergedLarsMomentumOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::MergedLarsMomentumOpKernel<paddle::platform::CPUDeviceContext,
+                                    double>);
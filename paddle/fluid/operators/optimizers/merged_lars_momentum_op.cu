@@ -0,0 +1,141 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/optimizers/merged_lars_momentum_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+// The square sums of the param and the grad of the i-th parameter are
+// sums[2 * i] and sums[2 * i + 1], where i is first plus the index of the
+// tensor in the launch.
+template <typename T>
+struct MergedLarsMomentumArgs {
+  static constexpr int kMaxTensors = 48;
+  ChunkTable table;
+  int first;
+  T* sums;
+  int64_t numel[kMaxTensors];
+  T* param[kMaxTensors];
+  const T* grad[kMaxTensors];
+  T* velocity[kMaxTensors];
+  const T* lr[kMaxTensors];
+};
+
+template <typename T>
+__global__ void MergedLarsNormKernel(MergedLarsMomentumArgs<T> args) {
+  int64_t begin, end;
+  int t = ChunkOfBlock(args.table, args.numel, &begin, &end);
+  const T* param = args.param[t];
+  const T* grad = args.grad[t];
+  T p_sum = 0;
+  T g_sum = 0;
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    p_sum += param[i] * param[i];
+    g_sum += grad[i] * grad[i];
+  }
+  BlockAtomicAddSums(p_sum, g_sum, args.sums + 2 * (args.first + t));
+}
+
+template <typename T>
+__global__ void MergedLarsMomentumKernel(MergedLarsMomentumArgs<T> args,
+                                         T mu, T lars_coeff,
+                                         T lars_weight_decay) {
+  int64_t begin, end;
+  int t = ChunkOfBlock(args.table, args.numel, &begin, &end);
+  const T* sums = args.sums + 2 * (args.first + t);
+  T local_lr = LarsLocalLearningRate(*args.lr[t], lars_coeff,
+                                     lars_weight_decay, sqrt(sums[0]),
+                                     sqrt(sums[1]));
+  T* param = args.param[t];
+  const T* grad = args.grad[t];
+  T* velocity = args.velocity[t];
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    T p = param[i];
+    T v = velocity[i] * mu + local_lr * (grad[i] + lars_weight_decay * p);
+    velocity[i] = v;
+    param[i] = p - v;
+  }
+}
+
+template <typename T>
+class MergedLarsMomentumOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto velocities = GetInPlaceTensors(ctx, "Velocity", "VelocityOut");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    T lars_coeff = static_cast<T>(ctx.Attr<float>("lars_coeff"));
+    T lars_weight_decay = static_cast<T>(ctx.Attr<float>("lars_weight_decay"));
+    auto& dev_ctx = ctx.cuda_device_context();
+    auto stream = dev_ctx.stream();
+
+    int n = static_cast<int>(params.size());
+    framework::Tensor sums_t =
+        ctx.AllocateTmpTensor<T, platform::CUDADeviceContext>({2 * n},
+                                                              dev_ctx);
+    math::SetConstant<platform::CUDADeviceContext, T>()(dev_ctx, &sums_t, 0);
+    T* sums = sums_t.data<T>();
+
+    std::vector<int64_t> numels(n);
+    for (int i = 0; i < n; ++i) {
+      numels[i] = params[i]->numel();
+    }
+    using Args = MergedLarsMomentumArgs<T>;
+    auto make_args = [&](int first, int num, const ChunkTable& table) {
+      Args args;
+      args.table = table;
+      args.first = first;
+      args.sums = sums;
+      for (int j = 0; j < num; ++j) {
+        int i = first + j;
+        args.numel[j] = numels[i];
+        args.param[j] = params[i]->data<T>();
+        args.grad[j] = grads[i]->data<T>();
+        args.velocity[j] = velocities[i]->data<T>();
+        args.lr[j] = lrs[i]->data<T>();
+      }
+      return args;
+    };
+    // All the norms are reduced before the updates, since the chunks of a
+    // parameter may be in two launches.
+    MultiTensorApply<Args::kMaxTensors>(
+        numels, kMultiTensorApplyChunkSize,
+        [&](int first, int num, const ChunkTable& table, int blocks) {
+          MergedLarsNormKernel<T><<<blocks, kMultiTensorApplyThreads, 0,
+                                    stream>>>(make_args(first, num, table));
+        });
+    MultiTensorApply<Args::kMaxTensors>(
+        numels, kMultiTensorApplyChunkSize,
+        [&](int first, int num, const ChunkTable& table, int blocks) {
+          MergedLarsMomentumKernel<T><<<blocks, kMultiTensorApplyThreads, 0,
+                                        stream>>>(
+              make_args(first, num, table), mu, lars_coeff,
+              lars_weight_decay);
+        });
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(merged_lars_momentum,
+                        ops::MergedLarsMomentumOpCUDAKernel<float>,
+                        ops::MergedLarsMomentumOpCUDAKernel<double>);
@@ -0,0 +1,77 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/operators/optimizers/merged_optimizer_op.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedLarsMomentumOp : public MergedOptimizerOp {
+ public:
+  using MergedOptimizerOp::MergedOptimizerOp;
+
+ protected:
+  std::vector<std::pair<std::string, std::string>> InPlaceStates()
+      const override {
+    return {{"Velocity", "VelocityOut"}};
+  }
+};
+
+// The local learning rate of LARS by the norms of the param and the grad.
+template <typename T>
+inline HOSTDEVICE T LarsLocalLearningRate(T lr, T lars_coeff,
+                                          T lars_weight_decay, T p_norm,
+                                          T g_norm) {
+  if (p_norm > 0 && g_norm > 0) {
+    return lr * lars_coeff * p_norm / (g_norm + lars_weight_decay * p_norm);
+  }
+  return lr;
+}
+
+template <typename DeviceContext, typename T>
+class MergedLarsMomentumOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto velocities = GetInPlaceTensors(ctx, "Velocity", "VelocityOut");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    T lars_coeff = static_cast<T>(ctx.Attr<float>("lars_coeff"));
+    T lars_weight_decay = static_cast<T>(ctx.Attr<float>("lars_weight_decay"));
+    for (size_t i = 0; i < params.size(); ++i) {
+      auto p = framework::EigenVector<T>::Flatten(*params[i]);
+      auto v = framework::EigenVector<T>::Flatten(*velocities[i]);
+      auto g = framework::EigenVector<T>::Flatten(*grads[i]);
+
+      Eigen::Tensor<T, 0, Eigen::RowMajor> p_norm = p.square().sum().sqrt();
+      Eigen::Tensor<T, 0, Eigen::RowMajor> g_norm = g.square().sum().sqrt();
+      T local_lr =
+          LarsLocalLearningRate(lrs[i]->data<T>()[0], lars_coeff,
+                                lars_weight_decay, p_norm(0), g_norm(0));
+      v = v * mu + local_lr * (g + lars_weight_decay * p);
+      p = p - v;
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/merged_momentum_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedMomentumOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(Tensor) Input parameters").AsDuplicable();
+    AddInput("Grad", "(Tensor) Input gradients").AsDuplicable();
+    AddInput("Velocity", "(Tensor) Input velocities").AsDuplicable();
+    AddInput("LearningRate",
+             "(Tensor) Learning rate of all the parameters, or one for each "
+             "of them")
+        .AsDuplicable();
+
+    AddOutput("ParamOut",
+              "(Tensor) Output parameters, which share memory with "
+              "Input(Param)")
+        .AsDuplicable();
+    AddOutput("VelocityOut",
+              "(Tensor) Output velocities, which share memory with "
+              "Input(Velocity)")
+        .AsDuplicable();
+
+    AddAttr<float>("mu", "(float) Momentum coefficient");
+    AddAttr<bool>("use_nesterov",
+                  "(bool, default false) "
+                  "Use Nesterov Momentum")
+        .SetDefault(false);
+
+    AddComment(R"DOC(
+Merged Momentum Optimizer.
+
+Update each of the parameters with dense gradients as the momentum op, whose
+velocities are updated in place. The parameters are not coalesced, and all of
+them are updated by a few kernels on GPU, each of which updates the chunks of
+many parameters by the tables of their pointers and sizes.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(merged_momentum, ops::MergedMomentumOp,
+                             ops::MergedMomentumOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    merged_momentum,
+    ops::MergedMomentumOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::MergedMomentumOpKernel<paddle::platform::CPUDeviceContext, double>);
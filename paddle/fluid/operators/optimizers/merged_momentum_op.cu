@@ -0,0 +1,99 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/merged_momentum_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+struct MergedMomentumArgs {
+  static constexpr int kMaxTensors = 48;
+  ChunkTable table;
+  int64_t numel[kMaxTensors];
+  T* param[kMaxTensors];
+  const T* grad[kMaxTensors];
+  T* velocity[kMaxTensors];
+  const T* lr[kMaxTensors];
+};
+
+template <typename T, bool UseNesterov>
+__global__ void MergedMomentumKernel(MergedMomentumArgs<T> args, T mu) {
+  int64_t begin, end;
+  int t = ChunkOfBlock(args.table, args.numel, &begin, &end);
+  T lr = *args.lr[t];
+  T* param = args.param[t];
+  const T* grad = args.grad[t];
+  T* velocity = args.velocity[t];
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    T g = grad[i];
+    T v = velocity[i] * mu + g;
+    velocity[i] = v;
+    if (UseNesterov) {
+      param[i] -= (g + v * mu) * lr;
+    } else {
+      param[i] -= lr * v;
+    }
+  }
+}
+
+template <typename T>
+class MergedMomentumOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto velocities = GetInPlaceTensors(ctx, "Velocity", "VelocityOut");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+    auto stream = ctx.cuda_device_context().stream();
+
+    std::vector<int64_t> numels(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      numels[i] = params[i]->numel();
+    }
+    using Args = MergedMomentumArgs<T>;
+    MultiTensorApply<Args::kMaxTensors>(
+        numels, kMultiTensorApplyChunkSize,
+        [&](int first, int num, const ChunkTable& table, int blocks) {
+          Args args;
+          args.table = table;
+          for (int j = 0; j < num; ++j) {
+            int i = first + j;
+            args.numel[j] = numels[i];
+            args.param[j] = params[i]->data<T>();
+            args.grad[j] = grads[i]->data<T>();
+            args.velocity[j] = velocities[i]->data<T>();
+            args.lr[j] = lrs[i]->data<T>();
+          }
+          if (use_nesterov) {
+            MergedMomentumKernel<T, true><<<blocks, kMultiTensorApplyThreads,
+                                            0, stream>>>(args, mu);
+          } else {
+            MergedMomentumKernel<T, false><<<blocks, kMultiTensorApplyThreads,
+                                             0, stream>>>(args, mu);
+          }
+        });
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(merged_momentum, ops::MergedMomentumOpCUDAKernel<float>,
+                        ops::MergedMomentumOpCUDAKernel<double>);
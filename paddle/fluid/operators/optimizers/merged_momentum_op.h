@@ -0,0 +1,64 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/operators/optimizers/merged_optimizer_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergedMomentumOp : public MergedOptimizerOp {
+ public:
+  using MergedOptimizerOp::MergedOptimizerOp;
+
+ protected:
+  std::vector<std::pair<std::string, std::string>> InPlaceStates()
+      const override {
+    return {{"Velocity", "VelocityOut"}};
+  }
+};
+
+template <typename DeviceContext, typename T>
+class MergedMomentumOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto params = GetInPlaceTensors(ctx, "Param", "ParamOut");
+    auto velocities = GetInPlaceTensors(ctx, "Velocity", "VelocityOut");
+    auto grads = GetMergedGrads(ctx);
+    auto lrs = GetMergedLearningRates(ctx, params.size());
+
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+    for (size_t i = 0; i < params.size(); ++i) {
+      auto p = framework::EigenVector<T>::Flatten(*params[i]);
+      auto v = framework::EigenVector<T>::Flatten(*velocities[i]);
+      auto g = framework::EigenVector<T>::Flatten(*grads[i]);
+      T lr = lrs[i]->data<T>()[0];
+
+      v = v * mu + g;
+      if (use_nesterov) {
+        p = p - (g + v * mu) * lr;
+      } else {
+        p = p - lr * v;
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,140 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+/*
+ * \brief The base of the merged optimizer ops, which update the lists of
+ * separate parameters by one op instead of one op for each parameter.
+ *
+ * Grad and the states returned by InPlaceStates are one for each Param, and
+ * every state is updated in place. LearningRate is one for all the
+ * parameters or one for each of them.
+ */
+class MergedOptimizerOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    size_t n = ctx->Inputs("Param").size();
+    PADDLE_ENFORCE_GE(n, 1UL, platform::errors::InvalidArgument(
+                                  "Inputs(Param) of %s should not be empty.",
+                                  Type()));
+    PADDLE_ENFORCE_EQ(
+        ctx->Inputs("Grad").size(), n,
+        platform::errors::InvalidArgument(
+            "The number of Inputs(Grad) of %s should be the number of "
+            "Inputs(Param) %d, but got %d.",
+            Type(), n, ctx->Inputs("Grad").size()));
+    size_t lr_num = ctx->Inputs("LearningRate").size();
+    PADDLE_ENFORCE_EQ(
+        lr_num == 1UL || lr_num == n, true,
+        platform::errors::InvalidArgument(
+            "The number of Inputs(LearningRate) of %s should be 1 or the "
+            "number of Inputs(Param) %d, but got %d.",
+            Type(), n, lr_num));
+    for (auto& lr_dims : ctx->GetInputsDim("LearningRate")) {
+      PADDLE_ENFORCE_EQ(framework::product(lr_dims), 1,
+                        platform::errors::InvalidArgument(
+                            "Each Input(LearningRate) of %s should be a "
+                            "scalar, but got dims [%s].",
+                            Type(), lr_dims));
+    }
+
+    auto states = InPlaceStates();
+    states.emplace_back("Param", "ParamOut");
+    for (auto& state : states) {
+      PADDLE_ENFORCE_EQ(
+          ctx->Inputs(state.first).size(), n,
+          platform::errors::InvalidArgument(
+              "The number of Inputs(%s) of %s should be the number of "
+              "Inputs(Param) %d, but got %d.",
+              state.first, Type(), n, ctx->Inputs(state.first).size()));
+      PADDLE_ENFORCE_EQ(
+          ctx->Outputs(state.second).size(), n,
+          platform::errors::InvalidArgument(
+              "The number of Outputs(%s) of %s should be the number of "
+              "Inputs(Param) %d, but got %d.",
+              state.second, Type(), n, ctx->Outputs(state.second).size()));
+      ctx->SetOutputsDim(state.second, ctx->GetInputsDim(state.first));
+    }
+  }
+
+ protected:
+  // The (input, output) names of the states updated in place besides Param.
+  virtual std::vector<std::pair<std::string, std::string>> InPlaceStates()
+      const = 0;
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = OperatorWithKernel::IndicateVarDataType(ctx, "Param");
+    return framework::OpKernelType(data_type, ctx.GetPlace());
+  }
+};
+
+// Get the tensors of Outputs(out), each of which should be the same variable
+// as the one of Inputs(in), since the merged optimizer ops update in place.
+inline std::vector<framework::LoDTensor*> GetInPlaceTensors(
+    const framework::ExecutionContext& ctx, const std::string& in,
+    const std::string& out) {
+  auto ins = ctx.MultiInput<framework::LoDTensor>(in);
+  auto outs = ctx.MultiOutput<framework::LoDTensor>(out);
+  PADDLE_ENFORCE_EQ(ins.size(), outs.size(),
+                    platform::errors::InvalidArgument(
+                        "The number of Outputs(%s) of %s should be the number "
+                        "of Inputs(%s) %d, but got %d.",
+                        out, ctx.Type(), in, ins.size(), outs.size()));
+  for (size_t i = 0; i < ins.size(); ++i) {
+    PADDLE_ENFORCE_EQ(
+        ins[i] == outs[i], true,
+        platform::errors::InvalidArgument(
+            "The %d-th Output(%s) of %s should be the same variable as "
+            "Input(%s), since it is updated in place.",
+            i, out, ctx.Type(), in));
+  }
+  return outs;
+}
+
+// Get the dense gradients of the parameters.
+inline std::vector<const framework::LoDTensor*> GetMergedGrads(
+    const framework::ExecutionContext& ctx) {
+  for (auto* var : ctx.MultiInputVar("Grad")) {
+    PADDLE_ENFORCE_EQ(
+        var->IsType<framework::LoDTensor>(), true,
+        platform::errors::InvalidArgument(
+            "The Inputs(Grad) of %s should be LoDTensor, but got %s.",
+            ctx.Type(), framework::ToTypeName(var->Type())));
+  }
+  return ctx.MultiInput<framework::LoDTensor>("Grad");
+}
+
+// Get the learning rate of each of the n parameters.
+inline std::vector<const framework::LoDTensor*> GetMergedLearningRates(
+    const framework::ExecutionContext& ctx, size_t n) {
+  auto lrs = ctx.MultiInput<framework::LoDTensor>("LearningRate");
+  if (lrs.size() == 1 && n > 1) {
+    lrs.resize(n, lrs[0]);
+  }
+  return lrs;
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,118 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "cub/cub.cuh"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+constexpr int kMultiTensorApplyThreads = 512;
+constexpr int kMultiTensorApplyMaxBlocks = 320;
+constexpr int64_t kMultiTensorApplyChunkSize = 64 * 1024;
+
+/*
+ * \brief The chunks of the tensors processed by one launch of a kernel
+ * applied to the lists of tensors, which is passed to the kernel by value in
+ * its arguments with the pointers of the tensors.
+ *
+ * The block b processes the elements of the block_to_chunk[b]-th chunk of the
+ * block_to_tensor[b]-th tensor of the launch, so that the tensors of any
+ * sizes are processed by one launch.
+ */
+struct ChunkTable {
+  int64_t chunk_size;
+  unsigned char block_to_tensor[kMultiTensorApplyMaxBlocks];
+  int block_to_chunk[kMultiTensorApplyMaxBlocks];
+};
+
+/*
+ * \brief Split the tensors of numels into the chunks of at most chunk_size
+ * elements, and call launch(first, num, table, blocks) for each group of the
+ * chunks, which launches a kernel of blocks blocks for the tensors
+ * [first, first + num).
+ *
+ * A group has at most kMaxTensors tensors, which is limited by the size of
+ * the kernel arguments, and at most kMultiTensorApplyMaxBlocks chunks. The
+ * chunks of a tensor may be in two groups, whose kernels should not depend on
+ * each other.
+ */
+template <int kMaxTensors, typename Launch>
+void MultiTensorApply(const std::vector<int64_t>& numels, int64_t chunk_size,
+                      Launch launch) {
+  static_assert(kMaxTensors <= 256,
+                "The tensors of a launch are indexed by unsigned char.");
+  ChunkTable table;
+  table.chunk_size = chunk_size;
+  int n = static_cast<int>(numels.size());
+  int first = 0;
+  int last = 0;
+  int blocks = 0;
+  for (int i = 0; i < n; ++i) {
+    if (numels[i] == 0) continue;
+    if (i - first >= kMaxTensors) {
+      if (blocks > 0) {
+        launch(first, last - first + 1, table, blocks);
+        blocks = 0;
+      }
+      first = i;
+    }
+    int64_t chunks = (numels[i] + chunk_size - 1) / chunk_size;
+    for (int64_t c = 0; c < chunks; ++c) {
+      table.block_to_tensor[blocks] = static_cast<unsigned char>(i - first);
+      table.block_to_chunk[blocks] = static_cast<int>(c);
+      last = i;
+      if (++blocks == kMultiTensorApplyMaxBlocks) {
+        launch(first, last - first + 1, table, blocks);
+        blocks = 0;
+        first = c + 1 == chunks ? i + 1 : i;
+      }
+    }
+  }
+  if (blocks > 0) {
+    launch(first, last - first + 1, table, blocks);
+  }
+}
+
+// Get the tensor and the element range [begin, end) of the chunk of this
+// block.
+__device__ __forceinline__ int ChunkOfBlock(const ChunkTable& table,
+                                            const int64_t* numels,
+                                            int64_t* begin, int64_t* end) {
+  int t = table.block_to_tensor[blockIdx.x];
+  *begin = table.block_to_chunk[blockIdx.x] * table.chunk_size;
+  *end = min(numels[t], *begin + table.chunk_size);
+  return t;
+}
+
+// Add the sums of x and y of all the threads of this block to out[0] and
+// out[1], which are the square sums of the chunks of a tensor.
+template <typename T>
+__device__ __forceinline__ void BlockAtomicAddSums(T x, T y, T* out) {
+  typedef cub::BlockReduce<T, kMultiTensorApplyThreads> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage x_storage;
+  __shared__ typename BlockReduce::TempStorage y_storage;
+  x = BlockReduce(x_storage).Reduce(x, cub::Sum());
+  y = BlockReduce(y_storage).Reduce(y, cub::Sum());
+  if (threadIdx.x == 0) {
+    platform::CudaAtomicAdd(out, x);
+    platform::CudaAtomicAdd(out + 1, y);
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
 
 namespace paddle {
 namespace operators {
@@ -89,6 +90,21 @@ class SGDOpKernel<platform::CPUDeviceContext, T>
         attr.selected_rows_size = grad_rows.size();
         PADDLE_ENFORCE_EQ(attr.grad_width, attr.param_width);
 
+#ifdef PADDLE_WITH_MKLML
+        // The rows of the large grads are updated by the shards in parallel.
+        if (grad_rows.size() >= math::scatter::kMergeUpdateParallelRows) {
+          int64_t width = attr.param_width;
+          T lr_value = lr[0];
+          math::scatter::MergeAndUpdate<T>(
+              *grad, out_dims[0], [&](int64_t row, const T *g) {
+                T *out = out_data + row * width;
+                for (int64_t j = 0; j < width; ++j) {
+                  out[j] -= lr_value * g[j];
+                }
+              });
+          return;
+        }
+#endif
         auto sgd =
             jit::KernelFuncs<jit::SgdTuple<T>, platform::CPUPlace>::Cache().At(
                 attr);
@@ -297,38 +297,57 @@ class CPUPyramidHashOPKernel : public framework::OpKernel<T> {
 
     drop_pos->Resize(framework::make_ddim(
         {bottom->dims()[0] * bottom->dims()[1] * _pyramid_layer, 1}));
-    std::vector<size_t> drop_pos_offset;
-    drop_pos_offset.resize(offset.size());
-    drop_pos_offset[0] = 0;
     int* iter = drop_pos->mutable_data<int>(ctx.GetPlace());
-    int* iter_end = iter;
 
-    for (size_t i = 0; i < top_offset.size() - 1; ++i) {
+    // the n-gram windows of the sentences are laid out one after another in
+    // DropPos, window_offset is the start of the windows of each sentence
+    int num_sentences = static_cast<int>(offset.size()) - 1;
+    std::vector<size_t> window_offset(offset.size());
+    window_offset[0] = 0;
+    for (int i = 0; i < num_sentences; ++i) {
       int w = offset[i + 1] - offset[i];
-      int nsentense_with_pyramid = 0;
-      if (w < 2) {
-        nsentense_with_pyramid = 0;
-      } else {
-        for (int ilayer = 1; ilayer < _pyramid_layer && ilayer < w; ++ilayer) {
-          for (int l = 0; l < w - ilayer; ++l) {
-            if (should_use_term(_filter, _black_filter,
-                                (const float*)(bottom_data + offset[i] + l),
-                                ilayer + 1)) {
-              if (_is_training != 0) {
-                unsigned int rand_val = rand_r(&_seed);
-                float rate = static_cast<float>(rand_val) / (RAND_MAX);
-                *(iter_end++) = (rate < _drop_out_percent ? 0 : 1);
-              } else {
-                *(iter_end++) = 1;
-              }
-            } else {
-              *(iter_end++) = 0;
-            }
-          }
+      size_t num_windows = 0;
+      for (int ilayer = 1; ilayer < _pyramid_layer && ilayer < w; ++ilayer) {
+        num_windows += w - ilayer;
+      }
+      window_offset[i + 1] = window_offset[i] + num_windows;
+    }
+
+    // check the windows by the bloom filters in parallel
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < num_sentences; ++i) {
+      int w = offset[i + 1] - offset[i];
+      int* pos = iter + window_offset[i];
+      for (int ilayer = 1; ilayer < _pyramid_layer && ilayer < w; ++ilayer) {
+        for (int l = 0; l < w - ilayer; ++l) {
+          bool use_term = should_use_term(
+              _filter, _black_filter,
+              (const float*)(bottom_data + offset[i] + l), ilayer + 1);
+          *(pos++) = use_term ? 1 : 0;
+        }
+      }
+    }
+
+    // the dropout draws the random numbers in the order of the windows, so
+    // that the results are the same as drawing them one by one
+    if (_is_training != 0) {
+      for (size_t k = 0; k < window_offset[num_sentences]; ++k) {
+        if (iter[k] == 1) {
+          unsigned int rand_val = rand_r(&_seed);
+          float rate = static_cast<float>(rand_val) / (RAND_MAX);
+          iter[k] = (rate < _drop_out_percent ? 0 : 1);
         }
-        nsentense_with_pyramid = std::count(iter, iter_end, 1);
-        iter = iter_end;
       }
+    }
+
+    std::vector<size_t> drop_pos_offset;
+    drop_pos_offset.resize(offset.size());
+    drop_pos_offset[0] = 0;
+    for (int i = 0; i < num_sentences; ++i) {
+      int nsentense_with_pyramid = std::count(
+          iter + window_offset[i], iter + window_offset[i + 1], 1);
       drop_pos_offset[i + 1] = drop_pos_offset[i] + nsentense_with_pyramid;
       top_offset[i + 1] =
           top_offset[i] +
@@ -347,42 +366,30 @@ class CPUPyramidHashOPKernel : public framework::OpKernel<T> {
     drop_pos_lod.push_back(drop_pos_offset);
     drop_pos->set_lod(drop_pos_lod);
 
-    iter = drop_pos->mutable_data<int>(ctx.GetPlace());
-    int top_counter = 0;
-    for (size_t i = 0; i < offset.size() - 1; ++i) {
-      int w_drop = drop_pos_offset[i + 1] - drop_pos_offset[i];
-      int w = offset[i + 1] - offset[i];
-      if (w_drop == 0) {
-        if (w >= 2) {
-          for (int ilayer = 1; ilayer < _pyramid_layer && ilayer < w;
-               ++ilayer) {
-            for (int l = 0; l < w - ilayer; ++l) {
-              iter++;
-            }
-          }
-        }
-        auto* top_pos = top_data + top_counter++ * _num_emb;
+    // the rows of the sentences start at top_offset, so that the sentences
+    // are hashed in parallel
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < num_sentences; ++i) {
+      auto* top_pos = top_data + top_offset[i] * _num_emb;
+      if (drop_pos_offset[i + 1] == drop_pos_offset[i]) {
         memset(top_pos, 0, _num_emb * sizeof(T));
         continue;
       }
-      if (w >= 2) {
-        for (int ilayer = 1; ilayer < _pyramid_layer && ilayer < w; ++ilayer) {
-          for (int l = 0; l < w - ilayer; ++l) {
-            if (*(iter++) == 0) {
-              // do nothing
-            } else {
-              auto* top_pos = top_data + top_counter++ * _num_emb;
-              hash_embedding_ff((const float*)(bottom_data + offset[i] + l),
-                                ilayer + 1, top_pos, weights, _num_emb,
-                                _rand_len, _space_len);
-            }
+      int w = offset[i + 1] - offset[i];
+      const int* pos = iter + window_offset[i];
+      for (int ilayer = 1; ilayer < _pyramid_layer && ilayer < w; ++ilayer) {
+        for (int l = 0; l < w - ilayer; ++l) {
+          if (*(pos++) != 0) {
+            hash_embedding_ff((const float*)(bottom_data + offset[i] + l),
+                              ilayer + 1, top_pos, weights, _num_emb,
+                              _rand_len, _space_len);
+            top_pos += _num_emb;
           }
         }
       }
     }
-    if (iter != iter_end) {
-      exit(1);
-    }
     auto weight_type = _blobs_0->type();
     if (_is_training == 0 && weight_type != framework::proto::VarType::INT8) {
       avx_axpy_noadd(top_data, top_data, top->dims()[0] * top->dims()[1],
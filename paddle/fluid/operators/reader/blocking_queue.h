@@ -91,6 +91,22 @@ class BlockingQueue {
     }
   }
 
+  // Receive an element only if the queue is not empty, without waiting.
+  bool TryReceive(T* elem) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EnforceNotKilled();
+    if (queue_.empty()) {
+      return false;
+    }
+    PADDLE_ENFORCE_NOT_NULL(elem);
+    *elem = queue_.front();
+    if (LIKELY(!speed_test_mode_)) {
+      queue_.pop_front();
+    }
+    send_cv_.notify_one();
+    return true;
+  }
+
   void ReOpen() {
     std::lock_guard<std::mutex> lock(mutex_);
     EnforceNotKilled();
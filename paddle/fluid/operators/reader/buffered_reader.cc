@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/reader/buffered_reader.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <memory>
 #include <utility>
 #include <vector>
@@ -36,28 +38,42 @@ BufferedReader::~BufferedReader() {
 
 BufferedReader::BufferedReader(
     const std::shared_ptr<framework::ReaderBase> &reader,
-    const platform::Place &place, size_t buffer_size)
+    const platform::Place &place, size_t buffer_size, size_t max_buffer_size)
     : framework::DecoratedReader(reader),
       thread_pool_(1),
       place_(place),
-      buffer_size_(buffer_size) {
+      buffer_size_(buffer_size),
+      max_buffer_size_(std::max(buffer_size, max_buffer_size)) {
   VLOG(1) << "BufferedReader";
+  PADDLE_ENFORCE_GT(buffer_size, 0UL,
+                    platform::errors::InvalidArgument(
+                        "The buffer size of BufferedReader should be larger "
+                        "than 0, but received %d.",
+                        buffer_size));
 #ifdef PADDLE_WITH_CUDA
   if (platform::is_gpu_place(place_)) {
     int dev_idx = boost::get<platform::CUDAPlace>(place_).device;
-    compute_stream_ =
-        ((platform::CUDADeviceContext *)(platform::DeviceContextPool::Instance()
-                                             .Get(place_)))
-            ->stream();
-    events_.resize(buffer_size);
+    auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+        platform::DeviceContextPool::Instance().Get(place_));
+    compute_stream_ = dev_ctx->stream();
+    events_.resize(max_buffer_size_);
     for (auto &event : events_) {
       event = platform::CudaEventResourcePool::Instance().New(dev_idx);
     }
+    copy_events_.resize(max_buffer_size_);
+    for (auto &event : copy_events_) {
+      event = platform::CudaEventResourcePool::Instance().New(dev_idx);
+    }
     stream_ = platform::CudaStreamResourcePool::Instance().New(dev_idx);
   }
 #endif
-  cpu_buffer_.resize(buffer_size);
-  gpu_buffer_.resize(buffer_size);
+  // The buffers allocate their tensors at the first read, so the buffers
+  // beyond the current depth cost nothing until the depth grows.
+  cpu_buffer_.resize(max_buffer_size_);
+  gpu_buffer_.resize(max_buffer_size_);
+#ifdef PADDLE_WITH_CUDA
+  cuda_pinned_buffer_.resize(max_buffer_size_);
+#endif
   ReadTillBufferFullAsync();
 }
 
@@ -71,6 +87,15 @@ void BufferedReader::ReadTillBufferFullAsync() {
 void BufferedReader::ReadAsync(size_t i) {
   position_.emplace(thread_pool_.enqueue([this, i]() -> size_t {
     TensorVec &cpu = cpu_buffer_[i];
+#ifdef PADDLE_WITH_CUDA
+    if (platform::is_gpu_place(place_)) {
+      // The last copies from the buffers are usually done long before.
+      PADDLE_ENFORCE_CUDA_SUCCESS(
+          cudaEventSynchronize(copy_events_[i].get()),
+          platform::errors::Fatal(
+              "cudaEventSynchronize raises unexpected exception"));
+    }
+#endif
     reader_->ReadNext(&cpu);
 
     if (cpu.empty()) {
@@ -84,8 +109,10 @@ void BufferedReader::ReadAsync(size_t i) {
     // commands from different streams cannot run concurrently.
     if (platform::is_gpu_place(place_)) {
       TensorVec &gpu = gpu_buffer_[i];
+      TensorVec &cuda_pinned = cuda_pinned_buffer_[i];
       if (gpu.empty()) {
         gpu.resize(cpu.size());
+        cuda_pinned.resize(cpu.size());
       } else {
         PADDLE_ENFORCE_EQ(gpu.size(), cpu.size(),
                           "Input tensor number not matched");
@@ -128,8 +155,11 @@ void BufferedReader::ReadAsync(size_t i) {
                        boost::get<platform::CUDAPlace>(cpu_place), cpu_ptr,
                        size, stream_.get());
         } else {
+          // The pinned tensor is kept in cuda_pinned_buffer_ until the
+          // copy event of the buffer is synchronized, so the next tensor is
+          // staged while this one is copied.
           platform::CUDAPinnedPlace cuda_pinned_place;
-          framework::LoDTensor cuda_pinned_tensor;
+          auto &cuda_pinned_tensor = cuda_pinned[i];
           cuda_pinned_tensor.Resize(cpu[i].dims());
           auto cuda_pinned_ptr =
               cuda_pinned_tensor.mutable_data(cuda_pinned_place, cpu[i].type());
@@ -137,18 +167,17 @@ void BufferedReader::ReadAsync(size_t i) {
                        boost::get<platform::CPUPlace>(cpu_place), cpu_ptr,
                        size);
           memory::Copy(boost::get<platform::CUDAPlace>(place_), gpu_ptr,
-                       cuda_pinned_place, cuda_pinned_ptr, size, stream_.get());
-          PADDLE_ENFORCE_CUDA_SUCCESS(
-              cudaStreamSynchronize(stream_.get()),
-              platform::errors::Fatal(
-                  "cudaStreamSynchronize raises unexpected exception"));
+                       cuda_pinned_place, cuda_pinned_ptr, size,
+                       stream_.get());
         }
         gpu[i].set_lod(cpu[i].lod());
       }
+      // The compute stream waits for the copies instead of this thread, so
+      // the next batch is read while they run.
       PADDLE_ENFORCE_CUDA_SUCCESS(
-          cudaStreamSynchronize(stream_.get()),
+          cudaEventRecord(copy_events_[i].get(), stream_.get()),
           platform::errors::Fatal(
-              "cudaStreamSynchronize raises unexpected exception"));
+              "cudaEventRecord raises unexpected exception"));
     }
 #endif
     return i;
@@ -174,7 +203,12 @@ void BufferedReader::ReadNextImpl(std::vector<framework::LoDTensor> *out) {
     out->clear();
     return;
   }
-  size_t i = position_.front().get();
+  auto &front = position_.front();
+  // The consumer waits for the batch, i.e., the reader falls behind, so one
+  // more buffer is prefetched from now on, to absorb the jitter of reading.
+  bool waited = front.wait_for(std::chrono::seconds(0)) !=
+                std::future_status::ready;
+  size_t i = front.get();
   position_.pop();
 
   if (i == -1UL) {
@@ -182,8 +216,21 @@ void BufferedReader::ReadNextImpl(std::vector<framework::LoDTensor> *out) {
     return;
   }
 
+  if (waited && buffer_size_ < max_buffer_size_) {
+    VLOG(2) << "BufferedReader grows the buffer size to " << buffer_size_ + 1;
+    ReadAsync(buffer_size_++);
+  }
+
   *out = std::move(platform::is_gpu_place(place_) ? gpu_buffer_[i]
                                                   : cpu_buffer_[i]);
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place_)) {
+    PADDLE_ENFORCE_CUDA_SUCCESS(
+        cudaStreamWaitEvent(compute_stream_, copy_events_[i].get(), 0),
+        platform::errors::Fatal(
+            "cudaStreamWaitEvent raises unexpected exception"));
+  }
+#endif
 
   // Do not push current position into ReadAsync. Push the previous position
   // Since all computation in fluid are async, change the data of
@@ -34,8 +34,12 @@ class BufferedReader : public framework::DecoratedReader {
   using VecFuture = std::future<TensorVec>;
 
  public:
+  // buffer_size is the initial prefetch depth. If max_buffer_size is larger,
+  // the depth grows by one buffer every time the consumer has to wait for a
+  // batch, until it reaches max_buffer_size.
   BufferedReader(const std::shared_ptr<framework::ReaderBase>& reader,
-                 const platform::Place& place, size_t buffer_size);
+                 const platform::Place& place, size_t buffer_size,
+                 size_t max_buffer_size = 0);
 
   ~BufferedReader() override;
 
@@ -52,7 +56,10 @@ class BufferedReader : public framework::DecoratedReader {
  private:
   ThreadPool thread_pool_;
   platform::Place place_;
-  const size_t buffer_size_;
+  // the number of buffers being prefetched, which is at most
+  // max_buffer_size_
+  size_t buffer_size_;
+  const size_t max_buffer_size_;
 
   std::queue<std::future<size_t>> position_;
 
@@ -65,9 +72,18 @@ class BufferedReader : public framework::DecoratedReader {
   std::vector<TensorVec> gpu_buffer_;
   size_t prev_pos_{-1UL};
 #ifdef PADDLE_WITH_CUDA
+  // The pinned buffers staging the pageable CPU tensors copied to GPU, so
+  // that all the copies of a batch are async.
+  std::vector<TensorVec> cuda_pinned_buffer_;
   cudaStream_t compute_stream_;
+  // The H2D stream owned by this reader, so that the copies of the readers
+  // of different devices, or of the same device, do not serialize.
   std::shared_ptr<platform::CudaStreamObject> stream_;
   std::vector<std::shared_ptr<platform::CudaEventObject>> events_;
+  // recorded on stream_ after the copies of each buffer, which the compute
+  // stream waits for before the buffer is read, and the reader thread
+  // before the buffer is written again
+  std::vector<std::shared_ptr<platform::CudaEventObject>> copy_events_;
 #endif
 };
 
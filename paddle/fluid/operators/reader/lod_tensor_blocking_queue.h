@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <chrono>  // NOLINT
 #include <memory>
 #include <utility>
 #include <vector>
@@ -21,60 +22,136 @@
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/operators/reader/ring_blocking_queue.h"
+#include "paddle/fluid/platform/metrics.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
 namespace operators {
 namespace reader {
 
+// If use_ring_queue is true, the batches are sent through a RingBlockingQueue
+// instead of the mutex guarded BlockingQueue, which suits a fast reader
+// thread sending many small batches.
 class LoDTensorBlockingQueue {
  public:
-  explicit LoDTensorBlockingQueue(size_t capacity, bool speed_test_mode = false)
-      : queue_(capacity, speed_test_mode) {}
+  explicit LoDTensorBlockingQueue(size_t capacity, bool speed_test_mode = false,
+                                  bool use_ring_queue = false) {
+    if (use_ring_queue) {
+      ring_queue_.reset(new RingQueue(capacity, speed_test_mode));
+    } else {
+      queue_.reset(new Queue(capacity, speed_test_mode));
+    }
+  }
 
   ~LoDTensorBlockingQueue() { VLOG(10) << "Destruct LoDTensorBlockingQueue"; }
 
   bool Push(const std::vector<framework::LoDTensor>& lod_tensor_vec) {
-    return queue_.Send(lod_tensor_vec);
+    GetMetrics().pushes->Add();
+    return ring_queue_ ? ring_queue_->Send(lod_tensor_vec)
+                       : queue_->Send(lod_tensor_vec);
   }
 
   bool Push(std::vector<framework::LoDTensor>&& lod_tensor_vec) {
-    return queue_.Send(std::move(lod_tensor_vec));
+    GetMetrics().pushes->Add();
+    return ring_queue_ ? ring_queue_->Send(std::move(lod_tensor_vec))
+                       : queue_->Send(std::move(lod_tensor_vec));
   }
 
   std::vector<framework::LoDTensor> Pop(bool* ok = nullptr) {
+    auto& metrics = GetMetrics();
+    auto start = std::chrono::steady_clock::now();
     std::vector<framework::LoDTensor> lod_tensor_vec;
-    bool success = queue_.Receive(&lod_tensor_vec);
+    bool success = ring_queue_ ? ring_queue_->Receive(&lod_tensor_vec)
+                               : queue_->Receive(&lod_tensor_vec);
+    metrics.pop_wait->Record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+    metrics.pops->Add();
     if (ok != nullptr) *ok = success;
     return lod_tensor_vec;
   }
 
-  inline size_t Cap() const { return queue_.Cap(); }
+  inline size_t Cap() const {
+    return ring_queue_ ? ring_queue_->Cap() : queue_->Cap();
+  }
 
-  inline size_t Size() const { return queue_.Size(); }
+  inline size_t Size() const {
+    return ring_queue_ ? ring_queue_->Size() : queue_->Size();
+  }
 
-  inline void ReOpen() { queue_.ReOpen(); }
+  inline void ReOpen() {
+    if (ring_queue_) {
+      ring_queue_->ReOpen();
+    } else {
+      queue_->ReOpen();
+    }
+  }
 
   inline void Close() {
     VLOG(1) << "LoDTensorBlockingQueue close";
-    queue_.Close();
+    if (ring_queue_) {
+      ring_queue_->Close();
+    } else {
+      queue_->Close();
+    }
   }
 
-  inline bool IsClosed() const { return queue_.IsClosed(); }
+  inline bool IsClosed() const {
+    return ring_queue_ ? ring_queue_->IsClosed() : queue_->IsClosed();
+  }
 
-  inline void Kill() { queue_.Kill(); }
+  inline void Kill() {
+    if (ring_queue_) {
+      ring_queue_->Kill();
+    } else {
+      queue_->Kill();
+    }
+  }
 
   inline bool WaitForInited(size_t) { return true; }
 
  private:
-  BlockingQueue<std::vector<framework::LoDTensor>> queue_;
+  // The metrics shared by all the queues, got once since the queues are on
+  // the hot path of the readers.
+  struct Metrics {
+    platform::MetricCounter* pushes;
+    platform::MetricCounter* pops;
+    platform::LatencyHistogram* pop_wait;
+  };
+
+  static Metrics& GetMetrics() {
+    static Metrics metrics = [] {
+      auto& registry = platform::MetricsRegistry::Instance();
+      return Metrics{
+          registry.Counter("paddle_reader_queue_pushes_total",
+                           "The batches pushed into the reader queues."),
+          registry.Counter("paddle_reader_queue_pops_total",
+                           "The batches popped from the reader queues."),
+          registry.Histogram("paddle_reader_queue_pop_wait_ns",
+                             "The nanoseconds waiting for the batches in "
+                             "the reader queues.")};
+    }();
+    return metrics;
+  }
+
+  using Queue = BlockingQueue<std::vector<framework::LoDTensor>>;
+  using RingQueue = RingBlockingQueue<std::vector<framework::LoDTensor>>;
+
+  // only one of them is created
+  std::unique_ptr<Queue> queue_;
+  std::unique_ptr<RingQueue> ring_queue_;
 };
 
 class OrderedMultiDeviceLoDTensorBlockingQueue {
  public:
   OrderedMultiDeviceLoDTensorBlockingQueue(size_t capacity,
-                                           bool speed_test_mode = false)
-      : capacity_(capacity), speed_test_mode_(speed_test_mode) {}
+                                           bool speed_test_mode = false,
+                                           bool use_ring_queue = false)
+      : capacity_(capacity),
+        speed_test_mode_(speed_test_mode),
+        use_ring_queue_(use_ring_queue) {}
 
   ~OrderedMultiDeviceLoDTensorBlockingQueue() {
     VLOG(10) << "Destruct OrderedMultiDeviceLoDTensorBlockingQueue";
@@ -105,7 +182,8 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
       queues_.resize(dev_cnt);
       for (auto& item : queues_) {
         auto cap = (capacity_ + dev_cnt - 1) / dev_cnt;
-        item.reset(new LoDTensorBlockingQueue(cap, speed_test_mode_));
+        item.reset(
+            new LoDTensorBlockingQueue(cap, speed_test_mode_, use_ring_queue_));
       }
     }
     cv_.notify_all();
@@ -154,7 +232,8 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
     auto dev_cnt = queues_.size();
     for (auto& item : queues_) {
       auto cap = (capacity_ + dev_cnt - 1) / dev_cnt;
-      item.reset(new LoDTensorBlockingQueue(cap, speed_test_mode_));
+      item.reset(
+          new LoDTensorBlockingQueue(cap, speed_test_mode_, use_ring_queue_));
     }
     data_index_ = 0;
   }
@@ -189,6 +268,7 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
   size_t dev_cnt_{0};
   const size_t capacity_;
   const bool speed_test_mode_;
+  const bool use_ring_queue_;
   bool is_closed_{false};
 
   std::vector<std::function<void()>> reset_methods_;
@@ -200,11 +280,13 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
 
 class LoDTensorBlockingQueueHolder {
  public:
-  void InitOnce(size_t capacity, bool speed_test_mode = false) {
+  void InitOnce(size_t capacity, bool speed_test_mode = false,
+                bool use_ring_queue = false) {
     PADDLE_ENFORCE(
         queue_ == nullptr,
         "LoDTensorBlockingQueueHolder::InitOnce() can only be called once");
-    queue_.reset(new LoDTensorBlockingQueue(capacity, speed_test_mode));
+    queue_.reset(
+        new LoDTensorBlockingQueue(capacity, speed_test_mode, use_ring_queue));
   }
 
   inline const std::shared_ptr<LoDTensorBlockingQueue>& GetQueue() const {
@@ -217,13 +299,14 @@ class LoDTensorBlockingQueueHolder {
 
 class OrderedMultiDeviceLoDTensorBlockingQueueHolder {
  public:
-  void InitOnce(size_t capacity, bool speed_test_mode = false) {
+  void InitOnce(size_t capacity, bool speed_test_mode = false,
+                bool use_ring_queue = false) {
     PADDLE_ENFORCE_EQ(queue_, nullptr,
                       platform::errors::AlreadyExists(
                           "OrderedMultiDeviceLoDTensorBlockingQueueHolder::"
                           "InitOnce() can only be called once"));
-    queue_.reset(new OrderedMultiDeviceLoDTensorBlockingQueue(capacity,
-                                                              speed_test_mode));
+    queue_.reset(new OrderedMultiDeviceLoDTensorBlockingQueue(
+        capacity, speed_test_mode, use_ring_queue));
   }
 
   inline const std::shared_ptr<OrderedMultiDeviceLoDTensorBlockingQueue>&
@@ -0,0 +1,270 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+/*
+ * A bounded multi-producer multi-consumer queue on a ring buffer, which has
+ * the same semantics of Send, Receive, Close, ReOpen and Kill as
+ * BlockingQueue. The elements are sent and received without any lock, by
+ * the sequence numbers of the cells of the ring (see "Bounded MPMC queue" of
+ * Dmitry Vyukov). A sender waiting for a free cell, or a receiver waiting for
+ * an element, spins a few rounds at first, and then parks on a condition
+ * variable, which is notified only if there are parked threads, so that
+ * no lock is taken when the queue is neither full nor empty.
+ */
+template <typename T>
+class RingBlockingQueue {
+ public:
+  explicit RingBlockingQueue(size_t capacity, bool speed_test_mode = false)
+      : capacity_(capacity), speed_test_mode_(speed_test_mode) {
+    PADDLE_ENFORCE_GT(capacity_, static_cast<size_t>(0),
+                      platform::errors::InvalidArgument(
+                          "The capacity of a reader::RingBlockingQueue must be "
+                          "greater than 0."));
+    cells_.reset(new Cell[capacity_]);
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool Send(const T& elem) {
+    T copy(elem);
+    return Send(std::move(copy));
+  }
+
+  bool Send(T&& elem) {
+    for (size_t round = 0;; ++round) {
+      EnforceNotKilled();
+      if (closed_.load()) {
+        VLOG(5) << "WARNING: Sending an element to a closed "
+                   "reader::RingBlockingQueue.";
+        return false;
+      }
+      if (TryPush(&elem)) {
+        Notify(&receive_waiters_, &receive_cv_);
+        return true;
+      }
+      if (round < kSpinRounds) {
+        std::this_thread::yield();
+      } else {
+        Park(&send_waiters_, &send_cv_,
+             [this] { return SizeRelaxed() < capacity_; });
+      }
+    }
+  }
+
+  bool Receive(T* elem) {
+    PADDLE_ENFORCE_NOT_NULL(elem);
+    for (size_t round = 0;; ++round) {
+      EnforceNotKilled();
+      if (TryPop(elem)) {
+        Notify(&send_waiters_, &send_cv_);
+        return true;
+      }
+      // An element being sent is received even if the queue is closed.
+      if (closed_.load() && SizeRelaxed() == 0) {
+        VLOG(3) << "queue is closed! return nothing.";
+        return false;
+      }
+      if (round < kSpinRounds) {
+        std::this_thread::yield();
+      } else {
+        Park(&receive_waiters_, &receive_cv_,
+             [this] { return SizeRelaxed() > 0; });
+      }
+    }
+  }
+
+  // Receive an element only if the queue is not empty, without waiting.
+  bool TryReceive(T* elem) {
+    EnforceNotKilled();
+    PADDLE_ENFORCE_NOT_NULL(elem);
+    if (!TryPop(elem)) {
+      return false;
+    }
+    Notify(&send_waiters_, &send_cv_);
+    return true;
+  }
+
+  // Like BlockingQueue::ReOpen, it should not be called while the elements
+  // are sent or received.
+  void ReOpen() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EnforceNotKilled();
+    VLOG(1) << "reopen queue";
+    closed_.store(false);
+    T elem;
+    while (TryPop(&elem)) {
+    }
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    VLOG(1) << "close queue";
+    closed_.store(true);
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+  bool IsClosed() const { return closed_.load(); }
+
+  size_t Cap() const { return capacity_; }
+
+  size_t Size() const { return SizeRelaxed(); }
+
+  void Kill() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    VLOG(1) << "kill queue";
+    closed_.store(true);
+    killed_.store(true);
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  // Most of the waits are shorter than a few scheduling rounds when the
+  // queue is busy, which are not worth parking for.
+  static constexpr size_t kSpinRounds = 64;
+
+  bool TryPush(T* elem) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[pos % capacity_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1)) {
+          cell.data = std::move(*elem);
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // the cell is not received yet, i.e., the queue is full
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool TryPop(T* elem) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[pos % capacity_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+      if (diff == 0) {
+        if (UNLIKELY(speed_test_mode_)) {
+          // The element is kept in the queue, and since no element is ever
+          // received, the cell is not overwritten.
+          *elem = cell.data;
+          return true;
+        }
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1)) {
+          *elem = std::move(cell.data);
+          cell.seq.store(pos + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // the cell is not sent yet, i.e., the queue is empty
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t SizeRelaxed() const {
+    size_t dequeue_pos = dequeue_pos_.load();
+    size_t enqueue_pos = enqueue_pos_.load();
+    size_t size = enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    return size < capacity_ ? size : capacity_;
+  }
+
+  // The waiters are counted before the condition is checked under the lock,
+  // and the notifier checks the count after the cell is updated, so either
+  // the waiter sees the update, or the notifier sees the waiter.
+  template <typename Pred>
+  void Park(std::atomic<size_t>* waiters, std::condition_variable* cv,
+            Pred pred) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters->fetch_add(1);
+    cv->wait(lock, [&] { return pred() || closed_.load() || killed_.load(); });
+    waiters->fetch_sub(1);
+  }
+
+  void Notify(std::atomic<size_t>* waiters, std::condition_variable* cv) {
+    if (waiters->load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cv->notify_one();
+    }
+  }
+
+  inline void EnforceNotKilled() {
+    PADDLE_ENFORCE_NE(
+        killed_.load(), true,
+        platform::errors::Fatal("Blocking queue is killed because the data "
+                                "reader raises an exception"));
+  }
+
+ private:
+  const size_t capacity_;
+  const bool speed_test_mode_;
+  std::unique_ptr<Cell[]> cells_;
+
+  // The positions are padded to their own cache lines, since they are
+  // written by the senders and the receivers respectively.
+  char pad0_[64];
+  std::atomic<size_t> enqueue_pos_{0};
+  char pad1_[64];
+  std::atomic<size_t> dequeue_pos_{0};
+  char pad2_[64];
+
+  std::atomic<bool> closed_{false};
+  std::atomic<bool> killed_{false};  // the queue is broken since exception
+  std::atomic<size_t> send_waiters_{0};
+  std::atomic<size_t> receive_waiters_{0};
+
+  mutable std::mutex mutex_;
+  std::condition_variable receive_cv_;
+  std::condition_variable send_cv_;
+};
+
+template <typename T>
+constexpr size_t RingBlockingQueue<T>::kSpinRounds;
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
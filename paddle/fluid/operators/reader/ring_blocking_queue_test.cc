@@ -0,0 +1,191 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "paddle/fluid/operators/reader/ring_blocking_queue.h"
+
+using paddle::operators::reader::RingBlockingQueue;
+
+TEST(RingBlockingQueue, CapacityTest) {
+  size_t cap = 10;
+  RingBlockingQueue<int> q(cap);
+  EXPECT_EQ(q.Cap(), cap);
+  EXPECT_EQ(q.Size(), 0UL);
+}
+
+void RingFirstInFirstOut(size_t queue_cap, size_t elem_num,
+                         size_t send_time_gap, size_t receive_time_gap) {
+  RingBlockingQueue<size_t> q(queue_cap);
+  std::thread sender([&]() {
+    for (size_t i = 0; i < elem_num; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(send_time_gap));
+      EXPECT_TRUE(q.Send(i));
+    }
+    q.Close();
+  });
+  size_t count = 0;
+  while (true) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(receive_time_gap));
+    size_t elem;
+    if (!q.Receive(&elem)) {
+      break;
+    }
+    EXPECT_EQ(elem, count++);
+  }
+  sender.join();
+  EXPECT_EQ(count, elem_num);
+  EXPECT_TRUE(q.IsClosed());
+}
+
+TEST(RingBlockingQueue, FirstInFirstOutTest) {
+  RingFirstInFirstOut(2, 5, 2, 50);
+  RingFirstInFirstOut(2, 5, 50, 2);
+  RingFirstInFirstOut(10, 3, 50, 2);
+  RingFirstInFirstOut(3, 10000, 0, 0);
+}
+
+TEST(RingBlockingQueue, SenderBlockingTest) {
+  const size_t queue_cap = 2;
+  RingBlockingQueue<size_t> q(queue_cap);
+  size_t send_count = 0;
+  std::thread sender([&]() {
+    for (size_t i = 0; i < 5; ++i) {
+      if (!q.Send(i)) {
+        break;
+      }
+      ++send_count;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  q.Close();
+  sender.join();
+  EXPECT_EQ(send_count, queue_cap);
+  // the elements sent before closed are still received
+  std::vector<size_t> res;
+  size_t elem;
+  while (q.Receive(&elem)) {
+    res.push_back(elem);
+  }
+  ASSERT_EQ(res.size(), queue_cap);
+  for (size_t i = 0; i < res.size(); ++i) {
+    EXPECT_EQ(res[i], i);
+  }
+}
+
+TEST(RingBlockingQueue, ReceiverBlockingTest) {
+  RingBlockingQueue<size_t> q(5);
+  std::vector<size_t> receive_res;
+  std::thread receiver([&]() {
+    size_t elem;
+    while (q.Receive(&elem)) {
+      receive_res.push_back(elem);
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::vector<size_t> to_send{2, 1, 7};
+  for (auto e : to_send) {
+    q.Send(e);
+  }
+  q.Close();
+  receiver.join();
+  EXPECT_EQ(receive_res, to_send);
+}
+
+TEST(RingBlockingQueue, MultiSenderMultiReceiverTest) {
+  const size_t sender_num = 4;
+  const size_t receiver_num = 3;
+  const size_t elem_num = 20000;
+  RingBlockingQueue<size_t> q(4);
+  std::vector<std::thread> senders;
+  for (size_t s = 0; s < sender_num; ++s) {
+    senders.emplace_back([&, s] {
+      for (size_t i = s; i < elem_num; i += sender_num) {
+        EXPECT_TRUE(q.Send(i));
+      }
+    });
+  }
+  std::mutex mu;
+  std::vector<size_t> received(elem_num, 0);
+  std::vector<std::thread> receivers;
+  for (size_t r = 0; r < receiver_num; ++r) {
+    receivers.emplace_back([&] {
+      size_t elem;
+      while (q.Receive(&elem)) {
+        std::lock_guard<std::mutex> lock(mu);
+        ++received[elem];
+      }
+    });
+  }
+  for (auto& t : senders) t.join();
+  q.Close();
+  for (auto& t : receivers) t.join();
+  for (size_t i = 0; i < elem_num; ++i) {
+    EXPECT_EQ(received[i], 1UL);
+  }
+  EXPECT_EQ(q.Size(), 0UL);
+}
+
+TEST(RingBlockingQueue, KillTest) {
+  RingBlockingQueue<size_t> q(2);
+  bool raised = false;
+  std::thread receiver([&] {
+    size_t elem;
+    try {
+      q.Receive(&elem);
+    } catch (paddle::platform::EnforceNotMet& err) {
+      raised = true;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  q.Kill();
+  receiver.join();
+  EXPECT_TRUE(raised);
+  EXPECT_TRUE(q.IsClosed());
+  EXPECT_THROW(q.Send(1), paddle::platform::EnforceNotMet);
+}
+
+TEST(RingBlockingQueue, ReOpenTest) {
+  RingBlockingQueue<size_t> q(3);
+  q.Send(1);
+  q.Send(2);
+  q.Close();
+  EXPECT_FALSE(q.Send(3));
+  q.ReOpen();
+  EXPECT_FALSE(q.IsClosed());
+  EXPECT_EQ(q.Size(), 0UL);
+  size_t elem;
+  EXPECT_FALSE(q.TryReceive(&elem));
+  EXPECT_TRUE(q.Send(4));
+  EXPECT_TRUE(q.TryReceive(&elem));
+  EXPECT_EQ(elem, 4UL);
+}
+
+TEST(RingBlockingQueue, speed_test_mode) {
+  size_t queue_size = 10;
+  RingBlockingQueue<size_t> q(queue_size, true);
+  for (size_t i = 0; i < queue_size; ++i) {
+    q.Send(i);
+  }
+  size_t b;
+  for (size_t i = 0; i < queue_size; ++i) {
+    q.Receive(&b);
+    EXPECT_EQ(b, 0UL);
+  }
+  EXPECT_EQ(q.Size(), queue_size);
+}
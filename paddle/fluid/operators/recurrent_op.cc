@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/recurrent_op.h"
 
 #include <algorithm>
+#include "paddle/fluid/framework/scope_pool.h"
 #include "paddle/fluid/string/string_helper.h"
 
 namespace paddle {
@@ -47,6 +48,16 @@ static void ClearStepScopes(const platform::DeviceContext &dev_ctx,
 
   dev_ctx.Wait();
 
+  if (framework::StepScopePool::IsEnabled()) {
+    // release the memory, and keep the scopes for the next forward run
+    for (auto *sub_scope : *step_scopes) {
+      if (parent_scope->HasKid(sub_scope)) {
+        framework::StepScopePool::ResetStepScope(sub_scope);
+      }
+    }
+    return;
+  }
+
   for (auto *sub_scope : *step_scopes) {
     if (parent_scope->HasKid(sub_scope)) {
       parent_scope->DeleteScope(sub_scope);
@@ -68,10 +79,13 @@ StepScopes::StepScopes(const platform::DeviceContext &dev_ctx,
                     platform::errors::PreconditionNotMet(
                         "Cannot backward when is not training"));
   if (!is_backward_) {
-    ClearStepScopes(dev_ctx, const_cast<framework::Scope *>(&parent), scopes);
+    if (!scopes->empty()) {
+      dev_ctx.Wait();
+    }
+    framework::StepScopePool step_scope_pool(parent, scopes);
     scopes->reserve(static_cast<size_t>(num_step_scopes));
     for (size_t i = 0; i < num_step_scopes; ++i) {
-      scopes->emplace_back(&parent.NewScope());
+      scopes->emplace_back(&step_scope_pool.NewScope());
     }
   }
 }
@@ -88,7 +102,12 @@ void StepScopes::BackwardNext(const platform::DeviceContext &dev_ctx,
   PADDLE_ENFORCE_EQ(is_backward_, true,
                     platform::errors::PreconditionNotMet(
                         "Cannot get backward next scope when is forward"));
-  if (counter_ + 2 == scopes_->size()) {
+  if (framework::StepScopePool::IsEnabled()) {
+    // the scopes are kept for the next forward run
+    if (counter_ + 1 < scopes_->size()) {
+      framework::StepScopePool::ResetStepScope((*scopes_)[counter_ + 1]);
+    }
+  } else if (counter_ + 2 == scopes_->size()) {
     parent_scope->DeleteScope((*scopes_)[counter_ + 1]);
     scopes_->pop_back();
     VLOG(3) << "Deleted scope at " << counter_ + 1;
@@ -18,15 +18,28 @@
 #include <cmath>
 #include <numeric>
 #include <set>
+#include <type_traits>
 #include <vector>
 
 #include <cub/cub.cuh>  // NOLINT
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/float16.h"
 
 namespace paddle {
 namespace operators {
 
+// The type to accumulate the reduction of T, which is float for float16.
+template <typename T>
+struct ReduceAccType {
+  using Type = T;
+};
+
+template <>
+struct ReduceAccType<platform::float16> {
+  using Type = float;
+};
+
 namespace detail {
 template <typename T, size_t ElementCount>
 struct Array {
@@ -54,38 +67,283 @@ struct Array {
   T data_[ElementCount];
 };
 
-// reduce the last axis of 2d array
-template <typename Tx, typename Ty, typename ReduceOp, typename TransformOp,
-          int BlockDim>
+// Apply the transformer to x converted to MPType.
+template <typename MPType, typename TransformOp>
+struct CastTransformer {
+  HOSTDEVICE explicit inline CastTransformer(const TransformOp& transformer)
+      : transformer_(transformer) {}
+
+  template <typename Tx>
+  HOSTDEVICE inline MPType operator()(const Tx& x) const {
+    return static_cast<MPType>(transformer_(static_cast<MPType>(x)));
+  }
+
+ private:
+  TransformOp transformer_;
+};
+
+template <typename T, int VecSize>
+struct alignas(sizeof(T) * VecSize) AlignedVector {
+  T val[VecSize];
+};
+
+// The number of the elements of T in a vector of 16 bytes.
+template <typename T>
+constexpr int GetVectorSize() {
+  return sizeof(T) >= 16 ? 1 : static_cast<int>(16 / sizeof(T));
+}
+
+/*
+ * \brief Reduce the transformed x[0, n) in the tid-th of num_threads threads,
+ * which loads the vectors of VecSize elements if VecSize > 1, where x should
+ * be aligned to the vector and n be divisible by VecSize.
+ */
+template <typename Tx, typename MPType, int VecSize, typename ReduceOp,
+          typename TransformOp>
+__device__ __forceinline__ MPType ThreadReduceRow(
+    const Tx* x, int n, int tid, int num_threads, const MPType& init,
+    const ReduceOp& reducer, const TransformOp& transformer) {
+  MPType reduce_var = init;
+  if (VecSize == 1) {
+    for (int i = tid; i < n; i += num_threads) {
+      reduce_var = reducer(reduce_var, transformer(x[i]));
+    }
+  } else {
+    auto* vec_x = reinterpret_cast<const AlignedVector<Tx, VecSize>*>(x);
+    for (int i = tid; i < n / VecSize; i += num_threads) {
+      AlignedVector<Tx, VecSize> vec = vec_x[i];
+#pragma unroll
+      for (int k = 0; k < VecSize; ++k) {
+        reduce_var = reducer(reduce_var, transformer(vec.val[k]));
+      }
+    }
+  }
+  return reduce_var;
+}
+
+template <typename Ty, typename MPType>
+__global__ void CastReduceResultKernel(const MPType* x, Ty* y) {
+  *y = static_cast<Ty>(*x);
+}
+
+// reduce the last axis of 2d array, each row of which is reduced by a block
+template <typename Tx, typename Ty, typename MPType, typename ReduceOp,
+          typename TransformOp, int BlockDim, int VecSize>
 __global__ void ReduceKernel2D(const Tx* x, Ty* y, ReduceOp reducer,
-                               TransformOp transformer, Ty init,
+                               TransformOp transformer, MPType init,
                                int reduce_num) {
-  __shared__ typename cub::BlockReduce<Ty, BlockDim>::TempStorage temp_storage;
-  int idx_x = blockIdx.x * reduce_num;
-  int idx_y = threadIdx.x;
-  Ty reduce_var = init;
-  for (int idx_y = threadIdx.x; idx_y < reduce_num; idx_y += BlockDim)
-    reduce_var = reducer(reduce_var, transformer(x[idx_x + idx_y]));
-  __syncthreads();
+  __shared__
+      typename cub::BlockReduce<MPType, BlockDim>::TempStorage temp_storage;
+  MPType reduce_var = ThreadReduceRow<Tx, MPType, VecSize>(
+      x + blockIdx.x * reduce_num, reduce_num, threadIdx.x, BlockDim, init,
+      reducer, transformer);
 
-  reduce_var =
-      cub::BlockReduce<Ty, BlockDim>(temp_storage).Reduce(reduce_var, reducer);
+  reduce_var = cub::BlockReduce<MPType, BlockDim>(temp_storage)
+                   .Reduce(reduce_var, reducer);
 
   if (threadIdx.x == 0) {
-    y[blockIdx.x] = reduce_var;
+    y[blockIdx.x] = static_cast<Ty>(reduce_var);
   }
 }
 
-template <typename Tx, typename Ty, typename ReduceOp, typename TransformOp,
-          int BlockDim, int Rank, int ReduceRank>
+constexpr int kWarpSize = 32;
+constexpr int kWarpReduceRows = 8;
+// The rows not longer than it are reduced by a warp instead of a block.
+constexpr int kWarpReduceMaxNum = 256;
+
+// reduce the last axis of 2d array, each row of which is reduced by a warp
+template <typename Tx, typename Ty, typename MPType, typename ReduceOp,
+          typename TransformOp, int VecSize>
+__global__ void ReduceKernel2DWarp(const Tx* x, Ty* y, ReduceOp reducer,
+                                   TransformOp transformer, MPType init,
+                                   int left_num, int reduce_num) {
+  __shared__ typename cub::WarpReduce<MPType>::TempStorage
+      temp_storage[kWarpReduceRows];
+  int row = blockIdx.x * kWarpReduceRows + threadIdx.y;
+  if (row >= left_num) return;
+  MPType reduce_var = ThreadReduceRow<Tx, MPType, VecSize>(
+      x + row * reduce_num, reduce_num, threadIdx.x, kWarpSize, init, reducer,
+      transformer);
+
+  reduce_var = cub::WarpReduce<MPType>(temp_storage[threadIdx.y])
+                   .Reduce(reduce_var, reducer);
+
+  if (threadIdx.x == 0) {
+    y[row] = static_cast<Ty>(reduce_var);
+  }
+}
+
+constexpr int kHigherDimBlockX = 32;
+constexpr int kHigherDimBlockY = 16;
+// The middle axis is reduced in chunks by more blocks if there are fewer
+// blocks than kHigherDimMinBlocks, while each thread of them still reduces
+// at least kHigherDimMinReducePerThread elements.
+constexpr int kHigherDimMinBlocks = 256;
+constexpr int kHigherDimMinReducePerThread = 16;
+
+/*
+ * \brief Reduce the middle axis of 3d array [pre, reduce_num, post] loaded by
+ * load(i, j, k). The threads along x of a block handle adjacent elements of
+ * the last axis so that the loads are coalesced, and those along y reduce
+ * every kHigherDimBlockY-th elements of the middle axis, which are folded in
+ * shared memory. The blockIdx.y-th blocks only reduce the blockIdx.y-th chunk
+ * of reduce_chunk elements, whose results are stored by
+ * store(blockIdx.y, i * post + k, result).
+ */
+template <typename MPType, typename ReduceOp, typename LoadOp,
+          typename StoreOp>
+__global__ void ReduceHigherDimKernel(LoadOp load, StoreOp store,
+                                      ReduceOp reducer, MPType init, int post,
+                                      int post_blocks, int reduce_num,
+                                      int reduce_chunk) {
+  __shared__ MPType sdata[kHigherDimBlockY][kHigherDimBlockX + 1];
+  int i = blockIdx.x / post_blocks;
+  int k = (blockIdx.x % post_blocks) * kHigherDimBlockX + threadIdx.x;
+  int begin = blockIdx.y * reduce_chunk;
+  int end = min(begin + reduce_chunk, reduce_num);
+  MPType reduce_var = init;
+  if (k < post) {
+    for (int j = begin + threadIdx.y; j < end; j += kHigherDimBlockY) {
+      reduce_var = reducer(reduce_var, load(i, j, k));
+    }
+  }
+  sdata[threadIdx.y][threadIdx.x] = reduce_var;
+  __syncthreads();
+  for (int stride = kHigherDimBlockY / 2; stride > 0; stride >>= 1) {
+    if (threadIdx.y < stride) {
+      sdata[threadIdx.y][threadIdx.x] =
+          reducer(sdata[threadIdx.y][threadIdx.x],
+                  sdata[threadIdx.y + stride][threadIdx.x]);
+    }
+    __syncthreads();
+  }
+  if (threadIdx.y == 0 && k < post) {
+    store(blockIdx.y, i * post + k, sdata[0][threadIdx.x]);
+  }
+}
+
+template <typename StoreOp>
+struct IgnoreChunkStorer {
+  template <typename MPType>
+  __device__ __forceinline__ void operator()(int chunk, int idx,
+                                             const MPType& val) const {
+    store(idx, val);
+  }
+
+  StoreOp store;
+};
+
+template <typename MPType>
+struct ChunkStorer {
+  __device__ __forceinline__ void operator()(int chunk, int idx,
+                                             const MPType& val) const {
+    partial[chunk * left_num + idx] = val;
+  }
+
+  MPType* partial;
+  int left_num;
+};
+
+template <typename MPType>
+struct ChunkLoader {
+  __device__ __forceinline__ MPType operator()(int i, int j, int k) const {
+    return partial[j * left_num + k];
+  }
+
+  const MPType* partial;
+  int left_num;
+};
+
+template <typename Tx, typename MPType, typename TransformOp>
+struct HigherDimLoader {
+  __device__ __forceinline__ MPType operator()(int i, int j, int k) const {
+    return transformer(x[(i * reduce_num + j) * post + k]);
+  }
+
+  const Tx* x;
+  TransformOp transformer;
+  int reduce_num;
+  int post;
+};
+
+template <typename Ty>
+struct CastStorer {
+  template <typename MPType>
+  __device__ __forceinline__ void operator()(int idx, const MPType& val) const {
+    y[idx] = static_cast<Ty>(val);
+  }
+
+  Ty* y;
+};
+
+}  // namespace detail
+
+/*
+ * \brief Reduce the middle axis of the 3d array [pre, reduce_num, post],
+ * whose element (i, j, k) is load(i, j, k) of MPType, and store the result of
+ * (i, k) by store(i * post + k, result). If there are not enough blocks for
+ * the other two axes, the middle axis is reduced in chunks by more blocks,
+ * whose partial results in a temporary buffer on place are reduced later.
+ */
+template <typename MPType, typename ReduceOp, typename LoadOp,
+          typename StoreOp>
+void ReduceHigherDim(const platform::Place& place, cudaStream_t stream,
+                     int pre, int reduce_num, int post, const MPType& init,
+                     const ReduceOp& reducer, const LoadOp& load,
+                     const StoreOp& store) {
+  int left_num = pre * post;
+  if (left_num == 0) return;
+  int post_blocks = (post + detail::kHigherDimBlockX - 1) /
+                    detail::kHigherDimBlockX;
+  int left_blocks = pre * post_blocks;
+  int max_chunks = std::max(
+      1, reduce_num / (detail::kHigherDimBlockY *
+                       detail::kHigherDimMinReducePerThread));
+  int chunks = std::min(
+      max_chunks,
+      (detail::kHigherDimMinBlocks + left_blocks - 1) / left_blocks);
+  dim3 block_dim(detail::kHigherDimBlockX, detail::kHigherDimBlockY);
+  if (chunks <= 1) {
+    detail::ReduceHigherDimKernel<<<left_blocks, block_dim, 0, stream>>>(
+        load, detail::IgnoreChunkStorer<StoreOp>{store}, reducer, init, post,
+        post_blocks, reduce_num, reduce_num);
+    return;
+  }
+
+  int reduce_chunk = (reduce_num + chunks - 1) / chunks;
+  chunks = (reduce_num + reduce_chunk - 1) / reduce_chunk;
+  framework::Tensor tmp;
+  auto* partial = reinterpret_cast<MPType*>(tmp.mutable_data<uint8_t>(
+      framework::make_ddim(
+          {static_cast<int64_t>(sizeof(MPType) * chunks * left_num)}),
+      place));
+  detail::ReduceHigherDimKernel<<<dim3(left_blocks, chunks), block_dim, 0,
+                                  stream>>>(
+      load, detail::ChunkStorer<MPType>{partial, left_num}, reducer, init,
+      post, post_blocks, reduce_num, reduce_chunk);
+  // Reduce the partial results of [1, chunks, left_num].
+  int left_num_blocks = (left_num + detail::kHigherDimBlockX - 1) /
+                        detail::kHigherDimBlockX;
+  detail::ReduceHigherDimKernel<<<left_num_blocks, block_dim, 0, stream>>>(
+      detail::ChunkLoader<MPType>{partial, left_num},
+      detail::IgnoreChunkStorer<StoreOp>{store}, reducer, init, left_num,
+      left_num_blocks, chunks, chunks);
+}
+
+namespace detail {
+
+template <typename Tx, typename Ty, typename MPType, typename ReduceOp,
+          typename TransformOp, int BlockDim, int Rank, int ReduceRank>
 __global__ void ReduceKernel(const Tx* x, Ty* y, ReduceOp reducer,
-                             TransformOp transformer, Ty init, int reduce_num,
+                             TransformOp transformer, MPType init,
+                             int reduce_num,
                              Array<int, Rank> x_strides,
                              Array<int, ReduceRank> reduce_dim,
                              Array<int, ReduceRank> reduce_strides,
                              Array<int, Rank - ReduceRank> left_dim,
                              Array<int, Rank - ReduceRank> left_strides) {
-  __shared__ typename cub::BlockReduce<Ty, BlockDim>::TempStorage temp_storage;
+  __shared__
+      typename cub::BlockReduce<MPType, BlockDim>::TempStorage temp_storage;
   Array<int, Rank> sub_index;
   int left_idx = blockIdx.x;
   for (int i = 0; i < Rank - ReduceRank; ++i) {
@@ -101,7 +359,7 @@ __global__ void ReduceKernel(const Tx* x, Ty* y, ReduceOp reducer,
 
   int idx_x = 0;
   for (int k = 0; k < Rank; ++k) idx_x += (sub_index[k] * x_strides[k]);
-  Ty reduce_var = static_cast<Ty>(transformer(x[idx_x]));
+  MPType reduce_var = transformer(x[idx_x]);
 
   for (int i = threadIdx.x + BlockDim; i < reduce_num; i += BlockDim) {
     int reduce_idx = i;
@@ -112,15 +370,15 @@ __global__ void ReduceKernel(const Tx* x, Ty* y, ReduceOp reducer,
 
     int idx_x = 0;
     for (int k = 0; k < Rank; ++k) idx_x += (sub_index[k] * x_strides[k]);
-    reduce_var = static_cast<Ty>(reducer(reduce_var, transformer(x[idx_x])));
+    reduce_var = reducer(reduce_var, transformer(x[idx_x]));
   }
   __syncthreads();
 
-  reduce_var =
-      cub::BlockReduce<Ty, BlockDim>(temp_storage).Reduce(reduce_var, reducer);
+  reduce_var = cub::BlockReduce<MPType, BlockDim>(temp_storage)
+                   .Reduce(reduce_var, reducer);
 
   if (threadIdx.x == 0) {
-    y[blockIdx.x] = reduce_var;
+    y[blockIdx.x] = static_cast<Ty>(reduce_var);
   }
 }
 
@@ -167,14 +425,15 @@ static inline void CheckReduceRankIsValid(int reduce_rank, int rank) {
   }
 }
 
-template <typename Tx, typename Ty, int BlockDim, typename ReduceOp,
-          typename TransformOp>
+template <typename Tx, typename Ty, typename MPType, int BlockDim,
+          typename ReduceOp, typename TransformOp>
 static void TensorReduceImpl(
     const Tx* x_data, Ty* y_data, const platform::Place& place,
-    const ReduceOp& reducer, const TransformOp& transformer, const Ty& init,
-    int left_num, int reduce_num, const std::vector<int>& x_strides,
-    const std::vector<int>& reduce_dim, const std::vector<int>& reduce_strides,
-    const std::vector<int>& left_dim, const std::vector<int>& left_strides,
+    const ReduceOp& reducer, const TransformOp& transformer,
+    const MPType& init, int left_num, int reduce_num,
+    const std::vector<int>& x_strides, const std::vector<int>& reduce_dim,
+    const std::vector<int>& reduce_strides, const std::vector<int>& left_dim,
+    const std::vector<int>& left_strides, bool use_vector,
     cudaStream_t stream) {
 #define CUB_RANK_CASE(i, ...)             \
   case i: {                               \
@@ -182,49 +441,60 @@ static void TensorReduceImpl(
     switch (reduce_rank) { __VA_ARGS__; } \
   } break
 
-#define CUB_REDUCE_RANK_CASE(i, ...)                              \
-  case i: {                                                       \
-    constexpr auto kReduceRank = i;                               \
-    ReduceKernel<Tx, Ty, ReduceOp, TransformOp, BlockDim, kRank,  \
-                 kReduceRank><<<left_num, BlockDim, 0, stream>>>( \
-        x_data, y_data, reducer, transformer, init, reduce_num,   \
-        Array<int, kRank>::From(x_strides),                       \
-        Array<int, kReduceRank>::From(reduce_dim),                \
-        Array<int, kReduceRank>::From(reduce_strides),            \
-        Array<int, kRank - kReduceRank>::From(left_dim),          \
-        Array<int, kRank - kReduceRank>::From(left_strides));     \
+#define CUB_REDUCE_RANK_CASE(i, ...)                                     \
+  case i: {                                                              \
+    constexpr auto kReduceRank = i;                                      \
+    ReduceKernel<Tx, Ty, MPType, ReduceOp, TransformOp, BlockDim,        \
+                 kRank, kReduceRank><<<left_num, BlockDim, 0, stream>>>( \
+        x_data, y_data, reducer, transformer, init, reduce_num,          \
+        Array<int, kRank>::From(x_strides),                              \
+        Array<int, kReduceRank>::From(reduce_dim),                       \
+        Array<int, kReduceRank>::From(reduce_strides),                   \
+        Array<int, kRank - kReduceRank>::From(left_dim),                 \
+        Array<int, kRank - kReduceRank>::From(left_strides));            \
   } break
 
   int rank = x_strides.size();
   int reduce_rank = reduce_strides.size();
   if (rank == reduce_rank) {
-    cub::TransformInputIterator<Ty, TransformOp, const Tx*> trans_x(
+    constexpr bool kSameType = std::is_same<Ty, MPType>::value;
+    cub::TransformInputIterator<MPType, TransformOp, const Tx*> trans_x(
         x_data, transformer);
+    // The result of MPType is cast to Ty by another kernel if they differ.
+    framework::Tensor tmp_result;
+    auto* result =
+        kSameType ? reinterpret_cast<MPType*>(y_data)
+                  : reinterpret_cast<MPType*>(tmp_result.mutable_data<uint8_t>(
+                        framework::make_ddim(
+                            {static_cast<int64_t>(sizeof(MPType))}),
+                        place));
     size_t temp_storage_bytes = 0;
-    cub::DeviceReduce::Reduce(nullptr, temp_storage_bytes, trans_x, y_data,
+    cub::DeviceReduce::Reduce(nullptr, temp_storage_bytes, trans_x, result,
                               reduce_num, reducer, init, stream);
     framework::Tensor tmp;
     auto* temp_storage = tmp.mutable_data<uint8_t>(
         framework::make_ddim({static_cast<int64_t>(temp_storage_bytes)}),
         place);
-    cub::DeviceReduce::Reduce(temp_storage, temp_storage_bytes, trans_x, y_data,
+    cub::DeviceReduce::Reduce(temp_storage, temp_storage_bytes, trans_x, result,
                               reduce_num, reducer, init, stream);
+    if (!kSameType) {
+      CastReduceResultKernel<Ty, MPType><<<1, 1, 0, stream>>>(result, y_data);
+    }
     return;
   }
   if (rank == 2 && reduce_rank == 1 && reduce_dim[0] == 1) {
-    ReduceKernel2D<Tx, Ty, ReduceOp, TransformOp,
-                   BlockDim><<<left_num, BlockDim, 0, stream>>>(
-        x_data, y_data, reducer, transformer, init, reduce_num);
-    return;
-  }
-  /*
-  if (rank == 3 && reduce_rank == 1 && reduce_dim[0] == 1) {
-    // TODO(liangdun): we can optimize 3d case which the 2nd axis is reduced.
-    // Currently, it is handled by code below, but inefficient
+    constexpr int kVecSize = GetVectorSize<Tx>();
+    if (use_vector) {
+      ReduceKernel2D<Tx, Ty, MPType, ReduceOp, TransformOp, BlockDim,
+                     kVecSize><<<left_num, BlockDim, 0, stream>>>(
+          x_data, y_data, reducer, transformer, init, reduce_num);
+    } else {
+      ReduceKernel2D<Tx, Ty, MPType, ReduceOp, TransformOp, BlockDim,
+                     1><<<left_num, BlockDim, 0, stream>>>(
+          x_data, y_data, reducer, transformer, init, reduce_num);
+    }
     return;
   }
-  */
-
   /**
    * Since we have combined the adjacent reduce dimensions inside TensorReduce,
    * The reduce ranks and non-reduce ranks must be interleaving. That is to say,
@@ -263,9 +533,15 @@ static void TensorReduceImpl(
 
 }  // namespace detail
 
-template <typename Tx, typename Ty, typename ReduceOp, typename TransformOp>
+/*
+ * \brief Reduce x over origin_reduce_dims into y, where the transformer is
+ * applied to each element of x converted to MPType, on which the reduction
+ * is accumulated, e.g. float for the reduction of float16.
+ */
+template <typename Tx, typename Ty, typename ReduceOp, typename TransformOp,
+          typename MPType = Ty>
 void TensorReduce(const framework::Tensor& x, framework::Tensor* y,
-                  std::vector<int> origin_reduce_dims, const Ty& init,
+                  std::vector<int> origin_reduce_dims, const MPType& init,
                   const ReduceOp& reducer, const TransformOp& transformer,
                   cudaStream_t stream) {
   auto x_dim = framework::vectorize<int>(x.dims());
@@ -318,16 +594,60 @@ void TensorReduce(const framework::Tensor& x, framework::Tensor* y,
     return;
   }
 
-#define CUB_BLOCK_DIM_CASE(block_dim)                                    \
-  case block_dim: {                                                      \
-    constexpr auto kBlockDim = block_dim;                                \
-    detail::TensorReduceImpl<Tx, Ty, block_dim, ReduceOp, TransformOp>(  \
-        x_data, y_data, x.place(), reducer, transformer, init, left_num, \
-        reduce_num, x_strides, reduce_dim, reduce_strides, left_dim,     \
-        left_strides, stream);                                           \
+  using CastTransformOp = detail::CastTransformer<MPType, TransformOp>;
+  CastTransformOp cast_transformer(transformer);
+  // Reduce the first axis of [reduce_num, left_num], or the middle axis of
+  // [pre, reduce_num, post], by the threads along the contiguous last axis.
+  bool reduce_higher_dim = (x_rank == 2 && reduce_dim[0] == 0) ||
+                           (x_rank == 3 && reduce_dim.size() == 1 &&
+                            reduce_dim[0] == 1);
+  if (reduce_higher_dim) {
+    int pre = x_rank == 3 ? x_dim[0] : 1;
+    int post = x_dim.back();
+    ReduceHigherDim(x.place(), stream, pre, reduce_num, post, init, reducer,
+                    detail::HigherDimLoader<Tx, MPType, CastTransformOp>{
+                        x_data, cast_transformer, reduce_num, post},
+                    detail::CastStorer<Ty>{y_data});
+    return;
+  }
+
+  // Each row of the last axis is loaded by the vectors of 16 bytes if it is
+  // divisible to them, and is reduced by a warp if it is short enough.
+  bool reduce_last_dim = x_rank == 2 && reduce_dim[0] == 1;
+  constexpr int kVecSize = detail::GetVectorSize<Tx>();
+  bool use_vector =
+      reduce_last_dim && kVecSize > 1 && reduce_num % kVecSize == 0 &&
+      reinterpret_cast<uintptr_t>(x_data) % (sizeof(Tx) * kVecSize) == 0;
+  if (reduce_last_dim && reduce_num <= detail::kWarpReduceMaxNum) {
+    dim3 block_dim(detail::kWarpSize, detail::kWarpReduceRows);
+    int grid_dim =
+        (left_num + detail::kWarpReduceRows - 1) / detail::kWarpReduceRows;
+    if (use_vector) {
+      detail::ReduceKernel2DWarp<Tx, Ty, MPType, ReduceOp, CastTransformOp,
+                                 kVecSize><<<grid_dim, block_dim, 0, stream>>>(
+          x_data, y_data, reducer, cast_transformer, init, left_num,
+          reduce_num);
+    } else {
+      detail::ReduceKernel2DWarp<Tx, Ty, MPType, ReduceOp, CastTransformOp,
+                                 1><<<grid_dim, block_dim, 0, stream>>>(
+          x_data, y_data, reducer, cast_transformer, init, left_num,
+          reduce_num);
+    }
+    return;
+  }
+
+#define CUB_BLOCK_DIM_CASE(block_dim)                                \
+  case block_dim: {                                                  \
+    constexpr auto kBlockDim = block_dim;                            \
+    detail::TensorReduceImpl<Tx, Ty, MPType, block_dim, ReduceOp,    \
+                             CastTransformOp>(                       \
+        x_data, y_data, x.place(), reducer, cast_transformer, init,  \
+        left_num, reduce_num, x_strides, reduce_dim, reduce_strides, \
+        left_dim, left_strides, use_vector, stream);                 \
   } break
 
-  switch (detail::GetDesiredBlockDim(reduce_num)) {
+  switch (detail::GetDesiredBlockDim(use_vector ? reduce_num / kVecSize
+                                                : reduce_num)) {
     CUB_BLOCK_DIM_CASE(512);
     CUB_BLOCK_DIM_CASE(256);
     CUB_BLOCK_DIM_CASE(128);
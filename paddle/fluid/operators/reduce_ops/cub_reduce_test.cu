@@ -0,0 +1,110 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/reduce_ops/cub_reduce.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+struct TestIdentityFunctor {
+  HOSTDEVICE inline T operator()(const T& x) const { return x; }
+};
+
+// Sum x of dims over reduce_dims by TensorReduce, and compare the result with
+// the one on CPU.
+template <typename T>
+void TestTensorReduceSum(const std::vector<int64_t>& dims,
+                         const std::vector<int>& reduce_dims, float atol) {
+  using MPType = typename ReduceAccType<T>::Type;
+  platform::CPUPlace cpu_place;
+  platform::CUDAPlace gpu_place(0);
+  platform::CUDADeviceContext context(gpu_place);
+
+  framework::Tensor x_cpu, x, y, y_cpu;
+  auto x_dims = framework::make_ddim(dims);
+  int64_t numel = framework::product(x_dims);
+  T* x_data = x_cpu.mutable_data<T>(x_dims, cpu_place);
+  for (int64_t i = 0; i < numel; ++i) {
+    x_data[i] = static_cast<T>(static_cast<float>(i % 17) / 16 - 0.5f);
+  }
+
+  // The reference of y of dims whose reduce_dims are 1.
+  std::vector<int64_t> y_dims = dims;
+  for (auto d : reduce_dims) y_dims[d] = 1;
+  std::vector<double> y_ref(framework::product(framework::make_ddim(y_dims)));
+  for (int64_t i = 0; i < numel; ++i) {
+    int64_t remain = i;
+    int64_t y_index = 0;
+    int64_t y_stride = 1;
+    for (int d = static_cast<int>(dims.size()) - 1; d >= 0; --d) {
+      int64_t index = remain % dims[d];
+      remain /= dims[d];
+      y_index += (y_dims[d] == 1 ? 0 : index) * y_stride;
+      y_stride *= y_dims[d];
+    }
+    y_ref[y_index] += static_cast<double>(static_cast<float>(x_data[i]));
+  }
+
+  framework::TensorCopySync(x_cpu, gpu_place, &x);
+  y.mutable_data<T>(framework::make_ddim(y_dims), gpu_place);
+  TensorReduce<T, T, cub::Sum, TestIdentityFunctor<MPType>, MPType>(
+      x, &y, reduce_dims, static_cast<MPType>(0), cub::Sum(),
+      TestIdentityFunctor<MPType>(), context.stream());
+  context.Wait();
+  framework::TensorCopySync(y, cpu_place, &y_cpu);
+
+  const T* y_data = y_cpu.data<T>();
+  for (size_t i = 0; i < y_ref.size(); ++i) {
+    EXPECT_NEAR(static_cast<float>(y_data[i]), y_ref[i], atol);
+  }
+}
+
+TEST(TensorReduce, reduce_last_dim) {
+  // by warps
+  TestTensorReduceSum<float>({300, 40}, {1}, 1e-4);
+  TestTensorReduceSum<float>({300, 37}, {1}, 1e-4);
+  // by blocks
+  TestTensorReduceSum<float>({30, 4000}, {1}, 1e-2);
+  TestTensorReduceSum<double>({30, 4001}, {1}, 1e-8);
+  TestTensorReduceSum<float>({3, 5, 4, 1000}, {2, 3}, 1e-2);
+}
+
+TEST(TensorReduce, reduce_higher_dim) {
+  TestTensorReduceSum<float>({50, 70}, {0}, 1e-4);
+  TestTensorReduceSum<float>({5, 60, 70}, {1}, 1e-4);
+  // in chunks
+  TestTensorReduceSum<float>({20000, 33}, {0}, 1e-1);
+  TestTensorReduceSum<double>({2, 10000, 3}, {1}, 1e-8);
+}
+
+TEST(TensorReduce, reduce_mixed_dims) {
+  TestTensorReduceSum<float>({20, 30, 40}, {0, 2}, 1e-3);
+  TestTensorReduceSum<float>({6, 7, 8, 9, 10}, {1, 3}, 1e-3);
+  TestTensorReduceSum<float>({300, 400}, {0, 1}, 1e-1);
+}
+
+TEST(TensorReduce, reduce_float16) {
+  TestTensorReduceSum<platform::float16>({64, 256}, {1}, 1e-1);
+  TestTensorReduceSum<platform::float16>({64, 1024}, {1}, 1e-1);
+  TestTensorReduceSum<platform::float16>({1024, 64}, {0}, 1e-1);
+  TestTensorReduceSum<platform::float16>({16, 32, 64}, {0, 2}, 1e-1);
+  TestTensorReduceSum<platform::float16>({100, 100}, {0, 1}, 1e-1);
+}
+
+}  // namespace operators
+}  // namespace paddle
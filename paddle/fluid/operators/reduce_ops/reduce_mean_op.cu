@@ -55,10 +55,11 @@ class ReduceMeanKernel : public framework::OpKernel<T> {
       reduce_num *= input->dims()[reduce_dims[i]];
     }
 
+    using MPType = typename ReduceAccType<T>::Type;
     auto stream = context.cuda_device_context().stream();
-    TensorReduce<T, T, cub::Sum, DivideFunctor<T>>(
-        *input, output, reduce_dims, static_cast<T>(0), cub::Sum(),
-        DivideFunctor<T>(reduce_num), stream);
+    TensorReduce<T, T, cub::Sum, DivideFunctor<MPType>, MPType>(
+        *input, output, reduce_dims, static_cast<MPType>(0), cub::Sum(),
+        DivideFunctor<MPType>(reduce_num), stream);
   }
 };
 
@@ -68,4 +69,5 @@ class ReduceMeanKernel : public framework::OpKernel<T> {
 REGISTER_OP_CUDA_KERNEL(reduce_mean, ops::ReduceMeanKernel<float>,
                         ops::ReduceMeanKernel<double>,
                         ops::ReduceMeanKernel<int>,
-                        ops::ReduceMeanKernel<int64_t>);
+                        ops::ReduceMeanKernel<int64_t>,
+                        ops::ReduceMeanKernel<paddle::platform::float16>);
@@ -31,7 +31,9 @@ struct MeanGradFunctor {
             typename DY, typename Dim>
   void operator()(const DeviceContext& place, X* x, Y* y, DX* dx, DY* dy,
                   const Dim& dim, int size) {
-    dx->device(place) = dy->broadcast(dim) / dx->constant(size);
+    using T = typename DX::Scalar;
+    dx->device(place) =
+        dy->broadcast(dim) / dx->constant(static_cast<T>(size));
   }
 };
 
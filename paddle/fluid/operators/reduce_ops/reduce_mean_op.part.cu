@@ -23,4 +23,5 @@ using CUDAReduceMeanGradKernel =
 REGISTER_OP_CUDA_KERNEL(reduce_mean_grad, CUDAReduceMeanGradKernel<float>,
                         CUDAReduceMeanGradKernel<double>,
                         CUDAReduceMeanGradKernel<int>,
-                        CUDAReduceMeanGradKernel<int64_t>);
+                        CUDAReduceMeanGradKernel<int64_t>,
+                        CUDAReduceMeanGradKernel<paddle::platform::float16>);
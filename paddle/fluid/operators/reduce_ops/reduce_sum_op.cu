@@ -51,10 +51,11 @@ class ReduceSumKernel : public framework::OpKernel<T> {
       reduce_num *= input->dims()[reduce_dims[i]];
     }
 
+    using MPType = typename ReduceAccType<T>::Type;
     auto stream = context.cuda_device_context().stream();
-    TensorReduce<T, T, cub::Sum, IdentityFunctor<T>>(
-        *input, output, reduce_dims, static_cast<T>(0), cub::Sum(),
-        IdentityFunctor<T>(), stream);
+    TensorReduce<T, T, cub::Sum, IdentityFunctor<MPType>, MPType>(
+        *input, output, reduce_dims, static_cast<MPType>(0), cub::Sum(),
+        IdentityFunctor<MPType>(), stream);
   }
 };
 
@@ -63,4 +64,5 @@ class ReduceSumKernel : public framework::OpKernel<T> {
 
 REGISTER_OP_CUDA_KERNEL(reduce_sum, ops::ReduceSumKernel<float>,
                         ops::ReduceSumKernel<double>, ops::ReduceSumKernel<int>,
-                        ops::ReduceSumKernel<int64_t>);
+                        ops::ReduceSumKernel<int64_t>,
+                        ops::ReduceSumKernel<paddle::platform::float16>);
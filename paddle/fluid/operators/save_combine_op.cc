@@ -65,6 +65,21 @@ to a file on disk.
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>("save_as_indexed",
+                  "(boolean, default false)"
+                  "If true, the tensors are saved in the indexed format, "
+                  "whose tensors are aligned in the file, so that "
+                  "load_combine can map the file without copying the "
+                  "tensors, or read the tensors in parallel.")
+        .SetDefault(false);
+    AddAttr<bool>("async",
+                  "(boolean, default false)"
+                  "If true, the LoDTensors are copied to the host memory, "
+                  "and written to the file in the background, so that the "
+                  "training is not stalled by the writing. The file is "
+                  "replaced by renaming once it is written completely. "
+                  "Call fluid.io.wait_async_save to wait for the writing.")
+        .SetDefault(false);
     AddAttr<std::string>(
         "file_path",
         "(string)"
@@ -19,10 +19,12 @@ limitations under the License. */
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/io/async_checkpoint.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -38,6 +40,7 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     auto filename = ctx.Attr<std::string>("file_path");
     auto overwrite = ctx.Attr<bool>("overwrite");
     auto save_as_fp16 = ctx.Attr<bool>("save_as_fp16");
+    auto save_as_indexed = ctx.Attr<bool>("save_as_indexed");
 
     bool is_present = FileExists(filename);
     if (is_present && !overwrite) {
@@ -46,9 +49,14 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     }
 
     MkDirRecursively(DirName(filename).c_str());
-    std::ofstream fout(filename, std::ios::binary);
-    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
-                   filename);
+    // the file is written in the background in the async mode
+    bool async = ctx.Attr<bool>("async");
+    std::ofstream fout;
+    if (!async) {
+      fout.open(filename, std::ios::binary);
+      PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                     filename);
+    }
 
     auto inp_var_names = ctx.InputNames("X");
     auto &inp_vars = ctx.MultiInputVar("X");
@@ -58,6 +66,10 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     // get device context from pool
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
+    // the tensors converted to float16, which are kept until the indexed file
+    // is written
+    std::vector<framework::LoDTensor> converted(inp_var_names.size());
+    std::vector<const framework::LoDTensor *> indexed_tensors;
 
     for (size_t i = 0; i < inp_var_names.size(); i++) {
       PADDLE_ENFORCE(inp_vars[i] != nullptr,
@@ -78,15 +90,29 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
       if (in_dtype != out_dtype) {
         auto in_kernel_type = framework::OpKernelType(in_dtype, place);
         auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor out;
+        framework::LoDTensor &out = converted[i];
         // copy LoD info to the new tensor
         out.set_lod(tensor.lod());
         framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
-        framework::SerializeToStream(fout, out, dev_ctx);
+        if (save_as_indexed || async) {
+          indexed_tensors.push_back(&out);
+        } else {
+          framework::SerializeToStream(fout, out, dev_ctx);
+        }
+      } else if (save_as_indexed || async) {
+        indexed_tensors.push_back(&tensor);
       } else {
         framework::SerializeToStream(fout, tensor, dev_ctx);
       }
     }
+    if (async) {
+      framework::AsyncCheckpointWriter::Instance().Save(
+          filename, indexed_tensors, dev_ctx, save_as_indexed);
+      return;
+    }
+    if (save_as_indexed) {
+      framework::SerializeIndexedToStream(fout, indexed_tensors, dev_ctx);
+    }
     fout.close();
   }
 };
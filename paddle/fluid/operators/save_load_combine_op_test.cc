@@ -344,3 +344,115 @@ TEST(SaveLoadTestWithCombineOp, CPU) {
     }
   }
 }
+
+#ifndef _WIN32
+// The tensors loaded with use_mmap share the mapped file, and the writes to
+// them do not change the file.
+TEST(LoadCombineOpWithMmap, CPU) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  float* expect1 = CreateForSaveCombineOp<float, float>(
+      10, 10, lod1, "test_var1", place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 20};
+  int numel2 = 4000;
+  paddle::framework::LoD expect_lod2;
+  int* expect2 = CreateForSaveCombineOp<int, int>(20, 200, lod2, "test_var2",
+                                                  place, &scope, &expect_lod2);
+
+  std::string filename = "check_tensor_mmap.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+  save_combine_op->Run(scope, place);
+
+  attrs.insert({"use_mmap", true});
+  for (int i = 0; i < 2; ++i) {
+    auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+    auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+    auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, attrs);
+    load_combine_op->Run(scope, place);
+
+    paddle::framework::LoD actual_lod1, actual_lod2;
+    float* actual1 =
+        GetValuesAfterLoadCombineOp<float>(target1, scope, &actual_lod1);
+    int* actual2 =
+        GetValuesAfterLoadCombineOp<int>(target2, scope, &actual_lod2);
+    CheckValues<float, float>(expect1, actual1, expect_lod1, actual_lod1,
+                              numel1);
+    CheckValues<int, int>(expect2, actual2, expect_lod2, actual_lod2, numel2);
+
+    // the write is private, and the tensors are loaded again from the file
+    target1->mutable_data<float>(place)[0] = -1;
+    EXPECT_EQ(target1->data<float>(), actual1);
+  }
+}
+#endif
+
+// The tensors saved in the indexed format are read in parallel, or share the
+// mapped file, whose data are aligned.
+TEST(SaveLoadCombineOpWithIndexed, CPU) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  float* expect1 = CreateForSaveCombineOp<float, float>(
+      10, 10, lod1, "test_var1", place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 3};
+  int numel2 = 3;
+  paddle::framework::LoD expect_lod2;
+  int* expect2 = CreateForSaveCombineOp<int, int>(3, 1, lod2, "test_var2",
+                                                  place, &scope, &expect_lod2);
+
+  std::string filename = "check_tensor_indexed.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+  attrs.insert({"save_as_indexed", true});
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+  save_combine_op->Run(scope, place);
+  EXPECT_TRUE(paddle::framework::IsIndexedTensorsFile(filename));
+
+  attrs.erase("save_as_indexed");
+#ifndef _WIN32
+  std::vector<bool> use_mmap = {false, true};
+#else
+  std::vector<bool> use_mmap = {false};
+#endif
+  for (bool mmap : use_mmap) {
+    attrs["use_mmap"] = mmap;
+    auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+    auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+    auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, attrs);
+    load_combine_op->Run(scope, place);
+
+    paddle::framework::LoD actual_lod1, actual_lod2;
+    float* actual1 =
+        GetValuesAfterLoadCombineOp<float>(target1, scope, &actual_lod1);
+    int* actual2 =
+        GetValuesAfterLoadCombineOp<int>(target2, scope, &actual_lod2);
+    CheckValues<float, float>(expect1, actual1, expect_lod1, actual_lod1,
+                              numel1);
+    CheckValues<int, int>(expect2, actual2, expect_lod2, actual_lod2, numel2);
+    if (mmap) {
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(actual2) % 64, 0UL);
+    }
+  }
+
+  // all the tensors of the file should be loaded
+  GeneratePlaceholderBeforeLoad("out_var1", &scope);
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"out_var1"}}}, attrs);
+  EXPECT_THROW(load_combine_op->Run(scope, place),
+               paddle::platform::EnforceNotMet);
+}
@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_registry.h"
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
 #include "paddle/fluid/platform/float16.h"
 
 USE_CPU_ONLY_OP(save);
@@ -63,6 +66,40 @@ TEST(SaveLoadOp, CPU) {
   }
 }
 
+#ifndef _WIN32
+TEST(SaveLoadOp, CPU_mmap) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  auto tensor =
+      scope.Var("test_var")->GetMutable<paddle::framework::LoDTensor>();
+  tensor->Resize({4, 8});
+  float* expect = tensor->mutable_data<float>(place);
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    expect[i] = static_cast<float>(i);
+  }
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string("tensor_mmap.save")});
+  auto save_op = paddle::framework::OpRegistry::CreateOp(
+      "save", {{"X", {"test_var"}}}, {}, attrs);
+  save_op->Run(scope, place);
+
+  attrs.insert({"use_mmap", true});
+  auto target =
+      scope.Var("out_var")->GetMutable<paddle::framework::LoDTensor>();
+  auto load_op = paddle::framework::OpRegistry::CreateOp(
+      "load", {}, {{"Out", {"out_var"}}}, attrs);
+  load_op->Run(scope, place);
+  // the loaded tensor is in the mapped file
+  EXPECT_TRUE(paddle::memory::allocation::IsInMemoryMapFile(
+      target->data<float>(), target->numel() * sizeof(float)));
+  const float* actual = target->data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    EXPECT_EQ(expect[i], actual[i]);
+  }
+}
+#endif
+
 TEST(SaveFP16Op, CPU) {
   paddle::framework::Scope scope;
   paddle::platform::CPUPlace place;
@@ -55,6 +55,14 @@ This operator will serialize and write LoDTensor / SelectedRows variable to file
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>("async",
+                  "(boolean, default false)"
+                  "If true, the LoDTensors are copied to the host memory, "
+                  "and written to the file in the background, so that the "
+                  "training is not stalled by the writing. The file is "
+                  "replaced by renaming once it is written completely. "
+                  "Call fluid.io.wait_async_save to wait for the writing.")
+        .SetDefault(false);
     AddAttr<std::string>("file_path",
                          "(string)"
                          "The \"file_path\" where the variable will be saved.")
@@ -15,12 +15,17 @@ limitations under the License. */
 #pragma once
 #include <unordered_set>
 #include <vector>
+#include "cub/cub.cuh"
+#include "gflags/gflags.h"
 #include "math/math_function.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
+#include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
 
+DECLARE_bool(cudnn_deterministic);
+
 namespace paddle {
 namespace operators {
 
@@ -29,6 +34,88 @@ using Tensor = framework::Tensor;
 #define CUDA_1D_KERNEL_LOOP(i, n)                              \
   for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
        i += blockDim.x * gridDim.x)
+
+// The updates are sorted by their rows in the output once there are this
+// many updates per row, since most of them go to the same rows, and the
+// atomicAdd of them contends.
+constexpr int64_t kSortedScatterRatio = 4;
+
+// Whether to add the updates by sorting them, which is also deterministic.
+inline bool UseSortedScatter(int64_t num_updates, int64_t num_rows) {
+  return FLAGS_cudnn_deterministic ||
+         num_updates >= kSortedScatterRatio * num_rows;
+}
+
+template <typename T>
+__global__ void ScatterIotaCUDAKernel(T* output, int n) {
+  CUDA_1D_KERNEL_LOOP(i, n) { output[i] = i; }
+}
+
+// Each thread sums up an element of the updates of a row, in their order in
+// the input, if the thread is at the first one of them.
+template <typename T, typename IndexT = int>
+__global__ void ScatterSortedCUDAKernel(const T* update,
+                                        const IndexT* sorted_rows,
+                                        const int* sorted_pos, T* output,
+                                        int num, size_t slice_size,
+                                        bool accumulate) {
+  CUDA_1D_KERNEL_LOOP(i, num * slice_size) {
+    int p = i / slice_size;
+    int slice_i = i - p * slice_size;  // offset inside the slice
+    IndexT row = sorted_rows[p];
+    if (p > 0 && sorted_rows[p - 1] == row) continue;
+    T sum = static_cast<T>(0);
+    for (int q = p; q < num && sorted_rows[q] == row; ++q) {
+      sum += update[sorted_pos[q] * slice_size + slice_i];
+    }
+    T* out = output + row * slice_size + slice_i;
+    *out = accumulate ? *out + sum : sum;
+  }
+}
+
+/**
+ * Adds the slices of update to the rows of output, or sets the rows to the
+ * sums of their slices if not accumulate, without atomicAdd. The updates are
+ * sorted by their rows stably, so that the sums are deterministic.
+ * update[i * slice_size, (i + 1) * slice_size) goes to the row rows[i].
+ */
+template <typename T, typename IndexT = int>
+void GPUScatterSorted(const platform::CUDADeviceContext& ctx, const T* update,
+                      const IndexT* rows, T* output, int num,
+                      size_t slice_size, bool accumulate) {
+  if (num == 0) return;
+  auto stream = ctx.stream();
+  auto sorted_rows_ptr = memory::Alloc(ctx, num * sizeof(IndexT));
+  auto pos_ptr = memory::Alloc(ctx, num * sizeof(int));
+  auto sorted_pos_ptr = memory::Alloc(ctx, num * sizeof(int));
+  auto* sorted_rows = reinterpret_cast<IndexT*>(sorted_rows_ptr->ptr());
+  auto* pos = reinterpret_cast<int*>(pos_ptr->ptr());
+  auto* sorted_pos = reinterpret_cast<int*>(sorted_pos_ptr->ptr());
+
+  int block = 512;
+  ScatterIotaCUDAKernel<int><<<(num + block - 1) / block, block, 0, stream>>>(
+      pos, num);
+  size_t temp_bytes = 0;
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cub::DeviceRadixSort::SortPairs(nullptr, temp_bytes, rows, sorted_rows,
+                                      pos, sorted_pos, num, 0,
+                                      sizeof(IndexT) * 8, stream),
+      platform::errors::External("Failed to get the temporary storage size "
+                                 "of cub::DeviceRadixSort::SortPairs."));
+  auto temp_ptr = memory::Alloc(ctx, temp_bytes);
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cub::DeviceRadixSort::SortPairs(temp_ptr->ptr(), temp_bytes, rows,
+                                      sorted_rows, pos, sorted_pos, num, 0,
+                                      sizeof(IndexT) * 8, stream),
+      platform::errors::External(
+          "Failed to sort the rows by cub::DeviceRadixSort::SortPairs."));
+
+  int n = slice_size * num;
+  ScatterSortedCUDAKernel<T, IndexT><<<(n + block - 1) / block, block, 0,
+                                       stream>>>(update, sorted_rows,
+                                                 sorted_pos, output, num,
+                                                 slice_size, accumulate);
+}
 template <typename T, typename IndexT = int>
 __global__ void ScatterInitCUDAKernel(const IndexT* indices, T* output,
                                       size_t index_size, size_t slice_size,
@@ -79,6 +166,23 @@ __global__ void ScatterNdCUDAKernel(const T* update, const IndexT* indices,
   }
 }
 
+// The rows of the output, of the shape [rows, slice_size], which the slices
+// of the updates are added to.
+template <typename IndexT = int>
+__global__ void ScatterNdRowsCUDAKernel(const IndexT* indices, IndexT* rows,
+                                        const int* output_dims,
+                                        size_t remain_size, size_t end_size) {
+  CUDA_1D_KERNEL_LOOP(i, remain_size) {
+    IndexT row = 0;
+    int64_t temp = 1;
+    for (int64_t j = end_size - 1; j >= 0; --j) {
+      row += indices[i * end_size + j] * temp;
+      temp *= output_dims[j];
+    }
+    rows[i] = row;
+  }
+}
+
 /**
  * A thin wrapper on gpu tensor
  * Return a new updated tensor from source tensor, scatter-assigned according to
@@ -121,6 +225,15 @@ void GPUScatterAssign(const framework::ExecutionContext& context,
   int n = slice_size * index_size;
   int grid = (n + block - 1) / block;
 
+  // The rows are set to the sums of their updates at once, so there is no
+  // need to init them.
+  if (!overwrite && UseSortedScatter(index_size, output->dims()[0])) {
+    GPUScatterSorted<T, IndexT>(
+        reinterpret_cast<const platform::CUDADeviceContext&>(ctx), p_src,
+        p_index, p_output, index_size, slice_size, false);
+    return;
+  }
+
   // if not overwrite mode, init data
   if (!overwrite) {
     ScatterInitCUDAKernel<T, IndexT><<<
@@ -178,6 +291,19 @@ void GPUScatterNdAdd(const framework::ExecutionContext& context,
                ctx.stream());
 
   int block = 512;
+  int64_t output_rows = framework::product(
+      framework::slice_ddim(output_dims, 0, end_size));
+  if (UseSortedScatter(remain_numel, output_rows)) {
+    auto rows_ptr = memory::Alloc(dev_ctx, remain_numel * sizeof(IndexT));
+    IndexT* rows = reinterpret_cast<IndexT*>(rows_ptr->ptr());
+    ScatterNdRowsCUDAKernel<IndexT><<<(remain_numel + block - 1) / block,
+                                      block, 0, ctx.stream()>>>(
+        p_index, rows, g_output_dims, remain_numel, end_size);
+    GPUScatterSorted<T, IndexT>(dev_ctx, p_update, rows, p_output,
+                                remain_numel, slice_size, true);
+    return;
+  }
+
   int n = slice_size * remain_numel;
   int grid = (n + block - 1) / block;
 
@@ -54,7 +54,7 @@ class SequenceEnumerateOpCUDAKernel : public framework::OpKernel<T> {
     int pad_value = context.Attr<int>("pad_value");
 
     auto in_dims = in->dims();
-    auto in_lod = in->lod();
+    auto& in_lod = in->lod();
 
     PADDLE_ENFORCE_EQ(
         static_cast<uint64_t>(in_dims[0]), in_lod[0].back(),
@@ -62,7 +62,7 @@ class SequenceEnumerateOpCUDAKernel : public framework::OpKernel<T> {
 
     /* Generate enumerate sequence set */
     auto stream = context.cuda_device_context().stream();
-    auto lod0 = in_lod[0];
+    auto& lod0 = in_lod[0];
     auto in_len = in->numel();
     auto in_data = in->data<T>();
     out->Resize({in_dims[0], win_size});
@@ -63,7 +63,7 @@ class SequenceEraseOpCUDAKernel : public framework::OpKernel<T> {
     auto* in = ctx.Input<LoDTensor>("X");
     auto* out = ctx.Output<LoDTensor>("Out");
 
-    auto lod = in->lod();
+    auto& lod = in->lod();
     PADDLE_ENFORCE_EQ(lod[lod.size() - 1].back(), (size_t)in->numel(),
                       "The actual size mismatches with the LoD information.");
     auto tokens = ctx.Attr<std::vector<int>>("tokens");
@@ -84,7 +84,7 @@ class SequenceEraseOpCUDAKernel : public framework::OpKernel<T> {
                            num_erased.begin() + 1);
 
     // Copy LoD to GPU
-    auto last_lod = lod[lod.size() - 1];
+    auto& last_lod = lod[lod.size() - 1];
     auto lod_len = last_lod.size();
     const size_t* dev_in_lod_ptr = last_lod.CUDAData(ctx.GetPlace());
     // Calc output LoD
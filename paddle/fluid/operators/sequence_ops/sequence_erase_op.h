@@ -27,7 +27,7 @@ class SequenceEraseKernel : public framework::OpKernel<T> {
     auto* in = ctx.Input<framework::LoDTensor>("X");
     auto* out = ctx.Output<framework::LoDTensor>("Out");
 
-    auto lod = in->lod();
+    auto& lod = in->lod();
     PADDLE_ENFORCE_EQ(
         lod.empty(), false,
         "Input(X) Tensor of SequenceEraseOp does not contain LoD information.");
@@ -36,7 +36,7 @@ class SequenceEraseKernel : public framework::OpKernel<T> {
     auto tokens = ctx.Attr<std::vector<int>>("tokens");
     auto in_len = in->numel();
     auto in_dat = in->data<T>();
-    auto last_lod = lod[lod.size() - 1];
+    auto& last_lod = lod[lod.size() - 1];
 
     std::vector<size_t> num_erased(in_len + 1, 0);
     std::vector<size_t> out_last_lod(1, 0);
@@ -13,11 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <cstring>
 #include <numeric>  // std::iota
+#include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/sequence_parallel.h"
 
 namespace paddle {
 namespace operators {
@@ -45,6 +48,21 @@ struct SequenceExpandGradFunctor {
       LoDTensor* dx);
 };
 
+// The offsets of the rows of the expanded sequences of Out, where the i-th
+// sequence of x_lod is repeated ref_lod[i + 1] - ref_lod[i] times.
+inline std::vector<size_t> GetExpandOffsets(
+    const framework::Vector<size_t>& x_lod,
+    const framework::Vector<size_t>& ref_lod) {
+  std::vector<size_t> offsets(ref_lod.size(), 0);
+  for (size_t i = 1; i < ref_lod.size(); ++i) {
+    offsets[i] = offsets[i - 1] +
+                 (ref_lod[i] - ref_lod[i - 1]) * (x_lod[i] - x_lod[i - 1]);
+  }
+  return offsets;
+}
+
+// The sequences are expanded in parallel by the chunks balanced by the rows
+// of Out, each repeat of a sequence being copied at once.
 template <typename T>
 struct SequenceExpandFunctor<platform::CPUDeviceContext, T> {
   void operator()(
@@ -52,31 +70,26 @@ struct SequenceExpandFunctor<platform::CPUDeviceContext, T> {
       const framework::Vector<size_t>& x_lod,   /*expand source lod*/
       const framework::Vector<size_t>& ref_lod, /*expand referenced lod*/
       LoDTensor* out) {
-    int out_offset = 0;
-    int x_item_length = x.numel() / x.dims()[0];
+    int64_t x_item_length = x.numel() / x.dims()[0];
     auto out_data = out->data<T>();
     auto x_data = x.data<T>();
-    for (size_t i = 1; i < ref_lod.size(); ++i) {
-      int repeat_num = ref_lod[i] - ref_lod[i - 1];
-      int x_start = x_lod[i - 1];
-      int x_end = x_lod[i];
-      int x_seq_len = x_end - x_start;
-      if (repeat_num > 0) {
-        int out_start = out_offset;
-        if (out->lod().size() == 1) {
-          out_start = out->lod()[0][out_offset];
-        }
-        for (int j = 0; j < repeat_num; j++) {
-          for (int k = 0; k < x_seq_len; k++) {
-            for (int l = 0; l < x_item_length; l++) {
-              out_data[(out_start + j * x_seq_len + k) * x_item_length + l] =
-                  x_data[(x_start + k) * x_item_length + l];
+    const size_t* x_starts = x_lod.data();
+    const size_t* ref_starts = ref_lod.data();
+    std::vector<size_t> out_offsets = GetExpandOffsets(x_lod, ref_lod);
+    math::ParallelForSequences(
+        out_offsets.data(), ref_lod.size() - 1, x_item_length,
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            size_t repeat_num = ref_starts[i + 1] - ref_starts[i];
+            size_t seq_numel = (x_starts[i + 1] - x_starts[i]) * x_item_length;
+            const T* x_seq = x_data + x_starts[i] * x_item_length;
+            T* out_seq = out_data + out_offsets[i] * x_item_length;
+            for (size_t j = 0; j < repeat_num; ++j) {
+              std::memcpy(out_seq + j * seq_numel, x_seq,
+                          seq_numel * sizeof(T));
             }
           }
-        }
-      }
-      out_offset += repeat_num;
-    }
+        });
   }
 };
 
@@ -150,6 +163,10 @@ class SequenceExpandKernel : public framework::OpKernel<T> {
  *    Grad(X).lod = Input(X).lod
  *
  * */
+// Each sequence of dx is the sum of its repeats in dout, which are added over
+// the whole contiguous sequence at once so that the loop is vectorized, and
+// the sequences are summed in parallel. The sequences of no repeat keep the
+// zero set by the kernel.
 template <typename T>
 struct SequenceExpandGradFunctor<platform::CPUDeviceContext, T> {
   void operator()(
@@ -157,24 +174,30 @@ struct SequenceExpandGradFunctor<platform::CPUDeviceContext, T> {
       const framework::Vector<size_t>& x_lod,   /*expand source lod*/
       const framework::Vector<size_t>& ref_lod, /*expand referenced lod*/
       LoDTensor* dx) {
-    int dout_offset = 0;
-    for (size_t i = 1; i < ref_lod.size(); ++i) {
-      int repeat_num = ref_lod[i] - ref_lod[i - 1];
-      if (repeat_num > 0) {
-        int x_start = x_lod[i - 1];
-        int x_end = x_lod[i];
-        int x_seq_len = x_end - x_start;
-        if (x_seq_len == 0) continue;
-        auto dx_sub = dx->Slice(x_start, x_end);
-        dx_sub.Resize(flatten_to_1d(dx_sub.dims()));
-        int dout_end = dout_offset + repeat_num * x_seq_len;
-        auto dout_sub = dout.Slice(dout_offset, dout_end);
-        dout_sub.Resize({repeat_num, dx_sub.dims()[0]});
-        math::ColwiseSum<platform::CPUDeviceContext, T> col_sum;
-        col_sum(context, dout_sub, &dx_sub);
-        dout_offset += repeat_num * x_seq_len;
-      }
-    }
+    int64_t x_item_length = dx->numel() / dx->dims()[0];
+    const T* dout_data = dout.data<T>();
+    T* dx_data = dx->data<T>();
+    const size_t* x_starts = x_lod.data();
+    const size_t* ref_starts = ref_lod.data();
+    std::vector<size_t> dout_offsets = GetExpandOffsets(x_lod, ref_lod);
+    math::ParallelForSequences(
+        dout_offsets.data(), ref_lod.size() - 1, x_item_length,
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            size_t repeat_num = ref_starts[i + 1] - ref_starts[i];
+            size_t seq_numel = (x_starts[i + 1] - x_starts[i]) * x_item_length;
+            if (repeat_num == 0 || seq_numel == 0) continue;
+            const T* dout_seq = dout_data + dout_offsets[i] * x_item_length;
+            T* dx_seq = dx_data + x_starts[i] * x_item_length;
+            std::memcpy(dx_seq, dout_seq, seq_numel * sizeof(T));
+            for (size_t j = 1; j < repeat_num; ++j) {
+              const T* dout_repeat = dout_seq + j * seq_numel;
+              for (size_t k = 0; k < seq_numel; ++k) {
+                dx_seq[k] += dout_repeat[k];
+              }
+            }
+          }
+        });
   }
 };
 
@@ -35,7 +35,7 @@ class SequencePoolKernel : public framework::OpKernel<T> {
     T pad_value = static_cast<T>(context.Attr<float>("pad_value"));
 
     auto dims = in->dims();
-    auto lod = in->lod();
+    auto& lod = in->lod();
     auto lod_level = lod.size();
     // InferShape by lod
     PADDLE_ENFORCE_GT(lod_level, 0, platform::errors::InvalidArgument(
@@ -48,7 +48,7 @@ class SequenceSliceOpKernel : public framework::OpKernel<T> {
     auto* length = ctx.Input<Tensor>("Length");
     auto* out = ctx.Output<LoDTensor>("Out");
 
-    auto lod = in->lod();
+    auto& lod = in->lod();
     PADDLE_ENFORCE_EQ(
         lod.empty(), false,
         "Input(X) Tensor of SequenceSliceOp does not contain LoD information.");
@@ -137,7 +137,7 @@ class SequenceSliceGradOpKernel : public framework::OpKernel<T> {
       length_data = length_cpu.data<int64_t>();
     }
 
-    auto lod = in->lod();
+    auto& lod = in->lod();
     // to avoid out_grad missing lod, compute lod again
     auto out_lod = SequenceSliceLoD(*in, offset_data, length_data);
 
@@ -93,7 +93,7 @@ class SequenceSoftmaxKernel : public framework::OpKernel<T> {
     auto *x = ctx.Input<LoDTensor>("X");
     auto *out = ctx.Output<LoDTensor>("Out");
 
-    auto lod = x->lod();
+    auto& lod = x->lod();
     auto dims = x->dims();
     PADDLE_ENFORCE_EQ(lod.empty(), false,
                       "Input(X) Tensor of SequenceSoftmaxOp does not contain "
@@ -131,7 +131,7 @@ class SequenceSoftmaxGradKernel : public framework::OpKernel<T> {
     }
 
     x_grad->set_lod(x->lod());
-    auto lod = x->lod();
+    auto& lod = x->lod();
     const size_t level = lod.size() - 1;
     x_grad->mutable_data<T>(ctx.GetPlace());
 
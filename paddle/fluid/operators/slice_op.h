@@ -17,11 +17,74 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/math_function.h"
 
 namespace paddle {
 namespace operators {
 using Tensor = framework::Tensor;
 
+// The minimum number of elements of the blocks that a strided slice is copied
+// by on the host, below which the Eigen slice is faster.
+constexpr int64_t kSliceMinBlockNumel = 256;
+
+// Splits the slice into the blocks that are contiguous in the input, i.e.,
+// the axes after the last sliced one are whole, each of block_numel elements.
+// block_offsets are the offsets of the blocks in the input, in the order of
+// the slice. Returns false when the slice is better copied by Eigen: on the
+// device each block costs a copy launch, so only a single block is copied
+// there, and on the host the blocks must not be too small.
+template <size_t D>
+inline bool SliceBlocks(const framework::DDim& in_dims,
+                        const framework::DDim& out_dims,
+                        const Eigen::array<int, D>& offsets, bool on_host,
+                        int64_t* block_numel,
+                        std::vector<int64_t>* block_offsets) {
+  int last_sliced = 0;
+  for (size_t i = 0; i < D; ++i) {
+    if (out_dims[i] != in_dims[i]) last_sliced = i;
+  }
+  *block_numel = 1;
+  for (size_t i = last_sliced; i < D; ++i) {
+    *block_numel *= out_dims[i];
+  }
+  int64_t num_blocks = 1;
+  for (int i = 0; i < last_sliced; ++i) {
+    num_blocks *= out_dims[i];
+  }
+  if (num_blocks > 1 && (!on_host || *block_numel < kSliceMinBlockNumel)) {
+    return false;
+  }
+
+  int64_t strides[D];
+  int64_t base = 0;
+  int64_t stride = 1;
+  for (int i = D - 1; i >= 0; --i) {
+    strides[i] = stride;
+    base += offsets[i] * stride;
+    stride *= in_dims[i];
+  }
+  block_offsets->assign(1, base);
+  block_offsets->reserve(num_blocks);
+  for (int i = 0; i < last_sliced; ++i) {
+    std::vector<int64_t> outer;
+    outer.reserve(num_blocks);
+    for (auto offset : *block_offsets) {
+      for (int64_t j = 0; j < out_dims[i]; ++j) {
+        outer.push_back(offset + j * strides[i]);
+      }
+    }
+    block_offsets->swap(outer);
+  }
+  return true;
+}
+
+// The view of numel elements from the offset of the tensor, sharing its data.
+inline Tensor FlatSlice(const Tensor& tensor, int64_t offset, int64_t numel) {
+  Tensor flat;
+  flat.ShareDataWith(tensor).Resize({tensor.numel()});
+  return flat.Slice(offset, offset + numel);
+}
+
 inline std::vector<int> get_new_data_from_tensorlist(
     const std::vector<const Tensor*>& list_new_data_tensor) {
   // get tensor from
@@ -217,6 +280,19 @@ class SliceKernel : public framework::OpKernel<T> {
       start = std::max(start, 0);
       offsets[axes[i]] = start;
     }
+    int64_t block_numel;
+    std::vector<int64_t> block_offsets;
+    if (SliceBlocks<D>(in_dims, new_out_dims, offsets,
+                       platform::is_cpu_place(context.GetPlace()),
+                       &block_numel, &block_offsets)) {
+      for (size_t i = 0; i < block_offsets.size(); ++i) {
+        Tensor out_block = FlatSlice(*out, i * block_numel, block_numel);
+        framework::TensorCopy(FlatSlice(*in, block_offsets[i], block_numel),
+                              context.GetPlace(), context.device_context(),
+                              &out_block);
+      }
+      return;
+    }
     auto in_t =
         framework::EigenTensor<T, D, Eigen::RowMajor, Eigen::DenseIndex>::From(
             *in);
@@ -332,6 +408,21 @@ class SliceGradKernel : public framework::OpKernel<T> {
       start = std::max(start, 0);
       offsets[axes[i]] = start;
     }
+    int64_t block_numel;
+    std::vector<int64_t> block_offsets;
+    if (SliceBlocks<D>(in_dims, out_dims, offsets,
+                       platform::is_cpu_place(context.GetPlace()),
+                       &block_numel, &block_offsets)) {
+      auto& dev_ctx = context.template device_context<DeviceContext>();
+      math::SetConstant<DeviceContext, T> set_zero;
+      set_zero(dev_ctx, d_input, static_cast<T>(0));
+      for (size_t i = 0; i < block_offsets.size(); ++i) {
+        Tensor d_in_block = FlatSlice(*d_input, block_offsets[i], block_numel);
+        framework::TensorCopy(FlatSlice(*d_out, i * block_numel, block_numel),
+                              context.GetPlace(), dev_ctx, &d_in_block);
+      }
+      return;
+    }
     Eigen::array<std::pair<int, int>, D> paddings;
     for (size_t i = 0; i < paddings.size(); ++i) {
       paddings[i].first = offsets[i];
@@ -196,12 +196,6 @@ class SyncBatchNormKernel : public framework::OpKernel<T> {
           saved_inv_variance->mutable_data<BatchNormParamType<T>>(
               ctx.GetPlace());
 
-      Tensor c_g_st;
-      auto *c_g_st_d = c_g_st.mutable_data<BatchNormParamType<T>>(
-          {2 * C + 1}, platform::CPUPlace());
-      auto gplace = boost::get<platform::CUDAPlace>(ctx.GetPlace());
-      memory::Copy(platform::CPUPlace(), c_g_st_d, gplace, stats, bytes, 0);
-
       int dtype = platform::ToNCCLDataType(mean_out->type());
       // In-place operation
       PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllReduce(
@@ -414,21 +408,36 @@ class SyncBatchNormGradKernel : public framework::OpKernel<T> {
                                          stats);
     }
     int dtype = platform::ToNCCLDataType(scale->type());
-    // In-place operation
+    // The stats are all reduced in place on the comm stream, which overlaps
+    // with the gradients of scale and bias, since they only depend on the
+    // local data.
+    dev_ctx.StreamWaitStream(platform::CUDAStreamType::kComm,
+                             platform::CUDAStreamType::kCompute);
     PADDLE_ENFORCE_CUDA_SUCCESS(platform::dynload::ncclAllReduce(
         stats, stats, 2 * C + 1, static_cast<ncclDataType_t>(dtype), ncclSum,
-        comm, stream));
+        comm, dev_ctx.stream(platform::CUDAStreamType::kComm)));
 
     const int block = 512;
     int grid2 = (std::min(x_numel, max_threads) + block - 1) / block;
-    if (layout == framework::DataLayout::kNCHW) {
-      if (d_scale && d_bias) {
+    if (d_scale && d_bias) {
+      if (layout == framework::DataLayout::kNCHW) {
         KeBNBackwardScaleBias<T, threads, framework::DataLayout::kNCHW>
             <<<grid, threads, 0, stream>>>(
                 dy_d, x_d, saved_mean, saved_inv_var, epsilon, N, C, fsize,
                 d_scale->data<BatchNormParamType<T>>(),
                 d_bias->data<BatchNormParamType<T>>());
+      } else {
+        KeBNBackwardScaleBias<T, threads, framework::DataLayout::kNHWC>
+            <<<grid, threads, 0, stream>>>(
+                dy_d, x_d, saved_mean, saved_inv_var, epsilon, N, C, fsize,
+                d_scale->data<BatchNormParamType<T>>(),
+                d_bias->data<BatchNormParamType<T>>());
       }
+    }
+    // the stats are used after the all reduce, and released after it too
+    dev_ctx.StreamWaitStream(platform::CUDAStreamType::kCompute,
+                             platform::CUDAStreamType::kComm);
+    if (layout == framework::DataLayout::kNCHW) {
       if (d_x) {
         KeBNBackwardData<T, framework::DataLayout::kNCHW>
             <<<grid2, block, 0, stream>>>(
@@ -437,13 +446,6 @@ class SyncBatchNormGradKernel : public framework::OpKernel<T> {
                 fsize, x->numel(), d_x->data<T>());
       }
     } else {
-      if (d_scale && d_bias) {
-        KeBNBackwardScaleBias<T, threads, framework::DataLayout::kNHWC>
-            <<<grid, threads, 0, stream>>>(
-                dy_d, x_d, saved_mean, saved_inv_var, epsilon, N, C, fsize,
-                d_scale->data<BatchNormParamType<T>>(),
-                d_bias->data<BatchNormParamType<T>>());
-      }
       if (d_x) {
         KeBNBackwardData<T, framework::DataLayout::kNHWC>
             <<<grid2, block, 0, stream>>>(
@@ -16,6 +16,7 @@
 
 #ifdef PADDLE_WITH_CUDA
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -220,7 +221,21 @@ class TensorRTEngineOp : public framework::OperatorBase {
       if (param_names_.count(x)) continue;
       num_inputs += 1;
     }
-    const int num_bindings = num_inputs + Outputs("Ys").size();
+    // In the dynamic shape mode, the optimization profile is selected by the
+    // input shapes, and the buffers have the bindings of all the profiles.
+    int profile = 0;
+    if (engine->with_dynamic_shape()) {
+      std::map<std::string, std::vector<int64_t>> input_shapes;
+      for (const auto &x : Inputs("Xs")) {
+        if (param_names_.count(x)) continue;
+        auto &t =
+            inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
+        input_shapes[x] = framework::vectorize<int64_t>(t.dims());
+      }
+      profile = engine->SelectProfile(input_shapes);
+    }
+    const int num_bindings =
+        (num_inputs + Outputs("Ys").size()) * engine->profile_num();
     std::vector<void *> buffers(num_bindings);
 
     // Bind input tensor to TRT.
@@ -231,7 +246,7 @@ class TensorRTEngineOp : public framework::OperatorBase {
           inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
       auto t_shape = framework::vectorize<int64_t>(t.dims());
       runtime_batch = t_shape[0];
-      const int bind_index = engine->engine()->getBindingIndex(x.c_str());
+      const int bind_index = engine->GetBindingIndex(x, profile);
       PADDLE_ENFORCE(bind_index < num_bindings,
                      "The bind index should be less than num_bindings");
       if (!engine->with_dynamic_shape()) {
@@ -247,7 +262,7 @@ class TensorRTEngineOp : public framework::OperatorBase {
         }
       } else {
 #if IS_TRT_VERSION_GE(6000)
-        auto *trt_context = engine->context();
+        auto *trt_context = engine->context(profile);
         trt_context->setBindingDimensions(
             bind_index, inference::tensorrt::Vec2TRT_Dims(t_shape, x, true));
 #endif
@@ -268,7 +283,7 @@ class TensorRTEngineOp : public framework::OperatorBase {
     VLOG(4) << "TensorRT Engine Op Outputs:";
     for (const auto &y : Outputs("Ys")) {
       const int bind_index =
-          engine->engine()->getBindingIndex(output_maps[output_index].c_str());
+          engine->GetBindingIndex(output_maps[output_index], profile);
       std::vector<int> ddim;
 
       if (!engine->with_dynamic_shape()) {
@@ -279,7 +294,7 @@ class TensorRTEngineOp : public framework::OperatorBase {
         }
       } else {
 #if IS_TRT_VERSION_GE(6000)
-        auto *trt_context = engine->context();
+        auto *trt_context = engine->context(profile);
         auto dims = trt_context->getBindingDimensions(bind_index);
         for (int i = 0; i < dims.nbDims; i++) ddim.push_back(dims.d[i]);
 #endif
@@ -316,7 +331,7 @@ class TensorRTEngineOp : public framework::OperatorBase {
             "nodes in the inconsistent subgraph.\n",
             runtime_batch, max_batch_size_));
     // Execute the engine.
-    engine->Execute(runtime_batch, &buffers, stream);
+    engine->Execute(runtime_batch, &buffers, stream, profile);
   }
 
   TensorRTEngine *GetEngine(const framework::Scope &scope,
@@ -0,0 +1,251 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <limits>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/unique_op.h"
+#include "paddle/fluid/platform/gpu_launch_param_config.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+template <typename T>
+static __global__ void UniqueFillIota(T* out, int num) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < num;
+       i += blockDim.x * gridDim.x) {
+    out[i] = static_cast<T>(i);
+  }
+}
+
+// heads[i] is 1 if sorted[i] starts a run of the equal values
+template <typename InT, typename IndexT>
+static __global__ void UniqueMarkHeads(const InT* sorted, IndexT* heads,
+                                       int num) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < num;
+       i += blockDim.x * gridDim.x) {
+    heads[i] = (i == 0 || sorted[i] != sorted[i - 1]) ? 1 : 0;
+  }
+}
+
+// Since the radix sort is stable, the first element of each run is the
+// first occurrence of the value.
+template <typename IndexT>
+static __global__ void UniqueGatherRuns(const IndexT* heads,
+                                        const IndexT* run_ids,
+                                        const IndexT* sorted_positions,
+                                        IndexT* run_firsts,
+                                        IndexT* run_starts, int num) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < num;
+       i += blockDim.x * gridDim.x) {
+    if (heads[i]) {
+      IndexT run = run_ids[i] - 1;
+      run_firsts[run] = sorted_positions[i];
+      run_starts[run] = static_cast<IndexT>(i);
+    }
+  }
+}
+
+template <typename InT, typename IndexT>
+static __global__ void UniqueWriteOut(const InT* sorted,
+                                      const IndexT* run_order,
+                                      const IndexT* run_starts, IndexT* ranks,
+                                      InT* out, IndexT* count, int num_runs,
+                                      int num) {
+  for (int k = blockIdx.x * blockDim.x + threadIdx.x; k < num_runs;
+       k += blockDim.x * gridDim.x) {
+    IndexT run = run_order[k];
+    IndexT start = run_starts[run];
+    ranks[run] = static_cast<IndexT>(k);
+    out[k] = sorted[start];
+    if (count != nullptr) {
+      IndexT end = run + 1 < num_runs ? run_starts[run + 1]
+                                      : static_cast<IndexT>(num);
+      count[k] = end - start;
+    }
+  }
+}
+
+template <typename IndexT>
+static __global__ void UniqueWriteIndex(const IndexT* run_ids,
+                                        const IndexT* sorted_positions,
+                                        const IndexT* ranks, IndexT* index,
+                                        int num) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < num;
+       i += blockDim.x * gridDim.x) {
+    index[sorted_positions[i]] = ranks[run_ids[i] - 1];
+  }
+}
+
+template <typename KeyT, typename ValueT>
+static void UniqueSortPairs(const platform::CUDADeviceContext& dev_ctx,
+                            const KeyT* keys_in, KeyT* keys_out,
+                            const ValueT* values_in, ValueT* values_out,
+                            int num, int end_bit = sizeof(KeyT) * 8) {
+  size_t temp_storage_bytes = 0;
+  auto err = cub::DeviceRadixSort::SortPairs(
+      nullptr, temp_storage_bytes, keys_in, keys_out, values_in, values_out,
+      num, 0, end_bit, dev_ctx.stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      err, "UniqueOp failed to get the temp storage of cub radix sort.");
+  Tensor temp_storage;
+  auto* temp = temp_storage.mutable_data<uint8_t>(dev_ctx.GetPlace(),
+                                                  temp_storage_bytes);
+  err = cub::DeviceRadixSort::SortPairs(temp, temp_storage_bytes, keys_in,
+                                        keys_out, values_in, values_out, num,
+                                        0, end_bit, dev_ctx.stream());
+  PADDLE_ENFORCE_CUDA_SUCCESS(err, "UniqueOp failed to run cub radix sort.");
+}
+
+/*
+ * Deduplicate on GPU by sorting: the values are radix sorted with their
+ * positions, the runs of the equal values are numbered by the prefix sum of
+ * the run heads, and the runs are sorted again by their first positions, so
+ * that the unique values are in the order of their first occurrences, as the
+ * CPU kernel does. Only the number of the unique values is copied to host,
+ * to allocate the outputs.
+ */
+template <typename InT, typename IndexT>
+void UniqueCUDA(const platform::CUDADeviceContext& dev_ctx, const Tensor& in,
+                Tensor* out, Tensor* index, Tensor* count) {
+  PADDLE_ENFORCE_LT(in.numel(), std::numeric_limits<int32_t>::max(),
+                    platform::errors::InvalidArgument(
+                        "The numel of the input of UniqueOp should be less "
+                        "than INT_MAX, but received %d.",
+                        in.numel()));
+  int num = static_cast<int>(in.numel());
+  auto place = dev_ctx.GetPlace();
+  auto stream = dev_ctx.stream();
+  IndexT* index_data = index->mutable_data<IndexT>(place);
+  if (num == 0) {
+    out->Resize(framework::make_ddim({0}));
+    out->mutable_data<InT>(place);
+    if (count != nullptr) {
+      count->Resize(framework::make_ddim({0}));
+      count->mutable_data<IndexT>(place);
+    }
+    return;
+  }
+  auto config = platform::GetGpuLaunchConfig1D(dev_ctx, num);
+  int grid = config.block_per_grid.x;
+  int threads = config.thread_per_block.x;
+
+  Tensor positions, sorted, sorted_positions, heads, run_ids;
+  auto dims = framework::make_ddim({num});
+  IndexT* positions_data = positions.mutable_data<IndexT>(dims, place);
+  InT* sorted_data = sorted.mutable_data<InT>(dims, place);
+  IndexT* sorted_positions_data =
+      sorted_positions.mutable_data<IndexT>(dims, place);
+  IndexT* heads_data = heads.mutable_data<IndexT>(dims, place);
+  IndexT* run_ids_data = run_ids.mutable_data<IndexT>(dims, place);
+
+  UniqueFillIota<IndexT><<<grid, threads, 0, stream>>>(positions_data, num);
+  UniqueSortPairs(dev_ctx, in.data<InT>(), sorted_data, positions_data,
+                  sorted_positions_data, num);
+  UniqueMarkHeads<InT, IndexT><<<grid, threads, 0, stream>>>(
+      sorted_data, heads_data, num);
+
+  size_t temp_storage_bytes = 0;
+  auto err = cub::DeviceScan::InclusiveSum(nullptr, temp_storage_bytes,
+                                           heads_data, run_ids_data, num,
+                                           stream);
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      err, "UniqueOp failed to get the temp storage of cub prefix sum.");
+  Tensor temp_storage;
+  auto* temp = temp_storage.mutable_data<uint8_t>(place, temp_storage_bytes);
+  err = cub::DeviceScan::InclusiveSum(temp, temp_storage_bytes, heads_data,
+                                      run_ids_data, num, stream);
+  PADDLE_ENFORCE_CUDA_SUCCESS(err, "UniqueOp failed to run cub prefix sum.");
+
+  IndexT num_runs_host = 0;
+  memory::Copy(platform::CPUPlace(), &num_runs_host,
+               boost::get<platform::CUDAPlace>(place), run_ids_data + num - 1,
+               sizeof(IndexT), stream);
+  dev_ctx.Wait();
+  int num_runs = static_cast<int>(num_runs_host);
+
+  Tensor run_firsts, run_starts, run_iota, sorted_firsts, run_order, ranks;
+  auto run_dims = framework::make_ddim({num_runs});
+  IndexT* run_firsts_data = run_firsts.mutable_data<IndexT>(run_dims, place);
+  IndexT* run_starts_data = run_starts.mutable_data<IndexT>(run_dims, place);
+  IndexT* run_iota_data = run_iota.mutable_data<IndexT>(run_dims, place);
+  IndexT* sorted_firsts_data =
+      sorted_firsts.mutable_data<IndexT>(run_dims, place);
+  IndexT* run_order_data = run_order.mutable_data<IndexT>(run_dims, place);
+  IndexT* ranks_data = ranks.mutable_data<IndexT>(run_dims, place);
+
+  UniqueGatherRuns<IndexT><<<grid, threads, 0, stream>>>(
+      heads_data, run_ids_data, sorted_positions_data, run_firsts_data,
+      run_starts_data, num);
+  auto run_config = platform::GetGpuLaunchConfig1D(dev_ctx, num_runs);
+  int run_grid = run_config.block_per_grid.x;
+  int run_threads = run_config.thread_per_block.x;
+  UniqueFillIota<IndexT><<<run_grid, run_threads, 0, stream>>>(run_iota_data,
+                                                               num_runs);
+  // the first positions are less than num, only the low bits are sorted
+  int end_bit = 1;
+  while (end_bit < static_cast<int>(sizeof(IndexT) * 8) - 1 &&
+         (static_cast<int64_t>(1) << end_bit) < num) {
+    ++end_bit;
+  }
+  UniqueSortPairs(dev_ctx, static_cast<const IndexT*>(run_firsts_data),
+                  sorted_firsts_data, static_cast<const IndexT*>(run_iota_data),
+                  run_order_data, num_runs, end_bit);
+
+  out->Resize(run_dims);
+  InT* out_data = out->mutable_data<InT>(place);
+  IndexT* count_data = nullptr;
+  if (count != nullptr) {
+    count->Resize(run_dims);
+    count_data = count->mutable_data<IndexT>(place);
+  }
+  UniqueWriteOut<InT, IndexT><<<run_grid, run_threads, 0, stream>>>(
+      sorted_data, run_order_data, run_starts_data, ranks_data, out_data,
+      count_data, num_runs, num);
+  UniqueWriteIndex<IndexT><<<grid, threads, 0, stream>>>(
+      run_ids_data, sorted_positions_data, ranks_data, index_data, num);
+}
+
+template <typename T>
+class UniqueCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto data_type = static_cast<framework::proto::VarType::Type>(
+        context.Attr<int>("dtype"));
+    auto* x = context.Input<framework::Tensor>("X");
+    auto* out = context.Output<framework::Tensor>("Out");
+    auto* index = context.Output<framework::Tensor>("Index");
+    // only unique_with_counts has the output Count
+    auto* count = context.HasOutput("Count")
+                      ? context.Output<framework::Tensor>("Count")
+                      : nullptr;
+    auto& dev_ctx = context.cuda_device_context();
+    if (data_type == framework::proto::VarType::INT32) {
+      UniqueCUDA<T, int32_t>(dev_ctx, *x, out, index, count);
+    } else if (data_type == framework::proto::VarType::INT64) {
+      UniqueCUDA<T, int64_t>(dev_ctx, *x, out, index, count);
+    } else {
+      PADDLE_THROW(platform::errors::InvalidArgument(
+          "The index of UniqueOp should be int32 or int64, but received %s.",
+          framework::DataTypeToString(data_type)));
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <cmath>
+#include <functional>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -23,6 +25,19 @@ limitations under the License. */
 namespace paddle {
 namespace operators {
 
+// With OpenMP, the inputs of at least kUniqueParallelNumel elements are
+// partitioned by the hash of the values, and the partitions are deduplicated
+// in parallel.
+constexpr int64_t kUniqueParallelNumel = 1 << 16;
+// 16 partitions, from the highest 4 bits of the mixed hash
+constexpr int kUniqueNumPartitions = 16;
+
+template <typename InT>
+inline int UniquePartitionOf(const InT& value) {
+  uint64_t hash = static_cast<uint64_t>(std::hash<InT>()(value));
+  return static_cast<int>((hash * 0x9E3779B97F4A7C15ULL) >> 60);
+}
+
 template <typename InT>
 struct UniqueOpFunctor {
   framework::Tensor* out_;
@@ -39,34 +54,101 @@ struct UniqueOpFunctor {
   void apply() const {
     auto* in_data = in_->data<InT>();
     auto* index_data = index_->mutable_data<IndexT>(platform::CPUPlace());
+    int64_t numel = in_->numel();
 
-    int64_t j = 0;
+    PADDLE_ENFORCE(numel < pow(2, 31),
+                   "numel of Unique op input should less than INT_MAX");
 
-    // TODO(fangzeyang): Should optimize performance here.
-    std::unordered_map<InT, int64_t> dict;
-    std::vector<InT> uniq;
+#ifdef PADDLE_WITH_MKLML
+    int num_partitions =
+        numel < kUniqueParallelNumel ? 1 : kUniqueNumPartitions;
+#else
+    int num_partitions = 1;
+#endif
+    std::vector<uint8_t> partitions;
+    // the ids of the elements in the unique values of their partitions
+    std::vector<int32_t> local_index;
+    if (num_partitions > 1) {
+      partitions.resize(numel);
+      local_index.resize(numel);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int64_t i = 0; i < numel; ++i) {
+        partitions[i] = static_cast<uint8_t>(UniquePartitionOf(in_data[i]));
+      }
+    }
 
-    PADDLE_ENFORCE(in_->numel() < pow(2, 31),
-                   "numel of Unique op input should less than INT_MAX");
+    // the unique values of the partitions in the order of their first
+    // occurrences, with the positions of the first occurrences and the counts
+    std::vector<std::vector<InT>> uniq(num_partitions);
+    std::vector<std::vector<int64_t>> firsts(num_partitions);
+    std::vector<std::vector<int64_t>> counts(num_partitions);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int p = 0; p < num_partitions; ++p) {
+      std::unordered_map<InT, int64_t> dict;
+      for (int64_t i = 0; i < numel; ++i) {
+        if (num_partitions > 1 && partitions[i] != p) continue;
+        int64_t j;
+        auto it = dict.find(in_data[i]);
+        if (it == dict.end()) {
+          j = static_cast<int64_t>(uniq[p].size());
+          dict.emplace(std::make_pair(in_data[i], j));
+          uniq[p].emplace_back(in_data[i]);
+          firsts[p].emplace_back(i);
+          counts[p].emplace_back(1);
+        } else {
+          j = it->second;
+          ++counts[p][j];
+        }
+        if (num_partitions > 1) {
+          local_index[i] = static_cast<int32_t>(j);
+        } else {
+          index_data[i] = static_cast<IndexT>(j);
+        }
+      }
+    }
 
-    for (auto i = 0; i < in_->numel(); i++) {
-      auto it = dict.find(in_data[i]);
-      if (it == dict.end()) {
-        dict.emplace(std::make_pair(in_data[i], j));
-        uniq.emplace_back(in_data[i]);
-        index_data[i] = static_cast<IndexT>(j);
-        j++;
-      } else {
-        index_data[i] = static_cast<IndexT>(it->second);
+    std::vector<InT> out_values;
+    std::vector<int64_t> out_counts;
+    if (num_partitions == 1) {
+      out_values.swap(uniq[0]);
+      out_counts.swap(counts[0]);
+    } else {
+      // merge the partitions by the positions of the first occurrences
+      std::vector<std::pair<int64_t, int>> order;
+      for (int p = 0; p < num_partitions; ++p) {
+        for (int64_t first : firsts[p]) {
+          order.emplace_back(first, p);
+        }
+      }
+      std::sort(order.begin(), order.end());
+      std::vector<std::vector<int64_t>> ids(num_partitions);
+      out_values.reserve(order.size());
+      out_counts.reserve(order.size());
+      for (size_t j = 0; j < order.size(); ++j) {
+        int p = order[j].second;
+        size_t local = ids[p].size();
+        ids[p].emplace_back(static_cast<int64_t>(j));
+        out_values.emplace_back(uniq[p][local]);
+        out_counts.emplace_back(counts[p][local]);
+      }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int64_t i = 0; i < numel; ++i) {
+        index_data[i] =
+            static_cast<IndexT>(ids[partitions[i]][local_index[i]]);
       }
     }
+    int64_t num_uniq = static_cast<int64_t>(out_values.size());
 
     if (count_ != nullptr) {
       // Resize the count tensor dims to allocate the memory
-      count_->Resize(framework::make_ddim({static_cast<int64_t>(uniq.size())}));
+      count_->Resize(framework::make_ddim({num_uniq}));
       IndexT* count_data = count_->mutable_data<IndexT>(platform::CPUPlace());
-      // init count_data to 0
-      memset(count_data, 0, uniq.size() * sizeof(IndexT));
 
       const auto& index_type = index_->type();
       bool index_type_match = index_type == framework::proto::VarType::INT32 ||
@@ -79,22 +161,14 @@ struct UniqueOpFunctor {
           paddle::framework::DataTypeToString(
               framework::proto::VarType::INT64));
 
-      if (index_type == framework::proto::VarType::INT32) {
-        for (auto i = 0; i < in_->numel(); ++i) {
-          const IndexT& index = index_data[i];
-          count_data[static_cast<int32_t>(index)] += static_cast<IndexT>(1);
-        }
-      } else {
-        for (auto i = 0; i < in_->numel(); ++i) {
-          const IndexT& index = index_data[i];
-          count_data[static_cast<int64_t>(index)] += static_cast<IndexT>(1);
-        }
+      for (int64_t j = 0; j < num_uniq; ++j) {
+        count_data[j] = static_cast<IndexT>(out_counts[j]);
       }
     }
 
-    out_->Resize(framework::make_ddim({static_cast<int64_t>(uniq.size())}));
+    out_->Resize(framework::make_ddim({num_uniq}));
     auto out_data = out_->mutable_data<InT>(platform::CPUPlace());
-    std::memcpy(out_data, uniq.data(), uniq.size() * sizeof(InT));
+    std::memcpy(out_data, out_values.data(), num_uniq * sizeof(InT));
   }
 };
 
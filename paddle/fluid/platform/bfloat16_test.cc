@@ -0,0 +1,120 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+#include "paddle/fluid/platform/bfloat16.h"
+
+#include <vector>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES  // msvc conflict logging with windows.h
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(bfloat16, conversion_cpu) {
+  // Conversion from float
+  EXPECT_EQ(bfloat16(1.0f).x, 0x3f80);
+  EXPECT_EQ(bfloat16(0.5f).x, 0x3f00);
+  EXPECT_EQ(bfloat16(0.33333f).x, 0x3eab);
+  EXPECT_EQ(bfloat16(0.0f).x, 0x0000);
+  EXPECT_EQ(bfloat16(-0.0f).x, 0x8000);
+  EXPECT_EQ(bfloat16(3.40282347e+38f).x, 0x7f80);
+
+  // Round to the nearest even
+  EXPECT_EQ(bfloat16(1.00390625f).x, 0x3f80);
+  EXPECT_EQ(bfloat16(1.01171875f).x, 0x3f82);
+  EXPECT_EQ(bfloat16(1.0040f).x, 0x3f81);
+
+  // Conversion from double, int and bool
+  EXPECT_EQ(bfloat16(0.5).x, 0x3f00);
+  EXPECT_EQ(bfloat16(-1).x, 0xbf80);
+  EXPECT_EQ(bfloat16(3).x, 0x4040);
+  EXPECT_EQ(bfloat16(true).x, 0x3f80);
+  EXPECT_EQ(bfloat16(false).x, 0x0000);
+
+  // Assignment operator
+  bfloat16 v_assign;
+  v_assign = 0.5f;
+  EXPECT_EQ(v_assign.x, 0x3f00);
+  v_assign = -1;
+  EXPECT_EQ(v_assign.x, 0xbf80);
+  v_assign = true;
+  EXPECT_EQ(v_assign.x, 0x3f80);
+
+  // Conversion operator
+  EXPECT_EQ(static_cast<float>(bfloat16(0.5f)), 0.5f);
+  EXPECT_NEAR(static_cast<double>(bfloat16(0.33333)), 0.33333, 0.001);
+  EXPECT_EQ(static_cast<int>(bfloat16(-1)), -1);
+  EXPECT_EQ(static_cast<bool>(bfloat16(true)), true);
+}
+
+TEST(bfloat16, arithmetic_cpu) {
+  EXPECT_EQ(static_cast<float>(bfloat16(1) + bfloat16(1)), 2);
+  EXPECT_EQ(static_cast<float>(bfloat16(5) + bfloat16(-5)), 0);
+  EXPECT_EQ(static_cast<float>(bfloat16(3) - bfloat16(5)), -2);
+  EXPECT_NEAR(static_cast<float>(bfloat16(3.3f) * bfloat16(2.0f)), 6.6f, 0.05);
+  EXPECT_NEAR(static_cast<float>(bfloat16(2.0f) / bfloat16(3.0f)), 0.66667f,
+              0.005);
+  EXPECT_EQ(static_cast<float>(-bfloat16(512.0f)), -512.0f);
+
+  bfloat16 a(1.0f);
+  a += bfloat16(2.0f);
+  a *= bfloat16(4.0f);
+  EXPECT_EQ(static_cast<float>(a), 12.0f);
+}
+
+TEST(bfloat16, comparison_cpu) {
+  EXPECT_TRUE(bfloat16(1.0f) == bfloat16(1.0f));
+  EXPECT_TRUE(bfloat16(1.0f) != bfloat16(0.5f));
+  EXPECT_TRUE(bfloat16(1.0f) < bfloat16(2.0f));
+  EXPECT_TRUE(bfloat16(2.0f) >= bfloat16(2.0f));
+  EXPECT_TRUE(bfloat16(0.0f) == bfloat16(-0.0f));
+  EXPECT_FALSE(bfloat16(NAN) == bfloat16(NAN));
+}
+
+TEST(bfloat16, special_values) {
+  EXPECT_TRUE(std::isinf(bfloat16(INFINITY)));
+  EXPECT_TRUE(std::isnan(bfloat16(NAN)));
+  // the NaN whose payload is only in the truncated bits is kept
+  float nan;
+  uint32_t bits = 0x7f800001;
+  memcpy(&nan, &bits, sizeof(nan));
+  EXPECT_TRUE(std::isnan(bfloat16(nan)));
+  EXPECT_TRUE(isfinite(bfloat16(1.0f)));
+
+  EXPECT_EQ(std::numeric_limits<bfloat16>::max().x, 0x7f7f);
+  EXPECT_EQ(std::numeric_limits<bfloat16>::lowest().x, 0xff7f);
+  EXPECT_EQ(std::numeric_limits<bfloat16>::epsilon().x, 0x3c00);
+  EXPECT_TRUE(std::is_floating_point<bfloat16>::value);
+  EXPECT_EQ(sizeof(bfloat16), 2UL);
+}
+
+TEST(bfloat16, lod_tensor_cpu) {
+  framework::LoDTensor lod_tensor;
+  lod_tensor.Resize({4, 1});
+  lod_tensor.set_lod(framework::LoD({{0, 2, 4}}));
+  bfloat16* data_ptr = lod_tensor.mutable_data<bfloat16>(CPUPlace());
+  EXPECT_EQ(lod_tensor.type(), framework::proto::VarType::BF16);
+  EXPECT_EQ(framework::SizeOfType(framework::proto::VarType::BF16), 2UL);
+
+  std::vector<float> input_data = {1.0f, 0.5f, 0.33333f, 0.0f};
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    data_ptr[i] = input_data[i];
+  }
+  auto x = framework::EigenVector<bfloat16>::Flatten(lod_tensor);
+  Eigen::Tensor<bfloat16, 0, Eigen::RowMajor> sum = x.sum();
+  EXPECT_NEAR(static_cast<float>(sum(0)), 1.83333f, 0.01);
+}
+
+}  // namespace platform
+}  // namespace paddle
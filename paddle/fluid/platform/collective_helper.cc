@@ -107,6 +107,8 @@ NCCLComm* NCCLCommContext::AssignNCCLComm(ncclComm_t comm, int nranks, int rank,
                                           int dev_id, int ring_id) {
   std::unique_ptr<CUDADeviceContext> dev_ctx(
       new CUDADeviceContext(CUDAPlace(dev_id)));
+  // the collectives are on the critical path, and preempt the bulk copies
+  dev_ctx->ResetDefaultContext(stream::Priority::HIGH);
 
   NCCLCommImpl* c = new NCCLCommImpl;
   c->set_ring_id(ring_id);
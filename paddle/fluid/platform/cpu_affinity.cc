@@ -0,0 +1,318 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/cpu_affinity.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <set>
+#include <sstream>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+#include "paddle/fluid/platform/numa.h"
+
+DECLARE_string(cpu_thread_partition);
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+constexpr int kNumCpuPools = static_cast<int>(CpuPool::kNone);
+using CpuPools = std::array<std::vector<int>, kNumCpuPools>;
+
+struct CpuPartitionState {
+  std::mutex mu;
+  std::string spec;
+  CpuPools pools;
+  // The CPUs the process is allowed to run on when the partition is set
+  // first, which the threads are bound back to when it is cleared.
+  std::vector<int> process_cpus;
+};
+
+CpuPartitionState &GetState() {
+  static CpuPartitionState state;
+  return state;
+}
+
+// The threads rebind themselves when the generation changes, i.e. the
+// partition is set again.
+std::atomic<uint64_t> g_generation{0};
+std::once_flag g_init_flag;
+
+struct ThreadBinding {
+  uint64_t generation{0};
+  CpuPool pool{CpuPool::kNone};
+  bool bound{false};
+};
+
+thread_local ThreadBinding thread_binding;
+
+// The binding of the OpenMP team of the thread, for the number of threads.
+struct OpenMPBinding {
+  uint64_t generation{0};
+  int num_threads{0};
+  bool bound{false};
+};
+
+thread_local OpenMPBinding omp_binding;
+
+std::vector<int> GetProcessCpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &mask)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return cpus;
+}
+
+bool SetThreadAffinity(const std::vector<int> &cpus) {
+#ifdef __linux__
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &mask);
+    }
+  }
+  return !cpus.empty() && sched_setaffinity(0, sizeof(mask), &mask) == 0;
+#else
+  return false;
+#endif
+}
+
+std::string Trim(const std::string &str) {
+  auto begin = str.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  auto end = str.find_last_not_of(" \t");
+  return str.substr(begin, end - begin + 1);
+}
+
+CpuPools ParsePartition(const std::string &spec,
+                        const std::vector<int> &process_cpus) {
+  CpuPools pools;
+  std::set<int> used;
+  std::istringstream sin(spec);
+  std::string item;
+  while (std::getline(sin, item, ';')) {
+    item = Trim(item);
+    if (item.empty()) {
+      continue;
+    }
+    auto pos = item.find('=');
+    PADDLE_ENFORCE_NE(pos, std::string::npos,
+                      platform::errors::InvalidArgument(
+                          "The item %s of the CPU thread partition should be "
+                          "like pool=cpulist.",
+                          item));
+    std::string name = Trim(item.substr(0, pos));
+    int pool = 0;
+    while (pool < kNumCpuPools &&
+           name != CpuPoolName(static_cast<CpuPool>(pool))) {
+      ++pool;
+    }
+    PADDLE_ENFORCE_LT(pool, kNumCpuPools,
+                      platform::errors::InvalidArgument(
+                          "The pool of the CPU thread partition should be "
+                          "compute, io or comm, but received %s.",
+                          name));
+    PADDLE_ENFORCE_EQ(pools[pool].empty(), true,
+                      platform::errors::InvalidArgument(
+                          "The pool %s is given more than once in the CPU "
+                          "thread partition.",
+                          name));
+    std::vector<int> cpus;
+    PADDLE_ENFORCE_EQ(
+        ParseCpuList(item.substr(pos + 1), &cpus) && !cpus.empty(), true,
+        platform::errors::InvalidArgument(
+            "The CPUs of the pool %s should be a cpulist like 0-3,8-11, but "
+            "received %s.",
+            name, item.substr(pos + 1)));
+    for (int cpu : cpus) {
+      PADDLE_ENFORCE_EQ(used.insert(cpu).second, true,
+                        platform::errors::InvalidArgument(
+                            "CPU %d is in more than one pool of the CPU "
+                            "thread partition.",
+                            cpu));
+      // The affinity is unknown on the other systems.
+      PADDLE_ENFORCE_EQ(
+          process_cpus.empty() ||
+              std::binary_search(process_cpus.begin(), process_cpus.end(),
+                                 cpu),
+          true, platform::errors::InvalidArgument(
+                    "CPU %d of the pool %s is not in the affinity of the "
+                    "process.",
+                    cpu, name));
+    }
+    pools[pool] = std::move(cpus);
+  }
+  return pools;
+}
+
+void SetPartitionLocked(CpuPartitionState *state, const std::string &spec) {
+  if (state->process_cpus.empty()) {
+    state->process_cpus = GetProcessCpus();
+  }
+  auto pools = ParsePartition(spec, state->process_cpus);
+  state->spec = spec;
+  state->pools = std::move(pools);
+  g_generation.fetch_add(1, std::memory_order_release);
+  VLOG(1) << "Set the CPU thread partition to \"" << spec << "\"";
+}
+
+void InitFromFlags() {
+  std::call_once(g_init_flag, [] {
+    if (!FLAGS_cpu_thread_partition.empty()) {
+      auto &state = GetState();
+      std::lock_guard<std::mutex> guard(state.mu);
+      SetPartitionLocked(&state, FLAGS_cpu_thread_partition);
+    }
+  });
+}
+
+}  // namespace
+
+const char *CpuPoolName(CpuPool pool) {
+  switch (pool) {
+    case CpuPool::kCompute:
+      return "compute";
+    case CpuPool::kIO:
+      return "io";
+    case CpuPool::kComm:
+      return "comm";
+    default:
+      return "none";
+  }
+}
+
+void SetCpuThreadPartition(const std::string &spec) {
+  InitFromFlags();
+  auto &state = GetState();
+  std::lock_guard<std::mutex> guard(state.mu);
+  if (spec != state.spec) {
+    SetPartitionLocked(&state, spec);
+  }
+}
+
+std::string GetCpuThreadPartition() {
+  InitFromFlags();
+  auto &state = GetState();
+  std::lock_guard<std::mutex> guard(state.mu);
+  return state.spec;
+}
+
+std::vector<int> GetCpuPoolCpus(CpuPool pool) {
+  if (pool == CpuPool::kNone) {
+    return {};
+  }
+  InitFromFlags();
+  auto &state = GetState();
+  std::lock_guard<std::mutex> guard(state.mu);
+  return state.pools[static_cast<int>(pool)];
+}
+
+bool BindThreadToCpuPool(CpuPool pool) {
+  if (pool == CpuPool::kNone) {
+    return false;
+  }
+  InitFromFlags();
+  uint64_t generation = g_generation.load(std::memory_order_acquire);
+  if (thread_binding.generation == generation && thread_binding.pool == pool) {
+    return thread_binding.bound;
+  }
+  std::vector<int> cpus;
+  {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> guard(state.mu);
+    cpus = state.pools[static_cast<int>(pool)];
+    if (cpus.empty() && thread_binding.bound) {
+      // Unbinds the thread bound by the previous partition.
+      SetThreadAffinity(state.process_cpus);
+    }
+  }
+  bool bound = !cpus.empty() && SetThreadAffinity(cpus);
+  if (!cpus.empty() && !bound) {
+    LOG(WARNING) << "Failed to bind the thread to the " << CpuPoolName(pool)
+                 << " CPU pool";
+  }
+  thread_binding.generation = generation;
+  thread_binding.pool = pool;
+  thread_binding.bound = bound;
+  return bound;
+}
+
+bool BindOpenMPThreadsToCpuPool() {
+#ifdef _OPENMP
+  InitFromFlags();
+  uint64_t generation = g_generation.load(std::memory_order_acquire);
+  int num_threads = omp_get_max_threads();
+  if (omp_binding.generation == generation &&
+      omp_binding.num_threads == num_threads) {
+    return omp_binding.bound;
+  }
+  omp_binding.generation = generation;
+  omp_binding.num_threads = num_threads;
+  omp_binding.bound = false;
+  // A single thread is bound to the pool by BindThreadToCpuPool instead of a
+  // CPU, so that the concurrent single-threaded callers are not stacked on
+  // the first CPU.
+  auto cpus = GetCpuPoolCpus(CpuPool::kCompute);
+  if (cpus.empty() || num_threads <= 1) {
+    return false;
+  }
+  std::atomic<bool> bound{true};
+#pragma omp parallel num_threads(num_threads)
+  {
+    int cpu = cpus[omp_get_thread_num() % cpus.size()];
+    if (!SetThreadAffinity({cpu})) {
+      bound = false;
+    }
+  }
+  if (!bound) {
+    LOG(WARNING) << "Failed to bind the OpenMP threads to the compute CPU "
+                    "pool";
+  }
+  // The calling thread is the thread 0 of the team, which is bound to a CPU.
+  thread_binding.generation = generation;
+  thread_binding.pool = CpuPool::kCompute;
+  thread_binding.bound = bound;
+  omp_binding.bound = bound;
+  return bound;
+#else
+  return false;
+#endif
+}
+
+}  // namespace platform
+}  // namespace paddle
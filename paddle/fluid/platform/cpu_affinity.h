@@ -0,0 +1,69 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+// The CPUs of the process can be partitioned by the kinds of the threads, so
+// that e.g. the reader and the RPC threads do not preempt the compute
+// threads and evict their caches. The partition is given by a spec like
+// "compute=0-11;io=12-13;comm=14-15", each pool with a cpulist of Linux. The
+// threads of a pool not in the spec are not bound, and nothing is bound if
+// there is no partition, which is the default.
+//
+// The threads bind themselves to their pools when they start, or when they
+// run a task, which costs nothing once the thread is bound until the
+// partition changes.
+
+enum class CpuPool {
+  kCompute = 0,
+  kIO = 1,
+  kComm = 2,
+  // The threads are not bound.
+  kNone = 3,
+};
+
+const char *CpuPoolName(CpuPool pool);
+
+//! Set the partition of the CPUs by the spec, an empty spec clears it. The
+//! pools should be disjoint, and the CPUs in the affinity of the process.
+//! The threads already bound are bound again when they call
+//! BindThreadToCpuPool next time. Setting the same spec again does nothing.
+void SetCpuThreadPartition(const std::string &spec);
+
+//! Get the spec of the current partition, which is FLAGS_cpu_thread_partition
+//! if it is not set by SetCpuThreadPartition.
+std::string GetCpuThreadPartition();
+
+//! Get the CPUs of the pool, empty if the pool is not partitioned.
+std::vector<int> GetCpuPoolCpus(CpuPool pool);
+
+//! Bind the current thread to the CPUs of the pool. Returns false if the pool
+//! is not partitioned or the thread can not be bound.
+bool BindThreadToCpuPool(CpuPool pool);
+
+//! Bind the OpenMP threads of the current thread one per CPU of the compute
+//! pool in order, e.g. the threads of the CPU math library, the current
+//! thread to the first CPU. Returns false if the compute pool is not
+//! partitioned, there is only one OpenMP thread, or it is not built with
+//! OpenMP.
+bool BindOpenMPThreadsToCpuPool();
+
+}  // namespace platform
+}  // namespace paddle
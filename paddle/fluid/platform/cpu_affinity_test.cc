@@ -0,0 +1,90 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/cpu_affinity.h"
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/numa.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(CpuAffinity, ParseCpuList) {
+  std::vector<int> cpus;
+  ASSERT_TRUE(ParseCpuList("0-2,5,7-8\n", &cpus));
+  ASSERT_EQ(cpus, std::vector<int>({0, 1, 2, 5, 7, 8}));
+  cpus.clear();
+  ASSERT_FALSE(ParseCpuList("3-1", &cpus));
+  ASSERT_FALSE(ParseCpuList("a", &cpus));
+}
+
+TEST(CpuAffinity, Partition) {
+  ASSERT_TRUE(GetCpuPoolCpus(CpuPool::kCompute).empty());
+  ASSERT_FALSE(BindThreadToCpuPool(CpuPool::kCompute));
+
+  ASSERT_THROW(SetCpuThreadPartition("compute=0;gpu=1"),
+               platform::EnforceNotMet);
+  ASSERT_THROW(SetCpuThreadPartition("compute=0;io=0"),
+               platform::EnforceNotMet);
+  ASSERT_THROW(SetCpuThreadPartition("compute=0-"), platform::EnforceNotMet);
+  ASSERT_THROW(SetCpuThreadPartition("compute=100000"),
+               platform::EnforceNotMet);
+  ASSERT_EQ(GetCpuThreadPartition(), "");
+
+#ifdef __linux__
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &mask)) {
+    ++cpu;
+  }
+  int num_cpus = CPU_COUNT(&mask);
+  std::string spec = "compute=" + std::to_string(cpu);
+  SetCpuThreadPartition(spec);
+  ASSERT_EQ(GetCpuThreadPartition(), spec);
+  ASSERT_EQ(GetCpuPoolCpus(CpuPool::kCompute), std::vector<int>({cpu}));
+  ASSERT_TRUE(GetCpuPoolCpus(CpuPool::kIO).empty());
+
+  std::thread thread([cpu, num_cpus] {
+    // the io pool is not partitioned
+    ASSERT_FALSE(BindThreadToCpuPool(CpuPool::kIO));
+    ASSERT_TRUE(BindThreadToCpuPool(CpuPool::kCompute));
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    ASSERT_EQ(CPU_COUNT(&mask), 1);
+    ASSERT_TRUE(CPU_ISSET(cpu, &mask));
+
+    // the thread is unbound when the partition is cleared
+    SetCpuThreadPartition("");
+    ASSERT_FALSE(BindThreadToCpuPool(CpuPool::kCompute));
+    CPU_ZERO(&mask);
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    ASSERT_EQ(CPU_COUNT(&mask), num_cpus);
+  });
+  thread.join();
+  ASSERT_TRUE(GetCpuPoolCpus(CpuPool::kCompute).empty());
+#endif
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,121 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/cuda_graph.h"
+#include <glog/logging.h>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+// not enforced, the destructor must not throw
+CUDAGraph::~CUDAGraph() {
+#if CUDA_VERSION >= 10010
+  if (capturing_) {
+    cudaGraph_t graph = nullptr;
+    cudaStreamEndCapture(stream_, &graph);
+    if (graph != nullptr) {
+      cudaGraphDestroy(graph);
+    }
+  }
+  if (exec_graph_ != nullptr) {
+    cudaGraphExecDestroy(exec_graph_);
+  }
+  if (graph_ != nullptr) {
+    cudaGraphDestroy(graph_);
+  }
+#endif
+}
+
+bool CUDAGraph::IsSupported() {
+#if CUDA_VERSION >= 10010
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CUDAGraph::BeginCapture(cudaStream_t stream) {
+  PADDLE_ENFORCE_EQ(IsCapturing() || IsCaptured(), false,
+                    platform::errors::PreconditionNotMet(
+                        "The CUDA graph is captured already, call Reset() "
+                        "before capturing again."));
+#if CUDA_VERSION >= 10010
+  // the relaxed mode allows the other threads to call the unsafe APIs, e.g.
+  // cudaMalloc, while capturing
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaStreamBeginCapture(stream, cudaStreamCaptureModeRelaxed));
+  capturing_ = true;
+  stream_ = stream;
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "CUDA graph requires CUDA 10.1 or later, but the version is %d.",
+      CUDA_VERSION));
+#endif
+}
+
+bool CUDAGraph::EndCapture() {
+  PADDLE_ENFORCE_EQ(
+      IsCapturing(), true,
+      platform::errors::PreconditionNotMet("The CUDA graph is not capturing."));
+#if CUDA_VERSION >= 10010
+  capturing_ = false;
+  auto result = cudaStreamEndCapture(stream_, &graph_);
+  if (result != cudaSuccess || graph_ == nullptr) {
+    // clear the error state of the failed capture
+    cudaGetLastError();
+    VLOG(3) << "CUDA graph capture fails: " << cudaGetErrorString(result);
+    Reset();
+    return false;
+  }
+  result = cudaGraphInstantiate(&exec_graph_, graph_, nullptr, nullptr, 0);
+  if (result != cudaSuccess) {
+    cudaGetLastError();
+    VLOG(3) << "CUDA graph instantiation fails: "
+            << cudaGetErrorString(result);
+    exec_graph_ = nullptr;
+    Reset();
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CUDAGraph::Replay() {
+  PADDLE_ENFORCE_EQ(
+      IsCaptured(), true,
+      platform::errors::PreconditionNotMet("The CUDA graph is not captured."));
+#if CUDA_VERSION >= 10010
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaGraphLaunch(exec_graph_, stream_));
+#endif
+}
+
+void CUDAGraph::Reset() {
+#if CUDA_VERSION >= 10010
+  if (exec_graph_ != nullptr) {
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaGraphExecDestroy(exec_graph_));
+    exec_graph_ = nullptr;
+  }
+  if (graph_ != nullptr) {
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaGraphDestroy(graph_));
+    graph_ = nullptr;
+  }
+#endif
+  stream_ = nullptr;
+}
+
+}  // namespace platform
+}  // namespace paddle
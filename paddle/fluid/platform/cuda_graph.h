@@ -0,0 +1,70 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace platform {
+
+/**
+ * CUDAGraph records the kernels launched on a stream between BeginCapture()
+ * and EndCapture() as a CUDA graph, and launches all of them by one call in
+ * Replay(), which saves the launch overhead of the small kernels.
+ *
+ * The replayed kernels use the same arguments as captured, so the memory
+ * they use must be kept and the inputs must be written to the same address
+ * before each replay. The host code between the launches is not recorded.
+ * It requires CUDA 10.1 or later.
+ */
+class CUDAGraph {
+ public:
+  CUDAGraph() = default;
+
+  ~CUDAGraph();
+
+  static bool IsSupported();
+
+  void BeginCapture(cudaStream_t stream);
+
+  // Return false if the capture is invalidated, e.g. by an operation not
+  // allowed during capturing, and the graph is discarded.
+  bool EndCapture();
+
+  void Replay();
+
+  void Reset();
+
+  bool IsCapturing() const { return capturing_; }
+
+  bool IsCaptured() const { return exec_graph_ != nullptr; }
+
+ private:
+  bool capturing_{false};
+  cudaStream_t stream_{nullptr};
+#if CUDA_VERSION >= 10010
+  cudaGraph_t graph_{nullptr};
+  cudaGraphExec_t exec_graph_{nullptr};
+#else
+  void *exec_graph_{nullptr};
+#endif
+
+  DISABLE_COPY_AND_ASSIGN(CUDAGraph);
+};
+
+}  // namespace platform
+}  // namespace paddle
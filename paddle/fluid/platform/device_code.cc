@@ -14,13 +14,29 @@ limitations under the License. */
 
 #include "paddle/fluid/platform/device_code.h"
 #include <sys/stat.h>
+#include <unistd.h>
+#include <xxhash.h>
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <set>
+#include <sstream>
 #include <utility>
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/port.h"
 
 DECLARE_string(cuda_dir);
 
+DEFINE_string(fusion_group_kernel_cache_dir, "",
+              "The directory to cache the PTX of the CUDA kernels compiled "
+              "at runtime by NVRTC, e.g. the ones generated by "
+              "fusion_group_pass, keyed by the source, the compute "
+              "capability and the version of NVRTC, empty for not caching "
+              "them");
+
 namespace paddle {
 namespace platform {
 
@@ -64,12 +80,19 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
       places.size(), 0,
       errors::InvalidArgument(
           "Expected the number of places >= 1. Expected %d.", places.size()));
+  AddPlaces(places);
+}
+
+void DeviceCodePool::AddPlaces(const std::vector<platform::Place>& places) {
   // Remove the duplicated places
   std::set<Place> set;
   for (auto& p : places) {
     set.insert(p);
   }
   for (auto& p : set) {
+    if (device_codes_.count(p) > 0) {
+      continue;
+    }
     if (is_gpu_place(p)) {
 #ifdef PADDLE_WITH_CUDA
       device_codes_.emplace(p, DeviceCodeMap());
@@ -77,6 +100,584 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
       PADDLE_THROW(platform::errors::PreconditionNotMet(
           "CUDAPlace is not supported, please re-compile with WITH_GPU=ON."));
 #endif
+    } else if (is_cpu_place(p)) {
+      device_codes_.emplace(p, DeviceCodeMap());
+    }
+  }
+}
+
+// The number of elements each instruction of CPUDeviceCode computes at a
+// time, which keeps the tiles of all the registers in the L1/L2 cache.
+static constexpr int64_t kCPUTileSize = 512;
+
+namespace {
+
+// Translates the loop body of a CPU kernel into the instructions of
+// CPUDeviceCode, by a recursive descent parser of the expressions the code
+// generator of fusion_group emits, i.e. the ternary, comparison and
+// arithmetic operators, the unary minus, Exp, Log, Sqrt, Max, static_cast
+// and the numbers.
+class CPUKernelParser {
+ public:
+  using OpCode = CPUDeviceCode::OpCode;
+
+  CPUKernelParser(const std::string& name, const std::string& kernel)
+      : name_(name), kernel_(kernel) {}
+
+  bool Parse() {
+    if (!ParseParameters() || !ParseBody()) {
+      LOG(WARNING) << "Cannot compile the kernel " << name_
+                   << " for CPU: " << error_;
+      return false;
+    }
+    return true;
+  }
+
+  bool IsDouble() const { return dtype_ == "double"; }
+  int NumArgs() const { return static_cast<int>(arg_names_.size()); }
+  int NumRegisters() const { return num_registers_; }
+  std::vector<CPUDeviceCode::Instruction>& Instructions() {
+    return instructions_;
+  }
+  std::vector<std::pair<int, double>>& Constants() { return constants_; }
+
+ private:
+  static bool IsIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  }
+
+  static std::string Trim(const std::string& str) {
+    size_t begin = str.find_first_not_of(" \t\n\r");
+    if (begin == std::string::npos) {
+      return "";
+    }
+    size_t end = str.find_last_not_of(" \t\n\r");
+    return str.substr(begin, end - begin + 1);
+  }
+
+  bool Fail(const std::string& error) {
+    if (error_.empty()) {
+      error_ = error;
+    }
+    return false;
+  }
+
+  // Parses "int N, float* arg0, float* arg1, ..." following the name.
+  bool ParseParameters() {
+    size_t pos = kernel_.find(name_ + "(");
+    if (pos == std::string::npos) {
+      return Fail("cannot find the function " + name_);
+    }
+    size_t begin = pos + name_.size() + 1;
+    size_t end = kernel_.find(')', begin);
+    if (end == std::string::npos) {
+      return Fail("the parameter list is not closed");
+    }
+    std::stringstream params(kernel_.substr(begin, end - begin));
+    std::string param;
+    bool first = true;
+    while (std::getline(params, param, ',')) {
+      param = Trim(param);
+      if (first) {
+        first = false;
+        if (param != "int N") {
+          return Fail("the first parameter is not \"int N\"");
+        }
+        continue;
+      }
+      size_t star = param.find('*');
+      if (star == std::string::npos) {
+        return Fail("the parameter \"" + param + "\" is not a pointer");
+      }
+      std::string type = Trim(param.substr(0, star));
+      std::string arg_name = Trim(param.substr(star + 1));
+      if (type != "float" && type != "double") {
+        return Fail("the data type " + type + " is not supported");
+      }
+      if (!dtype_.empty() && type != dtype_) {
+        return Fail("the parameters are not of the same data type");
+      }
+      dtype_ = type;
+      arg_index_[arg_name] = static_cast<int>(arg_names_.size());
+      arg_names_.push_back(arg_name);
+    }
+    if (arg_names_.empty()) {
+      return Fail("there is no pointer parameter");
+    }
+    body_begin_ = end + 1;
+    return true;
+  }
+
+  // Parses the statements inside the loop over idx.
+  bool ParseBody() {
+    size_t pos = kernel_.find("for", body_begin_);
+    if (pos == std::string::npos) {
+      return Fail("cannot find the loop over the elements");
+    }
+    size_t begin = kernel_.find('{', pos);
+    if (begin == std::string::npos) {
+      return Fail("cannot find the body of the loop");
+    }
+    int depth = 0;
+    size_t end = begin;
+    for (; end < kernel_.size(); ++end) {
+      if (kernel_[end] == '{') {
+        ++depth;
+      } else if (kernel_[end] == '}' && --depth == 0) {
+        break;
+      }
+    }
+    if (end == kernel_.size()) {
+      return Fail("the body of the loop is not closed");
+    }
+    std::stringstream body(kernel_.substr(begin + 1, end - begin - 1));
+    std::string statement;
+    while (std::getline(body, statement, ';')) {
+      if (!Tokenize(statement)) {
+        return false;
+      }
+      if (!tokens_.empty() && !ParseStatement()) {
+        return false;
+      }
+    }
+    if (instructions_.empty() ||
+        instructions_.back().code != OpCode::kStore) {
+      return Fail("the kernel stores no output");
+    }
+    return true;
+  }
+
+  bool Tokenize(const std::string& statement) {
+    static const char* kTwoCharOps[] = {"<=", ">=", "==", "!="};
+    tokens_.clear();
+    pos_ = 0;
+    size_t i = 0;
+    while (i < statement.size()) {
+      char c = statement[i];
+      if (std::isspace(static_cast<unsigned char>(c))) {
+        ++i;
+      } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+        size_t begin = i;
+        while (i < statement.size() &&
+               (IsIdentifierChar(statement[i]) || statement[i] == '.' ||
+                ((statement[i] == '-' || statement[i] == '+') &&
+                 (statement[i - 1] == 'e' || statement[i - 1] == 'E')))) {
+          ++i;
+        }
+        tokens_.push_back(statement.substr(begin, i - begin));
+      } else if (IsIdentifierChar(c)) {
+        size_t begin = i;
+        while (i < statement.size() && IsIdentifierChar(statement[i])) {
+          ++i;
+        }
+        tokens_.push_back(statement.substr(begin, i - begin));
+      } else {
+        std::string op(1, c);
+        for (auto* two_char_op : kTwoCharOps) {
+          if (statement.compare(i, 2, two_char_op) == 0) {
+            op = two_char_op;
+          }
+        }
+        if (op.size() == 1 && std::string("+-*/%?:()[]<>=,").find(c) ==
+                                  std::string::npos) {
+          return Fail(std::string("unexpected character ") + c);
+        }
+        tokens_.push_back(op);
+        i += op.size();
+      }
+    }
+    return true;
+  }
+
+  bool ParseStatement() {
+    if (tokens_[0] == "float" || tokens_[0] == "double") {
+      // <type> tmp = expr
+      if (tokens_[0] != dtype_) {
+        return Fail("the variables are not of the same data type");
+      }
+      tokens_.erase(tokens_.begin());
+    }
+    if (tokens_.size() < 3) {
+      return Fail("unexpected statement");
+    }
+    const std::string& lhs = tokens_[0];
+    if (arg_index_.count(lhs) > 0) {
+      // argK[idx] = expr
+      pos_ = 1;
+      if (!Expect("[") || !Expect("idx") || !Expect("]") || !Expect("=")) {
+        return false;
+      }
+      int value = ParseTernary();
+      if (value < 0 || !ExpectEnd()) {
+        return false;
+      }
+      CPUDeviceCode::Instruction instruction;
+      instruction.code = OpCode::kStore;
+      instruction.ins[0] = value;
+      instruction.arg = arg_index_[lhs];
+      instructions_.push_back(instruction);
+      return true;
+    }
+    pos_ = 1;
+    if (!Expect("=")) {
+      return false;
+    }
+    int value = ParseTernary();
+    if (value < 0 || !ExpectEnd()) {
+      return false;
+    }
+    variables_[lhs] = value;
+    return true;
+  }
+
+  bool Peek(const std::string& token) const {
+    return pos_ < tokens_.size() && tokens_[pos_] == token;
+  }
+
+  bool Expect(const std::string& token) {
+    if (!Peek(token)) {
+      return Fail("expected \"" + token + "\"");
+    }
+    ++pos_;
+    return true;
+  }
+
+  bool ExpectEnd() {
+    if (pos_ != tokens_.size()) {
+      return Fail("unexpected token \"" + tokens_[pos_] + "\"");
+    }
+    return true;
+  }
+
+  int Emit(OpCode code, int in0, int in1 = -1, int in2 = -1) {
+    CPUDeviceCode::Instruction instruction;
+    instruction.code = code;
+    instruction.out = num_registers_++;
+    instruction.ins[0] = in0;
+    instruction.ins[1] = in1;
+    instruction.ins[2] = in2;
+    instructions_.push_back(instruction);
+    return instruction.out;
+  }
+
+  // The following Parse functions return the register holding the value of
+  // the expression, or -1 if failed.
+  int ParseTernary() {
+    int cond = ParseComparison();
+    if (cond < 0 || !Peek("?")) {
+      return cond;
+    }
+    ++pos_;
+    int true_value = ParseTernary();
+    if (true_value < 0 || !Expect(":")) {
+      return -1;
+    }
+    int false_value = ParseTernary();
+    if (false_value < 0) {
+      return -1;
+    }
+    return Emit(OpCode::kSelect, cond, true_value, false_value);
+  }
+
+  int ParseComparison() {
+    static const std::map<std::string, OpCode> kOps = {
+        {"<", OpCode::kLT},  {"<=", OpCode::kLE}, {">", OpCode::kGT},
+        {">=", OpCode::kGE}, {"==", OpCode::kEQ}, {"!=", OpCode::kNE}};
+    return ParseBinary(kOps, &CPUKernelParser::ParseAdditive);
+  }
+
+  int ParseAdditive() {
+    static const std::map<std::string, OpCode> kOps = {{"+", OpCode::kAdd},
+                                                       {"-", OpCode::kSub}};
+    return ParseBinary(kOps, &CPUKernelParser::ParseMultiplicative);
+  }
+
+  int ParseMultiplicative() {
+    static const std::map<std::string, OpCode> kOps = {{"*", OpCode::kMul},
+                                                       {"/", OpCode::kDiv}};
+    return ParseBinary(kOps, &CPUKernelParser::ParseUnary);
+  }
+
+  int ParseBinary(const std::map<std::string, OpCode>& ops,
+                  int (CPUKernelParser::*parse_operand)()) {
+    int lhs = (this->*parse_operand)();
+    while (lhs >= 0 && pos_ < tokens_.size()) {
+      auto it = ops.find(tokens_[pos_]);
+      if (it == ops.end()) {
+        break;
+      }
+      ++pos_;
+      int rhs = (this->*parse_operand)();
+      if (rhs < 0) {
+        return -1;
+      }
+      lhs = Emit(it->second, lhs, rhs);
+    }
+    return lhs;
+  }
+
+  int ParseUnary() {
+    if (Peek("-")) {
+      ++pos_;
+      int value = ParseUnary();
+      return value < 0 ? -1 : Emit(OpCode::kNeg, value);
+    }
+    if (Peek("+")) {
+      ++pos_;
+      return ParseUnary();
+    }
+    return ParsePrimary();
+  }
+
+  int ParsePrimary() {
+    static const std::map<std::string, OpCode> kUnaryFuncs = {
+        {"Exp", OpCode::kExp}, {"Log", OpCode::kLog}, {"Sqrt", OpCode::kSqrt}};
+    if (pos_ >= tokens_.size()) {
+      Fail("unexpected end of the expression");
+      return -1;
+    }
+    std::string token = tokens_[pos_++];
+    if (token == "(") {
+      int value = ParseTernary();
+      return value >= 0 && Expect(")") ? value : -1;
+    }
+    if (std::isdigit(static_cast<unsigned char>(token[0])) || token[0] == '.') {
+      return ParseNumber(token);
+    }
+    if (arg_index_.count(token) > 0) {
+      return ParseLoad(token);
+    }
+    auto var_it = variables_.find(token);
+    if (var_it != variables_.end()) {
+      return var_it->second;
+    }
+    auto func_it = kUnaryFuncs.find(token);
+    if (func_it != kUnaryFuncs.end() || token == "Max") {
+      if (!Expect("(")) {
+        return -1;
+      }
+      int x = ParseTernary();
+      if (x < 0) {
+        return -1;
+      }
+      if (token == "Max") {
+        int y = Expect(",") ? ParseTernary() : -1;
+        return y >= 0 && Expect(")") ? Emit(OpCode::kMax, x, y) : -1;
+      }
+      return Expect(")") ? Emit(func_it->second, x) : -1;
+    }
+    if (token == "static_cast") {
+      // only the casts to the same data type, which are no-ops
+      if (!Expect("<") || !Expect(dtype_) || !Expect(">") || !Expect("(")) {
+        return -1;
+      }
+      int value = ParseTernary();
+      return value >= 0 && Expect(")") ? value : -1;
+    }
+    Fail("unknown identifier \"" + token + "\"");
+    return -1;
+  }
+
+  int ParseNumber(const std::string& token) {
+    std::string number = token;
+    if (number.back() == 'f' || number.back() == 'F') {
+      number.pop_back();
+    }
+    std::istringstream is(number);
+    double value = 0;
+    is >> value;
+    if (is.fail() || !is.eof()) {
+      Fail("invalid number " + token);
+      return -1;
+    }
+    int reg = num_registers_++;
+    constants_.emplace_back(reg, value);
+    return reg;
+  }
+
+  // argK[idx] or argK[idx % S]
+  int ParseLoad(const std::string& arg_name) {
+    int64_t broadcast_size = 0;
+    if (!Expect("[") || !Expect("idx")) {
+      return -1;
+    }
+    if (Peek("%")) {
+      ++pos_;
+      if (pos_ >= tokens_.size()) {
+        Fail("expected the broadcast size");
+        return -1;
+      }
+      std::istringstream is(tokens_[pos_++]);
+      is >> broadcast_size;
+      if (is.fail() || broadcast_size <= 0) {
+        Fail("invalid broadcast size");
+        return -1;
+      }
+    }
+    if (!Expect("]")) {
+      return -1;
+    }
+    int reg = Emit(OpCode::kLoad, -1);
+    instructions_.back().arg = arg_index_[arg_name];
+    instructions_.back().broadcast_size = broadcast_size;
+    return reg;
+  }
+
+  std::string name_;
+  const std::string& kernel_;
+  std::string error_;
+  std::string dtype_;
+  size_t body_begin_{0};
+
+  std::vector<std::string> arg_names_;
+  std::unordered_map<std::string, int> arg_index_;
+  std::unordered_map<std::string, int> variables_;
+
+  std::vector<std::string> tokens_;
+  size_t pos_{0};
+
+  int num_registers_{0};
+  std::vector<CPUDeviceCode::Instruction> instructions_;
+  std::vector<std::pair<int, double>> constants_;
+};
+
+}  // namespace
+
+CPUDeviceCode::CPUDeviceCode(const Place& place, const std::string& name,
+                             const std::string& kernel) {
+  PADDLE_ENFORCE_EQ(
+      is_cpu_place(place), true,
+      errors::PermissionDenied(
+          "CPUDeviceCode can only launch on CPUPlace, but got %s.", place));
+
+  place_ = place;
+  name_ = name;
+  kernel_ = kernel;
+}
+
+bool CPUDeviceCode::Compile(bool include_path) {
+  is_compiled_ = false;
+  CPUKernelParser parser(name_, kernel_);
+  if (!parser.Parse()) {
+    return false;
+  }
+  is_double_ = parser.IsDouble();
+  num_args_ = parser.NumArgs();
+  num_registers_ = parser.NumRegisters();
+  instructions_.swap(parser.Instructions());
+  constants_.swap(parser.Constants());
+  is_compiled_ = true;
+  return true;
+}
+
+void CPUDeviceCode::Launch(const size_t n, std::vector<void*>* args) const {
+  PADDLE_ENFORCE_EQ(
+      is_compiled_, true,
+      errors::PreconditionNotMet(
+          "Please compile the CPU device code %s before launching it.",
+          name_));
+  PADDLE_ENFORCE_EQ(
+      args->size(), static_cast<size_t>(num_args_ + 1),
+      errors::InvalidArgument("The CPU device code %s expects %d arguments, "
+                              "but received %d.",
+                              name_, num_args_ + 1, args->size()));
+  if (is_double_) {
+    LaunchImpl<double>(n, args);
+  } else {
+    LaunchImpl<float>(n, args);
+  }
+}
+
+template <typename T>
+void CPUDeviceCode::LaunchImpl(const size_t n,
+                               std::vector<void*>* args) const {
+  // args[0] is the address of N, and args[i + 1] is the address of the i-th
+  // pointer.
+  std::vector<T*> ptrs(num_args_);
+  for (int i = 0; i < num_args_; ++i) {
+    ptrs[i] = *reinterpret_cast<T**>((*args)[i + 1]);
+  }
+  std::vector<T> registers(static_cast<size_t>(num_registers_) *
+                           kCPUTileSize);
+  auto reg = [&registers](int i) {
+    return registers.data() + static_cast<size_t>(i) * kCPUTileSize;
+  };
+  for (auto& constant : constants_) {
+    std::fill(reg(constant.first), reg(constant.first) + kCPUTileSize,
+              static_cast<T>(constant.second));
+  }
+
+  int64_t numel = static_cast<int64_t>(n);
+  for (int64_t start = 0; start < numel; start += kCPUTileSize) {
+    int64_t len = std::min<int64_t>(kCPUTileSize, numel - start);
+    for (auto& ins : instructions_) {
+      T* out = ins.out >= 0 ? reg(ins.out) : nullptr;
+      const T* x = ins.ins[0] >= 0 ? reg(ins.ins[0]) : nullptr;
+      const T* y = ins.ins[1] >= 0 ? reg(ins.ins[1]) : nullptr;
+      const T* z = ins.ins[2] >= 0 ? reg(ins.ins[2]) : nullptr;
+      switch (ins.code) {
+        case OpCode::kLoad: {
+          const T* src = ptrs[ins.arg];
+          if (ins.broadcast_size > 0) {
+            int64_t s = ins.broadcast_size;
+            for (int64_t i = 0; i < len; ++i) out[i] = src[(start + i) % s];
+          } else {
+            std::copy(src + start, src + start + len, out);
+          }
+          break;
+        }
+        case OpCode::kStore:
+          std::copy(x, x + len, ptrs[ins.arg] + start);
+          break;
+        case OpCode::kNeg:
+          for (int64_t i = 0; i < len; ++i) out[i] = -x[i];
+          break;
+        case OpCode::kAdd:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] + y[i];
+          break;
+        case OpCode::kSub:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] - y[i];
+          break;
+        case OpCode::kMul:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] * y[i];
+          break;
+        case OpCode::kDiv:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] / y[i];
+          break;
+        case OpCode::kMax:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] > y[i] ? x[i] : y[i];
+          break;
+        case OpCode::kLT:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] < y[i];
+          break;
+        case OpCode::kLE:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] <= y[i];
+          break;
+        case OpCode::kGT:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] > y[i];
+          break;
+        case OpCode::kGE:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] >= y[i];
+          break;
+        case OpCode::kEQ:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] == y[i];
+          break;
+        case OpCode::kNE:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] != y[i];
+          break;
+        case OpCode::kSelect:
+          for (int64_t i = 0; i < len; ++i) out[i] = x[i] != 0 ? y[i] : z[i];
+          break;
+        case OpCode::kExp:
+          for (int64_t i = 0; i < len; ++i) out[i] = std::exp(x[i]);
+          break;
+        case OpCode::kLog:
+          for (int64_t i = 0; i < len; ++i) out[i] = std::log(x[i]);
+          break;
+        case OpCode::kSqrt:
+          for (int64_t i = 0; i < len; ++i) out[i] = std::sqrt(x[i]);
+          break;
+      }
     }
   }
 }
@@ -142,6 +743,101 @@ bool CUDADeviceCode::Compile(bool include_path) {
     return false;
   }
 
+  auto* dev_ctx = reinterpret_cast<CUDADeviceContext*>(
+      DeviceContextPool::Instance().Get(place_));
+  int compute_capability = dev_ctx->GetComputeCapability();
+  std::string cache_file = GetKernelCacheFile(compute_capability, include_path);
+  if (cache_file.empty() || !ReadKernelCache(cache_file)) {
+    if (!CompileToPTX(compute_capability, include_path)) {
+      return false;
+    }
+    if (!cache_file.empty()) {
+      WriteKernelCache(cache_file);
+    }
+  }
+
+  if (!CheckCUDADriverResult(dynload::cuModuleLoadData(&module_, ptx_.data()),
+                             "cuModuleLoadData")) {
+    return false;
+  }
+
+  if (!CheckCUDADriverResult(
+          dynload::cuModuleGetFunction(&function_, module_, name_.c_str()),
+          "cuModuleGetFunction")) {
+    return false;
+  }
+
+  max_threads_ = dev_ctx->GetMaxPhysicalThreadCount();
+  is_compiled_ = true;
+  return true;
+}
+
+std::string CUDADeviceCode::GetKernelCacheFile(int compute_capability,
+                                               bool include_path) const {
+  if (FLAGS_fusion_group_kernel_cache_dir.empty()) {
+    return "";
+  }
+  int major = 0;
+  int minor = 0;
+  if (dynload::nvrtcVersion(&major, &minor) != NVRTC_SUCCESS) {
+    return "";
+  }
+  // The PTX generated depends on the source, the compute capability, the
+  // version of NVRTC, and the headers included.
+  std::string key = name_ + "\n" + kernel_;
+  if (include_path) {
+    key += "\n" + FindCUDAIncludePath();
+  }
+  std::stringstream ss;
+  ss << FLAGS_fusion_group_kernel_cache_dir << "/" << name_ << "_" << std::hex
+     << XXH64(key.data(), key.size(), 0) << std::dec << "_sm"
+     << compute_capability << "_nvrtc" << major << "." << minor << ".ptx";
+  return ss.str();
+}
+
+bool CUDADeviceCode::ReadKernelCache(const std::string& cache_file) {
+  std::ifstream fin(cache_file, std::ios::in | std::ios::binary);
+  if (!fin.is_open()) {
+    return false;
+  }
+  std::vector<char> ptx((std::istreambuf_iterator<char>(fin)),
+                        std::istreambuf_iterator<char>());
+  // A PTX written completely ends with '\0'.
+  if (ptx.empty() || ptx.back() != '\0') {
+    return false;
+  }
+  VLOG(3) << "Load the PTX of " << name_ << " from " << cache_file;
+  ptx_.swap(ptx);
+  return true;
+}
+
+void CUDADeviceCode::WriteKernelCache(const std::string& cache_file) const {
+  try {
+    MkDirRecursively(FLAGS_fusion_group_kernel_cache_dir.c_str());
+  } catch (std::runtime_error& e) {
+    LOG(WARNING) << "Cannot cache the PTX of " << name_ << ": " << e.what();
+    return;
+  }
+  // Write a temporary file and rename it, so that the processes compiling
+  // the same kernel at the same time never read a partial file.
+  std::string tmp_file = cache_file + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream fout(tmp_file, std::ios::out | std::ios::binary);
+    fout.write(ptx_.data(), ptx_.size());
+    if (!fout.good()) {
+      LOG(WARNING) << "Cannot write the PTX of " << name_ << " to "
+                   << tmp_file;
+      std::remove(tmp_file.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+    LOG(WARNING) << "Cannot rename " << tmp_file << " to " << cache_file;
+    std::remove(tmp_file.c_str());
+  }
+}
+
+bool CUDADeviceCode::CompileToPTX(int compute_capability, bool include_path) {
   nvrtcProgram program;
   if (!CheckNVRTCResult(dynload::nvrtcCreateProgram(&program,
                                                     kernel_.c_str(),  // buffer
@@ -154,16 +850,14 @@ bool CUDADeviceCode::Compile(bool include_path) {
   }
 
   // Compile the program for specified compute_capability
-  auto* dev_ctx = reinterpret_cast<CUDADeviceContext*>(
-      DeviceContextPool::Instance().Get(place_));
-  int compute_capability = dev_ctx->GetComputeCapability();
   std::string compute_flag =
       "--gpu-architecture=compute_" + std::to_string(compute_capability);
   std::vector<const char*> options = {"--std=c++11", compute_flag.c_str()};
+  std::string include_option;
   if (include_path) {
     std::string cuda_include_path = FindCUDAIncludePath();
     if (!cuda_include_path.empty()) {
-      std::string include_option = "--include-path=" + cuda_include_path;
+      include_option = "--include-path=" + cuda_include_path;
       options.push_back(include_option.c_str());
     }
   }
@@ -203,25 +897,8 @@ bool CUDADeviceCode::Compile(bool include_path) {
     return false;
   }
 
-  if (!CheckNVRTCResult(dynload::nvrtcDestroyProgram(&program),
-                        "nvrtcDestroyProgram")) {
-    return false;
-  }
-
-  if (!CheckCUDADriverResult(dynload::cuModuleLoadData(&module_, ptx_.data()),
-                             "cuModuleLoadData")) {
-    return false;
-  }
-
-  if (!CheckCUDADriverResult(
-          dynload::cuModuleGetFunction(&function_, module_, name_.c_str()),
-          "cuModuleGetFunction")) {
-    return false;
-  }
-
-  max_threads_ = dev_ctx->GetMaxPhysicalThreadCount();
-  is_compiled_ = true;
-  return true;
+  return CheckNVRTCResult(dynload::nvrtcDestroyProgram(&program),
+                          "nvrtcDestroyProgram");
 }
 
 void CUDADeviceCode::Launch(const size_t n, std::vector<void*>* args) const {
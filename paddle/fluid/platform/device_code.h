@@ -43,6 +43,77 @@ class DeviceCode {
   std::string kernel_;
 };
 
+/**
+ * CPUDeviceCode runs the elementwise kernels generated for CPU, e.g. by
+ * fusion_group_pass, whose body is a loop over N elements like
+ *
+ *   extern "C" void relu_kernel(int N, float* arg0, float* arg1) {
+ *     for(int idx = 0; idx < N; idx++) {
+ *       float tmp0 = arg0[idx];
+ *       float tmp1 = tmp0 > 0 ? tmp0 : 0;
+ *       arg1[idx] = tmp1;
+ *     }
+ *   }
+ *
+ * Instead of invoking a C compiler, Compile translates the statements of the
+ * loop into instructions on tiles of elements, and Launch runs all the
+ * instructions on a tile before moving to the next one. So the elements are
+ * loaded and stored only once, and each instruction is a simple loop over a
+ * tile, which is vectorized by the compiler.
+ */
+class CPUDeviceCode : public DeviceCode {
+ public:
+  enum class OpCode {
+    kLoad,
+    kStore,
+    kNeg,
+    kAdd,
+    kSub,
+    kMul,
+    kDiv,
+    kMax,
+    kLT,
+    kLE,
+    kGT,
+    kGE,
+    kEQ,
+    kNE,
+    kSelect,
+    kExp,
+    kLog,
+    kSqrt
+  };
+
+  // An instruction reads the tiles in the registers ins and writes the tile
+  // in the register out, or loads and stores the tile of the arg-th pointer
+  // of the kernel, which is indexed by the remainder of broadcast_size if
+  // broadcast_size is not 0.
+  struct Instruction {
+    OpCode code;
+    int out{-1};
+    int ins[3] = {-1, -1, -1};
+    int arg{-1};
+    int64_t broadcast_size{0};
+  };
+
+  explicit CPUDeviceCode(const Place& place, const std::string& name,
+                         const std::string& kernel);
+  bool Compile(bool include_path = false) override;
+  void Launch(const size_t n, std::vector<void*>* args) const override;
+
+ private:
+  template <typename T>
+  void LaunchImpl(const size_t n, std::vector<void*>* args) const;
+
+  bool is_compiled_{false};
+  bool is_double_{false};
+  int num_args_{0};
+  int num_registers_{0};
+  std::vector<Instruction> instructions_;
+  // the registers holding the constants and their values
+  std::vector<std::pair<int, double>> constants_;
+};
+
 #ifdef PADDLE_WITH_CUDA
 class CUDADeviceCode : public DeviceCode {
  public:
@@ -57,6 +128,15 @@ class CUDADeviceCode : public DeviceCode {
   }
 
  private:
+  bool CompileToPTX(int compute_capability, bool include_path);
+
+  // The file in FLAGS_fusion_group_kernel_cache_dir caching the PTX, empty if
+  // not caching it.
+  std::string GetKernelCacheFile(int compute_capability,
+                                 bool include_path) const;
+  bool ReadKernelCache(const std::string& cache_file);
+  void WriteKernelCache(const std::string& cache_file) const;
+
   bool CheckNVRTCResult(nvrtcResult result, std::string function);
   bool CheckCUDADriverResult(CUresult result, std::string function);
 
@@ -85,9 +165,12 @@ class DeviceCodePool {
     return *pool;
   }
 
+  // Create the pool, or add the places not in the created pool.
   static DeviceCodePool& Init(const std::vector<platform::Place>& places) {
     if (pool == nullptr) {
       pool = new DeviceCodePool(places);
+    } else {
+      pool->AddPlaces(places);
     }
     return *pool;
   }
@@ -106,6 +189,8 @@ class DeviceCodePool {
   }
 
  private:
+  void AddPlaces(const std::vector<platform::Place>& places);
+
   static DeviceCodePool* pool;
   std::map<Place, DeviceCodeMap> device_codes_;
   DISABLE_COPY_AND_ASSIGN(DeviceCodePool);
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/device_code.h"
+#include <algorithm>
+#include <cmath>
 #include <utility>
+#include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/platform/init.h"
@@ -108,3 +111,76 @@ TEST(DeviceCodePool, cuda) {
   LOG(INFO) << "get ptr: " << code_get;
 }
 #endif
+
+constexpr auto cpu_elementwise_code = R"(
+extern "C" void fused_kernel(int N, float* arg0, float* arg1, float* arg2,
+                             float* arg3) {
+  for(int idx = 0;
+      idx < N;
+      idx++) {
+    float tmp0 = arg0[idx];
+    float tmp1 = arg1[idx % 4];
+    float tmp2 = static_cast<float>(tmp0 * tmp1 + 0.5);
+    float tmp3 = static_cast<float>(tmp2 > 0 ? tmp2 : 0);
+    float tmp4 = static_cast<float>(1.0 / (1.0 + Exp(- tmp3)));
+    arg2[idx] = tmp2;
+    arg3[idx] = tmp4;
+  }
+}
+)";
+
+TEST(DeviceCode, cpu) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode code(place, "fused_kernel",
+                                       cpu_elementwise_code);
+  EXPECT_EQ(code.Compile(), true);
+
+  // not a multiple of the tile size
+  size_t n = 1000;
+  std::vector<float> x(n), y = {1.0, -1.0, 2.0, -2.0}, z(n), out(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = static_cast<float>(i % 7) - 3;
+  }
+  float* x_data = x.data();
+  float* y_data = y.data();
+  float* z_data = z.data();
+  float* out_data = out.data();
+  std::vector<void*> args = {&n, &x_data, &y_data, &z_data, &out_data};
+  code.Launch(n, &args);
+
+  for (size_t i = 0; i < n; ++i) {
+    float expected_z = x[i] * y[i % 4] + 0.5;
+    float expected_out = 1.0 / (1.0 + std::exp(-std::max(expected_z, 0.0f)));
+    EXPECT_FLOAT_EQ(z[i], expected_z);
+    EXPECT_FLOAT_EQ(out[i], expected_out);
+  }
+}
+
+TEST(DeviceCode, cpu_unsupported) {
+  // float16 is not supported on CPU.
+  constexpr auto fp16_code = R"(
+extern "C" void fp16_kernel(int N, float16* arg0, float16* arg1) {
+  for(int idx = 0; idx < N; idx++) {
+    float16 tmp0 = arg0[idx];
+    arg1[idx] = tmp0;
+  }
+}
+)";
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode code(place, "fp16_kernel", fp16_code);
+  EXPECT_EQ(code.Compile(), false);
+}
+
+TEST(DeviceCodePool, cpu) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::DeviceCodePool& pool =
+      paddle::platform::DeviceCodePool::Init({place});
+  size_t num_device_codes_before = pool.size(place);
+
+  std::unique_ptr<paddle::platform::DeviceCode> code(
+      new paddle::platform::CPUDeviceCode(place, "fused_kernel",
+                                          cpu_elementwise_code));
+  pool.Set(std::move(code));
+  EXPECT_EQ(pool.size(place), num_device_codes_before + 1);
+  EXPECT_NE(pool.Get(place, "fused_kernel"), nullptr);
+}
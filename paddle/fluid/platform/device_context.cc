@@ -16,10 +16,15 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/platform/memory_profiler.h"
+#include "paddle/fluid/platform/metrics.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/cuda_device_context_allocator.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/cuda_resource_pool.h"
 #endif
 
 #include "glog/logging.h"
@@ -39,6 +44,10 @@ AllocationPtr Alloc(const platform::DeviceContext& dev_ctx, size_t size) {
       static_cast<const platform::CUDADeviceContext&>(dev_ctx);
   if (default_dev_ctx->stream() == desired_dev_ctx.stream()) {
     return Alloc(place, size);
+  } else if (allocation::GetAllocatorStrategy() ==
+             allocation::AllocatorStrategy::kStreamOrdered) {
+    return allocation::AllocatorFacade::Instance().Alloc(
+        place, size, desired_dev_ctx.stream());
   } else {
     return allocation::CUDADeviceContextAllocatorPool::Instance().Alloc(
         desired_dev_ctx, size);
@@ -209,12 +218,34 @@ void CudnnWorkspaceHandle::ReallocWorkspace(size_t required_workspace_bytes) {
   // reset allocation first before re-allocate to save memory
   allocation_.reset();
   allocation_ = memory::Alloc(device_context_, required_workspace_bytes);
+  if (MemoryProfiler::IsEnabled()) {
+    MemoryProfiler::Instance().Annotate(allocation_->ptr(),
+                                        allocation_->place(), "cudnn_workspace",
+                                        MemoryCategory::kWorkspace);
+  }
 }
 
 thread_local std::unordered_map<const CUDADeviceContext*,
                                 std::unique_ptr<CUDAContext>>
     CUDADeviceContext::thread_ctx_;
 thread_local std::mutex CUDADeviceContext::ctx_mtx_;
+thread_local std::unordered_map<const CUDADeviceContext*,
+                                const std::unique_ptr<CUDAContext>*>
+    CUDADeviceContext::bound_ctx_;
+
+const std::unique_ptr<CUDAContext>* CUDADeviceContext::BindThreadContext(
+    const std::unique_ptr<CUDAContext>* context) const {
+  const std::unique_ptr<CUDAContext>* prev_context = nullptr;
+  auto iter = bound_ctx_.find(this);
+  if (iter != bound_ctx_.end()) {
+    prev_context = iter->second;
+    bound_ctx_.erase(iter);
+  }
+  if (context != nullptr) {
+    bound_ctx_[this] = context;
+  }
+  return prev_context;
+}
 
 void CUDAContext::InitEigenContext(const stream::CUDAStream& stream) {
   eigen_stream_.reset(new EigenCudaStreamDevice());
@@ -283,6 +314,36 @@ CUDADeviceContext::CUDADeviceContext(CUDAPlace place) : place_(place) {
   default_ctx_.reset(new CUDAContext(place_));
 }
 
+CUDAStreamType StringToCUDAStreamType(const std::string& name) {
+  if (name.empty() || name == "compute") {
+    return CUDAStreamType::kCompute;
+  } else if (name == "h2d") {
+    return CUDAStreamType::kH2D;
+  } else if (name == "d2h") {
+    return CUDAStreamType::kD2H;
+  } else if (name == "comm") {
+    return CUDAStreamType::kComm;
+  }
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "The stream type should be compute, h2d, d2h or comm, but received %s.",
+      name));
+}
+
+CUDAThreadContextGuard::CUDAThreadContextGuard(
+    const std::unique_ptr<CUDAContext>* context) {
+  if (context != nullptr && *context != nullptr) {
+    dev_ctx_ = static_cast<const CUDADeviceContext*>(
+        DeviceContextPool::Instance().Get((*context)->Place()));
+    prev_context_ = dev_ctx_->BindThreadContext(context);
+  }
+}
+
+CUDAThreadContextGuard::~CUDAThreadContextGuard() {
+  if (dev_ctx_ != nullptr) {
+    dev_ctx_->BindThreadContext(prev_context_);
+  }
+}
+
 CUDADeviceContext::~CUDADeviceContext() {
   SetDeviceId(place_.device);
   Wait();
@@ -291,7 +352,50 @@ CUDADeviceContext::~CUDADeviceContext() {
 
 Place CUDADeviceContext::GetPlace() const { return place_; }
 
-void CUDADeviceContext::Wait() const { context()->Wait(); }
+void CUDADeviceContext::Wait() const {
+  context()->Wait();
+  std::lock_guard<std::mutex> guard(side_ctx_mtx_);
+  for (auto& ctx : side_ctx_) {
+    if (ctx) {
+      ctx->Wait();
+    }
+  }
+}
+
+const std::unique_ptr<CUDAContext>& CUDADeviceContext::context(
+    CUDAStreamType type) const {
+  if (type == CUDAStreamType::kCompute) {
+    return context();
+  }
+  std::lock_guard<std::mutex> guard(side_ctx_mtx_);
+  auto& ctx = side_ctx_[static_cast<int>(type)];
+  if (!ctx) {
+    ctx.reset(new CUDAContext(place_, type == CUDAStreamType::kComm
+                                          ? stream::Priority::HIGH
+                                          : stream::Priority::NORMAL));
+  }
+  return ctx;
+}
+
+void CUDADeviceContext::StreamWaitStream(CUDAStreamType stream,
+                                         CUDAStreamType dependency) const {
+  cudaStream_t waiter = this->stream(stream);
+  cudaStream_t signaler = this->stream(dependency);
+  if (waiter == signaler) {
+    return;
+  }
+  // The wait takes the work recorded so far, so the event can go back to the
+  // pool and be recorded again right away.
+  auto event = CudaEventResourcePool::Instance().New(place_.device);
+  CUDADeviceGuard guard(place_.device);
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaEventRecord(event.get(), signaler),
+      platform::errors::Fatal("cudaEventRecord raises unexpected exception"));
+  PADDLE_ENFORCE_CUDA_SUCCESS(
+      cudaStreamWaitEvent(waiter, event.get(), 0),
+      platform::errors::Fatal(
+          "cudaStreamWaitEvent raises unexpected exception"));
+}
 
 int CUDADeviceContext::GetComputeCapability() const {
   return compute_capability_;
@@ -462,12 +566,20 @@ std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(
 
   int sid = platform::get_cur_mkldnn_session_id();
 
+  static auto* hits = MetricsRegistry::Instance().Counter(
+      "paddle_mkldnn_blob_cache_hits_total",
+      "The MKLDNN primitives found in the blob cache.");
+  static auto* misses = MetricsRegistry::Instance().Counter(
+      "paddle_mkldnn_blob_cache_misses_total",
+      "The MKLDNN primitives not found in the blob cache.");
+
   std::lock_guard<std::mutex> lock(*p_mutex_);
 
   // Find ShapeBlob for current mkldnn session id firstly
   auto map_it = pMap->find(sid);
   if (map_it == pMap->end()) {
     VLOG(2) << "GetBlob: sid=" << sid << ", miss sid\n";
+    misses->Add();
     return nullptr;
   }
   sBlob = map_it->second;
@@ -477,6 +589,7 @@ std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(
   if (sBlob_it == sBlob->end()) {
     VLOG(2) << "GetBlob: sid=" << cur_input_shape_str
             << ", miss input_shape_str\n";
+    misses->Add();
     return nullptr;
   }
   pBlob = sBlob_it->second;
@@ -486,10 +599,12 @@ std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(
 
   if (key_it == pBlob->end()) {
     VLOG(2) << "GetBlob sid=" << sid << ", miss blob=" << name << "\n";
+    misses->Add();
     return nullptr;
   }
 
   VLOG(2) << "GetBlob sid=" << sid << ", get blob=" << name << "\n";
+  hits->Add();
   // lock will be automatically released when out of scope
   return key_it->second;
 }
@@ -81,6 +81,24 @@ struct DefaultDeviceContextType<platform::CPUPlace> {
 class EigenCudaStreamDevice;
 class CudnnWorkspaceHandle;
 
+// The streams of a CUDADeviceContext. The compute stream is the one of the
+// context of the current thread, the others are shared by the threads and
+// created when they are used first. The comm stream has the high priority,
+// and the copy streams the normal one, so that the collectives, and the
+// compute work of a context of the high priority, preempt the bulk copies.
+enum class CUDAStreamType : uint8_t {
+  kCompute = 0,
+  kH2D = 1,
+  kD2H = 2,
+  kComm = 3,
+};
+
+constexpr int kNumCUDAStreamTypes = 4;
+
+// Parse the name of the stream type, i.e. compute, h2d, d2h or comm. The
+// empty name is compute.
+CUDAStreamType StringToCUDAStreamType(const std::string& name);
+
 class CUDAContext {
  public:
   CUDAContext() = default;
@@ -296,6 +314,17 @@ class CUDADeviceContext : public DeviceContext {
   /*! \brief  Return cuda stream in the device context. */
   cudaStream_t stream() const;
 
+  /*! \brief  Return the cuda stream of the type, see CUDAStreamType. */
+  cudaStream_t stream(CUDAStreamType type) const {
+    return context(type)->Stream();
+  }
+
+  /*! \brief  Make the work issued to stream from now on wait for the work
+   *  issued to dependency so far, by an event of CudaEventResourcePool,
+   *  without blocking the host. */
+  void StreamWaitStream(CUDAStreamType stream,
+                        CUDAStreamType dependency) const;
+
 #if defined(PADDLE_WITH_NCCL)
   /*! \brief  Return nccl communicators. */
   ncclComm_t nccl_comm() const { return nccl_comm_; }
@@ -325,13 +354,30 @@ class CUDADeviceContext : public DeviceContext {
     thread_ctx_[this].reset(new CUDAContext(place_, priority));
   }
 
+  /*! \brief  Run the calls of the current thread on context, e.g. the
+   *  stream and the handles owned by an inference predictor, instead of the
+   *  default or the thread context, until it is unbound by nullptr. Return
+   *  the context bound before, or nullptr. */
+  const std::unique_ptr<CUDAContext>* BindThreadContext(
+      const std::unique_ptr<CUDAContext>* context) const;
+
   const std::unique_ptr<CUDAContext>& context() const {
+    if (UNLIKELY(!bound_ctx_.empty())) {
+      auto iter = bound_ctx_.find(this);
+      if (iter != bound_ctx_.end()) {
+        return *iter->second;
+      }
+    }
     if (!thread_ctx_.count(this)) {
       return default_ctx_;
     }
     return thread_ctx_.at(this);
   }
 
+  /*! \brief  Return the context of the stream type, e.g. to run the kernels
+   *  of an op on the stream by CUDAThreadContextGuard. */
+  const std::unique_ptr<CUDAContext>& context(CUDAStreamType type) const;
+
  private:
   CUDAPlace place_;
   std::unique_ptr<CUDAContext> default_ctx_;
@@ -340,9 +386,18 @@ class CUDADeviceContext : public DeviceContext {
                                          std::unique_ptr<CUDAContext>>
       thread_ctx_;
   static thread_local std::mutex ctx_mtx_;
+  // the contexts bound by BindThreadContext, which are not owned
+  static thread_local std::unordered_map<const CUDADeviceContext*,
+                                         const std::unique_ptr<CUDAContext>*>
+      bound_ctx_;
 
   mutable std::mutex cudnn_handle_mtx_;
 
+  // the contexts of the streams other than the compute one, which are
+  // waited by Wait() too
+  mutable std::mutex side_ctx_mtx_;
+  mutable std::unique_ptr<CUDAContext> side_ctx_[kNumCUDAStreamTypes];
+
 #if defined(PADDLE_WITH_NCCL)
   // NCCL communicator (single process version) for NCCL collective operations.
   // NCCL collective operations provides fast collectives over multiple GPUs
@@ -363,6 +418,22 @@ class CUDADeviceContext : public DeviceContext {
   DISABLE_COPY_AND_ASSIGN(CUDADeviceContext);
 };
 
+// Bind context to the current thread for the device context of its place in
+// the scope, see CUDADeviceContext::BindThreadContext. Nothing is bound if
+// context is null or holds nothing.
+class CUDAThreadContextGuard {
+ public:
+  explicit CUDAThreadContextGuard(const std::unique_ptr<CUDAContext>* context);
+
+  ~CUDAThreadContextGuard();
+
+ private:
+  const CUDADeviceContext* dev_ctx_{nullptr};
+  const std::unique_ptr<CUDAContext>* prev_context_{nullptr};
+
+  DISABLE_COPY_AND_ASSIGN(CUDAThreadContextGuard);
+};
+
 class CudnnWorkspaceHandle {
  public:
   inline CudnnWorkspaceHandle(const CUDADeviceContext& dev_ctx, std::mutex* mtx)
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <fstream>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <numeric>
 #include <sstream>
@@ -26,6 +27,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "google/protobuf/text_format.h"
 #include "paddle/fluid/framework/block_desc.h"
@@ -33,6 +35,11 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/string/printf.h"
 
+DEFINE_string(profiler_cupti_metrics, "",
+              "The comma separated CUPTI metrics collected for each kernel by "
+              "the profiler, e.g. achieved_occupancy,dram_read_throughput. "
+              "The kernels are serialized while the metrics are collected.");
+
 namespace paddle {
 namespace platform {
 namespace {
@@ -268,6 +275,227 @@ void CUPTIAPI bufferCompleted(CUcontext ctx, uint32_t streamId, uint8_t *buffer,
   free(buffer);
 }
 
+// Collects the CUPTI metrics of each kernel given by
+// FLAGS_profiler_cupti_metrics. The counters are enabled before and read
+// after each kernel launch with the device synchronized, so the kernels are
+// serialized and the timeline is distorted while the metrics are collected.
+// The kernels are not replayed, so only the metrics whose events can be
+// collected in one pass are supported.
+class CuptiMetricCollector {
+ public:
+  explicit CuptiMetricCollector(const std::string &metric_names) {
+    std::stringstream ss(metric_names);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+      if (!name.empty()) names_.push_back(name);
+    }
+  }
+
+  ~CuptiMetricCollector() {
+    for (auto &pair : contexts_) {
+      if (pair.second.sets != nullptr) {
+        dynload::cuptiEventGroupSetsDestroy(pair.second.sets);
+      }
+    }
+  }
+
+  // The launches are serialized by mu_, which is locked from the entry to
+  // the exit of a launch on the same thread.
+  void OnLaunchEnter(CUcontext context) {
+    mu_.lock();
+    current_ = &GetContextState(context);
+    if (current_->sets == nullptr) return;
+    cudaDeviceSynchronize();
+    CUPTI_CALL(dynload::cuptiSetEventCollectionMode(
+        context, CUPTI_EVENT_COLLECTION_MODE_KERNEL));
+    CUPTI_CALL(dynload::cuptiEventGroupSetEnable(&current_->sets->sets[0]));
+    CUPTI_CALL(dynload::cuptiGetTimestamp(&start_ns_));
+  }
+
+  void OnLaunchExit(uint32_t correlation_id) {
+    std::lock_guard<std::mutex> guard(mu_, std::adopt_lock);
+    ContextState *state = current_;
+    current_ = nullptr;
+    if (state == nullptr || state->sets == nullptr) return;
+    cudaDeviceSynchronize();
+    uint64_t end_ns = 0;
+    CUPTI_CALL(dynload::cuptiGetTimestamp(&end_ns));
+    auto *set = &state->sets->sets[0];
+    std::unordered_map<CUpti_EventID, uint64_t> event_values;
+    for (uint32_t i = 0; i < set->numEventGroups; ++i) {
+      ReadEventGroup(state->device, set->eventGroups[i], &event_values);
+    }
+    CUPTI_CALL(dynload::cuptiEventGroupSetDisable(set));
+
+    auto &metrics = metrics_[correlation_id];
+    for (size_t i = 0; i < state->ids.size(); ++i) {
+      double value = 0.;
+      if (GetMetricValue(state->device, state->ids[i], event_values,
+                         end_ns - start_ns_, &value)) {
+        metrics.emplace_back(state->names[i], value);
+      }
+    }
+  }
+
+  const std::vector<std::pair<std::string, double>> *GetMetrics(
+      uint32_t correlation_id) const {
+    auto it = metrics_.find(correlation_id);
+    return it == metrics_.end() ? nullptr : &it->second;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> guard(mu_);
+    metrics_.clear();
+  }
+
+ private:
+  struct ContextState {
+    CUdevice device{0};
+    std::vector<CUpti_MetricID> ids;
+    std::vector<std::string> names;
+    CUpti_EventGroupSets *sets{nullptr};
+  };
+
+  ContextState &GetContextState(CUcontext context) {
+    auto it = contexts_.find(context);
+    if (it != contexts_.end()) return it->second;
+    auto &state = contexts_[context];
+    uint32_t device_id = 0;
+    CUPTI_CALL(dynload::cuptiGetDeviceId(context, &device_id));
+    state.device = static_cast<CUdevice>(device_id);
+    for (auto &name : names_) {
+      CUpti_MetricID id;
+      if (dynload::cuptiMetricGetIdFromName(state.device, name.c_str(), &id) !=
+          CUPTI_SUCCESS) {
+        LOG(WARNING) << "Unknown CUPTI metric " << name << " of device "
+                     << device_id << ", which is not collected.";
+        continue;
+      }
+      state.ids.push_back(id);
+      state.names.push_back(name);
+    }
+    if (state.ids.empty()) return state;
+    CUPTI_CALL(dynload::cuptiMetricCreateEventGroupSets(
+        context, sizeof(CUpti_MetricID) * state.ids.size(), state.ids.data(),
+        &state.sets));
+    if (state.sets->numSets > 1) {
+      LOG(WARNING) << "The CUPTI metrics need " << state.sets->numSets
+                   << " passes of each kernel, so they are not collected. "
+                      "Please collect fewer metrics at a time.";
+      CUPTI_CALL(dynload::cuptiEventGroupSetsDestroy(state.sets));
+      state.sets = nullptr;
+    }
+    return state;
+  }
+
+  // Reads the events of the group, normalized to all the instances of the
+  // domain on the device.
+  void ReadEventGroup(CUdevice device, CUpti_EventGroup group,
+                      std::unordered_map<CUpti_EventID, uint64_t> *values) {
+    CUpti_EventDomainID domain;
+    size_t size = sizeof(domain);
+    CUPTI_CALL(dynload::cuptiEventGroupGetAttribute(
+        group, CUPTI_EVENT_GROUP_ATTR_EVENT_DOMAIN_ID, &size, &domain));
+    uint32_t total_instances = 0;
+    size = sizeof(total_instances);
+    CUPTI_CALL(dynload::cuptiDeviceGetEventDomainAttribute(
+        device, domain, CUPTI_EVENT_DOMAIN_ATTR_TOTAL_INSTANCE_COUNT, &size,
+        &total_instances));
+    uint32_t instances = 0;
+    size = sizeof(instances);
+    CUPTI_CALL(dynload::cuptiEventGroupGetAttribute(
+        group, CUPTI_EVENT_GROUP_ATTR_INSTANCE_COUNT, &size, &instances));
+    uint32_t num_events = 0;
+    size = sizeof(num_events);
+    CUPTI_CALL(dynload::cuptiEventGroupGetAttribute(
+        group, CUPTI_EVENT_GROUP_ATTR_NUM_EVENTS, &size, &num_events));
+    std::vector<CUpti_EventID> event_ids(num_events);
+    size = sizeof(CUpti_EventID) * num_events;
+    CUPTI_CALL(dynload::cuptiEventGroupGetAttribute(
+        group, CUPTI_EVENT_GROUP_ATTR_EVENTS, &size, event_ids.data()));
+
+    std::vector<uint64_t> buffer(instances);
+    for (auto event_id : event_ids) {
+      size = sizeof(uint64_t) * instances;
+      CUPTI_CALL(dynload::cuptiEventGroupReadEvent(
+          group, CUPTI_EVENT_READ_FLAG_NONE, event_id, &size, buffer.data()));
+      uint64_t sum = std::accumulate(buffer.begin(), buffer.end(), 0UL);
+      (*values)[event_id] = instances == 0 ? 0 : sum * total_instances /
+                                                    instances;
+    }
+  }
+
+  bool GetMetricValue(
+      CUdevice device, CUpti_MetricID id,
+      const std::unordered_map<CUpti_EventID, uint64_t> &event_values,
+      uint64_t duration_ns, double *value) {
+    uint32_t num_events = 0;
+    CUPTI_CALL(dynload::cuptiMetricGetNumEvents(id, &num_events));
+    std::vector<CUpti_EventID> event_ids(num_events);
+    size_t size = sizeof(CUpti_EventID) * num_events;
+    CUPTI_CALL(dynload::cuptiMetricEnumEvents(id, &size, event_ids.data()));
+    std::vector<uint64_t> values;
+    for (auto event_id : event_ids) {
+      auto it = event_values.find(event_id);
+      if (it == event_values.end()) return false;
+      values.push_back(it->second);
+    }
+    CUpti_MetricValue metric_value;
+    if (dynload::cuptiMetricGetValue(
+            device, id, sizeof(CUpti_EventID) * event_ids.size(),
+            event_ids.data(), sizeof(uint64_t) * values.size(), values.data(),
+            duration_ns, &metric_value) != CUPTI_SUCCESS) {
+      return false;
+    }
+    CUpti_MetricValueKind kind;
+    size = sizeof(kind);
+    CUPTI_CALL(dynload::cuptiMetricGetAttribute(
+        id, CUPTI_METRIC_ATTR_VALUE_KIND, &size, &kind));
+    switch (kind) {
+      case CUPTI_METRIC_VALUE_KIND_DOUBLE:
+        *value = metric_value.metricValueDouble;
+        break;
+      case CUPTI_METRIC_VALUE_KIND_UINT64:
+        *value = static_cast<double>(metric_value.metricValueUint64);
+        break;
+      case CUPTI_METRIC_VALUE_KIND_INT64:
+        *value = static_cast<double>(metric_value.metricValueInt64);
+        break;
+      case CUPTI_METRIC_VALUE_KIND_PERCENT:
+        *value = metric_value.metricValuePercent;
+        break;
+      case CUPTI_METRIC_VALUE_KIND_THROUGHPUT:
+        *value = static_cast<double>(metric_value.metricValueThroughput);
+        break;
+      case CUPTI_METRIC_VALUE_KIND_UTILIZATION_LEVEL:
+        *value = static_cast<double>(metric_value.metricValueUtilizationLevel);
+        break;
+      default:
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<std::string> names_;
+  std::mutex mu_;
+  std::unordered_map<CUcontext, ContextState> contexts_;
+  ContextState *current_{nullptr};
+  uint64_t start_ns_{0};
+  std::unordered_map<uint32_t, std::vector<std::pair<std::string, double>>>
+      metrics_;
+};
+
+bool IsLaunchCallback(CUpti_CallbackDomain domain, CUpti_CallbackId cbid) {
+  if (domain == CUPTI_CB_DOMAIN_RUNTIME_API) {
+    return cbid == CUPTI_RUNTIME_TRACE_CBID_cudaLaunch_v3020 ||
+           cbid == CUPTI_RUNTIME_TRACE_CBID_cudaLaunchKernel_v7000;
+  }
+  return domain == CUPTI_CB_DOMAIN_DRIVER_API &&
+         (cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunch ||
+          cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunchGrid ||
+          cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunchKernel);
+}
+
 void initCuptiCbidStr();
 
 }  // namespace
@@ -341,6 +569,21 @@ class DeviceTracerImpl : public DeviceTracer {
         start_ns, end_ns, bytes, place, thread_id, alloc_in, free_in});
   }
 
+  void AddMemStatRecord(uint64_t timestamp_ns, const Place &place,
+                        size_t allocated_bytes, size_t peak_allocated_bytes,
+                        size_t reserved_bytes) {
+    thread_local std::forward_list<MemStatRecord> *local_mem_stat_record =
+        nullptr;
+    if (local_mem_stat_record == nullptr) {
+      std::lock_guard<std::mutex> l(trace_mu_);
+      mem_stat_record_.emplace_front();
+      local_mem_stat_record = &mem_stat_record_.front();
+    }
+    local_mem_stat_record->emplace_front(
+        MemStatRecord{timestamp_ns, place, allocated_bytes,
+                      peak_allocated_bytes, reserved_bytes});
+  }
+
   void AddActiveKindRecords(const std::string &anno, uint64_t start_ns,
                             uint64_t end_ns, int64_t device_id,
                             int64_t thread_id, uint32_t correlation_id) {
@@ -423,6 +666,10 @@ class DeviceTracerImpl : public DeviceTracer {
     for (auto cbid : driver_cbids)
       CUPTI_CALL(dynload::cuptiEnableCallback(
           1, subscriber_, CUPTI_CB_DOMAIN_DRIVER_API, cbid));
+    if (!FLAGS_profiler_cupti_metrics.empty()) {
+      metric_collector_.reset(
+          new CuptiMetricCollector(FLAGS_profiler_cupti_metrics));
+    }
     CUPTI_CALL(dynload::cuptiGetTimestamp(&start_ns_));
 #endif  // PADDLE_WITH_CUPTI
     enabled_ = true;
@@ -440,7 +687,11 @@ class DeviceTracerImpl : public DeviceTracer {
     for (auto &tmp : correlations_pairs) tmp.clear();
     for (auto &tmp : cpu_records_) tmp.clear();
     for (auto &tmp : mem_info_record_) tmp.clear();
+    for (auto &tmp : mem_stat_record_) tmp.clear();
     for (auto &tmp : active_kind_records_) tmp.clear();
+#ifdef PADDLE_WITH_CUPTI
+    if (metric_collector_) metric_collector_->Clear();
+#endif
   }
 
   void GenEventKernelCudaElapsedTime() {
@@ -504,6 +755,18 @@ class DeviceTracerImpl : public DeviceTracer {
       event->set_end_ns(r.end_ns);
       event->set_sub_device_id(r.stream_id);
       event->set_device_id(r.device_id);
+#ifdef PADDLE_WITH_CUPTI
+      auto *metrics = metric_collector_
+                          ? metric_collector_->GetMetrics(r.correlation_id)
+                          : nullptr;
+      if (metrics != nullptr) {
+        for (auto &metric : *metrics) {
+          auto *metric_pb = event->add_metrics();
+          metric_pb->set_name(metric.first);
+          metric_pb->set_value(metric.second);
+        }
+      }
+#endif
     }
     VLOG(1) << "KernelRecord event miss: " << miss << " find: " << find;
 
@@ -581,6 +844,28 @@ class DeviceTracerImpl : public DeviceTracer {
       }
     }
 
+    for (auto &tmp : mem_stat_record_) {
+      for (const auto &r : tmp) {
+        auto *stat = profile_pb.add_mem_stats();
+        stat->set_device_id(0);
+        if (platform::is_cpu_place(r.place)) {
+          stat->set_place(proto::MemEvent::CPUPlace);
+        } else if (platform::is_gpu_place(r.place)) {
+          stat->set_place(proto::MemEvent::CUDAPlace);
+          stat->set_device_id(
+              boost::get<platform::CUDAPlace>(r.place).GetDeviceId());
+        } else if (platform::is_cuda_pinned_place(r.place)) {
+          stat->set_place(proto::MemEvent::CUDAPinnedPlace);
+        } else {
+          PADDLE_THROW("The current place is not supported.");
+        }
+        stat->set_timestamp_ns(r.timestamp_ns);
+        stat->set_allocated_bytes(r.allocated_bytes);
+        stat->set_peak_allocated_bytes(r.peak_allocated_bytes);
+        stat->set_reserved_bytes(r.reserved_bytes);
+      }
+    }
+
     std::ofstream profile_f;
     profile_f.open(profile_path,
                    std::ios::out | std::ios::trunc | std::ios::binary);
@@ -614,8 +899,24 @@ class DeviceTracerImpl : public DeviceTracer {
       Event *event = CurAnnotation();
       tracer->AddAnnotation(cbInfo->correlationId, event);
     }
+    auto *collector = tracer->metric_collector_.get();
+    if (collector == nullptr || !IsLaunchCallback(domain, cbid)) return;
+    // The runtime launch calls the driver one inside, whose callbacks are
+    // skipped, so the metrics are of the correlation id of the outer one.
+    thread_local bool in_launch = false;
+    thread_local CUpti_CallbackDomain launch_domain;
+    if (cbInfo->callbackSite == CUPTI_API_ENTER && !in_launch) {
+      in_launch = true;
+      launch_domain = domain;
+      collector->OnLaunchEnter(cbInfo->context);
+    } else if (cbInfo->callbackSite == CUPTI_API_EXIT && in_launch &&
+               domain == launch_domain) {
+      collector->OnLaunchExit(cbInfo->correlationId);
+      in_launch = false;
+    }
   }
   CUpti_SubscriberHandle subscriber_;
+  std::unique_ptr<CuptiMetricCollector> metric_collector_;
 #endif  // PADDLE_WITH_CUPTI
   std::mutex trace_mu_;
   bool enabled_;
@@ -625,6 +926,7 @@ class DeviceTracerImpl : public DeviceTracer {
   std::forward_list<MemRecord> mem_records_;
   std::forward_list<std::forward_list<CPURecord>> cpu_records_;
   std::forward_list<std::forward_list<MemInfoRecord>> mem_info_record_;
+  std::forward_list<std::forward_list<MemStatRecord>> mem_stat_record_;
   std::forward_list<std::forward_list<ActiveKindRecord>> active_kind_records_;
   std::forward_list<std::forward_list<std::pair<uint32_t, Event *>>>
       correlations_pairs;
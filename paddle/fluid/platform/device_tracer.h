@@ -77,6 +77,14 @@ class DeviceTracer {
     std::string free_in;
   };
 
+  struct MemStatRecord {
+    uint64_t timestamp_ns;
+    Place place;
+    size_t allocated_bytes;
+    size_t peak_allocated_bytes;
+    size_t reserved_bytes;
+  };
+
   struct ActiveKindRecord {
     std::string name;
     uint64_t start_ns;
@@ -118,6 +126,11 @@ class DeviceTracer {
                                 const std::string& free_in,
                                 int64_t thread_id) = 0;
 
+  virtual void AddMemStatRecord(uint64_t timestamp_ns, const Place& place,
+                                size_t allocated_bytes,
+                                size_t peak_allocated_bytes,
+                                size_t reserved_bytes) = 0;
+
   // Add a cuda kernel stats. `correlation_id` will be mapped to annotation
   // added before for human readability.
   virtual void AddKernelRecords(std::string name, uint64_t start, uint64_t end,
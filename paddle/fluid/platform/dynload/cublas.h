@@ -92,6 +92,7 @@ CUBLAS_BLAS_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_CUBLAS_WRAP)
 #if CUDA_VERSION >= 8000
 #define CUBLAS_BLAS_ROUTINE_EACH_R2(__macro) \
   __macro(cublasGemmEx);                     \
+  __macro(cublasAxpyEx);                     \
   __macro(cublasSgemmStridedBatched);        \
   __macro(cublasDgemmStridedBatched);        \
   __macro(cublasCgemmStridedBatched);        \
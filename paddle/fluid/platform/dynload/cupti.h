@@ -61,21 +61,35 @@ extern void *cupti_dso_handle;
   extern DynLoad__##__name __name
 #endif
 
-#define CUPTI_ROUTINE_EACH(__macro)           \
-  __macro(cuptiActivityEnable);               \
-  __macro(cuptiActivityDisable);              \
-  __macro(cuptiActivityRegisterCallbacks);    \
-  __macro(cuptiActivityGetAttribute);         \
-  __macro(cuptiActivitySetAttribute);         \
-  __macro(cuptiGetTimestamp);                 \
-  __macro(cuptiActivityGetNextRecord);        \
-  __macro(cuptiGetResultString);              \
-  __macro(cuptiActivityGetNumDroppedRecords); \
-  __macro(cuptiActivityFlushAll);             \
-  __macro(cuptiSubscribe);                    \
-  __macro(cuptiUnsubscribe);                  \
-  __macro(cuptiEnableCallback);               \
-  __macro(cuptiEnableDomain);
+#define CUPTI_ROUTINE_EACH(__macro)            \
+  __macro(cuptiActivityEnable);                \
+  __macro(cuptiActivityDisable);               \
+  __macro(cuptiActivityRegisterCallbacks);     \
+  __macro(cuptiActivityGetAttribute);          \
+  __macro(cuptiActivitySetAttribute);          \
+  __macro(cuptiGetTimestamp);                  \
+  __macro(cuptiActivityGetNextRecord);         \
+  __macro(cuptiGetResultString);               \
+  __macro(cuptiActivityGetNumDroppedRecords);  \
+  __macro(cuptiActivityFlushAll);              \
+  __macro(cuptiSubscribe);                     \
+  __macro(cuptiUnsubscribe);                   \
+  __macro(cuptiEnableCallback);                \
+  __macro(cuptiEnableDomain);                  \
+  __macro(cuptiGetDeviceId);                   \
+  __macro(cuptiSetEventCollectionMode);        \
+  __macro(cuptiDeviceGetEventDomainAttribute); \
+  __macro(cuptiEventGroupGetAttribute);        \
+  __macro(cuptiEventGroupReadEvent);           \
+  __macro(cuptiEventGroupSetEnable);           \
+  __macro(cuptiEventGroupSetDisable);          \
+  __macro(cuptiEventGroupSetsDestroy);         \
+  __macro(cuptiMetricGetIdFromName);           \
+  __macro(cuptiMetricGetNumEvents);            \
+  __macro(cuptiMetricEnumEvents);              \
+  __macro(cuptiMetricGetAttribute);            \
+  __macro(cuptiMetricCreateEventGroupSets);    \
+  __macro(cuptiMetricGetValue);
 
 CUPTI_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_CUPTI_WRAP);
 
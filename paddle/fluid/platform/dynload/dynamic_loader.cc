@@ -48,6 +48,10 @@ DEFINE_string(mklml_dir, "", "Specify path for loading libmklml_intel.so.");
 
 DEFINE_string(op_dir, "", "Specify path for loading user-defined op library.");
 
+DEFINE_string(hdfs_dir, "",
+              "Specify path for loading libhdfs.so, such as "
+              "$HADOOP_HOME/lib/native.");
+
 namespace paddle {
 namespace platform {
 namespace dynload {
@@ -232,6 +236,16 @@ void* GetNVRTCDsoHandle() {
 #endif
 }
 
+void* GetNVTXDsoHandle() {
+#if defined(__APPLE__) || defined(__OSX__)
+  return GetDsoHandleFromSearchPath(FLAGS_cuda_dir, "libnvToolsExt.dylib",
+                                    false);
+#else
+  return GetDsoHandleFromSearchPath(FLAGS_cuda_dir, "libnvToolsExt.so",
+                                    false);
+#endif
+}
+
 void* GetCUDADsoHandle() {
 #if defined(__APPLE__) || defined(__OSX__)
   return GetDsoHandleFromSearchPath(FLAGS_cuda_dir, "libcuda.dylib");
@@ -282,6 +296,14 @@ void* GetMKLMLDsoHandle() {
 #endif
 }
 
+void* GetHDFSDsoHandle() {
+#if defined(__linux__)
+  return GetDsoHandleFromSearchPath(FLAGS_hdfs_dir, "libhdfs.so", false);
+#else
+  return nullptr;
+#endif
+}
+
 void* GetOpDsoHandle(const std::string& dso_name) {
 #if defined(__APPLE__) || defined(__OSX__)
   PADDLE_THROW("Do not support Apple.");
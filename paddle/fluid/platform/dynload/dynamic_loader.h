@@ -30,11 +30,13 @@ void* GetCUDNNDsoHandle();
 void* GetCUPTIDsoHandle();
 void* GetCurandDsoHandle();
 void* GetNVRTCDsoHandle();
+void* GetNVTXDsoHandle();
 void* GetCUDADsoHandle();
 void* GetWarpCTCDsoHandle();
 void* GetNCCLDsoHandle();
 void* GetTensorRtDsoHandle();
 void* GetMKLMLDsoHandle();
+void* GetHDFSDsoHandle();
 void* GetOpDsoHandle(const std::string& dso_name);
 
 void SetPaddleLibPath(const std::string&);
@@ -0,0 +1,98 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+#include <mutex>  // NOLINT
+#include "paddle/fluid/platform/dynload/dynamic_loader.h"
+#include "paddle/fluid/platform/port.h"
+
+// libhdfs ships with hadoop rather than as a build dependency, so the
+// subset of hdfs.h used by framework/io is declared here.
+extern "C" {
+typedef int32_t tSize;
+typedef time_t tTime;
+typedef int64_t tOffset;
+typedef uint16_t tPort;
+typedef enum tObjectKind {
+  kObjectKindFile = 'F',
+  kObjectKindDirectory = 'D',
+} tObjectKind;
+typedef struct hdfs_internal* hdfsFS;
+typedef struct hdfsFile_internal* hdfsFile;
+typedef struct {
+  tObjectKind mKind;
+  char* mName;
+  tTime mLastMod;
+  tOffset mSize;
+  short mReplication;  // NOLINT
+  tOffset mBlockSize;
+  char* mOwner;
+  char* mGroup;
+  short mPermissions;  // NOLINT
+  tTime mLastAccess;
+} hdfsFileInfo;
+
+hdfsFS hdfsConnect(const char* nn, tPort port);
+hdfsFS hdfsConnectAsUser(const char* nn, tPort port, const char* user);
+hdfsFile hdfsOpenFile(hdfsFS fs, const char* path, int flags, int bufferSize,
+                      short replication, tSize blocksize);  // NOLINT
+int hdfsCloseFile(hdfsFS fs, hdfsFile file);
+tSize hdfsPread(hdfsFS fs, hdfsFile file, tOffset position, void* buffer,
+                tSize length);
+hdfsFileInfo* hdfsGetPathInfo(hdfsFS fs, const char* path);
+void hdfsFreeFileInfo(hdfsFileInfo* hdfsFileInfo, int numEntries);
+}
+
+namespace paddle {
+namespace platform {
+namespace dynload {
+
+extern std::once_flag hdfs_dso_flag;
+extern void* hdfs_dso_handle;
+// Whether libhdfs.so can be loaded, the native hdfs reader falls back to
+// `hadoop fs -cat` when it can not.
+extern bool HasHDFS();
+
+#define DECLARE_DYNAMIC_LOAD_HDFS_WRAP(__name)                           \
+  struct DynLoad__##__name {                                             \
+    template <typename... Args>                                          \
+    auto operator()(Args... args) -> DECLARE_TYPE(__name, args...) {     \
+      using hdfs_func = decltype(&::__name);                             \
+      std::call_once(hdfs_dso_flag, []() {                               \
+        hdfs_dso_handle = paddle::platform::dynload::GetHDFSDsoHandle(); \
+      });                                                                \
+      static void* p_##__name = dlsym(hdfs_dso_handle, #__name);         \
+      return reinterpret_cast<hdfs_func>(p_##__name)(args...);           \
+    }                                                                    \
+  };                                                                     \
+  extern struct DynLoad__##__name __name
+
+#define HDFS_ROUTINE_EACH(__macro) \
+  __macro(hdfsConnect);            \
+  __macro(hdfsConnectAsUser);      \
+  __macro(hdfsOpenFile);           \
+  __macro(hdfsCloseFile);          \
+  __macro(hdfsPread);              \
+  __macro(hdfsGetPathInfo);        \
+  __macro(hdfsFreeFileInfo)
+
+HDFS_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_HDFS_WRAP);
+
+#undef DECLARE_DYNAMIC_LOAD_HDFS_WRAP
+
+}  // namespace dynload
+}  // namespace platform
+}  // namespace paddle
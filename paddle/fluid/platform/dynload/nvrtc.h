@@ -67,7 +67,8 @@ extern bool HasNVRTC();
   __macro(nvrtcGetPTX);             \
   __macro(nvrtcGetPTXSize);         \
   __macro(nvrtcGetProgramLog);      \
-  __macro(nvrtcGetProgramLogSize)
+  __macro(nvrtcGetProgramLogSize);  \
+  __macro(nvrtcVersion)
 
 NVRTC_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_NVRTC_WRAP);
 
@@ -45,6 +45,23 @@ DEFINE_bool(check_nan_inf, false,
             "Checking whether operator produce NAN/INF or not. It will be "
             "extremely slow so please use this flag wisely.");
 
+/**
+ * Operator related FLAG
+ * Name: FLAGS_check_nan_inf_async
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_check_nan_inf=1 FLAGS_check_nan_inf_async=1 would check
+ *          the outputs of the operators on GPU without printing or
+ *          trapping in the kernels, and raise the error naming the
+ *          operators and the tensors at the end of the step.
+ * Note: The checks of an operator only write a flag on the device, which
+ *       are read once per step by the executors, so that it can be left on
+ *       in long training jobs. The checks on CPU are synchronous.
+ */
+DEFINE_bool(check_nan_inf_async, false,
+            "Whether the NAN/INF checks of FLAGS_check_nan_inf on GPU are "
+            "recorded on the device and read once per step.");
+
 #ifdef PADDLE_WITH_CUDA
 
 /**
@@ -146,6 +163,21 @@ DEFINE_int64(cudnn_exhaustive_search_times, -1,
              "Exhaustive search times for cuDNN convolution, "
              "default is -1, not exhaustive search");
 
+/**
+ * CUDNN related FLAG
+ * Name: FLAGS_cudnn_algo_cache_file
+ * Since Version:
+ * Value Range: string, default=""
+ * Example: FLAGS_cudnn_algo_cache_file=/path/to/conv_algos.txt
+ * Note: The file to load and save the convolution algorithms found by the
+ *       exhaustive search, keyed by the convolution descriptors, the GPU
+ *       model and the cuDNN version. The algorithms saved by the previous
+ *       processes are not searched again. Empty means not saved.
+ */
+DEFINE_string(cudnn_algo_cache_file, "",
+              "The file to load and save the convolution algorithms found by "
+              "the cuDNN exhaustive search, default is empty, not saved.");
+
 /**
  * CUDNN related FLAG
  * Name: FLAGS_cudnn_batchnorm_spatial_persistent
@@ -299,11 +331,29 @@ DEFINE_double(memory_fraction_of_eager_deletion, 1.0,
               "only the FLAGS_memory_fraction_of_eager_deletion of the largest "
               "variables would be deleted.");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_eager_delete_batch_size
+ * Since Version: 2.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_eager_delete_batch_size=8 would release the garbages of
+ *          every 8 ops in one batch.
+ * Note: Only works when FLAGS_eager_delete_tensor_gb=0.0. The garbages are
+ *       released in batches, on a dedicated thread for CPU and the fast GPU
+ *       garbage collector, or by one stream callback per batch, rather than
+ *       once per op. The memory is released a little later, the rest of a
+ *       batch is released at the end of each step.
+ */
+DEFINE_int32(eager_delete_batch_size, 0,
+             "The number of ops whose garbages are released in one batch, "
+             "0 or 1 for releasing the garbages of each op.");
+
 /**
  * Allocator related FLAG
  * Name: FLAGS_allocator_strategy
  * Since Version: 1.2
- * Value Range: string, {naive_best_fit, auto_growth}, default=auto_growth
+ * Value Range: string, {naive_best_fit, auto_growth, stream_ordered},
+ *              default=auto_growth
  * Example:
  * Note: For selecting allocator policy of PaddlePaddle.
  */
@@ -314,7 +364,8 @@ static constexpr char kDefaultAllocatorStrategy[] = "auto_growth";
 #endif
 DEFINE_string(
     allocator_strategy, kDefaultAllocatorStrategy,
-    "The allocation strategy, enum in [naive_best_fit, auto_growth]. "
+    "The allocation strategy, enum in [naive_best_fit, auto_growth, "
+    "stream_ordered]. "
     "naive_best_fit means the original pre-allocated allocator of Paddle. "
     "auto_growth means the auto-growth allocator. "
     "These two strategies differ in GPU memory allocation. "
@@ -324,7 +375,9 @@ DEFINE_string(
     "size of models may be larger). auto_growth strategy would allocate "
     "GPU memory on demand, which allows users to start several Paddle jobs "
     "on the same GPU card but may lead to more memory fragmentation "
-    "(i.e., maximum batch size of models may be smaller).");
+    "(i.e., maximum batch size of models may be smaller). stream_ordered "
+    "strategy is auto_growth with GPU allocations cached per CUDA stream, "
+    "see AllocatorFacade::Alloc(place, size, stream).");
 
 /**
  * Memory related FLAG
@@ -358,6 +411,69 @@ DEFINE_double(fraction_of_cpu_memory_to_use, 1,
 DEFINE_uint64(initial_cpu_memory_in_mb, 500ul,
               "Initial CPU memory for PaddlePaddle, in MD unit.");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_numa_aware
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_numa_aware=true would bind the threads of device workers to
+ *          the NUMA nodes in turn.
+ * Note: If True, the CPU memory allocated by a thread bound to a NUMA node is
+ *       placed on the node, by the CPU memory pool of the node. It takes
+ *       effect only if the host has more than one NUMA node.
+ */
+DEFINE_bool(numa_aware, false,
+            "Whether to bind the device worker threads to NUMA nodes, and "
+            "place the CPU memory allocated by them on their nodes.");
+
+/**
+ * Performance related FLAG
+ * Name: FLAGS_cpu_thread_partition
+ * Since Version: 2.0.0
+ * Value Range: string, default=empty
+ * Example: FLAGS_cpu_thread_partition="compute=0-11;io=12-13;comm=14-15"
+ *          would bind the compute threads, e.g. of the device workers, the
+ *          predictors and OpenMP, to CPUs 0-11, the reader threads to CPUs
+ *          12-13 and the communicator threads to CPUs 14-15.
+ * Note: The pools not in the spec are not bound. The CPUs of the pools
+ *       should be disjoint.
+ */
+DEFINE_string(cpu_thread_partition, "",
+              "The partition of the CPUs between the compute, io and comm "
+              "threads, like \"compute=0-11;io=12-13;comm=14-15\". Empty "
+              "means the threads are not bound.");
+
+/**
+ * Performance related FLAG
+ * Name: FLAGS_metrics_port
+ * Since Version: 2.0.0
+ * Value Range: int32, [0, 65535], default=0
+ * Example: FLAGS_metrics_port=9100 would serve the counters of the hot
+ *          paths, e.g. the reader queues, the caches, the communicator and
+ *          the allocators, at http://host:9100/metrics in the text format
+ *          of Prometheus.
+ * Note: The server is started by InitDevices, and is disabled if it is 0.
+ */
+DEFINE_int32(metrics_port, 0,
+             "The port serving the metrics in the text format of "
+             "Prometheus at /metrics. 0 means the server is disabled.");
+
+/**
+ * Performance related FLAG
+ * Name: FLAGS_use_packed_gemm_weights
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_packed_gemm_weights=true would pack the weights of fc
+ *          and mul on CPU for the GEMM of MKL once, and reuse the packed
+ *          weights until they are changed.
+ * Note: It only takes effect with MKLML. It is meant for the inference,
+ *       since the weights updated through the buffers fused by the
+ *       optimizers are not seen as changed.
+ */
+DEFINE_bool(use_packed_gemm_weights, false,
+            "Whether to pack the unchanged weights of fc and mul on CPU for "
+            "the GEMM of MKL, which are packed once and reused.");
+
 /**
  * Memory related FLAG
  * Name: FLAGS_fraction_of_cuda_pinned_memory_to_use
@@ -457,6 +573,21 @@ DEFINE_uint64(gpu_memory_limit_mb, 0UL,
               "memory exceeds the limit even though there is available "
               "memory on the gpu card. The unit is MB and default value is 0.");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_inference_params_contiguous
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_inference_params_contiguous=true would place the parameters
+ *          of each data type in one GPU allocation when a predictor uploads
+ *          them, so that they are copied by a few large copies.
+ * Note: The memory of a parameter is not freed alone, even if it is
+ *       erased from the scope later.
+ */
+DEFINE_bool(inference_params_contiguous, false,
+            "Place the parameters uploaded to the GPU by the predictor in one "
+            "allocation of each data type.");
+
 #endif
 
 /**
@@ -472,3 +603,73 @@ DEFINE_double(local_exe_sub_scope_limit, 256.0,  // MBytes
               "each CUDAPlace. If you don't need to limit the memory, "
               "you should set FLAGS_local_exe_sub_scope_limit=-1. "
               "The default value is 256 MBytes.");
+
+/**
+ * Scope related FLAG
+ * Name: FLAGS_local_exe_scope_drop_memory_mb
+ * Since Version: 2.0.0
+ * Value Range: double, default=-1 (MB)
+ * Example: FLAGS_local_exe_scope_drop_memory_mb=8192 would drop the local
+ *          execution scopes of ParallelExecutor after the iteration when more
+ *          than 8GB is in use on any of its places, instead of every
+ *          num_iteration_per_drop_scope iterations.
+ * Note: The local execution scopes are dropped by the memory in use, or by
+ *       FLAGS_local_exe_scope_drop_fragmentation, when either of them is
+ *       positive. It is not dropped again until the memory grows beyond the
+ *       one left by the last drop, so that the memory held by the
+ *       persistable variables does not drop the scopes every iteration. It
+ *       needs FLAGS_enable_allocator_stats.
+ */
+DEFINE_double(local_exe_scope_drop_memory_mb, -1,
+              "Drop the local execution scopes when the memory in use on a "
+              "place exceeds it, in MB. The scopes are dropped every "
+              "num_iteration_per_drop_scope iterations if it and "
+              "FLAGS_local_exe_scope_drop_fragmentation are not positive.");
+
+/**
+ * Scope related FLAG
+ * Name: FLAGS_local_exe_scope_drop_fragmentation
+ * Since Version: 2.0.0
+ * Value Range: double, [0, 1), default=-1
+ * Example: FLAGS_local_exe_scope_drop_fragmentation=0.5 would drop the local
+ *          execution scopes of ParallelExecutor after the iteration when less
+ *          than half of the free memory in the chunks of a place can be
+ *          allocated at once.
+ * Note: Only the allocators reporting their chunks, such as auto_growth,
+ *       are fragmented.
+ */
+DEFINE_double(local_exe_scope_drop_fragmentation, -1,
+              "Drop the local execution scopes when the fragmentation of the "
+              "chunks of a place exceeds it.");
+
+/**
+ * IO related FLAG
+ * Name: FLAGS_async_checkpoint_max_pending_mb
+ * Since Version: 2.0.0
+ * Value Range: uint64, default=4096 (MB)
+ * Example: FLAGS_async_checkpoint_max_pending_mb=1024 would block the async
+ *          save_op and save_combine_op while the copies of the checkpoints
+ *          not written yet exceed 1GB.
+ * Note: A checkpoint larger than it is saved once the earlier checkpoints
+ *       are written.
+ */
+DEFINE_uint64(async_checkpoint_max_pending_mb, 4096,
+              "The bound of the host memory holding the copies of the "
+              "checkpoints saved asynchronously but not written yet, in MB.");
+
+/**
+ * IO related FLAG
+ * Name: FLAGS_advise_mapped_embedding_rows
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_advise_mapped_embedding_rows=true would ask the kernel to
+ *          read the pages of all the rows looked up by a batch at once, when
+ *          the embedding table is memory mapped by
+ *          AnalysisConfig::EnableMemoryMappedParams.
+ * Note: It is for the tables much larger than the page cache, whose rows are
+ *       mostly read from the disk. The rows on the pages in memory cost an
+ *       madvise call per batch for nothing.
+ */
+DEFINE_bool(advise_mapped_embedding_rows, false,
+            "Read ahead the pages of the rows looked up by a batch in the "
+            "memory mapped embedding tables.");
@@ -30,10 +30,12 @@ limitations under the License. */
 #endif
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/metrics.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/string/piece.h"
 
 DECLARE_int32(paddle_num_threads);
+DECLARE_int32(metrics_port);
 DEFINE_int32(multiple_of_cupti_buffer_size, 1,
              "Multiple of the CUPTI device buffer size. If the timestamps have "
              "been dropped when you are profiling, try increasing this value.");
@@ -153,6 +155,10 @@ void InitDevices(bool init_p2p, const std::vector<int> devices) {
   platform::SetNumThreads(FLAGS_paddle_num_threads);
 #endif
 
+  if (FLAGS_metrics_port > 0) {
+    platform::StartMetricsHttpServer(FLAGS_metrics_port);
+  }
+
 #if !defined(_WIN32) && !defined(__APPLE__) && !defined(__OSX__)
   if (platform::MayIUse(platform::avx)) {
 #ifndef __AVX__
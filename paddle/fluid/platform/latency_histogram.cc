@@ -0,0 +1,101 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace paddle {
+namespace platform {
+
+constexpr int LatencyHistogram::kNumBuckets;
+
+LatencyHistogram::LatencyHistogram() { Reset(); }
+
+int LatencyHistogram::BucketIndex(uint64_t latency_ns) {
+  if (latency_ns < static_cast<uint64_t>(kSubBuckets)) {
+    return static_cast<int>(latency_ns);
+  }
+  int exponent = 63;
+  while ((latency_ns >> exponent) == 0) --exponent;
+  if (exponent > kMaxExponent) return kNumBuckets - 1;
+  int sub_bucket = static_cast<int>(
+      (latency_ns >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+  return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+uint64_t LatencyHistogram::BucketLower(int index) {
+  if (index < kSubBuckets) return index;
+  int exponent = index / kSubBuckets + kSubBucketBits - 1;
+  uint64_t sub_bucket = index % kSubBuckets;
+  return (kSubBuckets + sub_bucket) << (exponent - kSubBucketBits);
+}
+
+uint64_t LatencyHistogram::BucketUpper(int index) {
+  if (index < kSubBuckets) return index + 1;
+  int exponent = index / kSubBuckets + kSubBucketBits - 1;
+  return BucketLower(index) + (1ULL << (exponent - kSubBucketBits));
+}
+
+void LatencyHistogram::Record(uint64_t latency_ns) {
+  buckets_[BucketIndex(latency_ns)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_ns_.fetch_add(latency_ns, std::memory_order_relaxed);
+  uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+  while (latency_ns > max_ns &&
+         !max_ns_.compare_exchange_weak(max_ns, latency_ns,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+double LatencyHistogram::MeanNs() const {
+  uint64_t count = Count();
+  return count == 0 ? 0 : static_cast<double>(SumNs()) / count;
+}
+
+double LatencyHistogram::QuantileNs(double q) const {
+  uint64_t counts[kNumBuckets];
+  uint64_t total = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) return 0;
+  q = std::min(std::max(q, 0.0), 1.0);
+  // the rank of the quantile counted from 1
+  uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      double middle = (BucketLower(i) + BucketUpper(i)) / 2.0;
+      // the quantile is never beyond the max recorded
+      return std::min(middle, static_cast<double>(MaxNs()));
+    }
+  }
+  return static_cast<double>(MaxNs());
+}
+
+void LatencyHistogram::Reset() {
+  for (auto &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_ns_.store(0, std::memory_order_relaxed);
+  max_ns_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace platform
+}  // namespace paddle
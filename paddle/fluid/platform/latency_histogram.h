@@ -0,0 +1,70 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace paddle {
+namespace platform {
+
+/*
+ * A lock-free histogram of latencies in nanoseconds, which is cheap enough
+ * to record every run in production. The buckets are log-linear: each power
+ * of two is split into kSubBuckets buckets, so a quantile is within 1 /
+ * kSubBuckets of the real value. The latencies over about half an hour fall
+ * into the last bucket.
+ *
+ * Record is thread safe, and the reads are consistent per counter only,
+ * i.e. a read racing with the writes may see a part of a record.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kMaxExponent = 40;
+  static constexpr int kNumBuckets =
+      (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+  LatencyHistogram();
+
+  void Record(uint64_t latency_ns);
+
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t SumNs() const { return sum_ns_.load(std::memory_order_relaxed); }
+  uint64_t MaxNs() const { return max_ns_.load(std::memory_order_relaxed); }
+  double MeanNs() const;
+
+  // The latency at the quantile q in [0, 1], which is the middle of the
+  // bucket holding it, or 0 if nothing is recorded.
+  double QuantileNs(double q) const;
+
+  void Reset();
+
+  static int BucketIndex(uint64_t latency_ns);
+  // The range [lower, upper) of the latencies in the bucket.
+  static uint64_t BucketLower(int index);
+  static uint64_t BucketUpper(int index);
+
+ private:
+  std::atomic<uint64_t> buckets_[kNumBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_ns_;
+  std::atomic<uint64_t> max_ns_;
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,79 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/latency_histogram.h"
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(LatencyHistogram, bucket) {
+  for (uint64_t v : {0ULL, 1ULL, 7ULL, 8ULL, 9ULL, 15ULL, 16ULL, 1000ULL,
+                     123456789ULL}) {
+    int index = LatencyHistogram::BucketIndex(v);
+    EXPECT_LE(LatencyHistogram::BucketLower(index), v);
+    EXPECT_GT(LatencyHistogram::BucketUpper(index), v);
+  }
+  for (int i = 0; i + 1 < LatencyHistogram::kNumBuckets; ++i) {
+    EXPECT_EQ(LatencyHistogram::BucketUpper(i),
+              LatencyHistogram::BucketLower(i + 1));
+  }
+  EXPECT_EQ(LatencyHistogram::BucketIndex(~0ULL),
+            LatencyHistogram::kNumBuckets - 1);
+}
+
+TEST(LatencyHistogram, quantile) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.QuantileNs(0.5), 0);
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    histogram.Record(v * 1000);
+  }
+  EXPECT_EQ(histogram.Count(), 1000UL);
+  EXPECT_EQ(histogram.MaxNs(), 1000000UL);
+  EXPECT_DOUBLE_EQ(histogram.MeanNs(), 500500);
+  for (double q : {0.5, 0.9, 0.99}) {
+    double expected = q * 1000000;
+    EXPECT_NEAR(histogram.QuantileNs(q), expected,
+                expected / LatencyHistogram::kSubBuckets);
+  }
+  EXPECT_LE(histogram.QuantileNs(1), histogram.MaxNs());
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.Count(), 0UL);
+  EXPECT_EQ(histogram.MaxNs(), 0UL);
+}
+
+TEST(LatencyHistogram, concurrent_record) {
+  const int kThreads = 4;
+  const int kRecords = 10000;
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < kRecords; ++j) {
+        histogram.Record(i * kRecords + j);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(histogram.Count(), static_cast<uint64_t>(kThreads * kRecords));
+  EXPECT_EQ(histogram.MaxNs(), static_cast<uint64_t>(kThreads * kRecords - 1));
+}
+
+}  // namespace platform
+}  // namespace paddle
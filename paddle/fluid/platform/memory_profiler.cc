@@ -0,0 +1,277 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/memory_profiler.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+constexpr int kNumMemoryCategories =
+    static_cast<int>(MemoryCategory::kOther) + 1;
+
+thread_local const std::string* current_op_type = nullptr;
+
+// the same clock as PosixInNsec, so that the timeline is aligned with the
+// timeline of profiler
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::vector<std::pair<std::string, size_t>> SortAndTruncate(
+    const std::unordered_map<std::string, size_t>& bytes, size_t top_n) {
+  std::vector<std::pair<std::string, size_t>> sorted(bytes.begin(),
+                                                     bytes.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<std::string, size_t>& a,
+               const std::pair<std::string, size_t>& b) {
+              return a.second != b.second ? a.second > b.second
+                                          : a.first < b.first;
+            });
+  if (sorted.size() > top_n) {
+    sorted.resize(top_n);
+  }
+  return sorted;
+}
+
+std::string PlaceName(const Place& place) {
+  std::ostringstream os;
+  os << place;
+  return os.str();
+}
+
+}  // namespace
+
+std::atomic<bool> MemoryProfiler::enabled_{false};
+
+const char* MemoryCategoryName(MemoryCategory category) {
+  switch (category) {
+    case MemoryCategory::kParameter:
+      return "parameter";
+    case MemoryCategory::kGradient:
+      return "gradient";
+    case MemoryCategory::kOptimizerState:
+      return "optimizer_state";
+    case MemoryCategory::kActivation:
+      return "activation";
+    case MemoryCategory::kWorkspace:
+      return "workspace";
+    default:
+      return "other";
+  }
+}
+
+MemoryProfiler& MemoryProfiler::Instance() {
+  static MemoryProfiler profiler;
+  return profiler;
+}
+
+void MemoryProfiler::Enable() {
+  std::lock_guard<std::mutex> guard(mu_);
+  records_.clear();
+  events_.clear();
+  live_.clear();
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void MemoryProfiler::Disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void MemoryProfiler::RecordAlloc(const void* ptr, size_t size,
+                                 const Place& place) {
+  if (!IsEnabled()) return;
+  std::lock_guard<std::mutex> guard(mu_);
+  size_t index = records_.size();
+  records_.push_back(Record{size, place,
+                            current_op_type ? *current_op_type : "", "",
+                            MemoryCategory::kOther});
+  events_.push_back(Event{NowNs(), index, true});
+  live_[place][ptr] = index;
+}
+
+void MemoryProfiler::RecordFree(const void* ptr, const Place& place) {
+  if (!IsEnabled()) return;
+  std::lock_guard<std::mutex> guard(mu_);
+  auto place_iter = live_.find(place);
+  if (place_iter == live_.end()) return;
+  // the allocations before the profiler is enabled are not recorded
+  auto iter = place_iter->second.find(ptr);
+  if (iter == place_iter->second.end()) return;
+  events_.push_back(Event{NowNs(), iter->second, false});
+  place_iter->second.erase(iter);
+}
+
+void MemoryProfiler::Annotate(const void* ptr, const Place& place,
+                              const std::string& var_name,
+                              MemoryCategory category) {
+  if (!IsEnabled()) return;
+  std::lock_guard<std::mutex> guard(mu_);
+  auto place_iter = live_.find(place);
+  if (place_iter == live_.end()) return;
+  auto iter = place_iter->second.find(ptr);
+  if (iter == place_iter->second.end()) return;
+  auto& record = records_[iter->second];
+  record.var_name = var_name;
+  record.category = category;
+}
+
+MemoryCategory MemoryProfiler::CategoryOf(const Record& record) const {
+  if (!record.var_name.empty()) {
+    return record.category;
+  }
+  return record.op_type.empty() ? MemoryCategory::kOther
+                                : MemoryCategory::kWorkspace;
+}
+
+std::vector<MemoryPeak> MemoryProfiler::GetPeaks(size_t top_n) const {
+  std::lock_guard<std::mutex> guard(mu_);
+  // find the event at the peak of each place, the first one if tied
+  std::map<Place, size_t> live_bytes;
+  std::map<Place, std::pair<size_t, size_t>> peak_events;
+  for (size_t i = 0; i < events_.size(); ++i) {
+    auto& record = records_[events_[i].record];
+    auto& bytes = live_bytes[record.place];
+    if (events_[i].alloc) {
+      bytes += record.size;
+      auto& peak = peak_events[record.place];
+      if (bytes > peak.first) {
+        peak = std::make_pair(bytes, i);
+      }
+    } else {
+      bytes -= record.size;
+    }
+  }
+
+  std::vector<MemoryPeak> peaks;
+  for (auto& pair : peak_events) {
+    auto& place = pair.first;
+    size_t peak_event = pair.second.second;
+    std::unordered_set<size_t> live;
+    for (size_t i = 0; i <= peak_event; ++i) {
+      auto& event = events_[i];
+      if (!is_same_place(records_[event.record].place, place)) continue;
+      if (event.alloc) {
+        live.insert(event.record);
+      } else {
+        live.erase(event.record);
+      }
+    }
+
+    MemoryPeak peak;
+    peak.place = place;
+    peak.time_ns = events_[peak_event].time_ns;
+    peak.peak_bytes = pair.second.first;
+    std::unordered_map<std::string, size_t> op_bytes;
+    std::unordered_map<std::string, size_t> var_bytes;
+    for (size_t index : live) {
+      auto& record = records_[index];
+      peak.category_bytes[CategoryOf(record)] += record.size;
+      op_bytes[record.op_type.empty() ? "(none)" : record.op_type] +=
+          record.size;
+      var_bytes[record.var_name.empty() ? "(temporary)" : record.var_name] +=
+          record.size;
+    }
+    peak.op_bytes = SortAndTruncate(op_bytes, top_n);
+    peak.var_bytes = SortAndTruncate(var_bytes, top_n);
+    peaks.emplace_back(std::move(peak));
+  }
+  return peaks;
+}
+
+std::string MemoryProfiler::Report(size_t top_n) const {
+  auto peaks = GetPeaks(top_n);
+  std::ostringstream os;
+  os << "\n------------------------->"
+     << "   Memory Peak Report   "
+     << "<-------------------------\n";
+  os.setf(std::ios::left);
+  auto mb = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+  for (auto& peak : peaks) {
+    os << "\nPlace: " << peak.place << "  Peak(MB): " << mb(peak.peak_bytes)
+       << "\n\n";
+    os << std::setw(40) << "Category" << "Size(MB)\n";
+    for (auto& pair : peak.category_bytes) {
+      os << std::setw(40) << MemoryCategoryName(pair.first) << mb(pair.second)
+         << "\n";
+    }
+    os << "\n" << std::setw(40) << "Operator" << "Size(MB)\n";
+    for (auto& pair : peak.op_bytes) {
+      os << std::setw(40) << pair.first << mb(pair.second) << "\n";
+    }
+    os << "\n" << std::setw(40) << "Variable" << "Size(MB)\n";
+    for (auto& pair : peak.var_bytes) {
+      os << std::setw(40) << pair.first << mb(pair.second) << "\n";
+    }
+  }
+  return os.str();
+}
+
+void MemoryProfiler::ExportTimeline(const std::string& path) const {
+  std::ofstream fout(path);
+  PADDLE_ENFORCE_EQ(fout.is_open(), true,
+                    platform::errors::Unavailable(
+                        "Failed to open %s to export the memory timeline.",
+                        path));
+  std::lock_guard<std::mutex> guard(mu_);
+  // the live bytes of each category of the places
+  std::map<Place, std::vector<size_t>> live_bytes;
+  fout << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto& event : events_) {
+    auto& record = records_[event.record];
+    auto& bytes = live_bytes[record.place];
+    bytes.resize(kNumMemoryCategories, 0);
+    auto& category_bytes = bytes[static_cast<int>(CategoryOf(record))];
+    if (event.alloc) {
+      category_bytes += record.size;
+    } else {
+      category_bytes -= record.size;
+    }
+    fout << (first ? "" : ",") << "\n{\"name\":\"memory "
+         << PlaceName(record.place) << "\",\"ph\":\"C\",\"pid\":\"memory\","
+         << "\"ts\":" << event.time_ns / 1000 << "."
+         << std::setfill('0') << std::setw(3) << event.time_ns % 1000
+         << std::setfill(' ') << ",\"args\":{";
+    for (int i = 0; i < kNumMemoryCategories; ++i) {
+      fout << (i == 0 ? "" : ",") << "\""
+           << MemoryCategoryName(static_cast<MemoryCategory>(i))
+           << "\":" << bytes[i];
+    }
+    fout << "}}";
+    first = false;
+  }
+  fout << "\n]}\n";
+}
+
+MemoryProfiler::OpScope::OpScope(const std::string* op_type)
+    : prev_(current_op_type) {
+  current_op_type = op_type;
+}
+
+MemoryProfiler::OpScope::~OpScope() { current_op_type = prev_; }
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,134 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace platform {
+
+enum class MemoryCategory {
+  kParameter,
+  kGradient,
+  kOptimizerState,
+  kActivation,
+  // the temporaries allocated inside the operators, e.g. cuDNN workspace
+  kWorkspace,
+  kOther,
+};
+
+const char* MemoryCategoryName(MemoryCategory category);
+
+// The bytes alive when the allocated bytes of a place are at the peak.
+struct MemoryPeak {
+  Place place;
+  uint64_t time_ns{0};
+  size_t peak_bytes{0};
+  std::map<MemoryCategory, size_t> category_bytes;
+  // sorted by the bytes in the descending order
+  std::vector<std::pair<std::string, size_t>> op_bytes;
+  std::vector<std::pair<std::string, size_t>> var_bytes;
+};
+
+/*
+ * MemoryProfiler records the allocations of AllocatorFacade, once it is
+ * enabled, with the operators allocating them. The operators then attribute
+ * the allocations holding their outputs to the variables and the categories,
+ * so that the live bytes at the peak can be broken down, and the timeline of
+ * the categories can be exported, e.g. to plan the batch size and recompute.
+ *
+ * The allocations not attributed to a variable are the temporaries of the
+ * operators allocating them, like the cuDNN workspace.
+ */
+class MemoryProfiler {
+ public:
+  static MemoryProfiler& Instance();
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Clears the records of the last profiling.
+  void Enable();
+
+  void Disable();
+
+  void RecordAlloc(const void* ptr, size_t size, const Place& place);
+
+  void RecordFree(const void* ptr, const Place& place);
+
+  // Attribute the live allocation at ptr, which is ignored if it is not the
+  // start of an allocation recorded.
+  void Annotate(const void* ptr, const Place& place,
+                const std::string& var_name, MemoryCategory category);
+
+  std::vector<MemoryPeak> GetPeaks(size_t top_n = 10) const;
+
+  std::string Report(size_t top_n = 10) const;
+
+  // Export the live bytes of the categories in the chrome trace format, which
+  // can be opened in chrome://tracing along with the timeline of profiler.
+  void ExportTimeline(const std::string& path) const;
+
+  // Set the operator whose allocations are recorded in the thread.
+  class OpScope {
+   public:
+    explicit OpScope(const std::string* op_type);
+    ~OpScope();
+
+   private:
+    const std::string* prev_;
+    DISABLE_COPY_AND_ASSIGN(OpScope);
+  };
+
+ private:
+  struct Record {
+    size_t size;
+    Place place;
+    std::string op_type;
+    std::string var_name;
+    MemoryCategory category;
+  };
+
+  struct Event {
+    uint64_t time_ns;
+    size_t record;
+    bool alloc;
+  };
+
+  MemoryProfiler() = default;
+
+  MemoryCategory CategoryOf(const Record& record) const;
+
+  static std::atomic<bool> enabled_;
+
+  mutable std::mutex mu_;
+  std::vector<Record> records_;
+  std::vector<Event> events_;
+  // the records of the live allocations
+  std::map<Place, std::unordered_map<const void*, size_t>> live_;
+
+  DISABLE_COPY_AND_ASSIGN(MemoryProfiler);
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,88 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/memory_profiler.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(MemoryProfiler, peak) {
+  auto& profiler = MemoryProfiler::Instance();
+  CPUPlace place;
+  int buffers[4];
+  profiler.RecordAlloc(&buffers[0], 100, place);
+  EXPECT_TRUE(profiler.GetPeaks().empty());
+
+  profiler.Enable();
+  // allocated before enabled
+  profiler.RecordFree(&buffers[0], place);
+  std::string fc = "fc";
+  std::string conv = "conv2d";
+  {
+    MemoryProfiler::OpScope scope(&fc);
+    profiler.RecordAlloc(&buffers[0], 100, place);
+    profiler.Annotate(&buffers[0], place, "fc_0.w_0",
+                      MemoryCategory::kParameter);
+    profiler.RecordAlloc(&buffers[1], 50, place);
+    profiler.Annotate(&buffers[1], place, "fc_0.tmp_0",
+                      MemoryCategory::kActivation);
+  }
+  {
+    MemoryProfiler::OpScope scope(&conv);
+    // the workspace of conv2d
+    profiler.RecordAlloc(&buffers[2], 200, place);
+    profiler.RecordAlloc(&buffers[3], 10, place);
+    profiler.Annotate(&buffers[3], place, "conv2d_0.tmp_0",
+                      MemoryCategory::kActivation);
+    profiler.RecordFree(&buffers[2], place);
+  }
+  profiler.RecordFree(&buffers[1], place);
+  profiler.Disable();
+  profiler.RecordAlloc(&buffers[1], 1000, place);
+
+  auto peaks = profiler.GetPeaks(2);
+  ASSERT_EQ(peaks.size(), 1UL);
+  auto& peak = peaks[0];
+  EXPECT_EQ(peak.peak_bytes, 360UL);
+  EXPECT_EQ(peak.category_bytes[MemoryCategory::kParameter], 100UL);
+  EXPECT_EQ(peak.category_bytes[MemoryCategory::kActivation], 60UL);
+  EXPECT_EQ(peak.category_bytes[MemoryCategory::kWorkspace], 200UL);
+  ASSERT_EQ(peak.op_bytes.size(), 2UL);
+  EXPECT_EQ(peak.op_bytes[0].first, "conv2d");
+  EXPECT_EQ(peak.op_bytes[0].second, 210UL);
+  EXPECT_EQ(peak.op_bytes[1].first, "fc");
+  EXPECT_EQ(peak.op_bytes[1].second, 150UL);
+  ASSERT_EQ(peak.var_bytes.size(), 2UL);
+  EXPECT_EQ(peak.var_bytes[0].first, "(temporary)");
+  EXPECT_EQ(peak.var_bytes[1].first, "fc_0.w_0");
+
+  EXPECT_NE(profiler.Report().find("workspace"), std::string::npos);
+
+  std::string path = "memory_profiler_test_timeline.json";
+  profiler.ExportTimeline(path);
+  std::ifstream fin(path);
+  std::stringstream timeline;
+  timeline << fin.rdbuf();
+  EXPECT_EQ(timeline.str().find("{\"traceEvents\":["), 0UL);
+  EXPECT_NE(timeline.str().find("\"workspace\":200"), std::string::npos);
+  std::remove(path.c_str());
+}
+
+}  // namespace platform
+}  // namespace paddle
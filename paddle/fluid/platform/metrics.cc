@@ -0,0 +1,186 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/metrics.h"
+#include <sstream>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99};
+
+std::string EscapeHelp(const std::string& help) {
+  std::string escaped;
+  escaped.reserve(help.size());
+  for (char c : help) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+// Append the labels in braces, e.g. {place="gpu:0",quantile="0.5"}.
+void WriteLabels(std::ostream& os, const std::string& labels,
+                 const std::string& extra = "") {
+  if (labels.empty() && extra.empty()) {
+    return;
+  }
+  os << "{" << labels;
+  if (!labels.empty() && !extra.empty()) {
+    os << ",";
+  }
+  os << extra << "}";
+}
+
+}  // namespace
+
+MetricsRegistry& MetricsRegistry::Instance() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricsRegistry::Metric* MetricsRegistry::GetMetric(const std::string& name,
+                                                    const std::string& help,
+                                                    const std::string& labels,
+                                                    Type type) {
+  PADDLE_ENFORCE_EQ(name.empty(), false,
+                    platform::errors::InvalidArgument(
+                        "The name of the metric should not be empty."));
+  auto iter = families_.find(name);
+  if (iter == families_.end()) {
+    iter = families_.emplace(name, Family{type, help, {}}).first;
+  }
+  auto& family = iter->second;
+  // The callbacks are exported as gauges, so they share the families.
+  bool is_gauge = type == Type::kGauge || type == Type::kGaugeCallback;
+  bool family_is_gauge =
+      family.type == Type::kGauge || family.type == Type::kGaugeCallback;
+  PADDLE_ENFORCE_EQ(
+      family.type == type || (is_gauge && family_is_gauge), true,
+      platform::errors::InvalidArgument(
+          "The metric %s is registered as another type before.", name));
+  return &family.metrics[labels];
+}
+
+MetricCounter* MetricsRegistry::Counter(const std::string& name,
+                                        const std::string& help,
+                                        const std::string& labels) {
+  std::lock_guard<std::mutex> guard(mu_);
+  auto* metric = GetMetric(name, help, labels, Type::kCounter);
+  if (!metric->counter) {
+    metric->counter.reset(new MetricCounter());
+  }
+  return metric->counter.get();
+}
+
+MetricGauge* MetricsRegistry::Gauge(const std::string& name,
+                                    const std::string& help,
+                                    const std::string& labels) {
+  std::lock_guard<std::mutex> guard(mu_);
+  auto* metric = GetMetric(name, help, labels, Type::kGauge);
+  PADDLE_ENFORCE_EQ(!metric->callback, true,
+                    platform::errors::InvalidArgument(
+                        "The gauge %s{%s} is registered with a callback.",
+                        name, labels));
+  if (!metric->gauge) {
+    metric->gauge.reset(new MetricGauge());
+  }
+  return metric->gauge.get();
+}
+
+LatencyHistogram* MetricsRegistry::Histogram(const std::string& name,
+                                             const std::string& help,
+                                             const std::string& labels) {
+  std::lock_guard<std::mutex> guard(mu_);
+  auto* metric = GetMetric(name, help, labels, Type::kHistogram);
+  if (!metric->histogram) {
+    metric->histogram.reset(new LatencyHistogram());
+  }
+  return metric->histogram.get();
+}
+
+void MetricsRegistry::RegisterGaugeCallback(const std::string& name,
+                                            const std::string& help,
+                                            GaugeCallback callback,
+                                            const std::string& labels) {
+  std::lock_guard<std::mutex> guard(mu_);
+  auto* metric = GetMetric(name, help, labels, Type::kGaugeCallback);
+  PADDLE_ENFORCE_EQ(metric->gauge == nullptr, true,
+                    platform::errors::InvalidArgument(
+                        "The gauge %s{%s} is registered without a callback.",
+                        name, labels));
+  metric->callback = std::move(callback);
+}
+
+std::string MetricsRegistry::ExportPrometheus() const {
+  std::lock_guard<std::mutex> guard(mu_);
+  std::ostringstream os;
+  for (auto& pair : families_) {
+    auto& name = pair.first;
+    auto& family = pair.second;
+    if (!family.help.empty()) {
+      os << "# HELP " << name << " " << EscapeHelp(family.help) << "\n";
+    }
+    os << "# TYPE " << name << " "
+       << (family.type == Type::kCounter
+               ? "counter"
+               : family.type == Type::kHistogram ? "summary" : "gauge")
+       << "\n";
+    for (auto& labeled : family.metrics) {
+      auto& labels = labeled.first;
+      auto& metric = labeled.second;
+      if (metric.histogram) {
+        for (double q : kQuantiles) {
+          std::ostringstream quantile;
+          quantile << "quantile=\"" << q << "\"";
+          os << name;
+          WriteLabels(os, labels, quantile.str());
+          os << " " << metric.histogram->QuantileNs(q) << "\n";
+        }
+        os << name << "_sum";
+        WriteLabels(os, labels);
+        os << " " << metric.histogram->SumNs() << "\n";
+        os << name << "_count";
+        WriteLabels(os, labels);
+        os << " " << metric.histogram->Count() << "\n";
+        continue;
+      }
+      os << name;
+      WriteLabels(os, labels);
+      if (metric.counter) {
+        os << " " << metric.counter->Value() << "\n";
+      } else if (metric.gauge) {
+        os << " " << metric.gauge->Value() << "\n";
+      } else if (metric.callback) {
+        os << " " << metric.callback() << "\n";
+      } else {
+        os << " 0\n";
+      }
+    }
+  }
+  return os.str();
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,134 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include "paddle/fluid/platform/latency_histogram.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace platform {
+
+/*
+ * The registry of the counters, the gauges and the histograms of the hot
+ * paths, e.g. the queues of the readers, the caches and the communicator,
+ * which are exported in the text format of Prometheus, see
+ * StartMetricsHttpServer. The metrics are created when they are got first,
+ * and live until the process ends, so that the hot paths can get them once
+ * and update them without lock, e.g.
+ *
+ *   static auto* hits = platform::MetricsRegistry::Instance().Counter(
+ *       "paddle_scope_cache_hits_total", "The hits of the cache.");
+ *   hits->Add();
+ *
+ * A metric is identified by its name and its labels, like
+ * place="gpu:0",type="h2d", and the metrics of a name are of the same type.
+ */
+
+class MetricCounter {
+ public:
+  void Add(int64_t value = 1) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+class MetricGauge {
+ public:
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+
+  void Add(int64_t value) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+class MetricsRegistry {
+ public:
+  using GaugeCallback = std::function<double()>;
+
+  static MetricsRegistry& Instance();
+
+  MetricCounter* Counter(const std::string& name, const std::string& help,
+                         const std::string& labels = "");
+
+  MetricGauge* Gauge(const std::string& name, const std::string& help,
+                     const std::string& labels = "");
+
+  // The histogram of the values, e.g. the latencies in nanoseconds, which is
+  // exported as a summary of the quantiles.
+  LatencyHistogram* Histogram(const std::string& name, const std::string& help,
+                              const std::string& labels = "");
+
+  // Register the gauge whose value is read by callback when it is exported,
+  // e.g. the bytes allocated by an allocator, replacing the callback
+  // registered before for the name and the labels.
+  void RegisterGaugeCallback(const std::string& name, const std::string& help,
+                             GaugeCallback callback,
+                             const std::string& labels = "");
+
+  // The metrics in the text format of Prometheus, sorted by the names.
+  std::string ExportPrometheus() const;
+
+ private:
+  enum class Type { kCounter, kGauge, kHistogram, kGaugeCallback };
+
+  struct Metric {
+    std::unique_ptr<MetricCounter> counter;
+    std::unique_ptr<MetricGauge> gauge;
+    std::unique_ptr<LatencyHistogram> histogram;
+    GaugeCallback callback;
+  };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<std::string, Metric> metrics;
+  };
+
+  MetricsRegistry() = default;
+
+  Metric* GetMetric(const std::string& name, const std::string& help,
+                    const std::string& labels, Type type);
+
+  mutable std::mutex mu_;
+  std::map<std::string, Family> families_;
+
+  DISABLE_COPY_AND_ASSIGN(MetricsRegistry);
+};
+
+// Serve GET /metrics with MetricsRegistry::ExportPrometheus() on a thread,
+// port 0 for any free port. Returns the port listened on. Only one server
+// runs in a process.
+int StartMetricsHttpServer(int port);
+
+void StopMetricsHttpServer();
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,190 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/metrics.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+namespace paddle {
+namespace platform {
+
+#ifdef __linux__
+namespace {
+
+// The timeout of poll, in which the server sees it is stopped.
+constexpr int kPollTimeoutMs = 100;
+constexpr size_t kMaxRequestSize = 8192;
+
+struct MetricsServer {
+  std::mutex mu;
+  int fd{-1};
+  int port{0};
+  std::atomic<bool> stopped{true};
+  std::thread thread;
+};
+
+MetricsServer &GetServer() {
+  static MetricsServer server;
+  return server;
+}
+
+void WriteAll(int fd, const std::string &data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    ssize_t n = send(fd, data.data() + offset, data.size() - offset,
+                     MSG_NOSIGNAL);
+    if (n <= 0) {
+      return;
+    }
+    offset += static_cast<size_t>(n);
+  }
+}
+
+void HandleConnection(int fd) {
+  std::string request;
+  char buf[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.size() < kMaxRequestSize) {
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, 1000) <= 0) {
+      return;
+    }
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+      return;
+    }
+    request.append(buf, static_cast<size_t>(n));
+  }
+
+  std::string status = "404 Not Found";
+  std::string body = "Not Found\n";
+  auto line_end = request.find("\r\n");
+  std::string line = request.substr(0, line_end);
+  if (line.compare(0, 13, "GET /metrics ") == 0 || line == "GET /metrics") {
+    status = "200 OK";
+    body = MetricsRegistry::Instance().ExportPrometheus();
+  }
+  std::string response = "HTTP/1.1 " + status +
+                         "\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: " +
+                         std::to_string(body.size()) +
+                         "\r\nConnection: close\r\n\r\n" + body;
+  WriteAll(fd, response);
+}
+
+void ServeLoop(MetricsServer *server, int fd) {
+  while (!server->stopped.load(std::memory_order_acquire)) {
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, kPollTimeoutMs) <= 0) {
+      continue;
+    }
+    int conn = accept(fd, nullptr, nullptr);
+    if (conn < 0) {
+      continue;
+    }
+    HandleConnection(conn);
+    close(conn);
+  }
+}
+
+}  // namespace
+
+int StartMetricsHttpServer(int port) {
+  PADDLE_ENFORCE_EQ(port >= 0 && port < 65536, true,
+                    platform::errors::InvalidArgument(
+                        "The port of the metrics server should be in "
+                        "[0, 65535], but received %d.",
+                        port));
+  auto &server = GetServer();
+  std::lock_guard<std::mutex> guard(server.mu);
+  if (!server.stopped.load()) {
+    PADDLE_ENFORCE_EQ(port == 0 || port == server.port, true,
+                      platform::errors::AlreadyExists(
+                          "The metrics server is listening on port %d.",
+                          server.port));
+    return server.port;
+  }
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  PADDLE_ENFORCE_GE(fd, 0, platform::errors::Unavailable(
+                               "Failed to create the socket of the metrics "
+                               "server: %s.",
+                               strerror(errno)));
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, 16) != 0) {
+    std::string error = strerror(errno);
+    close(fd);
+    PADDLE_THROW(platform::errors::Unavailable(
+        "Failed to listen on port %d for the metrics server: %s.", port,
+        error));
+  }
+  socklen_t len = sizeof(addr);
+  getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+
+  server.fd = fd;
+  server.port = ntohs(addr.sin_port);
+  server.stopped.store(false, std::memory_order_release);
+  server.thread = std::thread(ServeLoop, &server, fd);
+  VLOG(1) << "The metrics server is listening on port " << server.port;
+  return server.port;
+}
+
+void StopMetricsHttpServer() {
+  auto &server = GetServer();
+  std::lock_guard<std::mutex> guard(server.mu);
+  if (server.stopped.load()) {
+    return;
+  }
+  server.stopped.store(true, std::memory_order_release);
+  server.thread.join();
+  close(server.fd);
+  server.fd = -1;
+  server.port = 0;
+}
+
+#else
+
+int StartMetricsHttpServer(int port) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The metrics server is only supported on Linux."));
+}
+
+void StopMetricsHttpServer() {}
+
+#endif
+
+}  // namespace platform
+}  // namespace paddle
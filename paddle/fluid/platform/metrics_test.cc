@@ -0,0 +1,132 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/metrics.h"
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(Metrics, counter_and_gauge) {
+  auto& registry = MetricsRegistry::Instance();
+  auto* counter = registry.Counter("test_counter_total", "The counter.");
+  EXPECT_EQ(counter, registry.Counter("test_counter_total", "The counter."));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([counter] {
+      for (int j = 0; j < 1000; ++j) {
+        counter->Add();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter->Value(), 4000);
+
+  auto* gauge = registry.Gauge("test_gauge", "The gauge.", "place=\"cpu\"");
+  gauge->Set(10);
+  gauge->Add(-3);
+  EXPECT_EQ(gauge->Value(), 7);
+
+  EXPECT_THROW(registry.Gauge("test_counter_total", "The counter."),
+               platform::EnforceNotMet);
+  EXPECT_THROW(registry.RegisterGaugeCallback(
+                   "test_gauge", "The gauge.", [] { return 1.0; },
+                   "place=\"cpu\""),
+               platform::EnforceNotMet);
+}
+
+TEST(Metrics, export) {
+  auto& registry = MetricsRegistry::Instance();
+  registry.Counter("test_export_total", "The line\nbreak.")->Add(3);
+  registry.RegisterGaugeCallback("test_export_bytes", "The bytes.",
+                                 [] { return 42.0; }, "place=\"gpu:0\"");
+  auto* histogram = registry.Histogram("test_export_ns", "The latency.",
+                                       "queue=\"reader\"");
+  histogram->Record(100);
+  histogram->Record(300);
+
+  std::string text = registry.ExportPrometheus();
+  auto contains = [&text](const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+  };
+  EXPECT_TRUE(contains("# HELP test_export_total The line\\nbreak."));
+  EXPECT_TRUE(contains("# TYPE test_export_total counter"));
+  EXPECT_TRUE(contains("test_export_total 3"));
+  EXPECT_TRUE(contains("# TYPE test_export_bytes gauge"));
+  EXPECT_TRUE(contains("test_export_bytes{place=\"gpu:0\"} 42"));
+  EXPECT_TRUE(contains("# TYPE test_export_ns summary"));
+  EXPECT_NE(text.find("test_export_ns{queue=\"reader\",quantile=\"0.5\"} "),
+            std::string::npos);
+  EXPECT_TRUE(contains("test_export_ns_sum{queue=\"reader\"} 400"));
+  EXPECT_TRUE(contains("test_export_ns_count{queue=\"reader\"} 2"));
+}
+
+#ifdef __linux__
+std::string HttpGet(int port, const std::string& path) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return "";
+  }
+  std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  send(fd, request.data(), request.size(), 0);
+  std::string response;
+  char buf[1024];
+  ssize_t n;
+  while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+    response.append(buf, static_cast<size_t>(n));
+  }
+  close(fd);
+  return response;
+}
+
+TEST(Metrics, http_server) {
+  MetricsRegistry::Instance().Counter("test_http_total", "The requests.")->Add();
+  int port = StartMetricsHttpServer(0);
+  ASSERT_GT(port, 0);
+  EXPECT_EQ(StartMetricsHttpServer(0), port);
+
+  std::string response = HttpGet(port, "/metrics");
+  EXPECT_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+  EXPECT_NE(response.find("text/plain; version=0.0.4"), std::string::npos);
+  EXPECT_NE(response.find("\ntest_http_total 1\n"), std::string::npos);
+  response = HttpGet(port, "/");
+  EXPECT_EQ(response.compare(0, 12, "HTTP/1.1 404"), 0);
+
+  StopMetricsHttpServer();
+  EXPECT_EQ(HttpGet(port, "/metrics"), "");
+}
+#endif
+
+}  // namespace platform
+}  // namespace paddle
@@ -49,13 +49,22 @@ class MKLDNNHandlerT {
     }
   }
 
+  // The forward primitive is immutable once created and keeps no scratchpad
+  // of its own (the scratchpad of DNNL is global per thread), so like the
+  // forward PD it is created once and shared by all the threads.
   std::shared_ptr<TForward> AcquireForwardPrimitive() {
-    const std::string key_p = key_ + "@forward_p";
+    const std::string key_p = key_common_ + "@forward_p";
     auto forward_p =
         std::static_pointer_cast<TForward>(dev_ctx_.GetBlob(key_p));
     if (forward_p == nullptr) {
-      forward_p = std::make_shared<TForward>(*fwd_pd_);
-      dev_ctx_.SetBlob(key_p, forward_p);
+      static std::mutex acquire_barrier;
+      std::lock_guard<std::mutex> block_threads_until_finish_this_job(
+          acquire_barrier);
+      forward_p = std::static_pointer_cast<TForward>(dev_ctx_.GetBlob(key_p));
+      if (forward_p == nullptr) {
+        forward_p = std::make_shared<TForward>(*fwd_pd_);
+        dev_ctx_.SetBlob(key_p, forward_p);
+      }
     }
     return forward_p;
   }
@@ -298,13 +307,44 @@ class MKLDNNHandler {
     // create reorder primitive if the input format is not the preferred one
     auto local_key = key_ + suffix;
     auto key_reorder_p = key_ + suffix + "reorder_p";
-
-    auto target_memory_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+    // The persistent memory reordered from the user memory, e.g., the weights
+    // for inference, is read-only, so it is reordered once and shared by all
+    // the threads.
+    auto shared_key = key_common_ + suffix;
+
+    std::shared_ptr<mkldnn::memory> target_memory_p;
+    if (is_persistent) {
+      target_memory_p = std::static_pointer_cast<mkldnn::memory>(
+          dev_ctx_.GetBlob(shared_key));
+    }
+    if (target_memory_p == nullptr) {
+      target_memory_p = std::static_pointer_cast<mkldnn::memory>(
+          dev_ctx_.GetBlob(local_key));
+    }
 
     mkldnn::stream astream(engine_);
 
-    if (target_memory_p == nullptr) {
+    if (target_memory_p == nullptr && is_persistent && md != user_md) {
+      static std::mutex acquire_barrier;
+      std::lock_guard<std::mutex> block_threads_until_finish_this_job(
+          acquire_barrier);
+      target_memory_p = std::static_pointer_cast<mkldnn::memory>(
+          dev_ctx_.GetBlob(shared_key));
+      if (target_memory_p == nullptr) {
+        target_memory_p = std::make_shared<mkldnn::memory>(md, engine_);
+        mkldnn::primitive_attr attri;
+        if (is_INT8) {
+          attri.set_output_scales(mask, scale_data);
+        }
+        mkldnn::reorder::primitive_desc reorder_pd(*user_memory_p,
+                                                   *target_memory_p, attri);
+        mkldnn::reorder(reorder_pd)
+            .execute(astream, {{MKLDNN_ARG_FROM, *user_memory_p},
+                               {MKLDNN_ARG_TO, *target_memory_p}});
+        astream.wait();
+        dev_ctx_.SetBlob(shared_key, target_memory_p);
+      }
+    } else if (target_memory_p == nullptr) {
       target_memory_p = user_memory_p;
       if (md != user_md) {
         target_memory_p = std::make_shared<mkldnn::memory>(md, engine_);
@@ -78,7 +78,10 @@ struct NCCLContext {
   ncclComm_t comm_;
 
   explicit NCCLContext(int dev_id)
-      : ctx_(new CUDADeviceContext(CUDAPlace(dev_id))), comm_{nullptr} {}
+      : ctx_(new CUDADeviceContext(CUDAPlace(dev_id))), comm_{nullptr} {
+    // the all-reduces are on the critical path, and preempt the bulk copies
+    ctx_->ResetDefaultContext(stream::Priority::HIGH);
+  }
 
   cudaStream_t stream() const { return ctx_->stream(); }
   ncclComm_t comm() const { return comm_; }
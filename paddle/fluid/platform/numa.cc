@@ -0,0 +1,149 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/numa.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "glog/logging.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+thread_local int current_numa_node = -1;
+
+#ifdef __linux__
+constexpr char kNodePath[] = "/sys/devices/system/node/node";
+// MPOL_PREFERRED in <numaif.h>, which is in libnuma
+constexpr int kMemPolicyPreferred = 1;
+#endif
+
+}  // namespace
+
+int GetNumaNodeCount() {
+#ifdef __linux__
+  static int node_count = [] {
+    int count = 0;
+    while (std::ifstream(kNodePath + std::to_string(count) + "/cpulist")) {
+      ++count;
+    }
+    return count > 0 ? count : 1;
+  }();
+  return node_count;
+#else
+  return 1;
+#endif
+}
+
+bool ParseCpuList(const std::string &cpulist, std::vector<int> *cpus) {
+  std::istringstream lin(cpulist);
+  std::string range;
+  while (std::getline(lin, range, ',')) {
+    int begin = 0, end = 0;
+    char dash = 0;
+    std::istringstream sin(range);
+    if (!(sin >> begin)) {
+      // the empty ranges, e.g. of the trailing newline, are skipped
+      if (range.find_first_not_of(" \t\n") == std::string::npos) {
+        continue;
+      }
+      return false;
+    }
+    if (sin >> dash) {
+      if (dash != '-' || !(sin >> end) || end < begin) {
+        return false;
+      }
+    } else {
+      end = begin;
+    }
+    if (begin < 0) {
+      return false;
+    }
+    for (int cpu = begin; cpu <= end; ++cpu) {
+      cpus->push_back(cpu);
+    }
+  }
+  return true;
+}
+
+std::vector<int> GetNumaNodeCpus(int node) {
+  std::vector<int> cpus;
+#ifdef __linux__
+  std::ifstream fin(kNodePath + std::to_string(node) + "/cpulist");
+  std::string cpulist;
+  if (std::getline(fin, cpulist) && !ParseCpuList(cpulist, &cpus)) {
+    LOG(WARNING) << "Malformed cpulist of NUMA node " << node << ": "
+                 << cpulist;
+    cpus.clear();
+  }
+#endif
+  return cpus;
+}
+
+bool BindThreadToNumaNode(int node) {
+#ifdef __linux__
+  auto cpus = GetNumaNodeCpus(node);
+  if (cpus.empty()) {
+    LOG(WARNING) << "No CPU found on NUMA node " << node;
+    return false;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &mask);
+  }
+  if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+    LOG(WARNING) << "Failed to bind the thread to NUMA node " << node;
+    return false;
+  }
+  current_numa_node = node;
+  VLOG(3) << "Bind the thread to NUMA node " << node;
+  return true;
+#else
+  return false;
+#endif
+}
+
+int GetCurrentNumaNode() { return current_numa_node; }
+
+bool SetMemoryNumaNode(void *ptr, size_t size, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  if (node < 0 || node >= 64) {
+    return false;
+  }
+  unsigned long node_mask = 1UL << node;  // NOLINT
+  return syscall(SYS_mbind, ptr, size, kMemPolicyPreferred, &node_mask,
+                 sizeof(node_mask) * 8, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+NumaNodeGuard::NumaNodeGuard(int node) : prev_node_(current_numa_node) {
+  current_numa_node = node;
+}
+
+NumaNodeGuard::~NumaNodeGuard() { current_numa_node = prev_node_; }
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,62 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+//! Get the number of NUMA nodes of the host, 1 if NUMA is not supported.
+int GetNumaNodeCount();
+
+//! Parse the cpulist like "0-3,8-11" of Linux into the CPUs. Returns false
+//! if it is malformed.
+bool ParseCpuList(const std::string &cpulist, std::vector<int> *cpus);
+
+//! Get the CPUs of the NUMA node.
+std::vector<int> GetNumaNodeCpus(int node);
+
+//! Bind the current thread to the CPUs of the NUMA node, and let it allocate
+//! CPU memory on the node. Returns false if the thread can not be bound.
+bool BindThreadToNumaNode(int node);
+
+//! Get the NUMA node the current thread allocates on, -1 if there is none.
+int GetCurrentNumaNode();
+
+//! Prefer placing the pages in [ptr, ptr + size) on the NUMA node when they
+//! are touched first. ptr must be aligned to the page size. Returns false if
+//! the policy can not be set.
+bool SetMemoryNumaNode(void *ptr, size_t size, int node);
+
+//! Let the current thread allocate CPU memory on the NUMA node in the scope,
+//! without binding it to the CPUs of the node, e.g. to place the memory
+//! another thread will use. node can be -1, which is no NUMA node.
+class NumaNodeGuard {
+ public:
+  explicit NumaNodeGuard(int node);
+  ~NumaNodeGuard();
+
+  NumaNodeGuard(const NumaNodeGuard &) = delete;
+  NumaNodeGuard &operator=(const NumaNodeGuard &) = delete;
+
+ private:
+  int prev_node_;
+};
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,58 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/numa.h"
+#include <stdlib.h>
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+
+TEST(Numa, NodeCpus) {
+  int node_count = paddle::platform::GetNumaNodeCount();
+  ASSERT_GE(node_count, 1);
+  ASSERT_TRUE(paddle::platform::GetNumaNodeCpus(node_count).empty());
+}
+
+TEST(Numa, BindThread) {
+  std::thread thread([] {
+    ASSERT_EQ(paddle::platform::GetCurrentNumaNode(), -1);
+    if (paddle::platform::GetNumaNodeCpus(0).empty()) {
+      // no NUMA information on this host
+      return;
+    }
+    ASSERT_TRUE(paddle::platform::BindThreadToNumaNode(0));
+    ASSERT_EQ(paddle::platform::GetCurrentNumaNode(), 0);
+
+    void *ptr = nullptr;
+    ASSERT_EQ(posix_memalign(&ptr, 4096, 1 << 20), 0);
+    paddle::platform::SetMemoryNumaNode(ptr, 1 << 20, 0);
+    free(ptr);
+  });
+  thread.join();
+  // the node is of the thread bound
+  ASSERT_EQ(paddle::platform::GetCurrentNumaNode(), -1);
+}
+
+TEST(Numa, Guard) {
+  {
+    paddle::platform::NumaNodeGuard guard(1);
+    ASSERT_EQ(paddle::platform::GetCurrentNumaNode(), 1);
+    {
+      paddle::platform::NumaNodeGuard inner_guard(-1);
+      ASSERT_EQ(paddle::platform::GetCurrentNumaNode(), -1);
+    }
+    ASSERT_EQ(paddle::platform::GetCurrentNumaNode(), 1);
+  }
+  ASSERT_EQ(paddle::platform::GetCurrentNumaNode(), -1);
+}
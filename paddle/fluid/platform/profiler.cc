@@ -14,16 +14,23 @@ limitations under the License. */
 
 #include <algorithm>
 #include <iomanip>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <mutex>  // NOLINT
 #include <random>
 #include <stack>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #ifdef PADDLE_WITH_CUDA
 #include <cuda.h>
 #endif  // PADDLE_WITH_CUDA
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32) && !defined(__APPLE__)
+#define PADDLE_WITH_NVTX
+#include "paddle/fluid/platform/dynload/nvtx.h"
+#endif
 
 #include "glog/logging.h"
 #include "paddle/fluid/framework/block_desc.h"
@@ -33,9 +40,21 @@ limitations under the License. */
 #include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/profiler_helper.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 #include "paddle/fluid/string/printf.h"
 
 DEFINE_bool(enable_rpc_profiler, false, "Enable rpc profiler or not.");
+DEFINE_bool(enable_nvtx, false,
+            "Emit the NVTX ranges of the RecordEvents, the executor runs, "
+            "the passes and the allocations, for Nsight Systems.");
+DEFINE_double(profiler_peak_gflops, 0.,
+              "The peak GFLOP/s of the devices in the roofline report of the "
+              "profiler. 0 means it is computed from the properties of the "
+              "GPUs, and unknown for the CPU.");
+DEFINE_double(profiler_peak_bandwidth, 0.,
+              "The peak memory bandwidth in GB/s of the devices in the "
+              "roofline report of the profiler. 0 means it is computed from "
+              "the properties of the GPUs, and unknown for the CPU.");
 
 namespace paddle {
 namespace platform {
@@ -63,9 +82,40 @@ double Event::CudaElapsedMs(const Event &e) const {
 #endif
 }
 
+bool IsNvtxEnabled() {
+#ifdef PADDLE_WITH_NVTX
+  static bool has_nvtx = dynload::HasNVTX();
+  return FLAGS_enable_nvtx && has_nvtx;
+#else
+  return false;
+#endif
+}
+
+void NvtxRangePush(const std::string &name) {
+#ifdef PADDLE_WITH_NVTX
+  dynload::nvtxRangePushA(name.c_str());
+#endif
+}
+
+void NvtxRangePop() {
+#ifdef PADDLE_WITH_NVTX
+  dynload::nvtxRangePop();
+#endif
+}
+
 RecordEvent::RecordEvent(const std::string &name, const EventRole role)
     : is_enabled_(false), start_ns_(PosixInNsec()), role_(role) {
-  if (g_state == ProfilerState::kDisabled || name.empty()) return;
+  if (UNLIKELY(IsNvtxEnabled()) && !name.empty()) {
+    NvtxRangePush(name);
+    is_nvtx_pushed_ = true;
+  }
+  if (g_state == ProfilerState::kDisabled || name.empty()) {
+    if (UNLIKELY(IsSamplingActive()) && !name.empty() && ShouldSampleEvent()) {
+      is_sampled_ = true;
+      name_ = name;
+    }
+    return;
+  }
   // lock is not needed, the code below is thread-safe
   is_enabled_ = true;
   Event *e = PushEvent(name, role);
@@ -75,6 +125,13 @@ RecordEvent::RecordEvent(const std::string &name, const EventRole role)
 }
 
 RecordEvent::~RecordEvent() {
+  if (UNLIKELY(is_nvtx_pushed_)) {
+    NvtxRangePop();
+  }
+  if (UNLIKELY(is_sampled_)) {
+    RecordSampledEvent(name_, start_ns_, PosixInNsec());
+    return;
+  }
   if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
   // lock is not needed, the code below is thread-safe
   DeviceTracer *tracer = GetDeviceTracer();
@@ -142,6 +199,53 @@ RecordRPCEvent::RecordRPCEvent(const std::string &name) {
   }
 }
 
+#ifdef PADDLE_WITH_CUDA
+RecordCommEvent::RecordCommEvent(const std::string &name,
+                                 const std::string &algorithm, size_t bytes,
+                                 int nranks, const std::vector<Place> &places,
+                                 const std::vector<cudaStream_t> &streams)
+    : name_(name), algorithm_(algorithm), bytes_(bytes), nranks_(nranks) {
+  if (g_state == ProfilerState::kDisabled) return;
+  PADDLE_ENFORCE_EQ(places.size(), streams.size(),
+                    platform::errors::InvalidArgument(
+                        "The number of places (%d) and streams (%d) of the "
+                        "collective call %s should be the same.",
+                        places.size(), streams.size(), name));
+  for (size_t i = 0; i < places.size(); ++i) {
+    int device = boost::get<platform::CUDAPlace>(places[i]).GetDeviceId();
+    CUDADeviceGuard guard(device);
+    cudaEvent_t event;
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventCreate(&event));
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(event, streams[i]));
+    devices_.push_back(device);
+    start_events_.push_back(event);
+  }
+  streams_ = streams;
+  is_enabled_ = true;
+}
+
+RecordCommEvent::~RecordCommEvent() {
+  if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
+  CommRecord record;
+  record.name = name_;
+  record.algorithm = algorithm_;
+  record.bytes = bytes_;
+  record.nranks = nranks_;
+  record.devices = devices_;
+  record.start_events = start_events_;
+  for (size_t i = 0; i < devices_.size(); ++i) {
+    CUDADeviceGuard guard(devices_[i]);
+    cudaEvent_t event;
+    // do not throw in the destructor
+    cudaEventCreate(&event);
+    cudaEventRecord(event, streams_[i]);
+    record.end_events.push_back(event);
+  }
+  std::lock_guard<std::mutex> guard(g_comm_records_mutex);
+  g_comm_records.emplace_back(std::move(record));
+}
+#endif
+
 RecordBlock::RecordBlock(int block_id)
     : is_enabled_(false), start_ns_(PosixInNsec()) {
   // lock is not needed, the code below is thread-safe
@@ -216,6 +320,8 @@ void ResetProfiler() {
   SynchronizeAllDevice();
   GetDeviceTracer()->Reset();
   MemEvenRecorder::Instance().Flush();
+  ClearCommRecords();
+  ClearOpCostRecords();
   std::lock_guard<std::mutex> guard(g_all_event_lists_mutex);
   for (auto it = g_all_event_lists.begin(); it != g_all_event_lists.end();
        ++it) {
@@ -253,6 +359,8 @@ void DisableProfiler(EventSortingKey sorted_key,
     std::vector<std::vector<MemEvent>> all_mem_events = GetMemEvents();
     ParseMemEvents(all_mem_events);
   }
+  PrintCommProfiler(GetCommEventItems(), 35, 14);
+  PrintOpCostProfiler(GetOpCostEventItems(), 35, 14);
 
   ResetProfiler();
   g_state = ProfilerState::kDisabled;
@@ -269,8 +377,236 @@ std::vector<std::vector<Event>> GetAllEvents() {
   return result;
 }
 
+std::unordered_map<std::string, double> GetEventAverageTimeMs() {
+  std::unordered_map<std::string, std::pair<double, size_t>> total_times;
+  for (auto &events : GetAllEvents()) {
+    std::vector<const Event *> pushed_events;
+    for (auto &event : events) {
+      if (event.type() == EventType::kPushRange) {
+        pushed_events.push_back(&event);
+      } else if (event.type() == EventType::kPopRange) {
+        // match the latest pushed event of the same name
+        for (auto it = pushed_events.rbegin(); it != pushed_events.rend();
+             ++it) {
+          if ((*it)->name() == event.name()) {
+            auto &total = total_times[event.name()];
+            total.first += (*it)->CpuElapsedMs(event);
+            ++total.second;
+            pushed_events.erase(std::next(it).base());
+            break;
+          }
+        }
+      }
+    }
+  }
+  std::unordered_map<std::string, double> average_times;
+  for (auto &pair : total_times) {
+    average_times[pair.first] = pair.second.first / pair.second.second;
+  }
+  return average_times;
+}
+
+RecordOpCost::RecordOpCost(const std::string &type) : type_(type) {
+  if (g_state == ProfilerState::kDisabled) return;
+  start_ns_ = PosixInNsec();
+  is_enabled_ = true;
+}
+
+#ifdef PADDLE_WITH_CUDA
+RecordOpCost::RecordOpCost(const std::string &type, const Place &place,
+                           cudaStream_t stream)
+    : type_(type), stream_(stream) {
+  if (g_state == ProfilerState::kDisabled) return;
+  device_ = boost::get<platform::CUDAPlace>(place).GetDeviceId();
+  CUDADeviceGuard guard(device_);
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventCreate(&start_event_));
+  PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(start_event_, stream_));
+  is_enabled_ = true;
+}
+#endif
+
+void RecordOpCost::Stop() {
+  if (!is_enabled_) return;
+#ifdef PADDLE_WITH_CUDA
+  if (device_ >= 0) {
+    CUDADeviceGuard guard(device_);
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventCreate(&end_event_));
+    PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventRecord(end_event_, stream_));
+    return;
+  }
+#endif
+  elapsed_ms_ = (PosixInNsec() - start_ns_) / 1000000.0;
+}
+
+void RecordOpCost::SetCost(double flops, double bytes) {
+  flops_ = flops;
+  bytes_ = bytes;
+}
+
+RecordOpCost::~RecordOpCost() {
+  if (!is_enabled_) return;
+#ifdef PADDLE_WITH_CUDA
+  // do not throw in the destructor
+  if (device_ >= 0 && end_event_ == nullptr) {
+    CUDADeviceGuard guard(device_);
+    cudaEventDestroy(start_event_);
+    return;
+  }
+#endif
+  OpCostRecord record;
+  record.type = type_;
+  record.device = device_;
+  record.flops = flops_;
+  record.bytes = bytes_;
+  record.elapsed_ms = elapsed_ms_;
+#ifdef PADDLE_WITH_CUDA
+  record.start_event = start_event_;
+  record.end_event = end_event_;
+#endif
+  std::lock_guard<std::mutex> guard(g_op_cost_records_mutex);
+  g_op_cost_records.emplace_back(std::move(record));
+}
+
+// The peak GFLOP/s and GB/s of the device, 0 if unknown. The peaks of the
+// GPUs are of the float32 CUDA cores.
+static void GetDevicePeaks(int device, double *gflops, double *bandwidth) {
+  *gflops = FLAGS_profiler_peak_gflops;
+  *bandwidth = FLAGS_profiler_peak_bandwidth;
+#ifdef PADDLE_WITH_CUDA
+  if (device < 0 || (*gflops > 0 && *bandwidth > 0)) return;
+  cudaDeviceProp prop;
+  if (cudaGetDeviceProperties(&prop, device) != cudaSuccess) return;
+  int cores_per_sm = 64;
+  if (prop.major == 3) {
+    cores_per_sm = 192;
+  } else if (prop.major == 5 || (prop.major == 6 && prop.minor > 0) ||
+             (prop.major == 8 && prop.minor > 0)) {
+    cores_per_sm = 128;
+  }
+  // an FMA is 2 FLOPs, and the clock rates are in kHz
+  if (*gflops <= 0) {
+    *gflops =
+        2.0 * prop.multiProcessorCount * cores_per_sm * prop.clockRate / 1e6;
+  }
+  // the memory is double data rate
+  if (*bandwidth <= 0) {
+    *bandwidth = 2.0 * prop.memoryClockRate * (prop.memoryBusWidth / 8) / 1e6;
+  }
+#endif
+}
+
+std::vector<OpCostEventItem> GetOpCostEventItems() {
+  std::map<std::pair<std::string, int>, OpCostEventItem> item_map;
+  {
+    std::lock_guard<std::mutex> guard(g_op_cost_records_mutex);
+    for (auto &record : g_op_cost_records) {
+      double elapsed_ms = record.elapsed_ms;
+#ifdef PADDLE_WITH_CUDA
+      if (record.device >= 0) {
+        CUDADeviceGuard device_guard(record.device);
+        float ms = 0;
+        PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventSynchronize(record.end_event));
+        PADDLE_ENFORCE_CUDA_SUCCESS(
+            cudaEventElapsedTime(&ms, record.start_event, record.end_event));
+        elapsed_ms = ms;
+      }
+#endif
+      auto &item = item_map[std::make_pair(record.type, record.device)];
+      item.name = record.type;
+      item.device = record.device;
+      item.calls += 1;
+      item.total_time += elapsed_ms;
+      item.total_flops += record.flops;
+      item.total_bytes += record.bytes;
+    }
+  }
+
+  std::vector<OpCostEventItem> items;
+  for (auto &pair : item_map) {
+    auto &item = pair.second;
+    // GFLOP/s is FLOPs / 1e9 over seconds, i.e. FLOPs / 1e6 over ms
+    if (item.total_time > 0) {
+      item.gflops = item.total_flops / item.total_time / 1e6;
+      item.bandwidth = item.total_bytes / item.total_time / 1e6;
+    }
+    item.intensity =
+        item.total_bytes > 0 ? item.total_flops / item.total_bytes : 0;
+    double peak_gflops = 0;
+    double peak_bandwidth = 0;
+    GetDevicePeaks(item.device, &peak_gflops, &peak_bandwidth);
+    if (peak_gflops > 0 && peak_bandwidth > 0) {
+      item.flops_ratio = item.gflops / peak_gflops;
+      item.bandwidth_ratio = item.bandwidth / peak_bandwidth;
+      item.memory_bound = item.intensity < peak_gflops / peak_bandwidth;
+    }
+    items.push_back(item);
+  }
+  std::sort(items.begin(), items.end(),
+            [](const OpCostEventItem &a, const OpCostEventItem &b) {
+              return a.total_time > b.total_time;
+            });
+  return items;
+}
+
+std::vector<CommEventItem> GetCommEventItems() {
+  std::vector<CommEventItem> items;
+#ifdef PADDLE_WITH_CUDA
+  std::map<std::pair<std::string, std::string>, CommEventItem> item_map;
+  std::lock_guard<std::mutex> guard(g_comm_records_mutex);
+  for (auto &record : g_comm_records) {
+    // a call finishes when the slowest rank finishes
+    float elapsed_ms = 0;
+    for (size_t i = 0; i < record.devices.size(); ++i) {
+      CUDADeviceGuard device_guard(record.devices[i]);
+      float ms = 0;
+      PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventSynchronize(record.end_events[i]));
+      PADDLE_ENFORCE_CUDA_SUCCESS(cudaEventElapsedTime(
+          &ms, record.start_events[i], record.end_events[i]));
+      elapsed_ms = std::max(elapsed_ms, ms);
+    }
+    auto &item = item_map[std::make_pair(record.name, record.algorithm)];
+    item.name = record.name;
+    item.algorithm = record.algorithm;
+    item.nranks = record.nranks;
+    item.calls += 1;
+    item.total_bytes += record.bytes;
+    item.total_time += elapsed_ms;
+    item.max_time = std::max(item.max_time, static_cast<double>(elapsed_ms));
+  }
+  for (auto &pair : item_map) {
+    auto &item = pair.second;
+    // GB/s is bytes / 1e9 over seconds, i.e. bytes / 1e6 over ms
+    item.alg_bandwidth =
+        item.total_time > 0 ? item.total_bytes / item.total_time / 1e6 : 0;
+    double factor = 1.0;
+    if (item.nranks > 1) {
+      if (item.name.find("allreduce") != std::string::npos ||
+          item.name.find("all_reduce") != std::string::npos) {
+        factor = 2.0 * (item.nranks - 1) / item.nranks;
+      } else if (item.name.find("allgather") != std::string::npos ||
+                 item.name.find("reducescatter") != std::string::npos) {
+        factor = 1.0 * (item.nranks - 1) / item.nranks;
+      }
+    }
+    item.bus_bandwidth = item.alg_bandwidth * factor;
+    items.push_back(item);
+  }
+#endif
+  return items;
+}
+
 bool IsProfileEnabled() { return g_state != ProfilerState::kDisabled; }
 
+void RecordMemStat(const Place &place, size_t allocated_bytes,
+                   size_t peak_allocated_bytes, size_t reserved_bytes) {
+  if (g_state == ProfilerState::kDisabled) return;
+  DeviceTracer *tracer = GetDeviceTracer();
+  if (tracer) {
+    tracer->AddMemStatRecord(PosixInNsec(), place, allocated_bytes,
+                             peak_allocated_bytes, reserved_bytes);
+  }
+}
+
 bool ShouldSendProfileState() { return should_send_profile_state; }
 
 std::string OpName(const framework::VariableNameMap &name_map,
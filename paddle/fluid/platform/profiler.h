@@ -128,6 +128,10 @@ struct RecordEvent {
   ~RecordEvent();
 
   bool is_enabled_;
+  // Whether the event is recorded by the sampling profiler.
+  bool is_sampled_{false};
+  // Whether the NVTX range of the event is pushed.
+  bool is_nvtx_pushed_{false};
   uint64_t start_ns_;
   // Event name
   std::string name_;
@@ -156,6 +160,127 @@ struct RecordBlock {
   uint64_t start_ns_;
 };
 
+// The NVTX ranges of the RecordEvents, the executor runs, the passes and the
+// allocations are emitted when FLAGS_enable_nvtx is set, so that the traces
+// of Nsight Systems show the names of the ops and the passes. They do not
+// depend on the profiler, and are not emitted without libnvToolsExt.
+bool IsNvtxEnabled();
+void NvtxRangePush(const std::string& name);
+void NvtxRangePop();
+
+class NvtxRange {
+ public:
+  explicit NvtxRange(const std::string& name) : enabled_(IsNvtxEnabled()) {
+    if (UNLIKELY(enabled_)) NvtxRangePush(name);
+  }
+  ~NvtxRange() {
+    if (UNLIKELY(enabled_)) NvtxRangePop();
+  }
+
+ private:
+  bool enabled_;
+
+  DISABLE_COPY_AND_ASSIGN(NvtxRange);
+};
+
+// The bytes and bandwidth of the collective calls of the same name and
+// algorithm given in the communication report
+struct CommEventItem {
+  std::string name;
+  std::string algorithm;
+  int nranks{0};
+  size_t calls{0};
+  size_t total_bytes{0};
+  double total_time{0.};
+  double max_time{0.};
+  // the bytes of the tensors over the time, in GB/s
+  double alg_bandwidth{0.};
+  // the algorithm bandwidth scaled by the data each rank sends in a ring,
+  // e.g. 2 * (nranks - 1) / nranks for allreduce, which is comparable with
+  // the bandwidth of the links
+  double bus_bandwidth{0.};
+};
+
+// The achieved FLOP/s and bandwidth of the ops of the same type on the same
+// device given in the roofline report
+struct OpCostEventItem {
+  std::string name;
+  // the id of the GPU, or -1 for the CPU
+  int device{-1};
+  size_t calls{0};
+  double total_time{0.};
+  double total_flops{0.};
+  double total_bytes{0.};
+  // in GFLOP/s and GB/s
+  double gflops{0.};
+  double bandwidth{0.};
+  // the FLOPs per byte
+  double intensity{0.};
+  // the achieved over the peaks of the device, 0 if the peaks are unknown
+  double flops_ratio{0.};
+  double bandwidth_ratio{0.};
+  // the intensity is lower than the ridge point of the device, i.e. the peak
+  // FLOP/s over the peak bandwidth
+  bool memory_bound{false};
+};
+
+#ifdef PADDLE_WITH_CUDA
+// Record the duration of a collective call on the streams of places, from
+// the construction to the destruction, when the profiler is enabled. The
+// grouped NCCL calls are launched at the end of the group, so the group
+// guard should be destructed in the scope of RecordCommEvent.
+class RecordCommEvent {
+ public:
+  RecordCommEvent(const std::string& name, const std::string& algorithm,
+                  size_t bytes, int nranks, const std::vector<Place>& places,
+                  const std::vector<cudaStream_t>& streams);
+  ~RecordCommEvent();
+
+ private:
+  bool is_enabled_{false};
+  std::string name_;
+  std::string algorithm_;
+  size_t bytes_;
+  int nranks_;
+  std::vector<int> devices_;
+  std::vector<cudaStream_t> streams_;
+  std::vector<cudaEvent_t> start_events_;
+};
+#endif
+
+// Record the duration of the kernel of an op from the construction to Stop,
+// with the FLOPs and the bytes estimated for it, when the profiler is
+// enabled. The duration on the GPU is measured by the events on the stream
+// of the kernel.
+class RecordOpCost {
+ public:
+  explicit RecordOpCost(const std::string& type);
+#ifdef PADDLE_WITH_CUDA
+  RecordOpCost(const std::string& type, const Place& place,
+               cudaStream_t stream);
+#endif
+  ~RecordOpCost();
+
+  void Stop();
+  void SetCost(double flops, double bytes);
+
+ private:
+  bool is_enabled_{false};
+  std::string type_;
+  int device_{-1};
+  uint64_t start_ns_{0};
+  double elapsed_ms_{0.};
+  double flops_{0.};
+  double bytes_{0.};
+#ifdef PADDLE_WITH_CUDA
+  cudaStream_t stream_{nullptr};
+  cudaEvent_t start_event_{nullptr};
+  cudaEvent_t end_event_{nullptr};
+#endif
+
+  DISABLE_COPY_AND_ASSIGN(RecordOpCost);
+};
+
 template <typename T>
 struct EventList {
   constexpr static size_t kMB = 1024 * 1024;
@@ -201,6 +326,16 @@ void PopEvent(const std::string& name);
 // Return the event list of all threads. Assumed the returned value calls
 // event_lists, event_lists[i][j] represents the j-th Event of i-th thread.
 std::vector<std::vector<Event>> GetAllEvents();
+// Return the average CPU time in ms of the recorded events by name, e.g. the
+// operators by their types, which can be used as the op costs of
+// critical_path_priority_pass.
+std::unordered_map<std::string, double> GetEventAverageTimeMs();
+// Return the collective calls recorded by RecordCommEvent, aggregated by the
+// names and the algorithms. It waits for the recorded calls to finish.
+std::vector<CommEventItem> GetCommEventItems();
+// Return the ops recorded by RecordOpCost, aggregated by the types and the
+// devices, sorted by the total time. It waits for the recorded ops to finish.
+std::vector<OpCostEventItem> GetOpCostEventItems();
 
 // Enable the profiling function.
 void EnableProfiler(ProfilerState state);
@@ -210,6 +345,10 @@ void DisableProfiler(EventSortingKey sorted_key,
                      const std::string& profile_path);
 // Test if the profiler is currently enabled.
 bool IsProfileEnabled();
+// Record the bytes allocated, the peak of them and the bytes reserved by the
+// allocator of place into the timeline, when the profiler is enabled.
+void RecordMemStat(const Place& place, size_t allocated_bytes,
+                   size_t peak_allocated_bytes, size_t reserved_bytes);
 // Whether the trainer should send profiling state to PS.
 bool ShouldSendProfileState();
 std::string OpName(const framework::VariableNameMap& name_map,
@@ -30,6 +30,7 @@ limitations under the License. */
 
 #ifdef PADDLE_WITH_CUDA
 #include <cuda.h>
+#include "paddle/fluid/platform/cuda_device_guard.h"
 #endif  // PADDLE_WITH_CUDA
 
 namespace paddle {
@@ -60,6 +61,36 @@ static thread_local std::shared_ptr<EventList<MemEvent>> g_mem_event_list;
 static std::mutex g_all_mem_event_lists_mutex;
 static thread_local int32_t g_mem_thread_id;
 static uint32_t g_mem_next_thread_id = 0;
+#ifdef PADDLE_WITH_CUDA
+// The collective calls recorded by RecordCommEvent, with the events on each
+// stream of the calls.
+struct CommRecord {
+  std::string name;
+  std::string algorithm;
+  size_t bytes;
+  int nranks;
+  std::vector<int> devices;
+  std::vector<cudaEvent_t> start_events;
+  std::vector<cudaEvent_t> end_events;
+};
+static std::mutex g_comm_records_mutex;
+static std::vector<CommRecord> g_comm_records;
+#endif
+// The ops recorded by RecordOpCost. The elapsed time of the ops on the GPU
+// is computed from the events when the report is generated.
+struct OpCostRecord {
+  std::string type;
+  int device;
+  double flops;
+  double bytes;
+  double elapsed_ms;
+#ifdef PADDLE_WITH_CUDA
+  cudaEvent_t start_event;
+  cudaEvent_t end_event;
+#endif
+};
+static std::mutex g_op_cost_records_mutex;
+static std::vector<OpCostRecord> g_op_cost_records;
 
 static int FindNthReversePos(const std::string &s, const char ch, const int N) {
   int found_pos = -1;
@@ -157,6 +188,107 @@ void PrintMemProfiler(
   std::cout << std::endl;
 }
 
+void PrintCommProfiler(const std::vector<CommEventItem> &items,
+                       const size_t name_width, const size_t data_width) {
+  if (items.empty()) return;
+  std::cout << "\n------------------------->"
+            << "  Communication Profiling Report  "
+            << "<-------------------------\n\n";
+  std::cout.setf(std::ios::left);
+  std::cout << std::setw(name_width) << "Event" << std::setw(data_width)
+            << "Algorithm" << std::setw(data_width) << "Ranks"
+            << std::setw(data_width) << "Calls" << std::setw(data_width)
+            << "Size(MB)" << std::setw(data_width) << "Total(ms)"
+            << std::setw(data_width) << "Max(ms)" << std::setw(data_width)
+            << "AlgBw(GB/s)" << std::setw(data_width) << "BusBw(GB/s)"
+            << std::endl;
+  for (auto &item : items) {
+    std::cout << std::setw(name_width) << item.name;
+    std::cout << std::setw(data_width) << item.algorithm;
+    std::cout << std::setw(data_width) << item.nranks;
+    std::cout << std::setw(data_width) << item.calls;
+    std::cout << std::setw(data_width)
+              << item.total_bytes / (1024.0 * 1024.0);
+    std::cout << std::setw(data_width) << item.total_time;
+    std::cout << std::setw(data_width) << item.max_time;
+    std::cout << std::setw(data_width) << item.alg_bandwidth;
+    std::cout << std::setw(data_width) << item.bus_bandwidth << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+void ClearCommRecords() {
+#ifdef PADDLE_WITH_CUDA
+  std::lock_guard<std::mutex> guard(g_comm_records_mutex);
+  for (auto &record : g_comm_records) {
+    for (size_t i = 0; i < record.devices.size(); ++i) {
+      CUDADeviceGuard device_guard(record.devices[i]);
+      cudaEventDestroy(record.start_events[i]);
+      cudaEventDestroy(record.end_events[i]);
+    }
+  }
+  g_comm_records.clear();
+#endif
+}
+
+void PrintOpCostProfiler(const std::vector<OpCostEventItem> &items,
+                         const size_t name_width, const size_t data_width) {
+  if (items.empty()) return;
+  std::cout << "\n------------------------->"
+            << "     Roofline Report     "
+            << "<-------------------------\n\n";
+  std::cout.setf(std::ios::left);
+  std::cout << std::setw(name_width) << "Event" << std::setw(data_width)
+            << "Place" << std::setw(data_width) << "Calls"
+            << std::setw(data_width) << "Total(ms)" << std::setw(data_width)
+            << "GFLOPs" << std::setw(data_width) << "Size(MB)"
+            << std::setw(data_width) << "GFLOP/s" << std::setw(data_width)
+            << "GB/s" << std::setw(data_width) << "FLOP/Byte"
+            << std::setw(data_width) << "%PeakFLOP/s" << std::setw(data_width)
+            << "%PeakGB/s" << std::setw(data_width) << "Bound" << std::endl;
+  for (auto &item : items) {
+    bool has_peak = item.flops_ratio > 0 || item.bandwidth_ratio > 0;
+    std::cout << std::setw(name_width) << item.name;
+    std::cout << std::setw(data_width)
+              << (item.device < 0 ? std::string("CPU")
+                                  : "GPU" + std::to_string(item.device));
+    std::cout << std::setw(data_width) << item.calls;
+    std::cout << std::setw(data_width) << item.total_time;
+    std::cout << std::setw(data_width) << item.total_flops / 1e9;
+    std::cout << std::setw(data_width)
+              << item.total_bytes / (1024.0 * 1024.0);
+    std::cout << std::setw(data_width) << item.gflops;
+    std::cout << std::setw(data_width) << item.bandwidth;
+    std::cout << std::setw(data_width) << item.intensity;
+    if (has_peak) {
+      std::cout << std::setw(data_width)
+                << string::Sprintf("%.2f%%", item.flops_ratio * 100)
+                << std::setw(data_width)
+                << string::Sprintf("%.2f%%", item.bandwidth_ratio * 100)
+                << std::setw(data_width)
+                << (item.memory_bound ? "Memory" : "Compute") << std::endl;
+    } else {
+      std::cout << std::setw(data_width) << "-" << std::setw(data_width)
+                << "-" << std::setw(data_width) << "-" << std::endl;
+    }
+  }
+  std::cout << std::endl;
+}
+
+void ClearOpCostRecords() {
+  std::lock_guard<std::mutex> guard(g_op_cost_records_mutex);
+#ifdef PADDLE_WITH_CUDA
+  for (auto &record : g_op_cost_records) {
+    if (record.device >= 0) {
+      CUDADeviceGuard device_guard(record.device);
+      cudaEventDestroy(record.start_event);
+      cudaEventDestroy(record.end_event);
+    }
+  }
+#endif
+  g_op_cost_records.clear();
+}
+
 // parse memory events
 void ParseMemEvents(const std::vector<std::vector<MemEvent>> &events) {
   if (g_state == ProfilerState::kDisabled) return;
@@ -14,10 +14,15 @@ limitations under the License. */
 
 #include "paddle/fluid/platform/profiler.h"
 #include <string>
+#include <vector>
 #ifdef PADDLE_WITH_CUDA
 #include <cuda_runtime.h>
 #endif
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
+
+DECLARE_bool(enable_nvtx);
 
 TEST(Event, CpuElapsedTime) {
   using paddle::platform::Event;
@@ -135,6 +140,84 @@ TEST(RecordEvent, RecordEvent) {
   DisableProfiler(EventSortingKey::kTotal, "/tmp/profiler");
 }
 
+TEST(RecordEvent, SamplingProfiler) {
+  using paddle::platform::RecordEvent;
+  using paddle::platform::SampledEventStat;
+  using paddle::platform::SamplingProfilerOptions;
+  using paddle::platform::GetSampledEventStats;
+  using paddle::platform::SamplingProfilerStep;
+
+  auto record = [](const std::string& name, int times) {
+    for (int i = 0; i < times; ++i) {
+      RecordEvent record_event(name);
+    }
+  };
+
+  int64_t reported_step = 0;
+  std::vector<SampledEventStat> reported_stats;
+  SamplingProfilerOptions options;
+  options.step_interval = 2;
+  options.report_interval = 4;
+  options.callback = [&](int64_t step,
+                         const std::vector<SampledEventStat>& stats) {
+    reported_step = step;
+    reported_stats = stats;
+  };
+  paddle::platform::EnableSamplingProfiler(options);
+  EXPECT_TRUE(paddle::platform::IsSamplingProfilerEnabled());
+
+  // Only the steps 0 and 2 are sampled.
+  for (int step = 0; step < 4; ++step) {
+    record("op_a", 3);
+    record("op_b", 1);
+    if (step == 1) {
+      auto stats = GetSampledEventStats();
+      ASSERT_EQ(stats.size(), 2UL);
+      EXPECT_EQ(stats[0].calls + stats[1].calls, 4UL);
+    }
+    SamplingProfilerStep();
+  }
+  EXPECT_EQ(reported_step, 4);
+  ASSERT_EQ(reported_stats.size(), 2UL);
+  for (auto& stat : reported_stats) {
+    EXPECT_EQ(stat.calls, stat.name == "op_a" ? 6UL : 2UL);
+    EXPECT_LE(stat.min_ms, stat.max_ms);
+  }
+  EXPECT_TRUE(GetSampledEventStats().empty());
+  paddle::platform::DisableSamplingProfiler();
+  EXPECT_FALSE(paddle::platform::IsSamplingProfilerEnabled());
+
+  // The ring buffer keeps the latest events when it is full.
+  options = SamplingProfilerOptions();
+  options.step_interval = 0;
+  options.op_sample_rate = 1.0;
+  options.buffer_size = 2;
+  paddle::platform::EnableSamplingProfiler(options);
+  record("op_c", 5);
+  auto stats = GetSampledEventStats();
+  ASSERT_EQ(stats.size(), 1UL);
+  EXPECT_EQ(stats[0].calls, 2UL);
+  EXPECT_EQ(paddle::platform::SampledEventDroppedNum(), 3UL);
+  paddle::platform::DisableSamplingProfiler();
+
+  record("op_d", 1);
+  EXPECT_TRUE(GetSampledEventStats().empty());
+
+  options.op_sample_rate = 2.0;
+  EXPECT_ANY_THROW(paddle::platform::EnableSamplingProfiler(options));
+}
+
+TEST(RecordEvent, Nvtx) {
+  // The ranges are emitted only with libnvToolsExt, and are balanced.
+  FLAGS_enable_nvtx = true;
+  {
+    paddle::platform::NvtxRange range("nvtx_range");
+    paddle::platform::RecordEvent record_event("nvtx_event");
+  }
+  FLAGS_enable_nvtx = false;
+  EXPECT_FALSE(paddle::platform::IsNvtxEnabled());
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(TMP, stream_wait) {
   cudaStream_t stream;
@@ -0,0 +1,350 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+namespace paddle {
+namespace platform {
+
+namespace detail {
+std::atomic<bool> g_sampling_active{false};
+}  // namespace detail
+
+namespace {
+
+struct SampledEvent {
+  std::string name;
+  uint64_t start_ns;
+  uint64_t end_ns;
+};
+
+// The ring buffer of the sampled events of a thread. The mutex is only
+// contended when the buffer is drained.
+class SampledEventBuffer {
+ public:
+  explicit SampledEventBuffer(size_t capacity) : events_(capacity) {}
+
+  void Push(const std::string& name, uint64_t start_ns, uint64_t end_ns) {
+    std::lock_guard<std::mutex> guard(mu_);
+    if (size_ == events_.size()) {
+      begin_ = (begin_ + 1) % events_.size();
+      --size_;
+      ++dropped_;
+    }
+    // The string keeps its capacity, so the names do not allocate in the
+    // steady state.
+    auto& event = events_[(begin_ + size_) % events_.size()];
+    event.name.assign(name);
+    event.start_ns = start_ns;
+    event.end_ns = end_ns;
+    ++size_;
+  }
+
+  template <typename Callback>
+  uint64_t Drain(Callback callback) {
+    std::lock_guard<std::mutex> guard(mu_);
+    for (size_t i = 0; i < size_; ++i) {
+      callback(events_[(begin_ + i) % events_.size()]);
+    }
+    begin_ = 0;
+    size_ = 0;
+    uint64_t dropped = dropped_;
+    dropped_ = 0;
+    return dropped;
+  }
+
+ private:
+  std::mutex mu_;
+  std::vector<SampledEvent> events_;
+  size_t begin_{0};
+  size_t size_{0};
+  uint64_t dropped_{0};
+};
+
+struct SamplingProfilerState {
+  std::mutex mu;
+  bool enabled{false};
+  SamplingProfilerOptions options;
+  int64_t step{0};
+  std::list<std::shared_ptr<SampledEventBuffer>> buffers;
+  std::unordered_map<std::string, SampledEventStat> stats;
+  uint64_t dropped{0};
+};
+
+SamplingProfilerState& GetState() {
+  static SamplingProfilerState state;
+  return state;
+}
+
+// The thread caches of the options are rebuilt when the generation changes,
+// i.e. the sampling profiler is enabled again.
+std::atomic<uint64_t> g_generation{0};
+std::atomic<bool> g_step_sampled{false};
+std::atomic<double> g_op_sample_rate{0.0};
+std::atomic<size_t> g_buffer_size{0};
+
+struct ThreadSampler {
+  uint64_t generation{0};
+  std::shared_ptr<SampledEventBuffer> buffer;
+  std::minstd_rand engine{std::random_device{}()};
+  std::geometric_distribution<int64_t> skip;
+  // The number of the events to skip before the next sampled one.
+  int64_t countdown{std::numeric_limits<int64_t>::max()};
+
+  void Reset(uint64_t new_generation) {
+    generation = new_generation;
+    buffer.reset();
+    double rate = g_op_sample_rate.load(std::memory_order_relaxed);
+    if (rate >= 1.0) {
+      countdown = 0;
+    } else if (rate > 0.0) {
+      skip = std::geometric_distribution<int64_t>(rate);
+      countdown = skip(engine);
+    } else {
+      countdown = std::numeric_limits<int64_t>::max();
+    }
+  }
+};
+
+ThreadSampler& GetThreadSampler() {
+  static thread_local ThreadSampler sampler;
+  uint64_t generation = g_generation.load(std::memory_order_acquire);
+  if (sampler.generation != generation) {
+    sampler.Reset(generation);
+  }
+  return sampler;
+}
+
+void UpdateSamplingActive(const SamplingProfilerState& state) {
+  bool active = state.enabled && (g_step_sampled.load() ||
+                                  state.options.op_sample_rate > 0.0);
+  detail::g_sampling_active.store(active, std::memory_order_relaxed);
+}
+
+// Moves the events of the buffers into the statistics, with state.mu held.
+void AggregateLocked(SamplingProfilerState* state) {
+  for (auto& buffer : state->buffers) {
+    state->dropped += buffer->Drain([state](const SampledEvent& event) {
+      double ms = (event.end_ns - event.start_ns) / 1000000.0;
+      auto& stat = state->stats[event.name];
+      if (stat.calls == 0) {
+        stat.name = event.name;
+        stat.min_ms = ms;
+        stat.max_ms = ms;
+      } else {
+        stat.min_ms = std::min(stat.min_ms, ms);
+        stat.max_ms = std::max(stat.max_ms, ms);
+      }
+      ++stat.calls;
+      stat.total_ms += ms;
+    });
+  }
+}
+
+std::vector<SampledEventStat> SortedStatsLocked(
+    const SamplingProfilerState& state) {
+  std::vector<SampledEventStat> stats;
+  stats.reserve(state.stats.size());
+  for (auto& pair : state.stats) {
+    stats.emplace_back(pair.second);
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const SampledEventStat& a, const SampledEventStat& b) {
+              return a.total_ms > b.total_ms;
+            });
+  return stats;
+}
+
+// Aggregates, writes the statistics to the file and clears them. The
+// statistics are returned to be passed to the callback, which is called
+// after state.mu is released so that it can use the sampling profiler.
+std::vector<SampledEventStat> ReportLocked(SamplingProfilerState* state) {
+  AggregateLocked(state);
+  auto stats = SortedStatsLocked(*state);
+  state->stats.clear();
+  if (stats.empty() || state->options.report_path.empty()) {
+    return stats;
+  }
+  std::ofstream fout(state->options.report_path, std::ios::app);
+  if (!fout) {
+    LOG(WARNING) << "Failed to open " << state->options.report_path
+                 << " to write the statistics of the sampling profiler.";
+    return stats;
+  }
+  // One line per event, so that the file can be tailed and parsed.
+  for (auto& stat : stats) {
+    fout << state->step << "\t" << stat.name << "\t" << stat.calls << "\t"
+         << stat.total_ms << "\t" << stat.min_ms << "\t" << stat.max_ms
+         << "\t" << stat.ave_ms() << "\n";
+  }
+  return stats;
+}
+
+}  // namespace
+
+bool ShouldSampleEvent() {
+  if (g_step_sampled.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  auto& sampler = GetThreadSampler();
+  if (sampler.countdown > 0) {
+    --sampler.countdown;
+    return false;
+  }
+  double rate = g_op_sample_rate.load(std::memory_order_relaxed);
+  sampler.countdown = rate >= 1.0 ? 0 : sampler.skip(sampler.engine);
+  return rate > 0.0;
+}
+
+void RecordSampledEvent(const std::string& name, uint64_t start_ns,
+                        uint64_t end_ns) {
+  auto& sampler = GetThreadSampler();
+  if (!sampler.buffer) {
+    auto& state = GetState();
+    std::lock_guard<std::mutex> guard(state.mu);
+    // The sampling profiler may be disabled or enabled again meanwhile.
+    if (!state.enabled ||
+        sampler.generation != g_generation.load(std::memory_order_relaxed)) {
+      return;
+    }
+    sampler.buffer = std::make_shared<SampledEventBuffer>(
+        g_buffer_size.load(std::memory_order_relaxed));
+    state.buffers.emplace_back(sampler.buffer);
+  }
+  sampler.buffer->Push(name, start_ns, end_ns);
+}
+
+void EnableSamplingProfiler(const SamplingProfilerOptions& options) {
+  PADDLE_ENFORCE_GE(options.step_interval, 0,
+                    platform::errors::InvalidArgument(
+                        "The step_interval of the sampling profiler should "
+                        "be >= 0, but received %d.",
+                        options.step_interval));
+  PADDLE_ENFORCE_EQ(
+      options.op_sample_rate >= 0.0 && options.op_sample_rate <= 1.0, true,
+      platform::errors::InvalidArgument(
+          "The op_sample_rate of the sampling profiler should be in [0, 1], "
+          "but received %f.",
+          options.op_sample_rate));
+  PADDLE_ENFORCE_GT(options.buffer_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The buffer_size of the sampling profiler should be "
+                        "> 0, but received %d.",
+                        options.buffer_size));
+  PADDLE_ENFORCE_GE(options.report_interval, 0,
+                    platform::errors::InvalidArgument(
+                        "The report_interval of the sampling profiler should "
+                        "be >= 0, but received %d.",
+                        options.report_interval));
+
+  auto& state = GetState();
+  {
+    std::lock_guard<std::mutex> guard(state.mu);
+    state.enabled = true;
+    state.options = options;
+    state.step = 0;
+    state.buffers.clear();
+    state.stats.clear();
+    state.dropped = 0;
+    g_op_sample_rate.store(options.op_sample_rate);
+    g_buffer_size.store(options.buffer_size);
+    g_step_sampled.store(options.step_interval > 0);
+    g_generation.fetch_add(1, std::memory_order_release);
+    UpdateSamplingActive(state);
+  }
+  VLOG(3) << "Enable the sampling profiler, step_interval: "
+          << options.step_interval
+          << ", op_sample_rate: " << options.op_sample_rate;
+}
+
+void DisableSamplingProfiler() {
+  auto& state = GetState();
+  std::vector<SampledEventStat> stats;
+  SamplingProfilerOptions options;
+  int64_t step = 0;
+  {
+    std::lock_guard<std::mutex> guard(state.mu);
+    if (!state.enabled) return;
+    state.enabled = false;
+    g_step_sampled.store(false);
+    UpdateSamplingActive(state);
+    stats = ReportLocked(&state);
+    step = state.step;
+    state.buffers.clear();
+    options = std::move(state.options);
+    state.options = SamplingProfilerOptions();
+  }
+  if (options.callback && !stats.empty()) {
+    options.callback(step, stats);
+  }
+}
+
+bool IsSamplingProfilerEnabled() {
+  auto& state = GetState();
+  std::lock_guard<std::mutex> guard(state.mu);
+  return state.enabled;
+}
+
+void SamplingProfilerStep() {
+  auto& state = GetState();
+  std::vector<SampledEventStat> stats;
+  SampledEventStatsCallback callback;
+  int64_t step = 0;
+  {
+    std::lock_guard<std::mutex> guard(state.mu);
+    if (!state.enabled) return;
+    step = ++state.step;
+    auto& options = state.options;
+    g_step_sampled.store(options.step_interval > 0 &&
+                         step % options.step_interval == 0);
+    UpdateSamplingActive(state);
+    if (options.report_interval == 0 || step % options.report_interval != 0) {
+      return;
+    }
+    stats = ReportLocked(&state);
+    callback = options.callback;
+  }
+  if (callback && !stats.empty()) {
+    callback(step, stats);
+  }
+}
+
+std::vector<SampledEventStat> GetSampledEventStats() {
+  auto& state = GetState();
+  std::lock_guard<std::mutex> guard(state.mu);
+  AggregateLocked(&state);
+  return SortedStatsLocked(state);
+}
+
+uint64_t SampledEventDroppedNum() {
+  auto& state = GetState();
+  std::lock_guard<std::mutex> guard(state.mu);
+  AggregateLocked(&state);
+  return state.dropped;
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,102 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+// The sampling profiler is a lightweight mode of the profiler which can be
+// left on in production. The RecordEvents of every step_interval-th step,
+// and besides a random op_sample_rate fraction of the RecordEvents of the
+// other steps, are written into fixed-size per-thread ring buffers. The
+// buffers are aggregated into per-event statistics every report_interval
+// steps, which are appended to report_path and passed to the callback.
+//
+// When the sampling profiler is not enabled, or the step is not sampled and
+// op_sample_rate is 0, a RecordEvent costs only one more atomic load.
+
+struct SampledEventStat {
+  std::string name;
+  uint64_t calls{0};
+  double total_ms{0.0};
+  double min_ms{0.0};
+  double max_ms{0.0};
+
+  double ave_ms() const { return calls == 0 ? 0.0 : total_ms / calls; }
+};
+
+using SampledEventStatsCallback =
+    std::function<void(int64_t step, const std::vector<SampledEventStat>&)>;
+
+struct SamplingProfilerOptions {
+  // Samples all the events of every step_interval-th step, 0 means none.
+  int64_t step_interval{100};
+  // The probability to sample an event of the other steps, in [0, 1].
+  double op_sample_rate{0.0};
+  // The number of events kept by each thread between two aggregations, the
+  // oldest ones are overwritten when it is full.
+  size_t buffer_size{4096};
+  // Reports the statistics every report_interval steps, 0 means they are
+  // reported only when the sampling profiler is disabled.
+  int64_t report_interval{1000};
+  // The file the statistics are appended to, empty means no file.
+  std::string report_path;
+  SampledEventStatsCallback callback;
+};
+
+namespace detail {
+// Whether the RecordEvents should be sampled at all, which is checked by
+// RecordEvent before anything else is done.
+extern std::atomic<bool> g_sampling_active;
+}  // namespace detail
+
+inline bool IsSamplingActive() {
+  return detail::g_sampling_active.load(std::memory_order_relaxed);
+}
+
+// Decides whether the current event is sampled, only called if
+// IsSamplingActive() is true.
+bool ShouldSampleEvent();
+
+// Writes the event into the ring buffer of the current thread.
+void RecordSampledEvent(const std::string& name, uint64_t start_ns,
+                        uint64_t end_ns);
+
+void EnableSamplingProfiler(const SamplingProfilerOptions& options);
+
+// Reports the statistics not reported yet, and stops sampling.
+void DisableSamplingProfiler();
+
+bool IsSamplingProfilerEnabled();
+
+// Marks the end of a step, which decides whether the next step is sampled
+// and reports the statistics every report_interval steps.
+void SamplingProfilerStep();
+
+// Returns the statistics of the events sampled since the last report, sorted
+// by the total time in descending order.
+std::vector<SampledEventStat> GetSampledEventStats();
+
+// The number of sampled events overwritten before they were aggregated.
+uint64_t SampledEventDroppedNum();
+
+}  // namespace platform
+}  // namespace paddle
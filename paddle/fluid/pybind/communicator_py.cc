@@ -21,6 +21,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/program_desc.h"
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 
 #include "paddle/fluid/operators/distributed/communicator.h"
 
@@ -64,7 +65,8 @@ void BindCommunicator(py::module* m) {
       }))
       .def("stop", &Communicator::Stop)
       .def("start", &Communicator::Start)
-      .def("is_running", &Communicator::IsRunning);
+      .def("is_running", &Communicator::IsRunning)
+      .def("get_stats", &Communicator::GetStats);
 }
 }  // namespace pybind
 }  // namespace paddle
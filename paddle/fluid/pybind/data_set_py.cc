@@ -197,6 +197,8 @@ void BindDataset(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("set_hdfs_config", &framework::Dataset::SetHdfsConfig,
            py::call_guard<py::gil_scoped_release>())
+      .def("set_hdfs_native_read", &framework::Dataset::SetHdfsNativeRead,
+           py::call_guard<py::gil_scoped_release>())
       .def("set_download_cmd", &framework::Dataset::SetDownloadCmd,
            py::call_guard<py::gil_scoped_release>())
       .def("set_data_feed_desc", &framework::Dataset::SetDataFeedDesc,
@@ -237,12 +239,21 @@ void BindDataset(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("global_shuffle", &framework::Dataset::GlobalShuffle,
            py::call_guard<py::gil_scoped_release>())
+      .def("load_into_memory_and_global_shuffle",
+           &framework::Dataset::LoadIntoMemoryAndGlobalShuffle,
+           py::call_guard<py::gil_scoped_release>())
       .def("get_memory_data_size", &framework::Dataset::GetMemoryDataSize,
            py::call_guard<py::gil_scoped_release>())
       .def("get_shuffle_data_size", &framework::Dataset::GetShuffleDataSize,
            py::call_guard<py::gil_scoped_release>())
       .def("set_queue_num", &framework::Dataset::SetChannelNum,
            py::call_guard<py::gil_scoped_release>())
+      .def("set_channel_shard_num", &framework::Dataset::SetChannelShardNum,
+           py::call_guard<py::gil_scoped_release>())
+      .def("set_compact_record", &framework::Dataset::SetCompactRecord,
+           py::call_guard<py::gil_scoped_release>())
+      .def("set_prefetch_batch", &framework::Dataset::SetPrefetchBatch,
+           py::call_guard<py::gil_scoped_release>())
       .def("set_parse_ins_id", &framework::Dataset::SetParseInsId,
            py::call_guard<py::gil_scoped_release>())
       .def("set_parse_content", &framework::Dataset::SetParseContent,
@@ -263,6 +274,12 @@ void BindDataset(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("set_preload_thread_num", &framework::Dataset::SetPreLoadThreadNum,
            py::call_guard<py::gil_scoped_release>())
+      .def("set_preload_memory_limit",
+           &framework::Dataset::SetPreLoadMemoryLimit,
+           py::call_guard<py::gil_scoped_release>())
+      .def("get_preload_memory_size",
+           &framework::Dataset::GetPreLoadMemorySize,
+           py::call_guard<py::gil_scoped_release>())
       .def("create_preload_readers", &framework::Dataset::CreatePreLoadReaders,
            py::call_guard<py::gil_scoped_release>())
       .def("destroy_preload_readers",
@@ -283,6 +300,24 @@ void BindDataset(py::module *m) {
                     const std::vector<platform::Place> &, size_t, bool>())
       .def("_start", &IterableDatasetWrapper::Start)
       .def("_next", &IterableDatasetWrapper::Next);
+
+  m->def("convert_multi_slot_text_to_binary",
+         [](const std::string &data_feed_desc_str, const std::string &src,
+            const std::string &dst, bool parse_ins_id, bool parse_content,
+            size_t block_size) {
+           framework::DataFeedDesc data_feed_desc;
+           bool success = google::protobuf::TextFormat::ParseFromString(
+               data_feed_desc_str, &data_feed_desc);
+           PADDLE_ENFORCE_EQ(success, true,
+                             platform::errors::InvalidArgument(
+                                 "Fail to parse DataFeedDesc from string."));
+           framework::MultiSlotBinaryInMemoryDataFeed feed;
+           feed.Init(data_feed_desc);
+           feed.SetParseInsId(parse_ins_id);
+           feed.SetParseContent(parse_content);
+           feed.ConvertTextFile(src, dst, block_size);
+         },
+         py::call_guard<py::gil_scoped_release>());
 }
 
 }  // namespace pybind
@@ -54,6 +54,8 @@ void BindFleetWrapper(py::module* m) {
       .def("init_worker", &framework::FleetWrapper::InitWorker)
       .def("init_model", &framework::FleetWrapper::PushDenseParamSync)
       .def("save_model", &framework::FleetWrapper::SaveModel)
+      .def("save_model_async", &framework::FleetWrapper::SaveModelAsync)
+      .def("wait_save_model", &framework::FleetWrapper::WaitSaveModel)
       .def("get_cache_threshold", &framework::FleetWrapper::GetCacheThreshold)
       .def("cache_shuffle", &framework::FleetWrapper::CacheShuffle)
       .def("save_cache", &framework::FleetWrapper::SaveCache)
@@ -74,6 +76,7 @@ void BindFleetWrapper(py::module* m) {
       .def("load_from_paddle_model",
            &framework::FleetWrapper::LoadFromPaddleModel)
       .def("load_model_one_table", &framework::FleetWrapper::LoadModelOneTable)
+      .def("load_model_tables", &framework::FleetWrapper::LoadModelTables)
       .def("set_client2client_config",
            &framework::FleetWrapper::SetClient2ClientConfig)
       .def("set_pull_local_thread_num",
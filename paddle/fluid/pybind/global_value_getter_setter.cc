@@ -39,6 +39,9 @@ DECLARE_bool(cudnn_deterministic);
 #endif
 DECLARE_string(allocator_strategy);
 DECLARE_bool(enable_parallel_graph);
+DECLARE_bool(executor_compiled_mode);
+DECLARE_double(local_exe_scope_drop_memory_mb);
+DECLARE_double(local_exe_scope_drop_fragmentation);
 
 namespace paddle {
 namespace pybind {
@@ -290,7 +293,9 @@ static void RegisterGlobalVarGetterSetter() {
 
   REGISTER_PUBLIC_GLOBAL_VAR(
       FLAGS_eager_delete_tensor_gb, FLAGS_enable_parallel_graph,
-      FLAGS_allocator_strategy, FLAGS_use_system_allocator);
+      FLAGS_allocator_strategy, FLAGS_use_system_allocator,
+      FLAGS_executor_compiled_mode, FLAGS_local_exe_scope_drop_memory_mb,
+      FLAGS_local_exe_scope_drop_fragmentation);
 
 #ifdef PADDLE_WITH_CUDA
   REGISTER_PUBLIC_GLOBAL_VAR(FLAGS_gpu_memory_limit_mb,
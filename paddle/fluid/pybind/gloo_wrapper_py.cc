@@ -43,6 +43,19 @@ void BindGlooWrapper(py::module* m) {
       .def("all_gather", &framework::GlooWrapper::AllGather<uint64_t>)
       .def("all_gather", &framework::GlooWrapper::AllGather<int64_t>)
       .def("all_gather", &framework::GlooWrapper::AllGather<double>);
+
+  m->def("init_gloo_parallel_env",
+         [](int rank, int size, const std::string& path,
+            const std::string& fs_name, const std::string& fs_ugi,
+            const std::string& iface, const std::string& prefix,
+            int ring_num) {
+           auto gloo = framework::GlooWrapper::GetInstance();
+           gloo->Init(rank, size, path, fs_name, fs_ugi, iface, prefix);
+           gloo->InitDenseRings(ring_num);
+         },
+         py::arg("rank"), py::arg("size"), py::arg("path"),
+         py::arg("fs_name"), py::arg("fs_ugi"), py::arg("iface"),
+         py::arg("prefix"), py::arg("ring_num") = 1);
 }  // end BindGlooWrapper
 }  // end namespace pybind
 }  // end namespace paddle
@@ -22,6 +22,7 @@ limitations under the License. */
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/imperative/backward_strategy.h"
@@ -31,6 +32,7 @@ limitations under the License. */
 #include "paddle/fluid/imperative/nccl_context.h"
 #include "paddle/fluid/imperative/partial_grad_engine.h"
 #include "paddle/fluid/imperative/profiler.h"
+#include "paddle/fluid/imperative/reducer.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
@@ -43,6 +45,24 @@ namespace pybind {
 
 namespace py = ::pybind11;
 
+// Runs the elementwise ops deferred by the current tracer, before reading the
+// values of the variables.
+static void FlushElementwiseFusion() {
+  auto &tracer = imperative::GetCurrentTracer();
+  if (tracer) {
+    tracer->FlushElementwiseFusion();
+  }
+}
+
+// The float16 copies of the parameters cached by the automatic mixed
+// precision can not be reused after their grad ops run.
+static void ClearAutoCastCache() {
+  auto &tracer = imperative::GetCurrentTracer();
+  if (tracer) {
+    tracer->ClearAutoCastCache();
+  }
+}
+
 class Layer : public imperative::Layer {
  public:
   using imperative::Layer::Layer;  // Inherit constructors
@@ -263,19 +283,19 @@ void BindImperative(py::module *m_ptr) {
           framework::LoDTensor t;
           SetTensorFromPyArray<platform::CPUPlace>(&t, array,
                                                    platform::CPUPlace(), true);
-          // 3. allocate shared memory
+          // 3. allocate shared memory, the files released by the main
+          // process are reused, and the files are unlinked by
+          // _cleanup_mmap_fds or by the main process
           void *data_ptr = t.data<void>();
           size_t data_size = t.numel() * framework::SizeOfType(t.type());
           auto shared_writer_holder =
-              memory::allocation::AllocateMemoryMapWriterAllocation(data_size);
-          // 4. maintain mmap fd set & backup ipc_name
-          const std::string &ipc_name = shared_writer_holder->ipc_name();
-          memory::allocation::MemoryMapFdSet::Instance().Insert(ipc_name);
-          // 5. copy data & reset holder
+              memory::allocation::MemoryMapAllocationPool::Instance().Allocate(
+                  data_size);
+          // 4. copy data & reset holder
           memory::Copy(platform::CPUPlace(), shared_writer_holder->ptr(),
                        platform::CPUPlace(), data_ptr, data_size);
           t.ResetHolder(shared_writer_holder);
-          // 6. append to result list
+          // 5. append to result list
           tensors.append(t);
         }
         return tensors;
@@ -285,6 +305,11 @@ void BindImperative(py::module *m_ptr) {
   m.def("_remove_tensor_list_mmap_fds", [](py::list &tensor_list) {
     for (size_t i = 0; i < tensor_list.size(); ++i) {
       auto t = tensor_list[i].cast<framework::LoDTensor>();
+      // the files of MemoryMapAllocationPool are kept by the pool
+      if (dynamic_cast<memory::allocation::MemoryMapPoolWriterAllocation *>(
+              t.Holder().get())) {
+        continue;
+      }
       auto *mmap_writer_allocation =
           dynamic_cast<memory::allocation::MemoryMapWriterAllocation *>(
               t.Holder().get());
@@ -298,8 +323,29 @@ void BindImperative(py::module *m_ptr) {
     }
   });
 
-  m.def("_cleanup_mmap_fds",
-        []() { memory::allocation::MemoryMapFdSet::Instance().Clear(); });
+  m.def("_cleanup_mmap_fds", []() {
+    memory::allocation::MemoryMapFdSet::Instance().Clear();
+    memory::allocation::MemoryMapAllocationPool::Instance().Clear();
+  });
+
+  m.def("_write_tensor_list_to_pipe", [](int fd, py::list &tensor_list) {
+    std::vector<framework::LoDTensor> tensors;
+    for (size_t i = 0; i < tensor_list.size(); ++i) {
+      tensors.emplace_back(tensor_list[i].cast<framework::LoDTensor>());
+    }
+    // the write blocks when the pipe is full
+    py::gil_scoped_release release;
+    imperative::WriteTensorListToPipe(fd, tensors);
+  });
+
+  m.def("_write_end_of_data_to_pipe", &imperative::WriteEndOfDataToPipe,
+        py::call_guard<py::gil_scoped_release>());
+
+  py::class_<imperative::PipeBatchReader>(m, "_PipeBatchReader")
+      .def(py::init<int, const std::shared_ptr<
+                             operators::reader::LoDTensorBlockingQueue> &>())
+      .def("join", &imperative::PipeBatchReader::Join,
+           py::call_guard<py::gil_scoped_release>());
 #endif
 
   py::class_<imperative::detail::BackwardStrategy> backward_strategy(
@@ -317,6 +363,12 @@ void BindImperative(py::module *m_ptr) {
 
         By Default: False
 
+        **num_threads**:
+
+        The number of the threads running the grad ops which are ready, so that the independent branches of the backward overlap. The grad ops run one by one in the calling thread if it is 1.
+
+        By Default: 1
+
         Examples:
             .. code-block:: python
 
@@ -344,6 +396,18 @@ void BindImperative(py::module *m_ptr) {
                     [](imperative::detail::BackwardStrategy &self,
                        bool sorted_sum_gradient) {
                       self.sorted_sum_gradient_ = sorted_sum_gradient;
+                    })
+      .def_property("num_threads",
+                    [](const imperative::detail::BackwardStrategy &self) {
+                      return self.num_threads_;
+                    },
+                    [](imperative::detail::BackwardStrategy &self,
+                       size_t num_threads) {
+                      PADDLE_ENFORCE_GT(num_threads, 0,
+                                        platform::errors::InvalidArgument(
+                                            "The number of the threads of the "
+                                            "backward should be positive."));
+                      self.num_threads_ = num_threads;
                     });
 
   m.def("start_imperative_gperf_profiler",
@@ -491,6 +555,7 @@ void BindImperative(py::module *m_ptr) {
            })
       .def("numpy",
            [](imperative::VarBase &self) -> py::array {
+             FlushElementwiseFusion();
              const auto &tensor =
                  self.MutableVar()->Get<framework::LoDTensor>();
              PADDLE_ENFORCE_EQ(
@@ -530,6 +595,7 @@ void BindImperative(py::module *m_ptr) {
        )DOC")
       .def("detach",
            [](const imperative::VarBase &self) {
+             FlushElementwiseFusion();
              const auto &tensor = self.Var().Get<framework::LoDTensor>();
              PADDLE_ENFORCE_EQ(tensor.IsInitialized(), true,
                                platform::errors::InvalidArgument(
@@ -601,6 +667,8 @@ void BindImperative(py::module *m_ptr) {
               const imperative::Tracer &tracer) {
              // TODO(jiabin): when we impl more backward execution we can select
              // them
+             FlushElementwiseFusion();
+             ClearAutoCastCache();
              auto *engine = tracer.GetEngine();
              engine->Init(&self, bckst);
              VLOG(3) << "Start backward";
@@ -634,13 +702,25 @@ void BindImperative(py::module *m_ptr) {
            py::return_value_policy::copy)
       .def("_copy_to",
            [](const imperative::VarBase &self, const platform::CPUPlace &place,
-              bool blocking) { return self.NewVarBase(place, blocking); },
+              bool blocking) {
+             FlushElementwiseFusion();
+             return self.NewVarBase(place, blocking);
+           },
            py::return_value_policy::copy)
       .def("_copy_to",
            [](const imperative::VarBase &self, const platform::CUDAPlace &place,
-              bool blocking) { return self.NewVarBase(place, blocking); },
+              bool blocking) {
+             FlushElementwiseFusion();
+             return self.NewVarBase(place, blocking);
+           },
            py::return_value_policy::copy)
-      .def("value", [](imperative::VarBase &self) { return self.MutableVar(); },
+      .def("value",
+           [](imperative::VarBase &self) {
+             FlushElementwiseFusion();
+             // The variable may be written by the caller.
+             self.BumpInplaceVersion();
+             return self.MutableVar();
+           },
            py::return_value_policy::reference)
       .def_property("name", &imperative::VarBase::Name,
                     &imperative::VarBase::SetName)
@@ -690,6 +770,30 @@ void BindImperative(py::module *m_ptr) {
                     &imperative::Tracer::SetEnableProgramDescTracing)
       .def_property("_train_mode", &imperative::Tracer::NoGrad,
                     &imperative::Tracer::SetNoGrad)
+      .def_property("_enable_elementwise_fusion",
+                    &imperative::Tracer::IsElementwiseFusionEnabled,
+                    &imperative::Tracer::SetEnableElementwiseFusion)
+      .def_property("_enable_auto_cast",
+                    &imperative::Tracer::IsAutoCastEnabled,
+                    &imperative::Tracer::SetEnableAutoCast)
+      .def("_set_amp_op_list",
+           [](imperative::Tracer &self,
+              const std::unordered_set<std::string> &white_list,
+              const std::unordered_set<std::string> &black_list) {
+             self.GetAmpAutoCast()->SetOpLists(white_list, black_list);
+           })
+      .def("_get_amp_op_list",
+           [](imperative::Tracer &self) {
+             auto *amp = self.GetAmpAutoCast();
+             return std::make_pair(amp->WhiteList(), amp->BlackList());
+           })
+      .def("_begin_recompute", &imperative::Tracer::BeginRecompute)
+      .def("_end_recompute", &imperative::Tracer::EndRecompute)
+      .def("_set_gradient_hook",
+           [](imperative::Tracer &self,
+              const std::shared_ptr<imperative::GradientHook> &hook) {
+             self.GetEngine()->SetGradientHook(hook);
+           })
       .def_property(
           "_expected_place",
           [](const imperative::Tracer &self) -> py::object {
@@ -785,6 +889,8 @@ void BindImperative(py::module *m_ptr) {
          const imperative::detail::BackwardStrategy &strategy,
          bool create_graph, bool retain_graph, bool allow_unused,
          bool only_inputs) {
+        FlushElementwiseFusion();
+        ClearAutoCastCache();
         imperative::PartialGradEngine engine(
             input_targets, output_targets, output_grads, no_grad_vars, place,
             strategy, create_graph, retain_graph, allow_unused, only_inputs);
@@ -793,6 +899,9 @@ void BindImperative(py::module *m_ptr) {
       },
       py::call_guard<py::gil_scoped_release>());
 
+  py::class_<imperative::GradientHook,
+             std::shared_ptr<imperative::GradientHook>>(m, "GradientHook");
+
 #if defined(PADDLE_WITH_NCCL)
   py::class_<imperative::NCCLParallelContext> nccl_ctx(m,
                                                        "NCCLParallelContext");
@@ -801,6 +910,14 @@ void BindImperative(py::module *m_ptr) {
       .def(py::init<const imperative::ParallelStrategy &,
                     const platform::CUDAPlace &>())
       .def("init", [](imperative::NCCLParallelContext &self) { self.Init(); });
+
+  py::class_<imperative::Reducer, imperative::GradientHook,
+             std::shared_ptr<imperative::Reducer>>(m, "Reducer")
+      .def(py::init<const std::vector<std::shared_ptr<imperative::VarBase>> &,
+                    int64_t, const platform::CUDAPlace &, int>(),
+           py::arg("params"), py::arg("bucket_bytes"), py::arg("place"),
+           py::arg("ring_id") = 0)
+      .def("bucket_num", &imperative::Reducer::BucketNum);
 #endif
 }
 
@@ -39,6 +39,7 @@ namespace pybind {
 using paddle::AnalysisPredictor;
 using paddle::NativeConfig;
 using paddle::NativePaddlePredictor;
+using paddle::OpLatencyStats;
 using paddle::PaddleBuf;
 using paddle::PaddleDType;
 using paddle::PaddlePassBuilder;
@@ -177,6 +178,21 @@ py::array ZeroCopyTensorToNumpy(ZeroCopyTensor &tensor) {  // NOLINT
   return array;
 }
 
+// The callback is called from the stream callback thread on GPU, so the GIL
+// is acquired to call and to release it.
+bool ZeroCopyRunAsync(PaddlePredictor &predictor,  // NOLINT
+                      py::function callback) {
+  std::shared_ptr<py::function> func(new py::function(std::move(callback)),
+                                     [](py::function *f) {
+                                       py::gil_scoped_acquire gil;
+                                       delete f;
+                                     });
+  return predictor.ZeroCopyRunAsync([func](bool success) {
+    py::gil_scoped_acquire gil;
+    (*func)(success);
+  });
+}
+
 py::bytes SerializePDTensorToBytes(PaddleTensor &tensor) {  // NOLINT
   std::stringstream ss;
   paddle::inference::SerializePDTensorToStream(&ss, tensor);
@@ -305,6 +321,15 @@ void BindPaddlePlace(py::module *m) {
 }
 
 void BindPaddlePredictor(py::module *m) {
+  py::class_<OpLatencyStats>(*m, "OpLatencyStats")
+      .def(py::init<>())
+      .def_readonly("count", &OpLatencyStats::count)
+      .def_readonly("mean_us", &OpLatencyStats::mean_us)
+      .def_readonly("p50_us", &OpLatencyStats::p50_us)
+      .def_readonly("p90_us", &OpLatencyStats::p90_us)
+      .def_readonly("p99_us", &OpLatencyStats::p99_us)
+      .def_readonly("max_us", &OpLatencyStats::max_us);
+
   auto paddle_predictor = py::class_<PaddlePredictor>(*m, "PaddlePredictor");
   paddle_predictor
       .def("run",
@@ -318,6 +343,8 @@ void BindPaddlePredictor(py::module *m) {
       .def("get_input_names", &PaddlePredictor::GetInputNames)
       .def("get_output_names", &PaddlePredictor::GetOutputNames)
       .def("zero_copy_run", &PaddlePredictor::ZeroCopyRun)
+      .def("zero_copy_run_async", &ZeroCopyRunAsync)
+      .def("get_op_latency_stats", &PaddlePredictor::GetOpLatencyStats)
       .def("clone", &PaddlePredictor::Clone)
       .def("get_serialized_program", &PaddlePredictor::GetSerializedProgram);
 
@@ -393,11 +420,42 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::memory_pool_init_size_mb)
       .def("fraction_of_gpu_memory_for_pool",
            &AnalysisConfig::fraction_of_gpu_memory_for_pool)
+      .def("set_gpu_memory_budget", &AnalysisConfig::SetGpuMemoryBudget,
+           py::arg("budget_mb"), py::arg("spill_to_host") = true)
+      .def("gpu_memory_budget_mb", &AnalysisConfig::gpu_memory_budget_mb)
+      .def("gpu_memory_spill_to_host",
+           &AnalysisConfig::gpu_memory_spill_to_host)
+      .def("enable_gpu_multi_stream", &AnalysisConfig::EnableGpuMultiStream,
+           py::arg("x") = true)
+      .def("gpu_multi_stream_enabled",
+           &AnalysisConfig::gpu_multi_stream_enabled)
+      .def("enable_nhwc_layout", &AnalysisConfig::EnableNHWCLayout)
+      .def("nhwc_layout_enabled", &AnalysisConfig::nhwc_layout_enabled)
       .def("switch_ir_optim", &AnalysisConfig::SwitchIrOptim,
            py::arg("x") = true)
       .def("ir_optim", &AnalysisConfig::ir_optim)
       .def("enable_memory_optim", &AnalysisConfig::EnableMemoryOptim)
+      .def("enable_static_memory_plan",
+           &AnalysisConfig::EnableStaticMemoryPlan, py::arg("x") = true)
+      .def("static_memory_plan_enabled",
+           &AnalysisConfig::static_memory_plan_enabled)
+      .def("enable_cuda_graph", &AnalysisConfig::EnableCUDAGraph,
+           py::arg("x") = true)
+      .def("cuda_graph_enabled", &AnalysisConfig::cuda_graph_enabled)
+      .def("enable_fuse_pass_auto_tune",
+           &AnalysisConfig::EnableFusePassAutoTune, py::arg("batch_size") = 1,
+           py::arg("seq_len") = 1, py::arg("repeat") = 10)
+      .def("fuse_pass_auto_tune_enabled",
+           &AnalysisConfig::fuse_pass_auto_tune_enabled)
+      .def("enable_optim_model_cache", &AnalysisConfig::EnableOptimModelCache,
+           py::arg("x") = true)
+      .def("optim_model_cache_enabled",
+           &AnalysisConfig::optim_model_cache_enabled)
       .def("enable_profile", &AnalysisConfig::EnableProfile)
+      .def("enable_op_latency_stats", &AnalysisConfig::EnableOpLatencyStats,
+           py::arg("x") = true)
+      .def("op_latency_stats_enabled",
+           &AnalysisConfig::op_latency_stats_enabled)
       .def("disable_glog_info", &AnalysisConfig::DisableGlogInfo)
       .def("glog_info_disabled", &AnalysisConfig::glog_info_disabled)
       .def("set_optim_cache_dir", &AnalysisConfig::SetOptimCacheDir)
@@ -422,15 +480,25 @@ void BindAnalysisConfig(py::module *m) {
            py::arg("optim_input_shape") =
                std::map<std::string, std::vector<int>>({}),
            py::arg("disable_trt_plugin_fp16") = false)
+      .def("add_trt_dynamic_shape_profile",
+           &AnalysisConfig::AddTRTDynamicShapeProfile,
+           py::arg("min_input_shape"), py::arg("max_input_shape"),
+           py::arg("optim_input_shape"))
+      .def("set_trt_engine_build_threads",
+           &AnalysisConfig::SetTRTEngineBuildThreads)
       .def("tensorrt_engine_enabled", &AnalysisConfig::tensorrt_engine_enabled)
       .def("switch_ir_debug", &AnalysisConfig::SwitchIrDebug,
            py::arg("x") = true)
       .def("enable_mkldnn", &AnalysisConfig::EnableMKLDNN)
       .def("mkldnn_enabled", &AnalysisConfig::mkldnn_enabled)
+      .def("set_mkldnn_batch_buckets", &AnalysisConfig::SetMkldnnBatchBuckets)
+      .def("mkldnn_batch_buckets", &AnalysisConfig::mkldnn_batch_buckets)
       .def("set_cpu_math_library_num_threads",
            &AnalysisConfig::SetCpuMathLibraryNumThreads)
       .def("cpu_math_library_num_threads",
            &AnalysisConfig::cpu_math_library_num_threads)
+      .def("set_cpu_thread_partition", &AnalysisConfig::SetCpuThreadPartition)
+      .def("cpu_thread_partition", &AnalysisConfig::cpu_thread_partition)
       .def("to_native_config", &AnalysisConfig::ToNativeConfig)
       .def("enable_quantizer", &AnalysisConfig::EnableMkldnnQuantizer)
 #ifdef PADDLE_WITH_MKLDNN
@@ -487,6 +555,8 @@ void BindAnalysisPredictor(py::module *m) {
       .def("get_output_names", &AnalysisPredictor::GetOutputNames)
       .def("get_input_tensor_shape", &AnalysisPredictor::GetInputTensorShape)
       .def("zero_copy_run", &AnalysisPredictor::ZeroCopyRun)
+      .def("zero_copy_run_async", &ZeroCopyRunAsync)
+      .def("get_op_latency_stats", &AnalysisPredictor::GetOpLatencyStats)
       .def("create_feed_fetch_var", &AnalysisPredictor::CreateFeedFetchVar)
       .def("prepare_feed_fetch", &AnalysisPredictor::PrepareFeedFetch)
       .def("prepare_argument", &AnalysisPredictor::PrepareArgument)
@@ -547,6 +617,7 @@ void BindPaddlePassBuilder(py::module *m) {
       .def("enable_mkldnn", &PassStrategy::EnableMKLDNN)
       .def("enable_ngraph", &PassStrategy::EnableNgraph)
       .def("enable_mkldnn_quantizer", &PassStrategy::EnableMkldnnQuantizer)
+      .def("enable_nhwc_layout", &PassStrategy::EnableNHWCLayout)
       .def("use_gpu", &PassStrategy::use_gpu);
 
   py::class_<CpuPassStrategy, PassStrategy>(*m, "CpuPassStrategy")
@@ -555,7 +626,8 @@ void BindPaddlePassBuilder(py::module *m) {
       .def("enable_cudnn", &CpuPassStrategy::EnableCUDNN)
       .def("enable_mkldnn", &CpuPassStrategy::EnableMKLDNN)
       .def("enable_ngraph", &CpuPassStrategy::EnableNgraph)
-      .def("enable_mkldnn_quantizer", &CpuPassStrategy::EnableMkldnnQuantizer);
+      .def("enable_mkldnn_quantizer", &CpuPassStrategy::EnableMkldnnQuantizer)
+      .def("enable_nhwc_layout", &CpuPassStrategy::EnableNHWCLayout);
 
   py::class_<GpuPassStrategy, PassStrategy>(*m, "GpuPassStrategy")
       .def(py::init<>())
@@ -563,7 +635,8 @@ void BindPaddlePassBuilder(py::module *m) {
       .def("enable_cudnn", &GpuPassStrategy::EnableCUDNN)
       .def("enable_mkldnn", &GpuPassStrategy::EnableMKLDNN)
       .def("enable_ngraph", &GpuPassStrategy::EnableNgraph)
-      .def("enable_mkldnn_quantizer", &GpuPassStrategy::EnableMkldnnQuantizer);
+      .def("enable_mkldnn_quantizer", &GpuPassStrategy::EnableMkldnnQuantizer)
+      .def("enable_nhwc_layout", &GpuPassStrategy::EnableNHWCLayout);
 }
 }  // namespace
 }  // namespace pybind
@@ -20,6 +20,7 @@
 #include <pybind11/stl.h>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/attribute.h"
 #include "paddle/fluid/framework/op_info.h"
@@ -31,16 +32,66 @@
 namespace py = pybind11;
 namespace paddle {
 namespace pybind {
-static inline void ConstructAttrMapFromPyArgs(framework::AttributeMap* attrs,
+// The types of the attributes of an op, which are generated from its proto.
+using OpAttrTypeMap =
+    std::unordered_map<std::string, framework::proto::AttrType>;
+
+template <typename T>
+static inline framework::Attribute CastPyArg2Attr(const py::handle& obj) {
+  py::detail::make_caster<T> caster;
+  if (caster.load(obj, true)) {
+    return py::detail::cast_op<T>(caster);
+  }
+  // The attribute checker converts some of the types, e.g. int to bool.
+  return obj.cast<framework::Attribute>();
+}
+
+// Casting to framework::Attribute tries all the types of the variant one by
+// one, so the attributes are cast by the types in the op proto if known.
+static inline framework::Attribute CastPyArg2Attr(
+    const py::handle& obj, framework::proto::AttrType type) {
+  switch (type) {
+    case framework::proto::AttrType::INT:
+      return CastPyArg2Attr<int>(obj);
+    case framework::proto::AttrType::FLOAT:
+      return CastPyArg2Attr<float>(obj);
+    case framework::proto::AttrType::STRING:
+      return CastPyArg2Attr<std::string>(obj);
+    case framework::proto::AttrType::INTS:
+      return CastPyArg2Attr<std::vector<int>>(obj);
+    case framework::proto::AttrType::FLOATS:
+      return CastPyArg2Attr<std::vector<float>>(obj);
+    case framework::proto::AttrType::STRINGS:
+      return CastPyArg2Attr<std::vector<std::string>>(obj);
+    case framework::proto::AttrType::BOOLEAN:
+      return CastPyArg2Attr<bool>(obj);
+    case framework::proto::AttrType::BOOLEANS:
+      return CastPyArg2Attr<std::vector<bool>>(obj);
+    case framework::proto::AttrType::LONG:
+      return CastPyArg2Attr<int64_t>(obj);
+    case framework::proto::AttrType::LONGS:
+      return CastPyArg2Attr<std::vector<int64_t>>(obj);
+    default:
+      return obj.cast<framework::Attribute>();
+  }
+}
+
+static inline void ConstructAttrMapFromPyArgs(const OpAttrTypeMap& attr_types,
+                                              framework::AttributeMap* attrs,
                                               const py::args& args) {
   PADDLE_ENFORCE_EQ(
       args.size() % 2, 0,
       platform::errors::InvalidArgument(
           "The number of arguments for arributes should be even."));
+  attrs->reserve(args.size() / 2);
   for (size_t i = 0; i < args.size(); i += 2) {
     auto name = args[i].cast<std::string>();
-    auto value = args[i + 1].cast<framework::Attribute>();
-    (*attrs)[name] = value;
+    auto iter = attr_types.find(name);
+    if (iter == attr_types.end()) {
+      (*attrs)[name] = args[i + 1].cast<framework::Attribute>();
+    } else {
+      (*attrs)[name] = CastPyArg2Attr(args[i + 1], iter->second);
+    }
   }
 }
 
@@ -71,6 +71,8 @@ const char* RETURN_TUPLE_TEMPLATE = R"(std::make_tuple(%s))";
 const char* RETURN_LIST_TEMPLATE = R"(outs["%s"])";
 const char* RETURN_TEMPLATE = R"(outs["%s"][0])";
 
+const char* ATTR_TYPE_TEMPLATE = R"({"%s", framework::proto::AttrType::%s})";
+
 const char* FUNCTION_ARGS = R"(%s, const py::args& args)";
 const char* FUNCTION_ARGS_NO_INPUT = R"(const py::args& args)";
 
@@ -78,15 +80,16 @@ const char* OP_FUNCTION_TEMPLATE =
 R"(
 %s %s(%s)
 {
+  static const OpAttrTypeMap attr_types = %s;
   framework::AttributeMap attrs;
-  ConstructAttrMapFromPyArgs(&attrs, args);
+  ConstructAttrMapFromPyArgs(attr_types, &attrs, args);
   {
     py::gil_scoped_release release;
     auto tracer = imperative::GetCurrentTracer();
     imperative::NameVarBaseMap outs = %s;
     imperative::NameVarBaseMap ins = %s;
     %s
-    tracer->TraceOp("%s", ins, outs, attrs);
+    tracer->TraceOp("%s", ins, outs, std::move(attrs));
     return %s; 
   }   
 })";
@@ -237,12 +240,25 @@ GenerateOpFunctions(const std::string& module_name) {
       function_args = paddle::string::Sprintf(FUNCTION_ARGS, input_args);
     }
 
+    // Generate the types of the attributes
+    std::string attr_types_initializer = "{";
+    for (auto& attr : op_proto->attrs()) {
+      attr_types_initializer += paddle::string::Sprintf(
+          ATTR_TYPE_TEMPLATE, attr.name(),
+          paddle::framework::proto::AttrType_Name(attr.type()));
+      attr_types_initializer += ",";
+    }
+    if (attr_types_initializer.back() == ',') {
+      attr_types_initializer.pop_back();
+    }
+    attr_types_initializer += "}";
+
     std::string func_name = "imperative_" + op_type;
     // generate op funtcion body
     auto op_function_str = paddle::string::Sprintf(
         OP_FUNCTION_TEMPLATE, return_type, func_name, function_args,
-        outs_initializer, ins_initializer, ins_initializer_with_null, op_type,
-        return_str);
+        attr_types_initializer, outs_initializer, ins_initializer,
+        ins_initializer_with_null, op_type, return_str);
 
     // generate pybind item
     auto bind_function_str = paddle::string::Sprintf(
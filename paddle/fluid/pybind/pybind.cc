@@ -17,6 +17,7 @@ limitations under the License. */
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT // for call_once
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -27,6 +28,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/garbage_collector.h"
+#include "paddle/fluid/framework/io/async_checkpoint.h"
 #include "paddle/fluid/framework/io/fs.h"
 #include "paddle/fluid/framework/ir/coalesce_grad_tensor_pass.h"
 #include "paddle/fluid/framework/ir/pass_builder.h"
@@ -47,17 +49,22 @@ limitations under the License. */
 #include "paddle/fluid/framework/type_defs.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 #include "paddle/fluid/operators/activation_op.h"
 #include "paddle/fluid/operators/py_func_op.h"
+#include "paddle/fluid/platform/cpu_affinity.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/dynload/dynamic_loader.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/memory_profiler.h"
+#include "paddle/fluid/platform/metrics.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 #include "paddle/fluid/pybind/box_helper_py.h"
 #include "paddle/fluid/pybind/const_value.h"
 #include "paddle/fluid/pybind/data_set_py.h"
@@ -234,6 +241,47 @@ static std::vector<std::string> inline GetNameList(
   return vec_res;
 }
 
+static py::dict GetAllocatorStats(const platform::Place &place) {
+  auto stats =
+      memory::allocation::AllocatorFacade::Instance().GetStats(place);
+  py::dict dict;
+  dict["allocated_bytes"] = stats.allocated_bytes;
+  dict["peak_allocated_bytes"] = stats.peak_allocated_bytes;
+  dict["total_allocated_bytes"] = stats.total_allocated_bytes;
+  dict["alloc_count"] = stats.alloc_count;
+  dict["free_count"] = stats.free_count;
+  dict["size_histogram"] = stats.size_histogram;
+  dict["reserved_bytes"] = stats.chunk_stats.reserved_bytes;
+  dict["chunk_num"] = stats.chunk_stats.chunk_num;
+  dict["free_bytes"] = stats.chunk_stats.free_bytes;
+  dict["largest_free_block"] = stats.chunk_stats.largest_free_block;
+  dict["fragmentation"] = stats.Fragmentation();
+  dict["defragment_num"] = stats.chunk_stats.defragment_num;
+  dict["recovered_bytes"] = stats.chunk_stats.recovered_bytes;
+  return dict;
+}
+
+static py::list GetMemoryPeaks(size_t top_n) {
+  py::list peaks;
+  for (auto &peak : platform::MemoryProfiler::Instance().GetPeaks(top_n)) {
+    std::ostringstream place;
+    place << peak.place;
+    py::dict categories;
+    for (auto &pair : peak.category_bytes) {
+      categories[platform::MemoryCategoryName(pair.first)] = pair.second;
+    }
+    py::dict dict;
+    dict["place"] = place.str();
+    dict["time_ns"] = peak.time_ns;
+    dict["peak_bytes"] = peak.peak_bytes;
+    dict["categories"] = categories;
+    dict["ops"] = peak.op_bytes;
+    dict["vars"] = peak.var_bytes;
+    peaks.append(dict);
+  }
+  return peaks;
+}
+
 static void inline CreateVariableIfNotExit(
     const py::handle &py_handle, const framework::Scope &scope,
     const framework::Executor *exe = nullptr) {
@@ -330,6 +378,14 @@ PYBIND11_MODULE(core_noavx, m) {
   BindException(&m);
 
   m.def("set_num_threads", &platform::SetNumThreads);
+  m.def("set_cpu_thread_partition", &platform::SetCpuThreadPartition);
+  m.def("get_cpu_thread_partition", &platform::GetCpuThreadPartition);
+  m.def("get_metrics", [] {
+    return platform::MetricsRegistry::Instance().ExportPrometheus();
+  });
+  m.def("start_metrics_server", &platform::StartMetricsHttpServer,
+        py::arg("port") = 0);
+  m.def("stop_metrics_server", &platform::StopMetricsHttpServer);
 
   m.def("from_dlpack", [](py::capsule *dltensor) {
     DLManagedTensor *dmt = reinterpret_cast<DLManagedTensor *>(
@@ -871,6 +927,18 @@ PYBIND11_MODULE(core_noavx, m) {
               platform::errors::PreconditionNotMet(
                   "LoDTensor is not on CPU."
                   "Now only LoDTensor on CPU can be serialized."));
+            int type_idx = static_cast<int>(t.type());
+            auto* pool_writer_allocation =
+              dynamic_cast<memory::allocation::MemoryMapPoolWriterAllocation *>(
+                holder.get());
+            if (pool_writer_allocation != nullptr) {
+              // the file returns to the pool after the reader releases it
+              pool_writer_allocation->MarkSent();
+              return py::make_tuple(pool_writer_allocation->ipc_name(),
+                                    pool_writer_allocation->size(),
+                                    type_idx, vectorize(t.dims()), t.lod(),
+                                    true);
+            }
             auto* mmap_writer_allocation =
               dynamic_cast<memory::allocation::MemoryMapWriterAllocation *>(
                 holder.get());
@@ -878,25 +946,33 @@ PYBIND11_MODULE(core_noavx, m) {
               platform::errors::PreconditionNotMet(
                 "LoDTensor is not in shared memory."
                 "Now only LoDTensor on shared memory can be serialized."));
-            int type_idx = static_cast<int>(t.type());
 
             return py::make_tuple(mmap_writer_allocation->ipc_name(),
                                   mmap_writer_allocation->size(),
                                   type_idx, vectorize(t.dims()), t.lod());
           },
           [](py::tuple t) {  // __setstate__
-            if (t.size() != 5)
+            if (t.size() != 5 && t.size() != 6)
               throw std::runtime_error("Invalid LoDTensor state!");
 
             // 1. Create a new C++ instance
             LoDTensor tensor;
 
-            // 2. Rebuild Allocation
+            // 2. Rebuild Allocation, the 6th item marks the files of
+            // MemoryMapAllocationPool
             const std::string &ipc_name = t[0].cast<std::string>();
             size_t size = t[1].cast<size_t>();
-            auto shared_reader_holder =
-              memory::allocation::RebuildMemoryMapReaderAllocation(
-                ipc_name, size);
+            std::shared_ptr<memory::allocation::Allocation>
+              shared_reader_holder;
+            if (t.size() == 6 && t[5].cast<bool>()) {
+              shared_reader_holder =
+                memory::allocation::RebuildMemoryMapPoolReaderAllocation(
+                  ipc_name, size);
+            } else {
+              shared_reader_holder =
+                memory::allocation::RebuildMemoryMapReaderAllocation(
+                  ipc_name, size);
+            }
 
             // 3. Maintain global fd set
             VLOG(3) << "LoDTensor ipc name: " << ipc_name;
@@ -1640,6 +1716,83 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_profiler", platform::DisableProfiler);
   m.def("is_profiler_enabled", platform::IsProfileEnabled);
   m.def("reset_profiler", platform::ResetProfiler);
+
+  py::class_<platform::SampledEventStat>(m, "SampledEventStat")
+      .def_readonly("name", &platform::SampledEventStat::name)
+      .def_readonly("calls", &platform::SampledEventStat::calls)
+      .def_readonly("total_ms", &platform::SampledEventStat::total_ms)
+      .def_readonly("min_ms", &platform::SampledEventStat::min_ms)
+      .def_readonly("max_ms", &platform::SampledEventStat::max_ms)
+      .def_property_readonly("ave_ms", &platform::SampledEventStat::ave_ms);
+  m.def("enable_sampling_profiler",
+        [](int64_t step_interval, double op_sample_rate, size_t buffer_size,
+           int64_t report_interval, const std::string &report_path,
+           py::object callback) {
+          platform::SamplingProfilerOptions options;
+          options.step_interval = step_interval;
+          options.op_sample_rate = op_sample_rate;
+          options.buffer_size = buffer_size;
+          options.report_interval = report_interval;
+          options.report_path = report_path;
+          if (!callback.is_none()) {
+            // The callback is called in SamplingProfilerStep or
+            // DisableSamplingProfiler, which are called from Python.
+            options.callback = [callback](
+                int64_t step,
+                const std::vector<platform::SampledEventStat> &stats) {
+              py::gil_scoped_acquire guard;
+              callback(step, stats);
+            };
+          }
+          platform::EnableSamplingProfiler(options);
+        },
+        py::arg("step_interval"), py::arg("op_sample_rate"),
+        py::arg("buffer_size"), py::arg("report_interval"),
+        py::arg("report_path"), py::arg("callback"));
+  m.def("disable_sampling_profiler", platform::DisableSamplingProfiler);
+  m.def("is_sampling_profiler_enabled", platform::IsSamplingProfilerEnabled);
+  m.def("sampling_profiler_step", platform::SamplingProfilerStep);
+  m.def("get_sampled_event_stats", platform::GetSampledEventStats);
+  m.def("sampled_event_dropped_num", platform::SampledEventDroppedNum);
+  m.def("get_event_average_time_ms", platform::GetEventAverageTimeMs);
+  m.def("get_allocator_stats", [](const platform::CPUPlace &place) {
+    return GetAllocatorStats(place);
+  });
+  m.def("get_allocator_stats", [](const platform::CUDAPlace &place) {
+    return GetAllocatorStats(place);
+  });
+  m.def("get_allocator_stats", [](const platform::CUDAPinnedPlace &place) {
+    return GetAllocatorStats(place);
+  });
+  m.def("enable_memory_profiler",
+        [] { platform::MemoryProfiler::Instance().Enable(); });
+  m.def("disable_memory_profiler",
+        [] { platform::MemoryProfiler::Instance().Disable(); });
+  m.def("get_memory_peaks", GetMemoryPeaks, py::arg("top_n") = 10);
+  m.def("memory_profiler_report",
+        [](size_t top_n) {
+          return platform::MemoryProfiler::Instance().Report(top_n);
+        },
+        py::arg("top_n") = 10);
+  m.def("export_memory_timeline", [](const std::string &path) {
+    platform::MemoryProfiler::Instance().ExportTimeline(path);
+  });
+  m.def("wait_async_checkpoints",
+        [] { framework::AsyncCheckpointWriter::Instance().Wait(); },
+        py::call_guard<py::gil_scoped_release>());
+  m.def("num_pending_async_checkpoints", [] {
+    return framework::AsyncCheckpointWriter::Instance().NumPending();
+  });
+  m.def("reset_allocator_peak_stats", [](const platform::CPUPlace &place) {
+    memory::allocation::AllocatorFacade::Instance().ResetPeakStats(place);
+  });
+  m.def("reset_allocator_peak_stats", [](const platform::CUDAPlace &place) {
+    memory::allocation::AllocatorFacade::Instance().ResetPeakStats(place);
+  });
+  m.def("reset_allocator_peak_stats",
+        [](const platform::CUDAPinnedPlace &place) {
+          memory::allocation::AllocatorFacade::Instance().ResetPeakStats(place);
+        });
   m.def("get_pass", [](const std::string &pass_type) {
     auto pass = framework::ir::PassRegistry::Instance().Get(pass_type);
     return std::shared_ptr<framework::ir::Pass>(std::move(pass));
@@ -1805,6 +1958,27 @@ All parameter, weight, gradient are variables in Paddle.
           },
           R"DOC(This config that the this is distributed training with parameter server
               )DOC")
+      .def_property(
+          "use_work_stealing",
+          [](const ExecutionStrategy &self) { return self.use_work_stealing_; },
+          [](ExecutionStrategy &self, bool use_work_stealing) {
+            self.use_work_stealing_ = use_work_stealing;
+          },
+          R"DOC(The type is BOOL, whether each thread of the experimental
+                executor runs the ready operators from its own queue, and
+                steals the operators of the other threads when it is idle,
+                rather than all the threads sharing one queue. It helps the
+                programs with many small operators running on CPU. The
+                utilization of the threads is logged with GLOG_v=3.
+                Default False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        exec_strategy = fluid.ExecutionStrategy()
+                        exec_strategy.use_work_stealing = True
+              )DOC")
       .def_property("_dry_run",
                     [](const ExecutionStrategy &self) { return self.dry_run_; },
                     [](ExecutionStrategy &self, bool dry_run) {
@@ -2090,6 +2264,79 @@ All parameter, weight, gradient are variables in Paddle.
                         build_strategy = fluid.BuildStrategy()
                         build_strategy.fuse_bn_act_ops = True
                      )DOC")
+      .def_property(
+          "fuse_attention_ops",
+          [](const BuildStrategy &self) { return self.fuse_attention_ops_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finlaized."));
+            self.fuse_attention_ops_ = b;
+          },
+          R"DOC((bool, optional): fuse_attention_ops indicate whether
+                to fuse matmul, softmax, dropout and matmul of the attention
+                into fused_attention, and their gradients, which computes
+                the attention without storing the attention scores.
+                It may save the memory and make the execution faster.
+                Default is False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.fuse_attention_ops = True
+                     )DOC")
+      .def_property(
+          "fuse_dropout_residual_layer_norm_ops",
+          [](const BuildStrategy &self) {
+            return self.fuse_dropout_residual_layer_norm_ops_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finlaized."));
+            self.fuse_dropout_residual_layer_norm_ops_ = b;
+          },
+          R"DOC((bool, optional): fuse_dropout_residual_layer_norm_ops
+                indicate whether to fuse dropout, elementwise_add and
+                layer_norm of the residual blocks into
+                fused_dropout_residual_layer_norm, and their gradients,
+                which keeps the dropout mask by bits and does not store
+                the output of the dropout. It may save the memory and make
+                the execution faster. Default is False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.fuse_dropout_residual_layer_norm_ops = True
+                     )DOC")
+      .def_property(
+          "fuse_fake_quant_dequant_ops",
+          [](const BuildStrategy &self) {
+            return self.fuse_fake_quant_dequant_ops_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finlaized."));
+            self.fuse_fake_quant_dequant_ops_ = b;
+          },
+          R"DOC((bool, optional): fuse_fake_quant_dequant_ops indicate
+                whether to fuse the fake quantization ops and the fake
+                dequantization ops reading their outputs into the fake
+                quantize-dequantize ops of the quantization aware training,
+                which do not store the quantized tensors. Default is False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.fuse_fake_quant_dequant_ops = True
+                     )DOC")
       .def_property(
           "enable_auto_fusion",
           [](const BuildStrategy &self) { return self.enable_auto_fusion_; },
@@ -2102,7 +2349,9 @@ All parameter, weight, gradient are variables in Paddle.
           R"DOC((bool, optional): Whether to enable fusing subgraph to a
                 fusion_group. Now we only support fusing subgraph that composed
                 of elementwise-like operators, such as elementwise_add/mul
-                without broadcast and activations.
+                with the bias broadcast and activations. On GPU, the
+                elementwise operators followed by reduce_sum/mean along the
+                trailing dims are fused too.
 
                 Examples:
                     .. code-block:: python
@@ -2111,6 +2360,30 @@ All parameter, weight, gradient are variables in Paddle.
                         build_strategy = fluid.BuildStrategy()
                         build_strategy.enable_auto_fusion = True
                     )DOC")
+      .def_property(
+          "enable_nhwc_layout",
+          [](const BuildStrategy &self) { return self.enable_nhwc_layout_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finlaized."));
+            self.enable_nhwc_layout_ = b;
+          },
+          R"DOC((bool, optional): Whether to run the regions of conv2d,
+                pool2d, batch_norm and the layout agnostic operators between
+                them in NHWC, which makes the convolutions faster on the GPUs
+                with the tensor cores, e.g. in float16. The transposes are
+                only inserted at the boundaries of the regions. Only the
+                forward operators are converted, so it is mainly for the
+                inference programs. It only works on GPU. Default is False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.enable_nhwc_layout = True
+                    )DOC")
       .def_property(
           "fuse_relu_depthwise_conv",
           [](const BuildStrategy &self) {
@@ -2244,6 +2517,31 @@ All parameter, weight, gradient are variables in Paddle.
                    self.fuse_all_reduce_ops_ == boost::none;
           },
           [](BuildStrategy &self, bool b) { self.fuse_all_reduce_ops_ = b; })
+      .def_property(
+          "fuse_grad_bucket_size_mb",
+          [](const BuildStrategy &self) {
+            return self.fuse_grad_bucket_size_mb_;
+          },
+          [](BuildStrategy &self, double size_mb) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.fuse_grad_bucket_size_mb_ = size_mb;
+          },
+          R"DOC((float, optional): if positive, fuse_all_reduce_ops groups
+                the gradients into the buckets of at most so many MB in the
+                order they are produced by the backward, rather than by the
+                layers, so that the all_reduce of each bucket starts as soon
+                as its gradients are ready. Default -1, which disables it.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.fuse_all_reduce_ops = True
+                        build_strategy.fuse_grad_bucket_size_mb = 25
+                     )DOC")
       .def_property("enable_backward_optimizer_op_deps",
                     [](const BuildStrategy &self) {
                       return self.enable_backward_optimizer_op_deps_;
@@ -2251,6 +2549,195 @@ All parameter, weight, gradient are variables in Paddle.
                     [](BuildStrategy &self, bool b) {
                       self.enable_backward_optimizer_op_deps_ = b;
                     })
+      .def_property(
+          "enable_critical_path_priority",
+          [](const BuildStrategy &self) {
+            return self.enable_critical_path_priority_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.enable_critical_path_priority_ = b;
+          },
+          R"DOC((bool, optional): enable_critical_path_priority indicates
+                whether the executor runs the ready operators with the
+                longest path to the end of the graph first, e.g. starts
+                all_reduce early, rather than in the order they get ready.
+                Default False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.enable_critical_path_priority = True
+                     )DOC")
+      .def_property(
+          "op_costs",
+          [](const BuildStrategy &self) { return self.op_costs_; },
+          [](BuildStrategy &self,
+             const std::unordered_map<std::string, double> &op_costs) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.op_costs_ = op_costs;
+          },
+          R"DOC((dict, optional): the costs of the operators by their types,
+                which are used to compute the critical paths when
+                enable_critical_path_priority is True. The operators
+                missing in it are estimated. The average time of the
+                operators in a profiling run can be got by
+                fluid.core.get_event_average_time_ms() before the profiler
+                is stopped. Default empty.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.enable_critical_path_priority = True
+                        build_strategy.op_costs = {'conv2d': 2.0, 'relu': 0.1}
+                     )DOC")
+      .def_property(
+          "enable_memory_aware_reorder",
+          [](const BuildStrategy &self) {
+            return self.enable_memory_aware_reorder_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.enable_memory_aware_reorder_ = b;
+          },
+          R"DOC((bool, optional): enable_memory_aware_reorder indicates
+                whether to reorder the operators of each device to reduce
+                the peak memory of the temporary variables before the
+                memory reuse, e.g. run the consumers of a large variable
+                right after its producer. The operators of a device then
+                run one by one. Default False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.enable_memory_aware_reorder = True
+                     )DOC")
+      .def_property(
+          "sparsify_grad",
+          [](const BuildStrategy &self) { return self.sparsify_grad_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.sparsify_grad_ = b;
+          },
+          R"DOC((bool, optional): sparsify_grad indicates whether to send
+                only the top-k values of the large dense gradients in the
+                AllReduce mode of the multi-node training. The values
+                unsent are accumulated locally and added to the next
+                gradients. Unlike DGCMomentumOptimizer, it works with any
+                optimizer. It requires Paddle compiled with DGC, and
+                fuse_all_reduce_ops is disabled. Default False.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.sparsify_grad = True
+                        build_strategy.grad_sparsity = [0.75, 0.9375, 0.999]
+                        build_strategy.grad_sparsify_rampup_begin_step = 1000
+                        build_strategy.grad_sparsify_rampup_step = 3000
+                     )DOC")
+      .def_property(
+          "grad_sparsity",
+          [](const BuildStrategy &self) { return self.grad_sparsity_; },
+          [](BuildStrategy &self, const std::vector<float> &sparsity) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.grad_sparsity_ = sparsity;
+          },
+          R"DOC((list(float), optional): the sparsity of the gradients
+                when sparsify_grad is True, which ramps up by the list
+                during grad_sparsify_rampup_step steps and then keeps the
+                last one. Default [0.999].)DOC")
+      .def_property(
+          "grad_sparsify_rampup_begin_step",
+          [](const BuildStrategy &self) {
+            return self.grad_sparsify_rampup_begin_step_;
+          },
+          [](BuildStrategy &self, int64_t step) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.grad_sparsify_rampup_begin_step_ = step;
+          },
+          R"DOC((int, optional): the step to begin sparsifying the
+                gradients, before which the gradients are all reduced
+                densely. Default 0.)DOC")
+      .def_property(
+          "grad_sparsify_rampup_step",
+          [](const BuildStrategy &self) {
+            return self.grad_sparsify_rampup_step_;
+          },
+          [](BuildStrategy &self, int64_t step) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.grad_sparsify_rampup_step_ = step;
+          },
+          R"DOC((int, optional): the number of the steps to ramp up the
+                sparsity by grad_sparsity. Default 1.)DOC")
+      .def_property(
+          "grad_sparsify_min_numel",
+          [](const BuildStrategy &self) {
+            return self.grad_sparsify_min_numel_;
+          },
+          [](BuildStrategy &self, int64_t numel) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            self.grad_sparsify_min_numel_ = numel;
+          },
+          R"DOC((int, optional): only the gradients with at least so many
+                elements are sparsified, and the smaller ones are all
+                reduced densely. Default 16384.)DOC")
+      .def_property(
+          "gradient_accumulate_steps",
+          [](const BuildStrategy &self) {
+            return self.gradient_accumulate_steps_;
+          },
+          [](BuildStrategy &self, int steps) {
+            PADDLE_ENFORCE_EQ(!self.IsFinalized(), true,
+                              platform::errors::PreconditionNotMet(
+                                  "BuildStrategy is finalized."));
+            PADDLE_ENFORCE_GE(steps, 1,
+                              platform::errors::InvalidArgument(
+                                  "The gradient_accumulate_steps should be "
+                                  "at least 1, but received %d.",
+                                  steps));
+            self.gradient_accumulate_steps_ = steps;
+          },
+          R"DOC((int, optional): if greater than 1, the gradients of so many
+                steps are accumulated and averaged in place, and the
+                parameters are updated once every so many steps, which trains
+                as if the batch is so many times larger, without copying the
+                graph like multi_batch_merge_pass. The optimize and the
+                collective ops are only run on the last step of each
+                accumulation, and the learning rate is scheduled by the
+                updates. It doesn't work with fuse_all_optimizer_ops and
+                fuse_all_reduce_ops. Default 1.
+
+                Examples:
+                    .. code-block:: python
+
+                        import paddle.fluid as fluid
+                        build_strategy = fluid.BuildStrategy()
+                        build_strategy.gradient_accumulate_steps = 4
+                     )DOC")
       .def_property(
           "cache_runtime_context",
           [](const BuildStrategy &self) { return self.cache_runtime_context_; },
@@ -125,7 +125,7 @@ class MultiDeviceFeedReader {
       const std::vector<framework::proto::VarType::Type> &dtypes,
       const std::vector<bool> &need_check_feed,
       const std::vector<platform::Place> &dst_places, bool use_double_buffer,
-      bool drop_last)
+      bool drop_last, size_t max_prefetch_depth)
       : queue_(queue),
         names_(names),
         pool_(new ::ThreadPool(dst_places.size())),
@@ -157,7 +157,7 @@ class MultiDeviceFeedReader {
         VLOG(10) << "Creating " << i << "-th BufferedReader";
         holder->Reset(
             framework::MakeDecoratedReader<operators::reader::BufferedReader>(
-                reader, p, 2));
+                reader, p, 2, max_prefetch_depth));
       } else {
         if (platform::is_gpu_place(p)) {
           PADDLE_THROW(
@@ -360,22 +360,25 @@ void BindReader(py::module *module) {
   });
 
   m.def("init_lod_tensor_blocking_queue",
-        [](framework::Variable &var, size_t capacity,
-           bool is_ordered) -> py::object {
+        [](framework::Variable &var, size_t capacity, bool is_ordered,
+           bool use_ring_queue) -> py::object {
           VLOG(1) << "init_lod_tensor_blocking_queue";
           if (is_ordered) {
             auto *holder = var.GetMutable<
                 reader::OrderedMultiDeviceLoDTensorBlockingQueueHolder>();
-            holder->InitOnce(capacity, FLAGS_reader_queue_speed_test_mode);
+            holder->InitOnce(capacity, FLAGS_reader_queue_speed_test_mode,
+                             use_ring_queue);
             return py::cast(holder->GetQueue());
           } else {
             auto *holder =
                 var.GetMutable<reader::LoDTensorBlockingQueueHolder>();
-            holder->InitOnce(capacity, FLAGS_reader_queue_speed_test_mode);
+            holder->InitOnce(capacity, FLAGS_reader_queue_speed_test_mode,
+                             use_ring_queue);
             return py::cast(holder->GetQueue());
           }
         },
-        py::return_value_policy::copy);
+        py::arg("var"), py::arg("capacity"), py::arg("is_ordered"),
+        py::arg("use_ring_queue") = false, py::return_value_policy::copy);
 
   py::class_<framework::ReaderHolder>(m, "Reader", "")
       .def("start", &framework::ReaderHolder::Start)
@@ -427,11 +430,15 @@ void BindReader(py::module *module) {
            const std::vector<framework::proto::VarType::Type> &dtypes,
            const std::vector<bool> &need_check_feed,
            const std::vector<platform::Place> &dst_places,
-           bool use_double_buffer, bool drop_last) {
+           bool use_double_buffer, bool drop_last, size_t max_prefetch_depth) {
           return new MultiDeviceFeedReader<reader::LoDTensorBlockingQueue>(
               queue, names, shapes, dtypes, need_check_feed, dst_places,
-              use_double_buffer, drop_last);
+              use_double_buffer, drop_last, max_prefetch_depth);
         },
+        py::arg("queue"), py::arg("names"), py::arg("shapes"),
+        py::arg("dtypes"), py::arg("need_check_feed"), py::arg("dst_places"),
+        py::arg("use_double_buffer"), py::arg("drop_last"),
+        py::arg("max_prefetch_depth") = 2,
         py::return_value_policy::take_ownership);
 
   m.def(
@@ -443,13 +450,17 @@ void BindReader(py::module *module) {
          const std::vector<framework::proto::VarType::Type> &dtypes,
          const std::vector<bool> &need_check_feed,
          const std::vector<platform::Place> &dst_places, bool use_double_buffer,
-         bool drop_last) {
+         bool drop_last, size_t max_prefetch_depth) {
         queue->SetDeviceCount(dst_places.size());
         return new MultiDeviceFeedReader<
             reader::OrderedMultiDeviceLoDTensorBlockingQueue>(
             queue, names, shapes, dtypes, need_check_feed, dst_places,
-            use_double_buffer, drop_last);
+            use_double_buffer, drop_last, max_prefetch_depth);
       },
+      py::arg("queue"), py::arg("names"), py::arg("shapes"), py::arg("dtypes"),
+      py::arg("need_check_feed"), py::arg("dst_places"),
+      py::arg("use_double_buffer"), py::arg("drop_last"),
+      py::arg("max_prefetch_depth") = 2,
       py::return_value_policy::take_ownership);
 }
 
@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/math/concat_and_split.h"
 #include "paddle/fluid/operators/strided_memcpy.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/float16.h"
 #include "pybind11/numpy.h"
@@ -57,6 +58,23 @@ struct npy_format_descriptor<paddle::platform::float16> {
   static PYBIND11_DESCR name() { return _("float16"); }
 };
 
+// Note: numpy has no bfloat16, so that paddle::platform::bfloat16 is
+// exposed as numpy.uint16 holding the raw bits.
+constexpr int NPY_UINT16_ = 4;
+
+template <>
+struct npy_format_descriptor<paddle::platform::bfloat16> {
+  static py::dtype dtype() {
+    handle ptr = npy_api::get().PyArray_DescrFromType_(NPY_UINT16_);
+    return reinterpret_borrow<py::dtype>(ptr);
+  }
+  static std::string format() {
+    // Note: "H" represents uint16.
+    return "H";
+  }
+  static PYBIND11_DESCR name() { return _("bfloat16"); }
+};
+
 }  // namespace detail
 }  // namespace pybind11
 
@@ -102,6 +120,7 @@ struct ValidDTypeToPyArrayChecker {
   }
 
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(platform::float16);
+DECLARE_VALID_DTYPE_TO_PY_ARRAY(platform::bfloat16);
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(float);
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(double);
 DECLARE_VALID_DTYPE_TO_PY_ARRAY(bool);
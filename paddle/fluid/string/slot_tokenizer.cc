@@ -0,0 +1,238 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/string/slot_tokenizer.h"
+
+#include <stdlib.h>
+
+#ifdef PADDLE_SLOT_TOKENIZER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace paddle {
+namespace string {
+namespace detail {
+
+namespace {
+
+// uint64 values of up to 19 digits never overflow
+constexpr int kMaxFastDigits = 19;
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+const char* ParseWithStrtoull(const char* str, int n, uint64_t* out) {
+  char* endptr = const_cast<char*>(str);
+  for (int i = 0; i < n; ++i) {
+    out[i] = static_cast<uint64_t>(strtoull(endptr, &endptr, 10));
+  }
+  return endptr;
+}
+
+}  // namespace
+
+const char* ParseUint64sScalar(const char* str, const char* end, int n,
+                               uint64_t* out) {
+  const char* p = str;
+  for (int i = 0; i < n; ++i) {
+    const char* q = p;
+    while (q < end && *q == ' ') {
+      ++q;
+    }
+    const char* digits = q;
+    uint64_t value = 0;
+    while (q < end && IsDigit(*q) && q - digits < kMaxFastDigits) {
+      value = value * 10 + (*q - '0');
+      ++q;
+    }
+    if (q == digits || (q < end && IsDigit(*q))) {
+      // not a plain number of at most 19 digits, e.g. a sign, other
+      // whitespace or overflow, let strtoull handle the rest
+      return ParseWithStrtoull(p, n - i, out + i);
+    }
+    out[i] = value;
+    p = q;
+  }
+  return p;
+}
+
+const char* SkipTokensScalar(const char* str, const char* end, int n) {
+  const char* p = str;
+  for (int i = 0; i < n; ++i) {
+    while (p < end && *p == ' ') {
+      ++p;
+    }
+    while (p < end && *p != ' ') {
+      ++p;
+    }
+  }
+  return p;
+}
+
+#ifdef PADDLE_SLOT_TOKENIZER_AVX2
+
+namespace {
+
+struct DigitShuffleTable {
+  // table[len] moves len digits to the end of a 16 bytes vector, and fills
+  // the bytes before them with zero
+  alignas(16) char table[17][16];
+  DigitShuffleTable() {
+    for (int len = 0; len <= 16; ++len) {
+      for (int i = 0; i < 16; ++i) {
+        int src = i - (16 - len);
+        table[len][i] = src >= 0 ? static_cast<char>(src) : '\x80';
+      }
+    }
+  }
+};
+
+const DigitShuffleTable& GetDigitShuffleTable() {
+  static DigitShuffleTable table;
+  return table;
+}
+
+// convert 16 digits (0 - 9 values, most significant first) to an integer
+__attribute__((target("avx2"))) inline uint64_t Digits16ToUint64(
+    __m128i digits) {
+  const __m128i mul_10 =
+      _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+  const __m128i mul_100 = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
+  const __m128i mul_10000 =
+      _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
+  // 8 values of 2 digits, 4 values of 4 digits, then 2 values of 8 digits
+  __m128i v = _mm_maddubs_epi16(digits, mul_10);
+  v = _mm_madd_epi16(v, mul_100);
+  v = _mm_packus_epi32(v, v);
+  v = _mm_madd_epi16(v, mul_10000);
+  uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+  uint64_t low = static_cast<uint32_t>(_mm_extract_epi32(v, 1));
+  return high * 100000000ULL + low;
+}
+
+// q points to len (1 - 19) digits, and 16 bytes from q are readable
+__attribute__((target("avx2"))) inline uint64_t DigitsToUint64(const char* q,
+                                                               int len) {
+  const __m128i zero_char = _mm_set1_epi8('0');
+  if (len <= 16) {
+    __m128i chunk =
+        _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(q)),
+                     zero_char);
+    __m128i shuffle = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(GetDigitShuffleTable().table[len]));
+    return Digits16ToUint64(_mm_shuffle_epi8(chunk, shuffle));
+  }
+  uint64_t head = 0;
+  for (int i = 0; i < len - 16; ++i) {
+    head = head * 10 + (q[i] - '0');
+  }
+  __m128i chunk = _mm_sub_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + len - 16)),
+      zero_char);
+  return head * 10000000000000000ULL + Digits16ToUint64(chunk);
+}
+
+}  // namespace
+
+__attribute__((target("avx2"))) const char* ParseUint64sAVX2(
+    const char* str, const char* end, int n, uint64_t* out) {
+  const __m256i zero_char = _mm256_set1_epi8('0');
+  const __m256i ten = _mm256_set1_epi8(10);
+  const __m256i minus_one = _mm256_set1_epi8(-1);
+  const char* p = str;
+  for (int i = 0; i < n; ++i) {
+    const char* q = p;
+    while (q < end && *q == ' ') {
+      ++q;
+    }
+    if (end - q < 32) {
+      return ParseUint64sScalar(p, end, n - i, out + i);
+    }
+    // find the length of the digits run starting at q
+    __m256i d = _mm256_sub_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q)), zero_char);
+    __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(d, minus_one),
+                                        _mm256_cmpgt_epi8(ten, d));
+    uint32_t not_digit = ~static_cast<uint32_t>(_mm256_movemask_epi8(is_digit));
+    int len = not_digit == 0 ? 32 : __builtin_ctz(not_digit);
+    if (len == 0 || len > kMaxFastDigits) {
+      return ParseUint64sScalar(p, end, n - i, out + i);
+    }
+    out[i] = DigitsToUint64(q, len);
+    p = q + len;
+  }
+  return p;
+}
+
+__attribute__((target("avx2"))) const char* SkipTokensAVX2(const char* str,
+                                                           const char* end,
+                                                           int n) {
+  const __m256i space = _mm256_set1_epi8(' ');
+  const char* p = str;
+  int remaining = n;
+  // p[32] is read to see if the last byte of a block ends a token
+  while (remaining > 0 && end - p > 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    uint32_t token =
+        ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            chunk, space)));
+    uint32_t next = (token >> 1) | (p[32] != ' ' ? 1u << 31 : 0u);
+    uint32_t token_end = token & ~next;
+    int count = __builtin_popcount(token_end);
+    if (count < remaining) {
+      remaining -= count;
+      p += 32;
+      continue;
+    }
+    for (int i = 1; i < remaining; ++i) {
+      token_end &= token_end - 1;
+    }
+    return p + __builtin_ctz(token_end) + 1;
+  }
+  return SkipTokensScalar(p, end, remaining);
+}
+
+#endif  // PADDLE_SLOT_TOKENIZER_AVX2
+
+}  // namespace detail
+
+bool SlotTokenizerUseAVX2() {
+#ifdef PADDLE_SLOT_TOKENIZER_AVX2
+  static bool use_avx2 = __builtin_cpu_supports("avx2");
+  return use_avx2;
+#else
+  return false;
+#endif
+}
+
+const char* ParseUint64s(const char* str, const char* end, int n,
+                         uint64_t* out) {
+#ifdef PADDLE_SLOT_TOKENIZER_AVX2
+  if (SlotTokenizerUseAVX2()) {
+    return detail::ParseUint64sAVX2(str, end, n, out);
+  }
+#endif
+  return detail::ParseUint64sScalar(str, end, n, out);
+}
+
+const char* SkipTokens(const char* str, const char* end, int n) {
+#ifdef PADDLE_SLOT_TOKENIZER_AVX2
+  if (SlotTokenizerUseAVX2()) {
+    return detail::SkipTokensAVX2(str, end, n);
+  }
+#endif
+  return detail::SkipTokensScalar(str, end, n);
+}
+
+}  // namespace string
+}  // namespace paddle
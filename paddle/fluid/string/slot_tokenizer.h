@@ -0,0 +1,57 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+// Tokenizer for the space separated lines of the MultiSlot text format:
+//   [num feasign_0 feasign_1 ... feasign_num]*
+// The AVX2 kernels are picked at runtime if the CPU supports them, otherwise
+// the scalar ones are used. Both give the same results.
+//
+// A line is given as [str, end), and must be terminated by '\0' at end or
+// later, like the buffers of std::string and LineFileReader.
+
+namespace paddle {
+namespace string {
+
+// Parse n unsigned decimal integers starting from str into out, returns the
+// position after the last parsed one. Each value is the same as the one
+// strtoull(str, &endptr, 10) gives, malformed input is handed to strtoull.
+const char* ParseUint64s(const char* str, const char* end, int n,
+                         uint64_t* out);
+
+// Skip n tokens separated by spaces starting from str, returns the position
+// after the last skipped token.
+const char* SkipTokens(const char* str, const char* end, int n);
+
+// If the AVX2 kernels are used
+bool SlotTokenizerUseAVX2();
+
+namespace detail {
+// the kernels behind the functions above, exposed for tests
+const char* ParseUint64sScalar(const char* str, const char* end, int n,
+                               uint64_t* out);
+const char* SkipTokensScalar(const char* str, const char* end, int n);
+#if defined(__GNUC__) && defined(__x86_64__)
+#define PADDLE_SLOT_TOKENIZER_AVX2
+const char* ParseUint64sAVX2(const char* str, const char* end, int n,
+                             uint64_t* out);
+const char* SkipTokensAVX2(const char* str, const char* end, int n);
+#endif
+}  // namespace detail
+
+}  // namespace string
+}  // namespace paddle
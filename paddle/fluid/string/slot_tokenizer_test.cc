@@ -0,0 +1,132 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/string/slot_tokenizer.h"
+
+#include <stdlib.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+typedef const char* (*ParseFunc)(const char*, const char*, int, uint64_t*);
+typedef const char* (*SkipFunc)(const char*, const char*, int);
+
+std::vector<ParseFunc> ParseFuncs() {
+  std::vector<ParseFunc> funcs{paddle::string::detail::ParseUint64sScalar};
+#ifdef PADDLE_SLOT_TOKENIZER_AVX2
+  if (paddle::string::SlotTokenizerUseAVX2()) {
+    funcs.push_back(paddle::string::detail::ParseUint64sAVX2);
+  }
+#endif
+  return funcs;
+}
+
+std::vector<SkipFunc> SkipFuncs() {
+  std::vector<SkipFunc> funcs{paddle::string::detail::SkipTokensScalar};
+#ifdef PADDLE_SLOT_TOKENIZER_AVX2
+  if (paddle::string::SlotTokenizerUseAVX2()) {
+    funcs.push_back(paddle::string::detail::SkipTokensAVX2);
+  }
+#endif
+  return funcs;
+}
+
+// parse the whole line like the data feeds did before
+void ParseWithStrtoull(const std::string& line, int n,
+                       std::vector<uint64_t>* values, size_t* end_pos) {
+  char* endptr = const_cast<char*>(line.c_str());
+  values->resize(n);
+  for (int i = 0; i < n; ++i) {
+    (*values)[i] = strtoull(endptr, &endptr, 10);
+  }
+  *end_pos = endptr - line.c_str();
+}
+
+void CheckParse(const std::string& line, int n) {
+  std::vector<uint64_t> expected;
+  size_t expected_end = 0;
+  ParseWithStrtoull(line, n, &expected, &expected_end);
+  for (auto func : ParseFuncs()) {
+    std::vector<uint64_t> values(n);
+    const char* end =
+        func(line.c_str(), line.c_str() + line.size(), n, values.data());
+    EXPECT_EQ(static_cast<size_t>(end - line.c_str()), expected_end) << line;
+    EXPECT_EQ(values, expected) << line;
+  }
+}
+
+}  // namespace
+
+TEST(SlotTokenizer, ParseUint64s) {
+  std::mt19937_64 engine(0);
+  for (int round = 0; round < 200; ++round) {
+    std::string line;
+    int n = round % 50 + 1;
+    for (int i = 0; i < n; ++i) {
+      // mix short ids, hashed ids of all lengths and the max uint64
+      uint64_t value = engine();
+      if (i % 3 == 0) {
+        value %= 1000;
+      } else if (i % 3 == 1) {
+        value >>= engine() % 64;
+      }
+      if (i % 17 == 16) {
+        value = 18446744073709551615ULL;
+      }
+      line += std::to_string(value) + " ";
+    }
+    line += "1 0.5";
+    CheckParse(line, n);
+    CheckParse(line, n + 1);
+  }
+}
+
+TEST(SlotTokenizer, ParseUint64sMalformed) {
+  CheckParse("1 2 3", 3);
+  CheckParse("  12   345 6789", 3);
+  CheckParse("12\t34 56", 3);
+  CheckParse("-1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17", 17);
+  CheckParse("18446744073709551616 1 2 3 4 5 6 7 8 9 10 11 12 13 14", 15);
+  CheckParse("123456789012345678901234567890 1 2 3 4 5 6 7 8 9", 10);
+  CheckParse("1 2 3", 5);
+  CheckParse("", 2);
+  CheckParse("00000000000000000000000000000000000000000001 7", 2);
+}
+
+TEST(SlotTokenizer, SkipTokens) {
+  std::mt19937 engine(0);
+  for (int round = 0; round < 200; ++round) {
+    std::string line;
+    std::vector<size_t> token_ends;
+    int n = round % 40 + 1;
+    for (int i = 0; i < n; ++i) {
+      line += std::string(engine() % 3 + 1, ' ');
+      line += std::string(engine() % 40 + 1, 'a' + i % 26);
+      token_ends.push_back(line.size());
+    }
+    line += " ";
+    for (auto func : SkipFuncs()) {
+      for (int skip = 0; skip <= n + 1; ++skip) {
+        const char* end = func(line.c_str(), line.c_str() + line.size(), skip);
+        size_t expected =
+            skip == 0 ? 0 : (skip <= n ? token_ends[skip - 1] : line.size());
+        EXPECT_EQ(static_cast<size_t>(end - line.c_str()), expected);
+      }
+    }
+  }
+}
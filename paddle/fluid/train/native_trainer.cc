@@ -0,0 +1,315 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/train/native_trainer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <numeric>
+#include <utility>
+
+#include "paddle/fluid/framework/channel.h"
+#include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/dataset_factory.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/inference/io.h"
+
+namespace paddle {
+namespace train {
+
+using framework::LoDTensor;
+using Batch = std::unordered_map<std::string, LoDTensor>;
+
+static std::unique_ptr<framework::ProgramDesc> LoadProgramDesc(
+    const std::string& filename) {
+  std::ifstream fin(filename, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin), true,
+      platform::errors::NotFound("Cannot open the program file %s.", filename));
+  std::string contents((std::istreambuf_iterator<char>(fin)),
+                       std::istreambuf_iterator<char>());
+  return std::unique_ptr<framework::ProgramDesc>(
+      new framework::ProgramDesc(contents));
+}
+
+static bool IsPersistable(const framework::VarDesc* var) {
+  return var->Persistable() &&
+         var->GetType() != framework::proto::VarType::FEED_MINIBATCH &&
+         var->GetType() != framework::proto::VarType::FETCH_LIST &&
+         var->GetType() != framework::proto::VarType::RAW;
+}
+
+NativeTrainer::NativeTrainer(const NativeTrainerConfig& config)
+    : config_(config), executor_(config.places.at(0)) {
+  PADDLE_ENFORCE_EQ(
+      config_.loss_name.empty(), false,
+      platform::errors::InvalidArgument("The loss_name should be set."));
+  if (!config_.params_file.empty()) {
+    main_program_ = inference::Load(&executor_, &scope_,
+                                    config_.main_program_file,
+                                    config_.params_file);
+  } else {
+    PADDLE_ENFORCE_EQ(config_.startup_program_file.empty(), false,
+                      platform::errors::InvalidArgument(
+                          "Either the startup_program_file or the "
+                          "params_file should be set."));
+    main_program_ = LoadProgramDesc(config_.main_program_file);
+    auto startup_program = LoadProgramDesc(config_.startup_program_file);
+    executor_.Run(*startup_program, &scope_, 0);
+  }
+
+  for (auto* var : main_program_->Block(0).AllVars()) {
+    if (IsPersistable(var)) {
+      persistable_names_.push_back(var->Name());
+    }
+  }
+  // the parameters are broadcast in the same order by all the trainers
+  std::sort(persistable_names_.begin(), persistable_names_.end());
+
+  if (config_.strategy == TrainStrategy::kParallelExecutor) {
+    CreateParallelExecutor();
+  }
+}
+
+NativeTrainer::~NativeTrainer() {
+  if (checkpoint_.valid()) {
+    checkpoint_.wait();
+  }
+}
+
+void NativeTrainer::CreateParallelExecutor() {
+  auto exec_strategy = config_.exec_strategy;
+  exec_strategy.use_cuda_ = platform::is_gpu_place(config_.places[0]);
+  if (exec_strategy.num_threads_ == 0) {
+    exec_strategy.num_threads_ =
+        config_.places.size() * (exec_strategy.use_cuda_ ? 4 : 2);
+  }
+  graph_.reset(new framework::ir::Graph(*main_program_));
+  parallel_executor_.reset(new framework::ParallelExecutor(
+      config_.places, persistable_names_, config_.loss_name, &scope_, {},
+      exec_strategy, config_.build_strategy, graph_.get()));
+}
+
+void NativeTrainer::PrepareThreads(size_t num) {
+  while (thread_scopes_.size() < num) {
+    auto* scope = &scope_.NewScope();
+    executor_.CreateVariables(*main_program_, scope, 0);
+    thread_scopes_.push_back(scope);
+    // the loss is kept from the eager deletion to be read after a run
+    prepared_.emplace_back(
+        framework::Executor::Prepare(*main_program_, 0, {config_.loss_name}));
+  }
+}
+
+void NativeTrainer::SetDataset(const std::string& data_feed_desc_str,
+                               const std::vector<std::string>& filelist,
+                               int thread_num) {
+  PADDLE_ENFORCE_GT(filelist.size(), 0,
+                    platform::errors::InvalidArgument(
+                        "At least one file should be given to train."));
+  dataset_ = framework::DatasetFactory::CreateDataset("MultiSlotDataset");
+  dataset_->SetThreadNum(thread_num);
+  dataset_->SetDataFeedDesc(data_feed_desc_str);
+  filelist_ = filelist;
+}
+
+float NativeTrainer::LossOf(const LoDTensor& loss) const {
+  LoDTensor cpu_loss;
+  const LoDTensor* loss_ptr = &loss;
+  if (!platform::is_cpu_place(loss.place())) {
+    framework::TensorCopySync(loss, platform::CPUPlace(), &cpu_loss);
+    loss_ptr = &cpu_loss;
+  }
+  // the losses of the places are merged by the ParallelExecutor
+  const float* data = loss_ptr->data<float>();
+  int64_t num = loss_ptr->numel();
+  return std::accumulate(data, data + num, 0.0f) / num;
+}
+
+float NativeTrainer::RunEpoch() {
+  PADDLE_ENFORCE_NOT_NULL(dataset_, platform::errors::PreconditionNotMet(
+                                        "SetDataset should be called before "
+                                        "RunEpoch."));
+  dataset_->SetFileList(filelist_);
+  return config_.strategy == TrainStrategy::kExecutor
+             ? RunEpochByExecutor()
+             : RunEpochByParallelExecutor();
+}
+
+float NativeTrainer::RunEpochByExecutor() {
+  dataset_->CreateReaders();
+  auto readers = dataset_->GetReaders();
+  PrepareThreads(readers.size());
+
+  std::vector<std::future<std::pair<double, int64_t>>> losses;
+  for (size_t i = 0; i < readers.size(); ++i) {
+    losses.emplace_back(std::async(std::launch::async, [this, &readers, i] {
+      auto* reader = readers[i];
+      auto* scope = thread_scopes_[i];
+      reader->SetPlace(config_.places[0]);
+      for (auto& name : reader->GetUseSlotAlias()) {
+        reader->AddFeedVar(scope->Var(name), name);
+      }
+      reader->Start();
+      double loss_sum = 0;
+      int64_t batch_num = 0;
+      while (reader->Next() > 0) {
+        executor_.RunPreparedContext(prepared_[i].get(), scope, false, false);
+        loss_sum += LossOf(scope->FindVar(config_.loss_name)->Get<LoDTensor>());
+        ++batch_num;
+      }
+      return std::make_pair(loss_sum, batch_num);
+    }));
+  }
+
+  double loss_sum = 0;
+  int64_t batch_num = 0;
+  for (auto& loss : losses) {
+    loss.wait();
+  }
+  dataset_->DestroyReaders();
+  for (auto& loss : losses) {
+    auto result = loss.get();
+    loss_sum += result.first;
+    batch_num += result.second;
+  }
+  return batch_num > 0 ? loss_sum / batch_num : 0;
+}
+
+float NativeTrainer::RunEpochByParallelExecutor() {
+  dataset_->CreateReaders();
+  auto readers = dataset_->GetReaders();
+  // The readers parse the next batches into the channel while the current
+  // one is run, and the last of them closes the channel.
+  auto batches = framework::MakeChannel<Batch>(config_.prefetch_capacity);
+  std::atomic<size_t> running(readers.size());
+  std::vector<std::future<void>> producers;
+  for (auto* reader : readers) {
+    producers.emplace_back(
+        std::async(std::launch::async, [reader, &batches, &running] {
+          framework::Scope feed_scope;
+          try {
+            reader->SetPlace(platform::CPUPlace());
+            auto& names = reader->GetUseSlotAlias();
+            for (auto& name : names) {
+              reader->AddFeedVar(feed_scope.Var(name), name);
+            }
+            reader->Start();
+            while (reader->Next() > 0) {
+              // the feed variables are overwritten by the next batch
+              Batch batch;
+              for (auto& name : names) {
+                auto& src = feed_scope.FindVar(name)->Get<LoDTensor>();
+                auto& dst = batch[name];
+                framework::TensorCopySync(src, platform::CPUPlace(), &dst);
+                dst.set_lod(src.lod());
+              }
+              if (!batches->Put(std::move(batch))) break;
+            }
+          } catch (...) {
+            if (--running == 0) batches->Close();
+            throw;
+          }
+          if (--running == 0) batches->Close();
+        }));
+  }
+
+  double loss_sum = 0;
+  int64_t batch_num = 0;
+  try {
+    Batch batch;
+    while (batches->Get(batch)) {
+      parallel_executor_->FeedAndSplitTensorIntoLocalScopes(batch);
+      auto fetched = boost::get<framework::FeedFetchList>(
+          parallel_executor_->Run({config_.loss_name}));
+      loss_sum += LossOf(fetched.at(0));
+      ++batch_num;
+    }
+  } catch (...) {
+    // the readers blocked on the full channel quit once it is closed
+    batches->Close();
+    for (auto& producer : producers) {
+      producer.wait();
+    }
+    dataset_->DestroyReaders();
+    throw;
+  }
+  for (auto& producer : producers) {
+    producer.wait();
+  }
+  dataset_->DestroyReaders();
+  for (auto& producer : producers) {
+    producer.get();
+  }
+  return batch_num > 0 ? loss_sum / batch_num : 0;
+}
+
+float NativeTrainer::RunStep(const Batch& feeds) {
+  if (config_.strategy == TrainStrategy::kParallelExecutor) {
+    parallel_executor_->FeedAndSplitTensorIntoLocalScopes(feeds);
+    auto fetched = boost::get<framework::FeedFetchList>(
+        parallel_executor_->Run({config_.loss_name}));
+    return LossOf(fetched.at(0));
+  }
+  PrepareThreads(1);
+  auto* scope = thread_scopes_[0];
+  for (auto& feed : feeds) {
+    auto* tensor = scope->Var(feed.first)->GetMutable<LoDTensor>();
+    if (feed.second.place() == config_.places[0]) {
+      tensor->ShareDataWith(feed.second);
+    } else {
+      framework::TensorCopySync(feed.second, config_.places[0], tensor);
+    }
+    tensor->set_lod(feed.second.lod());
+  }
+  executor_.RunPreparedContext(prepared_[0].get(), scope, false, false);
+  return LossOf(scope->FindVar(config_.loss_name)->Get<LoDTensor>());
+}
+
+void NativeTrainer::SaveCheckpoint(const std::string& dir) {
+  WaitCheckpoint();
+  // The variables are copied before returning, since they are updated by
+  // the next runs, and the copies are written in background.
+  checkpoint_scope_.reset(new framework::Scope);
+  std::vector<std::string> names;
+  for (auto& name : persistable_names_) {
+    auto* var = scope_.FindVar(name);
+    if (var == nullptr || !var->IsType<LoDTensor>() ||
+        !var->Get<LoDTensor>().IsInitialized()) {
+      continue;
+    }
+    auto& src = var->Get<LoDTensor>();
+    auto* dst = checkpoint_scope_->Var(name)->GetMutable<LoDTensor>();
+    framework::TensorCopySync(src, platform::CPUPlace(), dst);
+    dst->set_lod(src.lod());
+    names.push_back(name);
+  }
+  auto* scope = checkpoint_scope_.get();
+  checkpoint_ = std::async(std::launch::async, [scope, dir, names] {
+    inference::SaveVars(*scope, names, dir);
+    VLOG(3) << "save " << names.size() << " variables to " << dir;
+  });
+}
+
+void NativeTrainer::WaitCheckpoint() {
+  if (checkpoint_.valid()) {
+    // rethrows the error of saving
+    checkpoint_.get();
+  }
+}
+
+}  // namespace train
+}  // namespace paddle
@@ -0,0 +1,139 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/data_set.h"
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/parallel_executor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace train {
+
+enum class TrainStrategy {
+  // Each reader of the dataset is run by its own thread, which runs the
+  // program by the Executor in a child scope and updates the parameters of
+  // the root scope without lock, the same as the HogwildWorker.
+  kExecutor = 0,
+  // The batches are read ahead by the threads of the readers, and are split
+  // to the places of the ParallelExecutor, which reduces the gradients.
+  kParallelExecutor = 1,
+};
+
+struct NativeTrainerConfig {
+  std::string main_program_file;
+  // The parameters are either initialized by the startup program, or loaded
+  // from the combined params_file saved by save_combine.
+  std::string startup_program_file;
+  std::string params_file;
+  std::string loss_name;
+
+  TrainStrategy strategy{TrainStrategy::kExecutor};
+  // Only the first place is used by kExecutor.
+  std::vector<platform::Place> places{platform::CPUPlace()};
+  framework::details::ExecutionStrategy exec_strategy;
+  framework::details::BuildStrategy build_strategy;
+  // The number of the batches read ahead of kParallelExecutor.
+  size_t prefetch_capacity{4};
+};
+
+/*
+ * A trainer of the programs saved by Python, without Python at run time,
+ * which runs the epochs of a MultiSlotDataset or the steps of the tensors
+ * fed by the caller:
+ *
+ *   NativeTrainer trainer(config);
+ *   trainer.SetDataset(data_feed_desc_str, filelist, thread_num);
+ *   for (int epoch = 0; epoch < epoch_num; ++epoch) {
+ *     float loss = trainer.RunEpoch();
+ *     trainer.SaveCheckpoint(dir + "/epoch" + std::to_string(epoch));
+ *   }
+ *   trainer.WaitCheckpoint();
+ *
+ * The methods should be called by one thread.
+ */
+class NativeTrainer {
+ public:
+  explicit NativeTrainer(const NativeTrainerConfig& config);
+
+  ~NativeTrainer();
+
+  void SetDataset(const std::string& data_feed_desc_str,
+                  const std::vector<std::string>& filelist, int thread_num);
+
+  // Runs over the dataset once, and returns the average loss of the batches.
+  float RunEpoch();
+
+  // Runs one batch of the feeds, and returns its loss.
+  float RunStep(const std::unordered_map<std::string, framework::LoDTensor>&
+                    feeds);
+
+  // Copies the persistable variables, and saves them to dir/param in
+  // background, so that the training goes on while writing. The previous
+  // checkpoint is waited for first. The training is resumed from it with
+  // params_file set to dir/param.
+  void SaveCheckpoint(const std::string& dir);
+
+  void WaitCheckpoint();
+
+  framework::Scope* scope() { return &scope_; }
+
+  // The dataset set by SetDataset, e.g., to LoadIntoMemory and LocalShuffle
+  // for the in-memory data feeds.
+  framework::Dataset* dataset() { return dataset_.get(); }
+
+  const framework::ProgramDesc& main_program() const { return *main_program_; }
+
+ private:
+  float RunEpochByExecutor();
+
+  float RunEpochByParallelExecutor();
+
+  float LossOf(const framework::LoDTensor& loss) const;
+
+  void CreateParallelExecutor();
+
+  // Creates the scopes and the prepared contexts of num threads for kExecutor.
+  void PrepareThreads(size_t num);
+
+  NativeTrainerConfig config_;
+  framework::Scope scope_;
+  framework::Executor executor_;
+  std::unique_ptr<framework::ProgramDesc> main_program_;
+  // the child scope and the prepared context of each thread
+  std::vector<framework::Scope*> thread_scopes_;
+  std::vector<std::unique_ptr<framework::ExecutorPrepareContext>> prepared_;
+  std::unique_ptr<framework::ir::Graph> graph_;
+  std::unique_ptr<framework::ParallelExecutor> parallel_executor_;
+  std::vector<std::string> persistable_names_;
+
+  std::unique_ptr<framework::Dataset> dataset_;
+  std::vector<std::string> filelist_;
+
+  std::unique_ptr<framework::Scope> checkpoint_scope_;
+  std::future<void> checkpoint_;
+};
+
+}  // namespace train
+}  // namespace paddle
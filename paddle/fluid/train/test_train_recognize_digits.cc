@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <time.h>
+#include <algorithm>
 #include <fstream>
+#include <string>
+#include <unordered_map>
 
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
@@ -26,6 +29,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/place.h"
+#include "paddle/fluid/train/native_trainer.h"
 
 DEFINE_string(dirname, "", "Directory of the train model.");
 
@@ -87,4 +91,51 @@ void Train() {
 
 TEST(train, recognize_digits) { Train(); }
 
+void TrainByNativeTrainer(train::TrainStrategy strategy) {
+  CHECK(!FLAGS_dirname.empty());
+  framework::InitDevices(false);
+  train::NativeTrainerConfig config;
+  config.main_program_file = FLAGS_dirname + "__model_combined__.main_program";
+  config.params_file = FLAGS_dirname + "__params_combined__";
+  config.strategy = strategy;
+  config.places = {platform::CPUPlace(), platform::CPUPlace()};
+
+  std::ifstream fin(config.main_program_file, std::ios::binary);
+  std::string program_str((std::istreambuf_iterator<char>(fin)),
+                          std::istreambuf_iterator<char>());
+  framework::ProgramDesc program(program_str);
+  for (auto op_desc : program.Block(0).AllOps()) {
+    if (op_desc->Type() == "mean") {
+      config.loss_name = op_desc->Output("Out")[0];
+      break;
+    }
+  }
+  PADDLE_ENFORCE_NE(config.loss_name, "", "loss not found");
+  train::NativeTrainer trainer(config);
+
+  std::unordered_map<std::string, framework::LoDTensor> feeds;
+  auto& x_tensor = feeds["img"];
+  auto x_data =
+      x_tensor.mutable_data<float>({64, 1, 28, 28}, platform::CPUPlace());
+  std::fill(x_data, x_data + 64 * 28 * 28, 1.0f);
+  auto& y_tensor = feeds["label"];
+  auto y_data = y_tensor.mutable_data<int64_t>({64, 1}, platform::CPUPlace());
+  std::fill(y_data, y_data + 64, static_cast<int64_t>(1));
+
+  float first_loss = trainer.RunStep(feeds);
+  float last_loss = first_loss;
+  for (int i = 1; i < 100; ++i) {
+    last_loss = trainer.RunStep(feeds);
+  }
+  EXPECT_LT(last_loss, first_loss);
+}
+
+TEST(train, recognize_digits_by_native_executor) {
+  TrainByNativeTrainer(train::TrainStrategy::kExecutor);
+}
+
+TEST(train, recognize_digits_by_native_parallel_executor) {
+  TrainByNativeTrainer(train::TrainStrategy::kParallelExecutor);
+}
+
 }  // namespace paddle
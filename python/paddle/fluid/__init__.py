@@ -164,8 +164,8 @@ def __bootstrap__():
     os.environ['OMP_NUM_THREADS'] = str(num_threads)
     sysstr = platform.system()
     read_env_flags = [
-        'check_nan_inf', 'fast_check_nan_inf', 'benchmark',
-        'eager_delete_scope', 'fraction_of_cpu_memory_to_use',
+        'check_nan_inf', 'fast_check_nan_inf', 'check_nan_inf_async',
+        'benchmark', 'eager_delete_scope', 'fraction_of_cpu_memory_to_use',
         'initial_cpu_memory_in_mb', 'init_allocated_mem', 'paddle_num_threads',
         'dist_threadpool_size', 'eager_delete_tensor_gb',
         'fast_eager_deletion_mode', 'memory_fraction_of_eager_deletion',
@@ -173,8 +173,21 @@ def __bootstrap__():
         'print_sub_graph_dir', 'pe_profile_fname', 'inner_op_parallelism',
         'enable_parallel_graph', 'fuse_parameter_groups_size',
         'multiple_of_cupti_buffer_size', 'fuse_parameter_memory_size',
-        'tracer_profile_fname', 'dygraph_debug', 'use_system_allocator',
-        'enable_unused_var_check', 'free_idle_chunk', 'free_when_no_cache_hit'
+        'tracer_profile_fname', 'dygraph_debug', 'dygraph_cache_prepared_op',
+        'use_system_allocator',
+        'enable_unused_var_check', 'free_idle_chunk', 'free_when_no_cache_hit',
+        'auto_growth_defragment', 'numa_aware', 'cpu_thread_partition',
+        'metrics_port', 'async_checkpoint_max_pending_mb',
+        'advise_mapped_embedding_rows',
+        'local_exe_scope_drop_memory_mb',
+        'local_exe_scope_drop_fragmentation',
+        'use_packed_gemm_weights',
+        'executor_compiled_mode', 'inter_op_parallelism',
+        'eager_delete_batch_size',
+        'ssa_graph_executor_timeline_path', 'use_var_slots',
+        'reuse_step_scopes', 'jit_autotune', 'jit_autotune_repeat',
+        'jit_autotune_cache_file', 'profiler_peak_gflops',
+        'profiler_peak_bandwidth', 'enable_infer_shape_cache'
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
@@ -197,10 +210,13 @@ def __bootstrap__():
         read_env_flags.append('rpc_send_thread_num')
         read_env_flags.append('rpc_get_thread_num')
         read_env_flags.append('rpc_prefetch_thread_num')
+        read_env_flags.append('rpc_async_optimize_thread_num')
+        read_env_flags.append('rpc_async_optimize_shard_numel')
         read_env_flags.append('rpc_disable_reuse_port')
         read_env_flags.append('rpc_retry_bind_port')
 
         read_env_flags.append('worker_update_interval_secs')
+        read_env_flags.append('worker_lost_heartbeat_secs')
 
         if core.is_compiled_with_brpc():
             read_env_flags.append('max_body_size')
@@ -212,10 +228,15 @@ def __bootstrap__():
             'fraction_of_gpu_memory_to_use', 'initial_gpu_memory_in_mb',
             'reallocate_gpu_memory_in_mb', 'cudnn_deterministic',
             'enable_cublas_tensor_op_math', 'conv_workspace_size_limit',
-            'cudnn_exhaustive_search', 'selected_gpus', 'sync_nccl_allreduce',
+            'cudnn_exhaustive_search', 'cudnn_algo_cache_file',
+            'selected_gpus', 'sync_nccl_allreduce',
             'cudnn_batchnorm_spatial_persistent', 'gpu_allocator_retry_time',
-            'local_exe_sub_scope_limit', 'gpu_memory_limit_mb'
+            'local_exe_sub_scope_limit', 'gpu_memory_limit_mb',
+            'gpu_slab_allocator_max_size', 'enable_nvtx',
+            'profiler_cupti_metrics'
         ]
+        if os.name != 'nt':
+            read_env_flags.append('fusion_group_kernel_cache_dir')
     core.init_gflags([sys.argv[0]] +
                      ["--tryfromenv=" + ",".join(read_env_flags)])
     core.init_glog(sys.argv[0])
@@ -143,3 +143,23 @@ class Communicator(object):
                 comm.is_running()
         """
         self.communicator_.is_running()
+
+    def get_stats(self):
+        """
+        Get the internal states of the communicator, e.g. the queue depth,
+        the merge factor and the bytes sent per second.
+
+        Returns:
+            dict
+
+        Examples:
+            .. code-block:: python
+
+                import paddle.fluid as fluid
+
+                prog = fluid.Program()
+                comm = fluid.communicator.Communicator(prog)
+                comm.start()
+                print(comm.get_stats())
+        """
+        return self.communicator_.get_stats()
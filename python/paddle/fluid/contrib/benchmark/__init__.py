@@ -0,0 +1,31 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+The model-level benchmark of ResNet50, BERT, the DeepFM CTR model and the
+Transformer decoding, on CPU or GPU and with multiple threads. The results
+are JSON lines of the throughput, the latency percentiles and the memory
+peak, so that the regressions can be tracked across the versions, e.g.
+
+    python -m paddle.fluid.contrib.benchmark --workloads resnet50,bert \
+        --modes train,infer --threads 1,4 --output results.jsonl
+"""
+
+from __future__ import print_function
+
+from . import workloads
+from .workloads import *
+from . import runner
+from .runner import *
+
+__all__ = workloads.__all__ + runner.__all__
@@ -0,0 +1,100 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import argparse
+import sys
+
+from paddle.fluid.contrib.benchmark import WORKLOADS, create_workload, \
+    run_benchmark, to_json_line
+
+
+def _split(value):
+    return [v for v in value.split(',') if v]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='The model-level benchmark of Paddle.')
+    parser.add_argument(
+        '--workloads',
+        type=_split,
+        default=sorted(WORKLOADS.keys()),
+        help='The comma separated workloads, in %s.' % sorted(WORKLOADS.keys(
+        )))
+    parser.add_argument(
+        '--modes',
+        type=_split,
+        default=['train', 'infer'],
+        help='The comma separated modes, in train and infer.')
+    parser.add_argument(
+        '--devices',
+        type=_split,
+        default=['cpu'],
+        help='The comma separated devices, in cpu and gpu.')
+    parser.add_argument(
+        '--threads',
+        type=lambda v: [int(t) for t in _split(v)],
+        default=[1],
+        help='The comma separated numbers of the devices of the training, '
+        'or the threads of the inference.')
+    parser.add_argument(
+        '--preset',
+        default='standard',
+        choices=['standard', 'small'],
+        help='The sizes of the models.')
+    parser.add_argument(
+        '--batch_size',
+        type=int,
+        default=None,
+        help='The batch size, the default one of each workload if not set.')
+    parser.add_argument('--warmup', type=int, default=5)
+    parser.add_argument('--iterations', type=int, default=50)
+    parser.add_argument(
+        '--output',
+        default=None,
+        help='The file the JSON lines are appended to, stdout if not set.')
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    out = open(args.output, 'a') if args.output else sys.stdout
+    try:
+        for name in args.workloads:
+            workload = create_workload(name, args.preset)
+            for mode in args.modes:
+                # e.g. the decoding is only benchmarked for the inference.
+                if mode not in workload.modes:
+                    continue
+                for device in args.devices:
+                    for num_threads in args.threads:
+                        result = run_benchmark(
+                            workload,
+                            mode=mode,
+                            use_gpu=device == 'gpu',
+                            num_threads=num_threads,
+                            batch_size=args.batch_size,
+                            warmup=args.warmup,
+                            iterations=args.iterations)
+                        out.write(to_json_line(result) + '\n')
+                        out.flush()
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,249 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import json
+import shutil
+import tempfile
+import threading
+import time
+import numpy as np
+
+from ... import core
+from ... import framework
+from ... import unique_name
+from ...compiler import CompiledProgram
+from ...executor import Executor, scope_guard
+from .workloads import Workload, create_workload
+
+__all__ = ['run_benchmark', 'to_json_line']
+
+
+def _version():
+    try:
+        from paddle.version import full_version, commit
+        return full_version, commit
+    except ImportError:
+        return 'unknown', 'unknown'
+
+
+def _latency_stats(latencies):
+    if not latencies:
+        return None
+    latencies = np.array(latencies) * 1000.0
+    return {
+        'mean': float(np.mean(latencies)),
+        'p50': float(np.percentile(latencies, 50)),
+        'p90': float(np.percentile(latencies, 90)),
+        'p99': float(np.percentile(latencies, 99)),
+    }
+
+
+def _run_steps(workload, exe, program, target, batch_size, num_feeds,
+               iterations, rng):
+    latencies = []
+    for _ in range(iterations):
+        latencies.extend(
+            workload.run(exe, program, target, batch_size, num_feeds, rng))
+    return latencies
+
+
+def _train_from_dataset(workload, exe, main, batch_size, num_threads, warmup,
+                        iterations, rng):
+    """
+    Train the CTR model by the dataset reading the MultiSlot files, which is
+    how it is trained in practice. The batches are not visible to Python, so
+    only the throughput is measured.
+    """
+    dirname = tempfile.mkdtemp()
+    try:
+        if warmup > 0:
+            filelist = workload.write_files(dirname, num_threads,
+                                            warmup * batch_size, rng)
+            exe.train_from_dataset(
+                main,
+                workload.create_dataset(filelist, batch_size, num_threads),
+                thread=num_threads)
+        # The files of the warmup are overwritten.
+        filelist = workload.write_files(dirname, num_threads,
+                                        iterations * batch_size, rng)
+        dataset = workload.create_dataset(filelist, batch_size, num_threads)
+        core.reset_allocator_peak_stats(exe.place)
+        start = time.time()
+        exe.train_from_dataset(main, dataset, thread=num_threads)
+        return time.time() - start
+    finally:
+        shutil.rmtree(dirname, ignore_errors=True)
+
+
+def run_benchmark(workload,
+                  mode='infer',
+                  use_gpu=False,
+                  num_threads=1,
+                  batch_size=None,
+                  warmup=5,
+                  iterations=50,
+                  seed=90):
+    """
+    Benchmark a workload, and return the result as a dict.
+
+    The training with num_threads > 1 runs data parallel on num_threads
+    devices, i.e. the CPU places or the GPU cards, and the batch_size is per
+    device. The inference with num_threads > 1 runs the predictions in
+    num_threads Python threads concurrently, each of which has its own
+    executor and child scope sharing the parameters. The CTR workload trains
+    on CPU by the dataset of the MultiSlot files instead of the feeds, with
+    num_threads reader threads.
+
+    Args:
+        workload(str|Workload): The name of the workload, or the workload.
+        mode(str): 'train' or 'infer'. Default: 'infer'.
+        use_gpu(bool): Whether to run on the GPU. Default: False.
+        num_threads(int): The number of the devices or the threads, see
+            above. Default: 1.
+        batch_size(int, optional): The batch size, the default one of the
+            workload is used if it is None. Default: None.
+        warmup(int): The iterations run before the measurement. Default: 5.
+        iterations(int): The iterations measured. Default: 50.
+        seed(int): The seed of the parameters and the inputs. Default: 90.
+
+    Returns:
+        dict: The result, whose throughput is the number of the units of the
+        workload per second, latency_ms is the statistics of the latencies of
+        the steps in milliseconds, and peak_memory_bytes is the peak of the
+        memory allocated on the device during the measurement.
+    """
+    if not isinstance(workload, Workload):
+        workload = create_workload(workload)
+    if mode not in workload.modes:
+        raise ValueError("The mode of %s should be one of %s, but got %s." %
+                         (workload.name, workload.modes, mode))
+    if num_threads < 1:
+        raise ValueError("The num_threads should be >= 1, but got %d." %
+                         num_threads)
+    if batch_size is None:
+        batch_size = workload.default_batch_size[workload.preset]
+    is_train = mode == 'train'
+    place = core.CUDAPlace(0) if use_gpu else core.CPUPlace()
+
+    main = framework.Program()
+    startup = framework.Program()
+    main.random_seed = seed
+    startup.random_seed = seed
+    with framework.program_guard(main, startup), unique_name.guard():
+        _, target = workload.build(is_train)
+        if is_train:
+            workload.optimizer().minimize(target)
+
+    rng = np.random.RandomState(seed)
+    scope = core.Scope()
+    exe = Executor(place)
+    latencies = []
+    with scope_guard(scope):
+        exe.run(startup)
+        if is_train and not use_gpu and hasattr(workload, 'create_dataset'):
+            elapsed = _train_from_dataset(workload, exe, main, batch_size,
+                                          num_threads, warmup, iterations, rng)
+        elif is_train or num_threads == 1:
+            program = main
+            if num_threads > 1:
+                places = [
+                    core.CUDAPlace(i) if use_gpu else core.CPUPlace()
+                    for i in range(num_threads)
+                ]
+                program = CompiledProgram(main).with_data_parallel(
+                    loss_name=target.name, places=places)
+            _run_steps(workload, exe, program, target, batch_size,
+                       num_threads, warmup, rng)
+            core.reset_allocator_peak_stats(place)
+            start = time.time()
+            latencies = _run_steps(workload, exe, program, target,
+                                   batch_size, num_threads, iterations, rng)
+            elapsed = time.time() - start
+        else:
+            elapsed, latencies = _run_concurrent_inference(
+                workload, place, main, target, scope, batch_size,
+                num_threads, warmup, iterations, seed)
+        peak_memory = core.get_allocator_stats(place)['peak_allocated_bytes']
+
+    samples = workload.samples(batch_size) * workload.steps() * \
+        num_threads * iterations
+    version, commit = _version()
+    return {
+        'workload': workload.name,
+        'preset': workload.preset,
+        'mode': mode,
+        'device': 'gpu' if use_gpu else 'cpu',
+        'threads': num_threads,
+        'batch_size': batch_size,
+        'iterations': iterations,
+        'throughput': samples / elapsed if elapsed > 0 else 0.0,
+        'unit': '%s/s' % workload.unit,
+        'latency_ms': _latency_stats(latencies),
+        'peak_memory_bytes': peak_memory,
+        'version': version,
+        'commit': commit,
+    }
+
+
+def _run_concurrent_inference(workload, place, main, target, scope,
+                              batch_size, num_threads, warmup, iterations,
+                              seed):
+    results = [None] * num_threads
+    errors = []
+    warmed_up = threading.Semaphore(0)
+    start_event = threading.Event()
+
+    def _worker(idx):
+        try:
+            exe = Executor(place)
+            local_scope = scope.new_scope()
+            rng = np.random.RandomState(seed + idx)
+            with scope_guard(local_scope):
+                _run_steps(workload, exe, main, target, batch_size, 1,
+                           warmup, rng)
+                warmed_up.release()
+                start_event.wait()
+                results[idx] = _run_steps(workload, exe, main, target,
+                                          batch_size, 1, iterations, rng)
+        except Exception as e:  # pylint: disable=broad-except
+            errors.append(e)
+            warmed_up.release()
+
+    threads = [
+        threading.Thread(
+            target=_worker, args=(i, )) for i in range(num_threads)
+    ]
+    for t in threads:
+        t.start()
+    for _ in threads:
+        warmed_up.acquire()
+    core.reset_allocator_peak_stats(place)
+    start = time.time()
+    start_event.set()
+    for t in threads:
+        t.join()
+    elapsed = time.time() - start
+    if errors:
+        raise errors[0]
+    latencies = []
+    for r in results:
+        latencies.extend(r)
+    return elapsed, latencies
+
+
+def to_json_line(result):
+    """Return the result as a line of JSON, with the keys sorted."""
+    return json.dumps(result, sort_keys=True)
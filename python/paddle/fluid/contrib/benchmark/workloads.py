@@ -0,0 +1,493 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+The standard workloads of the benchmark. Each workload builds its model
+into the default programs, and generates the random feeds of a batch, so
+that the results only depend on the version of Paddle and the device.
+"""
+
+from __future__ import print_function
+
+import os
+import time
+import numpy as np
+
+from ... import layers
+from ... import optimizer
+from ...param_attr import ParamAttr
+from ...initializer import NormalInitializer
+
+__all__ = ['Workload', 'WORKLOADS', 'create_workload']
+
+
+class Workload(object):
+    """
+    The base class of the workloads.
+
+    Args:
+        preset(str): 'standard' for the sizes of the original models, or
+            'small' for the tiny models used by the tests.
+    """
+    name = None
+    # The unit of the throughput.
+    unit = 'samples'
+    modes = ('train', 'infer')
+    default_batch_size = {'standard': 32, 'small': 2}
+
+    def __init__(self, preset='standard'):
+        if preset not in ['standard', 'small']:
+            raise ValueError("The preset must be 'standard' or 'small'.")
+        self.preset = preset
+
+    def build(self, is_train):
+        """
+        Build the model into the default main and startup programs.
+
+        Returns:
+            tuple: (feed_vars, target), the target is the loss if
+            `is_train` is True, or the output otherwise.
+        """
+        raise NotImplementedError()
+
+    def optimizer(self):
+        return optimizer.Momentum(learning_rate=0.01, momentum=0.9)
+
+    def feed(self, batch_size, rng):
+        """Return the dict of the random inputs of a batch."""
+        raise NotImplementedError()
+
+    def samples(self, batch_size):
+        """The number of the units processed by a step."""
+        return batch_size
+
+    def steps(self):
+        """The number of the steps of an iteration."""
+        return 1
+
+    def run(self, exe, program, target, batch_size, num_feeds, rng):
+        """
+        Run an iteration by the executor, and return the latencies of its
+        steps in seconds. The program runs data parallel if num_feeds > 1,
+        which feeds a batch to each device.
+        """
+        if num_feeds > 1:
+            feed = [self.feed(batch_size, rng) for _ in range(num_feeds)]
+        else:
+            feed = self.feed(batch_size, rng)
+        start = time.time()
+        exe.run(program, feed=feed, fetch_list=[target])
+        return [time.time() - start]
+
+
+class ResNet50(Workload):
+    name = 'resnet50'
+    unit = 'images'
+    default_batch_size = {'standard': 32, 'small': 2}
+
+    def __init__(self, preset='standard'):
+        super(ResNet50, self).__init__(preset)
+        self.image_size = 224 if preset == 'standard' else 32
+        self.class_num = 1000 if preset == 'standard' else 10
+
+    def _conv_bn(self, x, num_filters, filter_size, stride=1, act=None):
+        conv = layers.conv2d(
+            x,
+            num_filters=num_filters,
+            filter_size=filter_size,
+            stride=stride,
+            padding=(filter_size - 1) // 2,
+            bias_attr=False)
+        return layers.batch_norm(conv, act=act)
+
+    def _bottleneck(self, x, num_filters, stride):
+        conv0 = self._conv_bn(x, num_filters, 1, act='relu')
+        conv1 = self._conv_bn(conv0, num_filters, 3, stride, act='relu')
+        conv2 = self._conv_bn(conv1, num_filters * 4, 1)
+        if x.shape[1] != num_filters * 4 or stride != 1:
+            x = self._conv_bn(x, num_filters * 4, 1, stride)
+        return layers.elementwise_add(x, conv2, act='relu')
+
+    def build(self, is_train):
+        image = layers.data(
+            name='image',
+            shape=[3, self.image_size, self.image_size],
+            dtype='float32')
+        label = layers.data(name='label', shape=[1], dtype='int64')
+        x = self._conv_bn(image, 64, 7, 2, act='relu')
+        x = layers.pool2d(
+            x, pool_size=3, pool_stride=2, pool_padding=1, pool_type='max')
+        for i, (depth, num_filters) in enumerate(
+                zip([3, 4, 6, 3], [64, 128, 256, 512])):
+            for j in range(depth):
+                x = self._bottleneck(x, num_filters, 2
+                                     if j == 0 and i != 0 else 1)
+        x = layers.pool2d(x, pool_type='avg', global_pooling=True)
+        logits = layers.fc(x, size=self.class_num)
+        if not is_train:
+            return [image], layers.softmax(logits)
+        loss = layers.mean(
+            layers.softmax_with_cross_entropy(logits=logits, label=label))
+        return [image, label], loss
+
+    def feed(self, batch_size, rng):
+        shape = [batch_size, 3, self.image_size, self.image_size]
+        return {
+            'image': rng.uniform(-1, 1, shape).astype('float32'),
+            'label': rng.randint(0, self.class_num,
+                                 [batch_size, 1]).astype('int64'),
+        }
+
+
+def _multi_head_attention(x, memory, bias, hidden_size, num_heads, name):
+    def _split_heads(x):
+        x = layers.reshape(
+            x, shape=[0, 0, num_heads, hidden_size // num_heads])
+        return layers.transpose(x, perm=[0, 2, 1, 3])
+
+    q = layers.fc(x, hidden_size, num_flatten_dims=2, name=name + '_q')
+    k = layers.fc(memory, hidden_size, num_flatten_dims=2, name=name + '_k')
+    v = layers.fc(memory, hidden_size, num_flatten_dims=2, name=name + '_v')
+    q, k, v = _split_heads(q), _split_heads(k), _split_heads(v)
+    scale = (hidden_size // num_heads)**-0.5
+    product = layers.matmul(q, k, transpose_y=True, alpha=scale)
+    if bias is not None:
+        product = layers.elementwise_add(product, bias)
+    out = layers.matmul(layers.softmax(product), v)
+    out = layers.transpose(out, perm=[0, 2, 1, 3])
+    out = layers.reshape(out, shape=[0, 0, hidden_size])
+    return layers.fc(out, hidden_size, num_flatten_dims=2, name=name + '_o')
+
+
+def _transformer_layer(x, bias, hidden_size, num_heads, name):
+    attn = _multi_head_attention(x, x, bias, hidden_size, num_heads,
+                                 name + '_att')
+    x = layers.layer_norm(
+        layers.elementwise_add(x, attn), begin_norm_axis=2)
+    ffn = layers.fc(x,
+                    hidden_size * 4,
+                    num_flatten_dims=2,
+                    act='gelu',
+                    name=name + '_ffn0')
+    ffn = layers.fc(ffn, hidden_size, num_flatten_dims=2, name=name + '_ffn1')
+    return layers.layer_norm(layers.elementwise_add(x, ffn), begin_norm_axis=2)
+
+
+class Bert(Workload):
+    name = 'bert'
+    unit = 'sequences'
+    default_batch_size = {'standard': 32, 'small': 2}
+
+    def __init__(self, preset='standard'):
+        super(Bert, self).__init__(preset)
+        if preset == 'standard':
+            # BERT base
+            self.vocab_size, self.seq_len = 30522, 128
+            self.hidden_size, self.num_heads, self.num_layers = 768, 12, 12
+        else:
+            self.vocab_size, self.seq_len = 100, 8
+            self.hidden_size, self.num_heads, self.num_layers = 16, 2, 2
+
+    def _embedding(self, ids, size, name):
+        return layers.embedding(
+            ids,
+            size=[size, self.hidden_size],
+            param_attr=ParamAttr(
+                name=name, initializer=NormalInitializer(scale=0.02)))
+
+    def build(self, is_train):
+        src_ids = layers.data(
+            name='src_ids', shape=[self.seq_len, 1], dtype='int64')
+        pos_ids = layers.data(
+            name='pos_ids', shape=[self.seq_len, 1], dtype='int64')
+        sent_ids = layers.data(
+            name='sent_ids', shape=[self.seq_len, 1], dtype='int64')
+        mlm_label = layers.data(
+            name='mlm_label', shape=[self.seq_len, 1], dtype='int64')
+        nsp_label = layers.data(name='nsp_label', shape=[1], dtype='int64')
+
+        x = self._embedding(src_ids, self.vocab_size, 'word_embedding')
+        x = layers.elementwise_add(
+            x, self._embedding(pos_ids, self.seq_len, 'pos_embedding'))
+        x = layers.elementwise_add(
+            x, self._embedding(sent_ids, 2, 'sent_embedding'))
+        x = layers.layer_norm(x, begin_norm_axis=2)
+        for i in range(self.num_layers):
+            x = _transformer_layer(x, None, self.hidden_size, self.num_heads,
+                                   'encoder_%d' % i)
+
+        cls = layers.slice(x, axes=[1], starts=[0], ends=[1])
+        pooled = layers.fc(cls, self.hidden_size, act='tanh')
+        nsp_logits = layers.fc(pooled, 2)
+        if not is_train:
+            return [src_ids, pos_ids, sent_ids], layers.softmax(nsp_logits)
+        # The masked LM predicts all the tokens, which is the upper bound of
+        # its cost.
+        mlm_logits = layers.fc(x, self.vocab_size, num_flatten_dims=2)
+        mlm_loss = layers.softmax_with_cross_entropy(
+            logits=mlm_logits, label=mlm_label)
+        nsp_loss = layers.softmax_with_cross_entropy(
+            logits=nsp_logits, label=nsp_label)
+        loss = layers.elementwise_add(
+            layers.mean(mlm_loss), layers.mean(nsp_loss))
+        return [src_ids, pos_ids, sent_ids, mlm_label, nsp_label], loss
+
+    def optimizer(self):
+        return optimizer.Adam(learning_rate=1e-4)
+
+    def feed(self, batch_size, rng):
+        shape = [batch_size, self.seq_len, 1]
+        pos = np.tile(
+            np.arange(self.seq_len).reshape([1, self.seq_len, 1]),
+            [batch_size, 1, 1])
+        return {
+            'src_ids': rng.randint(0, self.vocab_size, shape).astype('int64'),
+            'pos_ids': pos.astype('int64'),
+            'sent_ids': rng.randint(0, 2, shape).astype('int64'),
+            'mlm_label': rng.randint(0, self.vocab_size,
+                                     shape).astype('int64'),
+            'nsp_label': rng.randint(0, 2, [batch_size, 1]).astype('int64'),
+        }
+
+
+class DeepFM(Workload):
+    """
+    The CTR model, whose training reads the files of the MultiSlot format by
+    the dataset, see `write_files` and `create_dataset`.
+    """
+    name = 'deepfm'
+    default_batch_size = {'standard': 512, 'small': 4}
+
+    def __init__(self, preset='standard'):
+        super(DeepFM, self).__init__(preset)
+        if preset == 'standard':
+            # the sizes of the Criteo dataset
+            self.sparse_slots, self.dense_dim = 26, 13
+            self.sparse_dim, self.embedding_size = 1000001, 10
+            self.fc_sizes = [400, 400, 400]
+        else:
+            self.sparse_slots, self.dense_dim = 3, 2
+            self.sparse_dim, self.embedding_size = 100, 4
+            self.fc_sizes = [8]
+        self.feed_vars = []
+
+    def build(self, is_train):
+        dense = layers.data(
+            name='dense_input', shape=[self.dense_dim], dtype='float32')
+        sparse = [
+            layers.data(
+                name='C%d' % i, shape=[1], lod_level=1, dtype='int64')
+            for i in range(self.sparse_slots)
+        ]
+        label = layers.data(name='label', shape=[1], dtype='int64')
+
+        # first order
+        first_order = [
+            layers.sequence_pool(
+                layers.embedding(
+                    ids,
+                    size=[self.sparse_dim, 1],
+                    is_sparse=True,
+                    param_attr=ParamAttr(name='first_order_weight')),
+                pool_type='sum') for ids in sparse
+        ]
+        # second order, by the embeddings shared with the deep part
+        embs = [
+            layers.sequence_pool(
+                layers.embedding(
+                    ids,
+                    size=[self.sparse_dim, self.embedding_size],
+                    is_sparse=True,
+                    param_attr=ParamAttr(name='embedding_weight')),
+                pool_type='sum') for ids in sparse
+        ]
+        emb_stack = layers.stack(embs, axis=1)
+        sum_square = layers.square(layers.reduce_sum(emb_stack, dim=1))
+        square_sum = layers.reduce_sum(layers.square(emb_stack), dim=1)
+        second_order = layers.scale(
+            layers.reduce_sum(
+                sum_square - square_sum, dim=1, keep_dim=True),
+            scale=0.5)
+
+        deep = layers.concat(embs + [dense], axis=1)
+        for size in self.fc_sizes:
+            deep = layers.fc(deep, size, act='relu')
+        deep = layers.fc(deep, 1)
+
+        logit = layers.sums(
+            [layers.sums(first_order), second_order, deep])
+        predict = layers.sigmoid(logit)
+        self.feed_vars = [dense] + sparse + [label]
+        if not is_train:
+            return [dense] + sparse, predict
+        loss = layers.mean(
+            layers.sigmoid_cross_entropy_with_logits(
+                logit, layers.cast(label, 'float32')))
+        return self.feed_vars, loss
+
+    def optimizer(self):
+        return optimizer.Adam(learning_rate=1e-4, lazy_mode=True)
+
+    def _sample(self, rng):
+        dense = rng.uniform(0, 1, [self.dense_dim]).astype('float32')
+        sparse = [[rng.randint(self.sparse_dim)]
+                  for _ in range(self.sparse_slots)]
+        return dense, sparse, rng.randint(2)
+
+    def feed(self, batch_size, rng):
+        from ... import core
+        samples = [self._sample(rng) for _ in range(batch_size)]
+        feed = {
+            'dense_input': np.stack([s[0] for s in samples]),
+            'label': np.array(
+                [[s[2]] for s in samples], dtype='int64'),
+        }
+        for i in range(self.sparse_slots):
+            tensor = core.LoDTensor()
+            tensor.set(
+                np.array(
+                    [s[1][i] for s in samples], dtype='int64').reshape(
+                        [-1, 1]),
+                core.CPUPlace())
+            tensor.set_recursive_sequence_lengths([[1] * batch_size])
+            feed['C%d' % i] = tensor
+        return feed
+
+    def write_files(self, dirname, num_files, samples_per_file, rng):
+        """
+        Write the random samples in the MultiSlot format, i.e. each line has
+        the number of the values of a slot followed by the values, for the
+        slots in the order of the feed vars.
+        """
+        filelist = []
+        for i in range(num_files):
+            filename = os.path.join(dirname, 'deepfm_part_%d.txt' % i)
+            with open(filename, 'w') as f:
+                for _ in range(samples_per_file):
+                    dense, sparse, label = self._sample(rng)
+                    slots = [' '.join(['%d' % dense.size] +
+                                      ['%f' % v for v in dense])]
+                    for ids in sparse:
+                        slots.append(' '.join(
+                            ['%d' % len(ids)] + ['%d' % v for v in ids]))
+                    slots.append('1 %d' % label)
+                    f.write(' '.join(slots) + '\n')
+            filelist.append(filename)
+        return filelist
+
+    def create_dataset(self, filelist, batch_size, num_threads):
+        from ...dataset import DatasetFactory
+        dataset = DatasetFactory().create_dataset('QueueDataset')
+        dataset.set_use_var(self.feed_vars)
+        dataset.set_pipe_command('cat')
+        dataset.set_batch_size(batch_size)
+        dataset.set_thread(num_threads)
+        dataset.set_filelist(filelist)
+        return dataset
+
+
+class TransformerDecoding(Workload):
+    """
+    The greedy decoding of a Transformer decoder. Each step feeds the prefix
+    decoded so far and predicts the next token, so the latency is per token,
+    and the throughput is in tokens.
+    """
+    name = 'transformer_decoding'
+    unit = 'tokens'
+    modes = ('infer', )
+    default_batch_size = {'standard': 8, 'small': 2}
+
+    def __init__(self, preset='standard'):
+        super(TransformerDecoding, self).__init__(preset)
+        if preset == 'standard':
+            # Transformer base
+            self.vocab_size, self.max_len = 10000, 32
+            self.hidden_size, self.num_heads, self.num_layers = 512, 8, 6
+        else:
+            self.vocab_size, self.max_len = 50, 4
+            self.hidden_size, self.num_heads, self.num_layers = 16, 2, 2
+
+    def build(self, is_train):
+        if is_train:
+            raise ValueError("%s only supports the inference." % self.name)
+        ids = layers.data(
+            name='trg_ids',
+            shape=[-1, -1, 1],
+            dtype='int64',
+            append_batch_size=False)
+        pos = layers.data(
+            name='trg_pos',
+            shape=[-1, -1, 1],
+            dtype='int64',
+            append_batch_size=False)
+        bias = layers.data(
+            name='trg_bias',
+            shape=[-1, self.num_heads, -1, -1],
+            dtype='float32',
+            append_batch_size=False)
+        x = layers.elementwise_add(
+            layers.embedding(
+                ids, size=[self.vocab_size, self.hidden_size]),
+            layers.embedding(
+                pos, size=[self.max_len, self.hidden_size]))
+        for i in range(self.num_layers):
+            x = _transformer_layer(x, bias, self.hidden_size, self.num_heads,
+                                   'decoder_%d' % i)
+        logits = layers.fc(x, self.vocab_size, num_flatten_dims=2)
+        return [ids, pos, bias], layers.argmax(logits, axis=-1)
+
+    def feed(self, batch_size, rng, prefix=None):
+        """
+        Return the feeds of the prefix of the shape [batch_size, step],
+        which starts by the token 0.
+        """
+        if prefix is None:
+            prefix = np.zeros([batch_size, 1], dtype='int64')
+        step = prefix.shape[1]
+        pos = np.tile(np.arange(step).reshape([1, step]), [batch_size, 1])
+        # the causal mask
+        bias = np.triu(np.full([step, step], -1e9, dtype='float32'), 1)
+        bias = np.tile(bias, [batch_size, self.num_heads, 1, 1])
+        return {
+            'trg_ids': prefix.reshape([batch_size, step, 1]),
+            'trg_pos': pos.reshape([batch_size, step, 1]).astype('int64'),
+            'trg_bias': bias,
+        }
+
+    def steps(self):
+        return self.max_len - 1
+
+    def run(self, exe, program, target, batch_size, num_feeds, rng):
+        latencies = []
+        prefix = np.zeros([batch_size, 1], dtype='int64')
+        for _ in range(self.steps()):
+            feed = self.feed(batch_size, rng, prefix)
+            start = time.time()
+            out, = exe.run(program, feed=feed, fetch_list=[target])
+            latencies.append(time.time() - start)
+            next_ids = np.array(out)[:, -1].reshape([batch_size, 1])
+            prefix = np.concatenate([prefix, next_ids.astype('int64')], axis=1)
+        return latencies
+
+
+WORKLOADS = {
+    w.name: w
+    for w in [ResNet50, Bert, DeepFM, TransformerDecoding]
+}
+
+
+def create_workload(name, preset='standard'):
+    if name not in WORKLOADS:
+        raise ValueError("Unknown workload %s, which should be one of %s." %
+                         (name, sorted(WORKLOADS.keys())))
+    return WORKLOADS[name](preset)
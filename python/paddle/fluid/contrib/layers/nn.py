@@ -32,7 +32,7 @@ __all__ = [
     'fused_elemwise_activation', 'sequence_topk_avg_pooling', 'var_conv_2d',
     'match_matrix_tensor', 'tree_conv', 'fused_embedding_seq_pool',
     'multiclass_nms2', 'search_pyramid_hash', 'shuffle_batch', 'partial_concat',
-    'partial_sum'
+    'partial_sum', 'fused_embedding_seqpool_cvm_concat'
 ]
 
 
@@ -498,6 +498,76 @@ def fused_embedding_seq_pool(input,
     return out
 
 
+def fused_embedding_seqpool_cvm_concat(input,
+                                       size,
+                                       cvm,
+                                       pooltype='SUM',
+                                       use_cvm=True,
+                                       padding_idx=None,
+                                       param_attr=None,
+                                       dtype='float32'):
+    """
+    **Embedding Sequence pool CVM Concat**
+
+    This layer is the fusion of lookup_table, sequence_pool, cvm and concat
+    of all the slots, which share one embedding table. The gradient of the
+    table is always a SelectedRows.
+
+    Args:
+        input (list[Variable]): The Tensor<int64> Variables of the slots,
+            which contain the IDs' information with lod level 1.
+        size (tuple|list): The shape of the shared lookup_table parameter.
+            The first two columns of the embedding are show and click.
+        cvm (Variable): The show and click of each instance with shape
+            [N, 2], where N is the batch size.
+        pooltype (str): The pooling type of sequence_pool, which can be
+            `SUM`, `AVERAGE` or `SQRT`. Default: SUM.
+        use_cvm (bool): Apply cvm on show and click, or drop them.
+            Default: True.
+        padding_idx (int|long|None): It will pool all-zero embeddings
+            whenever lookup encounters :math:`padding\_idx` in Ids. If set
+            :attr:`None`, it makes no effect to output. If
+            :math:`padding\_idx < 0`, the :math:`padding\_idx` will
+            automatically be converted to :math:`size[0] + padding\_idx`.
+            Default: None.
+        param_attr (ParamAttr): Parameters for this layer.
+        dtype (np.dtype|core.VarDesc.VarType|str): The dtype of the output.
+    Returns:
+        The concatenated output Variable, whose width is the number of slots
+        times size[1], or size[1] - 2 if use_cvm is False.
+    Examples:
+        .. code-block:: python
+            import paddle.fluid as fluid
+
+            slots = [
+                fluid.layers.data(
+                    name='slot%d' % i, shape=[1], dtype='int64', lod_level=1)
+                for i in range(3)
+            ]
+            cvm = fluid.layers.data(name='cvm', shape=[2], dtype='float32')
+            out = fluid.contrib.fused_embedding_seqpool_cvm_concat(
+                input=slots, size=[1000, 11], cvm=cvm, param_attr='emb')
+    """
+    helper = LayerHelper('fused_embedding_seqpool_cvm_concat', **locals())
+    w = helper.create_parameter(
+        attr=helper.param_attr, shape=size, dtype=dtype, is_bias=False)
+    out = helper.create_variable_for_type_inference(dtype)
+    padding_idx = -1 if padding_idx is None else padding_idx if padding_idx >= 0 else (
+        size[0] + padding_idx)
+    helper.append_op(
+        type='fused_embedding_seqpool_cvm_concat',
+        inputs={'Ids': input,
+                'W': w,
+                'CVM': cvm},
+        outputs={'Out': out},
+        attrs={
+            'pooltype': pooltype.upper(),
+            'use_cvm': use_cvm,
+            'padding_idx': padding_idx
+        })
+    return out
+
+
 def multiclass_nms2(bboxes,
                     scores,
                     score_threshold,
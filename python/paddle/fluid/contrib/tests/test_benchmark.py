@@ -0,0 +1,67 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import json
+import unittest
+import paddle.fluid as fluid
+from paddle.fluid.contrib.benchmark import WORKLOADS, create_workload, \
+    run_benchmark, to_json_line
+
+
+class TestBenchmark(unittest.TestCase):
+    def check_result(self, result, workload, mode, num_threads):
+        self.assertEqual(result['workload'], workload.name)
+        self.assertEqual(result['mode'], mode)
+        self.assertEqual(result['threads'], num_threads)
+        self.assertGreater(result['throughput'], 0)
+        self.assertGreaterEqual(result['peak_memory_bytes'], 0)
+        latency = result['latency_ms']
+        if latency is not None:
+            self.assertLessEqual(latency['p50'], latency['p99'])
+        self.assertEqual(json.loads(to_json_line(result)), result)
+
+    def run_workloads(self, use_gpu, num_threads):
+        for name in sorted(WORKLOADS.keys()):
+            workload = create_workload(name, 'small')
+            for mode in workload.modes:
+                result = run_benchmark(
+                    workload,
+                    mode=mode,
+                    use_gpu=use_gpu,
+                    num_threads=num_threads,
+                    warmup=1,
+                    iterations=2)
+                self.check_result(result, workload, mode, num_threads)
+
+    def test_cpu(self):
+        self.run_workloads(False, 1)
+
+    def test_cpu_multi_threads(self):
+        self.run_workloads(False, 2)
+
+    def test_gpu(self):
+        if fluid.core.is_compiled_with_cuda():
+            self.run_workloads(True, 1)
+
+    def test_invalid_mode(self):
+        with self.assertRaises(ValueError):
+            run_benchmark('transformer_decoding', mode='train')
+        with self.assertRaises(ValueError):
+            create_workload('unknown')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -133,8 +133,12 @@ def convert_dist_to_sparse_program(program):
     return program
 
 
-def load_persistables_for_increment(dirname, executor, program,
-                                    lookup_table_var, lookup_table_var_path):
+def load_persistables_for_increment(dirname,
+                                    executor,
+                                    program,
+                                    lookup_table_var,
+                                    lookup_table_var_path,
+                                    lookup_table_delta_paths=None):
     """
     WARNING: this function will only be used for distributed training with distributed lookup table.
     for increment training, the pserver will not only load dense variables,
@@ -147,6 +151,9 @@ def load_persistables_for_increment(dirname, executor, program,
         program(Program): The parameter server program, which will run on Pserver.
         lookup_table_var: the distributed lookup tables var name.
         lookup_table_var_path: the the distributed lookup tables var location.
+        lookup_table_delta_paths(list|None): the locations of the delta saves
+            of the lookup table after the one in lookup_table_var_path, in
+            the saving order. Their rows overwrite the loaded table.
 
     Returns:
         None
@@ -221,7 +228,7 @@ def load_persistables_for_increment(dirname, executor, program,
         executor.run(load_prog)
 
     def __load_lookup_table_vars(executor, main_program, lookup_table_var,
-                                 lookup_table_var_path):
+                                 lookup_table_var_path, delta_paths):
         emb_var = main_program.global_block().var(lookup_table_var)
 
         load_program = Program()
@@ -230,7 +237,10 @@ def load_persistables_for_increment(dirname, executor, program,
             type='load',
             inputs={},
             outputs={'Out': [emb_var]},
-            attrs={'file_path': lookup_table_var_path})
+            attrs={
+                'file_path': lookup_table_var_path,
+                'delta_file_paths': delta_paths
+            })
         executor.run(load_program)
 
     if not os.path.isdir(dirname):
@@ -239,6 +249,11 @@ def load_persistables_for_increment(dirname, executor, program,
     if not os.path.exists(lookup_table_var_path):
         raise ValueError("There is no file named '%s'", lookup_table_var_path)
 
+    delta_paths = list(lookup_table_delta_paths or [])
+    for delta_path in delta_paths:
+        if not os.path.exists(delta_path):
+            raise ValueError("There is no file named '%s'", delta_path)
+
     if not isinstance(program, Program):
         raise ValueError("program must be an instance of fluid.Program")
 
@@ -250,7 +265,7 @@ def load_persistables_for_increment(dirname, executor, program,
         program._ps_endpoint)
     _load_persistable_vars(executor, dirname, need_load_vars)
     __load_lookup_table_vars(executor, program, lookup_table_var,
-                             lookup_table_var_path)
+                             lookup_table_var_path, delta_paths)
 
     _logger.info("Finish Load Sparse Program With "
                  "Distributed Lookup Table Vars from {}, time = {}".format(
@@ -236,6 +236,33 @@ class DatasetBase(object):
         """
         self.dataset.set_hdfs_config(fs_name, fs_ugi)
 
+    def set_hdfs_native_read(self,
+                             native_read=True,
+                             chunk_size=8 << 20,
+                             parallelism=4):
+        """
+        Set if Dataset reads hdfs files through libhdfs.so instead of
+        forking the hadoop command. Each file is read with parallelism
+        range reads of chunk_size bytes in flight. If libhdfs.so can not be
+        loaded (add its directory to LD_LIBRARY_PATH), the hadoop command is
+        used. It only works with the default pipe command "cat".
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset()
+              dataset.set_hdfs_config("my_fs_name", "my_fs_ugi")
+              dataset.set_hdfs_native_read(True)
+
+        Args:
+            native_read(bool): if use libhdfs or not, default is True
+            chunk_size(int): bytes of each range read, default is 8MB
+            parallelism(int): range reads in flight per file, default is 4
+        """
+        self.dataset.set_hdfs_native_read(native_read, chunk_size,
+                                          parallelism)
+
     def set_download_cmd(self, download_cmd):
         """
         Set customized download cmd: download_cmd
@@ -356,6 +383,104 @@ class InMemoryDataset(DatasetBase):
         self.is_user_set_queue_num = True
         self.queue_num = queue_num
 
+    def set_compact_record(self, compact_record):
+        """
+        Set if InMemoryDataset holds records in compact format. In compact
+        format the feasigns of each record are varint/delta encoded into
+        shared memory blocks and decoded when batches are fed, which takes
+        much less memory than the default format. Default is False.
+
+        Args:
+            compact_record(bool): if hold records in compact format or not
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_compact_record(True)
+
+        """
+        self.dataset.set_compact_record(compact_record)
+
+    def set_prefetch_batch(self, prefetch_batch):
+        """
+        Set if each reader builds the feed tensors of the next batch in a
+        helper thread while the current batch is trained, so batch assembly
+        overlaps with op execution. Default is False.
+
+        Args:
+            prefetch_batch(bool): if prefetch the next batch or not
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_prefetch_batch(True)
+
+        """
+        self.dataset.set_prefetch_batch(prefetch_batch)
+
+    def add_instance_filter(self,
+                            slot,
+                            values=None,
+                            keep_rate=1.0,
+                            others_keep_rate=1.0):
+        """
+        Add a filter evaluated by the readers while the instances are parsed,
+        so the dropped instances are never loaded into memory. An instance
+        matches the filter if its slot has one of the values (always if no
+        values are given), then it is kept with the probability keep_rate
+        if it matches and others_keep_rate if not. An instance is kept only
+        if all filters keep it.
+
+        Args:
+            slot(str): name of an int64 variable set by set_use_var
+            values(list|None): values of the slot to match, default is None
+            keep_rate(float): rate to keep the matched instances, default
+                              is 1.0
+            others_keep_rate(float): rate to keep the other instances,
+                                     default is 1.0
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              # keep instances tagged 3 or 5 only
+              dataset.add_instance_filter("tag", [3, 5], others_keep_rate=0.0)
+              # keep 10% of the instances with label 0
+              dataset.add_instance_filter("label", [0], keep_rate=0.1)
+
+        """
+        instance_filter = self.proto_desc.instance_filters.add()
+        instance_filter.slot = slot
+        if values is not None:
+            instance_filter.values.extend(values)
+        instance_filter.keep_rate = keep_rate
+        instance_filter.others_keep_rate = others_keep_rate
+
+    def set_channel_shard_num(self, shard_num):
+        """
+        Set shard num of the input channel. When shard_num > 1, the
+        reader threads of load_into_memory write into lock-striped shards
+        instead of contending on one lock, which helps when thread_num is
+        large. Default is 1, which means no sharding.
+
+        Args:
+            shard_num(int): shard num of the input channel
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_channel_shard_num(8)
+
+        """
+        self.dataset.set_channel_shard_num(shard_num)
+
     def set_parse_ins_id(self, parse_ins_id):
         """
         Set id Dataset need to parse insid
@@ -390,6 +515,52 @@ class InMemoryDataset(DatasetBase):
         """
         self.parse_content = parse_content
 
+    def set_binary_format(self, use_binary_format=True):
+        """
+        Set if Dataset reads files in binary slot-columnar format, which
+        are generated by convert_to_binary. Binary files are loaded without
+        text parsing.
+
+        Args:
+            use_binary_format(bool): if read binary files or not
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_binary_format(True)
+
+        """
+        if use_binary_format:
+            self.proto_desc.name = "MultiSlotBinaryInMemoryDataFeed"
+        else:
+            self.proto_desc.name = "MultiSlotInMemoryDataFeed"
+
+    def convert_to_binary(self, src, dst, block_size=1024):
+        """
+        Convert a text file to the binary format read by set_binary_format,
+        using the slots set by set_use_var. Call it after set_use_var,
+        set_pipe_command, set_parse_ins_id and set_parse_content.
+
+        Args:
+            src(str): text file to convert
+            dst(str): output binary file
+            block_size(int): instances per block, default is 1024
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_use_var([data, label])
+              dataset.convert_to_binary("a.txt", "a.bin")
+
+        """
+        core.convert_multi_slot_text_to_binary(self.desc(), src, dst,
+                                               self.parse_ins_id,
+                                               self.parse_content, block_size)
+
     def set_fleet_send_batch_size(self, fleet_send_batch_size=1024):
         """
         Set fleet send batch size, default is 1024
@@ -494,6 +665,50 @@ class InMemoryDataset(DatasetBase):
         self.dataset.create_preload_readers()
         self.dataset.preload_into_memory()
 
+    def set_preload_memory_limit(self, limit):
+        """
+        Set the memory limit in bytes of the data preloaded by
+        preload_into_memory. When it is reached, preload pauses until
+        wait_preload_done is called, which loads the rest of the files.
+        So the next pass can be preloaded while training without running
+        out of memory. Default is 0, which means no limit.
+
+        Args:
+            limit(int): memory limit in bytes
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              filelist = ["a.txt", "b.txt"]
+              dataset.set_filelist(filelist)
+              dataset.set_preload_memory_limit(8 << 30)
+              dataset.preload_into_memory()
+              dataset.wait_preload_done()
+        """
+        self.dataset.set_preload_memory_limit(limit)
+
+    def get_preload_memory_size(self):
+        """
+        Get the memory in bytes of the data preloaded so far. It is only
+        counted by preload_into_memory.
+
+        Returns:
+            The memory in bytes of the preloaded data.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              filelist = ["a.txt", "b.txt"]
+              dataset.set_filelist(filelist)
+              dataset.preload_into_memory()
+              print(dataset.get_preload_memory_size())
+        """
+        return self.dataset.get_preload_memory_size()
+
     def wait_preload_done(self):
         """
         Wait preload_into_memory done
@@ -572,6 +787,54 @@ class InMemoryDataset(DatasetBase):
         if fleet is not None:
             fleet._role_maker.barrier_worker()
 
+    def load_into_memory_and_global_shuffle(self, fleet=None, thread_num=12):
+        """
+        Load data into memory and global shuffle it in one pipelined pass.
+        Records are sent to their destination trainer while files are still
+        being parsed, instead of after the whole pass is loaded as in
+        load_into_memory followed by global_shuffle. This shortens the pass
+        time and avoids holding both pre- and post-shuffle data in memory.
+        If not in distributed mode (built without pslib), it is the same as
+        load_into_memory.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              from paddle.fluid.incubate.fleet.parameter_server.pslib import fleet
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              filelist = ["a.txt", "b.txt"]
+              dataset.set_filelist(filelist)
+              dataset.load_into_memory_and_global_shuffle(fleet)
+
+        Args:
+            fleet(Fleet): fleet singleton. Default None.
+            thread_num(int): shuffle thread num. Default is 12.
+
+        """
+        self._prepare_to_run()
+        trainer_num = 1
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+            trainer_num = fleet.worker_num()
+        if self.fleet_send_batch_size is None:
+            self.fleet_send_batch_size = 1024
+        if self.fleet_send_sleep_seconds is None:
+            self.fleet_send_sleep_seconds = 0
+        self.dataset.register_client2client_msg_handler()
+        self.dataset.set_trainer_num(trainer_num)
+        self.dataset.set_fleet_send_batch_size(self.fleet_send_batch_size)
+        self.dataset.set_fleet_send_sleep_seconds(self.fleet_send_sleep_seconds)
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+        self.dataset.load_into_memory_and_global_shuffle(thread_num)
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+        if self.merge_by_lineid:
+            self.dataset.merge_by_lineid()
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+
     def release_memory(self):
         """
         Release InMemoryDataset memory data, when data will not be used again.
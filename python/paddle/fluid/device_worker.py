@@ -78,6 +78,21 @@ class Hogwild(DeviceWorker):
     def __init__(self):
         """Init."""
         super(Hogwild, self).__init__()
+        self._local_param_max_numel = 0
+        self._local_param_merge_period = 100
+
+    def _set_local_param(self, max_numel, merge_period=100):
+        """
+        Update the params whose numels are at most max_numel in thread local
+        copies, and merge the updates of the threads into the global params
+        every merge_period batches.
+
+        Args:
+            max_numel(int): the max numel of the local params, 0 to disable.
+            merge_period(int): the number of batches between two merges.
+        """
+        self._local_param_max_numel = max_numel
+        self._local_param_merge_period = merge_period
 
     def _gen_worker_desc(self, trainer_desc):
         """
@@ -87,6 +102,9 @@ class Hogwild(DeviceWorker):
             trainer_desc(TrainerDesc): a TrainerDesc object
         """
         trainer_desc.device_worker_name = "HogwildWorker"
+        hogwild = trainer_desc.hogwild_param
+        hogwild.local_param_max_numel = self._local_param_max_numel
+        hogwild.local_param_merge_period = self._local_param_merge_period
         if self._infer:
             # just ignore feed op for inference model
             trainer_desc.hogwild_param.skip_ops.extend(["feed"])
@@ -178,6 +196,8 @@ class DownpourSGD(DeviceWorker):
         if opt_info["stat_var_names"]:
             for i in opt_info["stat_var_names"]:
                 downpour.stat_var_names.extend([i])
+        downpour.pipeline_pull = opt_info.get("pipeline_pull", False)
+        downpour.max_push_staleness = opt_info.get("max_push_staleness", -1)
 
         for i in worker.get_desc().dense_table:
             if i.table_id in dense_table_set:
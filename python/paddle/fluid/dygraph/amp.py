@@ -0,0 +1,229 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import math
+from ..wrapped_decorator import signature_safe_contextmanager
+from .. import core
+from .. import framework
+from .. import layers
+from ..framework import dygraph_only
+
+__all__ = ['amp_guard', 'AmpScaler']
+
+
+@signature_safe_contextmanager
+def amp_guard(enable=True, custom_white_list=None, custom_black_list=None):
+    """
+    The ops run under this guard use the automatic mixed precision. The
+    float32 inputs of the ops on the white list, e.g., conv2d, matmul and mul,
+    are cast to float16 if the op has a float16 kernel for the place, and the
+    float16 inputs of the ops on the black list, e.g., softmax and mean, are
+    cast to float32. The other ops run in float32 if they have both float16
+    and float32 inputs. The float16 copies of the parameters are cached until
+    the parameters are updated, and the gradients flow back to the float32
+    parameters.
+
+    The lists are the same as the ones of the static graph, see
+    ``fluid.contrib.mixed_precision.AutoMixedPrecisionLists``. It is usually
+    used with ``AmpScaler`` to scale the loss.
+
+    Args:
+        enable(bool, optional): Whether to enable the automatic mixed
+            precision. Default: True.
+        custom_white_list(set, optional): The ops added to the white list.
+            Default: None.
+        custom_black_list(set, optional): The ops added to the black list.
+            Default: None.
+
+    Examples:
+
+     .. code-block:: python
+
+        import numpy as np
+        import paddle.fluid as fluid
+
+        with fluid.dygraph.guard(fluid.CUDAPlace(0)):
+            x = fluid.dygraph.to_variable(
+                np.random.random([4, 32]).astype('float32'))
+            linear = fluid.Linear(32, 64)
+            with fluid.dygraph.amp_guard():
+                # The mul of linear runs in float16.
+                out = linear(x)
+            print(out.dtype)
+    """
+    # Import here to avoid importing the static graph modules in dygraph.
+    from ..contrib.mixed_precision.fp16_lists import AutoMixedPrecisionLists
+
+    tracer = framework._dygraph_tracer()
+    if tracer:
+        amp_lists = AutoMixedPrecisionLists(custom_white_list,
+                                            custom_black_list)
+        enabled = tracer._enable_auto_cast
+        op_lists = tracer._get_amp_op_list()
+        tracer._set_amp_op_list(amp_lists.white_list, amp_lists.black_list)
+        tracer._enable_auto_cast = enable
+    try:
+        yield
+    finally:
+        if tracer:
+            tracer._enable_auto_cast = enabled
+            tracer._set_amp_op_list(*op_lists)
+
+
+class AmpScaler(object):
+    """
+    Scales the loss for the automatic mixed precision, so that the small
+    gradients do not underflow in float16. The gradients are unscaled before
+    the parameters are updated, and the update is skipped if any of the
+    gradients is infinite or NAN. With the dynamic loss scaling, the loss
+    scaling decreases after ``decr_every_n_nan_or_inf`` steps with infinite
+    gradients, and increases after ``incr_every_n_steps`` steps with finite
+    gradients in a row.
+
+    Args:
+        init_loss_scaling(float, optional): The initial loss scaling.
+            Default: 2 ** 15.
+        use_dynamic_loss_scaling(bool, optional): Whether to use the dynamic
+            loss scaling. Default: True.
+        incr_every_n_steps(int, optional): Increases the loss scaling every n
+            consecutive steps with finite gradients. Default: 1000.
+        decr_every_n_nan_or_inf(int, optional): Decreases the loss scaling
+            every n accumulated steps with infinite gradients. Default: 2.
+        incr_ratio(float, optional): The multiplier to increase the loss
+            scaling. Default: 2.0.
+        decr_ratio(float, optional): The less-than-one multiplier to decrease
+            the loss scaling. Default: 0.5.
+
+    Examples:
+
+     .. code-block:: python
+
+        import numpy as np
+        import paddle.fluid as fluid
+
+        with fluid.dygraph.guard(fluid.CUDAPlace(0)):
+            x = fluid.dygraph.to_variable(
+                np.random.random([4, 32]).astype('float32'))
+            linear = fluid.Linear(32, 64)
+            sgd = fluid.optimizer.SGD(
+                learning_rate=0.01, parameter_list=linear.parameters())
+            scaler = fluid.dygraph.AmpScaler()
+            with fluid.dygraph.amp_guard():
+                loss = fluid.layers.reduce_mean(linear(x))
+            scaled_loss = scaler.scale(loss)
+            scaled_loss.backward()
+            scaler.minimize(sgd, scaled_loss)
+            linear.clear_gradients()
+    """
+
+    @dygraph_only
+    def __init__(self,
+                 init_loss_scaling=2.**15,
+                 use_dynamic_loss_scaling=True,
+                 incr_every_n_steps=1000,
+                 decr_every_n_nan_or_inf=2,
+                 incr_ratio=2.0,
+                 decr_ratio=0.5):
+        assert incr_ratio > 1.0, "The incr_ratio must be > 1.0."
+        assert decr_ratio < 1.0, "The decr_ratio must be < 1.0."
+        self._loss_scaling = float(init_loss_scaling)
+        self._use_dynamic_loss_scaling = use_dynamic_loss_scaling
+        self._incr_every_n_steps = incr_every_n_steps
+        self._decr_every_n_nan_or_inf = decr_every_n_nan_or_inf
+        self._incr_ratio = incr_ratio
+        self._decr_ratio = decr_ratio
+        self._num_good_steps = 0
+        self._num_bad_steps = 0
+
+    def get_loss_scaling(self):
+        """Return the current loss scaling."""
+        return self._loss_scaling
+
+    def scale(self, var):
+        """
+        Return the var multiplied by the loss scaling.
+
+        Args:
+            var(Variable): The loss to scale.
+        """
+        return layers.scale(var, scale=self._loss_scaling)
+
+    def minimize(self, optimizer, scaled_loss, grad_clip=None):
+        """
+        Unscale the gradients of the scaled loss, and update the parameters
+        by the optimizer if all the gradients are finite.
+
+        Args:
+            optimizer(Optimizer): The optimizer to update the parameters.
+            scaled_loss(Variable): The loss returned by ``scale``, whose
+                ``backward()`` has run.
+            grad_clip(GradClipBase, optional): The gradient clipping strategy
+                applied to the unscaled gradients. Default: None.
+
+        Returns:
+            tuple: tuple (optimize_ops, params_grads), ``optimize_ops`` is
+            empty if the update is skipped.
+        """
+        params_grads = optimizer.backward(scaled_loss)
+        grads = [g for _, g in params_grads]
+        tracer = framework._dygraph_tracer()
+        for g in grads:
+            tracer.trace_op(
+                type='scale',
+                inputs={'X': [g]},
+                outputs={'Out': [g]},
+                attrs={'scale': 1.0 / self._loss_scaling},
+                stop_gradient=True)
+
+        if self._use_dynamic_loss_scaling:
+            is_finite = self._is_finite(grads)
+            self._update_loss_scaling(is_finite)
+            if not is_finite:
+                return [], params_grads
+
+        if grad_clip is not None:
+            params_grads = grad_clip(params_grads)
+        optimize_ops = optimizer.apply_optimize(
+            scaled_loss, startup_program=None, params_grads=params_grads)
+        return optimize_ops, params_grads
+
+    def _is_finite(self, grads):
+        if not grads:
+            return True
+        grad_sums = []
+        for g in grads:
+            if g.type == core.VarDesc.VarType.SELECTED_ROWS:
+                g = layers.get_tensor_from_selected_rows(g)
+            grad_sums.append(layers.reduce_sum(g))
+        # The values are read once for all the gradients.
+        return bool(layers.isfinite(layers.sums(grad_sums)).numpy()[0])
+
+    def _update_loss_scaling(self, is_finite):
+        if is_finite:
+            self._num_good_steps += 1
+            self._num_bad_steps = 0
+            if self._num_good_steps >= self._incr_every_n_steps:
+                new_loss_scaling = self._loss_scaling * self._incr_ratio
+                if not math.isinf(new_loss_scaling):
+                    self._loss_scaling = new_loss_scaling
+                self._num_good_steps = 0
+        else:
+            self._num_bad_steps += 1
+            self._num_good_steps = 0
+            if self._num_bad_steps >= self._decr_every_n_nan_or_inf:
+                self._loss_scaling = max(
+                    self._loss_scaling * self._decr_ratio, 1.0)
+                self._num_bad_steps = 0
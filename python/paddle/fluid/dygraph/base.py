@@ -23,6 +23,8 @@ import objgraph
 
 __all__ = [
     'no_grad',
+    'recompute_guard',
+    'elementwise_fusion_guard',
     'grad',
     'guard',
     'enable_dygraph',
@@ -186,6 +188,92 @@ no_grad = wrap_decorator(_no_grad_)
 no_grad.__doc__ = _no_grad_.__doc__
 
 
+@signature_safe_contextmanager
+def recompute_guard():
+    """
+    The forward ops run under this guard make a recompute segment. At the
+    end of the guard, the tensors of the variables generated in the segment
+    and not referenced any more are released, and the backward runs the
+    forward ops of the segment again to regenerate them just before their
+    gradients are computed. The random ops, e.g., dropout, generate the same
+    values when recomputed. It saves the memory of the activations of the
+    selected layers at the cost of running their forward twice.
+
+    The recompute segments can not be nested.
+
+    Examples:
+
+     .. code-block:: python
+
+        import numpy as np
+        import paddle.fluid as fluid
+
+        with fluid.dygraph.guard():
+            inp = fluid.dygraph.to_variable(
+                np.random.random([4, 32]).astype('float32'))
+            linear1 = fluid.Linear(32, 64, act='relu')
+            linear2 = fluid.Linear(64, 32)
+            with fluid.dygraph.recompute_guard():
+                # Only inp and out are kept during the forward.
+                out = linear2(fluid.layers.dropout(linear1(inp), 0.1))
+            loss = fluid.layers.reduce_mean(out)
+            loss.backward()
+    """
+    tracer = framework._dygraph_tracer()
+    if tracer:
+        tracer._begin_recompute()
+    try:
+        yield
+    finally:
+        if tracer:
+            tracer._end_recompute()
+
+
+@signature_safe_contextmanager
+def elementwise_fusion_guard():
+    """
+    The elementwise ops run under this guard, e.g., elementwise_add,
+    elementwise_mul and relu, are deferred until an op of another type runs
+    or the value of a variable is read, e.g., by ``numpy()`` or ``backward()``.
+    Then the chain of the deferred ops runs by one kernel generated and
+    compiled for it, and the intermediate variables not referenced any more
+    are not written. The kernels are cached for the chains of the same ops.
+
+    The inputs of the chain should have the same shape and data type, float32
+    or float64, except the ``y`` of the binary ops broadcast along the
+    trailing dims, e.g., a bias. The ops which do not match run as usual. It
+    is not supported on Windows and MacOS now.
+
+    Examples:
+
+     .. code-block:: python
+
+        import numpy as np
+        import paddle.fluid as fluid
+
+        with fluid.dygraph.guard():
+            x = fluid.dygraph.to_variable(
+                np.random.random([4, 32]).astype('float32'))
+            w = fluid.dygraph.to_variable(
+                np.random.random([4, 32]).astype('float32'))
+            b = fluid.dygraph.to_variable(
+                np.random.random([32]).astype('float32'))
+            with fluid.dygraph.elementwise_fusion_guard():
+                # The three ops run by one kernel.
+                out = fluid.layers.relu(x * w + b)
+            print(out.numpy())
+    """
+    tracer = framework._dygraph_tracer()
+    enabled = tracer._enable_elementwise_fusion if tracer else False
+    if tracer:
+        tracer._enable_elementwise_fusion = True
+    try:
+        yield
+    finally:
+        if tracer:
+            tracer._enable_elementwise_fusion = enabled
+
+
 @signature_safe_contextmanager
 def guard(place=None):
     """
@@ -15,7 +15,7 @@
 from __future__ import print_function
 
 __all__ = [
-    'TracedLayer', 'dygraph_to_static_code', 'dygraph_to_static_func',
+    'TracedLayer', 'CompiledStep', 'dygraph_to_static_code', 'dygraph_to_static_func',
     'dygraph_to_static_output', 'dygraph_to_static_program'
 ]
 
@@ -25,9 +25,9 @@ from ..wrapped_decorator import wrap_decorator
 from .base import program_desc_tracing_guard, switch_to_static_graph
 from .layers import Layer
 from paddle.fluid import core
-from paddle.fluid.framework import Program, Block, Variable, _dygraph_tracer, dygraph_only, _dygraph_guard, _current_expected_place, in_dygraph_mode
+from paddle.fluid.framework import Program, Block, Variable, Parameter, _dygraph_tracer, dygraph_only, _dygraph_guard, _current_expected_place, in_dygraph_mode, program_guard
 from paddle.fluid.executor import Executor, scope_guard
-from paddle.fluid.compiler import CompiledProgram
+from paddle.fluid.compiler import CompiledProgram, BuildStrategy
 from paddle.fluid.dygraph.dygraph_to_static.program_translator import ProgramTranslator
 
 
@@ -411,3 +411,187 @@ class TracedLayer(object):
                 target_vars=target_vars,
                 executor=self._exe,
                 main_program=self._program.clone())
+
+
+class CompiledStep(object):
+    """
+    CompiledStep is used to run the training steps of a dygraph model as a
+    static graph model. The first call traces the forward of the model into
+    a static graph model, appends the backward and the optimization to it,
+    and runs it using :code:`CompiledProgram` , which applies the fuse and
+    the memory optimization passes of :code:`BuildStrategy` to it. The
+    following calls run the cached static graph model, so the inputs should
+    be of the same shapes and data types as the traced ones.
+
+    The static graph model shares parameters with the dygraph model, so the
+    dygraph model can be evaluated or saved with the trained parameters
+    directly. The first output of the layer should be the loss to minimize,
+    whose shape is [1].
+
+    The optimizer should only be used by the CompiledStep, since the states
+    of the optimizer, e.g., the velocity of Momentum, are kept by the static
+    graph model. Only the optimizers of float learning rates are supported.
+
+    Like TracedLayer, CompiledStep can only be used to train the
+    data-independent dygraph models.
+
+    Args:
+        layer (dygraph.Layer): the layer object to train.
+        optimizer (Optimizer): the optimizer to minimize the loss.
+        build_strategy (BuildStrategy, optional): build strategy of
+            :code:`CompiledProgram` inside CompiledStep. If None, the
+            element-wise add and activation ops are fused, and the memory is
+            optimized by the inplace and the memory reuse passes. Default None.
+        exec_strategy (ExecutionStrategy, optional): execution strategy of
+            :code:`CompiledProgram` inside CompiledStep. Default None.
+
+    Examples:
+        .. code-block:: python:
+
+            import paddle.fluid as fluid
+            from paddle.fluid.dygraph import Linear, to_variable, CompiledStep
+            import numpy as np
+
+            class ExampleLayer(fluid.dygraph.Layer):
+                def __init__(self):
+                    super(ExampleLayer, self).__init__()
+                    self._fc = Linear(3, 10)
+
+                def forward(self, input):
+                    return fluid.layers.reduce_mean(self._fc(input))
+
+            with fluid.dygraph.guard():
+                layer = ExampleLayer()
+                sgd = fluid.optimizer.SGD(learning_rate=1e-3,
+                                          parameter_list=layer.parameters())
+                step = CompiledStep(layer, sgd)
+                for _ in range(10):
+                    in_np = np.random.random([2, 3]).astype('float32')
+                    loss, = step([to_variable(in_np)])
+    """
+
+    @dygraph_only
+    def __init__(self,
+                 layer,
+                 optimizer,
+                 build_strategy=None,
+                 exec_strategy=None):
+        assert isinstance(layer, Layer)
+        self._layer = layer
+        self._optimizer = optimizer
+        if build_strategy is None:
+            build_strategy = BuildStrategy()
+            build_strategy.fuse_elewise_add_act_ops = True
+            build_strategy.enable_inplace = True
+            build_strategy.memory_optimize = True
+        self._build_strategy = build_strategy
+        self._exec_strategy = exec_strategy
+
+        self._place = _current_expected_place()
+        self._exe = Executor(self._place)
+        self._scope = core.Scope()
+        self._program = None
+        self._compiled_program = None
+        self._input_signature = None
+
+    @property
+    def program(self):
+        return self._program
+
+    @staticmethod
+    def _signature(inputs):
+        return [(tuple(x.shape), x.dtype) for x in inputs]
+
+    def _trace(self, inputs):
+        _, program, self._feed_names, self._fetch_names, persistables = _trace(
+            self._layer, inputs)
+        self._program = program
+        for p in persistables:
+            src_tensor = p.value().get_tensor()
+            dst_tensor = self._scope.var(p.name).get_tensor()
+            dst_tensor._share_data_with(src_tensor)
+
+        traced_names = set(p.name for p in persistables)
+        parameters = [
+            p for p in self._layer.parameters()
+            if p.trainable and p.name in traced_names
+        ]
+        self._append_optimization(parameters)
+
+    @switch_to_static_graph
+    def _append_optimization(self, parameters):
+        block = self._program.global_block()
+        # The traced parameters are plain variables of the program.
+        for p in parameters:
+            v = block.var(p.name)
+            block.vars[p.name] = Parameter(
+                block=block,
+                shape=v.shape,
+                dtype=v.dtype,
+                type=v.type,
+                lod_level=v.lod_level,
+                stop_gradient=p.stop_gradient,
+                trainable=p.trainable,
+                optimize_attr=p.optimize_attr,
+                regularizer=p.regularizer,
+                gradient_clip_attr=p.gradient_clip_attr,
+                do_model_average=p.do_model_average,
+                name=v.name)
+
+        loss = block.var(self._fetch_names[0])
+        startup_program = Program()
+        with program_guard(self._program, startup_program):
+            self._optimizer.minimize(
+                loss,
+                startup_program=startup_program,
+                parameter_list=[p.name for p in parameters])
+        # Only the states of the optimizer are initialized by the startup
+        # program, since the parameters are shared with the dygraph model.
+        self._exe.run(startup_program)
+
+        self._compiled_program = CompiledProgram(
+            self._program).with_data_parallel(
+                loss_name=loss.name,
+                build_strategy=self._build_strategy,
+                exec_strategy=self._exec_strategy,
+                places=self._place)
+
+    def _build_feed(self, inputs):
+        assert len(inputs) == len(self._feed_names)
+        feed_dict = {}
+        for x, name in zip(inputs, self._feed_names):
+            feed_dict[name] = x.value().get_tensor()
+        return feed_dict
+
+    @switch_to_static_graph
+    def _run(self, feed):
+        return self._exe.run(self._compiled_program,
+                             feed=feed,
+                             fetch_list=self._fetch_names)
+
+    @dygraph_only
+    def __call__(self, inputs):
+        """
+        Run a training step of the layer.
+
+        Args:
+            inputs (list(Variable)): the input variables of the layer object.
+
+        Returns:
+            list(numpy.ndarray): the outputs of the layer, whose first item
+            is the loss.
+        """
+        if not isinstance(inputs, (list, tuple)):
+            inputs = [inputs]
+        signature = self._signature(inputs)
+        with scope_guard(self._scope):
+            if self._compiled_program is None:
+                self._trace(inputs)
+                self._input_signature = signature
+            elif signature != self._input_signature:
+                raise ValueError(
+                    "The inputs of CompiledStep should be of the shapes and "
+                    "data types {} of the traced inputs, but received {}".
+                    format(self._input_signature, signature))
+
+            return self._run(self._build_feed(inputs))
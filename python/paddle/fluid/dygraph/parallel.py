@@ -233,6 +233,16 @@ class DataParallel(layers.Layer):
         layers(Layer): The module that should be executed by data parallel.
         strategy(ParallelStrategy): The strategy of data parallelism, contains 
             environment configuration related to parallel execution.
+        overlap_all_reduce(bool, optional): Whether to all-reduce the
+            gradients of the parameters by buckets during the backward, as
+            soon as the gradients of a bucket are finished, so that the
+            communication overlaps the backward of the other layers. If it is
+            True, the gradients are all-reduced when the backward returns,
+            and :code:`apply_collective_grads` does nothing. Only the dense
+            gradients on CUDA places are supported. Default: False.
+        bucket_mega_bytes(int, optional): The size of the buckets of the
+            gradients all-reduced together when :code:`overlap_all_reduce`
+            is True. Default: 25.
 
     Returns:
         Layer: The data paralleled module.
@@ -277,14 +287,31 @@ class DataParallel(layers.Layer):
                linear.clear_gradients()
     """
 
-    def __init__(self, layers, strategy):
+    def __init__(self,
+                 layers,
+                 strategy,
+                 overlap_all_reduce=False,
+                 bucket_mega_bytes=25):
         super(DataParallel,
               self).__init__(layers.full_name() + "_data_parallel")
 
         self._layers = layers
         self._strategy = strategy
+        self._overlap_all_reduce = overlap_all_reduce
+        self._bucket_bytes = int(bucket_mega_bytes * 1024 * 1024)
+        self._reducer = None
 
     def forward(self, *inputs, **kwargs):
+        if self._overlap_all_reduce and self._is_data_parallel_mode():
+            # The reducer observes the gradients of the next backward.
+            if self._reducer is None:
+                place = framework._current_expected_place()
+                assert isinstance(place, core.CUDAPlace), \
+                    "overlap_all_reduce only supports CUDAPlace"
+                params = [p for p in self._layers.parameters() if p.trainable]
+                self._reducer = core.Reducer(params, self._bucket_bytes,
+                                             place)
+            framework._dygraph_tracer()._set_gradient_hook(self._reducer)
         return self._layers(*inputs, **kwargs)
 
     def scale_loss(self, loss):
@@ -415,6 +442,9 @@ class DataParallel(layers.Layer):
         """
         if not self._is_data_parallel_mode():
             return
+        if self._reducer is not None:
+            # The gradients are all-reduced by the backward.
+            return
 
         grad_var_set = set()
         grad_vars = []
@@ -543,7 +543,7 @@ def dtype_is_floating(dtype):
 
     return dtype in [
         core.VarDesc.VarType.FP16, core.VarDesc.VarType.FP32,
-        core.VarDesc.VarType.FP64
+        core.VarDesc.VarType.FP64, core.VarDesc.VarType.BF16
     ]
 
 
@@ -139,11 +139,12 @@ class DistributedStrategy(fluid.BuildStrategy):
     def __init__(self):
         super(DistributedStrategy, self).__init__()
         self.use_local_sgd = False
+        self.use_sharded_optimizer = False
         self.use_dist_fc = False
 
         self.dist_fc_config = None  # DistFCConfig
         self.mode = "nccl2"  # or collective
-        self.collective_mode = None  # local_sgd or grad_allreduce
+        self.collective_mode = None  # local_sgd, sharded_optimizer or grad_allreduce
         self.nccl_comm_num = 1
         self.forward_recompute = False
         self.recompute_checkpoints = []
@@ -231,6 +232,16 @@ class CollectiveOptimizer(DistributedOptimizer):
                 use_dist_fc=strategy.use_dist_fc,
                 use_lamb=main_program._use_lamb)
 
+        if strategy.use_sharded_optimizer:
+            strategy.mode = "collective"
+            strategy.collective_mode = "sharded_optimizer"
+            self._check_condition(
+                "use_sharded_optimizer",
+                use_dgc=main_program._enable_dgc,
+                use_local_sgd=strategy.use_local_sgd,
+                use_dist_fc=strategy.use_dist_fc,
+                use_lamb=main_program._use_lamb)
+
         if strategy.use_dist_fc:
             self._check_condition(
                 "use_dist_fc",
@@ -248,9 +259,10 @@ class CollectiveOptimizer(DistributedOptimizer):
                 use_lamb=main_program._use_lamb)
 
         if self._strategy.collective_mode=="local_sgd" \
+                or self._strategy.collective_mode == "sharded_optimizer" \
                 or self._strategy.collective_mode == "grad_allreduce":
             assert self._strategy.mode == "collective", \
-                "local_sgd and grad_allreduce can be used under collective mode"
+                "local_sgd, sharded_optimizer and grad_allreduce can be used under collective mode"
 
     def _transpile(self, startup_program, main_program):
         """
@@ -44,6 +44,23 @@ class TrainerRuntimeConfig(object):
             "FLAGS_communicator_send_wait_times", "5")
         self.runtime_configs['communicator_is_sgd_optimizer'] = os.getenv(
             "FLAGS_communicator_is_sgd_optimizer", "1")
+        # tune the merge number and the send concurrency from the measured
+        # queue depth, rpc latency and bandwidth instead of the flags above
+        self.runtime_configs['communicator_adaptive_send'] = os.getenv(
+            "FLAGS_communicator_adaptive_send", "0")
+        # none, fp16 or int8
+        self.runtime_configs['communicator_grad_compression'] = os.getenv(
+            "FLAGS_communicator_grad_compression", "none")
+        # the dense gradients and parameters of the trainers on a host are
+        # aggregated over the shared memory named by the aggregation name,
+        # and only the local rank 0 communicates with the pservers
+        self.runtime_configs['communicator_local_trainers'] = os.getenv(
+            "FLAGS_communicator_local_trainers", "1")
+        self.runtime_configs['communicator_local_rank'] = os.getenv(
+            "FLAGS_communicator_local_rank", "0")
+        self.runtime_configs[
+            'communicator_host_aggregation_name'] = os.getenv(
+                "FLAGS_communicator_host_aggregation_name", "")
 
         # not used 
         self.runtime_configs['rpc_deadline'] = os.getenv("FLAGS_rpc_deadline",
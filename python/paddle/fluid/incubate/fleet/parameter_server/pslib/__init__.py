@@ -298,6 +298,58 @@ class PSLib(Fleet):
             self._fleet_ptr.save_model(dirname, mode)
         self._role_maker._barrier_worker()
 
+    def save_persistables_async(self, dirname, **kwargs):
+        """
+        save pslib model in the background, the training goes on while the
+        pservers save the tables, call wait_save_persistables to wait for it.
+
+        Args:
+            dirname(str): save path. It can be hdfs/afs path or local path
+            kwargs: use define property, current support following
+                mode(int): save mode, same as save_persistables, default 0
+                table_ids(list): the table ids to save, all the tables are
+                                 saved by one request if empty, default []
+                parallelism(int): the max number of the tables saved at the
+                                  same time, default 1
+
+        Example:
+            .. code-block:: python
+
+              fleet.save_persistables_async("/you/path/to/model",
+                                            table_ids=[0, 1], parallelism=2)
+              # train some batches
+              fleet.wait_save_persistables()
+
+        """
+        mode = kwargs.get("mode", 0)
+        table_ids = kwargs.get("table_ids", [])
+        parallelism = kwargs.get("parallelism", 1)
+        self._fleet_ptr.client_flush()
+        self._role_maker._barrier_worker()
+        if self._role_maker.is_first_worker():
+            self._fleet_ptr.save_model_async(dirname, mode, table_ids,
+                                             parallelism)
+
+    def wait_save_persistables(self):
+        """
+        wait for the model saved by save_persistables_async
+
+        Returns:
+            feasign_num(int): the number of the feasigns saved, 0 for the
+                              workers except the first one
+
+        Example:
+            .. code-block:: python
+
+              feasign_num = fleet.wait_save_persistables()
+
+        """
+        feasign_num = 0
+        if self._role_maker.is_first_worker():
+            feasign_num = self._fleet_ptr.wait_save_model()
+        self._role_maker._barrier_worker()
+        return feasign_num
+
     def save_cache_model(self, executor, dirname, main_program=None, **kwargs):
         """
         save sparse cache table,
@@ -449,6 +501,30 @@ class PSLib(Fleet):
             self._fleet_ptr.clear_model()
         self._role_maker._barrier_worker()
 
+    def load_tables(self, table_ids, model_path, **kwargs):
+        """
+        load pslib model for the tables in parallel, the load requests of all
+        the tables are sent before waiting for any of them
+
+        Args:
+            table_ids(list): load table ids
+            model_path(str): load model path, can be local or hdfs/afs path
+            kwargs(dict): user defined params, currently support following:
+                mode(int): load model mode. 0 is for load whole model, 1 is
+                           for load delta model (load diff), default is 0.
+
+        Examples:
+            .. code-block:: python
+
+              fleet.load_tables([0, 1], "hdfs:/my_fleet_model/20190714/0/")
+
+        """
+        mode = kwargs.get("mode", 0)
+        self._role_maker._barrier_worker()
+        if self._role_maker.is_first_worker():
+            self._fleet_ptr.load_model_tables(table_ids, model_path, mode)
+        self._role_maker._barrier_worker()
+
     def load_one_table(self, table_id, model_path, **kwargs):
         """
         load pslib model for one table or load params from paddle model
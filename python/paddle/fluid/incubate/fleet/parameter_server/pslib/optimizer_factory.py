@@ -405,6 +405,8 @@ class DistributedAdam(DistributedOptimizerImplBase):
         opt_info["use_cvm"] = strategy.get("use_cvm", False)
         opt_info["no_cvm"] = strategy.get("no_cvm", False)
         opt_info["stat_var_names"] = strategy.get("stat_var_names", [])
+        opt_info["pipeline_pull"] = strategy.get("pipeline_pull", False)
+        opt_info["max_push_staleness"] = strategy.get("max_push_staleness", -1)
         opt_info["local_tables"] = strategy.get("local_tables", [])
         opt_info["async_tables"] = strategy.get("async_tables", [])
         opt_info["async_tables"] = strategy.get("async_tables", [])
@@ -15,6 +15,7 @@
 from __future__ import print_function
 
 import os
+import atexit
 import errno
 import warnings
 import six
@@ -46,6 +47,7 @@ __all__ = [
     'save_vars',
     'save_params',
     'save_persistables',
+    'wait_async_save',
     'load_vars',
     'load_params',
     'load_persistables',
@@ -210,7 +212,8 @@ def save_vars(executor,
               main_program=None,
               vars=None,
               predicate=None,
-              filename=None):
+              filename=None,
+              async_save=False):
     """
     This API saves specific variables in the `Program` to files.
 
@@ -238,6 +241,12 @@ def save_vars(executor,
         filename(str, optional): If you prefer to save all variables in a single file,
                                  use `filename` to specify it. Otherwise, let `filename` be None. 
                                  Default: None
+        async_save(bool, optional): If True, the variables are copied to the host memory
+                                    and written in the background, so that the training
+                                    is not stalled by the writing. Call
+                                    :code:`fluid.io.wait_async_save` to wait for the writing.
+                                    Only LoDTensors can be saved asynchronously.
+                                    Default: False
 
     Returns:
         None
@@ -286,7 +295,8 @@ def save_vars(executor,
             main_program=main_program,
             dirname=save_dirname,
             vars=list(filter(predicate, main_program.list_vars())),
-            filename=filename)
+            filename=filename,
+            async_save=async_save)
     else:
         # give warning when there is no var in model
         if len(list(vars)) == 0:
@@ -311,7 +321,8 @@ def save_vars(executor,
                     type='save',
                     inputs={'X': [new_var]},
                     outputs={},
-                    attrs={'file_path': save_file_path})
+                    attrs={'file_path': save_file_path,
+                           'async': async_save})
             else:
                 save_var_map[new_var.name] = new_var
 
@@ -324,7 +335,10 @@ def save_vars(executor,
                 type='save_combine',
                 inputs={'X': save_var_list},
                 outputs={},
-                attrs={'file_path': os.path.join(save_dirname, filename)})
+                attrs={
+                    'file_path': os.path.join(save_dirname, filename),
+                    'async': async_save
+                })
 
         #NOTE(zhiqiu): save op will add variable kLookupTablePath in save_program.desc,
         # which leads to diff on save_program and its desc. Call _sync_with_cpp
@@ -402,7 +416,10 @@ def save_params(executor, dirname, main_program=None, filename=None):
         filename=filename)
 
 
-def _save_distributed_persistables(executor, dirname, main_program):
+def _save_distributed_persistables(executor,
+                                   dirname,
+                                   main_program,
+                                   lookup_table_delta=False):
     """
     save_persistables for distributed training.
     the method will do things listed below:
@@ -417,6 +434,11 @@ def _save_distributed_persistables(executor, dirname, main_program):
         main_program(Program): The program whose parameters will be
                             saved. the main_program must be the trainer_program
                             get after transpiler.
+        lookup_table_delta(bool): Whether to save only the rows of the
+                            distributed lookup table updated since the last
+                            save. The deltas are merged into the last full
+                            save by the loader, see
+                            load_persistables_for_increment. Default: False.
 
     Returns:
         None
@@ -485,13 +507,16 @@ def _save_distributed_persistables(executor, dirname, main_program):
         executor.run(prog)
 
     def __save_distributed_lookup_tables(executor, dirname,
-                                         distributed_lookup_table, endpoints):
+                                         distributed_lookup_table, endpoints,
+                                         delta):
         """
         because the distributed lookup table may too huge to merge and save at one place,
         it will be saved at parameter server independent respectively.
 
         the save directory is dirname/"__lookup_table__".
 
+        if delta is True, only the rows updated since the last save are saved.
+
         """
         prog = Program()
         block = prog.global_block()
@@ -502,6 +527,7 @@ def _save_distributed_persistables(executor, dirname, main_program):
         attrs['epmap'] = endpoints
         attrs['dir'] = lookup_table_filename
         attrs['lookup_table'] = distributed_lookup_table
+        attrs['delta'] = delta
         block.append_op(
             type='checkpoint_notify', inputs={}, outputs={}, attrs=attrs)
         executor.run(prog)
@@ -550,10 +576,14 @@ def _save_distributed_persistables(executor, dirname, main_program):
         if main_program._distributed_lookup_table:
             __save_distributed_lookup_tables(
                 executor, dirname, main_program._distributed_lookup_table,
-                main_program._endpoints)
+                main_program._endpoints, lookup_table_delta)
 
 
-def save_persistables(executor, dirname, main_program=None, filename=None):
+def save_persistables(executor,
+                      dirname,
+                      main_program=None,
+                      filename=None,
+                      async_save=False):
     """
     This operator saves all persistable variables from :code:`main_program` to 
     the folder :code:`dirname` or file :code:`filename`. You can refer to 
@@ -580,6 +610,11 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
         filename(str, optional): The file to save all variables. If you prefer to
                                  save variables in different files, set it to None.
                                  Default: None.
+        async_save(bool, optional): If True, the persistables are copied to the host
+                                    memory and written in the background, see
+                                    :code:`fluid.io.save_vars`. It is ignored for the
+                                    distributed programs.
+                                    Default: False.
 
     Returns:
         None
@@ -615,7 +650,34 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
             main_program=main_program,
             vars=None,
             predicate=is_persistable,
-            filename=filename)
+            filename=filename,
+            async_save=async_save)
+
+
+def wait_async_save():
+    """
+    Wait for the variables saved with :code:`async_save=True` to be written.
+    The errors of writing them are raised here. The load APIs wait for the
+    writing automatically, and it is called at the exit of the process.
+
+    Returns:
+        None
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(fluid.default_startup_program())
+            fluid.io.save_persistables(exe, "./my_paddle_model", async_save=True)
+            # continue the training, then
+            fluid.io.wait_async_save()
+    """
+    core.wait_async_checkpoints()
+
+
+atexit.register(wait_async_save)
 
 
 def load_vars(executor,
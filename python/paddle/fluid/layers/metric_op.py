@@ -113,7 +113,8 @@ def auc(input,
         curve='ROC',
         num_thresholds=2**12 - 1,
         topk=1,
-        slide_steps=1):
+        slide_steps=1,
+        accumulate_only=False):
     """
     **Area Under the Curve (AUC) Layer**
 
@@ -143,6 +144,14 @@ def auc(input,
                              the roc curve. Default 200.
         topk(int): only topk number of prediction output will be used for auc.
         slide_steps: when calc batch auc, we can not only use step currently but the previous steps can be used. slide_steps=1 means use the current step, slide_steps=3 means use current step and the previous second steps, slide_steps=0 use all of the steps.
+        accumulate_only(bool): only accumulate the statistics in each step
+                         without computing auc_out and batch_auc_out, so that
+                         the statistics are kept on the device and the steps
+                         need not wait for the AUC. The AUC is then computed
+                         from stat_pos and stat_neg when needed, e.g. by
+                         FleetUtil.get_global_auc at the end of a pass, which
+                         all-reduces the statistics of the trainers.
+                         Default False.
 
 
     Returns:
@@ -218,7 +227,8 @@ def auc(input,
         attrs={
             "curve": curve,
             "num_thresholds": num_thresholds,
-            "slide_steps": slide_steps
+            "slide_steps": slide_steps,
+            "accumulate_only": accumulate_only
         },
         outputs={
             "AUC": [batch_auc_out],
@@ -237,7 +247,8 @@ def auc(input,
         attrs={
             "curve": curve,
             "num_thresholds": num_thresholds,
-            "slide_steps": 0
+            "slide_steps": 0,
+            "accumulate_only": accumulate_only
         },
         outputs={
             "AUC": [auc_out],
@@ -49,6 +49,7 @@ __all__ = [
     'lstm_unit',
     'lstm',
     'beam_search',
+    'dense_beam_search',
     'beam_search_decode',
 ]
 
@@ -2845,6 +2846,96 @@ def beam_search(pre_ids,
         return selected_ids, selected_scores
 
 
+def dense_beam_search(pre_ids,
+                      pre_scores,
+                      scores,
+                      end_id,
+                      ids=None,
+                      is_accumulated=True,
+                      name=None):
+    """
+    Beam search of one time step on fixed-shape tensors without LoD.
+
+    Every sample keeps ``beam_size`` beams, the second dimension of
+    ``pre_ids`` . The top ``beam_size`` candidates among all the beams of a
+    sample are selected, and the finished beams, whose last id is ``end_id`` ,
+    are only extended with ``end_id`` and keep their scores. Since the shapes
+    never change, the whole decoding loop runs on the device, and the
+    sequences are backtraced by ``gather_tree`` with the
+    returned parent indices.
+
+    At the first step, set the scores of all but the first beam of every
+    sample to -inf, so that the same beam is not selected several times.
+
+    Args:
+        pre_ids(Variable): A Tensor of shape `[batch_size, beam_size]`
+            containing the ids selected at the previous step. The data type
+            should be int64.
+        pre_scores(Variable): A Tensor with the same shape as ``pre_ids`` ,
+            containing the accumulated scores of ``pre_ids`` . The data type
+            should be float32 or float64.
+        scores(Variable): A Tensor of shape `[batch_size, beam_size, K]` or
+            `[batch_size * beam_size, K]` containing the scores of the `K`
+            candidates of every beam. It has the same data type as
+            ``pre_scores`` .
+        end_id(int): The id of end token.
+        ids(Variable, optional): A Tensor with the same shape as ``scores``
+            containing the ids of the candidates, e.g. from
+            ``topk`` . If None, the candidates are the
+            indices in ``scores`` . The data type should be int64. Default
+            None.
+        is_accumulated(bool, optional): Whether ``scores`` are accumulated
+            scores. If False, they are the probabilities of this step and
+            their log is added to ``pre_scores`` . Default True.
+        name(str, optional): For detailed information, please refer
+            to :ref:`api_guide_Name`. Usually name is no need to set and
+            None by default.
+
+    Returns:
+        tuple: The selected ids, their accumulated scores and the indices of \
+            the beams they extend, all of shape `[batch_size, beam_size]` . \
+            The ids and the parent indices are int64.
+
+    Examples:
+        .. code-block:: python
+
+            import paddle.fluid as fluid
+
+            beam_size = 4
+            end_id = 1
+            pre_ids = fluid.data(
+                name='pre_ids', shape=[None, beam_size], dtype='int64')
+            pre_scores = fluid.data(
+                name='pre_scores', shape=[None, beam_size], dtype='float32')
+            log_probs = fluid.data(
+                name='log_probs', shape=[None, beam_size, 10000],
+                dtype='float32')
+            accu_scores = fluid.layers.elementwise_add(
+                log_probs, fluid.layers.unsqueeze(pre_scores, [2]))
+            selected_ids, selected_scores, parent_idx = \
+                fluid.layers.dense_beam_search(
+                    pre_ids, pre_scores, accu_scores, end_id=end_id)
+    """
+    helper = LayerHelper('dense_beam_search', **locals())
+    inputs = {"PreIds": pre_ids, "PreScores": pre_scores, "Scores": scores}
+    if ids is not None:
+        inputs["Ids"] = ids
+    selected_ids = helper.create_variable_for_type_inference(dtype="int64")
+    selected_scores = helper.create_variable_for_type_inference(
+        dtype=pre_scores.dtype)
+    parent_idx = helper.create_variable_for_type_inference(dtype="int64")
+    helper.append_op(
+        type='dense_beam_search',
+        inputs=inputs,
+        outputs={
+            'SelectedIds': selected_ids,
+            'SelectedScores': selected_scores,
+            'ParentIdx': parent_idx
+        },
+        attrs={'end_id': end_id,
+               'is_accumulated': is_accumulated})
+    return selected_ids, selected_scores, parent_idx
+
 def beam_search_decode(ids, scores, beam_size, end_id, name=None):
     """
     This operator is used after beam search has completed. It constructs the
@@ -15,7 +15,7 @@
 from __future__ import print_function
 
 import numpy as np
-from collections import defaultdict
+from collections import defaultdict, OrderedDict
 
 from paddle.fluid.distribute_lookup_table import find_distributed_lookup_table
 from paddle.fluid.framework import Program, Variable, name_scope, default_main_program, default_startup_program, device_guard
@@ -109,6 +109,9 @@ class Optimizer(object):
         self._opti_name_list = []
         self._accumulators_holder = {}
         self._param_device_map = dict()
+        # whether to update the parameters by the merged optimizer op, which
+        # is only supported by the subclasses with _append_merged_optimize_op
+        self._use_multi_tensor = False
 
     @framework.dygraph_only
     def state_dict(self):
@@ -540,6 +543,9 @@ class Optimizer(object):
                 if param_and_grad[0].trainable is True:
                     self._append_optimize_op(target_block, param_and_grad)
         else:
+            if self._use_multi_tensor:
+                parameters_and_grads = self._append_merged_optimize_ops(
+                    target_block, parameters_and_grads)
             for param_and_grad in parameters_and_grads:
                 if param_and_grad[1] is None:
                     continue
@@ -559,6 +565,53 @@ class Optimizer(object):
         end = len(target_block.ops)
         return target_block._slice_ops(start, end)
 
+    def _merged_group_key(self, param):
+        """
+        The key of the group of the parameter updated by one merged optimize
+        op, besides its device and dtype.
+        """
+        return None
+
+    def _append_merged_optimize_ops(self, block, parameters_and_grads):
+        """
+        Append one merged optimize op for each group of the trainable
+        parameters with dense gradients, and return the other parameters and
+        gradients, which are updated by one optimize op for each.
+        """
+        groups = OrderedDict()
+        others = []
+        for param_and_grad in parameters_and_grads:
+            param, grad = param_and_grad
+            if grad is None or param.trainable is not True or \
+                    grad.type != core.VarDesc.VarType.LOD_TENSOR:
+                others.append(param_and_grad)
+                continue
+            key = (self._get_device_for_param(param.name), param.dtype,
+                   self._merged_group_key(param))
+            groups.setdefault(key, []).append(param_and_grad)
+
+        for key, group in groups.items():
+            if len(group) == 1:
+                others.extend(group)
+                continue
+            param_and_grad_names = [
+                var.name for param_and_grad in group for var in param_and_grad
+            ]
+            with block.program._optimized_guard(
+                    param_and_grad_names), name_scope("optimizer"):
+                with device_guard(key[0]):
+                    self._append_merged_optimize_op(block, group)
+        return others
+
+    def _create_merged_param_lrs(self, parameters_and_grads):
+        lrs = [
+            self._create_param_lr(param_and_grad)
+            for param_and_grad in parameters_and_grads
+        ]
+        if all(lr.name == lrs[0].name for lr in lrs):
+            return lrs[:1]
+        return lrs
+
     def _process_distribute_lookuptable(self, param_grads):
         """
         Because distribute lookup table only support SGD optimizer for now, not support
@@ -943,6 +996,9 @@ class MomentumOptimizer(Optimizer):
             Optional, default is None.
         name (str, optional): This parameter is used by developers to print debugging information. \
             For details, please refer to :ref:`api_guide_Name`. Default is None.
+        use_multi_tensor (bool, optional): Whether to update the parameters with dense gradients \
+            by one merged_momentum op in static mode, which updates the separate parameters by \
+            a few kernels on GPU. Default is False.
 
     Examples:
         .. code-block:: python
@@ -981,7 +1037,8 @@ class MomentumOptimizer(Optimizer):
                  parameter_list=None,
                  use_nesterov=False,
                  regularization=None,
-                 name=None):
+                 name=None,
+                 use_multi_tensor=False):
         assert learning_rate is not None
         assert momentum is not None
         super(MomentumOptimizer, self).__init__(
@@ -992,6 +1049,7 @@ class MomentumOptimizer(Optimizer):
         self.type = "momentum"
         self._momentum = momentum
         self._use_nesterov = bool(use_nesterov)
+        self._use_multi_tensor = use_multi_tensor
 
     def _create_accumulators(self, block, parameters):
         assert isinstance(block, framework.Block)
@@ -1035,6 +1093,26 @@ class MomentumOptimizer(Optimizer):
 
         return momentum_op
 
+    def _append_merged_optimize_op(self, block, parameters_and_grads):
+        params = [p for p, _ in parameters_and_grads]
+        velocities = [
+            self._get_accumulator(self._velocity_acc_str, p) for p in params
+        ]
+        return block.append_op(
+            type="merged_momentum",
+            inputs={
+                "Param": params,
+                "Grad": [g for _, g in parameters_and_grads],
+                "Velocity": velocities,
+                "LearningRate":
+                self._create_merged_param_lrs(parameters_and_grads)
+            },
+            outputs={"ParamOut": params,
+                     "VelocityOut": velocities},
+            attrs={"mu": self._momentum,
+                   "use_nesterov": self._use_nesterov},
+            stop_gradient=True)
+
 
 class DGCMomentumOptimizer(Optimizer):
     """
@@ -1464,6 +1542,9 @@ class LarsMomentumOptimizer(Optimizer):
             Optional, default is None.
         name (str, optional): This parameter is used by developers to print debugging information. \
             For details, please refer to :ref:`api_guide_Name`. Default is None.
+        use_multi_tensor (bool, optional): Whether to update the parameters with dense gradients \
+            by one merged_lars_momentum op in static mode, which updates the separate parameters \
+            by a few kernels on GPU. Default is False.
 
     Examples:
         .. code-block:: python
@@ -1494,7 +1575,8 @@ class LarsMomentumOptimizer(Optimizer):
                  lars_weight_decay=0.0005,
                  parameter_list=None,
                  regularization=None,
-                 name=None):
+                 name=None,
+                 use_multi_tensor=False):
         assert learning_rate is not None
         assert momentum is not None
         super(LarsMomentumOptimizer, self).__init__(
@@ -1506,6 +1588,7 @@ class LarsMomentumOptimizer(Optimizer):
         self._momentum = momentum
         self._lars_coeff = float(lars_coeff)
         self._lars_weight_decay = float(lars_weight_decay)
+        self._use_multi_tensor = use_multi_tensor
 
     def _create_accumulators(self, block, parameters):
         assert isinstance(block, framework.Block)
@@ -1540,6 +1623,29 @@ class LarsMomentumOptimizer(Optimizer):
 
         return momentum_op
 
+    def _append_merged_optimize_op(self, block, parameters_and_grads):
+        params = [p for p, _ in parameters_and_grads]
+        velocities = [
+            self._get_accumulator(self._velocity_acc_str, p) for p in params
+        ]
+        return block.append_op(
+            type="merged_lars_momentum",
+            inputs={
+                "Param": params,
+                "Grad": [g for _, g in parameters_and_grads],
+                "Velocity": velocities,
+                "LearningRate":
+                self._create_merged_param_lrs(parameters_and_grads)
+            },
+            outputs={"ParamOut": params,
+                     "VelocityOut": velocities},
+            attrs={
+                "mu": self._momentum,
+                "lars_coeff": self._lars_coeff,
+                "lars_weight_decay": self._lars_weight_decay
+            },
+            stop_gradient=True)
+
 
 class AdagradOptimizer(Optimizer):
     """
@@ -1698,6 +1804,10 @@ class AdamOptimizer(Optimizer):
             gradient in current mini-batch, so it will be much more faster. But this mode has
             different semantics with the original Adam algorithm and may lead to different result.
             The default value is False.
+        use_multi_tensor (bool, optional): Whether to update the parameters with dense gradients
+            by one merged_adam op in static mode, which updates the separate parameters by a few
+            kernels on GPU. It is ignored if beta1 or beta2 is a Variable, or lazy_mode is True.
+            The default value is False.
 
     Examples:
         .. code-block:: python
@@ -1798,7 +1908,8 @@ class AdamOptimizer(Optimizer):
                  parameter_list=None,
                  regularization=None,
                  name=None,
-                 lazy_mode=False):
+                 lazy_mode=False,
+                 use_multi_tensor=False):
         assert learning_rate is not None
         assert beta1 is not None
         assert beta2 is not None
@@ -1813,6 +1924,9 @@ class AdamOptimizer(Optimizer):
         self._beta2 = beta2
         self._epsilon = epsilon
         self._lazy_mode = lazy_mode
+        self._use_multi_tensor = use_multi_tensor and not (
+            lazy_mode or isinstance(beta1, Variable) or
+            isinstance(beta2, Variable))
 
     def _create_accumulators(self, block, parameters):
         assert isinstance(block, framework.Block)
@@ -1904,6 +2018,42 @@ class AdamOptimizer(Optimizer):
 
         return adam_op
 
+    def _append_merged_optimize_op(self, block, parameters_and_grads):
+        params = [p for p, _ in parameters_and_grads]
+        accumulators = {}
+        for acc_str in [
+                self._moment1_acc_str, self._moment2_acc_str,
+                self._beta1_pow_acc_str, self._beta2_pow_acc_str
+        ]:
+            accumulators[acc_str] = [
+                self._get_accumulator(acc_str, p) for p in params
+            ]
+        return block.append_op(
+            type="merged_adam",
+            inputs={
+                "Param": params,
+                "Grad": [g for _, g in parameters_and_grads],
+                "LearningRate":
+                self._create_merged_param_lrs(parameters_and_grads),
+                "Moment1": accumulators[self._moment1_acc_str],
+                "Moment2": accumulators[self._moment2_acc_str],
+                "Beta1Pow": accumulators[self._beta1_pow_acc_str],
+                "Beta2Pow": accumulators[self._beta2_pow_acc_str]
+            },
+            outputs={
+                "ParamOut": params,
+                "Moment1Out": accumulators[self._moment1_acc_str],
+                "Moment2Out": accumulators[self._moment2_acc_str],
+                "Beta1PowOut": accumulators[self._beta1_pow_acc_str],
+                "Beta2PowOut": accumulators[self._beta2_pow_acc_str]
+            },
+            attrs={
+                "beta1": self._beta1,
+                "beta2": self._beta2,
+                "epsilon": self._epsilon
+            },
+            stop_gradient=True)
+
 
 class AdamaxOptimizer(Optimizer):
     """
@@ -2748,6 +2898,10 @@ class LambOptimizer(AdamOptimizer):
             Default None.
         name(str|None): For detailed information, please refer to 
             :ref:`api_guide_Name` . Usually name is no need to set and None by default.
+        use_multi_tensor (bool, optional): Whether to update the parameters with dense
+            gradients by merged_lamb ops in static mode, one for the parameters excluded
+            from weight decay and one for the others, which update the separate parameters
+            by a few kernels on GPU. Default False.
 
     Examples:
         .. code-block:: python
@@ -2780,7 +2934,8 @@ class LambOptimizer(AdamOptimizer):
                  parameter_list=None,
                  regularization=None,
                  exclude_from_weight_decay_fn=None,
-                 name=None):
+                 name=None,
+                 use_multi_tensor=False):
         assert learning_rate is not None
         assert lamb_weight_decay is not None
         assert beta1 is not None
@@ -2793,11 +2948,21 @@ class LambOptimizer(AdamOptimizer):
             beta1=beta1,
             beta2=beta2,
             epsilon=epsilon,
-            name=name)
+            name=name,
+            use_multi_tensor=use_multi_tensor)
         self.type = "lamb"
         self._weight_decay = lamb_weight_decay
         self._exclude_from_weight_decay_fn = exclude_from_weight_decay_fn
 
+    def _weight_decay_of(self, param):
+        if self._exclude_from_weight_decay_fn is not None \
+            and self._exclude_from_weight_decay_fn(param):
+            return 0.0
+        return self._weight_decay
+
+    def _merged_group_key(self, param):
+        return self._weight_decay_of(param)
+
     def _append_optimize_op(self, block, param_and_grad):
         assert isinstance(block, framework.Block)
         block.program._use_lamb = True
@@ -2811,11 +2976,7 @@ class LambOptimizer(AdamOptimizer):
         beta2_pow_acc = self._get_accumulator(self._beta2_pow_acc_str,
                                               param_and_grad[0])
 
-        if self._exclude_from_weight_decay_fn is not None \
-            and self._exclude_from_weight_decay_fn(param_and_grad[0]):
-            weight_decay = 0.0
-        else:
-            weight_decay = self._weight_decay
+        weight_decay = self._weight_decay_of(param_and_grad[0])
 
         # create the lamb optimize op
         lamb_op = block.append_op(
@@ -2844,6 +3005,38 @@ class LambOptimizer(AdamOptimizer):
 
         return lamb_op
 
+    def _append_merged_optimize_op(self, block, parameters_and_grads):
+        block.program._use_lamb = True
+        params = [p for p, _ in parameters_and_grads]
+        moment1 = [
+            self._get_accumulator(self._moment1_acc_str, p) for p in params
+        ]
+        moment2 = [
+            self._get_accumulator(self._moment2_acc_str, p) for p in params
+        ]
+        return block.append_op(
+            type="merged_lamb",
+            inputs={
+                "Param": params,
+                "Grad": [g for _, g in parameters_and_grads],
+                "LearningRate":
+                self._create_merged_param_lrs(parameters_and_grads),
+                "Moment1": moment1,
+                "Moment2": moment2
+            },
+            outputs={
+                "ParamOut": params,
+                "Moment1Out": moment1,
+                "Moment2Out": moment2
+            },
+            attrs={
+                "beta1": self._beta1,
+                "beta2": self._beta2,
+                "epsilon": self._epsilon,
+                "weight_decay": self._weight_decay_of(params[0])
+            },
+            stop_gradient=True)
+
 
 # We short the class name, since users will use the optimizer with the package
 # name. The sample code:
@@ -3430,6 +3623,13 @@ class PipelineOptimizer(object):
     
     So the length of place_list and concurrency_list must be also 2*k-1.
 
+    If cut_list is None, the program is split automatically into a CPU \
+    section running the embedding lookups, a device section running the \
+    dense part, and a CPU section running the optimize ops. The ops looking \
+    up the sparse tables, and the ops using the parameters larger than \
+    max_device_param_bytes, are placed on CPU with all the ops before them. \
+    If no op is placed on CPU, the program runs as one section.
+
     Note: Though the asynchronous mode is applied in pipeline training to speed up, \
     the final performance depends on the training progress of each pipeline heavily.
 
@@ -3445,6 +3645,8 @@ class PipelineOptimizer(object):
                         specify the scope queue size. [Optional. Default: 30].
         sync_steps (int): The synchronization steps between different cards. [Optional. Default: 1].
         start_cpu_core_id (int): specify the first cpu core id. [Optional. Default:0].
+        max_device_param_bytes (int): The ops using a parameter larger than it are placed \
+                        on CPU when cut_list is None. [Optional. Default: 256MB].
 
     Examples:
         .. code-block:: python
@@ -3493,7 +3695,8 @@ class PipelineOptimizer(object):
                  concurrency_list=None,
                  queue_size=30,
                  sync_steps=1,
-                 start_cpu_core_id=0):
+                 start_cpu_core_id=0,
+                 max_device_param_bytes=256 * 1024 * 1024):
         if framework.in_dygraph_mode():
             raise Exception("In dygraph, don't support PipelineOptimizer.")
         # TODO: check properties
@@ -3504,6 +3707,77 @@ class PipelineOptimizer(object):
         self._queue_size = queue_size
         self._sync_steps = sync_steps
         self._start_cpu_core_id = start_cpu_core_id
+        self._max_device_param_bytes = max_device_param_bytes
+
+    # The ops looking up the sparse tables, which run better on CPU next to
+    # the tables than on the device.
+    _cpu_op_types = set([
+        "lookup_table", "lookup_table_v2", "fused_embedding_seq_pool",
+        "pull_box_sparse", "pull_sparse", "pull_sparse_v2",
+        "distributed_lookup_table", "hash", "sequence_enumerate"
+    ])
+
+    def _param_bytes(self, block, op):
+        param_bytes = 0
+        for name in op.desc.input_arg_names():
+            var = block._find_var_recursive(name)
+            if var is None or not isinstance(var, framework.Parameter):
+                continue
+            numel = reduce(lambda x, y: x * abs(y), var.shape, 1)
+            param_bytes = max(param_bytes,
+                              numel * core.size_of_dtype(var.dtype))
+        return param_bytes
+
+    def _auto_partition(self, loss):
+        """
+        Split the forward ops by the last op to be placed on CPU, and set
+        the cut list, the places and the concurrency of the sections.
+        """
+        block = loss.block
+        ops = block.ops
+        loss_idx = None
+        for i, op in enumerate(ops):
+            if loss.name in op.desc.output_arg_names():
+                loss_idx = i
+        if loss_idx is None:
+            raise ValueError("The loss %s is not computed by the program." %
+                             loss.name)
+        forward_ops = ops[:loss_idx + 1]
+
+        last_cpu_idx = -1
+        for i, op in enumerate(forward_ops):
+            if op.type in self._cpu_op_types or self._param_bytes(
+                    block, op) > self._max_device_param_bytes:
+                last_cpu_idx = i
+
+        cut_names = []
+        if 0 <= last_cpu_idx < loss_idx:
+            cpu_outputs = set()
+            for op in forward_ops[:last_cpu_idx + 1]:
+                cpu_outputs.update(op.desc.output_arg_names())
+            for op in forward_ops[last_cpu_idx + 1:]:
+                for name in op.desc.input_arg_names():
+                    if name not in cpu_outputs:
+                        continue
+                    if name in cut_names or block.var(name).persistable:
+                        continue
+                    cut_names.append(name)
+
+        if len(cut_names) == 0 or not core.is_compiled_with_cuda():
+            self._cut_list = []
+            place = core.CUDAPlace(
+                0) if core.is_compiled_with_cuda() else core.CPUPlace()
+            self._place_list = [place]
+            default_concurrency = [1]
+        else:
+            self._cut_list = [[block.var(name) for name in cut_names], [loss]]
+            self._place_list = [
+                core.CPUPlace(), core.CUDAPlace(0), core.CPUPlace()
+            ]
+            default_concurrency = [1, 1, 1]
+        if self._concurrency_list is None or len(
+                self._concurrency_list) != len(self._place_list):
+            self._concurrency_list = default_concurrency
 
     def _create_vars(self, block, main_program):
         used_var_set = set()
@@ -3686,6 +3960,8 @@ class PipelineOptimizer(object):
                  startup_program=None,
                  parameter_list=None,
                  no_grad_set=None):
+        if self._cut_list is None:
+            self._auto_partition(loss)
         self._optimizer.minimize(loss, startup_program, parameter_list,
                                  no_grad_set)
         program = loss.block.program
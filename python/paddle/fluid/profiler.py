@@ -21,7 +21,9 @@ import six
 
 __all__ = [
     'cuda_profiler', 'reset_profiler', 'profiler', 'start_profiler',
-    'stop_profiler'
+    'stop_profiler', 'start_sampling_profiler', 'sampling_profiler_step',
+    'stop_sampling_profiler', 'get_sampled_event_stats',
+    'start_memory_profiler', 'stop_memory_profiler', 'memory_profiler'
 ]
 
 NVPROF_CONFIG = [
@@ -347,3 +349,159 @@ def profiler(state,
     start_profiler(state, tracer_option)
     yield
     stop_profiler(sorted_key, profile_path)
+
+
+def start_sampling_profiler(step_interval=100,
+                            op_sample_rate=0.0,
+                            buffer_size=4096,
+                            report_interval=1000,
+                            report_path=None,
+                            callback=None):
+    """
+    Enable the sampling profiler, which is cheap enough to be left on for
+    the long running jobs. All the events of every `step_interval`-th step,
+    and a random `op_sample_rate` fraction of the events of the other steps,
+    are recorded into fixed-size buffers. The per-event statistics are
+    reported every `report_interval` steps, the steps are counted by
+    `fluid.profiler.sampling_profiler_step`. It only records the events when
+    the profiler started by `fluid.profiler.start_profiler` is disabled.
+
+    Args:
+        step_interval (int, optional) : Samples all the events of every
+            `step_interval`-th step, 0 means no step is sampled. Default 100.
+        op_sample_rate (float, optional) : The probability to sample an
+            event of the other steps, in [0, 1]. Default 0.0.
+        buffer_size (int, optional) : The number of the events kept by each
+            thread between two reports, the oldest ones are overwritten when
+            the buffer is full. Default 4096.
+        report_interval (int, optional) : Reports the statistics every
+            `report_interval` steps, 0 means the statistics are only reported
+            when the sampling profiler stops. Default 1000.
+        report_path (str, optional) : The file the statistics are appended
+            to, one line of `step, name, calls, total, min, max, ave` per
+            event, the time is in ms. Default None, means no file.
+        callback (callable, optional) : Called by `callback(step, stats)`
+            when the statistics are reported, `stats` is a list of
+            `core.SampledEventStat` sorted by the total time. Default None.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            def print_stats(step, stats):
+                for stat in stats[:5]:
+                    print(step, stat.name, stat.calls, stat.ave_ms)
+
+            profiler.start_sampling_profiler(
+                step_interval=100, report_interval=1000, callback=print_stats)
+            for iter in range(10000):
+                # run a step
+                profiler.sampling_profiler_step()
+            profiler.stop_sampling_profiler()
+    """
+    core.enable_sampling_profiler(step_interval, op_sample_rate, buffer_size,
+                                  report_interval, report_path or "", callback)
+
+
+def sampling_profiler_step():
+    """
+    Mark the end of a step of the sampling profiler, which decides whether
+    the next step is sampled, and reports the statistics every
+    `report_interval` steps.
+    """
+    core.sampling_profiler_step()
+
+
+def stop_sampling_profiler():
+    """
+    Report the statistics not reported yet and stop the sampling profiler.
+    """
+    core.disable_sampling_profiler()
+
+
+def get_sampled_event_stats():
+    """
+    Return the statistics of the events sampled since the last report, as a
+    list of `core.SampledEventStat` sorted by the total time.
+    """
+    return core.get_sampled_event_stats()
+
+
+def start_memory_profiler():
+    """
+    Enable the memory profiler, which records the allocations from now on
+    with the operators allocating them and the variables holding them. The
+    records of the last memory profiling are cleared.
+    """
+    core.enable_memory_profiler()
+
+
+def stop_memory_profiler(top_n=10, timeline_path=None, print_report=True):
+    """
+    Stop the memory profiler, and return the live bytes at the peak of each
+    place broken down by the categories, the operators and the variables.
+
+    The categories are `parameter`, `gradient`, `optimizer_state`,
+    `activation`, `workspace` for the temporaries allocated inside the
+    operators like the cuDNN workspace, and `other` for the allocations
+    outside the operators.
+
+    Args:
+        top_n (int, optional) : The number of the operators and the
+            variables with the most bytes at the peak. Default 10.
+        timeline_path (str, optional) : The file the live bytes of the
+            categories are exported to in the chrome trace format, which can
+            be opened in chrome://tracing. Default None, means no timeline.
+        print_report (bool, optional) : Whether to print the report of the
+            peaks. Default True.
+
+    Returns:
+        A list of dicts, one for each place, with the keys `place`,
+        `peak_bytes`, `time_ns`, `categories` mapping the categories to the
+        bytes, and `ops`, `vars` which are the lists of (name, bytes) sorted
+        by the bytes.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            profiler.start_memory_profiler()
+            for iter in range(2):
+                # run a step
+                pass
+            peaks = profiler.stop_memory_profiler(
+                timeline_path='/tmp/memory_timeline.json')
+    """
+    core.disable_memory_profiler()
+    if timeline_path is not None:
+        core.export_memory_timeline(timeline_path)
+    if print_report:
+        print(core.memory_profiler_report(top_n))
+    return core.get_memory_peaks(top_n)
+
+
+@signature_safe_contextmanager
+def memory_profiler(top_n=10, timeline_path=None, print_report=True):
+    """
+    The memory profiler context manager, see `start_memory_profiler` and
+    `stop_memory_profiler`.
+
+    Examples:
+
+        .. code-block:: python
+
+            import paddle.fluid.profiler as profiler
+
+            with profiler.memory_profiler(timeline_path='/tmp/memory.json'):
+                # run the steps
+                pass
+    """
+    start_memory_profiler()
+    try:
+        yield
+    finally:
+        stop_memory_profiler(top_n, timeline_path, print_report)
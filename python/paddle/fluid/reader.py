@@ -511,17 +511,17 @@ class DygraphGeneratorLoader(DataLoaderBase):
             self._use_multiprocess = False
 
         if self._use_multiprocess:
-            # NOTE: the multiprocessing.Queue used to save loading data in self._process
-            self._data_queue = None
-            # NOTE: this process is used to load data asynchronously from self._batch_reader
+            # NOTE: this process is used to load data asynchronously from self._batch_reader,
+            # and write the shared memory files of the batches to a pipe
             self._process = None
+            # NOTE: the C++ thread reading the batches from the pipe, then pushing them into
+            # self._blocking_queue without the GIL
+            self._pipe_reader = None
 
         # NOTE: the C++ LoDTensorBlockingQueue instance
         self._blocking_queue = None
-        # NOTE: 1. In multiprocess mode, this thread is used to get next batch data from
-        # self._data_queue, then push it into self._blocking_queue; 2. In singleprocess
-        # mode, this thread is used to get next batch data from self._batch_reader, then 
-        # push it into self._blocking_queue
+        # NOTE: In singleprocess mode, this thread is used to get next batch data from
+        # self._batch_reader, then push it into self._blocking_queue
         self._thread = None
 
     @property
@@ -532,21 +532,17 @@ class DygraphGeneratorLoader(DataLoaderBase):
     def iterable(self):
         return self._iterable
 
-    def _clear_and_remove_data_queue(self):
-        if self._data_queue is not None:
-            while True:
-                try:
-                    self._data_queue.get_nowait()
-                except queue.Empty:
-                    break
-            global multiprocess_queue_set
-            multiprocess_queue_set.remove(self._data_queue)
-
     def _wait_thread_ends(self):
         thread = self._thread
         if thread is not None:
             self._blocking_queue.close()
             thread.join()
+        pipe_reader = getattr(self, '_pipe_reader', None)
+        if pipe_reader is not None:
+            # NOTE: the batches left in the pipe are dropped by the reader
+            self._blocking_queue.close()
+            pipe_reader.join()
+            self._pipe_reader = None
 
     def _wait_process_ends(self):
         process = self._process
@@ -587,17 +583,14 @@ class DygraphGeneratorLoader(DataLoaderBase):
 
     def _start(self):
         if self._use_multiprocess:
-            # clear old _data_queue and remove it from multiprocess_queue_set
-            self._clear_and_remove_data_queue()
-            # set data_queue and process
-            self._data_queue = multiprocessing.Queue(self._capacity)
-            # add _data_queue into global queue set
-            global multiprocess_queue_set
-            multiprocess_queue_set.add(self._data_queue)
+            read_fd, write_fd = os.pipe()
             self._process = multiprocessing.Process(
-                target=self._reader_process_loop)
+                target=self._reader_process_loop, args=(write_fd, read_fd))
             self._process.daemon = True
             self._process.start()
+            # NOTE: the reader sees the end of the pipe only if the child process
+            # holds the last write end
+            os.close(write_fd)
 
             # Set child process signal handler
             # NOTE: [ avoiding hang ] 1. if the child process dies due to bus error/segfault
@@ -607,12 +600,9 @@ class DygraphGeneratorLoader(DataLoaderBase):
             # joining them without a timeout), so here nedd to deal with SIGTERM.
             self._set_child_signal_handler()
 
-            # Set reader_thread
-            self._thread_done_event = threading.Event()
-            self._thread = threading.Thread(
-                target=self._reader_thread_loop_for_multiprocess)
-            self._thread.daemon = True
-            self._thread.start()
+            # NOTE: the read end of the pipe is closed by the reader
+            self._pipe_reader = core._PipeBatchReader(read_fd,
+                                                      self._blocking_queue)
         else:
             self._thread = threading.Thread(
                 target=self._reader_thread_loop_for_singleprocess)
@@ -652,17 +642,11 @@ class DygraphGeneratorLoader(DataLoaderBase):
                 " to locate the data causes this issue.\n\t* Please consider using "
                 "'fluid.create_lod_tensor' to convert it to a LoD-Tensor.")
 
-    def _exit_thread_expectedly(self):
-        self._thread_done_event.set()
-        self._blocking_queue.close()
-
-    def _exit_thread_unexpectedly(self):
-        self._thread_done_event.set()
-        self._blocking_queue.kill()
-        logging.error("DataLoader reader thread raised an exception!")
-
-    def _reader_process_loop(self):
+    def _reader_process_loop(self, write_fd, read_fd=None):
         try:
+            if read_fd is not None:
+                os.close(read_fd)
+
             # set signal handler
             core._set_process_signal_handler()
 
@@ -673,60 +657,21 @@ class DygraphGeneratorLoader(DataLoaderBase):
 
             # NOTE: [ mmap files clear ] When the child process exits unexpectedly,
             # some shared memory objects may have been applied for but have not yet
-            # been put into the inter-process Queue. This part of the object needs
-            # to be cleaned up when the process ends.
+            # been written into the pipe. This part of the object needs to be
+            # cleaned up when the process ends.
             CleanupFuncRegistrar.register(_cleanup)
 
             for batch in self._batch_reader():
                 tensor_list = core._convert_to_tensor_list(batch)
-                self._data_queue.put(tensor_list)
+                core._write_tensor_list_to_pipe(write_fd, tensor_list)
                 core._remove_tensor_list_mmap_fds(tensor_list)
-            self._data_queue.put(None)
+            core._write_end_of_data_to_pipe(write_fd)
         except KeyboardInterrupt:
             # NOTE: Main process will raise KeyboardInterrupt anyways, ignore it in child process
             pass
         except:
             six.reraise(*sys.exc_info())
 
-    def _reader_thread_loop_for_multiprocess(self):
-        while not self._thread_done_event.is_set():
-            try:
-                # NOTE: [ avoid hanging ] Even with carefully designed data dependencies 
-                # (i.e., a put() always corresponding to a get()), hanging on get() can 
-                # still happen when data in queue is corrupted (e.g., due to 
-                # Queue.cancel_join_thread or unexpected exit). So we set a timeout whenever 
-                # we try to get data from `data_queue`
-                # NOTE: [ avoid failed quickly ] Here, the time setting of QUEUE_GET_TIMEOUT
-                # is relatively long, currently it is 60 seconds, because in some models,
-                # if the reader child process starts with a heavy burden, the child process
-                # has no enough time to put the data in the queue when the main process
-                # start trying to get data from queue. At this time, the child thread needs
-                # to wait slightly longer
-                tensor_list = self._data_queue.get(timeout=QUEUE_GET_TIMEOUT)
-            except:
-                # NOTE [ avoid handing ] After adding the shared memory mechanism, not only
-                # the queue.Empty exception will occur here, but other exceptions will also
-                # occur, such as mmap failure. If it is not handled here, it will hang.
-                self._exit_thread_unexpectedly()
-                logging.error(
-                    "DataLoader reader thread failed to read data from the multiprocessing.Queue."
-                )
-                six.reraise(*sys.exc_info())
-
-            if not self._thread_done_event.is_set():
-                if tensor_list is not None:
-                    try:
-                        array = core.LoDTensorArray()
-                        for tensor in tensor_list:
-                            array.append(tensor)
-                        if not self._blocking_queue.push(array):
-                            self._blocking_queue.close()
-                    except:
-                        self._exit_thread_unexpectedly()
-                        six.reraise(*sys.exc_info())
-                else:
-                    self._exit_thread_expectedly()
-
     def _reader_thread_loop_for_singleprocess(self):
         try:
             for sample in self._batch_reader():
@@ -0,0 +1,68 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid.core as core
+
+
+class TestAllocatorStats(unittest.TestCase):
+    def check_place(self, place):
+        stats = core.get_allocator_stats(place)
+        data = np.ones([256, 1024], dtype='float32')
+        tensor = core.LoDTensor()
+        tensor.set(data, place)
+
+        new_stats = core.get_allocator_stats(place)
+        self.assertGreaterEqual(
+            new_stats['allocated_bytes'] - stats['allocated_bytes'],
+            data.nbytes)
+        self.assertGreater(new_stats['alloc_count'], stats['alloc_count'])
+        self.assertGreaterEqual(new_stats['peak_allocated_bytes'],
+                                new_stats['allocated_bytes'])
+        self.assertGreaterEqual(new_stats['total_allocated_bytes'],
+                                new_stats['allocated_bytes'])
+        self.assertGreater(new_stats['reserved_bytes'], 0)
+        self.assertGreater(new_stats['chunk_num'], 0)
+        self.assertGreaterEqual(new_stats['fragmentation'], 0.0)
+        self.assertLess(new_stats['fragmentation'], 1.0)
+        self.assertGreater(sum(new_stats['size_histogram']), 0)
+
+        del tensor
+        freed_stats = core.get_allocator_stats(place)
+        self.assertLess(freed_stats['allocated_bytes'],
+                        new_stats['allocated_bytes'])
+        self.assertGreater(freed_stats['free_count'], new_stats['free_count'])
+
+        core.reset_allocator_peak_stats(place)
+        self.assertEqual(
+            core.get_allocator_stats(place)['peak_allocated_bytes'],
+            core.get_allocator_stats(place)['allocated_bytes'])
+
+    def test_cpu(self):
+        self.check_place(core.CPUPlace())
+
+    def test_gpu(self):
+        if core.is_compiled_with_cuda():
+            self.check_place(core.CUDAPlace(0))
+
+    def test_cuda_pinned(self):
+        if core.is_compiled_with_cuda():
+            self.check_place(core.CUDAPinnedPlace())
+
+
+if __name__ == '__main__':
+    unittest.main()
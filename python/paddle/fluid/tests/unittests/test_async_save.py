@@ -0,0 +1,80 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import os
+import shutil
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestAsyncSave(unittest.TestCase):
+    def setUp(self):
+        self.model_path = "./async_save_model_temp/"
+
+    def check_async_save(self, filename):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name="x", shape=[10], dtype='float32')
+            fluid.layers.fc(x, 20)
+        place = fluid.CPUPlace()
+        exe = fluid.Executor(place)
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            exe.run(startup_program)
+            fluid.io.save_persistables(
+                exe,
+                self.model_path,
+                main_program=main_program,
+                filename=filename,
+                async_save=True)
+            params = main_program.global_block().all_parameters()
+            expected = [
+                np.array(scope.find_var(p.name).get_tensor()) for p in params
+            ]
+            # the parameters updated after saving are not saved
+            for p in params:
+                tensor = scope.find_var(p.name).get_tensor()
+                tensor.set(np.zeros(np.array(tensor).shape, 'float32'), place)
+            fluid.io.wait_async_save()
+            self.assertEqual(core.num_pending_async_checkpoints(), 0)
+
+        with fluid.scope_guard(fluid.Scope()):
+            fluid.io.load_persistables(
+                exe,
+                self.model_path,
+                main_program=main_program,
+                filename=filename)
+            for p, value in zip(params, expected):
+                loaded = np.array(fluid.global_scope().find_var(p.name)
+                                  .get_tensor())
+                self.assertTrue(np.array_equal(loaded, value))
+
+    def test_separate_files(self):
+        self.check_async_save(None)
+
+    def test_combined_file(self):
+        self.check_async_save("params")
+
+    def tearDown(self):
+        if os.path.exists(self.model_path):
+            shutil.rmtree(self.model_path)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -104,5 +104,45 @@ class TestGlobalAucOp(OpTest):
         self.check_output()
 
 
+class TestAccumulateOnlyAucOp(OpTest):
+    def setUp(self):
+        self.op_type = "auc"
+        pred = np.random.random((128, 2)).astype("float32")
+        labels = np.random.randint(0, 2, (128, 1)).astype("int64")
+        num_thresholds = 200
+        slide_steps = 0
+
+        stat_pos = np.zeros((1, (num_thresholds + 1))).astype("int64")
+        stat_neg = np.zeros((1, (num_thresholds + 1))).astype("int64")
+
+        self.inputs = {
+            'Predict': pred,
+            'Label': labels,
+            "StatPos": stat_pos,
+            "StatNeg": stat_neg
+        }
+        self.attrs = {
+            'curve': 'ROC',
+            'num_thresholds': num_thresholds,
+            "slide_steps": slide_steps,
+            "accumulate_only": True
+        }
+
+        python_auc = metrics.Auc(name="auc",
+                                 curve='ROC',
+                                 num_thresholds=num_thresholds)
+        python_auc.update(pred, labels)
+
+        self.outputs = {
+            'AUC': np.array(python_auc.eval()),
+            'StatPosOut': np.array(python_auc._stat_pos),
+            'StatNegOut': np.array(python_auc._stat_neg)
+        }
+
+    def test_check_output(self):
+        # AUC is not computed when only accumulating the statistics
+        self.check_output(no_check_set=['AUC'])
+
+
 if __name__ == "__main__":
     unittest.main()
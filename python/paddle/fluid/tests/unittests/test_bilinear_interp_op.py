@@ -258,6 +258,19 @@ class TestBilinearInterpDataLayout(TestBilinearInterpOp):
         self.data_layout = "NHWC"
 
 
+class TestBilinearInterpDataLayoutUpsample(TestBilinearInterpOp):
+    # The channels are a multiple of the vector size of the NHWC kernels.
+    def init_test_case(self):
+        self.interp_method = 'bilinear'
+        self.input_shape = [2, 3, 5, 4]
+        self.out_h = 7
+        self.out_w = 12
+        self.scale = 0.
+        self.align_corners = False
+        self.align_mode = 0
+        self.data_layout = "NHWC"
+
+
 class TestBilinearInterpOpUint8(OpTest):
     def setUp(self):
         self.out_size = None
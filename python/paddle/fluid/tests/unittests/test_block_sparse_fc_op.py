@@ -0,0 +1,112 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def block_sparse_matrix(rows, cols, block_shape, sparsity, dtype):
+    bh, bw = block_shape
+    mask = np.random.random((rows // bh, cols // bw)) >= sparsity
+    dense = np.random.random((rows, cols)).astype(dtype)
+    dense *= np.kron(mask, np.ones(block_shape)).astype(dtype)
+
+    values = []
+    offsets = [0]
+    columns = []
+    for r in range(rows // bh):
+        for c in range(cols // bw):
+            if mask[r, c]:
+                values.append(dense[r * bh:(r + 1) * bh, c * bw:(c + 1) * bw])
+                columns.append(c)
+        offsets.append(len(columns))
+    values = np.array(values).astype(dtype).reshape((-1, bh, bw))
+    return dense, values, np.array(offsets).astype('int32'), np.array(
+        columns).astype('int32')
+
+
+class TestBlockSparseFCOp(OpTest):
+    def setUp(self):
+        self.op_type = "block_sparse_fc"
+        self.init_config()
+        # The sparse matrix is the transposed weight.
+        w_t, values, offsets, columns = block_sparse_matrix(
+            self.out_features, self.in_features, self.block_shape, 0.8,
+            "float32")
+        x = np.random.random((self.batch, self.in_features)).astype("float32")
+        bias = np.random.random((self.out_features)).astype("float32")
+        out = np.dot(x, w_t.T) + bias
+        if self.activation_type == "relu":
+            out = np.maximum(out, 0)
+
+        self.inputs = {
+            'Input': x,
+            'Values': values,
+            'Offsets': offsets,
+            'Columns': columns,
+            'Bias': bias
+        }
+        self.attrs = {
+            'weight_shape': [self.in_features, self.out_features],
+            'block_shape': list(self.block_shape),
+            'activation_type': self.activation_type
+        }
+        self.outputs = {'Out': out}
+
+    def init_config(self):
+        self.batch = 3
+        self.in_features = 64
+        self.out_features = 32
+        self.block_shape = (8, 8)
+        self.activation_type = ""
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestBlockSparseFCOpRelu(TestBlockSparseFCOp):
+    def init_config(self):
+        self.batch = 5
+        self.in_features = 48
+        self.out_features = 16
+        self.block_shape = (1, 4)
+        self.activation_type = "relu"
+
+
+class TestBlockSparseConv2DOp(OpTest):
+    def setUp(self):
+        self.op_type = "block_sparse_conv2d"
+        filter, values, offsets, columns = block_sparse_matrix(16, 32, (4, 4),
+                                                               0.8, "float32")
+        x = np.random.random((2, 32, 5, 6)).astype("float32")
+        out = np.einsum('oc,nchw->nohw', filter, x)
+
+        self.inputs = {
+            'Input': x,
+            'Values': values,
+            'Offsets': offsets,
+            'Columns': columns
+        }
+        self.attrs = {'weight_shape': [16, 32], 'block_shape': [4, 4]}
+        self.outputs = {'Output': out}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+if __name__ == '__main__':
+    unittest.main()
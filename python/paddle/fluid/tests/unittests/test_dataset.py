@@ -256,6 +256,158 @@ class TestDataset(unittest.TestCase):
         os.remove("./test_in_memory_dataset_run_a.txt")
         os.remove("./test_in_memory_dataset_run_b.txt")
 
+    def test_in_memory_dataset_binary_format(self):
+        """
+        Testcase for InMemoryDataset loading converted binary files.
+        """
+        with open("test_in_memory_dataset_binary_a.txt", "w") as f:
+            data = "1 1 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 2 2 3 4 4 6 6 6 6 1 2\n"
+            data += "1 3 2 3 5 4 7 7 7 7 1 3\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+        dataset.set_batch_size(32)
+        dataset.set_thread(1)
+        dataset.set_pipe_command("cat")
+        dataset.set_use_var(slots_vars)
+        dataset.convert_to_binary("test_in_memory_dataset_binary_a.txt",
+                                  "test_in_memory_dataset_binary_a.bin")
+        dataset.set_binary_format(True)
+        dataset.set_filelist(["test_in_memory_dataset_binary_a.bin"])
+        dataset.load_into_memory()
+        self.assertEqual(dataset.get_memory_data_size(), 3)
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(fluid.default_startup_program())
+        for i in range(self.epoch_num):
+            try:
+                exe.train_from_dataset(fluid.default_main_program(), dataset)
+            except Exception as e:
+                self.assertTrue(False)
+
+        os.remove("./test_in_memory_dataset_binary_a.txt")
+        os.remove("./test_in_memory_dataset_binary_a.bin")
+
+    def test_in_memory_dataset_compact_record(self):
+        """
+        Testcase for InMemoryDataset holding records in compact format.
+        """
+        with open("test_in_memory_dataset_compact_a.txt", "w") as f:
+            data = "1 1 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 2 2 3 4 4 6 6 6 6 1 2\n"
+            data += "1 3 2 3 5 4 7 7 7 7 1 3\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+        dataset.set_batch_size(32)
+        dataset.set_thread(1)
+        dataset.set_pipe_command("cat")
+        dataset.set_use_var(slots_vars)
+        dataset.set_compact_record(True)
+        dataset.set_filelist(["test_in_memory_dataset_compact_a.txt"])
+        dataset.load_into_memory()
+        dataset.local_shuffle()
+        self.assertEqual(dataset.get_memory_data_size(), 3)
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(fluid.default_startup_program())
+        for i in range(self.epoch_num):
+            try:
+                exe.train_from_dataset(fluid.default_main_program(), dataset)
+            except Exception as e:
+                self.assertTrue(False)
+
+        os.remove("./test_in_memory_dataset_compact_a.txt")
+
+    def test_in_memory_dataset_prefetch_batch(self):
+        """
+        Testcase for InMemoryDataset building batches in a helper thread.
+        """
+        with open("test_in_memory_dataset_prefetch_a.txt", "w") as f:
+            data = "1 1 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 2 2 3 4 4 6 6 6 6 1 2\n"
+            data += "1 3 2 3 5 4 7 7 7 7 1 3\n"
+            data += "1 4 2 3 3 4 5 5 5 5 1 4\n"
+            data += "1 5 2 3 4 4 6 6 6 6 1 5\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+        dataset.set_batch_size(2)
+        dataset.set_thread(1)
+        dataset.set_pipe_command("cat")
+        dataset.set_use_var(slots_vars)
+        dataset.set_prefetch_batch(True)
+        dataset.set_filelist(["test_in_memory_dataset_prefetch_a.txt"])
+        dataset.load_into_memory()
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(fluid.default_startup_program())
+        for i in range(self.epoch_num):
+            try:
+                exe.train_from_dataset(fluid.default_main_program(), dataset)
+            except Exception as e:
+                self.assertTrue(False)
+
+        os.remove("./test_in_memory_dataset_prefetch_a.txt")
+
+    def test_in_memory_dataset_instance_filter(self):
+        """
+        Testcase for InMemoryDataset dropping instances while loading.
+        """
+        with open("test_in_memory_dataset_filter_a.txt", "w") as f:
+            data = "1 1 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 2 2 3 4 4 6 6 6 6 1 2\n"
+            data += "1 3 2 3 5 4 7 7 7 7 1 3\n"
+            data += "1 4 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 5 2 3 4 4 6 6 6 6 1 2\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+        dataset.set_batch_size(32)
+        dataset.set_thread(1)
+        dataset.set_pipe_command("cat")
+        dataset.set_use_var(slots_vars)
+        dataset.add_instance_filter("slot4", [2, 3], others_keep_rate=0.0)
+        dataset.add_instance_filter("slot1", [5], keep_rate=0.0)
+        dataset.set_filelist(["test_in_memory_dataset_filter_a.txt"])
+        dataset.load_into_memory()
+        self.assertEqual(dataset.get_memory_data_size(), 2)
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(fluid.default_startup_program())
+        for i in range(self.epoch_num):
+            try:
+                exe.train_from_dataset(fluid.default_main_program(), dataset)
+            except Exception as e:
+                self.assertTrue(False)
+
+        os.remove("./test_in_memory_dataset_filter_a.txt")
+
     def test_in_memory_dataset_masterpatch(self):
         """
         Testcase for InMemoryDataset from create to run.
@@ -472,6 +624,12 @@ class TestDataset(unittest.TestCase):
         dataset.wait_preload_done()
         dataset.dataset.merge_by_lineid()
         dataset.release_memory()
+        dataset.set_preload_memory_limit(1)
+        dataset.preload_into_memory()
+        dataset.wait_preload_done()
+        self.assertTrue(dataset.get_preload_memory_size() > 0)
+        dataset.set_preload_memory_limit(0)
+        dataset.release_memory()
         dataset.set_merge_by_lineid(30)
         dataset.set_parse_ins_id(False)
         dataset.load_into_memory()
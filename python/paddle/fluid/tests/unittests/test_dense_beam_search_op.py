@@ -0,0 +1,203 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+from op_test import OpTest
+
+
+def dense_beam_search(pre_ids, pre_scores, ids, scores, end_id,
+                      is_accumulated):
+    batch_size, beam_size = pre_ids.shape
+    scores = scores.reshape((batch_size, beam_size, -1))
+    width = scores.shape[2]
+    if ids is not None:
+        ids = ids.reshape(scores.shape)
+    selected_ids = np.zeros(pre_ids.shape, dtype=np.int64)
+    selected_scores = np.zeros(pre_scores.shape, dtype=pre_scores.dtype)
+    parent_idx = np.zeros(pre_ids.shape, dtype=np.int64)
+    for i in range(batch_size):
+        candidates = []
+        for beam in range(beam_size):
+            for col in range(width):
+                if pre_ids[i, beam] == end_id:
+                    score = pre_scores[i, beam] if col == 0 else -np.inf
+                    cand_id = end_id
+                else:
+                    score = scores[i, beam, col]
+                    if not is_accumulated:
+                        score = pre_scores[i, beam] + np.log(score)
+                    cand_id = col if ids is None else ids[i, beam, col]
+                candidates.append((-score, beam * width + col, cand_id, beam))
+        candidates.sort()
+        for k in range(beam_size):
+            score, _, cand_id, beam = candidates[k]
+            selected_ids[i, k] = cand_id
+            selected_scores[i, k] = -score
+            parent_idx[i, k] = beam
+    return selected_ids, selected_scores, parent_idx
+
+
+class TestDenseBeamSearchOp(OpTest):
+    def setUp(self):
+        self.op_type = "dense_beam_search"
+        self.dtype = np.float32
+        self.batch_size = 3
+        self.beam_size = 4
+        self.width = 10
+        self.end_id = 0
+        self.is_accumulated = True
+        self.with_ids = False
+        self.init_test_case()
+
+        shape = [self.batch_size, self.beam_size]
+        pre_ids = np.random.randint(1, 20, shape).astype(np.int64)
+        # Some beams are finished.
+        pre_ids[0, 1] = self.end_id
+        pre_ids[2, 0] = self.end_id
+        pre_scores = np.random.uniform(-5, 0, shape).astype(self.dtype)
+        self.scores_shape = shape + [self.width]
+        self.init_scores_shape()
+        if self.is_accumulated:
+            scores = np.random.uniform(-10, 0, self.scores_shape)
+        else:
+            scores = np.random.uniform(0.01, 1, self.scores_shape)
+        scores = scores.astype(self.dtype)
+        ids = None
+        self.inputs = {
+            'PreIds': pre_ids,
+            'PreScores': pre_scores,
+            'Scores': scores
+        }
+        if self.with_ids:
+            ids = np.random.randint(1, 1000, self.scores_shape).astype(
+                np.int64)
+            self.inputs['Ids'] = ids
+        self.attrs = {
+            'end_id': self.end_id,
+            'is_accumulated': self.is_accumulated
+        }
+        selected_ids, selected_scores, parent_idx = dense_beam_search(
+            pre_ids, pre_scores, ids, scores, self.end_id,
+            self.is_accumulated)
+        self.outputs = {
+            'SelectedIds': selected_ids,
+            'SelectedScores': selected_scores,
+            'ParentIdx': parent_idx
+        }
+
+    def init_test_case(self):
+        pass
+
+    def init_scores_shape(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestDenseBeamSearchOpWithIds(TestDenseBeamSearchOp):
+    def init_test_case(self):
+        self.with_ids = True
+        self.is_accumulated = False
+        self.dtype = np.float64
+
+
+class TestDenseBeamSearchOpFlattenBeams(TestDenseBeamSearchOp):
+    def init_test_case(self):
+        self.beam_size = 2
+        self.width = 300
+
+    def init_scores_shape(self):
+        self.scores_shape = [self.batch_size * self.beam_size, self.width]
+
+
+class TestDenseBeamSearchAPI(unittest.TestCase):
+    # Decodes several steps and backtraces the beams by gather_tree.
+    def check_with_place(self, place):
+        batch_size, beam_size, vocab_size, max_len = 2, 3, 8, 4
+        end_id = 0
+        log_probs_np = np.log(
+            np.random.uniform(0.01, 1, [max_len, batch_size, beam_size,
+                                        vocab_size])).astype('float32')
+        pre_scores_np = np.full([batch_size, beam_size], -np.inf, 'float32')
+        pre_scores_np[:, 0] = 0
+        pre_ids_np = np.ones([batch_size, beam_size], 'int64')
+
+        main = fluid.Program()
+        with fluid.program_guard(main, fluid.Program()):
+            pre_ids = fluid.data(
+                name='pre_ids', shape=[batch_size, beam_size], dtype='int64')
+            pre_scores = fluid.data(
+                name='pre_scores',
+                shape=[batch_size, beam_size],
+                dtype='float32')
+            log_probs = fluid.data(
+                name='log_probs',
+                shape=[max_len, batch_size, beam_size, vocab_size],
+                dtype='float32')
+            step_probs = fluid.layers.unstack(log_probs, axis=0)
+            step_ids, step_parents = [], []
+            for step in range(max_len):
+                accu_scores = fluid.layers.elementwise_add(
+                    step_probs[step],
+                    fluid.layers.unsqueeze(pre_scores, [2]),
+                    axis=0)
+                pre_ids, pre_scores, parent_idx = \
+                    fluid.layers.dense_beam_search(
+                        pre_ids, pre_scores, accu_scores, end_id=end_id)
+                step_ids.append(pre_ids)
+                step_parents.append(parent_idx)
+            sequences = fluid.layers.gather_tree(
+                fluid.layers.stack(step_ids), fluid.layers.stack(step_parents))
+
+        exe = fluid.Executor(place)
+        out, scores = exe.run(main,
+                              feed={
+                                  'pre_ids': pre_ids_np,
+                                  'pre_scores': pre_scores_np,
+                                  'log_probs': log_probs_np
+                              },
+                              fetch_list=[sequences, pre_scores])
+
+        ids_np, parents_np = [], []
+        for step in range(max_len):
+            accu_scores = log_probs_np[step] + pre_scores_np[:, :, np.newaxis]
+            pre_ids_np, pre_scores_np, parent_np = dense_beam_search(
+                pre_ids_np, pre_scores_np, None, accu_scores, end_id, True)
+            ids_np.append(pre_ids_np)
+            parents_np.append(parent_np)
+        expected = np.zeros(out.shape, dtype=np.int64)
+        parent = np.tile(np.arange(beam_size), (batch_size, 1))
+        for step in reversed(range(max_len)):
+            for i in range(batch_size):
+                expected[step, i] = ids_np[step][i][parent[i]]
+                parent[i] = parents_np[step][i][parent[i]]
+        self.assertTrue(np.array_equal(out, expected))
+        self.assertTrue(np.allclose(scores, pre_scores_np, atol=1e-5))
+
+    def test_api(self):
+        places = [core.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(core.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+
+
+if __name__ == '__main__':
+    unittest.main()
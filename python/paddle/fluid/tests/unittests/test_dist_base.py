@@ -135,6 +135,8 @@ class TestDistRunnerBase(object):
         dist_strategy.fuse_laryer_size = 1
         if args.use_local_sgd:
             dist_strategy.use_local_sgd = True
+        if args.use_sharded_optimizer:
+            dist_strategy.use_sharded_optimizer = True
         if args.ut4grad_allreduce:
             dist_strategy._ut4grad_allreduce = True
         if args.sync_batch_norm:
@@ -417,7 +419,10 @@ class TestParallelDyGraphRunnerBase(object):
                     type(self).__name__,
                     "begin to prepare context in dygraph with nccl2")
                 dygraph.parallel.prepare_context(strategy)
-                model = dygraph.parallel.DataParallel(model, strategy)
+                model = dygraph.parallel.DataParallel(
+                    model,
+                    strategy,
+                    overlap_all_reduce=args.overlap_all_reduce)
                 print_to_err(type(self).__name__, "model built in dygraph")
             out_losses = []
             print_to_err(type(self).__name__, "begin to run dygraph training")
@@ -462,6 +467,7 @@ def runtime_main(test_class):
     parser.add_argument('--use_hallreduce', action='store_true')
     parser.add_argument('--gpu_fleet_api', action='store_true')
     parser.add_argument('--use_local_sgd', action='store_true')
+    parser.add_argument('--use_sharded_optimizer', action='store_true')
     parser.add_argument('--ut4grad_allreduce', action='store_true')
     parser.add_argument(
         '--hallreduce_inter_nranks', type=int, required=False, default=2)
@@ -470,6 +476,7 @@ def runtime_main(test_class):
     parser.add_argument('--sync_mode', action='store_true')
     parser.add_argument('--use_cuda', action='store_true')
     parser.add_argument('--use_dgc', action='store_true')
+    parser.add_argument('--overlap_all_reduce', action='store_true')
     parser.add_argument('--use_reduce', action='store_true')
     parser.add_argument('--dc_asgd', action='store_true')
     parser.add_argument('--hogwild', action='store_true')
@@ -544,10 +551,12 @@ class TestDistBase(unittest.TestCase):
         self._lr = 0.001
         self._use_dgc = False
         self._dygraph = False
+        self._overlap_all_reduce = False
         self._nccl_comm_num = 1
         self._enable_backward_deps = False
         self._gpu_fleet_api = False
         self._use_local_sgd = False
+        self._use_sharded_optimizer = False
         self._ut4grad_allreduce = False
         self._use_hallreduce = False
         self._save_model = False
@@ -818,6 +827,9 @@ class TestDistBase(unittest.TestCase):
         if self._use_dgc:
             tr_cmd += " --use_dgc"
 
+        if self._overlap_all_reduce:
+            tr_cmd += " --overlap_all_reduce"
+
         if self._mp_mode:
             env = {"FLAGS_selected_gpus": "{}".format(trainer_id % 2)}
 
@@ -834,6 +846,8 @@ class TestDistBase(unittest.TestCase):
             tr_cmd += " --gpu_fleet_api"
             if self._use_local_sgd:
                 tr_cmd += " --use_local_sgd"
+            if self._use_sharded_optimizer:
+                tr_cmd += " --use_sharded_optimizer"
             if self._ut4grad_allreduce:
                 tr_cmd += " --ut4grad_allreduce"
             if hasattr(self, '_sync_batch_norm') and self._sync_batch_norm:
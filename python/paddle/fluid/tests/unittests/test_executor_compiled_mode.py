@@ -0,0 +1,74 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy
+import paddle.fluid.core as core
+import paddle.fluid as fluid
+
+
+class TestExecutorCompiledMode(unittest.TestCase):
+    def setUp(self):
+        self.compiled_mode = core.globals()['FLAGS_executor_compiled_mode']
+
+    def tearDown(self):
+        core.globals()['FLAGS_executor_compiled_mode'] = self.compiled_mode
+
+    def run_program(self, place, compiled_mode):
+        core.globals()['FLAGS_executor_compiled_mode'] = compiled_mode
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        main_program.random_seed = 1
+        startup_program.random_seed = 1
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name='x', shape=[16], dtype='float32')
+            hidden = fluid.layers.fc(input=x, size=8, act='relu')
+            out = fluid.layers.reduce_mean(
+                fluid.layers.elementwise_add(hidden, hidden))
+
+        exe = fluid.Executor(place)
+        scope = fluid.Scope()
+        results = []
+        with fluid.scope_guard(scope):
+            exe.run(startup_program)
+            # the batch size changes between the runs
+            for batch_size in [4, 4, 8, 8, 4]:
+                numpy.random.seed(batch_size)
+                x_np = numpy.random.random((batch_size, 16)).astype('float32')
+                results.append(
+                    exe.run(main_program,
+                            feed={'x': x_np},
+                            fetch_list=[out],
+                            use_program_cache=True)[0])
+        return results
+
+    def check_place(self, place):
+        expected = self.run_program(place, compiled_mode=False)
+        actual = self.run_program(place, compiled_mode=True)
+        for e, a in zip(expected, actual):
+            self.assertTrue(numpy.allclose(e, a))
+
+    def test_cpu(self):
+        self.check_place(fluid.CPUPlace())
+
+    def test_gpu(self):
+        if core.is_compiled_with_cuda():
+            self.check_place(fluid.CUDAPlace(0))
+
+
+if __name__ == '__main__':
+    unittest.main()
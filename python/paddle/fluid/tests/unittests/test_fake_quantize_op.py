@@ -243,5 +243,47 @@ class TestFakeQuantDequantMovingOp(TestMovingOpBase):
                         range_v) * out_scale / range_v
 
 
+
+class TestFakeQuantDequantAbsMaxOp(OpTest):
+    def setUp(self):
+        self.op_type = "fake_quantize_dequantize_abs_max"
+        self.attrs = {'bit_length': 8}
+        self.inputs = {'X': np.random.random((124, 240)).astype("float32"), }
+        scale = np.max(np.abs(self.inputs['X'])).astype("float32")
+        range_v = (1 << (self.attrs['bit_length'] - 1)) - 1
+        self.outputs = {
+            'Out': np.round(self.inputs['X'] / scale * range_v) * scale /
+            range_v,
+            'OutScale': np.array(scale).astype("float32"),
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFakeChannelWiseQuantDequantAbsMaxOp(OpTest):
+    def setUp(self):
+        self.op_type = "fake_channel_wise_quantize_dequantize_abs_max"
+        self.attrs = {'bit_length': 8}
+        self.inputs = {
+            'X': np.random.random((4, 3, 64, 64)).astype("float32"),
+        }
+        range_v = (1 << (self.attrs['bit_length'] - 1)) - 1
+        scales = []
+        outputs = self.inputs['X'].copy()
+        for i in range(self.inputs['X'].shape[0]):
+            scale = np.max(np.abs(self.inputs['X'][i])).astype("float32")
+            scales.append(scale)
+            outputs[i] = np.round(outputs[i] / scale *
+                                  range_v) * scale / range_v
+
+        self.outputs = {
+            'Out': outputs,
+            'OutScale': np.array(scales).astype("float32"),
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
 if __name__ == "__main__":
     unittest.main()
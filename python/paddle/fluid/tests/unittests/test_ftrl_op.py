@@ -16,9 +16,30 @@ from __future__ import print_function
 
 import unittest
 import numpy as np
+import paddle.fluid.core as core
+from paddle.fluid.op import Operator
 from op_test import OpTest
 
 
+def ftrl_step(w, g, sq_accum, linear_accum, lr, l1, l2, lr_power):
+    new_accum = sq_accum + g * g
+    if lr_power == -0.5:
+        linear_out = linear_accum + g - (
+            (np.sqrt(new_accum) - np.sqrt(sq_accum)) / lr) * w
+    else:
+        linear_out = linear_accum + g - ((np.power(
+            new_accum, -lr_power) - np.power(sq_accum, -lr_power)) / lr) * w
+
+    x = (l1 * np.sign(linear_out) - linear_out)
+    if lr_power == -0.5:
+        y = (np.sqrt(new_accum) / lr) + (2 * l2)
+    else:
+        y = (np.power(new_accum, -lr_power) / lr) + (2 * l2)
+    pre_shrink = x / y
+    param_out = np.where(np.abs(linear_out) > l1, pre_shrink, 0.0)
+    return param_out, new_accum, linear_out
+
+
 class TestFTRLOp(OpTest):
     def setUp(self):
         self.op_type = "ftrl"
@@ -44,25 +65,8 @@ class TestFTRLOp(OpTest):
             'lr_power': lr_power,
             'learning_rate': lr
         }
-        new_accum = sq_accum + g * g
-        if lr_power == -0.5:
-            linear_out = linear_accum + g - (
-                (np.sqrt(new_accum) - np.sqrt(sq_accum)) / lr) * w
-        else:
-            linear_out = linear_accum + g - ((np.power(
-                new_accum, -lr_power) - np.power(sq_accum, -lr_power)) / lr) * w
-
-        x = (l1 * np.sign(linear_out) - linear_out)
-        if lr_power == -0.5:
-            y = (np.sqrt(new_accum) / lr) + (2 * l2)
-            pre_shrink = x / y
-            param_out = np.where(np.abs(linear_out) > l1, pre_shrink, 0.0)
-        else:
-            y = (np.power(new_accum, -lr_power) / lr) + (2 * l2)
-            pre_shrink = x / y
-            param_out = np.where(np.abs(linear_out) > l1, pre_shrink, 0.0)
-
-        sq_accum_out = sq_accum + g * g
+        param_out, sq_accum_out, linear_out = ftrl_step(
+            w, g, sq_accum, linear_accum, lr, l1, l2, lr_power)
 
         self.outputs = {
             'ParamOut': param_out,
@@ -74,5 +78,86 @@ class TestFTRLOp(OpTest):
         self.check_output()
 
 
+class TestSparseFTRLOp(unittest.TestCase):
+    def setUp(self):
+        self.lr_power = -0.5
+
+    def check_with_place(self, place):
+        scope = core.Scope()
+        height = 10
+        rows = [0, 4, 7, 4]
+        row_numel = 12
+        l1 = 0.1
+        l2 = 0.2
+        lr = 0.01
+
+        grad_selected_rows = scope.var('Grad').get_selected_rows()
+        grad_selected_rows.set_height(height)
+        grad_selected_rows.set_rows(rows)
+        grad_array = np.random.random(
+            (len(rows), row_numel)).astype("float32")
+        grad_selected_rows.get_tensor().set(grad_array, place)
+
+        w = np.random.random((height, row_numel)).astype("float32")
+        sq_accum = np.full((height, row_numel), 0.1).astype("float32")
+        linear_accum = np.full((height, row_numel), 0.1).astype("float32")
+        scope.var('Param').get_tensor().set(w, place)
+        scope.var('SquaredAccumulator').get_tensor().set(sq_accum, place)
+        scope.var('LinearAccumulator').get_tensor().set(linear_accum, place)
+        scope.var('LearningRate').get_tensor().set(
+            np.array([lr]).astype("float32"), place)
+
+        ftrl_op = Operator(
+            "ftrl",
+            Param='Param',
+            Grad='Grad',
+            SquaredAccumulator='SquaredAccumulator',
+            LinearAccumulator='LinearAccumulator',
+            LearningRate='LearningRate',
+            ParamOut='Param',
+            SquaredAccumOut='SquaredAccumulator',
+            LinearAccumOut='LinearAccumulator',
+            l1=l1,
+            l2=l2,
+            lr_power=self.lr_power)
+        ftrl_op.run(scope, place)
+
+        # the duplicated rows are merged, and the other rows are unchanged
+        merged_grad = np.zeros((height, row_numel)).astype("float32")
+        for i, row in enumerate(rows):
+            merged_grad[row] += grad_array[i]
+        param_out, sq_accum_out, linear_out = ftrl_step(
+            w, merged_grad, sq_accum, linear_accum, lr, l1, l2,
+            self.lr_power)
+        untouched = [i for i in range(height) if i not in rows]
+        param_out[untouched] = w[untouched]
+        sq_accum_out[untouched] = sq_accum[untouched]
+        linear_out[untouched] = linear_accum[untouched]
+
+        self.assertTrue(
+            np.allclose(
+                np.array(scope.find_var('Param').get_tensor()),
+                param_out,
+                atol=1e-5))
+        self.assertTrue(
+            np.allclose(
+                np.array(scope.find_var('SquaredAccumulator').get_tensor()),
+                sq_accum_out,
+                atol=1e-5))
+        self.assertTrue(
+            np.allclose(
+                np.array(scope.find_var('LinearAccumulator').get_tensor()),
+                linear_out,
+                atol=1e-5))
+
+    def test_sparse_ftrl(self):
+        self.check_with_place(core.CPUPlace())
+
+
+class TestSparseFTRLOpPower(TestSparseFTRLOp):
+    def setUp(self):
+        self.lr_power = -0.6
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,203 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid.core as core
+from op_test import OpTest
+
+
+def attention(q, k, v, bias, alpha):
+    scores = np.matmul(q, np.swapaxes(k, -1, -2)) * alpha
+    if bias is not None:
+        scores = scores + bias
+    max_scores = np.max(scores, axis=-1, keepdims=True)
+    exp_scores = np.exp(scores - max_scores)
+    sum_scores = np.sum(exp_scores, axis=-1, keepdims=True)
+    out = np.matmul(exp_scores / sum_scores, v)
+    lse = np.log(sum_scores) + max_scores
+    return out, np.squeeze(lse, axis=-1)
+
+
+class TestFusedAttentionOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_attention"
+        self.dtype = np.float64
+        self.init_shape()
+        self.init_bias()
+
+        q = np.random.uniform(-1, 1, self.q_shape).astype(self.dtype)
+        k = np.random.uniform(-1, 1, self.k_shape).astype(self.dtype)
+        v = np.random.uniform(-1, 1, self.v_shape).astype(self.dtype)
+        self.inputs = {'Q': q, 'K': k, 'V': v}
+        bias = None
+        if self.with_bias:
+            bias = np.random.uniform(
+                -1, 1, self.q_shape[:-1] + self.k_shape[-2:-1]).astype(
+                    self.dtype)
+            self.inputs['BiasQK'] = bias
+
+        alpha = 1.0 / np.sqrt(self.q_shape[-1])
+        self.attrs = {'alpha': alpha, 'fix_seed': True, 'seed': 3}
+        out, lse = attention(q, k, v, bias, alpha)
+        self.outputs = {
+            'Out': out,
+            'SoftmaxLse': lse.astype(self.dtype),
+            'SeedOut': np.array([3]).astype('int32')
+        }
+
+    def init_shape(self):
+        self.q_shape = [2, 3, 5, 8]
+        self.k_shape = [2, 3, 7, 8]
+        self.v_shape = [2, 3, 7, 4]
+
+    def init_bias(self):
+        self.with_bias = True
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['Q', 'K', 'V'], 'Out')
+
+
+class TestFusedAttentionOpNoBias(TestFusedAttentionOp):
+    def init_bias(self):
+        self.with_bias = False
+
+
+class TestFusedAttentionOpLongSequence(TestFusedAttentionOp):
+    # The keys are computed in more than one block.
+    def init_shape(self):
+        self.q_shape = [1, 2, 70, 16]
+        self.k_shape = [1, 2, 130, 16]
+        self.v_shape = [1, 2, 130, 16]
+
+
+class TestFusedAttentionOpRank3(TestFusedAttentionOp):
+    def init_shape(self):
+        self.q_shape = [4, 6, 8]
+        self.k_shape = [4, 6, 8]
+        self.v_shape = [4, 6, 8]
+
+
+class TestFusedAttentionOpDropout(OpTest):
+    def setUp(self):
+        self.op_type = "fused_attention"
+        self.inputs = {
+            'Q': np.random.random((2, 4, 8)).astype("float32"),
+            'K': np.random.random((2, 4, 8)).astype("float32"),
+            'V': np.random.random((2, 4, 8)).astype("float32")
+        }
+        # All the attention probabilities are dropped.
+        self.attrs = {
+            'dropout_prob': 1.0,
+            'fix_seed': True,
+            'dropout_implementation': 'downgrade_in_infer'
+        }
+        _, lse = attention(self.inputs['Q'], self.inputs['K'],
+                           self.inputs['V'], None, 1.0)
+        self.outputs = {
+            'Out': np.zeros((2, 4, 8)).astype("float32"),
+            'SoftmaxLse': lse.astype("float32"),
+            'SeedOut': np.array([0]).astype('int32')
+        }
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusedAttentionOpVarlen(OpTest):
+    # The sequences of different lengths are packed without padding, with
+    # shape [total_len, num_heads, dim].
+    def setUp(self):
+        self.op_type = "fused_attention"
+        self.dtype = np.float64
+        q_lens = [3, 1, 6]
+        k_lens = [2, 5, 4]
+        num_heads = 2
+        q = np.random.uniform(-1, 1,
+                              (sum(q_lens), num_heads, 8)).astype(self.dtype)
+        k = np.random.uniform(-1, 1,
+                              (sum(k_lens), num_heads, 8)).astype(self.dtype)
+        v = np.random.uniform(-1, 1,
+                              (sum(k_lens), num_heads, 4)).astype(self.dtype)
+        alpha = 1.0 / np.sqrt(8)
+        out = np.zeros((sum(q_lens), num_heads, 4)).astype(self.dtype)
+        lse = np.zeros((sum(q_lens), num_heads)).astype(self.dtype)
+        q_offset = 0
+        k_offset = 0
+        for q_len, k_len in zip(q_lens, k_lens):
+            # [seq_len, num_heads, dim] -> [num_heads, seq_len, dim]
+            seq_q = np.swapaxes(q[q_offset:q_offset + q_len], 0, 1)
+            seq_k = np.swapaxes(k[k_offset:k_offset + k_len], 0, 1)
+            seq_v = np.swapaxes(v[k_offset:k_offset + k_len], 0, 1)
+            seq_out, seq_lse = attention(seq_q, seq_k, seq_v, None, alpha)
+            out[q_offset:q_offset + q_len] = np.swapaxes(seq_out, 0, 1)
+            lse[q_offset:q_offset + q_len] = np.swapaxes(seq_lse, 0, 1)
+            q_offset += q_len
+            k_offset += k_len
+
+        self.inputs = {
+            'Q': (q, [q_lens]),
+            'K': (k, [k_lens]),
+            'V': (v, [k_lens])
+        }
+        self.attrs = {
+            'alpha': alpha,
+            'varlen': True,
+            'fix_seed': True,
+            'seed': 3
+        }
+        self.outputs = {
+            'Out': (out, [q_lens]),
+            'SoftmaxLse': lse,
+            'SeedOut': np.array([3]).astype('int32')
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['Q', 'K', 'V'], 'Out')
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestFusedAttentionOpFP16(OpTest):
+    def setUp(self):
+        self.op_type = "fused_attention"
+        q = np.random.uniform(-1, 1, (2, 2, 9, 64)).astype(np.float16)
+        k = np.random.uniform(-1, 1, (2, 2, 9, 64)).astype(np.float16)
+        v = np.random.uniform(-1, 1, (2, 2, 9, 64)).astype(np.float16)
+        self.inputs = {'Q': q, 'K': k, 'V': v}
+        self.attrs = {'alpha': 0.125, 'fix_seed': True}
+        out, lse = attention(
+            q.astype(np.float32),
+            k.astype(np.float32), v.astype(np.float32), None, 0.125)
+        self.outputs = {
+            'Out': out.astype(np.float16),
+            # The statistics of float16 are saved in float32.
+            'SoftmaxLse': lse.astype(np.float32),
+            'SeedOut': np.array([0]).astype('int32')
+        }
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CUDAPlace(0), atol=1e-2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,200 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+from op_test import OpTest
+
+
+def pack_mask(kept):
+    rows, cols = kept.shape
+    num_bytes = (cols + 7) // 8
+    bits = np.zeros((rows, num_bytes * 8), dtype=np.int64)
+    bits[:, :cols] = kept
+    weights = 1 << np.arange(8)
+    return (bits.reshape((rows, num_bytes, 8)) * weights).sum(
+        axis=-1).astype(np.uint8)
+
+
+def unpack_mask(mask, cols):
+    bits = (mask[:, :, np.newaxis] >> np.arange(8)) & 1
+    return bits.reshape((mask.shape[0], -1))[:, :cols]
+
+
+def residual_layer_norm(z, scale, bias, begin_norm_axis, epsilon):
+    rows = int(np.prod(z.shape[:begin_norm_axis]))
+    z_2d = z.reshape((rows, -1))
+    mean = np.mean(z_2d, axis=1)
+    var = np.var(z_2d, axis=1)
+    y = (z_2d - mean[:, np.newaxis]) / np.sqrt(var[:, np.newaxis] + epsilon)
+    if scale is not None:
+        y = y * scale
+    if bias is not None:
+        y = y + bias
+    return y.reshape(z.shape), mean, var
+
+
+class TestFusedDropoutResidualLayerNormOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_dropout_residual_layer_norm"
+        self.dtype = np.float64
+        self.shape = [2, 3, 20]
+        self.begin_norm_axis = 2
+        self.epsilon = 1e-5
+        self.init_dropout()
+        self.init_scale_bias()
+
+        x = np.random.uniform(-1, 1, self.shape).astype(self.dtype)
+        residual = np.random.uniform(-1, 1, self.shape).astype(self.dtype)
+        cols = int(np.prod(self.shape[self.begin_norm_axis:]))
+        self.inputs = {'X': x, 'Residual': residual}
+        scale = bias = None
+        if self.with_scale_bias:
+            scale = np.random.uniform(0.5, 1.5, [cols]).astype(self.dtype)
+            bias = np.random.uniform(-1, 1, [cols]).astype(self.dtype)
+            self.inputs['Scale'] = scale
+            self.inputs['Bias'] = bias
+
+        self.attrs = {
+            'dropout_prob': self.dropout_prob,
+            'is_test': self.is_test,
+            'fix_seed': True,
+            'seed': 5,
+            'dropout_implementation': self.dropout_implementation,
+            'epsilon': self.epsilon,
+            'begin_norm_axis': self.begin_norm_axis
+        }
+        # The dropout keeps all the elements or none of them.
+        kept = np.full((x.size // cols, cols), self.dropout_prob < 1.0)
+        z = residual + x * kept.reshape(self.shape) * self.factor
+        y, mean, var = residual_layer_norm(z, scale, bias,
+                                           self.begin_norm_axis, self.epsilon)
+        self.outputs = {
+            'Y': y.astype(self.dtype),
+            'DropoutResidualOut': z.astype(self.dtype),
+            'Mean': mean.astype(self.dtype),
+            'Variance': var.astype(self.dtype)
+        }
+        if not self.is_test:
+            self.outputs['DropoutMask'] = pack_mask(kept)
+
+    def init_dropout(self):
+        self.dropout_prob = 0.0
+        self.is_test = False
+        self.dropout_implementation = 'upscale_in_train'
+        self.factor = 1.0
+
+    def init_scale_bias(self):
+        self.with_scale_bias = True
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        if self.with_scale_bias:
+            self.check_grad(['X', 'Residual', 'Scale', 'Bias'], 'Y')
+        else:
+            self.check_grad(['X', 'Residual'], 'Y')
+
+
+class TestFusedDropoutResidualLayerNormOpNoScaleBias(
+        TestFusedDropoutResidualLayerNormOp):
+    def init_scale_bias(self):
+        self.with_scale_bias = False
+
+
+class TestFusedDropoutResidualLayerNormOpAllDropped(
+        TestFusedDropoutResidualLayerNormOp):
+    def init_dropout(self):
+        self.dropout_prob = 1.0
+        self.is_test = False
+        self.dropout_implementation = 'upscale_in_train'
+        self.factor = 0.0
+
+
+class TestFusedDropoutResidualLayerNormOpInfer(
+        TestFusedDropoutResidualLayerNormOp):
+    def init_dropout(self):
+        self.dropout_prob = 0.3
+        self.is_test = True
+        self.dropout_implementation = 'downgrade_in_infer'
+        self.factor = 0.7
+
+    def test_check_grad(self):
+        pass
+
+
+class TestFusedDropoutResidualLayerNormOpRandomMask(unittest.TestCase):
+    # The outputs are checked against the dropout mask returned by the op.
+    def check_with_place(self, place):
+        shape = [16, 100]
+        prob = 0.4
+        x_np = np.random.uniform(-1, 1, shape).astype("float32")
+        residual_np = np.random.uniform(-1, 1, shape).astype("float32")
+        main = fluid.Program()
+        with fluid.program_guard(main, fluid.Program()):
+            x = fluid.data(name='x', shape=shape, dtype='float32')
+            residual = fluid.data(
+                name='residual', shape=shape, dtype='float32')
+            block = main.global_block()
+            outputs = {}
+            for name, dtype in [('Y', 'float32'), ('DropoutMask', 'uint8'),
+                                ('DropoutResidualOut', 'float32'),
+                                ('Mean', 'float32'), ('Variance', 'float32')]:
+                outputs[name] = block.create_var(
+                    name=name.lower(), dtype=dtype)
+            block.append_op(
+                type='fused_dropout_residual_layer_norm',
+                inputs={'X': x,
+                        'Residual': residual},
+                outputs=outputs,
+                attrs={
+                    'dropout_prob': prob,
+                    'fix_seed': True,
+                    'seed': 7,
+                    'dropout_implementation': 'upscale_in_train'
+                })
+        exe = fluid.Executor(place)
+        y, mask, z = exe.run(
+            main,
+            feed={'x': x_np,
+                  'residual': residual_np},
+            fetch_list=[
+                outputs['Y'], outputs['DropoutMask'],
+                outputs['DropoutResidualOut']
+            ])
+
+        self.assertEqual(mask.shape, (16, 13))
+        kept = unpack_mask(mask, shape[1])
+        self.assertTrue(abs(1.0 - kept.mean() - prob) < 0.05)
+        expected_z = residual_np + x_np * kept / (1.0 - prob)
+        self.assertTrue(np.allclose(z, expected_z, atol=1e-5))
+        expected_y, _, _ = residual_layer_norm(expected_z, None, None, 1,
+                                               1e-5)
+        self.assertTrue(np.allclose(y, expected_y, atol=1e-4))
+
+    def test_random_mask(self):
+        places = [core.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(core.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,151 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest, skip_check_grad_ci
+import paddle.fluid as fluid
+
+
+def emb_seqpool_cvm(table, ids, lod, pooltype, use_cvm, padding_idx):
+    out = []
+    offset = 0
+    for length in lod[0]:
+        seq = ids[offset:offset + length].flatten()
+        emb = table[seq].copy()
+        emb[seq == padding_idx] = 0
+        pooled = np.sum(emb, axis=0)
+        if length > 0 and pooltype == "AVERAGE":
+            pooled /= length
+        elif length > 0 and pooltype == "SQRT":
+            pooled /= np.sqrt(length)
+        if use_cvm:
+            pooled[0] = np.log(pooled[0] + 1)
+            pooled[1] = np.log(pooled[1] + 1) - pooled[0]
+        else:
+            pooled = pooled[2:]
+        out.append(pooled)
+        offset += length
+    return np.array(out)
+
+
+@skip_check_grad_ci(reason="The gradient of W is a SelectedRows, which is "
+                    "checked by TestFusedEmbeddingSeqPoolCVMConcatGrad.")
+class TestFusedEmbeddingSeqPoolCVMConcatOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_embedding_seqpool_cvm_concat"
+        self.set_conf()
+        self.table = np.random.random((17, 6)).astype("float64")
+        self.lods = [[[3, 0, 2]], [[1, 2, 1]]]
+        ids = [
+            np.random.randint(
+                0, 17, size=(sum(lod[0]), 1)).astype("int64")
+            for lod in self.lods
+        ]
+        if self.padding_idx >= 0:
+            ids[0][1] = self.padding_idx
+        cvm = np.random.random((3, 2)).astype("float64")
+        self.inputs = {
+            'Ids': [('ids%d' % i, (ids[i], self.lods[i]))
+                    for i in range(len(ids))],
+            'W': [('w', self.table)],
+            'CVM': cvm
+        }
+        self.attrs = {
+            'pooltype': self.pooltype,
+            'use_cvm': self.use_cvm,
+            'padding_idx': self.padding_idx
+        }
+        out = np.concatenate(
+            [
+                emb_seqpool_cvm(self.table, ids[i], self.lods[i],
+                                self.pooltype, self.use_cvm,
+                                self.padding_idx) for i in range(len(ids))
+            ],
+            axis=1)
+        self.outputs = {'Out': (out, [[1, 1, 1]])}
+
+    def set_conf(self):
+        self.pooltype = "SUM"
+        self.use_cvm = True
+        self.padding_idx = -1
+
+    def test_check_output(self):
+        self.check_output(check_dygraph=False)
+
+
+class TestFusedEmbeddingSeqPoolCVMConcatOpAvg(
+        TestFusedEmbeddingSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.pooltype = "AVERAGE"
+        self.use_cvm = False
+        self.padding_idx = 5
+
+
+class TestFusedEmbeddingSeqPoolCVMConcatOpSqrt(
+        TestFusedEmbeddingSeqPoolCVMConcatOp):
+    def set_conf(self):
+        self.pooltype = "SQRT"
+        self.use_cvm = True
+        self.padding_idx = 5
+
+
+class TestFusedEmbeddingSeqPoolCVMConcatGrad(unittest.TestCase):
+    def test_sgd_update(self):
+        # the table is updated by sgd with learning rate 1.0, and the loss
+        # is the sum of the output, so that W -= the sum of the row grads
+        table = np.random.random((10, 4)).astype("float32")
+        ids = np.array([[1], [3], [1], [7]]).astype("int64")
+        lod = [[2, 2]]
+        cvm = np.array([[2., 1.], [3., 0.]]).astype("float32")
+
+        main, startup = fluid.Program(), fluid.Program()
+        with fluid.program_guard(main, startup):
+            slot = fluid.layers.data(
+                name='slot', shape=[1], dtype='int64', lod_level=1)
+            cvm_var = fluid.layers.data(
+                name='cvm', shape=[2], dtype='float32')
+            out = fluid.contrib.fused_embedding_seqpool_cvm_concat(
+                input=[slot],
+                size=[10, 4],
+                cvm=cvm_var,
+                use_cvm=False,
+                param_attr=fluid.ParamAttr(
+                    name='emb',
+                    initializer=fluid.initializer.NumpyArrayInitializer(
+                        table)))
+            loss = fluid.layers.reduce_sum(out)
+            fluid.optimizer.SGD(learning_rate=1.0).minimize(loss)
+
+        place = fluid.CPUPlace()
+        exe = fluid.Executor(place)
+        exe.run(startup)
+        exe.run(main,
+                feed={
+                    'slot': fluid.create_lod_tensor(ids, lod, place),
+                    'cvm': cvm
+                })
+        updated = np.array(fluid.global_scope().find_var('emb').get_tensor())
+
+        expected = table.copy()
+        for i, row in enumerate(ids.flatten()):
+            grad = np.concatenate([cvm[i // 2], np.ones(2, "float32")])
+            expected[row] -= grad
+        self.assertTrue(np.allclose(updated, expected))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -121,5 +121,51 @@ class TestFusedMultiHeadMatmulOp2(TestFusedMultiheadMatmulOp):
         self.scale = 0.125
 
 
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "Paddle core is not compiled with CUDA")
+class TestFusedMultiheadMatmulOpVarlen(OpTest):
+    # The sequences of different lengths are packed without padding.
+    def setUp(self):
+        self.op_type = "multihead_matmul"
+        self.seq_lens = [5, 1, 12, 7]
+        self.size_per_head = 32
+        self.head_number = 4
+        self.scale = 0.125
+        total_len = sum(self.seq_lens)
+        n = self.head_number
+        h = self.size_per_head
+        w = n * h
+        x = np.random.random((total_len, w)).astype("float32") - 0.5
+        combined_w = (np.random.random((w, 3, w)).astype("float32") - 0.5) * 0.1
+        combined_b = np.random.random((3, w)).astype("float32") - 0.5
+        qkv = np.dot(x, combined_w.reshape((w, 3 * w))).reshape(
+            (total_len, 3, w)) + combined_b
+        out = np.zeros((total_len, w)).astype("float32")
+        offset = 0
+        for seq_len in self.seq_lens:
+            seq = qkv[offset:offset + seq_len].reshape((seq_len, 3, n, h))
+            q = np.transpose(seq[:, 0], (1, 0, 2))
+            k = np.transpose(seq[:, 1], (1, 0, 2))
+            v = np.transpose(seq[:, 2], (1, 0, 2))
+            qk = np.matmul(q, np.transpose(k, (0, 2, 1))) * self.scale
+            softmax_qk = np.apply_along_axis(stable_softmax, 2, qk)
+            seq_out = np.matmul(softmax_qk, v)
+            out[offset:offset + seq_len] = np.transpose(
+                seq_out, (1, 0, 2)).reshape((seq_len, w))
+            offset += seq_len
+
+        self.inputs = {
+            "Input": (x, [self.seq_lens]),
+            "W": combined_w,
+            "Bias": combined_b
+        }
+        self.attrs = {"head_number": self.head_number, "alpha": self.scale}
+        self.outputs = {"Out": (out, [self.seq_lens])}
+
+    def test_check_output(self):
+        place = core.CUDAPlace(0)
+        self.check_output_with_place(place, atol=2e-3)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -57,6 +57,7 @@ class TestFusionGRUOp(OpTest):
         self.with_bias = True
         self.act_state = 'tanh'
         self.act_gate = 'sigmoid'
+        self.use_int8 = False
         self.set_confs()
 
         T = sum(self.lod[0])
@@ -72,8 +73,23 @@ class TestFusionGRUOp(OpTest):
             N, self.D).astype('float32') if self.with_h0 else np.zeros(
                 (N, self.D), dtype='float32')
 
+        self.attrs = {}
+        ref_x, ref_wx = x, wx
+        if self.use_int8:
+            # WeightX is quantized by the columns, and X by the kernel
+            scale_data = 127. / np.abs(x).max()
+            scale_weights = 127. / np.abs(wx).max(axis=0)
+            x_q = np.clip(np.round(x * scale_data), -128, 127)
+            wx = np.clip(np.round(wx * scale_weights), -127,
+                         127).astype('int8')
+            ref_x = (x_q / scale_data).astype('float32')
+            ref_wx = (wx / scale_weights).astype('float32')
+            self.attrs['Scale_data'] = float(scale_data)
+            self.attrs['Scale_weights'] = scale_weights.astype(
+                'float32').tolist()
+
         _, _, _, hidden = fusion_gru(
-            x, self.lod, h0, wx, wh, bias, self.is_reverse,
+            ref_x, self.lod, h0, ref_wx, wh, bias, self.is_reverse,
             ACTIVATION[self.act_state], ACTIVATION[self.act_gate])
 
         self.inputs = {'X': (x, self.lod), 'WeightX': wx, 'WeightH': wh}
@@ -86,11 +102,11 @@ class TestFusionGRUOp(OpTest):
 
         self.outputs = {'Hidden': (hidden, self.lod)}
 
-        self.attrs = {
+        self.attrs.update({
             'activation': self.act_state,
             'gate_activation': self.act_gate,
             'is_reverse': self.is_reverse
-        }
+        })
 
     def test_check_output(self):
         for use_seq in {True, False}:
@@ -137,5 +153,12 @@ class TestFusionGRUOpBS1(TestFusionGRUOp):
         self.D = 16
 
 
+class TestFusionGRUOpINT8(TestFusionGRUOp):
+    def set_confs(self):
+        self.M = 36
+        self.D = 8
+        self.use_int8 = True
+
+
 if __name__ == "__main__":
     unittest.main()
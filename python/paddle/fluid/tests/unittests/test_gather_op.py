@@ -106,5 +106,17 @@ class TestCase6(TestGatherOp):
         self.index_type = "int32"
 
 
+class TestCase7(TestGatherOp):
+    def config(self):
+        """
+        For many duplicate indices, whose gradients are summed up by sorting
+        """
+        self.x_shape = (3, 20)
+        self.attrs = {'overwrite': False}
+        self.x_type = "float64"
+        self.index = [2, 0, 2, 2, 1, 0, 2, 2, 0, 2, 1, 2]
+        self.index_type = "int64"
+
+
 if __name__ == "__main__":
     unittest.main()
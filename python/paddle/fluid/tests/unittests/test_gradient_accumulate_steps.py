@@ -0,0 +1,96 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestGradientAccumulateSteps(unittest.TestCase):
+    def setUp(self):
+        self.regularization = None
+
+    def build_program(self):
+        main, startup = fluid.Program(), fluid.Program()
+        main.random_seed = startup.random_seed = 1
+        with fluid.program_guard(main, startup):
+            x = fluid.data(name='x', shape=[None, 8], dtype='float32')
+            y = fluid.data(name='y', shape=[None, 1], dtype='float32')
+            hidden = fluid.layers.fc(x, size=16, act='relu')
+            pred = fluid.layers.fc(hidden, size=1)
+            loss = fluid.layers.mean(
+                fluid.layers.square_error_cost(
+                    input=pred, label=y))
+            fluid.optimizer.SGD(learning_rate=0.1,
+                                regularization=self.regularization).minimize(
+                                    loss)
+        return main, startup, loss
+
+    def run_steps(self, place, feeds, steps):
+        main, startup, loss = self.build_program()
+        params = [p.name for p in main.global_block().all_parameters()]
+        exe = fluid.Executor(place)
+        scope = fluid.Scope()
+        results = []
+        with fluid.scope_guard(scope):
+            exe.run(startup)
+            results.append(
+                [np.array(scope.find_var(p).get_tensor()) for p in params])
+            build_strategy = fluid.BuildStrategy()
+            build_strategy.gradient_accumulate_steps = steps
+            compiled = fluid.CompiledProgram(main).with_data_parallel(
+                loss_name=loss.name,
+                build_strategy=build_strategy,
+                places=[place])
+            for feed in feeds:
+                exe.run(compiled, feed=feed, fetch_list=[loss.name])
+                results.append(
+                    [np.array(scope.find_var(p).get_tensor()) for p in params])
+        return results
+
+    def check_with_place(self, place):
+        np.random.seed(1)
+        xs = [np.random.random((4, 8)).astype('float32') for _ in range(4)]
+        ys = [np.random.random((4, 1)).astype('float32') for _ in range(4)]
+        accumulated = self.run_steps(
+            place, [{'x': x, 'y': y} for x, y in zip(xs, ys)], 2)
+        merged = self.run_steps(place, [{
+            'x': np.concatenate(xs[i:i + 2]),
+            'y': np.concatenate(ys[i:i + 2])
+        } for i in range(0, 4, 2)], 1)
+        # the parameters are only updated on every 2 steps, by the average of
+        # the gradients, which is the same as one step of the merged batch
+        for step in range(4):
+            expected = merged[(step + 1) // 2]
+            for result, param in zip(accumulated[step + 1], expected):
+                self.assertTrue(np.allclose(result, param, atol=1e-5))
+
+    def test_cpu(self):
+        self.check_with_place(fluid.CPUPlace())
+
+    def test_gpu(self):
+        if core.is_compiled_with_cuda():
+            self.check_with_place(fluid.CUDAPlace(0))
+
+
+class TestGradientAccumulateStepsWithWeightDecay(TestGradientAccumulateSteps):
+    def setUp(self):
+        self.regularization = fluid.regularizer.L2Decay(1e-2)
+
+
+if __name__ == '__main__':
+    unittest.main()
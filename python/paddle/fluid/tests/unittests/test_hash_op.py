@@ -102,5 +102,28 @@ class TestHashOp3(TestHashOp):
         self.check_output()
 
 
+class TestHashOp3(TestHashOp):
+    """
+    Case:
+    the rows longer than the 32 bytes stripes of xxHash
+    """
+
+    def setUp(self):
+        self.op_type = "hash"
+        self.init_test_case()
+        self.inputs = {'X': self.in_seq}
+        self.attrs = {'num_hash': 3, 'mod_by': 10000}
+        self.outputs = {'Out': self.out_seq}
+
+    def init_test_case(self):
+        self.in_seq = np.arange(36).reshape((3, 12)).astype("int32")
+        self.out_seq = np.array(
+            [5814, 1301, 484, 7856, 7363, 7116, 7516, 2328, 196]).reshape(
+                (3, 3, 1))
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == "__main__":
     unittest.main()
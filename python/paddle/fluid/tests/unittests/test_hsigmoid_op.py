@@ -259,7 +259,7 @@ class TestHSigmoidOpWithSparseGrad(unittest.TestCase):
 
         return avg_cost, data_list
 
-    def training_test(self, is_sparse):
+    def training_test(self, is_sparse, place=fluid.CPUPlace()):
         with fluid.program_guard(fluid.Program(), fluid.Program()):
             start_up = fluid.default_startup_program()
             start_up.random_seed = 1  # Fix random seed
@@ -273,7 +273,6 @@ class TestHSigmoidOpWithSparseGrad(unittest.TestCase):
             optimizer.minimize(loss)
 
             main_program = fluid.default_main_program()
-            place = fluid.CPUPlace()
             feeder = fluid.DataFeeder(feed_list=data_list, place=place)
             exe = fluid.Executor(place)
 
@@ -294,6 +293,14 @@ class TestHSigmoidOpWithSparseGrad(unittest.TestCase):
         sparse_result = self.training_test(is_sparse=True)
         assert (dense_result == sparse_result)
 
+    @unittest.skipIf(not core.is_compiled_with_cuda(),
+                     "core is not compiled with CUDA")
+    def test_hs_grad_with_sparse_gpu(self):
+        place = fluid.CUDAPlace(0)
+        dense_result = self.training_test(is_sparse=False, place=place)
+        sparse_result = self.training_test(is_sparse=True, place=place)
+        assert (dense_result == sparse_result)
+
 
 @skip_check_grad_ci(
     reason="[skip shape check] The huffman tree is structed separately. It will be complicated if use large shape."
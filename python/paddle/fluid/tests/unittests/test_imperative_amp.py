@@ -0,0 +1,109 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestImperativeAmp(unittest.TestCase):
+    def setUp(self):
+        self.x = np.random.uniform(-1, 1, [4, 16]).astype('float32')
+
+    def train(self,
+              place,
+              use_amp,
+              init_loss_scaling=2.**15,
+              steps=2,
+              x=None):
+        with fluid.dygraph.guard(place):
+            fluid.default_startup_program().random_seed = 10
+            fluid.default_main_program().random_seed = 10
+            x = fluid.dygraph.to_variable(self.x if x is None else x)
+            linear1 = fluid.Linear(16, 32, act='relu')
+            linear2 = fluid.Linear(32, 8)
+            params = linear1.parameters() + linear2.parameters()
+            sgd = fluid.optimizer.SGD(learning_rate=0.1,
+                                      parameter_list=params)
+            scaler = fluid.dygraph.AmpScaler(
+                init_loss_scaling=init_loss_scaling,
+                decr_every_n_nan_or_inf=1)
+            for _ in range(steps):
+                with fluid.dygraph.amp_guard(enable=use_amp):
+                    out = linear2(linear1(x))
+                    loss = fluid.layers.reduce_mean(
+                        fluid.layers.cast(out, 'float32'))
+                scaled_loss = scaler.scale(loss)
+                scaled_loss.backward()
+                scaler.minimize(sgd, scaled_loss)
+                linear1.clear_gradients()
+                linear2.clear_gradients()
+            return [p.numpy() for p in params], scaler.get_loss_scaling()
+
+    def test_loss_scaling(self):
+        place = fluid.CPUPlace()
+        # The ops have no float16 kernels for CPU, and run as usual.
+        params, loss_scaling = self.train(place, False, 1.0)
+        amp_params, amp_loss_scaling = self.train(place, True)
+        self.assertEqual(amp_loss_scaling, 2.**15)
+        for p, amp_p in zip(params, amp_params):
+            self.assertTrue(np.allclose(p, amp_p, atol=1e-6))
+
+    def test_skip_infinite_grads(self):
+        place = fluid.CPUPlace()
+        params, _ = self.train(place, False, steps=0)
+        x = np.copy(self.x)
+        x[0][0] = np.inf
+        inf_params, loss_scaling = self.train(place, False, steps=1, x=x)
+        self.assertEqual(loss_scaling, 2.**14)
+        for p, inf_p in zip(params, inf_params):
+            self.assertTrue(np.array_equal(p, inf_p))
+
+    def test_amp_guard(self):
+        if not core.is_compiled_with_cuda():
+            return
+        place = fluid.CUDAPlace(0)
+        with fluid.dygraph.guard(place):
+            x = fluid.dygraph.to_variable(self.x)
+            linear = fluid.Linear(16, 32)
+            with fluid.dygraph.amp_guard():
+                out = linear(x)
+                self.assertEqual(out.dtype, core.VarDesc.VarType.FP32)
+                mul_out = fluid.layers.mul(x, linear.weight)
+                self.assertEqual(mul_out.dtype, core.VarDesc.VarType.FP16)
+            with fluid.dygraph.amp_guard(custom_black_list={'mul'}):
+                mul_out = fluid.layers.mul(x, linear.weight)
+                self.assertEqual(mul_out.dtype, core.VarDesc.VarType.FP32)
+            expected = np.matmul(self.x, linear.weight.numpy())
+            with fluid.dygraph.amp_guard():
+                mul_out = fluid.layers.mul(x, linear.weight)
+            self.assertTrue(
+                np.allclose(
+                    mul_out.numpy().astype('float32'), expected, atol=1e-2))
+
+    def test_train_with_amp(self):
+        if not core.is_compiled_with_cuda():
+            return
+        place = fluid.CUDAPlace(0)
+        params, _ = self.train(place, False, 1.0)
+        amp_params, _ = self.train(place, True)
+        for p, amp_p in zip(params, amp_params):
+            self.assertTrue(np.allclose(p, amp_p, atol=1e-2))
+
+
+if __name__ == '__main__':
+    unittest.main()
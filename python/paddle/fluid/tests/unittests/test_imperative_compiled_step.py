@@ -0,0 +1,107 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import six
+import paddle.fluid as fluid
+from paddle.fluid.dygraph import CompiledStep
+
+
+class SimpleNet(fluid.dygraph.Layer):
+    def __init__(self, feature_size, hidden_size):
+        super(SimpleNet, self).__init__()
+        self._linear1 = fluid.dygraph.Linear(
+            feature_size, hidden_size, act='relu')
+        self._linear2 = fluid.dygraph.Linear(hidden_size, 1)
+
+    def forward(self, x, label):
+        y = self._linear2(self._linear1(x))
+        loss = fluid.layers.reduce_mean(fluid.layers.square(y - label))
+        return loss, y
+
+
+class TestCompiledStep(unittest.TestCase):
+    def setUp(self):
+        self.feature_size = 8
+        self.hidden_size = 16
+        self.batch_size = 4
+        self.steps = 5
+
+    def create_optimizer(self, parameters):
+        return fluid.optimizer.Momentum(
+            learning_rate=0.01, momentum=0.9, parameter_list=parameters)
+
+    def create_inputs(self):
+        x = np.random.random(
+            [self.batch_size, self.feature_size]).astype('float32')
+        label = np.random.random([self.batch_size, 1]).astype('float32')
+        return x, label
+
+    def check_with_place(self, place):
+        with fluid.dygraph.guard(place):
+            dygraph_net = SimpleNet(self.feature_size, self.hidden_size)
+            static_net = SimpleNet(self.feature_size, self.hidden_size)
+            static_net.set_dict(dygraph_net.state_dict())
+            dygraph_opt = self.create_optimizer(dygraph_net.parameters())
+            step = CompiledStep(static_net,
+                                self.create_optimizer(static_net.parameters()))
+
+            for _ in six.moves.range(self.steps):
+                x, label = self.create_inputs()
+                inputs = [
+                    fluid.dygraph.to_variable(x),
+                    fluid.dygraph.to_variable(label)
+                ]
+                dygraph_loss, _ = dygraph_net(*inputs)
+                dygraph_loss.backward()
+                dygraph_opt.minimize(dygraph_loss)
+                dygraph_net.clear_gradients()
+
+                static_loss, _ = step(inputs)
+                self.assertTrue(
+                    np.allclose(
+                        dygraph_loss.numpy(), static_loss, atol=1e-5))
+
+            # The parameters trained by the static graph model are shared
+            # with the dygraph model.
+            for p1, p2 in zip(dygraph_net.parameters(),
+                              static_net.parameters()):
+                self.assertTrue(np.allclose(p1.numpy(), p2.numpy(), atol=1e-5))
+
+            x, label = self.create_inputs()
+            with self.assertRaises(ValueError):
+                step([
+                    fluid.dygraph.to_variable(x[:2]),
+                    fluid.dygraph.to_variable(label[:2])
+                ])
+
+            program = step.program
+            for p in static_net.parameters():
+                self.assertTrue(
+                    isinstance(program.global_block().var(p.name),
+                               fluid.framework.Parameter))
+
+    def test_compiled_step(self):
+        places = [fluid.CPUPlace()]
+        if fluid.is_compiled_with_cuda():
+            places.append(fluid.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -12,18 +12,12 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-import sys
+import os
 import unittest
-import multiprocessing
 import numpy as np
 import paddle.fluid as fluid
 from paddle.fluid import core
 
-if sys.version_info[0] == 2:
-    import Queue as queue
-else:
-    import queue
-
 
 def get_random_images_and_labels(image_shape, label_shape):
     image = np.random.random(size=image_shape).astype('float32')
@@ -51,32 +45,31 @@ class TestDygraphDataLoaderProcess(unittest.TestCase):
         self.capacity = 2
 
     def test_reader_process_loop(self):
-        # This unittest's memory mapped files needs to be cleaned manually
-        def __clear_process__(util_queue):
-            while True:
-                try:
-                    util_queue.get_nowait()
-                except queue.Empty:
-                    break
-
         with fluid.dygraph.guard():
             loader = fluid.io.DataLoader.from_generator(
                 capacity=self.batch_num + 1, use_multiprocess=True)
             loader.set_batch_generator(
                 batch_generator_creator(self.batch_size, self.batch_num),
                 places=fluid.CPUPlace())
-            loader._data_queue = queue.Queue(self.batch_num + 1)
-            loader._reader_process_loop()
-            # For clean memory mapped files
-            util_queue = multiprocessing.Queue(self.batch_num + 1)
-            for _ in range(self.batch_num):
-                data = loader._data_queue.get(timeout=10)
-                util_queue.put(data)
-
-            # Clean up memory mapped files
-            clear_process = multiprocessing.Process(
-                target=__clear_process__, args=(util_queue, ))
-            clear_process.start()
+            loader._init_iterable()
+            read_fd, write_fd = os.pipe()
+            loader._reader_process_loop(write_fd)
+            os.close(write_fd)
+            # The batches are read from the pipe, and the memory mapped
+            # files are released with the tensors
+            loader._pipe_reader = core._PipeBatchReader(read_fd,
+                                                        loader._blocking_queue)
+            batch_num = 0
+            while True:
+                try:
+                    image, label = loader._reader.read_next_var_list()
+                except StopIteration:
+                    break
+                self.assertEqual(image.shape, [self.batch_size, 784])
+                self.assertEqual(label.shape, [self.batch_size, 1])
+                batch_num += 1
+            self.assertEqual(batch_num, self.batch_num)
+            loader._reset()
 
     def test_reader_process_loop_simple_none(self):
         def none_sample_genarator(batch_num):
@@ -91,13 +84,14 @@ class TestDygraphDataLoaderProcess(unittest.TestCase):
                 capacity=self.batch_num + 1, use_multiprocess=True)
             loader.set_batch_generator(
                 none_sample_genarator(self.batch_num), places=fluid.CPUPlace())
-            loader._data_queue = queue.Queue(self.batch_num + 1)
+            read_fd, write_fd = os.pipe()
             exception = None
             try:
-                loader._reader_process_loop()
+                loader._reader_process_loop(write_fd, read_fd)
             except core.EnforceNotMet as ex:
                 exception = ex
             self.assertIsNotNone(exception)
+            os.close(write_fd)
 
 
 if __name__ == '__main__':
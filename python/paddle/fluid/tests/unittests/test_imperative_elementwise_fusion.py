@@ -0,0 +1,77 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import sys
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+@unittest.skipIf(sys.platform == 'darwin' or sys.platform == 'win32',
+                 "The elementwise fusion is not supported on MacOS/Windows")
+class TestImperativeElementwiseFusion(unittest.TestCase):
+    def setUp(self):
+        self.x = np.random.uniform(-1, 1, [8, 16]).astype('float64')
+        self.w = np.random.uniform(-1, 1, [8, 16]).astype('float64')
+        self.b = np.random.uniform(-1, 1, [16]).astype('float64')
+
+    def run_chain(self, place, fusion):
+        with fluid.dygraph.guard(place):
+            x = fluid.dygraph.to_variable(self.x)
+            w = fluid.dygraph.to_variable(self.w)
+            b = fluid.dygraph.to_variable(self.b)
+            x.stop_gradient = False
+            if fusion:
+                with fluid.dygraph.elementwise_fusion_guard():
+                    out = fluid.layers.tanh(fluid.layers.relu(x * w + b) - w)
+                    self.assertEqual(out.shape, [8, 16])
+                    # Reading the value runs the deferred ops.
+                    out_value = out.numpy()
+            else:
+                out = fluid.layers.tanh(fluid.layers.relu(x * w + b) - w)
+                out_value = out.numpy()
+            loss = fluid.layers.reduce_sum(out)
+            loss.backward()
+            return out_value, x.gradient()
+
+    def check_with_place(self, place):
+        out, grad = self.run_chain(place, False)
+        fused_out, fused_grad = self.run_chain(place, True)
+        self.assertTrue(np.allclose(out, fused_out))
+        self.assertTrue(np.allclose(grad, fused_grad))
+
+    def test_elementwise_fusion(self):
+        places = [fluid.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(fluid.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+
+    def test_not_fusible(self):
+        with fluid.dygraph.guard(fluid.CPUPlace()):
+            x = fluid.dygraph.to_variable(self.x)
+            y = fluid.dygraph.to_variable(self.b.astype('float32'))
+            with fluid.dygraph.elementwise_fusion_guard():
+                # The data types do not match, and the op runs as usual.
+                out = fluid.layers.relu(x) + fluid.layers.cast(y, 'float64')
+                out = fluid.layers.reduce_mean(out)
+            expected = np.mean(np.maximum(self.x, 0) + self.b)
+            self.assertTrue(np.allclose(out.numpy(), expected))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,118 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+
+class MLP(fluid.dygraph.Layer):
+    def __init__(self, input_size, hidden_size, dropout_prob):
+        super(MLP, self).__init__()
+        self._linear1 = fluid.dygraph.Linear(
+            input_size, hidden_size, act='relu')
+        self._linear2 = fluid.dygraph.Linear(hidden_size, input_size)
+        self._dropout_prob = dropout_prob
+
+    def forward(self, x):
+        h = self._linear1(x)
+        if self._dropout_prob > 0:
+            h = fluid.layers.dropout(
+                h,
+                self._dropout_prob,
+                dropout_implementation='upscale_in_train')
+        return self._linear2(h)
+
+
+class TestImperativeRecompute(unittest.TestCase):
+    def setUp(self):
+        self.input_size = 16
+        self.hidden_size = 32
+        self.x = np.random.random([8, self.input_size]).astype('float32')
+
+    def run_model(self, place, recompute, dropout_prob=0.0, state=None):
+        with fluid.dygraph.guard(place):
+            mlps = [
+                MLP(self.input_size, self.hidden_size, dropout_prob)
+                for _ in range(3)
+            ]
+            if state is not None:
+                for mlp, mlp_state in zip(mlps, state):
+                    mlp.set_dict(mlp_state)
+            x = fluid.dygraph.to_variable(self.x)
+            x.stop_gradient = False
+            out = x
+            for mlp in mlps:
+                if recompute:
+                    with fluid.dygraph.recompute_guard():
+                        out = mlp(out)
+                else:
+                    out = mlp(out)
+            loss = fluid.layers.reduce_mean(out)
+            loss.backward()
+            grads = [x.gradient()]
+            for mlp in mlps:
+                grads.extend([p.gradient() for p in mlp.parameters()])
+            return loss.numpy(), grads, [mlp.state_dict() for mlp in mlps]
+
+    def check_with_place(self, place):
+        loss, grads, state = self.run_model(place, recompute=False)
+        recompute_loss, recompute_grads, _ = self.run_model(
+            place, recompute=True, state=state)
+        self.assertTrue(np.array_equal(loss, recompute_loss))
+        for grad, recompute_grad in zip(grads, recompute_grads):
+            self.assertTrue(np.allclose(grad, recompute_grad, atol=1e-6))
+
+    def check_dropout_with_place(self, place):
+        dropout_prob = 0.5
+        with fluid.dygraph.guard(place):
+            linear = fluid.dygraph.Linear(
+                self.input_size, self.hidden_size, bias_attr=False)
+            x = fluid.dygraph.to_variable(self.x)
+            with fluid.dygraph.recompute_guard():
+                out = fluid.layers.dropout(
+                    linear(x),
+                    dropout_prob,
+                    dropout_implementation='upscale_in_train')
+            loss = fluid.layers.reduce_sum(out)
+            loss.backward()
+
+            # The gradient is computed with the recomputed mask, which should
+            # be the mask of the forward.
+            mask = (out.numpy() != 0).astype('float32')
+            expected_grad = np.matmul(self.x.T, mask / (1 - dropout_prob))
+            self.assertTrue(
+                np.allclose(
+                    linear.weight.gradient(), expected_grad, atol=1e-5))
+
+    def test_recompute(self):
+        places = [fluid.CPUPlace()]
+        if fluid.is_compiled_with_cuda():
+            places.append(fluid.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+            self.check_dropout_with_place(place)
+
+    def test_nested_guard(self):
+        with fluid.dygraph.guard():
+            with fluid.dygraph.recompute_guard():
+                with self.assertRaises(Exception):
+                    with fluid.dygraph.recompute_guard():
+                        pass
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -51,5 +51,73 @@ class TestLookupTableDequantOp(OpTest):
         self.check_output()
 
 
+def quant_rows(value):
+    # the inverse of the dequantization of lookup_table_dequant
+    value = value.astype("float32")
+    lo = value.min(axis=1, keepdims=True)
+    hi = value.max(axis=1, keepdims=True)
+    scale = (hi - lo) / 256
+    q = np.floor((value - lo) / np.where(scale > 0, scale, 1) + 0.5)
+    q = np.minimum(np.where(scale > 0, q, 0), 255).astype("uint8")
+    packed = q.view("float32").reshape(value.shape[0], -1)
+    return np.concatenate([lo, hi, packed], axis=1)
+
+
+def dequant_rows(table):
+    lo, hi = table[:, 0:1], table[:, 1:2]
+    q = np.ascontiguousarray(table[:, 2:]).view("uint8").astype("float32")
+    return q * (hi - lo) / 256 + lo
+
+
+class TestLookupTableDequantSGDOp(unittest.TestCase):
+    def check_with_place(self, place):
+        scope = core.Scope()
+        height, row_width = 10, 16
+        rows = [0, 4, 7, 4]
+        value = np.random.uniform(-1, 1, (height, row_width))
+        table = quant_rows(value)
+        param = scope.var('Param').get_tensor()
+        param.set(table, place)
+
+        grad_selected_rows = scope.var('Grad').get_selected_rows()
+        grad_selected_rows.set_height(height)
+        grad_selected_rows.set_rows(rows)
+        grad = np.random.uniform(-1, 1, (len(rows), row_width))
+        grad_selected_rows.get_tensor().set(grad.astype("float32"), place)
+
+        lr = scope.var('LearningRate').get_tensor()
+        lr_value = 0.1
+        lr.set(np.full((1), lr_value).astype("float32"), place)
+
+        op = Operator(
+            "lookup_table_dequant_sgd",
+            Param='Param',
+            Grad='Grad',
+            ParamOut='Param',
+            LearningRate='LearningRate')
+        op.run(scope, place)
+
+        expected = dequant_rows(table)
+        for i, row in enumerate(rows):
+            expected[row] -= lr_value * grad[i]
+        result = np.array(param)
+        for row in range(height):
+            if row in rows:
+                scale = (result[row, 1] - result[row, 0]) / 256
+                self.assertTrue(
+                    np.allclose(
+                        dequant_rows(result[row:row + 1])[0],
+                        expected[row],
+                        atol=scale * 1.5))
+            else:
+                self.assertTrue(
+                    np.array_equal(
+                        result[row].view("uint32"),
+                        table[row].view("uint32")))
+
+    def test_sparse_sgd(self):
+        self.check_with_place(core.CPUPlace())
+
+
 if __name__ == "__main__":
     unittest.main()
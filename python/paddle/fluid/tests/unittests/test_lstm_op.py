@@ -217,6 +217,17 @@ class TestLstmOpCase3(TestLstmOp):
         self.lod = [[2, 0, 4]]
 
 
+# the batch is in the order of the input, which shares the outputs
+class TestLstmOpOneSeq(TestLstmOp):
+    def set_lod(self):
+        self.lod = [[5]]
+
+
+class TestLstmOpLen1(TestLstmOp):
+    def set_lod(self):
+        self.lod = [[1, 1, 1]]
+
+
 # class TestLstmOpHasInitial(TestLstmOp):
 #     def set_argument(self):
 #         self.lod = [[2, 3, 2]]
@@ -315,5 +315,11 @@ class TestLstmpOpLen0Case2(TestLstmpOp):
         self.lod = [[2, 0, 3]]
 
 
+# the batch is in the order of the input, which shares the outputs
+class TestLstmpOpOneSeq(TestLstmpOp):
+    def reset_argument(self):
+        self.lod = [[5]]
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,81 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+import paddle.fluid as fluid
+import unittest
+
+
+class TestMemoryAwareReorderPass(unittest.TestCase):
+    def build_program(self, main_program, startup_program, seed=1):
+        main_program.random_seed = seed
+        startup_program.random_seed = seed
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name='x', shape=[32], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='int64')
+            # the branches are independent, so they can be reordered
+            branches = []
+            for _ in range(4):
+                hidden = fluid.layers.fc(input=x, size=256, act='relu')
+                hidden = fluid.layers.fc(input=hidden, size=16, act='relu')
+                branches.append(hidden)
+            hidden = fluid.layers.sums(branches)
+            prediction = fluid.layers.fc(input=hidden, size=10, act='softmax')
+            loss = fluid.layers.cross_entropy(input=prediction, label=y)
+            loss = fluid.layers.mean(loss)
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+        return loss
+
+    def run_program(self, place, enable_memory_aware_reorder):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        loss = self.build_program(main_program, startup_program)
+        build_strategy = fluid.BuildStrategy()
+        build_strategy.enable_memory_aware_reorder = \
+            enable_memory_aware_reorder
+        build_strategy.memory_optimize = True
+        binary = fluid.CompiledProgram(main_program).with_data_parallel(
+            loss_name=loss.name, build_strategy=build_strategy, places=[place])
+
+        np.random.seed(5)
+        exe = fluid.Executor(place)
+        loss_vals = []
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            exe.run(startup_program)
+            for _ in range(5):
+                feed = {
+                    'x': np.random.random((8, 32)).astype('float32'),
+                    'y': np.random.randint(0, 10, (8, 1)).astype('int64')
+                }
+                loss_v = exe.run(binary, feed=feed, fetch_list=[loss])
+                loss_vals.append(loss_v[0][0])
+        return loss_vals
+
+    def check(self, place):
+        loss_vals = self.run_program(place, False)
+        loss_vals_reordered = self.run_program(place, True)
+        for loss, loss_reordered in zip(loss_vals, loss_vals_reordered):
+            self.assertAlmostEqual(loss, loss_reordered, delta=1e-5)
+
+    def test_memory_aware_reorder_pass_cpu(self):
+        self.check(fluid.CPUPlace())
+
+    def test_memory_aware_reorder_pass_cuda(self):
+        if fluid.core.is_compiled_with_cuda():
+            self.check(fluid.CUDAPlace(0))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,96 @@
+#   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestMergedOptimizerOps(unittest.TestCase):
+    def setUp(self):
+        self.x = np.random.random((8, 13)).astype("float32")
+        self.y = np.random.random((8, 1)).astype("float32")
+        self.places = [fluid.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            self.places.append(fluid.CUDAPlace(0))
+
+    def run_program(self, place, make_optimizer, use_multi_tensor):
+        main, startup = fluid.Program(), fluid.Program()
+        main.random_seed = startup.random_seed = 1
+        with fluid.program_guard(main, startup):
+            x = fluid.data(name='x', shape=[-1, 13], dtype='float32')
+            y = fluid.data(name='y', shape=[-1, 1], dtype='float32')
+            hidden = fluid.layers.fc(input=x, size=16, act='tanh')
+            hidden = fluid.layers.fc(input=hidden, size=8, act='tanh')
+            pred = fluid.layers.fc(
+                input=hidden,
+                size=1,
+                param_attr=fluid.ParamAttr(learning_rate=0.5))
+            loss = fluid.layers.mean(
+                fluid.layers.square_error_cost(
+                    input=pred, label=y))
+            make_optimizer(use_multi_tensor).minimize(loss)
+
+        op_types = [op.type for op in main.global_block().ops]
+        if use_multi_tensor:
+            self.assertTrue(any(t.startswith("merged_") for t in op_types))
+
+        scope = fluid.Scope()
+        exe = fluid.Executor(place)
+        with fluid.scope_guard(scope):
+            exe.run(startup)
+            for _ in range(3):
+                exe.run(main, feed={'x': self.x, 'y': self.y})
+            return [
+                np.array(scope.find_var(p.name).get_tensor())
+                for p in main.global_block().all_parameters()
+            ]
+
+    def check_optimizer(self, make_optimizer):
+        for place in self.places:
+            expected = self.run_program(place, make_optimizer, False)
+            merged = self.run_program(place, make_optimizer, True)
+            for e, m in zip(expected, merged):
+                self.assertTrue(np.allclose(e, m, rtol=1e-5, atol=1e-6))
+
+    def test_adam(self):
+        self.check_optimizer(lambda use_multi_tensor: fluid.optimizer.Adam(
+            learning_rate=0.01, use_multi_tensor=use_multi_tensor))
+
+    def test_momentum(self):
+        self.check_optimizer(lambda use_multi_tensor: fluid.optimizer.Momentum(
+            learning_rate=0.01,
+            momentum=0.9,
+            use_nesterov=True,
+            use_multi_tensor=use_multi_tensor))
+
+    def test_lars_momentum(self):
+        self.check_optimizer(
+            lambda use_multi_tensor: fluid.optimizer.LarsMomentum(
+                learning_rate=0.01,
+                momentum=0.9,
+                use_multi_tensor=use_multi_tensor))
+
+    def test_lamb(self):
+        self.check_optimizer(lambda use_multi_tensor: fluid.optimizer.Lamb(
+            learning_rate=0.01,
+            exclude_from_weight_decay_fn=lambda p: p.name.endswith('.b_0'),
+            use_multi_tensor=use_multi_tensor))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -61,5 +61,13 @@ class TestNanInfEnv(TestNanInf):
             "elementwise_add:fc_0.tmp_1")
 
 
+
+class TestNanInfAsync(TestNanInf):
+    def setUp(self):
+        super(TestNanInfAsync, self).setUp()
+        # the checks on GPU are read at the end of each step
+        self.env[str("FLAGS_check_nan_inf_async")] = str("1")
+
+
 if __name__ == '__main__':
     unittest.main()
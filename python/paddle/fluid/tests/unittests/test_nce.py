@@ -220,6 +220,15 @@ class TestNCECase1SelectedRows(unittest.TestCase):
         self.assertEqual(rets[0], rets[1])
 
 
+@unittest.skipIf(not fluid.core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestNCECase1SelectedRowsGPU(TestNCECase1SelectedRows):
+    @staticmethod
+    def get_place():
+        place = fluid.core.CUDAPlace(0)
+        return place
+
+
 class TestNCE_OpError(unittest.TestCase):
     def test_errors(self):
         with program_guard(Program(), Program()):
@@ -225,6 +225,18 @@ class TestNearestNeighborInterpDataLayout(TestNearestInterpOp):
         self.data_layout = "NHWC"
 
 
+class TestNearestNeighborInterpDataLayoutUpsample(TestNearestInterpOp):
+    # The channels are a multiple of the vector size of the NHWC kernels.
+    def init_test_case(self):
+        self.interp_method = 'nearest'
+        self.input_shape = [2, 3, 5, 4]
+        self.out_h = 7
+        self.out_w = 12
+        self.scale = 0.
+        self.align_corners = False
+        self.data_layout = "NHWC"
+
+
 class TestNearestInterpOpUint8(OpTest):
     def setUp(self):
         self.out_size = None
@@ -72,6 +72,18 @@ class TestVariable(unittest.TestCase):
 
             self.assertTrue(np.array_equal(res1.numpy(), res2.numpy()))
 
+    def test_attrs(self):
+        with fluid.dygraph.guard():
+            x = fluid.dygraph.to_variable(self.array)
+            # The attributes are cast by the types in the op proto, e.g. the
+            # float scale and the bool bias_after_scale here.
+            res = core.ops.scale(x, 'scale', 2, 'bias', 1,
+                                 'bias_after_scale', 0)
+            self.assertTrue(np.allclose(res.numpy(), (self.array + 1) * 2))
+
+            res = core.ops.reshape2(x, 'shape', (-1, ))[0]
+            self.assertEqual(res.shape, [512 * 768])
+
     def test_trace_backward(self):
         with fluid.dygraph.guard():
             a = np.random.uniform(0.1, 1, self.shape).astype(self.dtype)
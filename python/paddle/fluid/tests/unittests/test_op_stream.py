@@ -0,0 +1,81 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestOpStream(unittest.TestCase):
+    def run_program(self, streams):
+        main = fluid.Program()
+        startup = fluid.Program()
+        main.random_seed = 1
+        startup.random_seed = 1
+        with fluid.program_guard(main, startup):
+            x = fluid.data(name='x', shape=[8, 16], dtype='float32')
+            y = fluid.layers.fc(x, 32, act='relu')
+            z = fluid.layers.fc(x, 32, act='relu')
+            out = fluid.layers.reduce_mean(y + z)
+        stream_attr_name = core.op_proto_and_checker_maker.kOpStreamAttrName()
+        for op in main.global_block().ops:
+            if op.type in streams:
+                op._set_attr(stream_attr_name, streams[op.type])
+
+        exe = fluid.Executor(core.CUDAPlace(0))
+        scope = fluid.Scope()
+        x_np = np.random.RandomState(2).random_sample(
+            [8, 16]).astype('float32')
+        with fluid.scope_guard(scope):
+            exe.run(startup)
+            results = []
+            for _ in range(3):
+                results.append(
+                    exe.run(main, feed={'x': x_np}, fetch_list=[out])[0])
+        return results
+
+    def test_attr(self):
+        main = fluid.Program()
+        with fluid.program_guard(main, fluid.Program()):
+            fluid.layers.fill_constant(shape=[1], value=1.0, dtype='float32')
+        stream_attr_name = core.op_proto_and_checker_maker.kOpStreamAttrName()
+        op = main.global_block().ops[0]
+        self.assertEqual(op.attr(stream_attr_name), "")
+
+    def test_side_streams(self):
+        if not core.is_compiled_with_cuda():
+            return
+        expected = self.run_program({})
+        # the branches run on different streams, and the sum waits for both
+        results = self.run_program({
+            'mul': 'h2d',
+            'elementwise_add': 'comm',
+            'relu': 'd2h',
+            'reduce_mean': 'comm',
+        })
+        for result, expect in zip(results, expected):
+            self.assertTrue(np.allclose(result, expect))
+
+    def test_invalid_stream(self):
+        if not core.is_compiled_with_cuda():
+            return
+        with self.assertRaises(core.EnforceNotMet):
+            self.run_program({'relu': 'gpu'})
+
+
+if __name__ == '__main__':
+    unittest.main()
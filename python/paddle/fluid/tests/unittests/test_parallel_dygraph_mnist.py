@@ -36,5 +36,13 @@ class TestParallelDygraphMnist(TestDistBase):
                 log_name=flag_name)
 
 
+class TestParallelDygraphMnistOverlapAllReduce(TestParallelDygraphMnist):
+    def _setup_config(self):
+        self._sync_mode = False
+        self._nccl2_mode = True
+        self._dygraph = True
+        self._overlap_all_reduce = True
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -72,6 +72,50 @@ class TestParallelExecutorDropExeScope(unittest.TestCase):
         if fluid.core.is_compiled_with_cuda():
             self.check_drop_scope(use_cuda=True)
 
+    def check_drop_scope_by_memory(self, use_cuda=True):
+        place = fluid.CUDAPlace(0) if use_cuda else fluid.CPUPlace()
+
+        if not use_cuda:
+            os.environ['CPU_NUM'] = str(2)
+
+        train_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(train_program, startup_program):
+            data = fluid.layers.data(name='X', shape=[1], dtype='float32')
+            hidden = fluid.layers.fc(input=data, size=10)
+            loss = fluid.layers.mean(hidden)
+            fluid.optimizer.SGD(learning_rate=0.01).minimize(loss)
+
+        exe = fluid.Executor(place)
+        exe.run(startup_program)
+
+        exec_strateg = fluid.ExecutionStrategy()
+        exec_strateg.num_iteration_per_drop_scope = 100
+
+        train_exe = fluid.ParallelExecutor(
+            use_cuda=use_cuda,
+            main_program=train_program,
+            loss_name=loss.name,
+            exec_strategy=exec_strateg)
+
+        x = numpy.random.random(size=(10, 1)).astype('float32')
+        flags = fluid.core.globals()
+        # any memory in use drops the scopes after the first run
+        flags['FLAGS_local_exe_scope_drop_memory_mb'] = 1e-6
+        try:
+            train_exe.run(feed={"X": x}, fetch_list=[loss.name])
+            assert train_exe._need_create_local_exe_scopes()
+        finally:
+            flags['FLAGS_local_exe_scope_drop_memory_mb'] = -1
+
+        train_exe.run(feed={"X": x}, fetch_list=[loss.name])
+        assert train_exe._need_create_local_exe_scopes() == False
+
+    def test_drop_scope_by_memory(self):
+        self.check_drop_scope_by_memory(use_cuda=False)
+        if fluid.core.is_compiled_with_cuda():
+            self.check_drop_scope_by_memory(use_cuda=True)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -16,6 +16,7 @@ from __future__ import print_function
 
 import unittest
 import os
+import json
 import tempfile
 import numpy as np
 import paddle.fluid as fluid
@@ -115,6 +116,76 @@ class TestProfiler(unittest.TestCase):
                         event.name.startswith("Runtime API")):
                     print("Warning: unregister", event.name)
 
+    def test_sampling_profiler(self):
+        report_path = os.path.join(tempfile.gettempdir(), "sampling_profile")
+        open(report_path, "w").write("")
+        reports = []
+        profiler.start_sampling_profiler(
+            step_interval=2,
+            report_interval=4,
+            report_path=report_path,
+            callback=lambda step, stats: reports.append((step, stats)))
+        self.net_profiler_steps(8)
+        profiler.stop_sampling_profiler()
+        self.assertFalse(core.is_sampling_profiler_enabled())
+
+        self.assertEqual([step for step, _ in reports], [4, 8])
+        for _, stats in reports:
+            self.assertGreater(len(stats), 0)
+            for stat in stats:
+                self.assertGreater(stat.calls, 0)
+                self.assertLessEqual(stat.min_ms, stat.max_ms)
+        lines = open(report_path).read().splitlines()
+        self.assertEqual(len(lines), sum(len(s) for _, s in reports))
+
+    def net_profiler_steps(self, steps):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name='x', shape=[784], dtype='float32')
+            loss = fluid.layers.mean(fluid.layers.fc(input=x, size=10))
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+        for _ in range(steps):
+            x_data = np.random.random((4, 784)).astype('float32')
+            exe.run(main_program, feed={'x': x_data}, fetch_list=[loss])
+            profiler.sampling_profiler_step()
+
+    def test_memory_profiler(self):
+        timeline_path = os.path.join(tempfile.gettempdir(), "memory_timeline")
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.layers.data(name='x', shape=[784], dtype='float32')
+            hidden = fluid.layers.fc(input=x, size=64, act='relu')
+            loss = fluid.layers.mean(fluid.layers.fc(input=hidden, size=10))
+            optimizer = fluid.optimizer.Momentum(
+                learning_rate=0.001, momentum=0.9)
+            optimizer.minimize(loss)
+        exe = fluid.Executor(fluid.CPUPlace())
+        with profiler.memory_profiler(timeline_path=timeline_path):
+            exe.run(startup_program)
+            for _ in range(2):
+                x_data = np.random.random((32, 784)).astype('float32')
+                exe.run(main_program, feed={'x': x_data}, fetch_list=[loss])
+
+        peaks = core.get_memory_peaks(5)
+        self.assertEqual(len(peaks), 1)
+        peak = peaks[0]
+        self.assertGreater(peak['peak_bytes'], 0)
+        # the weights, and the velocities of momentum
+        self.assertGreater(peak['categories']['parameter'], 784 * 64 * 4)
+        self.assertGreater(peak['categories']['optimizer_state'], 784 * 64 * 4)
+        self.assertEqual(sum(peak['categories'].values()), peak['peak_bytes'])
+        self.assertLessEqual(len(peak['ops']), 5)
+        self.assertIn('fc_0.w_0', [name for name, _ in peak['vars']])
+
+        events = json.load(open(timeline_path))['traceEvents']
+        self.assertGreater(len(events), 0)
+        for category in ['activation', 'gradient']:
+            self.assertGreater(
+                max(event['args'][category] for event in events), 0)
+
     def test_cpu_profiler(self):
         self.net_profiler('CPU', "Default")
         self.net_profiler('CPU', "Default", use_parallel_executor=True)
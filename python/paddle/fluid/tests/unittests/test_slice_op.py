@@ -71,6 +71,38 @@ class TestCase2(TestSliceOp):
         self.out = self.input[-3:3, 0:100, :, 2:-1]
 
 
+# the slices copied as a contiguous block
+class TestCase3(TestSliceOp):
+    def config(self):
+        self.input = np.random.random([3, 4, 5, 6]).astype("float64")
+        self.starts = [1, 2, 1]
+        self.ends = [2, 3, 4]
+        self.axes = [0, 1, 2]
+        self.infer_flags = [1, 1, 1]
+        self.out = self.input[1:2, 2:3, 1:4, :]
+
+
+class TestCase4(TestSliceOp):
+    def config(self):
+        self.input = np.random.random([3, 4, 5, 6]).astype("float64")
+        self.starts = [1]
+        self.ends = [3]
+        self.axes = [0]
+        self.infer_flags = [1]
+        self.out = self.input[1:3, :, :, :]
+
+
+# the strided slices copied as blocks along the outer axes
+class TestCase5(TestSliceOp):
+    def config(self):
+        self.input = np.random.random([3, 4, 2, 64]).astype("float64")
+        self.starts = [1, 1]
+        self.ends = [3, 3]
+        self.axes = [0, 1]
+        self.infer_flags = [1, 1]
+        self.out = self.input[1:3, 1:3, :, :]
+
+
 # 1.2 with attr(decrease)
 class TestSliceOp_decs_dim(OpTest):
     def setUp(self):
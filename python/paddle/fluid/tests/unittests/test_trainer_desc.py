@@ -45,6 +45,21 @@ class TestTrainerDesc(unittest.TestCase):
         self.assertEqual(mpi_rank, 1)
         self.assertEqual(dump_fields_path, "path")
 
+    def test_hogwild_local_param(self):
+        """
+        Testcase for the local params of Hogwild.
+        """
+        trainer = fluid.trainer_factory.TrainerFactory()._create_trainer({
+            "trainer": "MultiTrainer",
+            "device_worker": "Hogwild",
+            "local_param_max_numel": 1024,
+            "local_param_merge_period": 10
+        })
+        trainer._device_worker._gen_worker_desc(trainer.proto_desc)
+        hogwild_param = trainer.proto_desc.hogwild_param
+        self.assertEqual(hogwild_param.local_param_max_numel, 1024)
+        self.assertEqual(hogwild_param.local_param_merge_period, 10)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -132,5 +132,35 @@ class TestRandomGPU(TestUniqueWithCountsOp):
             self.check_output_with_place(place, atol=1e-5)
 
 
+class TestRandomLarge(TestUniqueWithCountsOp):
+    # large enough to be partitioned by the parallel CPU kernel
+    def init_config(self):
+        input_data = np.random.randint(0, 10000, (1 << 17, ), dtype='int64')
+        self.inputs = {'X': input_data}
+        self.attrs = {'dtype': int(core.VarDesc.VarType.INT32)}
+        np_unique, np_index, np_inverse, np_count = np.unique(
+            input_data,
+            return_index=True,
+            return_inverse=True,
+            return_counts=True)
+        order = np.argsort(np_index)
+        rank = np.empty_like(order)
+        rank[order] = np.arange(len(order))
+        self.outputs = {
+            'Out': np_unique[order],
+            'Index': rank[np_inverse].astype('int32'),
+            'Count': np_count[order].astype('int32')
+        }
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class TestRandomLargeGPU(TestRandomLarge):
+    def test_check_output(self):
+        if core.is_compiled_with_cuda():
+            place = core.CUDAPlace(0)
+            self.check_output_with_place(place, atol=1e-5)
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -72,6 +72,10 @@ class TrainerFactory(object):
                     trainer._set_dump_converter(opt_info["dump_converter"])
                 if opt_info.get("dump_param") is not None:
                     trainer._set_dump_param(opt_info["dump_param"])
+                if opt_info.get("local_param_max_numel") is not None:
+                    device_worker._set_local_param(
+                        opt_info["local_param_max_numel"],
+                        opt_info.get("local_param_merge_period", 100))
 
             if "fleet_desc" in opt_info:
                 device_worker._set_fleet_desc(opt_info["fleet_desc"])
@@ -28,10 +28,13 @@ from .. import core, unique_name
 from ..framework import Program, default_main_program, default_startup_program
 from .details import wait_server_ready
 
-__all__ = ['GradAllReduce', 'LocalSGD']
+__all__ = ['GradAllReduce', 'LocalSGD', 'ShardedOptimizer']
 
 OpRole = core.op_proto_and_checker_maker.OpRole
 
+# The collectives run on the comm stream of their ring.
+_comm_op_types = ['c_allreduce_sum', 'c_reducescatter', 'c_allgather']
+
 
 class Collective(object):
     '''
@@ -39,6 +42,8 @@ class Collective(object):
 
     def __init__(self, nrings):
         self.nrings = nrings
+        # the bytes communicated on each ring
+        self.ring_bytes = [0] * nrings
         self.endpoints = None
         self.current_endpoint = None
         self.nranks = None
@@ -156,6 +161,68 @@ class Collective(object):
                 attrs={'ring_id': ring_id,
                        self.op_role_key: OpRole.Forward})
 
+    def _next_ring_id(self, var):
+        '''
+        Assign the collective of var to the ring with the least bytes to
+        communicate, so that the independent collectives are spread over the
+        rings and their streams evenly and run concurrently.
+        '''
+        ring_id = self.ring_bytes.index(min(self.ring_bytes))
+        numel = reduce(lambda x, y: x * abs(y), var.shape, 1)
+        self.ring_bytes[ring_id] += numel * core.size_of_dtype(var.dtype)
+        return ring_id
+
+    def _insert_sync_comm_ops(self, block, op_role):
+        '''
+        Sync the comm stream of a ring right before the first op using the
+        vars communicated on it, instead of syncing all the rings at once,
+        so that the ops using the vars of a ring run while the others are
+        still communicating. As the collectives of a ring run in order on
+        its stream, the sync waits for all of those before it.
+        '''
+        # ring id -> names of the vars communicated but not synced
+        pending = collections.OrderedDict()
+        idx = 0
+        while idx < len(block.ops):
+            op = block.ops[idx]
+            if op.type in _comm_op_types:
+                ring_id = op.attr('ring_id')
+                names = pending.setdefault(ring_id, [])
+                for name in op.input_arg_names + op.output_arg_names:
+                    if name not in names:
+                        names.append(name)
+                idx += 1
+                continue
+            if op.type == 'c_sync_comm_stream':
+                pending.pop(op.attr('ring_id'), None)
+                idx += 1
+                continue
+
+            used = set(op.input_arg_names + op.output_arg_names)
+            for ring_id in list(pending.keys()):
+                names = pending[ring_id]
+                if not any(name in used for name in names):
+                    continue
+                block._insert_op(
+                    idx,
+                    type='c_sync_comm_stream',
+                    inputs={'X': names},
+                    outputs={'Out': names},
+                    attrs={'ring_id': ring_id,
+                           self.op_role_key: op_role})
+                del pending[ring_id]
+                idx += 1
+            idx += 1
+
+        # the vars not used in this step, e.g. the allgathered params
+        for ring_id, names in pending.items():
+            block.append_op(
+                type='c_sync_comm_stream',
+                inputs={'X': names},
+                outputs={'Out': names},
+                attrs={'ring_id': ring_id,
+                       self.op_role_key: op_role})
+
     def _is_loss_grad_op(self, op):
         if self.op_role_key not in op.attr_names:
             return False
@@ -186,6 +253,8 @@ class GradAllReduce(Collective):
     def _transpile_main_program(self):
         self._insert_scale_loss_grad_ops()
         self._insert_allreduce_ops()
+        self._insert_sync_comm_ops(self.main_program.global_block(),
+                                   OpRole.Backward)
 
     def _insert_scale_loss_grad_ops(self):
         '''
@@ -208,8 +277,6 @@ class GradAllReduce(Collective):
 
     def _insert_allreduce_ops(self):
         block = self.main_program.global_block()
-        ring_id = -1
-        grad = None
         for idx, op in reversed(list(enumerate(block.ops))):
             if self._is_backward_op(op) and \
                     self.op_role_var_key in op.attr_names:
@@ -236,35 +303,203 @@ class GradAllReduce(Collective):
                             attrs={self.op_role_key: OpRole.Backward})
                         offset += 1
 
-                    # As we search ops reversedly, we should insert c_allreduce_sum
-                    # op in the same way to keep the ring_id alternate
-                    ring_id = (ring_id + 1) % self.nrings
-                    block._insert_op(
-                        offset,
-                        type='c_allreduce_sum',
-                        inputs={'X': grad},
-                        outputs={'Out': grad},
-                        attrs={
-                            'ring_id': ring_id,
-                            self.op_role_key: OpRole.Backward
-                        })
-
-        if grad is None:
-            return
+                    ring_id = self._next_ring_id(grad)
+                    self._insert_grad_comm_op(block, offset, grad, ring_id)
+
+    def _insert_grad_comm_op(self, block, offset, grad, ring_id):
+        block._insert_op(
+            offset,
+            type='c_allreduce_sum',
+            inputs={'X': grad},
+            outputs={'Out': grad},
+            attrs={'ring_id': ring_id,
+                   self.op_role_key: OpRole.Backward})
 
-        for idx, op in enumerate(block.ops):
+
+class ShardedOptimizer(GradAllReduce):
+    '''
+    Shard the states of the optimizer ops, e.g. the moments of adam, across
+    the ranks. Each rank updates the slice of dim 0 of the params it owns
+    with the same slice of the gradients and the states, and the updated
+    slices are allgathered to the full params. The gradients only used by
+    the optimizer ops are reduce-scattered into the slices, and the others,
+    e.g. the clipped or regularized ones, are allreduced and then sliced.
+
+    The params whose dim 0 is not divisible by the number of ranks, or which
+    are updated by the optimizers not elementwise, are not sharded. The
+    saved states of the sharded params are the slices of each rank.
+    '''
+
+    elementwise_optimizers = [
+        'sgd', 'momentum', 'adam', 'adamax', 'adagrad', 'decayed_adagrad',
+        'adadelta', 'rmsprop', 'ftrl'
+    ]
+
+    def __init__(self, nrings=2):
+        GradAllReduce.__init__(self, nrings)
+        self.shard_key = '@SHARD'
+        self.mode = "sharded_optimizer"
+        # grad name -> (param name, state names, whether to reduce-scatter)
+        self.sharded_grads = {}
+
+    def _transpile_main_program(self):
+        self._find_sharded_grads()
+        self._insert_scale_loss_grad_ops()
+        self._insert_allreduce_ops()
+        self._shard_update_ops()
+        self._insert_sync_comm_ops(self.main_program.global_block(),
+                                   OpRole.Optimize)
+
+    def shard_name(self, var_name):
+        return var_name + self.shard_key
+
+    def _shard_shape(self, shape):
+        return [shape[0] // self.nranks] + list(shape[1:])
+
+    def _find_state_init_op(self, state_name):
+        block = self.startup_program.global_block()
+        for op in block.ops:
+            if op.type == 'fill_constant' and \
+                    op.output('Out') == [state_name]:
+                return op
+        return None
+
+    def _find_sharded_grads(self):
+        block = self.main_program.global_block()
+        grad_names = set()
+        optimizer_readers = collections.defaultdict(int)
+        for op in block.ops:
+            if self._is_backward_op(op) and \
+                    self.op_role_var_key in op.attr_names:
+                op_role_var = op.all_attrs()[self.op_role_var_key]
+                grad_names.update(op_role_var[1::2])
             if self._is_optimizer_op(op):
-                for ring_id in range(self.nrings):
-                    block._insert_op(
-                        idx + ring_id,
-                        type='c_sync_comm_stream',
-                        inputs={'X': grad},
-                        outputs={'Out': grad},
-                        attrs={
-                            'ring_id': ring_id,
-                            self.op_role_key: OpRole.Backward
-                        })
-                break
+                for name in set(op.input_arg_names):
+                    optimizer_readers[name] += 1
+
+        for op in block.ops:
+            if not self._is_update_op(op) or \
+                    op.type not in self.elementwise_optimizers:
+                continue
+            param = block.vars[op.input('Param')[0]]
+            grad = block.vars[op.input('Grad')[0]]
+            shape = list(param.shape)
+            if param.is_distributed or \
+                    grad.type != core.VarDesc.VarType.LOD_TENSOR or \
+                    len(shape) == 0 or shape[0] <= 0 or \
+                    shape[0] % self.nranks != 0:
+                continue
+
+            states = []
+            for slot in op.input_names:
+                if slot in ['Param', 'Grad']:
+                    continue
+                for name in op.input(slot):
+                    if list(block.vars[name].shape) == shape:
+                        states.append(name)
+            if len(states) == 0 or any(
+                    self._find_state_init_op(name) is None
+                    for name in states):
+                continue
+
+            reduce_scatter = grad.name in grad_names and \
+                    optimizer_readers[grad.name] == 1
+            self.sharded_grads[grad.name] = (param.name, states,
+                                             reduce_scatter)
+
+    def _insert_grad_comm_op(self, block, offset, grad, ring_id):
+        info = self.sharded_grads.get(grad.name)
+        if info is None or not info[2]:
+            GradAllReduce._insert_grad_comm_op(self, block, offset, grad,
+                                               ring_id)
+            return
+
+        grad_shard = block.create_var(
+            name=self.shard_name(grad.name),
+            shape=self._shard_shape(grad.shape),
+            dtype=grad.dtype)
+        block._insert_op(
+            offset,
+            type='c_reducescatter',
+            inputs={'X': grad},
+            outputs={'Out': grad_shard},
+            attrs={
+                'ring_id': ring_id,
+                'nranks': self.nranks,
+                self.op_role_key: OpRole.Backward
+            })
+
+    def _shard_state(self, state_name, shard_shape):
+        main_block = self.main_program.global_block()
+        main_block.vars[state_name].desc.set_shape(shard_shape)
+        startup_block = self.startup_program.global_block()
+        startup_block.vars[state_name].desc.set_shape(shard_shape)
+        self._find_state_init_op(state_name)._set_attr('shape', shard_shape)
+
+    def _insert_slice_op(self, block, idx, var, var_shard):
+        rows = var_shard.shape[0]
+        block._insert_op(
+            idx,
+            type='slice',
+            inputs={'Input': var},
+            outputs={'Out': var_shard},
+            attrs={
+                'axes': [0],
+                'starts': [self.rank * rows],
+                'ends': [(self.rank + 1) * rows],
+                self.op_role_key: OpRole.Optimize
+            })
+
+    def _shard_update_ops(self):
+        block = self.main_program.global_block()
+        for idx, op in reversed(list(enumerate(block.ops))):
+            if not self._is_update_op(op) or \
+                    op.input('Grad')[0] not in self.sharded_grads:
+                continue
+            grad = block.vars[op.input('Grad')[0]]
+            param_name, states, reduce_scatter = self.sharded_grads[grad.name]
+            param = block.vars[param_name]
+            shard_shape = self._shard_shape(param.shape)
+            for state_name in states:
+                self._shard_state(state_name, shard_shape)
+
+            param_shard = block.create_var(
+                name=self.shard_name(param.name),
+                shape=shard_shape,
+                dtype=param.dtype)
+            if reduce_scatter:
+                grad_shard = block.vars[self.shard_name(grad.name)]
+            else:
+                grad_shard = block.create_var(
+                    name=self.shard_name(grad.name),
+                    shape=shard_shape,
+                    dtype=grad.dtype)
+            op._rename_input(param.name, param_shard.name)
+            op._rename_output(param.name, param_shard.name)
+            op._rename_input(grad.name, grad_shard.name)
+
+            # As the update ops are searched reversedly, the ops after the
+            # update op are inserted before the ones before it
+            ring_id = self._next_ring_id(param)
+            block._insert_op(
+                idx + 1,
+                type='c_sync_calc_stream',
+                inputs={'X': param_shard},
+                outputs={'Out': param_shard},
+                attrs={self.op_role_key: OpRole.Optimize})
+            block._insert_op(
+                idx + 2,
+                type='c_allgather',
+                inputs={'X': param_shard},
+                outputs={'Out': param},
+                attrs={
+                    'ring_id': ring_id,
+                    'nranks': self.nranks,
+                    self.op_role_key: OpRole.Optimize
+                })
+            self._insert_slice_op(block, idx, param, param_shard)
+            if not reduce_scatter:
+                self._insert_slice_op(block, idx, grad, grad_shard)
 
 
 class LocalSGD(Collective):
@@ -303,7 +538,6 @@ class LocalSGD(Collective):
     def _transpile_main_program(self):
         block = self.main_program.global_block()
         ordered_param_snapshot = []
-        ring_id = -1
         for idx, op in reversed(list(enumerate(block.ops))):
             if self._is_update_op(op):
                 param = block.vars[op.input('Param')[0]]
@@ -329,7 +563,7 @@ class LocalSGD(Collective):
                     inputs={'X': param},
                     outputs={'Out': param},
                     attrs={self.op_role_key: OpRole.Optimize})
-                ring_id = (ring_id + 1) % self.nrings
+                ring_id = self._next_ring_id(param)
                 block._insert_op(
                     idx + 3,
                     type='c_allreduce_sum',
@@ -342,14 +576,6 @@ class LocalSGD(Collective):
 
                 ordered_param_snapshot.append((param, snapshot))
 
-        for ring_id in range(self.nrings):
-            block.append_op(
-                type='c_sync_comm_stream',
-                inputs={'X': param},
-                outputs={'Out': param},
-                attrs={'ring_id': ring_id,
-                       self.op_role_key: OpRole.Optimize})
-
         for param_snapshot in reversed(ordered_param_snapshot):
             param = param_snapshot[0]
             snapshot = param_snapshot[1]
@@ -372,6 +598,7 @@ class LocalSGD(Collective):
                 inputs={'X': [param]},
                 outputs={'Out': [snapshot]},
                 attrs={self.op_role_key: OpRole.Optimize})
+        self._insert_sync_comm_ops(block, OpRole.Optimize)
 
 
 class SingleProcessMultiThread(GradAllReduce):
@@ -206,7 +206,7 @@ class DistributeTranspilerConfig(object):
     hierarchical_allreduce_inter_nranks = 0
 
     # if mode is collective
-    # supported modes: grad_allreduce, local_sgd
+    # supported modes: grad_allreduce, local_sgd, sharded_optimizer
     collective_mode = None
 
     def __init__(self):
@@ -430,6 +430,9 @@ class DistributeTranspiler(object):
             transpiler = collective.GradAllReduce(self.config.nccl_comm_num)
         elif collective_mode == 'local_sgd':
             transpiler = collective.LocalSGD(self.config.nccl_comm_num)
+        elif collective_mode == 'sharded_optimizer':
+            transpiler = collective.ShardedOptimizer(
+                self.config.nccl_comm_num)
         elif collective_mode == "single_process_multi_thread":
             transpiler = collective.SingleProcessMultiThread()
         else:
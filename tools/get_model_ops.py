@@ -0,0 +1,67 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Print the op types used by the saved inference models in alphabet order,
+which are given to cmake by -DOPS_LIST_FILE to build an inference library
+with only the op libraries registering them.
+
+Usage:
+    python get_model_ops.py MODEL_DIR [MODEL_DIR|MODEL_FILE ...] > ops.txt
+    python get_model_ops.py --extra_ops fc,conv2d_fusion MODEL_DIR > ops.txt
+
+The ops inserted by the inference passes, e.g., the fused ops, are not in the
+saved models, and should be given by --extra_ops unless the passes are
+switched off by AnalysisConfig::SwitchIrOptim(false).
+"""
+from __future__ import print_function
+import argparse
+import os
+import sys
+from paddle.fluid.proto import framework_pb2
+
+
+def get_program_ops(model_file):
+    with open(model_file, 'rb') as f:
+        program = framework_pb2.ProgramDesc.FromString(f.read())
+    # the ops of the sub-blocks are run by the control flow ops
+    return set(op.type for block in program.blocks for op in block.ops)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Print the op types used by the inference models.')
+    parser.add_argument(
+        'models',
+        nargs='+',
+        help='the model directories with __model__, or the model files')
+    parser.add_argument(
+        '--extra_ops',
+        default='',
+        help='the op types to build besides the ones in the models, '
+        'separated by comma')
+    args = parser.parse_args()
+
+    ops = set(op for op in args.extra_ops.split(',') if op)
+    for model in args.models:
+        model_file = os.path.join(model, '__model__') if os.path.isdir(
+            model) else model
+        if not os.path.isfile(model_file):
+            sys.exit('The model file %s is not found.' % model_file)
+        ops |= get_program_ops(model_file)
+    for op in sorted(ops):
+        print(op)
+
+
+if __name__ == '__main__':
+    main()
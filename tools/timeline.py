@@ -30,6 +30,12 @@ parser.add_argument(
     'should be trainer1=file1,trainer2=file2,ps=file3')
 parser.add_argument(
     '--timeline_path', type=str, default='', help='Output timeline file name.')
+parser.add_argument(
+    '--executor_timeline_path',
+    type=str,
+    default='',
+    help='Input timeline file of the SSA graph executors written by '
+    'FLAGS_ssa_graph_executor_timeline_path, merged into the output.')
 args = parser.parse_args()
 
 
@@ -134,6 +140,7 @@ class Timeline(object):
         self._pid = 0
         self._devices = dict()
         self._mem_devices = dict()
+        self._mem_stat_devices = dict()
         self._chrome_trace = _ChromeTraceFormatter()
 
     def _allocate_pid(self):
@@ -201,6 +208,21 @@ class Timeline(object):
                     self._mem_devices[(k, 0, "CUDAPinnedPlace")] = pid
                     self._chrome_trace.emit_pid(
                         "memory usage on %s:cudapinnedplace:%d" % (k, 0), pid)
+            if not hasattr(profile_pb, "mem_stats"):
+                continue
+            place_to_str = {
+                profiler_pb2.MemEvent.CPUPlace: "cpu",
+                profiler_pb2.MemEvent.CUDAPlace: "gpu",
+                profiler_pb2.MemEvent.CUDAPinnedPlace: "cudapinnedplace"
+            }
+            for mstat in profile_pb.mem_stats:
+                place = place_to_str[mstat.place]
+                if (k, mstat.device_id, place) not in self._mem_stat_devices:
+                    pid = self._allocate_pid()
+                    self._mem_stat_devices[(k, mstat.device_id, place)] = pid
+                    self._chrome_trace.emit_pid("allocator stats on %s:%s:%d" %
+                                                (k, place, mstat.device_id),
+                                                pid)
 
     def _allocate_events(self):
         for k, profile_pb in six.iteritems(self._profile_dict):
@@ -215,6 +237,8 @@ class Timeline(object):
                     args['mem_bytes'] = event.memcopy.bytes
                 if hasattr(event, "detail_info") and event.detail_info:
                     args['detail_info'] = event.detail_info
+                for metric in getattr(event, 'metrics', []):
+                    args[metric.name] = metric.value
                 # TODO(panyx0718): Chrome tracing only handles ms. However, some
                 # ops takes micro-seconds. Hence, we keep the ns here.
                 self._chrome_trace.emit_region(
@@ -270,13 +294,62 @@ class Timeline(object):
                     0, total_size)
                 i += 1
 
-    def generate_chrome_trace(self):
+    def _allocate_memory_stats(self):
+        if not hasattr(profiler_pb2, "MemStat"):
+            return
+        place_to_str = {
+            profiler_pb2.MemEvent.CPUPlace: "cpu",
+            profiler_pb2.MemEvent.CUDAPlace: "gpu",
+            profiler_pb2.MemEvent.CUDAPinnedPlace: "cudapinnedplace"
+        }
+        for k, profile_pb in six.iteritems(self._profile_dict):
+            for mstat in profile_pb.mem_stats:
+                pid = self._mem_stat_devices[(k, mstat.device_id,
+                                              place_to_str[mstat.place])]
+                self._chrome_trace.emit_counter(
+                    "Memory", "Allocated", pid, mstat.timestamp_ns, 0,
+                    mstat.allocated_bytes)
+                self._chrome_trace.emit_counter(
+                    "Memory", "Peak Allocated", pid, mstat.timestamp_ns, 0,
+                    mstat.peak_allocated_bytes)
+                self._chrome_trace.emit_counter("Memory", "Reserved", pid,
+                                                mstat.timestamp_ns, 0,
+                                                mstat.reserved_bytes)
+
+    def merge_executor_timeline(self, executor_timeline):
+        """Merges the events of the SSA graph executors, whose timestamps are
+        in nanoseconds as the profile, with the pids after the devices."""
+        pid_offset = self._pid
+        for event in executor_timeline:
+            event['pid'] += pid_offset
+            self._pid = max(self._pid, event['pid'] + 1)
+            if event['ph'] == 'M':
+                self._chrome_trace._metadata.append(event)
+            else:
+                self._chrome_trace._events.append(event)
+
+    def generate_chrome_trace(self, executor_timeline=None):
         self._allocate_pids()
         self._allocate_events()
         self._allocate_memory_event()
+        self._allocate_memory_stats()
+        if executor_timeline:
+            self.merge_executor_timeline(executor_timeline)
         return self._chrome_trace.format_to_string()
 
 
+def load_executor_timeline(path):
+    """Loads the timeline of the SSA graph executors, which is a JSON array
+    not closed, since it is appended step by step."""
+    with open(path, 'r') as f:
+        content = f.read().strip()
+    if content.endswith(','):
+        content = content[:-1]
+    if not content.endswith(']'):
+        content += ']'
+    return json.loads(content)
+
+
 profile_path = '/tmp/profile'
 if args.profile_path:
     profile_path = args.profile_path
@@ -301,6 +374,10 @@ else:
             profile_pb.ParseFromString(profile_s)
         profile_dict[k] = profile_pb
 
+executor_timeline = None
+if args.executor_timeline_path:
+    executor_timeline = load_executor_timeline(args.executor_timeline_path)
+
 tl = Timeline(profile_dict)
 with open(timeline_path, 'w') as f:
-    f.write(tl.generate_chrome_trace())
+    f.write(tl.generate_chrome_trace(executor_timeline))